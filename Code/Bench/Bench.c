@@ -0,0 +1,186 @@
+/**
+ * @file    Bench.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Gemeinsame Zeitmessung und CSV-Ausgabe der Benchmark-Firmware (display_bench, ...)
+ *
+ * Die Benchmark-Ziele in CMakeLists.txt übersetzen dieselben Quellen wie CLionTest.elf plus
+ * die Dateien in Bench/. main() ruft nach der Initialisierung die jeweilige Messreihe auf.
+ *
+ * Gemessen wird mit dem DWT-Zykluszähler (eingeschaltet von Prof_Init()). Jede Wiederholung
+ * eines Tests ist ein Paar Bench_Start()/Bench_Stop(), gesammelt werden Anzahl, Minimum,
+ * Maximum und Summe. Eine einzelne Wiederholung muss kürzer als ein Überlauf von CYCCNT sein
+ * (gut 15 s bei 280 MHz), die Summe läuft in 64 Bit.
+ *
+ * Ausgabe über printf (UART7) als CSV, eine Zeile je Test:
+ *   suite,test,param,reps,us_avg,us_min,us_max,units_per_s,mb_per_s
+ * units sind je nach Suite Pixel oder Bytes, mb_per_s sind die übertragenen Nutzdaten in 10^6
+ * Bytes/s. Zahlen ohne Gleitkomma: Zeiten mit einer, MB/s mit zwei Nachkommastellen. Zeilen mit
+ * '#' am Anfang sind Kommentare (Takt, Hinweise), damit lassen sich zwei Läufe direkt mit diff
+ * vergleichen. Nach jeder Zeile wird der Sendepuffer geleert, die UART-DMA läuft also nicht
+ * während einer Messung.
+ *
+ * Bench_Reset() löscht auch die Buszähler (BusStat.h). Hinter jeder CSV-Zeile steht dann für
+ * jedes Gerät mit Verkehr eine Kommentarzeile je Wiederholung:
+ *   # test bus ILI9341 cmd 5/5 data 4/7680 block_us 612.3
+ * also Befehle/Bytes, Daten/Bytes und die Zeit in blockierenden Aufrufen und DMA-Wartezeit.
+ *
+ * Der Kopf jeder Messreihe nennt die ersten 8 Bytes der GNU-Build-ID, Bench_Finish() meldet nach
+ * der letzten Messreihe "# bench done". Tools/bench_run.py flasht ein Ziel, liest bis zu dieser
+ * Zeile mit und vergleicht das Ergebnis mit einem gespeicherten Basislauf.
+ */
+
+#include "Bench.h"
+
+#include <stdio.h>
+#include "Serial.h"
+#include "BusStat.h"
+
+/* .note.gnu.build-id aus dem Linkerskript: namesz, descsz, type, "GNU\0", dann die ID */
+extern const uint8_t _sbuild_id[];
+
+static const char *Bench_Suite = "";
+
+static uint32_t Bench_CyclesToUs10(uint64_t cycles);
+static void Bench_Flush(void);
+static void Bench_ReportBus(const char *test, const Bench_Timer *timer);
+
+/**
+ * @brief  Gibt Kopf und Spaltennamen einer Messreihe aus
+ * @param  suite: Name der Messreihe, erste Spalte jeder Zeile
+ */
+void Bench_Begin(const char *suite) {
+	Bench_Suite = suite;
+
+	printf("# %s, core %lu MHz, build ", suite, SystemCoreClock / 1000000UL);
+	if (((const uint32_t*)_sbuild_id)[1] >= 8) {
+		for (uint8_t i = 0; i < 8; i++) {
+			printf("%02x", _sbuild_id[16 + i]);
+		}
+	} else {
+		printf("-");
+	}
+	printf("\n");
+	printf("suite,test,param,reps,us_avg,us_min,us_max,units_per_s,mb_per_s\n");
+	Bench_Flush();
+}
+
+/**
+ * @brief  Schließt die Messreihe ab
+ */
+void Bench_End(void) {
+	printf("# %s done\n", Bench_Suite);
+	Bench_Flush();
+}
+
+/**
+ * @brief  Meldet das Ende aller Messreihen, danach kommt keine CSV-Zeile mehr
+ */
+void Bench_Finish(void) {
+	printf("# bench done\n");
+	Bench_Flush();
+}
+
+/**
+ * @brief  Löscht eine Messreihe vor dem nächsten Test
+ */
+void Bench_Reset(Bench_Timer *timer) {
+	timer->reps = 0;
+	timer->min = UINT32_MAX;
+	timer->max = 0;
+	timer->total = 0;
+	BusStat_Reset();
+}
+
+/**
+ * @brief  Beginn einer Wiederholung
+ */
+void Bench_Start(Bench_Timer *timer) {
+	timer->start = DWT->CYCCNT;
+}
+
+/**
+ * @brief  Ende einer Wiederholung, trägt die Takte seit Bench_Start() ein
+ */
+void Bench_Stop(Bench_Timer *timer) {
+	uint32_t cycles = DWT->CYCCNT - timer->start;
+
+	timer->reps++;
+	timer->total += cycles;
+	if (cycles < timer->min) timer->min = cycles;
+	if (cycles > timer->max) timer->max = cycles;
+}
+
+/**
+ * @brief  Gibt eine CSV-Zeile aus
+ * @param  test: Name des Tests
+ * @param  param: Parameter des Tests (Größe, Radius, Blockgröße ...), 0 wenn keiner
+ * @param  timer: Messreihe mit mindestens einer Wiederholung
+ * @param  units: Pixel bzw. Bytes je Wiederholung, daraus units_per_s
+ * @param  bytes: übertragene Nutzdaten je Wiederholung, daraus mb_per_s
+ */
+void Bench_Report(const char *test, uint32_t param, const Bench_Timer *timer, uint32_t units, uint32_t bytes) {
+	if (timer->reps == 0 || timer->total == 0) {
+		printf("%s,%s,%lu,0,,,,,\n", Bench_Suite, test, param);
+		Bench_Flush();
+		return;
+	}
+
+	uint32_t avg = Bench_CyclesToUs10(timer->total / timer->reps);
+	uint32_t min = Bench_CyclesToUs10(timer->min);
+	uint32_t max = Bench_CyclesToUs10(timer->max);
+	uint64_t done = (uint64_t)timer->reps * SystemCoreClock;
+	uint32_t rate = (uint32_t)(done * units / timer->total);
+	// bytes / s / 10^4 = MB/s * 100
+	uint32_t mb100 = (uint32_t)((uint64_t)timer->reps * (SystemCoreClock / 10000UL) * bytes / timer->total);
+
+	printf("%s,%s,%lu,%lu,%lu.%lu,%lu.%lu,%lu.%lu,%lu,%lu.%02lu\n", Bench_Suite, test, param, timer->reps,
+			avg / 10, avg % 10, min / 10, min % 10, max / 10, max % 10, rate, mb100 / 100, mb100 % 100);
+	Bench_Flush();
+	Bench_ReportBus(test, timer);
+}
+
+/**
+ * @brief  Gibt eine Kommentarzeile aus (Takt der Schnittstelle, übersprungene Tests ...)
+ */
+void Bench_Note(const char *text) {
+	printf("# %s\n", text);
+	Bench_Flush();
+}
+
+/**
+ * @brief  Kommentarzeilen mit dem Busverkehr je Wiederholung seit Bench_Reset()
+ */
+static void Bench_ReportBus(const char *test, const Bench_Timer *timer) {
+#if BUSSTAT_ENABLE
+	BusStat_Counter counters[BUSSTAT_ID_COUNT];
+
+	BusStat_Snapshot(counters);
+	for (uint8_t i = 0; i < BUSSTAT_ID_COUNT; i++) {
+		const BusStat_Counter *c = &counters[i];
+		if (c->transactions[BUSSTAT_COMMAND] + c->transactions[BUSSTAT_DATA] == 0) continue;
+
+		uint32_t block = Bench_CyclesToUs10(c->blockCycles / timer->reps);
+		printf("# %s bus %s cmd %lu/%lu data %lu/%lu block_us %lu.%lu\n", test, BusStat_Name(i),
+				c->transactions[BUSSTAT_COMMAND] / timer->reps, (uint32_t)(c->bytes[BUSSTAT_COMMAND] / timer->reps),
+				c->transactions[BUSSTAT_DATA] / timer->reps, (uint32_t)(c->bytes[BUSSTAT_DATA] / timer->reps),
+				block / 10, block % 10);
+	}
+	Bench_Flush();
+#endif
+}
+
+/**
+ * @brief  Rechnet Takte in Zehntel-Mikrosekunden um
+ */
+static uint32_t Bench_CyclesToUs10(uint64_t cycles) {
+	return (uint32_t)(cycles * 10U / (SystemCoreClock / 1000000UL));
+}
+
+/**
+ * @brief  Wartet, bis die Ausgabe gesendet ist, damit die nächste Messung ungestört läuft
+ */
+static void Bench_Flush(void) {
+	fflush(stdout);
+	Serial_Flush(Serial_Stdout, BENCH_FLUSH_TIMEOUT);
+}
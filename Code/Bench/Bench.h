@@ -0,0 +1,33 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef BENCH_BENCH_H_
+#define BENCH_BENCH_H_
+
+#include "main.h"
+
+/* Wartezeit, bis eine CSV-Zeile über die UART hinaus ist, in ms */
+#define BENCH_FLUSH_TIMEOUT       500
+
+/**
+ * @brief Messreihe eines Tests in CPU-Takten (DWT->CYCCNT)
+ */
+typedef struct {
+	uint32_t start;
+	uint32_t reps;                 // Anzahl Bench_Stop()
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+} Bench_Timer;
+
+void Bench_Begin(const char *suite);
+void Bench_End(void);
+void Bench_Finish(void);
+void Bench_Reset(Bench_Timer *timer);
+void Bench_Start(Bench_Timer *timer);
+void Bench_Stop(Bench_Timer *timer);
+void Bench_Report(const char *test, uint32_t param, const Bench_Timer *timer, uint32_t units, uint32_t bytes);
+void Bench_Note(const char *text);
+
+#endif /* BENCH_BENCH_H_ */
@@ -0,0 +1,435 @@
+/**
+ * @file    BusBench.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Gleichzeitige Last aller Master auf den AXI-SRAM mit und ohne QoS, nur im Ziel bus_bench
+ *
+ * Abnahmetest für den Plan in BusQos.c: Wie viel Durchsatz behält jeder Master, wenn SPI1-DMA,
+ * SDMMC1-IDMA, MDMA, DMA2D und die CPU gleichzeitig auf den AXI-SRAM zugreifen, und wer wartet
+ * dabei am längsten? main() ruft BusBench_Run() einmal nach der Initialisierung auf, der Scheduler
+ * ist noch nicht aktiv.
+ *
+ * Master (Testname <szenario>_<master>, Bytes je Transfer in BusBench.h):
+ *   display  Vollbild aus dem Framebuffer über SPI1/DMA2 S6 (INI1, AHB-Brücke)
+ *   sd       BSP_SD_ReadBlocks_DMA() der Sektoren 0 bis BUS_BENCH_SD_SPAN (INI3), nur lesen
+ *   mdma     MDMA aus dem Memory-Mapped-Fenster des W25Qxx in den AXI-SRAM (INI4)
+ *   dma2d    DMA2D-Kopie Speicher zu Speicher im AXI-SRAM (INI5)
+ *   cpu      memcpy im AXI-SRAM, Quelle vorher verworfen, Ziel danach zurückgeschrieben (INI2)
+ * Die Hauptschleife startet jeden gewählten Master neu, sobald sein letzter Transfer fertig ist;
+ * die Dauer eines Transfers enthält also bis zu einen Umlauf der Schleife (meist ein CPU-Block).
+ *
+ * Szenarien (BUS_BENCH_MS lang):
+ *   solo_<master>  jeder Master allein, Bezugswert für die Auszehrung
+ *   all_flat       alle zusammen, BusQos_Flat (alle Initiatoren auf 0 wie nach dem Reset)
+ *   all_qos        alle zusammen, BusQos_Default
+ * Danach gilt wieder BusQos_Default.
+ *
+ * Ausgabe je Master und Szenario:
+ *   Bench-CSV-Zeile über alle Transfer-Dauern (units und mb_per_s je Transfer)
+ *   # <szenario> <master> kb_s <Durchsatz im Fenster> max <längster Transfer> us stretch <x.y>
+ *     starved <n>/<Transfers>
+ * stretch ist der längste Transfer geteilt durch den Mittelwert allein, starved zählt Transfers
+ * über BUS_BENCH_STARVE_FACTOR mal dem Mittelwert allein. Zum Schluss je Master die Zeile
+ *   # qos <master> kb_s <flat> -> <qos> (<Änderung in %>)
+ */
+
+#include "BusBench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "Bench.h"
+#include "BusQos.h"
+#include "Cache.h"
+#include "DmaAlloc.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "SDCard.h"
+#include "W25Qxx_QSPI.h"
+#include "bsp_driver_sd.h"
+#include "sdmmc.h"
+
+#define BUS_BENCH_MASTER_COUNT    5
+#define BUS_BENCH_DMA2D_LINE      1024UL          // bytes per DMA2D line (256 ARGB8888 pixels)
+
+typedef struct BusBench_Master BusBench_Master;
+
+/**
+ * @brief Ein Master: Start eines Transfers und Abfrage seines Endes
+ */
+struct BusBench_Master {
+	const char *name;
+	uint8_t mask;
+	uint32_t bytes;                                // per transfer
+	uint8_t (*start)(BusBench_Master *master);     // 0 = failed, the master drops out
+	uint8_t (*done)(BusBench_Master *master);      // 1 = finished, 2 = failed
+	uint8_t active;
+	uint8_t busy;
+	uint32_t failed;
+	uint32_t soloAvg;                              // mean cycles per transfer alone, 0 = none
+	uint32_t starved;
+	uint64_t moved;                                // bytes in the window
+	uint32_t flatRate;                             // KB/s in all_flat
+	Bench_Timer timer;
+};
+
+static uint8_t BusBench_DisplayStart(BusBench_Master *master);
+static uint8_t BusBench_DisplayDone(BusBench_Master *master);
+static uint8_t BusBench_SdStart(BusBench_Master *master);
+static uint8_t BusBench_SdDone(BusBench_Master *master);
+static uint8_t BusBench_MdmaStart(BusBench_Master *master);
+static uint8_t BusBench_MdmaDone(BusBench_Master *master);
+static uint8_t BusBench_Dma2dStart(BusBench_Master *master);
+static uint8_t BusBench_Dma2dDone(BusBench_Master *master);
+static uint8_t BusBench_CpuStart(BusBench_Master *master);
+static uint8_t BusBench_CpuDone(BusBench_Master *master);
+
+static BusBench_Master BusBench_Masters[BUS_BENCH_MASTER_COUNT] = {
+	{ "display", BUS_BENCH_DISPLAY, 0,                     BusBench_DisplayStart, BusBench_DisplayDone },
+	{ "sd",      BUS_BENCH_SD,      BUS_BENCH_SD_BYTES,    BusBench_SdStart,      BusBench_SdDone },
+	{ "mdma",    BUS_BENCH_MDMA,    BUS_BENCH_MDMA_BYTES,  BusBench_MdmaStart,    BusBench_MdmaDone },
+	{ "dma2d",   BUS_BENCH_DMA2D,   BUS_BENCH_DMA2D_BYTES, BusBench_Dma2dStart,   BusBench_Dma2dDone },
+	{ "cpu",     BUS_BENCH_CPU,     BUS_BENCH_CPU_BYTES,   BusBench_CpuStart,     BusBench_CpuDone },
+};
+
+static uint8_t BusBench_SdBuffer[BUS_BENCH_SD_BYTES] AXI_BUFFER;
+static uint8_t BusBench_MdmaBuffer[BUS_BENCH_MDMA_BYTES] AXI_BUFFER;
+static uint8_t BusBench_Dma2dBuffer[2 * BUS_BENCH_DMA2D_BYTES] AXI_BUFFER;
+static uint8_t BusBench_CpuBuffer[2 * BUS_BENCH_CPU_BYTES] AXI_BUFFER;
+
+static MDMA_HandleTypeDef BusBench_Mdma;
+static uint32_t BusBench_Sector = 0;
+static uint8_t BusBench_Available = 0;         // masters that passed BusBench_Prepare()
+static uint8_t BusBench_WasMapped = 0;
+
+static uint8_t BusBench_Prepare(void);
+static void BusBench_Cleanup(void);
+static void BusBench_Scenario(const char *name, uint8_t masters, const BusQos_Level *plan);
+static void BusBench_Report(const char *name, uint8_t masters, uint8_t solo);
+static void BusBench_Compare(void);
+
+/**
+ * @brief  Misst jeden Master allein, dann alle zusammen ohne und mit QoS
+ */
+void BusBench_Run(void) {
+	char name[24];
+
+	Bench_Begin("bus");
+	BusBench_Available = BusBench_Prepare() & BUS_BENCH_MASTERS;
+
+	for (uint8_t i = 0; i < BUS_BENCH_MASTER_COUNT; i++) {
+		BusBench_Master *m = &BusBench_Masters[i];
+
+		if (!(BusBench_Available & m->mask))
+			continue;
+		snprintf(name, sizeof(name), "solo_%s", m->name);
+		BusBench_Scenario(name, m->mask, BusQos_Default);
+	}
+	BusBench_Scenario("all_flat", BusBench_Available, BusQos_Flat);
+	BusBench_Scenario("all_qos", BusBench_Available, BusQos_Default);
+	BusBench_Compare();
+
+	BusQos_Apply(BusQos_Default);
+	BusBench_Cleanup();
+	Bench_End();
+}
+
+/* ------------------------------------------ Ablauf ------------------------------------------ */
+
+/**
+ * @brief  Gibt den Bus frei und richtet die Master ein
+ * @retval Maske der einsatzbereiten Master
+ */
+static uint8_t BusBench_Prepare(void) {
+	uint8_t ready = BUS_BENCH_DISPLAY | BUS_BENCH_DMA2D | BUS_BENCH_CPU;
+
+	// The framebuffer may still own DMA2D and SPI1
+	ILI9341_FB_Sync();
+	ILI9341_WaitWhileBusy();
+	__HAL_RCC_DMA2D_CLK_ENABLE();
+	BusBench_Masters[0].bytes = (uint32_t)ILI9341_WIDTH * ILI9341_HEIGHT * 2;
+
+	if (SDCard_Acquire() != NULL) {
+		ready |= BUS_BENCH_SD;
+	} else {
+		Bench_Note("sd skipped, no SD card");
+	}
+
+	__HAL_RCC_MDMA_CLK_ENABLE();
+	BusBench_WasMapped = W25Qxx_IsMemoryMapped();
+	if (!BusBench_WasMapped && !W25Qxx_EnableMemoryMapped()) {
+		Bench_Note("mdma skipped, memory-mapped mode failed");
+	} else if (!DmaAlloc_ClaimMdma(&BusBench_Mdma, "BusBench")) {
+		Bench_Note("mdma skipped, no free channel");
+	} else {
+		BusBench_Mdma.Init.Request = MDMA_REQUEST_SW;
+		BusBench_Mdma.Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+		BusBench_Mdma.Init.Priority = MDMA_PRIORITY_HIGH;
+		BusBench_Mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+		BusBench_Mdma.Init.SourceInc = MDMA_SRC_INC_DOUBLEWORD;
+		BusBench_Mdma.Init.DestinationInc = MDMA_DEST_INC_DOUBLEWORD;
+		BusBench_Mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_DOUBLEWORD;
+		BusBench_Mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_DOUBLEWORD;
+		BusBench_Mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+		BusBench_Mdma.Init.BufferTransferLength = 128;
+		BusBench_Mdma.Init.SourceBurst = MDMA_SOURCE_BURST_16BEATS;
+		BusBench_Mdma.Init.DestBurst = MDMA_DEST_BURST_16BEATS;
+		BusBench_Mdma.Init.SourceBlockAddressOffset = 0;
+		BusBench_Mdma.Init.DestBlockAddressOffset = 0;
+
+		if (HAL_MDMA_Init(&BusBench_Mdma) == HAL_OK) {
+			ready |= BUS_BENCH_MDMA;
+		} else {
+			DmaAlloc_Release(&BusBench_Mdma);
+			Bench_Note("mdma skipped, init failed");
+		}
+	}
+
+	for (uint32_t i = 0; i < sizeof(BusBench_CpuBuffer); i++)
+		BusBench_CpuBuffer[i] = (uint8_t)(i * 7U);
+	Cache_CleanDMA(BusBench_CpuBuffer, sizeof(BusBench_CpuBuffer));
+	return ready;
+}
+
+static void BusBench_Cleanup(void) {
+	if (BusBench_Available & BUS_BENCH_SD)
+		SDCard_Release();
+	if (BusBench_Available & BUS_BENCH_MDMA) {
+		HAL_MDMA_DeInit(&BusBench_Mdma);
+		DmaAlloc_Release(&BusBench_Mdma);
+	}
+	if (!BusBench_WasMapped && W25Qxx_IsMemoryMapped())
+		W25Qxx_DisableMemoryMapped();
+	// The display shows the last benchmark frame until the next flush
+	ILI9341_FB_InvalidateAll();
+}
+
+/**
+ * @brief  Ein Szenario: gewählte Master BUS_BENCH_MS lang so oft wie möglich neu starten
+ *
+ * Nach Ablauf der Zeit startet kein Master mehr, die laufenden Transfers zählen noch mit.
+ */
+static void BusBench_Scenario(const char *name, uint8_t masters, const BusQos_Level *plan) {
+	uint8_t solo = (masters & (masters - 1)) == 0;
+	uint8_t busy;
+
+	BusQos_Apply(plan);
+	for (uint8_t i = 0; i < BUS_BENCH_MASTER_COUNT; i++) {
+		BusBench_Master *m = &BusBench_Masters[i];
+
+		m->active = (masters & m->mask) != 0;
+		m->busy = 0;
+		m->failed = 0;
+		m->starved = 0;
+		m->moved = 0;
+		Bench_Reset(&m->timer);
+	}
+
+	uint32_t start = HAL_GetTick();
+	do {
+		uint8_t running = HAL_GetTick() - start < BUS_BENCH_MS;
+
+		busy = 0;
+		for (uint8_t i = 0; i < BUS_BENCH_MASTER_COUNT; i++) {
+			BusBench_Master *m = &BusBench_Masters[i];
+
+			if (!m->active)
+				continue;
+			if (m->busy) {
+				uint8_t result = m->done(m);
+
+				if (result == 0) {
+					busy = 1;
+					continue;
+				}
+				m->busy = 0;
+				if (result == 2) {
+					m->failed++;
+					m->active = 0;
+					continue;
+				}
+				uint32_t cycles = DWT->CYCCNT - m->timer.start;
+				Bench_Stop(&m->timer);
+				m->moved += m->bytes;
+				if (!solo && m->soloAvg && cycles > m->soloAvg * BUS_BENCH_STARVE_FACTOR)
+					m->starved++;
+			}
+			if (!running)
+				continue;
+			Bench_Start(&m->timer);
+			if (m->start(m)) {
+				m->busy = busy = 1;
+			} else {
+				m->failed++;
+				m->active = 0;
+			}
+		}
+	} while (busy);
+
+	BusBench_Report(name, masters, solo);
+}
+
+/* ------------------------------------------ Ausgabe ------------------------------------------ */
+
+/**
+ * @brief  CSV-Zeile und Kommentarzeile je Master, allein gemessen merkt sich den Mittelwert
+ */
+static void BusBench_Report(const char *name, uint8_t masters, uint8_t solo) {
+	uint32_t mhz = SystemCoreClock / 1000000UL;
+	char line[96];
+
+	for (uint8_t i = 0; i < BUS_BENCH_MASTER_COUNT; i++) {
+		BusBench_Master *m = &BusBench_Masters[i];
+
+		if (!(masters & m->mask))
+			continue;
+		if (m->failed) {
+			snprintf(line, sizeof(line), "%s %s failed after %lu transfers", name, m->name, m->timer.reps);
+			Bench_Note(line);
+		}
+		if (m->timer.reps == 0)
+			continue;
+
+		snprintf(line, sizeof(line), "%s_%s", name, m->name);
+		Bench_Report(line, m->bytes, &m->timer, m->bytes, m->bytes);
+
+		uint32_t avg = (uint32_t)(m->timer.total / m->timer.reps);
+		uint32_t rate = (uint32_t)(m->moved / BUS_BENCH_MS);          // bytes/ms = KB/s (10^3)
+		if (solo)
+			m->soloAvg = avg;
+		if (strcmp(name, "all_flat") == 0)
+			m->flatRate = rate;
+
+		uint32_t stretch10 = m->soloAvg ? (uint32_t)((uint64_t)m->timer.max * 10 / m->soloAvg) : 0;
+		snprintf(line, sizeof(line), "%s %s kb_s %lu max %lu us stretch %lu.%lu starved %lu/%lu", name, m->name,
+				rate, m->timer.max / mhz, stretch10 / 10, stretch10 % 10, m->starved, m->timer.reps);
+		Bench_Note(line);
+	}
+}
+
+/**
+ * @brief  Durchsatz je Master ohne und mit QoS, aus den Ergebnissen von all_flat und all_qos
+ */
+static void BusBench_Compare(void) {
+	char line[64];
+
+	for (uint8_t i = 0; i < BUS_BENCH_MASTER_COUNT; i++) {
+		BusBench_Master *m = &BusBench_Masters[i];
+		uint32_t rate = (uint32_t)(m->moved / BUS_BENCH_MS);
+
+		if (!(BusBench_Available & m->mask) || m->flatRate == 0)
+			continue;
+		int32_t change = (int32_t)((int64_t)rate * 100 / m->flatRate) - 100;
+		snprintf(line, sizeof(line), "qos %s kb_s %lu -> %lu (%+ld%%)", m->name, m->flatRate, rate, change);
+		Bench_Note(line);
+	}
+}
+
+/* ------------------------------------------ Master ------------------------------------------ */
+
+static uint8_t BusBench_DisplayStart(BusBench_Master *master) {
+	const uint8_t *frame = (const uint8_t*)ILI9341_FB_GetBuffer();
+
+	Cache_CleanDMA(frame, master->bytes);
+	ILI9341_BeginWrite(0, 0, ILI9341_WIDTH - 1, ILI9341_HEIGHT - 1);
+	return ILI9341_SendDataAsync(frame, master->bytes) == HAL_OK;
+}
+
+static uint8_t BusBench_DisplayDone(BusBench_Master *master) {
+	(void)master;
+	return !ILI9341_IsBusy();
+}
+
+static uint8_t BusBench_SdStart(BusBench_Master *master) {
+	uint32_t sectors = master->bytes / 512U;
+
+	if (BusBench_Sector + sectors > BUS_BENCH_SD_SPAN)
+		BusBench_Sector = 0;
+	Cache_CleanInvalidateDMA(BusBench_SdBuffer, master->bytes);
+	if (BSP_SD_ReadBlocks_DMA((uint32_t*)BusBench_SdBuffer, BusBench_Sector, sectors) != MSD_OK)
+		return 0;
+	BusBench_Sector += sectors;
+	return 1;
+}
+
+static uint8_t BusBench_SdDone(BusBench_Master *master) {
+	if (hsd1.State == HAL_SD_STATE_BUSY)
+		return 0;
+	if (hsd1.ErrorCode != HAL_SD_ERROR_NONE)
+		return 2;
+	// The card still programs its state machine back to "transfer" after the last block
+	if (BSP_SD_GetCardState() != SD_TRANSFER_OK)
+		return 0;
+	Cache_InvalidateDMA(BusBench_SdBuffer, master->bytes);
+	return 1;
+}
+
+static uint8_t BusBench_MdmaStart(BusBench_Master *master) {
+	Cache_CleanInvalidateDMA(BusBench_MdmaBuffer, master->bytes);
+	return HAL_MDMA_Start(&BusBench_Mdma, (uint32_t)W25Qxx_MappedAddress(0), (uint32_t)BusBench_MdmaBuffer,
+			master->bytes, 1) == HAL_OK;
+}
+
+static uint8_t BusBench_MdmaDone(BusBench_Master *master) {
+	if (__HAL_MDMA_GET_FLAG(&BusBench_Mdma, MDMA_FLAG_TE)) {
+		// Clears the error and returns the handle to the ready state
+		HAL_MDMA_PollForTransfer(&BusBench_Mdma, HAL_MDMA_FULL_TRANSFER, 1);
+		return 2;
+	}
+	if (!__HAL_MDMA_GET_FLAG(&BusBench_Mdma, MDMA_FLAG_CTC))
+		return 0;
+	// Flag is set, the HAL call only clears it and returns to the ready state
+	if (HAL_MDMA_PollForTransfer(&BusBench_Mdma, HAL_MDMA_FULL_TRANSFER, 1) != HAL_OK)
+		return 2;
+	Cache_InvalidateDMA(BusBench_MdmaBuffer, master->bytes);
+	return 1;
+}
+
+/**
+ * @brief  Erste Hälfte des Puffers in die zweite, ARGB8888 in Zeilen zu BUS_BENCH_DMA2D_LINE
+ */
+static uint8_t BusBench_Dma2dStart(BusBench_Master *master) {
+	Cache_CleanInvalidateDMA(BusBench_Dma2dBuffer, sizeof(BusBench_Dma2dBuffer));
+	DMA2D->FGPFCCR = 0;
+	DMA2D->FGMAR = (uint32_t)BusBench_Dma2dBuffer;
+	DMA2D->FGOR = 0;
+	DMA2D->OPFCCR = 0;
+	DMA2D->OMAR = (uint32_t)&BusBench_Dma2dBuffer[BUS_BENCH_DMA2D_BYTES];
+	DMA2D->OOR = 0;
+	DMA2D->NLR = ((BUS_BENCH_DMA2D_LINE / 4) << DMA2D_NLR_PL_Pos) | (master->bytes / BUS_BENCH_DMA2D_LINE);
+	DMA2D->CR = (0UL << DMA2D_CR_MODE_Pos) | DMA2D_CR_START;
+	return 1;
+}
+
+static uint8_t BusBench_Dma2dDone(BusBench_Master *master) {
+	uint32_t isr = DMA2D->ISR;
+
+	(void)master;
+	if (isr & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) {
+		DMA2D->IFCR = DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF | DMA2D_IFCR_CCEIF;
+		return 2;
+	}
+	if (!(isr & DMA2D_ISR_TCIF))
+		return 0;
+	DMA2D->IFCR = DMA2D_IFCR_CTCIF;
+	return 1;
+}
+
+/**
+ * @brief  Kopie einer Hälfte des CPU-Puffers in die andere; die Cache-Pflege zwingt beide auf den Bus
+ */
+static uint8_t BusBench_CpuStart(BusBench_Master *master) {
+	static uint8_t flip = 0;
+	uint8_t *src = &BusBench_CpuBuffer[flip ? master->bytes : 0];
+	uint8_t *dst = &BusBench_CpuBuffer[flip ? 0 : master->bytes];
+
+	Cache_InvalidateDMA(src, master->bytes);
+	memcpy(dst, src, master->bytes);
+	Cache_CleanDMA(dst, master->bytes);
+	flip ^= 1;
+	return 1;
+}
+
+static uint8_t BusBench_CpuDone(BusBench_Master *master) {
+	(void)master;
+	return 1;
+}
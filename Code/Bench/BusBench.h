@@ -0,0 +1,36 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef BENCH_BUSBENCH_H_
+#define BENCH_BUSBENCH_H_
+
+#include "main.h"
+
+/* Master am AXI-SRAM, je ein Bit; BUS_BENCH_MASTERS wählt, welche mitlaufen */
+#define BUS_BENCH_DISPLAY         (1U << 0)       // SPI1 über DMA2 S6, Vollbild aus dem Framebuffer
+#define BUS_BENCH_SD              (1U << 1)       // SDMMC1-IDMA, Sektoren lesen
+#define BUS_BENCH_MDMA            (1U << 2)       // MDMA aus dem Memory-Mapped-Fenster des W25Qxx
+#define BUS_BENCH_DMA2D           (1U << 3)       // DMA2D, Kopie im AXI-SRAM
+#define BUS_BENCH_CPU             (1U << 4)       // memcpy im AXI-SRAM mit Cache-Pflege
+
+#ifndef BUS_BENCH_MASTERS
+#define BUS_BENCH_MASTERS         (BUS_BENCH_DISPLAY | BUS_BENCH_SD | BUS_BENCH_MDMA | BUS_BENCH_DMA2D | BUS_BENCH_CPU)
+#endif
+
+/* Dauer je Szenario in ms */
+#define BUS_BENCH_MS              3000
+
+/* Bytes je Transfer; die Puffer liegen alle im AXI-SRAM (AXI_BUFFER) */
+#define BUS_BENCH_SD_BYTES        (32UL * 1024UL)
+#define BUS_BENCH_SD_SPAN         2048UL          // gelesene Sektoren ab 0, danach von vorn
+#define BUS_BENCH_MDMA_BYTES      (32UL * 1024UL)
+#define BUS_BENCH_DMA2D_BYTES     (32UL * 1024UL) // je Hälfte des Puffers
+#define BUS_BENCH_CPU_BYTES       (8UL * 1024UL)
+
+/* Ausgehungert: ein Transfer dauert unter Last mehr als so oft so lange wie allein */
+#define BUS_BENCH_STARVE_FACTOR   4
+
+void BusBench_Run(void);
+
+#endif /* BENCH_BUSBENCH_H_ */
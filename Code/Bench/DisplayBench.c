@@ -0,0 +1,218 @@
+/**
+ * @file    DisplayBench.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Messreihe der ILI9341-Zeichenfunktionen, nur im Ziel display_bench
+ *
+ * main() ruft DisplayBench_Run() einmal auf, nachdem Display und SD-Karte bereit sind; danach
+ * läuft die Firmware normal weiter. Jeder Test zeichnet direkt auf das Display (ohne
+ * Bildpuffer) und wartet nach jeder Wiederholung mit ILI9341_WaitWhileBusy(), bis die letzte
+ * DMA-Übertragung fertig ist. Gemessen wird also die Zeit bis zum letzten Byte auf SPI1.
+ *
+ * Tests (param in Klammern):
+ * - fill_screen: ILI9341_FillScreen, abwechselnde Farben
+ * - fill_rect (Kantenlänge): Quadrate von 8 bis 240 Pixel in der Bildmitte
+ * - draw_pixel (Pixel je Wiederholung): einzelne Pixel an Pseudozufallspositionen mit festem Startwert
+ * - draw_text (Schriftgröße 1-4): eine Zeile mit ILI9341_DrawText, vorher wird der Glyph-Cache
+ *   geleert; us_max enthält also den ersten Durchlauf mit Rasterung, us_min die Treffer im Cache
+ * - fill_circle / circle (Radius): ILI9341_DrawFilledCircle bzw. ILI9341_DrawCircleOutline
+ * - binary_file (Breite): ILI9341_DrawBinaryFile von der SD-Karte
+ *
+ * units sind gezeichnete Pixel (bei Kreisen auf ganze Pixel gerundet aus pi*r^2 bzw. 2*pi*r),
+ * mb_per_s rechnet 2 Byte je Pixel (RGB565). Befehle und Adressfenster zählen nicht mit; der
+ * Unterschied zur SPI-Bitrate im Kopf der Ausgabe zeigt ihren Anteil, die '# ... bus ILI9341'-Zeilen
+ * hinter jedem Test zählen sie getrennt von den Pixeldaten (Bench.c).
+ */
+
+#include "DisplayBench.h"
+
+#include <stdio.h>
+#include "Bench.h"
+#include "ILI9341.h"
+#include "SDCard.h"
+#include "Fonts/5x5_font.h"
+
+static const char DisplayBench_Text[] = "Benchmark 0123456789 ABC";
+
+static uint32_t DisplayBench_Seed;
+
+static void DisplayBench_FillScreen(void);
+static void DisplayBench_FillRect(void);
+static void DisplayBench_DrawPixel(void);
+static void DisplayBench_DrawText(void);
+static void DisplayBench_Circles(void);
+static void DisplayBench_BinaryFile(void);
+static uint32_t DisplayBench_Random(void);
+
+/**
+ * @brief  Führt alle Tests aus und gibt sie als CSV über printf aus
+ */
+void DisplayBench_Run(void) {
+	char note[48];
+	uint32_t kernel = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_SPI123);
+	uint32_t divider = 2UL << ((SPI1->CFG1 & SPI_CFG1_MBR) >> SPI_CFG1_MBR_Pos);
+
+	ILI9341_WaitWhileBusy();
+
+	Bench_Begin("display");
+	snprintf(note, sizeof(note), "SPI1 %lu kbit/s, %ux%u", kernel / divider / 1000UL,
+			ILI9341_WIDTH, ILI9341_HEIGHT);
+	Bench_Note(note);
+
+	DisplayBench_FillScreen();
+	DisplayBench_FillRect();
+	DisplayBench_DrawPixel();
+	DisplayBench_DrawText();
+	DisplayBench_Circles();
+	DisplayBench_BinaryFile();
+
+	Bench_End();
+	ILI9341_FillScreen(WHITE);
+}
+
+static void DisplayBench_FillScreen(void) {
+	static const uint16_t colors[] = { RED, GREEN, BLUE, BLACK };
+	uint32_t pixels = (uint32_t)ILI9341_WIDTH * ILI9341_HEIGHT;
+	Bench_Timer timer;
+
+	Bench_Reset(&timer);
+	for (uint32_t i = 0; i < DISPLAY_BENCH_FRAMES; i++) {
+		Bench_Start(&timer);
+		ILI9341_FillScreen(colors[i % 4]);
+		ILI9341_WaitWhileBusy();
+		Bench_Stop(&timer);
+	}
+	Bench_Report("fill_screen", 0, &timer, pixels, pixels * 2);
+}
+
+static void DisplayBench_FillRect(void) {
+	static const uint16_t sizes[] = { 8, 16, 32, 64, 128, 240 };
+	Bench_Timer timer;
+
+	ILI9341_FillScreen(BLACK);
+	for (uint8_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		uint16_t size = sizes[s];
+		if (size > ILI9341_HEIGHT) continue;
+
+		uint32_t pixels = (uint32_t)size * size;
+		uint32_t reps = DISPLAY_BENCH_RECT_PIXELS / pixels;
+		if (reps < 4) reps = 4;
+
+		int16_t x = (ILI9341_WIDTH - size) / 2;
+		int16_t y = (ILI9341_HEIGHT - size) / 2;
+
+		Bench_Reset(&timer);
+		for (uint32_t i = 0; i < reps; i++) {
+			Bench_Start(&timer);
+			ILI9341_fillRect(x, y, size, size, (i & 1) ? BLUE : YELLOW);
+			ILI9341_WaitWhileBusy();
+			Bench_Stop(&timer);
+		}
+		Bench_Report("fill_rect", size, &timer, pixels, pixels * 2);
+	}
+}
+
+static void DisplayBench_DrawPixel(void) {
+	Bench_Timer timer;
+
+	ILI9341_FillScreen(BLACK);
+	DisplayBench_Seed = 1;
+	Bench_Reset(&timer);
+	for (uint32_t i = 0; i < DISPLAY_BENCH_PIXEL_REPS; i++) {
+		Bench_Start(&timer);
+		for (uint32_t p = 0; p < DISPLAY_BENCH_PIXELS; p++) {
+			uint32_t r = DisplayBench_Random();
+			ILI9341_DrawPixel((r >> 8) % ILI9341_WIDTH, (r >> 20) % ILI9341_HEIGHT, (uint16_t)r);
+		}
+		ILI9341_WaitWhileBusy();
+		Bench_Stop(&timer);
+	}
+	Bench_Report("draw_pixel", DISPLAY_BENCH_PIXELS, &timer, DISPLAY_BENCH_PIXELS, DISPLAY_BENCH_PIXELS * 2);
+}
+
+static void DisplayBench_DrawText(void) {
+	Bench_Timer timer;
+
+	ILI9341_FillScreen(WHITE);
+	for (uint16_t size = 1; size <= 4; size++) {
+		// DrawText stops at the right edge
+		uint32_t chars = ILI9341_WIDTH / (CHAR_WIDTH * size);
+		if (chars > sizeof(DisplayBench_Text) - 1) chars = sizeof(DisplayBench_Text) - 1;
+		uint32_t pixels = chars * CHAR_WIDTH * CHAR_HEIGHT * size * size;
+		uint16_t y = (size - 1) * size * CHAR_HEIGHT * 2;
+
+		ILI9341_GlyphCacheClear();
+		Bench_Reset(&timer);
+		for (uint32_t i = 0; i < DISPLAY_BENCH_TEXT_REPS; i++) {
+			Bench_Start(&timer);
+			ILI9341_DrawText(DisplayBench_Text, 0, y, BLACK, size, WHITE);
+			ILI9341_WaitWhileBusy();
+			Bench_Stop(&timer);
+		}
+		Bench_Report("draw_text", size, &timer, pixels, pixels * 2);
+	}
+}
+
+static void DisplayBench_Circles(void) {
+	static const uint16_t radii[] = { 10, 50, 100 };
+	Bench_Timer timer;
+	uint16_t x = ILI9341_WIDTH / 2;
+	uint16_t y = ILI9341_HEIGHT / 2;
+
+	ILI9341_FillScreen(BLACK);
+	for (uint8_t r = 0; r < sizeof(radii) / sizeof(radii[0]); r++) {
+		uint16_t radius = radii[r];
+		uint32_t pixels = 355UL * radius * radius / 113UL;
+
+		Bench_Reset(&timer);
+		for (uint32_t i = 0; i < DISPLAY_BENCH_CIRCLE_REPS; i++) {
+			Bench_Start(&timer);
+			ILI9341_DrawFilledCircle(x, y, radius, (i & 1) ? RED : GREEN);
+			ILI9341_WaitWhileBusy();
+			Bench_Stop(&timer);
+		}
+		Bench_Report("fill_circle", radius, &timer, pixels, pixels * 2);
+	}
+
+	for (uint8_t r = 0; r < sizeof(radii) / sizeof(radii[0]); r++) {
+		uint16_t radius = radii[r];
+		uint32_t pixels = 710UL * radius / 113UL;
+
+		Bench_Reset(&timer);
+		for (uint32_t i = 0; i < DISPLAY_BENCH_CIRCLE_REPS; i++) {
+			Bench_Start(&timer);
+			ILI9341_DrawCircleOutline(x, y, radius, (i & 1) ? WHITE : BLUE);
+			ILI9341_WaitWhileBusy();
+			Bench_Stop(&timer);
+		}
+		Bench_Report("circle", radius, &timer, pixels, pixels * 2);
+	}
+}
+
+static void DisplayBench_BinaryFile(void) {
+	uint32_t pixels = (uint32_t)DISPLAY_BENCH_FILE_WIDTH * DISPLAY_BENCH_FILE_HEIGHT;
+	Bench_Timer timer;
+
+	if (!SDCard_Mount()) {
+		Bench_Note("binary_file skipped, no SD card");
+		return;
+	}
+
+	ILI9341_FillScreen(WHITE);
+	Bench_Reset(&timer);
+	for (uint32_t i = 0; i < DISPLAY_BENCH_FILE_REPS; i++) {
+		Bench_Start(&timer);
+		ILI9341_DrawBinaryFile(DISPLAY_BENCH_FILE, 30, 30, DISPLAY_BENCH_FILE_WIDTH, DISPLAY_BENCH_FILE_HEIGHT);
+		ILI9341_WaitWhileBusy();
+		Bench_Stop(&timer);
+	}
+	Bench_Report("binary_file", DISPLAY_BENCH_FILE_WIDTH, &timer, pixels, pixels * 2);
+}
+
+/**
+ * @brief  Pseudozufallszahl (LCG aus Numerical Recipes), gleiche Folge in jedem Lauf
+ */
+static uint32_t DisplayBench_Random(void) {
+	DisplayBench_Seed = DisplayBench_Seed * 1664525UL + 1013904223UL;
+	return DisplayBench_Seed;
+}
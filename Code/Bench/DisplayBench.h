@@ -0,0 +1,26 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef BENCH_DISPLAYBENCH_H_
+#define BENCH_DISPLAYBENCH_H_
+
+#include "main.h"
+
+/* Wiederholungen je Test */
+#define DISPLAY_BENCH_FRAMES      10      // ILI9341_FillScreen
+#define DISPLAY_BENCH_RECT_PIXELS 400000  // fillRect: so viele Pixel je Größe, mindestens 4 Wiederholungen
+#define DISPLAY_BENCH_PIXELS      1000    // DrawPixel je Wiederholung
+#define DISPLAY_BENCH_PIXEL_REPS  10
+#define DISPLAY_BENCH_TEXT_REPS   20
+#define DISPLAY_BENCH_CIRCLE_REPS 20
+#define DISPLAY_BENCH_FILE_REPS   5
+
+/* Bild auf der SD-Karte für DrawBinaryFile (RGB565, wie in main()) */
+#define DISPLAY_BENCH_FILE        "SiMi_Logo_TFT.bin"
+#define DISPLAY_BENCH_FILE_WIDTH  100
+#define DISPLAY_BENCH_FILE_HEIGHT 79
+
+void DisplayBench_Run(void);
+
+#endif /* BENCH_DISPLAYBENCH_H_ */
@@ -0,0 +1,298 @@
+/**
+ * @file    JitterBench.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Jitter des TIM7-Ticks (Realtime_Loop) unter Hintergrundlast, nur im Ziel jitter_bench
+ *
+ * Abnahmetest für den Prioritätsplan in Irq.h: Wie spät läuft der 1-ms-Tick, während Display,
+ * SD-Karte und printf ihre Interrupts und DMA-Transfers erzeugen? main() ruft JitterBench_Run()
+ * einmal nach der Initialisierung auf, HAL_TIM_PeriodElapsedCallback() ruft JitterBench_Tick()
+ * vor Realtime_Loop(). Der Tick nimmt je Aufruf auf:
+ * - Periode: DWT->CYCCNT seit dem letzten Aufruf, die Abweichung vom Sollwert (1 ms im Kerntakt)
+ *   geht in ein Histogramm mit JITTER_BENCH_BIN_NS breiten Klassen
+ * - Latenz: TIM7->CNT seit dem Update-Ereignis (1 µs Auflösung), Histogramm in µs
+ *
+ * Szenarien (JITTER_BENCH_MS lang): idle, display, sd, uart und alle zusammen. Die Lasten laufen
+ * in der Hauptschleife des Benchmarks, der Scheduler ist noch nicht aktiv. JITTER_BENCH_LOADS
+ * wählt die Lasten, Szenarien mit anderen werden übersprungen.
+ *
+ * Ausgabe je Szenario:
+ *   <szenario>_period  Bench-CSV-Zeile über alle Perioden (us_avg/min/max), units = Ticks
+ *   <szenario>_latency Bench-CSV-Zeile über alle Latenzen
+ *   # <szenario> dev p99 ... max ... latency p99 ... max ... PASS|FAIL
+ *   # <szenario> hist dev_ns <untere Grenze> <Anzahl>   (nur besetzte Klassen, ebenso lat_us)
+ * FAIL heißt: Latenz oder Abweichung über JITTER_BENCH_LIMIT_US. Während der UART-Last stehen
+ * deren Zeilen (mit '#' am Anfang) zwischen den Ergebnissen.
+ */
+
+#include "JitterBench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "Bench.h"
+#include "Cache.h"
+#include "ILI9341.h"
+#include "Realtime.h"
+#include "SDCard.h"
+#include "fatfs.h"
+
+/**
+ * @brief Ein Szenario: Name und Lasten
+ */
+typedef struct {
+	const char *name;
+	uint8_t loads;
+} JitterBench_Scenario;
+
+/**
+ * @brief Messwerte eines Szenarios, geschrieben im TIM7-Interrupt
+ */
+typedef struct {
+	uint32_t last;                             // CYCCNT of the previous tick, 0 = none yet
+	uint32_t ticks;
+	uint32_t periodMin;
+	uint32_t periodMax;
+	uint64_t periodTotal;
+	uint32_t latencyMin;                       // µs, TIM7 counts
+	uint32_t latencyMax;
+	uint64_t latencyTotal;
+	uint32_t deviation[JITTER_BENCH_BINS];
+	uint32_t latency[JITTER_BENCH_BINS];
+} JitterBench_Stats;
+
+static const JitterBench_Scenario JitterBench_Scenarios[] = {
+	{ "idle",    0 },
+	{ "display", JITTER_BENCH_LOAD_DISPLAY },
+	{ "sd",      JITTER_BENCH_LOAD_SD },
+	{ "uart",    JITTER_BENCH_LOAD_UART },
+	{ "all",     JITTER_BENCH_LOAD_DISPLAY | JITTER_BENCH_LOAD_SD | JITTER_BENCH_LOAD_UART },
+};
+
+static JitterBench_Stats JitterBench_Data;
+static volatile uint8_t JitterBench_Active = 0;
+static uint32_t JitterBench_Period;            // expected cycles per tick
+static uint32_t JitterBench_BinCycles;
+
+static uint8_t JitterBench_Buffer[JITTER_BENCH_SD_BLOCK] AXI_BUFFER;
+static FIL JitterBench_File;
+static uint8_t JitterBench_SdOpen = 0;
+static uint32_t JitterBench_Display = 0;
+
+static void JitterBench_Measure(const JitterBench_Scenario *scenario);
+static void JitterBench_Load(uint8_t loads);
+static uint8_t JitterBench_SdStart(void);
+static void JitterBench_SdStop(void);
+static void JitterBench_Report(const char *name);
+static uint32_t JitterBench_Percentile(const uint32_t *bins, uint32_t count, uint32_t permille);
+static void JitterBench_Histogram(const char *name, const char *unit, const uint32_t *bins, uint32_t width);
+
+/**
+ * @brief  Startet TIM7 und misst alle in JITTER_BENCH_LOADS enthaltenen Szenarien
+ */
+void JitterBench_Run(void) {
+	for (uint32_t i = 0; i < sizeof(JitterBench_Buffer); i++)
+		JitterBench_Buffer[i] = (uint8_t)(i * 13U);
+
+	// main() starts TIM7 only after the benchmarks; a second Realtime_Init() there does nothing
+	Realtime_Init();
+
+	Bench_Begin("jitter");
+	for (uint8_t i = 0; i < sizeof(JitterBench_Scenarios) / sizeof(JitterBench_Scenarios[0]); i++) {
+		const JitterBench_Scenario *scenario = &JitterBench_Scenarios[i];
+
+		if (scenario->loads & ~JITTER_BENCH_LOADS) {
+			char note[48];
+			snprintf(note, sizeof(note), "%s skipped, load not selected", scenario->name);
+			Bench_Note(note);
+			continue;
+		}
+		JitterBench_Measure(scenario);
+	}
+	Bench_End();
+}
+
+/**
+ * @brief  Ein Aufruf je TIM7-Tick, aus HAL_TIM_PeriodElapsedCallback() vor Realtime_Loop()
+ */
+RAMFUNC void JitterBench_Tick(void) {
+	uint32_t now = DWT->CYCCNT;
+	uint32_t count = TIM7->CNT;
+	JitterBench_Stats *s = &JitterBench_Data;
+
+	if (!JitterBench_Active)
+		return;
+
+	if (s->last != 0) {
+		uint32_t period = now - s->last;
+		uint32_t deviation = period > JitterBench_Period ? period - JitterBench_Period : JitterBench_Period - period;
+		uint32_t bin = deviation / JitterBench_BinCycles;
+
+		s->ticks++;
+		s->periodTotal += period;
+		if (period < s->periodMin) s->periodMin = period;
+		if (period > s->periodMax) s->periodMax = period;
+		s->deviation[bin < JITTER_BENCH_BINS ? bin : JITTER_BENCH_BINS - 1]++;
+
+		s->latencyTotal += count;
+		if (count < s->latencyMin) s->latencyMin = count;
+		if (count > s->latencyMax) s->latencyMax = count;
+		s->latency[count < JITTER_BENCH_BINS ? count : JITTER_BENCH_BINS - 1]++;
+	}
+	s->last = now ? now : 1;
+}
+
+/* ------------------------------------------ Ablauf ------------------------------------------ */
+
+static void JitterBench_Measure(const JitterBench_Scenario *scenario) {
+	char note[48];
+
+	if ((scenario->loads & JITTER_BENCH_LOAD_SD) && !JitterBench_SdStart()) {
+		snprintf(note, sizeof(note), "%s skipped, no SD card", scenario->name);
+		Bench_Note(note);
+		return;
+	}
+
+	JitterBench_Period = SystemCoreClock / 1000UL;
+	JitterBench_BinCycles = (SystemCoreClock / 1000000UL) * JITTER_BENCH_BIN_NS / 1000UL;
+	if (JitterBench_BinCycles == 0) JitterBench_BinCycles = 1;
+
+	__disable_irq();
+	memset(&JitterBench_Data, 0, sizeof(JitterBench_Data));
+	JitterBench_Data.periodMin = UINT32_MAX;
+	JitterBench_Data.latencyMin = UINT32_MAX;
+	JitterBench_Active = 1;
+	__enable_irq();
+
+	uint32_t start = HAL_GetTick();
+	while (HAL_GetTick() - start < JITTER_BENCH_MS) {
+		JitterBench_Load(scenario->loads);
+		if (scenario->loads == 0)
+			__WFI();
+	}
+	JitterBench_Active = 0;
+
+	if (scenario->loads & JITTER_BENCH_LOAD_DISPLAY)
+		ILI9341_WaitWhileBusy();
+	if (scenario->loads & JITTER_BENCH_LOAD_SD)
+		JitterBench_SdStop();
+
+	JitterBench_Report(scenario->name);
+}
+
+/**
+ * @brief  Ein Schritt jeder gewählten Last, jeder nur wenige Millisekunden
+ */
+static void JitterBench_Load(uint8_t loads) {
+	static const uint16_t colors[] = { RED, GREEN, BLUE, WHITE };
+
+	if (loads & JITTER_BENCH_LOAD_DISPLAY) {
+		ILI9341_FillScreen(colors[JitterBench_Display++ % 4]);
+	}
+	if (loads & JITTER_BENCH_LOAD_SD) {
+		UINT done = 0;
+
+		if (f_tell(&JitterBench_File) + JITTER_BENCH_SD_BLOCK > JITTER_BENCH_FILE_SIZE)
+			f_lseek(&JitterBench_File, 0);
+		f_write(&JitterBench_File, JitterBench_Buffer, JITTER_BENCH_SD_BLOCK, &done);
+	}
+	if (loads & JITTER_BENCH_LOAD_UART) {
+		printf("# jitter uart load 0123456789abcdefghijklmnopqrstuvwxyz %lu\n", HAL_GetTick());
+	}
+}
+
+static uint8_t JitterBench_SdStart(void) {
+	if (JitterBench_SdOpen)
+		return 1;
+	if (SDCard_Acquire() == NULL)
+		return 0;
+
+	FRESULT res = f_open(&JitterBench_File, JITTER_BENCH_FILE, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK) {
+		SDCard_CheckResult(res);
+		SDCard_Release();
+		return 0;
+	}
+	JitterBench_SdOpen = 1;
+	return 1;
+}
+
+static void JitterBench_SdStop(void) {
+	if (!JitterBench_SdOpen)
+		return;
+
+	f_close(&JitterBench_File);
+	f_unlink(JITTER_BENCH_FILE);
+	SDCard_Release();
+	JitterBench_SdOpen = 0;
+}
+
+/* ------------------------------------------ Ausgabe ------------------------------------------ */
+
+static void JitterBench_Report(const char *name) {
+	JitterBench_Stats *s = &JitterBench_Data;
+	uint32_t mhz = SystemCoreClock / 1000000UL;
+	char line[96];
+	Bench_Timer timer;
+
+	if (s->ticks == 0) {
+		snprintf(line, sizeof(line), "%s no ticks, TIM7 not running", name);
+		Bench_Note(line);
+		return;
+	}
+
+	// Periods in cycles and latencies in µs as Bench_Timer, so both use the common CSV columns
+	Bench_Reset(&timer);
+	timer.reps = s->ticks;
+	timer.min = s->periodMin;
+	timer.max = s->periodMax;
+	timer.total = s->periodTotal;
+	snprintf(line, sizeof(line), "%s_period", name);
+	Bench_Report(line, JITTER_BENCH_MS, &timer, 1, 0);
+
+	timer.min = s->latencyMin * mhz;
+	timer.max = s->latencyMax * mhz;
+	timer.total = s->latencyTotal * mhz;
+	snprintf(line, sizeof(line), "%s_latency", name);
+	if (timer.total == 0) timer.total = 1;
+	Bench_Report(line, JITTER_BENCH_MS, &timer, 1, 0);
+
+	uint32_t devMax = s->periodMax - JitterBench_Period > JitterBench_Period - s->periodMin
+			? s->periodMax - JitterBench_Period : JitterBench_Period - s->periodMin;
+	uint32_t devMaxNs = devMax * 1000UL / mhz;
+	uint32_t devP99Ns = JitterBench_Percentile(s->deviation, s->ticks, 990) * JITTER_BENCH_BIN_NS;
+	uint32_t latP99 = JitterBench_Percentile(s->latency, s->ticks, 990);
+	uint8_t pass = s->latencyMax < JITTER_BENCH_LIMIT_US && devMaxNs < JITTER_BENCH_LIMIT_US * 1000UL;
+
+	snprintf(line, sizeof(line), "%s dev p99 %lu ns max %lu ns latency p99 %lu us max %lu us %s", name,
+			devP99Ns, devMaxNs, latP99, s->latencyMax, pass ? "PASS" : "FAIL");
+	Bench_Note(line);
+
+	JitterBench_Histogram(name, "dev_ns", s->deviation, JITTER_BENCH_BIN_NS);
+	JitterBench_Histogram(name, "lat_us", s->latency, 1);
+}
+
+/**
+ * @brief  Obere Grenze der Klasse, in der der Anteil permille/1000 der Werte erreicht ist
+ */
+static uint32_t JitterBench_Percentile(const uint32_t *bins, uint32_t count, uint32_t permille) {
+	uint64_t target = ((uint64_t)count * permille + 999) / 1000;
+	uint32_t sum = 0;
+
+	for (uint32_t i = 0; i < JITTER_BENCH_BINS; i++) {
+		sum += bins[i];
+		if (sum >= target)
+			return i + 1;
+	}
+	return JITTER_BENCH_BINS;
+}
+
+static void JitterBench_Histogram(const char *name, const char *unit, const uint32_t *bins, uint32_t width) {
+	char line[64];
+
+	for (uint32_t i = 0; i < JITTER_BENCH_BINS; i++) {
+		if (bins[i] == 0) continue;
+		snprintf(line, sizeof(line), "%s hist %s %s%lu %lu", name, unit,
+				i == JITTER_BENCH_BINS - 1 ? ">=" : "", i * width, bins[i]);
+		Bench_Note(line);
+	}
+}
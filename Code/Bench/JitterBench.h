@@ -0,0 +1,37 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef BENCH_JITTERBENCH_H_
+#define BENCH_JITTERBENCH_H_
+
+#include "main.h"
+
+/* Hintergrundlast, je ein Bit; Szenarien mit Lasten außerhalb der Maske werden übersprungen */
+#define JITTER_BENCH_LOAD_DISPLAY (1U << 0)       // ILI9341_FillScreen ohne Pause (SPI1 + DMA2 S6)
+#define JITTER_BENCH_LOAD_SD      (1U << 1)       // f_write in eine Testdatei (SDMMC1)
+#define JITTER_BENCH_LOAD_UART    (1U << 2)       // Zeilen über printf (UART7 + DMA1 S1)
+
+#ifndef JITTER_BENCH_LOADS
+#define JITTER_BENCH_LOADS        (JITTER_BENCH_LOAD_DISPLAY | JITTER_BENCH_LOAD_SD | JITTER_BENCH_LOAD_UART)
+#endif
+
+/* Dauer je Szenario in ms */
+#define JITTER_BENCH_MS           5000
+
+/* Histogramme: Abweichung der Periode in Schritten von JITTER_BENCH_BIN_NS, Latenz in µs */
+#define JITTER_BENCH_BINS         64              // der letzte zählt alles darüber
+#define JITTER_BENCH_BIN_NS       250
+
+/* Abnahme: Latenz und Abweichung der Periode müssen in jedem Szenario darunter bleiben */
+#define JITTER_BENCH_LIMIT_US     20
+
+/* Testdatei der SD-Last, wird danach gelöscht */
+#define JITTER_BENCH_FILE         "jitter.dat"
+#define JITTER_BENCH_FILE_SIZE    (1024UL * 1024UL)
+#define JITTER_BENCH_SD_BLOCK     (16UL * 1024UL)
+
+void JitterBench_Run(void);
+void JitterBench_Tick(void);
+
+#endif /* BENCH_JITTERBENCH_H_ */
@@ -0,0 +1,451 @@
+/**
+ * @file    MemBench.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Bandbreite und Latenz der Speicherbereiche mit CPU, MDMA und DMA2D, nur im Ziel mem_bench
+ *
+ * Wohin Framebuffer, Ringpuffer und heißer Code gehören, hängt davon ab, wie schnell welcher
+ * Bus welchen Speicher erreicht. main() ruft MemBench_Run() einmal nach der Initialisierung auf.
+ * Es misst jeden Bereich zweimal: als Suite "mem" mit eingeschalteten Caches und als Suite
+ * "mem_nocache" mit ausgeschaltetem I- und D-Cache. Die Messschleifen liegen im ITCM
+ * (RAMFUNC), ihre Befehle kosten also in beiden Läufen gleich viel.
+ *
+ * Bereiche (Testname <bereich>_<engine>_<zugriff>):
+ *   itcm   ITCM, Puffer in .itcm_text          dtcm   DTCMRAM2 (0x20010000), sonst unbenutzt
+ *   axi    AXI-SRAM (AXI_BUFFER, cachebar)     cd     AHB-SRAM RAM_CD (DMA_BUFFER, MPU: nicht cachebar)
+ *   srd    SRD-SRAM (BDMA_BUFFER, nicht cachebar)
+ *   flash  interner Flash, nur lesen           qspi   W25Qxx im Memory-Mapped-Fenster, nur lesen
+ *
+ * CPU (param = Bytes im Durchlauf):
+ * - read_seq, write_seq: Wörter der Reihe nach, je über MEM_BENCH_HOT_BYTES (passt in den
+ *   D-Cache) und den ganzen Puffer
+ * - read_rand, write_rand: gleich viele Wörter an Pseudozufallsadressen; die Adressrechnung
+ *   (LCG, drei Takte) zählt mit
+ * - latency: MEM_BENCH_CHASE_LOADS abhängige Lesezugriffe, die nächste Adresse hängt vom
+ *   gelesenen Wert ab; die Kommentarzeile danach gibt Takte je Zugriff an
+ * Die CPU-Tests laufen mit gesperrten Interrupts.
+ *
+ * MDMA und DMA2D (Software-Anforderung bzw. Betriebsart Speicher zu Speicher, abgefragt):
+ * - mdma_copy, dma2d_copy: erste Hälfte des Puffers in die zweite, aus den Nur-Lese-Bereichen
+ *   in den AXI-Puffer; dma2d_fill beschreibt den Puffer mit einer Farbe (Register zu Speicher)
+ * Der DMA2D erreicht die TCMs nicht, der MDMA über seinen AHBS-Port schon. Die Cache-Pflege
+ * vor und nach jedem Transfer ist nicht gemessen.
+ *
+ * units und mb_per_s sind Bytes je Wiederholung, bei latency Zugriffe bzw. Nutzbytes.
+ */
+
+#include "MemBench.h"
+
+#include <stdio.h>
+#include "Bench.h"
+#include "Cache.h"
+#include "DmaAlloc.h"
+#include "ILI9341_FB.h"
+#include "W25Qxx_QSPI.h"
+
+#define MEM_BENCH_WRITABLE        (1U << 0)
+#define MEM_BENCH_DMA2D           (1U << 1)       // reachable by DMA2D (not the TCMs)
+
+#define MEM_BENCH_DMA_TIMEOUT_MS  20
+#define MEM_BENCH_DMA2D_LINE      1024UL          // bytes per DMA2D line (256 ARGB8888 pixels)
+
+/**
+ * @brief Ein Speicherbereich mit seinem Messpuffer
+ */
+typedef struct {
+	const char *name;
+	uint8_t *base;
+	uint32_t size;          // Zweierpotenz
+	uint8_t flags;
+} MemBench_Region;
+
+static uint8_t MemBench_Itcm[MEM_BENCH_ITCM_BYTES] __attribute__((section(".itcm_text.membench"), aligned(32)));
+static uint8_t MemBench_Axi[MEM_BENCH_AXI_BYTES] AXI_BUFFER;
+static uint8_t MemBench_Cd[MEM_BENCH_CD_BYTES] DMA_BUFFER;
+static uint8_t MemBench_Srd[MEM_BENCH_SRD_BYTES] BDMA_BUFFER;
+
+static const MemBench_Region MemBench_Regions[] = {
+	{ "itcm",  MemBench_Itcm,                       MEM_BENCH_ITCM_BYTES, MEM_BENCH_WRITABLE },
+	{ "dtcm",  (uint8_t*)MEM_BENCH_DTCM2_BASE,      MEM_BENCH_DTCM_BYTES, MEM_BENCH_WRITABLE },
+	{ "axi",   MemBench_Axi,                        MEM_BENCH_AXI_BYTES,  MEM_BENCH_WRITABLE | MEM_BENCH_DMA2D },
+	{ "cd",    MemBench_Cd,                         MEM_BENCH_CD_BYTES,   MEM_BENCH_WRITABLE | MEM_BENCH_DMA2D },
+	{ "srd",   MemBench_Srd,                        MEM_BENCH_SRD_BYTES,  MEM_BENCH_WRITABLE | MEM_BENCH_DMA2D },
+	{ "flash", (uint8_t*)FLASH_BANK1_BASE,          MEM_BENCH_RO_BYTES,   MEM_BENCH_DMA2D },
+	{ "qspi",  (uint8_t*)W25Qxx_MappedAddress(0),   MEM_BENCH_RO_BYTES,   MEM_BENCH_DMA2D },
+};
+
+#define MEM_BENCH_REGION_COUNT    (sizeof(MemBench_Regions) / sizeof(MemBench_Regions[0]))
+
+static MDMA_HandleTypeDef MemBench_Mdma;
+static uint8_t MemBench_MdmaReady = 0;
+static volatile uint32_t MemBench_Sink;
+
+static void MemBench_Pass(const char *suite);
+static void MemBench_Cpu(const MemBench_Region *region);
+static void MemBench_Dma(const MemBench_Region *region);
+static void MemBench_Latency(const MemBench_Region *region);
+static uint8_t MemBench_MdmaInit(void);
+static uint8_t MemBench_MdmaCopy(const uint8_t *src, uint8_t *dst, uint32_t bytes);
+static uint8_t MemBench_Dma2d(uint32_t mode, const uint8_t *src, uint8_t *dst, uint32_t bytes);
+static void MemBench_Report(const MemBench_Region *region, const char *test, uint32_t param,
+		const Bench_Timer *timer, uint32_t units, uint32_t bytes);
+
+static uint32_t MemBench_ReadSeq(const uint32_t *p, uint32_t words);
+static void MemBench_WriteSeq(uint32_t *p, uint32_t words, uint32_t value);
+static uint32_t MemBench_ReadRand(const uint32_t *p, uint32_t mask, uint32_t count);
+static void MemBench_WriteRand(uint32_t *p, uint32_t mask, uint32_t count);
+static uint32_t MemBench_Chase(const uint32_t *p, uint32_t mask, uint32_t count);
+
+/**
+ * @brief  Misst alle Bereiche mit und ohne Cache und gibt sie als CSV über printf aus
+ */
+void MemBench_Run(void) {
+	uint8_t wasMapped = W25Qxx_IsMemoryMapped();
+
+	// The framebuffer may still own DMA2D; the QSPI window must be readable
+	ILI9341_FB_Sync();
+	__HAL_RCC_DMA2D_CLK_ENABLE();
+	MemBench_MdmaReady = MemBench_MdmaInit();
+	if (!wasMapped)
+		W25Qxx_EnableMemoryMapped();
+
+	MemBench_Pass("mem");
+
+	SCB_DisableDCache();
+	SCB_DisableICache();
+	MemBench_Pass("mem_nocache");
+	SCB_EnableICache();
+	SCB_EnableDCache();
+
+	if (!wasMapped)
+		W25Qxx_DisableMemoryMapped();
+	if (MemBench_MdmaReady) {
+		HAL_MDMA_DeInit(&MemBench_Mdma);
+		DmaAlloc_Release(&MemBench_Mdma);
+	}
+}
+
+/* ------------------------------------------ Ablauf ------------------------------------------ */
+
+static void MemBench_Pass(const char *suite) {
+	Bench_Begin(suite);
+	if (!MemBench_MdmaReady)
+		Bench_Note("mdma skipped, no free channel");
+
+	for (uint8_t i = 0; i < MEM_BENCH_REGION_COUNT; i++) {
+		const MemBench_Region *region = &MemBench_Regions[i];
+
+		if (region->base == (uint8_t*)W25Qxx_MappedAddress(0) && !W25Qxx_IsMemoryMapped()) {
+			Bench_Note("qspi skipped, memory-mapped mode failed");
+			continue;
+		}
+		MemBench_Cpu(region);
+		MemBench_Latency(region);
+		MemBench_Dma(region);
+	}
+	Bench_End();
+}
+
+/**
+ * @brief  Sequentielle und zufällige Zugriffe der CPU
+ */
+static void MemBench_Cpu(const MemBench_Region *region) {
+	const uint32_t sizes[2] = { MEM_BENCH_HOT_BYTES, region->size };
+	uint32_t *words = (uint32_t*)region->base;
+	uint32_t mask = region->size / 4 - 1;
+	Bench_Timer timer;
+
+	for (uint8_t s = 0; s < 2; s++) {
+		uint32_t bytes = sizes[s];
+
+		if (s == 1 && bytes == sizes[0])
+			break;
+
+		Bench_Reset(&timer);
+		__disable_irq();
+		for (uint8_t rep = 0; rep < MEM_BENCH_REPS; rep++) {
+			Bench_Start(&timer);
+			MemBench_Sink = MemBench_ReadSeq(words, bytes / 4);
+			Bench_Stop(&timer);
+		}
+		__enable_irq();
+		MemBench_Report(region, "cpu_read_seq", bytes, &timer, bytes, bytes);
+
+		if (!(region->flags & MEM_BENCH_WRITABLE))
+			continue;
+
+		Bench_Reset(&timer);
+		__disable_irq();
+		for (uint8_t rep = 0; rep < MEM_BENCH_REPS; rep++) {
+			Bench_Start(&timer);
+			MemBench_WriteSeq(words, bytes / 4, rep);
+			Bench_Stop(&timer);
+		}
+		__enable_irq();
+		MemBench_Report(region, "cpu_write_seq", bytes, &timer, bytes, bytes);
+	}
+
+	Bench_Reset(&timer);
+	__disable_irq();
+	for (uint8_t rep = 0; rep < MEM_BENCH_REPS; rep++) {
+		Bench_Start(&timer);
+		MemBench_Sink = MemBench_ReadRand(words, mask, region->size / 4);
+		Bench_Stop(&timer);
+	}
+	__enable_irq();
+	MemBench_Report(region, "cpu_read_rand", region->size, &timer, region->size, region->size);
+
+	if (region->flags & MEM_BENCH_WRITABLE) {
+		Bench_Reset(&timer);
+		__disable_irq();
+		for (uint8_t rep = 0; rep < MEM_BENCH_REPS; rep++) {
+			Bench_Start(&timer);
+			MemBench_WriteRand(words, mask, region->size / 4);
+			Bench_Stop(&timer);
+		}
+		__enable_irq();
+		MemBench_Report(region, "cpu_write_rand", region->size, &timer, region->size, region->size);
+	}
+}
+
+/**
+ * @brief  Abhängige Lesezugriffe, Kommentarzeile mit Takten je Zugriff
+ */
+static void MemBench_Latency(const MemBench_Region *region) {
+	char note[48];
+	Bench_Timer timer;
+
+	Bench_Reset(&timer);
+	__disable_irq();
+	for (uint8_t rep = 0; rep < MEM_BENCH_REPS; rep++) {
+		Bench_Start(&timer);
+		MemBench_Sink = MemBench_Chase((const uint32_t*)region->base, region->size / 4 - 1, MEM_BENCH_CHASE_LOADS);
+		Bench_Stop(&timer);
+	}
+	__enable_irq();
+	MemBench_Report(region, "cpu_latency", MEM_BENCH_CHASE_LOADS, &timer, MEM_BENCH_CHASE_LOADS,
+			MEM_BENCH_CHASE_LOADS * 4);
+
+	uint32_t cycles10 = (uint32_t)(timer.total * 10 / ((uint64_t)timer.reps * MEM_BENCH_CHASE_LOADS));
+	snprintf(note, sizeof(note), "%s latency %lu.%lu cycles/load", region->name, cycles10 / 10, cycles10 % 10);
+	Bench_Note(note);
+}
+
+/**
+ * @brief  Kopie und Füllung mit MDMA und DMA2D
+ */
+static void MemBench_Dma(const MemBench_Region *region) {
+	const uint8_t *src = region->base;
+	uint8_t writable = region->flags & MEM_BENCH_WRITABLE;
+	uint8_t *dst = writable ? region->base + region->size / 2 : MemBench_Axi;
+	uint32_t bytes = writable ? region->size / 2 : region->size;
+	char note[48];
+	Bench_Timer timer;
+	uint8_t ok = 1;
+
+	if (MemBench_MdmaReady) {
+		Bench_Reset(&timer);
+		for (uint8_t rep = 0; rep < MEM_BENCH_REPS && ok; rep++) {
+			Cache_CleanDMA(src, bytes);
+			Cache_CleanInvalidateDMA(dst, bytes);
+			Bench_Start(&timer);
+			ok = MemBench_MdmaCopy(src, dst, bytes);
+			Bench_Stop(&timer);
+			Cache_InvalidateDMA(dst, bytes);
+		}
+		if (ok) {
+			MemBench_Report(region, "mdma_copy", bytes, &timer, bytes, bytes);
+		} else {
+			snprintf(note, sizeof(note), "%s mdma_copy failed", region->name);
+			Bench_Note(note);
+		}
+	}
+
+	if (!(region->flags & MEM_BENCH_DMA2D)) {
+		snprintf(note, sizeof(note), "%s dma2d skipped, not reachable", region->name);
+		Bench_Note(note);
+		return;
+	}
+
+	ok = 1;
+	Bench_Reset(&timer);
+	for (uint8_t rep = 0; rep < MEM_BENCH_REPS && ok; rep++) {
+		Cache_CleanDMA(src, bytes);
+		Cache_CleanInvalidateDMA(dst, bytes);
+		Bench_Start(&timer);
+		ok = MemBench_Dma2d(0UL << DMA2D_CR_MODE_Pos, src, dst, bytes);
+		Bench_Stop(&timer);
+		Cache_InvalidateDMA(dst, bytes);
+	}
+	if (ok) {
+		MemBench_Report(region, "dma2d_copy", bytes, &timer, bytes, bytes);
+	} else {
+		snprintf(note, sizeof(note), "%s dma2d_copy failed", region->name);
+		Bench_Note(note);
+	}
+
+	if (!writable)
+		return;
+
+	ok = 1;
+	Bench_Reset(&timer);
+	for (uint8_t rep = 0; rep < MEM_BENCH_REPS && ok; rep++) {
+		Cache_CleanInvalidateDMA(region->base, region->size);
+		Bench_Start(&timer);
+		ok = MemBench_Dma2d(3UL << DMA2D_CR_MODE_Pos, NULL, region->base, region->size);
+		Bench_Stop(&timer);
+		Cache_InvalidateDMA(region->base, region->size);
+	}
+	if (ok) {
+		MemBench_Report(region, "dma2d_fill", region->size, &timer, region->size, region->size);
+	} else {
+		snprintf(note, sizeof(note), "%s dma2d_fill failed", region->name);
+		Bench_Note(note);
+	}
+}
+
+/**
+ * @brief  CSV-Zeile mit dem Bereich vor dem Testnamen
+ */
+static void MemBench_Report(const MemBench_Region *region, const char *test, uint32_t param,
+		const Bench_Timer *timer, uint32_t units, uint32_t bytes) {
+	char name[32];
+
+	snprintf(name, sizeof(name), "%s_%s", region->name, test);
+	Bench_Report(name, param, timer, units, bytes);
+}
+
+/* ------------------------------------------- DMA ------------------------------------------- */
+
+/**
+ * @brief  MDMA-Kanal für Kopien Speicher zu Speicher, Doppelwörter in 16er-Bursts
+ */
+static uint8_t MemBench_MdmaInit(void) {
+	__HAL_RCC_MDMA_CLK_ENABLE();
+
+	if (!DmaAlloc_ClaimMdma(&MemBench_Mdma, "MemBench")) {
+		return 0;
+	}
+	MemBench_Mdma.Init.Request = MDMA_REQUEST_SW;
+	MemBench_Mdma.Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+	MemBench_Mdma.Init.Priority = MDMA_PRIORITY_VERY_HIGH;
+	MemBench_Mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+	MemBench_Mdma.Init.SourceInc = MDMA_SRC_INC_DOUBLEWORD;
+	MemBench_Mdma.Init.DestinationInc = MDMA_DEST_INC_DOUBLEWORD;
+	MemBench_Mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_DOUBLEWORD;
+	MemBench_Mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_DOUBLEWORD;
+	MemBench_Mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+	MemBench_Mdma.Init.BufferTransferLength = 128;
+	MemBench_Mdma.Init.SourceBurst = MDMA_SOURCE_BURST_16BEATS;
+	MemBench_Mdma.Init.DestBurst = MDMA_DEST_BURST_16BEATS;
+	MemBench_Mdma.Init.SourceBlockAddressOffset = 0;
+	MemBench_Mdma.Init.DestBlockAddressOffset = 0;
+
+	if (HAL_MDMA_Init(&MemBench_Mdma) != HAL_OK) {
+		DmaAlloc_Release(&MemBench_Mdma);
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Ein Block bis 64 KB, abgefragt
+ */
+static uint8_t MemBench_MdmaCopy(const uint8_t *src, uint8_t *dst, uint32_t bytes) {
+	if (HAL_MDMA_Start(&MemBench_Mdma, (uint32_t)src, (uint32_t)dst, bytes, 1) != HAL_OK) {
+		return 0;
+	}
+	if (HAL_MDMA_PollForTransfer(&MemBench_Mdma, HAL_MDMA_FULL_TRANSFER, MEM_BENCH_DMA_TIMEOUT_MS) != HAL_OK) {
+		HAL_MDMA_Abort(&MemBench_Mdma);
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  DMA2D als Kopierer (M2M) bzw. Füller (R2M) in ARGB8888, Zeilen zu MEM_BENCH_DMA2D_LINE
+ */
+static uint8_t MemBench_Dma2d(uint32_t mode, const uint8_t *src, uint8_t *dst, uint32_t bytes) {
+	uint32_t start = HAL_GetTick();
+	uint8_t ok = 1;
+
+	DMA2D->FGPFCCR = 0;                      // ARGB8888
+	DMA2D->FGMAR = (uint32_t)src;
+	DMA2D->FGOR = 0;
+	DMA2D->OPFCCR = 0;
+	DMA2D->OCOLR = 0x5A5A5A5AUL;
+	DMA2D->OMAR = (uint32_t)dst;
+	DMA2D->OOR = 0;
+	DMA2D->NLR = ((MEM_BENCH_DMA2D_LINE / 4) << DMA2D_NLR_PL_Pos) | (bytes / MEM_BENCH_DMA2D_LINE);
+	DMA2D->CR = mode | DMA2D_CR_START;
+
+	while (!(DMA2D->ISR & DMA2D_ISR_TCIF)) {
+		if (DMA2D->ISR & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) {
+			ok = 0;
+			break;
+		}
+		if (HAL_GetTick() - start > MEM_BENCH_DMA_TIMEOUT_MS) {
+			DMA2D->CR |= DMA2D_CR_ABORT;
+			while (DMA2D->CR & DMA2D_CR_START);
+			ok = 0;
+			break;
+		}
+	}
+	DMA2D->IFCR = DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF | DMA2D_IFCR_CCEIF;
+	return ok;
+}
+
+/* ------------------------------------- Messschleifen (ITCM) ------------------------------------- */
+
+static RAMFUNC uint32_t MemBench_ReadSeq(const uint32_t *p, uint32_t words) {
+	uint32_t a = 0, b = 0, c = 0, d = 0;
+
+	for (; words >= 4; words -= 4, p += 4) {
+		a += p[0];
+		b += p[1];
+		c += p[2];
+		d += p[3];
+	}
+	return a + b + c + d;
+}
+
+static RAMFUNC void MemBench_WriteSeq(uint32_t *p, uint32_t words, uint32_t value) {
+	for (; words >= 4; words -= 4, p += 4) {
+		p[0] = value;
+		p[1] = value;
+		p[2] = value;
+		p[3] = value;
+	}
+}
+
+static RAMFUNC uint32_t MemBench_ReadRand(const uint32_t *p, uint32_t mask, uint32_t count) {
+	uint32_t seed = 1;
+	uint32_t sum = 0;
+
+	while (count--) {
+		seed = seed * 1664525UL + 1013904223UL;
+		sum += p[(seed >> 8) & mask];
+	}
+	return sum;
+}
+
+static RAMFUNC void MemBench_WriteRand(uint32_t *p, uint32_t mask, uint32_t count) {
+	uint32_t seed = 1;
+
+	while (count--) {
+		seed = seed * 1664525UL + 1013904223UL;
+		p[(seed >> 8) & mask] = seed;
+	}
+}
+
+/**
+ * @brief  Jede Adresse hängt vom zuvor gelesenen Wert ab: kein Zugriff überlappt den nächsten
+ */
+static RAMFUNC uint32_t MemBench_Chase(const uint32_t *p, uint32_t mask, uint32_t count) {
+	uint32_t index = 0;
+
+	while (count--) {
+		index = (((index + p[index]) * 1664525UL + 1013904223UL) >> 8) & mask;
+	}
+	return index;
+}
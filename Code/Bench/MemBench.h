@@ -0,0 +1,29 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef BENCH_MEMBENCH_H_
+#define BENCH_MEMBENCH_H_
+
+#include "main.h"
+
+/* Messpuffer je Bereich; AXI größer als der D-Cache (16 KB), die übrigen sind nicht cachebar */
+#define MEM_BENCH_ITCM_BYTES      (4UL * 1024UL)      // in .itcm_text, belegt dasselbe im FLASH
+#define MEM_BENCH_DTCM_BYTES      (32UL * 1024UL)     // DTCMRAM2, sonst unbenutzt
+#define MEM_BENCH_AXI_BYTES       (64UL * 1024UL)
+#define MEM_BENCH_CD_BYTES        (8UL * 1024UL)      // RAM_CD teilt sich die Treiber-Puffer
+#define MEM_BENCH_SRD_BYTES       (4UL * 1024UL)
+#define MEM_BENCH_RO_BYTES        (32UL * 1024UL)     // gelesen aus internem Flash und QSPI-Fenster
+
+/* Kleiner Durchlauf, passt in den D-Cache: zeigt die Trefferrate statt des Speichers */
+#define MEM_BENCH_HOT_BYTES       (4UL * 1024UL)
+
+#define MEM_BENCH_DTCM2_BASE      0x20010000UL
+
+/* Wiederholungen je Test, Zugriffe je Latenzmessung */
+#define MEM_BENCH_REPS            8
+#define MEM_BENCH_CHASE_LOADS     4096UL
+
+void MemBench_Run(void);
+
+#endif /* BENCH_MEMBENCH_H_ */
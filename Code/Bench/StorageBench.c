@@ -0,0 +1,351 @@
+/**
+ * @file    StorageBench.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Durchsatz und Latenz von SD-Karte und W25Qxx, nur im Ziel storage_bench
+ *
+ * main() ruft StorageBench_Run() einmal auf, nachdem die SD-Karte gemountet ist; danach läuft
+ * die Firmware normal weiter. Jeder Test wird für alle Blockgrößen von 512 B bis 64 KB
+ * wiederholt (param = Blockgröße). Eine Wiederholung ist ein Zugriff; sequentiell sind es
+ * STORAGE_BENCH_SEQ_BYTES je Blockgröße, zufällig STORAGE_BENCH_RANDOM_OPS Zugriffe an
+ * blockweise ausgerichteten Pseudozufallsadressen (fester Startwert, in jedem Lauf gleich).
+ *
+ * SD-Karte:
+ * - sd_*: SD_read/SD_write über disk_read()/disk_write(), also durch den Sektorcache (SDCache),
+ *   der ab SDCACHE_BYPASS_SECTORS umgangen wird. Geschrieben wird nur in die Sektoren der
+ *   Testdatei, die mit f_expand() zusammenhängend belegt wird, das Dateisystem bleibt heil.
+ * - fat_*: f_read/f_write in derselben Datei, bei zufälligen Zugriffen mit f_lseek() davor.
+ * - Schreiben ist im Cache zunächst nur vorgemerkt. Nach jedem Schreibdurchlauf misst eine Zeile
+ *   *_sync (CTRL_SYNC bzw. f_sync) das Zurückschreiben des Rests.
+ *
+ * W25Qxx:
+ * - flash_read, flash_fast, flash_quad: W25Qxx_ReadData, FastReadData, FastReadQuadOutput im
+ *   indirekten Modus
+ * - flash_mapped: memcpy aus dem Memory-Mapped-Fenster, vor jedem Zugriff (ungemessen) werden
+ *   die Cache-Zeilen des Bereichs verworfen, damit wirklich vom Flash gelesen wird
+ * - erase_block64, erase_block32, erase_sector, page_program: Latenz der Lösch- und
+ *   Programmierbefehle im Bereich STORAGE_BENCH_FLASH_SCRATCH (param = Bytes je Befehl)
+ * Der Memory-Mapped-Modus wird danach wie vorgefunden wiederhergestellt.
+ *
+ * units und mb_per_s sind Nutzbytes je Zugriff, units_per_s also Bytes/s.
+ */
+
+#include "StorageBench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "Bench.h"
+#include "SDCard.h"
+#include "Asset.h"
+#include "W25Qxx_QSPI.h"
+#include "fatfs.h"
+#include "diskio.h"
+
+#define STORAGE_BENCH_SECTOR        512UL
+#define STORAGE_BENCH_PAGE          256UL
+
+/**
+ * @brief Ein Test über alle Blockgrößen
+ */
+typedef struct {
+	const char *name;
+	uint8_t (*run)(uint32_t offset, uint32_t size);      // ein Zugriff, 1 = ok
+	void (*prepare)(uint32_t offset, uint32_t size);     // ungemessen davor, darf NULL sein
+	uint8_t (*sync)(void);                               // gemessen nach dem Durchlauf, darf NULL sein
+	uint32_t span;                                       // Adressbereich in Bytes
+	uint8_t random;
+} StorageBench_Test;
+
+// DMA target for SDMMC (IDMA) and OCTOSPI, one cache line aligned
+static uint8_t StorageBench_Buffer[STORAGE_BENCH_MAX_BLOCK] __attribute__((aligned(32)));
+static uint32_t StorageBench_Seed;
+
+static FIL StorageBench_File;
+static BYTE StorageBench_Drive;
+static DWORD StorageBench_StartSector;
+
+static void StorageBench_Sd(void);
+static void StorageBench_Flash(void);
+static void StorageBench_FlashErase(void);
+static void StorageBench_Pass(const StorageBench_Test *test);
+static uint32_t StorageBench_Random(void);
+
+static uint8_t StorageBench_SdRead(uint32_t offset, uint32_t size);
+static uint8_t StorageBench_SdWrite(uint32_t offset, uint32_t size);
+static uint8_t StorageBench_SdSync(void);
+static uint8_t StorageBench_FatRead(uint32_t offset, uint32_t size);
+static uint8_t StorageBench_FatWrite(uint32_t offset, uint32_t size);
+static uint8_t StorageBench_FatSync(void);
+static uint8_t StorageBench_FlashRead(uint32_t offset, uint32_t size);
+static uint8_t StorageBench_FlashFast(uint32_t offset, uint32_t size);
+static uint8_t StorageBench_FlashQuad(uint32_t offset, uint32_t size);
+static uint8_t StorageBench_FlashMapped(uint32_t offset, uint32_t size);
+static void StorageBench_FlashInvalidate(uint32_t offset, uint32_t size);
+
+static const StorageBench_Test StorageBench_SdTests[] = {
+	{ "sd_read_seq",    StorageBench_SdRead,   NULL, NULL,                STORAGE_BENCH_FILE_SIZE, 0 },
+	{ "sd_read_rand",   StorageBench_SdRead,   NULL, NULL,                STORAGE_BENCH_FILE_SIZE, 1 },
+	{ "sd_write_seq",   StorageBench_SdWrite,  NULL, StorageBench_SdSync,  STORAGE_BENCH_FILE_SIZE, 0 },
+	{ "sd_write_rand",  StorageBench_SdWrite,  NULL, StorageBench_SdSync,  STORAGE_BENCH_FILE_SIZE, 1 },
+	{ "fat_read_seq",   StorageBench_FatRead,  NULL, NULL,                STORAGE_BENCH_FILE_SIZE, 0 },
+	{ "fat_read_rand",  StorageBench_FatRead,  NULL, NULL,                STORAGE_BENCH_FILE_SIZE, 1 },
+	{ "fat_write_seq",  StorageBench_FatWrite, NULL, StorageBench_FatSync, STORAGE_BENCH_FILE_SIZE, 0 },
+	{ "fat_write_rand", StorageBench_FatWrite, NULL, StorageBench_FatSync, STORAGE_BENCH_FILE_SIZE, 1 },
+};
+
+static const StorageBench_Test StorageBench_FlashTests[] = {
+	{ "flash_read_seq",  StorageBench_FlashRead, NULL, NULL, STORAGE_BENCH_FLASH_SPAN, 0 },
+	{ "flash_read_rand", StorageBench_FlashRead, NULL, NULL, STORAGE_BENCH_FLASH_SPAN, 1 },
+	{ "flash_fast_seq",  StorageBench_FlashFast, NULL, NULL, STORAGE_BENCH_FLASH_SPAN, 0 },
+	{ "flash_fast_rand", StorageBench_FlashFast, NULL, NULL, STORAGE_BENCH_FLASH_SPAN, 1 },
+	{ "flash_quad_seq",  StorageBench_FlashQuad, NULL, NULL, STORAGE_BENCH_FLASH_SPAN, 0 },
+	{ "flash_quad_rand", StorageBench_FlashQuad, NULL, NULL, STORAGE_BENCH_FLASH_SPAN, 1 },
+};
+
+static const StorageBench_Test StorageBench_MappedTests[] = {
+	{ "flash_mapped_seq",  StorageBench_FlashMapped, StorageBench_FlashInvalidate, NULL, STORAGE_BENCH_FLASH_SPAN, 0 },
+	{ "flash_mapped_rand", StorageBench_FlashMapped, StorageBench_FlashInvalidate, NULL, STORAGE_BENCH_FLASH_SPAN, 1 },
+};
+
+/**
+ * @brief  Führt alle Tests aus und gibt sie als CSV über printf aus
+ */
+void StorageBench_Run(void) {
+	for (uint32_t i = 0; i < sizeof(StorageBench_Buffer); i++)
+		StorageBench_Buffer[i] = (uint8_t)(i * 7U + (i >> 8));
+
+	Bench_Begin("storage");
+	StorageBench_Sd();
+	StorageBench_Flash();
+	Bench_End();
+}
+
+/* ------------------------------------------ SD-Karte ------------------------------------------ */
+
+static void StorageBench_Sd(void) {
+	char note[48];
+	FATFS *fs = SDCard_Acquire();
+
+	if (fs == NULL) {
+		Bench_Note("sd skipped, no SD card");
+		return;
+	}
+
+	FRESULT res = f_open(&StorageBench_File, STORAGE_BENCH_FILE, FA_CREATE_ALWAYS | FA_READ | FA_WRITE);
+	if (res == FR_OK) {
+		// Contiguous, so the raw tests can address the file by LBA
+		res = f_expand(&StorageBench_File, STORAGE_BENCH_FILE_SIZE, 1);
+		if (res != FR_OK) f_close(&StorageBench_File);
+	}
+	if (res != FR_OK) {
+		SDCard_CheckResult(res);
+		SDCard_Release();
+		snprintf(note, sizeof(note), "sd skipped, FatFs error %d", res);
+		Bench_Note(note);
+		return;
+	}
+
+	StorageBench_StartSector = fs->database + (StorageBench_File.obj.sclust - 2) * fs->csize;
+	StorageBench_Drive = fs->drv;
+	snprintf(note, sizeof(note), "sd file at LBA %lu", (uint32_t)StorageBench_StartSector);
+	Bench_Note(note);
+
+	for (uint8_t i = 0; i < sizeof(StorageBench_SdTests) / sizeof(StorageBench_SdTests[0]); i++)
+		StorageBench_Pass(&StorageBench_SdTests[i]);
+
+	f_close(&StorageBench_File);
+	f_unlink(STORAGE_BENCH_FILE);
+	SDCard_Release();
+}
+
+static uint8_t StorageBench_SdRead(uint32_t offset, uint32_t size) {
+	return disk_read(StorageBench_Drive, StorageBench_Buffer, StorageBench_StartSector + offset / STORAGE_BENCH_SECTOR,
+			size / STORAGE_BENCH_SECTOR) == RES_OK;
+}
+
+static uint8_t StorageBench_SdWrite(uint32_t offset, uint32_t size) {
+	return disk_write(StorageBench_Drive, StorageBench_Buffer, StorageBench_StartSector + offset / STORAGE_BENCH_SECTOR,
+			size / STORAGE_BENCH_SECTOR) == RES_OK;
+}
+
+static uint8_t StorageBench_SdSync(void) {
+	return disk_ioctl(StorageBench_Drive, CTRL_SYNC, NULL) == RES_OK;
+}
+
+static uint8_t StorageBench_FatRead(uint32_t offset, uint32_t size) {
+	UINT done = 0;
+
+	if (f_lseek(&StorageBench_File, offset) != FR_OK) return 0;
+	return f_read(&StorageBench_File, StorageBench_Buffer, size, &done) == FR_OK && done == size;
+}
+
+static uint8_t StorageBench_FatWrite(uint32_t offset, uint32_t size) {
+	UINT done = 0;
+
+	if (f_lseek(&StorageBench_File, offset) != FR_OK) return 0;
+	return f_write(&StorageBench_File, StorageBench_Buffer, size, &done) == FR_OK && done == size;
+}
+
+static uint8_t StorageBench_FatSync(void) {
+	return f_sync(&StorageBench_File) == FR_OK;
+}
+
+/* ------------------------------------------- W25Qxx ------------------------------------------- */
+
+static void StorageBench_Flash(void) {
+	uint8_t wasMapped = W25Qxx_IsMemoryMapped();
+
+	W25Qxx_DisableMemoryMapped();
+	for (uint8_t i = 0; i < sizeof(StorageBench_FlashTests) / sizeof(StorageBench_FlashTests[0]); i++)
+		StorageBench_Pass(&StorageBench_FlashTests[i]);
+
+	if (W25Qxx_EnableMemoryMapped()) {
+		for (uint8_t i = 0; i < sizeof(StorageBench_MappedTests) / sizeof(StorageBench_MappedTests[0]); i++)
+			StorageBench_Pass(&StorageBench_MappedTests[i]);
+		W25Qxx_DisableMemoryMapped();
+	}
+	else {
+		Bench_Note("flash_mapped skipped, memory-mapped mode failed");
+	}
+
+	StorageBench_FlashErase();
+	// The mapped tests may have cached the scratch block before it was erased
+	SCB_InvalidateDCache_by_Addr((uint32_t*)W25Qxx_MappedAddress(STORAGE_BENCH_FLASH_SCRATCH), 0x10000);
+
+	if (wasMapped)
+		W25Qxx_EnableMemoryMapped();
+}
+
+static void StorageBench_FlashErase(void) {
+	Asset_Header header;
+	Bench_Timer timer;
+
+	// Do not touch the scratch block if the asset bundle reaches into it
+	W25Qxx_ReadData(ASSET_BUNDLE_ADDRESS, (uint8_t*)&header, sizeof(header));
+	if (header.magic == ASSET_MAGIC && ASSET_BUNDLE_ADDRESS + header.size > STORAGE_BENCH_FLASH_SCRATCH) {
+		Bench_Note("erase skipped, asset bundle uses the scratch block");
+		return;
+	}
+
+	Bench_Reset(&timer);
+	for (uint8_t i = 0; i < STORAGE_BENCH_ERASE_REPS; i++) {
+		Bench_Start(&timer);
+		W25Qxx_WriteEnable();
+		W25Qxx_EraseBlock64K(STORAGE_BENCH_FLASH_SCRATCH);
+		Bench_Stop(&timer);
+	}
+	Bench_Report("erase_block64", 0x10000UL, &timer, 0x10000UL, 0x10000UL);
+
+	// The first 16 KB get programmed and are erased again sector by sector below
+	Bench_Reset(&timer);
+	for (uint32_t page = 0; page < STORAGE_BENCH_PAGES; page++) {
+		Bench_Start(&timer);
+		W25Qxx_WriteEnable();
+		W25Qxx_PageProgram(STORAGE_BENCH_FLASH_SCRATCH + page * STORAGE_BENCH_PAGE,
+				&StorageBench_Buffer[page * STORAGE_BENCH_PAGE], STORAGE_BENCH_PAGE);
+		Bench_Stop(&timer);
+	}
+	Bench_Report("page_program", STORAGE_BENCH_PAGE, &timer, STORAGE_BENCH_PAGE, STORAGE_BENCH_PAGE);
+
+	Bench_Reset(&timer);
+	for (uint32_t sector = 0; sector < STORAGE_BENCH_PAGES * STORAGE_BENCH_PAGE / 4096UL; sector++) {
+		Bench_Start(&timer);
+		W25Qxx_WriteEnable();
+		W25Qxx_EraseSector(STORAGE_BENCH_FLASH_SCRATCH + sector * 4096UL);
+		Bench_Stop(&timer);
+	}
+	Bench_Report("erase_sector", 4096UL, &timer, 4096UL, 4096UL);
+
+	Bench_Reset(&timer);
+	for (uint8_t i = 0; i < STORAGE_BENCH_ERASE_REPS; i++) {
+		Bench_Start(&timer);
+		W25Qxx_WriteEnable();
+		W25Qxx_EraseBlock32K(STORAGE_BENCH_FLASH_SCRATCH + 0x8000UL);
+		Bench_Stop(&timer);
+	}
+	Bench_Report("erase_block32", 0x8000UL, &timer, 0x8000UL, 0x8000UL);
+}
+
+static uint8_t StorageBench_FlashRead(uint32_t offset, uint32_t size) {
+	W25Qxx_ReadData(STORAGE_BENCH_FLASH_READ + offset, StorageBench_Buffer, size);
+	return 1;
+}
+
+static uint8_t StorageBench_FlashFast(uint32_t offset, uint32_t size) {
+	W25Qxx_FastReadData(STORAGE_BENCH_FLASH_READ + offset, StorageBench_Buffer, size);
+	return 1;
+}
+
+static uint8_t StorageBench_FlashQuad(uint32_t offset, uint32_t size) {
+	W25Qxx_FastReadQuadOutput(STORAGE_BENCH_FLASH_READ + offset, StorageBench_Buffer, size);
+	return 1;
+}
+
+static uint8_t StorageBench_FlashMapped(uint32_t offset, uint32_t size) {
+	memcpy(StorageBench_Buffer, W25Qxx_MappedAddress(STORAGE_BENCH_FLASH_READ + offset), size);
+	return 1;
+}
+
+/**
+ * @brief  Verwirft die Cache-Zeilen eines Bereichs im Memory-Mapped-Fenster (nur lesbar, nichts geht verloren)
+ */
+static void StorageBench_FlashInvalidate(uint32_t offset, uint32_t size) {
+	uint32_t start = (uint32_t)W25Qxx_MappedAddress(STORAGE_BENCH_FLASH_READ + offset) & ~31UL;
+	uint32_t end = (uint32_t)W25Qxx_MappedAddress(STORAGE_BENCH_FLASH_READ + offset) + size;
+
+	SCB_InvalidateDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+}
+
+/* ------------------------------------------ Ablauf ------------------------------------------ */
+
+/**
+ * @brief  Führt einen Test für alle Blockgrößen aus, eine CSV-Zeile je Blockgröße (und je *_sync)
+ */
+static void StorageBench_Pass(const StorageBench_Test *test) {
+	char name[32];
+	Bench_Timer timer;
+
+	for (uint32_t block = STORAGE_BENCH_MIN_BLOCK; block <= STORAGE_BENCH_MAX_BLOCK; block <<= 1) {
+		uint32_t reps = test->random ? STORAGE_BENCH_RANDOM_OPS : STORAGE_BENCH_SEQ_BYTES / block;
+		uint32_t blocks = test->span / block;
+		uint8_t ok = 1;
+
+		StorageBench_Seed = 1;
+		Bench_Reset(&timer);
+		for (uint32_t i = 0; i < reps && ok; i++) {
+			uint32_t offset = (test->random ? StorageBench_Random() % blocks : i % blocks) * block;
+
+			if (test->prepare != NULL)
+				test->prepare(offset, block);
+
+			Bench_Start(&timer);
+			ok = test->run(offset, block);
+			Bench_Stop(&timer);
+		}
+
+		if (!ok) {
+			snprintf(name, sizeof(name), "%s failed at %lu", test->name, block);
+			Bench_Note(name);
+			return;
+		}
+		Bench_Report(test->name, block, &timer, block, block);
+
+		if (test->sync != NULL) {
+			snprintf(name, sizeof(name), "%s_sync", test->name);
+			Bench_Reset(&timer);
+			Bench_Start(&timer);
+			ok = test->sync();
+			Bench_Stop(&timer);
+			if (ok)
+				Bench_Report(name, block, &timer, 0, 0);
+		}
+	}
+}
+
+/**
+ * @brief  Pseudozufallszahl (LCG aus Numerical Recipes), die oberen Bits streuen am besten
+ */
+static uint32_t StorageBench_Random(void) {
+	StorageBench_Seed = StorageBench_Seed * 1664525UL + 1013904223UL;
+	return StorageBench_Seed >> 8;
+}
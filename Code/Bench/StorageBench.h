@@ -0,0 +1,34 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef BENCH_STORAGEBENCH_H_
+#define BENCH_STORAGEBENCH_H_
+
+#include "main.h"
+
+/* Blockgrößen: 512 B bis STORAGE_BENCH_MAX_BLOCK, jeweils verdoppelt */
+#define STORAGE_BENCH_MIN_BLOCK     512UL
+#define STORAGE_BENCH_MAX_BLOCK     (64UL * 1024UL)
+
+/* Testdatei auf der SD-Karte, zusammenhängend belegt; nur in ihr wird auch roh geschrieben */
+#define STORAGE_BENCH_FILE          "bench.dat"
+#define STORAGE_BENCH_FILE_SIZE     (1024UL * 1024UL)
+
+/* Bytes je sequentiellem Durchlauf und Zugriffe je zufälligem Durchlauf */
+#define STORAGE_BENCH_SEQ_BYTES     (256UL * 1024UL)
+#define STORAGE_BENCH_RANDOM_OPS    32
+
+/* Lesebereich im W25Qxx (Inhalt beliebig) */
+#define STORAGE_BENCH_FLASH_READ    0x00000000UL
+#define STORAGE_BENCH_FLASH_SPAN    (4UL * 1024UL * 1024UL)
+
+/* Zum Löschen und Programmieren: der letzte 64-KB-Block des Asset-Bereichs,
+ * übersprungen, wenn das Bundle bis dorthin reicht */
+#define STORAGE_BENCH_FLASH_SCRATCH (ASSET_BUNDLE_ADDRESS + ASSET_BUNDLE_MAX_SIZE - 0x10000UL)
+#define STORAGE_BENCH_ERASE_REPS    3
+#define STORAGE_BENCH_PAGES         64
+
+void StorageBench_Run(void);
+
+#endif /* BENCH_STORAGEBENCH_H_ */
@@ -35,6 +35,80 @@ extern "C" {
 extern ADC_HandleTypeDef hadc1;
 
 /* USER CODE BEGIN Private defines */
+/* Potis VR1-VR4 an ADC1, Rank 1-4 */
+#define ADC_POTI_COUNT            4
+
+/* Scans pro Sekunde; jeder Scan wandelt alle Potis mit 16-facher Überabtastung */
+#define ADC_SCAN_HZ               1000
+
+/*
+ * Totband der Potis (von 65535): UpdatePotiValues() übernimmt einen Wert erst, wenn er sich
+ * um mehr als das bewegt hat, und meldet ihn dann als geändert. Rauschen löst so nichts aus.
+ */
+#define ADC_POTI_HYSTERESIS       256
+
+/* Abstand, in dem der TIM7-Tick die Potis prüft und bewegte als TOPIC_POTI veröffentlicht */
+#define ADC_POTI_PUBLISH_MS       10
+
+/* Zählertakt von TIM3, dem Trigger von ADC1 */
+#define ADC_TRIGGER_COUNTER_HZ    1000000UL
+
+/* Messbetrieb: Werte je Hälfte des Ping-Pong-Puffers (gesamt 2 x 2 KB in RAM_CD) */
+#define ADC_ACQ_HALF_SAMPLES      1024
+
+/* Plätze in der Wandlungssequenz von ADC1 (Hardware: höchstens 16 Ranks) */
+#define ADC_ACQ_MAX_SLOTS         16
+
+/* Empfänger von Messblöcken (Datenlogger, FFT, ..., Pipe_AttachAdc()) */
+#define ADC_ACQ_MAX_LISTENERS     6
+
+/* Wandlungen pro Sekunde, die ADC1 bei 8,5 Zyklen Abtastzeit sicher schafft (inkl. Überabtastung) */
+#define ADC_ACQ_MAX_CONVERSIONS_HZ 200000UL
+
+/**
+ * @brief Einstellungen des Messbetriebs
+ *
+ * Ein Kanal mit weight n steht n-mal gleichmäßig verteilt in jedem Scan und wird damit mit
+ * scanHz * n abgetastet; weight 0 schaltet ihn ab. Die Summe der Gewichte ist die Zahl der
+ * Slots je Scan (höchstens ADC_ACQ_MAX_SLOTS).
+ */
+typedef struct {
+  uint32_t scanHz;                       // Scans pro Sekunde (TIM3-Trigger)
+  uint8_t weight[ADC_POTI_COUNT];        // Abtastungen je Scan pro Poti
+  uint16_t oversampling;                 // Zweierpotenz 1-1024, Ergebnis bleibt 16 Bit
+} ADC_AcqConfig;
+
+/**
+ * @brief Ein fertiger Block im DMA-Puffer, Werte scanweise verschränkt
+ *
+ * Wert k von Scan s liegt bei data[s * slots + k] und gehört zu Poti slotChannel[k].
+ * Die Daten bleiben gültig, bis die DMA diese Hälfte wieder füllt (scans / scanHz),
+ * bzw. bis ADC_ReleaseBlock(), wenn der Empfänger den Block behalten hat.
+ */
+typedef struct {
+  const uint16_t *data;
+  uint16_t scans;
+  uint8_t slots;
+  const uint8_t *slotChannel;
+  uint8_t half;                          // 0 oder 1
+  uint32_t sequence;                     // laufende Blocknummer
+} ADC_Block;
+
+/**
+ * @brief Empfänger eines Blocks, wird im DMA-Interrupt aufgerufen
+ * @retval 1 = Block wird noch gebraucht (später ADC_ReleaseBlock()), 0 = fertig
+ */
+typedef uint8_t (*ADC_BlockCallback)(const ADC_Block *block, void *context);
+
+/**
+ * @brief Zähler des Messbetriebs
+ */
+typedef struct {
+  uint32_t blocks;                       // ausgelieferte Blöcke
+  uint32_t drops;                        // Blöcke verworfen, weil ihre Hälfte noch gehalten wurde
+  uint32_t overruns;                     // DMA hat eine noch gehaltene Hälfte überschrieben
+  uint32_t errors;                       // DMA- bzw. ADC-Fehler
+} ADC_AcqStats;
 
 /* USER CODE END Private defines */
 
@@ -46,7 +120,21 @@ extern uint16_t Poti2Value;
 extern uint16_t Poti3Value;
 extern uint16_t Poti4Value;
 
-uint16_t UpdatePotiValues();
+extern volatile uint16_t ADC_PotiBuffer[ADC_POTI_COUNT];
+
+uint8_t ADC_Start(void);
+uint8_t ADC_StartAcquisition(const ADC_AcqConfig *config);
+uint8_t ADC_StopAcquisition(void);
+uint8_t ADC_IsAcquiring(void);
+uint32_t ADC_GetChannelRate(uint8_t channel);
+uint8_t ADC_AddBlockListener(ADC_BlockCallback callback, void *context);
+void ADC_ReleaseBlock(const ADC_Block *block);
+const ADC_AcqStats* ADC_GetAcqStats(void);
+void ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc);
+void ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
+void ADC_ErrorCallback(ADC_HandleTypeDef *hadc);
+uint8_t UpdatePotiValues(void);
+void ADC_PublishPoti(void);
 uint16_t GetPoti1Reading();
 uint16_t GetPoti2Reading();
 uint16_t GetPoti3Reading();
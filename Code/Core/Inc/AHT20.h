@@ -10,8 +10,69 @@
 
 #include "main.h"
 
+/* Wartezeiten laut Datenblatt in ms */
+#define AHT20_CALIBRATION_MS    10      // nach dem Initialisierungsbefehl 0xBE
+#define AHT20_MEASUREMENT_MS    80      // typische Messdauer nach 0xAC
+#define AHT20_RETRY_MS          5       // erneutes Lesen, solange das Busy-Bit gesetzt ist
 
+/* Höchste I2C-Geschwindigkeit laut Datenblatt */
+#define AHT20_I2C_MAX_HZ        400000U
 
-void AHT20_Read(float* Temp, float* Humid);
+/* Abbruch einer Messung, die nach dieser Zeit noch nicht fertig ist */
+#define AHT20_TIMEOUT_MS        250
+
+/* Periode des AHT20-Tasks nur für den Timeout; Transfers und Wartezeiten geben ihn selbst frei */
+#define AHT20_TASK_MS           50
+
+/* Filter: Median über die letzten AHT20_MEDIAN_SIZE Messungen (ungerade, höchstens 7), danach EMA mit 1/2^AHT20_EMA_SHIFT */
+#define AHT20_MEDIAN_SIZE       3
+#define AHT20_EMA_SHIFT         2
+
+/**
+ * @brief Wird aus AHT20_Service() aufgerufen, sobald ein neuer Messwert vorliegt (gefiltert)
+ * @param centiCelsius  Temperatur in 0,01 °C
+ * @param centiPercent  Luftfeuchtigkeit in 0,01 % rF
+ */
+typedef void (*AHT20_Callback)(int16_t centiCelsius, uint16_t centiPercent);
+
+/**
+ * @brief Schritte der Messung (AHT20_CurrentState, zur Fehlersuche)
+ */
+typedef enum {
+	AHT20_STATE_IDLE = 0,
+	AHT20_STATE_STATUS,            // Statusbyte wird gelesen (Kalibrierung prüfen)
+	AHT20_STATE_CALIBRATE,         // Initialisierungsbefehl wird gesendet
+	AHT20_STATE_CALIBRATE_WAIT,
+	AHT20_STATE_TRIGGER,           // Messbefehl wird gesendet
+	AHT20_STATE_MEASURE_WAIT,
+	AHT20_STATE_READ               // Status, Messwerte und CRC werden gelesen
+} AHT20_State;
+
+void AHT20_Init(uint8_t taskId);
+uint8_t AHT20_StartMeasurement(void);
+void AHT20_Service(void);
+uint8_t AHT20_IsBusy(void);
+uint8_t AHT20_GetLatest(float* Temp, float* Humid);
+uint8_t AHT20_GetLatestCenti(int16_t *centiCelsius, uint16_t *centiPercent);
+uint8_t AHT20_GetFiltered(int16_t *centiCelsius, uint16_t *centiPercent);
+void AHT20_SetCallback(AHT20_Callback callback);
+
+/**
+ * @brief 20-Bit-Rohwert der Temperatur in 0,01 °C: t20 / 2^20 * 200 - 50 °C
+ *
+ * 20000 / 2^20 = 625 / 2^15, das Produkt bleibt unter 2^30. Gerundet, ohne Division.
+ */
+static inline int16_t AHT20_RawToCentiCelsius(uint32_t t20) {
+	return (int16_t)((int32_t)((t20 * 625U + (1U << 14)) >> 15) - 5000);
+}
+
+/**
+ * @brief 20-Bit-Rohwert der Luftfeuchtigkeit in 0,01 % rF: h20 / 2^20 * 100 %
+ *
+ * 10000 / 2^20 = 625 / 2^16.
+ */
+static inline uint16_t AHT20_RawToCentiPercent(uint32_t h20) {
+	return (uint16_t)((h20 * 625U + (1U << 15)) >> 16);
+}
 
 #endif /* INC_AHT20_H_ */
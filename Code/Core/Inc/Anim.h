@@ -0,0 +1,94 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ANIM_H_
+#define INC_ANIM_H_
+
+#include "main.h"
+
+/* Kennung und Formatversion einer Animation (muss zu Tools/anim_pack.py passen) */
+#define ANIM_MAGIC               0x31494E41UL   // "ANI1"
+#define ANIM_VERSION             1
+
+/* Anim_Header.flags */
+#define ANIM_FLAG_LOOP           0x0001         // Standard des Packers: am Ende wieder mit Bild 0 beginnen
+
+/* Anim_Frame.flags */
+#define ANIM_FRAME_KEY           0x01           // Bereich ist die ganze Animation, hängt von keinem Vorgänger ab
+
+/* Einträge der Bildtabelle, die auf einmal von der SD-Karte gelesen werden (20 Bytes je Eintrag) */
+#define ANIM_TABLE_WINDOW        32
+
+/* Rückfallperiode des Tasks; während der Wiedergabe legt er seine nächste Freigabe selbst fest */
+#define ANIM_TASK_MS             100
+
+/* Hinkt die Wiedergabe weiter hinterher (z.B. nach einem langen Shell-Befehl), beginnt die Zeitrechnung neu */
+#define ANIM_RESYNC_FRAMES       16
+
+/**
+ * @brief Inhalt eines Einzelbildes
+ */
+typedef enum {
+	ANIM_FORMAT_SAME = 0,        // keine Änderung gegenüber dem Vorgänger, keine Daten
+	ANIM_FORMAT_RGB565 = 1,      // Bereich als RGB565, High-Byte zuerst, zeilenweise
+	ANIM_FORMAT_CIMG = 2         // Bereich als komprimiertes Bild (ILI9341_ImageHeader, RLE oder LZ4)
+} Anim_Format;
+
+/**
+ * @brief Kopf am Anfang der Animation (32 Bytes, Little Endian)
+ */
+typedef struct {
+	uint32_t magic;              // ANIM_MAGIC
+	uint16_t version;            // ANIM_VERSION
+	uint16_t flags;              // ANIM_FLAG_*
+	uint16_t width;              // Größe der Animation in Pixeln
+	uint16_t height;
+	uint32_t frameCount;
+	uint32_t frameUs;            // Abstand der Bilder in µs (33333 = 30 Bilder/s)
+	uint32_t tableOffset;        // Bildtabelle relativ zum Anfang der Animation
+	uint32_t size;               // Gesamtgröße in Bytes
+	uint32_t reserved;
+} Anim_Header;
+
+/**
+ * @brief Eintrag der Bildtabelle (20 Bytes), frameCount Einträge ab tableOffset
+ */
+typedef struct {
+	uint32_t offset;             // Daten relativ zum Anfang der Animation
+	uint32_t size;               // Länge der Daten in Bytes
+	uint16_t x, y;               // geänderter Bereich relativ zur Animation
+	uint16_t width, height;
+	uint8_t format;              // Anim_Format
+	uint8_t flags;               // ANIM_FRAME_*
+	uint16_t reserved;
+} Anim_Frame;
+
+/**
+ * @brief Zähler der laufenden bzw. letzten Wiedergabe ('anim stat' in der Shell)
+ */
+typedef struct {
+	uint32_t frames;             // gezeichnete Bilder
+	uint32_t dropped;            // übersprungen, um die Bildrate zu halten (bis zum nächsten Schlüsselbild)
+	uint32_t late;               // mehr als eine Periode zu spät gezeichnet, weil kein Schlüsselbild erreichbar war
+	uint32_t loops;
+	uint32_t resyncs;            // Zeitrechnung neu begonnen (ANIM_RESYNC_FRAMES)
+	uint32_t errors;             // Lese- oder Dekodierfehler, die Wiedergabe endet
+	uint64_t bytes;              // Bilddaten aus Datei bzw. Flash
+	uint32_t lastFrameUs;        // Lesen und Senden des letzten Bildes
+	uint32_t maxFrameUs;
+	uint32_t maxLateUs;          // größter Abstand zwischen Soll und Beginn eines Bildes
+	uint64_t sumFrameUs;
+} Anim_Stats;
+
+void Anim_Init(uint8_t taskId);
+uint8_t Anim_PlayFile(const char *path, uint16_t x, uint16_t y, uint8_t loop);
+uint8_t Anim_PlayMemory(const uint8_t *data, uint32_t size, uint16_t x, uint16_t y, uint8_t loop);
+uint8_t Anim_PlayAsset(const char *name, uint16_t x, uint16_t y, uint8_t loop);
+void Anim_Stop(void);
+uint8_t Anim_IsPlaying(void);
+const Anim_Stats* Anim_GetStats(void);
+void Anim_Task(void *context);
+void Anim_Dump(void);
+
+#endif /* INC_ANIM_H_ */
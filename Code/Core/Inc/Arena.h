@@ -0,0 +1,41 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ARENA_H_
+#define INC_ARENA_H_
+
+#include "main.h"
+
+/* Größe der Frame-Arena im AXI-SRAM (JPEG-Dekoder: 2 x 4 KB Eingang + 2 x 8 KB MCU-Zeilen + FIL) */
+#define ARENA_FRAME_SIZE      (28UL * 1024UL)
+
+/* Ausrichtung, wenn Arena_Alloc() mit align 0 gerufen wird */
+#define ARENA_DEFAULT_ALIGN   8
+
+/**
+ * @brief Bump-Allokator über einen festen Speicherbereich
+ */
+typedef struct {
+	uint8_t *base;
+	uint32_t size;
+	uint32_t used;              // Belegte Bytes ab base
+	uint32_t peak;              // Höchststand von used
+	uint32_t failures;          // Arena_Alloc() ohne ausreichenden Platz
+} Arena;
+
+/**
+ * @brief Füllstand, zu dem Arena_Release() zurückkehrt
+ */
+typedef uint32_t Arena_Mark;
+
+/* Frame-Arena: Task_UI leert sie am Ende jedes Bildes, Dekoder geben ihren Teil je Datei zurück */
+extern Arena Arena_Frame;
+
+void Arena_Init(Arena *arena, void *memory, uint32_t size);
+void* Arena_Alloc(Arena *arena, uint32_t size, uint32_t align);
+Arena_Mark Arena_GetMark(const Arena *arena);
+void Arena_Release(Arena *arena, Arena_Mark mark);
+void Arena_Reset(Arena *arena);
+
+#endif /* INC_ARENA_H_ */
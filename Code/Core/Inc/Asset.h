@@ -0,0 +1,155 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ASSET_H_
+#define INC_ASSET_H_
+
+#include "main.h"
+#include "ILI9341_Sprite.h"
+#include "Fonts/gfxfont.h"
+
+/* Bereich des Asset-Bundles im W25Qxx: die ersten 4 MB, das FatFs-Laufwerk folgt danach */
+#define ASSET_BUNDLE_ADDRESS     0x00000000UL
+#define ASSET_BUNDLE_MAX_SIZE    (4UL * 1024UL * 1024UL)
+
+/* Kennung und Formatversion des Bundles (muss zu Tools/asset_pack.py passen) */
+#define ASSET_MAGIC              0x31425341UL   // "ASB1"
+#define ASSET_VERSION            2
+
+/* Kennung eines Font-Assets (Tools/font_atlas.py) */
+#define ASSET_FONT_MAGIC         0x33544E46UL   // "FNT3"
+
+/* Kennung eines Atlas-Assets (Tools/atlas_pack.py) */
+#define ASSET_ATLAS_MAGIC        0x314C5441UL   // "ATL1"
+
+/* Ausrichtung der Nutzdaten im Bundle (Cache-Zeile, DMA-tauglich) */
+#define ASSET_ALIGNMENT          32
+
+/* Größte Anzahl Index-Einträge; für jeden merkt sich Asset.c das Ergebnis der CRC-Prüfung */
+#define ASSET_MAX_ENTRIES        256
+
+/**
+ * @brief Art eines Assets
+ */
+typedef enum {
+	ASSET_TYPE_RAW = 0,     // Beliebige Bytes
+	ASSET_TYPE_RGB565 = 1,  // Bild, RGB565 High-Byte zuerst (wie ILI9341_DrawImage)
+	ASSET_TYPE_FONT = 2,    // Zeichensatz
+	ASSET_TYPE_TABLE = 3,   // Tabelle (z.B. Farbpaletten, Kennlinien)
+	ASSET_TYPE_IMAGE = 4,   // Komprimiertes Bild mit ILI9341_ImageHeader (RLE/LZ4)
+	ASSET_TYPE_JPEG = 5,    // JPEG-Datei für den Hardware-Codec (USE_JPEG_ENCODING)
+	ASSET_TYPE_SPRITE = 6,  // RGB565 wie ASSET_TYPE_RGB565, dahinter 1-Bit-Maske (siehe ILI9341_Sprite.h)
+	ASSET_TYPE_ANIM = 7,    // Animation mit Anim_Header (Tools/anim_pack.py, siehe Anim.h)
+	ASSET_TYPE_ATLAS = 8    // Symbole in RGB565-Streifen mit Asset_AtlasHeader (Tools/atlas_pack.py)
+} Asset_Type;
+
+/**
+ * @brief Kopf des Bundles am Anfang des Bereichs
+ */
+typedef struct {
+	uint32_t magic;         // ASSET_MAGIC
+	uint16_t version;       // ASSET_VERSION
+	uint16_t count;         // Anzahl der Index-Einträge
+	uint32_t size;          // Gesamtgröße des Bundles in Bytes
+	uint32_t indexCrc;      // CRC-32 über den Index
+} Asset_Header;
+
+/**
+ * @brief Eintrag des Index, direkt hinter dem Kopf, aufsteigend nach hash sortiert
+ */
+typedef struct {
+	uint32_t hash;          // FNV-1a des Namens
+	uint32_t offset;        // Beginn der Daten relativ zum Bundle, ASSET_ALIGNMENT-ausgerichtet
+	uint32_t size;          // Länge der Daten in Bytes
+	uint16_t width;         // Breite in Pixeln (nur Bilder)
+	uint16_t height;        // Höhe in Pixeln (nur Bilder)
+	uint8_t type;           // Asset_Type
+	uint8_t reserved[3];
+	uint32_t crc;           // CRC-32 der Daten (wie zlib.crc32)
+} Asset_Entry;
+
+/**
+ * @brief Kopf eines ASSET_TYPE_FONT-Assets, dahinter Glyphen-Index und Glyphen im ILI9341_t3-Format
+ *
+ * Die Felder ab version entsprechen denen von ILI9341_t3_font_t; Asset_LoadFont() setzt die
+ * Zeiger des Fonts auf Index und Glyphen im Memory-Mapped-Fenster.
+ */
+typedef struct {
+	uint32_t magic;         // ASSET_FONT_MAGIC
+	uint32_t indexOffset;   // Glyphen-Index relativ zum Asset, bits_index Bits je Zeichen
+	uint32_t dataOffset;    // Glyphen relativ zum Asset
+	uint8_t version;
+	uint8_t reserved;
+	uint8_t index1_first;
+	uint8_t index1_last;
+	uint8_t index2_first;
+	uint8_t index2_last;
+	uint8_t bits_index;
+	uint8_t bits_width;
+	uint8_t bits_height;
+	uint8_t bits_xoffset;
+	uint8_t bits_yoffset;
+	uint8_t bits_delta;
+	uint8_t line_space;
+	uint8_t cap_height;
+	uint8_t padding[2];
+} Asset_FontHeader;
+
+/**
+ * @brief Kopf eines ASSET_TYPE_ATLAS-Assets, dahinter die Streifen, die Rechtecke und die Pixel
+ *
+ * Jede Gruppe der Atlas-Liste ist ein Streifen: ihre Symbole stehen in Listenreihenfolge
+ * nebeneinander, Zeile für Zeile als RGB565 (High-Byte zuerst) mit der Streifenbreite als
+ * Zeilenlänge. Der ganze Streifen ist ein zusammenhängender Block.
+ */
+typedef struct {
+	uint32_t magic;         // ASSET_ATLAS_MAGIC
+	uint16_t count;         // Anzahl der Symbole (Asset_AtlasRect)
+	uint16_t strips;        // Anzahl der Streifen (Asset_AtlasStrip)
+	uint32_t stripOffset;   // Streifen relativ zum Asset
+	uint32_t rectOffset;    // Rechtecke relativ zum Asset, aufsteigend nach hash sortiert
+} Asset_AtlasHeader;
+
+typedef struct {
+	uint32_t offset;        // Pixel relativ zum Asset, ASSET_ALIGNMENT-ausgerichtet
+	uint16_t width;         // Zeilenlänge in Pixeln, Summe der Symbolbreiten
+	uint16_t height;        // Höhe des höchsten Symbols, darunter ist mit 0 aufgefüllt
+} Asset_AtlasStrip;
+
+typedef struct {
+	uint32_t hash;          // FNV-1a des Symbolnamens
+	uint16_t x;             // linke Spalte im Streifen
+	uint16_t width;
+	uint16_t height;
+	uint8_t strip;          // Index des Streifens
+	uint8_t reserved;
+} Asset_AtlasRect;
+
+/**
+ * @brief Geöffneter Atlas, von Asset_LoadAtlas() eingerichtet; alle Zeiger zeigen in das Fenster
+ */
+typedef struct {
+	const Asset_Entry *entry;
+	const uint8_t *data;
+	const Asset_AtlasStrip *strips;
+	const Asset_AtlasRect *rects;
+	uint16_t count;
+	uint16_t stripCount;
+} Asset_Atlas;
+
+uint8_t Asset_Init(void);
+uint32_t Asset_Hash(const char *name);
+const Asset_Entry* Asset_Lookup(const char *name);
+const uint8_t* Asset_Find(const char *name, const Asset_Entry **entry);
+uint8_t Asset_Verify(const Asset_Entry *entry);
+uint8_t Asset_DrawImage(const char *name, uint16_t x, uint16_t y);
+uint8_t Asset_DrawImageScaled(const char *name, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t flags);
+uint8_t Asset_LoadSprite(const char *name, ILI9341_Sprite *sprite);
+uint8_t Asset_LoadFont(const char *name, ILI9341_t3_font_t *font);
+uint8_t Asset_LoadAtlas(const char *name, Asset_Atlas *atlas);
+const Asset_AtlasRect* Asset_AtlasLookup(const Asset_Atlas *atlas, const char *name);
+uint8_t Asset_DrawAtlas(const Asset_Atlas *atlas, const char *name, int16_t x, int16_t y);
+uint8_t Asset_DrawAtlasRow(const Asset_Atlas *atlas, const char *const names[], uint8_t count, int16_t x, int16_t y);
+
+#endif /* INC_ASSET_H_ */
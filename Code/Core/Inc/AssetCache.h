@@ -0,0 +1,88 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ASSETCACHE_H_
+#define INC_ASSETCACHE_H_
+
+#include "main.h"
+#include "Asset.h"
+
+/* Speicher des Caches im AXI-SRAM; größere Assets (z.B. Vollbilder) werden weiter direkt gestreamt */
+#define ASSET_CACHE_SIZE          (128UL * 1024UL)
+
+/* Höchstzahl gleichzeitig gehaltener Assets */
+#define ASSET_CACHE_ENTRIES       24
+
+/* Angemeldete Bildschirme (AssetCache_AddScreen()) und Tiefe der Ladewarteschlange */
+#define ASSET_CACHE_MAX_SCREENS   8
+#define ASSET_CACHE_QUEUE         8
+
+/* Längster Dateipfad eines SD-Assets (wie ein Auftrag der SDQueue) */
+#define ASSET_CACHE_PATH_MAX      64
+
+/* Bytes je MDMA-Block aus dem Memory-Mapped-Fenster; ein Block je Durchlauf des Tasks */
+#define ASSET_CACHE_MDMA_BLOCK    32768UL
+
+/* Periode des Tasks in ms, er läuft mit der niedrigsten Priorität und nur, solange etwas zu laden ist */
+#define ASSET_CACHE_TASK_MS       5
+
+/* Über dieser CPU-Last (Promille, Scheduler_GetLoad()) lädt der Task nichts auf Verdacht */
+#define ASSET_CACHE_IDLE_LOAD     700
+
+/**
+ * @brief Gibt an, ob gerade ein DMA-Transfer aus dem Cache (z.B. Bild zum Display) laufen kann
+ */
+typedef uint8_t (*AssetCache_BusyFunction)(void);
+
+/**
+ * @brief Ein Asset, das ein Bildschirm zeichnet
+ *
+ * Namen mit '/' am Anfang oder Laufwerk ("0:/...") sind Dateien auf der SD-Karte, alle anderen
+ * Assets im Bundle (Asset.h).
+ */
+typedef struct {
+	const char *name;
+	uint32_t size;              // Nur Dateien: Länge in Bytes, bei rohem RGB565 Breite * Höhe * 2
+} AssetCache_Item;
+
+/**
+ * @brief Liste der Assets eines Bildschirms; Speicher gehört dem Aufrufer (statisch)
+ */
+typedef struct {
+	const char *name;
+	const AssetCache_Item *items;
+	uint8_t count;
+} AssetCache_Screen;
+
+/**
+ * @brief Zähler des Caches
+ */
+typedef struct {
+	uint32_t hits;              // Zugriffe aus dem RAM
+	uint32_t misses;            // Zugriffe auf nicht geladene Assets (danach nachgeladen)
+	uint32_t loads;             // Fertig geladene Assets
+	uint32_t speculative;       // davon auf Verdacht für angemeldete Bildschirme
+	uint32_t evictions;         // Verdrängte Assets
+	uint32_t failures;          // Lesefehler, falsche CRC, zu groß
+	uint32_t deferred;          // Durchläufe ohne Fortschritt (Fenster aus, Display liest, SDQueue voll)
+	uint32_t bytes;             // Geladene Bytes
+	uint32_t lastLoadUs;        // Dauer des letzten Ladevorgangs vom Start bis zur Prüfung
+	uint32_t maxLoadUs;
+} AssetCache_Stats;
+
+void AssetCache_Init(uint8_t taskId, AssetCache_BusyFunction busy);
+uint8_t AssetCache_AddScreen(const AssetCache_Screen *screen);
+void AssetCache_Prefetch(const AssetCache_Screen *screen);
+void AssetCache_Enter(const AssetCache_Screen *screen);
+const uint8_t* AssetCache_Get(const Asset_Entry *entry);
+const uint8_t* AssetCache_GetFile(const char *path, uint32_t size);
+uint8_t AssetCache_DrawFile(const char *path, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+void AssetCache_Clear(void);
+uint8_t AssetCache_IsBusy(void);
+void AssetCache_Task(void *context);
+const AssetCache_Stats* AssetCache_GetStats(void);
+void AssetCache_ResetStats(void);
+void AssetCache_Dump(void);
+
+#endif /* INC_ASSETCACHE_H_ */
@@ -0,0 +1,129 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ASYNC_H_
+#define INC_ASYNC_H_
+
+#include "main.h"
+#include "Scheduler.h"
+
+/* Rückfallperiode von Async_Spawn(); regulär geben Async_Notify() und AWAIT_MS den Task frei */
+#define ASYNC_POLL_MS             50
+
+/**
+ * @brief Rückgabe einer Coroutine an Async_Run()
+ */
+typedef enum {
+	ASYNC_WAITING = 0,             // an einem AWAIT_* unterbrochen
+	ASYNC_DONE                     // ASYNC_END bzw. ASYNC_EXIT erreicht
+} Async_Result;
+
+/**
+ * @brief Worauf eine Coroutine gerade wartet (für Async_Dump)
+ */
+typedef enum {
+	ASYNC_WAIT_NONE = 0,
+	ASYNC_WAIT_UNTIL,              // beliebige Bedingung, nur die Rückfallperiode weckt
+	ASYNC_WAIT_DMA,                // Ende eines Transfers, der Callback ruft Async_Notify()
+	ASYNC_WAIT_MS,                 // Wartezeit, Async_Run() legt die Freigabe auf ihr Ende
+	ASYNC_WAIT_FLAG,               // Flag aus einem Interrupt, der Async_Notify() ruft
+	ASYNC_WAIT_YIELD,              // freiwillig abgegeben, sofort wieder bereit
+	ASYNC_WAIT_KINDS
+} Async_Wait;
+
+typedef struct Async Async;
+
+/**
+ * @brief Rumpf einer Coroutine zwischen ASYNC_BEGIN und ASYNC_END
+ *
+ * Lokale Variablen überleben kein AWAIT_*: Zustand gehört in den Kontext oder in statische
+ * Variablen. Ein switch im Rumpf darf kein AWAIT_* enthalten (der Wartepunkt ist selbst ein case).
+ */
+typedef Async_Result (*Async_Function)(Async *self);
+
+/**
+ * @brief Stacklose Coroutine, Speicher gehört dem Aufrufer (statisch oder in einer Struktur)
+ */
+struct Async {
+	uint16_t resume;               // __LINE__ des letzten Wartepunkts, 0 = Anfang
+	uint8_t wait;                  // Async_Wait
+	uint8_t taskId;                // Task, den Async_Notify() freigibt
+	volatile uint8_t running;      // von Async_Start() bis ASYNC_END
+	uint8_t yielded;               // ASYNC_YIELD: erster Durchlauf des Wartepunkts
+	uint32_t untilMs;              // Ende von AWAIT_MS (HAL_GetTick)
+	const char *name;
+	Async_Function function;
+	void *context;
+	Async *next;                   // Liste für Async_Dump()
+
+	uint32_t starts;
+	uint32_t finished;
+	uint32_t resumes;              // Aufrufe des Rumpfs
+	uint32_t waits[ASYNC_WAIT_KINDS]; // Unterbrechungen je Art
+	uint64_t cycles;               // CPU-Takte im Rumpf insgesamt
+	uint32_t maxCycles;            // längster Abschnitt zwischen zwei Wartepunkten
+};
+
+/* Statische Vorbelegung, Async_Run() funktioniert damit auch ohne Async_Setup() */
+#define ASYNC_INITIALIZER(taskName, body, ctx) \
+	{ .taskId = SCHEDULER_INVALID_TASK, .name = (taskName), .function = (body), .context = (ctx) }
+
+/* --------------------------------- Rumpf --------------------------------- */
+
+#define ASYNC_BEGIN(a)            switch ((a)->resume) { case 0:
+#define ASYNC_END(a)              } (a)->resume = 0; return ASYNC_DONE
+#define ASYNC_EXIT(a)             do { (a)->resume = 0; return ASYNC_DONE; } while (0)
+
+/* Wartepunkt: beim Fortsetzen springt ASYNC_BEGIN direkt hinter die Zuweisung */
+#define ASYNC_POINT(a, kind)      (a)->wait = (kind); (a)->resume = __LINE__; __attribute__((fallthrough)); case __LINE__:
+
+#define ASYNC_AWAIT(a, kind, cond) \
+	do { \
+		ASYNC_POINT(a, kind) \
+		if (!(cond)) return ASYNC_WAITING; \
+		(a)->wait = ASYNC_WAIT_NONE; \
+	} while (0)
+
+/// Wartet, bis cond wahr ist; geprüft bei jeder Freigabe des Tasks
+#define AWAIT_UNTIL(a, cond)      ASYNC_AWAIT(a, ASYNC_WAIT_UNTIL, cond)
+
+/// Wartet, bis busy falsch ist; der Abschluss-Callback des Transfers ruft Async_Notify()
+#define AWAIT_DMA(a, busy)        ASYNC_AWAIT(a, ASYNC_WAIT_DMA, !(busy))
+
+/// Wartet, bis flag gesetzt ist, und löscht es; wer es setzt, ruft Async_Notify()
+#define AWAIT_FLAG(a, flag) \
+	do { \
+		ASYNC_AWAIT(a, ASYNC_WAIT_FLAG, (flag)); \
+		(flag) = 0; \
+	} while (0)
+
+/// Wartet ms Millisekunden, der Task schläft bis dahin
+#define AWAIT_MS(a, ms) \
+	do { \
+		(a)->untilMs = HAL_GetTick() + (ms); \
+		ASYNC_AWAIT(a, ASYNC_WAIT_MS, (int32_t)(HAL_GetTick() - (a)->untilMs) >= 0); \
+	} while (0)
+
+/// Gibt die CPU ab und läuft mit der nächsten Runde des Schedulers weiter
+#define ASYNC_YIELD(a) \
+	do { \
+		(a)->yielded = 1; \
+		ASYNC_POINT(a, ASYNC_WAIT_YIELD) \
+		if ((a)->yielded) { (a)->yielded = 0; return ASYNC_WAITING; } \
+		(a)->wait = ASYNC_WAIT_NONE; \
+	} while (0)
+
+/* --------------------------------- Steuerung --------------------------------- */
+
+void Async_Setup(Async *a, const char *name, Async_Function function, void *context, uint8_t taskId);
+uint8_t Async_Spawn(Async *a, const char *name, Async_Function function, void *context, uint8_t priority);
+uint8_t Async_Start(Async *a);
+void Async_Abort(Async *a);
+uint8_t Async_Run(Async *a);
+void Async_Notify(Async *a);
+uint8_t Async_IsRunning(const Async *a);
+void Async_ResetStats(void);
+void Async_Dump(void);
+
+#endif /* INC_ASYNC_H_ */
@@ -0,0 +1,58 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_BOOT_H_
+#define INC_BOOT_H_
+
+#include "main.h"
+
+/* Zeitstempel vom Reset bis zum Ende der Hintergrund-Initialisierung */
+#define BOOT_MAX_MARKS           24
+
+/* Initialisierungen, die erst nach dem Start des Schedulers laufen */
+#define BOOT_MAX_STAGES          8
+
+/**
+ * @brief Eine verschobene Initialisierung, liefert 1 bei Erfolg
+ */
+typedef uint8_t (*Boot_StageFunction)(void);
+
+/**
+ * @brief Ein Zeitstempel des Startvorgangs
+ */
+typedef struct {
+	const char *name;
+	uint32_t us;                // Seit Boot_Init()
+	uint32_t durationUs;        // Dauer des Abschnitts bzw. der Initialisierung
+	uint8_t failed;             // Verschobene Initialisierung ist fehlgeschlagen
+} Boot_Mark;
+
+/**
+ * @brief Kennzahlen des Startvorgangs, 0 solange der Punkt nicht erreicht ist
+ */
+typedef struct {
+	uint32_t firstPixelUs;      // Erstes Bild auf dem Display
+	uint32_t interactiveUs;     // Scheduler läuft, Eingaben werden bearbeitet
+	uint32_t completeUs;        // Alle verschobenen Initialisierungen fertig
+	uint8_t marks;
+	uint8_t pending;            // Noch nicht gelaufene Initialisierungen
+	uint8_t failed;             // Fehlgeschlagene Initialisierungen
+} Boot_Stats;
+
+void Boot_Init(void);
+void Boot_MarkPhase(const char *name);
+void Boot_FirstPixel(void);
+void Boot_Interactive(void);
+
+/* --------------------------------- Verschobene Initialisierung --------------------------------- */
+uint8_t Boot_Defer(const char *name, Boot_StageFunction function);
+void Boot_Start(uint8_t taskId);
+void Boot_Task(void *context);
+void Boot_RunDeferred(void);
+
+void Boot_GetStats(Boot_Stats *stats);
+const Boot_Mark* Boot_GetMark(uint8_t index);
+void Boot_Report(void);
+
+#endif /* INC_BOOT_H_ */
@@ -0,0 +1,35 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_BUSFAST_H_
+#define INC_BUSFAST_H_
+
+#include "main.h"
+#include "I2CBus.h"
+
+/* Kurze Befehlsschreibzugriffe direkt über die LL-Register statt über die HAL, 0 = immer HAL */
+#ifndef BUSFAST_ENABLE
+#define BUSFAST_ENABLE            1
+#endif
+
+/* Längste Übertragung (Frames bzw. Bytes) auf dem schnellen Weg, längere gehen an die HAL */
+#define BUSFAST_SPI_MAX_FRAMES    16
+#define BUSFAST_I2C_MAX_BYTES     16
+
+#if BUSFAST_ENABLE
+
+HAL_StatusTypeDef BusFast_SpiWrite(SPI_HandleTypeDef *hspi, const void *data, uint16_t count, uint32_t timeoutMs);
+HAL_StatusTypeDef BusFast_I2CMemWrite(I2CBus *bus, uint16_t address, uint8_t reg, const uint8_t *data,
+		uint16_t length, uint32_t timeoutMs);
+
+#else
+
+#define BusFast_SpiWrite(hspi, data, count, timeoutMs) \
+		HAL_SPI_Transmit((hspi), (uint8_t *)(data), (count), (timeoutMs))
+#define BusFast_I2CMemWrite(bus, address, reg, data, length, timeoutMs) \
+		HAL_I2C_Mem_Write((bus)->hi2c, (address), (reg), I2C_MEMADD_SIZE_8BIT, (uint8_t *)(data), (length), (timeoutMs))
+
+#endif /* BUSFAST_ENABLE */
+
+#endif /* INC_BUSFAST_H_ */
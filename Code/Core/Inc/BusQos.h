@@ -0,0 +1,51 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_BUSQOS_H_
+#define INC_BUSQOS_H_
+
+#include "main.h"
+
+/* Höchste QoS-Stufe eines Initiators (4 Bit), bei gleichzeitigen Zugriffen auf dasselbe Ziel gewinnt die höhere */
+#define BUSQOS_MAX                15
+
+/**
+ * @brief Initiatoren (ASIB) des AXI-Interconnects laut RM0455, Reihenfolge wie INI1 bis INI7 im GPV
+ *
+ * Neue Einträge auch in BusQos_Names und BusQos_Default (BusQos.c) ergänzen.
+ */
+typedef enum {
+	BUSQOS_INI_AHB = 0,       // INI1: Brücke der CD-AHB-Matrix, DMA1/DMA2 (SPI1-Display, ADC1, UARTs)
+	BUSQOS_INI_CPU,           // INI2: AXIM des Cortex-M7 (Cache-Zeilen, Schreibpuffer)
+	BUSQOS_INI_SDMMC1,        // INI3: IDMA der SD-Karte
+	BUSQOS_INI_MDMA,          // INI4: MDMA (Flash-Assets, W25Qxx-Programmierung, JPEG)
+	BUSQOS_INI_DMA2D,         // INI5: DMA2D (Framebuffer)
+	BUSQOS_INI_LTDC,          // INI6: LTDC, hier unbenutzt
+	BUSQOS_INI_AHB2,          // INI7: zweiter AHB-Eingang, hier ohne Master
+	BUSQOS_INI_COUNT
+} BusQos_Initiator;
+
+/**
+ * @brief Lese- und Schreib-QoS eines Initiators, 0 (Reset) bis BUSQOS_MAX
+ */
+typedef struct {
+	uint8_t read;
+	uint8_t write;
+} BusQos_Level;
+
+/* Plan des Betriebs: Display und ADC vor CPU, DMA2D und MDMA, die SD-Karte zuletzt */
+extern const BusQos_Level BusQos_Default[BUSQOS_INI_COUNT];
+
+/* Alle Initiatoren auf 0 wie nach dem Reset, reine Round-Robin-Arbitrierung (Vergleich im bus_bench) */
+extern const BusQos_Level BusQos_Flat[BUSQOS_INI_COUNT];
+
+void BusQos_Init(void);
+void BusQos_Apply(const BusQos_Level *plan);
+void BusQos_Set(BusQos_Initiator initiator, uint8_t read, uint8_t write);
+BusQos_Level BusQos_Get(BusQos_Initiator initiator);
+const char* BusQos_Name(BusQos_Initiator initiator);
+int8_t BusQos_Find(const char *name);
+void BusQos_Dump(void);
+
+#endif /* INC_BUSQOS_H_ */
@@ -0,0 +1,90 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_BUSSTAT_H_
+#define INC_BUSSTAT_H_
+
+#include "main.h"
+
+/* Zähler für SPI- und I2C-Verkehr der Treiber, 0 entfernt alle Zählpunkte aus dem Code */
+#ifndef BUSSTAT_ENABLE
+#define BUSSTAT_ENABLE            1
+#endif
+
+/**
+ * @brief Geräte mit Zählern. Neue Einträge auch in BusStat_Names (BusStat.c) ergänzen.
+ */
+typedef enum {
+	BUSSTAT_ID_ILI9341 = 0,   // SPI1, Display
+	BUSSTAT_ID_LED_MATRIX,    // SPI4, MAX7219-Kette
+	BUSSTAT_ID_SSD1306,       // I2C1, OLED
+	BUSSTAT_ID_AHT20,         // I2C, Temperatursensor
+	BUSSTAT_ID_COUNT
+} BusStat_Id;
+
+/**
+ * @brief Art einer Transaktion: Befehl (ILI9341 D/C low, SSD1306 Kontrollbyte 0x00,
+ *        MAX7219-Konfiguration, AHT20-Messbefehl) oder Nutzdaten
+ */
+typedef enum {
+	BUSSTAT_COMMAND = 0,
+	BUSSTAT_DATA,
+	BUSSTAT_KIND_COUNT
+} BusStat_Kind;
+
+/**
+ * @brief Zähler eines Geräts seit dem letzten BusStat_Reset()
+ *
+ * async zählt die per DMA bzw. Interrupt gestarteten Transaktionen (in transactions enthalten),
+ * für sie gibt es keine Blockierzeit. blockCycles sind CPU-Takte in blockierenden HAL-Aufrufen
+ * und in Warteschleifen auf das Ende einer DMA-Übertragung.
+ */
+typedef struct {
+	uint32_t transactions[BUSSTAT_KIND_COUNT];
+	uint64_t bytes[BUSSTAT_KIND_COUNT];
+	uint32_t async;
+	uint64_t blockCycles;
+	uint32_t blockMax;
+} BusStat_Counter;
+
+#if BUSSTAT_ENABLE
+
+/**
+ * Zählt einen blockierenden HAL-Aufruf und misst seine Dauer, liefert dessen Rückgabewert:
+ *   status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_COMMAND, 1, HAL_SPI_Transmit(...));
+ */
+#define BUSSTAT_CALL(id, kind, bytes, call) ({ \
+		uint32_t BusStat_Start_ = DWT->CYCCNT; \
+		__typeof__(call) BusStat_Result_ = (call); \
+		BusStat_Record((id), (kind), (bytes), DWT->CYCCNT - BusStat_Start_); \
+		BusStat_Result_; })
+
+/* Zählt eine DMA- bzw. Interrupt-Übertragung beim Start */
+#define BUSSTAT_ASYNC(id, kind, bytes)  BusStat_RecordAsync((id), (kind), (bytes))
+
+/* Misst eine Warteschleife auf das Ende einer asynchronen Übertragung */
+#define BUSSTAT_WAIT_BEGIN(id)          uint32_t BusStat_Wait_##id = DWT->CYCCNT
+#define BUSSTAT_WAIT_END(id)            BusStat_RecordWait((id), DWT->CYCCNT - BusStat_Wait_##id)
+
+void BusStat_Record(BusStat_Id id, BusStat_Kind kind, uint32_t bytes, uint32_t cycles);
+void BusStat_RecordAsync(BusStat_Id id, BusStat_Kind kind, uint32_t bytes);
+void BusStat_RecordWait(BusStat_Id id, uint32_t cycles);
+void BusStat_Snapshot(BusStat_Counter *counters);
+void BusStat_Reset(void);
+void BusStat_Dump(void);
+const char* BusStat_Name(BusStat_Id id);
+
+#else
+
+#define BUSSTAT_CALL(id, kind, bytes, call)  (call)
+#define BUSSTAT_ASYNC(id, kind, bytes)       ((void)0)
+#define BUSSTAT_WAIT_BEGIN(id)               ((void)0)
+#define BUSSTAT_WAIT_END(id)                 ((void)0)
+
+#define BusStat_Reset()                      ((void)0)
+#define BusStat_Dump()                       ((void)0)
+
+#endif /* BUSSTAT_ENABLE */
+
+#endif /* INC_BUSSTAT_H_ */
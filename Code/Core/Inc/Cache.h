@@ -0,0 +1,56 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_CACHE_H_
+#define INC_CACHE_H_
+
+#include "main.h"
+
+/* Größe einer Cache-Zeile des Cortex-M7 und des D-Cache im STM32H7B0 */
+#define CACHE_LINE_SIZE          32
+#define CACHE_DCACHE_SIZE        (16UL * 1024UL)
+
+/* Nicht cachebarer Bereich für DMA-Puffer: RAM_CD, MPU-Region 2 (siehe MPU_Config in main.c) */
+#define CACHE_DMA_REGION_BASE    0x30000000UL
+#define CACHE_DMA_REGION_SIZE    (128UL * 1024UL)
+
+/* SRD SRAM für BDMA2 (LPUART1), ebenfalls nicht cachebar: MPU-Region 3 */
+#define CACHE_BDMA_REGION_BASE   0x38000000UL
+#define CACHE_BDMA_REGION_SIZE   (32UL * 1024UL)
+
+/**
+ * Legt einen Puffer in den nicht cachebaren Abschnitt .dma_buffer (RAM_CD).
+ * Für Puffer, die die CPU füllt und DMA1/DMA2 liest (SPI1, TIM1) oder umgekehrt;
+ * Cache-Pflege entfällt dort. Der Abschnitt wird beim Start nicht genullt.
+ * Beispiel: uint8_t Buffer[512] DMA_BUFFER;
+ */
+#define DMA_BUFFER               __attribute__((section(".dma_buffer"), aligned(CACHE_LINE_SIZE)))
+
+/**
+ * Wie DMA_BUFFER, aber in SRD SRAM (.bdma_buffer): Der BDMA2 der SmartRun-Domäne
+ * (LPUART1) erreicht nur diesen Speicher.
+ */
+#define BDMA_BUFFER              __attribute__((section(".bdma_buffer"), aligned(CACHE_LINE_SIZE)))
+
+/**
+ * Große Puffer im AXI-SRAM außerhalb von .bss (.axi_buffer): cachebar, an Cache-Zeilen
+ * ausgerichtet, beim Start nicht genullt. Für Framebuffer, Lese- und Sektorpuffer, deren
+ * Inhalt vor dem ersten Lesen geschrieben wird; der Startup-Code spart das Nullen, und die
+ * Map-Datei weist die Puffer getrennt von den übrigen Variablen aus.
+ */
+#define AXI_BUFFER               __attribute__((section(".axi_buffer"), aligned(CACHE_LINE_SIZE)))
+
+/**
+ * Variable in SRD SRAM (.backup), nicht initialisiert: Der Inhalt übersteht einen Reset ohne
+ * Spannungsverlust und den Stop-Modus. Nach dem Einschalten ist er zufällig, Nutzer prüfen
+ * deshalb eine eigene Kennung. Nicht cachebar (MPU-Region 3).
+ */
+#define BACKUP_DATA              __attribute__((section(".backup")))
+
+uint8_t Cache_IsDMABuffer(const void *address);
+void Cache_CleanDMA(const void *data, uint32_t size);
+void Cache_InvalidateDMA(void *data, uint32_t size);
+void Cache_CleanInvalidateDMA(void *data, uint32_t size);
+
+#endif /* INC_CACHE_H_ */
@@ -0,0 +1,95 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_CAN_H_
+#define INC_CAN_H_
+
+#include "main.h"
+#include "fdcan.h"
+
+/* Empfangswarteschlange für beide RX-FIFOs (Zweierpotenz), je Platz ein Can_Message */
+#define CAN_RX_QUEUE_SIZE         32
+
+/* Sendewarteschlange hinter dem TX-FIFO der Hardware (Zweierpotenz) */
+#define CAN_TX_QUEUE_SIZE         16
+
+/* Vom Hardwarefilter in main() angenommene Standard-IDs: 0x100-0x1FF, RX-FIFO 0 */
+#define CAN_RX_ID_BASE            0x100
+#define CAN_RX_ID_MASK            0x700
+
+/* Größte Nutzlast eines CAN-FD-Rahmens */
+#define CAN_MAX_DATA              64
+
+/* Flags von Can_Message */
+#define CAN_FLAG_EXTENDED         0x01   // 29-Bit-Identifier
+#define CAN_FLAG_REMOTE           0x02   // Remote-Rahmen (nur klassisches CAN)
+#define CAN_FLAG_FD               0x04   // CAN-FD-Rahmen, bis 64 Bytes
+#define CAN_FLAG_BRS              0x08   // Datenphase mit der schnellen Bitrate (nur mit CAN_FLAG_FD)
+
+/**
+ * @brief Ein CAN- bzw. CAN-FD-Rahmen
+ *
+ * Beim Senden wird length auf die nächste gültige FD-Länge (12, 16, 20, 24, 32, 48, 64)
+ * aufgerundet und mit Nullen aufgefüllt.
+ */
+typedef struct {
+	uint32_t id;
+	uint8_t length;                // Bytes in data, 0-8 (klassisch) bzw. 0-64 (FD)
+	uint8_t flags;                 // CAN_FLAG_*
+	uint8_t fifo;                  // Empfang: RX-FIFO 0 oder 1 laut Filter
+	uint16_t timestamp;            // Empfang: Zeitstempel in Bitzeiten der Arbitrierungsphase
+	uint8_t data[CAN_MAX_DATA];
+} Can_Message;
+
+/**
+ * @brief Zähler des Treibers
+ */
+typedef struct {
+	uint32_t received;
+	uint32_t sent;                 // an die Hardware übergebene Rahmen
+	uint32_t rxOverruns;           // Warteschlange voll, Rahmen verworfen
+	uint32_t rxLost;               // RX-FIFO der Hardware übergelaufen
+	uint32_t txDropped;            // Sendewarteschlange voll
+	uint32_t busOff;
+} Can_Stats;
+
+/**
+ * @brief Empfänger für RX-FIFO 1 ohne Umweg über die Warteschlange, läuft im Interrupt
+ *
+ * data zeigt direkt in das Element im Message RAM und gilt nur während des Aufrufs; danach
+ * gibt der Treiber das Element frei.
+ */
+typedef void (*Can_FrameHandler)(uint32_t id, uint8_t flags, const uint8_t *data, uint8_t length, void *context);
+
+/**
+ * @brief Mitschnitt: sieht jeden Rahmen beider RX-FIFOs, läuft im Interrupt vor der normalen Verarbeitung
+ *
+ * timeUs ist Timebase_Us32() zum Zeitstempel der Hardware (Beginn des Rahmens), nicht zum Interrupt.
+ * data gilt nur während des Aufrufs.
+ */
+typedef void (*Can_CaptureHandler)(uint32_t timeUs, uint32_t id, uint8_t flags, uint8_t fifo,
+		const uint8_t *data, uint8_t length, void *context);
+
+uint8_t Can_Init(FDCAN_HandleTypeDef *hfdcan);
+uint8_t Can_AddFilter(uint32_t id, uint32_t mask, uint8_t flags, uint8_t fifo);
+uint8_t Can_Send(const Can_Message *message);
+uint8_t Can_Receive(Can_Message *message);
+uint32_t Can_GetPending(void);
+void Can_SetFifo1Handler(Can_FrameHandler handler, void *context);
+uint8_t Can_SetCapture(Can_CaptureHandler handler, void *context);
+uint8_t Can_SendDirect(uint32_t id, uint8_t flags, const uint8_t *head, uint8_t headLength,
+		const uint8_t *data, uint8_t length);
+uint32_t Can_GetTxFree(void);
+uint32_t Can_GetTxPending(void);
+const Can_Stats* Can_GetStats(void);
+void Can_GetErrorCounters(uint8_t *tx, uint8_t *rx);
+uint32_t Can_GetNominalBitrate(void);
+uint32_t Can_GetDataBitrate(void);
+
+void Can_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t interrupts);
+void Can_RxFifo1Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t interrupts);
+void Can_TxBufferCompleteCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t bufferIndexes);
+void Can_ErrorStatusCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t interrupts);
+
+#endif /* INC_CAN_H_ */
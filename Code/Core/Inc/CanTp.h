@@ -0,0 +1,71 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_CANTP_H_
+#define INC_CANTP_H_
+
+#include "main.h"
+#include "Can.h"
+
+/* Standard-IDs der Verbindung: Knoten n sendet auf CANTP_ID_BASE + n und hört auf die andere ID.
+ * Beide gehen über einen Filter in RX-FIFO 1. */
+#define CANTP_ID_BASE             0x6F0
+
+/* Knotennummer nach dem Start; am zweiten Board 1 eintragen oder 'xfer node 1' eingeben */
+#define CANTP_NODE                0
+
+/* Folgerahmen je Flusssteuerung (BS), bestimmt die Größe der beiden Empfangsfenster */
+#define CANTP_BLOCK_SIZE          32
+
+/* Mindestabstand der Folgerahmen, den der Empfänger verlangt (STmin, 0 = so schnell wie möglich) */
+#define CANTP_STMIN               0
+
+/* Wartezeit auf Flusssteuerung bzw. nächsten Folgerahmen in ms (N_Bs, N_Cr) */
+#define CANTP_TIMEOUT_MS          1000
+
+/* Höchstens so viele WAIT-Rahmen hintereinander, bevor der Sender abbricht (N_WFTmax) */
+#define CANTP_MAX_WAITS           16
+
+/**
+ * @brief Liefert den Zeiger auf length Bytes ab offset der zu sendenden Daten
+ *
+ * Der Zeiger muss bis zum nächsten Aufruf gültig bleiben; Daten im Speicher (Flash, RAM)
+ * gehen so ohne Kopie ins Message RAM. Läuft im CanTp-Task.
+ */
+typedef const uint8_t* (*CanTp_Source)(uint32_t offset, uint8_t length, void *context);
+
+/**
+ * @brief Nimmt ein Stück empfangener Daten ab (ein Fenster), läuft im CanTp-Task
+ *
+ * Die Stücke kommen lückenlos in Reihenfolge; das letzte endet bei offset + length == total.
+ */
+typedef void (*CanTp_Sink)(uint32_t offset, const uint8_t *data, uint32_t length, uint32_t total, void *context);
+
+/**
+ * @brief Zähler und Durchsatz der letzten Übertragungen
+ */
+typedef struct {
+	uint32_t txTransfers;          // vollständig gesendet
+	uint32_t rxTransfers;          // vollständig empfangen
+	uint32_t errors;               // Sequenzfehler, Überlauf, abgebrochen
+	uint32_t timeouts;
+	uint32_t waits;                // WAIT-Rahmen gesendet oder empfangen
+	uint32_t lastTxBytes;
+	uint32_t lastTxMs;             // First Frame bis letzter Rahmen auf dem Bus
+	uint32_t lastRxBytes;
+	uint32_t lastRxMs;             // First Frame bis letzter Folgerahmen
+} CanTp_Stats;
+
+uint8_t CanTp_Init(uint8_t taskId, uint8_t node);
+void CanTp_SetNode(uint8_t node);
+uint8_t CanTp_GetNode(void);
+void CanTp_SetSink(CanTp_Sink sink, void *context);
+uint8_t CanTp_Send(const void *data, uint32_t length);
+uint8_t CanTp_SendFrom(CanTp_Source source, void *context, uint32_t length);
+uint8_t CanTp_IsBusy(void);
+const CanTp_Stats* CanTp_GetStats(void);
+uint32_t CanTp_GetThroughput(uint32_t bytes, uint32_t ms);
+void CanTp_Task(void *context);
+
+#endif /* INC_CANTP_H_ */
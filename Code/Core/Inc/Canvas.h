@@ -0,0 +1,114 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_CANVAS_H_
+#define INC_CANVAS_H_
+
+#include "main.h"
+#include "SSD1306.h"
+
+/* Farben in RGB565; die einfarbigen Displays (SSD1306, LED-Matrix) setzen jedes Pixel, das nicht schwarz ist */
+#define CANVAS_BLACK        0x0000UL
+#define CANVAS_WHITE        0xFFFFUL
+
+/* Hintergrund von Bitmaps und Text: nur gesetzte Bits zeichnen */
+#define CANVAS_TRANSPARENT  0x10000UL
+
+/* Budget eines Bilds in µs (Zeichnen ab Canvas_FrameBegin() bis das langsamste Display fertig ist), ein UI-Takt */
+#define CANVAS_FRAME_BUDGET_US  20000UL
+
+typedef uint32_t Canvas_Color;
+
+typedef struct Canvas Canvas;
+
+/**
+ * @brief Zeichenfunktionen eines Displays in dessen eigenem Speicherlayout
+ *
+ * Die gemeinsamen Primitive in Canvas.c schneiden vorher auf die Fläche des Displays zu:
+ * fillRect bekommt nur sichtbare Rechtecke, drawBitmap nur vollständig sichtbare Bitmaps
+ * mit deckendem Hintergrund. Liefert drawBitmap 0, zeichnet Canvas.c die Bitmap stattdessen
+ * als waagerechte Läufe über fillRect.
+ */
+typedef struct {
+	void (*fillRect)(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color);
+	uint8_t (*drawBitmap)(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+			uint16_t w, uint16_t h, Canvas_Color fg, Canvas_Color bg);
+	uint8_t (*flush)(Canvas *canvas);          // veränderte Bereiche übertragen, 0 = Display noch belegt
+	uint8_t (*isBusy)(Canvas *canvas);
+} Canvas_Backend;
+
+/**
+ * @brief Zeichenfläche eines Displays
+ */
+struct Canvas {
+	const Canvas_Backend *backend;
+	int16_t width;
+	int16_t height;
+	const char *name;
+	volatile uint8_t pending;        // Bildtakt wartet auf das Ende der Übertragung
+	uint32_t lastUs;                 // Übertragung im letzten Bildtakt, ab dessen Start
+	uint32_t maxUs;
+	uint32_t skipped;                // Bildtakte, zu denen das Display noch das vorige Bild sendete
+};
+
+/**
+ * @brief Zähler des Bildtakts (Canvas_FrameFlush())
+ */
+typedef struct {
+	uint32_t frames;                 // abgeschlossene Bilder, alle Displays fertig
+	uint32_t lastUs;                 // Dauer des letzten Bilds = langsamster Bus
+	uint32_t maxUs;
+	uint32_t lastSerialUs;           // Summe der Einzeldauern, so lange bräuchten sie nacheinander
+	uint32_t lastRenderUs;           // Zeichnen von Canvas_FrameBegin() bis Canvas_FrameFlush()
+	uint32_t maxRenderUs;
+	uint32_t budgetUs;               // Zeichnen + Übertragen, 0 = keine Prüfung
+	uint32_t overruns;               // Bilder über dem Budget
+	uint32_t lastOverrunUs;          // Gesamtdauer des letzten zu langen Bilds
+	const char *overrunDisplay;      // darin das Display mit der längsten Übertragung
+	const void *overrunPart;         // darin der Teil, der am längsten zeichnete (Canvas_FrameCharge())
+	uint32_t overrunPartUs;
+} Canvas_FrameStats;
+
+/* TFT (ILI9341, RGB565), OLED (SSD1306, Seiten zu 8 Zeilen) und LED-Matrix (MAX7219-Kette, Zeilenbytes) */
+extern Canvas Canvas_Tft;
+extern Canvas Canvas_Oled;
+extern Canvas Canvas_Matrix;
+
+void Canvas_Init(void);
+
+/* --------------------------------- Formen --------------------------------- */
+void Canvas_Fill(Canvas *canvas, Canvas_Color color);
+void Canvas_FillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color);
+void Canvas_DrawPixel(Canvas *canvas, int16_t x, int16_t y, Canvas_Color color);
+void Canvas_DrawHLine(Canvas *canvas, int16_t x, int16_t y, int16_t w, Canvas_Color color);
+void Canvas_DrawVLine(Canvas *canvas, int16_t x, int16_t y, int16_t h, Canvas_Color color);
+void Canvas_DrawRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color);
+void Canvas_DrawLine(Canvas *canvas, int16_t x0, int16_t y0, int16_t x1, int16_t y1, Canvas_Color color);
+void Canvas_DrawCircle(Canvas *canvas, int16_t x0, int16_t y0, int16_t r, Canvas_Color color);
+void Canvas_FillCircle(Canvas *canvas, int16_t x0, int16_t y0, int16_t r, Canvas_Color color);
+
+/* --------------------------------- Bitmaps und Text --------------------------------- */
+void Canvas_DrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t w, uint16_t h,
+		Canvas_Color fg, Canvas_Color bg);
+void Canvas_DrawBitmapScaled(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t w, uint16_t h,
+		uint8_t scale, Canvas_Color fg, Canvas_Color bg);
+int16_t Canvas_DrawText(Canvas *canvas, int16_t x, int16_t y, const char *text, const SSD1306_Font_t *font,
+		Canvas_Color fg, Canvas_Color bg);
+uint16_t Canvas_MeasureText(const char *text, const SSD1306_Font_t *font);
+
+/* --------------------------------- Übertragung --------------------------------- */
+uint8_t Canvas_Flush(Canvas *canvas);
+uint8_t Canvas_IsBusy(Canvas *canvas);
+
+/* --------------------------------- Bildtakt --------------------------------- */
+void Canvas_FrameBegin(void);
+void Canvas_FrameCharge(const void *part, uint32_t cycles);
+void Canvas_FrameSetBudget(uint32_t us);
+uint8_t Canvas_FrameFlush(void);
+uint8_t Canvas_FrameIsDone(void);
+const Canvas_FrameStats* Canvas_GetFrameStats(void);
+void Canvas_FrameReset(void);
+void Canvas_FrameDump(void);
+
+#endif /* INC_CANVAS_H_ */
@@ -0,0 +1,108 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_CLOCK_H_
+#define INC_CLOCK_H_
+
+#include "main.h"
+
+/**
+ * @brief Taktprofile: SYSCLK kommt immer aus PLL1 (HSI 64 MHz / CLOCK_PLL_M = 16 MHz Referenz)
+ */
+typedef enum {
+	CLOCK_PROFILE_LOW_POWER = 0,    // 64 MHz bei VOS3, Bustakte wie die CubeMX-Konfiguration
+	CLOCK_PROFILE_BALANCED = 1,     // 128 MHz bei VOS2
+	CLOCK_PROFILE_MAX = 2,          // 280 MHz bei VOS0
+	CLOCK_PROFILE_COUNT
+} Clock_Profile;
+
+/* Profil beim Start, wird vor den MX_*_Init()-Aufrufen in main() gesetzt */
+#define CLOCK_PROFILE             CLOCK_PROFILE_LOW_POWER
+
+/* Gemeinsamer Teiler vor PLL1, die Referenz muss in RCC_PLL1VCIRANGE_3 (8-16 MHz) liegen */
+#define CLOCK_PLL_M               4
+
+/* Höchster Takt des W25Qxx im Quad-Lesebefehl (Datenblatt W25Q128JV) */
+#define CLOCK_OSPI_MAX_HZ         133000000UL
+
+/* Obergrenze für Clock_ResumeAfterStop() in Takten des HSI (64 MHz): VOS bereit, PLL1 eingerastet, umgeschaltet */
+#define CLOCK_RESUME_TIMEOUT      (HSI_VALUE / 1000UL)     // 1 ms
+
+/* Die I2C-Timings (CubeMX und I2CBus.c) sind für 32 MHz PCLK1 berechnet */
+#define CLOCK_PCLK1_MIN_HZ        32000000UL
+#define CLOCK_PCLK1_MAX_HZ        36000000UL
+
+/*
+ * Parameter der Profile. VOS als Zahl (0-3), Teiler der Busse als Zweierpotenz.
+ * PLL1Q versorgt SPI1 (Display), SDMMC1 und FDCAN1 und bleibt in allen Profilen bei ~42,7 MHz,
+ * damit SPI-Vorteiler und der SDMMC-ClockDiv aus dem Tuning gültig bleiben.
+ */
+// Low Power: VCO 256 MHz, SYSCLK 64 MHz, PLL1Q 42,7 MHz
+#define CLOCK_LOW_POWER_VOS       3
+#define CLOCK_LOW_POWER_PLLN      16
+#define CLOCK_LOW_POWER_PLLP      4
+#define CLOCK_LOW_POWER_PLLQ      6
+#define CLOCK_LOW_POWER_PLLR      4
+#define CLOCK_LOW_POWER_LATENCY   2
+#define CLOCK_LOW_POWER_APB1_DIV  2     // D2: I2C, UART7, SPI4, TIM6/7
+#define CLOCK_LOW_POWER_APB2_DIV  1     // D2: TIM1 (WS2812)
+#define CLOCK_LOW_POWER_APB3_DIV  2     // CD
+#define CLOCK_LOW_POWER_APB4_DIV  1     // SRD: LPUART1
+#define CLOCK_LOW_POWER_OSPI_DIV  1     // OCTOSPI aus HCLK
+
+// Balanced: VCO 256 MHz, SYSCLK 128 MHz, PLL1Q 42,7 MHz
+#define CLOCK_BALANCED_VOS        2
+#define CLOCK_BALANCED_PLLN       16
+#define CLOCK_BALANCED_PLLP       2
+#define CLOCK_BALANCED_PLLQ       6
+#define CLOCK_BALANCED_PLLR       2
+#define CLOCK_BALANCED_LATENCY    3
+#define CLOCK_BALANCED_APB1_DIV   4
+#define CLOCK_BALANCED_APB2_DIV   1
+#define CLOCK_BALANCED_APB3_DIV   2
+#define CLOCK_BALANCED_APB4_DIV   1
+#define CLOCK_BALANCED_OSPI_DIV   2
+
+// Max: VCO 560 MHz, SYSCLK 280 MHz, PLL1Q 43,1 MHz
+#define CLOCK_MAX_VOS             0
+#define CLOCK_MAX_PLLN            35
+#define CLOCK_MAX_PLLP            2
+#define CLOCK_MAX_PLLQ            13
+#define CLOCK_MAX_PLLR            2
+#define CLOCK_MAX_LATENCY         6
+#define CLOCK_MAX_APB1_DIV        8
+#define CLOCK_MAX_APB2_DIV        2
+#define CLOCK_MAX_APB3_DIV        2
+#define CLOCK_MAX_APB4_DIV        2
+#define CLOCK_MAX_OSPI_DIV        3
+
+/**
+ * @brief Aufgelöste Einstellungen eines Profils (HAL-Konstanten und resultierende Takte)
+ */
+typedef struct {
+	const char *name;
+	uint32_t voltageScaling;  // PWR_REGULATOR_VOLTAGE_SCALEx
+	uint32_t pllN;
+	uint32_t pllP;
+	uint32_t pllQ;
+	uint32_t pllR;
+	uint32_t flashLatency;    // FLASH_LATENCY_x
+	uint32_t apb1Divider;     // RCC_APB1_DIVx
+	uint32_t apb2Divider;     // RCC_APB2_DIVx
+	uint32_t apb3Divider;     // RCC_APB3_DIVx
+	uint32_t apb4Divider;     // RCC_APB4_DIVx
+	uint32_t ospiPrescaler;   // hospi1.Init.ClockPrescaler ohne gespeichertes Tuning (MX_OCTOSPI1_TuneBus())
+	uint32_t sysclkHz;
+	uint32_t pll1qHz;         // Kerneltakt SPI1/SDMMC1/FDCAN1
+} Clock_ProfileInfo;
+
+extern const Clock_ProfileInfo Clock_Profiles[CLOCK_PROFILE_COUNT];
+
+uint8_t Clock_SetProfile(Clock_Profile profile);
+Clock_Profile Clock_GetProfile(void);
+const Clock_ProfileInfo* Clock_GetProfileInfo(void);
+void Clock_ConfigOctospi(void);
+uint8_t Clock_ResumeAfterStop(void);
+
+#endif /* INC_CLOCK_H_ */
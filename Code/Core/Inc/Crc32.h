@@ -0,0 +1,19 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_CRC32_H_
+#define INC_CRC32_H_
+
+#include "main.h"
+
+/* Ab dieser Länge schiebt der MDMA die Wörter in die CRC-Einheit, darunter lohnt das Einrichten nicht */
+#define CRC32_MDMA_THRESHOLD     256
+
+/* Größter Block je MDMA-Transfer (BNDT des Kanals), längere Daten laufen in mehreren Blöcken */
+#define CRC32_MDMA_BLOCK         65532UL
+
+uint8_t Crc32_Init(void);
+uint32_t Crc32_Compute(const void *data, uint32_t length);
+
+#endif /* INC_CRC32_H_ */
@@ -0,0 +1,40 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_DIRLIST_H_
+#define INC_DIRLIST_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* Gespeicherte Lesepositionen im Verzeichnis; reichen sie nicht, wird ihr Abstand verdoppelt */
+#define DIRLIST_MARKS        16
+
+/* Anfänglicher Abstand der Lesepositionen in Einträgen */
+#define DIRLIST_MARK_STEP    16
+
+/**
+ * @brief Verzeichnis als Liste mit wahlfreiem Zugriff auf den n-ten Eintrag
+ *
+ * Speicher gehört dem Aufrufer (statisch), die Größe hängt nicht von der Anzahl der Einträge ab.
+ * "." und ".." werden übersprungen.
+ */
+typedef struct {
+	DIR dir;                      // aktuelle Leseposition
+	DIR marks[DIRLIST_MARKS];     // Leseposition vor Eintrag i * step
+	FILINFO info;                 // zuletzt gelesener Eintrag
+	uint16_t position;            // Eintrag, den das nächste f_readdir() liefert
+	uint16_t count;
+	uint16_t step;
+	uint8_t markCount;
+	uint8_t open;
+} DirList;
+
+uint8_t DirList_Open(DirList *list, const char *path);
+void DirList_Close(DirList *list);
+uint16_t DirList_Count(const DirList *list);
+const FILINFO* DirList_Get(DirList *list, uint16_t index);
+uint8_t DirList_Source(void *context, uint16_t index, char *text, uint8_t size);
+
+#endif /* INC_DIRLIST_H_ */
@@ -0,0 +1,49 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_DMAALLOC_H_
+#define INC_DMAALLOC_H_
+
+#include "main.h"
+
+/* DMA1 S0-7, DMA2 S0-7, BDMA2 C0-7 und die 16 Kanäle des MDMA */
+#define DMAALLOC_STREAM_COUNT    24
+#define DMAALLOC_MDMA_COUNT      16
+#define DMAALLOC_ENTRY_COUNT     (DMAALLOC_STREAM_COUNT + DMAALLOC_MDMA_COUNT)
+
+/**
+ * @brief Controller, aus dem DmaAlloc_Claim() einen freien Stream nimmt
+ */
+typedef enum {
+	DMAALLOC_DMA = 0,           // DMA1/DMA2 über DMAMUX1, alle Speicher außer SRD
+	DMAALLOC_BDMA               // BDMA2 über DMAMUX2, nur SRD-SRAM (BDMA_BUFFER) und LPUART1/SPI6/...
+} DmaAlloc_Bus;
+
+/**
+ * @brief Ein Eintrag der Belegungstabelle
+ */
+typedef struct {
+	const char *owner;          // NULL = frei
+	void *handle;               // DMA_HandleTypeDef* bzw. MDMA_HandleTypeDef*
+	uint32_t irqs;              // Interrupts des Streams bzw. Kanals
+	uint32_t errors;            // Interrupts mit neuem ErrorCode
+	uint32_t busyMs;            // Millisekunden mit gesetztem EN-Bit (Abtastung im 1-ms-Takt)
+	uint32_t maxCycles;         // längster Interrupt (ohne verschachtelte, IRQ_STAT_ENABLE)
+	uint64_t totalCycles;
+} DmaAlloc_Entry;
+
+/* --------------------------------- Belegung --------------------------------- */
+uint8_t DmaAlloc_Register(DMA_HandleTypeDef *hdma, const char *owner);
+uint8_t DmaAlloc_RegisterMdma(MDMA_HandleTypeDef *hmdma, const char *owner);
+uint8_t DmaAlloc_Claim(DMA_HandleTypeDef *hdma, DmaAlloc_Bus bus, uint32_t request, uint32_t irqPriority, const char *owner);
+uint8_t DmaAlloc_ClaimMdma(MDMA_HandleTypeDef *hmdma, const char *owner);
+void DmaAlloc_Release(const void *handle);
+
+/* --------------------------------- Statistik --------------------------------- */
+void DmaAlloc_Tick(uint32_t elapsedMs);
+const DmaAlloc_Entry* DmaAlloc_Get(uint8_t index);
+void DmaAlloc_ResetStats(void);
+void DmaAlloc_Dump(void);
+
+#endif /* INC_DMAALLOC_H_ */
@@ -0,0 +1,48 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_DSP_H_
+#define INC_DSP_H_
+
+#include "main.h"
+#include "adc.h"
+
+/* Punkte der FFT (Zweierpotenz), ergibt DSP_FFT_SIZE / 2 Bins */
+#define DSP_FFT_SIZE              512
+
+/* Länge des FIR-Tiefpasses (Vielfaches von 4) */
+#define DSP_FIR_TAPS              32
+
+/* Grenzfrequenz beim Start, Anteil der Abtastrate */
+#define DSP_DEFAULT_CUTOFF        0.1f
+
+/**
+ * @brief Glättung vor der FFT
+ */
+typedef enum {
+	DSP_FILTER_NONE = 0,
+	DSP_FILTER_FIR,                // gefensterter Sinc, linearphasig
+	DSP_FILTER_IIR,                // Biquad-Tiefpass 2. Ordnung (Butterworth)
+	DSP_FILTER_FIR_Q15,            // wie FIR, Festkomma mit SIMD-MAC (SMLALD)
+	DSP_FILTER_IIR_Q15             // wie IIR, Festkomma mit Fehlerrückführung
+} Dsp_Filter;
+
+/**
+ * @brief Veröffentlichtes Spektrum für die Anzeige
+ */
+typedef struct {
+	float magnitude[DSP_FFT_SIZE / 2]; // Amplitude je Bin, 1.0 = Vollaussteuerung
+	float binHz;                   // Breite eines Bins
+	float level;                   // letzter geglätteter Wert (-1.0 bis 1.0)
+	uint32_t sequence;             // zählt jedes neue Spektrum
+} Dsp_Spectrum;
+
+uint8_t Dsp_Init(uint8_t channel);
+void Dsp_SetChannel(uint8_t channel);
+void Dsp_SetFilter(Dsp_Filter filter, float cutoffHz);
+void Dsp_Process(void);
+const Dsp_Spectrum* Dsp_GetSpectrum(void);
+uint32_t Dsp_GetSkipped(void);
+
+#endif /* INC_DSP_H_ */
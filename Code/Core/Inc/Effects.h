@@ -0,0 +1,34 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_EFFECTS_H_
+#define INC_EFFECTS_H_
+
+#include "main.h"
+
+/* Takt der Effekte in ms, Periode des Scheduler-Tasks (passend zu WS2812_FRAME_RATE) */
+#define EFFECTS_TICK_MS           20
+
+/* Q15: 1.0 = 32768 */
+#define EFFECTS_Q15_ONE           32768U
+
+/**
+ * @brief Effekte; die Bedeutung der Potis steht jeweils dahinter (Poti 4 ist immer die Helligkeit)
+ */
+typedef enum {
+	EFFECTS_STATIC = 0,       // feste Farbe: Rot, Grün, Blau
+	EFFECTS_FADE,             // eine Farbe pulsiert: Farbton, Tempo, Sättigung
+	EFFECTS_RAINBOW,          // Regenbogen läuft über den Streifen: Tempo, Breite, Sättigung
+	EFFECTS_CHASE,            // Lauflicht mit Schweif: Farbton, Tempo, Schweiflänge
+	EFFECTS_COUNT
+} Effects_Mode;
+
+void Effects_SetMode(Effects_Mode mode);
+void Effects_NextMode(void);
+Effects_Mode Effects_GetMode(void);
+void Effects_SetInputs(uint16_t pot1, uint16_t pot2, uint16_t pot3, uint16_t pot4);
+void Effects_Tick(void);
+void Effects_HsvToRgb(uint16_t hue, uint16_t sat, uint16_t val, uint8_t *red, uint8_t *green, uint8_t *blue);
+
+#endif /* INC_EFFECTS_H_ */
@@ -0,0 +1,140 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ESPLINK_H_
+#define INC_ESPLINK_H_
+
+#include "main.h"
+#include "Serial.h"
+
+/* Gerahmte Verbindung zum ESP-12E-Einsatz auf UART7, 0 = UART7 bleibt reine Logausgabe */
+#ifndef ESPLINK_ENABLE
+#define ESPLINK_ENABLE            1
+#endif
+
+/* Logische Kanäle (Byte 1 des Rahmenkopfs) */
+#define ESPLINK_CH_CONTROL        0      // HELLO, CREDIT, PING/PONG, ohne Kredit
+#define ESPLINK_CH_LOG            1      // Inhalt von Serial_Log (printf und binäres LOG)
+#define ESPLINK_CH_TELEMETRY      2      // Pakete von Telemetry.c (wie auf LPUART1, ohne COBS)
+#define ESPLINK_CH_DISPLAY        3      // Bildspiegel von Mirror.c (Pakete wie TELEMETRY_PKT_MIRROR)
+#define ESPLINK_CH_COMMAND        4      // Befehlszeilen vom ESP, Antworten der Kommandozeile zurück
+#define ESPLINK_CHANNEL_COUNT     5
+
+/* Kontrollnachrichten (erstes Byte der Nutzdaten auf ESPLINK_CH_CONTROL) */
+#define ESPLINK_CTRL_HELLO        1      // Version, Kredit je Kanal 1..4; STM: dazu Breite und Höhe des Displays
+#define ESPLINK_CTRL_CREDIT       2      // Kanal, Anzahl
+#define ESPLINK_CTRL_PING         3      // Zeitstempel (4), die Gegenstelle antwortet mit PONG
+#define ESPLINK_CTRL_PONG         4
+
+#define ESPLINK_VERSION           1
+
+/* Rahmen: Kopf (8), Nutzdaten, CRC32 der Nutzdaten (4, entfällt ohne Nutzdaten) */
+#define ESPLINK_SYNC              0xA5
+#define ESPLINK_HEADER_SIZE       8
+#define ESPLINK_CRC_SIZE          4
+
+/* Größte Nutzdaten je Rahmen beim Senden bzw. Empfangen */
+#define ESPLINK_MAX_PAYLOAD       2048
+#define ESPLINK_MAX_RX_PAYLOAD    256
+
+/* Bis zu so vielen Bytes werden Nutzdaten hinter den Kopf kopiert (ein DMA-Transfer statt drei) */
+#define ESPLINK_COPY_MAX          32
+
+/* Eingereihte Rahmen je Kanal */
+#define ESPLINK_QUEUE_DEPTH       4
+
+/* Empfangsring (Zweierpotenz), zirkulär per DMA */
+#define ESPLINK_RX_BUFFER_SIZE    1024
+
+/* Sendepuffer der Antworten auf ESPLINK_CH_COMMAND (Zweierpotenz) */
+#define ESPLINK_REPLY_BUFFER_SIZE 2048
+
+/* Periode des Timers bei stehender bzw. laufender Verbindung, jeder Empfang weckt ihn sofort */
+#define ESPLINK_IDLE_MS           100
+#define ESPLINK_TICK_MS           2
+
+/* Abstand der PINGs und Zeit ohne Empfang, nach der die Verbindung als getrennt gilt */
+#define ESPLINK_PING_MS           1000
+#define ESPLINK_TIMEOUT_MS        3000
+
+/**
+ * @brief Meldet, dass der DMA die Nutzdaten fertig gelesen hat (aus dem Interrupt)
+ * @param sent: 1 gesendet, 0 verworfen (Verbindung getrennt oder Sendefehler)
+ */
+typedef void (*EspLink_Done)(const void *data, uint32_t length, uint8_t sent, void *context);
+
+/**
+ * @brief Zähler je Kanal, Latenz von EspLink_Send() bis zum Ende des DMA in µs
+ */
+typedef struct {
+	uint32_t frames;
+	uint64_t bytes;                // Nutzdaten
+	uint32_t full;                 // EspLink_Send() abgelehnt, Warteschlange voll
+	uint32_t discarded;            // eingereiht, aber wegen Trennung oder Fehler nicht gesendet
+	uint32_t stalls;               // Rahmen bereit, aber kein Kredit der Gegenstelle
+	uint64_t stallUs;              // Zeit ohne Kredit bei wartenden Rahmen
+	uint16_t credits;              // aktueller Kredit (Rahmen, die die Gegenstelle noch annimmt)
+	uint32_t rxFrames;
+	uint32_t lastLatencyUs;
+	uint32_t maxLatencyUs;
+	uint64_t sumLatencyUs;
+} EspLink_ChannelStats;
+
+typedef struct {
+	uint8_t up;                    // HELLO empfangen, UART7 gehört der Verbindung
+	uint32_t connects;
+	uint32_t timeouts;
+	uint64_t txBytes;              // auf der Leitung, mit Kopf und CRC
+	uint32_t txDma;                // gestartete DMA-Transfers
+	uint32_t txErrors;
+	uint64_t rxBytes;
+	uint32_t rxHeaderErrors;       // Prüfsumme des Kopfs oder Länge falsch
+	uint32_t rxCrcErrors;
+	uint32_t rxOverruns;           // Ring übergelaufen, bevor der Timer ihn gelesen hat
+	uint32_t rxRestarts;           // Empfang nach UART-Fehler neu gestartet
+	uint32_t rxSkipped;            // Bytes außerhalb eines Rahmens
+	uint32_t commands;             // Befehlszeilen an die Kommandozeile
+	uint32_t pings;
+	uint32_t pongs;
+	uint32_t lastRttUs;
+	uint32_t minRttUs;
+	uint32_t maxRttUs;
+	EspLink_ChannelStats channel[ESPLINK_CHANNEL_COUNT];
+} EspLink_Stats;
+
+#if ESPLINK_ENABLE
+
+void EspLink_Init(void);
+uint8_t EspLink_Send(uint8_t channel, const void *data, uint32_t length, uint16_t tag, EspLink_Done done, void *context);
+uint8_t EspLink_IsUp(void);
+uint8_t EspLink_IsBusy(void);
+void EspLink_Disconnect(void);
+void EspLink_Suspend(void);
+void EspLink_Resume(void);
+const EspLink_Stats* EspLink_GetStats(void);
+void EspLink_ResetStats(void);
+void EspLink_Dump(void);
+
+void EspLink_TxCpltCallback(UART_HandleTypeDef *huart);
+void EspLink_ErrorCallback(UART_HandleTypeDef *huart);
+void EspLink_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size);
+
+#else
+
+#define EspLink_Init()                              ((void)0)
+#define EspLink_Send(ch, data, len, tag, done, ctx) ((void)(done), 0U)
+#define EspLink_IsUp()                              (0U)
+#define EspLink_IsBusy()                            (0U)
+#define EspLink_Disconnect()                        ((void)0)
+#define EspLink_Suspend()                           ((void)0)
+#define EspLink_Resume()                            ((void)0)
+#define EspLink_ResetStats()                        ((void)0)
+#define EspLink_Dump()                              ((void)0)
+#define EspLink_TxCpltCallback(huart)               ((void)0)
+#define EspLink_ErrorCallback(huart)                ((void)0)
+#define EspLink_RxEventCallback(huart, size)        ((void)0)
+
+#endif /* ESPLINK_ENABLE */
+
+#endif /* INC_ESPLINK_H_ */
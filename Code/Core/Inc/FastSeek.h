@@ -0,0 +1,34 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_FASTSEEK_H_
+#define INC_FASTSEEK_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* Zwischengespeicherte Cluster-Tabellen (CLMT), eine je gleichzeitig offener oder kürzlich gelesener Datei */
+#define FASTSEEK_SLOTS         8
+
+/* Wörter je Tabelle: Länge, 2 je Fragment, Endmarke; 64 Wörter reichen für 31 Fragmente */
+#define FASTSEEK_TABLE_WORDS   64
+
+/**
+ * @brief Zähler seit dem Start ('sd stat' in der Shell)
+ */
+typedef struct {
+	uint32_t hits;              // Tabelle aus dem Cache übernommen
+	uint32_t builds;            // Tabelle neu aufgebaut (einmal die FAT-Kette entlang)
+	uint32_t fragmented;        // mehr Fragmente als FASTSEEK_TABLE_WORDS fasst, Datei ohne Tabelle
+	uint32_t busy;              // alle Plätze von offenen Dateien belegt
+	uint32_t small;             // Datei in einem Cluster, Tabelle lohnt nicht
+} FastSeek_Stats;
+
+FRESULT FastSeek_Open(FIL *fp, const TCHAR *path);
+uint8_t FastSeek_Attach(FIL *fp);
+void FastSeek_Detach(FIL *fp);
+FRESULT FastSeek_Close(FIL *fp);
+const FastSeek_Stats* FastSeek_GetStats(void);
+
+#endif /* INC_FASTSEEK_H_ */
@@ -0,0 +1,122 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_FIXMATH_H_
+#define INC_FIXMATH_H_
+
+#include "main.h"
+
+/* Iterationen je CORDIC-Rechnung, etwa ein Bit Genauigkeit pro Schritt (höchstens 30) */
+#define FIXMATH_ITERATIONS        30
+
+/* Q31: 1.0 ist nicht darstellbar, größter Wert 1 - 2^-31 */
+#define FIXMATH_Q31_MAX           0x7FFFFFFF
+
+/* Winkel in Q31 als Vielfaches von pi wie bei der CORDIC-Einheit der STM32: -2^31 = -pi,
+ * 2^30 = pi/2. Als uint32_t gerechnet läuft der Winkel ohne Abfrage über 360 Grad weiter. */
+#define FIXMATH_PI_HALF           0x40000000L
+
+int32_t FixMath_Degrees(int32_t degrees);
+void FixMath_SinCos(int32_t angle, int32_t *sine, int32_t *cosine);
+int32_t FixMath_Sin(int32_t angle);
+int32_t FixMath_Cos(int32_t angle);
+int32_t FixMath_Atan2(int32_t y, int32_t x);
+int32_t FixMath_Sqrt(int32_t value);
+uint32_t FixMath_ISqrt(uint32_t value);
+void FixMath_SinCosBatch(const int32_t *angles, int32_t *sine, int32_t *cosine, uint32_t count);
+
+/**
+ * @brief  Multipliziert einen Q31-Wert mit einer ganzen Zahl und rundet, z.B. Radius * cos
+ */
+static inline int32_t FixMath_Scale(int32_t q31, int32_t value) {
+	return (int32_t)(((int64_t)q31 * value + (1LL << 30)) >> 31);
+}
+
+/* --------------------------------- Q15 und Q16.16 --------------------------------- */
+
+/* Q15 ohne Vorzeichen für Anteile von 0 bis 1,0 einschließlich (Helligkeit, Sättigung) */
+#define FIXMATH_Q15_ONE           32768U
+
+/* Q16.16: 1.0 = 65536 */
+#define FIXMATH_Q16_ONE           65536L
+
+/**
+ * @brief  Sättigt einen Wert auf den Bereich von Q15 (-32768 bis 32767)
+ */
+static inline int16_t FixMath_SatQ15(int32_t value) {
+#if defined(__ARM_FEATURE_SAT)
+	return (int16_t)__SSAT(value, 16);
+#else
+	return (int16_t)(value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value);
+#endif
+}
+
+/**
+ * @brief  Sättigende Q15-Addition und -Subtraktion
+ */
+static inline int16_t FixMath_Q15Add(int16_t a, int16_t b) {
+	return FixMath_SatQ15((int32_t)a + b);
+}
+
+static inline int16_t FixMath_Q15Sub(int16_t a, int16_t b) {
+	return FixMath_SatQ15((int32_t)a - b);
+}
+
+/**
+ * @brief  Q15-Produkt mit Rundung, -1,0 * -1,0 sättigt auf 32767
+ */
+static inline int16_t FixMath_Q15Mul(int16_t a, int16_t b) {
+	return FixMath_SatQ15(((int32_t)a * b + (1 << 14)) >> 15);
+}
+
+/**
+ * @brief  Skaliert einen Wert ohne Vorzeichen mit einem Anteil in Q15 (0 bis FIXMATH_Q15_ONE), abgeschnitten
+ *
+ * value höchstens 17 Bit breit, sonst läuft das Produkt über.
+ */
+static inline uint32_t FixMath_Q15Scale(uint32_t value, uint32_t q15) {
+	return (value * q15) >> 15;
+}
+
+/**
+ * @brief  Sättigt einen 64-Bit-Wert auf int32_t
+ */
+static inline int32_t FixMath_Sat32(int64_t value) {
+	return (int32_t)(value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : value);
+}
+
+/**
+ * @brief  Sättigende Q16.16-Addition
+ */
+static inline int32_t FixMath_Q16Add(int32_t a, int32_t b) {
+	return FixMath_Sat32((int64_t)a + b);
+}
+
+/**
+ * @brief  Q16.16-Produkt mit Rundung und Sättigung
+ */
+static inline int32_t FixMath_Q16Mul(int32_t a, int32_t b) {
+	return FixMath_Sat32(((int64_t)a * b + (1 << 15)) >> 16);
+}
+
+/**
+ * @brief  Q16.16-Quotient mit Rundung zur Null hin, Division durch 0 sättigt mit dem Vorzeichen von a
+ */
+static inline int32_t FixMath_Q16Div(int32_t a, int32_t b) {
+	if (b == 0) return a >= 0 ? INT32_MAX : INT32_MIN;
+	return FixMath_Sat32((int64_t)a * 65536 / b);
+}
+
+/**
+ * @brief  Ganzzahl nach Q16.16 (gesättigt) und zurück (gerundet)
+ */
+static inline int32_t FixMath_Q16FromInt(int32_t value) {
+	return FixMath_Sat32((int64_t)value * 65536);
+}
+
+static inline int32_t FixMath_Q16ToInt(int32_t q16) {
+	return (int32_t)(((int64_t)q16 + (1 << 15)) >> 16);
+}
+
+#endif /* INC_FIXMATH_H_ */
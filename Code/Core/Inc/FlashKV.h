@@ -0,0 +1,46 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_FLASHKV_H_
+#define INC_FLASHKV_H_
+
+#include "main.h"
+
+/* Bereich des Schlüssel/Wert-Speichers im W25Qxx: die letzten 64 KB des W25Q128 */
+#define FLASHKV_BASE_ADDRESS       0x00FF0000UL
+#define FLASHKV_SECTOR_COUNT       16
+
+/* Längster Schlüssel in Zeichen; Kopf, Schlüssel und Wert eines Eintrags passen in eine 256-Byte-Seite */
+#define FLASHKV_MAX_KEY            32
+#define FLASHKV_MAX_VALUE          (256 - 8 - 1)
+
+/* Plätze des RAM-Hash-Index (Zweierpotenz, größer als die Anzahl der Einträge) */
+#define FLASHKV_INDEX_SIZE         256
+
+/* Garbage Collection beginnt, sobald nur noch so viele Sektoren frei sind; der letzte bleibt ihr vorbehalten */
+#define FLASHKV_GC_MIN_FREE        2
+
+/* Seiten, die FlashKV_Process() pro Aufruf prüft und umkopiert */
+#define FLASHKV_GC_PAGES_PER_STEP  4
+
+/**
+ * @brief Zähler des Schlüssel/Wert-Speichers
+ */
+typedef struct {
+	uint32_t entries;     // Belegte Index-Plätze (inklusive Löschmarken)
+	uint32_t writes;      // Programmierte Einträge
+	uint32_t unchanged;   // FlashKV_Set() mit unverändertem Wert, nichts geschrieben
+	uint32_t copied;      // Von der Garbage Collection umkopierte Einträge
+	uint32_t erases;      // Gelöschte Sektoren
+} FlashKV_Stats;
+
+extern FlashKV_Stats FlashKV_Statistics;
+
+uint8_t FlashKV_Init(void);
+uint8_t FlashKV_Set(const char *key, const void *value, uint16_t length);
+int32_t FlashKV_Get(const char *key, void *value, uint16_t maxLength);
+uint8_t FlashKV_Delete(const char *key);
+void FlashKV_Process(void);
+
+#endif /* INC_FLASHKV_H_ */
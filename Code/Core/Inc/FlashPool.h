@@ -0,0 +1,50 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_FLASHPOOL_H_
+#define INC_FLASHPOOL_H_
+
+#include "main.h"
+#include "W25Qxx_QSPI.h"
+
+/* Löscheinheit des Pools und erfasster Adressbereich (eine Bitmaske über den W25Q128) */
+#define FLASHPOOL_SECTOR_SIZE     4096UL
+#define FLASHPOOL_SECTOR_COUNT    (W25QXX_FLASH_SIZE / FLASHPOOL_SECTOR_SIZE)
+
+/* Höchste Dauer eines Löschabschnitts je Durchlauf des Tasks; danach Erase Suspend */
+#define FLASHPOOL_SLICE_US        1000
+
+/* Periode des Tasks in ms; zwischen zwei Abschnitten ist der Flash für alle anderen frei */
+#define FLASHPOOL_TASK_MS         2
+
+/**
+ * @brief Gibt an, ob gerade ein DMA-Transfer aus dem Memory-Mapped-Fenster läuft
+ */
+typedef uint8_t (*FlashPool_BusyFunction)(void);
+
+/**
+ * @brief Zähler des Hintergrund-Löschens
+ */
+typedef struct {
+	uint32_t pending;     // Sektoren, die noch gelöscht werden sollen
+	uint32_t queued;      // Mit FlashPool_Discard() angemeldete Sektoren
+	uint32_t erased;      // Im Hintergrund fertig gelöschte Sektoren
+	uint32_t slices;      // Löschabschnitte
+	uint32_t suspends;    // Unterbrechungen mit Erase Suspend
+	uint32_t claimed;     // Von FlashPool_Claim() zu Ende gewartete Löschvorgänge
+	uint32_t deferred;    // Durchläufe ohne Abschnitt, weil das Fenster per DMA gelesen wurde
+	uint32_t maxSliceUs;  // Längster Abschnitt inklusive Suspend
+} FlashPool_Stats;
+
+extern FlashPool_Stats FlashPool_Statistics;
+
+void FlashPool_Init(uint8_t taskId, FlashPool_BusyFunction windowBusy);
+void FlashPool_Wake(void);
+uint32_t FlashPool_Discard(uint32_t address, uint32_t size);
+uint8_t FlashPool_IsPending(uint32_t address);
+uint8_t FlashPool_Claim(uint32_t address);
+void FlashPool_Task(void *context);
+void FlashPool_Dump(void);
+
+#endif /* INC_FLASHPOOL_H_ */
@@ -0,0 +1,44 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_FMT_H_
+#define INC_FMT_H_
+
+#include <stdint.h>
+#include <stdarg.h>
+
+/**
+ * @brief Zeichenkette im Aufbau, direkt im Zielpuffer (z.B. ILI9341_Widget.text)
+ *
+ * Alle Fmt_*-Funktionen hängen an, kürzen am Ende des Puffers und lassen ihn immer mit 0
+ * abgeschlossen. truncated zeigt, dass etwas nicht mehr gepasst hat.
+ */
+typedef struct {
+	char *text;
+	uint16_t size;              // Puffergröße einschließlich der abschließenden 0
+	uint16_t length;
+	uint8_t truncated;
+} Fmt_Buffer;
+
+void Fmt_Init(Fmt_Buffer *b, char *text, uint16_t size);
+void Fmt_Char(Fmt_Buffer *b, char c);
+void Fmt_Str(Fmt_Buffer *b, const char *s);
+void Fmt_Pad(Fmt_Buffer *b, const char *s, int8_t width);
+void Fmt_U32(Fmt_Buffer *b, uint32_t value, uint8_t width, char pad);
+void Fmt_I32(Fmt_Buffer *b, int32_t value, uint8_t width, char pad);
+void Fmt_Fixed(Fmt_Buffer *b, int32_t value, uint8_t decimals, uint8_t width);
+void Fmt_Hex(Fmt_Buffer *b, uint32_t value, uint8_t digits, uint8_t upper);
+
+uint8_t Fmt_Decimal(char *out, uint32_t value);
+
+/**
+ * Teilmenge von printf: %d %i %u %x %X %s %c %% mit Flags '-' und '0', Breite (auch *) und
+ * dem Längenmodifikator l. Das format-Attribut lässt GCC Format und Argumente wie bei printf
+ * prüfen; Umwandlungen außerhalb der Teilmenge (%f, Genauigkeit) geben '?' aus und fallen
+ * damit beim ersten Blick auf die Anzeige auf. Festkomma über Fmt_Fixed().
+ */
+uint16_t Fmt_Format(char *text, uint16_t size, const char *format, ...) __attribute__((format(printf, 3, 4)));
+uint16_t Fmt_FormatV(char *text, uint16_t size, const char *format, va_list args) __attribute__((format(printf, 3, 0)));
+
+#endif /* INC_FMT_H_ */
@@ -1,6 +1,8 @@
 #ifndef BASIC_5X5_FONT_H
 #define BASIC_5X5_FONT_H
 
+#include <stdint.h>
+
 #define CHAR_WIDTH 6
 #define CHAR_HEIGHT 8
 
@@ -103,4 +105,16 @@ static const unsigned char stdfont[96][6] = {
 	{0x00,0x00,0x00,0x00,0x00,0x00}
 };
 
+/* Zeilenmasken für den ILI9341, aus stdfont zur Übersetzungszeit erzeugt (5x5_font_rows.cpp):
+ * [Zeichen][Zeile], Bit x = Pixel x von links; ×2 und ×3 schon waagerecht vergrößert */
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern const uint8_t  (*const stdfont_rows1)[CHAR_HEIGHT];
+extern const uint16_t (*const stdfont_rows2)[CHAR_HEIGHT];
+extern const uint32_t (*const stdfont_rows3)[CHAR_HEIGHT];
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,32 @@
+/**
+ * @file    5x5_font_rows.cpp
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Zeilenmasken der Grundschrift für ILI9341_RasteriseGlyph(), zur Übersetzungszeit erzeugt
+ *
+ * stdfont ist spaltenweise abgelegt (Bit 0 = oberste Zeile), das TFT bekommt die Pixel aber
+ * zeilenweise. Statt je Pixel Spalte und Bit herauszusuchen, liest der Rasterer je Pixelzeile
+ * eine Maske und schiebt sie bitweise heraus. Für die Größen 2 und 3 ist die waagerechte
+ * Verdopplung bzw. Verdreifachung schon in der Maske enthalten (uint16_t bzw. uint32_t).
+ */
+
+#include "FontTables.hpp"
+#include "5x5_font.h"
+
+namespace {
+
+constexpr auto rows1 = Fonts::RowMasks<1>(stdfont);
+constexpr auto rows2 = Fonts::RowMasks<2>(stdfont);
+constexpr auto rows3 = Fonts::RowMasks<3>(stdfont);
+
+static_assert(sizeof(rows1.data[0][0]) == 1 && sizeof(rows2.data[0][0]) == 2 && sizeof(rows3.data[0][0]) == 4,
+		"5x5_font_rows: Maskenbreite passt nicht zu CHAR_WIDTH");
+// '!' = 0x5c in column 0: rows 2..4 and 6 set
+static_assert(rows1.data[1][2] == 0x01 && rows1.data[1][5] == 0x00 && rows3.data[1][6] == 0x07,
+		"5x5_font_rows: Transposition fehlerhaft");
+
+} // namespace
+
+extern "C" const uint8_t (*const stdfont_rows1)[CHAR_HEIGHT] = rows1.data;
+extern "C" const uint16_t (*const stdfont_rows2)[CHAR_HEIGHT] = rows2.data;
+extern "C" const uint32_t (*const stdfont_rows3)[CHAR_HEIGHT] = rows3.data;
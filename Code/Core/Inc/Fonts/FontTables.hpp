@@ -0,0 +1,99 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_FONTS_FONTTABLES_HPP_
+#define INC_FONTS_FONTTABLES_HPP_
+
+/*
+ * Schrifttabellen im Format des Zielgeräts, zur Übersetzungszeit erzeugt (C++17, nur Header).
+ *
+ * Die Quelltabellen bleiben, wie sie gepflegt werden: ssd1306_fonts zeilenweise (uint16_t je
+ * Zeile, Bit 15 = linkes Pixel), 5x5_font.h spaltenweise (ein Byte je Spalte, Bit 0 = oberste
+ * Zeile). Daraus entstehen hier per constexpr
+ * - PageColumns(): Spaltenbytes in Seiten zu 8 Zeilen für den SSD1306 (ssd1306_DrawColumns()),
+ * - RowMasks<Scale>(): eine Maske je Pixelzeile für den ILI9341, Bit x = Pixel x von links,
+ *   bei Scale > 1 schon waagerecht vergrößert.
+ * Ergebnisse mit constexpr bzw. extern "C" const initialisiert liegen als Konstanten im Flash,
+ * Laufzeitcode für das Umsortieren gibt es nicht.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Fonts {
+
+/**
+ * @brief Feste Tabelle als Literaltyp, damit constexpr-Funktionen sie zurückgeben können
+ */
+template<typename T, size_t N>
+struct Table {
+	T data[N];
+};
+
+/**
+ * @brief Spaltenbytes für den SSD1306 aus zeilenweisen Zeichen
+ *
+ * Je Zeichen Width Spalten zu (Height+7)/8 Bytes, niederwertiges Byte zuerst, Bit 0 = obere Zeile.
+ * @tparam Width, Height  Zeichengröße in Pixeln, höchstens 16 Spalten (uint16_t je Zeile)
+ * @param  rows           Height Zeilen je Zeichen hintereinander
+ */
+template<size_t Width, size_t Height, size_t N>
+constexpr Table<uint8_t, N / Height * Width * ((Height + 7) / 8)> PageColumns(const uint16_t (&rows)[N]) {
+	static_assert(Width >= 1 && Width <= 16, "Fonts::PageColumns: höchstens 16 Spalten");
+	static_assert(N % Height == 0, "Fonts::PageColumns: Tabelle passt nicht zur Zeichenhöhe");
+
+	constexpr size_t bytesPerColumn = (Height + 7) / 8;
+	Table<uint8_t, N / Height * Width * bytesPerColumn> out{};
+
+	for (size_t glyph = 0; glyph < N / Height; glyph++) {
+		for (size_t y = 0; y < Height; y++) {
+			uint16_t row = rows[glyph * Height + y];
+			for (size_t x = 0; x < Width; x++) {
+				if (row & (0x8000u >> x)) {
+					out.data[(glyph * Width + x) * bytesPerColumn + y / 8] |= static_cast<uint8_t>(1u << (y % 8));
+				}
+			}
+		}
+	}
+	return out;
+}
+
+/**
+ * @brief Kleinster vorzeichenloser Typ für eine Zeilenmaske mit Bits Pixeln
+ */
+template<size_t Bits>
+using RowMask = typename std::conditional<(Bits <= 8), uint8_t,
+		typename std::conditional<(Bits <= 16), uint16_t, uint32_t>::type>::type;
+
+/**
+ * @brief Zeilenmasken aus spaltenweisen Zeichen, waagerecht um Scale vergrößert
+ *
+ * Ergebnis [Zeichen][Zeile], Bit x = Pixel x von links; die senkrechte Vergrößerung ist
+ * das Wiederholen der Zeile und bleibt beim Aufrufer.
+ * @param  columns  [Zeichen][Spalte], Bit 0 = oberste Zeile
+ */
+template<size_t Scale, size_t Glyphs, size_t Width, size_t Height = 8>
+constexpr Table<RowMask<Width * Scale>[Height], Glyphs> RowMasks(const unsigned char (&columns)[Glyphs][Width]) {
+	static_assert(Scale >= 1 && Width * Scale <= 32, "Fonts::RowMasks: höchstens 32 Pixel je Zeile");
+
+	Table<RowMask<Width * Scale>[Height], Glyphs> out{};
+
+	for (size_t glyph = 0; glyph < Glyphs; glyph++) {
+		for (size_t y = 0; y < Height; y++) {
+			uint32_t mask = 0;
+			for (size_t px = 0; px < Width * Scale; px++) {
+				if (columns[glyph][px / Scale] & (1u << y)) {
+					mask |= 1ul << px;
+				}
+			}
+			out.data[glyph][y] = static_cast<RowMask<Width * Scale>>(mask);
+		}
+	}
+	return out;
+}
+
+} // namespace Fonts
+
+#endif /* INC_FONTS_FONTTABLES_HPP_ */
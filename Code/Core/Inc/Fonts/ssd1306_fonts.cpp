@@ -1,8 +1,18 @@
+/*
+ * Die Zeichen sind zeilenweise gepflegt (uint16_t je Zeile, Bit 15 = linkes Pixel). Die
+ * Spaltenbytes für ssd1306_DrawColumns() erzeugt Fonts::PageColumns() (FontTables.hpp) daraus
+ * zur Übersetzungszeit, für jede eingebundene Schrift; ssd1306_WriteChar() schreibt damit
+ * ganze Seitenbytes statt einzelner Pixel.
+ */
 
+#include "FontTables.hpp"
+
+extern "C" {
 #include "ssd1306_fonts.h"
+}
 
 #ifdef SSD1306_INCLUDE_FONT_7x10
-static const uint16_t Font7x10 [] = {
+static constexpr uint16_t Font7x10 [] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // sp
 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x0000, 0x1000, 0x0000, 0x0000,  // !
 0x2800, 0x2800, 0x2800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // "
@@ -102,7 +112,7 @@ static const uint16_t Font7x10 [] = {
 #endif
 
 #ifdef SSD1306_INCLUDE_FONT_11x18
-static const uint16_t Font11x18 [] = {
+static constexpr uint16_t Font11x18 [] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // sp
 0x0000, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0000, 0x0C00, 0x0C00, 0x0000, 0x0000, 0x0000,   // !
 0x0000, 0x1B00, 0x1B00, 0x1B00, 0x1B00, 0x1B00, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // "
@@ -201,7 +211,7 @@ static const uint16_t Font11x18 [] = {
 };
 #endif
 #ifdef SSD1306_INCLUDE_FONT_16x26
-static const uint16_t Font16x26 [] = {
+static constexpr uint16_t Font16x26 [] = {
 0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // Ascii = [ ]
 0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03C0,0x03C0,0x01C0,0x01C0,0x01C0,0x01C0,0x01C0,0x0000,0x0000,0x0000,0x03E0,0x03E0,0x03E0,0x0000,0x0000,0x0000,0x0000,0x0000, // Ascii = [!]
 0x1E3C,0x1E3C,0x1E3C,0x1E3C,0x1E3C,0x1E3C,0x1E3C,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // Ascii = ["]
@@ -300,7 +310,7 @@ static const uint16_t Font16x26 [] = {
 };
 #endif
 #ifdef SSD1306_INCLUDE_FONT_6x8
-static const uint16_t Font6x8 [] = {
+static constexpr uint16_t Font6x8 [] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // sp
 0x2000, 0x2000, 0x2000, 0x2000, 0x2000, 0x0000, 0x2000, 0x0000,  // !
 0x5000, 0x5000, 0x5000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // "
@@ -401,7 +411,7 @@ static const uint16_t Font6x8 [] = {
 
 /* see ./examples/custom-fonts/ */
 #ifdef SSD1306_INCLUDE_FONT_16x24
-static const uint16_t Font16x24 [] = {
+static constexpr uint16_t Font16x24 [] = {
 /* -- <- these are comments and symbol separators */
 /* -- */
 /* -- This file was created manually by looking at: */
@@ -602,7 +612,7 @@ static const uint16_t Font16x24 [] = {
 #endif
 
 #ifdef SSD1306_INCLUDE_FONT_16x15
-static const uint16_t Font16x15 [] = {
+static constexpr uint16_t Font16x15 [] = {
 /**   **/
 0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
 /** ! **/
@@ -895,21 +905,26 @@ static const uint8_t char_width[] = {
 #endif
 
 #ifdef SSD1306_INCLUDE_FONT_6x8
-const SSD1306_Font_t Font_6x8 = {6, 8, Font6x8, NULL};
+static constexpr auto Font6x8_Columns = Fonts::PageColumns<6, 8>(Font6x8);
+const SSD1306_Font_t Font_6x8 = {6, 8, Font6x8, NULL, Font6x8_Columns.data};
 #endif
 #ifdef SSD1306_INCLUDE_FONT_7x10
-const SSD1306_Font_t Font_7x10 = {7, 10, Font7x10, NULL};
+static constexpr auto Font7x10_Columns = Fonts::PageColumns<7, 10>(Font7x10);
+const SSD1306_Font_t Font_7x10 = {7, 10, Font7x10, NULL, Font7x10_Columns.data};
 #endif
 #ifdef SSD1306_INCLUDE_FONT_11x18
-const SSD1306_Font_t Font_11x18 = {11, 18, Font11x18, NULL};
+static constexpr auto Font11x18_Columns = Fonts::PageColumns<11, 18>(Font11x18);
+const SSD1306_Font_t Font_11x18 = {11, 18, Font11x18, NULL, Font11x18_Columns.data};
 #endif
 #ifdef SSD1306_INCLUDE_FONT_16x26
-const SSD1306_Font_t Font_16x26 = {16, 26, Font16x26, NULL};
+static constexpr auto Font16x26_Columns = Fonts::PageColumns<16, 26>(Font16x26);
+const SSD1306_Font_t Font_16x26 = {16, 26, Font16x26, NULL, Font16x26_Columns.data};
 #endif
 
 /* see ./examples/custom-fonts/ */
 #ifdef SSD1306_INCLUDE_FONT_16x24
-const SSD1306_Font_t Font_16x24 = {16, 24, Font16x24, NULL};
+static constexpr auto Font16x24_Columns = Fonts::PageColumns<16, 24>(Font16x24);
+const SSD1306_Font_t Font_16x24 = {16, 24, Font16x24, NULL, Font16x24_Columns.data};
 #endif
 
 #ifdef SSD1306_INCLUDE_FONT_16x15
@@ -917,5 +932,6 @@ const SSD1306_Font_t Font_16x24 = {16, 24, Font16x24, NULL};
  * @copyright Google https://github.com/googlefonts/roboto
  * @license This font is licensed under the Apache License, Version 2.0.
 */
-const SSD1306_Font_t Font_16x15 = {16, 15, Font16x15, char_width};
+static constexpr auto Font16x15_Columns = Fonts::PageColumns<16, 15>(Font16x15);
+const SSD1306_Font_t Font_16x15 = {16, 15, Font16x15, char_width, Font16x15_Columns.data};
 #endif
@@ -0,0 +1,100 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_GAMEPAD_H_
+#define INC_GAMEPAD_H_
+
+#include "main.h"
+#include "UserInput.h"
+
+/* PS4-Controller über den Airlink auf UART4 als Eingabe, 0 = UART4 bleibt frei */
+#ifndef GAMEPAD_ENABLE
+#define GAMEPAD_ENABLE            1
+#endif
+
+/* Die Tasten gehen über UserInput_Inject(), das es nur mit der Entprellung im TIM7-Tick gibt */
+#if GAMEPAD_ENABLE && !defined(DEBOUNCE_WITH_TIMER)
+#undef GAMEPAD_ENABLE
+#define GAMEPAD_ENABLE            0
+#endif
+
+/* Rahmen vom Airlink (Little Endian):
+   0xA5, Folgenummer, Alter des Berichts in µs (2), USB-Bericht des DS4 ab der Report-ID (10), Prüfsumme */
+#define GAMEPAD_SYNC              0xA5
+#define GAMEPAD_REPORT_SIZE       10
+#define GAMEPAD_FRAME_SIZE        (4 + GAMEPAD_REPORT_SIZE + 1)
+#define GAMEPAD_REPORT_ID         0x01
+
+/* Empfangspuffer je Hälfte des Doppelpuffers, eine Cache-Zeile; ein voller Puffer gilt als Überlauf */
+#define GAMEPAD_RX_BUFFER_SIZE    32
+
+/* Auslenkung des linken Sticks (0-127 ab der Mitte) für Richtung gedrückt bzw. wieder losgelassen */
+#define GAMEPAD_STICK_PRESS       64
+#define GAMEPAD_STICK_RELEASE     40
+
+/* So lange (ms) ohne Rahmen gilt der Controller als getrennt, alle Tasten werden losgelassen.
+   Der Airlink schickt jeden Bericht des Controllers (250 Hz) und ohne Änderung alle 50 ms einen */
+#define GAMEPAD_TIMEOUT_MS        200
+
+/* Tasten im Byte 5 (oben: Hat, 8 = keine Richtung), 6 und 7 des DS4-Berichts */
+#define GAMEPAD_DS4_HAT_MASK      0x0F
+#define GAMEPAD_DS4_SQUARE        0x10
+#define GAMEPAD_DS4_CROSS         0x20
+#define GAMEPAD_DS4_CIRCLE        0x40
+#define GAMEPAD_DS4_TRIANGLE      0x80
+#define GAMEPAD_DS4_L1            0x01
+#define GAMEPAD_DS4_R1            0x02
+#define GAMEPAD_DS4_OPTIONS       0x20
+#define GAMEPAD_DS4_PS            0x01
+
+/* Alle Eingaben, die das Gamepad an UserInput meldet */
+#define GAMEPAD_INPUT_MASK        (((1UL << USER_INPUT_NONE) - 1) & ~((1UL << GAMEPAD_LEFT) - 1))
+
+typedef struct {
+	uint32_t reports;              // gültige Rahmen
+	uint32_t lost;                 // Lücken in der Folgenummer
+	uint32_t checksumErrors;
+	uint32_t syncErrors;           // Bytes ohne gültigen Rahmen übersprungen
+	uint32_t badReports;           // gültiger Rahmen, aber falsche Report-ID
+	uint32_t overruns;             // Puffer voll ohne Sendepause, Inhalt verworfen
+	uint32_t uartErrors;           // Fehler der UART, Empfang neu gestartet
+	uint32_t timeouts;             // GAMEPAD_TIMEOUT_MS ohne Rahmen, alle Tasten losgelassen
+	uint32_t connects;
+	uint32_t intervalUsMin;        // Abstand zweier Rahmen
+	uint32_t intervalUsMax;
+	uint32_t ageUs;                // Alter beim Eintreffen: USB am Airlink bis Ende der Sendepause, zuletzt
+	uint32_t ageUsMax;
+	uint32_t parseCycles;          // Auswertung im Interrupt von UART4, zuletzt
+	uint32_t parseCyclesMax;
+	uint8_t connected;
+} Gamepad_Stats;
+
+#if GAMEPAD_ENABLE
+
+void Gamepad_Init(void);
+void Gamepad_Tick(uint32_t elapsedMs);
+void Gamepad_Suspend(void);
+void Gamepad_Resume(void);
+uint8_t Gamepad_IsConnected(void);
+void Gamepad_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size);
+void Gamepad_ErrorCallback(UART_HandleTypeDef *huart);
+const Gamepad_Stats* Gamepad_GetStats(void);
+void Gamepad_ResetStats(void);
+void Gamepad_Dump(void);
+
+#else
+
+#define Gamepad_Init()                    ((void)0)
+#define Gamepad_Tick(elapsedMs)           ((void)0)
+#define Gamepad_Suspend()                 ((void)0)
+#define Gamepad_Resume()                  ((void)0)
+#define Gamepad_IsConnected()             (0U)
+#define Gamepad_RxEventCallback(huart, size) ((void)0)
+#define Gamepad_ErrorCallback(huart)      ((void)0)
+#define Gamepad_ResetStats()              ((void)0)
+#define Gamepad_Dump()                    ((void)0)
+
+#endif /* GAMEPAD_ENABLE */
+
+#endif /* INC_GAMEPAD_H_ */
@@ -0,0 +1,68 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_GOVERNOR_H_
+#define INC_GOVERNOR_H_
+
+#include "main.h"
+#include "Clock.h"
+
+/* Taktprofil zur Laufzeit nach der Auslastung wählen, 0 = Profil bleibt, wie es gesetzt wurde */
+#ifndef GOVERNOR_ENABLE
+#define GOVERNOR_ENABLE           1
+#endif
+
+/* Messfenster: ein Timer-Callback je Fenster wertet Last und Rückstau aus */
+#define GOVERNOR_WINDOW_MS        100
+
+/* Last in Promille: darüber eine Stufe höher, darunter (auf das kleinere Profil umgerechnet) tiefer */
+#define GOVERNOR_UP_PERMILLE      700
+#define GOVERNOR_DOWN_PERMILLE    450
+
+/* So viele Fenster in Folge muss das kleinere Profil reichen, bevor heruntergeschaltet wird */
+#define GOVERNOR_DOWN_HOLD        10
+
+/* Beobachtete Tasks: eine verpasste Deadline schaltet sofort auf CLOCK_PROFILE_MAX */
+#define GOVERNOR_WATCH_COUNT      4
+
+typedef struct {
+	uint32_t windows;                              // ausgewertete Fenster
+	uint32_t switches[CLOCK_PROFILE_COUNT];        // Wechsel in das Profil
+	uint32_t failed;                               // Clock_SetProfile() fehlgeschlagen
+	uint32_t deferred;                             // fällig, aber ein Transfer lief noch
+	uint32_t bursts;                               // Sprung auf MAX wegen Rückstau
+	uint32_t lastSwitchUs;                         // Dauer der letzten Umschaltung
+	uint32_t maxSwitchUs;
+	uint64_t sumSwitchUs;
+	uint64_t timeMs[CLOCK_PROFILE_COUNT];          // Zeit je Profil
+	uint32_t lastLoad;                             // Last im letzten Fenster in Promille
+	uint32_t capped;                               // Fenster, in denen die Obergrenze ein höheres Profil verhindert hat
+} Governor_Stats;
+
+#if GOVERNOR_ENABLE
+
+void Governor_Init(void);
+void Governor_SetEnabled(uint8_t enabled);
+uint8_t Governor_IsEnabled(void);
+uint8_t Governor_WatchTask(uint8_t taskId);
+void Governor_SetCeiling(Clock_Profile ceiling);
+Clock_Profile Governor_GetCeiling(void);
+const Governor_Stats* Governor_GetStats(void);
+void Governor_ResetStats(void);
+void Governor_Dump(void);
+
+#else
+
+#define Governor_Init()           ((void)0)
+#define Governor_SetEnabled(on)   ((void)0)
+#define Governor_IsEnabled()      (0U)
+#define Governor_WatchTask(id)    (id)
+#define Governor_SetCeiling(p)    ((void)0)
+#define Governor_GetCeiling()     (CLOCK_PROFILE_MAX)
+#define Governor_ResetStats()     ((void)0)
+#define Governor_Dump()           ((void)0)
+
+#endif /* GOVERNOR_ENABLE */
+
+#endif /* INC_GOVERNOR_H_ */
@@ -0,0 +1,147 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_HW_HPP_
+#define INC_HW_HPP_
+
+/*
+ * Pins, SPI-Geräte und Befehlstabellen als C++17-Templates, nur Header.
+ *
+ * Port, Pin und SPI stehen im Typ, nicht in Variablen: OutputPin<Port::D, DISPLAY_DC_Pin>::low()
+ * wird zu einem einzigen Speicherbefehl mit konstanter Adresse und konstantem Wert, genau wie
+ * Pin_Low(PIN(DISPLAY_DC)) in C (Pin.h). Die C-Treiber bleiben unverändert, C++-Code nutzt
+ * dieselben Definitionen aus main.h. Befehlstabellen dazu stehen in HwCommand.hpp.
+ */
+
+#include "HwCommand.hpp"
+
+namespace Hw {
+
+/**
+ * @brief GPIO-Ports über ihre Basisadresse, als Template-Parameter verwendbar
+ */
+enum class Port : uintptr_t {
+	A = GPIOA_BASE,
+	B = GPIOB_BASE,
+	C = GPIOC_BASE,
+	D = GPIOD_BASE,
+	E = GPIOE_BASE,
+};
+
+/**
+ * @brief Ausgangspin, zur Übersetzungszeit gebunden
+ * @tparam P Port
+ * @tparam Mask GPIO_PIN_x aus main.h (Bitmaske, z.B. DISPLAY_CS_Pin)
+ */
+template<Port P, uint16_t Mask>
+struct OutputPin {
+	static_assert(Mask != 0 && (Mask & (Mask - 1)) == 0, "OutputPin: genau ein Pin je Typ");
+
+	static constexpr uint32_t setMask = Mask;
+	static constexpr uint32_t resetMask = static_cast<uint32_t>(Mask) << 16;
+
+	static GPIO_TypeDef *port() {
+		return reinterpret_cast<GPIO_TypeDef *>(static_cast<uintptr_t>(P));
+	}
+
+	// Atomic via BSRR, also from interrupts
+	static void high() { port()->BSRR = setMask; }
+	static void low() { port()->BSRR = resetMask; }
+	static void write(bool state) { port()->BSRR = state ? setMask : resetMask; }
+
+	// Output level (ODR), not the pin read back
+	static bool isHigh() { return (port()->ODR & Mask) != 0; }
+
+	// Same binding as PIN(name) for the C functions in Pin.h
+	static Pin pin() { return Pin{ port(), Mask }; }
+};
+
+/**
+ * @brief Platzhalter ohne Wirkung, z.B. CS bei Hardware-NSS (SPI4, MAX7219) oder Geräte ohne D/C
+ */
+struct NoPin {
+	static void high() {}
+	static void low() {}
+	static void write(bool) {}
+};
+
+/**
+ * @brief SPI-Gerät aus Peripherie, Chip-Select und D/C-Leitung
+ *
+ * Schreibt blockierend über die Register wie BusFast_SpiWrite(): Simplex-Senden, TSIZE,
+ * CSTART, Frames bei freiem FIFO, Ende über EOT. Ein SPI-Master im Simplex-Senden hat keine
+ * Flusskontrolle und kann nicht hängen, eine Zeitbegrenzung entfällt deshalb.
+ *
+ * Vorbedingung: keine DMA-Übertragung auf dem Bus (z.B. nach ILI9341_WaitWhileBusy()),
+ * 8-Bit-Frames in CFG1, die SPI selbst mit der HAL initialisiert.
+ *
+ * @tparam SpiBase SPIx_BASE
+ * @tparam Cs, Dc OutputPin oder NoPin
+ */
+template<uintptr_t SpiBase, class Cs, class Dc = NoPin>
+struct SpiDevice {
+	static SPI_TypeDef *spi() {
+		return reinterpret_cast<SPI_TypeDef *>(SpiBase);
+	}
+
+	static void select() { Cs::low(); }
+	static void deselect() { Cs::high(); }
+
+	/**
+	 * @brief Sendet count Bytes als 8-Bit-Frames, höchstens 0xFFFF (TSIZE)
+	 */
+	static void write(const uint8_t *data, uint16_t count) {
+		SPI_TypeDef *s = spi();
+		if (count == 0) return;
+
+		s->CR1 &= ~SPI_CR1_SPE;
+		s->CFG2 = (s->CFG2 & ~SPI_CFG2_COMM) | SPI_CFG2_COMM_0;
+		s->CR2 = (s->CR2 & ~SPI_CR2_TSIZE) | count;
+		s->CR1 |= SPI_CR1_SPE;
+		s->CR1 |= SPI_CR1_CSTART;
+
+		for (uint16_t i = 0; i < count; i++) {
+			while ((s->SR & SPI_SR_TXP) == 0) {
+			}
+			*reinterpret_cast<volatile uint8_t *>(&s->TXDR) = data[i];
+		}
+		while ((s->SR & SPI_SR_EOT) == 0) {
+		}
+
+		s->IFCR = SPI_IFCR_EOTC | SPI_IFCR_TXTFC;
+		s->CR1 &= ~SPI_CR1_SPE;
+	}
+
+	/**
+	 * @brief Befehl (D/C low) mit Parametern (D/C high) innerhalb der laufenden CS-Phase
+	 */
+	static void command(uint8_t cmd, const uint8_t *params = nullptr, uint8_t count = 0) {
+		Dc::low();
+		write(&cmd, 1);
+		Dc::high();
+		write(params, count);
+	}
+
+	/**
+	 * @brief Sendet eine Befehlstabelle in einer CS-Phase, mit den Pausen der Einträge
+	 */
+	template<size_t N>
+	static void send(const ILI9341_InitCommand (&table)[N]) {
+		select();
+		for (const ILI9341_InitCommand &entry : table) {
+			command(entry.cmd, entry.params, entry.count);
+			if (entry.delayMs > 0) HAL_Delay(entry.delayMs);
+		}
+		deselect();
+	}
+};
+
+/* Pins und Geräte dieses Boards; der Port muss zu *_GPIO_Port in main.h passen */
+using DisplayCs = OutputPin<Port::D, DISPLAY_CS_Pin>;
+using DisplayDc = OutputPin<Port::D, DISPLAY_DC_Pin>;
+using Display = SpiDevice<SPI1_BASE, DisplayCs, DisplayDc>;
+
+} // namespace Hw
+
+#endif /* INC_HW_HPP_ */
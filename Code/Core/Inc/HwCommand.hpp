@@ -0,0 +1,57 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_HWCOMMAND_HPP_
+#define INC_HWCOMMAND_HPP_
+
+/*
+ * Befehlstabellen zur Übersetzungszeit (C++17, nur Header, ohne Registerzugriffe).
+ *
+ * Hw::Command() baut einen Eintrag ILI9341_InitCommand, die Anzahl der Parameter zählt der
+ * Compiler und prüft sie gegen das Feld der Struktur. Mit extern "C" deklarierte Tabellen
+ * sind aus C wie bisher erreichbar (ILI9341_InitFunctions.cpp).
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "main.h"
+#include "ILI9341.h"
+}
+
+namespace Hw {
+
+/**
+ * @brief Eintrag einer Befehlstabelle, Anzahl der Parameter aus der Argumentliste
+ */
+template<typename... Params>
+constexpr ILI9341_InitCommand Command(uint8_t cmd, Params... params) {
+	static_assert(sizeof...(Params) <= sizeof(ILI9341_InitCommand::params), "Hw::Command: zu viele Parameter");
+	return ILI9341_InitCommand{ cmd, static_cast<uint8_t>(sizeof...(Params)), 0,
+			{ static_cast<uint8_t>(params)... } };
+}
+
+/**
+ * @brief Wie Command(), mit Pause in ms nach dem Befehl (nur wo das Datenblatt sie verlangt)
+ */
+template<typename... Params>
+constexpr ILI9341_InitCommand CommandDelay(uint8_t delayMs, uint8_t cmd, Params... params) {
+	static_assert(sizeof...(Params) <= sizeof(ILI9341_InitCommand::params), "Hw::CommandDelay: zu viele Parameter");
+	return ILI9341_InitCommand{ cmd, static_cast<uint8_t>(sizeof...(Params)), delayMs,
+			{ static_cast<uint8_t>(params)... } };
+}
+
+/**
+ * @brief Anzahl der Einträge einer Tabelle als Konstante, passend zu *Length in C
+ */
+template<typename T, size_t N>
+constexpr uint8_t Count(const T (&)[N]) {
+	static_assert(N <= 0xFF, "Hw::Count: Tabelle zu lang für uint8_t");
+	return static_cast<uint8_t>(N);
+}
+
+} // namespace Hw
+
+#endif /* INC_HWCOMMAND_HPP_ */
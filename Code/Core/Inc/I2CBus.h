@@ -0,0 +1,99 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_I2CBUS_H_
+#define INC_I2CBUS_H_
+
+#include "main.h"
+
+/* Plätze in der Warteschlange je Bus */
+#define I2CBUS_QUEUE_DEPTH        8
+
+/* Ab dieser Länge wird per DMA übertragen, sofern am Handle ein DMA-Kanal hängt */
+#define I2CBUS_DMA_THRESHOLD      16
+
+/* Wartezeit in ms für I2CBus_WaitIdle() vor blockierenden Zugriffen */
+#define I2CBUS_WAIT_TIMEOUT       100
+
+/* Busgeschwindigkeiten (Standard, Fast mode, Fast-mode Plus) */
+#define I2CBUS_SPEED_STANDARD     100000U
+#define I2CBUS_SPEED_FAST         400000U
+#define I2CBUS_SPEED_FAST_PLUS    1000000U
+
+/*
+ * Geschwindigkeit je Bus. Sie darf nicht über dem Maximum des langsamsten Teilnehmers
+ * liegen, das prüfen die Treiber beim Übersetzen (SSD1306_I2C_MAX_HZ, AHT20_I2C_MAX_HZ).
+ * I2C1: SSD1306, I2C2: AHT20 - beide laut Datenblatt höchstens 400 kHz.
+ */
+#define I2CBUS_1_HZ               I2CBUS_SPEED_FAST
+#define I2CBUS_2_HZ               I2CBUS_SPEED_FAST
+
+/**
+ * @brief Art einer Transaktion
+ */
+typedef enum {
+	I2CBUS_WRITE = 0,              // Daten senden
+	I2CBUS_READ,                   // Daten lesen
+	I2CBUS_MEM_WRITE,              // Register-/Kontrollbyte, dann Daten senden
+	I2CBUS_MEM_READ                // Registeradresse senden, dann Daten lesen
+} I2CBus_Op;
+
+/**
+ * @brief Wird nach Abschluss einer Transaktion im Interrupt aufgerufen
+ * @param ok: 1 = erfolgreich, 0 = Fehler (NACK, Timeout, Busfehler)
+ */
+typedef void (*I2CBus_Callback)(uint8_t ok, void *context);
+
+/**
+ * @brief Eine Transaktion. Der Puffer gehört bis zum Callback dem Bus.
+ */
+typedef struct {
+	I2CBus_Op op;
+	uint16_t address;              // 8-Bit-Adresse (7-Bit-Adresse << 1)
+	uint16_t reg;                  // Register bzw. Kontrollbyte bei MEM_*
+	uint8_t regSize;               // 1 oder 2 Bytes bei MEM_*
+	uint8_t *data;
+	uint16_t length;
+	I2CBus_Callback callback;      // NULL = keine Rückmeldung
+	void *context;
+} I2CBus_Transaction;
+
+/**
+ * @brief Zustand eines Busses
+ */
+typedef struct {
+	I2C_HandleTypeDef *hi2c;
+	I2CBus_Transaction queue[I2CBUS_QUEUE_DEPTH];
+	volatile uint8_t head;         // laufende bzw. nächste Transaktion
+	volatile uint8_t count;
+	volatile uint8_t active;       // Transaktion an der HAL gestartet bzw. Bus belegt (I2CBus_Claim())
+	uint32_t speedHz;
+
+	uint32_t transactions;
+	uint32_t errors;
+	uint32_t rejected;             // Warteschlange war voll
+} I2CBus;
+
+extern I2CBus I2CBus_1;
+extern I2CBus I2CBus_2;
+
+void I2CBus_Init(I2CBus *bus, I2C_HandleTypeDef *hi2c, uint32_t speedHz);
+uint8_t I2CBus_Submit(I2CBus *bus, const I2CBus_Transaction *transaction);
+uint8_t I2CBus_Write(I2CBus *bus, uint16_t address, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context);
+uint8_t I2CBus_Read(I2CBus *bus, uint16_t address, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context);
+uint8_t I2CBus_MemWrite(I2CBus *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context);
+uint8_t I2CBus_MemRead(I2CBus *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context);
+uint8_t I2CBus_IsIdle(I2CBus *bus);
+uint8_t I2CBus_WaitIdle(I2CBus *bus, uint32_t timeoutMs);
+uint8_t I2CBus_Claim(I2CBus *bus);
+void I2CBus_Release(I2CBus *bus);
+
+void I2CBus_CompleteCallback(I2C_HandleTypeDef *hi2c);
+void I2CBus_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+#endif /* INC_I2CBUS_H_ */
@@ -9,13 +9,68 @@
 #define INC_ILI9341_H_
 
 #include "main.h"
+#include "Pin.h"
 #include "Fonts/gfxfont.h"
 
 /* --------------------------------- Konstanten --------------------------------- */
-extern uint16_t ILI9341_WIDTH;
-extern uint16_t ILI9341_HEIGHT;
+/* Größe eines der beiden Ping-Pong-Zeilenpuffer in Bytes (4 Zeilen à 320 Pixel RGB565) */
+#define ILI9341_LINE_BUFFER_SIZE (320 * 2 * 4)
+
+/* Größe der beiden Puffer für Bilder von der SD-Karte (Vielfaches von 512 Bytes für Multi-Block-Reads) */
+#define ILI9341_FILE_CHUNK_SIZE (16 * 1024)
+
+/* Maximale Anzahl Bytes pro HAL_SPI_Transmit_DMA-Aufruf (TSIZE-Register ist 16 Bit breit) */
+#define ILI9341_DMA_MAX_CHUNK 0xFFFE
+
+/* Pixel-Bursts mit 16-Bit-SPI-Frames senden (uint16_t RGB565 ohne Byte-Tausch). Auskommentieren für reine 8-Bit-Übertragung. */
+#define ILI9341_USE_16BIT_PIXELS
+
+/* SPI1-Teiler beim Lesen (Memory Read 0x2E): Lesezyklus laut Datenblatt >= 150 ns, PLL1Q 42,7 MHz / 8 = 5,3 MHz */
+#define ILI9341_READ_PRESCALER SPI_BAUDRATEPRESCALER_8
+
+/* Glyph-Cache für ILI9341_DrawChar: Anzahl Einträge und größte Skalierung, die gecacht wird */
+#define ILI9341_GLYPH_CACHE_ENTRIES   16
+#define ILI9341_GLYPH_CACHE_MAX_SIZE  4
+
+/* Befehlsliste: Größe eines der beiden Aufzeichnungspuffer und größter kopierter Datenblock (Glyphe Größe 1 = 96 Bytes) */
+#define ILI9341_BATCH_BUFFER_SIZE   4096
+#define ILI9341_BATCH_MAX_INLINE    128
+
+/* Segmente der Batch-Wiedergabe bis zu dieser Länge (Befehlsbyte, Parameter, kleine Daten) schreibt
+ * der Interrupt direkt in den SPI-FIFO (16 Bytes bei SPI1) statt je einen DMA-Transfer zu starten */
+#define ILI9341_BATCH_DIRECT_MAX    16
+
+/* Span-Rasterizer: größter Kreisradius, Spans pro Zeile und Eckpunkte von Polygonen */
+#define ILI9341_SPAN_MAX_RADIUS     320
+#define ILI9341_SPAN_SLOTS          4
+#define ILI9341_POLYGON_MAX_POINTS  16
+
+/* Anzahl der gespeicherten Textbreiten für ILI9341_MeasureText */
+#define ILI9341_TEXT_WIDTH_CACHE_ENTRIES 8
+
+/* Textlayout: gespeicherte Umbrüche (je Text, Breite und Font), Zeilen je Text und Zeichen je Zeile */
+#define ILI9341_TEXT_LAYOUT_CACHE_ENTRIES 4
+#define ILI9341_TEXT_MAX_LINES      8
+#define ILI9341_TEXT_MAX_RUN        64
+
+/* CS und D/CX zur Übersetzungszeit gebunden (Pin.h), jeder Wechsel ist ein Schreibzugriff auf BSRR */
+#ifndef ILI9341_CS_PIN
+#define ILI9341_CS_PIN              PIN(DISPLAY_CS)
+#endif
+#ifndef ILI9341_DC_PIN
+#define ILI9341_DC_PIN              PIN(DISPLAY_DC)
+#endif
 
-#define BURST_MAX_SIZE 100
+/* Wartezeiten nach Datenblatt: Reset-Impuls, bis zum ersten Befehl, bis Sleep Out (ILI9341_EndInit()) */
+#define ILI9341_RESET_PULSE_MS      1
+#define ILI9341_RESET_WAIT_MS       5
+#define ILI9341_SLEEP_OUT_WAIT_MS   120
+
+/* Read Display Power Mode (0x0A) eines wachen Panels: Booster, Sleep Out, Normal Mode, Display On */
+#define ILI9341_POWER_MODE_AWAKE    0x9C
+
+/* Pause ohne Befehle nach Sleep In/Out (Datenblatt 8.2.12/8.2.13); ILI9341_Power.c wartet sie ohne Blockieren ab */
+#define ILI9341_SLEEP_SETTLE_MS     5
 
 /* --------------------------------- Farben --------------------------------- */
 #define BLACK       0x0000
@@ -44,6 +99,7 @@ extern uint16_t ILI9341_HEIGHT;
 #define SCREEN_VERTICAL_2    2
 #define SCREEN_HORIZONTAL_2  3
 
+/* JPEG-Bilder mit dem Hardware-Codec (ILI9341_Jpeg.c, MDMA-Kanäle 1 und 2, ca. 24 KB RAM). Einkommentieren zum Aktivieren. */
 // #define USE_JPEG_ENCODING
 
 /**
@@ -59,11 +115,50 @@ typedef enum
     ILI9341_PORTRAIT_TRUE = 5
 } ILI9341_Orientation;
 
-extern ILI9341_t3_font_t *font;
+/* Ausrichtungen mit vertauschten Achsen (MV): 320x240 statt 240x320 */
+#define ILI9341_ORIENTATION_IS_LANDSCAPE(o)  ((o) == ILI9341_LANDSCAPE || (o) == ILI9341_LANDSCAPE_INVERTED || (o) == TEST)
+
+/* Ausrichtung zur Übersetzungszeit: ILI9341_WIDTH und ILI9341_HEIGHT werden Konstanten, Adress- und
+ * Klipping-Rechnungen aller Primitive falten der Compiler. ILI9341_SetOrientation()/ILI9341_SetRotation()
+ * nehmen dann nur Ausrichtungen mit demselben Seitenverhältnis an (z.B. um 180° gedreht). Der Host-Build
+ * (Host/) setzt ILI9341_NO_FIXED_ORIENTATION und wechselt die Ausrichtung zur Laufzeit. */
+#ifndef ILI9341_NO_FIXED_ORIENTATION
+#define ILI9341_FIXED_ORIENTATION  TEST
+#endif
+
+#ifdef ILI9341_FIXED_ORIENTATION
+#define ILI9341_WIDTH   ((uint16_t)(ILI9341_ORIENTATION_IS_LANDSCAPE(ILI9341_FIXED_ORIENTATION) ? 320 : 240))
+#define ILI9341_HEIGHT  ((uint16_t)(ILI9341_ORIENTATION_IS_LANDSCAPE(ILI9341_FIXED_ORIENTATION) ? 240 : 320))
+#else
+extern uint16_t ILI9341_WIDTH;
+extern uint16_t ILI9341_HEIGHT;
+#endif
+
+extern const ILI9341_t3_font_t *font;
+
+/**
+ * @brief Callback, der nach Abschluss einer asynchronen Übertragung aufgerufen wird
+ * @note  Wird im Interrupt-Kontext (SPI1/DMA) ausgeführt
+ */
+typedef void (*ILI9341_TransferCompleteCallback)(void);
+
+/**
+ * @brief Eintrag einer Initialisierungstabelle (ILI9341_InitFunctions.c)
+ */
+typedef struct {
+	uint8_t cmd;
+	uint8_t count;              // Anzahl Parameter
+	uint8_t delayMs;            // Pause nach dem Befehl, nur wo das Datenblatt sie verlangt
+	uint8_t params[15];
+} ILI9341_InitCommand;
 
 /* --------------------------------- Initialization --------------------------------- */
 void ILI9341_begin(SPI_HandleTypeDef *DISPLAY_SPI, GPIO_TypeDef *CS_Port, uint16_t CS_Pin, 
                   GPIO_TypeDef *DC_Port, uint16_t DC_Pin, GPIO_TypeDef *Reset_Port, uint16_t Reset_Pin);
+uint8_t ILI9341_Attach(SPI_HandleTypeDef *DISPLAY_SPI, GPIO_TypeDef *CS_Port, uint16_t CS_Pin,
+                       GPIO_TypeDef *DC_Port, uint16_t DC_Pin, GPIO_TypeDef *Reset_Port, uint16_t Reset_Pin);
+void ILI9341_EndInit();
+void ILI9341_SendInitSequence(const ILI9341_InitCommand *table, uint8_t count);
 
 /* --------------------------------- Low-level communication --------------------------------- */
 HAL_StatusTypeDef ILI9341_SendCommand(uint8_t cmd);
@@ -72,19 +167,80 @@ HAL_StatusTypeDef ILI9341_SendCommandWithParam_16Bit(uint8_t cmd, uint16_t *Para
 HAL_StatusTypeDef ILI9341_SendCommandAndReceive(uint8_t cmd, uint8_t *dataOut, uint8_t pSize);
 HAL_StatusTypeDef ILI9341_SendData(uint8_t *Data, uint32_t pSize);
 uint8_t ILI9341_ReceiveByte();
+void ILI9341_ChipSelect();
+void ILI9341_ChipDeselect();
 HAL_StatusTypeDef ILI9341_ReceiveData(uint8_t *dataOut, uint8_t pSize);
 
+
+/**
+ * Setzt das Display in den Befehlsmodus (D/CX-Pin auf LOW).
+ */
+static inline void ILI9341_SetCommand() {
+	Pin_Low(ILI9341_DC_PIN);
+}
+
+/**
+ * Setzt das Display in den Datenmodus (D/CX-Pin auf HIGH).
+ */
+static inline void ILI9341_SetData() {
+	//When DCX = ’1’, data is selected
+	/* If the D/CX bit is “high”, the transmission byte is stored as
+the display data RAM (Memory write command), or command register as parameter*/
+	Pin_High(ILI9341_DC_PIN);
+}
+
+/* --------------------------------- Asynchronous transfer (DMA) --------------------------------- */
+HAL_StatusTypeDef ILI9341_SendDataAsync(const uint8_t *Data, uint32_t pSize);
+uint8_t ILI9341_IsBusy();
+void ILI9341_WaitWhileBusy();
+void ILI9341_HoldBus(uint32_t ms);
+void ILI9341_SetTransferCompleteCallback(ILI9341_TransferCompleteCallback callback);
+void ILI9341_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+void ILI9341_SPI_ErrorCallback(SPI_HandleTypeDef *hspi);
+
+/* --------------------------------- Rücklesen (Memory Read, DMA) --------------------------------- */
+HAL_StatusTypeDef ILI9341_ReadPixelsAsync(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2, uint8_t *data,
+                                          uint32_t size, ILI9341_TransferCompleteCallback callback);
+void ILI9341_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi);
+
+/* --------------------------------- Streaming (Ping-Pong-Zeilenpuffer) --------------------------------- */
+void ILI9341_StreamBegin();
+void ILI9341_StreamBegin16();
+uint8_t* ILI9341_StreamGetBuffer();
+HAL_StatusTypeDef ILI9341_StreamSubmit(uint32_t size);
+void ILI9341_StreamEnd();
+
+/* --------------------------------- Befehlsliste (Batch) --------------------------------- */
+void ILI9341_BeginBatch();
+void ILI9341_EndBatch();
+uint8_t ILI9341_IsBatching();
+void ILI9341_SendRowsAsync(const uint8_t *Data, uint16_t RowBytes, uint16_t Stride, uint16_t Rows);
+
 /* --------------------------------- Display control commands --------------------------------- */
 void ILI9341_DisplayOn();
 void ILI9341_DisplayOff();
 void ILI9341_ColumnAddressSet(uint16_t SC, uint16_t EC);
 void ILI9341_RowAddressSet(uint16_t SC, uint16_t EC);
 void ILI9341_SetAddress(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2);
+void ILI9341_BeginWrite(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2);
+void ILI9341_InvalidateWindow();
 void ILI9341_MemoryWrite(uint8_t Red, uint8_t Green, uint8_t Blue);
 void ILI9341_MemoryWriteRaw(uint8_t *data, uint32_t size);
 void ILI9341_DrawColourBurst(uint16_t Colour, uint32_t Size);
 void ILI9341_SetRotation(uint8_t Rotation);
 void ILI9341_SetOrientation(ILI9341_Orientation orientation);
+uint8_t ILI9341_GetMemoryAccess();
+
+/* --------------------------------- Hardware-Scrolling --------------------------------- */
+HAL_StatusTypeDef ILI9341_ScrollDefine(uint16_t TopFixed, uint16_t ScrollHeight, uint16_t BottomFixed);
+void ILI9341_ScrollTo(uint16_t Line);
+void ILI9341_ScrollDisable();
+
+/* --------------------------------- Clip-Rechteck --------------------------------- */
+void ILI9341_SetClip(int16_t x, int16_t y, uint16_t width, uint16_t height);
+void ILI9341_ResetClip(void);
+uint8_t ILI9341_GetClip(int16_t *x1, int16_t *y1, int16_t *x2, int16_t *y2);
+uint8_t ILI9341_ClipRect(int16_t *x, int16_t *y, int16_t *w, int16_t *h);
 
 /* --------------------------------- Basic drawing functions --------------------------------- */
 void ILI9341_FillScreen(uint16_t Colour);
@@ -105,17 +261,73 @@ void ILI9341_FillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornern
 void ILI9341_DrawFilledRoundedRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t radius, uint16_t color);
 void ILI9341_DrawRoundedRectWithBorder(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t radius, 
                                       uint16_t fillColor, uint16_t borderColor, uint16_t borderSize);
+void ILI9341_FillPolygon(const int16_t *X, const int16_t *Y, uint8_t Count, uint16_t color);
+void ILI9341_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+void ILI9341_DrawPolyline(const int16_t *X, const int16_t *Y, uint16_t Count, uint16_t color);
+void ILI9341_DrawPlot(int16_t x, const int16_t *Y, uint16_t Count, uint16_t color);
 void ILI9341_DrawBorder(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t borderSize, uint16_t color);
 
+/* --------------------------------- Textlayout --------------------------------- */
+
+typedef enum
+{
+    ILI9341_ALIGN_LEFT = 0,
+    ILI9341_ALIGN_CENTER = 1,
+    ILI9341_ALIGN_RIGHT = 2
+} ILI9341_TextAlign;
+
+/**
+ * @brief Eine umbrochene Zeile: Ausschnitt des Textes ohne Leerzeichen am Zeilenende
+ */
+typedef struct {
+	uint16_t start;     // Index des ersten Zeichens im Text
+	uint16_t length;    // Anzahl Zeichen, höchstens ILI9341_TEXT_MAX_RUN
+	uint16_t width;     // Breite in Pixeln (Summe der Vorschübe)
+} ILI9341_TextRun;
+
+/**
+ * @brief Umbrochener Text für eine Breite und einen Font (ILI9341_LayoutText())
+ */
+typedef struct {
+	const ILI9341_t3_font_t *font;   // NULL: 5x5-Font in der Skalierung size
+	uint16_t size;
+	uint16_t maxWidth;
+	uint32_t hash;
+	uint16_t length;
+	uint16_t lineHeight;
+	uint8_t lineCount;
+	uint8_t truncated;               // Text hatte mehr als ILI9341_TEXT_MAX_LINES Zeilen
+	ILI9341_TextRun runs[ILI9341_TEXT_MAX_LINES];
+} ILI9341_TextLayout;
+
 /* --------------------------------- Text and font functions --------------------------------- */
 void ILI9341_DrawChar(char Character, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour);
 
 void ILI9341_DrawText(const char *Text, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour);
+void ILI9341_GlyphCacheClear();
+
+/* Proportionale ILI9341_t3-Fonts (1 Bit sowie anti-aliased 2/4 Bit pro Pixel) */
+void ILI9341_SetFont(const ILI9341_t3_font_t *f);
+int16_t ILI9341_DrawFontChar(uint16_t c, int16_t X, int16_t Y, uint16_t Colour, uint16_t Background_Colour);
+int16_t ILI9341_DrawFontText(const char *Text, int16_t X, int16_t Y, uint16_t Colour, uint16_t Background_Colour);
+uint16_t ILI9341_MeasureText(const char *Text);
+uint8_t ILI9341_GetFontLineHeight();
+
+/* Mehrzeiliger Text mit Umbruch an Leerzeichen und '\n', eine Übertragung je Zeile */
+const ILI9341_TextLayout* ILI9341_LayoutText(const char *Text, uint16_t Width, uint16_t Size);
+uint16_t ILI9341_DrawTextBox(const char *Text, int16_t X, int16_t Y, uint16_t Width, ILI9341_TextAlign Align,
+		uint16_t Colour, uint16_t Size, uint16_t Background_Colour);
+uint16_t ILI9341_DrawFontTextBox(const char *Text, int16_t X, int16_t Y, uint16_t Width, ILI9341_TextAlign Align,
+		uint16_t Colour, uint16_t Background_Colour);
 
 /* --------------------------------- Image drawing functions --------------------------------- */
 void ILI9341_DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *image);
+void ILI9341_DrawImage16(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *pixels);
+void ILI9341_DrawImageRegion(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image, uint16_t stride);
 void DisplayImageArray(const uint16_t *imageData, uint16_t width, uint16_t height);
 void ILI9341_DrawBinaryFile(const char *filename, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+void ILI9341_DrawBinaryFileRegion(const char *filename, uint16_t imageWidth, uint16_t imageHeight,
+                                  uint16_t srcX, uint16_t srcY, uint16_t width, uint16_t height, uint16_t x, uint16_t y);
 
 
 
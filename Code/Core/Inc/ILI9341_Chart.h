@@ -0,0 +1,86 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_CHART_H_
+#define INC_ILI9341_CHART_H_
+
+#include "main.h"
+#include "adc.h"
+
+/* Breiteste Kurve in Spalten (volle Displaybreite im Querformat) */
+#define ILI9341_CHART_MAX_WIDTH   320
+
+/* Fertige Spalten zwischen zwei ILI9341_Chart_Render(), Zweierpotenz; volle Warteschlange verwirft */
+#define ILI9341_CHART_QUEUE       32
+
+/**
+ * @brief Wie neue Spalten auf das Display kommen
+ */
+typedef enum {
+	ILI9341_CHART_SWEEP = 0,    // Schreibmarke läuft von links nach rechts und springt zurück
+	ILI9341_CHART_SCROLL        // Neueste Spalte rechts, ältere wandern nach links
+} ILI9341_ChartMode;
+
+/**
+ * @brief Laufende Messkurve; Speicher gehört dem Aufrufer (statisch)
+ *
+ * Werte kommen über ILI9341_Chart_AddSample() oder ILI9341_Chart_AdcListener() (auch aus
+ * Interrupts, ein Erzeuger), gezeichnet wird nur in ILI9341_Chart_Render(). Felder nicht
+ * direkt ändern.
+ */
+typedef struct {
+	int16_t x;
+	int16_t y;
+	uint16_t width;
+	uint16_t height;
+	uint16_t colour;            // Kurve
+	uint16_t background;
+	uint16_t accent;            // Schreibmarke im Sweep-Betrieb
+	uint8_t mode;               // ILI9341_ChartMode
+	uint8_t channel;            // Poti für ILI9341_Chart_AdcListener()
+	uint8_t redraw;             // Ganze Fläche neu zeichnen
+	int32_t min;                // Wert am unteren Rand
+	int32_t max;                // Wert am oberen Rand
+
+	// Dezimierung: Minimum und Maximum aus decimation Werten ergeben eine Spalte
+	uint16_t decimation;
+	uint16_t accCount;
+	int32_t accMin;
+	int32_t accMax;
+
+	// Fertige Spalten vom Erzeuger an ILI9341_Chart_Render()
+	int32_t queueMin[ILI9341_CHART_QUEUE];
+	int32_t queueMax[ILI9341_CHART_QUEUE];
+	volatile uint16_t queueHead;
+	volatile uint16_t queueTail;
+	volatile uint32_t dropped;
+
+	// Gezeichnete Spalten als Ring (Displayzeilen, oben/unten inklusive) für das Neuzeichnen
+	int16_t top[ILI9341_CHART_MAX_WIDTH];
+	int16_t bottom[ILI9341_CHART_MAX_WIDTH];
+	uint16_t cursor;            // Nächste Spalte im Ring
+	uint16_t filled;            // Gültige Spalten im Ring
+	uint8_t scrollActive;       // Hardware-Scrolling ist für diese Fläche eingerichtet
+	uint8_t shifted;            // Letztes Render hat im Framebuffer verschoben (Anordnung chronologisch)
+} ILI9341_Chart;
+
+void ILI9341_Chart_Init(ILI9341_Chart *chart, int16_t x, int16_t y, uint16_t width, uint16_t height,
+		ILI9341_ChartMode mode);
+void ILI9341_Chart_SetStyle(ILI9341_Chart *chart, uint16_t colour, uint16_t background, uint16_t accent);
+void ILI9341_Chart_SetRange(ILI9341_Chart *chart, int32_t min, int32_t max);
+void ILI9341_Chart_SetDecimation(ILI9341_Chart *chart, uint16_t samplesPerColumn);
+void ILI9341_Chart_SetChannel(ILI9341_Chart *chart, uint8_t channel);
+
+/* --------------------------------- Werte einspeisen --------------------------------- */
+void ILI9341_Chart_AddSample(ILI9341_Chart *chart, int32_t value);
+void ILI9341_Chart_AddSamples(ILI9341_Chart *chart, const uint16_t *data, uint32_t count, uint8_t stride);
+uint8_t ILI9341_Chart_AdcListener(const ADC_Block *block, void *context);
+
+/* --------------------------------- Zeichnen --------------------------------- */
+void ILI9341_Chart_Clear(ILI9341_Chart *chart);
+void ILI9341_Chart_Invalidate(ILI9341_Chart *chart);
+uint16_t ILI9341_Chart_Render(ILI9341_Chart *chart);
+uint32_t ILI9341_Chart_GetDropped(const ILI9341_Chart *chart);
+
+#endif /* INC_ILI9341_CHART_H_ */
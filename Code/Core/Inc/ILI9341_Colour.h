@@ -0,0 +1,30 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_COLOUR_H_
+#define INC_ILI9341_COLOUR_H_
+
+#include "main.h"
+
+/**
+ * @brief  Wandelt 8-Bit-Kanäle nach RGB565 (CPU-Byte-Reihenfolge, abgeschnitten wie DMA2D)
+ */
+static inline uint16_t ILI9341_Colour_RGB(uint8_t r, uint8_t g, uint8_t b) {
+	return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+/* --------------------------------- Puffer wandeln --------------------------------- */
+/* Ziel ist RGB565 in Display-Byte-Reihenfolge (High-Byte zuerst, wie ILI9341_DrawImage und der Framebuffer) */
+void ILI9341_Colour_FromRGB888(uint16_t *dst, const uint8_t *src, uint32_t count);
+void ILI9341_Colour_FromARGB8888(uint16_t *dst, const uint32_t *src, uint32_t count);
+void ILI9341_Colour_FromGray8(uint16_t *dst, const uint8_t *src, uint32_t count);
+void ILI9341_Colour_Swap(uint16_t *dst, const uint16_t *src, uint32_t count);
+
+/* --------------------------------- Farben berechnen --------------------------------- */
+uint16_t ILI9341_Colour_FromHSV(uint16_t hue, uint8_t sat, uint8_t val);
+void ILI9341_Colour_Gradient(uint16_t *dst, uint32_t count, uint16_t from, uint16_t to);
+void ILI9341_Colour_HueGradient(uint16_t *dst, uint32_t count, uint16_t hueFrom, uint16_t hueTo, uint8_t sat,
+		uint8_t val);
+
+#endif /* INC_ILI9341_COLOUR_H_ */
@@ -0,0 +1,41 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_CONSOLE_H_
+#define INC_ILI9341_CONSOLE_H_
+
+#include "main.h"
+
+/* Zeichengröße der Grundschrift (entspricht CHAR_WIDTH/CHAR_HEIGHT aus Fonts/5x5_font.h) */
+#define ILI9341_CONSOLE_CHAR_WIDTH   6
+#define ILI9341_CONSOLE_CHAR_HEIGHT  8
+
+/* Längste Zeile, die gepuffert wird (320 Pixel / 6 Pixel pro Zeichen) */
+#define ILI9341_CONSOLE_MAX_COLUMNS  53
+
+/**
+ * @brief Zustand einer Konsole im Hardware-Scrollbereich des Displays
+ */
+typedef struct {
+	uint16_t top;          // Erste Speicherzeile des Scrollbereichs
+	uint16_t height;       // Höhe des Scrollbereichs in Pixeln (Vielfaches der Zeilenhöhe)
+	uint16_t lineHeight;   // Pixel pro Textzeile
+	uint16_t rows;         // Anzahl Textzeilen im Scrollbereich
+	uint16_t columns;      // Zeichen pro Zeile
+	uint16_t used;         // Bereits beschriebene Zeilen (bis rows)
+	uint16_t scroll;       // Aktueller Scroll-Offset in Pixeln
+	uint16_t colour;
+	uint16_t background;
+	uint8_t size;
+	char line[ILI9341_CONSOLE_MAX_COLUMNS + 1];	// Angefangene Zeile für ILI9341_Console_Print
+	uint16_t lineLength;
+} ILI9341_Console;
+
+HAL_StatusTypeDef ILI9341_Console_Init(ILI9341_Console *console, uint16_t top, uint16_t height, uint8_t size,
+		uint16_t colour, uint16_t background);
+void ILI9341_Console_Clear(ILI9341_Console *console);
+void ILI9341_Console_WriteLine(ILI9341_Console *console, const char *text);
+void ILI9341_Console_Print(ILI9341_Console *console, const char *text);
+
+#endif /* INC_ILI9341_CONSOLE_H_ */
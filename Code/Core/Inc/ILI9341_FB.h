@@ -0,0 +1,86 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_FB_H_
+#define INC_ILI9341_FB_H_
+
+#include "main.h"
+
+/* Framebuffer im AXI-SRAM (320x240 RGB565 = 150 KB). Auskommentieren, um den Speicher freizugeben. */
+#define ILI9341_USE_FRAMEBUFFER
+
+/* Füllen, Kopieren, Mischen und Formatwandlung im Framebuffer über DMA2D (Chrom-ART). Auskommentieren für reine CPU-Pfade.
+ * Der Host-Build (Host/) setzt ILI9341_FB_NO_DMA2D, dort gibt es die Einheit nicht. */
+#ifndef ILI9341_FB_NO_DMA2D
+#define ILI9341_FB_USE_DMA2D
+#endif
+
+/* Zweiter Framebuffer (weitere 150 KB AXI-SRAM) für ILI9341_FB_SetDoubleBuffer(). Auskommentieren, um den Speicher freizugeben. */
+#define ILI9341_FB_USE_DOUBLE_BUFFER
+
+#define ILI9341_FB_PIXELS      (320 * 240)
+#define ILI9341_FB_MAX_DIRTY   8
+
+/* Unterhalb dieser Pixelanzahl ist die CPU schneller als das Aufsetzen eines DMA2D-Transfers */
+#define ILI9341_FB_DMA2D_MIN_PIXELS  64
+
+/* Zeilen des Zwischenpuffers für ILI9341_FB_BlendImage (je 320 Pixel RGB565) */
+#define ILI9341_FB_BLEND_LINES       8
+
+/**
+ * @brief Rechteckiger Bereich des Framebuffers, der noch zum Display übertragen werden muss
+ */
+typedef struct {
+	uint16_t x1, y1;	// Obere linke Ecke (inklusive)
+	uint16_t x2, y2;	// Untere rechte Ecke (inklusive)
+} ILI9341_FB_Rect;
+
+/**
+ * @brief Pixelformate für ILI9341_FB_DrawImageFormat (Werte bis RGB565 entsprechen den DMA2D-Farbmodi)
+ */
+typedef enum {
+	ILI9341_FB_ARGB8888 = 0,	// 32 Bit, uint32_t 0xAARRGGBB
+	ILI9341_FB_RGB888   = 1,	// 24 Bit, Bytes B, G, R
+	ILI9341_FB_RGB565   = 2,	// 16 Bit, High-Byte zuerst (wie ILI9341_DrawImage)
+	ILI9341_FB_RGB565_NATIVE = 3	// 16 Bit, uint16_t in CPU-Byte-Reihenfolge (wie ILI9341_DrawImage16)
+} ILI9341_FB_Format;
+
+/**
+ * @brief Erhält bei jedem ILI9341_FB_Flush() die übertragenen Bereiche (z.B. Mirror.c), bevor sie verworfen werden
+ */
+typedef void (*ILI9341_FB_FlushListener)(const ILI9341_FB_Rect *rects, uint8_t count);
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+
+/* --------------------------------- Steuerung --------------------------------- */
+void ILI9341_FB_Enable(uint8_t enable);
+uint8_t ILI9341_FB_IsEnabled();
+uint16_t* ILI9341_FB_GetBuffer();
+#ifdef ILI9341_FB_USE_DOUBLE_BUFFER
+void ILI9341_FB_SetDoubleBuffer(uint8_t enable);
+uint8_t ILI9341_FB_IsDoubleBuffered();
+#endif
+
+/* --------------------------------- Zeichnen in den RAM --------------------------------- */
+void ILI9341_FB_DrawPixel(uint16_t x, uint16_t y, uint16_t color);
+void ILI9341_FB_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void ILI9341_FB_DrawImage(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image);
+void ILI9341_FB_DrawImageFormat(int16_t x, int16_t y, uint16_t width, uint16_t height, const void *image, ILI9341_FB_Format format);
+void ILI9341_FB_DrawImageRegion(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image, uint16_t stride);
+void ILI9341_FB_DrawIndexed(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image,
+                            uint8_t bpp, const uint16_t *palette, uint16_t colours);
+void ILI9341_FB_BlendImage(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint32_t *image, uint8_t alpha);
+uint16_t ILI9341_FB_GetPixel(uint16_t x, uint16_t y);
+void ILI9341_FB_Sync();
+
+/* --------------------------------- Dirty-Rectangles und Übertragung --------------------------------- */
+void ILI9341_FB_MarkDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+void ILI9341_FB_InvalidateAll();
+uint8_t ILI9341_FB_GetDirtyCount();
+void ILI9341_FB_Flush();
+void ILI9341_FB_SetFlushListener(ILI9341_FB_FlushListener listener);
+
+#endif /* ILI9341_USE_FRAMEBUFFER */
+
+#endif /* INC_ILI9341_FB_H_ */
@@ -0,0 +1,54 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_IMAGE_H_
+#define INC_ILI9341_IMAGE_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* Kennung komprimierter Bilder (muss zu Tools/image_compress.py passen) */
+#define ILI9341_IMAGE_MAGIC       0x474D4943UL   // "CIMG"
+
+/* Größe des Lesepuffers für komprimierte Bilder von der SD-Karte (Vielfaches von 512 Bytes) */
+#define ILI9341_IMAGE_INPUT_SIZE  4096
+
+/* Größte Rückwärtsdistanz einer LZ4-Referenz; der Verlauf liegt in den beiden ILI9341_FileBuffer */
+#define ILI9341_IMAGE_LZ4_WINDOW  (12 * 1024)
+
+/**
+ * @brief Kompressionsverfahren eines Bildes
+ */
+typedef enum {
+	ILI9341_IMAGE_RLE = 1,    // Lauflängen auf RGB565-Pixeln, für flache UI-Grafik
+	ILI9341_IMAGE_LZ4 = 2,    // LZ4-Block auf dem Bytestrom, für Fotos und Verläufe
+	ILI9341_IMAGE_INDEXED = 3 // Farbtabelle und 1/2/4/8 Bit je Pixel, für UI-Grafik mit wenigen Farben
+} ILI9341_ImageFormat;
+
+/**
+ * @brief Kopf eines komprimierten Bildes, direkt gefolgt von den komprimierten Daten
+ */
+typedef struct {
+	uint32_t magic;           // ILI9341_IMAGE_MAGIC
+	uint16_t width;           // Breite in Pixeln
+	uint16_t height;          // Höhe in Pixeln
+	uint8_t format;           // ILI9341_ImageFormat
+	uint8_t bpp;              // INDEXED: Bits je Pixel (1, 2, 4 oder 8), sonst 0
+	uint8_t colours;          // INDEXED: Einträge der Farbtabelle - 1, sonst 0
+	uint8_t reserved;
+	uint32_t size;            // Länge der komprimierten Daten in Bytes (bei INDEXED mit Farbtabelle)
+} ILI9341_ImageHeader;
+
+/**
+ * @brief Empfänger dekodierter Zeilen (ILI9341_DecodeCompressedStream): count Zeilen ab row,
+ *        RGB565 mit High-Byte zuerst; pixels ist nur während des Aufrufs gültig
+ */
+typedef void (*ILI9341_ImageRows)(void *context, uint16_t row, uint16_t count, const uint8_t *pixels);
+
+uint8_t ILI9341_DrawCompressedImage(const uint8_t *data, uint32_t size, uint16_t x, uint16_t y);
+uint8_t ILI9341_DrawCompressedFile(const char *filename, uint16_t x, uint16_t y);
+uint8_t ILI9341_DrawCompressedStream(FIL *file, uint16_t x, uint16_t y);
+uint8_t ILI9341_DecodeCompressedStream(FIL *file, ILI9341_ImageHeader *header, ILI9341_ImageRows rows, void *context);
+
+#endif /* INC_ILI9341_IMAGE_H_ */
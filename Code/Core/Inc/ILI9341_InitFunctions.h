@@ -1,20 +1,4 @@
-void Power_Control_A();
-void Power_Control_B();
-void Power_On_Sequence_Control();
-void DriverTimingControl_A();
-void PumpRatioControl();
-void DriverTimingControl_B();
-void PowerControl_1();
-void PowerControl_2();
-void VCOM_Control_1();
-void VCOM_Control_2();
-void MemoryAccessControl();
-void VerticalScrollingStartAddress();
-void COLMOD_PixelFormatSet();
-void FrameRateControl();
-void DisplayFunctionControl();
-void Enable3G();
-void GammaSet();
-void PositiveGammaCorrection();
-void NegativeGammaCorrection();
-void SleepOut();
\ No newline at end of file
+extern const ILI9341_InitCommand ILI9341_InitSequence[];
+extern const uint8_t ILI9341_InitSequenceLength;
+extern const ILI9341_InitCommand ILI9341_WakeSequence[];
+extern const uint8_t ILI9341_WakeSequenceLength;
@@ -0,0 +1,44 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_JPEG_H_
+#define INC_ILI9341_JPEG_H_
+
+#include "main.h"
+#include "ILI9341.h"
+
+#ifdef USE_JPEG_ENCODING
+
+/* Größe der beiden Eingangspuffer für JPEG-Dateien von der SD-Karte (Vielfaches von 512 Bytes) */
+#define ILI9341_JPEG_INPUT_SIZE     4096
+
+/* Größe der beiden Puffer für eine MCU-Zeile YCbCr-Daten (4:2:0 mit 320 Pixeln: 20 MCUs à 384 Bytes) */
+#define ILI9341_JPEG_MCU_ROW_SIZE   8192
+
+/* Längster Abschnitt eines Eingangs-MDMA-Transfers aus dem Speicher (MDMA-Blocklänge max. 64 KB) */
+#define ILI9341_JPEG_DMA_MAX_CHUNK  (32UL * 1024UL)
+
+/* Abbruch, wenn der Codec so lange keine Daten annimmt oder liefert */
+#define ILI9341_JPEG_TIMEOUT        500	// ms
+
+/**
+ * @brief Eigenschaften des zuletzt dekodierten Bildes (aus dem JPEG-Kopf)
+ */
+typedef struct {
+	uint16_t width;
+	uint16_t height;
+	uint8_t components;      // 1 = Graustufen, 3 = YCbCr
+	uint8_t mcuWidth;        // 8 oder 16 Pixel
+	uint8_t mcuHeight;       // 8 oder 16 Pixel
+	uint16_t mcuBytes;       // Bytes einer MCU in der Ausgabe des Codecs
+} ILI9341_JpegInfo;
+
+extern ILI9341_JpegInfo ILI9341_JpegLastInfo;
+
+uint8_t ILI9341_DrawJpeg(const uint8_t *data, uint32_t size, uint16_t x, uint16_t y);
+uint8_t ILI9341_DrawJpegFile(const char *filename, uint16_t x, uint16_t y);
+
+#endif /* USE_JPEG_ENCODING */
+
+#endif /* INC_ILI9341_JPEG_H_ */
@@ -0,0 +1,59 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_POWER_H_
+#define INC_ILI9341_POWER_H_
+
+#include "main.h"
+
+/* Ohne Eingabe so lange, bis das Panel schläft (0 = nie); ILI9341_Power_SetTimeout() ändert es zur Laufzeit */
+#define ILI9341_POWER_TIMEOUT_MS      (5UL * 60UL * 1000UL)
+
+/* Periode des Power-Tasks; Eingaben geben ihn über TOPIC_INPUT sofort frei */
+#define ILI9341_POWER_TASK_MS         10
+
+/* Teilbereich für ILI9341_POWER_STATUS: Panelzeilen (0-319 entlang der langen Seite, unabhängig von MADCTL) */
+#define ILI9341_POWER_PARTIAL_FIRST   0
+#define ILI9341_POWER_PARTIAL_LAST    39
+
+/**
+ * @brief Betriebsart des Panels, solange es wach ist
+ */
+typedef enum {
+	ILI9341_POWER_NORMAL = 0,       // ganze Fläche, 262k Farben
+	ILI9341_POWER_STATUS            // nur der Teilbereich (Partial Mode), 8 Farben (Idle Mode)
+} ILI9341_PowerMode;
+
+/**
+ * @brief Zustand des Power-Managers
+ */
+typedef enum {
+	ILI9341_POWER_AWAKE = 0,
+	ILI9341_POWER_ASLEEP,           // Display Off + Sleep In, Speicher und Register bleiben erhalten
+	ILI9341_POWER_WAKING            // Sleep Out gesendet, Display On nach ILI9341_SLEEP_SETTLE_MS
+} ILI9341_PowerState;
+
+/**
+ * @brief Zähler seit dem Start
+ */
+typedef struct {
+	uint32_t sleeps;
+	uint32_t wakes;
+	uint32_t asleepMs;              // Summe aller abgeschlossenen Schlafphasen
+	uint32_t wakeMsMax;             // längste Zeit von ILI9341_Power_Wake() bis Display On
+} ILI9341_PowerStats;
+
+void ILI9341_Power_Init(uint8_t taskId);
+void ILI9341_Power_Activity(void);
+void ILI9341_Power_SetTimeout(uint32_t ms);
+void ILI9341_Power_SetMode(ILI9341_PowerMode mode);
+void ILI9341_Power_SetPartialArea(uint16_t first, uint16_t last);
+void ILI9341_Power_Sleep(void);
+void ILI9341_Power_Wake(void);
+ILI9341_PowerState ILI9341_Power_GetState(void);
+ILI9341_PowerMode ILI9341_Power_GetMode(void);
+void ILI9341_Power_Dump(void);
+void ILI9341_Power_Task(void *context);
+
+#endif /* INC_ILI9341_POWER_H_ */
@@ -0,0 +1,22 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_SCALE_H_
+#define INC_ILI9341_SCALE_H_
+
+#include "main.h"
+
+/* Flags für ILI9341_DrawImageScaled */
+#define ILI9341_SCALE_NEAREST      0x00   // nächster Nachbar, Kanten bleiben scharf (Symbole, Pixelgrafik)
+#define ILI9341_SCALE_BILINEAR     0x01   // Mittelwert der vier nächsten Pixel (Fotos, Vorschaubilder)
+#define ILI9341_SCALE_ROTATE_0     0x00
+#define ILI9341_SCALE_ROTATE_90    0x02   // im Uhrzeigersinn
+#define ILI9341_SCALE_ROTATE_180   0x04
+#define ILI9341_SCALE_ROTATE_270   0x06
+#define ILI9341_SCALE_ROTATE_MASK  0x06
+
+uint8_t ILI9341_DrawImageScaled(int16_t x, int16_t y, uint16_t dstWidth, uint16_t dstHeight,
+                                const uint8_t *image, uint16_t width, uint16_t height, uint8_t flags);
+
+#endif /* INC_ILI9341_SCALE_H_ */
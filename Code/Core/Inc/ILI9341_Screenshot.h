@@ -0,0 +1,36 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_SCREENSHOT_H_
+#define INC_ILI9341_SCREENSHOT_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* Zeilen je Lesevorgang: 320 x 8 Pixel sind 7681 Bytes RX-DMA und bei 5,3 MHz etwa 12 ms Busbelegung */
+#define ILI9341_SCREENSHOT_BAND_ROWS   8
+
+/* Dateiname, wenn 'shot' keinen angibt */
+#define ILI9341_SCREENSHOT_DEFAULT_PATH "shot.bmp"
+
+/* Periode des Screenshot-Tasks; zwischen zwei Bändern zeichnet die UI ungehindert weiter */
+#define ILI9341_SCREENSHOT_TASK_MS     5
+
+/**
+ * @brief Ergebnis der letzten Aufnahme
+ */
+typedef struct {
+	FRESULT result;             // FR_OK oder Fehler von Öffnen/Schreiben/Schließen
+	uint8_t readErrors;         // fehlgeschlagene Lesevorgänge am Display (Aufnahme abgebrochen)
+	uint32_t bytes;             // Dateigröße
+	uint32_t durationMs;        // vom Start bis zum Schließen der Datei
+} ILI9341_ScreenshotStats;
+
+void ILI9341_Screenshot_Init(SPI_HandleTypeDef *hspi, uint8_t taskId);
+uint8_t ILI9341_Screenshot_Start(const char *path);
+uint8_t ILI9341_Screenshot_IsBusy(void);
+const ILI9341_ScreenshotStats* ILI9341_Screenshot_GetStats(void);
+void ILI9341_Screenshot_Task(void *context);
+
+#endif /* INC_ILI9341_SCREENSHOT_H_ */
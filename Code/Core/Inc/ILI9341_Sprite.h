@@ -0,0 +1,65 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_SPRITE_H_
+#define INC_ILI9341_SPRITE_H_
+
+#include "main.h"
+
+/**
+ * @brief Transparenz eines Sprites
+ */
+typedef enum {
+	ILI9341_SPRITE_OPAQUE = 0,  // Alle Pixel deckend (ILI9341_DrawImage mit Clipping)
+	ILI9341_SPRITE_KEY,         // Pixel mit der Farbe key sind durchsichtig
+	ILI9341_SPRITE_MASK         // 1-Bit-Maske, gesetztes Bit = deckend
+} ILI9341_SpriteMode;
+
+/**
+ * @brief Ein Sprite im RAM oder im Flash (Memory-Mapped, siehe Asset_LoadSprite())
+ *
+ * pixels sind RGB565 mit High-Byte zuerst wie bei ILI9341_DrawImage. Die Maske hat je Zeile
+ * (width + 7) / 8 Bytes, das höchste Bit ist das linke Pixel. Beide Puffer müssen gültig
+ * bleiben, bis die Übertragung fertig ist (ILI9341_WaitWhileBusy()).
+ */
+typedef struct {
+	uint16_t width;
+	uint16_t height;
+	const uint8_t *pixels;
+	const uint8_t *mask;        // nur ILI9341_SPRITE_MASK
+	uint16_t key;               // nur ILI9341_SPRITE_KEY
+	uint8_t mode;               // ILI9341_SpriteMode
+} ILI9341_Sprite;
+
+void ILI9341_Sprite_Init(ILI9341_Sprite *sprite, uint16_t width, uint16_t height, const uint8_t *pixels);
+void ILI9341_Sprite_SetKey(ILI9341_Sprite *sprite, uint16_t key);
+void ILI9341_Sprite_SetMask(ILI9341_Sprite *sprite, const uint8_t *mask);
+
+void ILI9341_Sprite_SetClip(int16_t x, int16_t y, uint16_t width, uint16_t height);
+void ILI9341_Sprite_ResetClip(void);
+
+uint32_t ILI9341_Sprite_Draw(const ILI9341_Sprite *sprite, int16_t x, int16_t y);
+uint32_t ILI9341_Sprite_Erase(const ILI9341_Sprite *sprite, int16_t x, int16_t y, uint16_t colour);
+uint32_t ILI9341_Sprite_Move(const ILI9341_Sprite *sprite, int16_t fromX, int16_t fromY, int16_t toX, int16_t toY,
+		uint16_t background);
+
+/**
+ * @brief  Prüft, ob ein Pixel des Sprites deckend ist (Koordinaten im Sprite)
+ */
+static inline uint8_t ILI9341_Sprite_IsOpaque(const ILI9341_Sprite *sprite, int16_t col, int16_t row) {
+	switch (sprite->mode) {
+		case ILI9341_SPRITE_KEY: {
+			const uint8_t *p = sprite->pixels + ((uint32_t)row * sprite->width + col) * 2;
+			return (uint16_t)((p[0] << 8) | p[1]) != sprite->key;
+		}
+		case ILI9341_SPRITE_MASK: {
+			uint16_t stride = (sprite->width + 7) / 8;
+			return (sprite->mask[(uint32_t)row * stride + col / 8] & (0x80 >> (col & 7))) != 0;
+		}
+		default:
+			return 1;
+	}
+}
+
+#endif /* INC_ILI9341_SPRITE_H_ */
@@ -0,0 +1,57 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_TE_H_
+#define INC_ILI9341_TE_H_
+
+#include "main.h"
+
+/* Tearing-Effect-Leitung an DISPLAY_TE. Der Host-Build (Host/) setzt ILI9341_NO_TE, dort gibt es weder Leitung noch Scheduler. */
+#ifndef ILI9341_NO_TE
+#define ILI9341_USE_TE
+#endif
+
+/* Ohne Flanke so lange gilt das TE-Signal als nicht angeschlossen, gezeichnet wird dann frei laufend */
+#define ILI9341_TE_TIMEOUT_MS        40
+
+/* So lange nach einer Flanke darf eine Übertragung noch ohne Warten beginnen */
+#define ILI9341_TE_START_WINDOW_US   1000
+
+/**
+ * @brief Zähler des TE-Signals seit ILI9341_TE_Enable()
+ */
+typedef struct {
+	uint32_t edges;             // Flanken (Beginn der vertikalen Austastlücke)
+	uint32_t periodUs;          // Gemittelte Bildwiederholzeit des Panels
+	uint32_t frames;            // Takte der Bildratenbindung (jede divider-te Flanke)
+	uint32_t missed;            // Takte, die der Aufrufer nicht abgeholt hat
+	uint32_t waits;             // Übertragungen, die auf eine Flanke gewartet haben
+	uint32_t waitUsMax;         // Längstes Warten
+	uint32_t timeouts;          // Warten ohne Flanke abgebrochen
+} ILI9341_TEStats;
+
+#ifdef ILI9341_USE_TE
+
+void ILI9341_TE_Enable(uint8_t enable);
+uint8_t ILI9341_TE_IsActive(void);
+void ILI9341_TE_Callback(uint16_t GPIO_Pin);
+
+/* --------------------------------- Bildratenbindung --------------------------------- */
+void ILI9341_TE_SetPacing(uint8_t divider, uint8_t taskId);
+uint8_t ILI9341_TE_TakeFrame(void);
+
+/* --------------------------------- Übertragungen an der Flanke starten --------------------------------- */
+uint8_t ILI9341_TE_Wait(void);
+void ILI9341_TE_Sync(void);
+
+void ILI9341_TE_GetStats(ILI9341_TEStats *stats);
+
+#else
+
+#define ILI9341_TE_TakeFrame()   (1)
+#define ILI9341_TE_Sync()        ((void)0)
+
+#endif /* ILI9341_USE_TE */
+
+#endif /* INC_ILI9341_TE_H_ */
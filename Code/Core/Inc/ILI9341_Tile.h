@@ -0,0 +1,61 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_TILE_H_
+#define INC_ILI9341_TILE_H_
+
+#include "main.h"
+#include "ILI9341_Sprite.h"
+
+/* Kachel-Renderer für Builds ohne Framebuffer (ca. 10 KB statt 150 KB). Auskommentieren, um den Speicher freizugeben. */
+#define ILI9341_USE_TILES
+
+/* Kantenlänge einer Kachel in Pixeln; zwei Kachelpuffer liegen in .dma_buffer */
+#define ILI9341_TILE_SIZE          32
+
+/* Zeichenbefehle, die ein Bild aufnehmen kann; danach wird sofort gerendert und direkt weitergezeichnet */
+#define ILI9341_TILE_MAX_COMMANDS  256
+
+/* Kacheln für die größere Ausrichtung (320 / 32 x 320 / 32 deckt Hoch- und Querformat ab) */
+#define ILI9341_TILE_GRID          ((320 + ILI9341_TILE_SIZE - 1) / ILI9341_TILE_SIZE)
+#define ILI9341_TILE_MAX           (ILI9341_TILE_GRID * ILI9341_TILE_GRID)
+
+/**
+ * @brief Zähler des Kachel-Renderers seit dem Start bzw. dem letzten Zurücksetzen
+ */
+typedef struct {
+	uint32_t frames;            // Abgeschlossene Bilder (ILI9341_Tile_End)
+	uint32_t commands;          // Aufgenommene Zeichenbefehle
+	uint32_t tilesSent;         // Gerasterte und übertragene Kacheln
+	uint32_t tilesSkipped;      // Kacheln, deren Befehle sich nicht geändert haben
+	uint32_t overflows;         // Bilder, die mehr als ILI9341_TILE_MAX_COMMANDS Befehle hatten
+} ILI9341_TileStats;
+
+#ifdef ILI9341_USE_TILES
+
+/* --------------------------------- Bild aufnehmen --------------------------------- */
+uint8_t ILI9341_Tile_Begin(uint16_t background);
+uint8_t ILI9341_Tile_IsRecording(void);
+uint16_t ILI9341_Tile_End(void);
+
+void ILI9341_Tile_Invalidate(int16_t x, int16_t y, int16_t w, int16_t h);
+void ILI9341_Tile_InvalidateAll(void);
+void ILI9341_Tile_GetStats(ILI9341_TileStats *stats, uint8_t reset);
+
+/* --------------------------------- Zeichenbefehle --------------------------------- */
+/* Werden von den ILI9341-Funktionen während der Aufnahme aufgerufen; 0 = nicht aufgenommen, direkt zeichnen */
+uint8_t ILI9341_Tile_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colour);
+uint8_t ILI9341_Tile_Image(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image);
+uint8_t ILI9341_Tile_Image16(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint16_t *pixels);
+uint8_t ILI9341_Tile_ImageRegion(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image,
+		uint16_t stride);
+uint8_t ILI9341_Tile_Glyph(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t size,
+		const uint8_t *columns, uint16_t colour, uint16_t background);
+uint8_t ILI9341_Tile_Sprite(const ILI9341_Sprite *sprite, int16_t x, int16_t y, int16_t x1, int16_t y1,
+		int16_t x2, int16_t y2, uint8_t fill, uint16_t colour);
+uint8_t ILI9341_Tile_Blend(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colour, uint8_t alpha);
+
+#endif /* ILI9341_USE_TILES */
+
+#endif /* INC_ILI9341_TILE_H_ */
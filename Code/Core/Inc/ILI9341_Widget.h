@@ -0,0 +1,143 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_ILI9341_WIDGET_H_
+#define INC_ILI9341_WIDGET_H_
+
+#include "main.h"
+
+/* Anzahl Widgets, die ILI9341_Widget_Add() aufnimmt */
+#define ILI9341_WIDGET_MAX        16
+
+/* Längster Text eines Labels, Werts oder Buttons (53 Zeichen = 320 Pixel bei Größe 1) */
+#define ILI9341_WIDGET_TEXT_MAX   53
+
+/* Zeilenabstand einer Liste zusätzlich zur Zeichenhöhe, in Pixeln */
+#define ILI9341_WIDGET_LIST_PAD   4
+
+/* Sichtbare Zeilen einer Liste höchstens (Bitmaske der geänderten Zeilen); bei Größe 1 passen 26 */
+#define ILI9341_WIDGET_LIST_ROWS  32
+
+/**
+ * @brief Art eines Widgets
+ */
+typedef enum {
+	ILI9341_WIDGET_LABEL = 0,   // Text
+	ILI9341_WIDGET_VALUE,       // Zahl als Festkomma mit Einheit
+	ILI9341_WIDGET_BAR,         // Waagerechter Balken zwischen min und max
+	ILI9341_WIDGET_GAUGE,       // Runde Anzeige mit Zeiger über 270 Grad und Zahlenwert
+	ILI9341_WIDGET_BUTTON,      // Abgerundete Schaltfläche mit Text, gedrückt invertiert
+	ILI9341_WIDGET_LIST         // Textzeilen mit hervorgehobenem Eintrag, scrollt mit der Auswahl
+} ILI9341_WidgetType;
+
+/**
+ * @brief Ausrichtung des Textes in Label, Wert und Button
+ */
+typedef enum {
+	ILI9341_WIDGET_ALIGN_LEFT = 0,
+	ILI9341_WIDGET_ALIGN_CENTER,
+	ILI9341_WIDGET_ALIGN_RIGHT
+} ILI9341_WidgetAlign;
+
+/**
+ * @brief Datenquelle einer Liste: schreibt den Text von Eintrag index nach text
+ *
+ * Wird nur für sichtbare Zeilen und nur beim Zeichnen aufgerufen, die Einträge müssen also nicht
+ * im RAM liegen (z.B. DirList_Source() für ein Verzeichnis der SD-Karte).
+ *
+ * @retval 0, wenn der Eintrag nicht gelesen werden konnte (Zeile bleibt leer)
+ */
+typedef uint8_t (*ILI9341_WidgetSource)(void *context, uint16_t index, char *text, uint8_t size);
+
+/**
+ * @brief Text, wie er zuletzt auf dem Display gezeichnet wurde
+ *
+ * Mit der Grundschrift (feste Breite) liegt jedes Zeichen in einer eigenen Zelle. Bleibt der
+ * Anfang auf demselben Zellraster, werden nur die Zellen neu gezeichnet, deren Zeichen sich
+ * geändert haben.
+ */
+typedef struct {
+	char shown[ILI9341_WIDGET_TEXT_MAX + 1];
+	int16_t shownX;
+	uint8_t shownLength;
+	uint8_t valid;              // 0: Textbereich ist unbekannt (z.B. vom Zeiger übermalt)
+} ILI9341_WidgetText;
+
+/**
+ * @brief Ein Widget; Speicher gehört dem Aufrufer (statisch), angemeldet mit ILI9341_Widget_Add()
+ *
+ * Die Setter vergleichen mit dem gewünschten Zustand und merken Änderungen nur vor, gezeichnet
+ * wird erst in ILI9341_Widget_Render(). Felder nicht direkt ändern.
+ */
+typedef struct {
+	ILI9341_WidgetType type;
+	int16_t x;
+	int16_t y;
+	uint16_t width;
+	uint16_t height;
+	uint16_t colour;            // Text, Balken, Zeiger
+	uint16_t background;
+	uint16_t accent;            // Rahmen, Skala, Auswahl, gedrückter Button
+	uint8_t size;               // Skalierung der Grundschrift (1 = 6x8 Pixel)
+	uint8_t align;              // ILI9341_WidgetAlign
+	uint8_t redraw;             // Ganzes Widget neu zeichnen (Hintergrund, Rahmen)
+	uint8_t changed;            // Zustand weicht vom gezeichneten ab
+
+	char text[ILI9341_WIDGET_TEXT_MAX + 1];
+	ILI9341_WidgetText drawn;
+
+	int32_t value;              // Wert, Balken, Zeiger
+	int32_t min;
+	int32_t max;
+	uint8_t decimals;           // Nachkommastellen von value beim Wert und der Zeigeranzeige
+	const char *unit;
+	int16_t shownPosition;      // Gezeichnete Balkenlänge bzw. Zeigerwinkel in Grad
+
+	uint8_t pressed;
+	uint8_t shownPressed;
+
+	ILI9341_WidgetSource source;
+	void *sourceContext;
+	uint16_t itemCount;
+	uint16_t selected;
+	uint16_t top;               // Erster sichtbarer Eintrag
+	uint16_t shownSelected;
+	uint16_t shownTop;
+	uint32_t dirtyRows;         // Geänderte Einträge, Bit n = Zeile n ab shownTop
+	uint16_t scrollOffset;      // Speicherzeile der obersten Zeile relativ zu y (Hardware-Scrolling)
+	uint8_t hardwareScroll;
+
+	uint32_t renderCycles;      // Zeichnen beim letzten Render, in dem das Widget geändert war (CPU-Takte)
+	uint32_t maxRenderCycles;
+	uint32_t overruns;          // Bilder über dem Budget (Canvas.h), in denen es am längsten zeichnete
+} ILI9341_Widget;
+
+void ILI9341_Widget_Init(ILI9341_Widget *widget, ILI9341_WidgetType type, int16_t x, int16_t y,
+		uint16_t width, uint16_t height);
+void ILI9341_Widget_SetStyle(ILI9341_Widget *widget, uint16_t colour, uint16_t background, uint16_t accent,
+		uint8_t size);
+void ILI9341_Widget_SetAlign(ILI9341_Widget *widget, ILI9341_WidgetAlign align);
+void ILI9341_Widget_SetText(ILI9341_Widget *widget, const char *text);
+void ILI9341_Widget_SetRange(ILI9341_Widget *widget, int32_t min, int32_t max);
+void ILI9341_Widget_SetFormat(ILI9341_Widget *widget, uint8_t decimals, const char *unit);
+void ILI9341_Widget_SetValue(ILI9341_Widget *widget, int32_t value);
+void ILI9341_Widget_SetPressed(ILI9341_Widget *widget, uint8_t pressed);
+void ILI9341_Widget_SetItems(ILI9341_Widget *widget, const char *const *items, uint16_t count);
+void ILI9341_Widget_SetSource(ILI9341_Widget *widget, ILI9341_WidgetSource source, void *context, uint16_t count);
+void ILI9341_Widget_SetCount(ILI9341_Widget *widget, uint16_t count);
+void ILI9341_Widget_InvalidateItem(ILI9341_Widget *widget, uint16_t index);
+uint8_t ILI9341_Widget_SetHardwareScroll(ILI9341_Widget *widget, uint8_t enable);
+void ILI9341_Widget_Select(ILI9341_Widget *widget, uint16_t index);
+
+uint8_t ILI9341_Widget_Add(ILI9341_Widget *widget);
+void ILI9341_Widget_Invalidate(ILI9341_Widget *widget);
+void ILI9341_Widget_InvalidateAll(void);
+uint8_t ILI9341_Widget_Render(void);
+
+const ILI9341_Widget* ILI9341_Widget_Get(uint8_t index);
+uint8_t ILI9341_Widget_GetWorst(uint8_t *indices, uint8_t max);
+void ILI9341_Widget_ResetStats(void);
+void ILI9341_Widget_Dump(void);
+
+#endif /* INC_ILI9341_WIDGET_H_ */
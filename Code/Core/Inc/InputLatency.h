@@ -0,0 +1,57 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_INPUTLATENCY_H_
+#define INC_INPUTLATENCY_H_
+
+#include "main.h"
+
+/* Zeit von der Flanke am Eingang bis zum Ende der TFT-Übertragung, 0 entfernt alle Messpunkte */
+#ifndef INPUT_LATENCY_ENABLE
+#define INPUT_LATENCY_ENABLE      1
+#endif
+
+/* Histogramm der Gesamtzeit, der letzte Eimer zählt alles darüber */
+#define INPUT_LATENCY_BINS        32
+#define INPUT_LATENCY_BIN_US      2000UL
+
+/* Abschnitte einer Messung */
+typedef enum {
+	INPUT_LATENCY_QUEUE = 0,    ///< Flanke (EXTI) bis Task_UserInput das Ereignis abholt
+	INPUT_LATENCY_WAIT,         ///< bis Canvas_FrameFlush() das TFT startet (Bildtakt, Zeichnen)
+	INPUT_LATENCY_TRANSFER,     ///< bis der letzte DMA-Block beim ILI9341 ist
+	INPUT_LATENCY_STAGES
+} InputLatency_Stage;
+
+typedef struct {
+	uint32_t count;             ///< abgeschlossene Messungen
+	uint32_t merged;            ///< Eingaben, die mit einer früheren in dasselbe Bild gingen
+	uint32_t minUs;
+	uint32_t maxUs;
+	uint64_t sumUs;
+	uint64_t stageSumUs[INPUT_LATENCY_STAGES];
+	uint32_t stageMaxUs[INPUT_LATENCY_STAGES];
+	uint32_t bins[INPUT_LATENCY_BINS];
+} InputLatency_Stats;
+
+#if INPUT_LATENCY_ENABLE
+
+void InputLatency_Arm(uint32_t edgeUs);
+void InputLatency_Flush(void);
+void InputLatency_Photon(void);
+void InputLatency_Reset(void);
+const InputLatency_Stats* InputLatency_GetStats(void);
+void InputLatency_Dump(void);
+
+#else
+
+#define InputLatency_Arm(edgeUs)  ((void)0)
+#define InputLatency_Flush()      ((void)0)
+#define InputLatency_Photon()     ((void)0)
+#define InputLatency_Reset()      ((void)0)
+#define InputLatency_Dump()       ((void)0)
+
+#endif /* INPUT_LATENCY_ENABLE */
+
+#endif /* INC_INPUTLATENCY_H_ */
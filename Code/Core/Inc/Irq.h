@@ -0,0 +1,124 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_IRQ_H_
+#define INC_IRQ_H_
+
+#include "main.h"
+#include "Trace.h"
+
+/* Laufzeit und Latenz der Interrupts mit dem DWT-Zykluszähler, 0 entfernt alle Messpunkte */
+#ifndef IRQ_STAT_ENABLE
+#define IRQ_STAT_ENABLE           1
+#endif
+
+/*
+ * Prioritätenplan (NVIC_PRIORITYGROUP_4: 16 Stufen Preemption, keine Subpriorität, 0 = höchste).
+ * CubeMX legt im MSP-Code alles auf 0/0; Irq_Init() setzt danach diese Werte. Eine Stufe
+ * unterbricht nur die darunter, Interrupts derselben Stufe laufen nacheinander. Deshalb liegen
+ * ein Peripherie-Interrupt und sein DMA-Stream immer auf derselben Stufe (gemeinsame HAL-
+ * Callbacks), ebenso alles, was Scheduler_Release() oder UserInput aufruft, mit TIM7.
+ */
+#define IRQ_PRIO_HAL_TICK         TICK_INT_PRIORITY   // SysTick (HAL_GetTick), wenige Takte
+#define IRQ_PRIO_WS2812           1       // TIM1 + DMA2 S7: nächste LED-Bits vor Ablauf der Hälfte
+#define IRQ_PRIO_REALTIME         2       // TIM7-Tick, TIM5-Zeitbasis, EXTI (Taster, TE des Displays), Abtast-DMA der Taster, RTC-Wecker, UART4 + DMA (Gamepad)
+#define IRQ_PRIO_ADC              3       // ADC1 + DMA1 S0, Blöcke der Potis
+#define IRQ_PRIO_CAN              4       // FDCAN1, Empfangs-FIFO läuft sonst über
+#define IRQ_PRIO_SHELL            5       // LPUART1 + BDMA2 C0/C1, USB OTG_HS
+#define IRQ_PRIO_DISPLAY          6       // SPI1 + DMA2 S6 (ILI9341), SPI4 + DMA1 S2 (LED-Matrix)
+#define IRQ_PRIO_STORAGE          7       // SDMMC1, OCTOSPI1, MDMA
+#define IRQ_PRIO_I2C              8       // I2C1 + DMA2 S5, I2C2
+#define IRQ_PRIO_LOG              9       // UART7 + DMA1 S1 (printf)
+#define IRQ_PRIO_BACKGROUND       10      // TIM6, neue Streams ohne eigene Anforderung
+
+/**
+ * @brief Messpunkte je Interrupt-Handler. Einen Eintrag teilen sich nur Handler derselben Stufe,
+ *        sonst könnte einer den anderen mitten in der Aufzeichnung unterbrechen.
+ *        Neue Einträge auch in Irq_Names (Irq.c) ergänzen.
+ */
+typedef enum {
+	IRQ_ID_TIM7 = 0,
+	IRQ_ID_EXTI,              // EXTI9_5 und EXTI15_10
+	IRQ_ID_UART4,
+	IRQ_ID_TIM1,              // BRK, UP, TRG_COM, CC
+	IRQ_ID_ADC,
+	IRQ_ID_FDCAN1,
+	IRQ_ID_LPUART1,
+	IRQ_ID_OTG_HS,
+	IRQ_ID_SPI1,
+	IRQ_ID_SPI4,
+	IRQ_ID_SDMMC1,
+	IRQ_ID_OCTOSPI1,
+	IRQ_ID_I2C1,              // EV und ER
+	IRQ_ID_I2C2,              // EV und ER
+	IRQ_ID_UART7,
+	IRQ_ID_TIM6,
+	IRQ_ID_COUNT
+} Irq_Id;
+
+/**
+ * @brief Statistik eines Handlers in CPU-Takten, ohne die Zeit in verschachtelten Interrupts
+ */
+typedef struct {
+	uint32_t count;
+	uint32_t max;
+	uint64_t total;
+	uint32_t latencyMax;      // nur wo die Hardware den Zeitpunkt des Ereignisses kennt (TIM7)
+	uint64_t latencyTotal;
+} Irq_Stat;
+
+/**
+ * @brief Zustand eines laufenden Handlers zwischen IRQ_ENTER() und IRQ_EXIT()
+ */
+typedef struct {
+	uint32_t start;
+	uint32_t inner;
+} Irq_Frame;
+
+void Irq_Init(void);
+
+#if IRQ_STAT_ENABLE
+
+extern volatile uint32_t Irq_Inner;
+extern volatile uint32_t Irq_StackLow;
+
+/**
+ * Misst einen Handler von IRQ_ENTER(id) am Anfang bis IRQ_EXIT(id) am Ende (beide im selben
+ * Block, in stm32h7xx_it.c in USER CODE ... 0 und 1). Die Takte verschachtelter Interrupts
+ * werden abgezogen. id muss ein Name aus Irq_Id sein. Beide Punkte gehen außerdem als
+ * Ereignis in den Trace (Trace.h), außerhalb der gemessenen Zeit.
+ */
+#define IRQ_ENTER(id)             Irq_Frame Irq_Frame_##id; TRACE_ISR_ENTER(id); Irq_Enter(&Irq_Frame_##id)
+#define IRQ_EXIT(id)              Irq_Record((id), Irq_Leave(&Irq_Frame_##id)); TRACE_ISR_EXIT(id)
+
+static inline void Irq_Enter(Irq_Frame *frame) {
+	uint32_t sp = __get_MSP();
+
+	// Deepest stack at entry for Stack_Dump(), a nested handler only lowers it further
+	if (sp < Irq_StackLow) Irq_StackLow = sp;
+	frame->inner = Irq_Inner;
+	frame->start = DWT->CYCCNT;
+}
+
+uint32_t Irq_Leave(const Irq_Frame *frame);
+void Irq_Record(Irq_Id id, uint32_t cycles);
+void Irq_RecordLatency(Irq_Id id, uint32_t cycles);
+void Irq_RecordTickLatency(void);
+void Irq_GetStat(Irq_Id id, Irq_Stat *stat);
+const char* Irq_GetName(Irq_Id id);
+void Irq_Reset(void);
+void Irq_Dump(void);
+
+#else
+
+#define IRQ_ENTER(id)             TRACE_ISR_ENTER(id)
+#define IRQ_EXIT(id)              TRACE_ISR_EXIT(id)
+
+#define Irq_RecordTickLatency()   ((void)0)
+#define Irq_Reset()               ((void)0)
+#define Irq_Dump()                ((void)0)
+
+#endif /* IRQ_STAT_ENABLE */
+
+#endif /* INC_IRQ_H_ */
@@ -9,6 +9,23 @@
 #define LED_MATRIX_SHUTDOWN_MODE 0
 #define LED_MATRIX_NORMAL_OPERATION 1
 
+/* Anzahl der MAX7219-Module in der Kette (DOUT an DIN des nächsten), Modul 0 hängt direkt am SPI4 */
+#define LED_MATRIX_MODULES 1
+
+/* Zeilen (Digit-Register) je Modul */
+#define LED_MATRIX_ROWS 8
+
+/* Schrittweite der Laufschrift in ms (Periode von LED_Matrix_scroll_task) und längster Text */
+#define LED_MATRIX_SCROLL_MS 60
+#define LED_MATRIX_SCROLL_TEXT_MAX 63
+
+/**
+ * @brief Bild der ganzen Kette: frame[Zeile][Modul], ein Byte je Zeile und Modul
+ *
+ * Jedes Bit ist eine LED der Zeile, wie bei LED_Matrix_draw_row().
+ */
+typedef uint8_t LED_Matrix_Frame[LED_MATRIX_ROWS][LED_MATRIX_MODULES];
+
 void LED_Matrix_send_command(uint8_t address, uint8_t data);
 
 void LED_Matrix_setup(void);
@@ -23,4 +40,38 @@ void LED_Matrix_set_intensity(uint8_t intensity);
 
 void LED_Matrix_draw_matrix(uint8_t matrix[8][8]);
 
+void LED_Matrix_set_pixel(uint8_t x, uint8_t y, uint8_t on);
+
+void LED_Matrix_set_row(uint8_t row, uint8_t module, uint8_t data);
+
+uint8_t LED_Matrix_get_row(uint8_t row, uint8_t module);
+
+void LED_Matrix_set_module(uint8_t module, const uint8_t rows[LED_MATRIX_ROWS]);
+
+void LED_Matrix_clear(void);
+
+uint8_t LED_Matrix_flush(void);
+
+uint8_t LED_Matrix_show(const LED_Matrix_Frame frame);
+
+uint8_t LED_Matrix_is_busy(void);
+
+void LED_Matrix_wait(void);
+
+void LED_Matrix_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+
+void LED_Matrix_SPI_ErrorCallback(SPI_HandleTypeDef *hspi);
+
+void LED_Matrix_set_complete_callback(void (*callback)(void));
+
+void LED_Matrix_scroll_init(uint8_t task_id);
+
+void LED_Matrix_scroll_text(const char *text);
+
+void LED_Matrix_scroll_stop(void);
+
+uint8_t LED_Matrix_is_scrolling(void);
+
+void LED_Matrix_scroll_task(void *context);
+
 #endif //LED_MATRIX_H
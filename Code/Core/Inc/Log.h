@@ -0,0 +1,102 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_LOG_H_
+#define INC_LOG_H_
+
+#include "main.h"
+#include <stdio.h>
+
+/* 0 = alle LOG()-Aufrufe werden leer übersetzt */
+#ifndef LOG_ENABLE
+#define LOG_ENABLE                1
+#endif
+
+/* Höchstens so viele Argumente je Meldung */
+#define LOG_MAX_ARGS              8
+
+/* Erstes Byte eines Datensatzes, kommt in UTF-8-Text nie vor */
+#define LOG_MARKER                0xFF
+
+/*
+ * Datensatz im Ausgabestrom (Little Endian, 8 + 4 * Argumente Bytes):
+ *   LOG_MARKER, Anzahl Argumente, Id (16 Bit), DWT->CYCCNT (32 Bit), Argumente je 32 Bit
+ * Die Id ist der Offset des Formatstrings im Abschnitt .log_str. Der Abschnitt wird nicht in
+ * den Flash geladen, Tools/log_decode.py liest ihn aus der ELF-Datei.
+ */
+
+#if LOG_ENABLE
+
+/*
+ * Meldung mit bis zu LOG_MAX_ARGS Argumenten, Formatstring wie bei printf:
+ *   LOG("SD-Karte: %lu Bytes frei\r\n", freeSpace);
+ * Erlaubt sind ganze Zahlen (%d %u %x %c ...), float/double (%f %e %g, übertragen als float)
+ * und %s für konstante Strings im Flash. Strings im RAM kann der Decoder nicht lesen.
+ */
+#define LOG(...)                  LOG_N(LOG_COUNT(__VA_ARGS__), __VA_ARGS__)
+
+#else
+
+/* Argumente werden nicht ausgewertet, gelten aber als benutzt */
+#define LOG(...)                  do { if (0) { (void)printf(__VA_ARGS__); } } while (0)
+
+#endif /* LOG_ENABLE */
+
+void Log_Init(void);
+void Log_Clock(void);
+void Log_Write(uint16_t id, const uint32_t *args, uint32_t count);
+
+/* Umwandlung der Argumente in 32-Bit-Worte, nur für die Makros */
+static inline uint32_t Log_IntArg(uint32_t value) {
+	return value;
+}
+
+static inline uint32_t Log_FloatArg(float value) {
+	union { float f; uint32_t u; } bits = { .f = value };
+	return bits.u;
+}
+
+static inline uint32_t Log_PointerArg(const void *value) {
+	return (uint32_t)(uintptr_t)value;
+}
+
+#define LOG_ARG(x)                _Generic((x), \
+		float: Log_FloatArg, double: Log_FloatArg, \
+		char *: Log_PointerArg, const char *: Log_PointerArg, \
+		default: Log_IntArg)(x)
+
+/* Formatstring in .log_str ablegen, seine Adresse ist die Id */
+#define LOG_FORMAT(fmt)           static const char Log_Format_[] __attribute__((section(".log_str"), used)) = fmt
+#define LOG_ID                    ((uint16_t)(uintptr_t)Log_Format_)
+
+#define LOG_COUNT(...)            LOG_COUNT_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0)
+#define LOG_COUNT_(fmt, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define LOG_N(n, ...)             LOG_N_(n, __VA_ARGS__)
+#define LOG_N_(n, ...)            LOG_WITH_##n(__VA_ARGS__)
+
+#define LOG_WITH_0(fmt)           do { LOG_FORMAT(fmt); Log_Write(LOG_ID, NULL, 0); } while (0)
+#define LOG_WITH_ARGS(n, fmt, ...) do { \
+		LOG_FORMAT(fmt); \
+		const uint32_t Log_Args_[n] = { LOG_ARGS_##n(__VA_ARGS__) }; \
+		Log_Write(LOG_ID, Log_Args_, n); \
+	} while (0)
+#define LOG_WITH_1(fmt, ...)      LOG_WITH_ARGS(1, fmt, __VA_ARGS__)
+#define LOG_WITH_2(fmt, ...)      LOG_WITH_ARGS(2, fmt, __VA_ARGS__)
+#define LOG_WITH_3(fmt, ...)      LOG_WITH_ARGS(3, fmt, __VA_ARGS__)
+#define LOG_WITH_4(fmt, ...)      LOG_WITH_ARGS(4, fmt, __VA_ARGS__)
+#define LOG_WITH_5(fmt, ...)      LOG_WITH_ARGS(5, fmt, __VA_ARGS__)
+#define LOG_WITH_6(fmt, ...)      LOG_WITH_ARGS(6, fmt, __VA_ARGS__)
+#define LOG_WITH_7(fmt, ...)      LOG_WITH_ARGS(7, fmt, __VA_ARGS__)
+#define LOG_WITH_8(fmt, ...)      LOG_WITH_ARGS(8, fmt, __VA_ARGS__)
+
+#define LOG_ARGS_1(a)             LOG_ARG(a)
+#define LOG_ARGS_2(a, ...)        LOG_ARG(a), LOG_ARGS_1(__VA_ARGS__)
+#define LOG_ARGS_3(a, ...)        LOG_ARG(a), LOG_ARGS_2(__VA_ARGS__)
+#define LOG_ARGS_4(a, ...)        LOG_ARG(a), LOG_ARGS_3(__VA_ARGS__)
+#define LOG_ARGS_5(a, ...)        LOG_ARG(a), LOG_ARGS_4(__VA_ARGS__)
+#define LOG_ARGS_6(a, ...)        LOG_ARG(a), LOG_ARGS_5(__VA_ARGS__)
+#define LOG_ARGS_7(a, ...)        LOG_ARG(a), LOG_ARGS_6(__VA_ARGS__)
+#define LOG_ARGS_8(a, ...)        LOG_ARG(a), LOG_ARGS_7(__VA_ARGS__)
+
+#endif /* INC_LOG_H_ */
@@ -0,0 +1,22 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_LOGCODEC_H_
+#define INC_LOGCODEC_H_
+
+#include <stdint.h>
+
+/* Größe der Hashtabelle des LZ4-Kompressors als Zweierexponent (2^n Einträge zu 2 Bytes) */
+#define LOGCODEC_LZ4_HASH_BITS    10
+
+/* Größte Eingabe von LogCodec_Lz4Compress(): Positionen in der Hashtabelle sind 16 Bit breit */
+#define LOGCODEC_LZ4_MAX_INPUT    65535U
+
+/* Schlechtester Fall von LogCodec_DeltaEncode(): drei Bytes je 16-Bit-Wert */
+#define LOGCODEC_DELTA_BOUND(count)   (3U * (count))
+
+uint32_t LogCodec_DeltaEncode(const uint8_t *values, uint32_t count, uint8_t channels, uint8_t *out);
+uint32_t LogCodec_Lz4Compress(const uint8_t *in, uint32_t length, uint8_t *out, uint32_t capacity);
+
+#endif /* INC_LOGCODEC_H_ */
@@ -0,0 +1,87 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_LOWPOWER_H_
+#define INC_LOWPOWER_H_
+
+#include "main.h"
+
+/* Längere Leerlaufphasen im Stop-Modus statt mit WFI im Run-Modus verbringen, 0 = nur WFI */
+#ifndef LOWPOWER_ENABLE
+#define LOWPOWER_ENABLE           1
+#endif
+
+/* Stop erst, wenn bis zur nächsten Freigabe mindestens so viele ms frei sind */
+#define LOWPOWER_MIN_MS           3
+
+/* So lange (ms) ohne Eingabe und CAN-Verkehr, bevor der Stop-Modus genutzt wird; während einer
+   Bedienung bleibt der Kern im Run-Modus */
+#define LOWPOWER_QUIET_MS         2000
+
+/* Der RTC-Wecker klingelt so viele µs vor der Freigabe: Zeit für PLL1 und den Rest der Millisekunde */
+#define LOWPOWER_WAKE_MARGIN_US   300
+
+/* Budget vom Aufwachen bis zum ersten Task: ein Bild des Panels (ca. 70 Hz, TE) */
+#define LOWPOWER_FRAME_US         14286
+
+/* Regler im Stop: Low-Power-Regler bei SVOS3, der Flash bleibt an (schnellstes Aufwachen) */
+#define LOWPOWER_REGULATOR        PWR_LOWPOWERREGULATOR_ON
+#define LOWPOWER_SVOS             PWR_REGULATOR_SVOS_SCALE3
+
+/* Speicher, die im Stop abgeschaltet werden dürfen (PWR_CR1_xxxSO): nur GFXMMU/JPEG, beide unbenutzt.
+   AXI-, AHB- und SRD-SRAM, ITCM und die Speicher von USB und FDCAN behalten ihren Inhalt */
+#define LOWPOWER_RAM_SHUTOFF      PWR_CR1_GFXSO
+
+/* Nenntakt des LSI, der die RTC treibt; der tatsächliche wird im Betrieb gegen TIM5 gemessen */
+#define LOWPOWER_LSI_HZ           32000UL
+#define LOWPOWER_LSI_TOLERANCE    15       // Prozent, weiter entfernte Messungen gelten als Fehler
+
+/* Wachzeit (µs), über die der LSI gegen TIM5 gemessen wird */
+#define LOWPOWER_CAL_US           1000000UL
+
+typedef struct {
+	uint32_t stops;                // Eintritte in den Stop-Modus
+	uint64_t stoppedUs;            // Zeit im Stop
+	uint32_t rtcWakes;             // vom RTC-Wecker beendet
+	uint32_t otherWakes;           // von EXTI (Joystick, TE) oder einem anderen Interrupt beendet
+	uint32_t blocked;              // Leerlauf lang genug, aber ein Transfer oder eine Verbindung lief
+	const char *blocker;           // zuletzt verhindert durch
+	uint32_t restoreUs;            // PLL1 wieder als SYSCLK, zuletzt
+	uint32_t restoreUsMax;
+	uint32_t restoreFailed;        // schneller Weg gescheitert, Clock_SetProfile() im Timer-Task
+	uint32_t interactiveUs;        // Aufwachen bis zum Start des ersten Tasks, zuletzt
+	uint32_t interactiveUsMax;
+	uint32_t overBudget;           // länger als LOWPOWER_FRAME_US
+	uint32_t lsiHz;                // gemessener Takt der RTC
+	uint32_t calibrations;
+} LowPower_Stats;
+
+#if LOWPOWER_ENABLE
+
+extern volatile uint8_t LowPower_WakePending;
+
+void LowPower_Init(void);
+void LowPower_SetEnabled(uint8_t enabled);
+uint8_t LowPower_IsEnabled(void);
+uint8_t LowPower_Stop(uint32_t sleepUs, uint32_t *sleptUs);
+void LowPower_Interactive(uint32_t cycle);
+const LowPower_Stats* LowPower_GetStats(void);
+void LowPower_ResetStats(void);
+void LowPower_Dump(void);
+
+/* Aus Scheduler_Dispatch() beim Start eines Tasks: beendet die Messung nach dem Aufwachen */
+#define LOWPOWER_TASK_START(cycle) do { if (LowPower_WakePending) LowPower_Interactive(cycle); } while (0)
+
+#else
+
+#define LowPower_Init()           ((void)0)
+#define LowPower_SetEnabled(on)   ((void)0)
+#define LowPower_IsEnabled()      (0U)
+#define LowPower_ResetStats()     ((void)0)
+#define LowPower_Dump()           ((void)0)
+#define LOWPOWER_TASK_START(cycle) ((void)0)
+
+#endif /* LOWPOWER_ENABLE */
+
+#endif /* INC_LOWPOWER_H_ */
@@ -0,0 +1,76 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_MIRROR_H_
+#define INC_MIRROR_H_
+
+#include "main.h"
+
+/* Bildspiegel: geänderte Bereiche des Framebuffers komprimiert an den PC, 0 = kein Schattenpuffer (150 KB) */
+#ifndef MIRROR_ENABLE
+#define MIRROR_ENABLE             1
+#endif
+
+/* Abstand der Timer-Callbacks, je Callback höchstens MIRROR_PACKETS_PER_TICK Pakete */
+#define MIRROR_TICK_MS            20
+#define MIRROR_PACKETS_PER_TICK   8
+
+/* Spätestens nach dieser Zeit ein vollständiges Bild, damit ein später gestarteter Betrachter aufholt */
+#define MIRROR_KEYFRAME_MS        10000
+
+/* Gesammelte Bereiche zwischen zwei Bildern, darüber hinaus wird zusammengefasst */
+#define MIRROR_MAX_RECTS          8
+
+/* Nutzdaten je Paket: über LPUART1 begrenzt durch TELEMETRY_MAX_PAYLOAD, über den ESP-Link frei */
+#define MIRROR_UART_PAYLOAD       240
+#define MIRROR_LINK_PAYLOAD       1024
+
+/* Kopf jedes Pakets: Bild (2), Flags (1), reserviert (1), x, y, Breite, Höhe (je 2), Startpixel (4) */
+#define MIRROR_HEADER_SIZE        16
+#define MIRROR_FLAG_KEY           0x01   // Schlüsselbild: Empfänger löscht zuerst auf 0
+#define MIRROR_FLAG_END           0x02   // letztes Paket des Bildes
+
+typedef enum {
+	MIRROR_OFF = 0,
+	MIRROR_UART,                   // Telemetriepakete TELEMETRY_PKT_MIRROR auf LPUART1
+	MIRROR_ESP                     // ESPLINK_CH_DISPLAY
+} Mirror_Transport;
+
+typedef struct {
+	uint32_t frames;               // vollständig gesendete Bilder
+	uint32_t keyframes;
+	uint32_t packets;
+	uint64_t bytes;                // Nutzdaten der Pakete
+	uint64_t pixels;               // davon abgedeckte Pixel (Größe der Bereiche)
+	uint32_t full;                 // Callback beendet, Sendeweg voll
+	uint32_t errors;               // Paket nicht angenommen, nächstes Bild ist ein Schlüsselbild
+	uint32_t merged;               // Bereiche zusammengefasst, weil MIRROR_MAX_RECTS voll war
+	uint32_t lastEncodeUs;         // Kodierung des letzten Bildes
+	uint32_t maxEncodeUs;
+} Mirror_Stats;
+
+#if MIRROR_ENABLE
+
+void Mirror_Init(void);
+uint8_t Mirror_Start(Mirror_Transport transport);
+void Mirror_Stop(void);
+Mirror_Transport Mirror_GetTransport(void);
+void Mirror_Keyframe(void);
+const Mirror_Stats* Mirror_GetStats(void);
+void Mirror_ResetStats(void);
+void Mirror_Dump(void);
+
+#else
+
+#define Mirror_Init()             ((void)0)
+#define Mirror_Start(transport)   (0U)
+#define Mirror_Stop()             ((void)0)
+#define Mirror_GetTransport()     (MIRROR_OFF)
+#define Mirror_Keyframe()         ((void)0)
+#define Mirror_ResetStats()       ((void)0)
+#define Mirror_Dump()             ((void)0)
+
+#endif /* MIRROR_ENABLE */
+
+#endif /* INC_MIRROR_H_ */
@@ -0,0 +1,48 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_OVERLAY_H_
+#define INC_OVERLAY_H_
+
+#include "main.h"
+
+/* Ablage der Overlays im W25Qxx direkt hinter dem Asset-Bundle; muss zu QSPI_OVL im
+ * Linkerskript passen, das FatFs-Laufwerk beginnt dahinter */
+#define OVERLAY_STORE_ADDRESS     0x00400000UL
+#define OVERLAY_STORE_SIZE        (256UL * 1024UL)
+
+/* Funktion in ein Overlay legen: läuft im ITCM (ITCM_OVL), liegt aber nur im W25Qxx.
+ * Aufrufer holen es vorher mit Overlay_Load() und geben es mit Overlay_Release() zurück.
+ * Aufrufe zwischen zwei Overlays verweigert der Linker (NOCROSSREFS). */
+#define OVERLAY(name)             __attribute__((section(".ovl_" #name), noinline))
+
+/**
+ * @brief Overlays in der Reihenfolge des Linkerskripts
+ */
+typedef enum {
+	OVERLAY_DSP,              // FFT und Spektrum (Dsp.c)
+	OVERLAY_JPEG,             // Dekodierung mit dem Hardware-Codec (ILI9341_Jpeg.c)
+	OVERLAY_COUNT
+} Overlay_Id;
+
+/**
+ * @brief Zähler des Overlay-Managers
+ */
+typedef struct {
+	uint32_t loads;           // Kopien per MDMA in das ITCM
+	uint32_t hits;            // Overlay_Load() mit schon geladenem Overlay
+	uint32_t refused;         // Bereich war von einem anderen Overlay belegt
+	uint32_t failures;        // Ablage ungültig oder MDMA-Fehler
+	uint32_t lastLoadUs;
+	uint32_t maxLoadUs;
+} Overlay_Stats;
+
+extern Overlay_Stats Overlay_Statistics;
+
+uint8_t Overlay_Init(void);
+uint8_t Overlay_Load(Overlay_Id id);
+void Overlay_Release(Overlay_Id id);
+void Overlay_Dump(void);
+
+#endif /* INC_OVERLAY_H_ */
@@ -12,4 +12,36 @@ typedef struct Pin{
     uint16_t GPIO_Pin;
 }Pin;
 
+/**
+ * Bindet einen Pin aus main.h zur Übersetzungszeit: PIN(DISPLAY_CS) ergibt
+ * {DISPLAY_CS_GPIO_Port, DISPLAY_CS_Pin}. Mit den Funktionen unten wird daraus
+ * ein einzelner Schreibzugriff auf BSRR mit konstanter Adresse, ohne HAL-Aufruf.
+ */
+#define PIN(name) ((Pin){ name##_GPIO_Port, name##_Pin })
+
+/**
+ * Setzt den Pin auf HIGH (atomar über BSRR, auch aus Interrupts).
+ */
+static inline void Pin_High(Pin pin) {
+    pin.GPIOx->BSRR = pin.GPIO_Pin;
+}
+
+/**
+ * Setzt den Pin auf LOW (obere Hälfte von BSRR).
+ */
+static inline void Pin_Low(Pin pin) {
+    pin.GPIOx->BSRR = (uint32_t)pin.GPIO_Pin << 16;
+}
+
+static inline void Pin_Write(Pin pin, uint8_t state) {
+    pin.GPIOx->BSRR = state ? pin.GPIO_Pin : (uint32_t)pin.GPIO_Pin << 16;
+}
+
+/**
+ * Liefert den ausgegebenen Pegel (ODR), nicht den gelesenen.
+ */
+static inline uint8_t Pin_IsHigh(Pin pin) {
+    return (pin.GPIOx->ODR & pin.GPIO_Pin) != 0;
+}
+
 #endif //CLIONTEST_PIN_H
@@ -0,0 +1,111 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_PIPE_H_
+#define INC_PIPE_H_
+
+#include "main.h"
+
+/* Gleichzeitig umlaufende Puffer (Deskriptoren), aus Quellen und Pipe_Alloc() zusammen */
+#define PIPE_BUFFERS          16
+
+/* Plätze in der Eingangswarteschlange einer Stufe (Zweierpotenz) */
+#define PIPE_QUEUE_DEPTH      8
+
+/* Nachfolger je Stufe: so viele Empfänger bekommen denselben Puffer ohne Kopie */
+#define PIPE_MAX_OUTPUTS      4
+
+/* Angemeldete Stufen aller Pipelines zusammen */
+#define PIPE_MAX_STAGES       12
+
+/* Periode des Tasks in ms; jede eingereihte Übergabe gibt ihn sofort frei, die Periode ist nur Rückfallebene */
+#define PIPE_TASK_MS          100
+
+typedef struct Pipe_Buffer Pipe_Buffer;
+typedef struct Pipe_Stage Pipe_Stage;
+
+/**
+ * @brief Gibt einen fremden Puffer an seine Quelle zurück (z.B. ADC_ReleaseBlock()), darf im Interrupt laufen
+ */
+typedef void (*Pipe_ReleaseFunction)(Pipe_Buffer *buffer);
+
+/**
+ * @brief Verarbeitet einen Puffer; läuft im Pipe-Task bzw. bei PIPE_STAGE_INLINE im Kontext des Erzeugers
+ *
+ * Die Stufe hält für die Dauer des Aufrufs eine Referenz. Weiterreichen mit Pipe_Emit(), behalten
+ * über den Aufruf hinaus mit Pipe_Retain() (später Pipe_Release()).
+ */
+typedef void (*Pipe_StageFunction)(Pipe_Stage *stage, Pipe_Buffer *buffer);
+
+/**
+ * @brief Deskriptor eines Puffers in Umlauf, Referenzen zählen Warteschlangenplätze und Halter
+ */
+struct Pipe_Buffer {
+	void *data;
+	uint32_t length;            // gültige Bytes in data
+	uint32_t sequence;          // laufende Nummer der Quelle
+	uint64_t timeUs;            // Timebase_Us() beim Erzeugen
+	const void *meta;           // Beschreibung der Quelle, z.B. der ADC_Block
+	Pipe_ReleaseFunction release; // NULL: data stammt aus Pool_Alloc()
+	void *owner;                // für release
+	volatile uint8_t refs;
+};
+
+/**
+ * @brief Zähler einer Stufe
+ */
+typedef struct {
+	uint32_t in;                // angenommene Puffer
+	uint32_t out;               // an Nachfolger übergebene Referenzen
+	uint32_t drops;             // abgewiesen, weil die Warteschlange voll war (Rückstau)
+	uint32_t blocked;           // Pipe_Emit(), bei dem mindestens ein Nachfolger voll war
+	uint32_t bytes;             // verarbeitete Bytes
+	uint64_t cycles;            // Takte in der Stufenfunktion
+	uint32_t maxCycles;
+	uint8_t maxDepth;           // höchster Füllstand der Warteschlange
+} Pipe_StageStats;
+
+/* Die Stufe läuft direkt in Pipe_Push() statt im Task (kurze Arbeit im Interrupt des Erzeugers) */
+#define PIPE_STAGE_INLINE     0x01
+
+/**
+ * @brief Eine Stufe: Quelle (function NULL, nur Verteiler), Verarbeitung oder Senke (ohne Nachfolger)
+ *
+ * Speicher gehört dem Aufrufer (statisch); Pipe_AddStage() füllt alle Felder.
+ */
+struct Pipe_Stage {
+	const char *name;
+	Pipe_StageFunction function;
+	void *context;
+	uint8_t flags;
+	uint8_t outputCount;
+	Pipe_Stage *outputs[PIPE_MAX_OUTPUTS];
+	Pipe_Buffer *queue[PIPE_QUEUE_DEPTH];
+	volatile uint32_t head;     // schreiben nur unter gesperrten Interrupts
+	volatile uint32_t tail;     // schreibt nur der Verbraucher
+	Pipe_StageStats stats;
+};
+
+void Pipe_Init(uint8_t taskId);
+uint8_t Pipe_AddStage(Pipe_Stage *stage, const char *name, Pipe_StageFunction function, void *context, uint8_t flags);
+uint8_t Pipe_Connect(Pipe_Stage *from, Pipe_Stage *to);
+
+Pipe_Buffer* Pipe_Alloc(uint32_t size);
+Pipe_Buffer* Pipe_Wrap(void *data, uint32_t length, Pipe_ReleaseFunction release, void *owner);
+void Pipe_Retain(Pipe_Buffer *buffer);
+void Pipe_Release(Pipe_Buffer *buffer);
+
+uint8_t Pipe_Push(Pipe_Stage *stage, Pipe_Buffer *buffer);
+uint8_t Pipe_Emit(Pipe_Stage *stage, Pipe_Buffer *buffer);
+uint8_t Pipe_Room(const Pipe_Stage *stage);
+
+uint8_t Pipe_AttachAdc(Pipe_Stage *source);
+
+void Pipe_Task(void *context);
+uint8_t Pipe_GetStageCount(void);
+Pipe_Stage* Pipe_GetStage(uint8_t index);
+void Pipe_ResetStats(void);
+void Pipe_Dump(void);
+
+#endif /* INC_PIPE_H_ */
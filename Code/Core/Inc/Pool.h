@@ -0,0 +1,31 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_POOL_H_
+#define INC_POOL_H_
+
+#include "main.h"
+
+/* Größe eines Blocks in Bytes, Vielfaches der Cache-Zeile (32) */
+#define POOL_BLOCK_SIZE     256
+
+/* Anzahl Blöcke (zusammen POOL_BLOCK_SIZE * POOL_BLOCK_COUNT Bytes in RAM_CD), höchstens 255 */
+#define POOL_BLOCK_COUNT    8
+
+/**
+ * @brief Zähler des Pools seit dem Start
+ */
+typedef struct {
+	uint32_t allocs;            // Erfolgreiche Pool_Alloc()
+	uint32_t failures;          // Pool_Alloc() ohne freien Block oder zu groß
+	uint32_t largest;           // Größte angeforderte Länge
+	uint8_t inUse;              // Belegte Blöcke
+	uint8_t highWater;          // Höchstens gleichzeitig belegte Blöcke
+} Pool_Stats;
+
+void* Pool_Alloc(uint32_t size);
+void Pool_Free(void *block);
+void Pool_GetStats(Pool_Stats *stats);
+
+#endif /* INC_POOL_H_ */
@@ -0,0 +1,86 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_PROF_H_
+#define INC_PROF_H_
+
+#include "main.h"
+
+/* Laufzeitmessung mit dem DWT-Zykluszähler, 0 entfernt alle Messpunkte aus dem Code */
+#ifndef PROF_ENABLE
+#define PROF_ENABLE               1
+#endif
+
+/* Zeichen auf UART7, die Prof_PollCommand() auswertet */
+#define PROF_CMD_DUMP             'p'     // Tabelle ausgeben
+#define PROF_CMD_RESET            'r'     // Statistik zurücksetzen
+#define PROF_CMD_OVERLAY          'o'     // Anzeige auf dem Display ein/aus
+#define PROF_CMD_TASKS            's'     // Statistik des Schedulers ausgeben
+
+/* Position und Schriftgröße der Anzeige auf dem ILI9341 */
+#define PROF_OVERLAY_X            0
+#define PROF_OVERLAY_Y            160
+#define PROF_OVERLAY_SIZE         1
+
+/**
+ * @brief Messpunkte, je Subsystem einer. Neue Einträge auch in Prof_Names (Prof.c) ergänzen.
+ */
+typedef enum {
+	PROF_ID_MAIN_LOOP = 0,    // ein Durchlauf der Hauptschleife
+	PROF_ID_FB_FLUSH,         // ILI9341_FB_Flush()
+	PROF_ID_JPEG,             // ILI9341_DrawJpeg()
+	PROF_ID_SDQUEUE,          // SDQueue_Service()
+	PROF_ID_AHT20,            // AHT20_Service() im Task
+	PROF_ID_WS2812,           // WS2812_Show()
+	PROF_ID_DSP,              // Dsp_Process()
+	PROF_ID_WIDGETS,          // ILI9341_Widget_Render()
+	PROF_ID_COUNT
+} Prof_Id;
+
+/**
+ * @brief Statistik eines Messpunkts in CPU-Takten
+ */
+typedef struct {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+} Prof_Probe;
+
+#if PROF_ENABLE
+
+extern Prof_Probe Prof_Probes[PROF_ID_COUNT];
+
+/**
+ * Misst die Zeit zwischen PROF_BEGIN(id) und PROF_END(id) im selben Block.
+ * Der Startwert liegt in einer lokalen Variable, dadurch dürfen sich Messpunkte
+ * verschachteln und auch in Interrupts stehen. id muss ein Name aus Prof_Id sein.
+ * Beispiel: PROF_BEGIN(PROF_ID_FB_FLUSH); ... PROF_END(PROF_ID_FB_FLUSH);
+ */
+#define PROF_BEGIN(id)            uint32_t Prof_Start_##id = DWT->CYCCNT
+#define PROF_END(id)              Prof_Record((id), DWT->CYCCNT - Prof_Start_##id)
+
+void Prof_Init(void);
+void Prof_Record(Prof_Id id, uint32_t cycles);
+void Prof_Reset(void);
+void Prof_Dump(void);
+void Prof_DrawOverlay(uint16_t x, uint16_t y);
+void Prof_PollCommand(void);
+uint8_t Prof_IsOverlayEnabled(void);
+
+#else
+
+#define PROF_BEGIN(id)            ((void)0)
+#define PROF_END(id)              ((void)0)
+
+#define Prof_Init()               ((void)0)
+#define Prof_Reset()              ((void)0)
+#define Prof_Dump()               ((void)0)
+#define Prof_DrawOverlay(x, y)    ((void)0)
+#define Prof_PollCommand()        ((void)0)
+#define Prof_IsOverlayEnabled()   0
+
+#endif /* PROF_ENABLE */
+
+#endif /* INC_PROF_H_ */
@@ -6,8 +6,19 @@
 #define REALTIME_H
 #include <stdint.h>
 
+// Zähltakt von TIM7, ein Tick von 1 ms sind REALTIME_COUNTS_PER_MS Zählschritte
+#define REALTIME_COUNTER_HZ      1000000UL
+#define REALTIME_COUNTS_PER_MS   (REALTIME_COUNTER_HZ / 1000UL)
+
+// Längster Schlaf am Stück, begrenzt durch das 16-Bit-ARR von TIM7
+#define REALTIME_TICKLESS_MAX_MS (0x10000UL / REALTIME_COUNTS_PER_MS)
+
+// Mindestabstand in Zählschritten zwischen Zähler und neuem ARR beim vorzeitigen Aufwachen
+#define REALTIME_ARR_MARGIN      20
+
 void Realtime_Init(void);
 void Realtime_Loop(void);
+void Realtime_Sleep(uint32_t maxMs);
 
 
 #endif //REALTIME_H
@@ -0,0 +1,47 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SDCACHE_H_
+#define INC_SDCACHE_H_
+
+#include "main.h"
+#include "ff.h"
+#include "diskio.h"
+
+/* Sektor-Cache zwischen FatFs und SD_read/SD_write. Auskommentieren, um jeden Zugriff direkt an die Karte zu geben. */
+#define SDCACHE_ENABLE
+
+/* Aufbau: SETS x WAYS Zeilen zu je einem Sektor (16 x 4 x 512 Bytes = 32 KB im AXI-SRAM) */
+#define SDCACHE_SECTOR_SIZE   512
+#define SDCACHE_SETS          16
+#define SDCACHE_WAYS          4
+
+/* Nach einem sequentiellen Zugriff werden so viele Folgesektoren mitgelesen */
+#define SDCACHE_READAHEAD     8
+
+/* Ab dieser Sektoranzahl gehen Zugriffe am Cache vorbei direkt in den Aufruferpuffer (z. B. Bildstreaming) */
+#define SDCACHE_BYPASS_SECTORS  8
+
+/* Aufeinanderfolgende Dirty-Sektoren gehen bis zu dieser Anzahl in einem Multi-Block-Write zurück */
+#define SDCACHE_WRITE_RUN       16
+
+/**
+ * @brief Trefferstatistik zum Abstimmen der Cache-Parameter
+ */
+typedef struct {
+	uint32_t hits;        // Sektoren aus dem Cache
+	uint32_t misses;      // Sektoren von der Karte (ohne Read-Ahead)
+	uint32_t prefetched;  // Zusätzlich vorausgelesene Sektoren
+	uint32_t writebacks;  // Zurückgeschriebene Dirty-Sektoren
+	uint32_t writeRuns;   // dafür nötige Schreibkommandos
+} SDCache_Stats;
+
+extern SDCache_Stats SDCache_Statistics;
+
+DRESULT SDCache_Read(BYTE *buff, DWORD sector, UINT count);
+DRESULT SDCache_Write(const BYTE *buff, DWORD sector, UINT count);
+DRESULT SDCache_Flush();
+void SDCache_Invalidate();
+
+#endif /* INC_SDCACHE_H_ */
@@ -6,9 +6,36 @@
 #define SDCARD_H
 
 #include "main.h"
+#include "ff.h"
 
+/* Vorführung der FatFs-Grundfunktionen (SDCard_Test.c, Shell-Befehl 'sd') */
 void SDIO_SDCard_Test(void);
 
+/* Persistentes Volume mit Referenzzähler */
+uint8_t SDCard_Mount();
+uint8_t SDCard_Unmount();
+FATFS* SDCard_Acquire();
+void SDCard_Release();
+FRESULT SDCard_CheckResult(FRESULT res);
+
+/* Formatieren auf dem Gerät: Cluster und Datenbereich passend zur Allocation Unit der Karte */
+#define SDCARD_FORMAT_WORK_SIZE  (16UL * 1024UL)   // aus Arena_Frame, so viel schreibt f_mkfs am Stück
+#define SDCARD_FAT_CLUSTER_MAX   (32UL * 1024UL)    // FAT16/FAT32 bis 32 GB
+#define SDCARD_EXFAT_CLUSTER_MAX (128UL * 1024UL)   // exFAT ab 64 GB (SDXC)
+
+/**
+ * @brief Ergebnis von SDCard_Format()
+ */
+typedef struct {
+    uint32_t auBytes;      // Allocation Unit laut SD-Status (Ausrichtung des Datenbereichs)
+    uint32_t clusterBytes;
+    uint8_t fsType;        // FS_FAT16, FS_FAT32 oder FS_EXFAT nach dem erneuten Mounten
+    uint32_t dataSector;   // erster Sektor des Datenbereichs
+    uint32_t elapsedMs;
+} SDCard_FormatInfo;
+
+FRESULT SDCard_Format(BYTE opt, SDCard_FormatInfo *info);
+
 uint8_t mountSD();
 uint8_t unmountSD();
 
@@ -0,0 +1,47 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SDLOGGER_H_
+#define INC_SDLOGGER_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* RAM-Ringpuffer für Messdaten (Vielfaches von SDLOGGER_WRITE_SECTORS * 512), zwei Schreibblöcke */
+#define SDLOGGER_RING_SIZE       (64 * 1024)
+
+/*
+ * Sektoren pro Multi-Block-Write (64 x 512 Bytes = 32 KB). Die Blöcke liegen auf der Karte an
+ * 32-KB-Grenzen der LBA (nur der erste ist kürzer), so fällt keiner zweimal in eine Seite der
+ * Karte, und SDCache lässt sie vorbei (ab SDCACHE_BYPASS_SECTORS).
+ */
+#define SDLOGGER_SECTOR_SIZE     512
+#define SDLOGGER_WRITE_SECTORS   64
+
+/* Abstand der Checkpoints, an denen die Dateigröße im Verzeichniseintrag aktualisiert wird */
+#define SDLOGGER_CHECKPOINT_MS   1000
+
+/**
+ * @brief Zähler des Datenloggers
+ */
+typedef struct {
+	uint32_t written;     // Auf die Karte geschriebene Bytes
+	uint32_t dropped;     // Verworfene Bytes (Ringpuffer voll oder Datei voll)
+	uint32_t checkpoints; // Anzahl der Checkpoints
+	uint32_t writes;      // Multi-Block-Writes
+	uint32_t maxFill;     // höchster Füllstand des Ringpuffers in Bytes
+	uint32_t maxWriteMs;  // längster Multi-Block-Write
+} SDLogger_Stats;
+
+extern SDLogger_Stats SDLogger_Statistics;
+
+FRESULT SDLogger_Open(const char *path, uint32_t capacity);
+uint32_t SDLogger_Write(const void *data, uint32_t length);
+uint32_t SDLogger_GetFree();
+FRESULT SDLogger_Process();
+FRESULT SDLogger_Checkpoint();
+FRESULT SDLogger_Close();
+uint8_t SDLogger_IsOpen();
+
+#endif /* INC_SDLOGGER_H_ */
@@ -0,0 +1,39 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SDQUEUE_H_
+#define INC_SDQUEUE_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* Anzahl gleichzeitig offener Dateien und Länge der Auftragswarteschlange */
+#define SDQUEUE_MAX_FILES    4
+#define SDQUEUE_DEPTH        8
+
+/* Längster Dateiname, der in einen Auftrag kopiert wird */
+#define SDQUEUE_PATH_MAX     64
+
+/* Größe eines Teilstücks: große Lese-/Schreibaufträge werden über mehrere Aufrufe von SDQueue_Service verteilt */
+#define SDQUEUE_SLICE_BYTES  (8 * 1024)
+
+/**
+ * @brief Wird nach Abschluss eines Auftrags aus SDQueue_Service aufgerufen
+ * @param result  Ergebnis der FatFs-Operation
+ * @param bytes   Übertragene Bytes (Read/Write), sonst 0
+ * @param context Zeiger, der beim Einreihen übergeben wurde
+ */
+typedef void (*SDQueue_Callback)(FRESULT result, uint32_t bytes, void *context);
+
+int8_t SDQueue_Open(const char *path, BYTE mode, SDQueue_Callback callback, void *context);
+uint8_t SDQueue_Read(int8_t handle, void *buffer, uint32_t size, SDQueue_Callback callback, void *context);
+uint8_t SDQueue_Write(int8_t handle, const void *buffer, uint32_t size, SDQueue_Callback callback, void *context);
+uint8_t SDQueue_Seek(int8_t handle, FSIZE_t offset, SDQueue_Callback callback, void *context);
+uint8_t SDQueue_Sync(int8_t handle, SDQueue_Callback callback, void *context);
+uint8_t SDQueue_Close(int8_t handle, SDQueue_Callback callback, void *context);
+
+void SDQueue_Service(uint32_t budgetMs);
+uint8_t SDQueue_Pending();
+
+#endif /* INC_SDQUEUE_H_ */
@@ -8,6 +8,9 @@
 #define SSD1306_I2C_PORT        hi2c1
 #define SSD1306_I2C_ADDR        (0x3C << 1)
 
+// Höchste I2C-Geschwindigkeit laut Datenblatt (Taktperiode min. 2,5 us)
+#define SSD1306_I2C_MAX_HZ      400000U
+
 
 extern I2C_HandleTypeDef SSD1306_I2C_PORT;
 
@@ -20,6 +23,20 @@ extern I2C_HandleTypeDef SSD1306_I2C_PORT;
 #define SSD1306_HEIGHT          64
 
 #define SSD1306_BUFFER_SIZE   SSD1306_WIDTH * SSD1306_HEIGHT / 8
+#define SSD1306_PAGES         (SSD1306_HEIGHT / 8)
+
+// Wartezeit in ms für blockierende Befehle, solange der Bus noch belegt ist
+#define SSD1306_WAIT_TIMEOUT  100
+
+// Zeit in ms nach dem Einschalten, bis der Controller Befehle annimmt; ssd1306_Init() wartet nur den Rest
+#define SSD1306_POWER_UP_MS   100
+
+// Befehlsbytes, die ssd1306_BeginCommands() bis ssd1306_EndCommands() in einer Transaktion sammelt
+#define SSD1306_COMMAND_BATCH 32
+
+// Geschätzte Kosten einer zusätzlichen Seite als eigenes Update in Bytes auf dem Bus (Adressfenster,
+// zweimal START/Adresse/STOP); bis zu so viele unveränderte Spalten sendet ein gemeinsames Fenster mit
+#define SSD1306_PAGE_OVERHEAD 10
 
 
 typedef enum {
@@ -37,8 +54,34 @@ typedef struct {
     uint16_t CurrentY;
     uint8_t Initialized;
     uint8_t DisplayOn;
+    uint8_t Scrolling;
 } SSD1306_t;
 
+// Richtung des Hardware-Scrollens
+typedef enum {
+    SSD1306_SCROLL_RIGHT = 0x00,
+    SSD1306_SCROLL_LEFT  = 0x01
+} SSD1306_ScrollDir;
+
+// Abstand der Scrollschritte in Bildern (Kodierung des Datenblatts)
+typedef enum {
+    SSD1306_SCROLL_2_FRAMES   = 0x07,
+    SSD1306_SCROLL_3_FRAMES   = 0x04,
+    SSD1306_SCROLL_4_FRAMES   = 0x05,
+    SSD1306_SCROLL_5_FRAMES   = 0x00,
+    SSD1306_SCROLL_25_FRAMES  = 0x06,
+    SSD1306_SCROLL_64_FRAMES  = 0x01,
+    SSD1306_SCROLL_128_FRAMES = 0x02,
+    SSD1306_SCROLL_256_FRAMES = 0x03
+} SSD1306_ScrollInterval;
+
+// Ausblenden (0x23): aus, einmal bis dunkel, dauerhaft blinken
+typedef enum {
+    SSD1306_FADE_OFF   = 0x00,
+    SSD1306_FADE_OUT   = 0x20,
+    SSD1306_FADE_BLINK = 0x30
+} SSD1306_FadeMode;
+
 
 /** Font */
 typedef struct {
@@ -46,6 +89,7 @@ typedef struct {
     const uint8_t height;               /**< Font height in pixels */
     const uint16_t *const data;         /**< Pointer to font data array */
     const uint8_t *const char_width;    /**< Proportional character width in pixels (NULL for monospaced) */
+    const uint8_t *const columns;       /**< Column-major page bytes, (height+7)/8 per column (NULL = draw per pixel) */
 } SSD1306_Font_t;
 
 // Procedure definitions
@@ -59,15 +103,35 @@ void ssd1306_SetCursor(uint8_t x, uint8_t y);
 void ssd1306_Line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_DrawColumns(uint8_t x, uint8_t y, const uint8_t *columns, uint8_t width, uint8_t height, SSD1306_COLOR color);
 
 // Low-level procedures
 void ssd1306_Reset(void);
 void ssd1306_WriteCommand(uint8_t byte);
+void ssd1306_BeginCommands(void);
+void ssd1306_EndCommands(void);
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
 
 void ssd1306_SetDisplayOn(const uint8_t on);
 void ssd1306_SetContrast(const uint8_t value);
 
+// Hardware-Scrollen, Ausblenden und Zoom: laufen ohne weiteren I2C-Verkehr im Display
+void ssd1306_ScrollHorizontal(SSD1306_ScrollDir dir, uint8_t startPage, uint8_t endPage, SSD1306_ScrollInterval interval);
+void ssd1306_ScrollDiagonal(SSD1306_ScrollDir dir, uint8_t startPage, uint8_t endPage, SSD1306_ScrollInterval interval,
+                            uint8_t verticalOffset);
+void ssd1306_SetVerticalScrollArea(uint8_t fixedRows, uint8_t scrollRows);
+void ssd1306_ScrollStop(void);
+uint8_t ssd1306_IsScrolling(void);
+void ssd1306_SetFade(SSD1306_FadeMode mode, uint8_t interval);
+void ssd1306_SetZoom(const uint8_t on);
+
+// Asynchrones Update per DMA
+typedef void (*SSD1306_UpdateCompleteCallback)(void);
+
+uint8_t ssd1306_IsBusy(void);
+void ssd1306_InvalidateAll(void);
+void ssd1306_SetUpdateCompleteCallback(SSD1306_UpdateCompleteCallback callback);
+
 
 #define SSD1306_INCLUDE_FONT_6x8
 //#define SSD1306_INCLUDE_FONT_7x10
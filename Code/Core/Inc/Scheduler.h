@@ -0,0 +1,70 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+#include "main.h"
+
+/* Höchstzahl registrierter Tasks */
+#define SCHEDULER_MAX_TASKS       20
+
+/* 1 = im Leerlauf bis zur nächsten Freigabe schlafen (Realtime_Sleep), 0 = nur WFI im 1-ms-Takt */
+#define SCHEDULER_TICKLESS        1
+
+/* Zeitfenster für die CPU-Last in ms */
+#define SCHEDULER_LOAD_WINDOW_MS  1000
+
+/* Rückgabe von Scheduler_AddTask(), wenn kein Platz mehr frei ist */
+#define SCHEDULER_INVALID_TASK    0xFF
+
+/**
+ * @brief Task-Funktion, läuft bis zum Ende durch (run-to-completion) und darf nicht blockieren
+ */
+typedef void (*Scheduler_TaskFunction)(void *context);
+
+/**
+ * @brief Zustand und Statistik eines Tasks
+ */
+typedef struct {
+	const char *name;
+	Scheduler_TaskFunction function;
+	void *context;
+	uint32_t periodMs;
+	uint32_t deadlineMs;           // Zeit ab Freigabe, bis der Task fertig sein muss
+	uint8_t priority;              // 0 = höchste Priorität
+	uint8_t enabled;
+
+	volatile uint8_t ready;        // von Scheduler_Tick() gesetzt
+	volatile uint32_t releaseTick; // ms-Zeitpunkt der letzten Freigabe
+	volatile uint32_t releaseCycle;// DWT->CYCCNT bei der letzten Freigabe
+	uint32_t nextRelease;
+
+	uint32_t runs;
+	uint32_t overruns;             // fertig nach Ablauf der Deadline
+	uint32_t skipped;              // erneut freigegeben, bevor der Task laufen konnte
+	uint32_t minLatency;           // Takte von Freigabe bis Start
+	uint32_t maxLatency;
+	uint32_t maxRuntime;           // Takte für einen Durchlauf
+} Scheduler_Task;
+
+extern Scheduler_Task Scheduler_Tasks[SCHEDULER_MAX_TASKS];
+
+void Scheduler_Init(void);
+uint8_t Scheduler_AddTask(const char *name, Scheduler_TaskFunction function, void *context,
+		uint32_t periodMs, uint32_t deadlineMs, uint8_t priority);
+void Scheduler_SetEnabled(uint8_t id, uint8_t enabled);
+void Scheduler_Tick(uint32_t elapsedMs);
+void Scheduler_Release(uint8_t id);
+void Scheduler_ReleaseAfter(uint8_t id, uint32_t delayMs);
+uint8_t Scheduler_Dispatch(void);
+void Scheduler_Idle(void);
+uint32_t Scheduler_GetTicks(void);
+uint32_t Scheduler_GetLoad(void);
+uint32_t Scheduler_GetIdleCycles(void);
+uint8_t Scheduler_GetTaskCount(void);
+void Scheduler_ResetStats(void);
+void Scheduler_Dump(void);
+
+#endif /* INC_SCHEDULER_H_ */
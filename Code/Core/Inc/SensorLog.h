@@ -0,0 +1,75 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SENSORLOG_H_
+#define INC_SENSORLOG_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* Reservierte Dateigröße, wenn 'log start' keine angibt (reicht bei 4 Potis mit 1 kHz für ~2 h) */
+#define SENSORLOG_DEFAULT_SIZE    (64UL * 1024UL * 1024UL)
+#define SENSORLOG_DEFAULT_PATH    "sensor.bin"
+
+/* Erstes Byte jedes Satzes, zum Wiederaufsetzen hinter beschädigten Daten */
+#define SENSORLOG_MAGIC           0xA5
+
+/* Periode des Logger-Tasks, in der die Ringe in den SD-Puffer wandern */
+#define SENSORLOG_TASK_MS         5
+
+/* Abstand der SYNC-Sätze (Zeitbasis für das Auflösen des Zykluszählers) */
+#define SENSORLOG_SYNC_MS         1000
+
+/* Optionen von SensorLog_Start() */
+#define SENSORLOG_OPT_CAN         0x01   // alle Rahmen auf FDCAN1 mitschneiden (Can_SetCapture())
+#define SENSORLOG_OPT_RAW         0x02   // ADC-Blöcke unkodiert schreiben
+#define SENSORLOG_OPT_LZ4         0x04   // ADC-Differenzen zusätzlich mit LZ4, wenn der Task Zeit hat
+
+/* Kodierung der ADC-Werte, Byte 11 eines ADC-Satzes (nach Blocknummer, Scans/s, Scans, Slots) */
+#define SENSORLOG_ADC_RAW         0      // 16-Bit-Werte wie im DMA-Puffer
+#define SENSORLOG_ADC_DELTA       1      // Differenz je Slot, Zig-Zag-Varint (LogCodec_DeltaEncode())
+#define SENSORLOG_ADC_LZ4         2      // Länge der Differenzen (2), dann diese als LZ4-Block
+
+/**
+ * @brief Quellen, je eine mit eigenem Ringpuffer. Größen in SensorLog_Rings (SensorLog.c).
+ */
+typedef enum {
+	SENSORLOG_SRC_SYNC = 0,   // Zeitbasis: oberes Wort der µs-Zeit, HAL-Tick, verworfene Sätze
+	SENSORLOG_SRC_ADC,        // ganze Blöcke aus dem Messbetrieb von ADC.c (kHz)
+	SENSORLOG_SRC_POTI,       // TOPIC_POTI außerhalb des Messbetriebs
+	SENSORLOG_SRC_CLIMATE,    // TOPIC_CLIMATE (AHT20, 1 Hz)
+	SENSORLOG_SRC_INPUT,      // TOPIC_INPUT (Tasten)
+	SENSORLOG_SRC_CAN,        // Rahmen auf FDCAN1 mit SENSORLOG_OPT_CAN, Zeit aus dem Zeitstempel der Hardware
+	SENSORLOG_SRC_COUNT
+} SensorLog_Source;
+
+/**
+ * @brief Kopf jedes Satzes in der Datei (Little Endian), danach length Bytes Nutzdaten
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t magic;            // SENSORLOG_MAGIC
+	uint8_t source;           // SensorLog_Source
+	uint16_t length;          // Nutzdaten in Bytes
+	uint32_t timeUs;          // untere 32 Bit von Timebase_Us() beim Erfassen
+} SensorLog_Header;
+
+/**
+ * @brief Zähler einer Quelle
+ */
+typedef struct {
+	uint32_t records;         // in den Ringpuffer übernommene Sätze
+	uint32_t dropped;         // verworfene Sätze (Ringpuffer voll oder Ereignis verpasst)
+	uint32_t maxFill;         // höchster Füllstand des Ringpuffers in Bytes
+	uint32_t size;            // Größe des Ringpuffers
+} SensorLog_Stats;
+
+void SensorLog_Init(uint8_t taskId);
+FRESULT SensorLog_Start(const char *path, uint32_t capacity, uint8_t options);
+FRESULT SensorLog_Stop(void);
+uint8_t SensorLog_IsRunning(void);
+const SensorLog_Stats* SensorLog_GetStats(SensorLog_Source source);
+void SensorLog_Dump(void);
+void SensorLog_Task(void *context);
+
+#endif /* INC_SENSORLOG_H_ */
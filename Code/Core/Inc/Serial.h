@@ -0,0 +1,54 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SERIAL_H_
+#define INC_SERIAL_H_
+
+#include "main.h"
+#include "usart.h"
+
+/* Größe des Sendepuffers für printf (Zweierpotenz), reicht bei 921600 Baud für ca. 44 ms */
+#define SERIAL_LOG_BUFFER_SIZE    4096
+
+/* Sendepuffer von LPUART1 für Kommandozeile und Telemetrie (Zweierpotenz, in SRD SRAM für den BDMA2),
+   reicht bei 3 MBaud für ca. 27 ms */
+#define SERIAL_SHELL_BUFFER_SIZE  8192
+
+/* Wartezeit in ms, bis eine laufende Übertragung für Serial_Suspend() bzw. Serial_Flush() fertig ist */
+#define SERIAL_WAIT_TIMEOUT       100
+
+/**
+ * @brief Sendepuffer einer UART, geleert per DMA
+ */
+typedef struct {
+	UART_HandleTypeDef *huart;
+	uint8_t *buffer;               // Ringpuffer im nicht gecachten RAM (DMA_BUFFER)
+	uint32_t size;                 // Zweierpotenz
+	volatile uint32_t head;        // geschriebene Bytes (läuft frei über)
+	volatile uint32_t tail;        // gesendete Bytes
+	volatile uint32_t dmaLength;   // Länge der laufenden Übertragung, 0 = keine
+	volatile uint8_t suspended;    // keine neuen Übertragungen starten (Taktumschaltung)
+	volatile uint8_t external;     // den Ring leert ein anderes Modul (EspLink), Serial startet keine DMA
+
+	uint32_t sent;
+	uint32_t dropped;              // verworfene Bytes, Puffer war voll
+} Serial_Port;
+
+extern Serial_Port Serial_Log;
+extern Serial_Port Serial_Shell;
+extern Serial_Port *Serial_Stdout;
+
+void Serial_Init(Serial_Port *port, UART_HandleTypeDef *huart);
+uint32_t Serial_Write(Serial_Port *port, const void *data, uint32_t length);
+uint32_t Serial_GetFree(Serial_Port *port);
+uint32_t Serial_GetDropped(Serial_Port *port);
+uint8_t Serial_Flush(Serial_Port *port, uint32_t timeoutMs);
+uint8_t Serial_Suspend(Serial_Port *port);
+void Serial_Resume(Serial_Port *port);
+uint8_t Serial_SetExternal(Serial_Port *port, uint8_t external);
+
+void Serial_TxCpltCallback(UART_HandleTypeDef *huart);
+void Serial_ErrorCallback(UART_HandleTypeDef *huart);
+
+#endif /* INC_SERIAL_H_ */
@@ -0,0 +1,38 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SHELL_H_
+#define INC_SHELL_H_
+
+#include "main.h"
+#include "usart.h"
+#include "Serial.h"
+
+/* Empfangspuffer (zirkulär per DMA), muss die längste noch nicht ausgewertete Eingabe fassen */
+#define SHELL_RX_BUFFER_SIZE      256
+
+/* Höchstzahl der Wörter einer Zeile einschließlich Befehl */
+#define SHELL_MAX_ARGS            12
+
+/**
+ * @brief Befehl der Kommandozeile
+ * @param argc: Anzahl Wörter, argv[0] ist der Befehl
+ */
+typedef struct {
+	const char *name;
+	void (*handler)(uint8_t argc, char *argv[]);
+	const char *help;
+} Shell_Command;
+
+void Shell_Init(UART_HandleTypeDef *huart, uint8_t taskId);
+void Shell_Task(void *context);
+void Shell_Suspend(void);
+void Shell_Resume(void);
+uint8_t Shell_Submit(const char *line, uint32_t length, Serial_Port *out);
+uint8_t Shell_IsSubmitPending(void);
+
+void Shell_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size);
+void Shell_ErrorCallback(UART_HandleTypeDef *huart);
+
+#endif /* INC_SHELL_H_ */
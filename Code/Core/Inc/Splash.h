@@ -0,0 +1,26 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_SPLASH_H_
+#define INC_SPLASH_H_
+
+#include "main.h"
+
+/**
+ * @brief Ein Bild des Startbildschirms; Breite und Höhe gelten nur für die SD-Datei, im Bundle stehen sie im Index
+ */
+typedef struct {
+	const char *name;       // Name im Asset-Bundle und Dateiname auf der SD-Karte
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+} Splash_Image;
+
+uint8_t Splash_Show(void);
+void Splash_ShowFallback(void);
+void Splash_Keep(void);
+uint8_t Splash_GetPending(void);
+
+#endif /* INC_SPLASH_H_ */
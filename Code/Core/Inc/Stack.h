@@ -0,0 +1,40 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_STACK_H_
+#define INC_STACK_H_
+
+#include "main.h"
+
+/* Füllt den Stack beim Start mit einem Muster für die Hochwassermarke, 0 schaltet ab */
+#ifndef STACK_PAINT_ENABLE
+#define STACK_PAINT_ENABLE        1
+#endif
+
+/* Muster der unbenutzten Worte */
+#define STACK_PAINT_PATTERN       0xA5A5A5A5UL
+
+/* Bemalter Bereich unterhalb des Stackpointers beim Aufruf; weiter unten liegt der Heap */
+#define STACK_PAINT_SIZE          (64UL * 1024UL)
+
+/* Abstand zum eigenen Stackpointer beim Bemalen (Rahmen von Stack_Paint() selbst) */
+#define STACK_PAINT_MARGIN        64UL
+
+#if STACK_PAINT_ENABLE
+
+void Stack_Paint(void);
+uint32_t Stack_GetUsed(void);
+uint32_t Stack_GetPainted(void);
+void Stack_Dump(void);
+
+#else
+
+#define Stack_Paint()             ((void)0)
+#define Stack_GetUsed()           (0UL)
+#define Stack_GetPainted()        (0UL)
+#define Stack_Dump()              ((void)0)
+
+#endif /* STACK_PAINT_ENABLE */
+
+#endif /* INC_STACK_H_ */
@@ -0,0 +1,65 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include "main.h"
+#include "adc.h"
+
+/* Kanäle (Bitmaske für Telemetry_Config.channels) */
+#define TELEMETRY_CH_ADC          0x01   // Rohwerte der Potis aus dem Messbetrieb von ADC.c
+#define TELEMETRY_CH_AHT20        0x02   // Temperatur und Luftfeuchte
+#define TELEMETRY_CH_TIMING       0x04   // CPU-Last, Laufzeiten der Scheduler-Tasks und Bildbudget
+
+/* Paketarten (erstes Byte jedes Pakets) */
+#define TELEMETRY_PKT_INFO        0      // Kerntakt und Aufbau der ADC-Pakete
+#define TELEMETRY_PKT_ADC         1
+#define TELEMETRY_PKT_AHT20       2
+#define TELEMETRY_PKT_TIMING      3
+#define TELEMETRY_PKT_MIRROR      4      // Bildspiegel von Mirror.c, mit Telemetry_SendPacket()
+#define TELEMETRY_PKT_FRAME       5      // Bildbudget und langsamste Widgets, mit dem Kanal TIMING
+
+/* Widgets je FRAME-Paket, die mit den meisten Budgetüberschreitungen zuerst */
+#define TELEMETRY_FRAME_WORST     4
+
+/* Höchstens so viele Nutzdaten je Paket; ein 1024er ADC-Block wird auf mehrere Pakete verteilt */
+#define TELEMETRY_MAX_PAYLOAD     240
+
+/* Abstand der Info-Pakete in ms, damit ein später gestarteter Empfänger die Kanäle zuordnen kann */
+#define TELEMETRY_INFO_PERIOD_MS  1000
+
+/**
+ * @brief Einstellungen des Datenstroms
+ */
+typedef struct {
+	uint8_t channels;              // TELEMETRY_CH_*
+	uint8_t adcMask;               // Bit n = Poti n senden
+	uint8_t adcDecimation;         // nur jeden n-ten Scan senden (1 = alle)
+	uint16_t aht20PeriodMs;        // Abstand der AHT20-Pakete
+	uint16_t timingPeriodMs;       // Abstand der Timing-Pakete
+} Telemetry_Config;
+
+/**
+ * @brief Zähler des Datenstroms
+ */
+typedef struct {
+	uint32_t packets;              // gesendete Pakete
+	uint32_t bytes;                // gesendete Bytes einschließlich Rahmen
+	uint32_t dropped;              // Pakete verworfen, weil der Sendepuffer voll war
+	uint32_t adcSkipped;           // ADC-Blöcke, die der Task nicht rechtzeitig abgeholt hat
+	uint32_t linkPackets;          // zusätzlich an den ESP-Link übergeben
+	uint32_t linkSkipped;          // nicht an den ESP-Link, das vorige Paket war noch unterwegs
+} Telemetry_Stats;
+
+uint8_t Telemetry_Init(uint8_t taskId);
+void Telemetry_Start(const Telemetry_Config *config);
+void Telemetry_Stop(void);
+uint8_t Telemetry_IsRunning(void);
+const Telemetry_Config* Telemetry_GetConfig(void);
+const Telemetry_Stats* Telemetry_GetStats(void);
+void Telemetry_Task(void *context);
+uint8_t Telemetry_SendPacket(uint8_t type, const void *payload, uint32_t length);
+
+#endif /* INC_TELEMETRY_H_ */
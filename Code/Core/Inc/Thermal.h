@@ -0,0 +1,62 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_THERMAL_H_
+#define INC_THERMAL_H_
+
+#include "main.h"
+#include "Clock.h"
+
+/* Chiptemperatur über ADC2 überwachen und das Taktprofil bei Übertemperatur begrenzen */
+#ifndef THERMAL_ENABLE
+#define THERMAL_ENABLE            1
+#endif
+
+/* Abstand der Timer-Callbacks; VREFINT und Temperatursensor wechseln sich ab (ein Wert je Sensor alle 2 x) */
+#define THERMAL_TICK_MS           500
+
+/* Chiptemperatur in 0,01 °C, ab der höchstens CLOCK_PROFILE_BALANCED bzw. CLOCK_PROFILE_LOW_POWER läuft */
+#define THERMAL_DIE_BALANCED      9000
+#define THERMAL_DIE_LOW_POWER     10500
+
+/* Umgebung (AHT20) in 0,01 °C, ab der trotz kühlem Chip höchstens CLOCK_PROFILE_BALANCED läuft */
+#define THERMAL_AMBIENT_BALANCED  6000
+
+/* Die Begrenzung fällt erst, wenn alle Werte so weit (0,01 °C) unter ihrer Schwelle liegen */
+#define THERMAL_HYSTERESIS        500
+
+/* Kein Messwert der Umgebung (noch keine Messung des AHT20) */
+#define THERMAL_NO_AMBIENT        INT16_MIN
+
+typedef struct {
+	uint32_t samples;                 // Werte des Temperatursensors
+	uint32_t errors;                  // Fehler der HAL beim Start einer Wandlung
+	int16_t die;                      // Chip in 0,01 °C, zuletzt
+	int16_t dieMax;                   // höchster Wert seit ResetStats
+	int16_t ambient;                  // Umgebung vom AHT20 (gefiltert), THERMAL_NO_AMBIENT ohne Messung
+	uint16_t vddaMv;                  // aus VREFINT, Bezug der Umrechnung
+	Clock_Profile ceiling;            // aktuelle Obergrenze
+	uint32_t throttles;               // Obergrenze gesenkt
+	uint32_t releases;                // Obergrenze angehoben
+	uint64_t throttledMs;             // Zeit unter einer Obergrenze
+} Thermal_Stats;
+
+#if THERMAL_ENABLE
+
+void Thermal_Init(void);
+Clock_Profile Thermal_GetCeiling(void);
+const Thermal_Stats* Thermal_GetStats(void);
+void Thermal_ResetStats(void);
+void Thermal_Dump(void);
+
+#else
+
+#define Thermal_Init()            ((void)0)
+#define Thermal_GetCeiling()      (CLOCK_PROFILE_MAX)
+#define Thermal_ResetStats()      ((void)0)
+#define Thermal_Dump()            ((void)0)
+
+#endif /* THERMAL_ENABLE */
+
+#endif /* INC_THERMAL_H_ */
@@ -0,0 +1,43 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_THUMB_H_
+#define INC_THUMB_H_
+
+#include "main.h"
+
+/* Größte Kantenlängen eines Vorschaubilds; das Seitenverhältnis des Originals bleibt erhalten */
+#define THUMB_WIDTH          64
+#define THUMB_HEIGHT         48
+
+/* Vorschaubilder im RAM (je THUMB_WIDTH * THUMB_HEIGHT * 2 Bytes im AXI-SRAM), verdrängt wird das älteste */
+#define THUMB_RAM_ENTRIES    8
+
+/* Versteckte Cache-Datei auf der SD-Karte mit festen Plätzen, einer je Hash des Pfads */
+#define THUMB_FILE           "/.thumbs"
+#define THUMB_FILE_SLOTS     256
+
+/* Kennung eines belegten Platzes in THUMB_FILE */
+#define THUMB_MAGIC          0x424D4854UL   // "THMB"
+
+/**
+ * @brief Zähler des Caches, Zeiten in Mikrosekunden ohne Zeichnen
+ */
+typedef struct {
+	uint32_t ramHits;
+	uint32_t fileHits;
+	uint32_t generated;
+	uint32_t failures;           // Bild nicht lesbar oder Cache-Datei nicht beschreibbar
+	uint32_t lastUs;
+	uint32_t maxGenerateUs;
+	uint32_t maxFileUs;
+} Thumb_Stats;
+
+uint8_t Thumb_Draw(const char *path, uint16_t width, uint16_t height, uint16_t x, uint16_t y);
+const uint8_t* Thumb_Get(const char *path, uint16_t width, uint16_t height, uint16_t *thumbWidth, uint16_t *thumbHeight);
+void Thumb_Clear(void);
+const Thumb_Stats* Thumb_GetStats(void);
+void Thumb_Dump(void);
+
+#endif /* INC_THUMB_H_ */
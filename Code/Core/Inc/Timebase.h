@@ -0,0 +1,28 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_TIMEBASE_H_
+#define INC_TIMEBASE_H_
+
+#include "main.h"
+
+/* Zählfrequenz von TIM5; der 32-Bit-Zähler läuft nach 2^32 µs (ca. 71,6 min) über */
+#define TIMEBASE_HZ               1000000UL
+
+void Timebase_Init(void);
+void Timebase_ClockChanged(void);
+void Timebase_Advance(uint32_t us);
+
+uint64_t Timebase_Us(void);
+
+/**
+ * @brief  Untere 32 Bit der Zeitbasis, ein einziger Registerzugriff
+ *
+ * Reicht für Zeitstempel und Abstände bis ca. 71 min, Differenzen vorzeichenlos bilden.
+ */
+static inline uint32_t Timebase_Us32(void) {
+	return TIM5->CNT;
+}
+
+#endif /* INC_TIMEBASE_H_ */
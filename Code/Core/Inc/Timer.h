@@ -0,0 +1,81 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_TIMER_H_
+#define INC_TIMER_H_
+
+#include "main.h"
+
+/* Stufen des Timer-Rads und Bits je Stufe: 4 x 64 Fächer reichen 2^24 ms (ca. 4,6 h) weit */
+#define TIMER_WHEEL_LEVELS        4
+#define TIMER_WHEEL_BITS          6
+#define TIMER_WHEEL_SLOTS         (1UL << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK          (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_RANGE_MS      (1UL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS))
+
+/* Rückfallperiode des Timer-Tasks; regulär gibt ihn Timer_Tick() beim Ablauf frei */
+#define TIMER_TASK_MS             1000
+
+typedef enum {
+	TIMER_STATE_IDLE = 0,          // nicht gestartet, gestoppt oder einmalig abgelaufen
+	TIMER_STATE_ARMED,             // im Rad eingehängt
+	TIMER_STATE_PENDING            // abgelaufen, Callback wartet auf den Timer-Task
+} Timer_State;
+
+/**
+ * @brief Callback eines Timers, läuft im Timer-Task (nicht im Interrupt) und darf nicht blockieren
+ */
+typedef void (*Timer_Callback)(void *context);
+
+typedef struct Timer Timer;
+
+/**
+ * @brief Software-Timer, Speicher gehört dem Aufrufer (statisch oder in einer Struktur)
+ *
+ * Die Verkettung steckt im Timer selbst, Start, Stopp und Ablauf kosten deshalb unabhängig
+ * von der Zahl der Timer konstante Zeit und keinen Speicher aus einem Pool.
+ */
+struct Timer {
+	Timer *next;                   // Fach im Rad bzw. Liste der abgelaufenen Timer
+	Timer **pprev;
+	uint32_t expires;              // ms-Zeitpunkt des (nächsten) Ablaufs
+	uint32_t periodMs;             // 0 = einmalig
+	Timer_Callback callback;
+	void *context;
+	const char *name;
+	volatile uint8_t state;        // Timer_State
+
+	uint32_t runs;
+	uint32_t late;                 // Perioden übersprungen, weil der Callback zu spät lief
+};
+
+/**
+ * @brief Zähler des Timer-Rads für Timer_Dump()
+ */
+typedef struct {
+	uint32_t active;               // eingehängt oder abgelaufen
+	uint32_t maxActive;
+	uint32_t expired;              // Abläufe insgesamt
+	uint32_t cascaded;             // aus einer höheren Stufe weitergereicht
+	uint32_t dispatched;           // Callbacks im Timer-Task
+	uint32_t late;                 // übersprungene Perioden aller Timer
+	uint32_t maxPending;           // längste Liste abgelaufener Timer
+} Timer_Stats;
+
+void Timer_Init(uint8_t taskId);
+void Timer_Setup(Timer *timer, const char *name, Timer_Callback callback, void *context);
+void Timer_Start(Timer *timer, uint32_t delayMs, uint32_t periodMs);
+void Timer_Stop(Timer *timer);
+uint8_t Timer_IsActive(const Timer *timer);
+uint32_t Timer_Remaining(const Timer *timer);
+uint32_t Timer_Now(void);
+
+void Timer_Tick(uint32_t elapsedMs);
+void Timer_Task(void *context);
+uint32_t Timer_TimeToNext(uint32_t limitMs);
+
+const Timer_Stats* Timer_GetStats(void);
+void Timer_Dump(void);
+
+#endif /* INC_TIMER_H_ */
@@ -0,0 +1,80 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_TOPIC_H_
+#define INC_TOPIC_H_
+
+#include "main.h"
+#include "adc.h"
+#include "UserInput.h"
+
+/* Tasks, die eine Veröffentlichung eines Topics aufweckt */
+#define TOPIC_MAX_SUBSCRIBERS     4
+
+/* Rückgabe von Topic_Peek() vor der ersten Veröffentlichung */
+#define TOPIC_NO_DATA             0
+
+/**
+ * @brief Topics, je eines pro Art von Messwert. Neue Einträge in Topic_Data und Topic_Names (Topic.c).
+ */
+typedef enum {
+	TOPIC_POTI = 0,           // Topic_Poti, aus dem TIM7-Tick, wenn ein Poti das Totband verlässt
+	TOPIC_CLIMATE,            // Topic_Climate, vom AHT20 nach jeder gültigen Messung
+	TOPIC_INPUT,              // Topic_Input, von UserInput mit jedem Ereignis
+	TOPIC_GAMEPAD,            // Topic_Gamepad, aus dem Interrupt von UART4 mit jedem Bericht des Controllers
+	TOPIC_COUNT
+} Topic_Id;
+
+typedef struct {
+	uint16_t value[ADC_POTI_COUNT];  // 0-65535 nach Totband, wie Poti1Value ... Poti4Value
+	uint8_t changed;                 // Bitmaske der Potis, die sich seit der letzten Veröffentlichung bewegt haben
+} Topic_Poti;
+
+typedef struct {
+	int16_t temperature;          // 0,01 °C, letzte Messung
+	uint16_t humidity;            // 0,01 % rF
+	int16_t temperatureFiltered;  // nach Median und EMA (AHT20_GetFiltered())
+	uint16_t humidityFiltered;
+} Topic_Climate;
+
+typedef struct {
+	UserInput_Event event;    // letztes Ereignis; alle Ereignisse liefert UserInput_GetEvent()
+	uint32_t events;          // Ereignisse seit dem Start, Lücken zeigen verpasste
+} Topic_Input;
+
+typedef struct {
+	uint8_t stick[4];         // LX, LY, RX, RY, 128 = Mitte, Y wächst nach unten
+	uint8_t trigger[2];       // L2, R2, 0 = losgelassen
+	uint32_t buttons;         // gedrückte Eingaben wie bei UserInput (Bit = enum UserInputs)
+	uint64_t timeUs;          // Timebase_Us() des Berichts am Controller, ohne Funk- und UART-Weg
+	uint32_t reports;         // Berichte seit dem Start
+	uint8_t connected;        // 0 nach GAMEPAD_TIMEOUT_MS ohne Bericht, dann sind alle Tasten losgelassen
+} Topic_Gamepad;
+
+/**
+ * @brief Blick auf den aktuellen Wert eines Topics, ohne Kopie
+ *
+ * data zeigt in den Speicher des Topics und ist gültig, solange Topic_Valid() 1 liefert.
+ */
+typedef struct {
+	Topic_Id topic;
+	const void *data;
+	uint32_t sequence;        // Nummer der Veröffentlichung, TOPIC_NO_DATA = noch nichts da
+} Topic_View;
+
+/* --------------------------------- Erzeuger --------------------------------- */
+void* Topic_BeginPublish(Topic_Id topic);
+void Topic_EndPublish(Topic_Id topic);
+void Topic_Publish(Topic_Id topic, const void *data, uint32_t size);
+
+/* --------------------------------- Verbraucher --------------------------------- */
+uint8_t Topic_Subscribe(Topic_Id topic, uint8_t taskId);
+uint32_t Topic_Peek(Topic_Id topic, Topic_View *view);
+uint8_t Topic_Valid(const Topic_View *view);
+uint8_t Topic_Changed(Topic_Id topic, uint32_t *lastSequence, Topic_View *view);
+uint8_t Topic_Read(Topic_Id topic, void *data, uint32_t size, uint32_t *lastSequence);
+uint32_t Topic_GetSequence(Topic_Id topic);
+void Topic_Dump(void);
+
+#endif /* INC_TOPIC_H_ */
@@ -0,0 +1,112 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include "main.h"
+
+/* Ereignisse über ITM/SWO (Interrupts, Tasks, Marken), 0 entfernt alle Messpunkte */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE              1
+#endif
+
+/* Bitrate am SWO-Pin (PB3), muss zur Einstellung des Debug-Probes passen */
+#define TRACE_SWO_HZ              2000000UL
+
+/*
+ * Stimulus-Ports des ITM, der Port im Paket ist die Art des Ereignisses (Tools/trace_decode.py).
+ * Interrupts, Tasks und Marken schreiben ein Byte: die Nummer, Bit 7 = Ende.
+ */
+#define TRACE_PORT_TEXT           0       // Text, Trace_Print()
+#define TRACE_PORT_ISR            1       // Irq_Id, Bit 7 = Verlassen
+#define TRACE_PORT_TASK           2       // Task-Nummer des Schedulers, Bit 7 = fertig
+#define TRACE_PORT_MARK           3       // Marke 0-127, Bit 7 = Ende des Abschnitts
+#define TRACE_PORT_VALUE          4       // 32 Bit: Marke << 24 | Wert (24 Bit)
+#define TRACE_PORT_NAME           5       // Bytes: Art, Nummer, Name, 0
+#define TRACE_PORT_CLOCK          6       // 32 Bit: Kerntakt in Hz, Takt der Zeitstempel
+
+#define TRACE_END                 0x80
+
+/* Marken mit Namen, die Trace_Start() dem Decoder meldet */
+#define TRACE_MARK_COUNT          16
+
+/* PC-Abtastung des DWT ('trace pc', Tools/tcm_place.py profile): ein Paket alle
+ * (TRACE_PC_POSTPRESET + 1) * 1024 Takte, bei 280 MHz rund 17000 je Sekunde (85 KB/s am SWO-Pin) */
+#define TRACE_PC_POSTPRESET       15
+
+/* Art im Namenssatz (TRACE_PORT_NAME) */
+#define TRACE_NAME_ISR            0
+#define TRACE_NAME_TASK           1
+#define TRACE_NAME_MARK           2
+
+#if TRACE_ENABLE
+
+extern volatile uint8_t Trace_On;
+extern volatile uint32_t Trace_Dropped;
+
+void Trace_Init(void);
+void Trace_Start(void);
+void Trace_Stop(void);
+void Trace_Clock(void);
+void Trace_SetPcSampling(uint8_t enable);
+void Trace_SetMarkName(uint8_t id, const char *name);
+void Trace_Print(const char *text);
+void Trace_Dump(void);
+
+/**
+ * @brief  Schreibt ein Ereignis, ohne zu warten: ist der FIFO des ITM voll, wird es gezählt und verworfen
+ *
+ * Ohne Sperre. Schreibt ein Interrupt zwischen Prüfung und Schreiben selbst, geht eines der
+ * beiden verloren; das ITM meldet das dem Decoder als Überlauf.
+ */
+static inline void Trace_Put8(uint8_t port, uint8_t value) {
+	if (!Trace_On) return;
+	if (ITM->PORT[port].u32 == 0) {
+		Trace_Dropped++;
+		return;
+	}
+	ITM->PORT[port].u8 = value;
+}
+
+static inline void Trace_Put32(uint8_t port, uint32_t value) {
+	if (!Trace_On) return;
+	if (ITM->PORT[port].u32 == 0) {
+		Trace_Dropped++;
+		return;
+	}
+	ITM->PORT[port].u32 = value;
+}
+
+/* Zeitstempel setzt das ITM selbst (lokale Zeitstempel in CPU-Takten, wie DWT->CYCCNT) */
+#define TRACE_ISR_ENTER(id)       Trace_Put8(TRACE_PORT_ISR, (uint8_t)(id))
+#define TRACE_ISR_EXIT(id)        Trace_Put8(TRACE_PORT_ISR, (uint8_t)(id) | TRACE_END)
+#define TRACE_TASK_START(id)      Trace_Put8(TRACE_PORT_TASK, (uint8_t)(id))
+#define TRACE_TASK_STOP(id)       Trace_Put8(TRACE_PORT_TASK, (uint8_t)(id) | TRACE_END)
+#define TRACE_MARK_BEGIN(id)      Trace_Put8(TRACE_PORT_MARK, (uint8_t)(id))
+#define TRACE_MARK_END(id)        Trace_Put8(TRACE_PORT_MARK, (uint8_t)(id) | TRACE_END)
+#define TRACE_VALUE(id, value)    Trace_Put32(TRACE_PORT_VALUE, ((uint32_t)(id) << 24) | ((uint32_t)(value) & 0xFFFFFFUL))
+
+#else
+
+#define Trace_Init()              ((void)0)
+#define Trace_Start()             ((void)0)
+#define Trace_Stop()              ((void)0)
+#define Trace_Clock()             ((void)0)
+#define Trace_SetPcSampling(enable) ((void)0)
+#define Trace_SetMarkName(id, name) ((void)0)
+#define Trace_Print(text)         ((void)0)
+#define Trace_Dump()              ((void)0)
+
+#define TRACE_ISR_ENTER(id)       ((void)0)
+#define TRACE_ISR_EXIT(id)        ((void)0)
+#define TRACE_TASK_START(id)      ((void)0)
+#define TRACE_TASK_STOP(id)       ((void)0)
+#define TRACE_MARK_BEGIN(id)      ((void)0)
+#define TRACE_MARK_END(id)        ((void)0)
+#define TRACE_VALUE(id, value)    ((void)0)
+
+#endif /* TRACE_ENABLE */
+
+#endif /* INC_TRACE_H_ */
@@ -0,0 +1,71 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_UPDATE_H_
+#define INC_UPDATE_H_
+
+#include "main.h"
+
+/* Zwei Slots (A/B) für Firmware-Abbilder im W25Qxx, direkt unter dem Prüfmuster des Bus-Tunings
+ * (OCTOSPI1_TUNE_ADDRESS); das FatFs-Laufwerk endet an UPDATE_SLOT_BASE */
+#define UPDATE_SLOT_BASE          0x00FAD000UL
+#define UPDATE_SLOT_COUNT         2
+
+/* Je Slot ein Sektor für den Kopf, dahinter das Abbild in der Größe des internen Flashs */
+#define UPDATE_IMAGE_OFFSET       4096UL
+#define UPDATE_IMAGE_MAX          (128UL * 1024UL)
+#define UPDATE_SLOT_SIZE          (UPDATE_IMAGE_OFFSET + UPDATE_IMAGE_MAX)
+#define UPDATE_SLOT_ADDRESS(slot) (UPDATE_SLOT_BASE + (uint32_t)(slot) * UPDATE_SLOT_SIZE)
+
+/* Kopf vor dem Abbild im Übertragungsformat (Tools/update_pack.py), "FWUP" */
+#define UPDATE_MAGIC              0x50555746UL
+
+/* Schlüssel im FlashKV: Slot, dessen Abbild zuletzt in den internen Flash programmiert wurde */
+#define UPDATE_KEY_ACTIVE         "upd.slot"
+
+#define UPDATE_NO_SLOT            0xFF
+
+/**
+ * @brief Kopf eines Abbilds, wird mitübertragen und nach bestandener Prüfung in den Slot geschrieben
+ */
+typedef struct {
+	uint32_t magic;        // UPDATE_MAGIC
+	uint32_t size;         // Länge des Abbilds in Bytes
+	uint32_t crc;          // CRC-32 (zlib) des Abbilds
+	uint32_t version;      // frei wählbar, z. B. Build-Nummer
+	uint32_t reserved[4];
+} Update_Header;
+
+typedef enum {
+	UPDATE_IDLE,
+	UPDATE_RECEIVING,      // Update_Begin() bis Update_Finish()
+	UPDATE_VERIFIED,       // Abbild geprüft, Kopf im Slot geschrieben
+	UPDATE_FAILED
+} Update_State;
+
+/**
+ * @brief Stand des laufenden bzw. letzten Empfangs
+ */
+typedef struct {
+	Update_State state;
+	uint8_t slot;          // Zielslot des Empfangs
+	uint32_t received;     // Bytes einschließlich Kopf
+	uint32_t stalls;       // Sektoren, die der Löschpool noch nicht gelöscht hatte
+	uint32_t startMs;
+	uint32_t elapsedMs;    // Update_Begin() bis Update_Finish()
+	Update_Header header;
+	const char *error;     // Grund bei UPDATE_FAILED
+} Update_Status;
+
+uint8_t Update_Begin(void);
+uint8_t Update_Feed(const uint8_t *data, uint32_t length);
+uint8_t Update_Finish(void);
+void Update_Abort(void);
+uint8_t Update_FromFile(const char *path);
+uint8_t Update_ReadSlot(uint8_t slot, Update_Header *header);
+uint8_t Update_GetActiveSlot(void);
+uint8_t Update_Apply(uint8_t slot);
+const Update_Status* Update_GetStatus(void);
+
+#endif /* INC_UPDATE_H_ */
@@ -0,0 +1,87 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_USBCDC_H_
+#define INC_USBCDC_H_
+
+#include "main.h"
+#include "Serial.h"
+
+/* USB-Gerät mit zwei virtuellen COM-Ports (CDC-ACM) an PA11/PA12, 0 = USB bleibt aus */
+#ifndef USBCDC_ENABLE
+#define USBCDC_ENABLE             1
+#endif
+
+/* Kennung des Geräts, VID/PID des Virtual COM Port von ST */
+#define USBCDC_VID                0x0483
+#define USBCDC_PID                0x5740
+
+/* Ports des Geräts, je ein Sendepuffer aus Serial.c */
+#define USBCDC_PORT_SHELL         0      // Serial_Shell: Antworten der Kommandozeile, Telemetrie, Bildspiegel; Befehlszeilen vom PC
+#define USBCDC_PORT_LOG           1      // Serial_Log: printf und binäres LOG
+#define USBCDC_PORT_COUNT         2
+
+/* Paketgröße der Bulk-Endpunkte bei Full Speed */
+#define USBCDC_PACKET_SIZE        64
+
+/* Pakete, die der Sende-FIFO eines Ports vorhält (je 64 Bytes). Während der PC eines abholt, liegen
+   die nächsten schon bereit; der Interrupt füllt nach, sobald die Hälfte frei ist */
+#define USBCDC_TX_FIFO_PACKETS    16
+
+/* Größter Bulk-Transfer aus dem Ring, danach startet der Abschluss-Interrupt den nächsten */
+#define USBCDC_TRANSFER_MAX       4096
+
+/* Periode des Timers bei offenem bzw. ohne offenen Port: übernimmt neue Daten aus den Ringen */
+#define USBCDC_TICK_MS            2
+#define USBCDC_IDLE_MS            100
+
+/**
+ * @brief Zähler je Port
+ */
+typedef struct {
+	uint8_t open;                  // der PC hat DTR gesetzt, der Ring gehört dem USB-Port
+	uint32_t opens;
+	uint64_t txBytes;
+	uint32_t transfers;            // gestartete Bulk-Transfers
+	uint32_t zlps;                 // Null-Pakete am Ende eines Transfers aus vollen Paketen
+	uint32_t aborted;              // beim Schließen abgebrochene Transfers, der Rest geht über die UART
+	uint64_t rxBytes;
+	uint32_t lines;                // Befehlszeilen an die Kommandozeile
+	uint32_t rxDropped;            // Bytes einer Zeile über SHELL_RX_BUFFER_SIZE
+	uint32_t baud;                 // vom PC gesetzt (SET_LINE_CODING), ohne Wirkung
+} UsbCdc_PortStats;
+
+typedef struct {
+	uint8_t powered;               // 48 MHz und VDD33USB bereit, Kern initialisiert
+	uint8_t configured;            // SET_CONFIGURATION empfangen
+	uint8_t suspended;
+	uint32_t resets;               // Bus-Resets durch den PC
+	uint32_t suspends;
+	uint32_t setups;
+	uint32_t stalls;               // unbekannte Anfragen auf EP0
+	UsbCdc_PortStats port[USBCDC_PORT_COUNT];
+} UsbCdc_Stats;
+
+#if USBCDC_ENABLE
+
+void UsbCdc_Init(void);
+uint8_t UsbCdc_IsOpen(uint8_t port);
+uint8_t UsbCdc_IsActive(void);
+void UsbCdc_WakeFromStop(void);
+const UsbCdc_Stats* UsbCdc_GetStats(void);
+void UsbCdc_ResetStats(void);
+void UsbCdc_Dump(void);
+
+#else
+
+#define UsbCdc_Init()             ((void)0)
+#define UsbCdc_IsOpen(port)       (0U)
+#define UsbCdc_IsActive()         (0U)
+#define UsbCdc_WakeFromStop()     ((void)0)
+#define UsbCdc_ResetStats()       ((void)0)
+#define UsbCdc_Dump()             ((void)0)
+
+#endif /* USBCDC_ENABLE */
+
+#endif /* INC_USBCDC_H_ */
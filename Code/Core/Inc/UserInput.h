@@ -6,9 +6,11 @@
  * Definiert Funktionen und Datenstrukturen für das UserInput-Modul,
  * das Benutzereingaben (Joystick, Buttons) über GPIO-Pins verarbeitet.
  * Das Modul unterstützt:
- * - Zwei Betriebsmodi: Interrupt- oder Polling-basiert
- * - Entprellung via Delay oder Hardware-Timer
+ * - Drei Betriebsmodi: Interrupt- oder Polling-basiert oder Abtastung per DMA
+ * - Entprellung via Delay oder je Eingabe im 1-ms-Takt
  * - Flankenerkennung für sechs verschiedene Eingabetasten
+ * - Ereignis-Warteschlange mit Zeitstempel (DWT-Takte) statt einzelner Flags
+ * - Langer Druck, Wiederholung beim Halten und Tastenkombinationen
  *
  * @note Die Implementierung verwendet entweder den Interrupt- oder Polling-Modus,
  * was über Präprozessor-Direktiven konfiguriert wird.
@@ -28,23 +30,60 @@ enum UserInputs{
     MDS_DOWN,
     MDS_BUTTON,
     USER_BUTTON,
+    GAMEPAD_LEFT,           ///< ab hier Gamepad.c: Steuerkreuz oder linker Stick
+    GAMEPAD_RIGHT,
+    GAMEPAD_UP,
+    GAMEPAD_DOWN,
+    GAMEPAD_CROSS,
+    GAMEPAD_CIRCLE,
+    GAMEPAD_SQUARE,
+    GAMEPAD_TRIANGLE,
+    GAMEPAD_L1,
+    GAMEPAD_R1,
+    GAMEPAD_OPTIONS,
+    GAMEPAD_PS,
     USER_INPUT_NONE
 };
 
-/// Kommentiere eine der beiden Zeilen aus um den Interrupt oder Polling zu verwenden
+/// Eingaben an Pins (entprellt), die übrigen meldet UserInput_Inject() schon sauber
+#define USER_INPUT_PIN_COUNT (USER_BUTTON + 1)
+#define USER_INPUT_PIN_MASK ((1UL << USER_INPUT_PIN_COUNT) - 1)
+
+/// @brief Art eines Eingabeereignisses
+enum UserInputEvents{
+    USER_INPUT_PRESSED,     ///< entprellt gedrückt
+    USER_INPUT_RELEASED,    ///< entprellt losgelassen
+    USER_INPUT_LONG_PRESS,  ///< einmal, wenn die Taste die Zeit für den langen Druck gehalten wurde
+    USER_INPUT_REPEAT,      ///< wiederholt beim Halten, nur für Eingaben mit Wiederholung
+    USER_INPUT_CHORD        ///< mehrere Eingaben gleichzeitig gedrückt, siehe UserInput_Event.mask
+};
+
+/// Plätze in der Ereignis-Warteschlange (Zweierpotenz)
+#define USER_INPUT_QUEUE_SIZE 32
+
+/// @brief Ein Eingabeereignis, wie es UserInput_GetEvent() liefert
+typedef struct UserInput_Event{
+    uint8_t input;          ///< enum UserInputs (bei USER_INPUT_CHORD die zuletzt gedrückte)
+    uint8_t type;           ///< enum UserInputEvents
+    uint32_t mask;          ///< gedrückte Eingaben beim Ereignis (Bit = enum UserInputs)
+    uint64_t timeUs;        ///< Timebase_Us() bei der Erkennung der Flanke
+}UserInput_Event;
+
+/// Kommentiere eine der drei Zeilen aus um den Interrupt, Polling oder die DMA-Abtastung zu verwenden
 //#define USE_POLLING
 #define USE_INTERRUPT
+//#define USE_DMA_SAMPLING
 
 /// Check ob USE_POLLING und USE_INTERRUPT gleichzeitig definiert sind
 #if defined(USE_POLLING) && defined(USE_INTERRUPT)
 #error "Es darf nur USE_POLLING oder USE_INTERRUPT definiert sein, nicht beide!"
 #endif
 
-
-#ifdef USE_POLLING
-void PollingUserInput(void);
+#if defined(USE_DMA_SAMPLING) && (defined(USE_POLLING) || defined(USE_INTERRUPT))
+#error "USE_DMA_SAMPLING ersetzt USE_POLLING und USE_INTERRUPT, nur einen Modus definieren!"
 #endif
 
+
 /// Kommentiere eine der beiden Zeilen aus um entweder mit Delay oder Timern zu arbeiten
 //#define DEBOUNCE_WITH_DELAY
 #define DEBOUNCE_WITH_TIMER
@@ -55,12 +94,95 @@ void PollingUserInput(void);
 #endif
 
 #if defined(USE_INTERRUPT) && defined(DEBOUNCE_WITH_DELAY)
-#error "Es kann nicht USE_INTERRUPT und DEBOUNCE_WITH_TIMER gleichzeitig definiert sein! Weil Delay in den Interrupts nicht funktionieren!"
+#error "Es kann nicht USE_INTERRUPT und DEBOUNCE_WITH_DELAY gleichzeitig definiert sein! Die Bestätigung nach USER_INPUT_SETTLE_MS braucht PollingUserInput()!"
+#endif
+
+#if defined(USE_DMA_SAMPLING) && !defined(DEBOUNCE_WITH_TIMER)
+#error "USE_DMA_SAMPLING entprellt mit den Integratoren von DEBOUNCE_WITH_TIMER!"
+#endif
+
+/// Periode des Eingabe-Tasks in ms; jedes Ereignis gibt ihn über TOPIC_INPUT sofort frei,
+/// nur PollingUserInput() braucht den festen Takt, sonst ist die Periode eine Rückfallebene
+#if defined(USE_POLLING) && defined(DEBOUNCE_WITH_DELAY)
+#define USER_INPUT_TASK_MS 10
+#else
+#define USER_INPUT_TASK_MS 500
+#endif
+
+#if defined(USE_POLLING) && defined(DEBOUNCE_WITH_DELAY)
+/// Zeit in ms, nach der eine neu gedrückte Eingabe noch gedrückt sein muss; PollingUserInput() wartet sie nicht ab
+#define USER_INPUT_SETTLE_MS 50
+
+void PollingUserInput(void);
 #endif
 
 #ifdef DEBOUNCE_WITH_TIMER
-void HandleDebouncedUserInput(void);
-extern volatile uint8_t debounce_in_progress;
+/// Entprellzeit: so viele Millisekunden muss ein Pin stabil sein (höchstens 255)
+#define USER_INPUT_DEBOUNCE_MS 20
+
+#ifndef USE_DMA_SAMPLING
+/// Entprellt alle aktiven Eingaben, jede Millisekunde aus Realtime_Loop() aufrufen
+/// @param elapsedMs Millisekunden seit dem letzten Aufruf
+void UserInput_Tick(uint32_t elapsedMs);
+#endif
+
+/// Standardzeit bis zum langen Druck
+#define USER_INPUT_LONG_PRESS_MS 600
+
+/// Standardverzögerung bis zur ersten Wiederholung und Abstand der Wiederholungen
+#define USER_INPUT_REPEAT_DELAY_MS 400
+#define USER_INPUT_REPEAT_INTERVAL_MS 80
+
+/// Eingaben, die beim Halten standardmäßig wiederholt werden (Joystick-Richtungen für Menüs)
+#define USER_INPUT_REPEAT_DEFAULT ((1UL << MDS_LEFT) | (1UL << MDS_RIGHT) | (1UL << MDS_UP) | (1UL << MDS_DOWN) \
+                                 | (1UL << GAMEPAD_LEFT) | (1UL << GAMEPAD_RIGHT) | (1UL << GAMEPAD_UP) | (1UL << GAMEPAD_DOWN))
+
+/// Ob gerade eine Eingabe entprellt oder gehalten wird und der 1-ms-Takt gebraucht wird
+uint8_t UserInput_IsBusy(void);
+
+/// Zeit bis zum langen Druck einstellen
+/// @param ms Haltezeit in Millisekunden, 0 schaltet USER_INPUT_LONG_PRESS ab
+void UserInput_SetLongPress(uint16_t ms);
+
+/// Wiederholung beim Halten einstellen
+/// @param inputMask Eingaben mit Wiederholung (Bit = enum UserInputs)
+/// @param delayMs Haltezeit bis zur ersten Wiederholung
+/// @param intervalMs Abstand der Wiederholungen (mindestens 1)
+void UserInput_SetRepeat(uint32_t inputMask, uint16_t delayMs, uint16_t intervalMs);
+
+/// Entprellter Zustand aller Eingaben (Bit = enum UserInputs, 1 = gedrückt)
+uint32_t UserInput_GetPressed(void);
+
+/// Zustand externer Eingaben ohne Entprellung übernehmen (Gamepad), nur mit IRQ_PRIO_REALTIME aufrufen
+/// @param pressed Gedrückte Eingaben (Bit = enum UserInputs)
+/// @param mask Eingaben, die pressed beschreibt; Bits von Pin-Eingaben werden ignoriert
+/// @param timeUs Timebase_Us() der Änderung, Zeitstempel der Ereignisse
+void UserInput_Inject(uint32_t pressed, uint32_t mask, uint64_t timeUs);
+#endif
+
+#ifdef USE_DMA_SAMPLING
+/// Abtastrate der Ports GPIOB, C, D und E (TIM2, ganzzahliger Teiler von 1 MHz)
+#define USER_INPUT_SAMPLE_HZ 2000
+
+/// Abtastungen je Block; je halbem Ringpuffer entprellt ein Interrupt alle auf einmal (Zweierpotenz)
+#define USER_INPUT_SAMPLE_BLOCK 16
+
+/// Dauer eines Blocks in ms, so weit laufen Haltezeit, langer Druck und Wiederholung je Block
+#define USER_INPUT_SAMPLE_BLOCK_MS (USER_INPUT_SAMPLE_BLOCK * 1000 / USER_INPUT_SAMPLE_HZ)
+
+#if (USER_INPUT_SAMPLE_BLOCK * 1000) % USER_INPUT_SAMPLE_HZ != 0
+#error "USER_INPUT_SAMPLE_BLOCK Abtastungen müssen ganze Millisekunden ergeben!"
+#endif
+
+/// Startet TIM2 und die vier DMA-Streams, schaltet die EXTI-Leitungen der Eingaben ab
+/// @return 1 wenn die Abtastung läuft, 0 wenn kein DMA-Stream frei war
+uint8_t UserInput_StartSampling(void);
+
+/// Passt den Vorteiler von TIM2 nach einem Taktwechsel an
+void UserInput_ClockChanged(void);
+
+/// Bisher entprellte Blöcke (zum Prüfen, ob die Abtastung läuft)
+uint32_t UserInput_GetSampleBlocks(void);
 #endif
 
 #ifdef USE_INTERRUPT
@@ -70,16 +192,18 @@ void UserInput_Interrupt(uint16_t GPIO_Pin);
 #endif
 
 
-void HandlePendingUserInput(void);
-void HandleMDSLeft();
-void ResetFlanken();
+/// Holt das älteste Ereignis aus der Warteschlange
+/// @param event Ziel für das Ereignis
+/// @return 1 wenn ein Ereignis geliefert wurde, 0 wenn die Warteschlange leer ist
+uint8_t UserInput_GetEvent(UserInput_Event *event);
+
+/// Anzahl Ereignisse, die wegen voller Warteschlange verworfen wurden
+uint32_t UserInput_GetDropped(void);
 
+/// Anzahl der eingereihten Ereignisse seit dem Start (läuft über), ändert sich bei jeder Eingabe
+uint32_t UserInput_GetEventCount(void);
 
-extern volatile uint8_t MDS_LEFT_Flanke ;
-extern volatile uint8_t MDS_RIGHT_Flanke;
-extern volatile uint8_t MDS_UP_Flanke;
-extern volatile uint8_t MDS_DOWN_Flanke;
-extern volatile uint8_t MDS_BUTTON_Flanke;
-extern volatile uint8_t USER_BUTTON_Flanke;
+/// Name einer Eingabe für Ausgaben, z.B. "MDS_LEFT"
+const char* UserInput_GetName(enum UserInputs userInput);
 
 #endif //CLIONTEST_USERINPUT_H
@@ -6,10 +6,17 @@
  *
  * Diese Bibliothek ermöglicht:
  * - Lesen/Schreiben von Daten im Byte-Format
- * - Seiten-basierte Programmierung (256 Bytes)
- * - Sektor-Löschungen (4KB)
+ * - Seiten-basierte Programmierung (256 Bytes) per Quad Input Page Program
+ * - Sektor- und Block-Löschungen (4KB, 32KB, 64KB), Sektor-Löschen auch unterbrechbar
  * - Chip-Löschung
  * - Quad-SPI Unterstützung für schnellere Übertragungsraten
+ * - Memory-Mapped-Modus (XIP) mit Quad-I/O-Lesebefehl ab 0x90000000
+ * - Asynchrones Lesen im Hintergrund über OCTOSPI und MDMA
+ * - Asynchrones Programmieren: Seiten per MDMA, BUSY per Auto-Polling, nächste Seite aus dem Interrupt
+ * - RAM-Lesecache für kleine indirekte Lesezugriffe (sektorweise, LRU)
+ * - Optional Fast Read Quad I/O DTR (0xED) für indirekte und Memory-Mapped-Lesezugriffe
+ * - Erkennung von Kapazität, Lesebefehl und Löschgrößen aus der SFDP-Tabelle, 4-Byte-Adressen
+ *   ab 32 MB (W25Q256 und größer)
  * 
  * Angeschlossener Chip sollte mit STM32 QSPI-Interface verbunden sein.
  * 
@@ -22,15 +29,126 @@
 
 #include "main.h"
 
+/* Adressfenster des OCTOSPI1 im Memory-Mapped-Modus und Größe des W25Q128 (16 MB), falls der
+ * Chip keine SFDP-Tabelle liefert; die tatsächliche Größe steht in W25Qxx_Device.size */
+#define W25QXX_MAPPED_BASE    0x90000000UL
+#define W25QXX_FLASH_SIZE     (16UL * 1024UL * 1024UL)
+
+/* Größte Kapazität mit 3-Byte-Adressen, darüber schaltet W25Qxx_begin() auf 4-Byte-Adressen */
+#define W25QXX_3BYTE_LIMIT    (16UL * 1024UL * 1024UL)
+
+/* DTR-Lesebefehl (Fast Read Quad I/O DTR): 0 = nie, 1 = wenn die SFDP-Tabelle DTR meldet,
+ * 2 = immer versuchen. W25Qxx_EnableDtr() schaltet ihn erst nach bestandenem Selbsttest ein. */
+#define W25QXX_DTR_READ          1
+#define W25QXX_DTR_INSTRUCTION   0xED
+/* Wartetakte nach den Modusbits (ein DTR-Takt); die SFDP-Grundtabelle enthält sie nicht,
+ * 7 gilt für die W25Q-JV-DTR-Reihe bis 80 MHz */
+#define W25QXX_DTR_DUMMY_CYCLES  7
+/* Länge des Selbsttests, SDR- und DTR-Lesung liegen zusammen in einem Sektorpuffer */
+#define W25QXX_DTR_TEST_SIZE     2048UL
+
+/* Löschgrößen in W25Qxx_DeviceInfo.eraseInstruction */
+#define W25QXX_ERASE_4K       0
+#define W25QXX_ERASE_32K      1
+#define W25QXX_ERASE_64K      2
+#define W25QXX_ERASE_COUNT    3
+
+/**
+ * @brief Geometrie und Befehle des angeschlossenen Chips
+ * @note  Vorbelegt mit den Werten des W25Q128; W25Qxx_begin() übernimmt die Werte aus der
+ *        SFDP-Tabelle (JESD216), wenn der Chip eine gültige liefert.
+ */
+typedef struct {
+	uint32_t size;                                  // Kapazität in Bytes
+	uint32_t pageSize;                              // Programmierseite in Bytes
+	uint32_t addressSize;                           // HAL_OSPI_ADDRESS_24_BITS oder HAL_OSPI_ADDRESS_32_BITS
+	uint8_t eraseInstruction[W25QXX_ERASE_COUNT];   // 4 KB, 32 KB, 64 KB; 0 = Größe nicht vorhanden
+	uint8_t readInstruction;                        // schnellster Quad-Lesebefehl (0xEB oder 0x6B)
+	uint8_t readAddressLines;                       // 4 bei 1-4-4 (0xEB), 1 bei 1-1-4 (0x6B)
+	uint8_t readModeClocks;                         // Takte der Modusbits nach der Adresse (0 oder 2)
+	uint8_t readDummyCycles;                        // Wartetakte nach den Modusbits
+	uint8_t dtrInstruction;                         // DTR-Lesebefehl, 0 = nicht unterstützt
+	uint8_t readDtr;                                // 1: Lesebefehle laufen mit DTR (W25Qxx_EnableDtr)
+	uint8_t fromSfdp;                               // 1: Werte stammen aus der SFDP-Tabelle
+} W25Qxx_DeviceInfo;
+
+extern W25Qxx_DeviceInfo W25Qxx_Device;
+
+/* Größter Abschnitt eines MDMA-Transfers von W25Qxx_ReadAsync (MDMA-Blocklänge max. 64 KB) */
+#define W25QXX_DMA_MAX_CHUNK    (32UL * 1024UL)
+
+/* Timeout für blockierende Lesebefehle: 100 ms plus 1 ms pro KB */
+#define W25QXX_READ_TIMEOUT(size)  (100UL + ((size) >> 10))
+
+/* Lesecache im AXI-SRAM vor den indirekten Lesefunktionen. Auskommentieren, um jeden Zugriff
+ * direkt an den Chip zu geben. Im Memory-Mapped-Modus liest der D-Cache aus dem Fenster. */
+#define W25QXX_READ_CACHE
+
+/* Aufbau: LINES Zeilen zu je einem Sektor (8 x 4 KB = 32 KB), vollassoziativ mit LRU-Ersetzung */
+#define W25QXX_CACHE_LINE_SIZE  4096UL
+#define W25QXX_CACHE_LINES      8
+
+/* Ab dieser Größe gehen Lesezugriffe am Cache vorbei direkt in den Aufruferpuffer (Bilder, Sektoren) */
+#define W25QXX_CACHE_BYPASS     1024UL
+
+/**
+ * @brief Trefferstatistik des Lesecaches
+ */
+typedef struct {
+	uint32_t hits;           // Aus dem Cache bediente Zeilenzugriffe
+	uint32_t misses;         // Vom Chip nachgeladene Zeilen
+	uint32_t bypassed;       // Große Zugriffe am Cache vorbei
+	uint32_t invalidations;  // Durch Schreib- und Löschvorgänge verworfene Zeilen
+} W25Qxx_CacheStats;
+
+extern W25Qxx_CacheStats W25Qxx_CacheStatistics;
+
+/**
+ * @brief Callback, der nach Abschluss von W25Qxx_ReadAsync aufgerufen wird
+ * @note  Wird im Interrupt-Kontext (OCTOSPI1/MDMA) ausgeführt
+ */
+typedef void (*W25Qxx_ReadCallback)(HAL_StatusTypeDef status);
+
+/**
+ * @brief Callback, der nach Abschluss von W25Qxx_ProgramAsync aufgerufen wird
+ * @note  Wird im Interrupt-Kontext (OCTOSPI1) ausgeführt
+ */
+typedef void (*W25Qxx_ProgramCallback)(HAL_StatusTypeDef status);
+
+/**
+ * @brief Zähler der Programmieraufträge
+ */
+typedef struct {
+	uint32_t writes;         // Gestartete W25Qxx_ProgramAsync-Aufträge (auch aus W25Qxx_WriteData/PageProgram)
+	uint32_t pages;          // Programmierte Seiten
+	uint32_t skipped;        // Übersprungene Seiten, die nur 0xFF enthielten
+	uint32_t errors;         // Abgebrochene Aufträge (HAL-Fehler, Zeitüberschreitung)
+} W25Qxx_ProgramStats;
+
+extern W25Qxx_ProgramStats W25Qxx_ProgramStatistics;
+
+/* Längste Zeit für eine Seite in W25Qxx_WaitProgramAsync, danach Abbruch (tPP max. 3 ms beim W25Q128) */
+#define W25QXX_PAGE_TIMEOUT_MS  20
+
+/* Längste Wartezeit auf das BUSY-Bit per Auto-Polling (Chip-Erase des W25Q128 dauert bis zu 200 s,
+ * größere Chips wählen ihre Löscheinheit ohnehin über W25Qxx_WriteData) */
+#define W25QXX_BUSY_TIMEOUT_MS  200000UL
+
+/* Zeiger auf eine Flash-Adresse im Memory-Mapped-Modus */
+#define W25Qxx_MappedAddress(address)  ((const uint8_t*)(W25QXX_MAPPED_BASE + (uint32_t)(address)))
+
 /**
  * @brief  Initialisiert den W25Qxx Flash-Speicherchip
  * @retval Status: 0 bei Fehler, 1 bei erfolgreicher Initialisierung
+ * @note   Liest die SFDP-Tabelle (0x5A) und richtet danach W25Qxx_Device, die Gerätegröße des
+ *         OCTOSPI1, die MPU-Region des Adressfensters und bei Bedarf 4-Byte-Adressen ein
  */
 uint8_t W25Qxx_begin();
 
 /**
  * @brief  Wartet, bis eine Schreib- oder Löschoperation abgeschlossen ist
- * @note   Diese Funktion blockiert, bis der Chip bereit für neue Befehle ist
+ * @note   Diese Funktion blockiert, bis der Chip bereit für neue Befehle ist. Das BUSY-Bit
+ *         wird vom OCTOSPI im Auto-Polling-Modus abgefragt (Status-Match-Interrupt).
  */
 void W25Qxx_WaitForWriteComplete(void);
 
@@ -48,11 +166,53 @@ void W25Qxx_WriteEnable();
 void W25Qxx_EraseSector(uint32_t address);
 
 /**
- * @brief  Programmiert eine Seite (bis zu 256 Bytes) im Flash-Speicher
+ * @brief  Löscht einen 32KB Block an der angegebenen Adresse (0x52)
+ * @param  address: Startadresse des Blocks (32KB-ausgerichtet)
+ * @note   Write Enable muss vorher gesendet werden
+ */
+void W25Qxx_EraseBlock32K(uint32_t address);
+
+/**
+ * @brief  Löscht einen 64KB Block an der angegebenen Adresse (0xD8)
+ * @param  address: Startadresse des Blocks (64KB-ausgerichtet)
+ * @note   Write Enable muss vorher gesendet werden
+ */
+void W25Qxx_EraseBlock64K(uint32_t address);
+
+/**
+ * @brief  Startet das Löschen eines 4KB Sektors, ohne zu warten
+ * @param  address: Startadresse des Sektors
+ * @note   Ende mit W25Qxx_IsBusy() abfragen; anhalten mit W25Qxx_EraseSuspend()
+ */
+void W25Qxx_EraseSectorStart(uint32_t address);
+
+/**
+ * @brief  Gibt an, ob ein Schreib- oder Löschvorgang läuft (BUSY-Bit)
+ */
+uint8_t W25Qxx_IsBusy(void);
+
+/**
+ * @brief  Hält einen laufenden Löschvorgang an (0x75), andere Sektoren sind dann zugänglich
+ */
+void W25Qxx_EraseSuspend(void);
+
+/**
+ * @brief  Setzt einen angehaltenen Löschvorgang fort (0x7A)
+ */
+void W25Qxx_EraseResume(void);
+
+/**
+ * @brief  Gibt an, ob ein Löschvorgang angehalten ist; Löschfunktionen beenden ihn vorher selbst
+ */
+uint8_t W25Qxx_IsEraseSuspended(void);
+
+/**
+ * @brief  Programmiert eine Seite (bis zu W25Qxx_Device.pageSize Bytes) im Flash-Speicher
  * @param  address: Zieladresse im Flash (muss Seiten-ausgerichtet sein)
  * @param  data: Zeiger auf die zu schreibenden Daten
- * @param  size: Größe der zu schreibenden Daten (max. 256 Bytes)
- * @note   Die Seite muss vorher gelöscht sein (0xFF)
+ * @param  size: Größe der zu schreibenden Daten (max. eine Seite)
+ * @note   Die Seite muss vorher gelöscht sein (0xFF). Daten werden über vier Leitungen
+ *         gesendet (0x32), der Quad-Modus muss aktiv sein.
  */
 void W25Qxx_PageProgram(uint32_t address, uint8_t *data, uint32_t size);
 
@@ -80,14 +240,59 @@ void W25Qxx_FastReadData(uint32_t address, uint8_t *buffer, uint32_t size);
 void W25Qxx_Read_Manu_ID(uint8_t *manufacturerID, uint8_t *deviceID);
 
 /**
- * @brief  Liest Daten im Quad-Output-Modus (4 Datenleitungen)
+ * @brief  Liest Daten mit dem schnellsten Quad-Lesebefehl (4 Datenleitungen)
  * @param  address: Quelladresse im Flash
  * @param  buffer: Zielpuffer für die gelesenen Daten
  * @param  size: Anzahl zu lesender Bytes
- * @note   Quad-Modus muss vorher aktiviert sein
+ * @note   Quad-Modus muss vorher aktiviert sein. Befehl und Wartetakte stehen in W25Qxx_Device
+ *         (0xEB mit 4 Wartetakten beim W25Q128, sonst 0x6B mit 8).
  */
 void W25Qxx_FastReadQuadOutput(uint32_t address, uint8_t *buffer, uint32_t size);
 
+/**
+ * @brief  Liest Daten im Quad-Output-Modus per MDMA im Hintergrund
+ * @param  address: Quelladresse im Flash
+ * @param  buffer: Zielpuffer (möglichst 32-Byte-ausgerichtet, D-Cache wird gepflegt)
+ * @param  size: Anzahl zu lesender Bytes
+ * @param  callback: Wird nach Abschluss aufgerufen, darf NULL sein
+ * @retval HAL_OK bei Start, HAL_BUSY wenn noch ein Transfer läuft, sonst HAL_ERROR
+ */
+HAL_StatusTypeDef W25Qxx_ReadAsync(uint32_t address, uint8_t *buffer, uint32_t size, W25Qxx_ReadCallback callback);
+
+/**
+ * @brief  Gibt an, ob ein W25Qxx_ReadAsync-Transfer läuft
+ */
+uint8_t W25Qxx_IsReadBusy(void);
+
+/**
+ * @brief  Wartet, bis ein laufender W25Qxx_ReadAsync-Transfer beendet ist
+ */
+void W25Qxx_WaitReadAsync(void);
+
+/**
+ * @brief  Programmiert einen gelöschten Bereich beliebiger Länge im Hintergrund
+ * @param  address: Zieladresse im Flash, der Bereich muss gelöscht sein
+ * @param  data: Quelldaten, gültig und unverändert bis zum Callback
+ * @param  size: Anzahl zu schreibender Bytes
+ * @param  callback: Wird nach der letzten Seite aufgerufen, darf NULL sein
+ * @retval HAL_OK bei Start, HAL_BUSY wenn noch ein Lese- oder Schreibauftrag läuft, sonst HAL_ERROR
+ * @note   Je Seite Write Enable und Page Program aus dem Status-Match-Interrupt der vorigen,
+ *         Daten per MDMA; Seiten mit nur 0xFF werden übersprungen. Der Memory-Mapped-Modus
+ *         bleibt danach aus.
+ */
+HAL_StatusTypeDef W25Qxx_ProgramAsync(uint32_t address, const uint8_t *data, uint32_t size, W25Qxx_ProgramCallback callback);
+
+/**
+ * @brief  Gibt an, ob ein W25Qxx_ProgramAsync-Auftrag läuft
+ */
+uint8_t W25Qxx_IsProgramBusy(void);
+
+/**
+ * @brief  Wartet, bis ein laufender W25Qxx_ProgramAsync-Auftrag beendet ist
+ * @retval Ergebnis des Auftrags, HAL_TIMEOUT nach W25QXX_PAGE_TIMEOUT_MS ohne Fortschritt
+ */
+HAL_StatusTypeDef W25Qxx_WaitProgramAsync(void);
+
 /**
  * @brief  Aktiviert den Quad-SPI-Modus für schnellere Datenübertragung
  * @note   Nach dem Aufruf können Quad-Funktionen verwendet werden
@@ -106,8 +311,51 @@ void W25Qxx_ChipErase(void);
  * @param  data: Zeiger auf die zu schreibenden Daten
  * @param  size: Größe der zu schreibenden Daten
  * @note   Diese Funktion kümmert sich um die Aufteilung in Seiten,
- *         automatisches Löschen bei Bedarf und korrekte Adressierung
+ *         automatisches Löschen mit der größten passenden Einheit (64KB/32KB/4KB)
+ *         und korrekte Adressierung. Angeschnittene Sektoren werden per
+ *         Read-Modify-Write erhalten.
  */
 void W25Qxx_WriteData(int32_t address, uint8_t *data, uint32_t size);
 
+/**
+ * @brief  Schaltet alle Quad-Lesebefehle auf DTR (0xED) um, wenn der Selbsttest besteht
+ * @param  testAddress: Anfang eines Bereichs mit wechselnden Daten (W25QXX_DTR_TEST_SIZE Bytes),
+ *         z. B. das Prüfmuster des Bus-Tunings
+ * @retval 1, wenn DTR danach aktiv ist; 0 bei fehlender Unterstützung oder Abweichung von SDR
+ * @note   Nach einer Änderung des OCTOSPI-Timings erneut aufrufen
+ */
+uint8_t W25Qxx_EnableDtr(uint32_t testAddress);
+
+/**
+ * @brief  Schaltet die Lesebefehle zurück auf SDR
+ */
+void W25Qxx_DisableDtr(void);
+
+/**
+ * @brief  Verwirft die Zeilen des Lesecaches, die den Bereich berühren
+ * @param  address: Anfang des geänderten Bereichs
+ * @param  size: Länge in Bytes, 0xFFFFFFFF verwirft alles
+ * @note   Die Schreib- und Löschfunktionen des Treibers rufen das selbst auf
+ */
+void W25Qxx_InvalidateReadCache(uint32_t address, uint32_t size);
+
+/**
+ * @brief  Schaltet OCTOSPI1 in den Memory-Mapped-Modus (XIP)
+ * @retval Status: 0 bei Fehler, 1 bei Erfolg
+ * @note   Danach ist der Flash ab W25QXX_MAPPED_BASE lesbar. Lesefunktionen kopieren dann
+ *         direkt aus dem Adressfenster; Schreib- und Löschfunktionen verlassen den Modus
+ *         vorübergehend selbst.
+ */
+uint8_t W25Qxx_EnableMemoryMapped(void);
+
+/**
+ * @brief  Verlässt den Memory-Mapped-Modus und setzt den Continuous-Read-Modus des Chips zurück
+ */
+void W25Qxx_DisableMemoryMapped(void);
+
+/**
+ * @brief  Gibt an, ob der Memory-Mapped-Modus aktiv ist
+ */
+uint8_t W25Qxx_IsMemoryMapped(void);
+
 #endif /* INC_W25QXX_QSPI_H_ */
@@ -10,16 +10,27 @@
 
 #include "main.h"
 
-#define MAX_LED 1
+#define MAX_LED 1          // Anzahl LEDs am Streifen (TIM1_CH1), Speicherbedarf 3 Byte je LED
 #define USE_BRIGHTNESS 1
+#define WS2812_USE_GAMMA 1      // Farbwerte beim Senden gammakorrigieren (Tabelle in WS2812.c)
+#define WS2812_BRIGHTNESS_MAX 45 // höchste Stufe für WS2812_SetBrightness()
 
-extern uint8_t LED_Data[4];
-extern uint8_t LED_Mod[4];  // for brightness
+// Höchste Frame-Rate von WS2812_Show() in Hz (änderbar mit WS2812_SetFrameRate())
+#define WS2812_FRAME_RATE 50
 
-extern uint16_t pwmData[(24*1)+50];
+// Reset-Pause am Ende eines Frames in LED-Zeiten (je 24 Bit = 30 us), mindestens 50 us
+#define WS2812_RESET_SLOTS 3
 
+extern uint8_t WS2812_Pixels[MAX_LED][3];   // je LED Grün, Rot, Blau (Reihenfolge auf der Leitung)
+
+void WS2812_Init(void);
 void WS2812_SetLED(int Red, int Green, int Blue);
+void WS2812_SetPixel(uint16_t index, uint8_t Red, uint8_t Green, uint8_t Blue);
+void WS2812_SetAll(uint8_t Red, uint8_t Green, uint8_t Blue);
 void WS2812_SetBrightness (int brightness);
-void WS2812_Send (void);
+uint8_t WS2812_Send (void);
+uint8_t WS2812_Show(void);
+void WS2812_SetFrameRate(uint32_t fps);
+uint8_t WS2812_IsBusy(void);
 
 #endif /* INC_WS2812_H_ */
@@ -0,0 +1,93 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef INC_WARMBOOT_H_
+#define INC_WARMBOOT_H_
+
+#include "main.h"
+
+/* Ergebnisse langsamer Initialisierungen im SRD-SRAM über einen Software- oder Watchdog-Reset retten, 0 = jeder Start kalt */
+#ifndef WARMBOOT_ENABLE
+#define WARMBOOT_ENABLE           1
+#endif
+
+/* Kennung und Aufbau des geretteten Blocks; eine neue Version verwirft alte Inhalte */
+#define WARMBOOT_MAGIC            0x5741524DUL     // "WARM"
+#define WARMBOOT_VERSION          1
+
+/* Platz je Eintrag, der größte ist die SD-Karte (Tuning, Kartendaten, CID und CSD) */
+#define WARMBOOT_ITEM_SIZE        96
+
+/**
+ * @brief Gerettete Einträge, je einer pro langsamer Initialisierung
+ */
+typedef enum {
+	WARMBOOT_ITEM_ADC1 = 0,       // Offset- und Linearitätskalibrierung von ADC1 (Potis)
+	WARMBOOT_ITEM_ADC2,           // dasselbe für ADC2 (Chiptemperatur)
+	WARMBOOT_ITEM_OSPI,           // geprüftes Timing des OCTOSPI1 für das Startprofil
+	WARMBOOT_ITEM_SD,             // ausgehandelter Busmodus und Kartendaten der SD-Karte
+	WARMBOOT_ITEM_UI,             // Lichteffekt und Statuszeile
+	WARMBOOT_ITEM_COUNT
+} WarmBoot_Item;
+
+/**
+ * @brief Ursache des letzten Resets (RCC_RSR)
+ */
+typedef enum {
+	WARMBOOT_CAUSE_POWER = 0,     // Einschalten oder Brown-out: SRD-SRAM ist zufällig
+	WARMBOOT_CAUSE_PIN,           // Reset-Taster, Debugger
+	WARMBOOT_CAUSE_SOFTWARE,      // NVIC_SystemReset(), auch nach WarmBoot_Fault()
+	WARMBOOT_CAUSE_WATCHDOG,      // IWDG1 oder WWDG1
+	WARMBOOT_CAUSE_OTHER          // Low-Power-Reset, Domäne
+} WarmBoot_Cause;
+
+/**
+ * @brief Zustand des letzten Starts
+ */
+typedef struct {
+	WarmBoot_Cause cause;
+	uint32_t rsr;                  // RCC_RSR beim Start
+	uint8_t warm;                  // gerettete Einträge dürfen benutzt werden
+	uint32_t warmBoots;            // Warmstarts seit dem letzten kalten Start
+	uint32_t fault;                // WarmBoot_Fault()-Grund vor diesem Reset, 0 = keiner
+	uint32_t faultCfsr;            // SCB->CFSR, HFSR und die Fehleradresse dazu
+	uint32_t faultHfsr;
+	uint32_t faultAddress;
+	uint32_t restored;             // Bit je WarmBoot_Item: beim Start übernommen
+	uint32_t missing;              // Bit je WarmBoot_Item: warm, aber ungültig oder abgelehnt
+	uint32_t saves;
+} WarmBoot_Stats;
+
+/* Gründe für WarmBoot_Fault() */
+#define WARMBOOT_FAULT_HARD       1
+#define WARMBOOT_FAULT_ERROR      2
+
+#if WARMBOOT_ENABLE
+
+void WarmBoot_Init(void);
+uint8_t WarmBoot_IsWarm(void);
+uint8_t WarmBoot_Load(WarmBoot_Item item, void *data, uint16_t size);
+uint8_t WarmBoot_Save(WarmBoot_Item item, const void *data, uint16_t size);
+void WarmBoot_Invalidate(WarmBoot_Item item);
+uint8_t WarmBoot_CalibrateAdc(ADC_HandleTypeDef *hadc, WarmBoot_Item item);
+void WarmBoot_Fault(uint32_t reason);
+void WarmBoot_Confirm(void);
+const WarmBoot_Stats* WarmBoot_GetStats(void);
+void WarmBoot_Dump(void);
+
+#else
+
+#define WarmBoot_Init()                   ((void)0)
+#define WarmBoot_IsWarm()                 (0U)
+#define WarmBoot_Load(item, data, size)   (0U)
+#define WarmBoot_Save(item, data, size)   (0U)
+#define WarmBoot_Invalidate(item)         ((void)0)
+#define WarmBoot_CalibrateAdc(hadc, item) (HAL_ADCEx_Calibration_Start((hadc), ADC_CALIB_OFFSET_LINEARITY, ADC_SINGLE_ENDED) == HAL_OK)
+#define WarmBoot_Fault(reason)            ((void)0)
+#define WarmBoot_Confirm()                ((void)0)
+#define WarmBoot_Dump()                   ((void)0)
+
+#endif /* WARMBOOT_ENABLE */
+
+#endif /* INC_WARMBOOT_H_ */
@@ -46,6 +46,13 @@ extern "C" {
 
 /* Exported macro ------------------------------------------------------------*/
 /* USER CODE BEGIN EM */
+/* Funktion im ITCM ausführen (ohne Flash-Wartezyklen, vom Startup-Code kopiert), für ISRs und
+ * innere Schleifen. Aufrufe zwischen ITCM und Flash laufen über vom Linker erzeugte Veneers. */
+#define RAMFUNC   __attribute__((section(".itcm_text"), noinline))
+
+/* Variable im DTCM ablegen (ohne Wartezyklen, Startwert aus dem Flash). DMA1/DMA2 erreichen
+ * das DTCM nicht, DMA-Puffer gehören nach DMA_BUFFER (Cache.h). */
+#define FASTDATA  __attribute__((section(".dtcm_data")))
 
 /* USER CODE END EM */
 
@@ -82,6 +89,9 @@ void Error_Handler(void);
 #define DISPLAY_RESET_GPIO_Port GPIOD
 #define DISPLAY_DC_Pin GPIO_PIN_10
 #define DISPLAY_DC_GPIO_Port GPIOD
+#define DISPLAY_TE_Pin GPIO_PIN_11
+#define DISPLAY_TE_GPIO_Port GPIOD
+#define DISPLAY_TE_EXTI_IRQn EXTI15_10_IRQn
 #define MDS_BUTTON_Pin GPIO_PIN_14
 #define MDS_BUTTON_GPIO_Port GPIOD
 #define MDS_BUTTON_EXTI_IRQn EXTI15_10_IRQn
@@ -35,12 +35,52 @@ extern "C" {
 extern OSPI_HandleTypeDef hospi1;
 
 /* USER CODE BEGIN Private defines */
+/* Bus-Tuning nach W25Qxx_begin(): Prüfmuster im Sektor vor dem Schlüssel/Wert-Speicher (FLASHKV_BASE_ADDRESS) */
+#define OCTOSPI1_TUNE_ADDRESS      0x00FEF000UL
+#define OCTOSPI1_TUNE_SIZE         256
+
+/* Lesevorgänge je Einstellung; eine Einstellung besteht nur, wenn alle fehlerfrei sind */
+#define OCTOSPI1_TUNE_REPEAT       8
+
+/* Phasen des Delay Blocks (12 Abgriffe je Takt) und kleinstes Fenster bestandener Phasen */
+#define OCTOSPI1_TUNE_PHASES       12
+#define OCTOSPI1_TUNE_MIN_WINDOW   3
+
+/* delayPhase: Delay Block überbrückt (DCR1.DLYBYP) */
+#define OCTOSPI1_TUNE_BYPASS       0xFF
+
+/**
+ * @brief Timing des OCTOSPI1: Vorteiler, Abtastzeitpunkt und Delay Block
+ */
+typedef struct {
+  uint8_t prescaler;       /* CLK = HCLK / prescaler (DCR2.PRESCALER + 1) */
+  uint8_t sampleShift;     /* 1: Abtastung einen halben Takt später (TCR.SSHIFT) */
+  uint8_t delayPhase;      /* Abgriff des Delay Blocks 0..11 oder OCTOSPI1_TUNE_BYPASS */
+  uint8_t delayUnit;       /* Verzögerung je Stufe, von DelayBlock_Enable() auf einen Takt kalibriert */
+} OCTOSPI1_Setting;
+
+/**
+ * @brief Ergebnis des Bus-Tunings für das aktive Taktprofil
+ */
+typedef struct {
+  OCTOSPI1_Setting setting;
+  uint32_t clockHz;        /* Resultierender Takt an CLK */
+  uint8_t fromStore;       /* 1: Einstellung aus dem Schlüssel/Wert-Speicher, nur geprüft; 2: vom Warmstart übernommen */
+  uint8_t tested;          /* Geprüfte Einstellungen im Durchlauf */
+  uint8_t passed;          /* Davon bestanden */
+} OCTOSPI1_TuneResult;
+
+extern OCTOSPI1_TuneResult OCTOSPI1_Tuning;
 
 /* USER CODE END Private defines */
 
 void MX_OCTOSPI1_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+HAL_StatusTypeDef MX_OCTOSPI1_TuneBus(uint8_t force);
+void MX_OCTOSPI1_GetSetting(uint8_t profile, OCTOSPI1_Setting *setting);
+uint8_t MX_OCTOSPI1_IsApplied(const OCTOSPI1_Setting *setting);
+void MX_OCTOSPI1_ApplySetting(const OCTOSPI1_Setting *setting);
 
 /* USER CODE END Prototypes */
 
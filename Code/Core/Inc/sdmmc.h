@@ -35,12 +35,35 @@ extern "C" {
 extern SD_HandleTypeDef hsd1;
 
 /* USER CODE BEGIN Private defines */
+/* Bus-Tuning nach HAL_SD_Init: 4-Bit-Bus (D1..D3 an PC9..PC11) und High-Speed (SDR25) versuchen.
+ * Auskommentieren, um beim 1-Bit-Bus bzw. Default-Speed zu bleiben. */
+#define SDMMC1_TUNE_4BIT
+#define SDMMC1_TUNE_HIGH_SPEED
+
+/* Sektoren für Read-Verify und Bandbreitenmessung */
+#define SDMMC1_TUNE_VERIFY_BLOCKS  8
+#define SDMMC1_TUNE_BENCH_BLOCKS   256
+
+/**
+ * @brief Ergebnis des Bus-Tunings
+ */
+typedef struct {
+  uint8_t busWidth;        /* 1 oder 4 */
+  uint8_t highSpeed;       /* 1: SDR25 aktiv */
+  uint32_t clockDiv;       /* CLKDIV-Wert im CLKCR */
+  uint32_t clockHz;        /* Resultierender SDMMC_CK */
+  uint32_t bandwidthKBs;   /* Gemessene Lesebandbreite in KB/s */
+} SDMMC1_TuneResult;
+
+extern SDMMC1_TuneResult SDMMC1_Tuning;
 
 /* USER CODE END Private defines */
 
 void MX_SDMMC1_SD_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+HAL_StatusTypeDef MX_SDMMC1_TuneBus(void);
+HAL_StatusTypeDef MX_SDMMC1_Resume(void);
 
 /* USER CODE END Prototypes */
 
@@ -34,6 +34,8 @@ extern "C" {
 
 extern TIM_HandleTypeDef htim1;
 
+extern TIM_HandleTypeDef htim3;
+
 extern TIM_HandleTypeDef htim6;
 
 extern TIM_HandleTypeDef htim7;
@@ -43,6 +45,7 @@ extern TIM_HandleTypeDef htim7;
 /* USER CODE END Private defines */
 
 void MX_TIM1_Init(void);
+void MX_TIM3_Init(void);
 void MX_TIM6_Init(void);
 void MX_TIM7_Init(void);
 
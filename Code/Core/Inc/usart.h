@@ -34,6 +34,8 @@ extern "C" {
 
 extern UART_HandleTypeDef hlpuart1;
 
+extern UART_HandleTypeDef huart4;
+
 extern UART_HandleTypeDef huart7;
 
 /* USER CODE BEGIN Private defines */
@@ -41,6 +43,7 @@ extern UART_HandleTypeDef huart7;
 /* USER CODE END Private defines */
 
 void MX_LPUART1_UART_Init(void);
+void MX_UART4_Init(void);
 void MX_UART7_Init(void);
 
 /* USER CODE BEGIN Prototypes */
@@ -21,13 +21,59 @@
 #include "adc.h"
 
 /* USER CODE BEGIN 0 */
+#include "tim.h"
+#include "Cache.h"
+#include "Topic.h"
+#include "WarmBoot.h"
+
 uint16_t Poti1Value;
 uint16_t Poti2Value;
 uint16_t Poti3Value;
 uint16_t Poti4Value;
+
+// Ziel der ADC-DMA: ein überabgetasteter Wert je Poti, in der Reihenfolge der Ranks
+volatile uint16_t ADC_PotiBuffer[ADC_POTI_COUNT] DMA_BUFFER;
+
+// Messbetrieb: Ping-Pong-Puffer, die DMA füllt ihn zirkulär, die Hälften gehen als Blöcke raus
+uint16_t ADC_AcqBuffer[2 * ADC_ACQ_HALF_SAMPLES] DMA_BUFFER;
+
+typedef struct {
+  ADC_BlockCallback callback;
+  void *context;
+} ADC_Listener;
+
+ADC_Listener ADC_Listeners[ADC_ACQ_MAX_LISTENERS];
+uint8_t ADC_ListenerCount = 0;
+
+ADC_AcqConfig ADC_AcqActive;
+uint8_t ADC_Acquiring = 0;
+uint8_t ADC_AcqSlots;
+uint8_t ADC_AcqSlotChannel[ADC_ACQ_MAX_SLOTS];
+uint16_t ADC_AcqScans;                   // Scans je Hälfte
+ADC_Block ADC_Blocks[2];
+volatile uint8_t ADC_BlockHolds[2];      // Empfänger, die die Hälfte noch lesen
+uint32_t ADC_BlockSequence = 0;
+ADC_AcqStats ADC_Stats;
+
+// Channels of VR1-VR4 in pot order
+static const uint32_t ADC_PotiChannels[ADC_POTI_COUNT] = {
+  ADC_CHANNEL_10, ADC_CHANNEL_11, ADC_CHANNEL_14, ADC_CHANNEL_15
+};
+
+static const uint32_t ADC_Ranks[ADC_ACQ_MAX_SLOTS] = {
+  ADC_REGULAR_RANK_1, ADC_REGULAR_RANK_2, ADC_REGULAR_RANK_3, ADC_REGULAR_RANK_4,
+  ADC_REGULAR_RANK_5, ADC_REGULAR_RANK_6, ADC_REGULAR_RANK_7, ADC_REGULAR_RANK_8,
+  ADC_REGULAR_RANK_9, ADC_REGULAR_RANK_10, ADC_REGULAR_RANK_11, ADC_REGULAR_RANK_12,
+  ADC_REGULAR_RANK_13, ADC_REGULAR_RANK_14, ADC_REGULAR_RANK_15, ADC_REGULAR_RANK_16
+};
+
+static uint8_t ADC_Configure(const uint8_t *slotChannel, uint8_t slots, uint16_t oversampling,
+    uint32_t scanHz, volatile uint16_t *buffer, uint32_t length);
+static void ADC_BlockDone(uint8_t half);
 /* USER CODE END 0 */
 
 ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
 
 /* ADC1 init function */
 void MX_ADC1_Init(void)
@@ -54,14 +100,17 @@ void MX_ADC1_Init(void)
   hadc1.Init.LowPowerAutoWait = DISABLE;
   hadc1.Init.ContinuousConvMode = DISABLE;
   hadc1.Init.NbrOfConversion = 4;
-  hadc1.Init.DiscontinuousConvMode = ENABLE;
-  hadc1.Init.NbrOfDiscConversion = 1;
-  hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
-  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
-  hadc1.Init.ConversionDataManagement = ADC_CONVERSIONDATA_DR;
-  hadc1.Init.Overrun = ADC_OVR_DATA_PRESERVED;
+  hadc1.Init.DiscontinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIG_T3_TRGO;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc1.Init.ConversionDataManagement = ADC_CONVERSIONDATA_DMA_CIRCULAR;
+  hadc1.Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
   hadc1.Init.LeftBitShift = ADC_LEFTBITSHIFT_NONE;
-  hadc1.Init.OversamplingMode = DISABLE;
+  hadc1.Init.OversamplingMode = ENABLE;
+  hadc1.Init.Oversampling.Ratio = 16;
+  hadc1.Init.Oversampling.RightBitShift = ADC_RIGHTBITSHIFT_4;
+  hadc1.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+  hadc1.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
   if (HAL_ADC_Init(&hadc1) != HAL_OK)
   {
     Error_Handler();
@@ -79,7 +128,7 @@ void MX_ADC1_Init(void)
   */
   sConfig.Channel = ADC_CHANNEL_10;
   sConfig.Rank = ADC_REGULAR_RANK_1;
-  sConfig.SamplingTime = ADC_SAMPLETIME_1CYCLE_5;
+  sConfig.SamplingTime = ADC_SAMPLETIME_8CYCLES_5;
   sConfig.SingleDiff = ADC_SINGLE_ENDED;
   sConfig.OffsetNumber = ADC_OFFSET_NONE;
   sConfig.Offset = 0;
@@ -170,6 +219,25 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
     GPIO_InitStruct.Pull = GPIO_NOPULL;
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
+    /* ADC1 DMA Init */
+    /* ADC1 Init */
+    hdma_adc1.Instance = DMA1_Stream0;
+    hdma_adc1.Init.Request = DMA_REQUEST_ADC1;
+    hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_adc1.Init.Mode = DMA_CIRCULAR;
+    hdma_adc1.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_adc1.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&hdma_adc1) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(adcHandle,DMA_Handle,hdma_adc1);
+
     /* ADC1 interrupt Init */
     HAL_NVIC_SetPriority(ADC_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(ADC_IRQn);
@@ -200,6 +268,9 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 
     HAL_GPIO_DeInit(GPIOA, VR3_Pin|VR4_Pin);
 
+    /* ADC1 DMA DeInit */
+    HAL_DMA_DeInit(adcHandle->DMA_Handle);
+
     /* ADC1 interrupt Deinit */
     HAL_NVIC_DisableIRQ(ADC_IRQn);
   /* USER CODE BEGIN ADC1_MspDeInit 1 */
@@ -209,43 +280,340 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 }
 
 /* USER CODE BEGIN 1 */
-uint16_t UpdatePotiValues() {
-  for (int i = 0; i< 4;i++){
-    HAL_ADC_Start(&hadc1);
-    HAL_ADC_PollForConversion(&hadc1, 1);
-    uint16_t ADC_Reading = HAL_ADC_GetValue(&hadc1);
-
-    switch (i){
-      case 0:
-        Poti1Value = ADC_Reading;
-      break;
-      case 1:
-        Poti2Value = ADC_Reading;
-      break;
-      case 2:
-        Poti3Value = ADC_Reading;
-      break;
-      case 3:
-        Poti4Value = ADC_Reading;
-      break;
+/**
+  * @brief  Kalibriert ADC1 (nach einem Warmstart mit den geretteten Faktoren) und startet die Abtastung der Potis im Hintergrund
+  *
+  * TIM3 löst mit ADC_SCAN_HZ je einen Scan über VR1-VR4 aus, jeder Kanal wird dabei
+  * 16-fach überabgetastet und auf 16 Bit zurückgeschoben. Die DMA schreibt zirkulär nach
+  * ADC_PotiBuffer; die CPU ist an der Wandlung nicht beteiligt.
+  * @retval 1 bei Erfolg, 0 bei einem Fehler der HAL
+  */
+uint8_t ADC_Start(void) {
+  static const uint8_t potiSlots[ADC_POTI_COUNT] = { 0, 1, 2, 3 };
+
+  for (int i = 0; i < ADC_POTI_COUNT; i++) {
+    ADC_PotiBuffer[i] = 0;
+  }
+
+  // After a software or watchdog reset the retained factors replace the calibration
+  if (!WarmBoot_CalibrateAdc(&hadc1, WARMBOOT_ITEM_ADC1)) {
+    return 0;
+  }
+  if (!ADC_Configure(potiSlots, ADC_POTI_COUNT, 16, ADC_SCAN_HZ, ADC_PotiBuffer, ADC_POTI_COUNT)) {
+    return 0;
+  }
+  // The buffer is only polled, so the per-scan half/full transfer interrupts are not needed
+  __HAL_DMA_DISABLE_IT(&hdma_adc1, DMA_IT_HT | DMA_IT_TC);
+
+  ADC_Acquiring = 0;
+  return 1;
+}
+
+/**
+  * @brief  Schaltet ADC1 in den Messbetrieb mit Ping-Pong-Puffer
+  *
+  * Jede fertige Hälfte von ADC_AcqBuffer geht als ADC_Block ohne Kopie an alle Empfänger
+  * (ADC_AddBlockListener()). Die Potiwerte (Poti1Value usw.) kommen in dieser Zeit aus dem
+  * jeweils letzten Scan jedes Blocks; abgeschaltete Kanäle behalten ihren letzten Wert.
+  * @retval 1 bei Erfolg, 0 bei ungültiger Konfiguration oder einem Fehler der HAL
+  */
+uint8_t ADC_StartAcquisition(const ADC_AcqConfig *config) {
+  uint32_t current[ADC_POTI_COUNT] = { 0 };
+  uint32_t slots = 0;
+
+  for (int i = 0; i < ADC_POTI_COUNT; i++) {
+    slots += config->weight[i];
+  }
+  if (slots == 0 || slots > ADC_ACQ_MAX_SLOTS || config->scanHz == 0
+      || config->scanHz > ADC_TRIGGER_COUNTER_HZ / 2) {
+    return 0;
+  }
+  if (config->oversampling == 0 || config->oversampling > 1024
+      || (config->oversampling & (config->oversampling - 1)) != 0) {
+    return 0;
+  }
+  if (slots * config->oversampling > ADC_ACQ_MAX_CONVERSIONS_HZ / config->scanHz) {
+    return 0;
+  }
+
+  // Spread each channel's slots evenly over the scan (smooth weighted round robin)
+  for (uint32_t slot = 0; slot < slots; slot++) {
+    int best = 0;
+    for (int i = 0; i < ADC_POTI_COUNT; i++) {
+      current[i] += config->weight[i];
+      if (current[i] > current[best]) {
+        best = i;
+      }
+    }
+    current[best] -= slots;
+    ADC_AcqSlotChannel[slot] = best;
+  }
+
+  ADC_AcqActive = *config;
+  ADC_AcqSlots = slots;
+  ADC_AcqScans = ADC_ACQ_HALF_SAMPLES / slots;
+  ADC_BlockHolds[0] = 0;
+  ADC_BlockHolds[1] = 0;
+  ADC_BlockSequence = 0;
+  ADC_Stats = (ADC_AcqStats){ 0 };
+
+  for (uint8_t half = 0; half < 2; half++) {
+    ADC_Blocks[half].data = &ADC_AcqBuffer[half * ADC_AcqScans * slots];
+    ADC_Blocks[half].scans = ADC_AcqScans;
+    ADC_Blocks[half].slots = slots;
+    ADC_Blocks[half].slotChannel = ADC_AcqSlotChannel;
+    ADC_Blocks[half].half = half;
+  }
+
+  ADC_Acquiring = 1;
+  if (!ADC_Configure(ADC_AcqSlotChannel, slots, config->oversampling, config->scanHz,
+      ADC_AcqBuffer, 2UL * ADC_AcqScans * slots)) {
+    ADC_Acquiring = 0;
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+  * @brief  Beendet den Messbetrieb und kehrt zur Hintergrundabtastung der Potis zurück
+  */
+uint8_t ADC_StopAcquisition(void) {
+  static const uint8_t potiSlots[ADC_POTI_COUNT] = { 0, 1, 2, 3 };
+
+  ADC_Acquiring = 0;
+  if (!ADC_Configure(potiSlots, ADC_POTI_COUNT, 16, ADC_SCAN_HZ, ADC_PotiBuffer, ADC_POTI_COUNT)) {
+    return 0;
+  }
+  __HAL_DMA_DISABLE_IT(&hdma_adc1, DMA_IT_HT | DMA_IT_TC);
+
+  return 1;
+}
+
+/**
+  * @brief  Gibt an, ob der Messbetrieb läuft
+  */
+uint8_t ADC_IsAcquiring(void) {
+  return ADC_Acquiring;
+}
+
+/**
+  * @brief  Abtastrate eines Potis im Messbetrieb in Hz (0 = abgeschaltet oder Potibetrieb)
+  */
+uint32_t ADC_GetChannelRate(uint8_t channel) {
+  if (!ADC_Acquiring || channel >= ADC_POTI_COUNT) {
+    return 0;
+  }
+  return ADC_AcqActive.scanHz * ADC_AcqActive.weight[channel];
+}
+
+/**
+  * @brief  Meldet einen Empfänger für Messblöcke an
+  * @retval 1 bei Erfolg, 0 wenn alle ADC_ACQ_MAX_LISTENERS Plätze belegt sind
+  */
+uint8_t ADC_AddBlockListener(ADC_BlockCallback callback, void *context) {
+  if (ADC_ListenerCount >= ADC_ACQ_MAX_LISTENERS) {
+    return 0;
+  }
+
+  ADC_Listeners[ADC_ListenerCount].callback = callback;
+  ADC_Listeners[ADC_ListenerCount].context = context;
+  ADC_ListenerCount++;
+  return 1;
+}
+
+/**
+  * @brief  Gibt einen Block frei, den ein Empfänger mit Rückgabewert 1 behalten hat
+  */
+void ADC_ReleaseBlock(const ADC_Block *block) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (ADC_BlockHolds[block->half] > 0) {
+    ADC_BlockHolds[block->half]--;
+  }
+
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Zähler des Messbetriebs
+  */
+const ADC_AcqStats* ADC_GetAcqStats(void) {
+  return &ADC_Stats;
+}
+
+/**
+  * @brief  Aus HAL_ADC_ConvHalfCpltCallback() aufrufen: erste Hälfte fertig
+  */
+void ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc) {
+  if (hadc == &hadc1 && ADC_Acquiring) {
+    ADC_BlockDone(0);
+  }
+}
+
+/**
+  * @brief  Aus HAL_ADC_ConvCpltCallback() aufrufen: zweite Hälfte fertig
+  */
+void ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc) {
+  if (hadc == &hadc1 && ADC_Acquiring) {
+    ADC_BlockDone(1);
+  }
+}
+
+/**
+  * @brief  Aus HAL_ADC_ErrorCallback() aufrufen
+  */
+void ADC_ErrorCallback(ADC_HandleTypeDef *hadc) {
+  if (hadc == &hadc1) {
+    ADC_Stats.errors++;
+  }
+}
+
+/**
+  * @brief  Übernimmt bewegte Potis nach Poti1Value-Poti4Value, blockiert nicht
+  *
+  * Ein Wert wird erst übernommen, wenn er um mehr als ADC_POTI_HYSTERESIS vom zuletzt
+  * gemeldeten abweicht; in der Nähe der Anschläge rastet er auf 0 bzw. 65535 ein, damit
+  * der volle Bereich erreichbar bleibt. Aufrufer werten nur aus, wenn ein Bit gesetzt ist.
+  * @retval Bitmaske der geänderten Potis (Bit 0 = VR1), 0 = nichts bewegt
+  */
+uint8_t UpdatePotiValues(void) {
+  static uint16_t *const values[ADC_POTI_COUNT] = { &Poti1Value, &Poti2Value, &Poti3Value, &Poti4Value };
+  uint8_t changed = 0;
+
+  for (int i = 0; i < ADC_POTI_COUNT; i++) {
+    int32_t raw = ADC_PotiBuffer[i];
+
+    if (raw <= ADC_POTI_HYSTERESIS) {
+      raw = 0;
+    }
+    else if (raw >= 0xFFFF - ADC_POTI_HYSTERESIS) {
+      raw = 0xFFFF;
+    }
+
+    int32_t diff = raw - *values[i];
+    if (diff == 0) {
+      continue;
+    }
+    if (diff > ADC_POTI_HYSTERESIS || diff < -ADC_POTI_HYSTERESIS || raw == 0 || raw == 0xFFFF) {
+      *values[i] = raw;
+      changed |= 1 << i;
     }
   }
+
+  return changed;
+}
+
+/**
+  * @brief  Veröffentlicht bewegte Potis als TOPIC_POTI, aus dem TIM7-Tick alle ADC_POTI_PUBLISH_MS
+  *
+  * Einziger Aufrufer von UpdatePotiValues() und damit einziger Erzeuger des Topics.
+  * Poti1Value-Poti4Value bleiben für bestehende Leser gültig.
+  */
+RAMFUNC void ADC_PublishPoti(void) {
+  uint8_t changed = UpdatePotiValues();
+
+  if (!changed) {
+    return;
+  }
+
+  Topic_Poti *poti = Topic_BeginPublish(TOPIC_POTI);
+  poti->value[0] = Poti1Value;
+  poti->value[1] = Poti2Value;
+  poti->value[2] = Poti3Value;
+  poti->value[3] = Poti4Value;
+  poti->changed = changed;
+  Topic_EndPublish(TOPIC_POTI);
 }
 
 uint16_t GetPoti1Reading(){
-  UpdatePotiValues();
-  return Poti1Value;
+  return ADC_PotiBuffer[0];
 }
 uint16_t GetPoti2Reading(){
-  UpdatePotiValues();
-  return Poti2Value;
+  return ADC_PotiBuffer[1];
 }
 uint16_t GetPoti3Reading(){
-  UpdatePotiValues();
-  return Poti3Value;
+  return ADC_PotiBuffer[2];
 }
 uint16_t GetPoti4Reading(){
-  UpdatePotiValues();
-  return Poti4Value;
+  return ADC_PotiBuffer[3];
+}
+
+/**
+  * @brief  Stellt Sequenz, Überabtastung und Triggerrate ein und startet ADC1 mit zirkulärer DMA
+  */
+static uint8_t ADC_Configure(const uint8_t *slotChannel, uint8_t slots, uint16_t oversampling,
+    uint32_t scanHz, volatile uint16_t *buffer, uint32_t length) {
+  ADC_ChannelConfTypeDef sConfig = {0};
+  uint32_t shift = 0;
+
+  HAL_TIM_Base_Stop(&htim3);
+  HAL_ADC_Stop_DMA(&hadc1);
+
+  while ((1UL << shift) < oversampling) {
+    shift++;
+  }
+
+  hadc1.Init.NbrOfConversion = slots;
+  hadc1.Init.OversamplingMode = oversampling > 1 ? ENABLE : DISABLE;
+  hadc1.Init.Oversampling.Ratio = oversampling;
+  hadc1.Init.Oversampling.RightBitShift = shift << ADC_CFGR2_OVSS_Pos;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK) {
+    return 0;
+  }
+
+  sConfig.SamplingTime = ADC_SAMPLETIME_8CYCLES_5;
+  sConfig.SingleDiff = ADC_SINGLE_ENDED;
+  sConfig.OffsetNumber = ADC_OFFSET_NONE;
+  for (uint8_t slot = 0; slot < slots; slot++) {
+    sConfig.Channel = ADC_PotiChannels[slotChannel[slot]];
+    sConfig.Rank = ADC_Ranks[slot];
+    if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK) {
+      return 0;
+    }
+  }
+
+  if (HAL_ADC_Start_DMA(&hadc1, (uint32_t*)buffer, length) != HAL_OK) {
+    return 0;
+  }
+
+  __HAL_TIM_SET_COUNTER(&htim3, 0);
+  __HAL_TIM_SET_AUTORELOAD(&htim3, ADC_TRIGGER_COUNTER_HZ / scanHz - 1);
+  return HAL_TIM_Base_Start(&htim3) == HAL_OK;
+}
+
+/**
+  * @brief  Verteilt eine fertige Hälfte an die Empfänger, im DMA-Interrupt
+  */
+static void ADC_BlockDone(uint8_t half) {
+  ADC_Block *block = &ADC_Blocks[half];
+
+  // The DMA is now refilling the other half; whoever still reads it sees torn data
+  if (ADC_BlockHolds[half ^ 1] > 0) {
+    ADC_Stats.overruns++;
+  }
+
+  // Last scan of the block keeps the pot readings current
+  const uint16_t *last = &block->data[(block->scans - 1) * block->slots];
+  for (uint8_t slot = 0; slot < block->slots; slot++) {
+    ADC_PotiBuffer[ADC_AcqSlotChannel[slot]] = last[slot];
+  }
+
+  block->sequence = ADC_BlockSequence++;
+
+  // Still held from the previous round: the consumers are a full block behind
+  if (ADC_BlockHolds[half] > 0) {
+    ADC_Stats.drops++;
+    return;
+  }
+
+  for (uint8_t i = 0; i < ADC_ListenerCount; i++) {
+    if (ADC_Listeners[i].callback(block, ADC_Listeners[i].context)) {
+      ADC_BlockHolds[half]++;
+    }
+  }
+
+  ADC_Stats.blocks++;
 }
 /* USER CODE END 1 */
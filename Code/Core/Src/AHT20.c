@@ -9,80 +9,407 @@
 /// DATENBLATT AHT20
 /// https://files.seeedstudio.com/wiki/Grove-AHT20_I2C_Industrial_Grade_Temperature_and_Humidity_Sensor/AHT20-datasheet-2020-4-16.pdf
 ///
+/// Die Messung läuft als Coroutine (Async.h) ohne Warteschleifen: AHT20_StartMeasurement()
+/// startet AHT20_Measure(), das der Reihe nach beim ersten Mal die Kalibrierung prüft, den
+/// Messbefehl sendet, die 80 ms Messdauer abwartet und Status, Messwerte und CRC (7 Bytes)
+/// liest. Alle I2C-Transfers laufen per Interrupt, ihr Callback weckt den AHT20-Task
+/// (Async_Notify), die Wartezeiten legen seine nächste Freigabe (AWAIT_MS). AHT20_Service()
+/// setzt die Coroutine fort und bricht nach einem Fehler oder AHT20_TIMEOUT_MS ab. Der
+/// Kalibrierungsstatus wird nach der ersten Prüfung gehalten und erst nach einem Fehler erneut
+/// gelesen. AHT20_CurrentState zeigt weiterhin, in welchem Schritt die Messung steht.
+///
+/// Die Umrechnung der Rohwerte läuft ganzzahlig (AHT20_RawToCentiCelsius/-Percent, nur Multiplikation
+/// und Schieben) in Hundertstel °C bzw. % rF. Darauf sitzt ein Median über AHT20_MEDIAN_SIZE
+/// Messungen gegen einzelne Ausreißer und ein EMA zum Glätten; Callback und Anzeige bekommen
+/// die gefilterten Werte, TOPIC_CLIMATE beide.
+///
+/// Die Transfers laufen über die Warteschlange von I2CBus_2. Jede Transaktion bekommt eine
+/// laufende Nummer als Kontext; meldet sich eine nach einem Timeout noch zurück, wird sie ignoriert.
+///
 
 #include "AHT20.h"
+#include "I2CBus.h"
+#include "BusStat.h"
+#include "Topic.h"
+#include "Async.h"
 
-extern I2C_HandleTypeDef hi2c2;
+#if I2CBUS_2_HZ > AHT20_I2C_MAX_HZ
+#error "I2CBUS_2_HZ ist zu hoch für den AHT20"
+#endif
 
 /*
  * Adresse vom AHT20 Sensor ist 0x38. Aber da bei I2C das Addressenbyte immer [7:1] Addresse ;
  * [0] R/W (Lesen oder Schreiben Bit) wird die Adresse um 1
  * */
 #define AHT_ADDR	0x38<<1
-#define HI2C      hi2c2
+#define AHT20_BUS   I2CBus_2
+
+#define AHT20_STATUS_BUSY        (1 << 7)
+#define AHT20_STATUS_CALIBRATED  (1 << 3)
+
+AHT20_State AHT20_CurrentState = AHT20_STATE_IDLE;
+uint8_t AHT20_Calibrated = 0;
+uint8_t AHT20_Buffer[7];
+volatile uint8_t AHT20_TransferDone = 0;
+volatile uint8_t AHT20_TransferError = 0;
+uint32_t AHT20_Sequence = 0;
+uint32_t AHT20_StartTick = 0;
+
+uint8_t AHT20_Valid = 0;
+int16_t AHT20_CentiCelsius = 0;          // letzte Messung, ungefiltert
+uint16_t AHT20_CentiPercent = 0;
+
+// Filter: last AHT20_MEDIAN_SIZE readings (oldest overwritten), EMA accumulators << AHT20_EMA_SHIFT
+int16_t AHT20_HistoryCelsius[AHT20_MEDIAN_SIZE];
+uint16_t AHT20_HistoryPercent[AHT20_MEDIAN_SIZE];
+uint8_t AHT20_HistoryCount = 0;
+uint8_t AHT20_HistoryNext = 0;
+int32_t AHT20_EmaCelsius = 0;
+int32_t AHT20_EmaPercent = 0;
+uint32_t AHT20_Errors = 0;
+AHT20_Callback AHT20_NewValueCallback = NULL;
+
+static Async_Result AHT20_Measure(Async *self);
+static Async AHT20_Async = ASYNC_INITIALIZER("AHT20", AHT20_Measure, NULL);
+
+/* Fehler im Ablauf: Messung beenden; auf einen Transfer warten und bei Fehler aufhören */
+#define AHT20_FAIL(self)           do { AHT20_Fail(); ASYNC_EXIT(self); } while (0)
+#define AHT20_AWAIT_TRANSFER(self) \
+    do { \
+        AWAIT_DMA(self, !AHT20_TransferDone && !AHT20_TransferError); \
+        if (AHT20_TransferError) AHT20_FAIL(self); \
+    } while (0)
+
+static uint8_t AHT20_Transmit(uint8_t b0, uint8_t b1, uint8_t b2);
+static uint8_t AHT20_Receive(uint16_t size);
+static void AHT20_TransferCallback(uint8_t ok, void *context);
+static void AHT20_Fail(void);
+static void AHT20_Publish(void);
+static uint8_t AHT20_CRC8(const uint8_t *data, uint8_t length);
+static int32_t AHT20_Median(int32_t *values, uint8_t count);
+static void AHT20_Filter(void);
 
 
 /**
- * @brief Liest Temperatur und Luftfeuchtigkeit vom AHT20 Sensor über I2C.
+ * @brief Startet eine Messung, ohne zu blockieren.
  *
- * Diese Funktion kommuniziert mit dem AHT20 Sensor, um die aktuellen
- * Temperatur- und Feuchtigkeitswerte zu lesen. Sie prüft den Kalibrierungsstatus,
- * startet eine Messung und verarbeitet die Rohdaten, um die physikalischen Werte
- * zu berechnen.
+ * Beim ersten Aufruf (oder nach einem Fehler) wird zuerst das Statusbyte gelesen und
+ * ggf. die Kalibrierung ausgelöst. Das Ergebnis liefert AHT20_Service().
  *
- * @param[out] Temp   Pointer zur Speicherung der Temperatur (in °C).
- * @param[out] Humid  Pointer zur Speicherung der Luftfeuchtigkeit (in % rF).
+ * @retval 1, wenn die Messung gestartet wurde, 0 wenn noch eine läuft oder die Warteschlange voll ist
+ */
+uint8_t AHT20_StartMeasurement(void)
+{
+    if (!Async_Start(&AHT20_Async))
+        return 0;
+
+    AHT20_StartTick = HAL_GetTick();
+
+    // Queue the first transfer right away, a full bus queue ends the measurement here
+    Async_Run(&AHT20_Async);
+    return Async_IsRunning(&AHT20_Async);
+}
+
+/**
+ * @brief Bindet die Messung an den Task, der AHT20_Service() aufruft
+ *
+ * Transfers und Wartezeiten geben ihn dann gezielt frei; seine Periode (ASYNC_POLL_MS) bleibt
+ * für den Timeout. Ohne Aufruf funktioniert alles mit regelmäßigem AHT20_Service().
+ *
+ * @param taskId mit Scheduler_AddTask() registrierter Task
+ */
+void AHT20_Init(uint8_t taskId)
+{
+    Async_Setup(&AHT20_Async, "AHT20", AHT20_Measure, NULL, taskId);
+}
+
+/**
+ * @brief Treibt die laufende Messung voran, aus dem AHT20-Task bzw. regelmäßig aus dem Hauptprogramm.
+ *
+ * Kehrt sofort zurück, solange kein Transfer fertig und keine Wartezeit abgelaufen ist.
+ * Callbacks (AHT20_SetCallback) laufen von hier aus, also nicht im Interrupt.
+ */
+void AHT20_Service(void)
+{
+    if (!Async_IsRunning(&AHT20_Async))
+        return;
+
+    if (AHT20_TransferError || HAL_GetTick() - AHT20_StartTick > AHT20_TIMEOUT_MS) {
+        AHT20_Fail();
+        Async_Abort(&AHT20_Async);
+        return;
+    }
+
+    Async_Run(&AHT20_Async);
+}
+
+/**
+ * @brief Gibt an, ob gerade eine Messung läuft
+ */
+uint8_t AHT20_IsBusy(void)
+{
+    return Async_IsRunning(&AHT20_Async);
+}
+
+/**
+ * @brief Liefert den zuletzt veröffentlichten Messwert (ungefiltert, für bestehende Aufrufer).
+ *
+ * @param[out] Temp   Temperatur in °C
+ * @param[out] Humid  Luftfeuchtigkeit in % rF
+ * @retval 1, wenn schon eine Messung erfolgreich war
+ */
+uint8_t AHT20_GetLatest(float* Temp, float* Humid)
+{
+    *Temp = AHT20_CentiCelsius / 100.0f;
+    *Humid = AHT20_CentiPercent / 100.0f;
+    return AHT20_Valid;
+}
+
+/**
+ * @brief Liefert den zuletzt veröffentlichten Messwert ungefiltert in Hundertsteln.
+ *
+ * @param[out] centiCelsius  Temperatur in 0,01 °C
+ * @param[out] centiPercent  Luftfeuchtigkeit in 0,01 % rF
+ * @retval 1, wenn schon eine Messung erfolgreich war
+ */
+uint8_t AHT20_GetLatestCenti(int16_t *centiCelsius, uint16_t *centiPercent)
+{
+    *centiCelsius = AHT20_CentiCelsius;
+    *centiPercent = AHT20_CentiPercent;
+    return AHT20_Valid;
+}
+
+/**
+ * @brief Liefert den gefilterten Messwert (Median, dann EMA) in Hundertsteln.
+ *
+ * @param[out] centiCelsius  Temperatur in 0,01 °C
+ * @param[out] centiPercent  Luftfeuchtigkeit in 0,01 % rF
+ * @retval 1, wenn schon eine Messung erfolgreich war
+ */
+uint8_t AHT20_GetFiltered(int16_t *centiCelsius, uint16_t *centiPercent)
+{
+    // Round to nearest; the shift of a negative accumulator rounds down like the positive one
+    *centiCelsius = (int16_t)((AHT20_EmaCelsius + (1 << (AHT20_EMA_SHIFT - 1))) >> AHT20_EMA_SHIFT);
+    *centiPercent = (uint16_t)((AHT20_EmaPercent + (1 << (AHT20_EMA_SHIFT - 1))) >> AHT20_EMA_SHIFT);
+    return AHT20_Valid;
+}
+
+/**
+ * @brief Setzt die Funktion, die bei jedem neuen Messwert aufgerufen wird (NULL = keine)
+ */
+void AHT20_SetCallback(AHT20_Callback callback)
+{
+    AHT20_NewValueCallback = callback;
+}
+
+/**
+ * @brief Reiht einen 3-Byte-Befehl auf dem Bus ein
  */
-void AHT20_Read(float* Temp, float* Humid)
+static uint8_t AHT20_Transmit(uint8_t b0, uint8_t b1, uint8_t b2)
 {
-    uint8_t dum[6]; // Puffer für I2C-Daten
+    AHT20_Buffer[0] = b0, AHT20_Buffer[1] = b1, AHT20_Buffer[2] = b2;
+    AHT20_TransferDone = 0;
+    AHT20_TransferError = 0;
+    AHT20_Sequence++;
+    if (!I2CBus_Write(&AHT20_BUS, AHT_ADDR, AHT20_Buffer, 3, AHT20_TransferCallback, (void *)(uintptr_t)AHT20_Sequence))
+        return 0;
+    BUSSTAT_ASYNC(BUSSTAT_ID_AHT20, BUSSTAT_COMMAND, 3);
+    return 1;
+}
+
+/**
+ * @brief Reiht das Lesen von size Bytes (Status zuerst) nach AHT20_Buffer ein
+ */
+static uint8_t AHT20_Receive(uint16_t size)
+{
+    AHT20_TransferDone = 0;
+    AHT20_TransferError = 0;
+    AHT20_Sequence++;
+    if (!I2CBus_Read(&AHT20_BUS, AHT_ADDR, AHT20_Buffer, size, AHT20_TransferCallback, (void *)(uintptr_t)AHT20_Sequence))
+        return 0;
+    BUSSTAT_ASYNC(BUSSTAT_ID_AHT20, BUSSTAT_DATA, size);
+    return 1;
+}
+
+/**
+ * @brief Abschluss eines Transfers (Interrupt), veraltete Transfers werden ignoriert
+ */
+static void AHT20_TransferCallback(uint8_t ok, void *context)
+{
+    if ((uintptr_t)context != AHT20_Sequence)
+        return;
+
+    if (ok)
+        AHT20_TransferDone = 1;
+    else
+        AHT20_TransferError = 1;
+    Async_Notify(&AHT20_Async);
+}
+
+/**
+ * @brief Ablauf einer Messung: Kalibrierung prüfen, Messbefehl 0xAC 0x33 0x00, warten, lesen
+ */
+static Async_Result AHT20_Measure(Async *self)
+{
+    ASYNC_BEGIN(self);
 
-    // 1. Statusregister auslesen (Adresse 0x71), um Kalibrierungsstatus zu prüfen
-    HAL_I2C_Mem_Read(&HI2C, AHT_ADDR, 0x71, 1, dum, 1, 100);
+    if (!AHT20_Calibrated) {
+        AHT20_CurrentState = AHT20_STATE_STATUS;
+        if (!AHT20_Receive(1)) AHT20_FAIL(self);
+        AHT20_AWAIT_TRANSFER(self);
 
-    // 2. Kalibrierung durchführen, falls notwendig (Bit 3 = 0)
-    if (!(dum[0] & (1 << 3)))
-    {
-        // Initialisierungsbefehl 0xBE mit Parametern 0x08 0x00 senden
-        dum[0] = 0xBE, dum[1] = 0x08, dum[2] = 0x00;
-        HAL_I2C_Master_Transmit(&HI2C, AHT_ADDR, dum, 3, 100);
-        HAL_Delay(10); // Wartezeit für Kalibrierung
+        // Kalibrierung durchführen, falls notwendig (Bit 3 = 0)
+        if (!(AHT20_Buffer[0] & AHT20_STATUS_CALIBRATED)) {
+            AHT20_CurrentState = AHT20_STATE_CALIBRATE;
+            if (!AHT20_Transmit(0xBE, 0x08, 0x00)) AHT20_FAIL(self);
+            AHT20_AWAIT_TRANSFER(self);
+
+            AHT20_CurrentState = AHT20_STATE_CALIBRATE_WAIT;
+            AWAIT_MS(self, AHT20_CALIBRATION_MS);
+        }
+        AHT20_Calibrated = 1;
+    }
+
+    AHT20_CurrentState = AHT20_STATE_TRIGGER;
+    if (!AHT20_Transmit(0xAC, 0x33, 0x00)) AHT20_FAIL(self);
+    AHT20_AWAIT_TRANSFER(self);
+
+    AHT20_CurrentState = AHT20_STATE_MEASURE_WAIT;
+    AWAIT_MS(self, AHT20_MEASUREMENT_MS);
+
+    for (;;) {
+        AHT20_CurrentState = AHT20_STATE_READ;
+        if (!AHT20_Receive(sizeof(AHT20_Buffer))) AHT20_FAIL(self);
+        AHT20_AWAIT_TRANSFER(self);
+
+        // Messung noch nicht fertig (Bit 7 im Status = 1): später erneut lesen
+        if (!(AHT20_Buffer[0] & AHT20_STATUS_BUSY))
+            break;
+        AHT20_CurrentState = AHT20_STATE_MEASURE_WAIT;
+        AWAIT_MS(self, AHT20_RETRY_MS);
     }
 
-    // 3. Messung starten (Command 0xAC mit Parametern 0x33 0x00)
-    dum[0] = 0xAC, dum[1] = 0x33, dum[2] = 0x00;
-    HAL_I2C_Master_Transmit(&HI2C, AHT_ADDR, dum, 3, 100);
-    HAL_Delay(80); // Typische Messdauer laut Datenblatt
+    if (AHT20_CRC8(AHT20_Buffer, 6) != AHT20_Buffer[6])
+        AHT20_FAIL(self);
 
-    // 4. Warten, bis Messung fertig (Bit 7 im Statusregister = 0)
-    do {
-        HAL_I2C_Mem_Read(&HI2C, AHT_ADDR, 0x71, 1, dum, 1, 100);
-        HAL_Delay(1); // Kurze Wartezeit zwischen den Abfragen
-    } while (dum[0] & (1 << 7)); // Wiederhole, solange Busy-Flag gesetzt
+    AHT20_CurrentState = AHT20_STATE_IDLE;
+    AHT20_Publish();
 
-    // 5. Messdaten (6 Bytes) auslesen
-    HAL_I2C_Master_Receive(&HI2C, AHT_ADDR, dum, 6, 100);
+    ASYNC_END(self);
+}
 
+/**
+ * @brief Bricht die Messung ab; die Kalibrierung wird beim nächsten Start neu geprüft
+ */
+static void AHT20_Fail(void)
+{
+    // A transfer that is still queued reports back with an old sequence number
+    AHT20_Sequence++;
+    AHT20_Errors++;
+    AHT20_Calibrated = 0;
+    AHT20_CurrentState = AHT20_STATE_IDLE;
+}
+
+/**
+ * @brief Rechnet die Rohdaten um, filtert und meldet den neuen Wert (TOPIC_CLIMATE und Callback)
+ */
+static void AHT20_Publish(void)
+{
     /*
-     * 6. Rohdaten zusammensetzen:
+     * Rohdaten zusammensetzen:
      * - Temperatur und Feuchtigkeit sind jeweils 20-Bit Werte
      * - Die Daten sind über mehrere Bytes verteilt
      */
     // Feuchtigkeitswert (20 Bit) aus Bytes 1-3 zusammensetzen
-    uint32_t h20 = (dum[1]) << 12 | (dum[2]) << 4 | (dum[3] >> 4);
+    uint32_t h20 = (AHT20_Buffer[1]) << 12 | (AHT20_Buffer[2]) << 4 | (AHT20_Buffer[3] >> 4);
 
     // Temperaturwert (20 Bit) aus Bytes 3-5 zusammensetzen
-    uint32_t t20 = (dum[3] & 0x0F) << 16 | (dum[4]) << 8 | dum[5];
+    uint32_t t20 = (AHT20_Buffer[3] & 0x0F) << 16 | (AHT20_Buffer[4]) << 8 | AHT20_Buffer[5];
 
-    /*
-     * 7. Rohwerte in physikalische Größen umrechnen
-     * (Formeln laut AHT20 Datenblatt)
-     */
-    // Temperaturberechnung:
-    // - 20-Bit Wert (0-1048575) -> 0...200 -> -50...+150°C
-    *Temp = (t20 / 1048576.0) * 200.0 - 50.0;
+    // Rohwerte in Hundertstel umrechnen (Formeln laut AHT20 Datenblatt, siehe AHT20.h)
+    AHT20_CentiCelsius = AHT20_RawToCentiCelsius(t20);
+    AHT20_CentiPercent = AHT20_RawToCentiPercent(h20);
+    AHT20_Filter();
+    AHT20_Valid = 1;
+
+    int16_t centiCelsius;
+    uint16_t centiPercent;
+    AHT20_GetFiltered(&centiCelsius, &centiPercent);
+
+    Topic_Climate *climate = Topic_BeginPublish(TOPIC_CLIMATE);
+    climate->temperature = AHT20_CentiCelsius;
+    climate->humidity = AHT20_CentiPercent;
+    climate->temperatureFiltered = centiCelsius;
+    climate->humidityFiltered = centiPercent;
+    Topic_EndPublish(TOPIC_CLIMATE);
+
+    if (AHT20_NewValueCallback != NULL)
+        AHT20_NewValueCallback(centiCelsius, centiPercent);
+}
+
+/**
+ * @brief Median der letzten Messungen, dann ein Schritt des EMA
+ *
+ * Die erste Messung (nach dem Start) setzt den EMA direkt, sonst liefe er von 0 °C her ein.
+ */
+static void AHT20_Filter(void)
+{
+    int32_t celsius[AHT20_MEDIAN_SIZE];
+    int32_t percent[AHT20_MEDIAN_SIZE];
+
+    AHT20_HistoryCelsius[AHT20_HistoryNext] = AHT20_CentiCelsius;
+    AHT20_HistoryPercent[AHT20_HistoryNext] = AHT20_CentiPercent;
+    AHT20_HistoryNext = (AHT20_HistoryNext + 1) % AHT20_MEDIAN_SIZE;
+    if (AHT20_HistoryCount < AHT20_MEDIAN_SIZE)
+        AHT20_HistoryCount++;
+
+    for (uint8_t i = 0; i < AHT20_HistoryCount; i++) {
+        celsius[i] = AHT20_HistoryCelsius[i];
+        percent[i] = AHT20_HistoryPercent[i];
+    }
+    int32_t medianCelsius = AHT20_Median(celsius, AHT20_HistoryCount);
+    int32_t medianPercent = AHT20_Median(percent, AHT20_HistoryCount);
+
+    if (AHT20_HistoryCount == 1) {
+        AHT20_EmaCelsius = medianCelsius * (1 << AHT20_EMA_SHIFT);
+        AHT20_EmaPercent = medianPercent * (1 << AHT20_EMA_SHIFT);
+    }
+    else {
+        AHT20_EmaCelsius += medianCelsius - (AHT20_EmaCelsius >> AHT20_EMA_SHIFT);
+        AHT20_EmaPercent += medianPercent - (AHT20_EmaPercent >> AHT20_EMA_SHIFT);
+    }
+}
+
+/**
+ * @brief Median von count Werten (sortiert die Kopie in values, count <= 7)
+ */
+static int32_t AHT20_Median(int32_t *values, uint8_t count)
+{
+    for (uint8_t i = 1; i < count; i++) {
+        int32_t v = values[i];
+        int8_t j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+    // Even count while filling up: the lower of the two middle values
+    return values[(count - 1) / 2];
+}
+
+/**
+ * @brief CRC-8 laut Datenblatt: Polynom 0x31 (x^8 + x^5 + x^4 + 1), Startwert 0xFF
+ */
+static uint8_t AHT20_CRC8(const uint8_t *data, uint8_t length)
+{
+    uint8_t crc = 0xFF;
+
+    for (uint8_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
 
-    // Feuchtigkeitsberechnung:
-    // - 20-Bit Wert (0-1048575) -> 0...100%
-    *Humid = h20 / 10485.76; // 1048576/100 = 10485.76
+    return crc;
 }
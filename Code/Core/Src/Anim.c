@@ -0,0 +1,463 @@
+/**
+ * @file    Anim.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Wiedergabe kurzer RGB565-Animationen von der SD-Karte oder aus dem Asset-Bundle
+ *
+ * Tools/anim_pack.py packt eine Bildfolge am PC zu einem Container:
+ *
+ *   [Anim_Header][Daten der Bilder][Anim_Frame x frameCount]
+ *
+ * Jeder Tabelleneintrag nennt den Bereich, der sich gegenüber dem Vorgänger geändert hat, und
+ * dessen Pixel als rohes RGB565 oder als komprimiertes Bild (ILI9341_Image.c, RLE oder LZ4).
+ * Unveränderte Bilder kosten keine Daten. Schlüsselbilder (ANIM_FRAME_KEY) decken die ganze
+ * Animation ab, das erste Bild ist immer eines.
+ *
+ * Von der SD-Karte laufen rohe Bereiche durch dieselbe Pipeline wie ILI9341_DrawBinaryFileRegion():
+ * Während der DMA ein Band aus einem ILI9341_FileBuffer zum Display schickt, liest FatFs das
+ * nächste in den anderen. Die Datei wird mit FastSeek_Open() geöffnet, der Sprung zu einem Bild
+ * kostet also keinen Gang durch die FAT-Kette, und die Bildtabelle wird in Fenstern von
+ * ANIM_TABLE_WINDOW Einträgen gelesen. Aus dem Memory-Mapped-Fenster des W25Qxx liest der DMA die
+ * Pixel direkt, ohne Kopie.
+ *
+ * Takt: Bild n ist um Start + n * frameUs fällig. Der Task legt mit Scheduler_ReleaseAfter() seine
+ * nächste Freigabe auf diesen Zeitpunkt, die Übertragung beginnt mit ILI9341_TE_Sync() an der
+ * nächsten TE-Flanke. Ist die Wiedergabe ein Bild oder mehr im Verzug, springt sie zum letzten
+ * fälligen Schlüsselbild; die übersprungenen Bilder zählen als verworfen. Ohne erreichbares
+ * Schlüsselbild muss jedes Änderungsbild gezeichnet werden, sonst stimmt das Bild nicht mehr;
+ * solche Bilder zählen als verspätet. Dazu die Dauer je Bild (Lesen bis Start des letzten DMA)
+ * und der Durchsatz: 'anim stat' zeigt, was die ganze Kette von der Karte bis zum SPI schafft.
+ *
+ * Jedes Bild wird in einem Durchlauf des Tasks vollständig übertragen, andere Tasks zeichnen
+ * also nie mitten in ein Bild. Die UI sollte den Bereich der Animation nicht mitbenutzen.
+ */
+
+#include "Anim.h"
+#include "Asset.h"
+#include "FastSeek.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_Image.h"
+#include "ILI9341_TE.h"
+#include "Scheduler.h"
+#include "SDCard.h"
+#include "Timebase.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Ping-Pong-Puffer für Bilder von der SD-Karte (ILI9341.c) */
+extern uint8_t ILI9341_FileBuffer[2][ILI9341_FILE_CHUNK_SIZE];
+
+#define ANIM_TABLE_NONE          0xFFFFFFFFUL
+
+static uint8_t Anim_TaskId = SCHEDULER_INVALID_TASK;
+static uint8_t Anim_Playing;
+static uint8_t Anim_Loop;
+static Anim_Header Anim_Info;
+static const uint8_t *Anim_Data;          // Quelle im Speicher, NULL: Anim_File
+static FIL Anim_File;
+static uint16_t Anim_X, Anim_Y;
+static uint32_t Anim_Next;                // nächstes zu zeichnendes Bild
+static uint32_t Anim_StartUs;             // Soll-Zeitpunkt von Bild 0 der laufenden Runde
+static Anim_Frame Anim_Table[ANIM_TABLE_WINDOW];
+static uint32_t Anim_TableFirst = ANIM_TABLE_NONE;
+static Anim_Stats Anim_Statistics;
+
+static uint8_t Anim_Begin(uint16_t x, uint16_t y, uint8_t loop, uint32_t available);
+static uint8_t Anim_GetFrame(uint32_t index, Anim_Frame *frame);
+static uint32_t Anim_FindKey(uint32_t due);
+static uint8_t Anim_DrawFrame(const Anim_Frame *frame);
+static uint8_t Anim_StreamFile(const Anim_Frame *frame, uint16_t x, uint16_t y);
+
+/**
+ * @brief  Merkt sich den Task, er bleibt bis zur ersten Wiedergabe aus
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der Anim_Task() aufruft
+ */
+void Anim_Init(uint8_t taskId) {
+	Anim_TaskId = taskId;
+	Scheduler_SetEnabled(taskId, 0);
+}
+
+/**
+ * @brief  Startet eine Animation von der SD-Karte, eine laufende wird beendet
+ * @param  path Pfad zur Datei (Tools/anim_pack.py)
+ * @param  x, y Obere linke Ecke auf dem Display
+ * @param  loop 1 = endlos wiederholen, 0 = einmal
+ * @retval 1 wenn die Wiedergabe läuft, 0 ohne Karte, bei fehlender Datei oder falschem Kopf
+ */
+uint8_t Anim_PlayFile(const char *path, uint16_t x, uint16_t y, uint8_t loop) {
+	Anim_Stop();
+
+	if (SDCard_Acquire() == NULL) {
+		printf("Could not mount SDCard");
+		return 0;
+	}
+
+	FRESULT res = FastSeek_Open(&Anim_File, path);
+	if (res != FR_OK) {
+		printf("Failed to open file: %d\n", res);
+		SDCard_CheckResult(res);
+		SDCard_Release();
+		return 0;
+	}
+
+	UINT bytesRead = 0;
+	res = f_read(&Anim_File, &Anim_Info, sizeof(Anim_Info), &bytesRead);
+	Anim_Data = NULL;
+	if (res != FR_OK || bytesRead != sizeof(Anim_Info) || !Anim_Begin(x, y, loop, (uint32_t)f_size(&Anim_File))) {
+		SDCard_CheckResult(res);
+		FastSeek_Close(&Anim_File);
+		SDCard_Release();
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Startet eine Animation aus dem Speicher, z.B. aus dem Memory-Mapped-Fenster des W25Qxx
+ * @param  data Container, muss bis zum Ende der Wiedergabe lesbar bleiben
+ * @param  size Länge von data in Bytes
+ * @retval 1 wenn die Wiedergabe läuft, 0 bei falschem Kopf
+ */
+uint8_t Anim_PlayMemory(const uint8_t *data, uint32_t size, uint16_t x, uint16_t y, uint8_t loop) {
+	Anim_Stop();
+
+	if (data == NULL || size < sizeof(Anim_Info)) {
+		return 0;
+	}
+	memcpy(&Anim_Info, data, sizeof(Anim_Info));
+	Anim_Data = data;
+	if (!Anim_Begin(x, y, loop, size)) {
+		Anim_Data = NULL;
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Startet eine Animation aus dem Asset-Bundle (Typ anim in der Asset-Liste)
+ * @retval 1 wenn die Wiedergabe läuft, 0 wenn das Asset fehlt oder keine Animation ist
+ *
+ * @note   Bis zum Ende der Wiedergabe darf nicht auf den Flash geschrieben werden.
+ */
+uint8_t Anim_PlayAsset(const char *name, uint16_t x, uint16_t y, uint8_t loop) {
+	const Asset_Entry *entry;
+	const uint8_t *data = Asset_Find(name, &entry);
+
+	if (data == NULL || entry->type != ASSET_TYPE_ANIM) {
+		return 0;
+	}
+	return Anim_PlayMemory(data, entry->size, x, y, loop);
+}
+
+/**
+ * @brief  Beendet die Wiedergabe, das zuletzt gezeichnete Bild bleibt stehen
+ */
+void Anim_Stop(void) {
+	if (!Anim_Playing) {
+		return;
+	}
+
+	Anim_Playing = 0;
+	Scheduler_SetEnabled(Anim_TaskId, 0);
+	// The last band may still be read by the DMA, from the file buffers or the mapped window
+	ILI9341_WaitWhileBusy();
+	if (Anim_Data == NULL) {
+		FastSeek_Close(&Anim_File);
+		SDCard_Release();
+	}
+	Anim_Data = NULL;
+}
+
+/**
+ * @brief  Prüft, ob gerade eine Animation läuft
+ */
+uint8_t Anim_IsPlaying(void) {
+	return Anim_Playing;
+}
+
+/**
+ * @brief  Liefert die Zähler der laufenden bzw. letzten Wiedergabe
+ */
+const Anim_Stats* Anim_GetStats(void) {
+	return &Anim_Statistics;
+}
+
+/**
+ * @brief  Task: Zeichnet das fällige Bild und legt die nächste Freigabe auf das folgende
+ */
+void Anim_Task(void *context) {
+	if (!Anim_Playing) {
+		Scheduler_SetEnabled(Anim_TaskId, 0);
+		return;
+	}
+
+	uint32_t frameUs = Anim_Info.frameUs;
+	uint32_t now = Timebase_Us32();
+	int32_t ahead = (int32_t)(Anim_StartUs + Anim_Next * frameUs - now);
+	if (ahead > 0) {
+		// Released early by the fallback period
+		Scheduler_ReleaseAfter(Anim_TaskId, ((uint32_t)ahead + 999U) / 1000U);
+		return;
+	}
+
+	uint32_t due = (now - Anim_StartUs) / frameUs;
+	if (due >= Anim_Next + ANIM_RESYNC_FRAMES) {
+		// Too far behind to catch up, continue from here at the normal rate
+		Anim_StartUs = now - Anim_Next * frameUs;
+		due = Anim_Next;
+		Anim_Statistics.resyncs++;
+	}
+
+	uint32_t index = Anim_FindKey(due);
+	uint32_t lateUs = now - (Anim_StartUs + index * frameUs);
+	Anim_Statistics.dropped += index - Anim_Next;
+	if (lateUs > frameUs) {
+		Anim_Statistics.late++;
+	}
+	if (lateUs > Anim_Statistics.maxLateUs) {
+		Anim_Statistics.maxLateUs = lateUs;
+	}
+
+	Anim_Frame frame;
+	if (!Anim_GetFrame(index, &frame) || !Anim_DrawFrame(&frame)) {
+		printf("Animation stopped at frame %lu\n", (unsigned long)index);
+		Anim_Statistics.errors++;
+		Anim_Stop();
+		return;
+	}
+
+	uint32_t elapsedUs = Timebase_Us32() - now;
+	Anim_Statistics.frames++;
+	Anim_Statistics.bytes += frame.size;
+	Anim_Statistics.lastFrameUs = elapsedUs;
+	Anim_Statistics.sumFrameUs += elapsedUs;
+	if (elapsedUs > Anim_Statistics.maxFrameUs) {
+		Anim_Statistics.maxFrameUs = elapsedUs;
+	}
+
+	Anim_Next = index + 1;
+	if (Anim_Next >= Anim_Info.frameCount) {
+		if (!Anim_Loop) {
+			Anim_Stop();
+			return;
+		}
+		Anim_StartUs += Anim_Info.frameCount * frameUs;
+		Anim_Next = 0;
+		Anim_Statistics.loops++;
+	}
+
+	ahead = (int32_t)(Anim_StartUs + Anim_Next * frameUs - Timebase_Us32());
+	Scheduler_ReleaseAfter(Anim_TaskId, ahead > 0 ? ((uint32_t)ahead + 999U) / 1000U : 1);
+}
+
+/**
+ * @brief  Gibt Zustand und Zähler aus ('anim stat')
+ */
+void Anim_Dump(void) {
+	const Anim_Stats *s = &Anim_Statistics;
+
+	if (Anim_Playing) {
+		printf("Animation %ux%u bei %u,%u, %lu Bilder à %lu us, %s, Bild %lu\n", Anim_Info.width, Anim_Info.height,
+				Anim_X, Anim_Y, (unsigned long)Anim_Info.frameCount, (unsigned long)Anim_Info.frameUs,
+				Anim_Data != NULL ? "Flash" : "SD-Karte", (unsigned long)Anim_Next);
+	} else {
+		printf("Keine Animation aktiv, Zähler der letzten Wiedergabe:\n");
+	}
+	printf("%lu Bilder, %lu verworfen, %lu verspätet, %lu Runden, %lu Neustarts der Zeitrechnung, %lu Fehler\n",
+			(unsigned long)s->frames, (unsigned long)s->dropped, (unsigned long)s->late, (unsigned long)s->loops,
+			(unsigned long)s->resyncs, (unsigned long)s->errors);
+	printf("Je Bild %lu us (max %lu, Mittel %lu), Verzug max %lu us, %lu KB gelesen, %lu KB/s\n",
+			(unsigned long)s->lastFrameUs, (unsigned long)s->maxFrameUs,
+			(unsigned long)(s->frames ? s->sumFrameUs / s->frames : 0), (unsigned long)s->maxLateUs,
+			(unsigned long)(s->bytes / 1024U),
+			(unsigned long)(s->sumFrameUs ? s->bytes * 1000000ULL / 1024U / s->sumFrameUs : 0));
+}
+
+/**
+ * @brief  Prüft den Kopf in Anim_Info und startet die Wiedergabe
+ * @param  available: Länge der Quelle in Bytes
+ */
+static uint8_t Anim_Begin(uint16_t x, uint16_t y, uint8_t loop, uint32_t available) {
+	const Anim_Header *h = &Anim_Info;
+
+	if (h->magic != ANIM_MAGIC || h->version != ANIM_VERSION || h->width == 0 || h->height == 0
+	    || h->frameCount == 0 || h->frameUs < 1000U || h->size > available
+	    || h->tableOffset > h->size || h->frameCount > (h->size - h->tableOffset) / sizeof(Anim_Frame)
+	    || (uint32_t)x + h->width > ILI9341_WIDTH || (uint32_t)y + h->height > ILI9341_HEIGHT) {
+		printf("Invalid animation header\n");
+		return 0;
+	}
+
+	Anim_X = x;
+	Anim_Y = y;
+	Anim_Loop = loop;
+	Anim_Next = 0;
+	Anim_TableFirst = ANIM_TABLE_NONE;
+	Anim_Statistics = (Anim_Stats){0};
+	Anim_StartUs = Timebase_Us32();
+	Anim_Playing = 1;
+	Scheduler_SetEnabled(Anim_TaskId, 1);
+	return 1;
+}
+
+/**
+ * @brief  Liest einen Eintrag der Bildtabelle, von der SD-Karte über ein Fenster von ANIM_TABLE_WINDOW Einträgen
+ */
+static uint8_t Anim_GetFrame(uint32_t index, Anim_Frame *frame) {
+	uint32_t offset = Anim_Info.tableOffset + index * sizeof(Anim_Frame);
+
+	if (Anim_Data != NULL) {
+		memcpy(frame, Anim_Data + offset, sizeof(Anim_Frame));
+		return 1;
+	}
+
+	if (Anim_TableFirst == ANIM_TABLE_NONE || index < Anim_TableFirst || index >= Anim_TableFirst + ANIM_TABLE_WINDOW) {
+		// Anim_FindKey() walks backwards, then the window ends at index instead of starting there
+		uint32_t first = index;
+		if (Anim_TableFirst != ANIM_TABLE_NONE && index < Anim_TableFirst) {
+			first = index + 1 >= ANIM_TABLE_WINDOW ? index + 1 - ANIM_TABLE_WINDOW : 0;
+		}
+		uint32_t count = Anim_Info.frameCount - first;
+		if (count > ANIM_TABLE_WINDOW) {
+			count = ANIM_TABLE_WINDOW;
+		}
+
+		UINT bytesRead = 0;
+		FRESULT res = f_lseek(&Anim_File, Anim_Info.tableOffset + first * sizeof(Anim_Frame));
+		if (res == FR_OK) {
+			res = f_read(&Anim_File, Anim_Table, count * sizeof(Anim_Frame), &bytesRead);
+		}
+		if (res != FR_OK || bytesRead != count * sizeof(Anim_Frame)) {
+			SDCard_CheckResult(res);
+			Anim_TableFirst = ANIM_TABLE_NONE;
+			return 0;
+		}
+		Anim_TableFirst = first;
+	}
+
+	*frame = Anim_Table[index - Anim_TableFirst];
+	return 1;
+}
+
+/**
+ * @brief  Wählt das zu zeichnende Bild: Anim_Next oder das letzte Schlüsselbild bis einschließlich due
+ */
+static uint32_t Anim_FindKey(uint32_t due) {
+	if (due >= Anim_Info.frameCount) {
+		due = Anim_Info.frameCount - 1;
+	}
+
+	Anim_Frame frame;
+	for (uint32_t i = due; i > Anim_Next; i--) {
+		if (Anim_GetFrame(i, &frame) && (frame.flags & ANIM_FRAME_KEY)) {
+			return i;
+		}
+	}
+	return Anim_Next;
+}
+
+/**
+ * @brief  Prüft Bereich und Lage der Daten eines Bildes und überträgt es
+ */
+static uint8_t Anim_DrawFrame(const Anim_Frame *frame) {
+	if (frame->format == ANIM_FORMAT_SAME) {
+		return 1;
+	}
+	if ((uint32_t)frame->x + frame->width > Anim_Info.width || (uint32_t)frame->y + frame->height > Anim_Info.height
+	    || frame->width == 0 || frame->height == 0
+	    || frame->offset > Anim_Info.size || frame->size > Anim_Info.size - frame->offset) {
+		return 0;
+	}
+
+	uint16_t x = Anim_X + frame->x;
+	uint16_t y = Anim_Y + frame->y;
+
+	if (frame->format == ANIM_FORMAT_CIMG) {
+		if (Anim_Data != NULL) {
+			ILI9341_TE_Sync();
+			return ILI9341_DrawCompressedImage(Anim_Data + frame->offset, frame->size, x, y);
+		}
+		FRESULT res = f_lseek(&Anim_File, frame->offset);
+		if (res != FR_OK) {
+			SDCard_CheckResult(res);
+			return 0;
+		}
+		ILI9341_TE_Sync();
+		return ILI9341_DrawCompressedStream(&Anim_File, x, y);
+	}
+
+	uint32_t bytes = (uint32_t)frame->width * frame->height * 2;
+	if (frame->format != ANIM_FORMAT_RGB565 || frame->size < bytes) {
+		return 0;
+	}
+	if (Anim_Data == NULL) {
+		return Anim_StreamFile(frame, x, y);
+	}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawImage(x, y, frame->width, frame->height, Anim_Data + frame->offset);
+		return 1;
+	}
+#endif
+	ILI9341_TE_Sync();
+	ILI9341_BeginWrite(x, y, x + frame->width - 1, y + frame->height - 1);
+	ILI9341_SendDataAsync(Anim_Data + frame->offset, bytes);
+	return 1;
+}
+
+/**
+ * @brief  Überträgt einen rohen Bereich von der SD-Karte, Lesen und DMA überlappen sich in den ILI9341_FileBuffer
+ */
+static uint8_t Anim_StreamFile(const Anim_Frame *frame, uint16_t x, uint16_t y) {
+	uint32_t rowBytes = (uint32_t)frame->width * 2;
+	uint32_t rowsPerBand = ILI9341_FILE_CHUNK_SIZE / rowBytes;
+
+	FRESULT res = f_lseek(&Anim_File, frame->offset);
+#ifdef ILI9341_USE_FRAMEBUFFER
+	uint8_t toFramebuffer = ILI9341_FB_IsEnabled();
+#endif
+	uint8_t streaming = 0;
+	uint8_t index = 0;
+	uint8_t ok = res == FR_OK;
+
+	for (uint16_t row = 0; row < frame->height && ok; ) {
+		uint16_t rows = ((uint32_t)(frame->height - row) < rowsPerBand) ? frame->height - row : (uint16_t)rowsPerBand;
+		uint32_t bandBytes = rows * rowBytes;
+		uint8_t *buffer = ILI9341_FileBuffer[index];
+		UINT bytesRead = 0;
+
+		// Sent two bands ago; ILI9341_SendDataAsync() waited for it before starting the previous one
+		res = f_read(&Anim_File, buffer, bandBytes, &bytesRead);
+		if (res != FR_OK || bytesRead != bandBytes) {
+			ok = 0;
+			break;
+		}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+		if (toFramebuffer) {
+			ILI9341_FB_DrawImage(x, y + row, frame->width, rows, buffer);
+			row += rows;
+			continue;
+		}
+#endif
+		if (!streaming) {
+			// The first band is in memory, start the transfer at the next TE edge
+			ILI9341_TE_Sync();
+			ILI9341_BeginWrite(x, y, x + frame->width - 1, y + frame->height - 1);
+			ILI9341_StreamBegin();
+			streaming = 1;
+		}
+		ILI9341_SendDataAsync(buffer, bandBytes);
+
+		index ^= 1;
+		row += rows;
+	}
+
+	if (streaming) {
+		ILI9341_StreamEnd();
+	}
+	SDCard_CheckResult(res);
+	return ok;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file    Arena.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Bump-Allokator mit Marken für kurzlebige Puffer von Renderer und Dekodern
+ *
+ * Statt malloc() (Heap aus _sbrk in sysmem.c, zerstückelt mit der Zeit das AXI-SRAM) werden
+ * Zwischenpuffer aus einer Arena geschnitten: Arena_Alloc() schiebt nur einen Zeiger weiter,
+ * freigegeben wird nie einzeln, sondern alles ab einer Marke (Arena_Release()) oder alles auf
+ * einmal (Arena_Reset()). Beides kostet eine Zuweisung, vergessene Freigaben gibt es nicht.
+ *
+ * Arena_Frame ist die gemeinsame Arena für die UI: Task_UI setzt sie am Ende jedes Bildes
+ * zurück, was der Renderer innerhalb eines Bildes holt, lebt also bis dahin. Die Dekoder
+ * (ILI9341_Image.c, ILI9341_Jpeg.c) merken sich zu Beginn einer Datei die Marke, holen
+ * Lesepuffer und FIL und geben zum Schluss alles ab der Marke zurück; sie funktionieren damit
+ * in einem Bild wie außerhalb.
+ *
+ * Die Arena wird nur aus dem Hauptprogramm benutzt, nicht aus Interrupts. Puffer für DMA
+ * (cachebares AXI-SRAM) mit align CACHE_LINE_SIZE holen und in ganzen Cache-Zeilen anlegen;
+ * ein Puffer, in den die DMA schreibt, muss vorher invalidiert werden, da die CPU im selben
+ * Speicher zuvor andere Daten hatte.
+ */
+
+#include "Arena.h"
+#include "Cache.h"
+
+static uint8_t Arena_FrameMemory[ARENA_FRAME_SIZE] AXI_BUFFER;
+
+Arena Arena_Frame = { Arena_FrameMemory, ARENA_FRAME_SIZE, 0, 0, 0 };
+
+/**
+ * @brief  Legt eine Arena über memory an
+ */
+void Arena_Init(Arena *arena, void *memory, uint32_t size) {
+	arena->base = (uint8_t*)memory;
+	arena->size = size;
+	arena->used = 0;
+	arena->peak = 0;
+	arena->failures = 0;
+}
+
+/**
+ * @brief  Holt size Bytes
+ * @param  align: Zweierpotenz, 0 = ARENA_DEFAULT_ALIGN
+ * @retval Zeiger oder NULL, wenn der Platz nicht reicht (der Füllstand bleibt dann unverändert)
+ */
+void* Arena_Alloc(Arena *arena, uint32_t size, uint32_t align) {
+	if (align == 0) align = ARENA_DEFAULT_ALIGN;
+
+	uintptr_t start = ((uintptr_t)arena->base + arena->used + align - 1) & ~(uintptr_t)(align - 1);
+	uint32_t offset = (uint32_t)(start - (uintptr_t)arena->base);
+
+	if (offset > arena->size || size > arena->size - offset) {
+		arena->failures++;
+		return NULL;
+	}
+
+	arena->used = offset + size;
+	if (arena->used > arena->peak) arena->peak = arena->used;
+	return (void*)start;
+}
+
+/**
+ * @brief  Aktueller Füllstand als Marke für Arena_Release()
+ */
+Arena_Mark Arena_GetMark(const Arena *arena) {
+	return arena->used;
+}
+
+/**
+ * @brief  Gibt alles frei, was nach der Marke geholt wurde
+ */
+void Arena_Release(Arena *arena, Arena_Mark mark) {
+	if (mark < arena->used) arena->used = mark;
+}
+
+/**
+ * @brief  Gibt alles frei
+ */
+void Arena_Reset(Arena *arena) {
+	arena->used = 0;
+}
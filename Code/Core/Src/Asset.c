@@ -0,0 +1,500 @@
+/**
+ * @file    Asset.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Asset-Bundle (Bilder, Zeichensätze, Tabellen) im Memory-Mapped-Fenster des W25Qxx
+ *
+ * Statt Bilder per Dateiname von der SD-Karte zu laden und Breite und Höhe von Hand
+ * anzugeben, packt Tools/asset_pack.py alle Assets am PC zu einem einzigen Bundle, das an
+ * ASSET_BUNDLE_ADDRESS in den Flash geschrieben wird:
+ *
+ *   [Asset_Header][Asset_Entry x count][Daten, je ASSET_ALIGNMENT-ausgerichtet]
+ *
+ * Der Index ist nach dem FNV-1a-Hash des Namens sortiert; Hash-Kollisionen weist
+ * schon das Packwerkzeug ab, der Name selbst steht deshalb nicht im Bundle. Asset_Find() sucht
+ * binär im Index und liefert einen Zeiger direkt in das Memory-Mapped-Fenster: kein
+ * Dateisystem, keine Kopie. Ein Bild wird mit Asset_DrawImage() in einem einzigen DMA-Transfer
+ * vom Flash zum Display geschickt.
+ *
+ * Jeder Eintrag trägt die CRC-32 seiner Daten. Asset_Find() prüft sie beim ersten Zugriff auf
+ * ein Asset mit der CRC-Einheit, die der MDMA direkt aus dem Memory-Mapped-Fenster füttert
+ * (Crc32.c); das Ergebnis bleibt bis zum nächsten Asset_Init() gespeichert, spätere Zugriffe
+ * kosten nur einen Tabellenblick. Ein beschädigtes Asset wird wie ein fehlendes behandelt und
+ * einmal gemeldet, statt als Pixelmüll auf dem Display zu landen.
+ *
+ * Bilder zeichnen Asset_DrawImage() und Asset_DrawImageScaled() bevorzugt aus der geprüften
+ * Kopie im RAM (AssetCache.c), die der Cache für angemeldete Bildschirme im Leerlauf lädt; ein
+ * Fehltreffer liest wie bisher aus dem Fenster und reiht das Bild zum Nachladen ein.
+ *
+ * Kleine Symbole liegen statt als einzelne Bilder in einem Atlas (Tools/atlas_pack.py): ein Asset,
+ * eine CRC-Prüfung, ein Platz im Cache. Jede Gruppe der Atlas-Liste ist ein Streifen, in dem ihre
+ * Symbole in Listenreihenfolge nebeneinanderstehen. Asset_DrawAtlasRow() fasst Symbole, die auf
+ * dem Display nebeneinander und im Streifen direkt hintereinander liegen, zu einem Ausschnitt
+ * zusammen und schickt ihn mit einem Adressfenster (ILI9341_DrawImageRegion()); eine ganze
+ * Gruppe ist dabei ein einziger DMA-Block.
+ *
+ * Solange der Memory-Mapped-Modus aus ist (z.B. während eines Schreibzugriffs auf den Flash),
+ * sind die gelieferten Zeiger ungültig; Asset_Init() schaltet ihn ein.
+ */
+
+#include "Asset.h"
+#include "AssetCache.h"
+#include "W25Qxx_QSPI.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_Image.h"
+#include "ILI9341_Scale.h"
+#include "ILI9341_Jpeg.h"
+#include "Crc32.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Ergebnis der CRC-Prüfung je Index-Eintrag */
+#define ASSET_UNCHECKED          0
+#define ASSET_VALID              1
+#define ASSET_CORRUPT            2
+
+/* Kopf und Index des Bundles (im Memory-Mapped-Fenster), NULL bis Asset_Init() erfolgreich war */
+const Asset_Header *Asset_Bundle = NULL;
+const Asset_Entry *Asset_Index = NULL;
+
+static uint8_t Asset_State[ASSET_MAX_ENTRIES];
+
+static const uint8_t* Asset_FindImage(const char *name, const Asset_Entry **entry);
+static void Asset_DrawAtlasRun(const uint8_t *data, const Asset_AtlasStrip *strip, uint16_t srcX, uint16_t width,
+		uint16_t height, int16_t x, int16_t y);
+
+/**
+ * @brief  Schaltet den Memory-Mapped-Modus ein und prüft Kopf und Index des Bundles.
+ * @retval 1 wenn ein gültiges Bundle gefunden wurde, sonst 0
+ */
+uint8_t Asset_Init(void) {
+	Asset_Bundle = NULL;
+	Asset_Index = NULL;
+	AssetCache_Clear();
+	memset(Asset_State, ASSET_UNCHECKED, sizeof(Asset_State));
+
+	if (!W25Qxx_IsMemoryMapped() && !W25Qxx_EnableMemoryMapped()) {
+		return 0;
+	}
+
+	const Asset_Header *header = (const Asset_Header*)W25Qxx_MappedAddress(ASSET_BUNDLE_ADDRESS);
+	if (header->magic != ASSET_MAGIC || header->version != ASSET_VERSION || header->count > ASSET_MAX_ENTRIES) {
+		return 0;
+	}
+
+	uint32_t indexSize = (uint32_t)header->count * sizeof(Asset_Entry);
+	if (header->size > ASSET_BUNDLE_MAX_SIZE || sizeof(Asset_Header) + indexSize > header->size) {
+		return 0;
+	}
+
+	const Asset_Entry *index = (const Asset_Entry*)(header + 1);
+	if (Crc32_Compute(index, indexSize) != header->indexCrc) {
+		return 0;
+	}
+
+	Asset_Bundle = header;
+	Asset_Index = index;
+	return 1;
+}
+
+/**
+ * @brief FNV-1a über den Namen (wie in Tools/asset_pack.py).
+ */
+uint32_t Asset_Hash(const char *name) {
+	uint32_t hash = 2166136261UL;
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+/**
+ * @brief  Sucht den Index-Eintrag eines Assets (binäre Suche über die sortierten Hashes).
+ * @param  name Name des Assets, wie in der Asset-Liste des Packwerkzeugs
+ * @retval Eintrag im Memory-Mapped-Fenster oder NULL
+ */
+const Asset_Entry* Asset_Lookup(const char *name) {
+	if (Asset_Index == NULL) {
+		return NULL;
+	}
+
+	uint32_t hash = Asset_Hash(name);
+	uint32_t low = 0;
+	uint32_t high = Asset_Bundle->count;
+
+	while (low < high) {
+		uint32_t mid = (low + high) / 2;
+		uint32_t value = Asset_Index[mid].hash;
+
+		if (value == hash) {
+			return &Asset_Index[mid];
+		}
+		if (value < hash) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief  Liefert einen Zeiger auf die Daten eines Assets im Memory-Mapped-Fenster.
+ * @param  name  Name des Assets
+ * @param  entry Erhält den Index-Eintrag (Größe, Typ, Abmessungen), darf NULL sein
+ * @retval Zeiger auf die ASSET_ALIGNMENT-ausgerichteten Daten oder NULL (auch bei falscher CRC)
+ */
+const uint8_t* Asset_Find(const char *name, const Asset_Entry **entry) {
+	const Asset_Entry *e = Asset_Lookup(name);
+	if (entry != NULL) {
+		*entry = e;
+	}
+	if (e == NULL || !Asset_Verify(e)) {
+		return NULL;
+	}
+	return W25Qxx_MappedAddress(ASSET_BUNDLE_ADDRESS + e->offset);
+}
+
+/**
+ * @brief  Prüft Lage und CRC-32 der Daten eines Eintrags, gerechnet wird nur beim ersten Aufruf.
+ * @param  entry Eintrag aus Asset_Lookup()
+ * @retval 1 wenn die Daten im Bundle liegen und unversehrt sind, sonst 0
+ */
+uint8_t Asset_Verify(const Asset_Entry *entry) {
+	if (Asset_Index == NULL || entry < Asset_Index || entry >= Asset_Index + Asset_Bundle->count) {
+		return 0;
+	}
+
+	uint8_t *state = &Asset_State[entry - Asset_Index];
+	if (*state == ASSET_UNCHECKED) {
+		const uint8_t *data = W25Qxx_MappedAddress(ASSET_BUNDLE_ADDRESS + entry->offset);
+
+		if (entry->offset > Asset_Bundle->size || entry->size > Asset_Bundle->size - entry->offset
+		    || Crc32_Compute(data, entry->size) != entry->crc) {
+			*state = ASSET_CORRUPT;
+			printf("Asset %08lX corrupt\n", (unsigned long)entry->hash);
+		} else {
+			*state = ASSET_VALID;
+		}
+	}
+	return *state == ASSET_VALID;
+}
+
+/**
+ * @brief  Zeichnet ein RGB565-Bild aus dem Bundle mit den dort gespeicherten Abmessungen.
+ *
+ * Die Pixel werden nicht kopiert: Der SPI-DMA liest sie direkt aus dem Memory-Mapped-Fenster,
+ * die Funktion kehrt nach dem Start der Übertragung zurück. Komprimierte Bilder
+ * (ASSET_TYPE_IMAGE) werden mit ILI9341_DrawCompressedImage() dekodiert, JPEGs
+ * (ASSET_TYPE_JPEG) mit ILI9341_DrawJpeg().
+ *
+ * @param  name Name des Bildes
+ * @param  x, y Obere linke Ecke
+ * @retval 1 wenn das Bild gefunden wurde, sonst 0
+ *
+ * @note   Bis zum Ende der Übertragung (ILI9341_WaitWhileBusy()) darf nicht auf den Flash
+ *         geschrieben werden, weil das den Memory-Mapped-Modus verlässt.
+ */
+uint8_t Asset_DrawImage(const char *name, uint16_t x, uint16_t y) {
+	const Asset_Entry *entry;
+	const uint8_t *pixels = Asset_FindImage(name, &entry);
+
+	if (pixels != NULL && entry->type == ASSET_TYPE_IMAGE) {
+		return ILI9341_DrawCompressedImage(pixels, entry->size, x, y);
+	}
+#ifdef USE_JPEG_ENCODING
+	if (pixels != NULL && entry->type == ASSET_TYPE_JPEG) {
+		return ILI9341_DrawJpeg(pixels, entry->size, x, y);
+	}
+#endif
+	if (pixels == NULL || entry->type != ASSET_TYPE_RGB565 ||
+	    (uint32_t)entry->width * entry->height * 2 > entry->size) {
+		return 0;
+	}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawImage(x, y, entry->width, entry->height, pixels);
+		return 1;
+	}
+#endif
+
+	ILI9341_BeginWrite(x, y, x + entry->width - 1, y + entry->height - 1);
+	ILI9341_SendDataAsync(pixels, (uint32_t)entry->width * entry->height * 2);
+	return 1;
+}
+
+/**
+ * @brief  Zeichnet ein RGB565-Bild aus dem Bundle in beliebiger Größe und optional gedreht.
+ *
+ * Ein Asset deckt so Vorschau, Symbol und Zoomstufen ab. Gelesen wird direkt aus dem
+ * Memory-Mapped-Fenster (siehe ILI9341_DrawImageScaled()). Komprimierte Bilder und JPEGs
+ * lassen sich nicht skalieren, Sprites werden ohne Maske gezeichnet.
+ *
+ * @param  name          Name des Bildes
+ * @param  x, y          Obere linke Ecke
+ * @param  width, height Größe auf dem Display
+ * @param  flags         ILI9341_SCALE_* (Filter und Drehung)
+ * @retval 1 wenn das Bild gefunden und gezeichnet wurde, sonst 0
+ */
+uint8_t Asset_DrawImageScaled(const char *name, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t flags) {
+	const Asset_Entry *entry;
+	const uint8_t *pixels = Asset_FindImage(name, &entry);
+
+	if (pixels == NULL || (entry->type != ASSET_TYPE_RGB565 && entry->type != ASSET_TYPE_SPRITE) ||
+	    (uint32_t)entry->width * entry->height * 2 > entry->size) {
+		return 0;
+	}
+	return ILI9341_DrawImageScaled(x, y, width, height, pixels, entry->width, entry->height, flags);
+}
+
+/**
+ * @brief  Richtet ein Sprite auf ein Bild im Bundle ein, Pixel und Maske bleiben im Flash.
+ *
+ * ASSET_TYPE_SPRITE bringt seine Maske mit, ASSET_TYPE_RGB565 wird ein deckendes Sprite, dem
+ * der Aufrufer mit ILI9341_Sprite_SetKey() eine durchsichtige Farbe geben kann.
+ *
+ * @param  name   Name des Bildes
+ * @param  sprite Wird eingerichtet
+ * @retval 1 wenn das Bild gefunden wurde und groß genug ist, sonst 0
+ */
+uint8_t Asset_LoadSprite(const char *name, ILI9341_Sprite *sprite) {
+	const Asset_Entry *entry;
+	const uint8_t *pixels = Asset_Find(name, &entry);
+
+	if (pixels == NULL || (entry->type != ASSET_TYPE_RGB565 && entry->type != ASSET_TYPE_SPRITE)) {
+		return 0;
+	}
+
+	uint32_t pixelSize = (uint32_t)entry->width * entry->height * 2;
+	uint32_t maskSize = entry->type == ASSET_TYPE_SPRITE ? (uint32_t)(entry->width + 7) / 8 * entry->height : 0;
+	if (pixelSize + maskSize > entry->size) {
+		return 0;
+	}
+
+	ILI9341_Sprite_Init(sprite, entry->width, entry->height, pixels);
+	if (maskSize > 0) {
+		ILI9341_Sprite_SetMask(sprite, pixels + pixelSize);
+	}
+	return 1;
+}
+
+/**
+ * @brief  Richtet einen ILI9341_t3-Font aus einem Font-Asset ein (Tools/font_atlas.py).
+ *
+ * Index und Glyphen bleiben im Memory-Mapped-Fenster, ILI9341_DrawFontChar() liest sie dort
+ * direkt. Beim Aufrufer liegt nur der ILI9341_t3_font_t mit den Zeigern, nichts im internen Flash.
+ * Der Font muss so lange gültig bleiben, wie er mit ILI9341_SetFont() gesetzt ist.
+ *
+ * @code
+ * static ILI9341_t3_font_t Ui_Font;
+ * if (Asset_LoadFont("sans18", &Ui_Font)) ILI9341_SetFont(&Ui_Font);
+ * @endcode
+ *
+ * @param  name Name des Fonts
+ * @param  font Wird eingerichtet
+ * @retval 1 wenn der Font gefunden wurde und sein Kopf stimmt, sonst 0
+ */
+uint8_t Asset_LoadFont(const char *name, ILI9341_t3_font_t *font) {
+	const Asset_Entry *entry;
+	const uint8_t *data = Asset_Find(name, &entry);
+
+	if (data == NULL || entry->type != ASSET_TYPE_FONT || entry->size < sizeof(Asset_FontHeader)) {
+		return 0;
+	}
+
+	const Asset_FontHeader *header = (const Asset_FontHeader*)data;
+	if (header->magic != ASSET_FONT_MAGIC || header->indexOffset >= entry->size || header->dataOffset >= entry->size) {
+		return 0;
+	}
+
+	font->index = data + header->indexOffset;
+	font->unicode = NULL;
+	font->data = data + header->dataOffset;
+	font->version = header->version;
+	font->reserved = header->reserved;
+	font->index1_first = header->index1_first;
+	font->index1_last = header->index1_last;
+	font->index2_first = header->index2_first;
+	font->index2_last = header->index2_last;
+	font->bits_index = header->bits_index;
+	font->bits_width = header->bits_width;
+	font->bits_height = header->bits_height;
+	font->bits_xoffset = header->bits_xoffset;
+	font->bits_yoffset = header->bits_yoffset;
+	font->bits_delta = header->bits_delta;
+	font->line_space = header->line_space;
+	font->cap_height = header->cap_height;
+	return 1;
+}
+
+/**
+ * @brief  Öffnet einen Atlas aus dem Bundle und prüft Streifen und Rechtecke gegen seine Größe.
+ * @param  name  Name des Atlas in der Asset-Liste
+ * @param  atlas Wird eingerichtet, bleibt bis zum nächsten Asset_Init() gültig
+ * @retval 1 wenn der Atlas gefunden wurde und stimmig ist, sonst 0
+ */
+uint8_t Asset_LoadAtlas(const char *name, Asset_Atlas *atlas) {
+	const Asset_Entry *entry;
+	const uint8_t *data = Asset_Find(name, &entry);
+
+	if (data == NULL || entry->type != ASSET_TYPE_ATLAS || entry->size < sizeof(Asset_AtlasHeader)) {
+		return 0;
+	}
+
+	const Asset_AtlasHeader *header = (const Asset_AtlasHeader*)data;
+	if (header->magic != ASSET_ATLAS_MAGIC || header->stripOffset > entry->size || header->rectOffset > entry->size
+	    || (uint32_t)header->strips * sizeof(Asset_AtlasStrip) > entry->size - header->stripOffset
+	    || (uint32_t)header->count * sizeof(Asset_AtlasRect) > entry->size - header->rectOffset) {
+		return 0;
+	}
+
+	const Asset_AtlasStrip *strips = (const Asset_AtlasStrip*)(data + header->stripOffset);
+	for (uint16_t i = 0; i < header->strips; i++) {
+		if (strips[i].offset > entry->size
+		    || (uint32_t)strips[i].width * strips[i].height * 2 > entry->size - strips[i].offset) {
+			return 0;
+		}
+	}
+
+	atlas->entry = entry;
+	atlas->data = data;
+	atlas->strips = strips;
+	atlas->rects = (const Asset_AtlasRect*)(data + header->rectOffset);
+	atlas->count = header->count;
+	atlas->stripCount = header->strips;
+	return 1;
+}
+
+/**
+ * @brief  Sucht ein Symbol im Atlas (binäre Suche über die sortierten Hashes).
+ * @retval Rechteck im Fenster, NULL wenn es fehlt oder nicht in seinen Streifen passt
+ */
+const Asset_AtlasRect* Asset_AtlasLookup(const Asset_Atlas *atlas, const char *name) {
+	uint32_t hash = Asset_Hash(name);
+	uint32_t low = 0;
+	uint32_t high = atlas->count;
+
+	while (low < high) {
+		uint32_t mid = (low + high) / 2;
+		const Asset_AtlasRect *rect = &atlas->rects[mid];
+
+		if (rect->hash == hash) {
+			if (rect->strip >= atlas->stripCount || rect->x + rect->width > atlas->strips[rect->strip].width
+			    || rect->height > atlas->strips[rect->strip].height) {
+				return NULL;
+			}
+			return rect;
+		}
+		if (rect->hash < hash) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief  Zeichnet ein Symbol aus einem Atlas, die Pixel gehen ohne Kopie aus dem Fenster zum Display.
+ * @param  x, y Obere linke Ecke
+ * @retval 1 wenn das Symbol gefunden wurde, sonst 0
+ */
+uint8_t Asset_DrawAtlas(const Asset_Atlas *atlas, const char *name, int16_t x, int16_t y) {
+	const Asset_AtlasRect *rect = Asset_AtlasLookup(atlas, name);
+	const uint8_t *data = AssetCache_Get(atlas->entry);
+
+	if (rect == NULL) {
+		return 0;
+	}
+	Asset_DrawAtlasRun(data != NULL ? data : atlas->data, &atlas->strips[rect->strip], rect->x, rect->width,
+			rect->height, x, y);
+	return 1;
+}
+
+/**
+ * @brief  Zeichnet Symbole eines Atlas lückenlos nebeneinander, ab x nach rechts.
+ *
+ * Folgen Symbole im selben Streifen direkt aufeinander (wie in der Atlas-Liste), gehen sie als
+ * ein Ausschnitt mit einem Adressfenster hinaus, eine ganze Gruppe als ein DMA-Block. Ohne
+ * laufende Befehlsliste fasst die Funktion alle Ausschnitte in einer zusammen (eine CS-Phase).
+ * Die Höhe eines Ausschnitts ist die des höchsten Symbols darin; Symbole einer Gruppe sollten
+ * deshalb gleich hoch sein. Fehlende Symbole werden übersprungen und belegen keinen Platz.
+ *
+ * @code
+ * static const char *const Ui_Toolbar[] = { "play", "pause", "stop", "record" };
+ * Asset_DrawAtlasRow(&Ui_Icons, Ui_Toolbar, 4, 8, 4);
+ * @endcode
+ *
+ * @param  names Namen der Symbole von links nach rechts
+ * @param  count Anzahl der Namen
+ * @param  x, y  Obere linke Ecke des ersten Symbols
+ * @retval Anzahl der Adressfenster, 0 wenn kein Symbol gefunden wurde
+ */
+uint8_t Asset_DrawAtlasRow(const Asset_Atlas *atlas, const char *const names[], uint8_t count, int16_t x, int16_t y) {
+	const uint8_t *data = AssetCache_Get(atlas->entry);
+	const Asset_AtlasRect *run = NULL;
+	uint16_t runWidth = 0;
+	uint16_t runHeight = 0;
+	uint8_t windows = 0;
+	uint8_t batch = !ILI9341_IsBatching();
+
+	if (data == NULL) {
+		data = atlas->data;
+	}
+	if (batch) {
+		ILI9341_BeginBatch();
+	}
+	for (uint8_t i = 0; i <= count; i++) {
+		const Asset_AtlasRect *rect = i < count ? Asset_AtlasLookup(atlas, names[i]) : NULL;
+
+		if (i < count && rect == NULL) {
+			continue;
+		}
+		if (run != NULL && rect != NULL && rect->strip == run->strip && rect->x == run->x + runWidth) {
+			// Next to the previous one in the strip as well: extend the region
+			runWidth += rect->width;
+			if (rect->height > runHeight) {
+				runHeight = rect->height;
+			}
+			continue;
+		}
+		if (run != NULL) {
+			Asset_DrawAtlasRun(data, &atlas->strips[run->strip], run->x, runWidth, runHeight, x, y);
+			x += runWidth;
+			windows++;
+		}
+		run = rect;
+		runWidth = rect != NULL ? rect->width : 0;
+		runHeight = rect != NULL ? rect->height : 0;
+	}
+	if (batch) {
+		ILI9341_EndBatch();
+	}
+	return windows;
+}
+
+/**
+ * @brief  Wie Asset_Find(), aber zuerst aus dem Asset-Cache im RAM (nur für die Dauer des Zeichnens)
+ */
+static const uint8_t* Asset_FindImage(const char *name, const Asset_Entry **entry) {
+	const Asset_Entry *e = Asset_Lookup(name);
+	const uint8_t *data = e != NULL ? AssetCache_Get(e) : NULL;
+
+	if (data == NULL) {
+		return Asset_Find(name, entry);
+	}
+	*entry = e;
+	return data;
+}
+
+/**
+ * @brief  Zeichnet einen Ausschnitt eines Streifens: Spalten srcX bis srcX + width - 1, Zeilen ab 0
+ * @param  data Atlas im Fenster oder seine Kopie im Asset-Cache
+ */
+static void Asset_DrawAtlasRun(const uint8_t *data, const Asset_AtlasStrip *strip, uint16_t srcX, uint16_t width,
+		uint16_t height, int16_t x, int16_t y) {
+	ILI9341_DrawImageRegion(x, y, width, height, data + strip->offset + (uint32_t)srcX * 2, strip->width);
+}
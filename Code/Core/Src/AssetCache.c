@@ -0,0 +1,791 @@
+/**
+ * @file    AssetCache.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Assets im AXI-SRAM, im Leerlauf vorausgeladen für angemeldete Bildschirme
+ *
+ * Beim Wechsel auf einen Bildschirm kommen seine Bilder kalt aus dem Memory-Mapped-Fenster
+ * (beim ersten Zugriff zusätzlich die CRC-Prüfung über das ganze Asset) oder von der SD-Karte,
+ * das erste Bild wird dadurch langsam. Jeder Bildschirm nennt deshalb in einem
+ * AssetCache_Screen die Assets, die er zeichnet. Ein Task mit der niedrigsten Priorität lädt
+ * sie in ASSET_CACHE_SIZE Bytes AXI-SRAM, solange sonst nichts zu tun ist:
+ * - Bundle-Assets kopiert ein MDMA-Kanal in Blöcken von ASSET_CACHE_MDMA_BLOCK aus dem
+ *   Fenster, die CPU übernimmt nur die letzten 0-3 Bytes. Danach wird die CRC-32 über die
+ *   Kopie geprüft; was im Cache liegt, ist damit geprüft, und Asset_DrawImage() spart die
+ *   Prüfung im Fenster.
+ * - Dateien werden über die SDQueue gelesen (Open, Read, Close in einem Zug), die Daten
+ *   landen per IDMA direkt im Cache.
+ *
+ * Die Reihenfolge: AssetCache_Enter() stellt die Assets des aktuellen Bildschirms an den
+ * Anfang der Warteschlange, AssetCache_Prefetch() die eines absehbaren Ziels (z.B. des
+ * markierten Menüeintrags) an ihr Ende, ebenso jeder Fehltreffer. Ist die Warteschlange leer
+ * und die CPU-Last unter ASSET_CACHE_IDLE_LOAD, lädt der Task die Assets aller mit
+ * AssetCache_AddScreen() angemeldeten Bildschirme auf Verdacht, aber nur in freien Platz.
+ * Ein Wechsel trifft so schon beim ersten Besuch auf geladene Bilder, spätestens beim zweiten.
+ *
+ * Der Speicher wird nach dem ersten passenden Platz vergeben; passt nichts, wird das am
+ * längsten nicht benutzte Asset verdrängt, nie eines des aktuellen Bildschirms. Verdrängt
+ * wird nur, solange busy() keinen DMA-Transfer meldet, der noch aus dem Cache lesen könnte.
+ * Gelieferte Zeiger gelten deshalb nur bis zum Ende des Zeichnens, Fonts, Sprites und
+ * Animationen bleiben im Fenster.
+ *
+ * Während ein MDMA-Block läuft, meldet AssetCache_IsBusy() das Fenster als belegt
+ * (FlashPool darf den Memory-Mapped-Modus dann nicht verlassen).
+ */
+
+#include "AssetCache.h"
+#include "W25Qxx_QSPI.h"
+#include "ILI9341.h"
+#include "SDQueue.h"
+#include "Scheduler.h"
+#include "DmaAlloc.h"
+#include "Crc32.h"
+#include "Cache.h"
+#include "Timebase.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Zustand eines Platzes */
+#define ASSET_CACHE_EMPTY         0
+#define ASSET_CACHE_LOADING       1
+#define ASSET_CACHE_READY         2
+
+/* Ergebnis eines Dateizugriffs über die SDQueue */
+#define ASSET_CACHE_FILE_RUNNING  0
+#define ASSET_CACHE_FILE_DONE     1
+#define ASSET_CACHE_FILE_ERROR    2
+
+/* Wartezeit auf das Ende eines bereits fertig gemeldeten MDMA-Blocks */
+#define ASSET_CACHE_MDMA_TIMEOUT_MS  1
+
+#define ASSET_CACHE_ALIGN(size)   (((size) + CACHE_LINE_SIZE - 1) & ~(uint32_t)(CACHE_LINE_SIZE - 1))
+
+/**
+ * @brief Ein gehaltenes Asset
+ */
+typedef struct {
+	uint32_t hash;               // Asset_Entry.hash bzw. Asset_Hash() des Pfads
+	uint32_t offset;             // in AssetCache_Memory, CACHE_LINE_SIZE-ausgerichtet
+	uint32_t size;
+	uint32_t used;               // AssetCache_Clock beim letzten Zugriff
+	uint8_t state;
+	uint8_t file;
+} AssetCache_Slot;
+
+/**
+ * @brief Ein Auftrag der Ladewarteschlange
+ */
+typedef struct {
+	const Asset_Entry *entry;    // NULL: Datei in path
+	uint32_t hash;
+	uint32_t size;
+	uint8_t speculative;
+	char path[ASSET_CACHE_PATH_MAX];
+} AssetCache_Request;
+
+/**
+ * @brief Der laufende Ladevorgang
+ */
+typedef struct {
+	AssetCache_Slot *slot;       // NULL: keiner
+	const Asset_Entry *entry;    // NULL: Datei
+	uint32_t copied;             // Bundle: fertig kopierte Bytes
+	uint32_t block;              // Bundle: Länge des laufenden MDMA-Blocks, 0 wenn keiner läuft
+	uint32_t startUs;
+	uint8_t speculative;
+	uint8_t discard;             // AssetCache_Clear() während eines Dateizugriffs
+	volatile uint8_t fileState;
+	uint32_t fileBytes;
+} AssetCache_Loader;
+
+static uint8_t AssetCache_Memory[ASSET_CACHE_SIZE] AXI_BUFFER;
+static AssetCache_Slot AssetCache_Slots[ASSET_CACHE_ENTRIES];
+static AssetCache_Request AssetCache_Queue[ASSET_CACHE_QUEUE];
+static uint8_t AssetCache_QueueCount = 0;
+static AssetCache_Loader AssetCache_Load;
+static uint32_t AssetCache_Clock = 0;
+
+static const AssetCache_Screen *AssetCache_Screens[ASSET_CACHE_MAX_SCREENS];
+static uint8_t AssetCache_ScreenCount = 0;
+static const AssetCache_Screen *AssetCache_Current = NULL;
+static uint8_t AssetCache_SpecScreen = 0;    // Nächster Kandidat fürs Laden auf Verdacht
+static uint8_t AssetCache_SpecItem = 0;
+
+static AssetCache_Stats AssetCache_Statistics;
+static uint8_t AssetCache_TaskId = SCHEDULER_INVALID_TASK;
+static AssetCache_BusyFunction AssetCache_Busy = NULL;
+
+MDMA_HandleTypeDef AssetCache_Mdma;
+static uint8_t AssetCache_MdmaState = 0;     // 0 nicht eingerichtet, 1 bereit, 2 nicht verfügbar
+
+static uint8_t AssetCache_IsFile(const char *name);
+static AssetCache_Slot* AssetCache_Find(uint32_t hash, uint8_t file);
+static uint8_t AssetCache_IsPinned(const AssetCache_Slot *slot);
+static uint8_t AssetCache_Queued(uint32_t hash, uint8_t file);
+static void AssetCache_Push(const AssetCache_Request *request, uint8_t front);
+static uint8_t AssetCache_MakeRequest(const AssetCache_Item *item, uint8_t speculative, AssetCache_Request *request);
+static void AssetCache_QueueScreen(const AssetCache_Screen *screen, uint8_t front);
+static uint8_t AssetCache_NextSpeculative(AssetCache_Request *request);
+static int32_t AssetCache_Place(uint32_t size);
+static AssetCache_Slot* AssetCache_Allocate(uint32_t size, uint8_t evict, uint8_t *deferred);
+static uint8_t AssetCache_Start(const AssetCache_Request *request);
+static void AssetCache_Continue(void);
+static void AssetCache_Finish(uint8_t ok);
+static uint8_t AssetCache_MdmaInit(void);
+static void AssetCache_FileDone(FRESULT result, uint32_t bytes, void *context);
+
+/**
+ * @brief  Meldet den Task an
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der AssetCache_Task() aufruft
+ * @param  busy: meldet DMA-Transfers, die noch aus dem Cache lesen könnten (ILI9341_IsBusy), darf NULL sein
+ */
+void AssetCache_Init(uint8_t taskId, AssetCache_BusyFunction busy) {
+	AssetCache_TaskId = taskId;
+	AssetCache_Busy = busy;
+	Scheduler_SetEnabled(taskId, AssetCache_ScreenCount > 0 || AssetCache_QueueCount > 0);
+}
+
+/**
+ * @brief  Meldet einen Bildschirm an, dessen Assets im Leerlauf auf Verdacht geladen werden
+ * @retval 0 wenn schon ASSET_CACHE_MAX_SCREENS angemeldet sind
+ */
+uint8_t AssetCache_AddScreen(const AssetCache_Screen *screen) {
+	if (AssetCache_ScreenCount >= ASSET_CACHE_MAX_SCREENS) {
+		return 0;
+	}
+	AssetCache_Screens[AssetCache_ScreenCount++] = screen;
+	AssetCache_SpecScreen = 0;
+	AssetCache_SpecItem = 0;
+	Scheduler_SetEnabled(AssetCache_TaskId, 1);
+	return 1;
+}
+
+/**
+ * @brief  Lädt die Assets eines Bildschirms, zu dem als Nächstes gewechselt werden dürfte
+ *
+ * Sie kommen hinter die schon eingereihten Aufträge und dürfen ältere Assets verdrängen.
+ */
+void AssetCache_Prefetch(const AssetCache_Screen *screen) {
+	AssetCache_QueueScreen(screen, 0);
+}
+
+/**
+ * @brief  Setzt den aktuellen Bildschirm: Seine Assets werden zuerst geladen und nicht verdrängt
+ * @param  screen: NULL, wenn kein angemeldeter Bildschirm mehr zu sehen ist
+ */
+void AssetCache_Enter(const AssetCache_Screen *screen) {
+	AssetCache_Current = screen;
+	AssetCache_SpecScreen = 0;
+	AssetCache_SpecItem = 0;
+	if (screen != NULL) {
+		AssetCache_QueueScreen(screen, 1);
+	}
+}
+
+/**
+ * @brief  Liefert die geprüfte Kopie eines Bundle-Assets im RAM
+ *
+ * Fehlt sie, wird das Asset zum Nachladen eingereiht und NULL geliefert; der Aufrufer liest
+ * dann wie bisher aus dem Fenster.
+ *
+ * @param  entry: Eintrag aus Asset_Lookup()
+ * @retval Daten, gültig bis zum Ende des Zeichnens, oder NULL
+ */
+const uint8_t* AssetCache_Get(const Asset_Entry *entry) {
+	AssetCache_Slot *slot = AssetCache_Find(entry->hash, 0);
+
+	if (slot != NULL && slot->state == ASSET_CACHE_READY) {
+		AssetCache_Statistics.hits++;
+		slot->used = ++AssetCache_Clock;
+		return &AssetCache_Memory[slot->offset];
+	}
+
+	AssetCache_Statistics.misses++;
+	if (slot == NULL && entry->size <= ASSET_CACHE_SIZE) {
+		AssetCache_Request request = { .entry = entry, .hash = entry->hash, .size = entry->size };
+		AssetCache_Push(&request, 0);
+	}
+	return NULL;
+}
+
+/**
+ * @brief  Liefert eine Datei der SD-Karte aus dem RAM, sonst wird sie zum Nachladen eingereiht
+ * @param  path: Pfad, höchstens ASSET_CACHE_PATH_MAX - 1 Zeichen
+ * @param  size: erwartete Länge in Bytes
+ * @retval Daten, gültig bis zum Ende des Zeichnens, oder NULL
+ */
+const uint8_t* AssetCache_GetFile(const char *path, uint32_t size) {
+	uint32_t hash = Asset_Hash(path);
+	AssetCache_Slot *slot = AssetCache_Find(hash, 1);
+
+	if (slot != NULL && slot->state == ASSET_CACHE_READY && slot->size >= size) {
+		AssetCache_Statistics.hits++;
+		slot->used = ++AssetCache_Clock;
+		return &AssetCache_Memory[slot->offset];
+	}
+
+	AssetCache_Statistics.misses++;
+	if (slot == NULL) {
+		AssetCache_Item item = { path, size };
+		AssetCache_Request request;
+		if (AssetCache_MakeRequest(&item, 0, &request)) {
+			AssetCache_Push(&request, 0);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief  Zeichnet ein rohes RGB565-Bild der SD-Karte, aus dem RAM oder wie ILI9341_DrawBinaryFile
+ * @retval 1 wenn es aus dem Cache kam, 0 wenn es von der Karte gelesen wurde
+ */
+uint8_t AssetCache_DrawFile(const char *path, uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+	const uint8_t *pixels = AssetCache_GetFile(path, (uint32_t)width * height * 2);
+
+	if (pixels == NULL) {
+		ILI9341_DrawBinaryFile(path, x, y, width, height);
+		return 0;
+	}
+	ILI9341_DrawImage(x, y, width, height, pixels);
+	return 1;
+}
+
+/**
+ * @brief  Verwirft alle Assets und Aufträge (neues Bundle, Asset_Init())
+ *
+ * Ein laufender MDMA-Block wird abgebrochen. Ein Dateizugriff läuft in der SDQueue zu Ende,
+ * sein Platz bleibt bis dahin belegt.
+ */
+void AssetCache_Clear(void) {
+	AssetCache_Slot *keep = NULL;
+
+	if (AssetCache_Load.slot != NULL) {
+		if (AssetCache_Load.entry == NULL) {
+			keep = AssetCache_Load.slot;
+			AssetCache_Load.discard = 1;
+		} else {
+			if (AssetCache_Load.block > 0) {
+				HAL_MDMA_Abort(&AssetCache_Mdma);
+			}
+			memset(&AssetCache_Load, 0, sizeof(AssetCache_Load));
+		}
+	}
+
+	for (uint8_t i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+		if (&AssetCache_Slots[i] != keep) {
+			AssetCache_Slots[i].state = ASSET_CACHE_EMPTY;
+		}
+	}
+	AssetCache_QueueCount = 0;
+	AssetCache_SpecScreen = 0;
+	AssetCache_SpecItem = 0;
+	Scheduler_SetEnabled(AssetCache_TaskId, 1);
+}
+
+/**
+ * @brief  Gibt an, ob der MDMA gerade aus dem Memory-Mapped-Fenster liest
+ */
+uint8_t AssetCache_IsBusy(void) {
+	return AssetCache_Load.block > 0;
+}
+
+/**
+ * @brief  Scheduler-Task: ein Schritt des laufenden Ladevorgangs oder Start des nächsten
+ *
+ * Schaltet sich ab, wenn nichts mehr zu laden ist; Aufträge und angemeldete Bildschirme
+ * schalten ihn wieder ein.
+ */
+void AssetCache_Task(void *context) {
+	if (AssetCache_Load.slot != NULL) {
+		AssetCache_Continue();
+		return;
+	}
+
+	while (AssetCache_QueueCount > 0) {
+		AssetCache_Request request = AssetCache_Queue[0];
+		if (!AssetCache_Start(&request)) {
+			return;   // Deferred, the request stays at the front
+		}
+		AssetCache_QueueCount--;
+		memmove(&AssetCache_Queue[0], &AssetCache_Queue[1], AssetCache_QueueCount * sizeof(AssetCache_Request));
+		if (AssetCache_Load.slot != NULL) {
+			return;
+		}
+	}
+
+	if (Scheduler_GetLoad() > ASSET_CACHE_IDLE_LOAD) {
+		AssetCache_Statistics.deferred++;
+		return;
+	}
+
+	AssetCache_Request request;
+	while (AssetCache_NextSpeculative(&request)) {
+		if (!AssetCache_Start(&request)) {
+			return;
+		}
+		if (AssetCache_Load.slot != NULL) {
+			return;
+		}
+	}
+	Scheduler_SetEnabled(AssetCache_TaskId, 0);
+}
+
+/**
+ * @brief  Zähler des Caches
+ */
+const AssetCache_Stats* AssetCache_GetStats(void) {
+	return &AssetCache_Statistics;
+}
+
+/**
+ * @brief  Setzt die Zähler zurück, die gehaltenen Assets bleiben
+ */
+void AssetCache_ResetStats(void) {
+	memset(&AssetCache_Statistics, 0, sizeof(AssetCache_Statistics));
+}
+
+/**
+ * @brief  Gibt Belegung, Zähler und die gehaltenen Assets aus (Shell 'cache')
+ */
+void AssetCache_Dump(void) {
+	const AssetCache_Stats *s = &AssetCache_Statistics;
+	uint32_t bytes = 0;
+	uint8_t count = 0;
+
+	for (uint8_t i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+		if (AssetCache_Slots[i].state != ASSET_CACHE_EMPTY) {
+			bytes += ASSET_CACHE_ALIGN(AssetCache_Slots[i].size);
+			count++;
+		}
+	}
+	printf("Asset-Cache: %lu/%lu KB, %u/%u Assets, %u Bildschirme, aktuell %s, %u Aufträge\n",
+			(unsigned long)(bytes / 1024U), (unsigned long)(ASSET_CACHE_SIZE / 1024U), count, ASSET_CACHE_ENTRIES,
+			AssetCache_ScreenCount, AssetCache_Current != NULL ? AssetCache_Current->name : "-",
+			AssetCache_QueueCount);
+	printf("%lu Treffer, %lu Fehltreffer, %lu geladen (%lu auf Verdacht, %lu KB), %lu verdrängt, %lu Fehler, %lu verschoben\n",
+			(unsigned long)s->hits, (unsigned long)s->misses, (unsigned long)s->loads,
+			(unsigned long)s->speculative, (unsigned long)(s->bytes / 1024U), (unsigned long)s->evictions,
+			(unsigned long)s->failures, (unsigned long)s->deferred);
+	printf("Laden zuletzt %lu us, max %lu us, Kopie per %s\n", (unsigned long)s->lastLoadUs,
+			(unsigned long)s->maxLoadUs, AssetCache_MdmaState == 2 ? "CPU" : "MDMA");
+
+	for (uint8_t i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+		const AssetCache_Slot *slot = &AssetCache_Slots[i];
+		if (slot->state == ASSET_CACHE_EMPTY) {
+			continue;
+		}
+		printf("  %08lX %-5s %7lu B ab %6lu  %s%s\n", (unsigned long)slot->hash, slot->file ? "Datei" : "Asset",
+				(unsigned long)slot->size, (unsigned long)slot->offset,
+				slot->state == ASSET_CACHE_LOADING ? "lädt" : "bereit", AssetCache_IsPinned(slot) ? ", aktuell" : "");
+	}
+}
+
+/**
+ * @brief  Dateien der SD-Karte beginnen mit '/' oder einem Laufwerk ("0:/...")
+ */
+static uint8_t AssetCache_IsFile(const char *name) {
+	return name[0] == '/' || (name[0] != '\0' && name[1] == ':');
+}
+
+/**
+ * @brief  Sucht den Platz eines Assets (geladen oder im Laden)
+ */
+static AssetCache_Slot* AssetCache_Find(uint32_t hash, uint8_t file) {
+	for (uint8_t i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+		AssetCache_Slot *slot = &AssetCache_Slots[i];
+		if (slot->state != ASSET_CACHE_EMPTY && slot->hash == hash && slot->file == file) {
+			return slot;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief  Gehört ein Platz zum aktuellen Bildschirm? Solche werden nicht verdrängt.
+ */
+static uint8_t AssetCache_IsPinned(const AssetCache_Slot *slot) {
+	if (AssetCache_Current == NULL) {
+		return 0;
+	}
+	for (uint8_t i = 0; i < AssetCache_Current->count; i++) {
+		const char *name = AssetCache_Current->items[i].name;
+		if (AssetCache_IsFile(name) == slot->file && Asset_Hash(name) == slot->hash) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief  Steht ein Asset schon in der Warteschlange?
+ */
+static uint8_t AssetCache_Queued(uint32_t hash, uint8_t file) {
+	for (uint8_t i = 0; i < AssetCache_QueueCount; i++) {
+		if (AssetCache_Queue[i].hash == hash && (AssetCache_Queue[i].entry == NULL) == file) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief  Reiht einen Auftrag ein, am Anfang oder am Ende; schon eingereihte bleiben, wo sie sind
+ *
+ * Ist die Warteschlange voll, verdrängt ein Auftrag am Anfang den letzten, einer am Ende entfällt.
+ */
+static void AssetCache_Push(const AssetCache_Request *request, uint8_t front) {
+	if (AssetCache_Queued(request->hash, request->entry == NULL)) {
+		return;
+	}
+	if (front) {
+		uint8_t keep = AssetCache_QueueCount < ASSET_CACHE_QUEUE ? AssetCache_QueueCount : ASSET_CACHE_QUEUE - 1;
+		memmove(&AssetCache_Queue[1], &AssetCache_Queue[0], keep * sizeof(AssetCache_Request));
+		AssetCache_Queue[0] = *request;
+		AssetCache_QueueCount = keep + 1;
+	} else if (AssetCache_QueueCount < ASSET_CACHE_QUEUE) {
+		AssetCache_Queue[AssetCache_QueueCount++] = *request;
+	} else {
+		return;
+	}
+	Scheduler_SetEnabled(AssetCache_TaskId, 1);
+}
+
+/**
+ * @brief  Setzt den Auftrag für ein Asset eines Bildschirms auf
+ * @retval 0 wenn es nicht im Bundle steht, der Pfad zu lang ist oder es nicht in den Cache passt
+ */
+static uint8_t AssetCache_MakeRequest(const AssetCache_Item *item, uint8_t speculative, AssetCache_Request *request) {
+	memset(request, 0, sizeof(AssetCache_Request));
+	request->speculative = speculative;
+
+	if (AssetCache_IsFile(item->name)) {
+		if (strlen(item->name) >= ASSET_CACHE_PATH_MAX) {
+			return 0;
+		}
+		strcpy(request->path, item->name);
+		request->hash = Asset_Hash(item->name);
+		request->size = item->size;
+	} else {
+		request->entry = Asset_Lookup(item->name);
+		if (request->entry == NULL) {
+			return 0;
+		}
+		request->hash = request->entry->hash;
+		request->size = request->entry->size;
+	}
+	return request->size > 0 && request->size <= ASSET_CACHE_SIZE;
+}
+
+/**
+ * @brief  Reiht die noch nicht geladenen Assets eines Bildschirms ein, die geladenen zählen als benutzt
+ */
+static void AssetCache_QueueScreen(const AssetCache_Screen *screen, uint8_t front) {
+	// At the front in reverse order, so the first item is loaded first
+	for (uint8_t n = 0; n < screen->count; n++) {
+		const AssetCache_Item *item = &screen->items[front ? screen->count - 1 - n : n];
+		AssetCache_Request request;
+
+		if (!AssetCache_MakeRequest(item, 0, &request)) {
+			continue;
+		}
+		AssetCache_Slot *slot = AssetCache_Find(request.hash, request.entry == NULL);
+		if (slot != NULL) {
+			slot->used = ++AssetCache_Clock;
+			continue;
+		}
+		AssetCache_Push(&request, front);
+	}
+}
+
+/**
+ * @brief  Nächstes noch nicht geladenes Asset der angemeldeten Bildschirme, reihum einmal je Durchgang
+ * @retval 0 wenn alle durchgesehen sind
+ */
+static uint8_t AssetCache_NextSpeculative(AssetCache_Request *request) {
+	while (AssetCache_SpecScreen < AssetCache_ScreenCount) {
+		const AssetCache_Screen *screen = AssetCache_Screens[AssetCache_SpecScreen];
+
+		if (AssetCache_SpecItem >= screen->count) {
+			AssetCache_SpecScreen++;
+			AssetCache_SpecItem = 0;
+			continue;
+		}
+		const AssetCache_Item *item = &screen->items[AssetCache_SpecItem++];
+		if (AssetCache_MakeRequest(item, 1, request) && AssetCache_Find(request->hash, request->entry == NULL) == NULL) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief  Erster freier Bereich für size Bytes
+ * @retval Versatz in AssetCache_Memory oder -1
+ */
+static int32_t AssetCache_Place(uint32_t size) {
+	uint32_t need = ASSET_CACHE_ALIGN(size);
+	uint32_t candidate = 0;
+	uint8_t moved;
+
+	// Move past every overlapping slot until a full pass finds none
+	do {
+		moved = 0;
+		for (uint8_t i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+			const AssetCache_Slot *slot = &AssetCache_Slots[i];
+			uint32_t end = slot->offset + ASSET_CACHE_ALIGN(slot->size);
+			if (slot->state != ASSET_CACHE_EMPTY && slot->offset < candidate + need && candidate < end) {
+				candidate = end;
+				moved = 1;
+			}
+		}
+	} while (moved && candidate + need <= ASSET_CACHE_SIZE);
+
+	return candidate + need <= ASSET_CACHE_SIZE ? (int32_t)candidate : -1;
+}
+
+/**
+ * @brief  Vergibt Platz für ein Asset, verdrängt dafür bei Bedarf die am längsten unbenutzten
+ * @param  evict: 0 = nur freier Platz (Laden auf Verdacht)
+ * @param  deferred: wird 1, wenn verdrängt werden müsste, aber busy() einen Transfer meldet
+ * @retval Platz im Zustand ASSET_CACHE_LOADING oder NULL
+ */
+static AssetCache_Slot* AssetCache_Allocate(uint32_t size, uint8_t evict, uint8_t *deferred) {
+	*deferred = 0;
+
+	for (;;) {
+		AssetCache_Slot *empty = NULL;
+		for (uint8_t i = 0; i < ASSET_CACHE_ENTRIES && empty == NULL; i++) {
+			if (AssetCache_Slots[i].state == ASSET_CACHE_EMPTY) {
+				empty = &AssetCache_Slots[i];
+			}
+		}
+
+		int32_t offset = empty != NULL ? AssetCache_Place(size) : -1;
+		if (offset >= 0) {
+			empty->offset = (uint32_t)offset;
+			empty->size = size;
+			empty->used = ++AssetCache_Clock;
+			empty->state = ASSET_CACHE_LOADING;
+			return empty;
+		}
+		if (!evict) {
+			return NULL;
+		}
+		if (AssetCache_Busy != NULL && AssetCache_Busy()) {
+			*deferred = 1;
+			return NULL;
+		}
+
+		AssetCache_Slot *victim = NULL;
+		for (uint8_t i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+			AssetCache_Slot *slot = &AssetCache_Slots[i];
+			if (slot->state == ASSET_CACHE_READY && (victim == NULL || slot->used < victim->used)
+			    && !AssetCache_IsPinned(slot)) {
+				victim = slot;
+			}
+		}
+		if (victim == NULL) {
+			return NULL;
+		}
+		victim->state = ASSET_CACHE_EMPTY;
+		AssetCache_Statistics.evictions++;
+	}
+}
+
+/**
+ * @brief  Beginnt einen Ladevorgang
+ * @retval 0 wenn er später erneut versucht werden soll, 1 wenn er läuft oder entfällt
+ */
+static uint8_t AssetCache_Start(const AssetCache_Request *request) {
+	if (AssetCache_Find(request->hash, request->entry == NULL) != NULL) {
+		return 1;
+	}
+	if (request->entry != NULL ? !W25Qxx_IsMemoryMapped() : SDQueue_Pending() + 3 > SDQUEUE_DEPTH) {
+		AssetCache_Statistics.deferred++;
+		return 0;
+	}
+
+	uint8_t deferred;
+	AssetCache_Slot *slot = AssetCache_Allocate(request->size, !request->speculative, &deferred);
+	if (slot == NULL) {
+		if (deferred) {
+			AssetCache_Statistics.deferred++;
+			return 0;
+		}
+		if (!request->speculative) {
+			AssetCache_Statistics.failures++;
+		}
+		return 1;
+	}
+	slot->hash = request->hash;
+	slot->file = request->entry == NULL;
+
+	memset(&AssetCache_Load, 0, sizeof(AssetCache_Load));
+	AssetCache_Load.slot = slot;
+	AssetCache_Load.entry = request->entry;
+	AssetCache_Load.speculative = request->speculative;
+	AssetCache_Load.startUs = Timebase_Us32();
+
+	if (request->entry != NULL) {
+		AssetCache_Continue();
+		return 1;
+	}
+
+	uint8_t *data = &AssetCache_Memory[slot->offset];
+	int8_t handle = SDQueue_Open(request->path, FA_READ, NULL, NULL);
+	if (handle < 0) {
+		slot->state = ASSET_CACHE_EMPTY;
+		AssetCache_Load.slot = NULL;
+		AssetCache_Statistics.deferred++;
+		return 0;
+	}
+	AssetCache_Load.fileState = ASSET_CACHE_FILE_RUNNING;
+	SDQueue_Read(handle, data, request->size, AssetCache_FileDone, &AssetCache_Load);
+	SDQueue_Close(handle, NULL, NULL);
+	return 1;
+}
+
+/**
+ * @brief  Nächster Schritt des laufenden Ladevorgangs: MDMA-Block abholen und den nächsten starten
+ */
+static void AssetCache_Continue(void) {
+	AssetCache_Loader *load = &AssetCache_Load;
+	AssetCache_Slot *slot = load->slot;
+	uint8_t *data = &AssetCache_Memory[slot->offset];
+
+	if (load->entry == NULL) {
+		if (load->fileState == ASSET_CACHE_FILE_RUNNING) {
+			return;
+		}
+		if (load->discard) {
+			slot->state = ASSET_CACHE_EMPTY;
+			load->slot = NULL;
+			return;
+		}
+		AssetCache_Finish(load->fileState == ASSET_CACHE_FILE_DONE && load->fileBytes == slot->size);
+		return;
+	}
+
+	if (load->block > 0) {
+		if (!__HAL_MDMA_GET_FLAG(&AssetCache_Mdma, MDMA_FLAG_CTC | MDMA_FLAG_TE)) {
+			return;
+		}
+		uint8_t ok = HAL_MDMA_PollForTransfer(&AssetCache_Mdma, HAL_MDMA_FULL_TRANSFER,
+				ASSET_CACHE_MDMA_TIMEOUT_MS) == HAL_OK;
+		// The core may have fetched lines speculatively while the MDMA wrote
+		Cache_InvalidateDMA(data + load->copied, load->block);
+		load->copied += load->block;
+		load->block = 0;
+		if (!ok) {
+			AssetCache_Finish(0);
+			return;
+		}
+	}
+
+	if (!W25Qxx_IsMemoryMapped()) {
+		AssetCache_Statistics.deferred++;
+		return;
+	}
+
+	const uint8_t *source = W25Qxx_MappedAddress(ASSET_BUNDLE_ADDRESS + load->entry->offset);
+	uint32_t words = slot->size & ~3UL;
+
+	if (load->copied < words) {
+		uint32_t block = words - load->copied;
+		if (block > ASSET_CACHE_MDMA_BLOCK) {
+			block = ASSET_CACHE_MDMA_BLOCK;
+		}
+
+		if (AssetCache_MdmaInit()) {
+			Cache_InvalidateDMA(data + load->copied, block);
+			if (HAL_MDMA_Start(&AssetCache_Mdma, (uint32_t)(source + load->copied), (uint32_t)(data + load->copied),
+			                   block, 1) == HAL_OK) {
+				load->block = block;
+				return;
+			}
+		}
+		// Channel unavailable: copy this block with the CPU
+		memcpy(data + load->copied, source + load->copied, block);
+		load->copied += block;
+		if (load->copied < words) {
+			return;
+		}
+	}
+
+	memcpy(data + words, source + words, slot->size - words);
+	Cache_CleanDMA(data + words, slot->size - words);
+	AssetCache_Finish(Crc32_Compute(data, slot->size) == load->entry->crc);
+}
+
+/**
+ * @brief  Schließt den Ladevorgang ab: Asset bereit oder Platz wieder frei
+ */
+static void AssetCache_Finish(uint8_t ok) {
+	AssetCache_Loader *load = &AssetCache_Load;
+	AssetCache_Slot *slot = load->slot;
+	AssetCache_Stats *s = &AssetCache_Statistics;
+
+	if (ok) {
+		slot->state = ASSET_CACHE_READY;
+		s->loads++;
+		s->speculative += load->speculative;
+		s->bytes += slot->size;
+	} else {
+		slot->state = ASSET_CACHE_EMPTY;
+		s->failures++;
+		printf("Asset-Cache: %08lX nicht geladen\n", (unsigned long)slot->hash);
+	}
+
+	s->lastLoadUs = Timebase_Us32() - load->startUs;
+	if (s->lastLoadUs > s->maxLoadUs) {
+		s->maxLoadUs = s->lastLoadUs;
+	}
+	load->slot = NULL;
+}
+
+/**
+ * @brief  Richtet den MDMA-Kanal für Kopien aus dem Fenster ein (einmalig)
+ * @retval 1 wenn er bereit ist, 0 wenn die CPU kopieren muss
+ */
+static uint8_t AssetCache_MdmaInit(void) {
+	if (AssetCache_MdmaState != 0) {
+		return AssetCache_MdmaState == 1;
+	}
+	AssetCache_MdmaState = 2;
+
+	__HAL_RCC_MDMA_CLK_ENABLE();
+	if (!DmaAlloc_ClaimMdma(&AssetCache_Mdma, "Asset")) {
+		return 0;
+	}
+	AssetCache_Mdma.Init.Request = MDMA_REQUEST_SW;
+	AssetCache_Mdma.Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+	AssetCache_Mdma.Init.Priority = MDMA_PRIORITY_LOW;
+	AssetCache_Mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+	AssetCache_Mdma.Init.SourceInc = MDMA_SRC_INC_WORD;
+	AssetCache_Mdma.Init.DestinationInc = MDMA_DEST_INC_WORD;
+	AssetCache_Mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_WORD;
+	AssetCache_Mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_WORD;
+	AssetCache_Mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+	AssetCache_Mdma.Init.BufferTransferLength = 128;
+	AssetCache_Mdma.Init.SourceBurst = MDMA_SOURCE_BURST_32BEATS;
+	AssetCache_Mdma.Init.DestBurst = MDMA_DEST_BURST_32BEATS;
+	AssetCache_Mdma.Init.SourceBlockAddressOffset = 0;
+	AssetCache_Mdma.Init.DestBlockAddressOffset = 0;
+
+	if (HAL_MDMA_Init(&AssetCache_Mdma) != HAL_OK) {
+		return 0;
+	}
+	AssetCache_MdmaState = 1;
+	return 1;
+}
+
+/**
+ * @brief  Callback der SDQueue nach dem Lesen einer Datei (aus SDQueue_Service())
+ */
+static void AssetCache_FileDone(FRESULT result, uint32_t bytes, void *context) {
+	AssetCache_Loader *load = context;
+
+	load->fileBytes = bytes;
+	load->fileState = result == FR_OK ? ASSET_CACHE_FILE_DONE : ASSET_CACHE_FILE_ERROR;
+	Scheduler_SetEnabled(AssetCache_TaskId, 1);
+}
@@ -0,0 +1,203 @@
+/**
+ * @file    Async.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Stacklose Coroutinen (Protothreads) für Treiber, die sequentiell warten statt zu blockieren
+ *
+ * Ein nicht blockierender Treiber wird sonst von Hand als Zustandsautomat geschrieben: ein enum,
+ * ein switch und je Wartezeit ein Zustand (siehe frühere Fassung von AHT20_Service()). Mit den
+ * Makros aus Async.h steht derselbe Ablauf als gerader Code da:
+ *
+ *     ASYNC_BEGIN(self);
+ *     I2CBus_Write(...);
+ *     AWAIT_DMA(self, !done);
+ *     AWAIT_MS(self, 80);
+ *     ...
+ *     ASYNC_END(self);
+ *
+ * Jedes AWAIT_* merkt sich seine Zeile (__LINE__) in self->resume und kehrt zurück, solange die
+ * Bedingung nicht erfüllt ist. Der nächste Aufruf springt über das switch in ASYNC_BEGIN direkt
+ * dorthin (Duff's Device). Es gibt keinen eigenen Stack: ein Wartepunkt kostet zwei Byte, dafür
+ * überleben lokale Variablen kein AWAIT_*, und je Zeile ist nur ein Wartepunkt erlaubt.
+ * C++20-Coroutinen kämen mit Heap-Rahmen; die Treiber sind C, deshalb diese Lösung.
+ *
+ * Scheduler: Async_Spawn() legt eine Coroutine als eigenen Task an, Async_Setup() bindet sie an
+ * einen vorhandenen Task, der Async_Run() aufruft. Gewartet wird ohne Abfrageschleife:
+ * - AWAIT_DMA / AWAIT_FLAG: der Callback aus dem Interrupt ruft Async_Notify(), das gibt den Task
+ *   frei (Scheduler_Release)
+ * - AWAIT_MS: Async_Run() legt die nächste Freigabe auf das Ende der Wartezeit
+ *   (Scheduler_ReleaseAfter), der Tickless-Schlaf reicht genau bis dahin
+ * - ASYNC_YIELD: sofort wieder freigegeben, andere Tasks kommen dazwischen
+ * Die Periode des Tasks bleibt als Rückfallebene für AWAIT_UNTIL und verlorene Meldungen.
+ *
+ * CPU je Coroutine: Async_Run() misst jeden Abschnitt zwischen zwei Wartepunkten mit DWT->CYCCNT,
+ * unabhängig davon, aus welchem Task er läuft (AHT20_StartMeasurement() startet die Messung z.B.
+ * aus dem Timer-Task). Async_Dump() zeigt Summe, Anteil an der Laufzeit und längsten Abschnitt.
+ */
+
+#include "Async.h"
+#include <stdio.h>
+
+static Async *Async_List = NULL;
+static uint32_t Async_StatsStartMs = 0;
+
+static void Async_Task(void *context);
+static void Async_ResetOne(Async *a);
+
+static const char *const Async_WaitName[ASYNC_WAIT_KINDS] = {
+	"-", "until", "dma", "ms", "flag", "yield"
+};
+
+/**
+ * @brief  Bereitet eine Coroutine vor und trägt sie für Async_Dump() ein
+ * @param  taskId: Task, der Async_Run() aufruft und von Async_Notify() freigegeben wird
+ */
+void Async_Setup(Async *a, const char *name, Async_Function function, void *context, uint8_t taskId) {
+	uint8_t listed = 0;
+	for (Async *it = Async_List; it != NULL; it = it->next) {
+		if (it == a) listed = 1;
+	}
+
+	a->resume = 0;
+	a->wait = ASYNC_WAIT_NONE;
+	a->taskId = taskId;
+	a->running = 0;
+	a->yielded = 0;
+	a->name = name;
+	a->function = function;
+	a->context = context;
+	Async_ResetOne(a);
+
+	if (!listed) {
+		a->next = Async_List;
+		Async_List = a;
+	}
+}
+
+/**
+ * @brief  Legt für die Coroutine einen eigenen Task an (Periode ASYNC_POLL_MS), gestartet wird mit Async_Start()
+ * @retval Nummer des Tasks oder SCHEDULER_INVALID_TASK
+ */
+uint8_t Async_Spawn(Async *a, const char *name, Async_Function function, void *context, uint8_t priority) {
+	uint8_t taskId = Scheduler_AddTask(name, Async_Task, a, ASYNC_POLL_MS, ASYNC_POLL_MS, priority);
+	if (taskId != SCHEDULER_INVALID_TASK)
+		Async_Setup(a, name, function, context, taskId);
+	return taskId;
+}
+
+/**
+ * @brief  Beginnt den Rumpf von vorn, der Task läuft in der nächsten Runde
+ * @retval 0, wenn die Coroutine noch läuft
+ */
+uint8_t Async_Start(Async *a) {
+	if (a->running)
+		return 0;
+
+	a->resume = 0;
+	a->wait = ASYNC_WAIT_NONE;
+	a->yielded = 0;
+	a->starts++;
+	a->running = 1;
+	Scheduler_Release(a->taskId);
+	return 1;
+}
+
+/**
+ * @brief  Bricht die Coroutine am aktuellen Wartepunkt ab; laufende Transfers muss der Rumpf selbst verwerfen
+ */
+void Async_Abort(Async *a) {
+	a->running = 0;
+	a->resume = 0;
+	a->wait = ASYNC_WAIT_NONE;
+}
+
+/**
+ * @brief  Setzt die Coroutine bis zum nächsten Wartepunkt fort, aus einem Task (nicht aus dem Interrupt)
+ * @retval 1 solange sie noch läuft
+ */
+uint8_t Async_Run(Async *a) {
+	if (!a->running)
+		return 0;
+
+	uint32_t start = DWT->CYCCNT;
+	Async_Result result = a->function(a);
+	uint32_t cycles = DWT->CYCCNT - start;
+
+	a->resumes++;
+	a->cycles += cycles;
+	if (cycles > a->maxCycles) a->maxCycles = cycles;
+
+	if (result == ASYNC_DONE) {
+		a->running = 0;
+		a->wait = ASYNC_WAIT_NONE;
+		a->finished++;
+		return 0;
+	}
+
+	a->waits[a->wait]++;
+	if (a->wait == ASYNC_WAIT_MS) {
+		int32_t remaining = (int32_t)(a->untilMs - HAL_GetTick());
+		Scheduler_ReleaseAfter(a->taskId, remaining > 0 ? (uint32_t)remaining : 1);
+	} else if (a->wait == ASYNC_WAIT_YIELD) {
+		Scheduler_Release(a->taskId);
+	}
+	return 1;
+}
+
+/**
+ * @brief  Weckt den Task der Coroutine, aus jedem Kontext (Abschluss-Callbacks im Interrupt)
+ */
+RAMFUNC void Async_Notify(Async *a) {
+	if (a->running)
+		Scheduler_Release(a->taskId);
+}
+
+uint8_t Async_IsRunning(const Async *a) {
+	return a->running;
+}
+
+void Async_ResetStats(void) {
+	for (Async *a = Async_List; a != NULL; a = a->next)
+		Async_ResetOne(a);
+	Async_StatsStartMs = HAL_GetTick();
+}
+
+/**
+ * @brief  Coroutinen mit Zustand, Unterbrechungen je Art und CPU-Zeit über printf
+ */
+void Async_Dump(void) {
+	uint32_t elapsedMs = HAL_GetTick() - Async_StatsStartMs;
+	uint32_t cyclesPerUs = SystemCoreClock / 1000000UL;
+
+	printf("Coroutinen seit %lu ms\n", elapsedMs);
+	printf("%-10s %-6s %6s %6s %8s %6s %6s %6s %6s %10s %8s %8s\n", "Name", "Wartet", "Starts", "Fertig",
+			"Schritte", "dma", "ms", "flag", "yield", "CPU [us]", "Anteil", "Max [us]");
+
+	for (Async *a = Async_List; a != NULL; a = a->next) {
+		uint32_t us = (uint32_t)(a->cycles / cyclesPerUs);
+		// Share in 0.01 %: us / (elapsedMs * 1000) * 10000
+		uint32_t share = elapsedMs ? (uint32_t)((uint64_t)us * 10 / elapsedMs) : 0;
+
+		printf("%-10s %-6s %6lu %6lu %8lu %6lu %6lu %6lu %6lu %10lu %4lu.%02lu %% %8lu\n", a->name,
+				a->running ? Async_WaitName[a->wait] : "idle", a->starts, a->finished, a->resumes,
+				a->waits[ASYNC_WAIT_DMA], a->waits[ASYNC_WAIT_MS], a->waits[ASYNC_WAIT_FLAG],
+				a->waits[ASYNC_WAIT_YIELD], us, share / 100, share % 100, a->maxCycles / cyclesPerUs);
+	}
+}
+
+/**
+ * @brief  Task-Funktion von Async_Spawn()
+ */
+static void Async_Task(void *context) {
+	Async_Run((Async *)context);
+}
+
+static void Async_ResetOne(Async *a) {
+	a->starts = 0;
+	a->finished = 0;
+	a->resumes = 0;
+	for (uint8_t i = 0; i < ASYNC_WAIT_KINDS; i++)
+		a->waits[i] = 0;
+	a->cycles = 0;
+	a->maxCycles = 0;
+}
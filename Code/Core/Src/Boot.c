@@ -0,0 +1,228 @@
+/**
+ * @file    Boot.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Zeitmessung des Startvorgangs und verschobene Initialisierung langsamer Peripherie
+ *
+ * main() setzt mit Boot_MarkPhase() Zeitstempel hinter jeden Abschnitt des Starts. Gezählt
+ * wird mit DWT->CYCCNT ab Boot_Init(), ganz am Anfang von main(). Weil sich der Takt während
+ * des Starts ändert (SystemClock_Config(), Clock_SetProfile()), wird jeder Abschnitt mit dem
+ * SystemCoreClock beim Setzen des Zeitstempels in Mikrosekunden umgerechnet und aufsummiert.
+ * Der Abschnitt vor einem Taktwechsel wird daher mit dem neuen Takt gerechnet.
+ *
+ * Zwei Punkte sind die eigentlichen Kennzahlen:
+ * - Boot_FirstPixel(): das Display zeigt das erste Bild
+ * - Boot_Interactive(): der Scheduler läuft, Eingaben und UI werden bearbeitet
+ *
+ * Was für beides nicht gebraucht wird (SD-Karte mounten, ADC kalibrieren, CAN, Nebenanzeigen),
+ * meldet main() mit Boot_Defer() an. Der Boot-Task führt nach dem Start des Schedulers je
+ * Aufruf eine dieser Initialisierungen aus, zwischen ihnen laufen die anderen Tasks. Eine
+ * einzelne Initialisierung blockiert weiterhin für ihre ganze Dauer (z.B. f_mount()), nur
+ * eben nach dem ersten Bild statt davor. Schlägt eine fehl, wird das vermerkt und der Start
+ * geht weiter; nach der letzten gibt Boot_Report() die Tabelle über printf aus (UART7).
+ */
+
+#include "Boot.h"
+#include "Scheduler.h"
+#include "WarmBoot.h"
+#include <stdio.h>
+
+typedef struct {
+	const char *name;
+	Boot_StageFunction function;
+} Boot_Stage;
+
+static Boot_Mark Boot_Marks[BOOT_MAX_MARKS];
+static uint8_t Boot_MarkCount = 0;
+static uint32_t Boot_LastCycle = 0;
+static uint32_t Boot_Us = 0;
+
+static Boot_Stage Boot_Stages[BOOT_MAX_STAGES];
+static uint8_t Boot_StageCount = 0;
+static uint8_t Boot_NextStage = 0;
+static uint8_t Boot_Failed = 0;
+static uint8_t Boot_TaskId = SCHEDULER_INVALID_TASK;
+
+static uint32_t Boot_FirstPixelUs = 0;
+static uint32_t Boot_InteractiveUs = 0;
+static uint32_t Boot_CompleteUs = 0;
+
+static uint32_t Boot_Now(void);
+static void Boot_Add(const char *name, uint32_t startUs, uint8_t failed);
+static uint32_t Boot_LastMarkUs(void);
+static void Boot_RunStage(void);
+
+/**
+ * @brief  Startet den Zykluszähler, erster Aufruf in main()
+ */
+void Boot_Init(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;    // unlock key, required on the M7 without a debugger attached
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	Boot_LastCycle = 0;
+	Boot_Us = 0;
+	Boot_MarkCount = 0;
+}
+
+/**
+ * @brief  Setzt einen Zeitstempel hinter einen Abschnitt des Starts
+ * @param  name: konstanter String, wird nicht kopiert
+ */
+void Boot_MarkPhase(const char *name) {
+	Boot_Add(name, Boot_LastMarkUs(), 0);
+}
+
+/**
+ * @brief  Das erste Bild ist auf dem Display (nach der letzten Übertragung aufrufen)
+ */
+void Boot_FirstPixel(void) {
+	Boot_Add("first pixel", Boot_LastMarkUs(), 0);
+	Boot_FirstPixelUs = Boot_Us;
+}
+
+/**
+ * @brief  Der Scheduler übernimmt, direkt vor der Hauptschleife aufrufen
+ */
+void Boot_Interactive(void) {
+	Boot_Add("interactive", Boot_LastMarkUs(), 0);
+	Boot_InteractiveUs = Boot_Us;
+}
+
+/**
+ * @brief  Meldet eine Initialisierung an, die erst nach dem Start des Schedulers läuft
+ * @param  name: konstanter String für den Bericht
+ * @param  function: Initialisierung, liefert 1 bei Erfolg
+ * @retval 1 bei Erfolg, 0 wenn die Tabelle voll ist (dann läuft die Funktion sofort)
+ */
+uint8_t Boot_Defer(const char *name, Boot_StageFunction function) {
+	if (Boot_StageCount >= BOOT_MAX_STAGES) {
+		uint32_t start = Boot_Now();
+		uint8_t failed = !function();
+		Boot_Failed += failed;
+		Boot_Add(name, start, failed);
+		return 0;
+	}
+
+	Boot_Stages[Boot_StageCount].name = name;
+	Boot_Stages[Boot_StageCount].function = function;
+	Boot_StageCount++;
+	return 1;
+}
+
+/**
+ * @brief  Übergibt die angemeldeten Initialisierungen an den Boot-Task
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der Boot_Task() aufruft
+ */
+void Boot_Start(uint8_t taskId) {
+	Boot_TaskId = taskId;
+	Scheduler_SetEnabled(taskId, Boot_NextStage < Boot_StageCount);
+}
+
+/**
+ * @brief  Task: eine verschobene Initialisierung je Aufruf, danach Bericht und Task aus
+ */
+void Boot_Task(void *context) {
+	Boot_RunStage();
+
+	if (Boot_NextStage >= Boot_StageCount) {
+		Scheduler_SetEnabled(Boot_TaskId, 0);
+		Boot_Report();
+		WarmBoot_Confirm();
+	}
+}
+
+/**
+ * @brief  Führt alle noch ausstehenden Initialisierungen sofort aus (z.B. vor einer Messreihe)
+ */
+void Boot_RunDeferred(void) {
+	while (Boot_NextStage < Boot_StageCount) {
+		Boot_RunStage();
+	}
+	Scheduler_SetEnabled(Boot_TaskId, 0);
+	WarmBoot_Confirm();
+}
+
+/**
+ * @brief  Kopiert die Kennzahlen
+ */
+void Boot_GetStats(Boot_Stats *stats) {
+	stats->firstPixelUs = Boot_FirstPixelUs;
+	stats->interactiveUs = Boot_InteractiveUs;
+	stats->completeUs = Boot_CompleteUs;
+	stats->marks = Boot_MarkCount;
+	stats->pending = Boot_StageCount - Boot_NextStage;
+	stats->failed = Boot_Failed;
+}
+
+/**
+ * @brief  Liefert einen Zeitstempel in der Reihenfolge des Starts, NULL hinter dem letzten
+ */
+const Boot_Mark* Boot_GetMark(uint8_t index) {
+	return index < Boot_MarkCount ? &Boot_Marks[index] : NULL;
+}
+
+/**
+ * @brief  Gibt alle Zeitstempel mit der Dauer ihres Abschnitts und die Kennzahlen aus
+ */
+void Boot_Report(void) {
+	printf("\nStart bei %lu MHz\n", SystemCoreClock / 1000000UL);
+	printf("%-14s %10s %10s\n", "Abschnitt", "Dauer [us]", "ab Reset");
+	for (uint8_t i = 0; i < Boot_MarkCount; i++) {
+		const Boot_Mark *mark = &Boot_Marks[i];
+		printf("%-14s %10lu %10lu%s\n", mark->name, mark->durationUs, mark->us,
+				mark->failed ? "  FEHLER" : "");
+	}
+	printf("Erstes Bild %lu us, bedienbar %lu us, fertig %lu us, %u offen, %u fehlgeschlagen\n",
+			Boot_FirstPixelUs, Boot_InteractiveUs, Boot_CompleteUs,
+			(unsigned)(Boot_StageCount - Boot_NextStage), Boot_Failed);
+}
+
+/**
+ * @brief  Aktualisiert die Zeit seit Boot_Init() mit dem aktuellen Kerntakt
+ */
+static uint32_t Boot_Now(void) {
+	uint32_t cycle = DWT->CYCCNT;
+	uint32_t mhz = SystemCoreClock / 1000000UL;
+
+	Boot_Us += (cycle - Boot_LastCycle) / (mhz ? mhz : 1);
+	Boot_LastCycle = cycle;
+	return Boot_Us;
+}
+
+static void Boot_Add(const char *name, uint32_t startUs, uint8_t failed) {
+	uint32_t now = Boot_Now();
+
+	if (Boot_MarkCount >= BOOT_MAX_MARKS)
+		return;
+
+	Boot_Marks[Boot_MarkCount].name = name;
+	Boot_Marks[Boot_MarkCount].us = now;
+	Boot_Marks[Boot_MarkCount].durationUs = now - startUs;
+	Boot_Marks[Boot_MarkCount].failed = failed;
+	Boot_MarkCount++;
+}
+
+/**
+ * @brief  Führt die nächste angemeldete Initialisierung aus und setzt ihren Zeitstempel
+ */
+static void Boot_RunStage(void) {
+	if (Boot_NextStage >= Boot_StageCount)
+		return;
+
+	// The time since the last mark belongs to the other tasks, each stage gets only its own
+	uint32_t start = Boot_Now();
+	const Boot_Stage *stage = &Boot_Stages[Boot_NextStage++];
+	uint8_t failed = !stage->function();
+	Boot_Failed += failed;
+	Boot_Add(stage->name, start, failed);
+
+	if (Boot_NextStage >= Boot_StageCount) {
+		Boot_CompleteUs = Boot_Us;
+	}
+}
+
+static uint32_t Boot_LastMarkUs(void) {
+	return Boot_MarkCount > 0 ? Boot_Marks[Boot_MarkCount - 1].us : 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file    BusFast.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Kurze SPI- und I2C-Schreibzugriffe über die LL-Register, ohne Zustandsmaschine der HAL
+ *
+ * Ein einzelnes Befehlsbyte kostet über HAL_SPI_Transmit() bzw. HAL_I2C_Mem_Write() mehr Zeit
+ * in Lock, Zustandsprüfungen und HAL_GetTick() als auf dem Bus. Die Befehle von ILI9341,
+ * MAX7219 und SSD1306 gehen deshalb hier direkt an die Register: dieselbe Konfiguration, die
+ * die HAL für eine blockierende Übertragung setzt (SPI: Simplex-Senden, TSIZE, CSTART; I2C:
+ * AUTOEND mit Kontrollbyte vorneweg), gewartet wird auf die Flags mit DWT als Zeitbasis.
+ *
+ * Mit dem DMA-Weg der HAL bleibt das verträglich:
+ * - Nur wenn das Handle im Zustand READY ist, also keine DMA- oder Interrupt-Übertragung
+ *   läuft, und nur bis BUSFAST_SPI_MAX_FRAMES bzw. BUSFAST_I2C_MAX_BYTES; sonst übernimmt wie
+ *   bisher die HAL (und meldet ggf. HAL_BUSY).
+ * - Danach steht die Peripherie so, wie sie die HAL nach einem Transfer hinterlässt: SPI
+ *   abgeschaltet, Flags gelöscht; beim I2C CR2 zurückgesetzt und TXDR geleert.
+ * - Der I2C-Zugriff belegt vorher die Warteschlange (I2CBus_Claim()), in der Zeit eingereihte
+ *   Transaktionen starten mit I2CBus_Release().
+ * Die Handles selbst (State, Lock) werden nicht angefasst.
+ */
+
+#include "BusFast.h"
+
+#if BUSFAST_ENABLE
+
+#include "stm32h7xx_ll_spi.h"
+#include "stm32h7xx_ll_i2c.h"
+
+/* Obergrenze der Wartezeit; die Übertragungen sind kurz, HAL_MAX_DELAY würde im Zähler überlaufen */
+#define BUSFAST_TIMEOUT_MAX_MS    1000
+
+static uint32_t BusFast_Cycles(uint32_t timeoutMs);
+static HAL_StatusTypeDef BusFast_I2CWaitTxis(I2C_TypeDef *i2c, uint32_t start, uint32_t limit);
+
+/**
+ * @brief  Sendet wenige Frames blockierend, wie HAL_SPI_Transmit()
+ * @param  data: count Frames in der Breite des Handles (8 oder 16 Bit)
+ * @note   CS und D/C setzt der Aufrufer; Hardware-NSS erzeugt die SPI selbst
+ */
+RAMFUNC HAL_StatusTypeDef BusFast_SpiWrite(SPI_HandleTypeDef *hspi, const void *data, uint16_t count, uint32_t timeoutMs) {
+	SPI_TypeDef *spi = hspi->Instance;
+
+	if (count == 0 || count > BUSFAST_SPI_MAX_FRAMES || hspi->Init.DataSize > SPI_DATASIZE_16BIT ||
+			hspi->State != HAL_SPI_STATE_READY || hspi->Lock == HAL_LOCKED) {
+		return HAL_SPI_Transmit(hspi, (uint8_t *)data, count, timeoutMs);
+	}
+
+	const uint8_t *bytes = data;
+	const uint16_t *frames = data;
+	uint8_t wide = hspi->Init.DataSize > SPI_DATASIZE_8BIT;
+	uint32_t limit = BusFast_Cycles(timeoutMs);
+	uint32_t start = DWT->CYCCNT;
+
+	// CFG2 is only writable while the SPI is off; the HAL leaves it off after every transfer
+	LL_SPI_Disable(spi);
+	LL_SPI_SetTransferDirection(spi, LL_SPI_SIMPLEX_TX);
+	LL_SPI_SetTransferSize(spi, count);
+	LL_SPI_Enable(spi);
+	LL_SPI_StartMasterTransfer(spi);
+
+	for (uint16_t i = 0; i < count; i++) {
+		while (!LL_SPI_IsActiveFlag_TXP(spi)) {
+			if (DWT->CYCCNT - start > limit) goto timeout;
+		}
+		if (wide) {
+			LL_SPI_TransmitData16(spi, frames[i]);
+		} else {
+			LL_SPI_TransmitData8(spi, bytes[i]);
+		}
+	}
+	while (!LL_SPI_IsActiveFlag_EOT(spi)) {
+		if (DWT->CYCCNT - start > limit) goto timeout;
+	}
+
+	LL_SPI_ClearFlag_EOT(spi);
+	LL_SPI_ClearFlag_TXTF(spi);
+	LL_SPI_Disable(spi);
+	return HAL_OK;
+
+timeout:
+	LL_SPI_ClearFlag_EOT(spi);
+	LL_SPI_ClearFlag_TXTF(spi);
+	LL_SPI_Disable(spi);
+	hspi->ErrorCode |= HAL_SPI_ERROR_TIMEOUT;
+	return HAL_TIMEOUT;
+}
+
+/**
+ * @brief  Sendet Kontrollbyte und wenige Daten blockierend, wie HAL_I2C_Mem_Write() mit 8-Bit-Register
+ * @param  address: 8-Bit-Adresse (7-Bit-Adresse << 1)
+ * @retval HAL_BUSY, wenn auf dem Bus noch eine Transaktion läuft oder wartet
+ */
+HAL_StatusTypeDef BusFast_I2CMemWrite(I2CBus *bus, uint16_t address, uint8_t reg, const uint8_t *data,
+		uint16_t length, uint32_t timeoutMs) {
+	I2C_HandleTypeDef *hi2c = bus->hi2c;
+	I2C_TypeDef *i2c = hi2c->Instance;
+
+	if (length + 1U > BUSFAST_I2C_MAX_BYTES) {
+		return HAL_I2C_Mem_Write(hi2c, address, reg, I2C_MEMADD_SIZE_8BIT, (uint8_t *)data, length, timeoutMs);
+	}
+	if (!I2CBus_Claim(bus)) {
+		return HAL_BUSY;
+	}
+	if (hi2c->State != HAL_I2C_STATE_READY || LL_I2C_IsActiveFlag_BUSY(i2c)) {
+		I2CBus_Release(bus);
+		return HAL_BUSY;
+	}
+
+	uint32_t limit = BusFast_Cycles(timeoutMs);
+	uint32_t start = DWT->CYCCNT;
+	HAL_StatusTypeDef status = HAL_OK;
+
+	// STOP follows the last byte by itself, also after a NACK
+	LL_I2C_HandleTransfer(i2c, address, LL_I2C_ADDRSLAVE_7BIT, length + 1U, LL_I2C_MODE_AUTOEND,
+			LL_I2C_GENERATE_START_WRITE);
+
+	for (uint16_t i = 0; i <= length && status == HAL_OK; i++) {
+		status = BusFast_I2CWaitTxis(i2c, start, limit);
+		if (status == HAL_OK) {
+			LL_I2C_TransmitData8(i2c, i == 0 ? reg : data[i - 1]);
+		}
+	}
+	while (status != HAL_TIMEOUT && !LL_I2C_IsActiveFlag_STOP(i2c)) {
+		if (DWT->CYCCNT - start > limit) status = HAL_TIMEOUT;
+	}
+	if (LL_I2C_IsActiveFlag_NACK(i2c)) {
+		LL_I2C_ClearFlag_NACK(i2c);
+		hi2c->ErrorCode |= HAL_I2C_ERROR_AF;
+		if (status == HAL_OK) status = HAL_ERROR;
+	}
+	if (status == HAL_TIMEOUT) {
+		hi2c->ErrorCode |= HAL_I2C_ERROR_TIMEOUT;
+	}
+
+	// Leave the peripheral as I2C_Flush_TXDR() and I2C_RESET_CR2() do after a HAL transfer
+	LL_I2C_ClearFlag_STOP(i2c);
+	LL_I2C_ClearFlag_TXE(i2c);
+	CLEAR_BIT(i2c->CR2, I2C_CR2_SADD | I2C_CR2_HEAD10R | I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_RD_WRN);
+
+	I2CBus_Release(bus);
+	return status;
+}
+
+/**
+ * @brief  Wartezeit in CPU-Takten für die DWT-Schleifen
+ */
+static uint32_t BusFast_Cycles(uint32_t timeoutMs) {
+	if (timeoutMs > BUSFAST_TIMEOUT_MAX_MS) {
+		timeoutMs = BUSFAST_TIMEOUT_MAX_MS;
+	}
+	return timeoutMs * (SystemCoreClock / 1000UL);
+}
+
+/**
+ * @brief  Wartet, bis TXDR das nächste Byte annimmt
+ * @retval HAL_ERROR bei NACK, HAL_TIMEOUT nach Ablauf der Zeit
+ */
+static HAL_StatusTypeDef BusFast_I2CWaitTxis(I2C_TypeDef *i2c, uint32_t start, uint32_t limit) {
+	while (!LL_I2C_IsActiveFlag_TXIS(i2c)) {
+		if (LL_I2C_IsActiveFlag_NACK(i2c)) return HAL_ERROR;
+		if (DWT->CYCCNT - start > limit) return HAL_TIMEOUT;
+	}
+	return HAL_OK;
+}
+
+#endif /* BUSFAST_ENABLE */
@@ -0,0 +1,132 @@
+/**
+ * @file    BusQos.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   QoS-Stufen der Initiatoren am AXI-Interconnect (GPV-Register)
+ *
+ * SPI1-DMA, SDMMC1-IDMA, MDMA, DMA2D und die CPU greifen gleichzeitig auf den AXI-SRAM zu
+ * (Framebuffer, Asset-Cache, SD-Puffer). Nach dem Reset stehen alle Initiatoren auf QoS 0, der
+ * Interconnect wechselt dann reihum, und eine lange SD-Übertragung bekommt so viele Takte wie die
+ * Display-DMA. Jeder ASIB hat im GPV ein Lese- und ein Schreibregister (READ_QOS, WRITE_QOS,
+ * Bits 3:0); beim Zugriff mehrerer Initiatoren auf dasselbe Ziel gewinnt die höhere Stufe, bei
+ * gleicher Stufe bleibt es beim Wechsel.
+ *
+ * BusQos_Default setzt die Brücke der AHB-Matrix (INI1) nach oben: über sie lesen die SPI1-DMA den
+ * Framebuffer und schreiben die ADC1-DMA und die UARTs, beides bricht ab bzw. läuft über, wenn es zu
+ * lange wartet. Die SD-Karte (INI3) kommt zuletzt, ihr FIFO hält die Karte an, statt Daten zu
+ * verlieren. Die ADC-Blöcke selbst liegen im RAM_CD (DMA_BUFFER) und erreichen den AXI-Bus nicht;
+ * die Stufe wirkt für sie nur, wenn ein Verbraucher sie in den AXI-SRAM kopiert oder ein Puffer
+ * dorthin verlegt wird.
+ *
+ * main() ruft BusQos_Init() direkt nach Irq_Init() auf, bevor der erste DMA-Transfer startet. Die
+ * Shell ('qos') zeigt und ändert die Stufen im Betrieb, das Ziel bus_bench vergleicht BusQos_Flat
+ * mit BusQos_Default unter gleichzeitiger Last aller Master.
+ */
+
+#include "BusQos.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Registerpaar eines Initiators im GPV
+ */
+typedef struct {
+	const char *name;
+	volatile uint32_t *read;
+	volatile uint32_t *write;
+} BusQos_Port;
+
+static const BusQos_Port BusQos_Ports[BUSQOS_INI_COUNT] = {
+	[BUSQOS_INI_AHB]    = { "ahb",    &GPV->AXI_INI1_READ_QOS, &GPV->AXI_INI1_WRITE_QOS },
+	[BUSQOS_INI_CPU]    = { "cpu",    &GPV->AXI_INI2_READ_QOS, &GPV->AXI_INI2_WRITE_QOS },
+	[BUSQOS_INI_SDMMC1] = { "sdmmc1", &GPV->AXI_INI3_READ_QOS, &GPV->AXI_INI3_WRITE_QOS },
+	[BUSQOS_INI_MDMA]   = { "mdma",   &GPV->AXI_INI4_READ_QOS, &GPV->AXI_INI4_WRITE_QOS },
+	[BUSQOS_INI_DMA2D]  = { "dma2d",  &GPV->AXI_INI5_READ_QOS, &GPV->AXI_INI5_WRITE_QOS },
+	[BUSQOS_INI_LTDC]   = { "ltdc",   &GPV->AXI_INI6_READ_QOS, &GPV->AXI_INI6_WRITE_QOS },
+	[BUSQOS_INI_AHB2]   = { "ahb2",   &GPV->AXI_INI7_READ_QOS, &GPV->AXI_INI7_WRITE_QOS },
+};
+
+const BusQos_Level BusQos_Default[BUSQOS_INI_COUNT] = {
+	[BUSQOS_INI_AHB]    = { 14, 14 },     // display refresh and ADC/UART DMA
+	[BUSQOS_INI_CPU]    = { 10, 10 },
+	[BUSQOS_INI_SDMMC1] = {  2,  2 },     // bulk, the card waits on a full FIFO
+	[BUSQOS_INI_MDMA]   = {  8,  8 },
+	[BUSQOS_INI_DMA2D]  = {  8,  8 },
+	[BUSQOS_INI_LTDC]   = {  0,  0 },
+	[BUSQOS_INI_AHB2]   = {  0,  0 },
+};
+
+const BusQos_Level BusQos_Flat[BUSQOS_INI_COUNT] = { { 0, 0 } };
+
+/**
+ * @brief  Setzt den Plan BusQos_Default, vor dem ersten DMA-Transfer aufrufen
+ */
+void BusQos_Init(void) {
+	BusQos_Apply(BusQos_Default);
+}
+
+/**
+ * @brief  Setzt die Stufen aller Initiatoren
+ * @param  plan: BUSQOS_INI_COUNT Einträge in der Reihenfolge von BusQos_Initiator
+ */
+void BusQos_Apply(const BusQos_Level *plan) {
+	for (uint8_t i = 0; i < BUSQOS_INI_COUNT; i++)
+		BusQos_Set((BusQos_Initiator)i, plan[i].read, plan[i].write);
+}
+
+/**
+ * @brief  Setzt Lese- und Schreibstufe eines Initiators, Werte über BUSQOS_MAX werden begrenzt
+ *
+ * Wirkt ab der nächsten Arbitrierung, laufende Bursts werden nicht unterbrochen.
+ */
+void BusQos_Set(BusQos_Initiator initiator, uint8_t read, uint8_t write) {
+	if (initiator >= BUSQOS_INI_COUNT)
+		return;
+
+	*BusQos_Ports[initiator].read = read > BUSQOS_MAX ? BUSQOS_MAX : read;
+	*BusQos_Ports[initiator].write = write > BUSQOS_MAX ? BUSQOS_MAX : write;
+	__DSB();
+}
+
+/**
+ * @brief  Liest die Stufen eines Initiators aus dem GPV zurück
+ */
+BusQos_Level BusQos_Get(BusQos_Initiator initiator) {
+	BusQos_Level level = { 0, 0 };
+
+	if (initiator < BUSQOS_INI_COUNT) {
+		level.read = (uint8_t)(*BusQos_Ports[initiator].read & BUSQOS_MAX);
+		level.write = (uint8_t)(*BusQos_Ports[initiator].write & BUSQOS_MAX);
+	}
+	return level;
+}
+
+const char* BusQos_Name(BusQos_Initiator initiator) {
+	return initiator < BUSQOS_INI_COUNT ? BusQos_Ports[initiator].name : "?";
+}
+
+/**
+ * @brief  Sucht einen Initiator über seinen Kurznamen (z.B. "sdmmc1")
+ * @retval Index in BusQos_Initiator oder -1
+ */
+int8_t BusQos_Find(const char *name) {
+	for (uint8_t i = 0; i < BUSQOS_INI_COUNT; i++) {
+		if (strcmp(name, BusQos_Ports[i].name) == 0)
+			return (int8_t)i;
+	}
+	return -1;
+}
+
+/**
+ * @brief  Gibt die aktuellen Stufen und den Plan BusQos_Default aus
+ */
+void BusQos_Dump(void) {
+	printf("%-7s %4s %5s %9s\n", "INI", "Lesen", "Schr.", "Standard");
+	for (uint8_t i = 0; i < BUSQOS_INI_COUNT; i++) {
+		BusQos_Level level = BusQos_Get((BusQos_Initiator)i);
+
+		printf("%-7s %5u %5u %5u/%u\n", BusQos_Ports[i].name, level.read, level.write,
+				BusQos_Default[i].read, BusQos_Default[i].write);
+	}
+}
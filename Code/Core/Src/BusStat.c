@@ -0,0 +1,144 @@
+/**
+ * @file    BusStat.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Zähler für den SPI- und I2C-Verkehr von ILI9341, LED-Matrix, SSD1306 und AHT20
+ *
+ * Die Treiber umschließen jeden HAL-Aufruf mit BUSSTAT_CALL() (blockierend) bzw. zählen
+ * DMA-/Interrupt-Starts mit BUSSTAT_ASYNC(). Je Gerät entstehen Transaktionen und Bytes getrennt
+ * nach Befehl und Daten sowie die Zeit, die die CPU in blockierenden Aufrufen und beim Warten auf
+ * DMA verbringt (DWT-Takte, eingeschaltet von Prof_Init()).
+ *
+ * Gezählt wird aus der Hauptschleife und aus Interrupts (nächster DMA-Block im
+ * Completion-Callback), jeder Eintrag sperrt deshalb kurz die Interrupts. BusStat_Snapshot()
+ * kopiert alle Zähler in einem Stück, die Shell ('bus') und die Benchmark-Ziele lesen nur über
+ * diese Kopie.
+ *
+ * Mit BUSSTAT_ENABLE 0 werden die Makros zu den nackten HAL-Aufrufen und diese Datei übersetzt
+ * nichts.
+ */
+
+#include "BusStat.h"
+
+#if BUSSTAT_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+
+static BusStat_Counter BusStat_Counters[BUSSTAT_ID_COUNT];
+
+static const char *const BusStat_Names[BUSSTAT_ID_COUNT] = {
+	[BUSSTAT_ID_ILI9341]    = "ILI9341",
+	[BUSSTAT_ID_LED_MATRIX] = "LED_Matrix",
+	[BUSSTAT_ID_SSD1306]    = "SSD1306",
+	[BUSSTAT_ID_AHT20]      = "AHT20",
+};
+
+static uint32_t BusStat_CyclesToUs(uint64_t cycles);
+
+/**
+ * @brief  Trägt einen blockierenden Aufruf ein, wird von BUSSTAT_CALL() aufgerufen
+ * @param  id: Gerät
+ * @param  kind: Befehl oder Daten
+ * @param  bytes: übertragene Bytes (bei 16-Bit-Frames also doppelt so viele wie Frames)
+ * @param  cycles: Dauer des Aufrufs in CPU-Takten
+ */
+RAMFUNC void BusStat_Record(BusStat_Id id, BusStat_Kind kind, uint32_t bytes, uint32_t cycles) {
+	BusStat_Counter *c = &BusStat_Counters[id];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	c->transactions[kind]++;
+	c->bytes[kind] += bytes;
+	c->blockCycles += cycles;
+	if (cycles > c->blockMax) c->blockMax = cycles;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Trägt eine gestartete DMA- bzw. Interrupt-Übertragung ein
+ */
+RAMFUNC void BusStat_RecordAsync(BusStat_Id id, BusStat_Kind kind, uint32_t bytes) {
+	BusStat_Counter *c = &BusStat_Counters[id];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	c->transactions[kind]++;
+	c->bytes[kind] += bytes;
+	c->async++;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Trägt die Zeit ein, die auf das Ende einer asynchronen Übertragung gewartet wurde
+ */
+void BusStat_RecordWait(BusStat_Id id, uint32_t cycles) {
+	BusStat_Counter *c = &BusStat_Counters[id];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	c->blockCycles += cycles;
+	if (cycles > c->blockMax) c->blockMax = cycles;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Kopiert die Zähler aller Geräte
+ * @param  counters: Ziel mit BUSSTAT_ID_COUNT Einträgen
+ */
+void BusStat_Snapshot(BusStat_Counter *counters) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	memcpy(counters, BusStat_Counters, sizeof(BusStat_Counters));
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Setzt die Zähler aller Geräte zurück
+ */
+void BusStat_Reset(void) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	memset(BusStat_Counters, 0, sizeof(BusStat_Counters));
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt alle Zähler als Tabelle über printf aus
+ */
+void BusStat_Dump(void) {
+	BusStat_Counter counters[BUSSTAT_ID_COUNT];
+
+	BusStat_Snapshot(counters);
+
+	printf("\nBusverkehr bei %lu MHz\n", SystemCoreClock / 1000000UL);
+	printf("%-10s %8s %10s %8s %10s %6s %10s %8s\n", "Gerät", "Befehle", "Bytes", "Daten", "Bytes",
+			"DMA", "Block [us]", "max");
+
+	for (uint8_t i = 0; i < BUSSTAT_ID_COUNT; i++) {
+		BusStat_Counter *c = &counters[i];
+
+		printf("%-10s %8lu %10lu %8lu %10lu %6lu %10lu %8lu\n", BusStat_Names[i],
+				c->transactions[BUSSTAT_COMMAND], (uint32_t)c->bytes[BUSSTAT_COMMAND],
+				c->transactions[BUSSTAT_DATA], (uint32_t)c->bytes[BUSSTAT_DATA], c->async,
+				BusStat_CyclesToUs(c->blockCycles), BusStat_CyclesToUs(c->blockMax));
+	}
+}
+
+/**
+ * @brief  Name eines Geräts für Ausgaben (Shell, Benchmarks)
+ */
+const char* BusStat_Name(BusStat_Id id) {
+	return id < BUSSTAT_ID_COUNT ? BusStat_Names[id] : "?";
+}
+
+/**
+ * @brief  Rechnet Takte in Mikrosekunden um
+ */
+static uint32_t BusStat_CyclesToUs(uint64_t cycles) {
+	return (uint32_t)(cycles / (SystemCoreClock / 1000000UL));
+}
+
+#endif /* BUSSTAT_ENABLE */
@@ -0,0 +1,100 @@
+/**
+ * @file    Cache.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Cache-Pflege für DMA-Puffer im cachebaren Speicher
+ *
+ * main() schaltet I-Cache und D-Cache ein. AXI-SRAM, interner Flash und das
+ * Memory-Mapped-Fenster des W25Qxx sind damit cachebar (Write-Back im SRAM): Was die CPU
+ * schreibt, steht zunächst nur im Cache, und was ein DMA-Controller schreibt, sieht die
+ * CPU erst nach dem Verwerfen der betroffenen Cache-Zeilen.
+ *
+ * Es gibt deshalb zwei Wege für DMA-Puffer:
+ * 1. DMA_BUFFER: Der Puffer liegt in RAM_CD, das die MPU als nicht cachebar markiert.
+ *    Keine Pflege nötig; gedacht für DMA1/DMA2 (SPI1, TIM1). BDMA_BUFFER ist dasselbe
+ *    in SRD SRAM für den BDMA2 (LPUART1).
+ * 2. Cachebarer Speicher (Framebuffer, SD-Puffer, beliebige Aufruferpuffer): vor einem
+ *    Transfer, der aus dem Speicher liest, Cache_CleanDMA(); vor und nach einem Transfer,
+ *    der in den Speicher schreibt, Cache_InvalidateDMA(). Solche Puffer sollten auf
+ *    CACHE_LINE_SIZE ausgerichtet sein und ganze Cache-Zeilen belegen, sonst verwirft
+ *    Invalidate auch Nachbarvariablen in derselben Zeile.
+ *
+ * SDMMC1 (IDMA) arbeitet weiter aus dem AXI-SRAM mit Cache-Pflege in sd_diskio.c.
+ */
+
+#include "Cache.h"
+
+static uint8_t Cache_Range(const void *data, uint32_t size, uint32_t **start, int32_t *length);
+
+/**
+ * @brief  Prüft, ob eine Adresse im nicht cachebaren DMA-Bereich liegt
+ */
+uint8_t Cache_IsDMABuffer(const void *address) {
+	return (uintptr_t)address - CACHE_DMA_REGION_BASE < CACHE_DMA_REGION_SIZE
+			|| (uintptr_t)address - CACHE_BDMA_REGION_BASE < CACHE_BDMA_REGION_SIZE;
+}
+
+/**
+ * @brief  Schreibt gecachte Daten eines Puffers in den Speicher, bevor DMA ihn liest
+ * @param  data: Anfang des Puffers
+ * @param  size: Länge in Bytes
+ */
+void Cache_CleanDMA(const void *data, uint32_t size) {
+	uint32_t *start;
+	int32_t length;
+
+	if (!Cache_Range(data, size, &start, &length))
+		return;
+
+	// Beyond the cache size a full clean visits fewer lines than the address loop
+	if ((uint32_t)length > CACHE_DCACHE_SIZE)
+		SCB_CleanDCache();
+	else
+		SCB_CleanDCache_by_Addr(start, length);
+}
+
+/**
+ * @brief  Verwirft Cache-Zeilen eines Puffers, in den DMA schreibt (vor und nach dem Transfer)
+ * @param  data: Anfang des Puffers, möglichst CACHE_LINE_SIZE-ausgerichtet
+ * @param  size: Länge in Bytes
+ */
+void Cache_InvalidateDMA(void *data, uint32_t size) {
+	uint32_t *start;
+	int32_t length;
+
+	if (Cache_Range(data, size, &start, &length))
+		SCB_InvalidateDCache_by_Addr(start, length);
+}
+
+/**
+ * @brief  Schreibt gecachte Daten zurück und verwirft die Zeilen (Puffer, die DMA liest und schreibt)
+ * @param  data: Anfang des Puffers
+ * @param  size: Länge in Bytes
+ */
+void Cache_CleanInvalidateDMA(void *data, uint32_t size) {
+	uint32_t *start;
+	int32_t length;
+
+	if (!Cache_Range(data, size, &start, &length))
+		return;
+
+	if ((uint32_t)length > CACHE_DCACHE_SIZE)
+		SCB_CleanInvalidateDCache();
+	else
+		SCB_CleanInvalidateDCache_by_Addr(start, length);
+}
+
+/**
+ * @brief  Erweitert einen Puffer auf ganze Cache-Zeilen
+ * @retval 0, wenn keine Pflege nötig ist (D-Cache aus, leer oder im DMA-Bereich)
+ */
+static uint8_t Cache_Range(const void *data, uint32_t size, uint32_t **start, int32_t *length) {
+	uintptr_t first = (uintptr_t)data & ~(uintptr_t)(CACHE_LINE_SIZE - 1UL);
+
+	if (size == 0 || !(SCB->CCR & SCB_CCR_DC_Msk) || Cache_IsDMABuffer(data))
+		return 0;
+
+	*start = (uint32_t*)first;
+	*length = (int32_t)((uintptr_t)data + size - first);
+	return 1;
+}
@@ -0,0 +1,601 @@
+/**
+ * @file    Can.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   CAN-/CAN-FD-Treiber für FDCAN1: Hardwarefilter, Empfang per Interrupt, Sendewarteschlange
+ *
+ * MX_FDCAN1_Init() (CubeMX) legt Bitraten und Message RAM fest. Der Kerneltakt kommt von PLL2Q
+ * (64 MHz vom HSI) und ist damit vom Taktprofil unabhängig:
+ * - Arbitrierung 500 kbit/s: Vorteiler 2, 64 Zeitquanten, Abtastpunkt 81,25 %
+ * - Datenphase 2 Mbit/s (mit BRS): Vorteiler 1, 32 Zeitquanten, Abtastpunkt 75 %, mit
+ *   Transceiver Delay Compensation
+ * Message RAM (Elemente mit 64 Bytes Nutzlast, zusammen ca. 3 KB von 10 KB):
+ * 8 Standard- und 4 Extended-Filter, RX-FIFO 0 mit 16 und RX-FIFO 1 mit 8 Elementen, TX-FIFO
+ * mit 16 Elementen.
+ *
+ * Can_Init() stellt den globalen Filter so ein, dass alles ohne passenden Filter und alle
+ * Remote-Rahmen schon in der Hardware verworfen werden; die CPU sieht nur IDs, die mit
+ * Can_AddFilter() eingetragen sind. Der Interrupt (FDCAN1_IT0) leert beide RX-FIFOs in eine
+ * Warteschlange (ein Schreiber im Interrupt, ein Leser in der Hauptschleife, ohne Sperre),
+ * Can_Receive() holt daraus ab.
+ *
+ * Can_Send() schreibt direkt in den TX-FIFO der Hardware, solange dort Platz ist und nichts
+ * wartet; sonst kommt der Rahmen in die Sendewarteschlange, die der Interrupt nach jeder
+ * fertigen Übertragung nachfüllt. Die Reihenfolge bleibt dabei erhalten.
+ *
+ * Für Massendaten (CanTp.c) gibt es einen Weg ohne Kopie über FDCAN_RxHeaderTypeDef und
+ * Zwischenpuffer: Mit Can_SetFifo1Handler() gehen die Rahmen aus RX-FIFO 1 nicht in die
+ * Warteschlange, der Empfänger bekommt im Interrupt einen Zeiger direkt in das Element im
+ * Message RAM. Can_SendDirect() schreibt Kopf und Nutzdaten aus zwei getrennten Quellen
+ * wortweise direkt in das nächste freie Element des TX-FIFO, ohne Can_Message dazwischen. Das
+ * Message RAM verträgt beim Schreiben nur 32-Bit-Zugriffe; gelesen wird auch byteweise.
+ *
+ * Für den Mitschnitt (SensorLog.c) nimmt Can_SetCapture() zusätzlich alle Rahmen ohne passenden
+ * Filter in RX-FIFO 0 an und reicht jeden Rahmen beider FIFOs im Interrupt an den Empfänger.
+ * Angenommene Rahmen ohne Filter gehen nicht in die Warteschlange. Die Zeit jedes Rahmens kommt
+ * aus dem Zeitstempelzähler der Hardware (16 Bit in Bitzeiten der Arbitrierung, läuft bei 500 kbit/s
+ * nach 131 ms über): der Interrupt liest Zähler und Timebase_Us32() einmal und rechnet das Alter
+ * jedes Rahmens zurück, die Latenz des Interrupts fällt so aus der Zeit heraus.
+ *
+ * Nach Bus-Off setzt Can_ErrorStatusCallback() die Wiederanlaufsequenz in Gang (129 x 11
+ * rezessive Bits), danach geht es ohne Zutun weiter.
+ *
+ * Die HAL-Callbacks in main.c leiten an Can_RxFifo0Callback(), Can_RxFifo1Callback(),
+ * Can_TxBufferCompleteCallback() und Can_ErrorStatusCallback() weiter.
+ */
+
+#include "Can.h"
+#include "Timebase.h"
+#include <string.h>
+
+#if (CAN_RX_QUEUE_SIZE & (CAN_RX_QUEUE_SIZE - 1)) != 0 || (CAN_TX_QUEUE_SIZE & (CAN_TX_QUEUE_SIZE - 1)) != 0
+#error "CAN_RX_QUEUE_SIZE und CAN_TX_QUEUE_SIZE müssen Zweierpotenzen sein!"
+#endif
+
+/* Alle Elemente des TX-FIFO (TxFifoQueueElmtsNbr in MX_FDCAN1_Init()) melden ihren Abschluss */
+#define CAN_TX_BUFFERS_ALL        0xFFFFUL
+
+/* Bits der ersten beiden Worte eines RX-/TX-Elements im Message RAM (RM0455, FDCAN) */
+#define CAN_ELEMENT_XTD           (1UL << 30)
+#define CAN_ELEMENT_RTR           (1UL << 29)
+#define CAN_ELEMENT_STDID_Pos     18U
+#define CAN_ELEMENT_EXTID_Msk     0x1FFFFFFFUL
+#define CAN_ELEMENT_FDF           (1UL << 21)
+#define CAN_ELEMENT_BRS           (1UL << 20)
+#define CAN_ELEMENT_DLC_Pos       16U
+
+static FDCAN_HandleTypeDef *Can_Handle = NULL;
+static Can_Stats Can_Counters;
+
+static Can_Message Can_RxQueue[CAN_RX_QUEUE_SIZE];
+static volatile uint32_t Can_RxHead = 0;          // written by the interrupt
+static volatile uint32_t Can_RxTail = 0;          // written by Can_Receive()
+
+static Can_Message Can_TxQueue[CAN_TX_QUEUE_SIZE];
+static uint32_t Can_TxHead = 0;                   // both only changed with interrupts off
+static uint32_t Can_TxTail = 0;
+
+static Can_Message Can_RxDiscard;                 // target for frames that find the queue full
+
+static Can_FrameHandler Can_Fifo1Handler = NULL;
+static void *Can_Fifo1Context = NULL;
+
+static Can_CaptureHandler Can_Capture = NULL;
+static void *Can_CaptureContext = NULL;
+static uint32_t Can_TickNs = 0;                   // one timestamp count (nominal bit time)
+static uint32_t Can_CaptureUs = 0;                // Timebase_Us32() and counter, read together per interrupt
+static uint16_t Can_CaptureTicks = 0;
+
+static uint8_t Can_StdFilters = 0;
+static uint8_t Can_ExtFilters = 0;
+
+// Payload length for each DLC code
+static const uint8_t Can_DlcLength[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+static void Can_DrainFifo(uint32_t fifo);
+static void Can_CaptureNow(void);
+static uint32_t Can_CaptureTime(uint16_t timestamp);
+static void Can_DispatchFifo1(void);
+static uint8_t Can_Transmit(const Can_Message *message);
+static void Can_RefillTx(void);
+static uint32_t Can_LengthToDlc(uint8_t length);
+
+/**
+ * @brief  Stellt globalen Filter, Zeitstempel und Interrupts ein und startet FDCAN1
+ * @param  hfdcan: mit MX_FDCAN1_Init() initialisiertes Handle (Zustand READY)
+ * @retval 1 bei Erfolg, sonst 0
+ */
+uint8_t Can_Init(FDCAN_HandleTypeDef *hfdcan) {
+	Can_Handle = hfdcan;
+	memset(&Can_Counters, 0, sizeof(Can_Counters));
+	Can_RxHead = Can_RxTail = 0;
+	Can_TxHead = Can_TxTail = 0;
+	Can_StdFilters = Can_ExtFilters = 0;
+
+	// Frames without a matching filter never reach the message RAM
+	if (HAL_FDCAN_ConfigGlobalFilter(hfdcan, FDCAN_REJECT, FDCAN_REJECT, FDCAN_REJECT_REMOTE, FDCAN_REJECT_REMOTE) != HAL_OK)
+		return 0;
+
+	if (HAL_FDCAN_ConfigTimestampCounter(hfdcan, FDCAN_TIMESTAMP_PRESC_1) != HAL_OK
+			|| HAL_FDCAN_EnableTimestampCounter(hfdcan, FDCAN_TIMESTAMP_INTERNAL) != HAL_OK)
+		return 0;
+
+	// The transceiver loop delay is longer than a data bit at 2 Mbit/s: sample the own
+	// bits at the secondary sample point (offset in minimum time quanta)
+	if (HAL_FDCAN_ConfigTxDelayCompensation(hfdcan, hfdcan->Init.DataPrescaler * hfdcan->Init.DataTimeSeg1, 0) != HAL_OK
+			|| HAL_FDCAN_EnableTxDelayCompensation(hfdcan) != HAL_OK)
+		return 0;
+
+	if (HAL_FDCAN_ActivateNotification(hfdcan, FDCAN_IT_RX_FIFO0_NEW_MESSAGE | FDCAN_IT_RX_FIFO0_MESSAGE_LOST
+			| FDCAN_IT_RX_FIFO1_NEW_MESSAGE | FDCAN_IT_RX_FIFO1_MESSAGE_LOST
+			| FDCAN_IT_TX_COMPLETE | FDCAN_IT_BUS_OFF, CAN_TX_BUFFERS_ALL) != HAL_OK)
+		return 0;
+
+	return HAL_FDCAN_Start(hfdcan) == HAL_OK;
+}
+
+/**
+ * @brief  Trägt einen Hardwarefilter ein: angenommen wird, wenn (ID & mask) == (id & mask)
+ * @param  flags: CAN_FLAG_EXTENDED für 29-Bit-IDs, sonst 11 Bit
+ * @param  fifo: Ziel-FIFO 0 oder 1
+ * @retval 1 bei Erfolg, 0 wenn alle Filter der Art belegt sind
+ */
+uint8_t Can_AddFilter(uint32_t id, uint32_t mask, uint8_t flags, uint8_t fifo) {
+	FDCAN_FilterTypeDef filter = {0};
+	uint8_t extended = (flags & CAN_FLAG_EXTENDED) != 0;
+
+	if (Can_Handle == NULL)
+		return 0;
+	if (extended ? Can_ExtFilters >= Can_Handle->Init.ExtFiltersNbr : Can_StdFilters >= Can_Handle->Init.StdFiltersNbr)
+		return 0;
+
+	filter.IdType = extended ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+	filter.FilterIndex = extended ? Can_ExtFilters : Can_StdFilters;
+	filter.FilterType = FDCAN_FILTER_MASK;
+	filter.FilterConfig = fifo ? FDCAN_FILTER_TO_RXFIFO1 : FDCAN_FILTER_TO_RXFIFO0;
+	filter.FilterID1 = id;
+	filter.FilterID2 = mask;
+	if (HAL_FDCAN_ConfigFilter(Can_Handle, &filter) != HAL_OK)
+		return 0;
+
+	if (extended)
+		Can_ExtFilters++;
+	else
+		Can_StdFilters++;
+	return 1;
+}
+
+/**
+ * @brief  Reiht einen Rahmen zum Senden ein, kehrt sofort zurück (auch aus Interrupts)
+ * @retval 1 wenn übernommen, 0 wenn Hardware-FIFO und Warteschlange voll sind
+ */
+uint8_t Can_Send(const Can_Message *message) {
+	uint8_t ok = 1;
+	uint32_t primask;
+
+	if (Can_Handle == NULL)
+		return 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	// Queued frames go first, otherwise the order on the bus would change
+	if (Can_TxHead == Can_TxTail && HAL_FDCAN_GetTxFifoFreeLevel(Can_Handle) > 0) {
+		ok = Can_Transmit(message);
+	}
+	else if (Can_TxHead - Can_TxTail < CAN_TX_QUEUE_SIZE) {
+		Can_TxQueue[Can_TxHead & (CAN_TX_QUEUE_SIZE - 1)] = *message;
+		Can_TxHead++;
+	}
+	else {
+		Can_Counters.txDropped++;
+		ok = 0;
+	}
+
+	__set_PRIMASK(primask);
+	return ok;
+}
+
+/**
+ * @brief  Holt den ältesten empfangenen Rahmen ab
+ * @retval 1 wenn ein Rahmen kopiert wurde, 0 wenn die Warteschlange leer ist
+ */
+uint8_t Can_Receive(Can_Message *message) {
+	uint32_t tail = Can_RxTail;
+
+	if (tail == Can_RxHead)
+		return 0;
+
+	*message = Can_RxQueue[tail & (CAN_RX_QUEUE_SIZE - 1)];
+	__DMB();
+	Can_RxTail = tail + 1;
+	return 1;
+}
+
+/**
+ * @brief  Anzahl abholbereiter Rahmen
+ */
+uint32_t Can_GetPending(void) {
+	return Can_RxHead - Can_RxTail;
+}
+
+/**
+ * @brief  Leitet RX-FIFO 1 an einen eigenen Empfänger statt in die Warteschlange
+ * @param  handler: läuft im Interrupt je Rahmen, NULL = wieder die Warteschlange
+ */
+void Can_SetFifo1Handler(Can_FrameHandler handler, void *context) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	Can_Fifo1Handler = handler;
+	Can_Fifo1Context = context;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Schaltet den Mitschnitt ein (handler) oder aus (NULL)
+ *
+ * Der globale Filter lässt sich nur im Initialisierungsmodus umstellen: FDCAN1 hält dafür kurz an.
+ * Sendeaufträge im TX-FIFO gingen dabei verloren, deshalb muss der Sendeweg leer sein.
+ * @retval 1 bei Erfolg, 0 ohne Can_Init(), bei wartenden Rahmen oder Fehler der HAL
+ */
+uint8_t Can_SetCapture(Can_CaptureHandler handler, void *context) {
+	uint32_t nonMatching = handler != NULL ? FDCAN_ACCEPT_IN_RX_FIFO0 : FDCAN_REJECT;
+	uint32_t remote = handler != NULL ? FDCAN_FILTER_REMOTE : FDCAN_REJECT_REMOTE;
+	uint32_t bitrate;
+
+	if (Can_Handle == NULL || Can_GetTxPending() != 0 || (bitrate = Can_GetNominalBitrate()) == 0)
+		return 0;
+
+	Can_TickNs = 1000000000UL / bitrate;
+	if (HAL_FDCAN_Stop(Can_Handle) != HAL_OK)
+		return 0;
+
+	uint8_t ok = HAL_FDCAN_ConfigGlobalFilter(Can_Handle, nonMatching, nonMatching, remote, remote) == HAL_OK;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Can_Capture = ok ? handler : NULL;
+	Can_CaptureContext = context;
+	__set_PRIMASK(primask);
+
+	return HAL_FDCAN_Start(Can_Handle) == HAL_OK && ok;
+}
+
+/**
+ * @brief  Schreibt einen Rahmen aus Kopf und Nutzdaten direkt in den TX-FIFO (auch aus Interrupts)
+ *
+ * Anders als Can_Send() gibt es keine Warteschlange: Ist der FIFO voll oder wartet dort schon
+ * etwas aus Can_Send(), kehrt die Funktion mit 0 zurück und der Aufrufer versucht es später.
+ * Beide Quellen müssen nur während des Aufrufs gültig sein.
+ * @param  head, headLength: z. B. Protokollkopf, darf NULL/0 sein
+ * @param  data, length: Nutzdaten, zusammen mit dem Kopf höchstens 8 bzw. 64 (FD) Bytes
+ * @retval 1 wenn übergeben, sonst 0
+ */
+uint8_t Can_SendDirect(uint32_t id, uint8_t flags, const uint8_t *head, uint8_t headLength,
+		const uint8_t *data, uint8_t length) {
+	uint8_t fd = (flags & CAN_FLAG_FD) != 0;
+	uint32_t total = (uint32_t)headLength + length;
+	uint32_t primask, index, dlc, padded, word = 0;
+	volatile uint32_t *element;
+
+	if (Can_Handle == NULL || total > (fd ? CAN_MAX_DATA : 8))
+		return 0;
+
+	dlc = Can_LengthToDlc(total);
+	padded = Can_DlcLength[dlc];
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	FDCAN_GlobalTypeDef *can = Can_Handle->Instance;
+	if (Can_TxHead != Can_TxTail || (can->TXFQS & FDCAN_TXFQS_TFQF)) {
+		__set_PRIMASK(primask);
+		return 0;
+	}
+
+	index = (can->TXFQS & FDCAN_TXFQS_TFQPI) >> FDCAN_TXFQS_TFQPI_Pos;
+	element = (volatile uint32_t *)(Can_Handle->msgRam.TxBufferSA + index * Can_Handle->Init.TxElmtSize * 4U);
+
+	element[0] = (flags & CAN_FLAG_EXTENDED) ? CAN_ELEMENT_XTD | (id & CAN_ELEMENT_EXTID_Msk)
+			: (id & 0x7FFUL) << CAN_ELEMENT_STDID_Pos;
+	element[1] = (dlc << CAN_ELEMENT_DLC_Pos) | (fd ? CAN_ELEMENT_FDF : 0)
+			| ((fd && (flags & CAN_FLAG_BRS)) ? CAN_ELEMENT_BRS : 0);
+	element += 2;
+
+	// Pack head, data and zero padding into whole words, the message RAM takes no byte writes
+	for (uint32_t i = 0; i < padded; i++) {
+		uint32_t byte = i < headLength ? head[i] : (i < total ? data[i - headLength] : 0);
+		word |= byte << (8U * (i & 3U));
+		if ((i & 3U) == 3U) {
+			*element++ = word;
+			word = 0;
+		}
+	}
+	if (padded & 3U)
+		*element = word;
+
+	can->TXBAR = 1UL << index;
+	Can_Handle->LatestTxFifoQRequest = 1UL << index;
+	Can_Counters.sent++;
+
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+/**
+ * @brief  Freie Plätze für Can_SendDirect(), 0 solange die Sendewarteschlange nicht leer ist
+ */
+uint32_t Can_GetTxFree(void) {
+	if (Can_Handle == NULL || Can_TxHead != Can_TxTail)
+		return 0;
+	return HAL_FDCAN_GetTxFifoFreeLevel(Can_Handle);
+}
+
+/**
+ * @brief  Rahmen, die noch nicht auf dem Bus waren (TX-FIFO und Sendewarteschlange)
+ */
+uint32_t Can_GetTxPending(void) {
+	if (Can_Handle == NULL)
+		return 0;
+	return Can_Handle->Init.TxFifoQueueElmtsNbr - HAL_FDCAN_GetTxFifoFreeLevel(Can_Handle)
+			+ (Can_TxHead - Can_TxTail);
+}
+
+const Can_Stats* Can_GetStats(void) {
+	return &Can_Counters;
+}
+
+/**
+ * @brief  Fehlerzähler des Protokolls (ab 128 Error Passive, TX über 255 Bus-Off)
+ */
+void Can_GetErrorCounters(uint8_t *tx, uint8_t *rx) {
+	FDCAN_ErrorCountersTypeDef counters = {0};
+
+	if (Can_Handle != NULL)
+		HAL_FDCAN_GetErrorCounters(Can_Handle, &counters);
+	*tx = counters.TxErrorCnt;
+	*rx = counters.RxErrorCnt;
+}
+
+/**
+ * @brief  Bitrate der Arbitrierungsphase aus Kerneltakt und Segmenten
+ */
+uint32_t Can_GetNominalBitrate(void) {
+	if (Can_Handle == NULL)
+		return 0;
+
+	const FDCAN_InitTypeDef *init = &Can_Handle->Init;
+	return HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN)
+			/ (init->NominalPrescaler * (1U + init->NominalTimeSeg1 + init->NominalTimeSeg2));
+}
+
+/**
+ * @brief  Bitrate der Datenphase (Rahmen mit CAN_FLAG_BRS)
+ */
+uint32_t Can_GetDataBitrate(void) {
+	if (Can_Handle == NULL)
+		return 0;
+
+	const FDCAN_InitTypeDef *init = &Can_Handle->Init;
+	return HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN)
+			/ (init->DataPrescaler * (1U + init->DataTimeSeg1 + init->DataTimeSeg2));
+}
+
+/**
+ * @brief  Aus HAL_FDCAN_RxFifo0Callback(): neue Rahmen in RX-FIFO 0
+ */
+void Can_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t interrupts) {
+	if (hfdcan != Can_Handle)
+		return;
+
+	if (interrupts & FDCAN_IT_RX_FIFO0_MESSAGE_LOST)
+		Can_Counters.rxLost++;
+	Can_CaptureNow();
+	Can_DrainFifo(FDCAN_RX_FIFO0);
+}
+
+/**
+ * @brief  Aus HAL_FDCAN_RxFifo1Callback(): neue Rahmen in RX-FIFO 1
+ */
+void Can_RxFifo1Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t interrupts) {
+	if (hfdcan != Can_Handle)
+		return;
+
+	if (interrupts & FDCAN_IT_RX_FIFO1_MESSAGE_LOST)
+		Can_Counters.rxLost++;
+	Can_CaptureNow();
+	if (Can_Fifo1Handler != NULL)
+		Can_DispatchFifo1();
+	else
+		Can_DrainFifo(FDCAN_RX_FIFO1);
+}
+
+/**
+ * @brief  Aus HAL_FDCAN_TxBufferCompleteCallback(): Plätze im TX-FIFO frei, Warteschlange nachschieben
+ */
+void Can_TxBufferCompleteCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t bufferIndexes) {
+	if (hfdcan != Can_Handle)
+		return;
+
+	Can_RefillTx();
+}
+
+/**
+ * @brief  Aus HAL_FDCAN_ErrorStatusCallback(): nach Bus-Off den Wiederanlauf starten
+ */
+void Can_ErrorStatusCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t interrupts) {
+	if (hfdcan != Can_Handle || !(interrupts & FDCAN_IT_BUS_OFF))
+		return;
+
+	// Bus-off sets INIT; clearing it waits for 129 x 11 recessive bits and rejoins the bus
+	if (hfdcan->Instance->PSR & FDCAN_PSR_BO) {
+		Can_Counters.busOff++;
+		CLEAR_BIT(hfdcan->Instance->CCCR, FDCAN_CCCR_INIT);
+	}
+}
+
+/**
+ * @brief  Kopiert alle Elemente eines RX-FIFO in die Warteschlange, im Interrupt
+ */
+static void Can_DrainFifo(uint32_t fifo) {
+	FDCAN_RxHeaderTypeDef header;
+
+	while (HAL_FDCAN_GetRxFifoFillLevel(Can_Handle, fifo) > 0) {
+		uint32_t head = Can_RxHead;
+		Can_Message *message = &Can_RxQueue[head & (CAN_RX_QUEUE_SIZE - 1)];
+		uint8_t full = head - Can_RxTail >= CAN_RX_QUEUE_SIZE;
+
+		// A full queue still has to pop the element, or the FIFO stops raising interrupts
+		if (full)
+			message = &Can_RxDiscard;
+
+		if (HAL_FDCAN_GetRxMessage(Can_Handle, fifo, &header, message->data) != HAL_OK)
+			return;
+
+		message->id = header.Identifier;
+		message->length = Can_DlcLength[header.DataLength & 0x0F];
+		message->flags = (header.IdType == FDCAN_EXTENDED_ID ? CAN_FLAG_EXTENDED : 0)
+				| (header.RxFrameType == FDCAN_REMOTE_FRAME ? CAN_FLAG_REMOTE : 0)
+				| (header.FDFormat == FDCAN_FD_CAN ? CAN_FLAG_FD : 0)
+				| (header.BitRateSwitch == FDCAN_BRS_ON ? CAN_FLAG_BRS : 0);
+		message->fifo = fifo == FDCAN_RX_FIFO1;
+		message->timestamp = header.RxTimestamp;
+
+		if (Can_Capture != NULL) {
+			Can_Capture(Can_CaptureTime(header.RxTimestamp), message->id, message->flags, message->fifo,
+					message->data, message->length, Can_CaptureContext);
+			// Only the capture asked for frames without a filter
+			if (header.IsFilterMatchingFrame)
+				continue;
+		}
+
+		if (full) {
+			Can_Counters.rxOverruns++;
+			continue;
+		}
+
+		__DMB();
+		Can_RxHead = head + 1;
+		Can_Counters.received++;
+	}
+}
+
+/**
+ * @brief  Übergibt alle Elemente von RX-FIFO 1 direkt aus dem Message RAM an Can_Fifo1Handler, im Interrupt
+ */
+static void Can_DispatchFifo1(void) {
+	FDCAN_GlobalTypeDef *can = Can_Handle->Instance;
+	uint32_t status;
+
+	while ((status = can->RXF1S) & FDCAN_RXF1S_F1FL) {
+		uint32_t index = (status & FDCAN_RXF1S_F1GI) >> FDCAN_RXF1S_F1GI_Pos;
+		const volatile uint32_t *element = (const volatile uint32_t *)(Can_Handle->msgRam.RxFIFO1SA
+				+ index * Can_Handle->Init.RxFifo1ElmtSize * 4U);
+		uint32_t r0 = element[0], r1 = element[1];
+		uint8_t flags = 0;
+		uint32_t id;
+
+		if (r0 & CAN_ELEMENT_XTD) {
+			id = r0 & CAN_ELEMENT_EXTID_Msk;
+			flags |= CAN_FLAG_EXTENDED;
+		}
+		else {
+			id = (r0 >> CAN_ELEMENT_STDID_Pos) & 0x7FFUL;
+		}
+		if (r0 & CAN_ELEMENT_RTR)
+			flags |= CAN_FLAG_REMOTE;
+		if (r1 & CAN_ELEMENT_FDF)
+			flags |= CAN_FLAG_FD;
+		if (r1 & CAN_ELEMENT_BRS)
+			flags |= CAN_FLAG_BRS;
+
+		if (Can_Capture != NULL)
+			Can_Capture(Can_CaptureTime((uint16_t)r1), id, flags, 1, (const uint8_t *)&element[2],
+					Can_DlcLength[(r1 >> CAN_ELEMENT_DLC_Pos) & 0x0FU], Can_CaptureContext);
+
+		Can_Fifo1Handler(id, flags, (const uint8_t *)&element[2],
+				Can_DlcLength[(r1 >> CAN_ELEMENT_DLC_Pos) & 0x0FU], Can_Fifo1Context);
+
+		// Acknowledge only now, until then the element stays untouched by the hardware
+		can->RXF1A = index;
+		Can_Counters.received++;
+	}
+}
+
+/**
+ * @brief  Merkt Timebase_Us32() und den Zeitstempelzähler zusammen, Bezug für Can_CaptureTime()
+ */
+static void Can_CaptureNow(void) {
+	if (Can_Capture == NULL)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Can_CaptureTicks = (uint16_t)HAL_FDCAN_GetTimestampCounter(Can_Handle);
+	Can_CaptureUs = Timebase_Us32();
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Zeitstempel eines Rahmens als Timebase_Us32(): Abstand zum Zähler in Can_CaptureNow() zurückgerechnet
+ */
+static uint32_t Can_CaptureTime(uint16_t timestamp) {
+	uint16_t age = (uint16_t)(Can_CaptureTicks - timestamp);
+
+	return Can_CaptureUs - (uint32_t)age * Can_TickNs / 1000U;
+}
+
+/**
+ * @brief  Schreibt einen Rahmen in den TX-FIFO der Hardware (Platz muss frei sein)
+ */
+static uint8_t Can_Transmit(const Can_Message *message) {
+	FDCAN_TxHeaderTypeDef header = {0};
+	uint8_t data[CAN_MAX_DATA];
+	uint8_t fd = (message->flags & CAN_FLAG_FD) != 0;
+	uint8_t length = message->length;
+
+	if (length > (fd ? CAN_MAX_DATA : 8))
+		length = fd ? CAN_MAX_DATA : 8;
+
+	header.Identifier = message->id;
+	header.IdType = (message->flags & CAN_FLAG_EXTENDED) ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+	header.TxFrameType = (!fd && (message->flags & CAN_FLAG_REMOTE)) ? FDCAN_REMOTE_FRAME : FDCAN_DATA_FRAME;
+	header.DataLength = Can_LengthToDlc(length);
+	header.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
+	header.BitRateSwitch = (fd && (message->flags & CAN_FLAG_BRS)) ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+	header.FDFormat = fd ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+	header.TxEventFifoControl = FDCAN_NO_TX_EVENTS;
+
+	// Pad up to the DLC length with zeros
+	memcpy(data, message->data, length);
+	memset(&data[length], 0, Can_DlcLength[header.DataLength] - length);
+
+	if (HAL_FDCAN_AddMessageToTxFifoQ(Can_Handle, &header, data) != HAL_OK) {
+		Can_Counters.txDropped++;
+		return 0;
+	}
+	Can_Counters.sent++;
+	return 1;
+}
+
+/**
+ * @brief  Schiebt wartende Rahmen in den TX-FIFO, im Interrupt
+ */
+static void Can_RefillTx(void) {
+	while (Can_TxHead != Can_TxTail && HAL_FDCAN_GetTxFifoFreeLevel(Can_Handle) > 0) {
+		Can_Transmit(&Can_TxQueue[Can_TxTail & (CAN_TX_QUEUE_SIZE - 1)]);
+		Can_TxTail++;
+	}
+}
+
+/**
+ * @brief  Kleinster DLC-Code, dessen Länge die Daten fasst
+ */
+static uint32_t Can_LengthToDlc(uint8_t length) {
+	uint32_t dlc = 0;
+
+	while (dlc < 15 && Can_DlcLength[dlc] < length)
+		dlc++;
+	return dlc;
+}
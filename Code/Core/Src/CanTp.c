@@ -0,0 +1,667 @@
+/**
+ * @file    CanTp.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Segmentierte Übertragung großer Datenmengen über CAN-FD (nach ISO 15765-2), ohne Kopie
+ *
+ * Für Log-Dateien und Firmware-Abbilder zwischen zwei Boards. Die Daten werden in 64-Byte-
+ * Rahmen mit schneller Datenphase (BRS) zerlegt; das erste Byte jedes Rahmens ist die Protocol
+ * Control Information wie bei ISO-TP:
+ * - Single Frame   0x0L bzw. 0x00 LL           bis 62 Bytes in einem Rahmen
+ * - First Frame    0x1L LL bzw. 0x10 00 + 32 Bit Gesamtlänge, danach 62 bzw. 58 Bytes
+ * - Consecutive    0x2N (N = Folgenummer 0-15), 63 Bytes
+ * - Flow Control   0x3S BS STmin (S: 0 = weiter, 1 = warten, 2 = Überlauf)
+ * Nach dem First Frame und nach jedem Block aus BS Folgerahmen wartet der Sender auf die
+ * Flusssteuerung des Empfängers. Der Block ist das Fenster, das der Empfänger im RAM puffert.
+ *
+ * Es gibt keine Kopie über FDCAN_RxHeaderTypeDef und Zwischenpuffer. Die Rahmen kommen in
+ * RX-FIFO 1, und Can.c ruft CanTp_FrameHandler() im Interrupt mit einem Zeiger direkt ins
+ * Message RAM auf. Die Nutzdaten werden von dort einmal in das Empfangsfenster kopiert. Es gibt
+ * zwei Fenster: Während der Task ein volles Fenster an den Abnehmer (CanTp_Sink) übergibt,
+ * füllt der Interrupt schon das andere. Die Flusssteuerung geht deshalb meist sofort am
+ * Blockende hinaus. Ist noch kein Fenster frei, schickt der Task sie, sobald eins frei wird.
+ * Dauert das zu lange, hält er den Sender mit WAIT-Rahmen hin.
+ *
+ * Beim Senden liefert CanTp_Source einen Zeiger je Rahmen (bei Daten im Flash oder RAM direkt
+ * dorthin). Can_SendDirect() schreibt Protokollbyte und Nutzdaten direkt in das Element im
+ * TX-FIFO. Der Task füllt bei jedem Durchlauf (1 ms) alle freien Plätze des TX-FIFO nach. Bei
+ * 16 Plätzen reicht das für mehr als die Busbitrate.
+ *
+ * Der Durchsatz wird vom First Frame bis zum letzten Rahmen gemessen, beim Sender bis der
+ * TX-FIFO leer ist. Er steht in CanTp_GetStats() und wird nach jeder Übertragung mit printf
+ * ausgegeben. Bei 500 kbit/s Arbitrierung und 2 Mbit/s in der Datenphase braucht ein 64-Byte-
+ * Rahmen etwa 330 us, das sind knapp 190 KB/s Nutzdaten.
+ *
+ * Der Task ist nur eingeschaltet, solange eine Übertragung läuft. CanTp_Send() und ein
+ * empfangener First Frame schalten ihn ein.
+ */
+
+#include "CanTp.h"
+#include "Scheduler.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Nutzdaten je Rahmenart bei 64-Byte-Rahmen */
+#define CANTP_SF_DATA             (CAN_MAX_DATA - 2)
+#define CANTP_FF_DATA             (CAN_MAX_DATA - 2)
+#define CANTP_CF_DATA             (CAN_MAX_DATA - 1)
+
+/* Größte Länge im kurzen First Frame (12 Bit), darüber kommt die 32-Bit-Form */
+#define CANTP_FF_SHORT_MAX        0xFFFU
+
+/* Protocol Control Information (obere 4 Bit des ersten Bytes) und Flow Status */
+#define CANTP_PCI_SF              0x00
+#define CANTP_PCI_FF              0x10
+#define CANTP_PCI_CF              0x20
+#define CANTP_PCI_FC              0x30
+#define CANTP_FS_CTS              0
+#define CANTP_FS_WAIT             1
+#define CANTP_FS_OVERFLOW         2
+
+/* Ein Fenster fasst den First Frame und einen ganzen Block Folgerahmen */
+#define CANTP_WINDOW_SIZE         (CANTP_FF_DATA + CANTP_BLOCK_SIZE * CANTP_CF_DATA)
+
+#define CANTP_FRAME_FLAGS         (CAN_FLAG_FD | CAN_FLAG_BRS)
+
+/**
+ * @brief Zustand des Senders
+ */
+typedef enum {
+	CANTP_TX_IDLE,
+	CANTP_TX_START,                // erster Rahmen steht aus
+	CANTP_TX_WAIT_FC,              // wartet auf die Flusssteuerung
+	CANTP_TX_SEND,                 // Folgerahmen des Blocks
+	CANTP_TX_DRAIN                 // alles im TX-FIFO, wartet auf den Bus
+} CanTp_TxStates;
+
+static uint8_t CanTp_TaskId = SCHEDULER_INVALID_TASK;
+static uint8_t CanTp_Node = 0;
+static CanTp_Stats CanTp_Counters;
+
+static CanTp_Sink CanTp_RxSink = NULL;
+static void *CanTp_RxSinkContext = NULL;
+
+// Transmitter, runs in the task; the interrupt only takes the flow control
+static volatile uint8_t CanTp_TxState = CANTP_TX_IDLE;
+static CanTp_Source CanTp_TxSource;
+static void *CanTp_TxContext;
+static uint32_t CanTp_TxLength;
+static uint32_t CanTp_TxOffset;
+static uint8_t CanTp_TxSequence;
+static volatile uint8_t CanTp_TxBlockSize;        // from the receiver, 0 = no further flow control
+static volatile uint8_t CanTp_TxBlockLeft;
+static volatile uint8_t CanTp_TxStMin;
+static volatile uint32_t CanTp_TxTimer;           // tick of the last flow control
+static uint8_t CanTp_TxWaits;
+static uint32_t CanTp_TxStart;
+static uint32_t CanTp_TxLastFrame;
+
+// Receiver, filled in the interrupt straight from the message RAM
+static uint8_t CanTp_Window[2][CANTP_WINDOW_SIZE] __attribute__((aligned(4)));
+static volatile uint32_t CanTp_WindowLength[2];   // != 0: full, the task hands it to the sink
+static uint32_t CanTp_WindowOffset[2];
+static uint8_t CanTp_RxFill = 0;                  // window being filled
+static volatile uint8_t CanTp_RxDeliver = 0;      // next window for the sink, changed by the task
+static volatile uint8_t CanTp_RxActive = 0;
+static volatile uint8_t CanTp_RxDone = 0;         // finished, report pending
+static uint32_t CanTp_RxLength;
+static uint32_t CanTp_RxReceived;
+static uint32_t CanTp_RxUsed;                     // bytes in the window being filled
+static uint8_t CanTp_RxSequence;
+static uint8_t CanTp_RxBlockLeft;
+static volatile uint8_t CanTp_RxFcPending = 0;    // flow control owed until a window is free
+static volatile uint32_t CanTp_RxTimer;           // tick of the last frame or flow control
+static uint32_t CanTp_RxStart;
+
+static void CanTp_FrameHandler(uint32_t id, uint8_t flags, const uint8_t *data, uint8_t length, void *context);
+static void CanTp_RxSingle(const uint8_t *data, uint8_t length);
+static void CanTp_RxFirst(const uint8_t *data, uint8_t length);
+static void CanTp_RxConsecutive(const uint8_t *data, uint8_t length);
+static void CanTp_RxFlowControl(const uint8_t *data, uint8_t length);
+static uint8_t CanTp_RxBegin(uint32_t length);
+static uint8_t CanTp_RxStore(const uint8_t *data, uint32_t length);
+static void CanTp_RxCloseWindow(void);
+static void CanTp_RxFinish(void);
+static void CanTp_RxTask(uint32_t now);
+static void CanTp_TxTask(uint32_t now);
+static void CanTp_TxStartFrame(uint32_t now);
+static void CanTp_TxPump(uint32_t now);
+static void CanTp_SendFlowControl(uint8_t status);
+static uint32_t CanTp_StMinMs(uint8_t stMin);
+static const uint8_t* CanTp_MemorySource(uint32_t offset, uint8_t length, void *context);
+
+/**
+ * @brief  Richtet Filter und Empfang über RX-FIFO 1 ein, nach Can_Init()
+ * @param  taskId: Rückgabe von Scheduler_AddTask() für CanTp_Task
+ * @param  node: 0 oder 1, das andere Board bekommt die andere Nummer
+ * @retval 1 bei Erfolg, 0 wenn kein Filter mehr frei ist
+ */
+uint8_t CanTp_Init(uint8_t taskId, uint8_t node) {
+	CanTp_TaskId = taskId;
+	CanTp_Node = node & 1;
+	memset(&CanTp_Counters, 0, sizeof(CanTp_Counters));
+	Scheduler_SetEnabled(taskId, 0);
+
+	// Both IDs of the pair end up in FIFO 1, the handler picks the one of the other node
+	if (!Can_AddFilter(CANTP_ID_BASE, 0x7FE, 0, 1))
+		return 0;
+	Can_SetFifo1Handler(CanTp_FrameHandler, NULL);
+	return 1;
+}
+
+/**
+ * @brief  Wechselt die Knotennummer (0/1) und damit Sende- und Empfangs-ID, nur ohne laufende Übertragung
+ */
+void CanTp_SetNode(uint8_t node) {
+	if (!CanTp_IsBusy())
+		CanTp_Node = node & 1;
+}
+
+uint8_t CanTp_GetNode(void) {
+	return CanTp_Node;
+}
+
+/**
+ * @brief  Legt fest, wer die empfangenen Daten bekommt (NULL = nur zählen)
+ *
+ * Nach einem Abbruch beginnt die nächste Übertragung wieder bei offset 0.
+ */
+void CanTp_SetSink(CanTp_Sink sink, void *context) {
+	CanTp_RxSink = sink;
+	CanTp_RxSinkContext = context;
+}
+
+/**
+ * @brief  Sendet einen Speicherbereich (Flash oder RAM), der bis zum Ende gültig bleiben muss
+ * @retval 1 wenn gestartet, 0 wenn noch gesendet wird
+ */
+uint8_t CanTp_Send(const void *data, uint32_t length) {
+	return CanTp_SendFrom(CanTp_MemorySource, (void *)data, length);
+}
+
+/**
+ * @brief  Sendet length Bytes, die source Rahmen für Rahmen liefert
+ * @retval 1 wenn gestartet, 0 wenn noch gesendet wird oder length 0 ist
+ */
+uint8_t CanTp_SendFrom(CanTp_Source source, void *context, uint32_t length) {
+	if (CanTp_TxState != CANTP_TX_IDLE || source == NULL || length == 0)
+		return 0;
+
+	CanTp_TxSource = source;
+	CanTp_TxContext = context;
+	CanTp_TxLength = length;
+	CanTp_TxOffset = 0;
+	CanTp_TxWaits = 0;
+	CanTp_TxState = CANTP_TX_START;
+	Scheduler_SetEnabled(CanTp_TaskId, 1);
+	return 1;
+}
+
+/**
+ * @brief  1, solange gesendet, empfangen oder an den Abnehmer übergeben wird
+ */
+uint8_t CanTp_IsBusy(void) {
+	return CanTp_TxState != CANTP_TX_IDLE || CanTp_RxActive || CanTp_RxDone
+			|| CanTp_WindowLength[0] != 0 || CanTp_WindowLength[1] != 0;
+}
+
+const CanTp_Stats* CanTp_GetStats(void) {
+	return &CanTp_Counters;
+}
+
+/**
+ * @brief  Durchsatz in Bytes/s aus Menge und Dauer (z. B. lastTxBytes, lastTxMs)
+ */
+uint32_t CanTp_GetThroughput(uint32_t bytes, uint32_t ms) {
+	return ms ? (uint32_t)((uint64_t)bytes * 1000U / ms) : 0;
+}
+
+/**
+ * @brief  Scheduler-Task (1 ms): Fenster abgeben, Flusssteuerung nachholen, Rahmen nachfüllen
+ */
+void CanTp_Task(void *context) {
+	uint32_t now = HAL_GetTick();
+	uint32_t primask;
+
+	CanTp_RxTask(now);
+	CanTp_TxTask(now);
+
+	// Off again once everything is done; the next first frame switches it back on
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (!CanTp_IsBusy())
+		Scheduler_SetEnabled(CanTp_TaskId, 0);
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Empfänger für RX-FIFO 1 (Can_SetFifo1Handler), im Interrupt; data zeigt ins Message RAM
+ */
+static void CanTp_FrameHandler(uint32_t id, uint8_t flags, const uint8_t *data, uint8_t length, void *context) {
+	if (id != CANTP_ID_BASE + (CanTp_Node ^ 1U) || (flags & CAN_FLAG_EXTENDED) || length == 0)
+		return;
+
+	switch (data[0] & 0xF0) {
+	case CANTP_PCI_SF:
+		CanTp_RxSingle(data, length);
+		break;
+	case CANTP_PCI_FF:
+		CanTp_RxFirst(data, length);
+		break;
+	case CANTP_PCI_CF:
+		CanTp_RxConsecutive(data, length);
+		break;
+	case CANTP_PCI_FC:
+		CanTp_RxFlowControl(data, length);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief  Single Frame: ganze Übertragung in einem Rahmen
+ */
+static void CanTp_RxSingle(const uint8_t *data, uint8_t length) {
+	uint32_t size = data[0] & 0x0F;
+	const uint8_t *payload = &data[1];
+
+	// CAN FD: length 0 in the first byte means the length follows in the second one
+	if (size == 0 && length > 8) {
+		size = data[1];
+		payload = &data[2];
+	}
+	if (size == 0 || payload + size > data + length)
+		return;
+
+	// A new transfer replaces a running one (ISO 15765-2)
+	if (CanTp_RxActive) {
+		CanTp_RxActive = 0;
+		CanTp_Counters.errors++;
+	}
+	if (!CanTp_RxBegin(size)) {
+		CanTp_Counters.errors++;
+		return;
+	}
+
+	CanTp_RxStore(payload, size);
+	CanTp_RxFinish();
+}
+
+/**
+ * @brief  First Frame: Länge merken, erste Nutzdaten ablegen, Flusssteuerung senden
+ */
+static void CanTp_RxFirst(const uint8_t *data, uint8_t length) {
+	uint32_t total = ((uint32_t)(data[0] & 0x0F) << 8) | data[1];
+	const uint8_t *payload = &data[2];
+
+	if (length < 8)
+		return;
+
+	if (total == 0) {
+		total = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 8) | data[5];
+		payload = &data[6];
+	}
+
+	uint32_t size = (uint32_t)(data + length - payload);
+	if (total <= size)
+		return;
+
+	if (CanTp_RxActive) {
+		CanTp_RxActive = 0;
+		CanTp_Counters.errors++;
+	}
+	if (!CanTp_RxBegin(total)) {
+		CanTp_Counters.errors++;
+		CanTp_SendFlowControl(CANTP_FS_OVERFLOW);
+		return;
+	}
+
+	CanTp_RxStore(payload, size);
+	CanTp_RxSequence = 1;
+	CanTp_RxBlockLeft = CANTP_BLOCK_SIZE;
+	CanTp_RxActive = 1;
+	CanTp_SendFlowControl(CANTP_FS_CTS);
+}
+
+/**
+ * @brief  Consecutive Frame: Folgenummer prüfen, ablegen, am Blockende Fenster abgeben
+ */
+static void CanTp_RxConsecutive(const uint8_t *data, uint8_t length) {
+	uint32_t size = CanTp_RxLength - CanTp_RxReceived;
+
+	if (!CanTp_RxActive || CanTp_RxFcPending)
+		return;
+
+	if ((data[0] & 0x0F) != CanTp_RxSequence || (size > CANTP_CF_DATA && length < CAN_MAX_DATA)) {
+		CanTp_RxActive = 0;
+		CanTp_Counters.errors++;
+		return;
+	}
+	CanTp_RxSequence = (CanTp_RxSequence + 1) & 0x0F;
+
+	if (size > (uint32_t)length - 1)
+		size = (uint32_t)length - 1;
+	if (!CanTp_RxStore(&data[1], size)) {
+		// Sender ignored the block size
+		CanTp_RxActive = 0;
+		CanTp_Counters.errors++;
+		return;
+	}
+
+	if (CanTp_RxReceived == CanTp_RxLength) {
+		CanTp_RxFinish();
+		return;
+	}
+
+	if (--CanTp_RxBlockLeft == 0) {
+		CanTp_RxCloseWindow();
+		if (CanTp_WindowLength[CanTp_RxFill] == 0) {
+			CanTp_RxBlockLeft = CANTP_BLOCK_SIZE;
+			CanTp_SendFlowControl(CANTP_FS_CTS);
+		}
+		else {
+			CanTp_RxFcPending = 1;
+		}
+	}
+}
+
+/**
+ * @brief  Flow Control des Empfängers für den eigenen Sender
+ */
+static void CanTp_RxFlowControl(const uint8_t *data, uint8_t length) {
+	if (CanTp_TxState != CANTP_TX_WAIT_FC || length < 3)
+		return;
+
+	switch (data[0] & 0x0F) {
+	case CANTP_FS_CTS:
+		CanTp_TxBlockSize = data[1];
+		CanTp_TxBlockLeft = data[1];
+		CanTp_TxStMin = data[2];
+		CanTp_TxWaits = 0;
+		CanTp_TxTimer = HAL_GetTick();
+		__DMB();
+		CanTp_TxState = CANTP_TX_SEND;
+		break;
+	case CANTP_FS_WAIT:
+		CanTp_Counters.waits++;
+		CanTp_TxTimer = HAL_GetTick();
+		if (++CanTp_TxWaits > CANTP_MAX_WAITS) {
+			CanTp_Counters.errors++;
+			CanTp_TxState = CANTP_TX_IDLE;
+		}
+		break;
+	default:
+		// Overflow: the receiver has no room for this length
+		CanTp_Counters.errors++;
+		CanTp_TxState = CANTP_TX_IDLE;
+		break;
+	}
+}
+
+/**
+ * @brief  Beginnt einen Empfang, wenn beide Fenster frei sind
+ */
+static uint8_t CanTp_RxBegin(uint32_t length) {
+	if (CanTp_WindowLength[0] != 0 || CanTp_WindowLength[1] != 0 || CanTp_RxDone)
+		return 0;
+
+	CanTp_RxFill = CanTp_RxDeliver;
+	CanTp_RxLength = length;
+	CanTp_RxReceived = 0;
+	CanTp_RxUsed = 0;
+	CanTp_RxFcPending = 0;
+	CanTp_RxStart = CanTp_RxTimer = HAL_GetTick();
+	Scheduler_SetEnabled(CanTp_TaskId, 1);
+	return 1;
+}
+
+/**
+ * @brief  Kopiert Nutzdaten aus dem Message RAM in das aktuelle Fenster
+ * @retval 0 wenn das Fenster voll ist
+ */
+static uint8_t CanTp_RxStore(const uint8_t *data, uint32_t length) {
+	if (CanTp_RxUsed + length > CANTP_WINDOW_SIZE)
+		return 0;
+
+	memcpy(&CanTp_Window[CanTp_RxFill][CanTp_RxUsed], data, length);
+	CanTp_RxUsed += length;
+	CanTp_RxReceived += length;
+	CanTp_RxTimer = HAL_GetTick();
+	return 1;
+}
+
+/**
+ * @brief  Gibt das aktuelle Fenster an den Task und wechselt auf das andere
+ */
+static void CanTp_RxCloseWindow(void) {
+	CanTp_WindowOffset[CanTp_RxFill] = CanTp_RxReceived - CanTp_RxUsed;
+	__DMB();
+	CanTp_WindowLength[CanTp_RxFill] = CanTp_RxUsed;
+	CanTp_RxFill ^= 1;
+	CanTp_RxUsed = 0;
+}
+
+/**
+ * @brief  Letzte Daten sind da: Fenster abgeben, Dauer festhalten
+ */
+static void CanTp_RxFinish(void) {
+	CanTp_RxCloseWindow();
+	CanTp_RxActive = 0;
+	CanTp_Counters.rxTransfers++;
+	CanTp_Counters.lastRxBytes = CanTp_RxLength;
+	CanTp_Counters.lastRxMs = HAL_GetTick() - CanTp_RxStart;
+	CanTp_RxDone = 1;
+}
+
+/**
+ * @brief  Volle Fenster in Reihenfolge an den Abnehmer, danach ausstehende Flusssteuerung senden
+ */
+static void CanTp_RxTask(uint32_t now) {
+	uint32_t primask;
+	uint8_t window;
+
+	while (CanTp_WindowLength[window = CanTp_RxDeliver] != 0) {
+		if (CanTp_RxSink != NULL)
+			CanTp_RxSink(CanTp_WindowOffset[window], CanTp_Window[window], CanTp_WindowLength[window],
+					CanTp_RxLength, CanTp_RxSinkContext);
+
+		// Advance first: a first frame in between must start at the window delivered next
+		CanTp_RxDeliver = window ^ 1;
+		__DMB();
+		CanTp_WindowLength[window] = 0;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (CanTp_RxFcPending && CanTp_WindowLength[CanTp_RxFill] == 0) {
+		CanTp_RxFcPending = 0;
+		CanTp_RxBlockLeft = CANTP_BLOCK_SIZE;
+		CanTp_RxTimer = now;
+		CanTp_SendFlowControl(CANTP_FS_CTS);
+	}
+	else if (CanTp_RxFcPending && now - CanTp_RxTimer >= CANTP_TIMEOUT_MS / 2) {
+		// Keep the sender from timing out while the sink is slow
+		CanTp_RxTimer = now;
+		CanTp_Counters.waits++;
+		CanTp_SendFlowControl(CANTP_FS_WAIT);
+	}
+	else if (CanTp_RxActive && !CanTp_RxFcPending && now - CanTp_RxTimer > CANTP_TIMEOUT_MS) {
+		CanTp_RxActive = 0;
+		CanTp_Counters.timeouts++;
+	}
+	__set_PRIMASK(primask);
+
+	if (CanTp_RxDone && CanTp_WindowLength[0] == 0 && CanTp_WindowLength[1] == 0) {
+		CanTp_RxDone = 0;
+		printf("CanTp: %lu Bytes empfangen in %lu ms, %lu KB/s\n", CanTp_Counters.lastRxBytes,
+				CanTp_Counters.lastRxMs, CanTp_GetThroughput(CanTp_Counters.lastRxBytes, CanTp_Counters.lastRxMs) / 1024);
+	}
+}
+
+/**
+ * @brief  Sender: erster Rahmen, Folgerahmen, Zeitüberwachung und Abschluss
+ */
+static void CanTp_TxTask(uint32_t now) {
+	switch (CanTp_TxState) {
+	case CANTP_TX_START:
+		CanTp_TxStartFrame(now);
+		break;
+	case CANTP_TX_SEND:
+		CanTp_TxPump(now);
+		break;
+	case CANTP_TX_WAIT_FC:
+		if (now - CanTp_TxTimer > CANTP_TIMEOUT_MS) {
+			CanTp_Counters.timeouts++;
+			CanTp_TxState = CANTP_TX_IDLE;
+		}
+		break;
+	case CANTP_TX_DRAIN:
+		if (Can_GetTxPending() == 0) {
+			CanTp_Counters.txTransfers++;
+			CanTp_Counters.lastTxBytes = CanTp_TxLength;
+			CanTp_Counters.lastTxMs = now - CanTp_TxStart;
+			CanTp_TxState = CANTP_TX_IDLE;
+			printf("CanTp: %lu Bytes gesendet in %lu ms, %lu KB/s\n", CanTp_Counters.lastTxBytes,
+					CanTp_Counters.lastTxMs, CanTp_GetThroughput(CanTp_Counters.lastTxBytes, CanTp_Counters.lastTxMs) / 1024);
+		}
+		else if (now - CanTp_TxLastFrame > CANTP_TIMEOUT_MS) {
+			// Nobody acknowledges on the bus
+			CanTp_Counters.timeouts++;
+			CanTp_TxState = CANTP_TX_IDLE;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief  Single Frame oder First Frame
+ */
+static void CanTp_TxStartFrame(uint32_t now) {
+	uint32_t length = CanTp_TxLength;
+	uint8_t pci[6];
+	uint8_t pciLength, size;
+
+	if (Can_GetTxFree() == 0)
+		return;
+
+	if (length <= CANTP_SF_DATA) {
+		pci[0] = CANTP_PCI_SF;
+		pci[1] = (uint8_t)length;
+		pciLength = 2;
+		if (length <= 7) {
+			pci[0] |= (uint8_t)length;
+			pciLength = 1;
+		}
+		size = (uint8_t)length;
+	}
+	else {
+		if (length <= CANTP_FF_SHORT_MAX) {
+			pci[0] = CANTP_PCI_FF | (uint8_t)(length >> 8);
+			pci[1] = (uint8_t)length;
+			pciLength = 2;
+		}
+		else {
+			pci[0] = CANTP_PCI_FF;
+			pci[1] = 0;
+			pci[2] = (uint8_t)(length >> 24);
+			pci[3] = (uint8_t)(length >> 16);
+			pci[4] = (uint8_t)(length >> 8);
+			pci[5] = (uint8_t)length;
+			pciLength = 6;
+		}
+		size = CAN_MAX_DATA - pciLength;
+	}
+
+	const uint8_t *data = CanTp_TxSource(0, size, CanTp_TxContext);
+	uint32_t primask = __get_PRIMASK();
+
+	// The flow control may come back before this function would get to set the state
+	__disable_irq();
+	CanTp_TxState = length <= CANTP_SF_DATA ? CANTP_TX_DRAIN : CANTP_TX_WAIT_FC;
+	CanTp_TxTimer = now;
+	if (Can_SendDirect(CANTP_ID_BASE + CanTp_Node, CANTP_FRAME_FLAGS, pci, pciLength, data, size)) {
+		CanTp_TxOffset = size;
+		CanTp_TxSequence = 1;
+		CanTp_TxStart = CanTp_TxLastFrame = now;
+	}
+	else {
+		CanTp_TxState = CANTP_TX_START;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Folgerahmen in alle freien Plätze des TX-FIFO, bis der Block oder die Daten zu Ende sind
+ */
+static void CanTp_TxPump(uint32_t now) {
+	uint32_t budget = Can_GetTxFree();
+
+	if (CanTp_TxStMin != 0) {
+		if (now - CanTp_TxLastFrame < CanTp_StMinMs(CanTp_TxStMin))
+			return;
+		if (budget > 1)
+			budget = 1;
+	}
+
+	while (budget-- > 0 && CanTp_TxState == CANTP_TX_SEND) {
+		uint32_t size = CanTp_TxLength - CanTp_TxOffset;
+		uint8_t pci = CANTP_PCI_CF | CanTp_TxSequence;
+
+		if (size > CANTP_CF_DATA)
+			size = CANTP_CF_DATA;
+
+		const uint8_t *data = CanTp_TxSource(CanTp_TxOffset, (uint8_t)size, CanTp_TxContext);
+		uint32_t primask = __get_PRIMASK();
+
+		__disable_irq();
+		if (!Can_SendDirect(CANTP_ID_BASE + CanTp_Node, CANTP_FRAME_FLAGS, &pci, 1, data, (uint8_t)size)) {
+			__set_PRIMASK(primask);
+			break;
+		}
+		CanTp_TxOffset += size;
+		CanTp_TxSequence = (CanTp_TxSequence + 1) & 0x0F;
+		CanTp_TxLastFrame = now;
+		if (CanTp_TxOffset == CanTp_TxLength) {
+			CanTp_TxState = CANTP_TX_DRAIN;
+		}
+		else if (CanTp_TxBlockSize != 0 && --CanTp_TxBlockLeft == 0) {
+			CanTp_TxTimer = now;
+			CanTp_TxState = CANTP_TX_WAIT_FC;
+		}
+		__set_PRIMASK(primask);
+	}
+}
+
+/**
+ * @brief  Flow Control an den Sender; bei vollem TX-FIFO über die Warteschlange von Can.c
+ */
+static void CanTp_SendFlowControl(uint8_t status) {
+	uint8_t fc[3] = { CANTP_PCI_FC | status, CANTP_BLOCK_SIZE, CANTP_STMIN };
+
+	if (!Can_SendDirect(CANTP_ID_BASE + CanTp_Node, CANTP_FRAME_FLAGS, fc, sizeof(fc), NULL, 0)) {
+		Can_Message message = { .id = CANTP_ID_BASE + CanTp_Node, .length = sizeof(fc), .flags = CANTP_FRAME_FLAGS };
+		memcpy(message.data, fc, sizeof(fc));
+		Can_Send(&message);
+	}
+}
+
+/**
+ * @brief  STmin in ms: 0x01-0x7F direkt, 0xF1-0xF9 (100-900 us) als 1 ms, Rest reserviert = 127 ms
+ */
+static uint32_t CanTp_StMinMs(uint8_t stMin) {
+	if (stMin <= 0x7F)
+		return stMin;
+	if (stMin >= 0xF1 && stMin <= 0xF9)
+		return 1;
+	return 0x7F;
+}
+
+/**
+ * @brief  Quelle für CanTp_Send(): Zeiger direkt in den Speicherbereich
+ */
+static const uint8_t* CanTp_MemorySource(uint32_t offset, uint8_t length, void *context) {
+	return (const uint8_t *)context + offset;
+}
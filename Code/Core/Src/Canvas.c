@@ -0,0 +1,745 @@
+/**
+ * @file    Canvas.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Gemeinsame Zeichenfläche für TFT, OLED und LED-Matrix
+ *
+ * Formen, Bitmaps und Text werden einmal geschrieben und laufen auf jedem der drei Displays.
+ * Die Primitive schneiden auf die Fläche zu und zerlegen alles in Rechtecke (fillRect) und
+ * 1-Bit-Bitmaps (drawBitmap, Zeilen mit dem höchsten Bit links, wie die Zeilenbytes der
+ * LED-Matrix). Jedes Backend setzt beides in seinem eigenen Speicherlayout um:
+ * - TFT: Rechtecke als Farbfüllung des ILI9341 (bzw. in den Framebuffer), Bitmaps als ein
+ *   Fenster, in das die Zeilenpuffer RGB565 per DMA streamen
+ * - OLED: Rechtecke als Bytemasken je Seite, Bitmaps in Bändern zu 8 Zeilen in Spaltenbytes
+ *   gedreht und mit ssd1306_DrawColumns() in die Seiten geschoben
+ * - LED-Matrix: Rechtecke und Bitmaps als Masken auf den Zeilenbytes der Module
+ * Linien, Kreise und skalierte Bitmaps entstehen aus waagerechten bzw. senkrechten Läufen,
+ * nie Pixel für Pixel über fillRect.
+ *
+ * Die Backends behalten ihre Dirty-Verwaltung: der Framebuffer des TFT seine Rechtecke, das
+ * SSD1306 die Spannen je Seite, die Matrix den Vergleich mit dem zuletzt gesendeten Bild.
+ * Canvas_Flush() überträgt deshalb nur, was sich geändert hat. Ohne Framebuffer zeichnet das
+ * TFT sofort, Canvas_Flush() hat dort nichts zu tun.
+ *
+ * Farben sind RGB565. SSD1306 und Matrix setzen jedes Pixel, dessen Farbe nicht schwarz ist.
+ *
+ * Bildtakt: Canvas_FrameFlush() startet die Übertragungen aller drei Displays auf einmal, jedes
+ * auf seinem Bus und DMA-Stream (OLED I2C1, Matrix SPI4, TFT SPI1), und kehrt zurück, ohne auf
+ * sie zu warten. Zuerst kommen die beiden, die vollständig im Interrupt weiterlaufen, zuletzt
+ * das TFT, dessen Framebuffer die CPU in die Zeilenpuffer kopiert. Die Abschluss-Callbacks der
+ * Treiber melden das Ende; ein Bild dauert so lange wie der langsamste Bus statt der Summe.
+ * Sendet ein Display zum nächsten Takt noch, wird es in diesem Takt ausgelassen (skipped), seine
+ * Änderungen bleiben markiert und gehen mit dem folgenden hinaus.
+ *
+ * Bildbudget: Canvas_FrameBegin() zu Beginn des Zeichnens startet die Uhr des Bilds, ein Bild
+ * dauert vom Zeichnen bis zum Ende der langsamsten Übertragung. Ist das länger als budgetUs
+ * (Canvas_FrameSetBudget()), wird es als Überschreitung gezählt, zusammen mit dem langsamsten
+ * Display und dem Teil, der am längsten gezeichnet hat. Teile (z.B. Widgets) melden ihre
+ * Zeichenzeit mit Canvas_FrameCharge(); Canvas.c merkt sich nur den Zeiger, zuordnen muss der
+ * Meldende selbst.
+ */
+
+#include "Canvas.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_Tile.h"
+#include "LED_Matrix.h"
+#include "FixMath.h"
+#include "InputLatency.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Bytes je Glyphenzeile (Fonts bis 16 Pixel breit) und höchste Glyphe */
+#define CANVAS_GLYPH_STRIDE       2
+#define CANVAS_GLYPH_MAX_HEIGHT   32
+
+#define CANVAS_ON(color)          (((color) & 0xFFFFUL) != 0)
+
+/* Displays des Bildtakts in Startreihenfolge */
+#define CANVAS_FRAME_COUNT        3
+
+static void Canvas_Blit(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, uint8_t scale, Canvas_Color fg, Canvas_Color bg);
+static int16_t Canvas_CircleHalf(int16_t r, int16_t dy);
+static void Canvas_FrameComplete(Canvas *canvas);
+static void Canvas_FrameFinish(void);
+static void Canvas_OledDone(void);
+static void Canvas_MatrixDone(void);
+static void Canvas_TftDone(void);
+
+static void Canvas_TftFillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color);
+static uint8_t Canvas_TftDrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, Canvas_Color fg, Canvas_Color bg);
+static uint8_t Canvas_TftFlush(Canvas *canvas);
+static uint8_t Canvas_TftIsBusy(Canvas *canvas);
+static void Canvas_OledFillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color);
+static uint8_t Canvas_OledDrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, Canvas_Color fg, Canvas_Color bg);
+static uint8_t Canvas_OledFlush(Canvas *canvas);
+static uint8_t Canvas_OledIsBusy(Canvas *canvas);
+static void Canvas_MatrixFillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color);
+static uint8_t Canvas_MatrixDrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, Canvas_Color fg, Canvas_Color bg);
+static uint8_t Canvas_MatrixFlush(Canvas *canvas);
+static uint8_t Canvas_MatrixIsBusy(Canvas *canvas);
+
+static const Canvas_Backend Canvas_TftBackend = {
+	Canvas_TftFillRect, Canvas_TftDrawBitmap, Canvas_TftFlush, Canvas_TftIsBusy
+};
+static const Canvas_Backend Canvas_OledBackend = {
+	Canvas_OledFillRect, Canvas_OledDrawBitmap, Canvas_OledFlush, Canvas_OledIsBusy
+};
+static const Canvas_Backend Canvas_MatrixBackend = {
+	Canvas_MatrixFillRect, Canvas_MatrixDrawBitmap, Canvas_MatrixFlush, Canvas_MatrixIsBusy
+};
+
+Canvas Canvas_Tft = { &Canvas_TftBackend, 0, 0, "tft" };
+Canvas Canvas_Oled = { &Canvas_OledBackend, SSD1306_WIDTH, SSD1306_HEIGHT, "oled" };
+Canvas Canvas_Matrix = { &Canvas_MatrixBackend, 8 * LED_MATRIX_MODULES, LED_MATRIX_ROWS, "matrix" };
+
+static Canvas *const Canvas_Frame[CANVAS_FRAME_COUNT] = { &Canvas_Oled, &Canvas_Matrix, &Canvas_Tft };
+
+static Canvas_FrameStats Canvas_FrameStatistics = { .budgetUs = CANVAS_FRAME_BUDGET_US };
+static uint32_t Canvas_FrameStart;
+static volatile uint8_t Canvas_FrameOutstanding = 0;   // laufende Übertragungen + 1 während des Starts
+static uint32_t Canvas_FrameUs;
+static uint32_t Canvas_FrameSerialUs;
+static const Canvas *Canvas_FrameSlowest;
+
+// Drawing phase of the next frame, from Canvas_FrameBegin() up to Canvas_FrameFlush()
+static uint32_t Canvas_RenderStart;
+static uint8_t Canvas_Rendering = 0;
+static const void *Canvas_RenderPart;
+static uint32_t Canvas_RenderPartCycles;
+
+// Drawing phase of the frame in flight, judged against the budget once all displays are done
+static uint32_t Canvas_FrameRenderUs;
+static const void *Canvas_FramePart;
+static uint32_t Canvas_FramePartCycles;
+
+/**
+ * @brief  Übernimmt die Größe des TFT und meldet die Abschluss-Callbacks der Treiber an;
+ *         nach ILI9341_SetOrientation() aufrufen
+ * @note   Belegt den Transfer-Complete-Callback des ILI9341 (ILI9341_SetTransferCompleteCallback())
+ */
+void Canvas_Init(void) {
+	Canvas_Tft.width = ILI9341_WIDTH;
+	Canvas_Tft.height = ILI9341_HEIGHT;
+
+	ssd1306_SetUpdateCompleteCallback(Canvas_OledDone);
+	LED_Matrix_set_complete_callback(Canvas_MatrixDone);
+	ILI9341_SetTransferCompleteCallback(Canvas_TftDone);
+}
+
+/* --------------------------------- Formen --------------------------------- */
+
+void Canvas_Fill(Canvas *canvas, Canvas_Color color) {
+	canvas->backend->fillRect(canvas, 0, 0, canvas->width, canvas->height, color);
+}
+
+/**
+ * @brief  Gefülltes Rechteck, wird auf die Fläche zugeschnitten
+ */
+void Canvas_FillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color) {
+	if (w <= 0 || h <= 0) return;
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > canvas->width) w = canvas->width - x;
+	if (y + h > canvas->height) h = canvas->height - y;
+	if (w <= 0 || h <= 0) return;
+
+	canvas->backend->fillRect(canvas, x, y, w, h, color);
+}
+
+void Canvas_DrawPixel(Canvas *canvas, int16_t x, int16_t y, Canvas_Color color) {
+	Canvas_FillRect(canvas, x, y, 1, 1, color);
+}
+
+void Canvas_DrawHLine(Canvas *canvas, int16_t x, int16_t y, int16_t w, Canvas_Color color) {
+	Canvas_FillRect(canvas, x, y, w, 1, color);
+}
+
+void Canvas_DrawVLine(Canvas *canvas, int16_t x, int16_t y, int16_t h, Canvas_Color color) {
+	Canvas_FillRect(canvas, x, y, 1, h, color);
+}
+
+/**
+ * @brief  Rahmen eines Rechtecks, 1 Pixel breit
+ */
+void Canvas_DrawRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color) {
+	if (w <= 0 || h <= 0) return;
+
+	Canvas_DrawHLine(canvas, x, y, w, color);
+	if (h > 1) Canvas_DrawHLine(canvas, x, y + h - 1, w, color);
+	if (h > 2) {
+		Canvas_DrawVLine(canvas, x, y + 1, h - 2, color);
+		if (w > 1) Canvas_DrawVLine(canvas, x + w - 1, y + 1, h - 2, color);
+	}
+}
+
+/**
+ * @brief  Linie nach Bresenham, zusammenhängende Pixel einer Zeile bzw. Spalte als ein Lauf
+ */
+void Canvas_DrawLine(Canvas *canvas, int16_t x0, int16_t y0, int16_t x1, int16_t y1, Canvas_Color color) {
+	int16_t dx = abs(x1 - x0), dy = abs(y1 - y0);
+	int16_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+
+	if (dx >= dy) {
+		// Flat: one horizontal run per row
+		int16_t err = dx / 2, start = x0;
+		for (int16_t i = 0; i < dx; i++) {
+			err -= dy;
+			if (err < 0) {
+				Canvas_DrawHLine(canvas, sx > 0 ? start : x0, y0, abs(x0 - start) + 1, color);
+				y0 += sy;
+				err += dx;
+				start = x0 + sx;
+			}
+			x0 += sx;
+		}
+		Canvas_DrawHLine(canvas, sx > 0 ? start : x0, y0, abs(x0 - start) + 1, color);
+	} else {
+		// Steep: one vertical run per column
+		int16_t err = dy / 2, start = y0;
+		for (int16_t i = 0; i < dy; i++) {
+			err -= dx;
+			if (err < 0) {
+				Canvas_DrawVLine(canvas, x0, sy > 0 ? start : y0, abs(y0 - start) + 1, color);
+				x0 += sx;
+				err += dy;
+				start = y0 + sy;
+			}
+			y0 += sy;
+		}
+		Canvas_DrawVLine(canvas, x0, sy > 0 ? start : y0, abs(y0 - start) + 1, color);
+	}
+}
+
+/**
+ * @brief  Kreislinie; je Zeile die Läufe zwischen dieser und der nächsten Halbbreite, ohne Lücken
+ */
+void Canvas_DrawCircle(Canvas *canvas, int16_t x0, int16_t y0, int16_t r, Canvas_Color color) {
+	if (r < 0) return;
+
+	for (int16_t dy = 0; dy <= r; dy++) {
+		int16_t outer = Canvas_CircleHalf(r, dy);
+		int16_t inner = dy < r ? Canvas_CircleHalf(r, dy + 1) : -1;
+		int16_t length = outer > inner ? outer - inner : 1;
+
+		if (dy == r) {
+			// Top and bottom row are a single run across
+			Canvas_DrawHLine(canvas, x0 - outer, y0 - dy, 2 * outer + 1, color);
+			if (dy > 0) Canvas_DrawHLine(canvas, x0 - outer, y0 + dy, 2 * outer + 1, color);
+			continue;
+		}
+		Canvas_DrawHLine(canvas, x0 - outer, y0 - dy, length, color);
+		Canvas_DrawHLine(canvas, x0 + outer - length + 1, y0 - dy, length, color);
+		if (dy > 0) {
+			Canvas_DrawHLine(canvas, x0 - outer, y0 + dy, length, color);
+			Canvas_DrawHLine(canvas, x0 + outer - length + 1, y0 + dy, length, color);
+		}
+	}
+}
+
+/**
+ * @brief  Gefüllter Kreis, ein Lauf je Zeile
+ */
+void Canvas_FillCircle(Canvas *canvas, int16_t x0, int16_t y0, int16_t r, Canvas_Color color) {
+	if (r < 0) return;
+
+	for (int16_t dy = 0; dy <= r; dy++) {
+		int16_t half = Canvas_CircleHalf(r, dy);
+		Canvas_DrawHLine(canvas, x0 - half, y0 - dy, 2 * half + 1, color);
+		if (dy > 0) Canvas_DrawHLine(canvas, x0 - half, y0 + dy, 2 * half + 1, color);
+	}
+}
+
+/* --------------------------------- Bitmaps und Text --------------------------------- */
+
+/**
+ * @brief  1-Bit-Bitmap (Sprite), (w + 7) / 8 Bytes je Zeile, Bit 7 des ersten Bytes ist links
+ * @param  bg: Farbe der nicht gesetzten Bits oder CANVAS_TRANSPARENT
+ */
+void Canvas_DrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t w, uint16_t h,
+		Canvas_Color fg, Canvas_Color bg) {
+	Canvas_Blit(canvas, x, y, bits, (w + 7) / 8, w, h, 1, fg, bg);
+}
+
+/**
+ * @brief  Wie Canvas_DrawBitmap(), jedes Bit als Quadrat mit scale Pixeln Kantenlänge
+ */
+void Canvas_DrawBitmapScaled(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t w, uint16_t h,
+		uint8_t scale, Canvas_Color fg, Canvas_Color bg) {
+	if (scale == 0) return;
+	Canvas_Blit(canvas, x, y, bits, (w + 7) / 8, w, h, scale, fg, bg);
+}
+
+/**
+ * @brief  Text mit einem SSD1306-Font (Fonts/ssd1306_fonts.h), auf allen Displays gleich
+ * @retval x-Position hinter dem letzten Zeichen
+ */
+int16_t Canvas_DrawText(Canvas *canvas, int16_t x, int16_t y, const char *text, const SSD1306_Font_t *font,
+		Canvas_Color fg, Canvas_Color bg) {
+	uint8_t rows[CANVAS_GLYPH_MAX_HEIGHT * CANVAS_GLYPH_STRIDE];
+
+	if (font->height > CANVAS_GLYPH_MAX_HEIGHT) return x;
+
+	for (; *text != '\0'; text++) {
+		char ch = *text;
+		if (ch < 32 || ch > 126) continue;
+
+		uint8_t width = font->char_width ? font->char_width[ch - 32] : font->width;
+		const uint16_t *glyph = &font->data[(ch - 32) * font->height];
+
+		// Font rows are 16 bit with the leftmost pixel in bit 15, i.e. two bitmap bytes
+		for (uint8_t i = 0; i < font->height; i++) {
+			rows[i * CANVAS_GLYPH_STRIDE] = (uint8_t)(glyph[i] >> 8);
+			rows[i * CANVAS_GLYPH_STRIDE + 1] = (uint8_t)glyph[i];
+		}
+		Canvas_Blit(canvas, x, y, rows, CANVAS_GLYPH_STRIDE, width, font->height, 1, fg, bg);
+		x += width;
+	}
+	return x;
+}
+
+/**
+ * @brief  Breite eines Texts in Pixeln
+ */
+uint16_t Canvas_MeasureText(const char *text, const SSD1306_Font_t *font) {
+	uint16_t width = 0;
+
+	for (; *text != '\0'; text++) {
+		char ch = *text;
+		if (ch >= 32 && ch <= 126)
+			width += font->char_width ? font->char_width[ch - 32] : font->width;
+	}
+	return width;
+}
+
+/* --------------------------------- Übertragung --------------------------------- */
+
+/**
+ * @brief  Überträgt die veränderten Bereiche des Displays, ohne auf das Ende zu warten
+ * @retval 0 wenn das Display noch mit dem vorigen Bild beschäftigt ist (später erneut aufrufen)
+ */
+uint8_t Canvas_Flush(Canvas *canvas) {
+	return canvas->backend->flush(canvas);
+}
+
+uint8_t Canvas_IsBusy(Canvas *canvas) {
+	return canvas->backend->isBusy(canvas);
+}
+
+/* --------------------------------- Bildtakt --------------------------------- */
+
+/**
+ * @brief  Beginn eines Bilds vor dem ersten Zeichnen; die Zeit bis Canvas_FrameFlush() zählt zum Budget
+ */
+void Canvas_FrameBegin(void) {
+	Canvas_RenderStart = DWT->CYCCNT;
+	Canvas_RenderPart = NULL;
+	Canvas_RenderPartCycles = 0;
+	Canvas_Rendering = 1;
+}
+
+/**
+ * @brief  Meldet die Zeichenzeit eines Teils des laufenden Bilds (vor Canvas_FrameFlush())
+ * @param  part: Kennung des Teils, z.B. das Widget; landet bei einer Überschreitung in overrunPart
+ * @param  cycles: CPU-Takte
+ */
+void Canvas_FrameCharge(const void *part, uint32_t cycles) {
+	if (cycles > Canvas_RenderPartCycles) {
+		Canvas_RenderPart = part;
+		Canvas_RenderPartCycles = cycles;
+	}
+}
+
+/**
+ * @brief  Setzt das Budget eines Bilds in µs, 0 schaltet die Prüfung ab
+ */
+void Canvas_FrameSetBudget(uint32_t us) {
+	Canvas_FrameStatistics.budgetUs = us;
+}
+
+/**
+ * @brief  Startet die Übertragung aller Displays, deren voriges Bild fertig ist, und kehrt sofort zurück
+ * @retval Zahl der gestarteten Displays
+ */
+uint8_t Canvas_FrameFlush(void) {
+	uint8_t started = 0;
+	uint32_t renderUs = Canvas_Rendering ? (DWT->CYCCNT - Canvas_RenderStart) / (SystemCoreClock / 1000000UL) : 0;
+
+	Canvas_Rendering = 0;
+	if (renderUs > Canvas_FrameStatistics.maxRenderUs) Canvas_FrameStatistics.maxRenderUs = renderUs;
+	Canvas_FrameStatistics.lastRenderUs = renderUs;
+
+	// The extra count keeps a display that finishes right away from closing the frame early
+	__disable_irq();
+	if (Canvas_FrameOutstanding == 0) {
+		Canvas_FrameStart = DWT->CYCCNT;
+		Canvas_FrameUs = 0;
+		Canvas_FrameSerialUs = 0;
+		Canvas_FrameSlowest = NULL;
+		Canvas_FrameRenderUs = renderUs;
+		Canvas_FramePart = Canvas_RenderPart;
+		Canvas_FramePartCycles = Canvas_RenderPartCycles;
+	}
+	Canvas_FrameOutstanding++;
+	__enable_irq();
+
+	for (uint8_t i = 0; i < CANVAS_FRAME_COUNT; i++) {
+		Canvas *canvas = Canvas_Frame[i];
+
+		if (canvas->pending || !canvas->backend->flush(canvas)) {
+			canvas->skipped++;
+			continue;
+		}
+		started++;
+
+		// Completion callbacks only count once pending is set; nothing left to send finishes here
+		__disable_irq();
+		if (canvas == &Canvas_Tft) InputLatency_Flush();
+		canvas->pending = 1;
+		Canvas_FrameOutstanding++;
+		if (!canvas->backend->isBusy(canvas)) {
+			Canvas_FrameComplete(canvas);
+		}
+		__enable_irq();
+	}
+
+	__disable_irq();
+	if (--Canvas_FrameOutstanding == 0 && started > 0) {
+		Canvas_FrameFinish();
+	}
+	__enable_irq();
+	return started;
+}
+
+/**
+ * @brief  Gibt an, ob alle Displays das zuletzt gestartete Bild übertragen haben
+ */
+uint8_t Canvas_FrameIsDone(void) {
+	return Canvas_FrameOutstanding == 0;
+}
+
+const Canvas_FrameStats* Canvas_GetFrameStats(void) {
+	return &Canvas_FrameStatistics;
+}
+
+void Canvas_FrameReset(void) {
+	__disable_irq();
+	Canvas_FrameStatistics = (Canvas_FrameStats){ .budgetUs = Canvas_FrameStatistics.budgetUs };
+	for (uint8_t i = 0; i < CANVAS_FRAME_COUNT; i++) {
+		Canvas_Frame[i]->lastUs = 0;
+		Canvas_Frame[i]->maxUs = 0;
+		Canvas_Frame[i]->skipped = 0;
+	}
+	__enable_irq();
+}
+
+/**
+ * @brief  Gibt Bilddauer und die Zeiten je Display aus
+ */
+void Canvas_FrameDump(void) {
+	Canvas_FrameStats s = Canvas_FrameStatistics;
+
+	printf("Bilder %lu: zuletzt %lu us (nacheinander %lu us), max %lu us\n",
+			s.frames, s.lastUs, s.lastSerialUs, s.maxUs);
+	printf("Zeichnen zuletzt %lu us, max %lu us; Budget %lu us, überschritten %lu", s.lastRenderUs,
+			s.maxRenderUs, s.budgetUs, s.overruns);
+	if (s.overruns > 0) {
+		printf(" (zuletzt %lu us, langsamstes Display %s, längster Teil %lu us)", s.lastOverrunUs,
+				s.overrunDisplay ? s.overrunDisplay : "-", s.overrunPartUs);
+	}
+	printf("\n");
+	for (uint8_t i = 0; i < CANVAS_FRAME_COUNT; i++) {
+		const Canvas *canvas = Canvas_Frame[i];
+		printf("  %-6s %3dx%-3d zuletzt %6lu us, max %6lu us, ausgelassen %lu%s\n", canvas->name,
+				canvas->width, canvas->height, canvas->lastUs, canvas->maxUs, canvas->skipped,
+				canvas->pending ? " (sendet)" : "");
+	}
+}
+
+/**
+ * @brief  Ende der Übertragung eines Displays, aus dem Interrupt oder mit gesperrten Interrupts
+ */
+static void Canvas_FrameComplete(Canvas *canvas) {
+	if (!canvas->pending) return;
+
+	uint32_t us = (DWT->CYCCNT - Canvas_FrameStart) / (SystemCoreClock / 1000000UL);
+	canvas->pending = 0;
+	canvas->lastUs = us;
+	if (us > canvas->maxUs) canvas->maxUs = us;
+	if (us > Canvas_FrameUs) {
+		Canvas_FrameUs = us;
+		Canvas_FrameSlowest = canvas;
+	}
+	Canvas_FrameSerialUs += us;
+	if (canvas == &Canvas_Tft) InputLatency_Photon();
+
+	if (--Canvas_FrameOutstanding == 0) {
+		Canvas_FrameFinish();
+	}
+}
+
+/**
+ * @brief  Alle Displays fertig: Dauer des Bilds übernehmen und mit dem Budget vergleichen
+ */
+static void Canvas_FrameFinish(void) {
+	Canvas_FrameStats *s = &Canvas_FrameStatistics;
+	uint32_t totalUs = Canvas_FrameRenderUs + Canvas_FrameUs;
+
+	s->frames++;
+	s->lastUs = Canvas_FrameUs;
+	s->lastSerialUs = Canvas_FrameSerialUs;
+	if (Canvas_FrameUs > s->maxUs) s->maxUs = Canvas_FrameUs;
+
+	if (s->budgetUs != 0 && totalUs > s->budgetUs) {
+		s->overruns++;
+		s->lastOverrunUs = totalUs;
+		s->overrunDisplay = Canvas_FrameSlowest ? Canvas_FrameSlowest->name : NULL;
+		s->overrunPart = Canvas_FramePart;
+		s->overrunPartUs = Canvas_FramePartCycles / (SystemCoreClock / 1000000UL);
+	}
+}
+
+static void Canvas_OledDone(void) {
+	Canvas_FrameComplete(&Canvas_Oled);
+}
+
+static void Canvas_MatrixDone(void) {
+	Canvas_FrameComplete(&Canvas_Matrix);
+}
+
+/**
+ * @brief  Kommt nach jedem DMA-Block des ILI9341; pending wird erst gesetzt, wenn alle Blöcke
+ *         des Framebuffers übergeben sind, frühere Blöcke zählen deshalb nicht
+ */
+static void Canvas_TftDone(void) {
+	Canvas_FrameComplete(&Canvas_Tft);
+}
+
+/**
+ * @brief  Zeichnet eine Bitmap über das Backend oder, wo es das nicht kann, als Läufe
+ */
+static void Canvas_Blit(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, uint8_t scale, Canvas_Color fg, Canvas_Color bg) {
+	int16_t right = x + (int16_t)(w * scale), bottom = y + (int16_t)(h * scale);
+
+	if (w == 0 || h == 0 || right <= 0 || bottom <= 0 || x >= canvas->width || y >= canvas->height)
+		return;
+
+	if (scale == 1 && bg != CANVAS_TRANSPARENT && x >= 0 && y >= 0
+			&& right <= canvas->width && bottom <= canvas->height
+			&& canvas->backend->drawBitmap(canvas, x, y, bits, stride, w, h, fg, bg))
+		return;
+
+	// Runs of equal bits per row; transparent background runs are skipped
+	for (uint16_t row = 0; row < h; row++) {
+		const uint8_t *line = &bits[row * stride];
+		uint16_t col = 0;
+
+		while (col < w) {
+			uint8_t set = (line[col >> 3] >> (7 - (col & 7))) & 1;
+			uint16_t start = col;
+			while (col < w && ((line[col >> 3] >> (7 - (col & 7))) & 1) == set)
+				col++;
+
+			if (set || bg != CANVAS_TRANSPARENT)
+				Canvas_FillRect(canvas, x + start * scale, y + row * scale, (col - start) * scale, scale, set ? fg : bg);
+		}
+	}
+}
+
+/**
+ * @brief  Halbe Breite des Kreises mit Radius r in der Zeile dy (r + 1/2 gerundet)
+ */
+static int16_t Canvas_CircleHalf(int16_t r, int16_t dy) {
+	return (int16_t)FixMath_ISqrt((uint32_t)((int32_t)r * r + r - (int32_t)dy * dy));
+}
+
+/* --------------------------------- TFT (ILI9341) --------------------------------- */
+
+static void Canvas_TftFillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color) {
+	ILI9341_fillRect(x, y, w, h, (uint16_t)color);
+}
+
+/**
+ * @brief  Rastert Zeilenbänder einer Bitmap in die Zeilenpuffer (RGB565, High-Byte zuerst)
+ *
+ * Mit Framebuffer gehen die Bänder in den RAM, sonst in ein Fenster, in das sie per DMA
+ * streamen. Nimmt der Kachel-Renderer gerade auf, zeichnet Canvas.c als Läufe.
+ */
+static uint8_t Canvas_TftDrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, Canvas_Color fg, Canvas_Color bg) {
+	uint16_t rowsPerBuffer = ILI9341_LINE_BUFFER_SIZE / (w * 2);
+	uint8_t fgHigh = (uint8_t)(fg >> 8), fgLow = (uint8_t)fg;
+	uint8_t bgHigh = (uint8_t)(bg >> 8), bgLow = (uint8_t)bg;
+	uint8_t direct = 1;
+
+	if (rowsPerBuffer == 0) return 0;
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording()) return 0;
+#endif
+#ifdef ILI9341_USE_FRAMEBUFFER
+	direct = !ILI9341_FB_IsEnabled();
+#endif
+
+	if (direct) {
+		ILI9341_BeginWrite(x, y, x + w - 1, y + h - 1);
+		ILI9341_StreamBegin();
+	}
+	for (uint16_t row = 0; row < h; row += rowsPerBuffer) {
+		uint16_t rowTo = (row + rowsPerBuffer < h) ? row + rowsPerBuffer : h;
+		uint8_t *buffer = ILI9341_StreamGetBuffer();
+		uint8_t *out = buffer;
+
+		for (uint16_t r = row; r < rowTo; r++) {
+			const uint8_t *line = &bits[r * stride];
+			for (uint16_t col = 0; col < w; col++) {
+				uint8_t set = line[col >> 3] & (0x80 >> (col & 7));
+				*out++ = set ? fgHigh : bgHigh;
+				*out++ = set ? fgLow : bgLow;
+			}
+		}
+
+		if (direct) {
+			ILI9341_StreamSubmit((uint32_t)(rowTo - row) * w * 2);
+		}
+#ifdef ILI9341_USE_FRAMEBUFFER
+		else {
+			ILI9341_FB_DrawImage(x, y + row, w, rowTo - row, buffer);
+		}
+#endif
+	}
+	if (direct) {
+		ILI9341_StreamEnd();
+	}
+	return 1;
+}
+
+static uint8_t Canvas_TftFlush(Canvas *canvas) {
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_Flush();
+	}
+#endif
+	return 1;
+}
+
+static uint8_t Canvas_TftIsBusy(Canvas *canvas) {
+	return ILI9341_IsBusy();
+}
+
+/* --------------------------------- OLED (SSD1306) --------------------------------- */
+
+static void Canvas_OledFillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color) {
+	ssd1306_FillRectangle(x, y, x + w - 1, y + h - 1, CANVAS_ON(color) ? White : Black);
+}
+
+/**
+ * @brief  Dreht Bänder zu 8 Zeilen in Spaltenbytes (Bit 0 oben) und schreibt sie in die Seiten
+ */
+static uint8_t Canvas_OledDrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, Canvas_Color fg, Canvas_Color bg) {
+	uint8_t columns[SSD1306_WIDTH];
+	uint8_t fgOn = CANVAS_ON(fg);
+
+	if (fgOn == CANVAS_ON(bg)) {
+		Canvas_OledFillRect(canvas, x, y, w, h, fg);
+		return 1;
+	}
+
+	for (uint16_t row = 0; row < h; row += 8) {
+		uint8_t rows = h - row < 8 ? h - row : 8;
+
+		for (uint16_t col = 0; col < w; col++) {
+			uint8_t mask = 0x80 >> (col & 7), value = 0;
+			const uint8_t *source = &bits[row * stride + (col >> 3)];
+			for (uint8_t k = 0; k < rows; k++, source += stride) {
+				if (*source & mask) value |= 1 << k;
+			}
+			columns[col] = value;
+		}
+		// Set bits get the given colour, the rest the inverse: exactly fg/bg when they differ
+		ssd1306_DrawColumns(x, y + row, columns, w, rows, fgOn ? White : Black);
+	}
+	return 1;
+}
+
+static uint8_t Canvas_OledFlush(Canvas *canvas) {
+	ssd1306_UpdateScreen();
+	return 1;
+}
+
+static uint8_t Canvas_OledIsBusy(Canvas *canvas) {
+	return ssd1306_IsBusy();
+}
+
+/* --------------------------------- LED-Matrix (MAX7219) --------------------------------- */
+
+/**
+ * @brief  Bits der Spalten first..last innerhalb eines Moduls (Bit 7 = linke Spalte)
+ */
+static uint8_t Canvas_MatrixMask(int16_t first, int16_t last) {
+	if (last < 0 || first > 7) return 0;
+	if (first < 0) first = 0;
+	if (last > 7) last = 7;
+	return (uint8_t)((0xFF >> first) & (0xFF << (7 - last)));
+}
+
+/**
+ * @brief  8 Bits einer Bitmapzeile ab Spalte offset (auch negativ), außerhalb 0
+ */
+static uint8_t Canvas_MatrixBits(const uint8_t *line, uint16_t stride, int16_t offset) {
+	if (offset < 0) {
+		return offset > -8 ? line[0] >> -offset : 0;
+	}
+	uint16_t index = offset >> 3;
+	uint8_t shift = offset & 7;
+	if (index >= stride) return 0;
+
+	uint8_t value = (uint8_t)(line[index] << shift);
+	if (shift != 0 && index + 1 < stride) value |= line[index + 1] >> (8 - shift);
+	return value;
+}
+
+static void Canvas_MatrixFillRect(Canvas *canvas, int16_t x, int16_t y, int16_t w, int16_t h, Canvas_Color color) {
+	uint8_t on = CANVAS_ON(color);
+
+	for (uint8_t module = x >> 3; module <= (x + w - 1) >> 3; module++) {
+		uint8_t mask = Canvas_MatrixMask(x - 8 * module, x + w - 1 - 8 * module);
+		for (int16_t row = y; row < y + h; row++) {
+			uint8_t value = LED_Matrix_get_row(row, module);
+			LED_Matrix_set_row(row, module, on ? value | mask : value & ~mask);
+		}
+	}
+}
+
+/**
+ * @brief  Schiebt je Zeile und Modul 8 Bits der Bitmap auf das Zeilenbyte
+ */
+static uint8_t Canvas_MatrixDrawBitmap(Canvas *canvas, int16_t x, int16_t y, const uint8_t *bits, uint16_t stride,
+		uint16_t w, uint16_t h, Canvas_Color fg, Canvas_Color bg) {
+	uint8_t fgBits = CANVAS_ON(fg) ? 0xFF : 0x00;
+	uint8_t bgBits = CANVAS_ON(bg) ? 0xFF : 0x00;
+
+	for (uint8_t module = x >> 3; module <= (x + w - 1) >> 3; module++) {
+		uint8_t mask = Canvas_MatrixMask(x - 8 * module, x + w - 1 - 8 * module);
+		for (uint16_t row = 0; row < h; row++) {
+			uint8_t source = Canvas_MatrixBits(&bits[row * stride], stride, 8 * module - x);
+			uint8_t pixels = (source & fgBits) | (~source & bgBits);
+			uint8_t value = LED_Matrix_get_row(y + row, module);
+			LED_Matrix_set_row(y + row, module, (value & ~mask) | (pixels & mask));
+		}
+	}
+	return 1;
+}
+
+static uint8_t Canvas_MatrixFlush(Canvas *canvas) {
+	return LED_Matrix_flush();
+}
+
+static uint8_t Canvas_MatrixIsBusy(Canvas *canvas) {
+	return LED_Matrix_is_busy();
+}
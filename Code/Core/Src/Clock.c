@@ -0,0 +1,351 @@
+/**
+ * @file    Clock.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Umschaltbare Taktprofile (64 MHz / 128 MHz / 280 MHz) mit PLL1 als SYSCLK
+ *
+ * SystemClock_Config() aus CubeMX lässt den Kern mit HSI (64 MHz) bei VOS3 laufen. main() setzt
+ * danach, noch vor den MX_*_Init()-Aufrufen, das Profil CLOCK_PROFILE aus Clock.h, damit alle
+ * Peripherien schon mit den endgültigen Bustakten initialisiert werden (Timer und UARTs
+ * berechnen ihre Teiler selbst aus HAL_RCC_GetPCLKxFreq()).
+ *
+ * Ein Profil legt fest: Spannungsbereich (VOS), PLL1 (M/N/P/Q/R), Flash-Wartezyklen, die
+ * Teiler der APB-Busse und den Vorteiler des OCTOSPI. Die Kerneltakte bleiben in allen Profilen
+ * gleich gewählt: SPI1 und SDMMC1 an PLL1Q (~42,7 MHz), OCTOSPI an HCLK mit eigenem Vorteiler.
+ * Die Grenzwerte aus dem Datenblatt (VCO, VOS, Flash, APB, W25Qxx ...) werden beim Übersetzen
+ * geprüft.
+ *
+ * Clock_SetProfile() schaltet auch zur Laufzeit um. Dabei läuft der Kern kurz vom HSI, PLL1 wird
+ * neu gestartet und bereits initialisierte Timer, UARTs und der OCTOSPI werden an die neuen
+ * Takte angepasst. Während der Umschaltung dürfen keine DMA-Übertragungen laufen (Display,
+ * WS2812, SD-Karte), da SPI1 und SDMMC1 für einige Mikrosekunden keinen Takt bekommen. Den
+ * printf-Sendepuffer und den ESP-Link auf UART7 hält Clock_SetProfile() selbst an (Serial_Suspend(),
+ * EspLink_Suspend() und die zugehörigen Resume-Aufrufe), ebenso den Empfang des Gamepads auf UART4.
+ * LPUART1 (Kommandozeile, Telemetrie) läuft vom HSI und bleibt von der Umschaltung unberührt.
+ *
+ * Nach dem Stop-Modus (LowPower.c) läuft der Kern vom HSI, PLL1 ist aus. Alle übrigen Einstellungen
+ * hat RCC behalten; Clock_ResumeAfterStop() schaltet deshalb nur PLL1 wieder ein und zurück, direkt
+ * über die Register und ohne die Wartezeiten der HAL auf HAL_GetTick(), das im Stop angehalten ist.
+ */
+
+#include "Clock.h"
+#include "octospi.h"
+#include "tim.h"
+#include "usart.h"
+#include "Serial.h"
+#include "EspLink.h"
+#include "Gamepad.h"
+#include "Log.h"
+#include "W25Qxx_QSPI.h"
+#include "Timebase.h"
+#include "UserInput.h"
+#include "Trace.h"
+
+/* Abgeleitete Takte eines Profils (p = LOW_POWER, BALANCED oder MAX) */
+#define CLOCK_REF_HZ             (HSI_VALUE / CLOCK_PLL_M)
+#define CLOCK_VCO_HZ(p)          (CLOCK_REF_HZ * CLOCK_##p##_PLLN)
+#define CLOCK_SYSCLK_HZ(p)       (CLOCK_VCO_HZ(p) / CLOCK_##p##_PLLP)
+#define CLOCK_PLL1Q_HZ(p)        (CLOCK_VCO_HZ(p) / CLOCK_##p##_PLLQ)
+#define CLOCK_APB_HZ(p, n)       (CLOCK_SYSCLK_HZ(p) / CLOCK_##p##_APB##n##_DIV)
+
+/* Grenzen je VOS (RM0455): höchster HCLK und Schrittweite der Flash-Wartezyklen */
+#define CLOCK_VOS_MAX_HZ(v)      ((v) == 0 ? 280000000UL : (v) == 1 ? 225000000UL : (v) == 2 ? 160000000UL : 88000000UL)
+#define CLOCK_VOS_WS_STEP_HZ(v)  ((v) == 0 ? 42000000UL : (v) == 1 ? 38000000UL : (v) == 2 ? 34000000UL : 22000000UL)
+#define CLOCK_MIN_LATENCY(p)     ((CLOCK_SYSCLK_HZ(p) + CLOCK_VOS_WS_STEP_HZ(CLOCK_##p##_VOS) - 1) \
+                                  / CLOCK_VOS_WS_STEP_HZ(CLOCK_##p##_VOS) - 1)
+#define CLOCK_APB_MAX_HZ         140000000UL
+
+/* Prüfungen für ein einzelnes Profil */
+#define CLOCK_VCO_OK(p)          (CLOCK_VCO_HZ(p) >= 192000000UL && CLOCK_VCO_HZ(p) <= 836000000UL)
+#define CLOCK_PLLP_OK(p)         (CLOCK_##p##_PLLP == 1 || (CLOCK_##p##_PLLP % 2) == 0)
+#define CLOCK_VOS_OK(p)          (CLOCK_##p##_VOS <= 3 && CLOCK_SYSCLK_HZ(p) <= CLOCK_VOS_MAX_HZ(CLOCK_##p##_VOS))
+#define CLOCK_LATENCY_OK(p)      (CLOCK_##p##_LATENCY >= CLOCK_MIN_LATENCY(p) && CLOCK_##p##_LATENCY <= 7)
+#define CLOCK_APB_OK(p)          (CLOCK_APB_HZ(p, 1) <= CLOCK_APB_MAX_HZ && CLOCK_APB_HZ(p, 2) <= CLOCK_APB_MAX_HZ \
+                                  && CLOCK_APB_HZ(p, 3) <= CLOCK_APB_MAX_HZ && CLOCK_APB_HZ(p, 4) <= CLOCK_APB_MAX_HZ)
+#define CLOCK_PCLK1_OK(p)        (CLOCK_APB_HZ(p, 1) >= CLOCK_PCLK1_MIN_HZ && CLOCK_APB_HZ(p, 1) <= CLOCK_PCLK1_MAX_HZ)
+#define CLOCK_PLL1Q_OK(p)        (CLOCK_PLL1Q_HZ(p) >= 40000000UL && CLOCK_PLL1Q_HZ(p) <= 45000000UL)
+#define CLOCK_OSPI_OK(p)         (CLOCK_SYSCLK_HZ(p) / CLOCK_##p##_OSPI_DIV <= CLOCK_OSPI_MAX_HZ)
+#define CLOCK_ALL_PROFILES(check) (check(LOW_POWER) && check(BALANCED) && check(MAX))
+
+#if CLOCK_REF_HZ < 8000000UL || CLOCK_REF_HZ > 16000000UL
+#error "CLOCK_PLL_M: Die PLL1-Referenz muss zwischen 8 und 16 MHz liegen (RCC_PLL1VCIRANGE_3)!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_VCO_OK)
+#error "Taktprofil: Der VCO von PLL1 muss zwischen 192 und 836 MHz liegen!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_PLLP_OK)
+#error "Taktprofil: PLL1P muss 1 oder gerade sein!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_VOS_OK)
+#error "Taktprofil: SYSCLK ist für den gewählten Spannungsbereich (VOS) zu hoch!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_LATENCY_OK)
+#error "Taktprofil: Zu wenige Flash-Wartezyklen für SYSCLK und VOS!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_APB_OK)
+#error "Taktprofil: Ein APB-Bus liegt über 140 MHz!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_PCLK1_OK)
+#error "Taktprofil: PCLK1 passt nicht zu den I2C-Timings (CLOCK_PCLK1_MIN_HZ/MAX_HZ)!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_PLL1Q_OK)
+#error "Taktprofil: PLL1Q muss für SPI1 und SDMMC1 zwischen 40 und 45 MHz bleiben!"
+#endif
+#if !CLOCK_ALL_PROFILES(CLOCK_OSPI_OK)
+#error "Taktprofil: Der OCTOSPI-Takt liegt über CLOCK_OSPI_MAX_HZ!"
+#endif
+
+/* Umsetzung der Zahlenwerte in HAL-Konstanten */
+#define CLOCK_VOS(v)             ((v) == 0 ? PWR_REGULATOR_VOLTAGE_SCALE0 : (v) == 1 ? PWR_REGULATOR_VOLTAGE_SCALE1 \
+                                  : (v) == 2 ? PWR_REGULATOR_VOLTAGE_SCALE2 : PWR_REGULATOR_VOLTAGE_SCALE3)
+#define CLOCK_APB_DIV(n, d)      ((d) == 1 ? RCC_APB##n##_DIV1 : (d) == 2 ? RCC_APB##n##_DIV2 : (d) == 4 ? RCC_APB##n##_DIV4 \
+                                  : (d) == 8 ? RCC_APB##n##_DIV8 : RCC_APB##n##_DIV16)
+#define CLOCK_PROFILE_INFO(p, text) { \
+		text, CLOCK_VOS(CLOCK_##p##_VOS), \
+		CLOCK_##p##_PLLN, CLOCK_##p##_PLLP, CLOCK_##p##_PLLQ, CLOCK_##p##_PLLR, \
+		CLOCK_##p##_LATENCY, \
+		CLOCK_APB_DIV(1, CLOCK_##p##_APB1_DIV), CLOCK_APB_DIV(2, CLOCK_##p##_APB2_DIV), \
+		CLOCK_APB_DIV(3, CLOCK_##p##_APB3_DIV), CLOCK_APB_DIV(4, CLOCK_##p##_APB4_DIV), \
+		CLOCK_##p##_OSPI_DIV, CLOCK_SYSCLK_HZ(p), CLOCK_PLL1Q_HZ(p) }
+
+const Clock_ProfileInfo Clock_Profiles[CLOCK_PROFILE_COUNT] = {
+	CLOCK_PROFILE_INFO(LOW_POWER, "low power 64 MHz"),
+	CLOCK_PROFILE_INFO(BALANCED, "balanced 128 MHz"),
+	CLOCK_PROFILE_INFO(MAX, "max 280 MHz"),
+};
+
+/* Aktives Profil; die Bustakte der CubeMX-Konfiguration entsprechen CLOCK_PROFILE_LOW_POWER */
+Clock_Profile Clock_CurrentProfile = CLOCK_PROFILE_LOW_POWER;
+
+static uint8_t Clock_Switch(Clock_Profile profile);
+static uint8_t Clock_VosLevel(uint32_t voltageScaling);
+static void Clock_SetVoltageScaling(uint32_t voltageScaling);
+static void Clock_ReinitPeripherals(void);
+
+/**
+ * @brief  Schaltet auf ein Taktprofil um (beim Start und zur Laufzeit)
+ * @param  profile: gewünschtes Profil
+ * @retval 1 bei Erfolg, sonst 0 (der Kern läuft dann weiter vom HSI)
+ */
+uint8_t Clock_SetProfile(Clock_Profile profile) {
+	uint8_t ok;
+
+	if (profile >= CLOCK_PROFILE_COUNT)
+		return 0;
+
+	// MX_UART7_Init() must not reconfigure the UART under a running TX or RX DMA
+	EspLink_Suspend();
+	Gamepad_Suspend();
+	Serial_Suspend(&Serial_Log);
+
+	ok = Clock_Switch(profile);
+	if (ok) {
+		Clock_ConfigOctospi();
+		Clock_ReinitPeripherals();
+	}
+
+	Serial_Resume(&Serial_Log);
+	Gamepad_Resume();
+	EspLink_Resume();
+
+	// Log time stamps are CPU cycles: tell the decoder the new rate
+	if (ok) {
+		Log_Clock();
+		Trace_Clock();
+	}
+	return ok;
+}
+
+/**
+ * @brief  Stellt Spannung, PLL1 und Bustakte auf das Profil um
+ * @retval 1 bei Erfolg, sonst 0
+ */
+static uint8_t Clock_Switch(Clock_Profile profile) {
+	RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+	RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+	RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+	const Clock_ProfileInfo *info = &Clock_Profiles[profile];
+	uint8_t raise;
+
+	// A higher core voltage has to be in place before the clock goes up
+	raise = Clock_VosLevel(info->voltageScaling) < Clock_VosLevel(HAL_PWREx_GetVoltageRange());
+	if (raise)
+		Clock_SetVoltageScaling(info->voltageScaling);
+
+	// PLL1 can only be reconfigured while it is not the system clock: run from HSI meanwhile.
+	// HSI (64 MHz) is within the limits of every VOS with the target latency.
+	RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK
+			| RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2
+			| RCC_CLOCKTYPE_D3PCLK1 | RCC_CLOCKTYPE_D1PCLK1;
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+	RCC_ClkInitStruct.SYSCLKDivider = RCC_SYSCLK_DIV1;
+	RCC_ClkInitStruct.AHBCLKDivider = RCC_HCLK_DIV1;
+	RCC_ClkInitStruct.APB3CLKDivider = info->apb3Divider;
+	RCC_ClkInitStruct.APB1CLKDivider = info->apb1Divider;
+	RCC_ClkInitStruct.APB2CLKDivider = info->apb2Divider;
+	RCC_ClkInitStruct.APB4CLKDivider = info->apb4Divider;
+	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, info->flashLatency) != HAL_OK)
+		return 0;
+
+	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+	RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+	RCC_OscInitStruct.PLL.PLLM = CLOCK_PLL_M;
+	RCC_OscInitStruct.PLL.PLLN = info->pllN;
+	RCC_OscInitStruct.PLL.PLLP = info->pllP;
+	RCC_OscInitStruct.PLL.PLLQ = info->pllQ;
+	RCC_OscInitStruct.PLL.PLLR = info->pllR;
+	RCC_OscInitStruct.PLL.PLLRGE = RCC_PLL1VCIRANGE_3;
+	RCC_OscInitStruct.PLL.PLLVCOSEL = RCC_PLL1VCOWIDE;
+	RCC_OscInitStruct.PLL.PLLFRACN = 0;
+	if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+		return 0;
+
+	// Also updates SystemCoreClock and the SysTick (HAL_InitTick)
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, info->flashLatency) != HAL_OK)
+		return 0;
+
+	if (!raise)
+		Clock_SetVoltageScaling(info->voltageScaling);
+
+	Clock_CurrentProfile = profile;
+
+	// Same kernel clock sources in every profile (as selected by the MspInit functions)
+	PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_SPI1 | RCC_PERIPHCLK_OSPI | RCC_PERIPHCLK_SDMMC;
+	PeriphClkInitStruct.Spi123ClockSelection = RCC_SPI123CLKSOURCE_PLL;
+	PeriphClkInitStruct.OspiClockSelection = RCC_OSPICLKSOURCE_D1HCLK;
+	PeriphClkInitStruct.SdmmcClockSelection = RCC_SDMMCCLKSOURCE_PLL;
+	if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK)
+		return 0;
+
+	return 1;
+}
+
+/**
+ * @brief  Liefert das aktive Taktprofil
+ */
+Clock_Profile Clock_GetProfile(void) {
+	return Clock_CurrentProfile;
+}
+
+/**
+ * @brief  Liefert die Einstellungen und Takte des aktiven Profils
+ */
+const Clock_ProfileInfo* Clock_GetProfileInfo(void) {
+	return &Clock_Profiles[Clock_CurrentProfile];
+}
+
+/**
+ * @brief  Stellt das OCTOSPI-Timing des aktiven Profils ein (kein Einfluss vor MX_OCTOSPI1_Init())
+ *
+ * Wird aus MX_OCTOSPI1_Init() und nach jeder Umschaltung aufgerufen. Gilt die Einstellung aus
+ * MX_OCTOSPI1_TuneBus() für das Profil, wird sie übernommen, sonst der Vorteiler aus dem Profil.
+ * Ein aktiver Memory-Mapped-Modus wird dafür kurz verlassen und danach wieder eingeschaltet,
+ * aktive DTR-Lesebefehle werden mit dem neuen Timing erneut geprüft.
+ */
+void Clock_ConfigOctospi(void) {
+	OCTOSPI1_Setting setting;
+	uint8_t mapped, dtr;
+
+	if (hospi1.State == HAL_OSPI_STATE_RESET)
+		return;
+
+	MX_OCTOSPI1_GetSetting(Clock_CurrentProfile, &setting);
+	if (MX_OCTOSPI1_IsApplied(&setting))
+		return;
+
+	dtr = W25Qxx_Device.readDtr;
+	W25Qxx_DisableDtr();
+	mapped = W25Qxx_IsMemoryMapped();
+	if (mapped)
+		W25Qxx_DisableMemoryMapped();
+
+	MX_OCTOSPI1_ApplySetting(&setting);
+
+	// The new timing has to pass the DTR self-test again, otherwise reads stay SDR
+	if (dtr)
+		W25Qxx_EnableDtr(OCTOSPI1_TUNE_ADDRESS);
+	if (mapped)
+		W25Qxx_EnableMemoryMapped();
+}
+
+/**
+ * @brief  Schneller Weg aus dem Stop-Modus zurück zum aktiven Profil (bei gesperrten Interrupts)
+ *
+ * Teiler, Flash-Wartezyklen und die Einstellung von PLL1 sind erhalten, SystemCoreClock stimmt
+ * also schon. Der Spannungsbereich wird neu gesetzt, bevor der Takt steigt, falls der Regler ihn
+ * im Stop aufgegeben hat. Jeder Schritt ist durch CLOCK_RESUME_TIMEOUT begrenzt.
+ * @retval 1 bei Erfolg, 0 wenn VOS oder PLL1 nicht rechtzeitig bereit waren (der Kern läuft weiter vom HSI)
+ */
+uint8_t Clock_ResumeAfterStop(void) {
+	uint32_t start = DWT->CYCCNT;
+
+	__HAL_PWR_VOLTAGESCALING_CONFIG(Clock_Profiles[Clock_CurrentProfile].voltageScaling);
+	while (!__HAL_PWR_GET_FLAG(PWR_FLAG_VOSRDY)) {
+		if (DWT->CYCCNT - start > CLOCK_RESUME_TIMEOUT)
+			return 0;
+	}
+
+	RCC->CR |= RCC_CR_PLL1ON;
+	while (!(RCC->CR & RCC_CR_PLL1RDY)) {
+		if (DWT->CYCCNT - start > CLOCK_RESUME_TIMEOUT)
+			return 0;
+	}
+
+	MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, RCC_CFGR_SW_PLL1);
+	while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL1) {
+		if (DWT->CYCCNT - start > CLOCK_RESUME_TIMEOUT)
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Ordnet die HAL-Konstante eines Spannungsbereichs seiner Nummer zu (0 = höchste Spannung)
+ */
+static uint8_t Clock_VosLevel(uint32_t voltageScaling) {
+	if (voltageScaling == PWR_REGULATOR_VOLTAGE_SCALE0)
+		return 0;
+	if (voltageScaling == PWR_REGULATOR_VOLTAGE_SCALE1)
+		return 1;
+	if (voltageScaling == PWR_REGULATOR_VOLTAGE_SCALE2)
+		return 2;
+	return 3;
+}
+
+/**
+ * @brief  Stellt den Spannungsbereich ein und wartet, bis er erreicht ist
+ */
+static void Clock_SetVoltageScaling(uint32_t voltageScaling) {
+	__HAL_PWR_VOLTAGESCALING_CONFIG(voltageScaling);
+	while (!__HAL_PWR_GET_FLAG(PWR_FLAG_VOSRDY)) {
+	}
+}
+
+/**
+ * @brief  Initialisiert die Peripherien neu, deren Teiler aus den Bustakten berechnet werden
+ *
+ * Beim Start (vor den MX_*_Init()-Aufrufen) ist noch keine davon initialisiert. Zur Laufzeit
+ * berechnen die MX_*_Init()-Funktionen Prescaler, ARR und Baudrate aus den neuen Takten; laufende
+ * Timer zählen dabei weiter, ihre Interrupts bleiben eingeschaltet. Die µs-Zeitbasis (TIM5) bekommt
+ * nur einen neuen Vorteiler, ihr Stand bleibt erhalten.
+ */
+static void Clock_ReinitPeripherals(void) {
+	if (htim1.State != HAL_TIM_STATE_RESET)
+		MX_TIM1_Init();
+	if (htim3.State != HAL_TIM_STATE_RESET)
+		MX_TIM3_Init();
+	if (htim6.State != HAL_TIM_STATE_RESET)
+		MX_TIM6_Init();
+	if (htim7.State != HAL_TIM_STATE_RESET)
+		MX_TIM7_Init();
+	if (huart7.gState != HAL_UART_STATE_RESET)
+		MX_UART7_Init();
+	if (huart4.gState != HAL_UART_STATE_RESET)
+		MX_UART4_Init();
+	Timebase_ClockChanged();
+#ifdef USE_DMA_SAMPLING
+	UserInput_ClockChanged();
+#endif
+}
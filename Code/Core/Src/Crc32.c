@@ -0,0 +1,151 @@
+/**
+ * @file    Crc32.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   CRC-32 (wie zlib.crc32) mit der CRC-Einheit des H7, größere Blöcke per MDMA
+ *
+ * Die Einheit rechnet Polynom 0x04C11DB7 ab 0xFFFFFFFF und verarbeitet ein Wort ab dem höchsten
+ * Byte. Damit das erste Byte im Speicher zuerst kommt, wird jedes Wort gedreht: die CPU mit
+ * __REV(), der MDMA mit dem Tausch von Bytes und Halbwörtern (BEX | HEX). REV_IN spiegelt jedes
+ * Byte, REV_OUT das Ergebnis, das Komplement am Ende ergibt die gespiegelte CRC-32 von zlib.
+ *
+ * Ab CRC32_MDMA_THRESHOLD Bytes liest ein MDMA-Kanal die Daten per Software-Anforderung und
+ * schreibt sie wortweise in CRC->DR; die CPU schreibt nur den unausgerichteten Anfang und die
+ * letzten 0-3 Bytes und wartet sonst auf das Ende des Blocks. Den Kanal vergibt DmaAlloc beim
+ * ersten Aufruf, er läuft im Polling-Betrieb wie die JPEG-Kanäle.
+ *
+ * Die Einheit ist nicht gegen Unterbrechung geschützt: Aufrufer sind Tasks des kooperativen
+ * Schedulers, nicht Interrupts.
+ */
+
+#include "Crc32.h"
+#include "Cache.h"
+#include "DmaAlloc.h"
+#include <string.h>
+
+/* Wartezeit je MDMA-Block; 64 KB aus dem Memory-Mapped-Fenster brauchen wenige Millisekunden */
+#define CRC32_MDMA_TIMEOUT_MS    20
+
+MDMA_HandleTypeDef Crc32_Mdma;
+static uint8_t Crc32_Initialised = 0;
+
+static void Crc32_FeedBytes(const uint8_t *data, uint32_t length);
+static uint8_t Crc32_FeedMdma(const uint8_t *data, uint32_t length);
+
+/**
+ * @brief  Schaltet die CRC-Einheit ein und konfiguriert den MDMA-Kanal (einmalig)
+ * @retval 1 bei Erfolg, 0 wenn der MDMA-Kanal nicht eingerichtet werden konnte (die CPU-
+ *         Berechnung funktioniert trotzdem)
+ */
+uint8_t Crc32_Init(void) {
+	if (Crc32_Initialised) {
+		return 1;
+	}
+
+	// CRC-32 as zlib: polynomial 0x04C11DB7, start 0xFFFFFFFF, bytes and result reflected
+	__HAL_RCC_CRC_CLK_ENABLE();
+	CRC->POL = 0x04C11DB7UL;
+	CRC->INIT = 0xFFFFFFFFUL;
+	CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_OUT;
+
+	__HAL_RCC_MDMA_CLK_ENABLE();
+
+	// Words from memory into the fixed data register, reversed like __REV()
+	if (!DmaAlloc_ClaimMdma(&Crc32_Mdma, "CRC32")) {
+		return 0;
+	}
+	Crc32_Mdma.Init.Request = MDMA_REQUEST_SW;
+	Crc32_Mdma.Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+	Crc32_Mdma.Init.Priority = MDMA_PRIORITY_LOW;
+	Crc32_Mdma.Init.Endianness = MDMA_LITTLE_BYTE_ENDIANNESS_EXCHANGE | MDMA_LITTLE_HALFWORD_ENDIANNESS_EXCHANGE;
+	Crc32_Mdma.Init.SourceInc = MDMA_SRC_INC_WORD;
+	Crc32_Mdma.Init.DestinationInc = MDMA_DEST_INC_DISABLE;
+	Crc32_Mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_WORD;
+	Crc32_Mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_WORD;
+	Crc32_Mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+	Crc32_Mdma.Init.BufferTransferLength = 128;
+	Crc32_Mdma.Init.SourceBurst = MDMA_SOURCE_BURST_32BEATS;
+	Crc32_Mdma.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+	Crc32_Mdma.Init.SourceBlockAddressOffset = 0;
+	Crc32_Mdma.Init.DestBlockAddressOffset = 0;
+
+	if (HAL_MDMA_Init(&Crc32_Mdma) != HAL_OK) {
+		return 0;
+	}
+
+	Crc32_Initialised = 1;
+	return 1;
+}
+
+/**
+ * @brief  CRC-32 über einen Speicherbereich (RAM oder Memory-Mapped-Fenster)
+ *
+ * Liegen die Daten in gecachtem RAM, werden ihre Cache-Zeilen vor dem MDMA-Transfer
+ * zurückgeschrieben. Ist der MDMA-Kanal nicht verfügbar, rechnet die CPU alles.
+ *
+ * @param  data   Beliebig ausgerichtet
+ * @param  length Länge in Bytes
+ * @retval CRC-32 wie zlib.crc32(data)
+ */
+uint32_t Crc32_Compute(const void *data, uint32_t length) {
+	const uint8_t *p = data;
+	uint8_t mdma = Crc32_Init();
+
+	CRC->CR |= CRC_CR_RESET;
+
+	if (mdma && length >= CRC32_MDMA_THRESHOLD) {
+		uint32_t head = (uint32_t)(-(uintptr_t)p & 3);
+		uint32_t words = (length - head) & ~3UL;
+
+		Crc32_FeedBytes(p, head);
+		if (Crc32_FeedMdma(p + head, words)) {
+			p += head + words;
+			length -= head + words;
+		} else {
+			// Channel busy or stalled: start over with the CPU
+			CRC->CR |= CRC_CR_RESET;
+		}
+	}
+
+	Crc32_FeedBytes(p, length);
+	return ~CRC->DR;
+}
+
+/**
+ * @brief  Schreibt Bytes mit der CPU in die Einheit (wortweise, Rest einzeln)
+ */
+static void Crc32_FeedBytes(const uint8_t *data, uint32_t length) {
+	uint32_t word;
+
+	for (; length >= 4; length -= 4, data += 4) {
+		memcpy(&word, data, 4);
+		CRC->DR = __REV(word);
+	}
+	while (length--)
+		*(volatile uint8_t*)&CRC->DR = *data++;
+}
+
+/**
+ * @brief  Lässt den MDMA ausgerichtete Wörter in die Einheit schreiben und wartet darauf
+ * @param  data   Wortausgerichtet
+ * @param  length Vielfaches von 4
+ * @retval 1 wenn alle Wörter übertragen wurden, 0 bei belegtem Kanal oder Timeout
+ */
+static uint8_t Crc32_FeedMdma(const uint8_t *data, uint32_t length) {
+	Cache_CleanDMA(data, length);
+
+	while (length > 0) {
+		uint32_t block = length > CRC32_MDMA_BLOCK ? CRC32_MDMA_BLOCK : length;
+
+		if (HAL_MDMA_Start(&Crc32_Mdma, (uint32_t)data, (uint32_t)&CRC->DR, block, 1) != HAL_OK) {
+			return 0;
+		}
+		if (HAL_MDMA_PollForTransfer(&Crc32_Mdma, HAL_MDMA_FULL_TRANSFER, CRC32_MDMA_TIMEOUT_MS) != HAL_OK) {
+			HAL_MDMA_Abort(&Crc32_Mdma);
+			return 0;
+		}
+		data += block;
+		length -= block;
+	}
+	return 1;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file    DirList.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Verzeichnis der SD-Karte als Datenquelle einer Liste mit konstantem Speicherbedarf
+ *
+ * Ein Dateibrowser über ein Verzeichnis mit tausend Einträgen soll weder alle Namen im RAM
+ * halten noch für jede Zeile das Verzeichnis von vorn lesen. f_readdir() liest aber nur der
+ * Reihe nach. DirList_Open() zählt deshalb einmal alle Einträge und merkt sich dabei alle
+ * step Einträge die Leseposition: Ein DIR-Objekt enthält Cluster, Sektor und Index des
+ * nächsten Eintrags, eine Kopie setzt f_readdir() genau dort fort. Sind alle DIRLIST_MARKS
+ * Plätze belegt, bleibt jede zweite Marke erhalten und der Abstand verdoppelt sich.
+ *
+ * DirList_Get() liest ab der letzten Marke vor dem gewünschten Eintrag oder, wenn sie näher
+ * liegt, ab der aktuellen Position weiter. Eine Liste fragt ihre sichtbaren Zeilen von oben
+ * nach unten ab, beim Scrollen um eine Zeile nach unten kostet das einen Eintrag, nach oben
+ * höchstens step Einträge. Die Sektoren liegen dabei meist schon im SDCache.
+ *
+ * Die Karte bleibt von DirList_Open() bis DirList_Close() belegt (SDCard_Acquire()).
+ */
+
+#include "DirList.h"
+#include "SDCard.h"
+#include "Fmt.h"
+#include <string.h>
+
+static FRESULT DirList_Next(DirList *list, FILINFO *info);
+
+/**
+ * @brief  Öffnet ein Verzeichnis, zählt die Einträge und legt die Lesepositionen an.
+ * @param  list Speicher der Liste, danach mit DirList_Close() schließen
+ * @param  path Verzeichnis, z.B. "/" oder "/logs"
+ * @retval 1 bei Erfolg, sonst 0 (Karte fehlt oder Verzeichnis nicht lesbar)
+ */
+uint8_t DirList_Open(DirList *list, const char *path) {
+	memset(list, 0, sizeof(*list));
+	if (SDCard_Acquire() == NULL) {
+		return 0;
+	}
+
+	FRESULT res = f_opendir(&list->dir, path);
+	if (res != FR_OK) {
+		SDCard_CheckResult(res);
+		SDCard_Release();
+		return 0;
+	}
+	list->open = 1;
+	list->step = DIRLIST_MARK_STEP;
+
+	while (list->count < UINT16_MAX) {
+		if (list->count % list->step == 0) {
+			if (list->markCount == DIRLIST_MARKS) {
+				// Keep every second mark, the distance doubles
+				for (uint8_t i = 0; i < DIRLIST_MARKS / 2; i++) {
+					list->marks[i] = list->marks[i * 2];
+				}
+				list->markCount = DIRLIST_MARKS / 2;
+				list->step *= 2;
+			}
+			if (list->count % list->step == 0) {
+				list->marks[list->markCount++] = list->dir;
+			}
+		}
+
+		res = DirList_Next(list, &list->info);
+		if (res != FR_OK || list->info.fname[0] == '\0') {
+			break;
+		}
+		list->count++;
+	}
+
+	list->dir = list->marks[0];
+	list->position = 0;
+	if (res != FR_OK) {
+		SDCard_CheckResult(res);
+		DirList_Close(list);
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Schließt das Verzeichnis und gibt die Karte frei.
+ */
+void DirList_Close(DirList *list) {
+	if (!list->open) {
+		return;
+	}
+
+	// The marks are copies of the same open directory, only the handle itself is closed
+	f_closedir(&list->dir);
+	list->open = 0;
+	list->count = 0;
+	SDCard_Release();
+}
+
+/**
+ * @brief  Anzahl der Einträge beim Öffnen
+ */
+uint16_t DirList_Count(const DirList *list) {
+	return list->count;
+}
+
+/**
+ * @brief  Liest den Eintrag index.
+ * @retval Eintrag (gültig bis zum nächsten Aufruf), NULL hinter dem Ende oder bei Lesefehlern
+ */
+const FILINFO* DirList_Get(DirList *list, uint16_t index) {
+	if (!list->open || index >= list->count) {
+		return NULL;
+	}
+
+	// Continue from the current position unless a mark lies closer before the entry
+	uint16_t mark = index / list->step;
+	if (mark >= list->markCount) {
+		mark = list->markCount - 1;
+	}
+	uint16_t markPosition = mark * list->step;
+	if (list->position > index || list->position < markPosition) {
+		_FDID obj = list->dir.obj;
+		list->dir = list->marks[mark];
+		list->dir.obj = obj;
+		list->position = markPosition;
+	}
+
+	while (list->position <= index) {
+		if (DirList_Next(list, &list->info) != FR_OK || list->info.fname[0] == '\0') {
+			// Directory changed or card gone: read again from the start next time
+			list->position = UINT16_MAX;
+			return NULL;
+		}
+		list->position++;
+	}
+	return &list->info;
+}
+
+/**
+ * @brief  Datenquelle für ILI9341_Widget_SetSource(): Name, Verzeichnisse mit '/', Dateien mit Größe.
+ * @param  context DirList
+ */
+uint8_t DirList_Source(void *context, uint16_t index, char *text, uint8_t size) {
+	const FILINFO *info = DirList_Get((DirList*)context, index);
+	if (info == NULL) {
+		return 0;
+	}
+
+	Fmt_Buffer b;
+	Fmt_Init(&b, text, size);
+	Fmt_Str(&b, info->fname);
+	if (info->fattrib & AM_DIR) {
+		Fmt_Char(&b, '/');
+	} else if (info->fsize < 10240) {
+		Fmt_Char(&b, ' ');
+		Fmt_U32(&b, (uint32_t)info->fsize, 0, ' ');
+		Fmt_Char(&b, 'B');
+	} else {
+		Fmt_Char(&b, ' ');
+		Fmt_U32(&b, (uint32_t)(info->fsize >> 10), 0, ' ');
+		Fmt_Char(&b, 'K');
+	}
+	return 1;
+}
+
+/**
+ * @brief  Liest den nächsten Eintrag ohne "." und ".."; am Ende ist info->fname leer.
+ */
+static FRESULT DirList_Next(DirList *list, FILINFO *info) {
+	FRESULT res;
+	do {
+		res = f_readdir(&list->dir, info);
+	} while (res == FR_OK && info->fname[0] == '.' &&
+	         (info->fname[1] == '\0' || (info->fname[1] == '.' && info->fname[2] == '\0')));
+	return res;
+}
@@ -0,0 +1,421 @@
+/**
+ * @file    DmaAlloc.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Belegungstabelle der DMA-Streams und MDMA-Kanäle mit gemeinsamer Interrupt-Verteilung
+ *
+ * Jeder Stream von DMA1, DMA2 und BDMA2 sowie jeder MDMA-Kanal hat einen Eintrag mit Besitzer,
+ * Handle und Zählern. Es gibt zwei Wege in die Tabelle:
+ * - DmaAlloc_Register(): Streams, die CubeMX im MSP-Code fest vergibt (SPI1, UART7, ADC, ...).
+ *   main() meldet sie nach MX_..._Init() an, die Streams bleiben, wo CubeMX sie hingelegt hat.
+ * - DmaAlloc_Claim(): neue Übertragungswege nehmen zur Laufzeit den ersten freien Stream des
+ *   Controllers, tragen Instanz und DMAMUX-Anforderung in das Handle ein und schalten die
+ *   NVIC-Leitung ein; HAL_DMA_Init() danach programmiert den DMAMUX. Für MDMA-Kanäle genauso
+ *   DmaAlloc_ClaimMdma().
+ *
+ * Alle Stream-Interrupts und der MDMA-Interrupt sind hier definiert; in stm32h7xx_it.c erzeugt
+ * CubeMX dafür keine Handler mehr (im .ioc abgeschaltet). Der Handler zählt den Interrupt und ruft
+ * HAL_DMA_IRQHandler() mit dem eingetragenen Handle, ein neuer Übertragungsweg braucht also keine
+ * Änderung am generierten Code. Kommt ein Interrupt von einem Stream ohne Besitzer, wird er als
+ * verirrt gezählt und seine NVIC-Leitung abgeschaltet, sonst käme er endlos wieder.
+ *
+ * Die Auslastung tastet DmaAlloc_Tick() im 1-ms-Takt ab (Realtime_Loop()): jeder belegte Stream
+ * mit gesetztem EN-Bit bekommt die vergangenen Millisekunden gutgeschrieben. Kurze Transfers
+ * zwischen zwei Abtastungen fallen dabei durch, die Zahl ist für längere Übertragungen gedacht
+ * (Vollbilder, Dauerbetrieb von ADC und UART-Empfang).
+ */
+
+#include "DmaAlloc.h"
+#include "Irq.h"
+#include "Fmt.h"
+#include <stdio.h>
+
+typedef struct {
+	void *instance;
+	IRQn_Type irq;
+} DmaAlloc_Slot;
+
+/* Streams in der Reihenfolge der DMAMUX-Kanäle: DMAMUX1 0-15 -> DMA1/DMA2, DMAMUX2 0-7 -> BDMA2 */
+static const DmaAlloc_Slot DmaAlloc_Slots[DMAALLOC_STREAM_COUNT] = {
+	{ DMA1_Stream0, DMA1_Stream0_IRQn }, { DMA1_Stream1, DMA1_Stream1_IRQn },
+	{ DMA1_Stream2, DMA1_Stream2_IRQn }, { DMA1_Stream3, DMA1_Stream3_IRQn },
+	{ DMA1_Stream4, DMA1_Stream4_IRQn }, { DMA1_Stream5, DMA1_Stream5_IRQn },
+	{ DMA1_Stream6, DMA1_Stream6_IRQn }, { DMA1_Stream7, DMA1_Stream7_IRQn },
+	{ DMA2_Stream0, DMA2_Stream0_IRQn }, { DMA2_Stream1, DMA2_Stream1_IRQn },
+	{ DMA2_Stream2, DMA2_Stream2_IRQn }, { DMA2_Stream3, DMA2_Stream3_IRQn },
+	{ DMA2_Stream4, DMA2_Stream4_IRQn }, { DMA2_Stream5, DMA2_Stream5_IRQn },
+	{ DMA2_Stream6, DMA2_Stream6_IRQn }, { DMA2_Stream7, DMA2_Stream7_IRQn },
+	{ BDMA2_Channel0, BDMA2_Channel0_IRQn }, { BDMA2_Channel1, BDMA2_Channel1_IRQn },
+	{ BDMA2_Channel2, BDMA2_Channel2_IRQn }, { BDMA2_Channel3, BDMA2_Channel3_IRQn },
+	{ BDMA2_Channel4, BDMA2_Channel4_IRQn }, { BDMA2_Channel5, BDMA2_Channel5_IRQn },
+	{ BDMA2_Channel6, BDMA2_Channel6_IRQn }, { BDMA2_Channel7, BDMA2_Channel7_IRQn },
+};
+
+#define DMAALLOC_BDMA_FIRST      16
+
+static DmaAlloc_Entry DmaAlloc_Entries[DMAALLOC_ENTRY_COUNT];
+static uint32_t DmaAlloc_Spurious = 0;
+static uint32_t DmaAlloc_TotalMs = 0;
+
+static int8_t DmaAlloc_Find(const void *instance);
+static int8_t DmaAlloc_IndexOf(const void *handle);
+static uint8_t DmaAlloc_Take(int8_t index, void *handle, const char *owner);
+static MDMA_Channel_TypeDef* DmaAlloc_MdmaChannel(uint8_t channel);
+static uint8_t DmaAlloc_Enabled(uint8_t index);
+static uint32_t DmaAlloc_Priority(uint8_t index);
+static uint32_t DmaAlloc_Request(uint8_t index);
+static void DmaAlloc_Dispatch(uint8_t index);
+#if IRQ_STAT_ENABLE
+static void DmaAlloc_RecordCycles(DmaAlloc_Entry *entry, uint32_t cycles);
+#endif
+
+/**
+ * @brief  Trägt einen von CubeMX vergebenen Stream ein (Instance ist bereits gesetzt)
+ * @param  owner: konstanter String für die Ausgabe
+ * @retval 1 bei Erfolg, 0 wenn der Stream unbekannt ist oder schon jemand anderem gehört
+ */
+uint8_t DmaAlloc_Register(DMA_HandleTypeDef *hdma, const char *owner) {
+	int8_t index = DmaAlloc_Find(hdma->Instance);
+
+	return index >= 0 && index < DMAALLOC_STREAM_COUNT && DmaAlloc_Take(index, hdma, owner);
+}
+
+/**
+ * @brief  Trägt einen fest vergebenen MDMA-Kanal ein (z.B. OCTOSPI aus octospi.c)
+ */
+uint8_t DmaAlloc_RegisterMdma(MDMA_HandleTypeDef *hmdma, const char *owner) {
+	int8_t index = DmaAlloc_Find(hmdma->Instance);
+
+	return index >= DMAALLOC_STREAM_COUNT && DmaAlloc_Take(index, hmdma, owner);
+}
+
+/**
+ * @brief  Belegt den ersten freien Stream eines Controllers, danach HAL_DMA_Init() aufrufen
+ *
+ * Frei ist ein Stream ohne Eintrag, dessen DMAMUX-Kanal keine Anforderung trägt; damit bleibt ein
+ * von CubeMX initialisierter, aber (noch) nicht angemeldeter Stream unangetastet.
+ *
+ * @param  hdma: Init-Felder ausgefüllt, Instance und Init.Request setzt diese Funktion
+ * @param  bus: DMAALLOC_BDMA für Peripherie und Puffer im SRD-Bereich, sonst DMAALLOC_DMA
+ * @param  request: DMA_REQUEST_... bzw. BDMA_REQUEST_...
+ * @param  irqPriority: Preemption-Priorität der NVIC-Leitung
+ * @retval 1 bei Erfolg, 0 wenn kein Stream frei ist
+ */
+uint8_t DmaAlloc_Claim(DMA_HandleTypeDef *hdma, DmaAlloc_Bus bus, uint32_t request, uint32_t irqPriority, const char *owner) {
+	uint8_t first = bus == DMAALLOC_BDMA ? DMAALLOC_BDMA_FIRST : 0;
+	uint8_t last = bus == DMAALLOC_BDMA ? DMAALLOC_STREAM_COUNT : DMAALLOC_BDMA_FIRST;
+
+	if (DmaAlloc_IndexOf(hdma) >= 0) {
+		return 1;    // claimed before, e.g. a retried initialisation
+	}
+	for (uint8_t i = first; i < last; i++) {
+		if (DmaAlloc_Entries[i].owner != NULL || DmaAlloc_Request(i) != 0) {
+			continue;
+		}
+
+		hdma->Instance = DmaAlloc_Slots[i].instance;
+		hdma->Init.Request = request;
+		DmaAlloc_Take(i, hdma, owner);
+
+		HAL_NVIC_SetPriority(DmaAlloc_Slots[i].irq, irqPriority, 0);
+		HAL_NVIC_EnableIRQ(DmaAlloc_Slots[i].irq);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief  Belegt den ersten freien MDMA-Kanal, danach HAL_MDMA_Init() aufrufen
+ *
+ * Die NVIC-Leitung des MDMA teilen sich alle Kanäle; sie ist mit dem OCTOSPI bereits an, ein
+ * Kanal im Polling-Betrieb löst ohne gesetzte Interrupt-Bits ohnehin keinen Interrupt aus.
+ *
+ * @retval 1 bei Erfolg, 0 wenn kein Kanal frei ist
+ */
+uint8_t DmaAlloc_ClaimMdma(MDMA_HandleTypeDef *hmdma, const char *owner) {
+	if (DmaAlloc_IndexOf(hmdma) >= 0) {
+		return 1;
+	}
+	for (uint8_t i = 0; i < DMAALLOC_MDMA_COUNT; i++) {
+		MDMA_Channel_TypeDef *channel = DmaAlloc_MdmaChannel(i);
+
+		// CTCR is zero after reset, HAL_MDMA_Init() of an unregistered owner sets it
+		if (DmaAlloc_Entries[DMAALLOC_STREAM_COUNT + i].owner != NULL || channel->CTCR != 0) {
+			continue;
+		}
+
+		hmdma->Instance = channel;
+		return DmaAlloc_Take(DMAALLOC_STREAM_COUNT + i, hmdma, owner);
+	}
+	return 0;
+}
+
+/**
+ * @brief  Gibt einen Stream bzw. MDMA-Kanal frei (nach HAL_DMA_DeInit() bzw. HAL_MDMA_DeInit())
+ */
+void DmaAlloc_Release(const void *handle) {
+	int8_t index = DmaAlloc_IndexOf(handle);
+
+	if (index < 0) {
+		return;
+	}
+	if (index < DMAALLOC_STREAM_COUNT) {
+		HAL_NVIC_DisableIRQ(DmaAlloc_Slots[index].irq);
+	}
+	DmaAlloc_Entries[index].owner = NULL;
+	DmaAlloc_Entries[index].handle = NULL;
+}
+
+/**
+ * @brief  Tastet die EN-Bits aller belegten Streams ab, aus Realtime_Loop() (1-ms-Takt)
+ * @param  elapsedMs: Millisekunden seit dem letzten Aufruf (nach Realtime_Sleep() mehr als 1)
+ */
+RAMFUNC void DmaAlloc_Tick(uint32_t elapsedMs) {
+	DmaAlloc_TotalMs += elapsedMs;
+
+	for (uint8_t i = 0; i < DMAALLOC_ENTRY_COUNT; i++) {
+		if (DmaAlloc_Entries[i].owner != NULL && DmaAlloc_Enabled(i)) {
+			DmaAlloc_Entries[i].busyMs += elapsedMs;
+		}
+	}
+}
+
+/**
+ * @brief  Liefert einen Eintrag: 0-23 Streams (DMA1, DMA2, BDMA2), 24-39 MDMA-Kanäle
+ */
+const DmaAlloc_Entry* DmaAlloc_Get(uint8_t index) {
+	return index < DMAALLOC_ENTRY_COUNT ? &DmaAlloc_Entries[index] : NULL;
+}
+
+/**
+ * @brief  Setzt Interrupt-, Fehler- und Auslastungszähler zurück, die Belegung bleibt
+ */
+void DmaAlloc_ResetStats(void) {
+	__disable_irq();
+	for (uint8_t i = 0; i < DMAALLOC_ENTRY_COUNT; i++) {
+		DmaAlloc_Entries[i].irqs = 0;
+		DmaAlloc_Entries[i].errors = 0;
+		DmaAlloc_Entries[i].busyMs = 0;
+		DmaAlloc_Entries[i].maxCycles = 0;
+		DmaAlloc_Entries[i].totalCycles = 0;
+	}
+	DmaAlloc_Spurious = 0;
+	DmaAlloc_TotalMs = 0;
+	__enable_irq();
+}
+
+/**
+ * @brief  Gibt die belegten Streams mit Anforderung, Prioritäten und Zählern aus
+ */
+void DmaAlloc_Dump(void) {
+	static const char *const levels[] = { "low", "med", "high", "vhigh" };
+	uint32_t total = DmaAlloc_TotalMs ? DmaAlloc_TotalMs : 1;
+	uint32_t mhz = SystemCoreClock / 1000000UL;
+
+	printf("%-9s %-12s %4s %5s %4s %9s %7s %6s %8s\n", "Stream", "Besitzer", "Req", "Prio", "IRQ", "Interrupts", "Fehler", "Last",
+			"Max [us]");
+	for (uint8_t i = 0; i < DMAALLOC_ENTRY_COUNT; i++) {
+		const DmaAlloc_Entry *entry = &DmaAlloc_Entries[i];
+		char name[10];
+
+		if (entry->owner == NULL) {
+			continue;
+		}
+		if (i < DMAALLOC_BDMA_FIRST) {
+			Fmt_Format(name, sizeof(name), "DMA%u S%u", 1 + i / 8, i % 8);
+		} else if (i < DMAALLOC_STREAM_COUNT) {
+			Fmt_Format(name, sizeof(name), "BDMA2 C%u", i - DMAALLOC_BDMA_FIRST);
+		} else {
+			Fmt_Format(name, sizeof(name), "MDMA C%u", i - DMAALLOC_STREAM_COUNT);
+		}
+
+		printf("%-9s %-12s %4lu %5s ", name, entry->owner, DmaAlloc_Request(i), levels[DmaAlloc_Priority(i)]);
+		if (i < DMAALLOC_STREAM_COUNT) {
+			printf("%4lu ", NVIC_GetPriority(DmaAlloc_Slots[i].irq));
+		} else {
+			printf("%4lu ", NVIC_GetPriority(MDMA_IRQn));
+		}
+		printf("%9lu %7lu %5lu%% %8lu\n", entry->irqs, entry->errors, entry->busyMs * 100UL / total,
+				entry->maxCycles / (mhz ? mhz : 1));
+	}
+	printf("Verirrte Interrupts %lu, Messdauer %lu ms\n", DmaAlloc_Spurious, DmaAlloc_TotalMs);
+}
+
+/* --------------------------------- Interrupts --------------------------------- */
+
+#define DMAALLOC_HANDLER(name, index)    void name(void) { DmaAlloc_Dispatch(index); }
+
+DMAALLOC_HANDLER(DMA1_Stream0_IRQHandler, 0)
+DMAALLOC_HANDLER(DMA1_Stream1_IRQHandler, 1)
+DMAALLOC_HANDLER(DMA1_Stream2_IRQHandler, 2)
+DMAALLOC_HANDLER(DMA1_Stream3_IRQHandler, 3)
+DMAALLOC_HANDLER(DMA1_Stream4_IRQHandler, 4)
+DMAALLOC_HANDLER(DMA1_Stream5_IRQHandler, 5)
+DMAALLOC_HANDLER(DMA1_Stream6_IRQHandler, 6)
+DMAALLOC_HANDLER(DMA1_Stream7_IRQHandler, 7)
+DMAALLOC_HANDLER(DMA2_Stream0_IRQHandler, 8)
+DMAALLOC_HANDLER(DMA2_Stream1_IRQHandler, 9)
+DMAALLOC_HANDLER(DMA2_Stream2_IRQHandler, 10)
+DMAALLOC_HANDLER(DMA2_Stream3_IRQHandler, 11)
+DMAALLOC_HANDLER(DMA2_Stream4_IRQHandler, 12)
+DMAALLOC_HANDLER(DMA2_Stream5_IRQHandler, 13)
+DMAALLOC_HANDLER(DMA2_Stream6_IRQHandler, 14)
+DMAALLOC_HANDLER(DMA2_Stream7_IRQHandler, 15)
+DMAALLOC_HANDLER(BDMA2_Channel0_IRQHandler, 16)
+DMAALLOC_HANDLER(BDMA2_Channel1_IRQHandler, 17)
+DMAALLOC_HANDLER(BDMA2_Channel2_IRQHandler, 18)
+DMAALLOC_HANDLER(BDMA2_Channel3_IRQHandler, 19)
+DMAALLOC_HANDLER(BDMA2_Channel4_IRQHandler, 20)
+DMAALLOC_HANDLER(BDMA2_Channel5_IRQHandler, 21)
+DMAALLOC_HANDLER(BDMA2_Channel6_IRQHandler, 22)
+DMAALLOC_HANDLER(BDMA2_Channel7_IRQHandler, 23)
+
+/**
+ * @brief  Gemeinsamer Interrupt aller MDMA-Kanäle, verteilt nach GISR0 an die Handles
+ */
+void MDMA_IRQHandler(void) {
+	uint32_t pending = MDMA->GISR0;
+
+	for (uint8_t i = 0; i < DMAALLOC_MDMA_COUNT && pending != 0; i++, pending >>= 1) {
+		DmaAlloc_Entry *entry = &DmaAlloc_Entries[DMAALLOC_STREAM_COUNT + i];
+		MDMA_HandleTypeDef *hmdma = entry->handle;
+
+		if ((pending & 1) == 0) {
+			continue;
+		}
+
+		entry->irqs++;
+		if (hmdma == NULL) {
+			// Nobody owns the channel: mask all its interrupts
+			DmaAlloc_MdmaChannel(i)->CCR &= ~(MDMA_CCR_TEIE | MDMA_CCR_CTCIE | MDMA_CCR_BRTIE | MDMA_CCR_BTIE | MDMA_CCR_TCIE);
+			DmaAlloc_Spurious++;
+			continue;
+		}
+
+#if IRQ_STAT_ENABLE
+		Irq_Frame frame;
+		Irq_Enter(&frame);
+#endif
+		uint32_t before = hmdma->ErrorCode;
+		HAL_MDMA_IRQHandler(hmdma);
+		if (hmdma->ErrorCode != before) {
+			entry->errors++;
+		}
+#if IRQ_STAT_ENABLE
+		DmaAlloc_RecordCycles(entry, Irq_Leave(&frame));
+#endif
+	}
+}
+
+/* --------------------------------- Intern --------------------------------- */
+
+RAMFUNC static void DmaAlloc_Dispatch(uint8_t index) {
+	DmaAlloc_Entry *entry = &DmaAlloc_Entries[index];
+	DMA_HandleTypeDef *hdma = entry->handle;
+#if IRQ_STAT_ENABLE
+	Irq_Frame frame;
+	Irq_Enter(&frame);
+#endif
+
+	entry->irqs++;
+	if (hdma == NULL) {
+		HAL_NVIC_DisableIRQ(DmaAlloc_Slots[index].irq);
+		DmaAlloc_Spurious++;
+	} else {
+		uint32_t before = hdma->ErrorCode;
+		HAL_DMA_IRQHandler(hdma);
+		if (hdma->ErrorCode != before) {
+			entry->errors++;
+		}
+	}
+
+#if IRQ_STAT_ENABLE
+	DmaAlloc_RecordCycles(entry, Irq_Leave(&frame));
+#endif
+}
+
+#if IRQ_STAT_ENABLE
+/**
+ * @brief  Trägt die Laufzeit eines Interrupts ein; ein Eintrag gehört nur einem Handler
+ */
+RAMFUNC static void DmaAlloc_RecordCycles(DmaAlloc_Entry *entry, uint32_t cycles) {
+	entry->totalCycles += cycles;
+	if (cycles > entry->maxCycles) entry->maxCycles = cycles;
+}
+#endif
+
+/**
+ * @brief  Index eines Streams (0-23) oder MDMA-Kanals (24-39), -1 wenn unbekannt
+ */
+static int8_t DmaAlloc_Find(const void *instance) {
+	for (uint8_t i = 0; i < DMAALLOC_STREAM_COUNT; i++) {
+		if (DmaAlloc_Slots[i].instance == instance)
+			return i;
+	}
+	for (uint8_t i = 0; i < DMAALLOC_MDMA_COUNT; i++) {
+		if (DmaAlloc_MdmaChannel(i) == instance)
+			return DMAALLOC_STREAM_COUNT + i;
+	}
+	return -1;
+}
+
+static int8_t DmaAlloc_IndexOf(const void *handle) {
+	for (uint8_t i = 0; i < DMAALLOC_ENTRY_COUNT; i++) {
+		if (DmaAlloc_Entries[i].handle == handle)
+			return i;
+	}
+	return -1;
+}
+
+static uint8_t DmaAlloc_Take(int8_t index, void *handle, const char *owner) {
+	DmaAlloc_Entry *entry = &DmaAlloc_Entries[index];
+
+	if (entry->owner != NULL && entry->handle != handle) {
+		return 0;
+	}
+	entry->owner = owner;
+	entry->handle = handle;
+	return 1;
+}
+
+static MDMA_Channel_TypeDef* DmaAlloc_MdmaChannel(uint8_t channel) {
+	return (MDMA_Channel_TypeDef*)(MDMA_Channel0_BASE + channel * (MDMA_Channel1_BASE - MDMA_Channel0_BASE));
+}
+
+RAMFUNC static uint8_t DmaAlloc_Enabled(uint8_t index) {
+	if (index < DMAALLOC_BDMA_FIRST) {
+		return (((DMA_Stream_TypeDef*)DmaAlloc_Slots[index].instance)->CR & DMA_SxCR_EN) != 0;
+	}
+	if (index < DMAALLOC_STREAM_COUNT) {
+		return (((BDMA_Channel_TypeDef*)DmaAlloc_Slots[index].instance)->CCR & BDMA_CCR_EN) != 0;
+	}
+	return (DmaAlloc_MdmaChannel(index - DMAALLOC_STREAM_COUNT)->CCR & MDMA_CCR_EN) != 0;
+}
+
+/**
+ * @brief  Kanalpriorität aus dem Register (0 low ... 3 very high)
+ */
+static uint32_t DmaAlloc_Priority(uint8_t index) {
+	if (index < DMAALLOC_BDMA_FIRST) {
+		return (((DMA_Stream_TypeDef*)DmaAlloc_Slots[index].instance)->CR & DMA_SxCR_PL) >> DMA_SxCR_PL_Pos;
+	}
+	if (index < DMAALLOC_STREAM_COUNT) {
+		return (((BDMA_Channel_TypeDef*)DmaAlloc_Slots[index].instance)->CCR & BDMA_CCR_PL) >> BDMA_CCR_PL_Pos;
+	}
+	return (DmaAlloc_MdmaChannel(index - DMAALLOC_STREAM_COUNT)->CCR & MDMA_CCR_PL) >> MDMA_CCR_PL_Pos;
+}
+
+/**
+ * @brief  Anforderung aus dem DMAMUX-Kanal bzw. dem TSEL-Feld des MDMA, 0 = keine
+ *
+ * Beim MDMA ist 0 auch eine gültige Anforderung (DMA1 Stream 0); dort zählt nur die Anzeige.
+ */
+static uint32_t DmaAlloc_Request(uint8_t index) {
+	if (index < DMAALLOC_BDMA_FIRST) {
+		return (DMAMUX1_Channel0 + index)->CCR & DMAMUX_CxCR_DMAREQ_ID;
+	}
+	if (index < DMAALLOC_STREAM_COUNT) {
+		return (DMAMUX2_Channel0 + (index - DMAALLOC_BDMA_FIRST))->CCR & DMAMUX_CxCR_DMAREQ_ID;
+	}
+	return DmaAlloc_MdmaChannel(index - DMAALLOC_STREAM_COUNT)->CTBR & MDMA_CTBR_TSEL_Msk;
+}
@@ -0,0 +1,485 @@
+/**
+ * @file    Dsp.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Glättung und Spektrum eines Potikanals aus den Messblöcken von ADC.c
+ *
+ * Dsp_Init() meldet sich als Empfänger der ADC-Blöcke an (ADC_AddBlockListener()). Im
+ * DMA-Interrupt wird der Block nur vorgemerkt und behalten; Dsp_Process() im Scheduler-Task
+ * holt die Werte des gewählten Kanals direkt aus dem DMA-Puffer, gibt den Block frei und
+ * rechnet dann:
+ * - Umrechnung nach float (-1.0 bis 1.0) und Tiefpass über den ganzen Block,
+ *   wahlweise FIR (DSP_FIR_TAPS, gefensterter Sinc) oder Biquad-IIR
+ * - sobald DSP_FFT_SIZE Werte beisammen sind: Hann-Fenster, reelle FFT (komplexe FFT halber
+ *   Länge plus Entflechtung) und Beträge
+ * Das Ergebnis liegt doppelt gepuffert vor; Dsp_GetSpectrum() liefert immer das letzte
+ * vollständige Spektrum für die Anzeige. FFT und Entflechtung liegen im Overlay "dsp"
+ * (Overlay.h) und laufen aus dem ITCM; hält gerade ein anderes Modul den Overlay-Bereich,
+ * entfällt das Spektrum dieses Rahmens.
+ *
+ * Gerechnet wird in float auf der FPU des Cortex-M7 (Build mit -mfloat-abi=hard, siehe
+ * CMakeLists.txt). DSP_FILTER_FIR_Q15 und DSP_FILTER_IIR_Q15 glätten stattdessen in Q15: die
+ * Werte kommen ohne Umrechnung aus dem DMA-Puffer (Offset 0x8000), der FIR multipliziert je
+ * Befehl zwei Werte mit zwei Koeffizienten (SMLALD, 64-Bit-Akkumulator), der Biquad rechnet
+ * mit Q14-Koeffizienten und führt den abgeschnittenen Rest in den nächsten Wert zurück. Erst
+ * das Ergebnis wird für die FFT nach float gewandelt. Die Koeffizienten werden neu berechnet, sobald sich die Abtastrate des
+ * Kanals (ADC_GetChannelRate()) oder die Grenzfrequenz ändert.
+ */
+
+#include "Dsp.h"
+#include "Prof.h"
+#include "Overlay.h"
+#include "FixMath.h"
+#include <math.h>
+#include <string.h>
+
+#if (DSP_FFT_SIZE & (DSP_FFT_SIZE - 1)) != 0
+#error "DSP_FFT_SIZE muss eine Zweierpotenz sein!"
+#endif
+
+#if (DSP_FIR_TAPS % 4) != 0
+#error "DSP_FIR_TAPS muss ein Vielfaches von 4 sein!"
+#endif
+
+#define DSP_PI                    3.14159265358979f
+#define DSP_HALF                  (DSP_FFT_SIZE / 2)
+
+uint8_t Dsp_Channel = 0;
+Dsp_Filter Dsp_FilterType = DSP_FILTER_FIR;
+float Dsp_CutoffHz = 0;                      // 0 = DSP_DEFAULT_CUTOFF * Abtastrate
+uint32_t Dsp_DesignRate = 0;                 // Abtastrate, für die die Koeffizienten gelten
+uint8_t Dsp_DesignValid = 0;
+
+const ADC_Block *volatile Dsp_Pending = NULL; // vom Interrupt vorgemerkter Block
+uint32_t Dsp_Skipped = 0;
+
+float Dsp_Input[ADC_ACQ_HALF_SAMPLES];
+float Dsp_FirCoeffs[DSP_FIR_TAPS];           // zeitlich gespiegelt
+float Dsp_FirState[DSP_FIR_TAPS - 1 + ADC_ACQ_HALF_SAMPLES];
+float Dsp_Biquad[5];                         // b0, b1, b2, a1, a2
+float Dsp_BiquadState[4];                    // x1, x2, y1, y2
+
+int16_t Dsp_InputQ15[ADC_ACQ_HALF_SAMPLES];
+int16_t Dsp_FirCoeffsQ15[DSP_FIR_TAPS] __ALIGNED(4); // zeitlich gespiegelt
+int16_t Dsp_FirStateQ15[DSP_FIR_TAPS - 1 + ADC_ACQ_HALF_SAMPLES];
+int32_t Dsp_BiquadQ14[5];                    // b0, b1, b2, -a1, -a2 in Q14
+int16_t Dsp_BiquadStateQ15[4];               // x1, x2, y1, y2
+int32_t Dsp_BiquadResidue = 0;               // abgeschnittene Bits des letzten Ausgangs
+
+float Dsp_Frame[DSP_FFT_SIZE];
+uint16_t Dsp_FrameFill = 0;
+float Dsp_Work[DSP_FFT_SIZE];                // DSP_HALF komplexe Werte (re, im)
+float Dsp_Window[DSP_FFT_SIZE];
+float Dsp_Twiddle[DSP_HALF][2];              // cos, sin von 2*pi*k/N
+
+Dsp_Spectrum Dsp_Spectra[2];
+volatile uint8_t Dsp_Published = 0;
+
+static uint8_t Dsp_BlockCallback(const ADC_Block *block, void *context);
+static void Dsp_Design(uint32_t rateHz);
+static void Dsp_Reset(void);
+static void Dsp_FilterBlock(float *data, uint32_t count);
+static void Dsp_Fir(float *data, uint32_t count);
+static void Dsp_Iir(float *data, uint32_t count);
+static void Dsp_FirQ15(int16_t *data, uint32_t count);
+static void Dsp_IirQ15(int16_t *data, uint32_t count);
+static int16_t Dsp_ToQ15(float value, float scale);
+static void Dsp_Transform(void);
+static void Dsp_Fft(float *z, uint32_t points);
+
+/**
+ * @brief  Berechnet Fenster und Drehfaktoren und meldet sich bei ADC.c an
+ * @param  channel: Poti-Index 0-3, dessen Werte ausgewertet werden
+ * @retval 1 bei Erfolg, 0 wenn kein Empfängerplatz mehr frei ist
+ */
+uint8_t Dsp_Init(uint8_t channel) {
+	for (uint32_t n = 0; n < DSP_FFT_SIZE; n++)
+		Dsp_Window[n] = 0.5f - 0.5f * cosf(2.0f * DSP_PI * n / DSP_FFT_SIZE);
+
+	for (uint32_t k = 0; k < DSP_HALF; k++) {
+		Dsp_Twiddle[k][0] = cosf(2.0f * DSP_PI * k / DSP_FFT_SIZE);
+		Dsp_Twiddle[k][1] = sinf(2.0f * DSP_PI * k / DSP_FFT_SIZE);
+	}
+
+	Dsp_SetChannel(channel);
+	return ADC_AddBlockListener(Dsp_BlockCallback, NULL);
+}
+
+/**
+ * @brief  Wählt den ausgewerteten Poti-Kanal, Filter und Rahmen beginnen neu
+ */
+void Dsp_SetChannel(uint8_t channel) {
+	Dsp_Channel = channel < ADC_POTI_COUNT ? channel : 0;
+	Dsp_DesignValid = 0;
+}
+
+/**
+ * @brief  Stellt den Tiefpass ein
+ * @param  cutoffHz: Grenzfrequenz, 0 = DSP_DEFAULT_CUTOFF der Abtastrate
+ */
+void Dsp_SetFilter(Dsp_Filter filter, float cutoffHz) {
+	Dsp_FilterType = filter;
+	Dsp_CutoffHz = cutoffHz;
+	Dsp_DesignValid = 0;
+}
+
+/**
+ * @brief  Verarbeitet einen vorgemerkten Block, aus einem Scheduler-Task aufrufen
+ */
+void Dsp_Process(void) {
+	const ADC_Block *block = Dsp_Pending;
+	uint32_t count = 0;
+	uint8_t fixed = Dsp_FilterType == DSP_FILTER_FIR_Q15 || Dsp_FilterType == DSP_FILTER_IIR_Q15;
+
+	if (block == NULL)
+		return;
+
+	uint32_t rate = ADC_GetChannelRate(Dsp_Channel);
+	if (rate == 0) {
+		ADC_ReleaseBlock(block);
+		Dsp_Pending = NULL;
+		return;
+	}
+
+	PROF_BEGIN(PROF_ID_DSP);
+
+	// Pick this channel's slots straight from the DMA half, then hand it back
+	for (uint32_t scan = 0; scan < block->scans; scan++) {
+		const uint16_t *samples = &block->data[scan * block->slots];
+		for (uint32_t slot = 0; slot < block->slots; slot++) {
+			if (block->slotChannel[slot] != Dsp_Channel)
+				continue;
+			if (fixed)
+				Dsp_InputQ15[count++] = (int16_t)(samples[slot] ^ 0x8000U);
+			else
+				Dsp_Input[count++] = ((int32_t)samples[slot] - 32768) * (1.0f / 32768.0f);
+		}
+	}
+	ADC_ReleaseBlock(block);
+	Dsp_Pending = NULL;
+
+	if (!Dsp_DesignValid || rate != Dsp_DesignRate)
+		Dsp_Design(rate);
+
+	if (fixed) {
+		if (Dsp_FilterType == DSP_FILTER_FIR_Q15)
+			Dsp_FirQ15(Dsp_InputQ15, count);
+		else
+			Dsp_IirQ15(Dsp_InputQ15, count);
+		for (uint32_t i = 0; i < count; i++)
+			Dsp_Input[i] = Dsp_InputQ15[i] * (1.0f / 32768.0f);
+	} else {
+		Dsp_FilterBlock(Dsp_Input, count);
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		Dsp_Frame[Dsp_FrameFill++] = Dsp_Input[i];
+		if (Dsp_FrameFill == DSP_FFT_SIZE) {
+			if (Overlay_Load(OVERLAY_DSP)) {
+				Dsp_Transform();
+				Overlay_Release(OVERLAY_DSP);
+			}
+			Dsp_FrameFill = 0;
+		}
+	}
+
+	if (count > 0)
+		Dsp_Spectra[Dsp_Published].level = Dsp_Input[count - 1];
+
+	PROF_END(PROF_ID_DSP);
+}
+
+/**
+ * @brief  Letztes vollständiges Spektrum; gültig bis zum übernächsten Dsp_Process()
+ */
+const Dsp_Spectrum* Dsp_GetSpectrum(void) {
+	return &Dsp_Spectra[Dsp_Published];
+}
+
+/**
+ * @brief  Blöcke, die verworfen wurden, weil der vorige noch nicht verarbeitet war
+ */
+uint32_t Dsp_GetSkipped(void) {
+	return Dsp_Skipped;
+}
+
+/**
+ * @brief  Empfänger der ADC-Blöcke, im DMA-Interrupt: nur vormerken
+ */
+static uint8_t Dsp_BlockCallback(const ADC_Block *block, void *context) {
+	if (Dsp_Pending != NULL) {
+		Dsp_Skipped++;
+		return 0;
+	}
+
+	Dsp_Pending = block;
+	return 1;
+}
+
+/**
+ * @brief  Berechnet FIR- und Biquad-Koeffizienten für eine Abtastrate
+ */
+static void Dsp_Design(uint32_t rateHz) {
+	float cutoff = Dsp_CutoffHz > 0 ? Dsp_CutoffHz : DSP_DEFAULT_CUTOFF * rateHz;
+	float fc = cutoff / rateHz;
+	if (fc > 0.49f) fc = 0.49f;
+
+	// FIR: windowed sinc (Hamming), normalised to unity gain at DC
+	float h[DSP_FIR_TAPS];
+	float sum = 0;
+	for (uint32_t n = 0; n < DSP_FIR_TAPS; n++) {
+		float m = n - (DSP_FIR_TAPS - 1) * 0.5f;
+		float sinc = m == 0 ? 2.0f * fc : sinf(2.0f * DSP_PI * fc * m) / (DSP_PI * m);
+		h[n] = sinc * (0.54f - 0.46f * cosf(2.0f * DSP_PI * n / (DSP_FIR_TAPS - 1)));
+		sum += h[n];
+	}
+	for (uint32_t n = 0; n < DSP_FIR_TAPS; n++) {
+		Dsp_FirCoeffs[n] = h[DSP_FIR_TAPS - 1 - n] / sum;
+		Dsp_FirCoeffsQ15[n] = Dsp_ToQ15(Dsp_FirCoeffs[n], 32768.0f);
+	}
+
+	// Biquad low-pass, Q = 1/sqrt(2) (RBJ cookbook)
+	float w0 = 2.0f * DSP_PI * fc;
+	float cosW = cosf(w0);
+	float alpha = sinf(w0) / (2.0f * 0.70710678f);
+	float a0 = 1.0f + alpha;
+	Dsp_Biquad[0] = (1.0f - cosW) * 0.5f / a0;
+	Dsp_Biquad[1] = (1.0f - cosW) / a0;
+	Dsp_Biquad[2] = Dsp_Biquad[0];
+	Dsp_Biquad[3] = -2.0f * cosW / a0;
+	Dsp_Biquad[4] = (1.0f - alpha) / a0;
+
+	// Q14 covers |a1| < 2; the feedback terms are stored negated so the loop only adds
+	for (uint32_t i = 0; i < 5; i++)
+		Dsp_BiquadQ14[i] = Dsp_ToQ15(i < 3 ? Dsp_Biquad[i] : -Dsp_Biquad[i], 16384.0f);
+	// Rounding b0 to a few LSB at low cutoff shifts the DC gain; b1 absorbs it so a held pot stays exact
+	Dsp_BiquadQ14[1] = 16384 - Dsp_BiquadQ14[3] - Dsp_BiquadQ14[4] - Dsp_BiquadQ14[0] - Dsp_BiquadQ14[2];
+
+	Dsp_DesignRate = rateHz;
+	Dsp_DesignValid = 1;
+	Dsp_Reset();
+
+	for (uint8_t i = 0; i < 2; i++)
+		Dsp_Spectra[i].binHz = (float)rateHz / DSP_FFT_SIZE;
+}
+
+/**
+ * @brief  Löscht Filterzustand und angefangenen Rahmen
+ */
+static void Dsp_Reset(void) {
+	memset(Dsp_FirState, 0, sizeof(Dsp_FirState));
+	memset(Dsp_BiquadState, 0, sizeof(Dsp_BiquadState));
+	memset(Dsp_FirStateQ15, 0, sizeof(Dsp_FirStateQ15));
+	memset(Dsp_BiquadStateQ15, 0, sizeof(Dsp_BiquadStateQ15));
+	Dsp_BiquadResidue = 0;
+	Dsp_FrameFill = 0;
+}
+
+/**
+ * @brief  Glättet einen Block an Ort und Stelle
+ */
+static void Dsp_FilterBlock(float *data, uint32_t count) {
+	switch (Dsp_FilterType) {
+		case DSP_FILTER_FIR:
+			Dsp_Fir(data, count);
+			break;
+		case DSP_FILTER_IIR:
+			Dsp_Iir(data, count);
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief  FIR über einen Block; die letzten DSP_FIR_TAPS - 1 Eingänge bleiben als Verlauf stehen
+ */
+RAMFUNC static void Dsp_Fir(float *data, uint32_t count) {
+	float *state = Dsp_FirState;
+
+	memcpy(&state[DSP_FIR_TAPS - 1], data, count * sizeof(float));
+
+	for (uint32_t i = 0; i < count; i++) {
+		const float *x = &state[i];
+		float acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+
+		// Four independent accumulators keep the FPU pipeline busy
+		for (uint32_t k = 0; k < DSP_FIR_TAPS; k += 4) {
+			acc0 += Dsp_FirCoeffs[k] * x[k];
+			acc1 += Dsp_FirCoeffs[k + 1] * x[k + 1];
+			acc2 += Dsp_FirCoeffs[k + 2] * x[k + 2];
+			acc3 += Dsp_FirCoeffs[k + 3] * x[k + 3];
+		}
+		data[i] = (acc0 + acc1) + (acc2 + acc3);
+	}
+
+	memmove(state, &state[count], (DSP_FIR_TAPS - 1) * sizeof(float));
+}
+
+/**
+ * @brief  Biquad (Direktform I) über einen Block
+ */
+RAMFUNC static void Dsp_Iir(float *data, uint32_t count) {
+	float b0 = Dsp_Biquad[0], b1 = Dsp_Biquad[1], b2 = Dsp_Biquad[2];
+	float a1 = Dsp_Biquad[3], a2 = Dsp_Biquad[4];
+	float x1 = Dsp_BiquadState[0], x2 = Dsp_BiquadState[1];
+	float y1 = Dsp_BiquadState[2], y2 = Dsp_BiquadState[3];
+
+	for (uint32_t i = 0; i < count; i++) {
+		float x0 = data[i];
+		float y0 = b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+		x2 = x1; x1 = x0;
+		y2 = y1; y1 = y0;
+		data[i] = y0;
+	}
+
+	Dsp_BiquadState[0] = x1; Dsp_BiquadState[1] = x2;
+	Dsp_BiquadState[2] = y1; Dsp_BiquadState[3] = y2;
+}
+
+/**
+ * @brief  FIR in Q15 über einen Block, zwei Taps je SMLALD
+ *
+ * Die Paare des Verlaufs liegen bei ungeradem i nicht auf Wortgrenzen; der M7 liest sie trotzdem
+ * mit einem LDR (unausgerichteter Zugriff auf Normal-Speicher, DTCM bzw. AXI-SRAM).
+ */
+RAMFUNC static void Dsp_FirQ15(int16_t *data, uint32_t count) {
+	int16_t *state = Dsp_FirStateQ15;
+
+	memcpy(&state[DSP_FIR_TAPS - 1], data, count * sizeof(int16_t));
+
+	for (uint32_t i = 0; i < count; i++) {
+		const int16_t *x = &state[i];
+		uint64_t acc0 = 0, acc1 = 0;
+
+		for (uint32_t k = 0; k < DSP_FIR_TAPS; k += 4) {
+			uint32_t c0, c1, x0, x1;
+			memcpy(&c0, &Dsp_FirCoeffsQ15[k], 4);
+			memcpy(&c1, &Dsp_FirCoeffsQ15[k + 2], 4);
+			memcpy(&x0, &x[k], 4);
+			memcpy(&x1, &x[k + 2], 4);
+			acc0 = __SMLALD(c0, x0, acc0);
+			acc1 = __SMLALD(c1, x1, acc1);
+		}
+		int64_t acc = (int64_t)acc0 + (int64_t)acc1 + (1 << 14);
+		data[i] = FixMath_SatQ15((int32_t)(acc >> 15));
+	}
+
+	memmove(state, &state[count], (DSP_FIR_TAPS - 1) * sizeof(int16_t));
+}
+
+/**
+ * @brief  Biquad (Direktform I) in Q15 mit Q14-Koeffizienten über einen Block
+ *
+ * Die beim Zurückschieben auf Q15 abgeschnittenen Bits gehen in den nächsten Wert ein
+ * (Fehlerrückführung erster Ordnung); sonst bliebe der Ausgang bei niedriger Grenzfrequenz
+ * einige LSB neben dem Eingang stehen.
+ */
+RAMFUNC static void Dsp_IirQ15(int16_t *data, uint32_t count) {
+	int32_t b0 = Dsp_BiquadQ14[0], b1 = Dsp_BiquadQ14[1], b2 = Dsp_BiquadQ14[2];
+	int32_t a1 = Dsp_BiquadQ14[3], a2 = Dsp_BiquadQ14[4];
+	int32_t x1 = Dsp_BiquadStateQ15[0], x2 = Dsp_BiquadStateQ15[1];
+	int32_t y1 = Dsp_BiquadStateQ15[2], y2 = Dsp_BiquadStateQ15[3];
+	int32_t residue = Dsp_BiquadResidue;
+
+	for (uint32_t i = 0; i < count; i++) {
+		int32_t x0 = data[i];
+		int64_t acc = (int64_t)b0 * x0 + (int64_t)b1 * x1 + (int64_t)b2 * x2
+				+ (int64_t)a1 * y1 + (int64_t)a2 * y2 + residue;
+		int32_t y0 = FixMath_SatQ15((int32_t)(acc >> 14));
+		residue = (int32_t)(acc & 0x3FFF);
+		x2 = x1; x1 = x0;
+		y2 = y1; y1 = y0;
+		data[i] = (int16_t)y0;
+	}
+
+	Dsp_BiquadStateQ15[0] = (int16_t)x1; Dsp_BiquadStateQ15[1] = (int16_t)x2;
+	Dsp_BiquadStateQ15[2] = (int16_t)y1; Dsp_BiquadStateQ15[3] = (int16_t)y2;
+	Dsp_BiquadResidue = residue;
+}
+
+/**
+ * @brief  Rundet einen Koeffizienten in das Festkommaformat (scale = 1,0) mit Sättigung auf 16 Bit
+ */
+static int16_t Dsp_ToQ15(float value, float scale) {
+	float q = value * scale + (value >= 0 ? 0.5f : -0.5f);
+	if (q > 32767.0f) return 32767;
+	if (q < -32768.0f) return -32768;
+	return (int16_t)q;
+}
+
+/**
+ * @brief  Reelle FFT des vollen Rahmens und Beträge in den nicht veröffentlichten Puffer
+ *
+ * Die N reellen Werte werden als N/2 komplexe (gerade = Real-, ungerade = Imaginärteil)
+ * transformiert und danach entflochten: X[k] = E[k] + W^k * O[k].
+ */
+OVERLAY(dsp) static void Dsp_Transform(void) {
+	uint8_t back = Dsp_Published ^ 1;
+	Dsp_Spectrum *out = &Dsp_Spectra[back];
+
+	for (uint32_t n = 0; n < DSP_FFT_SIZE; n++)
+		Dsp_Work[n] = Dsp_Frame[n] * Dsp_Window[n];
+
+	Dsp_Fft(Dsp_Work, DSP_HALF);
+
+	// Hann window has a coherent gain of 0.5, so 4/N restores the amplitude of a sine
+	const float scale = 4.0f / DSP_FFT_SIZE;
+	for (uint32_t k = 0; k < DSP_HALF; k++) {
+		uint32_t m = (DSP_HALF - k) & (DSP_HALF - 1);
+		float zr = Dsp_Work[2 * k], zi = Dsp_Work[2 * k + 1];
+		float cr = Dsp_Work[2 * m], ci = -Dsp_Work[2 * m + 1];
+
+		float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+		float odr = 0.5f * (zi - ci), odi = -0.5f * (zr - cr);
+
+		float c = Dsp_Twiddle[k][0], s = Dsp_Twiddle[k][1];
+		float xr = er + c * odr + s * odi;
+		float xi = ei + c * odi - s * odr;
+
+		out->magnitude[k] = sqrtf(xr * xr + xi * xi) * (k == 0 ? scale * 0.5f : scale);
+	}
+
+	out->level = Dsp_Spectra[Dsp_Published].level;
+	out->sequence = Dsp_Spectra[Dsp_Published].sequence + 1;
+	Dsp_Published = back;
+}
+
+/**
+ * @brief  Komplexe Radix-2-FFT an Ort und Stelle, z = re, im, re, im, ...
+ * @param  points: Zahl der komplexen Werte (DSP_HALF)
+ */
+OVERLAY(dsp) static void Dsp_Fft(float *z, uint32_t points) {
+	// Bit-reversal permutation
+	for (uint32_t i = 1, j = 0; i < points; i++) {
+		uint32_t bit = points >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+
+		if (i < j) {
+			float tr = z[2 * i], ti = z[2 * i + 1];
+			z[2 * i] = z[2 * j]; z[2 * i + 1] = z[2 * j + 1];
+			z[2 * j] = tr; z[2 * j + 1] = ti;
+		}
+	}
+
+	// Butterflies; W_len^k = W_N^(k * N / len) from the shared twiddle table
+	for (uint32_t len = 2; len <= points; len <<= 1) {
+		uint32_t half = len >> 1;
+		uint32_t step = DSP_FFT_SIZE / len;
+
+		for (uint32_t i = 0; i < points; i += len) {
+			for (uint32_t k = 0; k < half; k++) {
+				float wr = Dsp_Twiddle[k * step][0], wi = -Dsp_Twiddle[k * step][1];
+				float *a = &z[2 * (i + k)];
+				float *b = &z[2 * (i + k + half)];
+
+				float tr = b[0] * wr - b[1] * wi;
+				float ti = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - tr; b[1] = a[1] - ti;
+				a[0] += tr; a[1] += ti;
+			}
+		}
+	}
+}
@@ -0,0 +1,233 @@
+/**
+ * @file    Effects.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Lichteffekte für den WS2812-Streifen in Festkomma, gesteuert über die Potis
+ *
+ * Ein Scheduler-Task ruft alle EFFECTS_TICK_MS Effects_Tick() auf, Effects_SetInputs() nur,
+ * wenn UpdatePotiValues() ein bewegtes Poti meldet; Effects_Tick() schreibt in die Farbdaten
+ * von WS2812.c, gesendet wird mit WS2812_Show(). Rechnungen laufen ganzzahlig: Farbton und Phasen als Bruchteil
+ * einer vollen Umdrehung in 16 Bit, Sättigung und Helligkeit in Q15 (EFFECTS_Q15_ONE = 1,0).
+ *
+ * Neu berechnet wird nur, was sich ändert:
+ * - Statisch und Pulsieren: eine Farbe für alle LEDs, nur wenn sie sich geändert hat
+ * - Regenbogen: alle LEDs, aber nur wenn sich die Phase weiterbewegt hat
+ * - Lauflicht: nur die LEDs zwischen altem Schweifende und neuem Kopf
+ * Ändert sich ein Poti oder der Effekt, wird der ganze Streifen einmal neu gezeichnet.
+ *
+ * Poti 4 stellt bei allen Effekten die Helligkeit ein (WS2812_SetBrightness()).
+ */
+
+#include "Effects.h"
+#include "WS2812.h"
+#include "FixMath.h"
+
+Effects_Mode Effects_CurrentMode = EFFECTS_STATIC;
+uint16_t Effects_Pots[4];
+uint8_t Effects_Redraw = 1;                // ganzer Streifen neu
+uint16_t Effects_Phase = 0;                // Fortschritt des Effekts, eine Umdrehung = 65536
+uint16_t Effects_LastPhase = 0;
+uint16_t Effects_ChaseHead = 0;            // LED, an der der Kopf des Lauflichts zuletzt stand
+
+static void Effects_Static(void);
+static void Effects_Fade(void);
+static void Effects_Rainbow(void);
+static void Effects_Chase(void);
+static void Effects_ChasePixel(uint16_t index, uint16_t head, uint16_t tail);
+static uint16_t Effects_Speed(uint16_t pot);
+
+/**
+ * @brief  Wählt einen Effekt, der Streifen wird im nächsten Tick neu gezeichnet
+ */
+void Effects_SetMode(Effects_Mode mode) {
+	if (mode >= EFFECTS_COUNT)
+		mode = EFFECTS_STATIC;
+
+	Effects_CurrentMode = mode;
+	Effects_Phase = 0;
+	Effects_Redraw = 1;
+}
+
+/**
+ * @brief  Schaltet zum nächsten Effekt weiter (z.B. per Taster)
+ */
+void Effects_NextMode(void) {
+	Effects_SetMode((Effects_Mode)((Effects_CurrentMode + 1) % EFFECTS_COUNT));
+}
+
+/**
+ * @brief  Aktueller Effekt
+ */
+Effects_Mode Effects_GetMode(void) {
+	return Effects_CurrentMode;
+}
+
+/**
+ * @brief  Übernimmt die Potiwerte (0-65535), nur aufrufen, wenn UpdatePotiValues() eine Änderung meldet
+ */
+void Effects_SetInputs(uint16_t pot1, uint16_t pot2, uint16_t pot3, uint16_t pot4) {
+	// The dead band is applied by UpdatePotiValues(); brightness alone needs no redraw
+	if (pot1 != Effects_Pots[0] || pot2 != Effects_Pots[1] || pot3 != Effects_Pots[2]) {
+		Effects_Pots[0] = pot1;
+		Effects_Pots[1] = pot2;
+		Effects_Pots[2] = pot3;
+		Effects_Redraw = 1;
+	}
+
+	Effects_Pots[3] = pot4;
+	WS2812_SetBrightness(((uint32_t)pot4 * WS2812_BRIGHTNESS_MAX) >> 16);
+}
+
+/**
+ * @brief  Rechnet einen Schritt des aktuellen Effekts, alle EFFECTS_TICK_MS aufrufen
+ */
+void Effects_Tick(void) {
+	switch (Effects_CurrentMode) {
+		case EFFECTS_FADE:
+			Effects_Fade();
+			break;
+		case EFFECTS_RAINBOW:
+			Effects_Rainbow();
+			break;
+		case EFFECTS_CHASE:
+			Effects_Chase();
+			break;
+		case EFFECTS_STATIC:
+		default:
+			Effects_Static();
+			break;
+	}
+
+	Effects_LastPhase = Effects_Phase;
+	Effects_Redraw = 0;
+}
+
+/**
+ * @brief  HSV nach RGB in Festkomma
+ * @param  hue: Farbton, 0-65535 entspricht 0-360°
+ * @param  sat: Sättigung in Q15 (0 bis EFFECTS_Q15_ONE)
+ * @param  val: Helligkeit in Q15 (0 bis EFFECTS_Q15_ONE)
+ */
+void Effects_HsvToRgb(uint16_t hue, uint16_t sat, uint16_t val, uint8_t *red, uint8_t *green, uint8_t *blue) {
+	uint32_t sector = ((uint32_t)hue * 6) >> 16;              // 0-5
+	uint32_t frac = (((uint32_t)hue * 6) & 0xFFFF) >> 1;      // position within the sector, Q15
+
+	uint32_t v = val;
+	uint32_t p = FixMath_Q15Scale(v, EFFECTS_Q15_ONE - sat);
+	uint32_t q = FixMath_Q15Scale(v, EFFECTS_Q15_ONE - FixMath_Q15Scale(sat, frac));
+	uint32_t t = FixMath_Q15Scale(v, EFFECTS_Q15_ONE - FixMath_Q15Scale(sat, EFFECTS_Q15_ONE - frac));
+	uint32_t r, g, b;
+
+	switch (sector) {
+		case 0:  r = v; g = t; b = p; break;
+		case 1:  r = q; g = v; b = p; break;
+		case 2:  r = p; g = v; b = t; break;
+		case 3:  r = p; g = q; b = v; break;
+		case 4:  r = t; g = p; b = v; break;
+		default: r = v; g = p; b = q; break;
+	}
+
+	*red = (uint8_t)FixMath_Q15Scale(255, r);
+	*green = (uint8_t)FixMath_Q15Scale(255, g);
+	*blue = (uint8_t)FixMath_Q15Scale(255, b);
+}
+
+/**
+ * @brief  Feste Farbe aus den Potis 1-3
+ */
+static void Effects_Static(void) {
+	if (!Effects_Redraw)
+		return;
+
+	WS2812_SetAll(Effects_Pots[0] >> 8, Effects_Pots[1] >> 8, Effects_Pots[2] >> 8);
+}
+
+/**
+ * @brief  Eine Farbe, deren Helligkeit weich (Kosinus) auf- und abschwillt
+ */
+static void Effects_Fade(void) {
+	static uint8_t lastRed, lastGreen, lastBlue;
+	uint8_t red, green, blue;
+
+	Effects_Phase += Effects_Speed(Effects_Pots[1]);
+
+	// Raised cosine 0 -> 1 -> 0 over one turn, Q15: (1 - cos) / 2
+	int32_t cosine = FixMath_Cos((int32_t)((uint32_t)Effects_Phase << 16));
+	uint32_t val = (uint32_t)(((int64_t)FIXMATH_Q31_MAX - cosine + 1) >> 17);
+	Effects_HsvToRgb(Effects_Pots[0], Effects_Pots[2] >> 1, (uint16_t)val, &red, &green, &blue);
+
+	if (!Effects_Redraw && red == lastRed && green == lastGreen && blue == lastBlue)
+		return;
+
+	lastRed = red, lastGreen = green, lastBlue = blue;
+	WS2812_SetAll(red, green, blue);
+}
+
+/**
+ * @brief  Farbton wandert über den Streifen, Poti 2 bestimmt, wie viel davon gleichzeitig zu sehen ist
+ */
+static void Effects_Rainbow(void) {
+	Effects_Phase += Effects_Speed(Effects_Pots[0]);
+
+	if (!Effects_Redraw && Effects_Phase == Effects_LastPhase)
+		return;
+
+	// Hue step between neighbouring LEDs: pot 2 = 0 -> whole strip one colour, max -> one full turn
+	uint32_t spread = Effects_Pots[1] / MAX_LED;
+	uint16_t sat = Effects_Pots[2] >> 1;
+
+	for (uint16_t i = 0; i < MAX_LED; i++) {
+		uint8_t red, green, blue;
+		Effects_HsvToRgb((uint16_t)(Effects_Phase + i * spread), sat, EFFECTS_Q15_ONE, &red, &green, &blue);
+		WS2812_SetPixel(i, red, green, blue);
+	}
+}
+
+/**
+ * @brief  Ein Lichtpunkt mit Schweif läuft über den Streifen
+ */
+static void Effects_Chase(void) {
+	Effects_Phase += Effects_Speed(Effects_Pots[1]);
+
+	uint16_t head = ((uint32_t)Effects_Phase * MAX_LED) >> 16;
+	uint16_t tail = 1 + (((uint32_t)Effects_Pots[2] * MAX_LED) >> 16);
+
+	if (Effects_Redraw) {
+		for (uint16_t i = 0; i < MAX_LED; i++)
+			Effects_ChasePixel(i, head, tail);
+	}
+	else if (head != Effects_ChaseHead) {
+		// Only LEDs from the old tail end up to the new head change
+		uint16_t moved = (head + MAX_LED - Effects_ChaseHead) % MAX_LED;
+		uint32_t count = (uint32_t)moved + tail;
+		if (count > MAX_LED) count = MAX_LED;
+
+		uint16_t i = (head + MAX_LED - (count - 1)) % MAX_LED;
+		for (uint32_t n = 0; n < count; n++, i = (i + 1) % MAX_LED)
+			Effects_ChasePixel(i, head, tail);
+	}
+
+	Effects_ChaseHead = head;
+}
+
+/**
+ * @brief  Farbe einer LED im Lauflicht: voll am Kopf, linear dunkler über den Schweif
+ */
+static void Effects_ChasePixel(uint16_t index, uint16_t head, uint16_t tail) {
+	uint16_t distance = (head + MAX_LED - index) % MAX_LED;
+	uint8_t red = 0, green = 0, blue = 0;
+
+	if (distance < tail) {
+		uint16_t val = (uint16_t)((EFFECTS_Q15_ONE * (uint32_t)(tail - distance)) / tail);
+		Effects_HsvToRgb(Effects_Pots[0], EFFECTS_Q15_ONE, val, &red, &green, &blue);
+	}
+
+	WS2812_SetPixel(index, red, green, blue);
+}
+
+/**
+ * @brief  Phasenschritt je Tick aus einem Poti: Poti auf 0 = eine Umdrehung in ca. 20 min, Maximum = ca. 1,3 s
+ */
+static uint16_t Effects_Speed(uint16_t pot) {
+	return 1 + (pot >> 6);
+}
@@ -0,0 +1,871 @@
+/**
+ * @file    EspLink.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Verbindung zum ESP-12E-Einsatz: Rahmen mit Kanälen und Krediten über UART7, Senden ohne Kopie
+ *
+ * Der Einsatz (Hardware/ESP32Insert) steckt im Steckplatz des HC06 und hat nur die UART-Leitungen
+ * (STM_TX, STM_RX, GND, 5V); SPI ist dort nicht verdrahtet. Die Verbindung läuft deshalb über UART7
+ * mit der Baudrate aus CubeMX (921600). Bis der ESP ein HELLO schickt, bleibt UART7 die gewohnte
+ * Logausgabe; danach gehört die UART der Verbindung, und der Inhalt von Serial_Log geht als Kanal
+ * ESPLINK_CH_LOG hinaus (Serial_SetExternal()). Schweigt der ESP ESPLINK_TIMEOUT_MS lang, fällt
+ * UART7 an Serial_Log zurück.
+ *
+ * Rahmen (Little Endian):
+ *   0xA5, Kanal, Folgenummer je Kanal (1), Tag (2), Länge (2), CRC-8 über die Bytes 0-6 (Polynom 0x07),
+ *   Nutzdaten, CRC32 der Nutzdaten (wie zlib.crc32, entfällt bei Länge 0)
+ * Der Empfänger sucht das 0xA5, prüft den Kopf und verwirft bei Fehler nur das erste Byte.
+ *
+ * Senden ohne Kopie: EspLink_Send() nimmt einen Zeiger auf die Daten des Erzeugers, rechnet die
+ * CRC32 (Crc32.c) und schreibt gecachte Zeilen zurück. Der DMA sendet dann nacheinander Kopf,
+ * Nutzdaten und CRC, jeweils aus dem Abschluss-Interrupt gestartet; erst danach meldet der
+ * EspLink_Done-Callback, dass der Erzeuger seinen Puffer wieder beschreiben darf. Nutzdaten bis
+ * ESPLINK_COPY_MAX Bytes werden hinter den Kopf kopiert und gehen in einem Transfer. Daten im DTCM
+ * erreicht DMA1 nicht, sie werden abgelehnt.
+ *
+ * Kredite: Jeder Rahmen auf den Kanälen 1-4 verbraucht einen Kredit, den die Gegenstelle mit
+ * HELLO oder CREDIT vergeben hat; ohne Kredit wartet der Kanal (stalls, stallUs), die anderen
+ * laufen weiter. Kontrollrahmen brauchen keinen Kredit und gehen immer zuerst. Umgekehrt nimmt
+ * der STM eine Befehlszeile an und vergibt den nächsten Kredit für ESPLINK_CH_COMMAND erst, wenn
+ * die Kommandozeile sie ausgeführt hat (Shell_Submit()); die Ausgabe geht über EspLink_Reply zurück.
+ *
+ * Der Empfang läuft wie bei der Kommandozeile zirkulär per DMA mit Idle-Erkennung, den Stream
+ * vergibt DmaAlloc. Die Auswertung, PING, das Leeren der Sendepuffer und Mirror.c laufen im
+ * Timer-Callback (ESPLINK_TICK_MS), jeder Empfang weckt ihn sofort.
+ *
+ * Vor einer Taktumschaltung hält EspLink_Suspend() den Sendeweg nach dem laufenden Transfer an
+ * und bricht den Empfang ab, EspLink_Resume() setzt beides fort.
+ */
+
+#include "EspLink.h"
+
+#if ESPLINK_ENABLE
+
+#include "Cache.h"
+#include "Crc32.h"
+#include "DmaAlloc.h"
+#include "Irq.h"
+#include "Log.h"
+#include "Shell.h"
+#include "Timebase.h"
+#include "Timer.h"
+#include "ILI9341.h"
+#include <stdio.h>
+#include <string.h>
+
+#if (ESPLINK_RX_BUFFER_SIZE & (ESPLINK_RX_BUFFER_SIZE - 1)) != 0
+#error "ESPLINK_RX_BUFFER_SIZE muss eine Zweierpotenz sein!"
+#endif
+
+#define ESPLINK_RX_MASK           (ESPLINK_RX_BUFFER_SIZE - 1)
+#define ESPLINK_NO_CHANNEL        0xFF
+
+/* Kopf, kopierte Nutzdaten und CRC eines Rahmens, auf Cache-Zeilen aufgerundet */
+#define ESPLINK_SLOT_SIZE         ((ESPLINK_HEADER_SIZE + ESPLINK_COPY_MAX + ESPLINK_CRC_SIZE + 31) & ~31)
+
+/* DTCM: von DMA1 nicht erreichbar */
+#define ESPLINK_DTCM_BASE         0x20000000UL
+#define ESPLINK_DTCM_END          0x20020000UL
+
+/**
+ * @brief Eingereihter Rahmen
+ */
+typedef struct {
+	uint8_t *frame;                // Kopf, ggf. Nutzdaten, CRC (DMA_BUFFER)
+	uint16_t frameLength;          // erster Transfer
+	uint8_t transfers;             // 1 = kopiert, 3 = Kopf, Nutzdaten, CRC
+	const uint8_t *data;
+	uint32_t length;
+	EspLink_Done done;
+	void *context;
+	uint32_t queuedUs;
+} EspLink_Slot;
+
+typedef struct {
+	EspLink_Slot slot[ESPLINK_QUEUE_DEPTH];
+	volatile uint32_t head;        // eingereiht
+	volatile uint32_t tail;        // fertig
+	uint8_t sequence;
+	uint8_t stalled;
+	uint32_t stallStartUs;
+} EspLink_Queue;
+
+/**
+ * @brief Sendepuffer, dessen Inhalt direkt aus dem Ring auf einen Kanal geht
+ */
+typedef struct {
+	Serial_Port *port;
+	uint8_t channel;
+	volatile uint32_t queued;      // eingereiht, tail noch nicht vorgerückt
+} EspLink_Drain;
+
+static uint8_t EspLink_SlotBuffer[ESPLINK_CHANNEL_COUNT][ESPLINK_QUEUE_DEPTH][ESPLINK_SLOT_SIZE] DMA_BUFFER;
+static uint8_t EspLink_RxBuffer[ESPLINK_RX_BUFFER_SIZE] DMA_BUFFER;
+static uint8_t EspLink_ReplyBuffer[ESPLINK_REPLY_BUFFER_SIZE] DMA_BUFFER;
+static uint8_t EspLink_RxFrame[ESPLINK_HEADER_SIZE + ESPLINK_MAX_RX_PAYLOAD + ESPLINK_CRC_SIZE] __attribute__((aligned(4)));
+
+// Output of commands received on ESPLINK_CH_COMMAND, never sent by Serial.c itself
+static Serial_Port EspLink_Reply = {
+	.buffer = EspLink_ReplyBuffer,
+	.size = ESPLINK_REPLY_BUFFER_SIZE,
+};
+
+static EspLink_Drain EspLink_LogDrain = { &Serial_Log, ESPLINK_CH_LOG, 0 };
+static EspLink_Drain EspLink_ReplyDrain = { &EspLink_Reply, ESPLINK_CH_COMMAND, 0 };
+
+static DMA_HandleTypeDef EspLink_DmaRx;
+static Timer EspLink_Timer;
+static uint8_t EspLink_Initialised = 0;
+static uint32_t EspLink_PeriodMs = ESPLINK_IDLE_MS;
+
+static EspLink_Queue EspLink_Queues[ESPLINK_CHANNEL_COUNT];
+static volatile uint16_t EspLink_Credits[ESPLINK_CHANNEL_COUNT];
+static EspLink_Stats EspLink_Statistics;
+static uint32_t EspLink_StatsStartMs = 0;
+
+// Transmit engine, advanced from the DMA complete interrupt
+static volatile uint8_t EspLink_Active = ESPLINK_NO_CHANNEL;
+static volatile uint8_t EspLink_Step = 0;
+static volatile uint8_t EspLink_TxBusy = 0;
+static volatile uint16_t EspLink_TxLength = 0;
+static volatile uint8_t EspLink_Suspended = 0;
+static uint8_t EspLink_LastChannel = ESPLINK_CH_CONTROL;   // round robin over the data channels
+
+// Link state
+static volatile uint8_t EspLink_Up = 0;
+static uint8_t EspLink_ReturnLog = 0;           // give UART7 back to Serial_Log once idle
+static uint32_t EspLink_LastRxMs = 0;
+static uint32_t EspLink_LastPingMs = 0;
+static uint8_t EspLink_CommandCreditOwed = 0;
+
+// Receiver
+static uint8_t EspLink_RxRunning = 0;
+static uint16_t EspLink_RxPos = 0;              // DMA position at the last event
+static volatile uint32_t EspLink_Received = 0;  // bytes received, free running
+static uint32_t EspLink_Parsed = 0;
+static uint32_t EspLink_RxFill = 0;
+static uint32_t EspLink_RxNeed = 0;
+
+static void EspLink_Tick(void *context);
+static void EspLink_StartRx(void);
+static void EspLink_Parse(void);
+static void EspLink_Dispatch(uint8_t channel, const uint8_t *data, uint16_t length, uint16_t tag);
+static void EspLink_Control(const uint8_t *data, uint16_t length);
+static void EspLink_Connect(void);
+static void EspLink_SendHello(void);
+static void EspLink_SendControl(const uint8_t *data, uint32_t length);
+static void EspLink_AddCredits(uint8_t channel, uint16_t count);
+static void EspLink_DrainPort(EspLink_Drain *drain);
+static void EspLink_Drained(const void *data, uint32_t length, uint8_t sent, void *context);
+static void EspLink_Purge(void);
+static void EspLink_StartNext(void);
+static uint8_t EspLink_Pick(void);
+static void EspLink_Finish(uint8_t channel, uint8_t sent);
+static uint8_t EspLink_Crc8(const uint8_t *data, uint32_t length);
+
+/**
+ * @brief  Richtet den Empfang auf UART7 ein und startet den Timer, UART7 bleibt bis zum HELLO Logausgabe
+ *
+ * Nach MX_UART7_Init() und Serial_Init(&Serial_Log, ...) aufrufen. Ohne freien DMA-Stream bleibt
+ * die Verbindung aus.
+ */
+void EspLink_Init(void) {
+	DMA_HandleTypeDef *hdma = &EspLink_DmaRx;
+
+	for (uint8_t c = 0; c < ESPLINK_CHANNEL_COUNT; c++)
+		for (uint8_t i = 0; i < ESPLINK_QUEUE_DEPTH; i++)
+			EspLink_Queues[c].slot[i].frame = EspLink_SlotBuffer[c][i];
+
+	Serial_Init(&EspLink_Reply, &huart7);
+	EspLink_Reply.external = 1;
+	Crc32_Init();
+
+	hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+	hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma->Init.MemInc = DMA_MINC_ENABLE;
+	hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	hdma->Init.Mode = DMA_CIRCULAR;
+	hdma->Init.Priority = DMA_PRIORITY_LOW;
+	hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (!DmaAlloc_Claim(hdma, DMAALLOC_DMA, DMA_REQUEST_UART7_RX, IRQ_PRIO_LOG, "UART7 RX")
+			|| HAL_DMA_Init(hdma) != HAL_OK) {
+		DmaAlloc_Release(hdma);
+		return;    // UART7 stays the plain log output, 'esp' shows the link as down
+	}
+	__HAL_LINKDMA(&huart7, hdmarx, EspLink_DmaRx);
+
+	EspLink_Initialised = 1;
+	EspLink_StatsStartMs = HAL_GetTick();
+	EspLink_Statistics.minRttUs = UINT32_MAX;
+	EspLink_StartRx();
+
+	Timer_Setup(&EspLink_Timer, "EspLink", EspLink_Tick, NULL);
+	Timer_Start(&EspLink_Timer, EspLink_PeriodMs, EspLink_PeriodMs);
+}
+
+/**
+ * @brief  Reiht einen Rahmen ein, nur aus Tasks (die CRC rechnet die CRC-Einheit)
+ * @param  channel: ESPLINK_CH_*
+ * @param  data: bleibt bis zum done-Callback unverändert, nicht im DTCM
+ * @param  length: höchstens ESPLINK_MAX_PAYLOAD
+ * @param  tag: frei je Kanal (ESPLINK_CH_DISPLAY: Bildnummer von Mirror.c)
+ * @param  done: darf NULL sein, läuft im Interrupt
+ * @retval 1 eingereiht, 0 wenn die Verbindung steht nicht, die Warteschlange voll ist oder die Daten unzulässig sind
+ */
+uint8_t EspLink_Send(uint8_t channel, const void *data, uint32_t length, uint16_t tag, EspLink_Done done, void *context) {
+	uintptr_t address = (uintptr_t)data;
+
+	if (channel >= ESPLINK_CHANNEL_COUNT || length > ESPLINK_MAX_PAYLOAD || !EspLink_Up)
+		return 0;
+	if (length > ESPLINK_COPY_MAX && address >= ESPLINK_DTCM_BASE && address < ESPLINK_DTCM_END)
+		return 0;
+
+	EspLink_Queue *q = &EspLink_Queues[channel];
+	if (q->head - q->tail >= ESPLINK_QUEUE_DEPTH) {
+		EspLink_Statistics.channel[channel].full++;
+		return 0;
+	}
+
+	EspLink_Slot *s = &q->slot[q->head % ESPLINK_QUEUE_DEPTH];
+	uint8_t *f = s->frame;
+	f[0] = ESPLINK_SYNC;
+	f[1] = channel;
+	f[2] = q->sequence++;
+	f[3] = (uint8_t)tag;
+	f[4] = (uint8_t)(tag >> 8);
+	f[5] = (uint8_t)length;
+	f[6] = (uint8_t)(length >> 8);
+	f[7] = EspLink_Crc8(f, 7);
+
+	uint32_t crc = length ? Crc32_Compute(data, length) : 0;
+	if (length <= ESPLINK_COPY_MAX) {
+		memcpy(&f[ESPLINK_HEADER_SIZE], data, length);
+		s->frameLength = ESPLINK_HEADER_SIZE + length;
+		if (length > 0) {
+			memcpy(&f[s->frameLength], &crc, ESPLINK_CRC_SIZE);
+			s->frameLength += ESPLINK_CRC_SIZE;
+		}
+		s->transfers = 1;
+	} else {
+		memcpy(&f[ESPLINK_HEADER_SIZE], &crc, ESPLINK_CRC_SIZE);
+		s->frameLength = ESPLINK_HEADER_SIZE;
+		s->transfers = 3;
+		Cache_CleanDMA(data, length);
+	}
+	s->data = data;
+	s->length = length;
+	s->done = done;
+	s->context = context;
+	s->queuedUs = Timebase_Us32();
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	q->head++;
+	EspLink_StartNext();
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+/**
+ * @brief  1, solange der ESP verbunden ist und UART7 der Verbindung gehört
+ */
+uint8_t EspLink_IsUp(void) {
+	return EspLink_Up;
+}
+
+/**
+ * @brief  Trennt die Verbindung, eingereihte Rahmen werden verworfen, UART7 geht an Serial_Log zurück
+ *
+ * Ein neues HELLO des ESP verbindet wieder.
+ */
+void EspLink_Disconnect(void) {
+	uint32_t primask;
+
+	if (!EspLink_Up)
+		return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	EspLink_Up = 0;
+	for (uint8_t c = 0; c < ESPLINK_CHANNEL_COUNT; c++)
+		EspLink_Credits[c] = 0;
+	EspLink_Purge();
+	__set_PRIMASK(primask);
+
+	EspLink_Statistics.up = 0;
+	EspLink_ReturnLog = 1;
+	LOG("EspLink getrennt");
+}
+
+/**
+ * @brief  1, solange ein DMA-Transfer auf UART7 läuft (Governor schaltet dann nicht um)
+ */
+uint8_t EspLink_IsBusy(void) {
+	return EspLink_TxBusy;
+}
+
+/**
+ * @brief  Vor der Taktumschaltung: laufenden Transfer beenden lassen, keinen neuen starten, Empfang abbrechen
+ */
+void EspLink_Suspend(void) {
+	uint32_t start = HAL_GetTick();
+
+	EspLink_Suspended = 1;
+	while (EspLink_TxBusy && HAL_GetTick() - start < SERIAL_WAIT_TIMEOUT)
+		;
+	if (EspLink_RxRunning) {
+		HAL_UART_AbortReceive(&huart7);
+		EspLink_RxRunning = 0;
+	}
+}
+
+/**
+ * @brief  Nach der Taktumschaltung: Empfang neu starten und weitersenden
+ */
+void EspLink_Resume(void) {
+	uint32_t primask;
+
+	if (EspLink_Initialised && !EspLink_RxRunning)
+		EspLink_StartRx();
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	EspLink_Suspended = 0;
+	EspLink_StartNext();
+	__set_PRIMASK(primask);
+}
+
+const EspLink_Stats* EspLink_GetStats(void) {
+	for (uint8_t c = 0; c < ESPLINK_CHANNEL_COUNT; c++)
+		EspLink_Statistics.channel[c].credits = EspLink_Credits[c];
+	return &EspLink_Statistics;
+}
+
+void EspLink_ResetStats(void) {
+	uint8_t up = EspLink_Statistics.up;
+
+	memset(&EspLink_Statistics, 0, sizeof(EspLink_Statistics));
+	EspLink_Statistics.up = up;
+	EspLink_Statistics.minRttUs = UINT32_MAX;
+	EspLink_StatsStartMs = HAL_GetTick();
+}
+
+/**
+ * @brief  Zustand, Durchsatz, Umlaufzeit und Zähler je Kanal für die Kommandozeile
+ */
+void EspLink_Dump(void) {
+	static const char *const names[ESPLINK_CHANNEL_COUNT] = { "control", "log", "tele", "display", "command" };
+	const EspLink_Stats *s = EspLink_GetStats();
+	uint32_t elapsedMs = HAL_GetTick() - EspLink_StatsStartMs;
+
+	if (!EspLink_Initialised) {
+		printf("ESP-Link aus: kein DMA-Stream für den Empfang auf UART7\n");
+		return;
+	}
+	printf("ESP-Link %s auf UART7 (%lu Baud), %lu Verbindungen, %lu Zeitüberschreitungen\n",
+			s->up ? "verbunden" : "getrennt", huart7.Init.BaudRate, s->connects, s->timeouts);
+	printf("  gesendet %lu B (%lu B/s), %lu DMA-Transfers, %lu Fehler\n", (uint32_t)s->txBytes,
+			elapsedMs ? (uint32_t)(s->txBytes * 1000U / elapsedMs) : 0, s->txDma, s->txErrors);
+	printf("  empfangen %lu B (%lu B/s), Kopf %lu, CRC %lu, Überlauf %lu, Neustart %lu, übersprungen %lu B\n",
+			(uint32_t)s->rxBytes, elapsedMs ? (uint32_t)(s->rxBytes * 1000U / elapsedMs) : 0, s->rxHeaderErrors,
+			s->rxCrcErrors, s->rxOverruns, s->rxRestarts, s->rxSkipped);
+	printf("  Umlauf %lu us (min %lu, max %lu), %lu PING / %lu PONG, %lu Befehle\n",
+			s->lastRttUs, s->minRttUs == UINT32_MAX ? 0 : s->minRttUs, s->maxRttUs, s->pings, s->pongs,
+			s->commands);
+	printf("  Kanal     Rahmen      Bytes Kredit  voll verworfen  Stau  Stau ms  Latenz us (mittel/max) empfangen\n");
+	for (uint8_t c = 0; c < ESPLINK_CHANNEL_COUNT; c++) {
+		const EspLink_ChannelStats *ch = &s->channel[c];
+		printf("  %-8s %7lu %10lu %6u %5lu %9lu %5lu %8lu %10lu %10lu %9lu\n", names[c], ch->frames,
+				(uint32_t)ch->bytes, ch->credits, ch->full, ch->discarded, ch->stalls,
+				(uint32_t)(ch->stallUs / 1000U), ch->frames ? (uint32_t)(ch->sumLatencyUs / ch->frames) : 0,
+				ch->maxLatencyUs, ch->rxFrames);
+	}
+}
+
+/**
+ * @brief  Aus HAL_UART_TxCpltCallback(): nächster Teil des Rahmens bzw. nächster Rahmen
+ */
+void EspLink_TxCpltCallback(UART_HandleTypeDef *huart) {
+	if (huart != &huart7 || !EspLink_TxBusy)
+		return;
+
+	EspLink_TxBusy = 0;
+	EspLink_Statistics.txBytes += EspLink_TxLength;
+
+	EspLink_Queue *q = &EspLink_Queues[EspLink_Active];
+	EspLink_Slot *s = &q->slot[q->tail % ESPLINK_QUEUE_DEPTH];
+	if (++EspLink_Step >= s->transfers)
+		EspLink_Finish(EspLink_Active, 1);
+	EspLink_StartNext();
+}
+
+/**
+ * @brief  Aus HAL_UART_ErrorCallback(): abgebrochener Transfer verwirft den Rahmen, abgebrochener Empfang startet neu
+ */
+void EspLink_ErrorCallback(UART_HandleTypeDef *huart) {
+	if (huart != &huart7 || !EspLink_Initialised)
+		return;
+
+	if (EspLink_TxBusy && huart->gState == HAL_UART_STATE_READY) {
+		EspLink_TxBusy = 0;
+		EspLink_Statistics.txErrors++;
+		EspLink_Finish(EspLink_Active, 0);
+		EspLink_StartNext();
+	}
+	if (EspLink_RxRunning && huart->RxState == HAL_UART_STATE_READY) {
+		EspLink_Statistics.rxRestarts++;
+		EspLink_StartRx();
+	}
+}
+
+/**
+ * @brief  Aus HAL_UARTEx_RxEventCallback(): neue Bytes im Ring, Timer sofort wecken
+ * @param  size: DMA-Position im Puffer (bei vollem Puffer ESPLINK_RX_BUFFER_SIZE)
+ */
+void EspLink_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size) {
+	if (huart != &huart7 || !EspLink_RxRunning)
+		return;
+
+	uint16_t pos = size & ESPLINK_RX_MASK;
+	EspLink_Received += (uint16_t)(pos - EspLink_RxPos) & ESPLINK_RX_MASK;
+	EspLink_RxPos = pos;
+	if (Timer_Remaining(&EspLink_Timer) > 1)
+		Timer_Start(&EspLink_Timer, 1, EspLink_PeriodMs);
+}
+
+/**
+ * @brief  Timer-Callback: Empfang auswerten, Verbindung überwachen, Sendepuffer einreihen
+ */
+static void EspLink_Tick(void *context) {
+	uint32_t now = HAL_GetTick();
+	uint32_t period;
+
+	EspLink_Parse();
+
+	if (EspLink_Up && now - EspLink_LastRxMs >= ESPLINK_TIMEOUT_MS) {
+		EspLink_Statistics.timeouts++;
+		EspLink_Disconnect();
+	}
+
+	if (EspLink_Up) {
+		if (now - EspLink_LastPingMs >= ESPLINK_PING_MS) {
+			uint8_t ping[5] = { ESPLINK_CTRL_PING };
+			uint32_t stamp = Timebase_Us32();
+
+			memcpy(&ping[1], &stamp, sizeof(stamp));
+			EspLink_SendControl(ping, sizeof(ping));
+			EspLink_Statistics.pings++;
+			EspLink_LastPingMs = now;
+		}
+		if (EspLink_CommandCreditOwed && !Shell_IsSubmitPending()) {
+			uint8_t credit[3] = { ESPLINK_CTRL_CREDIT, ESPLINK_CH_COMMAND, 1 };
+
+			EspLink_SendControl(credit, sizeof(credit));
+			EspLink_CommandCreditOwed = 0;
+		}
+		EspLink_DrainPort(&EspLink_ReplyDrain);
+		EspLink_DrainPort(&EspLink_LogDrain);
+	} else if (EspLink_ReturnLog && EspLink_Active == ESPLINK_NO_CHANNEL) {
+		// Everything the link did not send goes out as plain UART bytes again
+		if (Serial_SetExternal(&Serial_Log, 0))
+			EspLink_ReturnLog = 0;
+	}
+
+	// A start refused by the HAL (UART busy) is retried from here
+	__disable_irq();
+	EspLink_StartNext();
+	__enable_irq();
+
+	period = EspLink_Up ? ESPLINK_TICK_MS : ESPLINK_IDLE_MS;
+	if (period != EspLink_PeriodMs) {
+		EspLink_PeriodMs = period;
+		Timer_Start(&EspLink_Timer, period, period);
+	}
+}
+
+/**
+ * @brief  Setzt den Ring zurück und startet die zirkuläre DMA-Übertragung
+ */
+static void EspLink_StartRx(void) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	// The DMA restarts at index 0: align the counters to a multiple of the ring and drop the rest
+	EspLink_Received = (EspLink_Received + ESPLINK_RX_MASK) & ~ESPLINK_RX_MASK;
+	EspLink_Parsed = EspLink_Received;
+	EspLink_RxPos = 0;
+	EspLink_RxFill = 0;
+	__set_PRIMASK(primask);
+
+	EspLink_RxRunning = HAL_UARTEx_ReceiveToIdle_DMA(&huart7, EspLink_RxBuffer, ESPLINK_RX_BUFFER_SIZE) == HAL_OK;
+}
+
+/**
+ * @brief  Sammelt die Bytes seit dem letzten Aufruf zu Rahmen und prüft Kopf und CRC
+ */
+static void EspLink_Parse(void) {
+	uint32_t received = EspLink_Received;
+
+	if (received - EspLink_Parsed > ESPLINK_RX_BUFFER_SIZE) {
+		EspLink_Statistics.rxOverruns++;
+		EspLink_Parsed = received - ESPLINK_RX_BUFFER_SIZE;
+		EspLink_RxFill = 0;
+	}
+	EspLink_Statistics.rxBytes += received - EspLink_Parsed;
+
+	while (EspLink_Parsed != received) {
+		uint8_t c = EspLink_RxBuffer[EspLink_Parsed++ & ESPLINK_RX_MASK];
+
+		if (EspLink_RxFill == 0 && c != ESPLINK_SYNC) {
+			EspLink_Statistics.rxSkipped++;
+			continue;
+		}
+		EspLink_RxFrame[EspLink_RxFill++] = c;
+
+		if (EspLink_RxFill == ESPLINK_HEADER_SIZE) {
+			uint16_t length = EspLink_RxFrame[5] | (EspLink_RxFrame[6] << 8);
+			if (EspLink_Crc8(EspLink_RxFrame, 7) != EspLink_RxFrame[7] || length > ESPLINK_MAX_RX_PAYLOAD
+					|| EspLink_RxFrame[1] >= ESPLINK_CHANNEL_COUNT) {
+				// Not a header: search for the next sync byte right after this one
+				EspLink_Statistics.rxHeaderErrors++;
+				EspLink_Statistics.rxSkipped++;
+				EspLink_Parsed -= ESPLINK_HEADER_SIZE - 1;
+				EspLink_RxFill = 0;
+				continue;
+			}
+			EspLink_RxNeed = ESPLINK_HEADER_SIZE + length + (length ? ESPLINK_CRC_SIZE : 0);
+		}
+
+		if (EspLink_RxFill >= ESPLINK_HEADER_SIZE && EspLink_RxFill == EspLink_RxNeed) {
+			uint16_t length = EspLink_RxFrame[5] | (EspLink_RxFrame[6] << 8);
+			uint32_t crc;
+
+			EspLink_RxFill = 0;
+			memcpy(&crc, &EspLink_RxFrame[ESPLINK_HEADER_SIZE + length], sizeof(crc));
+			if (length > 0 && Crc32_Compute(&EspLink_RxFrame[ESPLINK_HEADER_SIZE], length) != crc) {
+				EspLink_Statistics.rxCrcErrors++;
+				continue;
+			}
+			EspLink_LastRxMs = HAL_GetTick();
+			EspLink_Statistics.channel[EspLink_RxFrame[1]].rxFrames++;
+			EspLink_Dispatch(EspLink_RxFrame[1], &EspLink_RxFrame[ESPLINK_HEADER_SIZE], length,
+					EspLink_RxFrame[3] | (EspLink_RxFrame[4] << 8));
+		}
+	}
+}
+
+/**
+ * @brief  Verteilt einen geprüften Rahmen der Gegenstelle
+ */
+static void EspLink_Dispatch(uint8_t channel, const uint8_t *data, uint16_t length, uint16_t tag) {
+	if (channel == ESPLINK_CH_CONTROL) {
+		EspLink_Control(data, length);
+		return;
+	}
+	if (!EspLink_Up)
+		return;
+
+	if (channel == ESPLINK_CH_COMMAND) {
+		// The peer sends a line only with a credit granted after the previous one finished
+		if (Shell_Submit((const char*)data, length, &EspLink_Reply)) {
+			EspLink_Statistics.commands++;
+			EspLink_CommandCreditOwed = 1;
+		} else {
+			EspLink_Statistics.channel[channel].discarded++;
+		}
+	}
+}
+
+/**
+ * @brief  HELLO, CREDIT, PING und PONG der Gegenstelle
+ */
+static void EspLink_Control(const uint8_t *data, uint16_t length) {
+	uint32_t stamp;
+
+	if (length == 0)
+		return;
+
+	switch (data[0]) {
+	case ESPLINK_CTRL_HELLO:
+		if (length < 2 + ESPLINK_CHANNEL_COUNT - 1)
+			return;
+		// A HELLO while connected means the peer restarted: begin from zero
+		EspLink_Connect();
+		for (uint8_t c = 1; c < ESPLINK_CHANNEL_COUNT; c++) {
+			EspLink_Credits[c] = 0;
+			EspLink_AddCredits(c, data[1 + c]);
+		}
+		break;
+
+	case ESPLINK_CTRL_CREDIT:
+		if (length >= 3 && data[1] > ESPLINK_CH_CONTROL && data[1] < ESPLINK_CHANNEL_COUNT)
+			EspLink_AddCredits(data[1], data[2]);
+		break;
+
+	case ESPLINK_CTRL_PING:
+		if (length >= 5 && EspLink_Up) {
+			uint8_t pong[5] = { ESPLINK_CTRL_PONG };
+
+			memcpy(&pong[1], &data[1], 4);
+			EspLink_SendControl(pong, sizeof(pong));
+		}
+		break;
+
+	case ESPLINK_CTRL_PONG:
+		if (length >= 5) {
+			memcpy(&stamp, &data[1], sizeof(stamp));
+			uint32_t rtt = Timebase_Us32() - stamp;
+			EspLink_Statistics.pongs++;
+			EspLink_Statistics.lastRttUs = rtt;
+			if (rtt < EspLink_Statistics.minRttUs)
+				EspLink_Statistics.minRttUs = rtt;
+			if (rtt > EspLink_Statistics.maxRttUs)
+				EspLink_Statistics.maxRttUs = rtt;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief  (Neu) verbinden: UART7 von Serial_Log übernehmen, Folgenummern ab 0, eigenes HELLO senden
+ */
+static void EspLink_Connect(void) {
+	if (EspLink_Up)
+		EspLink_Disconnect();
+
+	// Serial_Log keeps filling its ring, the link sends it from there; an open USB log port owns it first
+	if (!EspLink_ReturnLog && (Serial_Log.external || !Serial_SetExternal(&Serial_Log, 1)))
+		return;
+	EspLink_ReturnLog = 0;
+
+	for (uint8_t c = 0; c < ESPLINK_CHANNEL_COUNT; c++)
+		EspLink_Queues[c].sequence = 0;
+	EspLink_Reply.tail = EspLink_Reply.head;    // nothing stale from before the connection
+	EspLink_CommandCreditOwed = 0;
+	EspLink_LastRxMs = HAL_GetTick();
+	EspLink_LastPingMs = EspLink_LastRxMs;
+	EspLink_Up = 1;
+	EspLink_Statistics.up = 1;
+	EspLink_Statistics.connects++;
+
+	EspLink_SendHello();
+	LOG("EspLink verbunden");
+}
+
+/**
+ * @brief  Version, Kredit für die Kanäle 1-4 (eine Befehlszeile) und Größe des Displays (für Mirror.c)
+ */
+static void EspLink_SendHello(void) {
+	uint8_t hello[2 + ESPLINK_CHANNEL_COUNT - 1 + 4] = { ESPLINK_CTRL_HELLO, ESPLINK_VERSION };
+	uint16_t width = ILI9341_WIDTH;
+	uint16_t height = ILI9341_HEIGHT;
+
+	hello[1 + ESPLINK_CH_COMMAND] = 1;
+	memcpy(&hello[1 + ESPLINK_CHANNEL_COUNT], &width, sizeof(width));
+	memcpy(&hello[3 + ESPLINK_CHANNEL_COUNT], &height, sizeof(height));
+	EspLink_SendControl(hello, sizeof(hello));
+}
+
+static void EspLink_SendControl(const uint8_t *data, uint32_t length) {
+	if (!EspLink_Send(ESPLINK_CH_CONTROL, data, length, 0, NULL, NULL))
+		EspLink_Statistics.channel[ESPLINK_CH_CONTROL].discarded++;
+}
+
+/**
+ * @brief  Kredit der Gegenstelle gutschreiben, ein wartender Kanal läuft sofort weiter
+ */
+static void EspLink_AddCredits(uint8_t channel, uint16_t count) {
+	EspLink_Queue *q = &EspLink_Queues[channel];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	uint32_t credits = EspLink_Credits[channel] + count;
+	EspLink_Credits[channel] = credits > UINT16_MAX ? UINT16_MAX : (uint16_t)credits;
+	if (q->stalled && count > 0) {
+		EspLink_Statistics.channel[channel].stallUs += Timebase_Us32() - q->stallStartUs;
+		q->stalled = 0;
+	}
+	EspLink_StartNext();
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Reiht den noch nicht eingereihten Inhalt eines Sendepuffers direkt aus dem Ring ein
+ */
+static void EspLink_DrainPort(EspLink_Drain *drain) {
+	Serial_Port *port = drain->port;
+	uint32_t mask = port->size - 1;
+
+	for (;;) {
+		// tail and queued move together in EspLink_Drained()
+		__disable_irq();
+		uint32_t start = port->tail + drain->queued;
+		uint32_t pending = port->head - start;
+		uint32_t offset = start & mask;
+		uint32_t length = port->size - offset;
+
+		if (length > pending)
+			length = pending;
+		if (length > ESPLINK_MAX_PAYLOAD)
+			length = ESPLINK_MAX_PAYLOAD;
+		drain->queued += length;
+		__enable_irq();
+
+		if (length == 0)
+			return;
+		if (!EspLink_Send(drain->channel, &port->buffer[offset], length, 0, EspLink_Drained, drain)) {
+			__disable_irq();
+			drain->queued -= length;
+			__enable_irq();
+			return;
+		}
+	}
+}
+
+/**
+ * @brief  Rahmen aus einem Sendepuffer ist fertig: gesendet rückt tail vor, verworfen bleibt er im Ring
+ */
+static void EspLink_Drained(const void *data, uint32_t length, uint8_t sent, void *context) {
+	EspLink_Drain *drain = context;
+
+	if (sent) {
+		drain->port->tail += length;
+		drain->port->sent += length;
+	}
+	drain->queued -= length;
+}
+
+/**
+ * @brief  Verwirft alle eingereihten Rahmen außer dem gerade gesendeten (Interrupts gesperrt)
+ */
+static void EspLink_Purge(void) {
+	for (uint8_t c = 0; c < ESPLINK_CHANNEL_COUNT; c++) {
+		EspLink_Queue *q = &EspLink_Queues[c];
+		uint32_t keep = (c == EspLink_Active) ? 1 : 0;
+
+		while (q->head - q->tail > keep) {
+			EspLink_Slot *s = &q->slot[(q->head - 1) % ESPLINK_QUEUE_DEPTH];
+			if (s->done != NULL)
+				s->done(s->data, s->length, 0, s->context);
+			EspLink_Statistics.channel[c].discarded++;
+			q->head--;
+		}
+		q->stalled = 0;
+	}
+}
+
+/**
+ * @brief  Startet den nächsten Transfer, falls die UART frei ist (Interrupts gesperrt)
+ */
+static void EspLink_StartNext(void) {
+	const uint8_t *data;
+	uint16_t length;
+
+	if (EspLink_TxBusy || EspLink_Suspended)
+		return;
+
+	if (EspLink_Active == ESPLINK_NO_CHANNEL) {
+		uint8_t channel = EspLink_Pick();
+		if (channel == ESPLINK_NO_CHANNEL)
+			return;
+		EspLink_Active = channel;
+		EspLink_Step = 0;
+	}
+
+	EspLink_Queue *q = &EspLink_Queues[EspLink_Active];
+	EspLink_Slot *s = &q->slot[q->tail % ESPLINK_QUEUE_DEPTH];
+	switch (EspLink_Step) {
+	case 0:
+		data = s->frame;
+		length = s->frameLength;
+		break;
+	case 1:
+		data = s->data;
+		length = (uint16_t)s->length;
+		break;
+	default:
+		data = &s->frame[ESPLINK_HEADER_SIZE];
+		length = ESPLINK_CRC_SIZE;
+		break;
+	}
+
+	EspLink_TxLength = length;
+	if (HAL_UART_Transmit_DMA(&huart7, (uint8_t*)data, length) == HAL_OK) {
+		EspLink_TxBusy = 1;
+		EspLink_Statistics.txDma++;
+	}
+}
+
+/**
+ * @brief  Nächster Kanal mit wartendem Rahmen: Kontrolle zuerst, sonst reihum mit Kredit
+ */
+static uint8_t EspLink_Pick(void) {
+	if (EspLink_Queues[ESPLINK_CH_CONTROL].head != EspLink_Queues[ESPLINK_CH_CONTROL].tail)
+		return ESPLINK_CH_CONTROL;
+
+	for (uint8_t i = 1; i < ESPLINK_CHANNEL_COUNT; i++) {
+		uint8_t c = (uint8_t)((EspLink_LastChannel + i - 1) % (ESPLINK_CHANNEL_COUNT - 1) + 1);
+		EspLink_Queue *q = &EspLink_Queues[c];
+
+		if (q->head == q->tail)
+			continue;
+		if (EspLink_Credits[c] == 0) {
+			if (!q->stalled) {
+				q->stalled = 1;
+				q->stallStartUs = Timebase_Us32();
+				EspLink_Statistics.channel[c].stalls++;
+			}
+			continue;
+		}
+		EspLink_Credits[c]--;
+		EspLink_LastChannel = c;
+		return c;
+	}
+	return ESPLINK_NO_CHANNEL;
+}
+
+/**
+ * @brief  Rahmen des aktiven Kanals abschließen: Zähler, Latenz, Callback an den Erzeuger
+ */
+static void EspLink_Finish(uint8_t channel, uint8_t sent) {
+	EspLink_Queue *q = &EspLink_Queues[channel];
+	EspLink_Slot *s = &q->slot[q->tail % ESPLINK_QUEUE_DEPTH];
+	EspLink_ChannelStats *st = &EspLink_Statistics.channel[channel];
+
+	if (sent) {
+		uint32_t latency = Timebase_Us32() - s->queuedUs;
+		st->frames++;
+		st->bytes += s->length;
+		st->lastLatencyUs = latency;
+		st->sumLatencyUs += latency;
+		if (latency > st->maxLatencyUs)
+			st->maxLatencyUs = latency;
+	} else {
+		st->discarded++;
+	}
+	if (s->done != NULL)
+		s->done(s->data, s->length, sent, s->context);
+
+	q->tail++;
+	EspLink_Active = ESPLINK_NO_CHANNEL;
+}
+
+/**
+ * @brief  CRC-8 über den Rahmenkopf, Polynom 0x07, Start 0
+ */
+static uint8_t EspLink_Crc8(const uint8_t *data, uint32_t length) {
+	uint8_t crc = 0;
+
+	while (length--) {
+		crc ^= *data++;
+		for (uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	}
+	return crc;
+}
+
+#endif /* ESPLINK_ENABLE */
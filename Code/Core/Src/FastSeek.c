@@ -0,0 +1,200 @@
+/**
+ * @file    FastSeek.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Cluster-Tabellen (Fast Seek) für Dateien, die nur gelesen werden
+ *
+ * Ohne Tabelle folgt f_lseek() der FAT-Kette vom ersten Cluster an: Ein Sprung an das Ende
+ * eines 4 MB großen Sprite-Sheets mit 32-KB-Clustern liest 128 FAT-Einträge, bei einem Video
+ * für jedes Bild von Neuem. Mit _USE_FASTSEEK kennt FatFs eine Tabelle der Fragmente
+ * (Länge und erster Cluster je zusammenhängendem Stück), mit der jeder Sprung ohne Zugriff
+ * auf die FAT auskommt. Sie aufzubauen kostet aber einmal die ganze Kette.
+ *
+ * Deshalb hält FastSeek.c FASTSEEK_SLOTS fertige Tabellen fest. Eine Datei erkennt es am
+ * Volume (mit Mount-ID) und am ersten Cluster, der auf einem Volume nur einer Datei gehören
+ * kann; Größe und Änderungszeit aus dem Verzeichniseintrag müssen ebenfalls passen, sonst
+ * wurde die Datei inzwischen neu geschrieben und die Tabelle wird neu aufgebaut. Ein Platz,
+ * den eine offene Datei benutzt, wird nicht verdrängt, sonst der am längsten unbenutzte.
+ *
+ * Dateien in einem Cluster und zu stark zerstückelte Dateien bleiben ohne Tabelle und werden
+ * wie bisher gelesen. Geschrieben werden darf eine Datei mit Tabelle nicht (FatFs verlängert
+ * sie dann nicht), darum nehmen FastSeek_Open() und FastSeek_Attach() nur FA_READ.
+ */
+
+#include "FastSeek.h"
+
+/* Änderungszeit im Verzeichniseintrag (FAT) bzw. im File-Eintrag des Eintragssatzes (exFAT) */
+#define FASTSEEK_DIR_MODTIME   22
+#define FASTSEEK_XDIR_MODTIME  12
+
+/**
+ * @brief Eine zwischengespeicherte Tabelle
+ */
+typedef struct {
+	FATFS *fs;                  // NULL: Platz frei
+	WORD id;                    // Mount-ID des Volumes beim Aufbau
+	DWORD sclust;               // erster Cluster der Datei
+	FSIZE_t size;
+	DWORD modTime;              // Datum und Uhrzeit der letzten Änderung
+	uint32_t lastUse;
+	uint8_t users;              // offene Dateien mit dieser Tabelle
+	uint8_t fragmented;         // Tabelle zu klein, merkt nur, dass die Kette nicht erneut abgelaufen werden muss
+	DWORD table[FASTSEEK_TABLE_WORDS];
+} FastSeek_Slot;
+
+static FastSeek_Slot FastSeek_Slots[FASTSEEK_SLOTS];
+static uint32_t FastSeek_Clock;
+static FastSeek_Stats FastSeek_Statistics;
+
+static DWORD FastSeek_ModTime(const FIL *fp);
+static FastSeek_Slot* FastSeek_SlotOf(const FIL *fp);
+
+/**
+ * @brief  Öffnet eine Datei zum Lesen und hängt eine Cluster-Tabelle an.
+ * @param  fp   Dateiobjekt, mit FastSeek_Close() schließen
+ * @param  path Pfad wie bei f_open()
+ * @retval Ergebnis von f_open(); ohne Tabelle ist die Datei trotzdem offen
+ */
+FRESULT FastSeek_Open(FIL *fp, const TCHAR *path) {
+	FRESULT res = f_open(fp, path, FA_READ);
+	if (res == FR_OK) {
+		FastSeek_Attach(fp);
+	}
+	return res;
+}
+
+/**
+ * @brief  Hängt einer gerade mit FA_READ geöffneten Datei eine Tabelle an (aus dem Cache oder neu).
+ *
+ * Muss direkt nach f_open() laufen: Die Änderungszeit wird aus dem Verzeichniseintrag im
+ * Fensterpuffer des Volumes gelesen, den der nächste Zugriff überschreibt.
+ *
+ * @retval 1 wenn fp->cltbl gesetzt ist, 0 wenn die Datei ohne Tabelle gelesen wird
+ */
+uint8_t FastSeek_Attach(FIL *fp) {
+	FATFS *fs = fp->obj.fs;
+	if (fs == NULL || (fp->flag & FA_WRITE) || fp->cltbl != NULL) {
+		return 0;
+	}
+
+#if _MAX_SS == _MIN_SS
+	FSIZE_t clusterBytes = (FSIZE_t)fs->csize * _MIN_SS;
+#else
+	FSIZE_t clusterBytes = (FSIZE_t)fs->csize * fs->ssize;
+#endif
+	if (fp->obj.sclust == 0 || fp->obj.objsize <= clusterBytes) {
+		FastSeek_Statistics.small++;
+		return 0;
+	}
+
+	DWORD modTime = FastSeek_ModTime(fp);
+	FastSeek_Slot *victim = NULL;
+	FastSeek_Clock++;
+
+	for (uint8_t i = 0; i < FASTSEEK_SLOTS; i++) {
+		FastSeek_Slot *slot = &FastSeek_Slots[i];
+		if (slot->fs == fs && slot->id == fs->id && slot->sclust == fp->obj.sclust) {
+			if (slot->size == fp->obj.objsize && slot->modTime == modTime) {
+				slot->lastUse = FastSeek_Clock;
+				if (slot->fragmented) {
+					FastSeek_Statistics.fragmented++;
+					return 0;
+				}
+				slot->users++;
+				fp->cltbl = slot->table;
+				FastSeek_Statistics.hits++;
+				return 1;
+			}
+			if (slot->users == 0) {
+				// The file was rewritten in place, its table is stale
+				slot->fs = NULL;
+			}
+		}
+		if (slot->users == 0 && (victim == NULL || (victim->fs != NULL
+		    && (slot->fs == NULL || slot->lastUse < victim->lastUse)))) {
+			victim = slot;
+		}
+	}
+
+	if (victim == NULL) {
+		FastSeek_Statistics.busy++;
+		return 0;
+	}
+
+	victim->fs = NULL;
+	victim->table[0] = FASTSEEK_TABLE_WORDS;
+	fp->cltbl = victim->table;
+	FRESULT res = f_lseek(fp, CREATE_LINKMAP);
+	if (res != FR_OK) {
+		// FR_NOT_ENOUGH_CORE leaves the file intact, other errors are kept in fp->err anyway
+		fp->cltbl = NULL;
+		if (res != FR_NOT_ENOUGH_CORE) {
+			return 0;
+		}
+		FastSeek_Statistics.fragmented++;
+	} else {
+		FastSeek_Statistics.builds++;
+	}
+
+	victim->fs = fs;
+	victim->id = fs->id;
+	victim->sclust = fp->obj.sclust;
+	victim->size = fp->obj.objsize;
+	victim->modTime = modTime;
+	victim->lastUse = FastSeek_Clock;
+	victim->fragmented = res != FR_OK;
+	victim->users = victim->fragmented ? 0 : 1;
+	return !victim->fragmented;
+}
+
+/**
+ * @brief  Löst die Tabelle von der Datei, sie bleibt für das nächste Öffnen im Cache.
+ */
+void FastSeek_Detach(FIL *fp) {
+	FastSeek_Slot *slot = FastSeek_SlotOf(fp);
+	if (slot != NULL && slot->users > 0) {
+		slot->users--;
+	}
+	fp->cltbl = NULL;
+}
+
+/**
+ * @brief  Schließt eine mit FastSeek_Open() geöffnete Datei.
+ * @retval Ergebnis von f_close()
+ */
+FRESULT FastSeek_Close(FIL *fp) {
+	FastSeek_Detach(fp);
+	return f_close(fp);
+}
+
+/**
+ * @brief  Liefert die Zähler
+ */
+const FastSeek_Stats* FastSeek_GetStats(void) {
+	return &FastSeek_Statistics;
+}
+
+/**
+ * @brief  Liest Datum und Uhrzeit der letzten Änderung aus dem Eintrag, den f_open() geladen hat.
+ */
+static DWORD FastSeek_ModTime(const FIL *fp) {
+	const BYTE *p = fp->dir_ptr + FASTSEEK_DIR_MODTIME;
+#if _FS_EXFAT
+	if (fp->obj.fs->fs_type == FS_EXFAT) {
+		p = fp->obj.fs->dirbuf + FASTSEEK_XDIR_MODTIME;
+	}
+#endif
+	return (DWORD)p[0] | (DWORD)p[1] << 8 | (DWORD)p[2] << 16 | (DWORD)p[3] << 24;
+}
+
+/**
+ * @brief  Platz, dessen Tabelle an fp hängt, sonst NULL
+ */
+static FastSeek_Slot* FastSeek_SlotOf(const FIL *fp) {
+	for (uint8_t i = 0; i < FASTSEEK_SLOTS; i++) {
+		if (fp->cltbl == FastSeek_Slots[i].table) {
+			return &FastSeek_Slots[i];
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file    FixMath.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Trigonometrie und Wurzel in Q31 ohne libm und ohne FPU, per Software-CORDIC
+ *
+ * Der STM32H7B0 hat keine CORDIC-Einheit (nur H72x/H73x). Die Funktionen rechnen deshalb den
+ * CORDIC-Algorithmus selbst, mit derselben Darstellung wie die Einheit: Werte in Q31, Winkel in
+ * Q31 als Vielfaches von pi. Jede Iteration ist eine Addition mit Schiebung, FIXMATH_ITERATIONS
+ * Schritte ergeben etwa ebenso viele Bits (Fehler bei 30 Schritten unter 2^-28).
+ *
+ * - Rotation (FixMath_SinCos): der Vektor (K, 0) wird schrittweise um +-atan(2^-i) gedreht,
+ *   bis der Restwinkel 0 ist; K gleicht die Verstärkung der Schritte aus.
+ * - Vektorisierung (FixMath_Atan2): (x, y) wird auf die x-Achse gedreht, die Summe der
+ *   Drehungen ist der Winkel.
+ * - Wurzel: bitweise ganzzahlig (ein Vergleich und eine Subtraktion je Ergebnisbit).
+ *
+ * Zeiger- und Bogenwidgets rechnen damit Endpunkte ohne float, die Effekte der WS2812 ihre
+ * Helligkeitskurven aus der Phase.
+ */
+
+#include "FixMath.h"
+
+/* 1/K im Format Q30: Produkt der 1/sqrt(1 + 2^-2i) */
+#define FIXMATH_CORDIC_GAIN_INV   652032874L
+
+#if FIXMATH_ITERATIONS > 30
+#error "FIXMATH_ITERATIONS darf höchstens 30 sein!"
+#endif
+
+/* atan(2^-i) als Q31-Winkel (Vielfaches von pi) */
+static const int32_t FixMath_AtanTable[30] = {
+	0x20000000, 0x12E4051E, 0x09FB385B, 0x051111D4,
+	0x028B0D43, 0x0145D7E1, 0x00A2F61E, 0x00517C55,
+	0x0028BE53, 0x00145F2F, 0x000A2F98, 0x000517CC,
+	0x00028BE6, 0x000145F3, 0x0000A2FA, 0x0000517D,
+	0x000028BE, 0x0000145F, 0x00000A30, 0x00000518,
+	0x0000028C, 0x00000146, 0x000000A3, 0x00000051,
+	0x00000029, 0x00000014, 0x0000000A, 0x00000005,
+	0x00000003, 0x00000001,
+};
+
+static int32_t FixMath_Q30ToQ31(int32_t value);
+static uint32_t FixMath_ISqrt64(uint64_t value);
+
+/**
+ * @brief  Wandelt ganze Grad in einen Q31-Winkel um, beliebig viele Umdrehungen
+ */
+int32_t FixMath_Degrees(int32_t degrees) {
+	return (int32_t)(uint32_t)(((int64_t)(degrees % 360) * 4294967296LL) / 360);
+}
+
+/**
+ * @brief  Sinus und Kosinus eines Winkels in einer Rechnung
+ * @param  angle: Q31-Winkel, -2^31 = -pi
+ * @param  sine, cosine: Ergebnisse in Q31, dürfen NULL sein
+ */
+void FixMath_SinCos(int32_t angle, int32_t *sine, int32_t *cosine) {
+	int32_t x = FIXMATH_CORDIC_GAIN_INV, y = 0;
+	int32_t z = angle;
+	uint8_t flip = 0;
+
+	// CORDIC converges up to about 99 degrees: rotate the outer half by pi and negate
+	if (z > FIXMATH_PI_HALF || z < -FIXMATH_PI_HALF) {
+		z = (int32_t)((uint32_t)z + 0x80000000UL);
+		flip = 1;
+	}
+
+	for (uint32_t i = 0; i < FIXMATH_ITERATIONS; i++) {
+		int32_t dx = y >> i, dy = x >> i;
+		if (z >= 0) {
+			x -= dx;
+			y += dy;
+			z -= FixMath_AtanTable[i];
+		} else {
+			x += dx;
+			y -= dy;
+			z += FixMath_AtanTable[i];
+		}
+	}
+
+	if (flip) {
+		x = -x;
+		y = -y;
+	}
+	if (sine != NULL) *sine = FixMath_Q30ToQ31(y);
+	if (cosine != NULL) *cosine = FixMath_Q30ToQ31(x);
+}
+
+int32_t FixMath_Sin(int32_t angle) {
+	int32_t sine;
+	FixMath_SinCos(angle, &sine, NULL);
+	return sine;
+}
+
+int32_t FixMath_Cos(int32_t angle) {
+	int32_t cosine;
+	FixMath_SinCos(angle, NULL, &cosine);
+	return cosine;
+}
+
+/**
+ * @brief  Winkel des Vektors (x, y), wie atan2f(y, x)
+ * @param  y, x: beliebige Einheit (Q31 oder ganze Pixel), nur das Verhältnis zählt
+ * @retval Q31-Winkel von -pi bis pi, 0 für (0, 0)
+ */
+int32_t FixMath_Atan2(int32_t y, int32_t x) {
+	uint32_t ax = x < 0 ? 0U - (uint32_t)x : (uint32_t)x;
+	uint32_t ay = y < 0 ? 0U - (uint32_t)y : (uint32_t)y;
+	uint32_t largest = ax | ay;
+	int32_t z = 0;
+
+	if (largest == 0) {
+		return 0;
+	}
+
+	// Normalise to bit 28: room for the gain (1.65) times sqrt(2), small pixel offsets keep their precision
+	int32_t shift = (int32_t)__CLZ(largest) - 3;
+	int64_t vx = x, vy = y;
+	if (shift >= 0) {
+		vx *= (1LL << shift);
+		vy *= (1LL << shift);
+	} else {
+		vx /= (1LL << -shift);
+		vy /= (1LL << -shift);
+	}
+	int32_t px = (int32_t)vx, py = (int32_t)vy;
+
+	// Left half plane: turn by pi, the angle wraps around in uint32_t
+	if (px < 0) {
+		px = -px;
+		py = -py;
+		z = INT32_MIN;
+	}
+
+	for (uint32_t i = 0; i < FIXMATH_ITERATIONS; i++) {
+		int32_t dx = py >> i, dy = px >> i;
+		if (py > 0) {
+			px += dx;
+			py -= dy;
+			z = (int32_t)((uint32_t)z + (uint32_t)FixMath_AtanTable[i]);
+		} else {
+			px -= dx;
+			py += dy;
+			z = (int32_t)((uint32_t)z - (uint32_t)FixMath_AtanTable[i]);
+		}
+	}
+	return z;
+}
+
+/**
+ * @brief  Quadratwurzel in Q31
+ * @param  value: 0 bis 1 in Q31, negative Werte ergeben 0
+ */
+int32_t FixMath_Sqrt(int32_t value) {
+	if (value <= 0) {
+		return 0;
+	}
+	uint32_t root = FixMath_ISqrt64((uint64_t)value << 31);
+	return root > FIXMATH_Q31_MAX ? FIXMATH_Q31_MAX : (int32_t)root;
+}
+
+/**
+ * @brief  Ganzzahlige Quadratwurzel, abgerundet, z.B. für Radien und Abstände in Pixeln
+ */
+uint32_t FixMath_ISqrt(uint32_t value) {
+	return FixMath_ISqrt64(value);
+}
+
+/**
+ * @brief  Sinus und Kosinus für eine Reihe von Winkeln, z.B. alle Teilstriche einer Skala
+ * @param  sine, cosine: je count Ergebnisse, dürfen NULL sein
+ */
+void FixMath_SinCosBatch(const int32_t *angles, int32_t *sine, int32_t *cosine, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++) {
+		FixMath_SinCos(angles[i], sine != NULL ? &sine[i] : NULL, cosine != NULL ? &cosine[i] : NULL);
+	}
+}
+
+/**
+ * @brief  Q30 nach Q31 mit Sättigung bei +-1,0
+ */
+static int32_t FixMath_Q30ToQ31(int32_t value) {
+	if (value >= 0x40000000L) return FIXMATH_Q31_MAX;
+	if (value <= -0x40000000L) return INT32_MIN;
+	return value * 2;
+}
+
+/**
+ * @brief  Bitweise Quadratwurzel, höchstens 32 Schritte
+ */
+static uint32_t FixMath_ISqrt64(uint64_t value) {
+	uint64_t root = 0;
+	uint64_t bit = 1ULL << 62;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
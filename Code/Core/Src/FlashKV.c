@@ -0,0 +1,659 @@
+/**
+ * @file    FlashKV.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Log-strukturierter Schlüssel/Wert-Speicher mit Wear-Levelling im W25Qxx-Flash
+ *
+ * Kalibrierwerte und Einstellungen werden nicht an Ort und Stelle überschrieben, sondern
+ * als neuer Eintrag an das Ende eines Logs angehängt. Jeder Eintrag belegt genau eine
+ * 256-Byte-Seite; eine Änderung kostet damit ein Page Program (< 1 ms) statt eines
+ * Sektor-Löschens (45 ms). Der neueste Eintrag eines Schlüssels gilt, ältere sind Müll.
+ *
+ * Aufbau: FLASHKV_SECTOR_COUNT Sektoren à 4 KB, die als Ring benutzt werden. Seite 0 eines
+ * Sektors trägt Magic und eine fortlaufende Sequenznummer, die Seiten 1-15 die Einträge
+ * (Kopf, Schlüssel, Wert, CRC-16). Ein gelöschter Sektor (nur 0xFF) ist frei.
+ *
+ * Beim Start werden die Sektoren in Sequenzreihenfolge gelesen und ein Hash-Index im RAM
+ * aufgebaut (Schlüssel-Hash -> Flash-Adresse des neuesten Eintrags). Lesen kostet danach
+ * einen einzigen 256-Byte-Lesezugriff.
+ *
+ * Die Garbage Collection läuft schrittweise in FlashKV_Process(): Sie nimmt den ältesten
+ * Sektor, kopiert dessen noch gültige Einträge an das Log-Ende und übergibt ihn dann dem
+ * Löschpool (FlashPool_Discard()). Der Pool löscht ihn im Hintergrund in kurzen Abschnitten
+ * mit Erase Suspend dazwischen; sobald er fertig ist, zählt der Sektor wieder als frei. Freie
+ * Sektoren sind damit immer schon gelöscht, ein FlashKV_Set() bleibt ein Page Program. Weil
+ * immer der älteste Sektor recycelt wird, nutzen sich alle Sektoren gleichmäßig ab; lange
+ * unveränderte Einträge wandern dabei mit.
+ *
+ * Alle Funktionen laufen in der Hauptschleife, nicht im Interrupt. FlashKV_Process() läuft
+ * im Task des Löschpools, der sich über FlashPool_Wake() einschaltet, sobald die
+ * Garbage Collection etwas zu tun hat.
+ */
+
+#include "FlashKV.h"
+#include "Cache.h"
+#include "W25Qxx_QSPI.h"
+#include "FlashPool.h"
+#include <string.h>
+
+#define FLASHKV_PAGE_SIZE         256
+#define FLASHKV_SECTOR_SIZE       4096
+#define FLASHKV_PAGES_PER_SECTOR  (FLASHKV_SECTOR_SIZE / FLASHKV_PAGE_SIZE)
+
+#define FLASHKV_SECTOR_MAGIC      0x53564B46UL	// "FKVS"
+#define FLASHKV_RECORD_MAGIC      0x4B56		// "VK"
+#define FLASHKV_FLAG_DELETED      0x01
+
+#define FLASHKV_SEQ_FREE          0xFFFFFFFFUL
+#define FLASHKV_SLOT_EMPTY        0xFFFFFFFFUL
+#define FLASHKV_SLOT_DELETED      0xFFFFFFFEUL
+#define FLASHKV_SECTOR_NONE       0xFF
+
+/* Einträge, die auch bei vollständig belegtem Log noch Platz finden */
+#define FLASHKV_CAPACITY          ((FLASHKV_SECTOR_COUNT - FLASHKV_GC_MIN_FREE) * (FLASHKV_PAGES_PER_SECTOR - 1))
+
+/* Ergebnis von FlashKV_ReadRecord */
+#define FLASHKV_PAGE_FREE         0
+#define FLASHKV_PAGE_VALID        1
+#define FLASHKV_PAGE_INVALID      2
+
+/**
+ * @brief Kopf eines Eintrags am Anfang seiner Seite, danach folgen Schlüssel und Wert
+ */
+typedef struct {
+	uint16_t magic;        // FLASHKV_RECORD_MAGIC
+	uint8_t keyLength;
+	uint8_t flags;         // FLASHKV_FLAG_DELETED = Löschmarke ohne Wert
+	uint16_t valueLength;
+	uint16_t crc;          // CRC-16 über keyLength, flags, valueLength, Schlüssel und Wert
+} FlashKV_Record;
+
+/**
+ * @brief Kopf eines Sektors in Seite 0
+ */
+typedef struct {
+	uint32_t magic;        // FLASHKV_SECTOR_MAGIC
+	uint32_t sequence;     // Fortlaufende Nummer, der höchste Wert ist das Log-Ende
+} FlashKV_SectorHeader;
+
+/**
+ * @brief Platz im Hash-Index
+ */
+typedef struct {
+	uint32_t hash;
+	uint32_t address;      // Flash-Adresse des neuesten Eintrags oder FLASHKV_SLOT_EMPTY/DELETED
+} FlashKV_Slot;
+
+typedef enum {
+	FLASHKV_GC_IDLE,
+	FLASHKV_GC_COPY,       // Gültige Einträge des Opfersektors umkopieren
+	FLASHKV_GC_ERASE       // Opfersektor wartet im Löschpool
+} FlashKV_GCState;
+
+FlashKV_Stats FlashKV_Statistics = {0};
+
+FlashKV_Slot FlashKV_Index[FLASHKV_INDEX_SIZE];
+uint32_t FlashKV_SectorSeq[FLASHKV_SECTOR_COUNT];	// FLASHKV_SEQ_FREE = frei
+uint32_t FlashKV_NextSeq = 0;
+uint8_t FlashKV_FreeSectors = 0;
+uint8_t FlashKV_Head = FLASHKV_SECTOR_NONE;			// Sektor am Log-Ende
+uint8_t FlashKV_HeadPage = FLASHKV_PAGES_PER_SECTOR;	// Nächste freie Seite darin
+uint8_t FlashKV_Ready = 0;
+
+FlashKV_GCState FlashKV_GC = FLASHKV_GC_IDLE;
+uint8_t FlashKV_GCSector = 0;
+uint8_t FlashKV_GCPage = 0;
+
+uint8_t FlashKV_Page[FLASHKV_PAGE_SIZE] AXI_BUFFER;
+
+static uint32_t FlashKV_Hash(const char *key, uint8_t length);
+static uint16_t FlashKV_Crc(uint16_t crc, const uint8_t *data, uint32_t length);
+static uint32_t FlashKV_SectorAddress(uint8_t sector);
+static uint8_t FlashKV_ReadRecord(uint32_t address);
+static int32_t FlashKV_Find(const char *key, uint8_t keyLength, uint32_t hash, int32_t *freeSlot);
+static void FlashKV_IndexPut(const char *key, uint8_t keyLength, uint32_t hash, uint32_t address);
+static uint8_t FlashKV_Reserve(uint8_t forGC);
+static uint32_t FlashKV_Program(uint32_t length);
+static uint8_t FlashKV_OpenSector(void);
+static uint8_t FlashKV_StartCollect(void);
+static void FlashKV_CollectStep(uint8_t pages);
+static void FlashKV_CompleteErase(void);
+static uint8_t FlashKV_Collect(void);
+static uint8_t FlashKV_Append(const char *key, uint8_t keyLength, const void *value, uint16_t length, uint8_t flags);
+
+/**
+ * @brief  Baut den Index aus dem Flash auf.
+ *
+ * Liest die Köpfe aller Sektoren, sortiert die gültigen nach Sequenznummer und trägt jeden
+ * Eintrag in dieser Reihenfolge in den Index ein, sodass der neueste gewinnt. Seiten mit
+ * fehlerhafter CRC (z.B. Stromausfall beim Programmieren) werden übersprungen.
+ *
+ * @return 1, wenn der Speicher benutzbar ist
+ * @note   W25Qxx_begin() muss vorher aufgerufen worden sein.
+ */
+uint8_t FlashKV_Init(void)
+{
+	uint8_t order[FLASHKV_SECTOR_COUNT];
+	uint8_t valid = 0;
+
+	memset(&FlashKV_Statistics, 0, sizeof(FlashKV_Statistics));
+	for (uint32_t i = 0; i < FLASHKV_INDEX_SIZE; i++) {
+		FlashKV_Index[i].address = FLASHKV_SLOT_EMPTY;
+	}
+
+	FlashKV_NextSeq = 0;
+	FlashKV_FreeSectors = 0;
+	FlashKV_Head = FLASHKV_SECTOR_NONE;
+	FlashKV_HeadPage = FLASHKV_PAGES_PER_SECTOR;
+	FlashKV_GC = FLASHKV_GC_IDLE;
+
+	for (uint8_t s = 0; s < FLASHKV_SECTOR_COUNT; s++) {
+		FlashKV_SectorHeader header;
+		W25Qxx_FastReadQuadOutput(FlashKV_SectorAddress(s), (uint8_t*)&header, sizeof(header));
+
+		if (header.magic != FLASHKV_SECTOR_MAGIC || header.sequence == FLASHKV_SEQ_FREE) {
+			FlashKV_SectorSeq[s] = FLASHKV_SEQ_FREE;
+			FlashKV_FreeSectors++;
+			continue;
+		}
+
+		// Insertion sort by sequence number
+		FlashKV_SectorSeq[s] = header.sequence;
+		uint8_t pos = valid++;
+		while (pos > 0 && FlashKV_SectorSeq[order[pos - 1]] > header.sequence) {
+			order[pos] = order[pos - 1];
+			pos--;
+		}
+		order[pos] = s;
+
+		if (header.sequence >= FlashKV_NextSeq) FlashKV_NextSeq = header.sequence + 1;
+	}
+
+	for (uint8_t i = 0; i < valid; i++) {
+		uint8_t s = order[i];
+		uint8_t page;
+
+		for (page = 1; page < FLASHKV_PAGES_PER_SECTOR; page++) {
+			uint32_t address = FlashKV_SectorAddress(s) + page * FLASHKV_PAGE_SIZE;
+			uint8_t result = FlashKV_ReadRecord(address);
+
+			if (result == FLASHKV_PAGE_FREE) break;		// Pages are programmed in order
+			if (result != FLASHKV_PAGE_VALID) continue;
+
+			FlashKV_Record *record = (FlashKV_Record*)FlashKV_Page;
+			char key[FLASHKV_MAX_KEY];
+			uint8_t keyLength = record->keyLength;
+			memcpy(key, &FlashKV_Page[sizeof(FlashKV_Record)], keyLength);
+
+			FlashKV_IndexPut(key, keyLength, FlashKV_Hash(key, keyLength), address);
+		}
+
+		FlashKV_Head = s;
+		FlashKV_HeadPage = page;
+	}
+
+	FlashKV_Ready = 1;
+	if (FlashKV_FreeSectors <= FLASHKV_GC_MIN_FREE) FlashPool_Wake();
+	return 1;
+}
+
+/**
+ * @brief  Speichert einen Wert unter einem Schlüssel.
+ *
+ * Ist der Wert unverändert, wird nichts geschrieben. Sonst wird ein neuer Eintrag an das
+ * Log-Ende angehängt (ein Page Program). Nur wenn kein freier Sektor mehr übrig ist, räumt
+ * die Funktion selbst blockierend einen Sektor auf.
+ *
+ * @param  key    Nullterminierter Schlüssel, 1 bis FLASHKV_MAX_KEY Zeichen
+ * @param  value  Daten
+ * @param  length Länge in Bytes; Schlüssel und Wert zusammen höchstens 248 Bytes
+ * @return 1 bei Erfolg, 0 bei ungültigen Parametern oder vollem Speicher
+ */
+uint8_t FlashKV_Set(const char *key, const void *value, uint16_t length)
+{
+	if (!FlashKV_Ready || key == NULL) return 0;
+	if (length > 0 && value == NULL) return 0;
+
+	uint32_t keyLength = strlen(key);
+	if (keyLength == 0 || keyLength > FLASHKV_MAX_KEY) return 0;
+	if (sizeof(FlashKV_Record) + keyLength + length > FLASHKV_PAGE_SIZE) return 0;
+
+	uint32_t hash = FlashKV_Hash(key, keyLength);
+	int32_t freeSlot;
+	int32_t slot = FlashKV_Find(key, keyLength, hash, &freeSlot);
+
+	if (slot >= 0) {
+		// FlashKV_Find left the current record in FlashKV_Page
+		FlashKV_Record *record = (FlashKV_Record*)FlashKV_Page;
+		if (!(record->flags & FLASHKV_FLAG_DELETED) && record->valueLength == length &&
+			memcmp(&FlashKV_Page[sizeof(FlashKV_Record) + keyLength], value, length) == 0) {
+			FlashKV_Statistics.unchanged++;
+			return 1;
+		}
+	} else if (FlashKV_Statistics.entries >= FLASHKV_CAPACITY) {
+		return 0;
+	}
+
+	return FlashKV_Append(key, keyLength, value, length, 0);
+}
+
+/**
+ * @brief  Liest den Wert eines Schlüssels.
+ *
+ * @param  key       Nullterminierter Schlüssel
+ * @param  value     Zielpuffer
+ * @param  maxLength Größe des Zielpuffers; längere Werte werden abgeschnitten
+ * @return Länge des gespeicherten Werts oder -1, wenn der Schlüssel nicht existiert
+ */
+int32_t FlashKV_Get(const char *key, void *value, uint16_t maxLength)
+{
+	if (!FlashKV_Ready || key == NULL) return -1;
+
+	uint32_t keyLength = strlen(key);
+	if (keyLength == 0 || keyLength > FLASHKV_MAX_KEY) return -1;
+
+	int32_t freeSlot;
+	if (FlashKV_Find(key, keyLength, FlashKV_Hash(key, keyLength), &freeSlot) < 0) return -1;
+
+	FlashKV_Record *record = (FlashKV_Record*)FlashKV_Page;
+	if (record->flags & FLASHKV_FLAG_DELETED) return -1;
+
+	uint16_t copy = (record->valueLength < maxLength) ? record->valueLength : maxLength;
+	if (value != NULL && copy > 0) {
+		memcpy(value, &FlashKV_Page[sizeof(FlashKV_Record) + keyLength], copy);
+	}
+	return record->valueLength;
+}
+
+/**
+ * @brief  Entfernt einen Schlüssel.
+ *
+ * Schreibt eine Löschmarke; die Garbage Collection verwirft sie zusammen mit den alten
+ * Einträgen, sobald ihr Sektor recycelt wird.
+ *
+ * @return 1 bei Erfolg oder wenn der Schlüssel nicht existiert, 0 bei einem Fehler
+ */
+uint8_t FlashKV_Delete(const char *key)
+{
+	if (!FlashKV_Ready || key == NULL) return 0;
+
+	uint32_t keyLength = strlen(key);
+	if (keyLength == 0 || keyLength > FLASHKV_MAX_KEY) return 0;
+
+	int32_t freeSlot;
+	if (FlashKV_Find(key, keyLength, FlashKV_Hash(key, keyLength), &freeSlot) < 0) return 1;
+	if (((FlashKV_Record*)FlashKV_Page)->flags & FLASHKV_FLAG_DELETED) return 1;
+
+	return FlashKV_Append(key, keyLength, NULL, 0, FLASHKV_FLAG_DELETED);
+}
+
+/**
+ * @brief  Führt die Garbage Collection schrittweise aus; im Task des Löschpools aufrufen.
+ *
+ * Bearbeitet höchstens FLASHKV_GC_PAGES_PER_STEP Seiten des Opfersektors oder fragt ab, ob
+ * der Pool ihn fertig gelöscht hat. Solange die Garbage Collection läuft, hält die Funktion
+ * den Task mit FlashPool_Wake() eingeschaltet.
+ */
+void FlashKV_Process(void)
+{
+	if (!FlashKV_Ready) return;
+
+	if (FlashKV_GC == FLASHKV_GC_IDLE) {
+		if (FlashKV_FreeSectors > FLASHKV_GC_MIN_FREE || !FlashKV_StartCollect()) return;
+	}
+
+	FlashKV_CollectStep(FLASHKV_GC_PAGES_PER_STEP);
+	if (FlashKV_GC != FLASHKV_GC_IDLE) FlashPool_Wake();
+}
+
+/**
+ * @brief FNV-1a über den Schlüssel.
+ */
+static uint32_t FlashKV_Hash(const char *key, uint8_t length)
+{
+	uint32_t hash = 2166136261UL;
+	for (uint8_t i = 0; i < length; i++) {
+		hash ^= (uint8_t)key[i];
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+/**
+ * @brief CRC-16/CCITT (Polynom 0x1021), fortgesetzt ab crc (Startwert 0xFFFF).
+ */
+static uint16_t FlashKV_Crc(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+	while (length--) {
+		crc ^= (uint16_t)(*data++) << 8;
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static uint32_t FlashKV_SectorAddress(uint8_t sector)
+{
+	return FLASHKV_BASE_ADDRESS + (uint32_t)sector * FLASHKV_SECTOR_SIZE;
+}
+
+/**
+ * @brief  Liest die Seite an address nach FlashKV_Page und prüft den Eintrag.
+ * @return FLASHKV_PAGE_FREE, FLASHKV_PAGE_VALID oder FLASHKV_PAGE_INVALID
+ */
+static uint8_t FlashKV_ReadRecord(uint32_t address)
+{
+	W25Qxx_FastReadQuadOutput(address, FlashKV_Page, FLASHKV_PAGE_SIZE);
+
+	FlashKV_Record *record = (FlashKV_Record*)FlashKV_Page;
+	if (record->magic == 0xFFFF) return FLASHKV_PAGE_FREE;
+	if (record->magic != FLASHKV_RECORD_MAGIC) return FLASHKV_PAGE_INVALID;
+	if (record->keyLength == 0 || record->keyLength > FLASHKV_MAX_KEY) return FLASHKV_PAGE_INVALID;
+
+	uint32_t length = sizeof(FlashKV_Record) + record->keyLength + record->valueLength;
+	if (length > FLASHKV_PAGE_SIZE) return FLASHKV_PAGE_INVALID;
+
+	uint16_t crc = FlashKV_Crc(0xFFFF, &FlashKV_Page[2], 4);
+	crc = FlashKV_Crc(crc, &FlashKV_Page[sizeof(FlashKV_Record)], length - sizeof(FlashKV_Record));
+	return (crc == record->crc) ? FLASHKV_PAGE_VALID : FLASHKV_PAGE_INVALID;
+}
+
+/**
+ * @brief  Sucht einen Schlüssel im Index (lineares Sondieren).
+ *
+ * Bei gleichem Hash wird der Schlüssel im Flash verglichen; nach einem Treffer steht dessen
+ * Eintrag in FlashKV_Page.
+ *
+ * @param  freeSlot Erhält den ersten freien oder gelöschten Platz der Sondierfolge (-1, wenn keiner)
+ * @return Platz des Schlüssels oder -1
+ */
+static int32_t FlashKV_Find(const char *key, uint8_t keyLength, uint32_t hash, int32_t *freeSlot)
+{
+	*freeSlot = -1;
+
+	for (uint32_t n = 0; n < FLASHKV_INDEX_SIZE; n++) {
+		uint32_t i = (hash + n) & (FLASHKV_INDEX_SIZE - 1);
+		FlashKV_Slot *slot = &FlashKV_Index[i];
+
+		if (slot->address == FLASHKV_SLOT_EMPTY) {
+			if (*freeSlot < 0) *freeSlot = i;
+			return -1;
+		}
+		if (slot->address == FLASHKV_SLOT_DELETED) {
+			if (*freeSlot < 0) *freeSlot = i;
+			continue;
+		}
+		if (slot->hash != hash) continue;
+
+		if (FlashKV_ReadRecord(slot->address) == FLASHKV_PAGE_VALID &&
+			((FlashKV_Record*)FlashKV_Page)->keyLength == keyLength &&
+			memcmp(&FlashKV_Page[sizeof(FlashKV_Record)], key, keyLength) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Trägt address als neuesten Eintrag des Schlüssels ein.
+ */
+static void FlashKV_IndexPut(const char *key, uint8_t keyLength, uint32_t hash, uint32_t address)
+{
+	int32_t freeSlot;
+	int32_t slot = FlashKV_Find(key, keyLength, hash, &freeSlot);
+
+	if (slot < 0) {
+		if (freeSlot < 0) return;		// Index full, cannot happen below FLASHKV_CAPACITY
+		slot = freeSlot;
+		FlashKV_Index[slot].hash = hash;
+		FlashKV_Statistics.entries++;
+	}
+	FlashKV_Index[slot].address = address;
+}
+
+/**
+ * @brief  Sorgt für eine freie Seite am Log-Ende.
+ *
+ * Normale Schreibzugriffe dürfen den letzten freien Sektor nicht belegen, er bleibt der
+ * Garbage Collection vorbehalten. Notfalls wird hier blockierend aufgeräumt.
+ *
+ * @param  forGC 1, wenn die Garbage Collection selbst umkopiert
+ * @return 1, wenn FlashKV_Program() schreiben kann
+ */
+static uint8_t FlashKV_Reserve(uint8_t forGC)
+{
+	if (FlashKV_Head != FLASHKV_SECTOR_NONE && FlashKV_HeadPage < FLASHKV_PAGES_PER_SECTOR) return 1;
+
+	if (!forGC) {
+		uint8_t attempts = FLASHKV_SECTOR_COUNT;
+		while (FlashKV_FreeSectors <= 1) {
+			if (attempts-- == 0) return 0;
+			FlashKV_Collect();
+		}
+		// Collecting may have opened a new head sector for its copies
+		if (FlashKV_Head != FLASHKV_SECTOR_NONE && FlashKV_HeadPage < FLASHKV_PAGES_PER_SECTOR) return 1;
+	}
+
+	return FlashKV_OpenSector();
+}
+
+/**
+ * @brief  Programmiert die ersten length Bytes von FlashKV_Page in die nächste freie Seite.
+ * @return Flash-Adresse der Seite; FlashKV_Reserve() muss vorher erfolgreich gewesen sein
+ */
+static uint32_t FlashKV_Program(uint32_t length)
+{
+	uint32_t address = FlashKV_SectorAddress(FlashKV_Head) + FlashKV_HeadPage * FLASHKV_PAGE_SIZE;
+
+	W25Qxx_WriteEnable();
+	W25Qxx_PageProgram(address, FlashKV_Page, length);
+
+	FlashKV_HeadPage++;
+	FlashKV_Statistics.writes++;
+	return address;
+}
+
+/**
+ * @brief  Macht den nächsten freien Sektor (in Ringreihenfolge) zum neuen Log-Ende.
+ *
+ * Ein Sektor ohne gültigen Kopf kann nach einem Stromausfall noch Reste enthalten; er wird
+ * geprüft und bei Bedarf blockierend gelöscht.
+ */
+static uint8_t FlashKV_OpenSector(void)
+{
+	uint8_t start = (FlashKV_Head == FLASHKV_SECTOR_NONE) ? 0 : FlashKV_Head + 1;
+	uint8_t sector = FLASHKV_SECTOR_NONE;
+
+	for (uint8_t n = 0; n < FLASHKV_SECTOR_COUNT; n++) {
+		uint8_t s = (start + n) % FLASHKV_SECTOR_COUNT;
+		if (FlashKV_SectorSeq[s] == FLASHKV_SEQ_FREE) {
+			sector = s;
+			break;
+		}
+	}
+	if (sector == FLASHKV_SECTOR_NONE) return 0;
+
+	uint32_t address = FlashKV_SectorAddress(sector);
+	uint8_t blank = 1;
+	for (uint32_t offset = 0; offset < FLASHKV_SECTOR_SIZE && blank; offset += FLASHKV_PAGE_SIZE) {
+		W25Qxx_FastReadQuadOutput(address + offset, FlashKV_Page, FLASHKV_PAGE_SIZE);
+		for (uint32_t i = 0; i < FLASHKV_PAGE_SIZE; i++) {
+			if (FlashKV_Page[i] != 0xFF) {
+				blank = 0;
+				break;
+			}
+		}
+	}
+
+	if (!blank) {
+		W25Qxx_WriteEnable();
+		W25Qxx_EraseSector(address);
+		FlashKV_Statistics.erases++;
+	}
+
+	FlashKV_SectorHeader *header = (FlashKV_SectorHeader*)FlashKV_Page;
+	header->magic = FLASHKV_SECTOR_MAGIC;
+	header->sequence = FlashKV_NextSeq++;
+
+	W25Qxx_WriteEnable();
+	W25Qxx_PageProgram(address, FlashKV_Page, sizeof(FlashKV_SectorHeader));
+
+	FlashKV_SectorSeq[sector] = header->sequence;
+	FlashKV_FreeSectors--;
+	if (FlashKV_FreeSectors <= FLASHKV_GC_MIN_FREE) FlashPool_Wake();
+	FlashKV_Head = sector;
+	FlashKV_HeadPage = 1;
+	return 1;
+}
+
+/**
+ * @brief  Wählt den ältesten belegten Sektor als Opfer der Garbage Collection.
+ * @return 1, wenn ein Opfer gefunden wurde
+ */
+static uint8_t FlashKV_StartCollect(void)
+{
+	uint8_t victim = FLASHKV_SECTOR_NONE;
+
+	for (uint8_t s = 0; s < FLASHKV_SECTOR_COUNT; s++) {
+		if (s == FlashKV_Head || FlashKV_SectorSeq[s] == FLASHKV_SEQ_FREE) continue;
+		if (victim == FLASHKV_SECTOR_NONE || FlashKV_SectorSeq[s] < FlashKV_SectorSeq[victim]) victim = s;
+	}
+	if (victim == FLASHKV_SECTOR_NONE) return 0;
+
+	FlashKV_GCSector = victim;
+	FlashKV_GCPage = 1;
+	FlashKV_GC = FLASHKV_GC_COPY;
+	return 1;
+}
+
+/**
+ * @brief Bearbeitet bis zu pages Seiten des Opfersektors oder fragt das laufende Löschen ab.
+ *
+ * Ein Eintrag ist noch gültig, wenn der Index auf genau diese Adresse zeigt. Löschmarken
+ * werden nicht umkopiert: Der Opfersektor ist der älteste, ältere Einträge desselben
+ * Schlüssels verschwinden also mit ihm.
+ */
+static void FlashKV_CollectStep(uint8_t pages)
+{
+	if (FlashKV_GC == FLASHKV_GC_ERASE) {
+		if (!FlashPool_IsPending(FlashKV_SectorAddress(FlashKV_GCSector))) FlashKV_CompleteErase();
+		return;
+	}
+	if (FlashKV_GC != FLASHKV_GC_COPY) return;
+
+	while (pages-- > 0) {
+		if (FlashKV_GCPage >= FLASHKV_PAGES_PER_SECTOR) {
+			uint32_t address = FlashKV_SectorAddress(FlashKV_GCSector);
+			FlashKV_GC = FLASHKV_GC_ERASE;
+			if (FlashPool_Discard(address, FLASHKV_SECTOR_SIZE) == 0) {
+				// Outside the range of the pool
+				W25Qxx_WriteEnable();
+				W25Qxx_EraseSector(address);
+				FlashKV_CompleteErase();
+			}
+			return;
+		}
+
+		uint32_t address = FlashKV_SectorAddress(FlashKV_GCSector) + FlashKV_GCPage * FLASHKV_PAGE_SIZE;
+		FlashKV_GCPage++;
+
+		uint8_t result = FlashKV_ReadRecord(address);
+		if (result == FLASHKV_PAGE_FREE) {
+			FlashKV_GCPage = FLASHKV_PAGES_PER_SECTOR;
+			continue;
+		}
+		if (result != FLASHKV_PAGE_VALID) continue;
+
+		FlashKV_Record *record = (FlashKV_Record*)FlashKV_Page;
+		char key[FLASHKV_MAX_KEY];
+		uint8_t keyLength = record->keyLength;
+		memcpy(key, &FlashKV_Page[sizeof(FlashKV_Record)], keyLength);
+
+		int32_t freeSlot;
+		int32_t slot = FlashKV_Find(key, keyLength, FlashKV_Hash(key, keyLength), &freeSlot);
+		if (slot < 0 || FlashKV_Index[slot].address != address) continue;	// Superseded
+
+		if (((FlashKV_Record*)FlashKV_Page)->flags & FLASHKV_FLAG_DELETED) {
+			FlashKV_Index[slot].address = FLASHKV_SLOT_DELETED;
+			FlashKV_Statistics.entries--;
+			continue;
+		}
+
+		// Opening a new head sector reuses FlashKV_Page, so read the record again afterwards
+		if (!FlashKV_Reserve(1)) {
+			FlashKV_GCPage--;		// Retry this record later
+			return;
+		}
+		FlashKV_ReadRecord(address);
+		record = (FlashKV_Record*)FlashKV_Page;
+		FlashKV_Index[slot].address = FlashKV_Program(sizeof(FlashKV_Record) + record->keyLength + record->valueLength);
+		FlashKV_Statistics.copied++;
+	}
+}
+
+/**
+ * @brief Gibt den Opfersektor frei; hat der Pool ihn noch nicht gelöscht, wird er geholt und blockierend gelöscht.
+ */
+static void FlashKV_CompleteErase(void)
+{
+	if (FlashKV_GC != FLASHKV_GC_ERASE) return;
+
+	uint32_t address = FlashKV_SectorAddress(FlashKV_GCSector);
+	if (FlashPool_IsPending(address) && !FlashPool_Claim(address)) {
+		W25Qxx_WriteEnable();
+		W25Qxx_EraseSector(address);
+	}
+
+	FlashKV_SectorSeq[FlashKV_GCSector] = FLASHKV_SEQ_FREE;
+	FlashKV_FreeSectors++;
+	FlashKV_Statistics.erases++;
+	FlashKV_GC = FLASHKV_GC_IDLE;
+}
+
+/**
+ * @brief  Räumt blockierend einen ganzen Sektor auf (wenn FlashKV_Set() keinen Platz findet).
+ * @return 1, wenn danach mehr Sektoren frei sind als vorher
+ */
+static uint8_t FlashKV_Collect(void)
+{
+	uint8_t before = FlashKV_FreeSectors;
+
+	if (FlashKV_GC == FLASHKV_GC_IDLE && !FlashKV_StartCollect()) return 0;
+
+	while (FlashKV_GC != FLASHKV_GC_IDLE) {
+		if (FlashKV_GC == FLASHKV_GC_ERASE) {
+			FlashKV_CompleteErase();
+		} else {
+			uint8_t page = FlashKV_GCPage;
+			FlashKV_CollectStep(FLASHKV_PAGES_PER_SECTOR);
+			if (FlashKV_GC == FLASHKV_GC_COPY && FlashKV_GCPage == page) return 0;	// No space for copies
+		}
+	}
+	return FlashKV_FreeSectors > before;
+}
+
+/**
+ * @brief Baut einen Eintrag in FlashKV_Page, schreibt ihn ans Log-Ende und aktualisiert den Index.
+ */
+static uint8_t FlashKV_Append(const char *key, uint8_t keyLength, const void *value, uint16_t length, uint8_t flags)
+{
+	if (!FlashKV_Reserve(0)) return 0;
+
+	FlashKV_Record *record = (FlashKV_Record*)FlashKV_Page;
+	memset(FlashKV_Page, 0xFF, FLASHKV_PAGE_SIZE);
+	record->magic = FLASHKV_RECORD_MAGIC;
+	record->keyLength = keyLength;
+	record->flags = flags;
+	record->valueLength = length;
+	memcpy(&FlashKV_Page[sizeof(FlashKV_Record)], key, keyLength);
+	if (length > 0) memcpy(&FlashKV_Page[sizeof(FlashKV_Record) + keyLength], value, length);
+
+	uint32_t total = sizeof(FlashKV_Record) + keyLength + length;
+	uint16_t crc = FlashKV_Crc(0xFFFF, &FlashKV_Page[2], 4);
+	record->crc = FlashKV_Crc(crc, &FlashKV_Page[sizeof(FlashKV_Record)], total - sizeof(FlashKV_Record));
+
+	uint32_t address = FlashKV_Program(total);
+	FlashKV_IndexPut(key, keyLength, FlashKV_Hash(key, keyLength), address);
+	return 1;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file    FlashPool.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Hintergrund-Löschen freigegebener 4-KB-Sektoren des W25Qxx
+ *
+ * Schlüssel/Wert-Speicher und FatFs-Laufwerk melden Sektoren, deren Inhalt nicht mehr
+ * gebraucht wird, mit FlashPool_Discard() an (Garbage Collection bzw. CTRL_TRIM). Der Task
+ * löscht sie in Abschnitten von höchstens FLASHPOOL_SLICE_US: Resume, BUSY abfragen bis der
+ * Abschnitt um ist, dann Erase Suspend (0x75, tSUS max. 20 us). Zwischen zwei Abschnitten
+ * ist der Chip also nie beschäftigt; alle anderen dürfen lesen, programmieren und den
+ * Memory-Mapped-Modus benutzen, ohne vom Pool zu wissen. Nur Löschbefehle nimmt der Chip
+ * während der Unterbrechung nicht an, die Löschfunktionen des W25Qxx lassen den angehaltenen
+ * Vorgang deshalb vorher zu Ende laufen.
+ *
+ * War der Memory-Mapped-Modus eingeschaltet, verlässt ihn der Task für den Abschnitt und
+ * schaltet ihn danach wieder ein. Läuft gerade ein DMA-Transfer aus dem Fenster (Bild zum
+ * Display), ein W25Qxx_ReadAsync() oder ein W25Qxx_ProgramAsync(), wird der Abschnitt auf
+ * den nächsten Durchlauf verschoben.
+ *
+ * Ein späterer Schreibzugriff in einen gelöschten Sektor ist nur noch ein Page Program
+ * (< 1 ms statt 45 ms). Wer einen angemeldeten Sektor vorher braucht, holt ihn mit
+ * FlashPool_Claim() aus dem Pool.
+ *
+ * Vorgemerkt wird in einer Bitmaske mit einem Bit je Sektor; Adressen über
+ * W25QXX_FLASH_SIZE nimmt der Pool nicht an, ihre Besitzer löschen wie bisher selbst.
+ * Der Task schaltet sich ab, wenn nichts mehr zu löschen ist. In main() ruft er auch
+ * FlashKV_Process() auf, die Garbage Collection weckt ihn dafür mit FlashPool_Wake().
+ */
+
+#include "FlashPool.h"
+#include "Scheduler.h"
+#include <stdio.h>
+
+#define FLASHPOOL_WORDS           (FLASHPOOL_SECTOR_COUNT / 32)
+#define FLASHPOOL_NONE            0xFFFFFFFFUL
+
+FlashPool_Stats FlashPool_Statistics = {0};
+
+static uint32_t FlashPool_Pending[FLASHPOOL_WORDS];
+static uint32_t FlashPool_Current = FLASHPOOL_NONE;     // Sektor des laufenden (angehaltenen) Löschvorgangs
+static uint32_t FlashPool_Cursor = 0;                   // Nächstes Wort der Suche
+static uint8_t FlashPool_TaskId = SCHEDULER_INVALID_TASK;
+static FlashPool_BusyFunction FlashPool_WindowBusy = NULL;
+
+static uint32_t FlashPool_Next(void);
+static void FlashPool_Complete(void);
+
+/**
+ * @brief  Meldet den Task an
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der FlashPool_Task() aufruft
+ * @param  windowBusy: meldet DMA-Transfers aus dem Memory-Mapped-Fenster, darf NULL sein
+ * @note   Der Task bleibt eingeschaltet, bis sein erster Durchlauf nichts zu tun findet;
+ *         vorher angemeldete Sektoren (Garbage Collection in FlashKV_Init()) bleiben erhalten
+ */
+void FlashPool_Init(uint8_t taskId, FlashPool_BusyFunction windowBusy) {
+	FlashPool_TaskId = taskId;
+	FlashPool_WindowBusy = windowBusy;
+}
+
+/**
+ * @brief  Schaltet den Task ein, z.B. für die Garbage Collection des Schlüssel/Wert-Speichers
+ * @note   Er schaltet sich wieder ab, wenn der Pool leer ist und niemand erneut weckt
+ */
+void FlashPool_Wake(void) {
+	Scheduler_SetEnabled(FlashPool_TaskId, 1);
+}
+
+/**
+ * @brief  Meldet die ganz im Bereich liegenden Sektoren zum Löschen im Hintergrund an
+ * @param  address: Anfang des nicht mehr benötigten Bereichs
+ * @param  size: Länge in Bytes; angeschnittene Sektoren am Rand bleiben unberührt
+ * @retval Anzahl neu angemeldeter Sektoren
+ */
+uint32_t FlashPool_Discard(uint32_t address, uint32_t size) {
+	uint32_t first = (address + FLASHPOOL_SECTOR_SIZE - 1) / FLASHPOOL_SECTOR_SIZE;
+	uint32_t end = (address + size) / FLASHPOOL_SECTOR_SIZE;
+	uint32_t added = 0;
+
+	if (end > FLASHPOOL_SECTOR_COUNT) end = FLASHPOOL_SECTOR_COUNT;
+	for (uint32_t sector = first; sector < end; sector++) {
+		uint32_t bit = 1UL << (sector % 32);
+		if (FlashPool_Pending[sector / 32] & bit) continue;
+		FlashPool_Pending[sector / 32] |= bit;
+		added++;
+	}
+
+	if (added > 0) {
+		FlashPool_Statistics.pending += added;
+		FlashPool_Statistics.queued += added;
+		FlashPool_Wake();
+	}
+	return added;
+}
+
+/**
+ * @brief  Gibt an, ob der Sektor mit address noch auf sein Löschen wartet oder gerade gelöscht wird
+ */
+uint8_t FlashPool_IsPending(uint32_t address) {
+	uint32_t sector = address / FLASHPOOL_SECTOR_SIZE;
+	if (sector >= FLASHPOOL_SECTOR_COUNT) return 0;
+	return (FlashPool_Pending[sector / 32] >> (sector % 32)) & 1;
+}
+
+/**
+ * @brief  Nimmt einen angemeldeten Sektor aus dem Pool, bevor er beschrieben oder selbst gelöscht wird
+ *
+ * Wird der Sektor gerade gelöscht, wartet die Funktion das Ende ab (bis zu 45 ms typisch).
+ * Wartet er noch, wird er nur abgemeldet; sein alter Inhalt bleibt dann stehen.
+ *
+ * @retval 1, wenn der Sektor danach gelöscht ist, 0, wenn der Aufrufer selbst löschen muss
+ */
+uint8_t FlashPool_Claim(uint32_t address) {
+	uint32_t sector = address / FLASHPOOL_SECTOR_SIZE;
+	if (!FlashPool_IsPending(address)) return 0;
+
+	if (sector == FlashPool_Current) {
+		uint8_t wasMapped = W25Qxx_IsMemoryMapped();
+		W25Qxx_DisableMemoryMapped();
+		if (W25Qxx_IsEraseSuspended()) {
+			W25Qxx_EraseResume();
+		}
+		W25Qxx_WaitForWriteComplete();
+		FlashPool_Complete();
+		FlashPool_Statistics.claimed++;
+		if (wasMapped) W25Qxx_EnableMemoryMapped();
+		return 1;
+	}
+
+	FlashPool_Pending[sector / 32] &= ~(1UL << (sector % 32));
+	FlashPool_Statistics.pending--;
+	return 0;
+}
+
+/**
+ * @brief  Task: setzt den angehaltenen Löschvorgang für einen Abschnitt fort oder startet den nächsten
+ */
+void FlashPool_Task(void *context) {
+	if (W25Qxx_IsReadBusy() || W25Qxx_IsProgramBusy() || (FlashPool_WindowBusy != NULL && FlashPool_WindowBusy())) {
+		FlashPool_Statistics.deferred++;
+		return;
+	}
+
+	// An erase function of the W25Qxx may have let the suspended erase finish
+	if (FlashPool_Current != FLASHPOOL_NONE && !W25Qxx_IsEraseSuspended()) {
+		FlashPool_Complete();
+	}
+	if (FlashPool_Current == FLASHPOOL_NONE) {
+		FlashPool_Current = FlashPool_Next();
+		if (FlashPool_Current == FLASHPOOL_NONE) {
+			Scheduler_SetEnabled(FlashPool_TaskId, 0);
+			return;
+		}
+	}
+
+	uint32_t start = DWT->CYCCNT;
+	uint32_t slice = FLASHPOOL_SLICE_US * (SystemCoreClock / 1000000UL);
+	uint8_t wasMapped = W25Qxx_IsMemoryMapped();
+
+	if (W25Qxx_IsEraseSuspended()) {
+		W25Qxx_EraseResume();
+	} else {
+		W25Qxx_EraseSectorStart(FlashPool_Current * FLASHPOOL_SECTOR_SIZE);
+	}
+	FlashPool_Statistics.slices++;
+
+	uint8_t busy;
+	while ((busy = W25Qxx_IsBusy()) && DWT->CYCCNT - start < slice) {}
+	if (busy) {
+		W25Qxx_EraseSuspend();
+		FlashPool_Statistics.suspends++;
+	} else {
+		FlashPool_Complete();
+	}
+
+	if (wasMapped) W25Qxx_EnableMemoryMapped();
+
+	uint32_t us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000UL);
+	if (us > FlashPool_Statistics.maxSliceUs) FlashPool_Statistics.maxSliceUs = us;
+}
+
+/**
+ * @brief  Gibt Füllstand und Zähler aus
+ */
+void FlashPool_Dump(void) {
+	FlashPool_Stats s = FlashPool_Statistics;
+
+	printf("Löschpool: %lu Sektoren offen, %lu angemeldet, %lu gelöscht, %lu abgeholt\n",
+			s.pending, s.queued, s.erased, s.claimed);
+	printf("Abschnitte %lu (max %lu us), Suspend %lu, verschoben %lu\n",
+			s.slices, s.maxSliceUs, s.suspends, s.deferred);
+}
+
+/**
+ * @brief  Sucht ab FlashPool_Cursor den nächsten vorgemerkten Sektor
+ * @retval Sektornummer oder FLASHPOOL_NONE
+ */
+static uint32_t FlashPool_Next(void) {
+	for (uint32_t n = 0; n < FLASHPOOL_WORDS; n++) {
+		uint32_t word = (FlashPool_Cursor + n) % FLASHPOOL_WORDS;
+		if (FlashPool_Pending[word] != 0) {
+			FlashPool_Cursor = word;
+			return word * 32 + __CLZ(__RBIT(FlashPool_Pending[word]));
+		}
+	}
+	return FLASHPOOL_NONE;
+}
+
+/**
+ * @brief  Gibt den gerade gelöschten Sektor frei und verwirft seine Cache-Zeilen im Fenster
+ */
+static void FlashPool_Complete(void) {
+	uint32_t sector = FlashPool_Current;
+
+	FlashPool_Pending[sector / 32] &= ~(1UL << (sector % 32));
+	FlashPool_Statistics.pending--;
+	FlashPool_Statistics.erased++;
+	FlashPool_Current = FLASHPOOL_NONE;
+
+	SCB_InvalidateDCache_by_Addr((uint32_t*)W25Qxx_MappedAddress(sector * FLASHPOOL_SECTOR_SIZE),
+			(int32_t)FLASHPOOL_SECTOR_SIZE);
+}
@@ -0,0 +1,346 @@
+/**
+ * @file    Fmt.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Schnelle Textformatierung für Anzeigen: Ganzzahl, Festkomma, Hex, Breiten, ohne newlib-printf
+ *
+ * newlib-sprintf geht für jede Zahl durch die allgemeine Formatmaschine mit Locale, Division je
+ * Ziffer und über 1 KB Stack. Hier entstehen Dezimalzahlen zwei Ziffern auf einmal aus einer
+ * Tabelle (Division durch die Konstante 100 wird zu einer Multiplikation), Ziel ist direkt der
+ * Textpuffer des Aufrufers, z.B. ILI9341_Widget.text. Eine Festkommazahl mit Einheit kostet so
+ * einige hundert Takte statt einigen tausend.
+ *
+ * Fmt_Format() deckt die Teilmenge von printf ab, die Anzeigen brauchen, und trägt das
+ * printf-format-Attribut, damit GCC Format und Argumente schon beim Übersetzen prüft.
+ */
+
+#include "Fmt.h"
+#include <string.h>
+
+// Two decimal digits per entry, "00" .. "99"
+static const char Fmt_Digits[200] = {
+	'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+static const uint32_t Fmt_Powers[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+#define FMT_MAX_DECIMALS          ((uint8_t)(sizeof(Fmt_Powers) / sizeof(Fmt_Powers[0]) - 1))
+
+static void Fmt_Field(Fmt_Buffer *b, const char *s, uint8_t length, uint8_t width, uint8_t left, char pad);
+
+/**
+ * @brief  Beginnt eine leere Zeichenkette im Puffer text mit size Bytes
+ */
+void Fmt_Init(Fmt_Buffer *b, char *text, uint16_t size) {
+	b->text = text;
+	b->size = size;
+	b->length = 0;
+	b->truncated = 0;
+	if (size > 0) text[0] = '\0';
+}
+
+/**
+ * @brief  Hängt ein Zeichen an
+ */
+void Fmt_Char(Fmt_Buffer *b, char c) {
+	if (b->length + 1 >= b->size) {
+		b->truncated = 1;
+		return;
+	}
+	b->text[b->length++] = c;
+	b->text[b->length] = '\0';
+}
+
+/**
+ * @brief  Hängt eine Zeichenkette an
+ */
+void Fmt_Str(Fmt_Buffer *b, const char *s) {
+	uint32_t length = strlen(s);
+
+	if (b->size == 0) {
+		b->truncated = 1;
+		return;
+	}
+	if (b->length + length >= b->size) {
+		length = b->size - 1 - b->length;
+		b->truncated = 1;
+	}
+	memcpy(&b->text[b->length], s, length);
+	b->length += length;
+	b->text[b->length] = '\0';
+}
+
+/**
+ * @brief  Hängt s in einem Feld von |width| Zeichen an, rechtsbündig bzw. linksbündig bei width < 0
+ */
+void Fmt_Pad(Fmt_Buffer *b, const char *s, int8_t width) {
+	uint32_t length = strlen(s);
+	uint8_t left = width < 0;
+	uint8_t field = left ? -width : width;
+
+	Fmt_Field(b, s, length > 255 ? 255 : (uint8_t)length, field, left, ' ');
+}
+
+/**
+ * @brief  Schreibt value dezimal nach out, ohne abschließende 0
+ * @retval Anzahl der Ziffern (1-10)
+ */
+uint8_t Fmt_Decimal(char *out, uint32_t value) {
+	char digits[10];
+	uint8_t pos = sizeof(digits);
+
+	while (value >= 100) {
+		uint32_t pair = (value % 100) * 2;
+		value /= 100;
+		digits[--pos] = Fmt_Digits[pair + 1];
+		digits[--pos] = Fmt_Digits[pair];
+	}
+	if (value >= 10) {
+		digits[--pos] = Fmt_Digits[value * 2 + 1];
+		digits[--pos] = Fmt_Digits[value * 2];
+	} else {
+		digits[--pos] = (char)('0' + value);
+	}
+
+	uint8_t count = sizeof(digits) - pos;
+	memcpy(out, &digits[pos], count);
+	return count;
+}
+
+/**
+ * @brief  Hängt value dezimal an, rechtsbündig in width Zeichen mit pad (' ' oder '0')
+ */
+void Fmt_U32(Fmt_Buffer *b, uint32_t value, uint8_t width, char pad) {
+	char digits[10];
+	uint8_t count = Fmt_Decimal(digits, value);
+
+	Fmt_Field(b, digits, count, width, 0, pad);
+}
+
+/**
+ * @brief  Wie Fmt_U32() mit Vorzeichen; bei pad '0' steht das '-' vor den Nullen
+ */
+void Fmt_I32(Fmt_Buffer *b, int32_t value, uint8_t width, char pad) {
+	char digits[11];
+	uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+	uint8_t count = 0;
+
+	if (value < 0) digits[count++] = '-';
+	count += Fmt_Decimal(&digits[count], magnitude);
+
+	if (pad == '0' && value < 0) {
+		Fmt_Char(b, '-');
+		Fmt_Field(b, &digits[1], count - 1, width > 0 ? width - 1 : 0, 0, '0');
+	} else {
+		Fmt_Field(b, digits, count, width, 0, pad);
+	}
+}
+
+/**
+ * @brief  Hängt value / 10^decimals mit decimals Nachkommastellen an, rechtsbündig in width Zeichen
+ *
+ * Beispiel: Fmt_Fixed(&b, -2345, 2, 0) ergibt "-23.45", Fmt_Fixed(&b, 5, 1, 5) "  0.5".
+ */
+void Fmt_Fixed(Fmt_Buffer *b, int32_t value, uint8_t decimals, uint8_t width) {
+	char digits[12];
+	uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+	uint8_t count = 0;
+
+	if (decimals > FMT_MAX_DECIMALS) decimals = FMT_MAX_DECIMALS;
+	uint32_t divider = Fmt_Powers[decimals];
+
+	if (value < 0) digits[count++] = '-';
+	count += Fmt_Decimal(&digits[count], magnitude / divider);
+	if (decimals > 0) {
+		char fraction[10];
+		uint8_t fractionCount = Fmt_Decimal(fraction, magnitude % divider);
+
+		// Leading zeros of the fraction, then its digits
+		digits[count++] = '.';
+		memset(&digits[count], '0', decimals - fractionCount);
+		count += decimals - fractionCount;
+		memcpy(&digits[count], fraction, fractionCount);
+		count += fractionCount;
+	}
+
+	Fmt_Field(b, digits, count, width, 0, ' ');
+}
+
+/**
+ * @brief  Hängt value hexadezimal an, mit mindestens digits Stellen (führende Nullen, 0 = so kurz wie möglich)
+ */
+void Fmt_Hex(Fmt_Buffer *b, uint32_t value, uint8_t digits, uint8_t upper) {
+	const char *alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	char hex[8];
+	uint8_t count = 0;
+
+	do {
+		hex[7 - count++] = alphabet[value & 0xF];
+		value >>= 4;
+	} while (value != 0 && count < 8);
+
+	Fmt_Field(b, &hex[8 - count], count, digits, 0, '0');
+}
+
+/**
+ * @brief  printf-Teilmenge in text (höchstens size Bytes einschließlich 0)
+ * @retval Länge des Ergebnisses ohne die abschließende 0
+ */
+uint16_t Fmt_Format(char *text, uint16_t size, const char *format, ...) {
+	va_list args;
+
+	va_start(args, format);
+	uint16_t length = Fmt_FormatV(text, size, format, args);
+	va_end(args);
+	return length;
+}
+
+/**
+ * @brief  Wie Fmt_Format() mit einer va_list
+ */
+uint16_t Fmt_FormatV(char *text, uint16_t size, const char *format, va_list args) {
+	Fmt_Buffer b;
+
+	Fmt_Init(&b, text, size);
+	for (const char *p = format; *p != '\0'; p++) {
+		if (*p != '%') {
+			Fmt_Char(&b, *p);
+			continue;
+		}
+
+		uint8_t left = 0, zero = 0, isLong = 0, unsupported = 0;
+		uint8_t width = 0;
+
+		p++;
+		for (; *p == '-' || *p == '0'; p++) {
+			if (*p == '-') left = 1;
+			else zero = 1;
+		}
+		if (*p == '*') {
+			int w = va_arg(args, int);
+			if (w < 0) {
+				left = 1;
+				w = -w;
+			}
+			width = w > 255 ? 255 : (uint8_t)w;
+			p++;
+		}
+		for (; *p >= '0' && *p <= '9'; p++) {
+			width = width * 10 + (*p - '0');
+		}
+		if (*p == '.') {
+			unsupported = 1;
+			for (p++; (*p >= '0' && *p <= '9') || *p == '*'; p++) {
+				if (*p == '*') (void)va_arg(args, int);
+			}
+		}
+		for (; *p == 'l' || *p == 'h'; p++) {
+			if (*p == 'l') isLong = 1;
+		}
+
+		char digits[12];
+		uint8_t count = 0;
+		char pad = (zero && !left) ? '0' : ' ';
+
+		switch (*p) {
+			case 'd':
+			case 'i': {
+				int32_t value = isLong ? (int32_t)va_arg(args, long) : (int32_t)va_arg(args, int);
+				uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+				if (value < 0 && pad == '0') {
+					Fmt_Char(&b, '-');
+					if (width > 0) width--;
+				} else if (value < 0) {
+					digits[count++] = '-';
+				}
+				count += Fmt_Decimal(&digits[count], magnitude);
+				break;
+			}
+			case 'u': {
+				uint32_t value = isLong ? (uint32_t)va_arg(args, unsigned long) : va_arg(args, unsigned int);
+				count = Fmt_Decimal(digits, value);
+				break;
+			}
+			case 'x':
+			case 'X': {
+				uint32_t value = isLong ? (uint32_t)va_arg(args, unsigned long) : va_arg(args, unsigned int);
+				Fmt_Buffer hex;
+				Fmt_Init(&hex, digits, sizeof(digits));
+				Fmt_Hex(&hex, value, 0, *p == 'X');
+				count = hex.length;
+				break;
+			}
+			case 'c':
+				digits[count++] = (char)va_arg(args, int);
+				break;
+			case 's': {
+				const char *s = va_arg(args, const char*);
+				if (s == NULL) s = "(null)";
+				if (unsupported) {
+					Fmt_Char(&b, '?');
+					continue;
+				}
+				uint32_t length = strlen(s);
+				Fmt_Field(&b, s, length > 255 ? 255 : (uint8_t)length, width, left, ' ');
+				continue;
+			}
+			case '%':
+				Fmt_Char(&b, '%');
+				continue;
+			case 'f':
+			case 'e':
+			case 'g':
+				(void)va_arg(args, double);
+				Fmt_Char(&b, '?');
+				continue;
+			case '\0':
+				return b.length;
+			default:
+				Fmt_Char(&b, '?');
+				continue;
+		}
+
+		if (unsupported) {
+			Fmt_Char(&b, '?');
+			continue;
+		}
+		Fmt_Field(&b, digits, count, width, left, pad);
+	}
+	return b.length;
+}
+
+/**
+ * @brief  Hängt length Zeichen aus s in einem Feld von width Zeichen an
+ */
+static void Fmt_Field(Fmt_Buffer *b, const char *s, uint8_t length, uint8_t width, uint8_t left, char pad) {
+	uint8_t fill = width > length ? width - length : 0;
+
+	if (b->size == 0) {
+		b->truncated = 1;
+		return;
+	}
+	if (!left) {
+		while (fill-- > 0) Fmt_Char(b, pad);
+	}
+
+	if (b->length + length >= b->size) {
+		length = b->size - 1 - b->length;
+		b->truncated = 1;
+	}
+	memcpy(&b->text[b->length], s, length);
+	b->length += length;
+	b->text[b->length] = '\0';
+
+	if (left) {
+		while (fill-- > 0) Fmt_Char(b, ' ');
+	}
+}
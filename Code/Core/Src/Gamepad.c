@@ -0,0 +1,370 @@
+/**
+ * @file    Gamepad.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   PS4-Controller über den Airlink als Eingabe: Rahmen per UART4-DMA, Auswertung ohne Kopie
+ *
+ * Der Airlink (Hardware/PS4_Airlink, Raspberry Pi Pico mit USB-Host für den Controller und
+ * NRF24L01) empfängt die Berichte des DS4 und gibt jeden als Rahmen auf UART4 (PD0/PD1, 1 MBaud)
+ * weiter. Ein Rahmen ist 15 Bytes lang (Gamepad.h): 0xA5, Folgenummer, Alter des Berichts in µs
+ * beim Start des Sendens, die ersten 10 Bytes des USB-Berichts ab der Report-ID und als Prüfsumme
+ * das Komplement der Bytesumme davor. Ohne Änderung am Controller schickt der Airlink alle 50 ms
+ * den letzten Bericht noch einmal, damit Gamepad_Tick() eine getrennte Verbindung erkennt.
+ *
+ * Empfang: HAL_UARTEx_ReceiveToIdle_DMA() füllt abwechselnd einen von zwei Puffern im nicht
+ * gecachten Speicher (DMA_BUFFER); die Sendepause hinter jedem Rahmen beendet den Transfer. Der
+ * Interrupt startet zuerst den Empfang in den anderen Puffer und wertet dann den fertigen an Ort
+ * und Stelle aus (Gamepad_Frame liegt über den Bytes), ohne Ring und ohne Kopie. Läuft ein Puffer
+ * ohne Pause voll, wird er verworfen (overruns). Die Zeit des Berichts am Controller ist das Ende
+ * der Pause abzüglich der Pause selbst, der Sendezeit des Rahmens und des mitgeschickten Alters.
+ *
+ * Linker Stick (mit Hysterese) und Steuerkreuz werden zu GAMEPAD_LEFT ... GAMEPAD_DOWN, die Tasten
+ * zu den übrigen GAMEPAD_*-Eingaben. UserInput_Inject() erzeugt daraus dieselben Ereignisse wie
+ * bei Joystick und Tastern, samt Wiederholung und langem Druck. UART4, sein DMA-Stream und
+ * Gamepad_Tick() (aus dem TIM7-Tick) laufen deshalb auf IRQ_PRIO_REALTIME wie die übrigen Erzeuger
+ * von UserInput und unterbrechen sich nicht gegenseitig. Jeder Bericht geht außerdem als
+ * TOPIC_GAMEPAD mit Sticks und Triggern hinaus.
+ *
+ * Vor einer Taktumschaltung bricht Gamepad_Suspend() den Empfang ab (UART4 hängt wie UART7 an
+ * D2PCLK1), Gamepad_Resume() startet ihn neu.
+ */
+
+#include "Gamepad.h"
+
+#if GAMEPAD_ENABLE
+
+#include "usart.h"
+#include "Cache.h"
+#include "DmaAlloc.h"
+#include "Irq.h"
+#include "Timebase.h"
+#include "Topic.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Richtungen des linken Sticks bzw. des Steuerkreuzes als Bits unter den GAMEPAD_*-Eingaben */
+#define GAMEPAD_DIR_UP            (1UL << GAMEPAD_UP)
+#define GAMEPAD_DIR_RIGHT         (1UL << GAMEPAD_RIGHT)
+#define GAMEPAD_DIR_DOWN          (1UL << GAMEPAD_DOWN)
+#define GAMEPAD_DIR_LEFT          (1UL << GAMEPAD_LEFT)
+
+/**
+ * @brief Rahmen des Airlinks, liegt direkt über dem DMA-Puffer
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t sync;                  // GAMEPAD_SYNC
+	uint8_t sequence;
+	uint16_t ageUs;                // vom USB-Bericht am Airlink bis zum ersten Byte dieses Rahmens
+	uint8_t report[GAMEPAD_REPORT_SIZE];  // Report-ID, LX, LY, RX, RY, Tasten (3), L2, R2
+	uint8_t checksum;              // ~Summe der Bytes davor
+} Gamepad_Frame;
+
+// Steuerkreuz 0 = oben, im Uhrzeigersinn, 8 und mehr = keine Richtung
+static const uint32_t Gamepad_Hat[8] = {
+	GAMEPAD_DIR_UP, GAMEPAD_DIR_UP | GAMEPAD_DIR_RIGHT, GAMEPAD_DIR_RIGHT, GAMEPAD_DIR_DOWN | GAMEPAD_DIR_RIGHT,
+	GAMEPAD_DIR_DOWN, GAMEPAD_DIR_DOWN | GAMEPAD_DIR_LEFT, GAMEPAD_DIR_LEFT, GAMEPAD_DIR_UP | GAMEPAD_DIR_LEFT,
+};
+
+static DMA_HandleTypeDef Gamepad_DmaRx;
+static uint8_t Gamepad_RxBuffer[2][GAMEPAD_RX_BUFFER_SIZE] DMA_BUFFER;
+static uint8_t Gamepad_RxIndex = 0;            // Puffer, den der DMA gerade füllt
+static uint8_t Gamepad_Initialised = 0;
+static volatile uint8_t Gamepad_RxRunning = 0;
+
+static Gamepad_Stats Gamepad_Statistics;
+static Topic_Gamepad Gamepad_State;
+static uint32_t Gamepad_Stick = 0;             // Richtungen des linken Sticks, für die Hysterese
+static uint32_t Gamepad_SilentMs = 0;          // seit dem letzten gültigen Rahmen
+static uint8_t Gamepad_LastSequence = 0;
+static uint64_t Gamepad_LastFrameUs = 0;
+static uint32_t Gamepad_StatsStartMs = 0;
+
+static void Gamepad_StartRx(uint8_t index);
+static void Gamepad_Parse(const uint8_t *data, uint16_t size, uint64_t endUs);
+static void Gamepad_Report(const Gamepad_Frame *frame, uint64_t endUs);
+static uint32_t Gamepad_StickAxis(uint8_t value, uint32_t held, uint32_t negative, uint32_t positive);
+static uint32_t Gamepad_ByteUs(void);
+
+/**
+ * @brief  Holt einen DMA-Stream für den Empfang auf UART4 und startet ihn
+ *
+ * Ohne freien Stream bleibt das Gamepad aus ('pad' zeigt das an), der Rest läuft weiter.
+ */
+void Gamepad_Init(void) {
+	DMA_HandleTypeDef *hdma = &Gamepad_DmaRx;
+
+	hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+	hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma->Init.MemInc = DMA_MINC_ENABLE;
+	hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	hdma->Init.Mode = DMA_NORMAL;
+	hdma->Init.Priority = DMA_PRIORITY_MEDIUM;
+	hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (!DmaAlloc_Claim(hdma, DMAALLOC_DMA, DMA_REQUEST_UART4_RX, IRQ_PRIO_REALTIME, "UART4 RX")
+			|| HAL_DMA_Init(hdma) != HAL_OK) {
+		DmaAlloc_Release(hdma);
+		return;
+	}
+	__HAL_LINKDMA(&huart4, hdmarx, Gamepad_DmaRx);
+
+	Gamepad_Initialised = 1;
+	Gamepad_ResetStats();
+	Gamepad_StartRx(0);
+}
+
+/**
+ * @brief  Aus HAL_UARTEx_RxEventCallback(): Sendepause oder voller Puffer, Rahmen auswerten
+ * @param  size: empfangene Bytes im fertigen Puffer
+ */
+RAMFUNC void Gamepad_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size) {
+	if (huart != &huart4 || !Gamepad_RxRunning)
+		return;
+	if (HAL_UARTEx_GetRxEventType(huart) == HAL_UART_RXEVENT_HT)
+		return;
+
+	uint64_t now = Timebase_Us();
+	uint32_t start = DWT->CYCCNT;
+	const uint8_t *done = Gamepad_RxBuffer[Gamepad_RxIndex];
+
+	// The next frame may already be on the wire: restart first, parse afterwards
+	Gamepad_StartRx(Gamepad_RxIndex ^ 1U);
+
+	if (size >= GAMEPAD_RX_BUFFER_SIZE)
+		Gamepad_Statistics.overruns++;
+	else
+		Gamepad_Parse(done, size, now - Gamepad_ByteUs());
+
+	uint32_t cycles = DWT->CYCCNT - start;
+	Gamepad_Statistics.parseCycles = cycles;
+	if (cycles > Gamepad_Statistics.parseCyclesMax)
+		Gamepad_Statistics.parseCyclesMax = cycles;
+}
+
+/**
+ * @brief  Aus HAL_UART_ErrorCallback(): abgebrochener Empfang startet neu, der Pufferinhalt ist verloren
+ */
+void Gamepad_ErrorCallback(UART_HandleTypeDef *huart) {
+	if (huart != &huart4 || !Gamepad_RxRunning)
+		return;
+
+	Gamepad_Statistics.uartErrors++;
+	if (huart->RxState == HAL_UART_STATE_READY)
+		Gamepad_StartRx(Gamepad_RxIndex);
+}
+
+/**
+ * @brief  Aus dem TIM7-Tick: nach GAMEPAD_TIMEOUT_MS ohne Rahmen alle Tasten loslassen
+ * @param  elapsedMs: Millisekunden seit dem letzten Aufruf
+ */
+RAMFUNC void Gamepad_Tick(uint32_t elapsedMs) {
+	if (!Gamepad_Statistics.connected)
+		return;
+
+	Gamepad_SilentMs += elapsedMs;
+	if (Gamepad_SilentMs < GAMEPAD_TIMEOUT_MS)
+		return;
+
+	Gamepad_Statistics.connected = 0;
+	Gamepad_Statistics.timeouts++;
+	Gamepad_Stick = 0;
+	UserInput_Inject(0, GAMEPAD_INPUT_MASK, Timebase_Us());
+
+	Gamepad_State.buttons = 0;
+	Gamepad_State.connected = 0;
+	Topic_Publish(TOPIC_GAMEPAD, &Gamepad_State, sizeof(Gamepad_State));
+}
+
+/**
+ * @brief  Vor einer Taktumschaltung: Empfang abbrechen, MX_UART4_Init() rechnet danach die Baudrate neu
+ */
+void Gamepad_Suspend(void) {
+	if (Gamepad_RxRunning) {
+		Gamepad_RxRunning = 0;
+		HAL_UART_AbortReceive(&huart4);
+	}
+}
+
+/**
+ * @brief  Nach der Taktumschaltung: Empfang neu starten
+ */
+void Gamepad_Resume(void) {
+	if (Gamepad_Initialised && !Gamepad_RxRunning)
+		Gamepad_StartRx(Gamepad_RxIndex);
+}
+
+uint8_t Gamepad_IsConnected(void) {
+	return Gamepad_Statistics.connected;
+}
+
+const Gamepad_Stats* Gamepad_GetStats(void) {
+	return &Gamepad_Statistics;
+}
+
+void Gamepad_ResetStats(void) {
+	uint32_t primask = __get_PRIMASK();
+	uint8_t connected;
+
+	__disable_irq();
+	connected = Gamepad_Statistics.connected;
+	memset(&Gamepad_Statistics, 0, sizeof(Gamepad_Statistics));
+	Gamepad_Statistics.connected = connected;
+	Gamepad_Statistics.intervalUsMin = UINT32_MAX;
+	Gamepad_StatsStartMs = HAL_GetTick();
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Zustand und Statistik für die Kommandozeile ('pad')
+ */
+void Gamepad_Dump(void) {
+	const Gamepad_Stats *s = &Gamepad_Statistics;
+	uint32_t elapsedMs = HAL_GetTick() - Gamepad_StatsStartMs;
+
+	if (!Gamepad_Initialised) {
+		printf("Gamepad aus: kein DMA-Stream für den Empfang auf UART4\n");
+		return;
+	}
+	printf("Gamepad %s auf UART4 (%lu Baud), %lu Verbindungen, %lu Zeitüberschreitungen\n",
+			s->connected ? "verbunden" : "getrennt", huart4.Init.BaudRate, s->connects, s->timeouts);
+	printf("  Berichte %lu (%lu/s), verloren %lu, Abstand %lu-%lu us\n", s->reports,
+			elapsedMs ? (uint32_t)((uint64_t)s->reports * 1000U / elapsedMs) : 0, s->lost,
+			s->intervalUsMin == UINT32_MAX ? 0 : s->intervalUsMin, s->intervalUsMax);
+	printf("  Alter %lu us (max %lu), Auswertung %lu Takte (max %lu)\n", s->ageUs, s->ageUsMax,
+			s->parseCycles, s->parseCyclesMax);
+	printf("  Prüfsumme %lu, Sync %lu B, Report-ID %lu, Überlauf %lu, UART %lu\n", s->checksumErrors,
+			s->syncErrors, s->badReports, s->overruns, s->uartErrors);
+	printf("  Tasten 0x%03lX, links %u/%u, rechts %u/%u, L2 %u, R2 %u\n",
+			(unsigned long)(Gamepad_State.buttons >> GAMEPAD_LEFT), Gamepad_State.stick[0], Gamepad_State.stick[1],
+			Gamepad_State.stick[2], Gamepad_State.stick[3], Gamepad_State.trigger[0], Gamepad_State.trigger[1]);
+}
+
+/**
+ * @brief  Startet den Empfang in einen der beiden Puffer, ohne Interrupt bei halbem Puffer
+ */
+static void Gamepad_StartRx(uint8_t index) {
+	Gamepad_RxIndex = index;
+	Gamepad_RxRunning = HAL_UARTEx_ReceiveToIdle_DMA(&huart4, Gamepad_RxBuffer[index], GAMEPAD_RX_BUFFER_SIZE) == HAL_OK;
+	if (Gamepad_RxRunning)
+		__HAL_DMA_DISABLE_IT(&Gamepad_DmaRx, DMA_IT_HT);
+}
+
+/**
+ * @brief  Sucht die Rahmen im fertigen Puffer, normalerweise genau einen am Anfang
+ * @param  endUs: Timebase_Us() beim Ende des letzten Bytes
+ */
+static RAMFUNC void Gamepad_Parse(const uint8_t *data, uint16_t size, uint64_t endUs) {
+	uint32_t byteUs = Gamepad_ByteUs();
+	uint16_t offset = 0;
+
+	while (size - offset >= GAMEPAD_FRAME_SIZE) {
+		const Gamepad_Frame *frame = (const Gamepad_Frame*)&data[offset];
+		uint8_t sum = 0;
+
+		if (frame->sync != GAMEPAD_SYNC) {
+			Gamepad_Statistics.syncErrors++;
+			offset++;
+			continue;
+		}
+		for (uint8_t i = 0; i < GAMEPAD_FRAME_SIZE - 1; i++)
+			sum += data[offset + i];
+		if ((uint8_t)(sum + frame->checksum) != 0xFF) {    // checksum == ~sum
+			Gamepad_Statistics.checksumErrors++;
+			offset++;
+			continue;
+		}
+
+		offset += GAMEPAD_FRAME_SIZE;
+		Gamepad_Report(frame, endUs - (uint64_t)(size - offset) * byteUs);
+	}
+	Gamepad_Statistics.syncErrors += size - offset;
+}
+
+/**
+ * @brief  Übernimmt einen gültigen Rahmen: Statistik, Eingaben an UserInput, TOPIC_GAMEPAD
+ * @param  endUs: Timebase_Us() beim Ende des Rahmens
+ */
+static RAMFUNC void Gamepad_Report(const Gamepad_Frame *frame, uint64_t endUs) {
+	Gamepad_Stats *s = &Gamepad_Statistics;
+	const uint8_t *r = frame->report;
+
+	if (r[0] != GAMEPAD_REPORT_ID) {
+		s->badReports++;
+		return;
+	}
+
+	uint32_t ageUs = frame->ageUs + GAMEPAD_FRAME_SIZE * Gamepad_ByteUs();
+	uint64_t timeUs = endUs - ageUs;
+
+	if (s->connected) {
+		uint32_t interval = (uint32_t)(endUs - Gamepad_LastFrameUs);
+		uint8_t gap = (uint8_t)(frame->sequence - Gamepad_LastSequence);
+
+		if (gap > 1)
+			s->lost += gap - 1U;
+		if (interval < s->intervalUsMin)
+			s->intervalUsMin = interval;
+		if (interval > s->intervalUsMax)
+			s->intervalUsMax = interval;
+	} else {
+		s->connected = 1;
+		s->connects++;
+	}
+	Gamepad_LastSequence = frame->sequence;
+	Gamepad_LastFrameUs = endUs;
+	Gamepad_SilentMs = 0;
+	s->reports++;
+	s->ageUs = ageUs;
+	if (ageUs > s->ageUsMax)
+		s->ageUsMax = ageUs;
+
+	// Left stick with hysteresis, combined with the d-pad
+	uint32_t stick = Gamepad_StickAxis(r[1], Gamepad_Stick, GAMEPAD_DIR_LEFT, GAMEPAD_DIR_RIGHT)
+			| Gamepad_StickAxis(r[2], Gamepad_Stick, GAMEPAD_DIR_UP, GAMEPAD_DIR_DOWN);
+	uint8_t hat = r[5] & GAMEPAD_DS4_HAT_MASK;
+	uint32_t pressed = stick | (hat < 8 ? Gamepad_Hat[hat] : 0);
+
+	Gamepad_Stick = stick;
+	if (r[5] & GAMEPAD_DS4_CROSS)    pressed |= 1UL << GAMEPAD_CROSS;
+	if (r[5] & GAMEPAD_DS4_CIRCLE)   pressed |= 1UL << GAMEPAD_CIRCLE;
+	if (r[5] & GAMEPAD_DS4_SQUARE)   pressed |= 1UL << GAMEPAD_SQUARE;
+	if (r[5] & GAMEPAD_DS4_TRIANGLE) pressed |= 1UL << GAMEPAD_TRIANGLE;
+	if (r[6] & GAMEPAD_DS4_L1)       pressed |= 1UL << GAMEPAD_L1;
+	if (r[6] & GAMEPAD_DS4_R1)       pressed |= 1UL << GAMEPAD_R1;
+	if (r[6] & GAMEPAD_DS4_OPTIONS)  pressed |= 1UL << GAMEPAD_OPTIONS;
+	if (r[7] & GAMEPAD_DS4_PS)       pressed |= 1UL << GAMEPAD_PS;
+
+	UserInput_Inject(pressed, GAMEPAD_INPUT_MASK, timeUs);
+
+	memcpy(Gamepad_State.stick, &r[1], sizeof(Gamepad_State.stick));
+	Gamepad_State.trigger[0] = r[8];
+	Gamepad_State.trigger[1] = r[9];
+	Gamepad_State.buttons = pressed;
+	Gamepad_State.timeUs = timeUs;
+	Gamepad_State.reports = s->reports;
+	Gamepad_State.connected = 1;
+	Topic_Publish(TOPIC_GAMEPAD, &Gamepad_State, sizeof(Gamepad_State));
+}
+
+/**
+ * @brief  Eine Achse als zwei Richtungen: gedrückt ab GAMEPAD_STICK_PRESS, gehalten bis unter GAMEPAD_STICK_RELEASE
+ * @param  held: Richtungen nach dem letzten Bericht
+ */
+static uint32_t Gamepad_StickAxis(uint8_t value, uint32_t held, uint32_t negative, uint32_t positive) {
+	int32_t deflection = (int32_t)value - 128;
+
+	if (deflection <= -((held & negative) ? GAMEPAD_STICK_RELEASE : GAMEPAD_STICK_PRESS))
+		return negative;
+	if (deflection >= ((held & positive) ? GAMEPAD_STICK_RELEASE : GAMEPAD_STICK_PRESS))
+		return positive;
+	return 0;
+}
+
+/**
+ * @brief  Dauer eines Zeichens (Start, 8 Daten, Stop) bei der eingestellten Baudrate in µs, aufgerundet
+ */
+static uint32_t Gamepad_ByteUs(void) {
+	return (10000000UL + huart4.Init.BaudRate - 1) / huart4.Init.BaudRate;
+}
+
+#endif /* GAMEPAD_ENABLE */
@@ -0,0 +1,264 @@
+/**
+ * @file    Governor.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Wählt das Taktprofil zur Laufzeit nach Auslastung und Rückstau
+ *
+ * Die meiste Zeit schläft der Kern im Leerlauf des Schedulers, Last gibt es in Schüben beim
+ * Zeichnen, Dekodieren und im Messbetrieb. Der Governor wertet alle GOVERNOR_WINDOW_MS in einem
+ * Callback von Timer.c aus:
+ * - Last: Anteil der Takte außerhalb von Scheduler_Idle() im Fenster (Scheduler_GetIdleCycles())
+ * - Rückstau: verpasste Deadlines der mit Governor_WatchTask() beobachteten Tasks (UI, DSP) und
+ *   ADC-Blöcke, die der DSP nicht mehr abnehmen konnte (Dsp_GetSkipped())
+ * Rückstau springt sofort auf CLOCK_PROFILE_MAX, Last über GOVERNOR_UP_PERMILLE schaltet eine
+ * Stufe höher. Herunter geht es eine Stufe, wenn die Last auf das kleinere Profil umgerechnet
+ * (Last * f_jetzt / f_kleiner) GOVERNOR_DOWN_HOLD Fenster in Folge unter GOVERNOR_DOWN_PERMILLE
+ * bleibt; der Abstand zur oberen Schwelle verhindert Pendeln.
+ *
+ * Die Umschaltung selbst macht Clock_SetProfile(). Die Kerneltakte von SPI1 und SDMMC1 (PLL1Q)
+ * und der Takt am W25Qxx (OCTOSPI-Vorteiler je Profil) bleiben dabei gleich, PCLK1 und damit
+ * I2C bleibt bei 32-36 MHz. Nur während der wenigen Mikrosekunden vom HSI bekommen SPI1 und
+ * SDMMC1 keinen Takt: der Governor schaltet deshalb nur, wenn Display, OLED, Matrix, WS2812,
+ * beide I2C-Busse und der ESP-Link ruhen, sonst wird es im nächsten Fenster erneut versucht (deferred).
+ * SD-Zugriffe laufen synchron im SDQueue-Task und können den Timer-Task nicht überlappen.
+ *
+ * Obergrenze: Governor_SetCeiling() (Thermal.c bei Übertemperatur) begrenzt das Zielprofil. Liegt
+ * das aktive Profil darüber, schaltet der Governor auch dann herunter, wenn er abgeschaltet ist;
+ * nur die Auswertung der Last ruht dann.
+ *
+ * Statistik: Wechsel je Zielprofil, Dauer jeder Umschaltung (Timebase_Us32()) und Zeit je
+ * Profil. Mit 'clock' von Hand gesetzte Profile schalten den Governor ab ('gov on' wieder an).
+ */
+
+#include "Governor.h"
+
+#if GOVERNOR_ENABLE
+
+#include "Scheduler.h"
+#include "Timer.h"
+#include "Timebase.h"
+#include "Canvas.h"
+#include "ILI9341.h"
+#include "SSD1306.h"
+#include "LED_Matrix.h"
+#include "WS2812.h"
+#include "I2CBus.h"
+#include "EspLink.h"
+#include "Dsp.h"
+#include "Log.h"
+#include <stdio.h>
+
+static Timer Governor_Timer;
+static uint8_t Governor_Enabled = 0;
+static Clock_Profile Governor_Ceiling = CLOCK_PROFILE_MAX;
+static Governor_Stats Governor_Statistics;
+
+static uint8_t Governor_Watched[GOVERNOR_WATCH_COUNT];
+static uint32_t Governor_WatchedOverruns[GOVERNOR_WATCH_COUNT];
+static uint8_t Governor_WatchCount = 0;
+
+/* Beginn des laufenden Fensters */
+static uint32_t Governor_WindowCycle = 0;
+static uint32_t Governor_WindowIdle = 0;
+static uint32_t Governor_WindowTick = 0;
+static uint32_t Governor_DspSkipped = 0;
+static uint8_t Governor_LowCount = 0;
+
+static void Governor_Tick(void *context);
+static uint8_t Governor_Pressure(void);
+static uint8_t Governor_Quiet(void);
+static void Governor_Switch(Clock_Profile profile);
+static void Governor_StartWindow(void);
+
+/**
+ * @brief  Startet die Auswertung im Takt GOVERNOR_WINDOW_MS (nach Timer_Init())
+ */
+void Governor_Init(void) {
+	Timer_Setup(&Governor_Timer, "Governor", Governor_Tick, NULL);
+	Governor_ResetStats();
+	Governor_SetEnabled(1);
+	Timer_Start(&Governor_Timer, GOVERNOR_WINDOW_MS, GOVERNOR_WINDOW_MS);
+}
+
+/**
+ * @brief  Schaltet die Auswertung ein oder aus; das gerade aktive Profil bleibt stehen, solange es
+ *         unter der Obergrenze liegt
+ */
+void Governor_SetEnabled(uint8_t enabled) {
+	Governor_Enabled = enabled ? 1 : 0;
+	Governor_LowCount = 0;
+}
+
+uint8_t Governor_IsEnabled(void) {
+	return Governor_Enabled;
+}
+
+/**
+ * @brief  Beobachtet die Deadlines eines Tasks als Rückstau
+ * @retval taskId unverändert, damit sich der Aufruf um Scheduler_AddTask() legen lässt
+ */
+uint8_t Governor_WatchTask(uint8_t taskId) {
+	if (taskId < Scheduler_GetTaskCount() && Governor_WatchCount < GOVERNOR_WATCH_COUNT) {
+		Governor_Watched[Governor_WatchCount] = taskId;
+		Governor_WatchedOverruns[Governor_WatchCount] = Scheduler_Tasks[taskId].overruns;
+		Governor_WatchCount++;
+	}
+	return taskId;
+}
+
+/**
+ * @brief  Höchstes Profil, das der Governor wählt; ein höheres aktives Profil wird im nächsten
+ *         ruhigen Fenster heruntergeschaltet
+ */
+void Governor_SetCeiling(Clock_Profile ceiling) {
+	Governor_Ceiling = ceiling < CLOCK_PROFILE_COUNT ? ceiling : CLOCK_PROFILE_MAX;
+}
+
+Clock_Profile Governor_GetCeiling(void) {
+	return Governor_Ceiling;
+}
+
+const Governor_Stats* Governor_GetStats(void) {
+	return &Governor_Statistics;
+}
+
+void Governor_ResetStats(void) {
+	Governor_Statistics = (Governor_Stats){0};
+	Governor_WindowTick = HAL_GetTick();
+}
+
+/**
+ * @brief  Zustand, Wechsel und Zeit je Profil über printf
+ */
+void Governor_Dump(void) {
+	const Governor_Stats *s = &Governor_Statistics;
+	uint64_t totalMs = 0;
+
+	for (uint8_t i = 0; i < CLOCK_PROFILE_COUNT; i++)
+		totalMs += s->timeMs[i];
+	printf("Governor %s, Profil %s, Last %lu.%lu %% im letzten Fenster (%lu Fenster)\n",
+			Governor_Enabled ? "an" : "aus", Clock_GetProfileInfo()->name, s->lastLoad / 10, s->lastLoad % 10,
+			s->windows);
+	if (Governor_Ceiling != CLOCK_PROFILE_MAX)
+		printf("  Obergrenze %s, %lu Fenster begrenzt\n", Clock_Profiles[Governor_Ceiling].name, s->capped);
+	for (uint8_t i = 0; i < CLOCK_PROFILE_COUNT; i++) {
+		uint32_t permille = totalMs ? (uint32_t)(s->timeMs[i] * 1000U / totalMs) : 0;
+		printf("  %-18s %8lu ms %3lu.%lu %%, %lu Wechsel hierher\n", Clock_Profiles[i].name,
+				(uint32_t)s->timeMs[i], permille / 10, permille % 10, s->switches[i]);
+	}
+	uint32_t count = 0;
+	for (uint8_t i = 0; i < CLOCK_PROFILE_COUNT; i++)
+		count += s->switches[i];
+	printf("  Umschaltung: zuletzt %lu us, mittel %lu us, max %lu us; Rückstau %lu, aufgeschoben %lu, fehlgeschlagen %lu\n",
+			s->lastSwitchUs, count ? (uint32_t)(s->sumSwitchUs / count) : 0, s->maxSwitchUs, s->bursts,
+			s->deferred, s->failed);
+}
+
+/**
+ * @brief  Timer-Callback: Fenster auswerten und ggf. umschalten
+ */
+static void Governor_Tick(void *context) {
+	Governor_Stats *s = &Governor_Statistics;
+	Clock_Profile current = Clock_GetProfile();
+	uint32_t now = HAL_GetTick();
+	uint32_t cycles = DWT->CYCCNT - Governor_WindowCycle;
+	uint32_t idle = Scheduler_GetIdleCycles() - Governor_WindowIdle;
+
+	s->timeMs[current] += now - Governor_WindowTick;
+	s->windows++;
+	if (idle > cycles) idle = cycles;
+	uint32_t load = cycles ? (uint32_t)((uint64_t)(cycles - idle) * 1000U / cycles) : 0;
+	s->lastLoad = load;
+
+	Clock_Profile target = current;
+	uint8_t pressure = Governor_Pressure();
+	if (!Governor_Enabled) {
+		Governor_LowCount = 0;
+	} else if (pressure) {
+		target = CLOCK_PROFILE_MAX;
+		if (target != current) s->bursts++;
+		Governor_LowCount = 0;
+	} else if (load > GOVERNOR_UP_PERMILLE) {
+		if (current + 1 < CLOCK_PROFILE_COUNT) target = (Clock_Profile)(current + 1);
+		Governor_LowCount = 0;
+	} else if (current > CLOCK_PROFILE_LOW_POWER) {
+		// Same work on the slower clock takes proportionally longer
+		uint32_t lower = (uint32_t)((uint64_t)load * Clock_Profiles[current].sysclkHz
+				/ Clock_Profiles[current - 1].sysclkHz);
+		Governor_LowCount = lower < GOVERNOR_DOWN_PERMILLE ? Governor_LowCount + 1 : 0;
+		if (Governor_LowCount >= GOVERNOR_DOWN_HOLD) target = (Clock_Profile)(current - 1);
+	}
+
+	if (target > Governor_Ceiling) {
+		if (target > current) s->capped++;
+		target = Governor_Ceiling;
+	}
+
+	if (target != current) {
+		if (Governor_Quiet()) {
+			Governor_Switch(target);
+			Governor_LowCount = 0;
+		} else {
+			s->deferred++;
+		}
+	}
+	Governor_StartWindow();
+}
+
+/**
+ * @brief  Neue verpasste Deadlines der beobachteten Tasks oder verworfene ADC-Blöcke seit dem letzten Fenster
+ */
+static uint8_t Governor_Pressure(void) {
+	uint8_t pressure = 0;
+
+	for (uint8_t i = 0; i < Governor_WatchCount; i++) {
+		uint32_t overruns = Scheduler_Tasks[Governor_Watched[i]].overruns;
+		// Scheduler_ResetStats() sets the counter back to zero, that is not pressure
+		if (overruns > Governor_WatchedOverruns[i]) pressure = 1;
+		Governor_WatchedOverruns[i] = overruns;
+	}
+
+	uint32_t skipped = Dsp_GetSkipped();
+	if (skipped != Governor_DspSkipped) pressure = 1;
+	Governor_DspSkipped = skipped;
+	return pressure;
+}
+
+/**
+ * @brief  Läuft kein Transfer, dessen Takt sich beim Umschalten ändert oder kurz ausfällt?
+ */
+static uint8_t Governor_Quiet(void) {
+	return !ILI9341_IsBusy() && Canvas_FrameIsDone() && !ssd1306_IsBusy() && !LED_Matrix_is_busy()
+			&& !WS2812_IsBusy() && I2CBus_IsIdle(&I2CBus_1) && I2CBus_IsIdle(&I2CBus_2)
+			&& !EspLink_IsBusy();
+}
+
+static void Governor_Switch(Clock_Profile profile) {
+	Governor_Stats *s = &Governor_Statistics;
+
+	// TIM5 runs a few µs with the old prescaler, the duration is good to about that
+	uint32_t start = Timebase_Us32();
+	uint8_t ok = Clock_SetProfile(profile);
+	uint32_t us = Timebase_Us32() - start;
+
+	if (!ok) {
+		s->failed++;
+		LOG("Governor: Umschaltung auf %s fehlgeschlagen\n", Clock_Profiles[profile].name);
+		return;
+	}
+	s->switches[profile]++;
+	s->lastSwitchUs = us;
+	s->sumSwitchUs += us;
+	if (us > s->maxSwitchUs) s->maxSwitchUs = us;
+}
+
+/**
+ * @brief  Neues Messfenster; nach einer Umschaltung zählt DWT mit dem neuen Takt
+ */
+static void Governor_StartWindow(void) {
+	Governor_WindowCycle = DWT->CYCCNT;
+	Governor_WindowIdle = Scheduler_GetIdleCycles();
+	Governor_WindowTick = HAL_GetTick();
+}
+
+#endif /* GOVERNOR_ENABLE */
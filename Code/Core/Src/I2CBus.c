@@ -0,0 +1,304 @@
+/**
+ * @file    I2CBus.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Warteschlange für I2C-Transaktionen je Bus, abgearbeitet per Interrupt bzw. DMA
+ *
+ * Jeder Treiber auf einem Bus reiht seine Transfers (Adresse, Register, Puffer, Callback)
+ * mit I2CBus_Submit() bzw. den Kurzformen ein, statt selbst die HAL aufzurufen. Ist der
+ * Bus frei, startet die Transaktion sofort; sonst startet der Abschluss-Interrupt der
+ * vorigen direkt die nächste. Damit laufen Transfers verschiedener Geräte ohne Lücke
+ * hintereinander und kein Treiber bekommt mehr HAL_BUSY, weil ein anderer gerade sendet.
+ *
+ * Schreibzugriffe ab I2CBUS_DMA_THRESHOLD Bytes laufen per DMA, wenn am Handle ein
+ * TX-DMA-Kanal hängt (I2C1 für das SSD1306), alles andere per Interrupt.
+ *
+ * I2CBus_Init() setzt die Busgeschwindigkeit. Die Timing-Werte gelten für 32 MHz I2C-Takt
+ * (PCLK1, siehe Clock.c) und stammen aus dem Timing-Rechner von CubeMX. Für 1 MHz wird
+ * zusätzlich der Fast-mode-Plus-Treiber der Pins eingeschaltet.
+ *
+ * Die HAL-Callbacks in main.c leiten an I2CBus_CompleteCallback() bzw. I2CBus_ErrorCallback()
+ * weiter. Die Callbacks der Transaktionen laufen im Interrupt und müssen kurz bleiben.
+ */
+
+#include "I2CBus.h"
+
+// TIMINGR for I2CCLK = 32 MHz, analog filter on, rise/fall time 0
+#define I2CBUS_TIMING_STANDARD    0x00707CBB
+#define I2CBUS_TIMING_FAST        0x00300F38
+#define I2CBUS_TIMING_FAST_PLUS   0x00100413
+
+I2CBus I2CBus_1;
+I2CBus I2CBus_2;
+
+static I2CBus *I2CBus_Find(I2C_HandleTypeDef *hi2c);
+static void I2CBus_StartNext(I2CBus *bus);
+static HAL_StatusTypeDef I2CBus_Start(I2CBus *bus, I2CBus_Transaction *t);
+static void I2CBus_Finish(I2CBus *bus, uint8_t ok);
+static void I2CBus_Complete(I2CBus *bus, uint8_t ok);
+
+/**
+ * @brief  Ordnet einem I2C-Handle einen Bus zu und stellt die Geschwindigkeit ein
+ * @param  bus: I2CBus_1 oder I2CBus_2
+ * @param  hi2c: bereits mit MX_I2Cx_Init() initialisiertes Handle
+ * @param  speedHz: I2CBUS_SPEED_STANDARD, _FAST oder _FAST_PLUS
+ */
+void I2CBus_Init(I2CBus *bus, I2C_HandleTypeDef *hi2c, uint32_t speedHz) {
+	uint32_t timing;
+
+	bus->hi2c = hi2c;
+	bus->head = 0;
+	bus->count = 0;
+	bus->active = 0;
+	bus->transactions = 0;
+	bus->errors = 0;
+	bus->rejected = 0;
+
+	if (speedHz >= I2CBUS_SPEED_FAST_PLUS) {
+		timing = I2CBUS_TIMING_FAST_PLUS;
+		speedHz = I2CBUS_SPEED_FAST_PLUS;
+	}
+	else if (speedHz >= I2CBUS_SPEED_FAST) {
+		timing = I2CBUS_TIMING_FAST;
+		speedHz = I2CBUS_SPEED_FAST;
+	}
+	else {
+		timing = I2CBUS_TIMING_STANDARD;
+		speedHz = I2CBUS_SPEED_STANDARD;
+	}
+	bus->speedHz = speedHz;
+
+	// TIMINGR may only be written while the peripheral is disabled
+	__HAL_I2C_DISABLE(hi2c);
+	hi2c->Init.Timing = timing;
+	hi2c->Instance->TIMINGR = timing;
+	__HAL_I2C_ENABLE(hi2c);
+
+	if (speedHz == I2CBUS_SPEED_FAST_PLUS) {
+		if (hi2c->Instance == I2C1)
+			HAL_I2CEx_EnableFastModePlus(I2C_FASTMODEPLUS_I2C1);
+		else if (hi2c->Instance == I2C2)
+			HAL_I2CEx_EnableFastModePlus(I2C_FASTMODEPLUS_I2C2);
+	}
+}
+
+/**
+ * @brief  Reiht eine Transaktion ein und startet sie, falls der Bus frei ist
+ * @param  transaction: wird kopiert; der Datenpuffer muss bis zum Callback gültig bleiben
+ * @retval 1, wenn eingereiht, 0 wenn die Warteschlange voll ist
+ */
+uint8_t I2CBus_Submit(I2CBus *bus, const I2CBus_Transaction *transaction) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (bus->count >= I2CBUS_QUEUE_DEPTH) {
+		bus->rejected++;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+
+	bus->queue[(bus->head + bus->count) % I2CBUS_QUEUE_DEPTH] = *transaction;
+	bus->count++;
+
+	if (!bus->active)
+		I2CBus_StartNext(bus);
+
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+/**
+ * @brief  Kurzform: Daten an ein Gerät senden
+ */
+uint8_t I2CBus_Write(I2CBus *bus, uint16_t address, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context) {
+	I2CBus_Transaction t = { I2CBUS_WRITE, address, 0, 0, data, length, callback, context };
+	return I2CBus_Submit(bus, &t);
+}
+
+/**
+ * @brief  Kurzform: Daten von einem Gerät lesen
+ */
+uint8_t I2CBus_Read(I2CBus *bus, uint16_t address, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context) {
+	I2CBus_Transaction t = { I2CBUS_READ, address, 0, 0, data, length, callback, context };
+	return I2CBus_Submit(bus, &t);
+}
+
+/**
+ * @brief  Kurzform: Register (bzw. Kontrollbyte) und Daten senden
+ */
+uint8_t I2CBus_MemWrite(I2CBus *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context) {
+	I2CBus_Transaction t = { I2CBUS_MEM_WRITE, address, reg, 1, data, length, callback, context };
+	return I2CBus_Submit(bus, &t);
+}
+
+/**
+ * @brief  Kurzform: ab einem Register lesen
+ */
+uint8_t I2CBus_MemRead(I2CBus *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t length,
+		I2CBus_Callback callback, void *context) {
+	I2CBus_Transaction t = { I2CBUS_MEM_READ, address, reg, 1, data, length, callback, context };
+	return I2CBus_Submit(bus, &t);
+}
+
+/**
+ * @brief  Gibt an, ob keine Transaktion läuft oder wartet
+ */
+uint8_t I2CBus_IsIdle(I2CBus *bus) {
+	return bus->count == 0;
+}
+
+/**
+ * @brief  Wartet, bis die Warteschlange leer ist (vor blockierenden HAL-Zugriffen)
+ * @retval 1, wenn der Bus frei ist, 0 nach Ablauf von timeoutMs
+ */
+uint8_t I2CBus_WaitIdle(I2CBus *bus, uint32_t timeoutMs) {
+	uint32_t start = HAL_GetTick();
+
+	while (!I2CBus_IsIdle(bus)) {
+		if (HAL_GetTick() - start >= timeoutMs)
+			return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief  Belegt den freien Bus für einen Zugriff an der HAL vorbei (BusFast_I2CMemWrite())
+ * @retval 1, wenn nichts lief oder wartete; bis I2CBus_Release() eingereihte Transaktionen warten
+ */
+uint8_t I2CBus_Claim(I2CBus *bus) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (bus->count > 0 || bus->active) {
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	bus->active = 1;
+
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+/**
+ * @brief  Gibt einen mit I2CBus_Claim() belegten Bus frei und startet, was inzwischen eingereiht wurde
+ */
+void I2CBus_Release(I2CBus *bus) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	bus->active = 0;
+	I2CBus_StartNext(bus);
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Aus den Tx/Rx-Complete-Callbacks der HAL aufrufen
+ */
+void I2CBus_CompleteCallback(I2C_HandleTypeDef *hi2c) {
+	I2CBus *bus = I2CBus_Find(hi2c);
+	if (bus != NULL && bus->active)
+		I2CBus_Finish(bus, 1);
+}
+
+/**
+ * @brief  Aus HAL_I2C_ErrorCallback() und HAL_I2C_AbortCpltCallback() aufrufen
+ */
+void I2CBus_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+	I2CBus *bus = I2CBus_Find(hi2c);
+	if (bus != NULL && bus->active) {
+		bus->errors++;
+		I2CBus_Finish(bus, 0);
+	}
+}
+
+/**
+ * @brief  Sucht den Bus zu einem Handle
+ */
+static I2CBus *I2CBus_Find(I2C_HandleTypeDef *hi2c) {
+	if (I2CBus_1.hi2c == hi2c) return &I2CBus_1;
+	if (I2CBus_2.hi2c == hi2c) return &I2CBus_2;
+	return NULL;
+}
+
+/**
+ * @brief  Meldet die laufende Transaktion und startet die nächste
+ */
+static void I2CBus_Finish(I2CBus *bus, uint8_t ok) {
+	I2CBus_Complete(bus, ok);
+
+	if (!bus->active)
+		I2CBus_StartNext(bus);
+}
+
+/**
+ * @brief  Entfernt die laufende Transaktion aus der Warteschlange und ruft ihren Callback auf
+ */
+static void I2CBus_Complete(I2CBus *bus, uint8_t ok) {
+	I2CBus_Transaction *t = &bus->queue[bus->head];
+	I2CBus_Callback callback = t->callback;
+	void *context = t->context;
+
+	bus->transactions++;
+	bus->head = (bus->head + 1) % I2CBUS_QUEUE_DEPTH;
+	bus->count--;
+	bus->active = 0;
+
+	// The callback may submit again; it is queued behind what is already waiting
+	if (callback != NULL)
+		callback(ok, context);
+}
+
+/**
+ * @brief  Startet die erste wartende Transaktion; Startfehler werden sofort gemeldet
+ *
+ * Wird mit gesperrten Interrupts oder aus dem Interrupt des Busses aufgerufen.
+ */
+static void I2CBus_StartNext(I2CBus *bus) {
+	while (bus->count > 0) {
+		I2CBus_Transaction *t = &bus->queue[bus->head];
+
+		bus->active = 1;
+		if (I2CBus_Start(bus, t) == HAL_OK)
+			return;
+
+		bus->errors++;
+		I2CBus_Complete(bus, 0);
+		if (bus->active)
+			return;
+	}
+}
+
+/**
+ * @brief  Übergibt eine Transaktion an die HAL
+ */
+static HAL_StatusTypeDef I2CBus_Start(I2CBus *bus, I2CBus_Transaction *t) {
+	I2C_HandleTypeDef *hi2c = bus->hi2c;
+	uint16_t regSize = t->regSize == 2 ? I2C_MEMADD_SIZE_16BIT : I2C_MEMADD_SIZE_8BIT;
+	uint8_t useDma = hi2c->hdmatx != NULL && t->length >= I2CBUS_DMA_THRESHOLD;
+
+	switch (t->op) {
+		case I2CBUS_WRITE:
+			if (useDma)
+				return HAL_I2C_Master_Transmit_DMA(hi2c, t->address, t->data, t->length);
+			return HAL_I2C_Master_Transmit_IT(hi2c, t->address, t->data, t->length);
+
+		case I2CBUS_READ:
+			return HAL_I2C_Master_Receive_IT(hi2c, t->address, t->data, t->length);
+
+		case I2CBUS_MEM_WRITE:
+			if (useDma)
+				return HAL_I2C_Mem_Write_DMA(hi2c, t->address, t->reg, regSize, t->data, t->length);
+			return HAL_I2C_Mem_Write_IT(hi2c, t->address, t->reg, regSize, t->data, t->length);
+
+		case I2CBUS_MEM_READ:
+			return HAL_I2C_Mem_Read_IT(hi2c, t->address, t->reg, regSize, t->data, t->length);
+
+		default:
+			return HAL_ERROR;
+	}
+}
@@ -19,34 +19,100 @@
 #include "main.h"
 #include <ILI9341.h>
 #include <math.h>
+#include <string.h>
 
 #include "ff.h"
 #include "Fonts/5x5_font.h"
 #include "stdio.h"
 #include "ILI9341_InitFunctions.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_Tile.h"
+#include "ILI9341_Colour.h"
 #include "SDCard.h"
+#include "FastSeek.h"
+#include "Cache.h"
+#include "Pool.h"
+#include "BusStat.h"
+#include "BusFast.h"
 
 // Konstanten und globale Variablen
 #define CHUNK_SIZE_IN  ((uint32_t)(64 * 1024))
 #define CHUNK_SIZE_OUT ((uint32_t)(64 * 1024))
 
+/* Befehl oder Daten für BusStat nach dem aktuellen Pegel von D/C (Batch-Wiedergabe) */
+#define ILI9341_BUS_KIND() (Pin_IsHigh(ILI9341_DC_PIN) ? BUSSTAT_DATA : BUSSTAT_COMMAND)
+
 int16_t cursor_x, cursor_y;
 uint16_t textcolor, textbgcolor;
 
 
 SPI_HandleTypeDef* ILI9341_SPI;
 
-GPIO_TypeDef* ILI9341_CS_Port;
-uint16_t ILI9341_CS_Pin;
-
-GPIO_TypeDef* ILI9341_DC_Port;
-uint16_t ILI9341_DC_Pin;
-
 GPIO_TypeDef* ILI9341_Reset_Port;
 uint16_t ILI9341_Reset_Pin;
 
+#ifndef ILI9341_FIXED_ORIENTATION
 uint16_t ILI9341_WIDTH = 240;
 uint16_t ILI9341_HEIGHT = 320;
+#endif
+uint8_t ILI9341_MemoryAccess = 0x08;	// Zuletzt gesetztes MADCTL (0x36)
+
+const ILI9341_t3_font_t *font = NULL;
+
+// Zustand der asynchronen DMA-Übertragung
+volatile uint8_t ILI9341_TxBusy FASTDATA = 0;
+const uint8_t* ILI9341_TxPtr FASTDATA;
+volatile uint32_t ILI9341_TxRemaining FASTDATA = 0;
+ILI9341_TransferCompleteCallback ILI9341_TxCallback FASTDATA = NULL;
+
+// Befehlspause nach Sleep In/Out (ILI9341_HoldBus): ILI9341_HoldMs ab ILI9341_HoldStart sendet niemand
+uint32_t ILI9341_HoldStart = 0;
+volatile uint32_t ILI9341_HoldMs = 0;
+
+// Ende des Hardware-Resets; bis ILI9341_EndInit() ist das Panel im Sleep-Modus
+uint32_t ILI9341_ResetTick = 0;
+uint8_t ILI9341_InitPending = 0;
+
+// Laufendes Rücklesen per RX-DMA (ILI9341_ReadPixelsAsync), belegt den Bus wie eine Übertragung über ILI9341_TxBusy
+volatile uint8_t ILI9341_RxActive = 0;
+ILI9341_TransferCompleteCallback ILI9341_RxCallback = NULL;
+
+// Puffer für ILI9341_DrawBinaryFileRegion: SD liest in den einen, während DMA den anderen sendet
+uint8_t ILI9341_FileBuffer[2][ILI9341_FILE_CHUNK_SIZE] AXI_BUFFER;
+
+// Ping-Pong-Zeilenpuffer: Die CPU füllt einen Puffer, während DMA den anderen überträgt (nicht cachebar)
+uint8_t ILI9341_LineBuffer[2][ILI9341_LINE_BUFFER_SIZE] DMA_BUFFER;
+uint8_t ILI9341_LineBufferIndex = 0;
+volatile uint8_t ILI9341_StreamActive = 0;
+
+// Aktuelle SPI-Framegröße: 0 = 8 Bit (Befehle, Byte-Puffer), 1 = 16 Bit (uint16_t-Pixel)
+uint8_t ILI9341_Frame16 = 0;
+
+// Befehlsliste: Ein Puffer wird aufgezeichnet, während der andere abgespielt wird
+uint8_t ILI9341_BatchBuffer[2][ILI9341_BATCH_BUFFER_SIZE] DMA_BUFFER;
+uint8_t ILI9341_BatchIndex = 0;
+uint32_t ILI9341_BatchLength = 0;
+uint8_t ILI9341_BatchRecording = 0;
+uint8_t ILI9341_BatchSuspended = 0;	// Ein Stream hat die Aufzeichnung unterbrochen
+
+// Zustand der Wiedergabe (wird aus dem SPI-Interrupt fortgesetzt)
+volatile uint8_t ILI9341_BatchReplaying = 0;
+const uint8_t *ILI9341_BatchReplayBuffer;
+uint32_t ILI9341_BatchReplayLength;
+uint32_t ILI9341_BatchReplayPos;
+const uint8_t *ILI9341_BatchParams;
+uint8_t ILI9341_BatchParamCount;
+uint32_t ILI9341_BatchFillRemaining;	// Pixel
+const uint8_t *ILI9341_BatchRowsData;	// Zeilen eines Verweises (ILI9341_SendRowsAsync)
+uint16_t ILI9341_BatchRowsBytes;
+uint16_t ILI9341_BatchRowsStride;
+uint16_t ILI9341_BatchRowsRemaining;
+uint8_t ILI9341_BatchFillBuffer[ILI9341_LINE_BUFFER_SIZE] DMA_BUFFER;
+
+// Zuletzt gesendetes Adressfenster (0x2A/0x2B), um unveränderte Hälften nicht erneut zu senden
+uint16_t ILI9341_WinX1, ILI9341_WinX2, ILI9341_WinY1, ILI9341_WinY2;
+uint8_t ILI9341_ColumnValid = 0;
+uint8_t ILI9341_PageValid = 0;
 
 #ifdef USE_JPEG_ENCODING
 extern __IO uint32_t Jpeg_HWDecodingEnd;
@@ -55,6 +121,22 @@ extern __IO uint32_t Jpeg_HWDecodingEnd;
 
 
 void SecretCommand();
+static void ILI9341_StreamColour(uint16_t Colour, uint32_t Size);
+static void ILI9341_SetFrameSize16(uint8_t enable);
+static void ILI9341_SetReadClock(uint8_t enable);
+static void ILI9341_ReadFinish();
+static uint8_t ILI9341_IsHeld();
+static void ILI9341_WriteCommandInline(uint8_t cmd, const uint8_t *Params, uint8_t pSize);
+static void ILI9341_WriteWindowInline(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2);
+static uint8_t ILI9341_BatchSuspend();
+static void ILI9341_BatchResume(uint8_t suspended);
+static void ILI9341_BatchRecordCommand(uint8_t cmd, const uint8_t *Params, uint8_t pSize);
+static uint8_t ILI9341_BatchRecordData(const uint8_t *Data, uint32_t pSize);
+static void ILI9341_BatchNextSegment();
+static uint8_t ILI9341_ApplySize(uint16_t width, uint16_t height);
+static void ILI9341_FillWindow(int16_t x, int16_t y, int32_t w, int32_t h, uint16_t color);
+static void ILI9341_DrawImageRows(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *image, uint32_t stride,
+		uint8_t swap);
 
 // Hilfsfunktionen
 static uint32_t fetchbits_unsigned(const uint8_t *p, uint32_t index, uint32_t required)
@@ -84,1024 +166,3686 @@ static inline uint32_t fetchbit(const uint8_t *p, uint32_t index)
 	return (p[index >> 3] & (0x80 >> (index & 7)));
 }
 
+static int32_t fetchbits_signed(const uint8_t *p, uint32_t index, uint32_t required)
+{
+	uint32_t val = fetchbits_unsigned(p, index, required);
+	if (val & (1 << (required - 1))) {
+		return (int32_t)val - (1 << required);
+	}
+	return (int32_t)val;
+}
+
 
 // Funktionen zur Steuerung des Displays
 /**
  * Aktiviert das Display, indem der CS-Pin auf LOW gesetzt wird.
+ * Läuft noch eine asynchrone Übertragung, wird zuerst auf deren Ende gewartet,
+ * damit blockierende Aufrufe nie in einen laufenden DMA-Transfer hineinfunken.
  */
 void ILI9341_ChipSelect() {
-	HAL_GPIO_WritePin(ILI9341_CS_Port, ILI9341_CS_Pin, GPIO_PIN_RESET);
+	if (ILI9341_BatchRecording) return;	// Die Wiedergabe steuert CS selbst
+	ILI9341_WaitWhileBusy();
+	// Befehle und Byte-Puffer laufen immer mit 8-Bit-Frames, nur ein 16-Bit-Stream behält seinen Modus
+	if (!ILI9341_StreamActive) {
+		ILI9341_SetFrameSize16(0);
+	}
+	Pin_Low(ILI9341_CS_PIN);
 }
 
 /**
  * Deaktiviert das Display, indem der CS-Pin auf HIGH gesetzt wird.
  */
 void ILI9341_ChipDeselect() {
-	HAL_GPIO_WritePin(ILI9341_CS_Port, ILI9341_CS_Pin, GPIO_PIN_SET);
+	if (ILI9341_BatchRecording) return;
+	Pin_High(ILI9341_CS_PIN);
 }
 
 /**
- * Setzt das Display in den Befehlsmodus (D/CX-Pin auf LOW).
+ * @brief  Schaltet SPI und TX-DMA zwischen 8- und 16-Bit-Frames um.
+ *
+ * Im 16-Bit-Modus sendet die SPI jedes uint16_t MSB zuerst, ein RGB565-Wert in
+ * CPU-Byte-Reihenfolge kommt also ohne Tausch in der vom Display erwarteten Reihenfolge an.
+ * Jeder FIFO-Eintrag trägt ein ganzes Pixel und die FIFO-Schwelle steigt auf zwei Pixel.
+ * Darf nur aufgerufen werden, während keine Übertragung läuft (SPE ist dann aus).
+ *
+ * @param  enable 1 = 16-Bit-Frames, 0 = 8-Bit-Frames.
  */
-void ILI9341_SetCommand() {
-    HAL_GPIO_WritePin(ILI9341_DC_Port, ILI9341_DC_Pin, GPIO_PIN_RESET);
+static void ILI9341_SetFrameSize16(uint8_t enable) {
+#ifdef ILI9341_USE_16BIT_PIXELS
+	if (ILI9341_Frame16 == enable) return;
+
+	DMA_HandleTypeDef *hdma = ILI9341_SPI->hdmatx;
+
+	ILI9341_SPI->Init.DataSize = enable ? SPI_DATASIZE_16BIT : SPI_DATASIZE_8BIT;
+	ILI9341_SPI->Init.FifoThreshold = enable ? SPI_FIFO_THRESHOLD_02DATA : SPI_FIFO_THRESHOLD_01DATA;
+	hdma->Init.PeriphDataAlignment = enable ? DMA_PDATAALIGN_HALFWORD : DMA_PDATAALIGN_BYTE;
+	hdma->Init.MemDataAlignment = enable ? DMA_MDATAALIGN_HALFWORD : DMA_MDATAALIGN_BYTE;
+
+	__HAL_SPI_DISABLE(ILI9341_SPI);
+	MODIFY_REG(ILI9341_SPI->Instance->CFG1, SPI_CFG1_DSIZE | SPI_CFG1_FTHLV,
+			ILI9341_SPI->Init.DataSize | ILI9341_SPI->Init.FifoThreshold);
+	MODIFY_REG(((DMA_Stream_TypeDef*)hdma->Instance)->CR, DMA_SxCR_PSIZE | DMA_SxCR_MSIZE,
+			hdma->Init.PeriphDataAlignment | hdma->Init.MemDataAlignment);
+
+	ILI9341_Frame16 = enable;
+#else
+	(void)enable;
+#endif
 }
 
+/* --------------------------------- Asynchrone Übertragung (DMA) --------------------------------- */
+
 /**
- * Setzt das Display in den Datenmodus (D/CX-Pin auf HIGH).
+ * @brief  Startet den nächsten DMA-Block der laufenden asynchronen Übertragung.
+ *
+ * Ein einzelner HAL_SPI_Transmit_DMA-Aufruf kann höchstens ILI9341_DMA_MAX_CHUNK Bytes
+ * übertragen. Größere Puffer werden deshalb in mehrere Blöcke zerlegt, die nacheinander
+ * aus dem Completion-Interrupt heraus gestartet werden. CS bleibt dabei die ganze Zeit aktiv.
+ *
+ * @retval HAL_StatusTypeDef Status des DMA-Starts. Bei einem Fehler wird die Übertragung
+ *         abgebrochen und CS wieder freigegeben.
  */
-void ILI9341_SetData() {
-	//When DCX = ’1’, data is selected
-	/* If the D/CX bit is “high”, the transmission byte is stored as
-the display data RAM (Memory write command), or command register as parameter*/
-	HAL_GPIO_WritePin(ILI9341_DC_Port, ILI9341_DC_Pin, GPIO_PIN_SET);
+RAMFUNC static HAL_StatusTypeDef ILI9341_StartNextChunk() {
+	uint32_t chunk = ILI9341_TxRemaining;
+	if (chunk > ILI9341_DMA_MAX_CHUNK) {
+		chunk = ILI9341_DMA_MAX_CHUNK;
+	}
+
+	const uint8_t *ptr = ILI9341_TxPtr;
+	ILI9341_TxPtr += chunk;
+	ILI9341_TxRemaining -= chunk;
+
+	// Die HAL zählt in SPI-Frames, im 16-Bit-Modus also in Pixeln
+	uint16_t frames = ILI9341_Frame16 ? (uint16_t)(chunk / 2) : (uint16_t)chunk;
+
+	// Cacheable sources (framebuffer, file buffers, caller data) must reach SRAM before DMA reads them
+	Cache_CleanDMA(ptr, chunk);
+
+	HAL_StatusTypeDef status = HAL_SPI_Transmit_DMA(ILI9341_SPI, ptr, frames);
+	BUSSTAT_ASYNC(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, chunk);
+	if (status != HAL_OK) {
+		ILI9341_TxRemaining = 0;
+		Pin_High(ILI9341_CS_PIN);
+		ILI9341_TxBusy = 0;
+	}
+	return status;
 }
 
 /**
- * Initialisiert das ILI9341-Display.
- */
-/**
- * @brief  Initialisiert das ILI9341 Display
- * @param  DISPLAY_SPI:       SPI-Handler für die Kommunikation mit dem Display
- * @param  _ILI9341_CS_Port:  GPIO-Port für das Chip-Select-Signal
- * @param  _ILI9341_CS_Pin:   GPIO-Pin für das Chip-Select-Signal
- * @param  _ILI9341_DC_Port:  GPIO-Port für das Data/Command-Signal
- * @param  _ILI9341_DC_Pin:   GPIO-Pin für das Data/Command-Signal
- * @param  _ILI9341_Reset_Port: GPIO-Port für das Reset-Signal
- * @param  _ILI9341_Reset_Pin:  GPIO-Pin für das Reset-Signal
- * @retval None
+ * @brief  Sendet Daten per DMA an das ILI9341-Display, ohne auf das Ende der Übertragung zu warten.
  *
- * @note Diese Funktion führt folgende Initialisierungsschritte durch:
- *       1. Speichern der SPI- und GPIO-Konfigurationen
- *       2. Hardware-Reset des Displays
- *       3. SPI-Initialisierung
- *       4. Konfiguration der Display-Einstellungen
- *       5. Aktivierung des Displays
- *       6. Einstellung der Standard-Ausrichtung
+ * Diese Funktion führt folgende Schritte aus:
+ * 1. Wartet, bis eine eventuell noch laufende asynchrone Übertragung beendet ist.
+ * 2. Wählt das Display aus (CS-Pin auf LOW) und setzt den Datenmodus (D/CX-Pin auf HIGH).
+ * 3. Startet die DMA-Übertragung und kehrt sofort zurück.
+ *
+ * Das Freigeben von CS erfolgt im Completion-Interrupt (ILI9341_SPI_TxCpltCallback).
+ * Danach wird der mit ILI9341_SetTransferCompleteCallback() registrierte Callback aufgerufen.
+ *
+ * @param  Data  Zeiger auf den Puffer, der die zu sendenden Daten enthält.
+ * @param  pSize Anzahl der zu sendenden Bytes (darf größer als ILI9341_DMA_MAX_CHUNK sein).
+ * @retval HAL_StatusTypeDef Status des DMA-Starts.
+ *
+ * @note   Der Puffer muss bis zum Ende der Übertragung gültig bleiben und darf nicht
+ *         verändert werden (kein Stack-Puffer des Aufrufers!). Mit ILI9341_IsBusy()
+ *         bzw. ILI9341_WaitWhileBusy() kann das Ende abgefragt werden.
  */
-void ILI9341_begin(SPI_HandleTypeDef* DISPLAY_SPI, GPIO_TypeDef* _ILI9341_CS_Port,
-                   uint16_t _ILI9341_CS_Pin, GPIO_TypeDef* _ILI9341_DC_Port,
-                   uint16_t _ILI9341_DC_Pin, GPIO_TypeDef* _ILI9341_Reset_Port,
-                   uint16_t _ILI9341_Reset_Pin)
-{
-    /* GPIO und SPI-Handler speichern */
-    ILI9341_SPI = DISPLAY_SPI;
-    ILI9341_CS_Port = _ILI9341_CS_Port;
-    ILI9341_CS_Pin = _ILI9341_CS_Pin;
-    ILI9341_DC_Port = _ILI9341_DC_Port;
-    ILI9341_DC_Pin = _ILI9341_DC_Pin;
-    ILI9341_Reset_Port = _ILI9341_Reset_Port;
-    ILI9341_Reset_Pin = _ILI9341_Reset_Pin;
+HAL_StatusTypeDef ILI9341_SendDataAsync(const uint8_t *Data, uint32_t pSize) {
+	if (pSize == 0) {
+		return HAL_OK;
+	}
 
-    /* Hardware-Reset durchführen */
-    HAL_GPIO_WritePin(ILI9341_Reset_Port, ILI9341_Reset_Pin, GPIO_PIN_SET);
-    ILI9341_ChipSelect();
-    HAL_GPIO_WritePin(ILI9341_Reset_Port, ILI9341_Reset_Pin, GPIO_PIN_RESET);
-    HAL_Delay(200);  // Reset-Impuls für 200ms
-    ILI9341_ChipDeselect();
-    HAL_Delay(200);  // Warten nach Reset
-    HAL_GPIO_WritePin(ILI9341_Reset_Port, ILI9341_Reset_Pin, GPIO_PIN_SET);
+	// Kleine Blöcke (z.B. Glyphen) werden in die Befehlsliste kopiert
+	if (ILI9341_BatchRecordData(Data, pSize)) {
+		return HAL_OK;
+	}
+	uint8_t suspended = ILI9341_BatchSuspend();
 
-    /* SPI-Interface mit Dummy-Byte initialisieren */
-    uint8_t dummy_byte = 0b01010101;
-    ILI9341_ChipSelect();
-    HAL_SPI_Transmit(ILI9341_SPI, &dummy_byte, 1, 100);
-    ILI9341_ChipDeselect();
+	ILI9341_ChipSelect();
+	ILI9341_SetData();
 
-    /* Software-Reset senden */
-    ILI9341_SendCommand(0x01);  // Software Reset Kommando
-    HAL_Delay(150);             // Warten auf Reset-Abschluss
-
-    /* Display-Spezifische Einstellungen konfigurieren */
-    // Power-Management und Timing konfigurieren
-    Power_Control_A();          // Leistungssteuerung A
-    Power_Control_B();          // Leistungssteuerung B
-    DriverTimingControl_A();    // Treiber-Timing A
-    DriverTimingControl_B();    // Treiber-Timing B
-    Power_On_Sequence_Control(); // Einschaltsequenz-Steuerung
-    PumpRatioControl();         // Pumpen-Verhältnis-Steuerung
-
-    // Spannung und Stromversorgung konfigurieren
-    PowerControl_1();           // Leistungssteuerung 1
-    PowerControl_2();           // Leistungssteuerung 2
-    VCOM_Control_1();           // VCOM-Steuerung 1
-    VCOM_Control_2();           // VCOM-Steuerung 2
-
-    // Display-Funktionen konfigurieren
-    MemoryAccessControl();      // Speicherzugriffsteuerung
-    COLMOD_PixelFormatSet();    // Pixelformat einstellen (16 Bit pro Pixel)
-    FrameRateControl();         // Bildwiederholrate einstellen
-    DisplayFunctionControl();   // Display-Funktionssteuerung
-    Enable3G();                 // 3G-Funktion aktivieren
-
-    // Gamma-Korrektur konfigurieren
-    GammaSet();                 // Gamma-Kurve auswählen
-    PositiveGammaCorrection();  // Positive Gamma-Korrektur
-    NegativeGammaCorrection();  // Negative Gamma-Korrektur
-
-    // Display aktivieren
-    SleepOut();                 // Sleep-Modus beenden
-    ILI9341_DisplayOn();        // Display einschalten
+	ILI9341_TxPtr = Data;
+	ILI9341_TxRemaining = pSize;
+	ILI9341_TxBusy = 1;
 
-    /* Standard-Ausrichtung einstellen */
-    ILI9341_SetRotation(SCREEN_VERTICAL_2);  // Portrait-Modus (180° gedreht)
+	HAL_StatusTypeDef status = ILI9341_StartNextChunk();
+	ILI9341_BatchResume(suspended);
+	return status;
 }
 
+/**
+ * @brief  Gibt zurück, ob gerade eine asynchrone Übertragung zum Display läuft.
+ * @retval 1 wenn eine DMA-Übertragung aktiv ist, sonst 0.
+ */
+uint8_t ILI9341_IsBusy() {
+	return ILI9341_TxBusy || ILI9341_IsHeld();
+}
 
 /**
- * @brief  Sendet einen Befehl an das ILI9341-Display über die SPI-Schnittstelle.
- *
- * Diese Funktion wählt das Display aus, setzt es in den Befehlsmodus,
- * überträgt das Befehlsbyte und hebt anschließend die Auswahl des Displays auf.
- *
- * @param  cmd Das Befehlsbyte, das an das Display gesendet werden soll.
- * @retval HAL_StatusTypeDef Der Status der SPI-Übertragung (HAL_OK bei Erfolg,
- *         andernfalls ein Fehlercode).
+ * @brief  Wartet, bis eine laufende asynchrone Übertragung abgeschlossen ist
+ *         und eine mit ILI9341_HoldBus() gesetzte Befehlspause abgelaufen ist.
  */
-HAL_StatusTypeDef ILI9341_SendCommand(uint8_t cmd) {
+void ILI9341_WaitWhileBusy() {
+	if (!ILI9341_TxBusy && !ILI9341_IsHeld()) return;
 
-	ILI9341_ChipSelect(); // Wählt das Display aus
-	ILI9341_SetCommand(); // Setzt den Modus auf "Befehl"
+	BUSSTAT_WAIT_BEGIN(BUSSTAT_ID_ILI9341);
+	while (ILI9341_TxBusy || ILI9341_IsHeld()) {
+	}
+	BUSSTAT_WAIT_END(BUSSTAT_ID_ILI9341);
+}
 
-	HAL_StatusTypeDef status;
-	status = HAL_SPI_Transmit(ILI9341_SPI, &cmd, 1, 100); // Überträgt das Befehlsbyte
+/**
+ * @brief  Sperrt den Bus für ms Millisekunden, ohne zu blockieren.
+ *
+ * Nach Sleep In und Sleep Out verlangt das Datenblatt 5 ms ohne weitere Befehle. Statt eines
+ * HAL_Delay() meldet ILI9341_IsBusy() so lange 1; wer trotzdem zeichnet, wartet in
+ * ILI9341_ChipSelect() nur den Rest der Pause ab.
+ */
+void ILI9341_HoldBus(uint32_t ms) {
+	ILI9341_HoldStart = HAL_GetTick();
+	ILI9341_HoldMs = ms;
+}
 
-	ILI9341_ChipDeselect(); // Hebt die Auswahl des Displays auf
+/**
+ * @brief  Läuft noch eine Befehlspause? Ganze ms ab dem nächsten Tick, deshalb '>'.
+ */
+static uint8_t ILI9341_IsHeld() {
+	if (ILI9341_HoldMs == 0) return 0;
+	if (HAL_GetTick() - ILI9341_HoldStart > ILI9341_HoldMs) {
+		ILI9341_HoldMs = 0;
+		return 0;
+	}
+	return 1;
+}
 
-	return status; // Gibt den Status der Übertragung zurück
+/**
+ * @brief  Registriert einen Callback, der nach jeder abgeschlossenen asynchronen Übertragung aufgerufen wird.
+ * @param  callback Funktionszeiger oder NULL, um den Callback zu entfernen.
+ * @note   Der Callback läuft im Interrupt-Kontext und sollte entsprechend kurz sein.
+ */
+void ILI9341_SetTransferCompleteCallback(ILI9341_TransferCompleteCallback callback) {
+	ILI9341_TxCallback = callback;
 }
 
 /**
- * @brief  Empfängt ein einzelnes Byte vom ILI9341-Display über die SPI-Schnittstelle.
+ * @brief  Muss aus HAL_SPI_TxCpltCallback() aufgerufen werden.
  *
- * Diese Funktion wählt das Display aus, empfängt ein Byte und hebt anschließend die Auswahl des Displays auf.
- * Das empfangene Byte wird zurückgegeben.
+ * Startet den nächsten Block einer großen Übertragung oder beendet die Übertragung,
+ * indem CS freigegeben, das Busy-Flag gelöscht und der Anwender-Callback aufgerufen wird.
  *
- * @retval uint8_t Das empfangene Byte vom Display.
+ * @param  hspi SPI-Handler, der den Interrupt ausgelöst hat.
  */
-uint8_t ILI9341_ReceiveByte() {
-	ILI9341_ChipSelect(); // Wählt das Display aus
-	uint8_t data;
+RAMFUNC void ILI9341_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi != ILI9341_SPI || !ILI9341_TxBusy) {
+		return;
+	}
 
-	HAL_SPI_Receive(ILI9341_SPI, &data, 1, 100); // Empfängt ein Byte über SPI
+	if (ILI9341_BatchReplaying) {
+		ILI9341_BatchNextSegment();
+		return;
+	}
 
-	ILI9341_ChipDeselect(); // Hebt die Auswahl des Displays auf
+	if (ILI9341_TxRemaining > 0) {
+		ILI9341_StartNextChunk();
+		return;
+	}
 
-	return data; // Gibt das empfangene Byte zurück
+	// Während eines Streams bleibt CS aktiv, ILI9341_StreamEnd() gibt ihn frei
+	if (!ILI9341_StreamActive) {
+		Pin_High(ILI9341_CS_PIN);
+	}
+	ILI9341_TxBusy = 0;
+
+	if (ILI9341_TxCallback != NULL) {
+		ILI9341_TxCallback();
+	}
 }
 
 /**
- * @brief  Empfängt mehrere Bytes vom ILI9341-Display über die SPI-Schnittstelle.
+ * @brief  Muss aus HAL_SPI_ErrorCallback() aufgerufen werden.
  *
- * Diese Funktion wählt das Display aus, empfängt eine angegebene Anzahl von Bytes
- * und hebt anschließend die Auswahl des Displays auf. Der Status der SPI-Übertragung
- * wird zurückgegeben.
+ * Bricht eine laufende asynchrone Übertragung ab und gibt CS wieder frei,
+ * damit nachfolgende Aufrufe nicht ewig in ILI9341_WaitWhileBusy() hängen.
  *
- * @param  dataOut Zeiger auf den Puffer, in dem die empfangenen Daten gespeichert werden.
- * @param  pSize   Anzahl der zu empfangenden Bytes.
- * @retval HAL_StatusTypeDef Status der SPI-Übertragung (HAL_OK bei Erfolg,
- *         andernfalls ein Fehlercode).
+ * @param  hspi SPI-Handler, der den Fehler gemeldet hat.
  */
-HAL_StatusTypeDef ILI9341_ReceiveData(uint8_t *dataOut, uint8_t pSize) {
-	// Wählt das Display aus, indem der CS-Pin auf LOW gesetzt wird
-	ILI9341_ChipSelect();
+void ILI9341_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi != ILI9341_SPI || !ILI9341_TxBusy) {
+		return;
+	}
+	if (ILI9341_RxActive) {
+		ILI9341_ReadFinish();
+		return;
+	}
 
-	// Lokaler Puffer für die empfangenen Daten
-	uint8_t data[pSize];
+	ILI9341_TxRemaining = 0;
+	ILI9341_BatchReplaying = 0;
+	Pin_High(ILI9341_CS_PIN);
+	ILI9341_TxBusy = 0;
+}
 
-	// Führt die SPI-Datenübertragung aus und speichert den Status
-	HAL_StatusTypeDef status;
-	status = HAL_SPI_Receive(ILI9341_SPI, data, pSize, HAL_MAX_DELAY);
+/* --------------------------------- Rücklesen (Memory Read, DMA) --------------------------------- */
 
-	// Hebt die Auswahl des Displays auf, indem der CS-Pin auf HIGH gesetzt wird
-	ILI9341_ChipDeselect();
+/**
+ * @brief  Liest ein Fenster des Displayspeichers per DMA zurück (Memory Read, 0x2E).
+ *
+ * Über SPI antwortet das Panel unabhängig von COLMOD mit 18 Bit pro Pixel: je ein Byte R, G und B,
+ * der Farbwert steht in den oberen 6 Bits. Davor liegt ein Dummy-Byte. data muss deshalb
+ * 1 + Pixel * 3 Bytes fassen, das erste Pixel steht in data[1].
+ *
+ * Für die Dauer des Lesens läuft SPI1 mit ILI9341_READ_PRESCALER, danach wieder mit dem Teiler
+ * aus MX_SPI1_Init(). ILI9341_IsBusy() bleibt bis zum Ende gesetzt, blockierende Zeichenbefehle
+ * warten also wie bei ILI9341_SendDataAsync() in ILI9341_ChipSelect().
+ *
+ * @param  data     Zielpuffer, nicht cachebar (DMA_BUFFER) oder vom Aufrufer invalidiert.
+ * @param  size     1 + (X2 - X1 + 1) * (Y2 - Y1 + 1) * 3, höchstens ILI9341_DMA_MAX_CHUNK.
+ * @param  callback Läuft im Interrupt-Kontext nach dem letzten Byte, NULL = keiner.
+ * @retval HAL_ERROR ohne RX-DMA am SPI-Handle, während einer Aufzeichnung oder bei zu großem Fenster.
+ */
+HAL_StatusTypeDef ILI9341_ReadPixelsAsync(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2, uint8_t *data,
+		uint32_t size, ILI9341_TransferCompleteCallback callback) {
+	if (ILI9341_SPI->hdmarx == NULL || ILI9341_BatchRecording || size == 0 || size > ILI9341_DMA_MAX_CHUNK) {
+		return HAL_ERROR;
+	}
 
-	// Gibt den Status der SPI-Übertragung zurück
+	ILI9341_ChipSelect();
+	ILI9341_WriteWindowInline(X1, Y1, X2, Y2);
+	ILI9341_WriteCommandInline(0x2E, NULL, 0);
+
+	ILI9341_SetReadClock(1);
+	ILI9341_RxCallback = callback;
+	ILI9341_RxActive = 1;
+	ILI9341_TxBusy = 1;
+
+	HAL_StatusTypeDef status = HAL_SPI_Receive_DMA(ILI9341_SPI, data, (uint16_t)size);
+	BUSSTAT_ASYNC(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, size);
+	if (status != HAL_OK) {
+		ILI9341_ReadFinish();
+	}
 	return status;
 }
 
 /**
-  * @brief  Sendet einen Befehl an das ILI9341-Display und empfängt anschließend mehrere Datenbytes.
-  *
-  * Diese Funktion führt folgende Schritte aus:
-  * 1. Sendet ein Befehlsbyte an das Display über `ILI9341_SendCommand`.
-  * 2. Schaltet das Display in den Datenmodus mit `ILI9341_SetData`.
-  * 3. Empfängt die angegebene Anzahl von Datenbytes mit `ILI9341_ReceiveData`.
-  *
-  * @param  cmd     Das Befehlsbyte, das an das Display gesendet werden soll.
-  * @param  dataOut Zeiger auf den Puffer, in dem die empfangenen Daten gespeichert werden.
-  * @param  pSize   Anzahl der zu empfangenden Bytes.
-  * @retval HAL_StatusTypeDef Status der Operation:
-  *         - HAL_OK: Operation erfolgreich ausgeführt.
-  *         - Fehlercode: Wenn die Operation fehlschlägt.
-  */
- HAL_StatusTypeDef ILI9341_SendCommandAndReceive(uint8_t cmd, uint8_t *dataOut,
- 		uint8_t pSize) {
-
- 	HAL_StatusTypeDef status;
- 	status = ILI9341_SendCommand(cmd);
-
- 	ILI9341_SetData();
+ * @brief  Muss aus HAL_SPI_RxCpltCallback() aufgerufen werden.
+ *
+ * Beendet das Rücklesen: CS frei, Schreibtakt zurück, Busy-Flag löschen, Callback des Aufrufers.
+ */
+RAMFUNC void ILI9341_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi != ILI9341_SPI || !ILI9341_RxActive) {
+		return;
+	}
 
- 	status = ILI9341_ReceiveData(dataOut, pSize);
+	ILI9341_TransferCompleteCallback callback = ILI9341_RxCallback;
+	ILI9341_ReadFinish();
+	if (callback != NULL) {
+		callback();
+	}
+}
 
- 	return status;
- }
+/**
+ * @brief  Schaltet den SPI-Teiler zwischen Lese- und Schreibtakt um (SPE muss dafür aus sein).
+ */
+static void ILI9341_SetReadClock(uint8_t enable) {
+	__HAL_SPI_DISABLE(ILI9341_SPI);
+	MODIFY_REG(ILI9341_SPI->Instance->CFG1, SPI_CFG1_MBR,
+			enable ? ILI9341_READ_PRESCALER : ILI9341_SPI->Init.BaudRatePrescaler);
+}
 
+/**
+ * @brief  Gibt Bus und CS nach dem Rücklesen frei (auch nach einem Fehler).
+ */
+static void ILI9341_ReadFinish() {
+	ILI9341_SetReadClock(0);
+	Pin_High(ILI9341_CS_PIN);
+	ILI9341_RxActive = 0;
+	ILI9341_TxBusy = 0;
+}
 
+/* --------------------------------- Streaming (Ping-Pong-Zeilenpuffer) --------------------------------- */
 
 /**
- * @brief  Sendet einen Befehl an das ILI9341-Display gefolgt von 8-Bit-Parametern über die SPI-Schnittstelle.
+ * @brief  Beginnt eine Pixel-Übertragung über die Ping-Pong-Zeilenpuffer.
  *
- * Diese Funktion führt folgende Schritte aus:
- * 1. Wählt das Display aus (CS-Pin auf LOW).
- * 2. Setzt den Kommunikationsmodus auf Befehlsmodus (D/CX-Pin auf LOW).
- * 3. Überträgt das Befehlsbyte an das Display.
- * 4. Wechselt in den Datenmodus (D/CX-Pin auf HIGH).
- * 5. Überträgt die angegebenen Parameter an das Display.
- * 6. Deaktiviert die Auswahl des Displays (CS-Pin auf HIGH).
+ * Muss nach dem Setzen des Adressfensters und dem Memory-Write-Befehl (0x2C) aufgerufen werden.
+ * CS bleibt bis ILI9341_StreamEnd() aktiv, damit die einzelnen DMA-Blöcke ohne
+ * Unterbrechung hintereinander in den Displayspeicher geschrieben werden.
  *
- * @param  cmd    Das Befehlsbyte, das an das Display gesendet werden soll.
- * @param  Params Zeiger auf den Puffer mit den 8-Bit-Parametern, die gesendet werden sollen.
- * @param  pSize  Anzahl der zu sendenden Parameter (Bytes).
- * @retval HAL_StatusTypeDef Status der Operation (HAL_OK bei Erfolg, andernfalls ein Fehlercode).
+ * Typischer Ablauf:
+ * @code
+ * ILI9341_StreamBegin();
+ * while (...) {
+ *     uint8_t *buf = ILI9341_StreamGetBuffer();
+ *     // buf mit bis zu ILI9341_LINE_BUFFER_SIZE Bytes füllen
+ *     ILI9341_StreamSubmit(size);
+ * }
+ * ILI9341_StreamEnd();
+ * @endcode
  */
-HAL_StatusTypeDef ILI9341_SendCommandWithParam_8Bit(uint8_t cmd, uint8_t *Params,
-		uint8_t pSize) {
+void ILI9341_StreamBegin() {
+	// Große Pixelmengen laufen direkt, das bisher Aufgezeichnete wird vorher gesendet
+	ILI9341_BatchSuspended = ILI9341_BatchSuspend();
 	ILI9341_ChipSelect();
-
-	ILI9341_SetCommand();
-
-	HAL_StatusTypeDef status;
-	status = HAL_SPI_Transmit(ILI9341_SPI, &cmd, 1, 100);
-
 	ILI9341_SetData();
+	ILI9341_StreamActive = 1;
+}
 
-	status = HAL_SPI_Transmit(ILI9341_SPI, Params, pSize, HAL_MAX_DELAY);
-
-	ILI9341_ChipDeselect();
+/**
+ * @brief  Wie ILI9341_StreamBegin(), aber mit 16-Bit-SPI-Frames.
+ *
+ * Die Puffer enthalten dann RGB565-Pixel als uint16_t in CPU-Byte-Reihenfolge, die Größen
+ * für ILI9341_StreamSubmit() bleiben in Bytes. ILI9341_StreamEnd() und der nächste
+ * Befehl schalten automatisch auf 8 Bit zurück. Ohne ILI9341_USE_16BIT_PIXELS
+ * entspricht die Funktion ILI9341_StreamBegin().
+ */
+void ILI9341_StreamBegin16() {
+	ILI9341_StreamBegin();
+	ILI9341_SetFrameSize16(1);
+}
 
-	return status;
+/**
+ * @brief  Liefert den Zeilenpuffer, der gerade nicht von DMA übertragen wird.
+ *
+ * Es läuft immer höchstens eine DMA-Übertragung, und zwar aus dem zuletzt mit
+ * ILI9341_StreamSubmit() übergebenen Puffer. Der zurückgegebene Puffer ist daher
+ * sofort beschreibbar.
+ *
+ * @retval Zeiger auf einen Puffer mit ILI9341_LINE_BUFFER_SIZE Bytes.
+ */
+uint8_t* ILI9341_StreamGetBuffer() {
+	return ILI9341_LineBuffer[ILI9341_LineBufferIndex];
 }
 
 /**
- * @brief  Sendet einen Befehl an das ILI9341-Display gefolgt von 16-Bit-Parametern über die SPI-Schnittstelle.
+ * @brief  Überträgt den zuvor mit ILI9341_StreamGetBuffer() geholten Puffer per DMA.
  *
- * Diese Funktion führt folgende Schritte aus:
- * 1. Konvertiert 16-Bit-Parameter in 8-Bit-Daten für die Übertragung
- * 2. Wählt das Display aus (CS-Pin auf LOW)
- * 3. Setzt den Kommunikationsmodus auf Befehlsmodus (D/CX-Pin auf LOW)
- * 4. Sendet das Befehlsbyte an das Display
- * 5. Wechselt in den Datenmodus (D/CX-Pin auf HIGH)
- * 6. Überträgt die konvertierten Parameter
- * 7. Deaktiviert die Auswahl des Displays (CS-Pin auf HIGH)
+ * Wartet ggf. auf das Ende der Übertragung des anderen Puffers, startet dann
+ * den DMA-Transfer und schaltet auf den anderen Puffer um.
  *
- * @param  cmd    Das Befehlsbyte, das an das Display gesendet werden soll.
- * @param  Params Zeiger auf den Puffer mit den 16-Bit-Parametern, die gesendet werden sollen.
- * @param  pSize  Anzahl der zu sendenden Bytes (muss gerade sein für 16-Bit-Parameter).
- * @retval HAL_StatusTypeDef Status der Operation (HAL_OK bei Erfolg, andernfalls ein Fehlercode).
+ * @param  size Anzahl der gültigen Bytes im Puffer (max. ILI9341_LINE_BUFFER_SIZE).
+ * @retval HAL_StatusTypeDef Status des DMA-Starts.
  */
-HAL_StatusTypeDef ILI9341_SendCommandWithParam_16Bit(uint8_t cmd, uint16_t* Params, uint8_t pSize){
+HAL_StatusTypeDef ILI9341_StreamSubmit(uint32_t size) {
+	uint8_t *buffer = ILI9341_LineBuffer[ILI9341_LineBufferIndex];
+	ILI9341_LineBufferIndex ^= 1;
 
+	return ILI9341_SendDataAsync(buffer, size);
+}
 
 /**
- * Diese Schleife durchläuft die 16-Bit-Parameter und teilt sie in zwei 8-Bit-Werte auf,
- * die in einem neuen Array gespeichert werden. Der erste 8-Bit-Wert wird in das höhere Byte
- * und der zweite in das niedrigere Byte des Zielarrays geschrieben.
+ * @brief  Beendet eine Pixel-Übertragung.
+ *
+ * Wartet nicht auf den letzten DMA-Block: Läuft noch eine Übertragung, gibt der
+ * Completion-Interrupt CS frei, ansonsten geschieht das sofort.
  */
-	uint8_t txData[pSize];
-	int j = 0;
-	for (int i = 0; i < pSize; i+=2){
-		txData[i] = Params[j] << 8;
-		txData[i+1] = Params[j];
-		j++;
+void ILI9341_StreamEnd() {
+	ILI9341_StreamActive = 0;
+	if (!ILI9341_TxBusy) {
+		ILI9341_ChipDeselect();
 	}
+	ILI9341_BatchResume(ILI9341_BatchSuspended);
+	ILI9341_BatchSuspended = 0;
+}
 
+/* --------------------------------- Befehlsliste (Batch) --------------------------------- */
 
-	ILI9341_ChipSelect();
+/*
+ * Aufbau eines Eintrags in der Befehlsliste:
+ *   Befehl:  [ILI9341_BATCH_CMD]  [cmd] [n] [n Parameter]
+ *   Daten:   [ILI9341_BATCH_DATA] [Länge Low] [Länge High] [Daten]
+ *   Füllung: [ILI9341_BATCH_FILL] [Farbe High] [Farbe Low] [Anzahl Pixel, 4 Bytes Little Endian]
+ *   Zeilen:  [ILI9341_BATCH_ROWS] [Bytes je Zeile, 2] [Zeilenabstand, 2] [Zeilen, 2] [Adresse, sizeof(Zeiger)]
+ */
+#define ILI9341_BATCH_CMD   0
+#define ILI9341_BATCH_DATA  1
+#define ILI9341_BATCH_FILL  2
+#define ILI9341_BATCH_ROWS  3
 
-	ILI9341_SetCommand();
+/**
+ * @brief  Startet die Wiedergabe des aktuellen Aufzeichnungspuffers und schaltet auf den anderen um.
+ *
+ * Wartet auf eine laufende Übertragung (z.B. die Wiedergabe des anderen Puffers),
+ * aktiviert CS und startet das erste Segment. Alle weiteren Segmente werden aus dem
+ * SPI-Interrupt gestartet.
+ */
+static void ILI9341_BatchStart() {
+	if (ILI9341_BatchLength == 0) return;
 
-	HAL_StatusTypeDef status;
+	ILI9341_WaitWhileBusy();
+	ILI9341_SetFrameSize16(0);
 
-	status = HAL_SPI_Transmit(ILI9341_SPI, &cmd, 1, 100);
+	ILI9341_BatchReplayBuffer = ILI9341_BatchBuffer[ILI9341_BatchIndex];
+	ILI9341_BatchReplayLength = ILI9341_BatchLength;
+	ILI9341_BatchReplayPos = 0;
+	ILI9341_BatchParamCount = 0;
+	ILI9341_BatchFillRemaining = 0;
+	ILI9341_BatchRowsRemaining = 0;
 
-	ILI9341_SetData();
+	ILI9341_BatchIndex ^= 1;
+	ILI9341_BatchLength = 0;
 
-	status = HAL_SPI_Transmit(ILI9341_SPI, txData, pSize, HAL_MAX_DELAY);
+	Pin_Low(ILI9341_CS_PIN);
+	ILI9341_TxBusy = 1;
+	ILI9341_BatchReplaying = 1;
 
+	ILI9341_BatchNextSegment();
+}
 
-	ILI9341_ChipDeselect();
+/**
+ * @brief  Beendet die Wiedergabe: CS freigeben, Busy löschen, Anwender-Callback aufrufen.
+ */
+static void ILI9341_BatchFinish() {
+	ILI9341_BatchReplaying = 0;
+	Pin_High(ILI9341_CS_PIN);
+	ILI9341_TxBusy = 0;
 
-	return status;
+	if (ILI9341_TxCallback != NULL) {
+		ILI9341_TxCallback();
+	}
 }
 
+/**
+ * @brief  Startet einen DMA-Block der Wiedergabe, bricht bei einem Fehler ab.
+ */
+RAMFUNC static void ILI9341_BatchTransmit(const uint8_t *Data, uint16_t pSize) {
+	if (HAL_SPI_Transmit_DMA(ILI9341_SPI, Data, pSize) != HAL_OK) {
+		ILI9341_BatchFinish();
+		return;
+	}
+	BUSSTAT_ASYNC(BUSSTAT_ID_ILI9341, ILI9341_BUS_KIND(), pSize);
+}
 
 /**
- * @brief  Legt den Spaltenadressbereich für das ILI9341-Display fest.
+ * @brief  Sendet ein kurzes Segment der Wiedergabe ohne DMA (Aufruf auch im Interrupt-Kontext).
  *
- * Diese Funktion sendet den Spaltenadressbefehl (0x2A), gefolgt von den Start- (SC)
- * und End- (EC) Spaltenadressen. Die Adressen werden als 16-Bit-Parameter gesendet.
- *
- * @param  SC Startadresse der Spalte.
- * @param  EC Endadresse der Spalte.
+ * Bis ILI9341_BATCH_DIRECT_MAX Bytes passen in den SPI-FIFO; der blockierende Transfer
+ * kehrt nach dem letzten Bit zurück, DC darf danach sofort wechseln.
+ * @retval 1 bei Erfolg, 0 wenn die Wiedergabe abgebrochen wurde.
  */
-void ILI9341_ColumnAddressSet(uint16_t SC, uint16_t EC) {
-
-	uint16_t txData[2] = {SC, EC};
-
-	ILI9341_SendCommandWithParam_16Bit(0x2A, txData, 4);
+RAMFUNC static uint8_t ILI9341_BatchTransmitDirect(const uint8_t *Data, uint16_t pSize) {
+	if (BUSSTAT_CALL(BUSSTAT_ID_ILI9341, ILI9341_BUS_KIND(), pSize,
+			BusFast_SpiWrite(ILI9341_SPI, Data, pSize, 10)) != HAL_OK) {
+		ILI9341_BatchFinish();
+		return 0;
+	}
+	return 1;
 }
 
 /**
-  * @brief  Legt den Zeilenadressbereich für das ILI9341-Display fest.
-  *
-  * Diese Funktion sendet den Zeilenadressbefehl (0x2B), gefolgt von den Start- (SC)
-  * und End- (EC) Zeilenadressen. Die Adressen werden als 16-Bit-Parameter gesendet.
-  *
-  * @param  SC Startadresse der Zeile.
-  * @param  EC Endadresse der Zeile.
-  */
- void ILI9341_RowAddressSet(uint16_t SC, uint16_t EC) {
- 	uint16_t txData[2] = {SC, EC};
+ * @brief  Startet das nächste Segment der Wiedergabe (Aufruf auch im Interrupt-Kontext).
+ *
+ * Lange Segmente (Datenblöcke, Blöcke einer Farbfüllung) laufen als DMA-Transfer, DC wird
+ * im Completion-Interrupt umgeschaltet, wenn das letzte Bit gesendet ist. Kurze Segmente
+ * (Befehlsbytes, Parameter, kleine Daten) gehen direkt über den FIFO, danach folgt im selben
+ * Aufruf das nächste. Ein Adressfenster mit Memory Write (2A, 2B, 2C samt Parametern) kostet
+ * so keinen Interrupt mehr, erst der Pixelblock danach startet wieder DMA.
+ */
+RAMFUNC static void ILI9341_BatchNextSegment() {
+	const uint8_t *buffer = ILI9341_BatchReplayBuffer;
+
+	for (;;) {
+		if (ILI9341_BatchFillRemaining > 0) {
+			uint32_t n = ILI9341_BatchFillRemaining;
+			if (n > ILI9341_LINE_BUFFER_SIZE / 2) {
+				n = ILI9341_LINE_BUFFER_SIZE / 2;
+			}
+			ILI9341_BatchFillRemaining -= n;
+			ILI9341_BatchTransmit(ILI9341_BatchFillBuffer, n * 2);
+			return;
+		}
 
- 	ILI9341_SendCommandWithParam_16Bit(0x2B, txData, 4);
- }
+		if (ILI9341_BatchRowsRemaining > 0) {
+			// Rows without gaps go out as one block, up to the DMA limit
+			uint32_t rows = 1;
+			if (ILI9341_BatchRowsStride == ILI9341_BatchRowsBytes) {
+				rows = ILI9341_DMA_MAX_CHUNK / ILI9341_BatchRowsBytes;
+				if (rows > ILI9341_BatchRowsRemaining) {
+					rows = ILI9341_BatchRowsRemaining;
+				}
+			}
+			const uint8_t *data = ILI9341_BatchRowsData;
+			uint32_t n = rows * ILI9341_BatchRowsBytes;
+			ILI9341_BatchRowsData += rows * ILI9341_BatchRowsStride;
+			ILI9341_BatchRowsRemaining -= rows;
+			if (n > ILI9341_BATCH_DIRECT_MAX) {
+				ILI9341_BatchTransmit(data, n);
+				return;
+			}
+			if (!ILI9341_BatchTransmitDirect(data, n)) return;
+			continue;
+		}
 
-/**
-  * @brief  Sendet Daten an das ILI9341-Display über die SPI-Schnittstelle.
-  *
-  * Diese Funktion führt folgende Schritte aus:
-  * 1. Wählt das Display aus, indem der CS-Pin auf LOW gesetzt wird.
-  * 2. Setzt das Display in den Datenmodus (D/CX-Pin auf HIGH).
-  * 3. Überträgt die bereitgestellten Daten über die SPI-Schnittstelle.
-  * 4. Hebt die Auswahl des Displays auf, indem der CS-Pin auf HIGH gesetzt wird.
-  *
-  * @param  Data  Zeiger auf den Puffer, der die zu sendenden Daten enthält.
-  * @param  pSize Anzahl der zu sendenden Bytes.
-  * @retval HAL_StatusTypeDef Status der SPI-Übertragung:
-  *         - HAL_OK: Übertragung erfolgreich.
-  *         - Fehlercode: Wenn die Übertragung fehlschlägt.
-  */
- HAL_StatusTypeDef ILI9341_SendData(uint8_t *Data, uint32_t pSize) {
- 	ILI9341_ChipSelect();
+		if (ILI9341_BatchParamCount > 0) {
+			uint8_t n = ILI9341_BatchParamCount;
+			ILI9341_BatchParamCount = 0;
+			ILI9341_SetData();
+			if (n > ILI9341_BATCH_DIRECT_MAX) {
+				ILI9341_BatchTransmit(ILI9341_BatchParams, n);
+				return;
+			}
+			if (!ILI9341_BatchTransmitDirect(ILI9341_BatchParams, n)) return;
+			continue;
+		}
 
- 	HAL_StatusTypeDef status;
+		if (ILI9341_BatchReplayPos >= ILI9341_BatchReplayLength) {
+			ILI9341_BatchFinish();
+			return;
+		}
 
- 	ILI9341_SetData();
+		const uint8_t *entry = &buffer[ILI9341_BatchReplayPos];
+		if (entry[0] == ILI9341_BATCH_CMD) {
+			ILI9341_BatchParams = &entry[3];
+			ILI9341_BatchParamCount = entry[2];
+			ILI9341_BatchReplayPos += 3 + entry[2];
+			ILI9341_SetCommand();
+			if (!ILI9341_BatchTransmitDirect(&entry[1], 1)) return;
+		}
+		else if (entry[0] == ILI9341_BATCH_DATA) {
+			uint16_t length = entry[1] | (entry[2] << 8);
+			ILI9341_BatchReplayPos += 3 + length;
+			ILI9341_SetData();
+			if (length > ILI9341_BATCH_DIRECT_MAX) {
+				ILI9341_BatchTransmit(&entry[3], length);
+				return;
+			}
+			if (!ILI9341_BatchTransmitDirect(&entry[3], length)) return;
+		}
+		else if (entry[0] == ILI9341_BATCH_FILL) {
+			uint32_t count = entry[3] | (entry[4] << 8) | (entry[5] << 16) | ((uint32_t)entry[6] << 24);
+			uint32_t n = (count > ILI9341_LINE_BUFFER_SIZE / 2) ? ILI9341_LINE_BUFFER_SIZE / 2 : count;
+			for (uint32_t i = 0; i < n * 2; i += 2) {
+				ILI9341_BatchFillBuffer[i] = entry[1];
+				ILI9341_BatchFillBuffer[i + 1] = entry[2];
+			}
+			ILI9341_BatchReplayPos += 7;
+			ILI9341_BatchFillRemaining = count;
+			ILI9341_SetData();
+		}
+		else if (entry[0] == ILI9341_BATCH_ROWS) {
+			ILI9341_BatchRowsBytes = entry[1] | (entry[2] << 8);
+			ILI9341_BatchRowsStride = entry[3] | (entry[4] << 8);
+			ILI9341_BatchRowsRemaining = entry[5] | (entry[6] << 8);
+			memcpy(&ILI9341_BatchRowsData, &entry[7], sizeof(ILI9341_BatchRowsData));
+			ILI9341_BatchReplayPos += 7 + sizeof(ILI9341_BatchRowsData);
+			ILI9341_SetData();
+		}
+		else {
+			ILI9341_BatchFinish();
+			return;
+		}
+	}
+}
 
- 	status = HAL_SPI_Transmit(ILI9341_SPI, Data, pSize, HAL_MAX_DELAY);
+/**
+ * @brief  Reserviert Platz für einen Eintrag; ist der Puffer voll, wird er vorab gesendet.
+ */
+static uint8_t* ILI9341_BatchAlloc(uint32_t size) {
+	if (ILI9341_BatchLength + size > ILI9341_BATCH_BUFFER_SIZE) {
+		ILI9341_BatchStart();
+	}
+	uint8_t *entry = &ILI9341_BatchBuffer[ILI9341_BatchIndex][ILI9341_BatchLength];
+	ILI9341_BatchLength += size;
+	return entry;
+}
 
- 	ILI9341_ChipDeselect();
+/**
+ * @brief  Zeichnet einen Befehl mit Parametern auf.
+ */
+static void ILI9341_BatchRecordCommand(uint8_t cmd, const uint8_t *Params, uint8_t pSize) {
+	uint8_t *entry = ILI9341_BatchAlloc(3 + pSize);
+	entry[0] = ILI9341_BATCH_CMD;
+	entry[1] = cmd;
+	entry[2] = pSize;
+	if (pSize > 0) {
+		memcpy(&entry[3], Params, pSize);
+	}
+}
 
- 	return status;
- }
+/**
+ * @brief  Kopiert einen kleinen Datenblock in die Befehlsliste.
+ * @retval 1 wenn aufgezeichnet wurde, 0 wenn nicht aufgezeichnet wird oder der Block zu groß ist.
+ */
+static uint8_t ILI9341_BatchRecordData(const uint8_t *Data, uint32_t pSize) {
+	if (!ILI9341_BatchRecording || pSize > ILI9341_BATCH_MAX_INLINE) return 0;
+
+	uint8_t *entry = ILI9341_BatchAlloc(3 + pSize);
+	entry[0] = ILI9341_BATCH_DATA;
+	entry[1] = pSize;
+	entry[2] = pSize >> 8;
+	memcpy(&entry[3], Data, pSize);
+	return 1;
+}
+
+/**
+ * @brief  Zeichnet eine Farbfüllung von Size Pixeln auf.
+ */
+static void ILI9341_BatchRecordFill(uint16_t Colour, uint32_t Size) {
+	uint8_t *entry = ILI9341_BatchAlloc(7);
+	entry[0] = ILI9341_BATCH_FILL;
+	entry[1] = Colour >> 8;
+	entry[2] = Colour;
+	entry[3] = Size;
+	entry[4] = Size >> 8;
+	entry[5] = Size >> 16;
+	entry[6] = Size >> 24;
+}
 
+/**
+ * @brief  Zeichnet einen Verweis auf Zeilen im Speicher auf, die Wiedergabe sendet sie direkt von dort.
+ */
+static void ILI9341_BatchRecordRows(const uint8_t *Data, uint16_t RowBytes, uint16_t Stride, uint16_t Rows) {
+	uint8_t *entry = ILI9341_BatchAlloc(7 + sizeof(Data));
+	entry[0] = ILI9341_BATCH_ROWS;
+	entry[1] = RowBytes;
+	entry[2] = RowBytes >> 8;
+	entry[3] = Stride;
+	entry[4] = Stride >> 8;
+	entry[5] = Rows;
+	entry[6] = Rows >> 8;
+	memcpy(&entry[7], &Data, sizeof(Data));
+}
 
 /**
- * @brief  Schreibt Rohdaten direkt in den Speicher des ILI9341-Displays.
- *
- * Diese Funktion sendet zuerst den Speicherschreibbefehl (0x2C) an das Display
- * und überträgt dann die bereitgestellten Rohdaten. Sie wird verwendet, um
- * Pixeldaten oder andere Rohdaten direkt in den Anzeigespeicher zu schreiben,
- * ohne zusätzliche Formatierungen oder Adressierungen vorzunehmen.
- *
- * Der Prozess besteht aus zwei Hauptschritten:
- * 1. Senden des Memory Write-Befehls (0x2C)
- * 2. Übertragen der angegebenen Daten über die SPI-Schnittstelle
+ * @brief  Unterbricht die Aufzeichnung für eine direkte Übertragung.
  *
- * @param  data Zeiger auf den Puffer, der die zu schreibenden Daten enthält.
- * @param  size Anzahl der zu schreibenden Bytes.
- * @note   Vor dem Aufruf dieser Funktion sollte der Adressbereich mit
- *         ILI9341_SetAddress() oder ähnlichen Funktionen festgelegt werden,
- *         um die korrekte Position auf dem Display zu definieren.
+ * Das bisher Aufgezeichnete wird gestartet, damit die Reihenfolge erhalten bleibt.
+ * @retval 1 wenn aufgezeichnet wurde (für ILI9341_BatchResume()), sonst 0.
  */
-void ILI9341_MemoryWriteRaw(uint8_t *data, uint32_t size){
-	ILI9341_SendCommand(0x2C);
-	ILI9341_SendData(data, size);
+static uint8_t ILI9341_BatchSuspend() {
+	if (!ILI9341_BatchRecording) return 0;
+
+	ILI9341_BatchRecording = 0;
+	ILI9341_BatchStart();
+	return 1;
 }
 
-void ILI9341_DisplayOn() {
-	ILI9341_SendCommand(0x29);
-	HAL_Delay(10);
+/**
+ * @brief  Setzt eine mit ILI9341_BatchSuspend() unterbrochene Aufzeichnung fort.
+ */
+static void ILI9341_BatchResume(uint8_t suspended) {
+	if (suspended) {
+		ILI9341_BatchRecording = 1;
+	}
 }
 
 /**
- * @brief  Legt das Adressfenster für das ILI9341-Display fest.
- *
- * Diese Funktion definiert den rechteckigen Bereich für das Schreiben oder Lesen von Pixeldaten,
- * indem sie die Spalten- und Zeilenadressbereiche festlegt. Sie sendet die Befehle
- * "Column Address Set" (0x2A) und "Row Address Set" (0x2B) zusammen mit den angegebenen Koordinaten.
+ * @brief  Beginnt die Aufzeichnung einer Befehlsliste.
  *
- * @param  X1 Startadresse der Spalte.
- * @param  Y1 Startadresse der Zeile.
- * @param  X2 Endadresse der Spalte.
- * @param  Y2 Endadresse der Zeile.
+ * Bis ILI9341_EndBatch() werden Befehle, Parameter, kleine Datenblöcke und Farbfüllungen
+ * aller Zeichenfunktionen nur in einen Puffer geschrieben, statt pro Befehl CS, DC und
+ * einen SPI-Transfer zu steuern. Große Pixelmengen (Bilder, Streams) senden vorher das
+ * bisher Aufgezeichnete und laufen dann direkt. Ist der Puffer voll, wird er gesendet und
+ * im zweiten Puffer weiter aufgezeichnet.
  *
- * @note   Diese Funktion wird häufig vor dem Schreiben von Pixeldaten verwendet, um den Zielbereich
- *         auf dem Display zu definieren.
+ * @note   Lesebefehle (ILI9341_ReceiveData() usw.) dürfen während der Aufzeichnung
+ *         nicht verwendet werden.
  */
-void ILI9341_SetAddress(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2) {
-    // Erstellen der Parameter für den Spaltenadressbereich
-    uint8_t params[4] = {X1 >> 8, X1, X2 >> 8, X2};
-    // Erstellen der Parameter für den Zeilenadressbereich
-    uint8_t params2[4] = {Y1 >> 8, Y1, Y2 >> 8, Y2};
+void ILI9341_BeginBatch() {
+	if (ILI9341_BatchRecording) return;
 
-    // Senden des Spaltenadressbefehls mit den entsprechenden Parametern
-    ILI9341_SendCommandWithParam_8Bit(0x2A, params, 4);
-
-    // Senden des Zeilenadressbefehls mit den entsprechenden Parametern
-    ILI9341_SendCommandWithParam_8Bit(0x2B, params2, 4);
+	ILI9341_BatchLength = 0;
+	ILI9341_BatchRecording = 1;
 }
 
+/**
+ * @brief  Beendet die Aufzeichnung und spielt die Befehlsliste ab.
+ *
+ * Die Wiedergabe läuft in einer einzigen CS-Phase per DMA im Hintergrund. Der nächste
+ * Displayzugriff wartet automatisch auf ihr Ende, der Callback aus
+ * ILI9341_SetTransferCompleteCallback() meldet es.
+ */
+void ILI9341_EndBatch() {
+	if (!ILI9341_BatchRecording) return;
 
+	ILI9341_BatchRecording = 0;
+	ILI9341_BatchStart();
+}
 
 /**
- * @brief  Füllt den gesamten Bildschirm mit einer einzigen Farbe.
- *
- * Diese Funktion nutzt die ILI9341_SetAddress-Funktion, um das Adressfenster auf
- * die gesamte Bildschirmfläche zu setzen (von 0,0 bis zur maximalen Breite und Höhe),
- * und ruft dann ILI9341_DrawColourBurst auf, um alle Pixel mit der angegebenen Farbe zu füllen.
+ * @brief  Sendet Zeilen mit Zeilenabstand (z.B. ein Rechteck aus dem Framebuffer) per DMA direkt aus dem Speicher.
  *
- * @param  Colour Die 16-Bit-Farbe (RGB565-Format), mit der der Bildschirm gefüllt werden soll.
+ * Während einer Befehlsliste wird nur ein Verweis aufgezeichnet, die Zeilen gehen bei der
+ * Wiedergabe hinter den vorigen Befehlen hinaus (Fenster vorher mit ILI9341_BeginWrite()).
+ * Ohne Befehlsliste startet die Funktion eine eigene und kehrt sofort zurück. Zeilen ohne
+ * Lücke (Stride == RowBytes) laufen als ein Block, sonst eine DMA je Zeile.
  *
- * @note   Diese Funktion ist eine effiziente Methode zum Löschen des gesamten Bildschirms,
- *         da sie alle Pixel in einem einzigen Burst aktualisiert.
+ * @param  Data     Erste Zeile, Bytes in Display-Reihenfolge.
+ * @param  RowBytes Bytes je Zeile.
+ * @param  Stride   Abstand der Zeilen in Bytes.
+ * @param  Rows     Anzahl Zeilen.
+ * @note   Die Daten dürfen bis zum Ende der Wiedergabe (ILI9341_IsBusy()) nicht verändert werden.
  */
-void ILI9341_FillScreen(uint16_t Colour) {
-	ILI9341_SetAddress(0,0,ILI9341_WIDTH,ILI9341_HEIGHT);
-	ILI9341_DrawColourBurst(Colour,ILI9341_WIDTH*ILI9341_HEIGHT);
+void ILI9341_SendRowsAsync(const uint8_t *Data, uint16_t RowBytes, uint16_t Stride, uint16_t Rows) {
+	if (RowBytes == 0 || Rows == 0) return;
+
+	// The DMA reads these bytes later, from SRAM
+	Cache_CleanDMA(Data, (uint32_t)(Rows - 1) * Stride + RowBytes);
+
+	if (ILI9341_BatchRecording) {
+		ILI9341_BatchRecordRows(Data, RowBytes, Stride, Rows);
+		return;
+	}
+	ILI9341_BeginBatch();
+	ILI9341_BatchRecordRows(Data, RowBytes, Stride, Rows);
+	ILI9341_EndBatch();
 }
 
+/**
+ * @brief  Gibt zurück, ob gerade eine Befehlsliste aufgezeichnet wird.
+ */
+uint8_t ILI9341_IsBatching() {
+	return ILI9341_BatchRecording;
+}
 
 /**
- * @brief  Zeichnet den Umriss eines Rechtecks auf dem ILI9341-Display.
- *
- * Diese Funktion zeichnet ein Rechteck mit den angegebenen Abmessungen und der angegebenen Farbe,
- * indem sie zwei horizontale und zwei vertikale Linien verbindet, um den Umriss zu bilden.
- * Es wird nur der Umriss (Rahmen) gezeichnet, nicht das gefüllte Innere.
- *
- * Der Algorithmus besteht aus vier Schritten:
- * 1. Zeichnen der oberen horizontalen Linie
- * 2. Zeichnen der unteren horizontalen Linie
- * 3. Zeichnen der linken vertikalen Linie
- * 4. Zeichnen der rechten vertikalen Linie
+ * Initialisiert das ILI9341-Display.
+ */
+/**
+ * @brief  Initialisiert das ILI9341 Display
+ * @param  DISPLAY_SPI:       SPI-Handler für die Kommunikation mit dem Display
+ * @param  _ILI9341_CS_Port:  GPIO-Port für das Chip-Select-Signal (muss zu ILI9341_CS_PIN passen)
+ * @param  _ILI9341_CS_Pin:   GPIO-Pin für das Chip-Select-Signal
+ * @param  _ILI9341_DC_Port:  GPIO-Port für das Data/Command-Signal (muss zu ILI9341_DC_PIN passen)
+ * @param  _ILI9341_DC_Pin:   GPIO-Pin für das Data/Command-Signal
+ * @param  _ILI9341_Reset_Port: GPIO-Port für das Reset-Signal
+ * @param  _ILI9341_Reset_Pin:  GPIO-Pin für das Reset-Signal
+ * @retval None
  *
- * @param x      Die x-Koordinate der oberen linken Ecke des Rechtecks.
- * @param y      Die y-Koordinate der oberen linken Ecke des Rechtecks.
- * @param width  Die Breite des Rechtecks in Pixeln.
- * @param height Die Höhe des Rechtecks in Pixeln.
- * @param color  Die Farbe des Rechteck-Umrisses im 16-Bit RGB565-Format.
+ * @note Diese Funktion führt folgende Initialisierungsschritte durch:
+ *       1. Speichern der SPI- und GPIO-Konfigurationen
+ *       2. Hardware-Reset des Displays (ersetzt den Software-Reset)
+ *       3. SPI-Initialisierung
+ *       4. Konfiguration der Display-Einstellungen (ILI9341_InitSequence in einer CS-Phase)
+ *       5. Einstellung der Standard-Ausrichtung
  *
- * @note   Im Gegensatz zu ILI9341_DrawRectangle() oder ILI9341_fillRect(), die gefüllte
- *         Rechtecke zeichnen, erstellt diese Funktion nur den Rahmen des Rechtecks.
+ *       Das Panel bleibt danach im Sleep-Modus, der Displayspeicher lässt sich aber schon
+ *       beschreiben. ILI9341_EndInit() schaltet es ein, sobald die 120 ms nach dem Reset
+ *       abgelaufen sind; bis dahin kann main() das erste Bild aufbauen.
  */
-void ILI9341_DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color) {
-    // Draw the top horizontal line
-    ILI9341_DrawHLine(x, y, width, color);
+void ILI9341_begin(SPI_HandleTypeDef* DISPLAY_SPI, GPIO_TypeDef* _ILI9341_CS_Port,
+                   uint16_t _ILI9341_CS_Pin, GPIO_TypeDef* _ILI9341_DC_Port,
+                   uint16_t _ILI9341_DC_Pin, GPIO_TypeDef* _ILI9341_Reset_Port,
+                   uint16_t _ILI9341_Reset_Pin)
+{
+    /* GPIO und SPI-Handler speichern */
+    ILI9341_SPI = DISPLAY_SPI;
+    // CS und D/CX sind fest gebunden (ILI9341_CS_PIN, ILI9341_DC_PIN), die Parameter bleiben für die Schnittstelle
+    (void)_ILI9341_CS_Port;
+    (void)_ILI9341_CS_Pin;
+    (void)_ILI9341_DC_Port;
+    (void)_ILI9341_DC_Pin;
+    ILI9341_Reset_Port = _ILI9341_Reset_Port;
+    ILI9341_Reset_Pin = _ILI9341_Reset_Pin;
 
-    // Draw the bottom horizontal line
-    ILI9341_DrawHLine(x, y + height - 1, width, color);
+    /* Hardware-Reset durchführen (Datenblatt: mindestens 10 µs Impuls, 5 ms bis zum ersten Befehl) */
+    HAL_GPIO_WritePin(ILI9341_Reset_Port, ILI9341_Reset_Pin, GPIO_PIN_SET);
+    ILI9341_ChipSelect();
+    HAL_GPIO_WritePin(ILI9341_Reset_Port, ILI9341_Reset_Pin, GPIO_PIN_RESET);
+    HAL_Delay(ILI9341_RESET_PULSE_MS);
+    ILI9341_ChipDeselect();
+    HAL_GPIO_WritePin(ILI9341_Reset_Port, ILI9341_Reset_Pin, GPIO_PIN_SET);
+    ILI9341_ResetTick = HAL_GetTick();
+    ILI9341_InitPending = 1;
+    HAL_Delay(ILI9341_RESET_WAIT_MS);
+    ILI9341_InvalidateWindow(); // Adressregister wurden zurückgesetzt
 
-    // Draw the left vertical line
-    ILI9341_DrawVLine(x, y, height, color);
+    /* SPI-Interface mit Dummy-Byte initialisieren */
+    uint8_t dummy_byte = 0b01010101;
+    ILI9341_ChipSelect();
+    BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, 1, HAL_SPI_Transmit(ILI9341_SPI, &dummy_byte, 1, 100));
+    ILI9341_ChipDeselect();
 
-    // Draw the right vertical line
-    ILI9341_DrawVLine(x + width - 1, y, height, color);
+    /* Display-Spezifische Einstellungen konfigurieren: Power, Timing, Spannungen, Format, Gamma */
+    ILI9341_SendInitSequence(ILI9341_InitSequence, ILI9341_InitSequenceLength);
+
+    /* Standard-Ausrichtung einstellen */
+#ifdef ILI9341_FIXED_ORIENTATION
+    ILI9341_SetOrientation(ILI9341_FIXED_ORIENTATION);
+#else
+    ILI9341_SetRotation(SCREEN_VERTICAL_2);  // Portrait-Modus (180° gedreht)
+#endif
 }
 
 /**
- * @brief  Sendet einen Burst einer bestimmten Farbe an das ILI9341-Display für eine angegebene Anzahl von Pixeln.
- *
- * Diese Funktion sendet Farbdaten als Burst an das Display unter Verwendung des Memory-Write-Befehls (0x2C).
- * Sie optimiert die Übertragung, indem sie die Daten in Blöcke mit einer maximalen Größe (BURST_MAX_SIZE)
- * aufteilt, um Pufferüberläufe zu vermeiden und die Leistung zu verbessern. Die Farbe wird im
- * 16-Bit-Format (RGB565) gesendet.
- *
- * Der Algorithmus funktioniert wie folgt:
- * 1. Senden des Memory-Write-Befehls an das Display
- * 2. Berechnung der optimalen Puffergröße basierend auf der Anzahl der zu sendenden Pixel
- * 3. Vorbereiten des Burst-Puffers mit der angegebenen Farbe
- * 4. Aufteilen der Gesamtdaten in vollständige Blöcke und einen möglichen Rest
- * 5. Senden der vollständigen Blöcke und des Rests über die SPI-Schnittstelle
+ * @brief  Übernimmt nach einem Warmstart ein Panel, das den Reset des Controllers wach überstanden hat.
  *
- * @param  Colour Die 16-Bit-Farbwert (RGB565), der gesendet werden soll.
- * @param  Size   Die Anzahl der Pixel, die mit der angegebenen Farbe gefüllt werden sollen.
+ * Liest Read Display Power Mode (0x0A). Meldet das Panel ILI9341_POWER_MODE_AWAKE, gelten Init-Sequenz,
+ * Gamma und Displayspeicher noch: kein Hardware-Reset, keine Wartezeiten, das letzte Bild bleibt stehen.
+ * Nur die Ausrichtung wird wie in ILI9341_begin() neu gesetzt, ILI9341_EndInit() tut danach nichts.
+ * Ohne Antwort (MISO offen, Panel im Reset oder im Sleep) liefert die Funktion 0 und ändert nichts am Panel.
  *
- * @note   Die Funktion teilt die Daten in Blöcke der Größe BURST_MAX_SIZE auf, um eine effiziente
- *         Übertragung zu gewährleisten. Wenn die Gesamtgröße BURST_MAX_SIZE überschreitet, werden
- *         die Daten in Blöcken gesendet und der Rest separat behandelt.
+ * @retval 1, wenn das Panel übernommen wurde, sonst 0 (dann ILI9341_begin() aufrufen)
  */
-void ILI9341_DrawColourBurst(uint16_t Colour, uint32_t Size) {
-
-	//COMMAND Memory Write
-	ILI9341_SendCommand(0x2C);
+uint8_t ILI9341_Attach(SPI_HandleTypeDef* DISPLAY_SPI, GPIO_TypeDef* _ILI9341_CS_Port,
+                       uint16_t _ILI9341_CS_Pin, GPIO_TypeDef* _ILI9341_DC_Port,
+                       uint16_t _ILI9341_DC_Pin, GPIO_TypeDef* _ILI9341_Reset_Port,
+                       uint16_t _ILI9341_Reset_Pin)
+{
+    uint8_t mode[2] = {0, 0};
 
-	// Calculate the buffer size for transmission
-	uint32_t Buffer_Size = 0;
-	if((Size*2) < BURST_MAX_SIZE)
-	{
-		Buffer_Size = Size; // Use the full size if it fits within the buffer limit
-	} else {
-		Buffer_Size = BURST_MAX_SIZE; // Otherwise, use the maximum buffer size
-	}
+    ILI9341_SPI = DISPLAY_SPI;
+    (void)_ILI9341_CS_Port;
+    (void)_ILI9341_CS_Pin;
+    (void)_ILI9341_DC_Port;
+    (void)_ILI9341_DC_Pin;
+    ILI9341_Reset_Port = _ILI9341_Reset_Port;
+    ILI9341_Reset_Pin = _ILI9341_Reset_Pin;
 
-	// Exit if the buffer size is zero
-	if (Buffer_Size == 0) return;
+    // Some panels clock out a dummy byte first, the power mode is then in the second one
+    ILI9341_ChipSelect();
+    ILI9341_WriteCommandInline(0x0A, NULL, 0);
+    ILI9341_SetReadClock(1);
+    HAL_StatusTypeDef status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, sizeof(mode),
+            HAL_SPI_Receive(ILI9341_SPI, mode, sizeof(mode), 10));
+    ILI9341_SetReadClock(0);
+    ILI9341_ChipDeselect();
 
-	ILI9341_SetData();
-	ILI9341_ChipSelect();
+    if (status != HAL_OK || (mode[0] != ILI9341_POWER_MODE_AWAKE && mode[1] != ILI9341_POWER_MODE_AWAKE)) {
+        return 0;
+    }
 
-	// Prepare the burst buffer with the specified color
-	unsigned char chifted = 	Colour>>8; // Extract the high byte of the color
-	unsigned char burst_buffer[Buffer_Size];
-	for(uint32_t j = 0; j < Buffer_Size; j+=2)
-		{
-			burst_buffer[j] = 	chifted; // High byte of the color
-			burst_buffer[j+1] = Colour; // Low byte of the color
-		}
+    ILI9341_InitPending = 0;
+    ILI9341_InvalidateWindow(); // Stand der Adressregister unbekannt
+#ifdef ILI9341_FIXED_ORIENTATION
+    ILI9341_SetOrientation(ILI9341_FIXED_ORIENTATION);
+#else
+    ILI9341_SetRotation(SCREEN_VERTICAL_2);
+#endif
+    return 1;
+}
 
-	// Calculate the total data size and how to split it into blocks
-	uint32_t Sending_Size = Size*2; // Total bytes to send (2 bytes per pixel)
-	uint32_t Sending_in_Block = Sending_Size/Buffer_Size; // Number of full blocks
-	uint32_t Remainder_from_block = Sending_Size%Buffer_Size; // Remaining bytes
-
-	// Send full blocks of data
-	if(Sending_in_Block != 0)
-	{
-		for(uint32_t j = 0; j < (Sending_in_Block); j++)
-			{
-			HAL_SPI_Transmit(ILI9341_SPI, (unsigned char *)burst_buffer, Buffer_Size, 100);
-			}
-	}
+/**
+ * @brief  Beendet ILI9341_begin(): Sleep Out und Display On.
+ *
+ * Wartet nur, was von ILI9341_SLEEP_OUT_WAIT_MS nach dem Reset noch übrig ist, plus
+ * ILI9341_SLEEP_SETTLE_MS. Zeichnet main() vorher das erste Bild in den Displayspeicher,
+ * fällt die Wartezeit ganz oder teilweise weg und das Panel zeigt sofort den fertigen Inhalt.
+ * Weitere Aufrufe tun nichts.
+ */
+void ILI9341_EndInit() {
+    if (!ILI9341_InitPending) return;
 
-	// Send the remaining bytes
-	HAL_SPI_Transmit(ILI9341_SPI, (unsigned char *)burst_buffer, Remainder_from_block, 10);
-	ILI9341_ChipDeselect();
+    ILI9341_WaitWhileBusy();
+    uint32_t elapsed = HAL_GetTick() - ILI9341_ResetTick;
+    if (elapsed < ILI9341_SLEEP_OUT_WAIT_MS) {
+        HAL_Delay(ILI9341_SLEEP_OUT_WAIT_MS - elapsed);
+    }
+    ILI9341_SendInitSequence(ILI9341_WakeSequence, ILI9341_WakeSequenceLength);
+    ILI9341_InitPending = 0;
 }
 
 /**
- * Sets the rotation of the ILI9341 display.
- *
- * This function configures the display's orientation by sending the Memory Access Control (0x36) command
- * followed by the appropriate parameter to set the rotation. It also updates the display's width and height
- * based on the selected rotation.
+ * @brief  Sendet eine Initialisierungstabelle in einer einzigen CS-Phase.
  *
- * @param Rotation The desired rotation mode. Supported modes are:
- *                 - SCREEN_VERTICAL_1: Vertical orientation (default).
- *                 - SCREEN_HORIZONTAL_1: Horizontal orientation (90 degrees).
- *                 - SCREEN_VERTICAL_2: Vertical orientation flipped (180 degrees).
- *                 - SCREEN_HORIZONTAL_2: Horizontal orientation flipped (270 degrees).
+ * Zwischen den Einträgen wechselt nur D/CX, Pausen (delayMs) laufen bei aktivem CS ab.
+ * Nicht innerhalb von ILI9341_BeginBatch()/ILI9341_EndBatch() aufrufen, die Liste kennt
+ * keine Pausen.
  *
- * @note If an invalid rotation mode is provided, the function exits without making any changes.
+ * @param  table: Einträge, z.B. ILI9341_InitSequence
+ * @param  count: Anzahl der Einträge
  */
-void ILI9341_SetRotation(uint8_t Rotation) {
-	ILI9341_SendCommand(0x36);
-	HAL_Delay(1);
-	uint8_t data;
-	switch(Rotation)
-		{
-			case SCREEN_VERTICAL_1:
-				data = 0x40|0x08;
-				ILI9341_WIDTH = 240;
-				ILI9341_HEIGHT = 320;
-				break;
+void ILI9341_SendInitSequence(const ILI9341_InitCommand *table, uint8_t count) {
+    ILI9341_ChipSelect();
+    for (uint8_t i = 0; i < count; i++) {
+        ILI9341_WriteCommandInline(table[i].cmd, table[i].params, table[i].count);
+        if (table[i].delayMs > 0) {
+            HAL_Delay(table[i].delayMs);
+        }
+    }
+    ILI9341_ChipDeselect();
+}
+
+
+/**
+ * @brief  Sendet einen Befehl an das ILI9341-Display über die SPI-Schnittstelle.
+ *
+ * Diese Funktion wählt das Display aus, setzt es in den Befehlsmodus,
+ * überträgt das Befehlsbyte und hebt anschließend die Auswahl des Displays auf.
+ *
+ * @param  cmd Das Befehlsbyte, das an das Display gesendet werden soll.
+ * @retval HAL_StatusTypeDef Der Status der SPI-Übertragung (HAL_OK bei Erfolg,
+ *         andernfalls ein Fehlercode).
+ */
+HAL_StatusTypeDef ILI9341_SendCommand(uint8_t cmd) {
+	if (ILI9341_BatchRecording) {
+		ILI9341_BatchRecordCommand(cmd, NULL, 0);
+		return HAL_OK;
+	}
+
+	ILI9341_ChipSelect(); // Wählt das Display aus
+	ILI9341_SetCommand(); // Setzt den Modus auf "Befehl"
+
+	HAL_StatusTypeDef status;
+	status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_COMMAND, 1,
+			BusFast_SpiWrite(ILI9341_SPI, &cmd, 1, 100)); // Überträgt das Befehlsbyte
+
+	ILI9341_ChipDeselect(); // Hebt die Auswahl des Displays auf
+
+	return status; // Gibt den Status der Übertragung zurück
+}
+
+/**
+ * @brief  Empfängt ein einzelnes Byte vom ILI9341-Display über die SPI-Schnittstelle.
+ *
+ * Diese Funktion wählt das Display aus, empfängt ein Byte und hebt anschließend die Auswahl des Displays auf.
+ * Das empfangene Byte wird zurückgegeben.
+ *
+ * @retval uint8_t Das empfangene Byte vom Display.
+ */
+uint8_t ILI9341_ReceiveByte() {
+	ILI9341_ChipSelect(); // Wählt das Display aus
+	uint8_t data;
+
+	BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, 1,
+			HAL_SPI_Receive(ILI9341_SPI, &data, 1, 100)); // Empfängt ein Byte über SPI
+
+	ILI9341_ChipDeselect(); // Hebt die Auswahl des Displays auf
+
+	return data; // Gibt das empfangene Byte zurück
+}
+
+/**
+ * @brief  Empfängt mehrere Bytes vom ILI9341-Display über die SPI-Schnittstelle.
+ *
+ * Diese Funktion wählt das Display aus, empfängt eine angegebene Anzahl von Bytes
+ * und hebt anschließend die Auswahl des Displays auf. Der Status der SPI-Übertragung
+ * wird zurückgegeben.
+ *
+ * @param  dataOut Zeiger auf den Puffer, in dem die empfangenen Daten gespeichert werden.
+ * @param  pSize   Anzahl der zu empfangenden Bytes.
+ * @retval HAL_StatusTypeDef Status der SPI-Übertragung (HAL_OK bei Erfolg,
+ *         andernfalls ein Fehlercode).
+ */
+HAL_StatusTypeDef ILI9341_ReceiveData(uint8_t *dataOut, uint8_t pSize) {
+	// Wählt das Display aus, indem der CS-Pin auf LOW gesetzt wird
+	ILI9341_ChipSelect();
+
+	// Blockierender Empfang direkt in den Puffer des Aufrufers, ein Zwischenpuffer ist nicht nötig
+	HAL_StatusTypeDef status;
+	status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, pSize,
+			HAL_SPI_Receive(ILI9341_SPI, dataOut, pSize, HAL_MAX_DELAY));
+
+	// Hebt die Auswahl des Displays auf, indem der CS-Pin auf HIGH gesetzt wird
+	ILI9341_ChipDeselect();
+
+	// Gibt den Status der SPI-Übertragung zurück
+	return status;
+}
+
+/**
+  * @brief  Sendet einen Befehl an das ILI9341-Display und empfängt anschließend mehrere Datenbytes.
+  *
+  * Diese Funktion führt folgende Schritte aus:
+  * 1. Sendet ein Befehlsbyte an das Display über `ILI9341_SendCommand`.
+  * 2. Schaltet das Display in den Datenmodus mit `ILI9341_SetData`.
+  * 3. Empfängt die angegebene Anzahl von Datenbytes mit `ILI9341_ReceiveData`.
+  *
+  * @param  cmd     Das Befehlsbyte, das an das Display gesendet werden soll.
+  * @param  dataOut Zeiger auf den Puffer, in dem die empfangenen Daten gespeichert werden.
+  * @param  pSize   Anzahl der zu empfangenden Bytes.
+  * @retval HAL_StatusTypeDef Status der Operation:
+  *         - HAL_OK: Operation erfolgreich ausgeführt.
+  *         - Fehlercode: Wenn die Operation fehlschlägt.
+  */
+ HAL_StatusTypeDef ILI9341_SendCommandAndReceive(uint8_t cmd, uint8_t *dataOut,
+ 		uint8_t pSize) {
+
+ 	HAL_StatusTypeDef status;
+ 	status = ILI9341_SendCommand(cmd);
+
+ 	ILI9341_SetData();
+
+ 	status = ILI9341_ReceiveData(dataOut, pSize);
+
+ 	return status;
+ }
+
+
+
+/**
+ * @brief  Sendet einen Befehl an das ILI9341-Display gefolgt von 8-Bit-Parametern über die SPI-Schnittstelle.
+ *
+ * Diese Funktion führt folgende Schritte aus:
+ * 1. Wählt das Display aus (CS-Pin auf LOW).
+ * 2. Setzt den Kommunikationsmodus auf Befehlsmodus (D/CX-Pin auf LOW).
+ * 3. Überträgt das Befehlsbyte an das Display.
+ * 4. Wechselt in den Datenmodus (D/CX-Pin auf HIGH).
+ * 5. Überträgt die angegebenen Parameter an das Display.
+ * 6. Deaktiviert die Auswahl des Displays (CS-Pin auf HIGH).
+ *
+ * @param  cmd    Das Befehlsbyte, das an das Display gesendet werden soll.
+ * @param  Params Zeiger auf den Puffer mit den 8-Bit-Parametern, die gesendet werden sollen.
+ * @param  pSize  Anzahl der zu sendenden Parameter (Bytes).
+ * @retval HAL_StatusTypeDef Status der Operation (HAL_OK bei Erfolg, andernfalls ein Fehlercode).
+ */
+HAL_StatusTypeDef ILI9341_SendCommandWithParam_8Bit(uint8_t cmd, uint8_t *Params,
+		uint8_t pSize) {
+	if (ILI9341_BatchRecording) {
+		ILI9341_BatchRecordCommand(cmd, Params, pSize);
+		return HAL_OK;
+	}
+
+	ILI9341_ChipSelect();
+
+	ILI9341_SetCommand();
+
+	HAL_StatusTypeDef status;
+	status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_COMMAND, 1, BusFast_SpiWrite(ILI9341_SPI, &cmd, 1, 100));
+
+	ILI9341_SetData();
+
+	status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, pSize,
+			BusFast_SpiWrite(ILI9341_SPI, Params, pSize, HAL_MAX_DELAY));
+
+	ILI9341_ChipDeselect();
+
+	return status;
+}
+
+/**
+ * @brief  Sendet einen Befehl an das ILI9341-Display gefolgt von 16-Bit-Parametern über die SPI-Schnittstelle.
+ *
+ * Diese Funktion führt folgende Schritte aus:
+ * 1. Konvertiert 16-Bit-Parameter in 8-Bit-Daten für die Übertragung
+ * 2. Wählt das Display aus (CS-Pin auf LOW)
+ * 3. Setzt den Kommunikationsmodus auf Befehlsmodus (D/CX-Pin auf LOW)
+ * 4. Sendet das Befehlsbyte an das Display
+ * 5. Wechselt in den Datenmodus (D/CX-Pin auf HIGH)
+ * 6. Überträgt die konvertierten Parameter
+ * 7. Deaktiviert die Auswahl des Displays (CS-Pin auf HIGH)
+ *
+ * @param  cmd    Das Befehlsbyte, das an das Display gesendet werden soll.
+ * @param  Params Zeiger auf den Puffer mit den 16-Bit-Parametern, die gesendet werden sollen.
+ * @param  pSize  Anzahl der zu sendenden Bytes (muss gerade sein für 16-Bit-Parameter).
+ * @retval HAL_StatusTypeDef Status der Operation (HAL_OK bei Erfolg, andernfalls ein Fehlercode).
+ */
+HAL_StatusTypeDef ILI9341_SendCommandWithParam_16Bit(uint8_t cmd, uint16_t* Params, uint8_t pSize){
+
+
+/**
+ * Diese Schleife durchläuft die 16-Bit-Parameter und teilt sie in zwei 8-Bit-Werte auf,
+ * die in einem Block aus dem Pool gespeichert werden. Das höhere Byte wird zuerst gesendet,
+ * danach das niedrigere.
+ */
+	uint8_t *txData = Pool_Alloc(pSize);
+	if (txData == NULL) {
+		return HAL_ERROR;
+	}
+	int j = 0;
+	for (int i = 0; i + 1 < pSize; i+=2){
+		txData[i] = Params[j] >> 8;
+		txData[i+1] = Params[j];
+		j++;
+	}
+
+	if (ILI9341_BatchRecording) {
+		ILI9341_BatchRecordCommand(cmd, txData, pSize);
+		Pool_Free(txData);
+		return HAL_OK;
+	}
+
+
+	ILI9341_ChipSelect();
+
+	ILI9341_SetCommand();
+
+	HAL_StatusTypeDef status;
+
+	status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_COMMAND, 1, BusFast_SpiWrite(ILI9341_SPI, &cmd, 1, 100));
+
+	ILI9341_SetData();
+
+	status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, pSize,
+			BusFast_SpiWrite(ILI9341_SPI, txData, pSize, HAL_MAX_DELAY));
+
+
+	ILI9341_ChipDeselect();
+	Pool_Free(txData);
+
+	return status;
+}
+
+
+/**
+ * @brief  Legt den Spaltenadressbereich für das ILI9341-Display fest.
+ *
+ * Diese Funktion sendet den Spaltenadressbefehl (0x2A), gefolgt von den Start- (SC)
+ * und End- (EC) Spaltenadressen. Die Adressen werden als 16-Bit-Parameter gesendet.
+ *
+ * @param  SC Startadresse der Spalte.
+ * @param  EC Endadresse der Spalte.
+ */
+void ILI9341_ColumnAddressSet(uint16_t SC, uint16_t EC) {
+
+	uint16_t txData[2] = {SC, EC};
+
+	ILI9341_SendCommandWithParam_16Bit(0x2A, txData, 4);
+	ILI9341_ColumnValid = 0;
+}
+
+/**
+  * @brief  Legt den Zeilenadressbereich für das ILI9341-Display fest.
+  *
+  * Diese Funktion sendet den Zeilenadressbefehl (0x2B), gefolgt von den Start- (SC)
+  * und End- (EC) Zeilenadressen. Die Adressen werden als 16-Bit-Parameter gesendet.
+  *
+  * @param  SC Startadresse der Zeile.
+  * @param  EC Endadresse der Zeile.
+  */
+ void ILI9341_RowAddressSet(uint16_t SC, uint16_t EC) {
+ 	uint16_t txData[2] = {SC, EC};
+
+ 	ILI9341_SendCommandWithParam_16Bit(0x2B, txData, 4);
+ }
+
+/**
+  * @brief  Sendet Daten an das ILI9341-Display über die SPI-Schnittstelle.
+  *
+  * Diese Funktion führt folgende Schritte aus:
+  * 1. Wählt das Display aus, indem der CS-Pin auf LOW gesetzt wird.
+  * 2. Setzt das Display in den Datenmodus (D/CX-Pin auf HIGH).
+  * 3. Überträgt die bereitgestellten Daten über die SPI-Schnittstelle.
+  * 4. Hebt die Auswahl des Displays auf, indem der CS-Pin auf HIGH gesetzt wird.
+  *
+  * @param  Data  Zeiger auf den Puffer, der die zu sendenden Daten enthält.
+  * @param  pSize Anzahl der zu sendenden Bytes.
+  * @retval HAL_StatusTypeDef Status der SPI-Übertragung:
+  *         - HAL_OK: Übertragung erfolgreich.
+  *         - Fehlercode: Wenn die Übertragung fehlschlägt.
+  */
+ HAL_StatusTypeDef ILI9341_SendData(uint8_t *Data, uint32_t pSize) {
+ 	if (ILI9341_BatchRecordData(Data, pSize)) {
+ 		return HAL_OK;
+ 	}
+ 	uint8_t suspended = ILI9341_BatchSuspend();
+
+ 	ILI9341_ChipSelect();
+
+ 	HAL_StatusTypeDef status;
+
+ 	ILI9341_SetData();
+
+ 	status = BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, pSize,
+ 			HAL_SPI_Transmit(ILI9341_SPI, Data, pSize, HAL_MAX_DELAY));
+
+ 	ILI9341_ChipDeselect();
+ 	ILI9341_BatchResume(suspended);
+
+ 	return status;
+ }
+
+
+/**
+ * @brief  Schreibt Rohdaten direkt in den Speicher des ILI9341-Displays.
+ *
+ * Diese Funktion sendet zuerst den Speicherschreibbefehl (0x2C) an das Display
+ * und überträgt dann die bereitgestellten Rohdaten. Sie wird verwendet, um
+ * Pixeldaten oder andere Rohdaten direkt in den Anzeigespeicher zu schreiben,
+ * ohne zusätzliche Formatierungen oder Adressierungen vorzunehmen.
+ *
+ * Der Prozess besteht aus zwei Hauptschritten:
+ * 1. Senden des Memory Write-Befehls (0x2C)
+ * 2. Übertragen der angegebenen Daten über die SPI-Schnittstelle
+ *
+ * @param  data Zeiger auf den Puffer, der die zu schreibenden Daten enthält.
+ * @param  size Anzahl der zu schreibenden Bytes.
+ * @note   Vor dem Aufruf dieser Funktion sollte der Adressbereich mit
+ *         ILI9341_SetAddress() oder ähnlichen Funktionen festgelegt werden,
+ *         um die korrekte Position auf dem Display zu definieren.
+ */
+void ILI9341_MemoryWriteRaw(uint8_t *data, uint32_t size){
+	ILI9341_SendCommand(0x2C);
+	ILI9341_SendData(data, size);
+}
+
+void ILI9341_DisplayOn() {
+	ILI9341_SendCommand(0x29);
+}
+
+/**
+ * @brief  Schaltet die Ausgabe ab (Display Off, 0x28), der Displayspeicher bleibt erhalten.
+ */
+void ILI9341_DisplayOff() {
+	ILI9341_SendCommand(0x28);
+}
+
+/**
+ * @brief  Sendet einen Befehl mit optionalen Parametern, ohne CS zu verändern.
+ *
+ * Hilfsfunktion für Befehlsfolgen, die innerhalb einer einzigen CS-Phase gesendet werden.
+ * CS muss vom Aufrufer bereits aktiviert sein. Nach der Rückkehr ist der Datenmodus gesetzt.
+ */
+static void ILI9341_WriteCommandInline(uint8_t cmd, const uint8_t *Params, uint8_t pSize) {
+	if (ILI9341_BatchRecording) {
+		ILI9341_BatchRecordCommand(cmd, Params, pSize);
+		return;
+	}
+	ILI9341_SetCommand();
+	BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_COMMAND, 1, BusFast_SpiWrite(ILI9341_SPI, &cmd, 1, 100));
+	ILI9341_SetData();
+	if (pSize > 0) {
+		BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, pSize, BusFast_SpiWrite(ILI9341_SPI, Params, pSize, 100));
+	}
+}
+
+/**
+ * @brief  Sendet nur die Hälften des Adressfensters, die sich geändert haben.
+ *
+ * CS muss vom Aufrufer bereits aktiviert sein.
+ */
+static void ILI9341_WriteWindowInline(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2) {
+	if (!ILI9341_ColumnValid || X1 != ILI9341_WinX1 || X2 != ILI9341_WinX2) {
+		uint8_t params[4] = {X1 >> 8, X1, X2 >> 8, X2};
+		ILI9341_WriteCommandInline(0x2A, params, 4);
+		ILI9341_WinX1 = X1;
+		ILI9341_WinX2 = X2;
+		ILI9341_ColumnValid = 1;
+	}
+
+	if (!ILI9341_PageValid || Y1 != ILI9341_WinY1 || Y2 != ILI9341_WinY2) {
+		uint8_t params[4] = {Y1 >> 8, Y1, Y2 >> 8, Y2};
+		ILI9341_WriteCommandInline(0x2B, params, 4);
+		ILI9341_WinY1 = Y1;
+		ILI9341_WinY2 = Y2;
+		ILI9341_PageValid = 1;
+	}
+}
+
+/**
+ * @brief  Verwirft das gespeicherte Adressfenster.
+ *
+ * Der nächste Aufruf von ILI9341_SetAddress() bzw. ILI9341_BeginWrite() sendet
+ * dann wieder beide Befehle (0x2A und 0x2B). Muss nach einem Reset des Displays oder
+ * nach direktem Zugriff auf die Adressregister aufgerufen werden.
+ */
+void ILI9341_InvalidateWindow() {
+	ILI9341_ColumnValid = 0;
+	ILI9341_PageValid = 0;
+}
+
+/**
+ * @brief  Legt das Adressfenster für das ILI9341-Display fest.
+ *
+ * Diese Funktion definiert den rechteckigen Bereich für das Schreiben oder Lesen von Pixeldaten,
+ * indem sie die Spalten- und Zeilenadressbereiche festlegt. Sie sendet die Befehle
+ * "Column Address Set" (0x2A) und "Row Address Set" (0x2B) zusammen mit den angegebenen Koordinaten.
+ *
+ * Das zuletzt gesendete Fenster wird gespeichert. Unveränderte Hälften (z.B. gleiche Spalten
+ * bei aufeinanderfolgenden Zeilen) werden nicht erneut gesendet, und beide Befehle laufen
+ * in einer einzigen CS-Phase.
+ *
+ * @param  X1 Startadresse der Spalte.
+ * @param  Y1 Startadresse der Zeile.
+ * @param  X2 Endadresse der Spalte.
+ * @param  Y2 Endadresse der Zeile.
+ *
+ * @note   Diese Funktion wird häufig vor dem Schreiben von Pixeldaten verwendet, um den Zielbereich
+ *         auf dem Display zu definieren. Für "Fenster setzen + Memory Write" ist
+ *         ILI9341_BeginWrite() effizienter.
+ */
+void ILI9341_SetAddress(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2) {
+	ILI9341_ChipSelect();
+	ILI9341_WriteWindowInline(X1, Y1, X2, Y2);
+	ILI9341_ChipDeselect();
+}
+
+/**
+ * @brief  Setzt das Adressfenster und startet den Memory-Write (0x2C) in einer einzigen CS-Phase.
+ *
+ * Nach der Rückkehr ist CS weiterhin aktiv und der Datenmodus gesetzt, sodass direkt
+ * Pixeldaten folgen können (z.B. mit ILI9341_StreamBegin(), ILI9341_SendData() oder
+ * ILI9341_SendDataAsync()). Diese geben CS anschließend wieder frei.
+ *
+ * @param  X1 Startadresse der Spalte.
+ * @param  Y1 Startadresse der Zeile.
+ * @param  X2 Endadresse der Spalte.
+ * @param  Y2 Endadresse der Zeile.
+ */
+void ILI9341_BeginWrite(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2) {
+	ILI9341_ChipSelect();
+	ILI9341_WriteWindowInline(X1, Y1, X2, Y2);
+	ILI9341_WriteCommandInline(0x2C, NULL, 0);
+}
+
+
+
+/**
+ * @brief  Füllt den gesamten Bildschirm mit einer einzigen Farbe.
+ *
+ * Diese Funktion nutzt die ILI9341_BeginWrite-Funktion, um das Adressfenster auf
+ * die gesamte Bildschirmfläche zu setzen (von 0,0 bis zur maximalen Breite und Höhe),
+ * und füllt dann alle Pixel per Burst mit der angegebenen Farbe.
+ *
+ * @param  Colour Die 16-Bit-Farbe (RGB565-Format), mit der der Bildschirm gefüllt werden soll.
+ *
+ * @note   Diese Funktion ist eine effiziente Methode zum Löschen des gesamten Bildschirms,
+ *         da sie alle Pixel in einem einzigen Burst aktualisiert.
+ */
+void ILI9341_FillScreen(uint16_t Colour) {
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_FillRect(0, 0, ILI9341_WIDTH, ILI9341_HEIGHT, Colour);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_FillRect(0, 0, ILI9341_WIDTH, ILI9341_HEIGHT, Colour)) {
+		return;
+	}
+#endif
+	ILI9341_BeginWrite(0, 0, ILI9341_WIDTH - 1, ILI9341_HEIGHT - 1);
+	ILI9341_StreamColour(Colour, (uint32_t)ILI9341_WIDTH*ILI9341_HEIGHT);
+}
+
+
+/**
+ * @brief  Zeichnet den Umriss eines Rechtecks auf dem ILI9341-Display.
+ *
+ * Diese Funktion zeichnet ein Rechteck mit den angegebenen Abmessungen und der angegebenen Farbe,
+ * indem sie zwei horizontale und zwei vertikale Linien verbindet, um den Umriss zu bilden.
+ * Es wird nur der Umriss (Rahmen) gezeichnet, nicht das gefüllte Innere.
+ *
+ * Der Algorithmus besteht aus vier Schritten:
+ * 1. Zeichnen der oberen horizontalen Linie
+ * 2. Zeichnen der unteren horizontalen Linie
+ * 3. Zeichnen der linken vertikalen Linie
+ * 4. Zeichnen der rechten vertikalen Linie
+ *
+ * @param x      Die x-Koordinate der oberen linken Ecke des Rechtecks.
+ * @param y      Die y-Koordinate der oberen linken Ecke des Rechtecks.
+ * @param width  Die Breite des Rechtecks in Pixeln.
+ * @param height Die Höhe des Rechtecks in Pixeln.
+ * @param color  Die Farbe des Rechteck-Umrisses im 16-Bit RGB565-Format.
+ *
+ * @note   Im Gegensatz zu ILI9341_DrawRectangle() oder ILI9341_fillRect(), die gefüllte
+ *         Rechtecke zeichnen, erstellt diese Funktion nur den Rahmen des Rechtecks.
+ */
+void ILI9341_DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color) {
+    // Draw the top horizontal line
+    ILI9341_DrawHLine(x, y, width, color);
+
+    // Draw the bottom horizontal line
+    ILI9341_DrawHLine(x, y + height - 1, width, color);
+
+    // Draw the left vertical line
+    ILI9341_DrawVLine(x, y, height, color);
+
+    // Draw the right vertical line
+    ILI9341_DrawVLine(x + width - 1, y, height, color);
+}
+
+/**
+ * @brief  Sendet Size Pixel einer Farbe über die Ping-Pong-Zeilenpuffer.
+ *
+ * Der Memory-Write-Befehl (0x2C) muss bereits gesendet sein und CS aktiv
+ * (z.B. durch ILI9341_BeginWrite()).
+ */
+static void ILI9341_StreamColour(uint16_t Colour, uint32_t Size) {
+	// Exit if there is nothing to send
+	if (Size == 0) {
+		ILI9341_ChipDeselect();
+		return;
+	}
+
+	if (ILI9341_BatchRecording) {
+		ILI9341_BatchRecordFill(Colour, Size);
+		return;
+	}
+
+	uint32_t Sending_Size = Size*2; // Total bytes to send (2 bytes per pixel)
+	uint8_t Buffers_Prepared = 0;   // Beide Puffer müssen nur einmal mit der Farbe gefüllt werden
+
+#ifdef ILI9341_USE_16BIT_PIXELS
+	// 16-Bit-Frames: Die Farbe wird unverändert als uint16_t abgelegt
+	ILI9341_StreamBegin16();
+
+	while (Sending_Size > 0) {
+		uint32_t Block_Size = Sending_Size;
+		if (Block_Size > ILI9341_LINE_BUFFER_SIZE) {
+			Block_Size = ILI9341_LINE_BUFFER_SIZE;
+		}
+
+		uint16_t *burst_buffer = (uint16_t*)ILI9341_StreamGetBuffer();
+		if (Buffers_Prepared < 2) {
+			for (uint32_t j = 0; j < Block_Size / 2; j++) {
+				burst_buffer[j] = Colour;
+			}
+			Buffers_Prepared++;
+		}
+
+		ILI9341_StreamSubmit(Block_Size);
+		Sending_Size -= Block_Size;
+	}
+
+	ILI9341_StreamEnd();
+	return;
+#endif
+
+	ILI9341_StreamBegin();
+
+	while (Sending_Size > 0) {
+		uint32_t Block_Size = Sending_Size;
+		if (Block_Size > ILI9341_LINE_BUFFER_SIZE) {
+			Block_Size = ILI9341_LINE_BUFFER_SIZE;
+		}
+
+		uint8_t *burst_buffer = ILI9341_StreamGetBuffer();
+		if (Buffers_Prepared < 2) {
+			for (uint32_t j = 0; j < Block_Size; j += 2) {
+				burst_buffer[j] = Colour >> 8; // High byte of the color
+				burst_buffer[j+1] = Colour;    // Low byte of the color
+			}
+			Buffers_Prepared++;
+		}
+
+		ILI9341_StreamSubmit(Block_Size);
+		Sending_Size -= Block_Size;
+	}
+
+	ILI9341_StreamEnd();
+}
+
+/**
+ * @brief  Sendet einen Burst einer bestimmten Farbe an das ILI9341-Display für eine angegebene Anzahl von Pixeln.
+ *
+ * Diese Funktion sendet Farbdaten als Burst an das Display unter Verwendung des Memory-Write-Befehls (0x2C).
+ * Die Übertragung läuft über die Ping-Pong-Zeilenpuffer (ILI9341_StreamBegin()), sodass jeweils
+ * ILI9341_LINE_BUFFER_SIZE Bytes pro DMA-Transfer gesendet werden. Die Farbe wird im
+ * 16-Bit-Format (RGB565) gesendet.
+ *
+ * Der Algorithmus funktioniert wie folgt:
+ * 1. Senden des Memory-Write-Befehls an das Display
+ * 2. Beide Zeilenpuffer werden beim ersten Durchlauf mit der Farbe gefüllt
+ * 3. Danach werden die Puffer abwechselnd per DMA gesendet, bis alle Pixel übertragen sind
+ *
+ * @param  Colour Die 16-Bit-Farbwert (RGB565), der gesendet werden soll.
+ * @param  Size   Die Anzahl der Pixel, die mit der angegebenen Farbe gefüllt werden sollen.
+ *
+ * @note   Die Funktion kehrt zurück, sobald der letzte Block gestartet wurde. Der nächste
+ *         Displayzugriff wartet automatisch auf dessen Ende.
+ */
+void ILI9341_DrawColourBurst(uint16_t Colour, uint32_t Size) {
+
+	//COMMAND Memory Write, CS stays asserted for the pixel data
+	ILI9341_ChipSelect();
+	ILI9341_WriteCommandInline(0x2C, NULL, 0);
+
+	ILI9341_StreamColour(Colour, Size);
+}
+
+/**
+ * Sets the rotation of the ILI9341 display.
+ *
+ * This function configures the display's orientation by sending the Memory Access Control (0x36) command
+ * followed by the appropriate parameter to set the rotation. It also updates the display's width and height
+ * based on the selected rotation.
+ *
+ * @param Rotation The desired rotation mode. Supported modes are:
+ *                 - SCREEN_VERTICAL_1: Vertical orientation (default).
+ *                 - SCREEN_HORIZONTAL_1: Horizontal orientation (90 degrees).
+ *                 - SCREEN_VERTICAL_2: Vertical orientation flipped (180 degrees).
+ *                 - SCREEN_HORIZONTAL_2: Horizontal orientation flipped (270 degrees).
+ *
+ * @note If an invalid rotation mode is provided, the function exits without making any changes.
+ *       With ILI9341_FIXED_ORIENTATION only rotations with the fixed aspect ratio are applied.
+ */
+void ILI9341_SetRotation(uint8_t Rotation) {
+	uint8_t data;
+	uint16_t width, height;
+	switch(Rotation)
+		{
+			case SCREEN_VERTICAL_1:
+				data = 0x40|0x08;
+				width = 240;
+				height = 320;
+				break;
 			case SCREEN_HORIZONTAL_1:
 				data = (0x20|0x08);
-				ILI9341_WIDTH  = 320;
-				ILI9341_HEIGHT = 240;
+				width  = 320;
+				height = 240;
 				break;
 			case SCREEN_VERTICAL_2:
 				data = (0x80|0x08);
-				ILI9341_WIDTH  = 240;
-				ILI9341_HEIGHT = 320;
+				width  = 240;
+				height = 320;
 				break;
 			case SCREEN_HORIZONTAL_2:
 				data = (0x40|0x80|0x20|0x08);
-				ILI9341_WIDTH  = 320;
-				ILI9341_HEIGHT = 240;
+				width  = 320;
+				height = 240;
 				break;
 			default:
 				//EXIT IF SCREEN ROTATION NOT VALID!
 				return;
 		}
-	ILI9341_SendData(&data, 1);
+	if (!ILI9341_ApplySize(width, height)) {
+		return;
+	}
+
+	ILI9341_SendCommandWithParam_8Bit(0x36, &data, 1);
+	ILI9341_MemoryAccess = data;
+}
+
+/**
+ * @brief  Legt die Ausrichtung des ILI9341-Displays fest.
+ *
+ * Diese Funktion konfiguriert die Ausrichtung des Displays durch Senden des
+ * Memory Access Control-Befehls (0x36) gefolgt vom entsprechenden MADCTL-Parameter.
+ * Sie aktualisiert auch die Breite und Höhe des Displays basierend auf der gewählten
+ * Ausrichtung.
+ *
+ * Die MADCTL-Bits haben folgende Bedeutung:
+ *   - MY: Row Address Order (0=Top to Bottom, 1=Bottom to Top)
+ *   - MX: Column Address Order (0=Left to Right, 1=Right to Left)
+ *   - MV: Row/Column Exchange (0=Normal, 1=Vertauscht)
+ *   - ML: Vertical Refresh Order (0=Normal, 1=Umgekehrt)
+ *   - BGR: RGB/BGR Order (0=RGB, 1=BGR Format)
+ *
+ * @param orientation Der gewünschte Ausrichtungsmodus. Unterstützte Modi sind:
+ *                    - ILI9341_PORTRAIT: 0° Portrait.
+ *                    - ILI9341_LANDSCAPE: 90° Querformat.
+ *                    - ILI9341_PORTRAIT_INVERTED: 180° Invertiertes Portrait.
+ *                    - ILI9341_LANDSCAPE_INVERTED: 270° Invertiertes Querformat.
+ *                    - TEST: Benutzerdefinierte Ausrichtung für Testzwecke.
+ *                    - ILI9341_PORTRAIT_TRUE: Echte Portrait-Ausrichtung.
+ *
+ * @note Diese Funktion aktualisiert die globalen Variablen ILI9341_WIDTH und
+ *       ILI9341_HEIGHT entsprechend der gewählten Ausrichtung (240x320 oder 320x240).
+ *       Mit ILI9341_FIXED_ORIENTATION sind beide Konstanten, Ausrichtungen mit anderem
+ *       Seitenverhältnis werden dann ignoriert.
+ */
+void ILI9341_SetOrientation(ILI9341_Orientation orientation) {
+    uint8_t madctl = 0;
+    uint16_t width = ILI9341_WIDTH, height = ILI9341_HEIGHT;
+
+    switch(orientation) {
+        case ILI9341_PORTRAIT: // 0° Portrait
+            madctl = 0x08;  // MY=0, MX=0, MV=0, ML=0, BGR=1
+            width = 240;
+            height = 320;
+            break;
+
+        case ILI9341_LANDSCAPE: // 90° Landscape
+            madctl = 0x68;  // MY=0, MX=1, MV=1, ML=0, BGR=1
+            width = 320;
+            height = 240;
+            break;
+
+        case ILI9341_PORTRAIT_INVERTED: // 180° Inverted Portrait
+            madctl = 0xC8;  // MY=1, MX=1, MV=0, ML=0, BGR=1
+            width = 240;
+            height = 320;
+            break;
+
+        case ILI9341_LANDSCAPE_INVERTED: // 270° Inverted Landscape
+            madctl = 0xA8;  // MY=1, MX=0, MV=1, ML=0, BGR=1
+            width = 320;
+            height = 240;
+            break;
+        case TEST:
+        	madctl = 0b00101000;  // MY=1, MX=0, MV=1, ML=0, BGR=1
+			width = 320;
+			height = 240;
+			break;
+        case ILI9341_PORTRAIT_TRUE:
+        	madctl = 0b10001000;  // MY=0, MX=0, MV=0, ML=0, BGR=1
+			width = 240;
+			height = 320;
+    }
+
+    if (!ILI9341_ApplySize(width, height)) {
+        return;
+    }
+
+    // Send command to set MADCTL
+    ILI9341_SendCommandWithParam_8Bit(0x36, &madctl, 1);
+    ILI9341_MemoryAccess = madctl;
+}
+
+/**
+ * @brief  Liefert das zuletzt mit ILI9341_SetRotation()/ILI9341_SetOrientation() gesetzte MADCTL.
+ *
+ * Das Hardware-Scrolling arbeitet auf den Zeilen des Panels; MV (0x20) und MY (0x80) sagen,
+ * ob und in welcher Richtung diese im Querformat als Spalten erscheinen.
+ */
+uint8_t ILI9341_GetMemoryAccess() {
+	return ILI9341_MemoryAccess;
+}
+
+/**
+ * @brief  Übernimmt die Displaygröße einer neuen Ausrichtung
+ * @retval 0, wenn sie nicht zur festen Ausrichtung (ILI9341_FIXED_ORIENTATION) passt
+ */
+static uint8_t ILI9341_ApplySize(uint16_t width, uint16_t height) {
+#ifdef ILI9341_FIXED_ORIENTATION
+	return width == ILI9341_WIDTH && height == ILI9341_HEIGHT;
+#else
+	ILI9341_WIDTH = width;
+	ILI9341_HEIGHT = height;
+	return 1;
+#endif
+}
+
+/* --------------------------------- Hardware-Scrolling --------------------------------- */
+
+/**
+ * @brief  Legt den Bereich für das Hardware-Scrolling fest (Vertical Scrolling Definition, 0x33).
+ *
+ * Der Displayspeicher wird in einen festen oberen Bereich, einen Scrollbereich und einen
+ * festen unteren Bereich geteilt. Die Angaben beziehen sich auf die 320 Zeilen des Panels
+ * und damit auf die Hochformat-Ausrichtung; im Querformat verschiebt das Scrolling horizontal.
+ *
+ * @param  TopFixed     Anzahl fester Zeilen oben.
+ * @param  ScrollHeight Anzahl Zeilen im Scrollbereich.
+ * @param  BottomFixed  Anzahl fester Zeilen unten.
+ * @retval HAL_ERROR wenn die Summe nicht 320 ergibt, sonst Status der SPI-Übertragung.
+ */
+HAL_StatusTypeDef ILI9341_ScrollDefine(uint16_t TopFixed, uint16_t ScrollHeight, uint16_t BottomFixed) {
+	if ((uint32_t)TopFixed + ScrollHeight + BottomFixed != 320) {
+		return HAL_ERROR;
+	}
+
+	uint8_t params[6] = {
+		TopFixed >> 8, TopFixed,
+		ScrollHeight >> 8, ScrollHeight,
+		BottomFixed >> 8, BottomFixed
+	};
+	return ILI9341_SendCommandWithParam_8Bit(0x33, params, 6);
+}
+
+/**
+ * @brief  Setzt die erste angezeigte Speicherzeile des Scrollbereichs (Vertical Scrolling Start Address, 0x37).
+ *
+ * Die Zeile Line erscheint am oberen Rand des Scrollbereichs, die Zeilen darüber werden
+ * unten wieder eingeblendet. Zum Scrollen muss also nur dieser eine Befehl gesendet werden.
+ *
+ * @param  Line Speicherzeile, TopFixed <= Line < TopFixed + ScrollHeight.
+ */
+void ILI9341_ScrollTo(uint16_t Line) {
+	uint8_t params[2] = { Line >> 8, Line };
+	ILI9341_SendCommandWithParam_8Bit(0x37, params, 2);
+}
+
+/**
+ * @brief  Beendet das Scrolling und kehrt in den normalen Anzeigemodus zurück (Normal Display Mode On, 0x13).
+ */
+void ILI9341_ScrollDisable() {
+	ILI9341_ScrollTo(0);
+	ILI9341_SendCommand(0x13);
+}
+
+/* --------------------------------- Clip-Rechteck --------------------------------- */
+
+// Clip rectangle in display coordinates (inclusive); while 0 everything is cut at the display only
+static uint8_t ILI9341_Clipped = 0;
+static int16_t ILI9341_ClipX1, ILI9341_ClipY1, ILI9341_ClipX2, ILI9341_ClipY2;
+
+/**
+ * @brief  Beschreibbarer Bereich (inklusive), Kern von ILI9341_GetClip() und ILI9341_ClipRect()
+ */
+static inline void ILI9341_ClipBounds(int16_t *x1, int16_t *y1, int16_t *x2, int16_t *y2) {
+	*x1 = 0;
+	*y1 = 0;
+	*x2 = ILI9341_WIDTH - 1;
+	*y2 = ILI9341_HEIGHT - 1;
+	if (ILI9341_Clipped) {
+		if (ILI9341_ClipX1 > *x1) *x1 = ILI9341_ClipX1;
+		if (ILI9341_ClipY1 > *y1) *y1 = ILI9341_ClipY1;
+		if (ILI9341_ClipX2 < *x2) *x2 = ILI9341_ClipX2;
+		if (ILI9341_ClipY2 < *y2) *y2 = ILI9341_ClipY2;
+	}
+}
+
+/**
+ * @brief  Begrenzt alle folgenden Zeichenaufrufe zusätzlich auf ein Rechteck.
+ *
+ * Formen, die vollständig außerhalb liegen, werden vor jedem Buszugriff verworfen, teilweise
+ * sichtbare auf ihre Spans bzw. ihr Fenster innerhalb des Rechtecks beschnitten. Das gilt für
+ * den direkten Weg ebenso wie für Framebuffer, Kacheln, Sprites und skalierte Bilder.
+ * Das Rechteck bleibt über einen Wechsel der Ausrichtung hinweg bestehen.
+ */
+void ILI9341_SetClip(int16_t x, int16_t y, uint16_t width, uint16_t height) {
+	int32_t x2 = (int32_t)x + width - 1, y2 = (int32_t)y + height - 1;
+
+	ILI9341_ClipX1 = x;
+	ILI9341_ClipY1 = y;
+	ILI9341_ClipX2 = x2 > INT16_MAX ? INT16_MAX : x2;
+	ILI9341_ClipY2 = y2 > INT16_MAX ? INT16_MAX : y2;
+	ILI9341_Clipped = 1;
+}
+
+/**
+ * @brief  Hebt das Clip-Rechteck auf, es wird nur noch am Display geschnitten
+ */
+void ILI9341_ResetClip(void) {
+	ILI9341_Clipped = 0;
+}
+
+/**
+ * @brief  Liefert den beschreibbaren Bereich: Display geschnitten mit dem Clip-Rechteck
+ * @param  x1, y1, x2, y2: Ecken (inklusive)
+ * @retval 0, wenn der Bereich leer ist
+ */
+uint8_t ILI9341_GetClip(int16_t *x1, int16_t *y1, int16_t *x2, int16_t *y2) {
+	ILI9341_ClipBounds(x1, y1, x2, y2);
+	return *x1 <= *x2 && *y1 <= *y2;
+}
+
+/**
+ * @brief  Schneidet ein Rechteck auf die Displayfläche und das Clip-Rechteck zu (Koordinaten dürfen negativ sein)
+ * @retval 0, wenn nichts sichtbar bleibt
+ */
+uint8_t ILI9341_ClipRect(int16_t *x, int16_t *y, int16_t *w, int16_t *h) {
+	int16_t left, top, right, bottom;
+	ILI9341_ClipBounds(&left, &top, &right, &bottom);
+
+	int32_t x1 = *x, y1 = *y;
+	int32_t x2 = x1 + *w, y2 = y1 + *h;		// exclusive
+
+	if (x1 < left) x1 = left;
+	if (y1 < top) y1 = top;
+	if (x2 > right + 1) x2 = right + 1;
+	if (y2 > bottom + 1) y2 = bottom + 1;
+	if (x2 <= x1 || y2 <= y1) return 0;
+
+	*x = x1;
+	*y = y1;
+	*w = x2 - x1;
+	*h = y2 - y1;
+	return 1;
+}
+
+/**
+ * @brief  Verwirft eine Form, deren Begrenzungsrechteck (inklusive) ganz außerhalb des beschreibbaren Bereichs liegt
+ * @retval 1, wenn nichts von ihr sichtbar sein kann
+ */
+static uint8_t ILI9341_ClipReject(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+	int16_t left, top, right, bottom;
+	ILI9341_ClipBounds(&left, &top, &right, &bottom);
+
+	return x1 > x2 || y1 > y2 || x2 < left || x1 > right || y2 < top || y1 > bottom;
+}
+
+/**
+ * @brief  Füllt den sichtbaren Teil eines Rechtecks im Framebuffer, in den Kacheln oder direkt auf dem Display.
+ *
+ * Beschnitten wird vor der Verzweigung, ein Rechteck außerhalb des Clip-Rechtecks kostet
+ * also in keinem Betrieb etwas. Übergroße Breiten und Höhen werden begrenzt statt umzubrechen.
+ */
+static void ILI9341_FillWindow(int16_t x, int16_t y, int32_t w, int32_t h, uint16_t color) {
+	if (w <= 0 || h <= 0) return;
+	int16_t cw = w > INT16_MAX ? INT16_MAX : w;
+	int16_t ch = h > INT16_MAX ? INT16_MAX : h;
+	if (!ILI9341_ClipRect(&x, &y, &cw, &ch)) return;
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_FillRect(x, y, cw, ch, color);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_FillRect(x, y, cw, ch, color)) {
+		return;
+	}
+#endif
+	ILI9341_BeginWrite(x, y, x + cw - 1, y + ch - 1);
+	ILI9341_StreamColour(color, (uint32_t)cw * ch);
+}
+
+/**
+ * @brief  Zeichnet ein Rechteck auf dem ILI9341-Display.
+ * @param  x: X-Koordinate der oberen linken Ecke des Rechtecks.
+ * @param  y: Y-Koordinate der oberen linken Ecke des Rechtecks.
+ * @param  w: Breite des Rechtecks.
+ * @param  h: Höhe des Rechtecks.
+ * @param  color: Farbe des Rechtecks (16-Bit RGB565 Format).
+ * @retval None
+ */
+void ILI9341_DrawRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+	ILI9341_FillWindow(x, y, w, h, color);
+}
+
+/**
+ * @brief  Füllt einen rechteckigen Bereich auf dem ILI9341-Display mit einer bestimmten Farbe.
+ *
+ * Diese Funktion setzt das Adressfenster auf den angegebenen rechteckigen Bereich und
+ * füllt diesen mit der angegebenen Farbe, indem sie einen Farb-Burst verwendet. Der rechteckige
+ * Bereich wird durch seine obere linke Ecke, Breite und Höhe definiert.
+ *
+ * Die Funktion nutzt folgende Hilfsfunktionen:
+ * - ILI9341_BeginWrite(): Legt den Adressbereich fest und startet den Memory-Write in einer CS-Phase
+ * - ILI9341_StreamColour(): Füllt den festgelegten Bereich mit der angegebenen Farbe
+ *
+ * @param x     Die x-Koordinate der oberen linken Ecke des Rechtecks.
+ * @param y     Die y-Koordinate der oberen linken Ecke des Rechtecks.
+ * @param w     Die Breite des Rechtecks in Pixeln.
+ * @param h     Die Höhe des Rechtecks in Pixeln.
+ * @param color Der 16-Bit-Farbwert (RGB565-Format) zum Füllen des Rechtecks.
+ *
+ * @note   Diese Funktion ist ähnlich zu ILI9341_DrawRectangle(), verwendet jedoch
+ *         andere Parametertypen (int16_t statt uint16_t) für die Positionierung.
+ */
+void ILI9341_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+	ILI9341_FillWindow(x, y, w, h, color);
+}
+
+/**
+ * @brief  Zeichnet eine horizontale Linie auf dem ILI9341-Display.
+ *
+ * Diese Funktion zeichnet eine horizontale Linie von einem bestimmten Startpunkt (x,y)
+ * mit einer angegebenen Breite und Farbe. Der Algorithmus nutzt optimierte
+ * Zeichenmethoden, indem er:
+ * 1. Das Adressfenster auf die exakte Größe der Linie setzt (von (x,y) bis (x+w-1,y))
+ * 2. Einen Farb-Burst verwendet, um alle Pixel der Linie in einem einzigen Vorgang zu füllen
+ *
+ * @param  x     Die x-Koordinate des Startpunkts der Linie.
+ * @param  y     Die y-Koordinate des Startpunkts der Linie.
+ * @param  w     Die Breite (Länge) der Linie in Pixeln.
+ * @param  color Die Farbe der Linie im 16-Bit RGB565-Format.
+ *
+ * @note   Diese Funktion ist effizienter als das separate Zeichnen einzelner Pixel,
+ *         da sie die schnelle Burst-Methode verwendet.
+ */
+void ILI9341_DrawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
+	ILI9341_FillWindow(x, y, w, 1, color);
+}
+/**
+ * @brief  Zeichnet eine vertikale Linie auf dem ILI9341-Display.
+ *
+ * Diese Funktion zeichnet eine vertikale Linie von einem bestimmten Startpunkt (x,y)
+ * mit einer angegebenen Höhe und Farbe. Der Algorithmus nutzt optimierte
+ * Zeichenmethoden, indem er:
+ * 1. Das Adressfenster auf die exakte Größe der Linie setzt (von (x,y) bis (x,y+h-1))
+ * 2. Einen Farb-Burst verwendet, um alle Pixel der Linie in einem einzigen Vorgang zu füllen
+ *
+ * @param  x     Die x-Koordinate des Startpunkts der Linie.
+ * @param  y     Die y-Koordinate des Startpunkts der Linie.
+ * @param  h     Die Höhe (Länge) der Linie in Pixeln.
+ * @param  color Die Farbe der Linie im 16-Bit RGB565-Format.
+ *
+ * @note   Diese Funktion ist effizienter als das separate Zeichnen einzelner Pixel,
+ *         da sie die schnelle Burst-Methode verwendet.
+ */
+void ILI9341_DrawVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color) {
+	ILI9341_FillWindow(x, y, 1, h, color);
+}
+
+/**
+ * @brief  Zeichnet einen einzelnen Pixel auf dem ILI9341-Display.
+ *
+ * Diese Funktion setzt einen einzelnen Pixel an den angegebenen Koordinaten mit der
+ * gewünschten Farbe. Der Algorithmus funktioniert wie folgt:
+ * 1. Setzen des Adressfensters auf genau einen Pixel an Position (x,y)
+ * 2. Aufteilen des 16-Bit-Farbwerts in zwei 8-Bit-Werte (High-Byte und Low-Byte)
+ * 3. Senden des Memory-Write-Befehls (0x2C) an das Display
+ * 4. Übertragen der Farbdaten über die SPI-Schnittstelle
+ *
+ * @param  x     Die x-Koordinate des zu zeichnenden Pixels.
+ * @param  y     Die y-Koordinate des zu zeichnenden Pixels.
+ * @param  color Die Farbe des Pixels im 16-Bit RGB565-Format.
+ *
+ * @note   Diese Funktion ist der grundlegende Baustein für alle komplexeren Zeichenoperationen,
+ *         wird aber für größere Zeichenoperationen zugunsten effizienterer Methoden wie
+ *         ILI9341_DrawColourBurst() vermieden.
+ */
+void ILI9341_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
+	if (x >= ILI9341_WIDTH || y >= ILI9341_HEIGHT) return;
+	if (ILI9341_Clipped && ((int16_t)x < ILI9341_ClipX1 || (int16_t)x > ILI9341_ClipX2 ||
+			(int16_t)y < ILI9341_ClipY1 || (int16_t)y > ILI9341_ClipY2)) return;
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawPixel(x, y, color);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_FillRect(x, y, 1, 1, color)) {
+		return;
+	}
+#endif
+	unsigned char cholor = color>>8;
+	unsigned char buffer[2] = {cholor,color};
+	//Window + COMMAND Memory Write in one CS phase
+	ILI9341_BeginWrite(x, y, x, y);
+
+	ILI9341_SendData(buffer, 2);
+}
+/**
+ * @brief  Zeichnet einen einzelnen Pixel auf dem ILI9341-Display mit RGB-Farbkomponenten.
+ *
+ * Diese Funktion ermöglicht das Setzen eines Pixels mit separaten 8-Bit RGB-Farbwerten,
+ * was eine intuitivere Farbdefinition im Vergleich zum direkten RGB565-Format ermöglicht.
+ * Der Algorithmus führt folgende Schritte aus:
+ * 1. Konvertiert die 8-Bit RGB-Werte (R: 0-255, G: 0-255, B: 0-255) in das 16-Bit RGB565-Format:
+ *    - Rot: Die oberen 5 Bits werden verwendet (R & 0xF8) und um 8 Bits nach links verschoben
+ *    - Grün: Die oberen 6 Bits werden verwendet (G & 0xFC) und um 3 Bits nach links verschoben
+ *    - Blau: Die oberen 5 Bits werden verwendet (B >> 3)
+ * 2. Ruft ILI9341_DrawPixel() auf, um den Pixel mit der berechneten Farbe zu setzen
+ *
+ * @param  x  Die x-Koordinate des zu zeichnenden Pixels.
+ * @param  y  Die y-Koordinate des zu zeichnenden Pixels.
+ * @param  r  Die Rot-Komponente der Farbe (8-Bit, 0-255).
+ * @param  g  Die Grün-Komponente der Farbe (8-Bit, 0-255).
+ * @param  b  Die Blau-Komponente der Farbe (8-Bit, 0-255).
+ *
+ */
+void ILI9341_DrawPixelRGB(uint16_t x,uint16_t y,uint8_t r, uint8_t g, uint8_t b){
+	ILI9341_DrawPixel(x, y, ILI9341_Colour_RGB(r, g, b));
+}
+
+
+/**
+ * @brief  Draws the outline of a circle on the display.
+ * @param  x_pos: X-coordinate of the circle center.
+ * @param  y_pos: Y-coordinate of the circle center.
+ * @param  r: Radius of the circle.
+ * @param  color: Color of the circle outline (16-bit RGB565 format).
+ * @retval None
+ *
+ * This function implements the Midpoint Circle Algorithm to efficiently
+ * draw a circle by plotting symmetric points in all eight octants.
+ */
+/* --------------------------------- Span-Rasterizer --------------------------------- */
+
+/**
+ * @brief Offenes Rechteck des Span-Rasterizers: Zeilen mit gleichem Span werden zusammengefasst
+ */
+typedef struct {
+	int16_t x1, x2;
+	int16_t y1, y2;
+	uint8_t used;
+} ILI9341_SpanRect;
+
+ILI9341_SpanRect ILI9341_SpanPending[ILI9341_SPAN_SLOTS] FASTDATA;
+uint16_t ILI9341_SpanColour;
+uint8_t ILI9341_SpanSelected = 0;	// CS wurde vom Rasterizer aktiviert
+
+// Eine Displayzeile in der aktuellen Farbe (High-Byte zuerst) für kurze, blockierende Spans
+uint8_t ILI9341_SpanColourBuffer[320 * 2] __attribute__((aligned(32)));
+uint16_t ILI9341_SpanBufferColour;
+uint8_t ILI9341_SpanBufferValid = 0;
+
+// Halbe Breiten der Kreiszeilen (Index = Abstand zur Mittelzeile), zwei Tabellen für äußere/innere Form
+int16_t ILI9341_SpanWidths[2][ILI9341_SPAN_MAX_RADIUS + 2] FASTDATA;
+
+/**
+ * @brief  Beginnt eine Form in einer Farbe.
+ */
+static void ILI9341_SpanBegin(uint16_t color) {
+	ILI9341_SpanColour = color;
+	for (uint8_t i = 0; i < ILI9341_SPAN_SLOTS; i++) {
+		ILI9341_SpanPending[i].used = 0;
+	}
+
+	if (!ILI9341_SpanBufferValid || ILI9341_SpanBufferColour != color) {
+		// Der Puffer wird nur blockierend gesendet, kann also sofort überschrieben werden
+		for (uint32_t i = 0; i < sizeof(ILI9341_SpanColourBuffer); i += 2) {
+			ILI9341_SpanColourBuffer[i] = color >> 8;
+			ILI9341_SpanColourBuffer[i + 1] = color;
+		}
+		ILI9341_SpanBufferColour = color;
+		ILI9341_SpanBufferValid = 1;
+	}
+}
+
+/**
+ * @brief  Zeichnet ein fertiges Rechteck des Rasterizers.
+ *
+ * Alle Rechtecke einer Form laufen in derselben CS-Phase: Fenster (nur geänderte Hälften),
+ * Memory Write und die Pixel folgen direkt aufeinander. Kurze Läufe werden blockierend aus
+ * dem Farbpuffer gesendet, längere über die Ping-Pong-Zeilenpuffer per DMA.
+ */
+static void ILI9341_SpanEmit(const ILI9341_SpanRect *r) {
+	uint32_t pixels = (uint32_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_FillRect(r->x1, r->y1, r->x2 - r->x1 + 1, r->y2 - r->y1 + 1, ILI9341_SpanColour);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_FillRect(r->x1, r->y1, r->x2 - r->x1 + 1, r->y2 - r->y1 + 1, ILI9341_SpanColour)) {
+		return;
+	}
+#endif
+
+	if (!ILI9341_SpanSelected) {
+		ILI9341_ChipSelect();
+		ILI9341_SpanSelected = 1;
+	}
+	ILI9341_WriteWindowInline(r->x1, r->y1, r->x2, r->y2);
+	ILI9341_WriteCommandInline(0x2C, NULL, 0);
+
+	if (ILI9341_BatchRecording || pixels * 2 > sizeof(ILI9341_SpanColourBuffer)) {
+		ILI9341_StreamColour(ILI9341_SpanColour, pixels);	// Gibt CS am Ende frei
+		ILI9341_SpanSelected = 0;
+		return;
+	}
+	BUSSTAT_CALL(BUSSTAT_ID_ILI9341, BUSSTAT_DATA, pixels * 2,
+			HAL_SPI_Transmit(ILI9341_SPI, ILI9341_SpanColourBuffer, pixels * 2, 100));
+}
+
+/**
+ * @brief  Fügt einen horizontalen Span [x1, x2] in Zeile y hinzu.
+ *
+ * Jeder Slot fasst aufeinanderfolgende Zeilen mit gleichem Span zu einem Rechteck
+ * zusammen, sodass z.B. der Mittelteil eines abgerundeten Rechtecks nur ein Fenster braucht.
+ * Formen mit mehreren Spans pro Zeile (Ringe, Polygone) nutzen je Span einen eigenen Slot.
+ *
+ * @param  slot   Slot 0 .. ILI9341_SPAN_SLOTS-1.
+ * @param  x1, x2 Erste und letzte Spalte (inklusive), wird auf ILI9341_GetClip() beschnitten.
+ * @param  y      Zeile.
+ */
+RAMFUNC static void ILI9341_SpanFill(uint8_t slot, int16_t x1, int16_t x2, int16_t y) {
+	int16_t left, top, right, bottom;
+	ILI9341_ClipBounds(&left, &top, &right, &bottom);
+	if (y < top || y > bottom) return;
+	if (x1 < left) x1 = left;
+	if (x2 > right) x2 = right;
+	if (x1 > x2) return;
+
+	ILI9341_SpanRect *p = &ILI9341_SpanPending[slot];
+	if (p->used && p->x1 == x1 && p->x2 == x2 && p->y2 + 1 == y) {
+		p->y2 = y;
+		return;
+	}
+	if (p->used) {
+		ILI9341_SpanEmit(p);
+	}
+	p->x1 = x1;
+	p->x2 = x2;
+	p->y1 = y;
+	p->y2 = y;
+	p->used = 1;
+}
+
+/**
+ * @brief  Zeichnet die restlichen Rechtecke und beendet die Form.
+ */
+static void ILI9341_SpanEnd() {
+	for (uint8_t i = 0; i < ILI9341_SPAN_SLOTS; i++) {
+		if (ILI9341_SpanPending[i].used) {
+			ILI9341_SpanEmit(&ILI9341_SpanPending[i]);
+			ILI9341_SpanPending[i].used = 0;
+		}
+	}
+	if (ILI9341_SpanSelected) {
+		ILI9341_ChipDeselect();
+		ILI9341_SpanSelected = 0;
+	}
+}
+
+/**
+ * @brief  Berechnet die halben Zeilenbreiten eines Kreises.
+ *
+ * widths[d] ist der größte Abstand x mit x² + d² <= r² + r (entspricht dem
+ * Mittelpunkt-Algorithmus), widths[r+1] = -1 markiert die erste Zeile außerhalb.
+ *
+ * @retval Der auf ILI9341_SPAN_MAX_RADIUS begrenzte Radius.
+ */
+static int16_t ILI9341_CircleWidths(int16_t r, int16_t *widths) {
+	if (r < 0) r = 0;
+	if (r > ILI9341_SPAN_MAX_RADIUS) r = ILI9341_SPAN_MAX_RADIUS;
+
+	int32_t limit = (int32_t)r * r + r;
+	int16_t x = r;
+	for (int16_t d = 0; d <= r; d++) {
+		while (x > 0 && (int32_t)x * x + (int32_t)d * d > limit) {
+			x--;
+		}
+		widths[d] = x;
+	}
+	widths[r + 1] = -1;
+	return r;
+}
+
+/**
+ * @brief  Liefert den Span eines abgerundeten Rechtecks in einer Zeile.
+ * @retval 1 wenn die Zeile zum Rechteck gehört, sonst 0.
+ */
+static uint8_t ILI9341_RoundRectRow(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+		const int16_t *widths, int16_t row, int16_t *x1, int16_t *x2) {
+	if (w <= 0 || h <= 0 || row < y || row >= y + h) return 0;
+
+	int16_t d = 0;
+	if (row < y + r) {
+		d = y + r - row;
+	} else if (row > y + h - 1 - r) {
+		d = row - (y + h - 1 - r);
+	}
+
+	int16_t inset = (d > 0) ? r - widths[d] : 0;
+	*x1 = x + inset;
+	*x2 = x + w - 1 - inset;
+	return 1;
+}
+
+/**
+ * @brief  Begrenzt den Eckradius auf die halbe Breite/Höhe und füllt die Breitentabelle.
+ */
+static int16_t ILI9341_RoundRectRadius(int16_t w, int16_t h, int16_t r, int16_t *widths) {
+	if (r > w / 2) r = w / 2;
+	if (r > h / 2) r = h / 2;
+	return ILI9341_CircleWidths(r, widths);
+}
+
+/**
+ * @brief  Zeichnet einen Kreisumriss.
+ *
+ * Pro Zeile werden nur die Randpixel als (höchstens zwei) Spans gezeichnet; flache Stellen
+ * oben und unten werden zu einem Span, senkrechte Stellen links und rechts zu Rechtecken
+ * zusammengefasst. Die ganze Form läuft in einer CS-Phase.
+ *
+ * @param  x_pos, y_pos Mittelpunkt.
+ * @param  r            Radius.
+ * @param  color        Farbe (RGB565).
+ */
+void ILI9341_DrawCircleOutline(uint16_t x_pos, uint16_t y_pos, uint8_t r, uint16_t color) {
+	int16_t *widths = ILI9341_SpanWidths[0];
+	int16_t x0 = x_pos, y0 = y_pos;
+	r = ILI9341_CircleWidths(r, widths);
+	if (ILI9341_ClipReject(x0 - r, y0 - r, x0 + r, y0 + r)) return;
+
+	ILI9341_SpanBegin(color);
+	for (int16_t dy = -r; dy <= r; dy++) {
+		int16_t d = (dy < 0) ? -dy : dy;
+		int16_t outer = widths[d];
+		int16_t inner = widths[d + 1];
+		if (inner > outer - 1) inner = outer - 1;	// Innen liegt, wessen Nachbarn alle im Kreis liegen
+
+		if (inner < 0) {
+			ILI9341_SpanFill(0, x0 - outer, x0 + outer, y0 + dy);
+		} else {
+			ILI9341_SpanFill(0, x0 - outer, x0 - inner - 1, y0 + dy);
+			ILI9341_SpanFill(1, x0 + inner + 1, x0 + outer, y0 + dy);
+		}
+	}
+	ILI9341_SpanEnd();
+}
+
+/**
+ * @brief  Zeichnet einen gefüllten Kreis (siehe ILI9341_DrawFilledCircle()).
+ */
+void ILI9341_DrawCircle(uint16_t x_pos, uint16_t y_pos, uint8_t r, uint16_t color) {
+	ILI9341_DrawFilledCircle(x_pos, y_pos, r, color);
+}
+
+/**
+ * @brief  Zeichnet einen gefüllten Kreis als ein Span pro Zeile in einer CS-Phase.
+ *
+ * @param  x0, y0 Mittelpunkt.
+ * @param  radius Radius (max. ILI9341_SPAN_MAX_RADIUS).
+ * @param  color  Farbe (RGB565).
+ */
+void ILI9341_DrawFilledCircle(uint16_t x0, uint16_t y0, uint16_t radius, uint16_t color) {
+	int16_t *widths = ILI9341_SpanWidths[0];
+	int16_t r = ILI9341_CircleWidths(radius > ILI9341_SPAN_MAX_RADIUS ? ILI9341_SPAN_MAX_RADIUS : radius, widths);
+	if (ILI9341_ClipReject((int16_t)x0 - r, (int16_t)y0 - r, (int16_t)x0 + r, (int16_t)y0 + r)) return;
+
+	ILI9341_SpanBegin(color);
+	for (int16_t dy = -r; dy <= r; dy++) {
+		int16_t hw = widths[(dy < 0) ? -dy : dy];
+		ILI9341_SpanFill(0, (int16_t)x0 - hw, (int16_t)x0 + hw, (int16_t)y0 + dy);
+	}
+	ILI9341_SpanEnd();
+}
+
+/**
+ * @brief  Füllt ein Polygon (gerade-ungerade Regel) mit einer Farbe.
+ *
+ * Für jede Zeile werden die Schnittpunkte mit allen Kanten bestimmt, sortiert und
+ * paarweise als Spans gezeichnet. Eine Zeile y gehört zu einer Kante, wenn
+ * y_oben <= y < y_unten gilt, sodass sich angrenzende Polygone nicht überlappen.
+ *
+ * @param  X, Y   Eckpunkte.
+ * @param  Count  Anzahl der Eckpunkte (3 .. ILI9341_POLYGON_MAX_POINTS).
+ * @param  color  Farbe (RGB565).
+ */
+void ILI9341_FillPolygon(const int16_t *X, const int16_t *Y, uint8_t Count, uint16_t color) {
+	if (Count < 3 || Count > ILI9341_POLYGON_MAX_POINTS) return;
+
+	int16_t xMin = X[0], xMax = X[0], yMin = Y[0], yMax = Y[0];
+	for (uint8_t i = 1; i < Count; i++) {
+		if (X[i] < xMin) xMin = X[i];
+		if (X[i] > xMax) xMax = X[i];
+		if (Y[i] < yMin) yMin = Y[i];
+		if (Y[i] > yMax) yMax = Y[i];
+	}
+	if (ILI9341_ClipReject(xMin, yMin, xMax, yMax)) return;
+
+	// Only rows inside the clip rectangle are scanned
+	int16_t left, top, right, bottom;
+	ILI9341_ClipBounds(&left, &top, &right, &bottom);
+	if (yMin < top) yMin = top;
+	if (yMax > bottom + 1) yMax = bottom + 1;
+
+	int32_t nodes[ILI9341_POLYGON_MAX_POINTS];
+
+	ILI9341_SpanBegin(color);
+	for (int16_t y = yMin; y < yMax; y++) {
+		uint8_t n = 0;
+
+		for (uint8_t i = 0, j = Count - 1; i < Count; j = i++) {
+			int16_t ya = Y[i], yb = Y[j];
+			if ((ya <= y && y < yb) || (yb <= y && y < ya)) {
+				// Schnittpunkt in 8.8-Festkomma
+				nodes[n++] = ((int32_t)X[i] << 8) + ((int32_t)(y - ya) * (((int32_t)X[j] - X[i]) << 8)) / (yb - ya);
+			}
+		}
+
+		// Wenige Schnittpunkte: Insertion Sort
+		for (uint8_t i = 1; i < n; i++) {
+			int32_t v = nodes[i];
+			int8_t k = i - 1;
+			while (k >= 0 && nodes[k] > v) {
+				nodes[k + 1] = nodes[k];
+				k--;
+			}
+			nodes[k + 1] = v;
+		}
+
+		for (uint8_t i = 0; i + 1 < n; i += 2) {
+			uint8_t slot = i / 2;
+			if (slot >= ILI9341_SPAN_SLOTS) slot = ILI9341_SPAN_SLOTS - 1;
+			ILI9341_SpanFill(slot, (nodes[i] + 128) >> 8, (nodes[i + 1] + 127) >> 8, y);
+		}
+	}
+	ILI9341_SpanEnd();
+}
+
+/**
+ * @brief  Zeichnet ein beschnittenes Rechteck des Rasterizers sofort (ohne Slot).
+ */
+static void ILI9341_SpanRectFill(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	int16_t left, top, right, bottom;
+	ILI9341_ClipBounds(&left, &top, &right, &bottom);
+	if (x1 < left) x1 = left;
+	if (y1 < top) y1 = top;
+	if (x2 > right) x2 = right;
+	if (y2 > bottom) y2 = bottom;
+	if (x1 > x2 || y1 > y2) return;
+
+	ILI9341_SpanRect r = { x1, x2, y1, y2, 1 };
+	ILI9341_SpanEmit(&r);
+}
+
+/**
+ * @brief  Rastert eine Linie nach Bresenham in Slot 0.
+ *
+ * Die Linie wird immer von oben nach unten durchlaufen. Flache Linien ergeben einen
+ * horizontalen Span je Zeile, steile Linien einen Pixel je Zeile; gleiche Spalten in
+ * aufeinanderfolgenden Zeilen fasst ILI9341_SpanFill() zu einem senkrechten Rechteck zusammen.
+ */
+static void ILI9341_LineSpans(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+	if (y0 > y1) {
+		int16_t t = x0; x0 = x1; x1 = t;
+		t = y0; y0 = y1; y1 = t;
+	}
+	if (ILI9341_ClipReject(x0 < x1 ? x0 : x1, y0, x0 < x1 ? x1 : x0, y1)) return;
+
+	int32_t dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+	int32_t dy = y1 - y0;
+	int16_t sx = (x1 > x0) ? 1 : -1;
+	int16_t x = x0, y = y0;
+
+	if (dx >= dy) {
+		int32_t err = dx / 2;
+		int16_t run = x0;
+		for (int32_t i = 0; i < dx; i++) {
+			x += sx;
+			err -= dy;
+			if (err < 0) {
+				// Zeilenwechsel: bisherigen Lauf ausgeben
+				int16_t last = x - sx;
+				ILI9341_SpanFill(0, (run < last) ? run : last, (run < last) ? last : run, y);
+				y++;
+				err += dx;
+				run = x;
+			}
+		}
+		ILI9341_SpanFill(0, (run < x1) ? run : x1, (run < x1) ? x1 : run, y);
+	} else {
+		int32_t err = dy / 2;
+		for (; y <= y1; y++) {
+			ILI9341_SpanFill(0, x, x, y);
+			err -= dx;
+			if (err < 0) {
+				x += sx;
+				err += dy;
+			}
+		}
+	}
+}
+
+/**
+ * @brief  Zeichnet eine Linie zwischen zwei Punkten (beide inklusive).
+ *
+ * Statt einzelner Pixel entstehen Spans: eine flache Linie braucht ein Fenster je Zeile,
+ * eine steile eines je Spalte, waagrechte und senkrechte Linien genau eines. Alle laufen in
+ * einer CS-Phase. Punkte außerhalb des Displays sind erlaubt, die Linie wird beschnitten.
+ *
+ * @param  x0, y0 Startpunkt.
+ * @param  x1, y1 Endpunkt.
+ * @param  color  Farbe (RGB565).
+ */
+void ILI9341_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+	if (ILI9341_ClipReject(x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, x0 < x1 ? x1 : x0, y0 < y1 ? y1 : y0)) return;
+
+	ILI9341_SpanBegin(color);
+	ILI9341_LineSpans(x0, y0, x1, y1);
+	ILI9341_SpanEnd();
+}
+
+/**
+ * @brief  Zeichnet einen Linienzug durch alle Punkte in einer CS-Phase.
+ *
+ * @param  X, Y   Punkte.
+ * @param  Count  Anzahl der Punkte (ab 2), der Zug wird nicht geschlossen.
+ * @param  color  Farbe (RGB565).
+ */
+void ILI9341_DrawPolyline(const int16_t *X, const int16_t *Y, uint16_t Count, uint16_t color) {
+	if (Count < 2) return;
+
+	ILI9341_SpanBegin(color);
+	for (uint16_t i = 1; i < Count; i++) {
+		ILI9341_LineSpans(X[i - 1], Y[i - 1], X[i], Y[i]);
+	}
+	ILI9341_SpanEnd();
+}
+
+/**
+ * @brief  Zeichnet eine Messkurve mit einem Wert je Spalte.
+ *
+ * Schneller Weg für Zeitreihen: Spalte x + i bekommt einen senkrechten Span vom Wert der
+ * vorigen Spalte (exklusiv) bis Y[i], die Kurve ist also geschlossen, ohne dass Linien
+ * gerastert werden. Gleiche Werte in benachbarten Spalten werden zu einem waagrechten Span
+ * zusammengefasst. Eine Kurve über die volle Breite braucht damit höchstens 320 Fenster, bei
+ * ruhigem Signal deutlich weniger.
+ *
+ * @param  x      Spalte des ersten Wertes.
+ * @param  Y      Displayzeile je Wert (bereits skaliert), Werte außerhalb werden beschnitten.
+ * @param  Count  Anzahl der Werte.
+ * @param  color  Farbe (RGB565).
+ */
+void ILI9341_DrawPlot(int16_t x, const int16_t *Y, uint16_t Count, uint16_t color) {
+	if (Count == 0) return;
+	if (ILI9341_ClipReject(x, INT16_MIN, (int32_t)x + Count - 1, INT16_MAX)) return;
+
+	// Offener Lauf: Rechteck, das noch um weitere Spalten derselben Zeile wachsen kann
+	int16_t rx1 = x, rx2 = x, ry1 = Y[0], ry2 = Y[0];
+
+	ILI9341_SpanBegin(color);
+	for (uint16_t i = 1; i < Count; i++) {
+		int16_t col = x + i;
+		int16_t prev = Y[i - 1], cur = Y[i];
+		int16_t ya = cur, yb = cur;
+		if (cur > prev) {
+			ya = prev + 1;
+		} else if (cur < prev) {
+			yb = prev - 1;
+		}
+
+		if (ya == yb && ry1 == ry2 && ry1 == ya) {
+			rx2 = col;
+			continue;
+		}
+		ILI9341_SpanRectFill(rx1, ry1, rx2, ry2);
+		rx1 = rx2 = col;
+		ry1 = ya;
+		ry2 = yb;
+	}
+	ILI9341_SpanRectFill(rx1, ry1, rx2, ry2);
+	ILI9341_SpanEnd();
+}
+
+void ILI9341_SecretCommand() {
+	uint8_t param = 0x10;
+	ILI9341_SendCommandWithParam_8Bit(0xD9, &param, 1);
+}
+
+/**
+ * @brief  Sendet einen bereits geschnittenen Bildausschnitt zeilenweise über die Zeilenpuffer
+ * @param  image:  erstes sichtbares Pixel
+ * @param  stride: Abstand zweier Bildzeilen in Bytes
+ * @param  swap:   1 = Pixel in CPU-Byte-Reihenfolge (ILI9341_DrawImage16), werden getauscht
+ */
+static void ILI9341_DrawImageRows(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *image, uint32_t stride,
+		uint8_t swap) {
+	uint32_t rowBytes = (uint32_t)w * 2;
+	int16_t rowsPerBuffer = ILI9341_LINE_BUFFER_SIZE / rowBytes;
+
+	ILI9341_BeginWrite(x, y, x + w - 1, y + h - 1);
+	ILI9341_StreamBegin();
+	for (int16_t row = 0; row < h; row += rowsPerBuffer) {
+		int16_t rows = (h - row < rowsPerBuffer) ? h - row : rowsPerBuffer;
+		uint8_t *buffer = ILI9341_StreamGetBuffer();
+
+		for (int16_t i = 0; i < rows; i++) {
+			const uint8_t *src = image + (uint32_t)(row + i) * stride;
+			if (swap) {
+				ILI9341_Colour_Swap((uint16_t*)(buffer + i * rowBytes), (const uint16_t*)src, w);
+			} else {
+				memcpy(buffer + i * rowBytes, src, rowBytes);
+			}
+		}
+		ILI9341_StreamSubmit(rows * rowBytes);
+	}
+	ILI9341_StreamEnd();
+}
+
+/**
+ * @brief  Zeigt ein RGB565-Bild zentriert auf dem Display an, ohne auf das Ende der Übertragung zu warten.
+ *
+ * Das Adressfenster wird blockierend gesetzt, die eigentlichen Bilddaten werden anschließend
+ * per ILI9341_SendDataAsync() im Hintergrund übertragen.
+ *
+ * @param  imageData Zeiger auf die Bilddaten (z.B. konstantes Array im Flash).
+ * @param  width     Breite des Bildes in Pixeln.
+ * @param  height    Höhe des Bildes in Pixeln.
+ *
+ * @note   imageData muss bis zum Ende der Übertragung gültig bleiben (siehe ILI9341_IsBusy()).
+ */
+void DisplayImageArray(const uint16_t* imageData, uint16_t width, uint16_t height)
+{
+  /* Centre on the current orientation, larger images are cropped on all sides */
+  int16_t x_start = ((int16_t)ILI9341_WIDTH - (int16_t)width) / 2;
+  int16_t y_start = ((int16_t)ILI9341_HEIGHT - (int16_t)height) / 2;
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawImage(x_start, y_start, width, height, (const uint8_t*)imageData);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_Image(x_start, y_start, width, height, (const uint8_t*)imageData)) {
+		return;
+	}
+#endif
+
+  int16_t cx = x_start, cy = y_start, cw = width, ch = height;
+  if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+  if (cw != width || ch != height) {
+    /* Cropped rows are not contiguous, copy them through the line buffers instead */
+    ILI9341_DrawImageRows(cx, cy, cw, ch, (const uint8_t*)&imageData[(uint32_t)(cy - y_start) * width + (cx - x_start)],
+        (uint32_t)width * 2, 0);
+    return;
+  }
+
+  /* Set display address window */
+  ILI9341_BeginWrite(cx, cy, cx + width - 1, cy + height - 1);
+
+  /* Send image data to display in the background, CS is released in the DMA completion path */
+  ILI9341_SendDataAsync((const uint8_t*)imageData, (uint32_t)width * height * 2);
+}
+
+/**
+ * @brief  Zeichnet ein Bild auf dem ILI9341-Display.
+ *
+ * Diese Funktion zeichnet ein Bild an der angegebenen Position (x,y) mit der
+ * angegebenen Größe (width x height). Das Bild wird aus einem Byte-Array gelesen,
+ * das die Pixel im RGB565-Format enthält (2 Bytes pro Pixel). Der Algorithmus
+ * führt folgende Schritte aus:
+ * 1. Setzt das Adressfenster auf den Bereich, in dem das Bild gezeichnet werden soll
+ * 2. Sendet den Memory-Write-Befehl (0x2C) an das Display
+ * 3. Kopiert die Bilddaten blockweise in die Ping-Pong-Zeilenpuffer und überträgt sie per DMA
+ *
+ * Da die Daten kopiert werden, darf der Aufrufer den Puffer nach der Rückkehr sofort wiederverwenden.
+ *
+ * @param  x      Die x-Koordinate der oberen linken Ecke des Bildes.
+ * @param  y      Die y-Koordinate der oberen linken Ecke des Bildes.
+ * @param  width  Die Breite des Bildes in Pixeln.
+ * @param  height Die Höhe des Bildes in Pixeln.
+ * @param  image  Zeiger auf das Byte-Array, das die Bilddaten im RGB565-Format enthält
+ *                (2 Bytes pro Pixel, insgesamt width*height*2 Bytes).
+ *
+ * @note   Die Bilddaten müssen im RGB565-Format vorliegen (High-Byte zuerst),
+ *         wobei jedes Pixel durch 2 Bytes dargestellt wird. Das Array muss
+ *         mindestens width*height*2 Bytes groß sein.
+ */
+void ILI9341_DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *image){
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawImage(x, y, width, height, image);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_Image(x, y, width, height, image)) {
+		return;
+	}
+#endif
+    int16_t cx = x, cy = y, cw = width, ch = height;
+    if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+    if (cw != width || ch != height) {
+    	ILI9341_DrawImageRows(cx, cy, cw, ch, image + ((uint32_t)(cy - (int16_t)y) * width + (cx - (int16_t)x)) * 2,
+    			(uint32_t)width * 2, 0);
+    	return;
+    }
+
+    // Set the drawing window
+    ILI9341_BeginWrite(x, y, x + width - 1, y + height - 1);
+
+    // Bilddaten blockweise in die Zeilenpuffer kopieren, während DMA den jeweils anderen sendet
+    uint32_t remaining = (uint32_t)width * height * 2;
+
+    ILI9341_StreamBegin();
+    while (remaining > 0) {
+    	uint32_t chunk = remaining;
+    	if (chunk > ILI9341_LINE_BUFFER_SIZE) {
+    		chunk = ILI9341_LINE_BUFFER_SIZE;
+    	}
+
+    	memcpy(ILI9341_StreamGetBuffer(), image, chunk);
+    	ILI9341_StreamSubmit(chunk);
 
+    	image += chunk;
+    	remaining -= chunk;
+    }
+    ILI9341_StreamEnd();
 }
 
 /**
- * @brief  Legt die Ausrichtung des ILI9341-Displays fest.
+ * @brief  Zeichnet einen Ausschnitt eines größeren RGB565-Bildes in einem Adressfenster, ohne Kopie.
  *
- * Diese Funktion konfiguriert die Ausrichtung des Displays durch Senden des
- * Memory Access Control-Befehls (0x36) gefolgt vom entsprechenden MADCTL-Parameter.
- * Sie aktualisiert auch die Breite und Höhe des Displays basierend auf der gewählten
- * Ausrichtung.
+ * Die Zeilen gehen per DMA direkt aus dem Bild (ILI9341_SendRowsAsync()): als ein Block, wenn
+ * der Ausschnitt die ganze Bildbreite umfasst, sonst eine DMA je Zeile, aber immer mit nur einem
+ * Fenster und einem Memory Write. Asset_DrawAtlasRow() zeichnet so nebeneinanderliegende Symbole.
  *
- * Die MADCTL-Bits haben folgende Bedeutung:
- *   - MY: Row Address Order (0=Top to Bottom, 1=Bottom to Top)
- *   - MX: Column Address Order (0=Left to Right, 1=Right to Left)
- *   - MV: Row/Column Exchange (0=Normal, 1=Vertauscht)
- *   - ML: Vertical Refresh Order (0=Normal, 1=Umgekehrt)
- *   - BGR: RGB/BGR Order (0=RGB, 1=BGR Format)
+ * @param  x, y   Obere linke Ecke auf dem Display.
+ * @param  width  Breite des Ausschnitts in Pixeln.
+ * @param  height Höhe des Ausschnitts in Pixeln.
+ * @param  image  Erstes Pixel des Ausschnitts (High-Byte zuerst).
+ * @param  stride Zeilenlänge des ganzen Bildes in Pixeln.
  *
- * @param orientation Der gewünschte Ausrichtungsmodus. Unterstützte Modi sind:
- *                    - ILI9341_PORTRAIT: 0° Portrait.
- *                    - ILI9341_LANDSCAPE: 90° Querformat.
- *                    - ILI9341_PORTRAIT_INVERTED: 180° Invertiertes Portrait.
- *                    - ILI9341_LANDSCAPE_INVERTED: 270° Invertiertes Querformat.
- *                    - TEST: Benutzerdefinierte Ausrichtung für Testzwecke.
- *                    - ILI9341_PORTRAIT_TRUE: Echte Portrait-Ausrichtung.
+ * @note   image muss bis zum Ende der Übertragung gültig bleiben (siehe ILI9341_IsBusy()).
+ */
+void ILI9341_DrawImageRegion(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image, uint16_t stride){
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawImageRegion(x, y, width, height, image, stride);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_ImageRegion(x, y, width, height, image, stride)) {
+		return;
+	}
+#endif
+	int16_t cx = x, cy = y, cw = width, ch = height;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+
+	image += ((uint32_t)(cy - y) * stride + (cx - x)) * 2;
+	ILI9341_BeginWrite(cx, cy, cx + cw - 1, cy + ch - 1);
+	ILI9341_SendRowsAsync(image, (uint16_t)(cw * 2), (uint16_t)(stride * 2), ch);
+}
+
+/**
+ * @brief  Zeichnet ein Bild aus uint16_t-RGB565-Pixeln (CPU-Byte-Reihenfolge).
  *
- * @note Diese Funktion aktualisiert die globalen Variablen ILI9341_WIDTH und
- *       ILI9341_HEIGHT entsprechend der gewählten Ausrichtung (240x320 oder 320x240).
+ * Mit ILI9341_USE_16BIT_PIXELS sendet DMA die Pixel direkt aus dem Puffer des Aufrufers
+ * mit 16-Bit-SPI-Frames, ohne Kopie und ohne Byte-Tausch. Ohne 16-Bit-Modus werden die
+ * Pixel beim Kopieren in die Zeilenpuffer getauscht.
+ *
+ * @param  x, y   Obere linke Ecke des Bildes.
+ * @param  width  Die Breite des Bildes in Pixeln.
+ * @param  height Die Höhe des Bildes in Pixeln.
+ * @param  pixels width*height Pixel, 16-Bit ausgerichtet.
+ *
+ * @note   Im 16-Bit-Modus muss pixels bis zum Ende der Übertragung gültig bleiben
+ *         (siehe ILI9341_IsBusy()).
  */
-void ILI9341_SetOrientation(ILI9341_Orientation orientation) {
-    uint8_t madctl = 0;
+void ILI9341_DrawImage16(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *pixels){
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawImageFormat(x, y, width, height, pixels, ILI9341_FB_RGB565_NATIVE);
+		return;
+	}
+#endif
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_Image16(x, y, width, height, pixels)) {
+		return;
+	}
+#endif
+	int16_t cx = x, cy = y, cw = width, ch = height;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+	if (cw != width || ch != height) {
+		ILI9341_DrawImageRows(cx, cy, cw, ch,
+				(const uint8_t*)&pixels[(uint32_t)(cy - (int16_t)y) * width + (cx - (int16_t)x)], (uint32_t)width * 2, 1);
+		return;
+	}
 
-    switch(orientation) {
-        case ILI9341_PORTRAIT: // 0° Portrait
-            madctl = 0x08;  // MY=0, MX=0, MV=0, ML=0, BGR=1
-            ILI9341_WIDTH = 240;
-            ILI9341_HEIGHT = 320;
-            break;
+	ILI9341_BeginWrite(x, y, x + width - 1, y + height - 1);
 
-        case ILI9341_LANDSCAPE: // 90° Landscape
-            madctl = 0x68;  // MY=0, MX=1, MV=1, ML=0, BGR=1
-            ILI9341_WIDTH = 320;
-            ILI9341_HEIGHT = 240;
-            break;
+#ifdef ILI9341_USE_16BIT_PIXELS
+	ILI9341_StreamBegin16();
+	ILI9341_SendDataAsync((const uint8_t*)pixels, (uint32_t)width * height * 2);
+	ILI9341_StreamEnd();
+#else
+	uint32_t remaining = (uint32_t)width * height;
 
-        case ILI9341_PORTRAIT_INVERTED: // 180° Inverted Portrait
-            madctl = 0xC8;  // MY=1, MX=1, MV=0, ML=0, BGR=1
-            ILI9341_WIDTH = 240;
-            ILI9341_HEIGHT = 320;
-            break;
+	ILI9341_StreamBegin();
+	while (remaining > 0) {
+		uint32_t count = remaining;
+		if (count > ILI9341_LINE_BUFFER_SIZE / 2) {
+			count = ILI9341_LINE_BUFFER_SIZE / 2;
+		}
 
-        case ILI9341_LANDSCAPE_INVERTED: // 270° Inverted Landscape
-            madctl = 0xA8;  // MY=1, MX=0, MV=1, ML=0, BGR=1
-            ILI9341_WIDTH = 320;
-            ILI9341_HEIGHT = 240;
-            break;
-        case TEST:
-        	madctl = 0b00101000;  // MY=1, MX=0, MV=1, ML=0, BGR=1
-			ILI9341_WIDTH = 320;
-			ILI9341_HEIGHT = 240;
-			break;
-        case ILI9341_PORTRAIT_TRUE:
-        	madctl = 0b10001000;  // MY=0, MX=0, MV=0, ML=0, BGR=1
-			ILI9341_WIDTH = 240;
-			ILI9341_HEIGHT = 320;
-    }
+		ILI9341_Colour_Swap((uint16_t*)ILI9341_StreamGetBuffer(), pixels, count);
+		ILI9341_StreamSubmit(count * 2);
 
-    // Send command to set MADCTL
-    ILI9341_SendCommandWithParam_8Bit(0x36, &madctl, 1);
+		pixels += count;
+		remaining -= count;
+	}
+	ILI9341_StreamEnd();
+#endif
 }
 
+/* --------------------------------- Glyph-Cache --------------------------------- */
+
+#define GLYPH_PIXEL_WIDTH_MAX  (CHAR_WIDTH * ILI9341_GLYPH_CACHE_MAX_SIZE)
+#define GLYPH_PIXEL_HEIGHT_MAX (CHAR_HEIGHT * ILI9341_GLYPH_CACHE_MAX_SIZE)
+
 /**
- * @brief  Zeichnet ein Rechteck auf dem ILI9341-Display.
- * @param  x: X-Koordinate der oberen linken Ecke des Rechtecks.
- * @param  y: Y-Koordinate der oberen linken Ecke des Rechtecks.
- * @param  w: Breite des Rechtecks.
- * @param  h: Höhe des Rechtecks.
- * @param  color: Farbe des Rechtecks (16-Bit RGB565 Format).
- * @retval None
+ * @brief Ein vorgerastertes Zeichen (Zeichen, Größe, Vorder- und Hintergrundfarbe) im RGB565-Format
  */
-void ILI9341_DrawRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-	ILI9341_SetAddress(x, y, x+w-1, y+h-1);
-	ILI9341_DrawColourBurst(color,w*h);
+typedef struct {
+	uint8_t  character;   // Index in stdfont
+	uint8_t  size;        // Skalierung, 0 = Eintrag unbenutzt
+	uint16_t colour;
+	uint16_t background;
+	uint32_t last_used;   // Zeitstempel für LRU-Verdrängung
+	uint8_t  pixels[GLYPH_PIXEL_WIDTH_MAX * GLYPH_PIXEL_HEIGHT_MAX * 2] __attribute__((aligned(4)));
+} ILI9341_Glyph;
+
+ILI9341_Glyph ILI9341_GlyphCache[ILI9341_GLYPH_CACHE_ENTRIES] __attribute__((aligned(32)));
+uint32_t ILI9341_GlyphCacheClock = 0;
+
+/**
+ * @brief  Wandelt ein ASCII-Zeichen in den Index im stdfont-Array um.
+ *         Nicht darstellbare Zeichen werden als Leerzeichen dargestellt.
+ */
+static uint8_t ILI9341_GlyphIndex(char Character) {
+	uint8_t c = (uint8_t)Character;
+	if (c < ' ' || c >= ' ' + 96) {
+		return 0;
+	}
+	return c - ' ';
 }
 
 /**
- * @brief  Füllt einen rechteckigen Bereich auf dem ILI9341-Display mit einer bestimmten Farbe.
+ * @brief  Rastert ein Zeichen in einen RGB565-Puffer (High-Byte zuerst).
  *
- * Diese Funktion setzt das Adressfenster auf den angegebenen rechteckigen Bereich und
- * füllt diesen mit der angegebenen Farbe, indem sie einen Farb-Burst verwendet. Der rechteckige
- * Bereich wird durch seine obere linke Ecke, Breite und Höhe definiert.
+ * Liest je Pixelzeile eine Zeilenmaske (stdfont_rows1..3 aus Fonts/5x5_font_rows.cpp) statt
+ * je Pixel Spalte und Bit aus stdfont; ab Größe 4 wird die einfache Maske je Pixel geteilt.
  *
- * Die Funktion nutzt folgende Hilfsfunktionen:
- * - ILI9341_SetAddress(): Legt den zu bearbeitenden Adressbereich auf dem Display fest
- * - ILI9341_DrawColourBurst(): Füllt den festgelegten Bereich mit der angegebenen Farbe
+ * @param  index   Index in stdfont.
+ * @param  Size    Skalierung.
+ * @param  dst     Zielpuffer mit mindestens CHAR_WIDTH*Size*CHAR_HEIGHT*Size*2 Bytes.
+ * @param  rowFrom Erste zu rasternde Pixelzeile.
+ * @param  rowTo   Zeile nach der letzten zu rasternden Pixelzeile.
+ */
+RAMFUNC static void ILI9341_RasteriseGlyph(uint8_t index, uint16_t Size, uint16_t Colour, uint16_t Background_Colour,
+		uint8_t *dst, uint16_t rowFrom, uint16_t rowTo) {
+	uint16_t width = CHAR_WIDTH * Size;
+
+	for (uint16_t py = rowFrom; py < rowTo; py++) {
+		uint8_t row = py / Size;
+
+		// Sizes 1..3: one pre-transposed, pre-scaled mask per row, shifted out pixel by pixel
+		uint32_t mask;
+		switch (Size) {
+		case 1: mask = stdfont_rows1[index][row]; break;
+		case 2: mask = stdfont_rows2[index][row]; break;
+		case 3: mask = stdfont_rows3[index][row]; break;
+		default: mask = 0; break;
+		}
+
+		if (Size <= 3) {
+			for (uint16_t px = 0; px < width; px++, mask >>= 1) {
+				uint16_t c = (mask & 1) ? Colour : Background_Colour;
+				*dst++ = c >> 8;
+				*dst++ = c;
+			}
+		} else {
+			uint8_t bits = stdfont_rows1[index][row];
+			for (uint16_t px = 0; px < width; px++) {
+				uint16_t c = ((bits >> (px / Size)) & 1) ? Colour : Background_Colour;
+				*dst++ = c >> 8;
+				*dst++ = c;
+			}
+		}
+	}
+}
+
+/**
+ * @brief  Sucht ein Zeichen im Glyph-Cache bzw. rastert es in den am längsten unbenutzten Eintrag.
+ * @retval Zeiger auf den Cache-Eintrag.
+ */
+static ILI9341_Glyph* ILI9341_GlyphLookup(uint8_t index, uint16_t Size, uint16_t Colour, uint16_t Background_Colour) {
+	ILI9341_Glyph *victim = &ILI9341_GlyphCache[0];
+
+	for (uint8_t i = 0; i < ILI9341_GLYPH_CACHE_ENTRIES; i++) {
+		ILI9341_Glyph *g = &ILI9341_GlyphCache[i];
+		if (g->size == Size && g->character == index && g->colour == Colour && g->background == Background_Colour) {
+			g->last_used = ++ILI9341_GlyphCacheClock;
+			return g;
+		}
+		if (g->last_used < victim->last_used) {
+			victim = g;
+		}
+	}
+
+	// Der Eintrag könnte noch per DMA übertragen werden, bevor er überschrieben wird
+	ILI9341_WaitWhileBusy();
+
+	victim->character = index;
+	victim->size = Size;
+	victim->colour = Colour;
+	victim->background = Background_Colour;
+	victim->last_used = ++ILI9341_GlyphCacheClock;
+	ILI9341_RasteriseGlyph(index, Size, Colour, Background_Colour, victim->pixels, 0, CHAR_HEIGHT * Size);
+
+	return victim;
+}
+
+/**
+ * @brief  Leert den Glyph-Cache (z.B. nach einem Wechsel der Schriftart).
+ */
+void ILI9341_GlyphCacheClear() {
+	ILI9341_WaitWhileBusy();
+	for (uint8_t i = 0; i < ILI9341_GLYPH_CACHE_ENTRIES; i++) {
+		ILI9341_GlyphCache[i].size = 0;
+		ILI9341_GlyphCache[i].last_used = 0;
+	}
+	ILI9341_GlyphCacheClock = 0;
+}
+
+/**
+ * @brief  Zeichnet ein Zeichen aus dem 5x5-Font mit Vorder- und Hintergrundfarbe.
  *
- * @param x     Die x-Koordinate der oberen linken Ecke des Rechtecks.
- * @param y     Die y-Koordinate der oberen linken Ecke des Rechtecks.
- * @param w     Die Breite des Rechtecks in Pixeln.
- * @param h     Die Höhe des Rechtecks in Pixeln.
- * @param color Der 16-Bit-Farbwert (RGB565-Format) zum Füllen des Rechtecks.
+ * Das Zeichen wird als vollständiger Block (CHAR_WIDTH*Size x CHAR_HEIGHT*Size) mit einem
+ * einzigen Adressfenster und einer einzigen Übertragung gesendet:
+ * - Bis Size == ILI9341_GLYPH_CACHE_MAX_SIZE wird der gerasterte Block im LRU-Glyph-Cache
+ *   gehalten und direkt per DMA aus dem Cache gesendet.
+ * - Größere Zeichen werden zeilenweise in die Ping-Pong-Zeilenpuffer gerastert.
  *
- * @note   Diese Funktion ist ähnlich zu ILI9341_DrawRectangle(), verwendet jedoch
- *         andere Parametertypen (int16_t statt uint16_t) für die Positionierung.
+ * @param  Character         Das zu zeichnende ASCII-Zeichen.
+ * @param  X, Y              Obere linke Ecke.
+ * @param  Colour            Vordergrundfarbe (RGB565).
+ * @param  Size              Skalierungsfaktor (1 = 6x8 Pixel).
+ * @param  Background_Colour Hintergrundfarbe (RGB565).
  */
-void ILI9341_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
-	ILI9341_SetAddress(x, y, x+w-1, y+h-1);
-	ILI9341_DrawColourBurst(color,w*h);
+void ILI9341_DrawChar(char Character, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
+{
+	if (Size == 0) return;
+
+	uint8_t index = ILI9341_GlyphIndex(Character);
+	uint16_t width = CHAR_WIDTH * Size;
+	uint16_t height = CHAR_HEIGHT * Size;
+
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording() && ILI9341_Tile_Glyph(X, Y, width, height, Size, stdfont[index], Colour, Background_Colour)) {
+		return;
+	}
+#endif
+
+	if (Size <= ILI9341_GLYPH_CACHE_MAX_SIZE) {
+		ILI9341_Glyph *glyph = ILI9341_GlyphLookup(index, Size, Colour, Background_Colour);
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+		if (ILI9341_FB_IsEnabled()) {
+			ILI9341_FB_DrawImage(X, Y, width, height, glyph->pixels);
+			return;
+		}
+#endif
+		int16_t cx = X, cy = Y, cw = width, ch = height;
+		if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+		if (cw != width || ch != height) {
+			ILI9341_DrawImageRows(cx, cy, cw, ch,
+					glyph->pixels + ((uint32_t)(cy - (int16_t)Y) * width + (cx - (int16_t)X)) * 2, (uint32_t)width * 2, 0);
+			return;
+		}
+
+		ILI9341_BeginWrite(X, Y, X + width - 1, Y + height - 1);
+		ILI9341_SendDataAsync(glyph->pixels, (uint32_t)width * height * 2);
+		return;
+	}
+
+	// Zu groß für den Cache: Zeilenbänder direkt in die Zeilenpuffer rastern
+	uint16_t rowsPerBuffer = ILI9341_LINE_BUFFER_SIZE / (width * 2);
+	if (rowsPerBuffer == 0) return;
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		for (uint16_t row = 0; row < height; row += rowsPerBuffer) {
+			uint16_t rowTo = (row + rowsPerBuffer < height) ? row + rowsPerBuffer : height;
+			uint8_t *buffer = ILI9341_StreamGetBuffer();
+			ILI9341_RasteriseGlyph(index, Size, Colour, Background_Colour, buffer, row, rowTo);
+			ILI9341_FB_DrawImage(X, Y + row, width, rowTo - row, buffer);
+		}
+		return;
+	}
+#endif
+
+	// Only the visible rows are rasterised; cropped columns are squeezed out in place
+	int16_t cx = X, cy = Y, cw = width, ch = height;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+	uint16_t skip = cx - (int16_t)X;
+	uint16_t rowFirst = cy - (int16_t)Y;
+	uint16_t rowEnd = rowFirst + ch;
+
+	ILI9341_BeginWrite(cx, cy, cx + cw - 1, cy + ch - 1);
+	ILI9341_StreamBegin();
+	for (uint16_t row = rowFirst; row < rowEnd; row += rowsPerBuffer) {
+		uint16_t rowTo = (row + rowsPerBuffer < rowEnd) ? row + rowsPerBuffer : rowEnd;
+		uint8_t *buffer = ILI9341_StreamGetBuffer();
+		ILI9341_RasteriseGlyph(index, Size, Colour, Background_Colour, buffer, row, rowTo);
+		if (cw != width) {
+			for (uint16_t i = 0; i < rowTo - row; i++) {
+				memmove(buffer + (uint32_t)i * cw * 2, buffer + ((uint32_t)i * width + skip) * 2, (uint32_t)cw * 2);
+			}
+		}
+		ILI9341_StreamSubmit((uint32_t)(rowTo - row) * cw * 2);
+	}
+	ILI9341_StreamEnd();
 }
 
 /**
- * @brief  Zeichnet eine horizontale Linie auf dem ILI9341-Display.
- *
- * Diese Funktion zeichnet eine horizontale Linie von einem bestimmten Startpunkt (x,y)
- * mit einer angegebenen Breite und Farbe. Der Algorithmus nutzt optimierte
- * Zeichenmethoden, indem er:
- * 1. Das Adressfenster auf die exakte Größe der Linie setzt (von (x,y) bis (x+w-1,y))
- * 2. Einen Farb-Burst verwendet, um alle Pixel der Linie in einem einzigen Vorgang zu füllen
+ * @brief  Rastert eine Pixelzeile einer Textzeile über die ganze Breite.
+ * @param  row  Pixelzeile relativ zur Oberkante der Textzeile.
+ * @param  line Ziel (High-Byte zuerst); NULL für Zeilen vor dem sichtbaren Ausschnitt, die nur
+ *              den Zustand der Dekoder weiterschalten.
+ */
+typedef void (*ILI9341_TextRowFunc)(void *context, uint16_t row, uint8_t *line);
+
+/**
+ * @brief Eine Zeile aus dem 5x5-Font, links und rechts mit der Hintergrundfarbe aufgefüllt
+ */
+typedef struct {
+	const char *text;
+	uint16_t count;
+	uint16_t offset;      // First cell within the line
+	uint16_t width;
+	uint16_t size;
+	uint16_t colour;
+	uint16_t background;
+} ILI9341_StdTextRow;
+
+/**
+ * @brief  ILI9341_TextRowFunc für den 5x5-Font.
+ */
+static void ILI9341_StdTextRaster(void *context, uint16_t row, uint8_t *line) {
+	if (line == NULL) return;
+
+	const ILI9341_StdTextRow *t = context;
+	uint16_t cellWidth = CHAR_WIDTH * t->size;
+	uint16_t end = t->offset + t->count * cellWidth;
+
+	for (uint16_t x = 0; x < t->offset; x++) {
+		line[2 * x] = t->background >> 8;
+		line[2 * x + 1] = t->background;
+	}
+	for (uint16_t i = 0; i < t->count; i++) {
+		ILI9341_RasteriseGlyph(ILI9341_GlyphIndex(t->text[i]), t->size, t->colour, t->background,
+				line + (uint32_t)(t->offset + i * cellWidth) * 2, row, row + 1);
+	}
+	for (uint16_t x = end; x < t->width; x++) {
+		line[2 * x] = t->background >> 8;
+		line[2 * x + 1] = t->background;
+	}
+}
+
+/**
+ * @brief  Sendet eine Textzeile als ein Block mit einem einzigen Adressfenster.
  *
- * @param  x     Die x-Koordinate des Startpunkts der Linie.
- * @param  y     Die y-Koordinate des Startpunkts der Linie.
- * @param  w     Die Breite (Länge) der Linie in Pixeln.
- * @param  color Die Farbe der Linie im 16-Bit RGB565-Format.
+ * rasterise() füllt je Pixelzeile die ganze Breite in die Ping-Pong-Zeilenpuffer, die per DMA
+ * gestreamt werden, während der nächste Puffer gefüllt wird. Vom Clip-Rechteck abgeschnittene
+ * Spalten werden im Puffer entfernt. Im Framebuffer-Betrieb werden die Bänder dorthin kopiert.
  *
- * @note   Diese Funktion ist effizienter als das separate Zeichnen einzelner Pixel,
- *         da sie die schnelle Burst-Methode verwendet.
+ * @param  width Breite der Zeile, höchstens ILI9341_LINE_BUFFER_SIZE / 2 Pixel.
  */
-void ILI9341_DrawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
-	ILI9341_SetAddress(x, y, x+w-1,y);
-	ILI9341_DrawColourBurst(color,w);
+static void ILI9341_TextLineWrite(int16_t X, int16_t Y, uint16_t width, uint16_t height,
+		ILI9341_TextRowFunc rasterise, void *context) {
+	if (width == 0 || width > ILI9341_LINE_BUFFER_SIZE / 2) return;
+
+	int16_t cx = X, cy = Y, cw = width, ch = height;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+
+	uint16_t rowsPerBuffer = ILI9341_LINE_BUFFER_SIZE / (width * 2);
+	uint16_t skip = cx - X;
+	uint16_t rowFirst = cy - Y;
+	uint16_t rowEnd = rowFirst + ch;
+
+	for (uint16_t row = 0; row < rowFirst; row++) {
+		rasterise(context, row, NULL);
+	}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	uint8_t toFramebuffer = ILI9341_FB_IsEnabled();
+#else
+	uint8_t toFramebuffer = 0;
+#endif
+	if (!toFramebuffer) {
+		ILI9341_BeginWrite(cx, cy, cx + cw - 1, cy + ch - 1);
+		ILI9341_StreamBegin();
+	}
+
+	for (uint16_t row = rowFirst; row < rowEnd; row += rowsPerBuffer) {
+		uint16_t rowTo = (row + rowsPerBuffer < rowEnd) ? row + rowsPerBuffer : rowEnd;
+		uint8_t *buffer = ILI9341_StreamGetBuffer();
+		for (uint16_t py = row; py < rowTo; py++) {
+			rasterise(context, py, buffer + (uint32_t)(py - row) * width * 2);
+		}
+		if (cw != width) {
+			for (uint16_t i = 0; i < rowTo - row; i++) {
+				memmove(buffer + (uint32_t)i * cw * 2, buffer + ((uint32_t)i * width + skip) * 2, (uint32_t)cw * 2);
+			}
+		}
+#ifdef ILI9341_USE_FRAMEBUFFER
+		if (toFramebuffer) {
+			ILI9341_FB_DrawImage(cx, Y + row, cw, rowTo - row, buffer);
+			continue;
+		}
+#endif
+		ILI9341_StreamSubmit((uint32_t)(rowTo - row) * cw * 2);
+	}
+
+	if (!toFramebuffer) {
+		ILI9341_StreamEnd();
+	}
 }
+
 /**
- * @brief  Zeichnet eine vertikale Linie auf dem ILI9341-Display.
+ * @brief  Zeichnet einen Text aus dem 5x5-Font deckend mit Vorder- und Hintergrundfarbe.
  *
- * Diese Funktion zeichnet eine vertikale Linie von einem bestimmten Startpunkt (x,y)
- * mit einer angegebenen Höhe und Farbe. Der Algorithmus nutzt optimierte
- * Zeichenmethoden, indem er:
- * 1. Das Adressfenster auf die exakte Größe der Linie setzt (von (x,y) bis (x,y+h-1))
- * 2. Einen Farb-Burst verwendet, um alle Pixel der Linie in einem einzigen Vorgang zu füllen
+ * Die ganze Zeile wird als ein Block mit einem einzigen Adressfenster gesendet: je Pixelzeile
+ * werden alle Zeichenzellen nebeneinander in die Ping-Pong-Zeilenpuffer gerastert und per DMA
+ * gestreamt, während der nächste Puffer gefüllt wird. Ein vorheriges Löschen der Fläche ist
+ * nicht nötig, ein geändertes Label kostet eine Übertragung statt einer je Zeichen.
+ * Im Framebuffer- und Tile-Betrieb wird weiter zeichenweise über ILI9341_DrawChar() gezeichnet.
+ * Zeichen, die nicht mehr vollständig auf die Breite des Displays passen, entfallen.
  *
- * @param  x     Die x-Koordinate des Startpunkts der Linie.
- * @param  y     Die y-Koordinate des Startpunkts der Linie.
- * @param  h     Die Höhe (Länge) der Linie in Pixeln.
- * @param  color Die Farbe der Linie im 16-Bit RGB565-Format.
+ * @param  Text              Nullterminierter ASCII-Text.
+ * @param  X, Y              Obere linke Ecke.
+ * @param  Colour            Vordergrundfarbe (RGB565).
+ * @param  Size              Skalierungsfaktor (1 = 6x8 Pixel je Zeichen).
+ * @param  Background_Colour Hintergrundfarbe (RGB565).
+ */
+void ILI9341_DrawText(const char* Text, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
+{
+	if (Size == 0) return;
+
+	uint16_t cellWidth = CHAR_WIDTH * Size;
+	uint16_t height = CHAR_HEIGHT * Size;
+
+	uint16_t count = 0;
+	while (Text[count] && X + (uint32_t)(count + 1) * cellWidth <= ILI9341_WIDTH) {
+		count++;
+	}
+	if (count == 0) return;
+
+	uint8_t perChar = 0;
+#ifdef ILI9341_USE_FRAMEBUFFER
+	perChar |= ILI9341_FB_IsEnabled();
+#endif
+#ifdef ILI9341_USE_TILES
+	perChar |= ILI9341_Tile_IsRecording();
+#endif
+	if (perChar) {
+		for (uint16_t i = 0; i < count; i++) {
+			ILI9341_DrawChar(Text[i], X + i * cellWidth, Y, Colour, Size, Background_Colour);
+		}
+		return;
+	}
+
+	// One text row never exceeds the display width, so every buffer holds at least one pixel row
+	uint16_t width = count * cellWidth;
+	ILI9341_StdTextRow row = { Text, count, 0, width, Size, Colour, Background_Colour };
+	ILI9341_TextLineWrite(X, Y, width, height, ILI9341_StdTextRaster, &row);
+}
+
+/* --------------------------------- Proportionale Fonts (ILI9341_t3) --------------------------------- */
+
+/**
+ * @brief Kopfdaten eines Zeichens aus einem ILI9341_t3-Font
+ */
+typedef struct {
+	const uint8_t *data;
+	uint32_t bitoffset;   // Beginn der Pixeldaten
+	uint32_t width;
+	uint32_t height;
+	int32_t  xoffset;
+	int32_t  yoffset;
+	uint32_t delta;       // Vorschub des Cursors
+} ILI9341_FontGlyph;
+
+/**
+ * @brief Zustand beim zeilenweisen Dekodieren eines Zeichens
+ */
+typedef struct {
+	uint32_t bitoffset;   // Nächste ungelesene Zeile
+	uint32_t rowstart;    // Bitposition der aktuellen Zeile
+	uint8_t  repeat;      // Wie oft die aktuelle Zeile noch wiederholt wird (nur 1 Bit)
+} ILI9341_FontRowDecoder;
+
+/**
+ * @brief Zwischengespeicherte Textbreite für das Layout
+ */
+typedef struct {
+	const ILI9341_t3_font_t *font;
+	uint32_t hash;
+	uint16_t length;
+	uint16_t width;
+} ILI9341_TextWidthEntry;
+
+ILI9341_TextWidthEntry ILI9341_TextWidthCache[ILI9341_TEXT_WIDTH_CACHE_ENTRIES];
+uint8_t ILI9341_TextWidthNext = 0;
+
+/**
+ * @brief  Bits pro Pixel des aktuellen Fonts (Version 23 = anti-aliased).
+ */
+static uint8_t ILI9341_FontBpp() {
+	if (font->version == 23) {
+		return (font->reserved & 0x03) + 1;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Liest die Kopfdaten eines Zeichens aus dem Font.
+ * @retval 1 wenn das Zeichen im Font vorhanden ist, sonst 0.
+ */
+static uint8_t ILI9341_FontGetGlyph(uint16_t c, ILI9341_FontGlyph *g) {
+	uint32_t bitoffset;
+
+	if (c >= font->index1_first && c <= font->index1_last) {
+		bitoffset = c - font->index1_first;
+	} else if (c >= font->index2_first && c <= font->index2_last) {
+		bitoffset = c - font->index2_first + font->index1_last - font->index1_first + 1;
+	} else {
+		return 0;	// Unicode-Tabellen werden nicht unterstützt
+	}
+	bitoffset *= font->bits_index;
+
+	g->data = font->data + fetchbits_unsigned(font->index, bitoffset, font->bits_index);
+
+	uint32_t encoding = fetchbits_unsigned(g->data, 0, 3);
+	if (encoding != 0) return 0;
+
+	bitoffset = 3;
+	g->width = fetchbits_unsigned(g->data, bitoffset, font->bits_width);
+	bitoffset += font->bits_width;
+	g->height = fetchbits_unsigned(g->data, bitoffset, font->bits_height);
+	bitoffset += font->bits_height;
+	g->xoffset = fetchbits_signed(g->data, bitoffset, font->bits_xoffset);
+	bitoffset += font->bits_xoffset;
+	g->yoffset = fetchbits_signed(g->data, bitoffset, font->bits_yoffset);
+	bitoffset += font->bits_yoffset;
+	g->delta = fetchbits_unsigned(g->data, bitoffset, font->bits_delta);
+	bitoffset += font->bits_delta;
+
+	// Anti-aliased Pixeldaten beginnen an einer Byte-Grenze
+	if (ILI9341_FontBpp() > 1) {
+		bitoffset = (bitoffset + 7) & ~7UL;
+	}
+	g->bitoffset = bitoffset;
+	return 1;
+}
+
+/**
+ * @brief  Springt zur nächsten Pixelzeile eines Zeichens.
  *
- * @note   Diese Funktion ist effizienter als das separate Zeichnen einzelner Pixel,
- *         da sie die schnelle Burst-Methode verwendet.
+ * 1-Bit-Fonts sind zeilenweise komprimiert: Ein führendes 1-Bit kennzeichnet eine Zeile,
+ * die (n+2)-mal wiederholt wird. Anti-aliased Fonts speichern jede Zeile unkomprimiert.
+ */
+static void ILI9341_FontNextRow(const ILI9341_FontGlyph *g, ILI9341_FontRowDecoder *d, uint8_t bpp) {
+	if (bpp > 1) {
+		d->rowstart = d->bitoffset;
+		d->bitoffset += g->width * bpp;
+		return;
+	}
+
+	if (d->repeat > 0) {
+		d->repeat--;
+		return;
+	}
+
+	if (fetchbit(g->data, d->bitoffset++) == 0) {
+		d->rowstart = d->bitoffset;
+	} else {
+		d->repeat = fetchbits_unsigned(g->data, d->bitoffset, 3) + 1;	// n+2 Zeilen, diese eingeschlossen
+		d->rowstart = d->bitoffset + 3;
+	}
+	d->bitoffset = d->rowstart + g->width;
+}
+
+/**
+ * @brief  Farbpalette für alle Deckungsstufen eines Fonts mit bpp Bits pro Pixel (High-Byte zuerst).
  */
-void ILI9341_DrawVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color) {
-	ILI9341_SetAddress(x, y, x,y+h-1);
-	ILI9341_DrawColourBurst(color,h);
+static void ILI9341_FontPalette(uint16_t Colour, uint16_t Background_Colour, uint8_t bpp, uint16_t *palette) {
+	uint32_t alphaMax = (1UL << bpp) - 1;
+
+	for (uint32_t a = 0; a <= alphaMax; a++) {
+		uint32_t r = (((Colour >> 11) & 0x1F) * a + ((Background_Colour >> 11) & 0x1F) * (alphaMax - a)) / alphaMax;
+		uint32_t gr = (((Colour >> 5) & 0x3F) * a + ((Background_Colour >> 5) & 0x3F) * (alphaMax - a)) / alphaMax;
+		uint32_t b = ((Colour & 0x1F) * a + (Background_Colour & 0x1F) * (alphaMax - a)) / alphaMax;
+		uint16_t col = (r << 11) | (gr << 5) | b;
+		palette[a] = (uint16_t)((col >> 8) | (col << 8));
+	}
 }
 
 /**
- * @brief  Zeichnet einen einzelnen Pixel auf dem ILI9341-Display.
+ * @brief  Zeichnet ein Zeichen des aktuellen Fonts deckend in seine Zeichenzelle.
  *
- * Diese Funktion setzt einen einzelnen Pixel an den angegebenen Koordinaten mit der
- * gewünschten Farbe. Der Algorithmus funktioniert wie folgt:
- * 1. Setzen des Adressfensters auf genau einen Pixel an Position (x,y)
- * 2. Aufteilen des 16-Bit-Farbwerts in zwei 8-Bit-Werte (High-Byte und Low-Byte)
- * 3. Senden des Memory-Write-Befehls (0x2C) an das Display
- * 4. Übertragen der Farbdaten über die SPI-Schnittstelle
- *
- * @param  x     Die x-Koordinate des zu zeichnenden Pixels.
- * @param  y     Die y-Koordinate des zu zeichnenden Pixels.
- * @param  color Die Farbe des Pixels im 16-Bit RGB565-Format.
+ * Die Zelle reicht horizontal vom Cursor bis zum Vorschub (bzw. bis zum Ende der Glyphe)
+ * und vertikal über die gesamte Zeilenhöhe (line_space). Der Inhalt wird zeilenweise in
+ * die Ping-Pong-Zeilenpuffer dekodiert und mit einem einzigen Adressfenster gesendet.
+ * Anti-aliased Pixel werden mit einer vorberechneten Farbpalette zwischen Colour und
+ * Background_Colour gemischt.
  *
- * @note   Diese Funktion ist der grundlegende Baustein für alle komplexeren Zeichenoperationen,
- *         wird aber für größere Zeichenoperationen zugunsten effizienterer Methoden wie
- *         ILI9341_DrawColourBurst() vermieden.
+ * @param  c                 Das zu zeichnende Zeichen.
+ * @param  X, Y              Cursorposition (obere linke Ecke der Zeile).
+ * @param  Colour            Vordergrundfarbe (RGB565).
+ * @param  Background_Colour Hintergrundfarbe (RGB565).
+ * @retval Vorschub in Pixeln (0 wenn das Zeichen nicht im Font ist).
  */
-void ILI9341_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
-	ILI9341_SetAddress(x, y, x,y);
-	unsigned char cholor = color>>8;
-	unsigned char buffer[2] = {cholor,color};
-	//COMMAND Memory Write
-	ILI9341_SendCommand(0x2C);
+int16_t ILI9341_DrawFontChar(uint16_t c, int16_t X, int16_t Y, uint16_t Colour, uint16_t Background_Colour) {
+	ILI9341_FontGlyph g;
+	if (font == NULL || !ILI9341_FontGetGlyph(c, &g)) return 0;
+
+	uint8_t bpp = ILI9341_FontBpp();
+	uint16_t palette[16];
+	ILI9341_FontPalette(Colour, Background_Colour, bpp, palette);
+	uint16_t bg = palette[0];
+
+	// Zeichenzelle bestimmen
+	int32_t cellX0 = (g.xoffset < 0) ? g.xoffset : 0;
+	int32_t cellX1 = ((int32_t)g.delta > g.xoffset + (int32_t)g.width) ? (int32_t)g.delta : g.xoffset + (int32_t)g.width;
+	int32_t cellW = cellX1 - cellX0;
+	int32_t cellH = font->line_space;
+	int32_t glyphY0 = font->cap_height - (int32_t)g.height - g.yoffset;	// Erste Glyphenzeile relativ zur Zelle
+	int32_t glyphX0 = g.xoffset - cellX0;
+
+	int32_t screenX = X + cellX0;
+	if (cellW <= 0 || cellH <= 0 || screenX < INT16_MIN || screenX > INT16_MAX) return g.delta;
+
+	// Sichtbarer Teil der Zelle: Zeilen davor werden nur dekodiert, abgeschnittene Spalten entfernt
+	int16_t cx = screenX, cy = Y, cw = cellW, ch = cellH;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return g.delta;
+	int32_t skip = cx - screenX;
+	int32_t rowFirst = cy - Y;
+	int32_t rowEnd = rowFirst + ch;
+
+	uint32_t rowBytes = cellW * 2;
+	uint32_t rowsPerBuffer = ILI9341_LINE_BUFFER_SIZE / rowBytes;
+	if (rowsPerBuffer == 0) return g.delta;
+
+	ILI9341_FontRowDecoder d = { g.bitoffset, g.bitoffset, 0 };
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	uint8_t toFramebuffer = ILI9341_FB_IsEnabled();
+#else
+	uint8_t toFramebuffer = 0;
+#endif
+	if (!toFramebuffer) {
+		ILI9341_BeginWrite(cx, cy, cx + cw - 1, cy + ch - 1);
+		ILI9341_StreamBegin();
+	}
 
-	ILI9341_SendData(buffer, 2);
+	int32_t row = 0;
+	int32_t emitted = 0;	// Rows already drawn into the framebuffer
+	while (row < rowEnd) {
+		uint16_t *buffer = (uint16_t*)ILI9341_StreamGetBuffer();
+		uint32_t n = 0;
+
+		for (; n < rowsPerBuffer && row < rowEnd; row++) {
+			uint16_t *dst = &buffer[n * cellW];
+			int32_t gy = row - glyphY0;
+			uint8_t visible = row >= rowFirst;
+
+			if (visible) {
+				for (int32_t x = 0; x < cellW; x++) {
+					dst[x] = bg;
+				}
+				n++;
+			}
+
+			if (gy < 0 || gy >= (int32_t)g.height) continue;
+
+			ILI9341_FontNextRow(&g, &d, bpp);
+			if (!visible) continue;
+			for (uint32_t x = 0; x < g.width; x++) {
+				uint32_t alpha;
+				if (bpp == 1) {
+					alpha = fetchbit(g.data, d.rowstart + x) ? 1 : 0;
+				} else {
+					alpha = fetchbits_unsigned(g.data, d.rowstart + x * bpp, bpp);
+				}
+				if (alpha) {
+					dst[glyphX0 + x] = palette[alpha];
+				}
+			}
+		}
+
+		if (n == 0) continue;
+		if (cw != cellW) {
+			for (uint32_t i = 0; i < n; i++) {
+				memmove(&buffer[i * cw], &buffer[i * cellW + skip], (uint32_t)cw * 2);
+			}
+		}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+		if (toFramebuffer) {
+			ILI9341_FB_DrawImage(cx, cy + emitted, cw, n, (const uint8_t*)buffer);
+			emitted += n;
+			continue;
+		}
+#endif
+		ILI9341_StreamSubmit(n * cw * 2);
+	}
+
+	if (!toFramebuffer) {
+		ILI9341_StreamEnd();
+	}
+	return g.delta;
 }
+
 /**
- * @brief  Zeichnet einen einzelnen Pixel auf dem ILI9341-Display mit RGB-Farbkomponenten.
- *
- * Diese Funktion ermöglicht das Setzen eines Pixels mit separaten 8-Bit RGB-Farbwerten,
- * was eine intuitivere Farbdefinition im Vergleich zum direkten RGB565-Format ermöglicht.
- * Der Algorithmus führt folgende Schritte aus:
- * 1. Setzt das Adressfenster auf genau einen Pixel an Position (x,y)
- * 2. Konvertiert die 8-Bit RGB-Werte (R: 0-255, G: 0-255, B: 0-255) in das 16-Bit RGB565-Format:
- *    - Rot: Die oberen 5 Bits werden verwendet (R & 0xF8) und um 8 Bits nach links verschoben
- *    - Grün: Die oberen 6 Bits werden verwendet (G & 0xFC) und um 3 Bits nach links verschoben
- *    - Blau: Die oberen 5 Bits werden verwendet (B >> 3)
- * 3. Ruft ILI9341_DrawPixel() auf, um den Pixel mit der berechneten Farbe zu setzen
- *
- * @param  x  Die x-Koordinate des zu zeichnenden Pixels.
- * @param  y  Die y-Koordinate des zu zeichnenden Pixels.
- * @param  r  Die Rot-Komponente der Farbe (8-Bit, 0-255).
- * @param  g  Die Grün-Komponente der Farbe (8-Bit, 0-255).
- * @param  b  Die Blau-Komponente der Farbe (8-Bit, 0-255).
+ * @brief  Zeichnet einen Text mit dem aktuellen proportionalen Font.
  *
+ * @param  Text              Nullterminierter ASCII-Text.
+ * @param  X, Y              Cursorposition (obere linke Ecke der Zeile).
+ * @param  Colour            Vordergrundfarbe (RGB565).
+ * @param  Background_Colour Hintergrundfarbe (RGB565).
+ * @retval X-Position hinter dem letzten Zeichen.
  */
-void ILI9341_DrawPixelRGB(uint16_t x,uint16_t y,uint8_t r, uint8_t g, uint8_t b){
-	ILI9341_SetAddress(x, y, x, y);
+int16_t ILI9341_DrawFontText(const char *Text, int16_t X, int16_t Y, uint16_t Colour, uint16_t Background_Colour) {
+	if (font == NULL) return X;
 
-	// Convert 8-bit RGB values to 16-bit RGB565 format
-	uint16_t color = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+	while (*Text) {
+		X += ILI9341_DrawFontChar((uint8_t)*Text++, X, Y, Colour, Background_Colour);
+	}
+	return X;
+}
 
-	// Set the pixel at (x, y) with the calculated color
-	ILI9341_DrawPixel(x, y, color);
+/**
+ * @brief  Setzt den Font für ILI9341_DrawFontText() und ILI9341_MeasureText().
+ * @param  f Zeiger auf einen ILI9341_t3-Font (z.B. aus den PJRC-Font-Dateien).
+ */
+void ILI9341_SetFont(const ILI9341_t3_font_t *f) {
+	font = f;
 }
 
+/**
+ * @brief  Gibt die Zeilenhöhe des aktuellen Fonts zurück (0 ohne Font).
+ */
+uint8_t ILI9341_GetFontLineHeight() {
+	return (font != NULL) ? font->line_space : 0;
+}
 
 /**
- * @brief  Draws the outline of a circle on the display.
- * @param  x_pos: X-coordinate of the circle center.
- * @param  y_pos: Y-coordinate of the circle center.
- * @param  r: Radius of the circle.
- * @param  color: Color of the circle outline (16-bit RGB565 format).
- * @retval None
+ * @brief  FNV-1a-Hash eines Textes als Schlüssel der Text-Caches.
+ * @param  length Ausgabe: Länge des Textes.
+ */
+static uint32_t ILI9341_TextHash(const char *Text, uint16_t *length) {
+	uint32_t hash = 2166136261UL;
+	uint16_t n = 0;
+	for (const char *p = Text; *p; p++, n++) {
+		hash = (hash ^ (uint8_t)*p) * 16777619UL;
+	}
+	*length = n;
+	return hash;
+}
+
+/**
+ * @brief  Berechnet die Breite eines Textes im aktuellen Font in Pixeln.
  *
- * This function implements the Midpoint Circle Algorithm to efficiently
- * draw a circle by plotting symmetric points in all eight octants.
+ * Die Ergebnisse werden (pro Font, FNV-1a-Hash und Länge des Textes) in einem kleinen
+ * Ringpuffer zwischengespeichert, sodass wiederholte Layout-Berechnungen, z.B. für
+ * zentrierte Beschriftungen, die Glyphen-Köpfe nicht erneut dekodieren müssen.
+ *
+ * @param  Text Nullterminierter ASCII-Text.
+ * @retval Summe der Vorschübe aller Zeichen.
  */
-void ILI9341_DrawCircleOutline(uint16_t x_pos, uint16_t y_pos, uint8_t r, uint16_t color) {
+uint16_t ILI9341_MeasureText(const char *Text) {
+	if (font == NULL) return 0;
 
+	uint16_t length;
+	uint32_t hash = ILI9341_TextHash(Text, &length);
 
-	int x = r;
-	int y = 0;
-	int decisionOver2 = 1 - x; // Decision criterion divided by 2 evaluated at x=r, y=0
-
-	while (y <= x) {
-		// Octants are drawn in each step since the circle is symmetric
-		ILI9341_DrawPixel(x_pos + x, y_pos + y,color); // Octant 1
-		ILI9341_DrawPixel(x_pos + y, y_pos + x,color); // Octant 2
-		ILI9341_DrawPixel(x_pos - y, y_pos + x,color); // Octant 3
-		ILI9341_DrawPixel(x_pos - x, y_pos + y,color); // Octant 4
-		ILI9341_DrawPixel(x_pos - x, y_pos - y,color); // Octant 5
-		ILI9341_DrawPixel(x_pos - y, y_pos - x,color); // Octant 6
-		ILI9341_DrawPixel(x_pos + y, y_pos - x,color); // Octant 7
-		ILI9341_DrawPixel(x_pos + x, y_pos - y,color); // Octant 8
-
-		y++;
-		if (decisionOver2 <= 0) {
-			decisionOver2 += 2 * y + 1; // Change decision criterion for y -> y+1
-		} else {
-			x--;
-			decisionOver2 += 2 * (y - x) + 1; // Change decision criterion for y -> y+1, x -> x-1
+	for (uint8_t i = 0; i < ILI9341_TEXT_WIDTH_CACHE_ENTRIES; i++) {
+		ILI9341_TextWidthEntry *e = &ILI9341_TextWidthCache[i];
+		if (e->font == font && e->hash == hash && e->length == length) {
+			return e->width;
 		}
 	}
 
-
-}
-
-void ILI9341_DrawCircle(uint16_t x_pos, uint16_t y_pos, uint8_t r, uint16_t color) {
-	int x = r;
-	int y = 0;
-	int decisionOver2 = 1 - x; // Decision criterion divided by 2 evaluated at x=r, y=0
-
-	while (y <= x) {
-		// Draw horizontal lines between points in each octant
-		ILI9341_DrawHLine(x_pos - x, y_pos + y, 2 * x + 1,color); // Top segment
-		ILI9341_DrawHLine(x_pos - y, y_pos + x, 2 * y + 1,color); // Right segment
-		ILI9341_DrawHLine(x_pos - x, y_pos - y, 2 * x + 1,color); // Bottom segment
-		ILI9341_DrawHLine(x_pos - y, y_pos - x, 2 * y + 1,color); // Left segment
-
-		y++;
-		if (decisionOver2 <= 0) {
-			decisionOver2 += 2 * y + 1; // Change decision criterion for y -> y+1
-		} else {
-			x--;
-			decisionOver2 += 2 * (y - x) + 1; // Change decision criterion for y -> y+1, x -> x-1
+	uint16_t width = 0;
+	ILI9341_FontGlyph g;
+	for (const char *p = Text; *p; p++) {
+		if (ILI9341_FontGetGlyph((uint8_t)*p, &g)) {
+			width += g.delta;
 		}
 	}
-}
 
-void ILI9341_DrawFilledCircle(uint16_t x0, uint16_t y0, uint16_t radius, uint16_t color) {
-    int16_t x = radius;
-    int16_t y = 0;
-    int16_t err = 0;
-
-    while (x >= y) {
-        // Draw horizontal lines to fill the circle
-        ILI9341_DrawHLine(x0 - x, y0 + y, 2 * x, color);
-        ILI9341_DrawHLine(x0 - x, y0 - y, 2 * x, color);
-        ILI9341_DrawHLine(x0 - y, y0 + x, 2 * y, color);
-        ILI9341_DrawHLine(x0 - y, y0 - x, 2 * y, color);
-
-        // Update the midpoint error
-        if (err <= 0) {
-            y += 1;
-            err += 2 * y + 1;
-        }
-        if (err > 0) {
-            x -= 1;
-            err -= 2 * x + 1;
-        }
-    }
-}
+	ILI9341_TextWidthEntry *e = &ILI9341_TextWidthCache[ILI9341_TextWidthNext];
+	ILI9341_TextWidthNext = (ILI9341_TextWidthNext + 1) % ILI9341_TEXT_WIDTH_CACHE_ENTRIES;
+	e->font = font;
+	e->hash = hash;
+	e->length = length;
+	e->width = width;
 
-void ILI9341_SecretCommand() {
-	uint8_t param = 0x10;
-	ILI9341_SendCommandWithParam_8Bit(0xD9, &param, 1);
+	return width;
 }
 
-void DisplayImageArray(const uint16_t* imageData, uint16_t width, uint16_t height)
-{
 
-  /* Calculate screen centering (if needed) */
-  uint16_t x_start = (320 - width) / 2;  // Assuming 320x240 display
-  uint16_t y_start = (240 - height) / 2;
 
-  /* Set display address window */
-  ILI9341_SetAddress(x_start, y_start, x_start + width - 1, y_start + height - 1);
+/* --------------------------------- Textlayout --------------------------------- */
+
+/**
+ * @brief Zustand einer Zeile im proportionalen Font: ein Dekoder je Zeichen
+ */
+typedef struct {
+	uint16_t count;
+	uint16_t width;
+	uint8_t bpp;
+	uint16_t palette[16];
+	int16_t x[ILI9341_TEXT_MAX_RUN];        // Left edge of the glyph bitmap within the line
+	int16_t y0[ILI9341_TEXT_MAX_RUN];       // First glyph row within the line
+	ILI9341_FontGlyph glyph[ILI9341_TEXT_MAX_RUN];
+	ILI9341_FontRowDecoder decoder[ILI9341_TEXT_MAX_RUN];
+} ILI9341_FontTextRow;
+
+static ILI9341_FontTextRow ILI9341_FontRow;
+
+static ILI9341_TextLayout ILI9341_TextLayoutCache[ILI9341_TEXT_LAYOUT_CACHE_ENTRIES];
+static uint8_t ILI9341_TextLayoutNext = 0;
+
+/**
+ * @brief  Vorschub eines Zeichens: 5x5-Font in der Skalierung Size, bei Size == 0 aktueller Font.
+ */
+static uint16_t ILI9341_TextAdvance(char c, uint16_t Size) {
+	if (Size) return CHAR_WIDTH * Size;
 
-  ILI9341_SendCommand(0x2C);
+	ILI9341_FontGlyph g;
+	return ILI9341_FontGetGlyph((uint8_t)c, &g) ? g.delta : 0;
+}
 
-  /* Send image data to display */
-  ILI9341_SetData();
-  ILI9341_ChipSelect();
+/**
+ * @brief  Bricht einen Text in Zeilen von höchstens Width Pixeln um.
+ *
+ * Gierig von links: Umbrochen wird am letzten Leerzeichen, das noch passt, ein Wort breiter als
+ * die Zeile wird zwischen zwei Zeichen getrennt. '\n' beendet die Zeile immer. Leerzeichen am
+ * Ende einer umbrochenen Zeile und am Anfang der folgenden gehören zu keiner Zeile.
+ */
+static void ILI9341_TextBreak(const char *Text, uint16_t Width, uint16_t Size, ILI9341_TextLayout *layout) {
+	uint16_t space = ILI9341_TextAdvance(' ', Size);
+	uint16_t i = 0;
 
-  /* Send data in chunks to work with DMA buffer size limitations */
-  #define CHUNK_SIZE 1024  // Adjust based on your available memory
+	layout->lineCount = 0;
+	layout->truncated = 0;
 
-  for (uint32_t i = 0; i < width * height; i += CHUNK_SIZE) {
-    uint32_t chunk = ((width * height) - i > CHUNK_SIZE) ? CHUNK_SIZE : (width * height) - i;
+	while (Text[i]) {
+		if (layout->lineCount == ILI9341_TEXT_MAX_LINES) {
+			layout->truncated = 1;
+			return;
+		}
 
-    /* Use DMA for faster transfer */
-    HAL_SPI_Transmit(ILI9341_SPI, (uint8_t*)&imageData[i], chunk * 2,HAL_MAX_DELAY);
+		uint16_t start = i;
+		uint16_t width = 0;
+		uint16_t breakAt = start, breakWidth = 0;	// first space after the last word that fits
+		while (Text[i] && Text[i] != '\n') {
+			uint16_t advance = ILI9341_TextAdvance(Text[i], Size);
+			if (Text[i] == ' ') {
+				if (i > start && Text[i - 1] != ' ') {
+					breakAt = i;
+					breakWidth = width;
+				}
+			} else if (width + advance > Width || i - start >= ILI9341_TEXT_MAX_RUN) {
+				break;
+			}
+			width += advance;
+			i++;
+		}
 
-    /* Wait for DMA to complete */
-    while (HAL_SPI_GetState(ILI9341_SPI) != HAL_SPI_STATE_READY) {}
-  }
+		uint16_t end = i;
+		uint16_t next = i;
+		if (Text[i] == '\n') {
+			next = i + 1;
+		} else if (Text[i]) {
+			if (breakAt > start) {
+				end = breakAt;
+				width = breakWidth;
+			} else if (i == start) {
+				// A single character wider than the line still gets a line of its own
+				width = ILI9341_TextAdvance(Text[i], Size);
+				end = i + 1;
+			}
+			next = end;
+			while (Text[next] == ' ') {
+				next++;
+			}
+		}
+		while (end > start && Text[end - 1] == ' ') {
+			end--;
+			width -= space;
+		}
 
-  ILI9341_ChipDeselect();
+		ILI9341_TextRun *run = &layout->runs[layout->lineCount++];
+		run->start = start;
+		run->length = end - start;
+		run->width = width;
+		i = next;
+	}
 }
 
 /**
- * @brief  Zeichnet ein Bild auf dem ILI9341-Display.
+ * @brief  Bricht einen Text für eine Breite um.
  *
- * Diese Funktion zeichnet ein Bild an der angegebenen Position (x,y) mit der
- * angegebenen Größe (width x height). Das Bild wird aus einem Byte-Array gelesen,
- * das die Pixel im RGB565-Format enthält (2 Bytes pro Pixel). Der Algorithmus
- * führt folgende Schritte aus:
- * 1. Setzt das Adressfenster auf den Bereich, in dem das Bild gezeichnet werden soll
- * 2. Sendet den Memory-Write-Befehl (0x2C) an das Display
- * 3. Überträgt die Bilddaten in einem Durchgang an das Display
+ * Die Zeilen werden (pro Font bzw. Skalierung, Breite, FNV-1a-Hash und Länge des Textes) in
+ * einem Ringpuffer mit ILI9341_TEXT_LAYOUT_CACHE_ENTRIES Einträgen gehalten; statische
+ * Beschriftungen werden damit nur beim ersten Zeichnen vermessen.
  *
- * @param  x      Die x-Koordinate der oberen linken Ecke des Bildes.
- * @param  y      Die y-Koordinate der oberen linken Ecke des Bildes.
- * @param  width  Die Breite des Bildes in Pixeln.
- * @param  height Die Höhe des Bildes in Pixeln.
- * @param  image  Zeiger auf das Byte-Array, das die Bilddaten im RGB565-Format enthält
- *                (2 Bytes pro Pixel, insgesamt width*height*2 Bytes).
+ * @param  Text  Nullterminierter ASCII-Text, '\n' erzwingt einen Zeilenumbruch.
+ * @param  Width Breite der Zeilen in Pixeln.
+ * @param  Size  Skalierung des 5x5-Fonts, 0 für den aktuellen proportionalen Font (ILI9341_SetFont()).
+ * @retval Umbrochener Text, gültig bis der Eintrag von einem anderen Text verdrängt wird;
+ *         NULL bei Size == 0 ohne Font.
+ */
+const ILI9341_TextLayout* ILI9341_LayoutText(const char *Text, uint16_t Width, uint16_t Size) {
+	if (Size == 0 && font == NULL) return NULL;
+
+	const ILI9341_t3_font_t *f = Size ? NULL : font;
+	uint16_t length;
+	uint32_t hash = ILI9341_TextHash(Text, &length);
+
+	for (uint8_t i = 0; i < ILI9341_TEXT_LAYOUT_CACHE_ENTRIES; i++) {
+		ILI9341_TextLayout *e = &ILI9341_TextLayoutCache[i];
+		if (e->lineHeight != 0 && e->font == f && e->size == Size && e->maxWidth == Width
+				&& e->hash == hash && e->length == length) {
+			return e;
+		}
+	}
+
+	ILI9341_TextLayout *layout = &ILI9341_TextLayoutCache[ILI9341_TextLayoutNext];
+	ILI9341_TextLayoutNext = (ILI9341_TextLayoutNext + 1) % ILI9341_TEXT_LAYOUT_CACHE_ENTRIES;
+	layout->font = f;
+	layout->size = Size;
+	layout->maxWidth = Width;
+	layout->hash = hash;
+	layout->length = length;
+	layout->lineHeight = Size ? CHAR_HEIGHT * Size : font->line_space;
+	ILI9341_TextBreak(Text, Width, Size, layout);
+
+	return layout;
+}
+
+/**
+ * @brief  ILI9341_TextRowFunc für den proportionalen Font.
  *
- * @note   Die Bilddaten müssen im RGB565-Format vorliegen (High-Byte zuerst),
- *         wobei jedes Pixel durch 2 Bytes dargestellt wird. Das Array muss
- *         mindestens width*height*2 Bytes groß sein.
+ * Die Zeile wird mit der Hintergrundfarbe gefüllt, danach setzt jedes Zeichen nur seine
+ * gedeckten Pixel; überhängende Glyphen überschreiben den Nachbarn daher nicht.
  */
-void ILI9341_DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *image){
-    // Set the drawing window
-    ILI9341_SetAddress(x, y, x + width - 1, y + height - 1);
+static void ILI9341_FontTextRaster(void *context, uint16_t row, uint8_t *line) {
+	ILI9341_FontTextRow *t = context;
+	uint16_t *dst = (uint16_t*)line;
+
+	if (dst != NULL) {
+		for (uint16_t x = 0; x < t->width; x++) {
+			dst[x] = t->palette[0];
+		}
+	}
 
-    ILI9341_SendCommand(0x2C);
+	for (uint16_t k = 0; k < t->count; k++) {
+		const ILI9341_FontGlyph *g = &t->glyph[k];
+		int32_t gy = (int32_t)row - t->y0[k];
+		if (gy < 0 || gy >= (int32_t)g->height) continue;
 
+		ILI9341_FontNextRow(g, &t->decoder[k], t->bpp);
+		if (dst == NULL) continue;
 
-	ILI9341_SendData(image, width*height*2);
+		for (uint32_t px = 0; px < g->width; px++) {
+			int32_t x = t->x[k] + (int32_t)px;
+			if (x < 0 || x >= t->width) continue;
 
+			uint32_t alpha;
+			if (t->bpp == 1) {
+				alpha = fetchbit(g->data, t->decoder[k].rowstart + px) ? 1 : 0;
+			} else {
+				alpha = fetchbits_unsigned(g->data, t->decoder[k].rowstart + px * t->bpp, t->bpp);
+			}
+			if (alpha) {
+				dst[x] = t->palette[alpha];
+			}
+		}
+	}
 }
 
-void ILI9341_DrawChar(char Character, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
-{
-	uint8_t 	function_char;
-    uint16_t 	i,j;
+/**
+ * @brief  Zeichnet eine Zeile aus dem 5x5-Font über die ganze Breite der Box.
+ * @param  offset Beginn der ersten Zeichenzelle; Zellen, die rechts herausragen, entfallen.
+ */
+static void ILI9341_DrawStdRun(const char *Text, uint16_t count, int16_t X, int16_t Y, uint16_t Width, uint16_t offset,
+		uint16_t Colour, uint16_t Size, uint16_t Background_Colour) {
+	uint16_t cellWidth = CHAR_WIDTH * Size;
+	uint16_t height = CHAR_HEIGHT * Size;
+	if (offset + (uint32_t)count * cellWidth > Width) {
+		count = (Width - offset) / cellWidth;
+	}
+
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording()) {
+		uint16_t end = offset + count * cellWidth;
+		ILI9341_FillWindow(X, Y, offset, height, Background_Colour);
+		for (uint16_t i = 0; i < count; i++) {
+			ILI9341_DrawChar(Text[i], X + offset + i * cellWidth, Y, Colour, Size, Background_Colour);
+		}
+		ILI9341_FillWindow(X + end, Y, Width - end, height, Background_Colour);
+		return;
+	}
+#endif
 
-	function_char = Character;
+	ILI9341_StdTextRow row = { Text, count, offset, Width, Size, Colour, Background_Colour };
+	ILI9341_TextLineWrite(X, Y, Width, height, ILI9341_StdTextRaster, &row);
+}
 
-    if (function_char < ' ') {
-        Character = 0;
-    } else {
-    	function_char -= 32;
+/**
+ * @brief  Zeichnet eine Zeile im aktuellen Font über die ganze Breite der Box.
+ */
+static void ILI9341_DrawFontRun(const char *Text, uint16_t count, int16_t X, int16_t Y, uint16_t Width, uint16_t offset,
+		uint16_t Colour, uint16_t Background_Colour) {
+	ILI9341_FontTextRow *t = &ILI9341_FontRow;
+
+	t->count = 0;
+	t->width = Width;
+	t->bpp = ILI9341_FontBpp();
+	ILI9341_FontPalette(Colour, Background_Colour, t->bpp, t->palette);
+
+	int32_t x = offset;
+	for (uint16_t i = 0; i < count && t->count < ILI9341_TEXT_MAX_RUN; i++) {
+		ILI9341_FontGlyph *g = &t->glyph[t->count];
+		if (!ILI9341_FontGetGlyph((uint8_t)Text[i], g)) continue;
+
+		t->x[t->count] = x + g->xoffset;
+		t->y0[t->count] = font->cap_height - (int32_t)g->height - g->yoffset;
+		t->decoder[t->count] = (ILI9341_FontRowDecoder){ g->bitoffset, g->bitoffset, 0 };
+		t->count++;
+		x += g->delta;
 	}
 
-	char temp[CHAR_WIDTH];
-	for(uint16_t k = 0; k<CHAR_WIDTH; k++)
-	{
-	temp[k] = stdfont[function_char][k];
+	ILI9341_TextLineWrite(X, Y, Width, font->line_space, ILI9341_FontTextRaster, t);
+}
+
+/**
+ * @brief  Zeichnet die Zeilen eines umbrochenen Textes untereinander.
+ * @retval Höhe aller Zeilen in Pixeln.
+ */
+static uint16_t ILI9341_DrawLayout(const char *Text, const ILI9341_TextLayout *layout, int16_t X, int16_t Y,
+		uint16_t Width, ILI9341_TextAlign Align, uint16_t Colour, uint16_t Background_Colour) {
+	for (uint8_t n = 0; n < layout->lineCount; n++) {
+		const ILI9341_TextRun *run = &layout->runs[n];
+		int16_t y = Y + n * layout->lineHeight;
+
+		uint16_t offset = 0;
+		if (run->width < Width) {
+			if (Align == ILI9341_ALIGN_CENTER) {
+				offset = (Width - run->width) / 2;
+			} else if (Align == ILI9341_ALIGN_RIGHT) {
+				offset = Width - run->width;
+			}
+		}
+
+		if (layout->font == NULL) {
+			ILI9341_DrawStdRun(&Text[run->start], run->length, X, y, Width, offset, Colour, layout->size, Background_Colour);
+		} else {
+			ILI9341_DrawFontRun(&Text[run->start], run->length, X, y, Width, offset, Colour, Background_Colour);
+		}
 	}
+	return layout->lineCount * layout->lineHeight;
+}
 
-    // Draw pixels
-	//ILI9341_DrawRectangle(X, Y, CHAR_WIDTH*Size, CHAR_HEIGHT*Size, Background_Colour);
-    for (j=0; j<CHAR_WIDTH; j++) {
-        for (i=0; i<CHAR_HEIGHT; i++) {
-            if (temp[j] & (1<<i)) {
-				if(Size == 1)
-				{
-					ILI9341_DrawPixel(X+j, Y+i, Colour);
-				}
-				else
-				{
-					ILI9341_DrawRectangle(X+(j*Size), Y+(i*Size), Size, Size, Colour);
-				}
-            }
-        }
-    }
+/**
+ * @brief  Zeichnet einen umbrochenen Text aus dem 5x5-Font deckend in eine Box.
+ *
+ * Jede Zeile wird über die ganze Breite der Box in einem Adressfenster gesendet, Ausrichtung
+ * und Rest der Zeile sind Hintergrund; ein geändertes Label muss vorher nicht gelöscht werden.
+ * Unter der letzten Zeile zeichnet die Funktion nichts, bei weniger Zeilen als zuvor muss der
+ * Aufrufer den Rest der Box selbst füllen.
+ *
+ * @param  Text              Nullterminierter ASCII-Text, '\n' erzwingt einen Zeilenumbruch.
+ * @param  X, Y              Obere linke Ecke der Box.
+ * @param  Width             Breite der Box in Pixeln.
+ * @param  Align             Ausrichtung der Zeilen.
+ * @param  Colour            Vordergrundfarbe (RGB565).
+ * @param  Size              Skalierungsfaktor (1 = 6x8 Pixel je Zeichen).
+ * @param  Background_Colour Hintergrundfarbe (RGB565).
+ * @retval Höhe des Textes in Pixeln.
+ */
+uint16_t ILI9341_DrawTextBox(const char *Text, int16_t X, int16_t Y, uint16_t Width, ILI9341_TextAlign Align,
+		uint16_t Colour, uint16_t Size, uint16_t Background_Colour) {
+	if (Size == 0) return 0;
+
+	const ILI9341_TextLayout *layout = ILI9341_LayoutText(Text, Width, Size);
+	return ILI9341_DrawLayout(Text, layout, X, Y, Width, Align, Colour, Background_Colour);
 }
 
-void ILI9341_DrawText(const char* Text, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
-{
-    while (*Text) {
-        // Check if the next character will fit within the display's width
-        if (X + CHAR_WIDTH * Size > ILI9341_WIDTH) {
-            break; // Stop drawing if the next character exceeds the display width
-        }
+/**
+ * @brief  Zeichnet einen umbrochenen Text im aktuellen proportionalen Font deckend in eine Box.
+ *
+ * Wie ILI9341_DrawTextBox(), Zeilenhöhe ist line_space des Fonts. Alle Zeichen einer Zeile
+ * werden gemeinsam dekodiert, statt eines Fensters je Zeichen gibt es eines je Zeile.
+ *
+ * @retval Höhe des Textes in Pixeln (0 ohne Font).
+ */
+uint16_t ILI9341_DrawFontTextBox(const char *Text, int16_t X, int16_t Y, uint16_t Width, ILI9341_TextAlign Align,
+		uint16_t Colour, uint16_t Background_Colour) {
+	if (font == NULL) return 0;
 
-    	ILI9341_DrawChar(*Text++, X, Y, Colour, Size, Background_Colour);
-        X += CHAR_WIDTH*Size;
-    }
+	const ILI9341_TextLayout *layout = ILI9341_LayoutText(Text, Width, 0);
+	return ILI9341_DrawLayout(Text, layout, X, Y, Width, Align, Colour, Background_Colour);
 }
 
 
@@ -1119,70 +3863,130 @@ void ILI9341_DrawBorder(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
 	ILI9341_DrawRectangle(x + width, y, borderSize, height, color);
 }
 
-// Function to draw a filled rounded rectangle
+/**
+ * @brief  Zeichnet ein gefülltes abgerundetes Rechteck als ein Span pro Zeile in einer CS-Phase.
+ *
+ * Die Zeilen ohne Rundung werden zu einem einzigen Rechteck zusammengefasst.
+ *
+ * @param  x, y          Obere linke Ecke.
+ * @param  width, height Größe in Pixeln.
+ * @param  radius        Eckradius (wird auf die halbe Breite/Höhe begrenzt).
+ * @param  color         Farbe (RGB565).
+ */
 void ILI9341_DrawFilledRoundedRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t radius, uint16_t color) {
-    // Draw the filled rectangle (excluding the rounded corners)
-    ILI9341_DrawRectangle(x + radius, y, width - 2 * radius, height, color); // Middle rectangle
-    ILI9341_DrawRectangle(x, y + radius, width, height - 2 * radius, color); // Middle rectangle
-
-    // Draw the four rounded corners
-    ILI9341_DrawFilledCircle(x + radius, y + radius, radius, color); // Top-left corner
-    ILI9341_DrawFilledCircle(x + width - radius - 1, y + radius, radius, color); // Top-right corner
-    ILI9341_DrawFilledCircle(x + radius, y + height - radius - 1, radius, color); // Bottom-left corner
-    ILI9341_DrawFilledCircle(x + width - radius - 1, y + height - radius - 1, radius, color); // Bottom-right corner
+	ILI9341_FillRoundRect(x, y, width, height, radius, color);
 }
 
+/**
+ * @brief  Zeichnet ein abgerundetes Rechteck mit Rahmen ohne Überzeichnen.
+ *
+ * Zuerst wird nur der Rahmen (äußere Form ohne innere Form) gezeichnet, danach die innere
+ * Fläche. Beide Formen haben denselben Eckradius. Jede Farbe läuft in einer CS-Phase.
+ *
+ * @param  x, y          Obere linke Ecke.
+ * @param  width, height Äußere Größe in Pixeln.
+ * @param  radius        Eckradius.
+ * @param  fillColor     Farbe der inneren Fläche.
+ * @param  borderColor   Farbe des Rahmens.
+ * @param  borderSize    Rahmenbreite in Pixeln.
+ */
 void ILI9341_DrawRoundedRectWithBorder(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t radius, uint16_t fillColor, uint16_t borderColor, uint16_t borderSize) {
+	int16_t ox = x, oy = y, ow = width, oh = height;
+	int16_t ix = x + borderSize, iy = y + borderSize;
+	int16_t iw = width - 2 * borderSize, ih = height - 2 * borderSize;
 
-    // Draw the outer rounded rectangle (border)
-    ILI9341_DrawFilledRoundedRect(x, y, width, height, radius, borderColor);
+	if (ILI9341_ClipReject(ox, oy, (int32_t)ox + ow - 1, (int32_t)oy + oh - 1)) return;
 
-    // Draw the inner rounded rectangle (fill)
-    ILI9341_DrawFilledRoundedRect(x + borderSize, y + borderSize, width - 2 * borderSize, height - 2 * borderSize, radius, fillColor);
+	int16_t left, top, right, bottom;
+	ILI9341_ClipBounds(&left, &top, &right, &bottom);
 
-}
+	int16_t *outerWidths = ILI9341_SpanWidths[0];
+	int16_t *innerWidths = ILI9341_SpanWidths[1];
+	int16_t ro = ILI9341_RoundRectRadius(ow, oh, radius, outerWidths);
+	int16_t ri = ILI9341_RoundRectRadius(iw, ih, radius, innerWidths);
 
+	// Rahmen: äußerer Span ohne inneren Span
+	ILI9341_SpanBegin(borderColor);
+	for (int16_t row = oy > top ? oy : top; row < oy + oh && row <= bottom; row++) {
+		int16_t a, b, c, d;
+		if (!ILI9341_RoundRectRow(ox, oy, ow, oh, ro, outerWidths, row, &a, &b)) continue;
+
+		if (!ILI9341_RoundRectRow(ix, iy, iw, ih, ri, innerWidths, row, &c, &d)) {
+			ILI9341_SpanFill(0, a, b, row);
+		} else {
+			ILI9341_SpanFill(0, a, c - 1, row);
+			ILI9341_SpanFill(1, d + 1, b, row);
+		}
+	}
+	ILI9341_SpanEnd();
+
+	// Innere Fläche
+	ILI9341_SpanBegin(fillColor);
+	for (int16_t row = iy > top ? iy : top; row < iy + ih && row <= bottom; row++) {
+		int16_t c, d;
+		if (ILI9341_RoundRectRow(ix, iy, iw, ih, ri, innerWidths, row, &c, &d)) {
+			ILI9341_SpanFill(0, c, d, row);
+		}
+	}
+	ILI9341_SpanEnd();
+}
 
 void setTextColor(uint16_t c){
 	textcolor = textbgcolor = c;
 }
 
+/**
+ * @brief  Zeichnet ein gefülltes abgerundetes Rechteck (siehe ILI9341_DrawFilledRoundedRect()).
+ */
 void ILI9341_FillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color){
-    // Draw the central rectangle
-    ILI9341_fillRect(x + r, y, w - 2 * r, h, color);
-
-    // Draw the four rounded corners
-    ILI9341_FillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color); // Top-right corner
-    ILI9341_FillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);         // Top-left corner
-    ILI9341_FillCircleHelper(x + r, y + h - r - 1, r, 4, h - 2 * r - 1, color); // Bottom-left corner
-    ILI9341_FillCircleHelper(x + w - r - 1, y + h - r - 1, r, 8, h - 2 * r - 1, color); // Bottom-right corner
+	int16_t *widths = ILI9341_SpanWidths[0];
+	if (ILI9341_ClipReject(x, y, (int32_t)x + w - 1, (int32_t)y + h - 1)) return;
+	r = ILI9341_RoundRectRadius(w, h, r, widths);
+
+	int16_t left, top, right, bottom;
+	ILI9341_ClipBounds(&left, &top, &right, &bottom);
+	int16_t rowFirst = y > top ? y : top;
+	int16_t rowEnd = y + h - 1 < bottom ? y + h : bottom + 1;
+
+	ILI9341_SpanBegin(color);
+	for (int16_t row = rowFirst; row < rowEnd; row++) {
+		int16_t x1, x2;
+		if (ILI9341_RoundRectRow(x, y, w, h, r, widths, row, &x1, &x2)) {
+			ILI9341_SpanFill(0, x1, x2, row);
+		}
+	}
+	ILI9341_SpanEnd();
 }
+
+/**
+ * @brief  Füllt die rechte (cornername & 1) und/oder linke (cornername & 2) Hälfte eines Kreises,
+ *         die vertikal um delta Zeilen gestreckt ist.
+ *
+ * Die Mittelspalte x0 selbst wird nicht gezeichnet. Die Spans laufen zeilenweise in einer CS-Phase.
+ */
 void ILI9341_FillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, int16_t delta, uint16_t color){
-    int16_t f = 1 - r;
-    int16_t ddF_x = 1;
-    int16_t ddF_y = -2 * r;
-    int16_t x = 0;
-    int16_t y = r;
-
-    while (x < y) {
-        if (f >= 0) {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
-        }
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
+	int16_t *widths = ILI9341_SpanWidths[0];
+	r = ILI9341_CircleWidths(r, widths);
+	if (ILI9341_ClipReject(x0 - r, y0 - r, x0 + r, (int32_t)y0 + r + delta)) return;
+
+	ILI9341_SpanBegin(color);
+	for (int16_t row = y0 - r; row <= y0 + r + delta; row++) {
+		int16_t d = 0;
+		if (row < y0) {
+			d = y0 - row;
+		} else if (row > y0 + delta) {
+			d = row - (y0 + delta);
+		}
+		int16_t hw = widths[d];
 
-        if (cornername & 0x1) {
-            ILI9341_DrawVLine(x0 + x, y0 - y, 2 * y + 1 + delta, color);
-            ILI9341_DrawVLine(x0 + y, y0 - x, 2 * x + 1 + delta, color);
-        }
-        if (cornername & 0x2) {
-            ILI9341_DrawVLine(x0 - x, y0 - y, 2 * y + 1 + delta, color);
-            ILI9341_DrawVLine(x0 - y, y0 - x, 2 * x + 1 + delta, color);
-        }
-    }
+		if (cornername & 0x1) {
+			ILI9341_SpanFill(0, x0 + 1, x0 + hw, row);
+		}
+		if (cornername & 0x2) {
+			ILI9341_SpanFill(1, x0 - hw, x0 - 1, row);
+		}
+	}
+	ILI9341_SpanEnd();
 }
 
 // Macro to swap two values
@@ -1195,11 +3999,11 @@ void ILI9341_FillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornern
  *
  * Diese Funktion lädt und zeigt eine binäre Bilddatei von der SD-Karte auf dem Display an.
  * Der Algorithmus funktioniert wie folgt:
- * 1. Mounten der SD-Karte
+ * 1. Anfordern des persistenten SD-Volumes (SDCard_Acquire)
  * 2. Öffnen der angegebenen Datei im Lesemodus
- * 3. Zeilenweises Lesen der Bilddaten (RGB565-Format, 2 Bytes pro Pixel)
- * 4. Zeichnen jeder Zeile auf dem Display mit ILI9341_DrawImage()
- * 5. Schließen der Datei und Unmounten der SD-Karte nach Abschluss
+ * 3. Setzen des Adressfensters für das gesamte Bild
+ * 4. Blockweises Lesen der Bilddaten (RGB565-Format, 2 Bytes pro Pixel) und Übertragen per DMA
+ * 5. Schließen der Datei und Freigeben des Volumes nach Abschluss
  *
  * @param  filename Der Pfad zur Binärdatei auf der SD-Karte.
  * @param  x        Die x-Koordinate der oberen linken Ecke des Bildes auf dem Display.
@@ -1208,47 +4012,120 @@ void ILI9341_FillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornern
  * @param  height   Die Höhe des Bildes in Pixeln.
  *
  * @note   Die Binärdatei muss Pixeldaten im RGB565-Format enthalten (2 Bytes pro Pixel).
- *         Die Funktion liest das Bild zeilenweise ein, um Speicher zu sparen, und
- *         verwendet einen Puffer der Größe width*2 Bytes für jede Zeile.
- *         Eine Überprüfung der Dateigröße ist auskommentiert, kann aber bei Bedarf
- *         aktiviert werden, um sicherzustellen, dass die Datei genügend Daten enthält.
+ *         Wrapper um ILI9341_DrawBinaryFileRegion() für das ganze Bild.
  */
 void ILI9341_DrawBinaryFile(const char* filename, uint16_t x, uint16_t y, uint16_t width, uint16_t height){
+	ILI9341_DrawBinaryFileRegion(filename, width, height, 0, 0, width, height, x, y);
+}
+
+/**
+ * @brief  Zeichnet einen Ausschnitt eines RGB565-Bildes von der SD-Karte.
+ *
+ * Die Datei wird in Bändern aus ganzen Bildzeilen gelesen, sodass jedes f_read() einen
+ * zusammenhängenden Bereich abdeckt und FatFs volle Sektoren direkt (Multi-Block-Read)
+ * in den Puffer liest. Die beiden ILI9341_FileBuffer wechseln sich ab: Während DMA
+ * das eine Band zum Display sendet, wird das nächste von der SD-Karte gelesen.
+ * Bei einem Ausschnitt werden die Zeilen im Puffer zusammengeschoben und das ganze
+ * Band unter einem einzigen Adressfenster gesendet.
+ *
+ * @param  filename    Der Pfad zur Binärdatei auf der SD-Karte.
+ * @param  imageWidth  Breite des Bildes in der Datei.
+ * @param  imageHeight Höhe des Bildes in der Datei.
+ * @param  srcX, srcY  Obere linke Ecke des Ausschnitts im Bild.
+ * @param  width       Breite des Ausschnitts.
+ * @param  height      Höhe des Ausschnitts.
+ * @param  x, y        Zielposition auf dem Display.
+ */
+void ILI9341_DrawBinaryFileRegion(const char* filename, uint16_t imageWidth, uint16_t imageHeight,
+		uint16_t srcX, uint16_t srcY, uint16_t width, uint16_t height, uint16_t x, uint16_t y){
+
+	if (srcX + width > imageWidth) width = imageWidth - srcX;
+	if (srcY + height > imageHeight) height = imageHeight - srcY;
+	if (srcX >= imageWidth || srcY >= imageHeight || width == 0 || height == 0) return;
+
+	uint32_t fileRowBytes = (uint32_t)imageWidth * 2;
+	uint32_t rowBytes = (uint32_t)width * 2;
+	uint32_t rowsPerBand = ILI9341_FILE_CHUNK_SIZE / fileRowBytes;
+	if (rowsPerBand == 0) {
+		printf("Image too wide for file buffer\n");
+		return;
+	}
 
-	if (!mountSD()){
+	if (SDCard_Acquire() == NULL){
 		printf("Could not mount SDCard");
 		return;
 	}
 
 	FIL file = {0};          // File object
 	UINT bytesRead;    // Number of bytes read
-	uint8_t buffer[width*2]; // Buffer for reading pixel data (adjust size as needed)
 
 	// Open the file
-	FRESULT res = f_open(&file, filename, FA_READ);
+	// Sprite sheets: with the cluster table the seek to srcY does not walk the FAT chain
+	FRESULT res = FastSeek_Open(&file, filename);
 	if (res != FR_OK) {
 		printf("Failed to open file: %d\n", res);
+		SDCard_CheckResult(res);
+		SDCard_Release();
 		return;
 	}
 
-	// Read and display the binary file
-	for (uint16_t row = 0; row < height; row++) {
-		// Read a row of pixel data
-		res = f_read(&file, buffer, width * 2, &bytesRead);
+	res = f_lseek(&file, (FSIZE_t)srcY * fileRowBytes);
 
-
-		if (res != FR_OK || bytesRead != width * sizeof(uint16_t)) {
+#ifdef ILI9341_USE_FRAMEBUFFER
+	uint8_t toFramebuffer = ILI9341_FB_IsEnabled();
+#else
+	uint8_t toFramebuffer = 0;
+#endif
+	uint8_t streaming = 0;
+	uint8_t index = 0;
+
+	for (uint16_t row = 0; row < height && res == FR_OK; ) {
+		uint16_t rows = (height - row < rowsPerBand) ? height - row : rowsPerBand;
+		uint32_t bandBytes = rows * fileRowBytes;
+		uint8_t *buffer = ILI9341_FileBuffer[index];
+
+		// Der Puffer wurde vor zwei Bändern übergeben; ILI9341_SendDataAsync() hat auf dessen Ende gewartet
+		res = f_read(&file, buffer, bandBytes, &bytesRead);
+		if (res != FR_OK || bytesRead != bandBytes) {
+			// Zu kurze Datei ist kein Kartenfehler; res bleibt dann FR_OK
 			printf("Failed to read file: %d\n", res);
-			f_close(&file);
-			return;
+			break;
+		}
+
+		// Ausschnitt: Zeilen im Puffer zusammenschieben
+		if (width != imageWidth) {
+			for (uint16_t r = 0; r < rows; r++) {
+				memmove(buffer + r * rowBytes, buffer + r * fileRowBytes + (uint32_t)srcX * 2, rowBytes);
+			}
+		}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+		if (toFramebuffer) {
+			ILI9341_FB_DrawImage(x, y + row, width, rows, buffer);
+			row += rows;
+			continue;
 		}
+#endif
+		if (!streaming) {
+			// Adressfenster einmal für das ganze Bild, CS bleibt bis zum Ende aktiv
+			ILI9341_BeginWrite(x, y, x + width - 1, y + height - 1);
+			ILI9341_StreamBegin();
+			streaming = 1;
+		}
+		ILI9341_SendDataAsync(buffer, rows * rowBytes);
+
+		index ^= 1;
+		row += rows;
+	}
 
-		// Draw the row on the screen
-		ILI9341_DrawImage(x, y+row, width, 1, buffer);
+	if (streaming) {
+		ILI9341_StreamEnd();
 	}
+	(void)toFramebuffer;
 
 	// Close the file
-	f_close(&file);
+	FastSeek_Close(&file);
 
-	unmountSD();
+	SDCard_CheckResult(res);
+	SDCard_Release();
 }
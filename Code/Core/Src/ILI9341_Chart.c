@@ -0,0 +1,422 @@
+/**
+ * @file    ILI9341_Chart.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Laufende Messkurve (Strip-Chart) für Potis, Temperatur und ADC-Blöcke
+ *
+ * Jede Spalte der Kurve ist das Minimum und Maximum aus decimation Werten; kommen Werte
+ * schneller als Spalten, gehen so keine Spitzen verloren. Die Erzeuger (ILI9341_Chart_AddSample(),
+ * ILI9341_Chart_AdcListener() im DMA-Interrupt) füllen nur eine kleine Warteschlange fertiger
+ * Spalten, ILI9341_Chart_Render() zeichnet sie im UI-Task. Die gezeichneten Spalten liegen als
+ * Ring im Chart, damit die Fläche nach einer Überdeckung neu entstehen kann.
+ *
+ * Eine neue Spalte kostet eine Spalte auf dem Bus (Hintergrund darüber, Kurve, Hintergrund
+ * darunter), nie die ganze Fläche:
+ * - ILI9341_CHART_SWEEP: die Spalte wird an der Schreibmarke gezeichnet, die nächste Spalte
+ *   in accent gelöscht. Funktioniert überall, auch mit Framebuffer und Kacheln.
+ * - ILI9341_CHART_SCROLL, Hardware: im Querformat erscheinen die Zeilen des Panels als
+ *   Spalten. Deckt die Kurve die volle Displayhöhe ab, liegt sie im Speicher wie im Sweep-
+ *   Betrieb und das Panel verschiebt die Anzeige (ILI9341_ScrollTo(), ein Befehl je Render).
+ *   Alles in diesen Spalten scrollt mit, die Fläche gehört also allein der Kurve.
+ * - ILI9341_CHART_SCROLL mit Framebuffer: die Zeilen der Fläche werden im RAM um die neuen
+ *   Spalten nach links verschoben. Übertragen wird dann beim Flush die ganze Fläche.
+ * Passt keines davon (Hochformat, nicht volle Höhe, ohne Framebuffer), läuft SCROLL als Sweep.
+ *
+ * Der Ring wird nur aus dem UI-Task geändert. Je Chart darf nur ein Erzeuger einspeisen.
+ */
+
+#include "ILI9341_Chart.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include <string.h>
+
+#define ILI9341_CHART_MASK   (ILI9341_CHART_QUEUE - 1)
+
+static void ILI9341_Chart_Push(ILI9341_Chart *chart, int32_t min, int32_t max);
+static int16_t ILI9341_Chart_ValueToY(const ILI9341_Chart *chart, int32_t value);
+static void ILI9341_Chart_DrawColumn(const ILI9341_Chart *chart, int16_t x, uint16_t index, uint8_t background);
+static void ILI9341_Chart_DrawMarker(const ILI9341_Chart *chart);
+static void ILI9341_Chart_DrawAll(ILI9341_Chart *chart, uint8_t chronological);
+static uint8_t ILI9341_Chart_CanShift(const ILI9341_Chart *chart);
+static void ILI9341_Chart_Shift(ILI9341_Chart *chart, uint16_t columns);
+static uint8_t ILI9341_Chart_SetupScroll(ILI9341_Chart *chart);
+static void ILI9341_Chart_UpdateScroll(const ILI9341_Chart *chart);
+
+/**
+ * @brief  Legt eine Kurve an (schwarz auf weiß, Wertebereich 0-65535, eine Spalte je Wert)
+ * @param  width: Spalten, höchstens ILI9341_CHART_MAX_WIDTH
+ */
+void ILI9341_Chart_Init(ILI9341_Chart *chart, int16_t x, int16_t y, uint16_t width, uint16_t height,
+		ILI9341_ChartMode mode) {
+	memset(chart, 0, sizeof(*chart));
+	chart->x = x;
+	chart->y = y;
+	chart->width = (width > ILI9341_CHART_MAX_WIDTH) ? ILI9341_CHART_MAX_WIDTH : width;
+	chart->height = height;
+	chart->colour = BLACK;
+	chart->background = WHITE;
+	chart->accent = LIGHTGREY;
+	chart->mode = mode;
+	chart->min = 0;
+	chart->max = 65535;
+	chart->decimation = 1;
+	chart->redraw = 1;
+}
+
+void ILI9341_Chart_SetStyle(ILI9341_Chart *chart, uint16_t colour, uint16_t background, uint16_t accent) {
+	chart->colour = colour;
+	chart->background = background;
+	chart->accent = accent;
+	chart->redraw = 1;
+}
+
+/**
+ * @brief  Wertebereich der Fläche; bereits gezeichnete Spalten bleiben in der alten Skalierung
+ */
+void ILI9341_Chart_SetRange(ILI9341_Chart *chart, int32_t min, int32_t max) {
+	if (max <= min) max = min + 1;
+	chart->min = min;
+	chart->max = max;
+}
+
+/**
+ * @brief  Werte je Spalte (Minimum und Maximum daraus bilden eine Spalte)
+ */
+void ILI9341_Chart_SetDecimation(ILI9341_Chart *chart, uint16_t samplesPerColumn) {
+	chart->decimation = samplesPerColumn ? samplesPerColumn : 1;
+}
+
+/**
+ * @brief  Poti (0 .. ADC_POTI_COUNT-1), dessen Werte ILI9341_Chart_AdcListener() übernimmt
+ */
+void ILI9341_Chart_SetChannel(ILI9341_Chart *chart, uint8_t channel) {
+	chart->channel = channel;
+}
+
+/**
+ * @brief  Nimmt einen Wert auf, auch aus einem Interrupt
+ */
+RAMFUNC void ILI9341_Chart_AddSample(ILI9341_Chart *chart, int32_t value) {
+	if (chart->accCount == 0) {
+		chart->accMin = value;
+		chart->accMax = value;
+	} else if (value < chart->accMin) {
+		chart->accMin = value;
+	} else if (value > chart->accMax) {
+		chart->accMax = value;
+	}
+
+	if (++chart->accCount >= chart->decimation) {
+		ILI9341_Chart_Push(chart, chart->accMin, chart->accMax);
+		chart->accCount = 0;
+	}
+}
+
+/**
+ * @brief  Nimmt count Werte mit Abstand stride auf (z.B. ein Kanal aus verschränkten DMA-Daten)
+ */
+RAMFUNC void ILI9341_Chart_AddSamples(ILI9341_Chart *chart, const uint16_t *data, uint32_t count, uint8_t stride) {
+	// Local copies: the accumulator stays in registers for the whole block
+	uint16_t acc = chart->accCount;
+	int32_t lo = chart->accMin, hi = chart->accMax;
+
+	for (uint32_t i = 0; i < count; i++, data += stride) {
+		int32_t value = *data;
+		if (acc == 0) {
+			lo = hi = value;
+		} else if (value < lo) {
+			lo = value;
+		} else if (value > hi) {
+			hi = value;
+		}
+		if (++acc >= chart->decimation) {
+			ILI9341_Chart_Push(chart, lo, hi);
+			acc = 0;
+		}
+	}
+
+	chart->accCount = acc;
+	chart->accMin = lo;
+	chart->accMax = hi;
+}
+
+/**
+ * @brief  Empfänger für ADC_AddBlockListener(), context ist der Chart
+ *
+ * Übernimmt alle Slots des eingestellten Potis in zeitlicher Reihenfolge direkt aus dem
+ * DMA-Puffer; der Block wird nicht gehalten.
+ */
+RAMFUNC uint8_t ILI9341_Chart_AdcListener(const ADC_Block *block, void *context) {
+	ILI9341_Chart *chart = (ILI9341_Chart*)context;
+	uint8_t first = 0xFF, matches = 0;
+
+	for (uint8_t k = 0; k < block->slots; k++) {
+		if (block->slotChannel[k] == chart->channel) {
+			if (first == 0xFF) first = k;
+			matches++;
+		}
+	}
+
+	if (matches == 1) {
+		ILI9341_Chart_AddSamples(chart, block->data + first, block->scans, block->slots);
+	} else if (matches > 1) {
+		const uint16_t *scan = block->data;
+		for (uint16_t s = 0; s < block->scans; s++, scan += block->slots) {
+			for (uint8_t k = first; k < block->slots; k++) {
+				if (block->slotChannel[k] == chart->channel) ILI9341_Chart_AddSample(chart, scan[k]);
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief  Verwirft alle Spalten und leert die Fläche beim nächsten Render
+ *
+ * Nicht aufrufen, während ein Interrupt in den Chart einspeist.
+ */
+void ILI9341_Chart_Clear(ILI9341_Chart *chart) {
+	chart->accCount = 0;
+	chart->queueTail = chart->queueHead;
+	chart->cursor = 0;
+	chart->filled = 0;
+	chart->redraw = 1;
+}
+
+/**
+ * @brief  Zeichnet beim nächsten Render die ganze Fläche aus dem Ring neu
+ */
+void ILI9341_Chart_Invalidate(ILI9341_Chart *chart) {
+	chart->redraw = 1;
+}
+
+/**
+ * @brief  Zeichnet die seit dem letzten Aufruf fertigen Spalten
+ * @retval Anzahl neuer Spalten
+ */
+uint16_t ILI9341_Chart_Render(ILI9341_Chart *chart) {
+	uint8_t shift = 0;
+
+	if (chart->mode == ILI9341_CHART_SCROLL) {
+		if (ILI9341_Chart_CanShift(chart)) {
+			shift = 1;
+		} else if (!chart->scrollActive && ILI9341_Chart_SetupScroll(chart)) {
+			chart->redraw = 1;
+		}
+	}
+	// Hardware scrolling keeps the sweep layout in memory, only the FB shift is chronological
+	if (shift != chart->shifted) {
+		chart->shifted = shift;
+		chart->redraw = 1;
+	}
+	uint8_t marker = (chart->mode == ILI9341_CHART_SWEEP || (!shift && !chart->scrollActive));
+
+	if (chart->redraw) {
+		chart->redraw = 0;
+		ILI9341_Chart_DrawAll(chart, shift);
+	}
+
+	uint16_t tail = chart->queueTail;
+	uint16_t count = (uint16_t)(chart->queueHead - tail);
+	if (count == 0) return 0;
+
+	int16_t prevTop = 0, prevBottom = 0;
+	if (chart->filled > 0) {
+		uint16_t prev = chart->cursor ? chart->cursor - 1 : chart->width - 1;
+		prevTop = chart->top[prev];
+		prevBottom = chart->bottom[prev];
+	}
+
+	for (uint16_t i = 0; i < count; i++, tail++) {
+		int16_t top = ILI9341_Chart_ValueToY(chart, chart->queueMax[tail & ILI9341_CHART_MASK]);
+		int16_t bottom = ILI9341_Chart_ValueToY(chart, chart->queueMin[tail & ILI9341_CHART_MASK]);
+
+		// Close the gap to the previous column so the trace stays connected
+		if (chart->filled > 0) {
+			if (top > prevBottom + 1) top = prevBottom + 1;
+			if (bottom < prevTop - 1) bottom = prevTop - 1;
+		}
+
+		uint16_t index = chart->cursor;
+		chart->top[index] = top;
+		chart->bottom[index] = bottom;
+		chart->cursor = (index + 1 < chart->width) ? index + 1 : 0;
+		if (chart->filled < chart->width) chart->filled++;
+		prevTop = top;
+		prevBottom = bottom;
+
+		if (!shift) ILI9341_Chart_DrawColumn(chart, chart->x + index, index, 1);
+	}
+	chart->queueTail = tail;
+
+	if (shift) {
+		ILI9341_Chart_Shift(chart, count);
+	} else if (marker) {
+		ILI9341_Chart_DrawMarker(chart);
+	} else {
+		ILI9341_Chart_UpdateScroll(chart);
+	}
+	return count;
+}
+
+/**
+ * @brief  Spalten, die wegen voller Warteschlange verworfen wurden (Render zu selten)
+ */
+uint32_t ILI9341_Chart_GetDropped(const ILI9341_Chart *chart) {
+	return chart->dropped;
+}
+
+/**
+ * @brief  Hängt eine fertige Spalte an die Warteschlange (ein Erzeuger)
+ */
+static void ILI9341_Chart_Push(ILI9341_Chart *chart, int32_t min, int32_t max) {
+	uint16_t head = chart->queueHead;
+
+	if ((uint16_t)(head - chart->queueTail) >= ILI9341_CHART_QUEUE) {
+		chart->dropped++;
+		return;
+	}
+	chart->queueMin[head & ILI9341_CHART_MASK] = min;
+	chart->queueMax[head & ILI9341_CHART_MASK] = max;
+	__DMB();	// Column data before the index that publishes it
+	chart->queueHead = head + 1;
+}
+
+/**
+ * @brief  Displayzeile eines Wertes, max oben, min unten
+ */
+static int16_t ILI9341_Chart_ValueToY(const ILI9341_Chart *chart, int32_t value) {
+	int32_t span = (int32_t)chart->height - 1;
+
+	if (value <= chart->min) return chart->y + span;
+	if (value >= chart->max) return chart->y;
+	return chart->y + span - (int16_t)(((int64_t)(value - chart->min) * span) / (chart->max - chart->min));
+}
+
+/**
+ * @brief  Zeichnet Spalte index des Rings an Displayspalte x
+ * @param  background: 1 = auch den Hintergrund darüber und darunter (Spalte war schon belegt)
+ */
+static void ILI9341_Chart_DrawColumn(const ILI9341_Chart *chart, int16_t x, uint16_t index, uint8_t background) {
+	int16_t top = chart->top[index];
+	int16_t bottom = chart->bottom[index];
+	int16_t end = chart->y + chart->height;
+
+	if (background && top > chart->y) {
+		ILI9341_fillRect(x, chart->y, 1, top - chart->y, chart->background);
+	}
+	ILI9341_fillRect(x, top, 1, bottom - top + 1, chart->colour);
+	if (background && bottom + 1 < end) {
+		ILI9341_fillRect(x, bottom + 1, 1, end - bottom - 1, chart->background);
+	}
+}
+
+/**
+ * @brief  Schreibmarke des Sweep-Betriebs: löscht die Spalte, die als nächste beschrieben wird
+ */
+static void ILI9341_Chart_DrawMarker(const ILI9341_Chart *chart) {
+	ILI9341_fillRect(chart->x + chart->cursor, chart->y, 1, chart->height, chart->accent);
+}
+
+/**
+ * @brief  Zeichnet Hintergrund und alle Spalten des Rings
+ * @param  chronological: 1 = älteste Spalte links (Verschieben im Framebuffer), 0 = Position im Ring
+ */
+static void ILI9341_Chart_DrawAll(ILI9341_Chart *chart, uint8_t chronological) {
+	ILI9341_fillRect(chart->x, chart->y, chart->width, chart->height, chart->background);
+
+	if (chronological) {
+		uint16_t index = (chart->cursor + chart->width - chart->filled) % chart->width;
+		int16_t x = chart->x + chart->width - chart->filled;
+		for (uint16_t i = 0; i < chart->filled; i++) {
+			ILI9341_Chart_DrawColumn(chart, x + i, index, 0);
+			index = (index + 1 < chart->width) ? index + 1 : 0;
+		}
+		return;
+	}
+
+	// Before the first wrap the ring holds columns 0 .. filled-1, after it all columns
+	for (uint16_t i = 0; i < chart->filled; i++) {
+		ILI9341_Chart_DrawColumn(chart, chart->x + i, i, 0);
+	}
+	if (chart->scrollActive) {
+		ILI9341_Chart_UpdateScroll(chart);
+	} else {
+		ILI9341_Chart_DrawMarker(chart);
+	}
+}
+
+/**
+ * @brief  Prüft, ob SCROLL im Framebuffer verschieben kann (aktiv, Fläche ganz auf dem Display)
+ */
+static uint8_t ILI9341_Chart_CanShift(const ILI9341_Chart *chart) {
+#ifdef ILI9341_USE_FRAMEBUFFER
+	return ILI9341_FB_IsEnabled() && chart->x >= 0 && chart->y >= 0
+			&& chart->x + chart->width <= ILI9341_WIDTH && chart->y + chart->height <= ILI9341_HEIGHT;
+#else
+	(void)chart;
+	return 0;
+#endif
+}
+
+/**
+ * @brief  Verschiebt die Fläche im Framebuffer um columns nach links und zeichnet die neuesten rechts
+ */
+static void ILI9341_Chart_Shift(ILI9341_Chart *chart, uint16_t columns) {
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (columns >= chart->width) {
+		ILI9341_Chart_DrawAll(chart, 1);
+		return;
+	}
+
+	uint16_t keep = chart->width - columns;
+	uint16_t *row = ILI9341_FB_GetBuffer() + (uint32_t)chart->y * ILI9341_WIDTH + chart->x;
+
+	ILI9341_FB_Sync();
+	for (uint16_t r = 0; r < chart->height; r++, row += ILI9341_WIDTH) {
+		memmove(row, row + columns, (uint32_t)keep * 2);
+	}
+	ILI9341_FB_MarkDirty(chart->x, chart->y, keep, chart->height);
+
+	uint16_t index = (chart->cursor + chart->width - columns) % chart->width;
+	for (uint16_t i = 0; i < columns; i++) {
+		ILI9341_Chart_DrawColumn(chart, chart->x + keep + i, index, 1);
+		index = (index + 1 < chart->width) ? index + 1 : 0;
+	}
+#else
+	(void)chart;
+	(void)columns;
+#endif
+}
+
+/**
+ * @brief  Richtet das Hardware-Scrolling ein, wenn die Fläche im Querformat die volle Höhe hat
+ * @retval 1 wenn eingerichtet
+ */
+static uint8_t ILI9341_Chart_SetupScroll(ILI9341_Chart *chart) {
+	uint8_t madctl = ILI9341_GetMemoryAccess();
+
+	if (!(madctl & 0x20) || chart->y != 0 || chart->height != ILI9341_HEIGHT) return 0;
+	if (chart->x < 0 || chart->x + chart->width > ILI9341_WIDTH) return 0;
+
+	// Panel lines run along the screen columns; with MY they count from the right edge
+	uint16_t first = (madctl & 0x80) ? ILI9341_WIDTH - chart->x - chart->width : chart->x;
+	if (ILI9341_ScrollDefine(first, chart->width, 320 - first - chart->width) != HAL_OK) return 0;
+
+	chart->scrollActive = 1;
+	return 1;
+}
+
+/**
+ * @brief  Zeigt die neueste Spalte am rechten Rand: Startzeile des Scrollbereichs setzen
+ */
+static void ILI9341_Chart_UpdateScroll(const ILI9341_Chart *chart) {
+	uint8_t madctl = ILI9341_GetMemoryAccess();
+
+	if (madctl & 0x80) {
+		uint16_t first = ILI9341_WIDTH - chart->x - chart->width;
+		ILI9341_ScrollTo(first + (chart->width - chart->cursor) % chart->width);
+	} else {
+		ILI9341_ScrollTo(chart->x + chart->cursor);
+	}
+}
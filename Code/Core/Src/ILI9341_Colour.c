@@ -0,0 +1,218 @@
+/**
+ * @file    ILI9341_Colour.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Wandlung von RGB888, ARGB8888 und Graustufen nach RGB565, HSV und Farbverläufe
+ *
+ * Die Puffer-Kernel schreiben RGB565 in Display-Byte-Reihenfolge, also direkt sendbar bzw. im
+ * Format des Framebuffers. Je Schleifendurchlauf entstehen zwei Pixel: beide werden mit __PKHBT
+ * in ein Wort gepackt und mit einem __REV16 gleichzeitig getauscht, gespeichert wird ein Wort.
+ * RGB888 liest vier Pixel aus drei Wörtern statt zwölf Einzelbytes, Graustufen vier Pixel aus
+ * einem Wort. Quellen dürfen beliebig ausgerichtet sein (der M7 liest unausgerichtete Wörter),
+ * ein ungerades Ziel bekommt den ersten Pixel einzeln.
+ *
+ * Die Kanäle werden wie bei der Formatwandlung von DMA2D abgeschnitten, nicht gerundet; CPU-
+ * und DMA2D-Pfad des Framebuffers liefern damit dieselben Pixel.
+ *
+ * Für Skalen und Anzeigen erzeugen ILI9341_Colour_Gradient() (linear in RGB565) und
+ * ILI9341_Colour_HueGradient() (über den Farbton, z.B. grün nach rot) eine Zeile Farben, die
+ * als Bild gezeichnet oder als Tabelle für Werte genutzt werden kann.
+ */
+
+#include "ILI9341_Colour.h"
+#include <string.h>
+
+static inline uint32_t ILI9341_Colour_Load32(const void *p);
+static inline void ILI9341_Colour_Store32(void *p, uint32_t value);
+static inline uint16_t ILI9341_Colour_Pixel(uint32_t rgb);
+static inline uint32_t ILI9341_Colour_Pair(uint32_t first, uint32_t second);
+static inline uint16_t ILI9341_Colour_Swap16(uint16_t colour);
+
+/**
+ * @brief  Wandelt RGB888 (Bytes B, G, R wie ILI9341_FB_RGB888)
+ */
+RAMFUNC void ILI9341_Colour_FromRGB888(uint16_t *dst, const uint8_t *src, uint32_t count) {
+	if (count > 0 && ((uintptr_t)dst & 2)) {
+		*dst++ = ILI9341_Colour_Swap16(ILI9341_Colour_Pixel(src[0] | (src[1] << 8) | ((uint32_t)src[2] << 16)));
+		src += 3;
+		count--;
+	}
+
+	// Four pixels are exactly three words: BGRB GRBG RBGR
+	for (; count >= 4; count -= 4, src += 12, dst += 4) {
+		uint32_t w0 = ILI9341_Colour_Load32(src);
+		uint32_t w1 = ILI9341_Colour_Load32(src + 4);
+		uint32_t w2 = ILI9341_Colour_Load32(src + 8);
+
+		ILI9341_Colour_Store32(dst, ILI9341_Colour_Pair(ILI9341_Colour_Pixel(w0),
+				ILI9341_Colour_Pixel((w0 >> 24) | (w1 << 8))));
+		ILI9341_Colour_Store32(dst + 2, ILI9341_Colour_Pair(ILI9341_Colour_Pixel((w1 >> 16) | (w2 << 16)),
+				ILI9341_Colour_Pixel(w2 >> 8)));
+	}
+
+	for (; count > 0; count--, src += 3) {
+		*dst++ = ILI9341_Colour_Swap16(ILI9341_Colour_Pixel(src[0] | (src[1] << 8) | ((uint32_t)src[2] << 16)));
+	}
+}
+
+/**
+ * @brief  Wandelt ARGB8888 (uint32_t 0xAARRGGBB), der Alphakanal wird ignoriert
+ */
+RAMFUNC void ILI9341_Colour_FromARGB8888(uint16_t *dst, const uint32_t *src, uint32_t count) {
+	if (count > 0 && ((uintptr_t)dst & 2)) {
+		*dst++ = ILI9341_Colour_Swap16(ILI9341_Colour_Pixel(*src++));
+		count--;
+	}
+
+	for (; count >= 2; count -= 2, src += 2, dst += 2) {
+		ILI9341_Colour_Store32(dst, ILI9341_Colour_Pair(ILI9341_Colour_Pixel(src[0]), ILI9341_Colour_Pixel(src[1])));
+	}
+
+	if (count > 0) {
+		*dst = ILI9341_Colour_Swap16(ILI9341_Colour_Pixel(*src));
+	}
+}
+
+/**
+ * @brief  Wandelt 8-Bit-Graustufen
+ */
+RAMFUNC void ILI9341_Colour_FromGray8(uint16_t *dst, const uint8_t *src, uint32_t count) {
+	if (count > 0 && ((uintptr_t)dst & 2)) {
+		*dst++ = ILI9341_Colour_Swap16(ILI9341_Colour_Pixel(*src++ * 0x010101UL));
+		count--;
+	}
+
+	for (; count >= 4; count -= 4, src += 4, dst += 4) {
+		uint32_t w = ILI9341_Colour_Load32(src);
+
+		ILI9341_Colour_Store32(dst, ILI9341_Colour_Pair(ILI9341_Colour_Pixel((w & 0xFF) * 0x010101UL),
+				ILI9341_Colour_Pixel(((w >> 8) & 0xFF) * 0x010101UL)));
+		ILI9341_Colour_Store32(dst + 2, ILI9341_Colour_Pair(ILI9341_Colour_Pixel(((w >> 16) & 0xFF) * 0x010101UL),
+				ILI9341_Colour_Pixel((w >> 24) * 0x010101UL)));
+	}
+
+	for (; count > 0; count--) {
+		*dst++ = ILI9341_Colour_Swap16(ILI9341_Colour_Pixel(*src++ * 0x010101UL));
+	}
+}
+
+/**
+ * @brief  Tauscht die Bytes von RGB565-Pixeln (CPU- <-> Display-Reihenfolge), dst == src ist erlaubt
+ */
+RAMFUNC void ILI9341_Colour_Swap(uint16_t *dst, const uint16_t *src, uint32_t count) {
+	if (count > 0 && ((uintptr_t)dst & 2)) {
+		*dst++ = ILI9341_Colour_Swap16(*src++);
+		count--;
+	}
+
+	for (; count >= 2; count -= 2, src += 2, dst += 2) {
+		ILI9341_Colour_Store32(dst, __REV16(ILI9341_Colour_Load32(src)));
+	}
+
+	if (count > 0) {
+		*dst = ILI9341_Colour_Swap16(*src);
+	}
+}
+
+/**
+ * @brief  HSV nach RGB565 (CPU-Byte-Reihenfolge)
+ * @param  hue: Farbton, 0-65535 entspricht 0-360° (wie Effects_HsvToRgb)
+ * @param  sat: Sättigung 0-255
+ * @param  val: Helligkeit 0-255
+ */
+uint16_t ILI9341_Colour_FromHSV(uint16_t hue, uint8_t sat, uint8_t val) {
+	uint32_t sector = ((uint32_t)hue * 6) >> 16;              // 0-5
+	uint32_t frac = (((uint32_t)hue * 6) >> 8) & 0xFF;        // position within the sector
+
+	uint32_t p = (uint32_t)val * (255 - sat) / 255;
+	uint32_t q = (uint32_t)val * (65025 - sat * frac) / 65025;
+	uint32_t t = (uint32_t)val * (65025 - sat * (255 - frac)) / 65025;
+	uint32_t r, g, b;
+
+	switch (sector) {
+		case 0:  r = val; g = t; b = p; break;
+		case 1:  r = q; g = val; b = p; break;
+		case 2:  r = p; g = val; b = t; break;
+		case 3:  r = p; g = q; b = val; break;
+		case 4:  r = t; g = p; b = val; break;
+		default: r = val; g = p; b = q; break;
+	}
+
+	return ILI9341_Colour_RGB(r, g, b);
+}
+
+/**
+ * @brief  Linearer Verlauf zwischen zwei RGB565-Farben, erster und letzter Eintrag sind from und to
+ * @param  dst: count Farben in Display-Byte-Reihenfolge
+ */
+void ILI9341_Colour_Gradient(uint16_t *dst, uint32_t count, uint16_t from, uint16_t to) {
+	if (count == 0) return;
+
+	int32_t steps = count > 1 ? (int32_t)count - 1 : 1;
+	// 16.16 fixed point per channel, starting at half a step for rounding
+	int32_t r = (((from >> 11) & 0x1F) << 16) + 0x8000;
+	int32_t g = (((from >> 5) & 0x3F) << 16) + 0x8000;
+	int32_t b = ((from & 0x1F) << 16) + 0x8000;
+	int32_t dr = ((int32_t)((to >> 11) & 0x1F) - ((from >> 11) & 0x1F)) * 65536 / steps;
+	int32_t dg = ((int32_t)((to >> 5) & 0x3F) - ((from >> 5) & 0x3F)) * 65536 / steps;
+	int32_t db = ((int32_t)(to & 0x1F) - (from & 0x1F)) * 65536 / steps;
+
+	for (uint32_t i = 0; i < count; i++) {
+		dst[i] = ILI9341_Colour_Swap16((uint16_t)(((r >> 16) << 11) | ((g >> 16) << 5) | (b >> 16)));
+		r += dr;
+		g += dg;
+		b += db;
+	}
+}
+
+/**
+ * @brief  Verlauf über den Farbton bei fester Sättigung und Helligkeit
+ *
+ * hueTo kleiner als hueFrom läuft rückwärts, z.B. 21845 (grün) bis 0 (rot) für eine Warnskala.
+ *
+ * @param  dst: count Farben in Display-Byte-Reihenfolge
+ */
+void ILI9341_Colour_HueGradient(uint16_t *dst, uint32_t count, uint16_t hueFrom, uint16_t hueTo, uint8_t sat,
+		uint8_t val) {
+	if (count == 0) return;
+
+	int32_t steps = count > 1 ? (int32_t)count - 1 : 1;
+	int32_t hue = ((int32_t)hueFrom << 8) + 0x80;                 // 16.8 fixed point
+	int32_t step = (((int32_t)hueTo - hueFrom) << 8) / steps;
+
+	for (uint32_t i = 0; i < count; i++) {
+		dst[i] = ILI9341_Colour_Swap16(ILI9341_Colour_FromHSV((uint16_t)(hue >> 8), sat, val));
+		hue += step;
+	}
+}
+
+/**
+ * @brief  Liest ein Wort von beliebiger Adresse (eine LDR-Anweisung auf dem M7)
+ */
+static inline uint32_t ILI9341_Colour_Load32(const void *p) {
+	uint32_t value;
+	memcpy(&value, p, 4);
+	return value;
+}
+
+static inline void ILI9341_Colour_Store32(void *p, uint32_t value) {
+	memcpy(p, &value, 4);
+}
+
+/**
+ * @brief  0x..RRGGBB nach RGB565, die oberen Bits der Kanäle
+ */
+static inline uint16_t ILI9341_Colour_Pixel(uint32_t rgb) {
+	return (uint16_t)(((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x001F));
+}
+
+/**
+ * @brief  Packt zwei RGB565-Pixel in ein Wort (erster unten) und tauscht beide in Display-Reihenfolge
+ */
+static inline uint32_t ILI9341_Colour_Pair(uint32_t first, uint32_t second) {
+	return __REV16(__PKHBT(first, second, 16));
+}
+
+static inline uint16_t ILI9341_Colour_Swap16(uint16_t colour) {
+	return (uint16_t)((colour >> 8) | (colour << 8));
+}
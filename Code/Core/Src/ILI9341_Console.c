@@ -0,0 +1,146 @@
+/**
+ * @file    ILI9341_Console.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Textkonsole mit Hardware-Scrolling für das ILI9341-Display
+ *
+ * Die Konsole belegt einen Scrollbereich über die volle Displaybreite. Ist er voll,
+ * wird für jede neue Zeile nur die älteste Textzeile im Displayspeicher überschrieben
+ * und der Scroll-Startpunkt (0x37) um eine Zeilenhöhe weitergesetzt. Statt den ganzen
+ * Bereich neu zu zeichnen, wird also pro Zeile genau eine Textzeile übertragen.
+ *
+ * Da das Hardware-Scrolling entlang der 320 Panelzeilen arbeitet, wird nur das
+ * Hochformat unterstützt.
+ */
+
+#include "ILI9341_Console.h"
+#include "ILI9341.h"
+#include <string.h>
+
+/**
+ * @brief  Zeichnet eine Textzeile in die Speicherzeile y und füllt den Rest der Zeile mit dem Hintergrund.
+ */
+static void ILI9341_Console_DrawRow(ILI9341_Console *console, uint16_t y, const char *text, uint16_t length)
+{
+	char row[ILI9341_CONSOLE_MAX_COLUMNS + 1];
+	if (length > console->columns) length = console->columns;
+	memcpy(row, text, length);
+	row[length] = '\0';
+
+	uint16_t textWidth = length * ILI9341_CONSOLE_CHAR_WIDTH * console->size;
+	if (length > 0) {
+		ILI9341_DrawText(row, 0, y, console->colour, console->size, console->background);
+	}
+	if (textWidth < ILI9341_WIDTH) {
+		ILI9341_fillRect(textWidth, y, ILI9341_WIDTH - textWidth, console->lineHeight, console->background);
+	}
+}
+
+/**
+ * @brief  Richtet eine Konsole im Bereich der Speicherzeilen top .. top+height-1 ein.
+ *
+ * Der Bereich wird als Scrollbereich definiert (der Rest bleibt fest) und gelöscht.
+ * Die Höhe wird auf ein Vielfaches der Zeilenhöhe abgerundet.
+ *
+ * @param  console    Zu initialisierende Konsole.
+ * @param  top        Erste Zeile des Scrollbereichs.
+ * @param  height     Höhe des Scrollbereichs in Pixeln.
+ * @param  size       Skalierung der Grundschrift (1 = 6x8 Pixel).
+ * @param  colour     Textfarbe (RGB565).
+ * @param  background Hintergrundfarbe (RGB565).
+ * @retval HAL_ERROR bei Querformat oder ungültiger Geometrie, sonst HAL_OK.
+ */
+HAL_StatusTypeDef ILI9341_Console_Init(ILI9341_Console *console, uint16_t top, uint16_t height, uint8_t size,
+		uint16_t colour, uint16_t background)
+{
+	if (size == 0 || ILI9341_WIDTH > ILI9341_HEIGHT) return HAL_ERROR;
+
+	console->lineHeight = ILI9341_CONSOLE_CHAR_HEIGHT * size;
+	console->rows = height / console->lineHeight;
+	if (console->rows == 0 || (uint32_t)top + height > 320) return HAL_ERROR;
+
+	console->top = top;
+	console->height = console->rows * console->lineHeight;
+	console->columns = ILI9341_WIDTH / (ILI9341_CONSOLE_CHAR_WIDTH * size);
+	if (console->columns > ILI9341_CONSOLE_MAX_COLUMNS) console->columns = ILI9341_CONSOLE_MAX_COLUMNS;
+	console->colour = colour;
+	console->background = background;
+	console->size = size;
+
+	if (ILI9341_ScrollDefine(top, console->height, 320 - top - console->height) != HAL_OK) {
+		return HAL_ERROR;
+	}
+
+	ILI9341_Console_Clear(console);
+	return HAL_OK;
+}
+
+/**
+ * @brief  Löscht den Konsolenbereich und setzt das Scrolling zurück.
+ */
+void ILI9341_Console_Clear(ILI9341_Console *console)
+{
+	console->used = 0;
+	console->scroll = 0;
+	console->lineLength = 0;
+
+	ILI9341_ScrollTo(console->top);
+	ILI9341_fillRect(0, console->top, ILI9341_WIDTH, console->height, console->background);
+}
+
+/**
+ * @brief  Hängt eine Zeile unten an die Konsole an.
+ *
+ * Solange der Bereich nicht voll ist, wird die Zeile einfach unter die letzte gezeichnet.
+ * Danach überschreibt sie die älteste Zeile, die anschließend per Hardware-Scrolling
+ * nach unten wandert. Zu lange Zeilen werden abgeschnitten.
+ *
+ * @param  console Ziel-Konsole.
+ * @param  text    Nullterminierter Text ohne Zeilenumbruch.
+ */
+void ILI9341_Console_WriteLine(ILI9341_Console *console, const char *text)
+{
+	uint16_t length = strlen(text);
+
+	if (console->used < console->rows) {
+		ILI9341_Console_DrawRow(console, console->top + console->used * console->lineHeight, text, length);
+		console->used++;
+		return;
+	}
+
+	// Älteste Zeile liegt am aktuellen Scroll-Startpunkt
+	ILI9341_Console_DrawRow(console, console->top + console->scroll, text, length);
+
+	console->scroll += console->lineHeight;
+	if (console->scroll >= console->height) {
+		console->scroll = 0;
+	}
+	ILI9341_ScrollTo(console->top + console->scroll);
+}
+
+/**
+ * @brief  Gibt Text mit Zeilenumbrüchen aus.
+ *
+ * '\n' schließt die aktuelle Zeile ab, '\r' wird ignoriert. Erreicht eine Zeile die
+ * Konsolenbreite, wird automatisch umgebrochen. Eine angefangene Zeile wird erst bei
+ * ihrem Abschluss gezeichnet.
+ *
+ * @param  console Ziel-Konsole.
+ * @param  text    Nullterminierter Text.
+ */
+void ILI9341_Console_Print(ILI9341_Console *console, const char *text)
+{
+	while (*text) {
+		char c = *text++;
+
+		if (c == '\r') continue;
+		if (c != '\n') {
+			console->line[console->lineLength++] = c;
+			if (console->lineLength < console->columns) continue;
+		}
+
+		console->line[console->lineLength] = '\0';
+		ILI9341_Console_WriteLine(console, console->line);
+		console->lineLength = 0;
+	}
+}
@@ -0,0 +1,818 @@
+/**
+ * @file    ILI9341_FB.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Framebuffer-Modus für den ILI9341-Treiber
+ *
+ * Im Framebuffer-Modus zeichnen alle Primitive (Pixel, Linien, Rechtecke, Kreise,
+ * Text, Bilder) nur in einen Puffer im AXI-SRAM. Die veränderten Bereiche werden
+ * als Dirty-Rectangles gesammelt und erst mit ILI9341_FB_Flush() per DMA zum
+ * Display übertragen. Dadurch kostet ein einzelner Pixel nur noch einen
+ * Speicherzugriff statt drei SPI-Befehlen.
+ *
+ * Die Pixel werden bereits in der Byte-Reihenfolge des Displays (High-Byte zuerst)
+ * abgelegt, damit beim Flush keine Umwandlung mehr nötig ist.
+ *
+ * Mit ILI9341_FB_USE_DMA2D übernimmt die DMA2D-Einheit Füllungen, Bildkopien,
+ * Alpha-Blending und die Wandlung von RGB888/ARGB8888 nach RGB565. Die Byte-Reihenfolge
+ * des Displays erzeugt dabei das Swap-Bytes-Bit der Ausgabe (OPFCCR.SB). Kleine Bereiche,
+ * falsch ausgerichtete Quelldaten und Transferfehler laufen über die CPU-Pfade.
+ *
+ * Mit ILI9341_FB_SetDoubleBuffer() (ILI9341_FB_USE_DOUBLE_BUFFER) gibt es zwei Puffer. Gezeichnet
+ * wird immer in den hinteren (ILI9341_FB_Back). ILI9341_FB_Flush() tauscht die Puffer und gibt
+ * die Dirty-Rectangles des fertigen Bildes als Befehlsliste mit Verweisen in den vorderen
+ * Puffer an die SPI-DMA (ILI9341_SendRowsAsync()), ohne zu kopieren und ohne zu warten. Das
+ * nächste Bild entsteht also, während das vorige übertragen wird; erst der nächste Flush wartet
+ * auf dessen Ende. Damit der neue hintere Puffer wieder das ganze Bild enthält, kopiert der Flush
+ * dieselben Rechtecke vom vorderen in den hinteren Puffer (DMA2D, parallel zur SPI). Jeder Bereich
+ * ist so in beiden Puffern aktuell, und das nächste Bild braucht nur seine eigenen Änderungen.
+ */
+
+#include "ILI9341_FB.h"
+#include "ILI9341.h"
+#include "ILI9341_TE.h"
+#include "ILI9341_Colour.h"
+#include "Cache.h"
+#include "Prof.h"
+#include <string.h>
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+
+// Framebuffer im AXI-SRAM, Zeilenlänge entspricht immer der aktuellen ILI9341_WIDTH.
+// Nicht vom Startup-Code genullt, das erste ILI9341_FB_Enable() löscht ihn.
+uint16_t ILI9341_FrameBuffer[ILI9341_FB_PIXELS] AXI_BUFFER;
+
+// Puffer, in den gezeichnet wird; im Doppelpuffer-Modus wechselt er bei jedem Flush
+uint16_t *ILI9341_FB_Back = ILI9341_FrameBuffer;
+
+#ifdef ILI9341_FB_USE_DOUBLE_BUFFER
+uint16_t ILI9341_FrameBuffer2[ILI9341_FB_PIXELS] AXI_BUFFER;
+uint8_t ILI9341_FB_Double = 0;
+#endif
+
+uint8_t ILI9341_FB_Enabled = 0;
+uint8_t ILI9341_FB_Cleared = 0;
+
+ILI9341_FB_Rect ILI9341_FB_Dirty[ILI9341_FB_MAX_DIRTY];
+uint8_t ILI9341_FB_DirtyCount = 0;
+
+ILI9341_FB_FlushListener ILI9341_FB_Listener = NULL;
+
+#ifdef ILI9341_FB_USE_DMA2D
+// Zwischenpuffer für den Hintergrund beim Blending (DMA2D kann RGB565 nur ohne Byte-Tausch lesen)
+uint16_t ILI9341_FB_BlendBuffer[320 * ILI9341_FB_BLEND_LINES] AXI_BUFFER;
+
+volatile uint8_t ILI9341_FB_DMA2DBusy = 0;
+
+// Ziel des laufenden Transfers, dessen Cache-Zeilen nach dem Ende verworfen werden
+uint16_t *ILI9341_FB_DMA2DTarget;
+uint32_t ILI9341_FB_DMA2DTargetBytes;
+
+#define ILI9341_FB_DMA2D_TIMEOUT  100	// ms
+
+// DMA2D-Betriebsarten (CR.MODE)
+#define ILI9341_FB_DMA2D_M2M        (0UL << DMA2D_CR_MODE_Pos)
+#define ILI9341_FB_DMA2D_M2M_PFC    (1UL << DMA2D_CR_MODE_Pos)
+#define ILI9341_FB_DMA2D_M2M_BLEND  (2UL << DMA2D_CR_MODE_Pos)
+#define ILI9341_FB_DMA2D_R2M        (3UL << DMA2D_CR_MODE_Pos)
+#endif
+
+// Hilfsfunktionen
+static inline uint16_t ILI9341_FB_Swap(uint16_t color)
+{
+	return (uint16_t)((color >> 8) | (color << 8));
+}
+
+static inline uint32_t ILI9341_FB_Area(const ILI9341_FB_Rect *r)
+{
+	return (uint32_t)(r->x2 - r->x1 + 1) * (uint32_t)(r->y2 - r->y1 + 1);
+}
+
+static inline void ILI9341_FB_Union(ILI9341_FB_Rect *dst, const ILI9341_FB_Rect *src)
+{
+	if (src->x1 < dst->x1) dst->x1 = src->x1;
+	if (src->y1 < dst->y1) dst->y1 = src->y1;
+	if (src->x2 > dst->x2) dst->x2 = src->x2;
+	if (src->y2 > dst->y2) dst->y2 = src->y2;
+}
+
+/**
+ * Prüft, ob sich zwei Rechtecke überlappen oder direkt berühren.
+ */
+static inline uint8_t ILI9341_FB_Touches(const ILI9341_FB_Rect *a, const ILI9341_FB_Rect *b)
+{
+	return !(a->x2 + 1 < b->x1 || b->x2 + 1 < a->x1 ||
+			 a->y2 + 1 < b->y1 || b->y2 + 1 < a->y1);
+}
+
+/**
+ * @brief  Beschneidet ein Rechteck auf die aktuelle Displaygröße (Dirty-Rechtecke, ohne Clip-Rechteck).
+ * @retval 1 wenn nach dem Beschneiden noch ein sichtbarer Bereich übrig ist, sonst 0.
+ */
+static uint8_t ILI9341_FB_Clip(int16_t *x, int16_t *y, int16_t *w, int16_t *h)
+{
+	if (*x < 0) { *w += *x; *x = 0; }
+	if (*y < 0) { *h += *y; *y = 0; }
+	if (*x + *w > (int16_t)ILI9341_WIDTH)  *w = ILI9341_WIDTH - *x;
+	if (*y + *h > (int16_t)ILI9341_HEIGHT) *h = ILI9341_HEIGHT - *y;
+
+	return (*w > 0 && *h > 0);
+}
+
+#ifdef ILI9341_FB_USE_DMA2D
+/* --------------------------------- DMA2D --------------------------------- */
+
+/**
+ * @brief  Wartet auf das Ende des laufenden DMA2D-Transfers.
+ * @retval HAL_OK bei Erfolg, HAL_ERROR bei Transfer-/Konfigurationsfehler oder Timeout.
+ */
+static HAL_StatusTypeDef ILI9341_FB_DMA2D_Wait()
+{
+	if (!ILI9341_FB_DMA2DBusy) return HAL_OK;
+
+	HAL_StatusTypeDef status = HAL_OK;
+	uint32_t start = HAL_GetTick();
+
+	while (!(DMA2D->ISR & DMA2D_ISR_TCIF)) {
+		if (DMA2D->ISR & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) {
+			status = HAL_ERROR;
+			break;
+		}
+		if (HAL_GetTick() - start > ILI9341_FB_DMA2D_TIMEOUT) {
+			DMA2D->CR |= DMA2D_CR_ABORT;
+			while (DMA2D->CR & DMA2D_CR_START);
+			status = HAL_ERROR;
+			break;
+		}
+	}
+
+	DMA2D->IFCR = DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF | DMA2D_IFCR_CCEIF;
+	ILI9341_FB_DMA2DBusy = 0;
+
+	// Drop lines the core may have fetched speculatively while DMA2D was writing
+	Cache_InvalidateDMA(ILI9341_FB_DMA2DTarget, ILI9341_FB_DMA2DTargetBytes);
+	return status;
+}
+
+/**
+ * @brief  Bytes von der ersten bis zur letzten Zeile eines Rechtecks mit Zeilenabstand.
+ */
+static inline uint32_t ILI9341_FB_DMA2D_Span(uint32_t offset, uint16_t w, uint16_t h, uint32_t bytesPerPixel)
+{
+	return ((uint32_t)(h - 1) * (w + offset) + w) * bytesPerPixel;
+}
+
+/**
+ * @brief  Startet einen DMA2D-Transfer mit Ausgabe RGB565 (Display-Byte-Reihenfolge) in den Framebuffer.
+ *
+ * Die Register für Vorder- und Hintergrund müssen vorher gesetzt sein.
+ *
+ * @param  mode Betriebsart (ILI9341_FB_DMA2D_*).
+ * @param  dst  Zieladresse.
+ * @param  dstOffset Zeilenabstand des Ziels in Pixeln (Zeilenlänge minus Breite).
+ * @param  w, h Breite und Höhe des Bereichs in Pixeln.
+ * @param  swap 1 = Ausgabebytes tauschen.
+ */
+static void ILI9341_FB_DMA2D_Start(uint32_t mode, uint16_t *dst, uint32_t dstOffset, uint16_t w, uint16_t h, uint8_t swap)
+{
+	// Pixels the CPU wrote must reach SRAM before DMA2D reads or overwrites them
+	if (mode != ILI9341_FB_DMA2D_R2M) {
+		uint32_t cm = DMA2D->FGPFCCR & DMA2D_FGPFCCR_CM;
+		uint32_t bytesPerPixel = (cm == ILI9341_FB_ARGB8888) ? 4 : (cm == ILI9341_FB_RGB888) ? 3 : 2;
+		Cache_CleanDMA((const void*)DMA2D->FGMAR, ILI9341_FB_DMA2D_Span(DMA2D->FGOR, w, h, bytesPerPixel));
+	}
+	if (mode == ILI9341_FB_DMA2D_M2M_BLEND) {
+		Cache_CleanDMA((const void*)DMA2D->BGMAR, ILI9341_FB_DMA2D_Span(DMA2D->BGOR, w, h, 2));
+	}
+	ILI9341_FB_DMA2DTarget = dst;
+	ILI9341_FB_DMA2DTargetBytes = ILI9341_FB_DMA2D_Span(dstOffset, w, h, 2);
+	Cache_CleanInvalidateDMA(dst, ILI9341_FB_DMA2DTargetBytes);
+
+	DMA2D->OPFCCR = 2 | (swap ? DMA2D_OPFCCR_SB : 0);	// RGB565
+	DMA2D->OMAR = (uint32_t)dst;
+	DMA2D->OOR = dstOffset;
+	DMA2D->NLR = ((uint32_t)w << DMA2D_NLR_PL_Pos) | h;
+	DMA2D->CR = mode | DMA2D_CR_START;
+	ILI9341_FB_DMA2DBusy = 1;
+}
+
+/**
+ * @brief  Prüft, ob sich ein Bereich mit DMA2D lohnt und die Quelle passend ausgerichtet ist.
+ */
+static inline uint8_t ILI9341_FB_DMA2D_Usable(uint32_t pixels, const void *src, uint32_t alignment)
+{
+	return pixels >= ILI9341_FB_DMA2D_MIN_PIXELS && ((uint32_t)src % alignment) == 0;
+}
+#endif /* ILI9341_FB_USE_DMA2D */
+
+#ifdef ILI9341_FB_USE_DOUBLE_BUFFER
+static void ILI9341_FB_FlushDouble();
+#endif
+
+/**
+ * @brief  Wartet, bis ein laufender DMA2D-Transfer den Framebuffer nicht mehr verändert.
+ *
+ * Muss vor jedem direkten Zugriff auf ILI9341_FB_GetBuffer() aufgerufen werden; die
+ * Funktionen dieses Moduls erledigen das selbst.
+ */
+void ILI9341_FB_Sync()
+{
+#ifdef ILI9341_FB_USE_DMA2D
+	ILI9341_FB_DMA2D_Wait();
+#endif
+}
+
+/* --------------------------------- Steuerung --------------------------------- */
+
+/**
+ * @brief  Schaltet den Framebuffer-Modus ein oder aus.
+ *
+ * Beim Einschalten wird der gesamte Puffer als "dirty" markiert, damit der erste
+ * Flush den Displayinhalt vollständig mit dem Puffer synchronisiert.
+ *
+ * @param  enable 1 = alle Zeichenfunktionen schreiben in den RAM, 0 = direkt zum Display.
+ */
+void ILI9341_FB_Enable(uint8_t enable)
+{
+	ILI9341_FB_Enabled = enable;
+	if (enable) {
+		if (!ILI9341_FB_Cleared) {
+			memset(ILI9341_FrameBuffer, 0, sizeof(ILI9341_FrameBuffer));
+			ILI9341_FB_Cleared = 1;
+		}
+#ifdef ILI9341_FB_USE_DMA2D
+		__HAL_RCC_DMA2D_CLK_ENABLE();
+#endif
+		ILI9341_FB_InvalidateAll();
+	}
+}
+
+#ifdef ILI9341_FB_USE_DOUBLE_BUFFER
+/**
+ * @brief  Schaltet zwischen einem und zwei Framebuffern um.
+ *
+ * Beim Einschalten übernimmt der zweite Puffer den Inhalt des ersten, beide zeigen danach
+ * dasselbe Bild. Beim Ausschalten wartet die Funktion auf eine laufende Übertragung und
+ * zeichnet im bisherigen hinteren Puffer weiter.
+ *
+ * @param  enable 1 = ILI9341_FB_Flush() überträgt im Hintergrund, 0 = Flush kopiert und kehrt erst danach zurück.
+ */
+void ILI9341_FB_SetDoubleBuffer(uint8_t enable)
+{
+	if (enable == ILI9341_FB_Double) return;
+
+	ILI9341_FB_Sync();
+	ILI9341_WaitWhileBusy();
+	if (enable) {
+		uint16_t *other = (ILI9341_FB_Back == ILI9341_FrameBuffer) ? ILI9341_FrameBuffer2 : ILI9341_FrameBuffer;
+		memcpy(other, ILI9341_FB_Back, sizeof(ILI9341_FrameBuffer));
+	}
+	ILI9341_FB_Double = enable;
+}
+
+/**
+ * @brief  Gibt zurück, ob der Doppelpuffer-Modus aktiv ist.
+ */
+uint8_t ILI9341_FB_IsDoubleBuffered()
+{
+	return ILI9341_FB_Double;
+}
+#endif /* ILI9341_FB_USE_DOUBLE_BUFFER */
+
+/**
+ * @brief  Gibt zurück, ob der Framebuffer-Modus aktiv ist.
+ */
+uint8_t ILI9341_FB_IsEnabled()
+{
+	return ILI9341_FB_Enabled;
+}
+
+/**
+ * @brief  Liefert einen Zeiger auf den Framebuffer (Pixel in Display-Byte-Reihenfolge).
+ *
+ * Im Doppelpuffer-Modus ist das der hintere Puffer; der Zeiger wechselt mit jedem ILI9341_FB_Flush().
+ */
+uint16_t* ILI9341_FB_GetBuffer()
+{
+	ILI9341_FB_Sync();
+	return ILI9341_FB_Back;
+}
+
+/* --------------------------------- Zeichnen in den RAM --------------------------------- */
+
+/**
+ * @brief  Setzt einen einzelnen Pixel im Framebuffer.
+ * @param  x     Die x-Koordinate des Pixels.
+ * @param  y     Die y-Koordinate des Pixels.
+ * @param  color Die Farbe im 16-Bit RGB565-Format.
+ */
+void ILI9341_FB_DrawPixel(uint16_t x, uint16_t y, uint16_t color)
+{
+	int16_t cx = x, cy = y, cw = 1, ch = 1;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+
+	ILI9341_FB_Sync();
+	ILI9341_FB_Back[(uint32_t)y * ILI9341_WIDTH + x] = ILI9341_FB_Swap(color);
+	ILI9341_FB_MarkDirty(x, y, 1, 1);
+}
+
+/**
+ * @brief  Liest einen Pixel aus dem Framebuffer.
+ * @retval Die Farbe im 16-Bit RGB565-Format (0 außerhalb des Displays).
+ */
+uint16_t ILI9341_FB_GetPixel(uint16_t x, uint16_t y)
+{
+	if (x >= ILI9341_WIDTH || y >= ILI9341_HEIGHT) return 0;
+
+	ILI9341_FB_Sync();
+	return ILI9341_FB_Swap(ILI9341_FB_Back[(uint32_t)y * ILI9341_WIDTH + x]);
+}
+
+/**
+ * @brief  Füllt ein Rechteck im Framebuffer mit einer Farbe.
+ *
+ * Der Bereich wird auf die Displaygröße beschnitten und als "dirty" markiert.
+ *
+ * @param  x, y  Obere linke Ecke.
+ * @param  w, h  Breite und Höhe in Pixeln.
+ * @param  color Die Farbe im 16-Bit RGB565-Format.
+ */
+void ILI9341_FB_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	if (!ILI9341_ClipRect(&x, &y, &w, &h)) return;
+
+	uint16_t *start = &ILI9341_FB_Back[(uint32_t)y * ILI9341_WIDTH + x];
+	ILI9341_FB_Sync();
+
+#ifdef ILI9341_FB_USE_DMA2D
+	// Register-zu-Speicher: läuft im Hintergrund weiter, bis der nächste Zugriff wartet
+	if ((uint32_t)w * h >= ILI9341_FB_DMA2D_MIN_PIXELS) {
+		DMA2D->OCOLR = ILI9341_FB_Swap(color);
+		ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_R2M, start, ILI9341_WIDTH - w, w, h, 0);
+		ILI9341_FB_MarkDirty(x, y, w, h);
+		return;
+	}
+#endif
+
+	uint16_t swapped = ILI9341_FB_Swap(color);
+	for (int16_t row = 0; row < h; row++) {
+		uint16_t *dst = start + (uint32_t)row * ILI9341_WIDTH;
+		for (int16_t col = 0; col < w; col++) {
+			dst[col] = swapped;
+		}
+	}
+
+	ILI9341_FB_MarkDirty(x, y, w, h);
+}
+
+/**
+ * @brief  Kopiert ein RGB565-Bild (High-Byte zuerst) in den Framebuffer.
+ *
+ * @param  x, y   Obere linke Ecke des Bildes.
+ * @param  width  Breite des Bildes in Pixeln.
+ * @param  height Höhe des Bildes in Pixeln.
+ * @param  image  Bilddaten, width*height*2 Bytes.
+ */
+void ILI9341_FB_DrawImage(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image)
+{
+	ILI9341_FB_DrawImageFormat(x, y, width, height, image, ILI9341_FB_RGB565);
+}
+
+/**
+ * @brief  Kopiert einen Ausschnitt eines größeren RGB565-Bildes (High-Byte zuerst) in den Framebuffer.
+ *
+ * @param  x, y   Obere linke Ecke auf dem Display.
+ * @param  width  Breite des Ausschnitts in Pixeln.
+ * @param  height Höhe des Ausschnitts in Pixeln.
+ * @param  image  Erstes Pixel des Ausschnitts.
+ * @param  stride Zeilenlänge des ganzen Bildes in Pixeln.
+ */
+void ILI9341_FB_DrawImageRegion(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image, uint16_t stride)
+{
+	int16_t cx = x, cy = y, cw = width, ch = height;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+
+	const uint8_t *src = image + ((uint32_t)(cy - y) * stride + (cx - x)) * 2;
+	uint16_t *dst = &ILI9341_FB_Back[(uint32_t)cy * ILI9341_WIDTH + cx];
+
+	ILI9341_FB_Sync();
+	ILI9341_FB_MarkDirty(cx, cy, cw, ch);
+
+#ifdef ILI9341_FB_USE_DMA2D
+	if (ILI9341_FB_DMA2D_Usable((uint32_t)cw * ch, src, 2)) {
+		DMA2D->FGMAR = (uint32_t)src;
+		DMA2D->FGOR = stride - cw;
+		DMA2D->FGPFCCR = ILI9341_FB_RGB565;
+		ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_M2M, dst, ILI9341_WIDTH - cw, cw, ch, 0);
+		if (ILI9341_FB_DMA2D_Wait() == HAL_OK) return;
+	}
+#endif
+
+	for (int16_t row = 0; row < ch; row++) {
+		memcpy(dst + (uint32_t)row * ILI9341_WIDTH, src + (uint32_t)row * stride * 2, (uint32_t)cw * 2);
+	}
+}
+
+/**
+ * @brief  Kopiert ein Bild in einem der Formate aus ILI9341_FB_Format in den Framebuffer.
+ *
+ * RGB888 und ARGB8888 werden dabei nach RGB565 gewandelt, RGB565_NATIVE wird byteweise getauscht, der Alphakanal wird ignoriert
+ * (siehe ILI9341_FB_BlendImage). Die Funktion kehrt erst zurück, wenn die Quelldaten
+ * gelesen wurden; der Puffer darf also sofort wiederverwendet werden.
+ *
+ * @param  x, y   Obere linke Ecke des Bildes.
+ * @param  width  Breite des Bildes in Pixeln.
+ * @param  height Höhe des Bildes in Pixeln.
+ * @param  image  Bilddaten im angegebenen Format.
+ * @param  format Pixelformat der Quelle.
+ */
+void ILI9341_FB_DrawImageFormat(int16_t x, int16_t y, uint16_t width, uint16_t height, const void *image, ILI9341_FB_Format format)
+{
+	int16_t cx = x, cy = y, cw = width, ch = height;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+
+	static const uint8_t bytesPerPixel[] = { 4, 3, 2, 2 };
+	uint32_t bpp = bytesPerPixel[format];
+	const uint8_t *src = (const uint8_t*)image + ((uint32_t)(cy - y) * width + (cx - x)) * bpp;
+	uint16_t *dst = &ILI9341_FB_Back[(uint32_t)cy * ILI9341_WIDTH + cx];
+
+	ILI9341_FB_Sync();
+	ILI9341_FB_MarkDirty(cx, cy, cw, ch);
+
+#ifdef ILI9341_FB_USE_DMA2D
+	if (ILI9341_FB_DMA2D_Usable((uint32_t)cw * ch, src, (format == ILI9341_FB_RGB888) ? 1 : bpp)) {
+		DMA2D->FGMAR = (uint32_t)src;
+		DMA2D->FGOR = width - cw;
+		DMA2D->FGPFCCR = (format == ILI9341_FB_RGB565_NATIVE) ? ILI9341_FB_RGB565 : format;
+		if (format == ILI9341_FB_RGB565) {
+			// Quelle liegt bereits in Display-Reihenfolge vor: reine Kopie
+			ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_M2M, dst, ILI9341_WIDTH - cw, cw, ch, 0);
+		} else {
+			ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_M2M_PFC, dst, ILI9341_WIDTH - cw, cw, ch, 1);
+		}
+		if (ILI9341_FB_DMA2D_Wait() == HAL_OK) return;
+	}
+#endif
+
+	for (int16_t row = 0; row < ch; row++) {
+		const uint8_t *s = src + (uint32_t)row * width * bpp;
+		uint16_t *d = dst + (uint32_t)row * ILI9341_WIDTH;
+
+		if (format == ILI9341_FB_RGB565) {
+			memcpy(d, s, (uint32_t)cw * 2);
+			continue;
+		}
+		if (format == ILI9341_FB_RGB565_NATIVE) {
+			ILI9341_Colour_Swap(d, (const uint16_t*)s, cw);
+		} else if (format == ILI9341_FB_RGB888) {
+			ILI9341_Colour_FromRGB888(d, s, cw);
+		} else {
+			ILI9341_Colour_FromARGB8888(d, (const uint32_t*)s, cw);
+		}
+	}
+}
+
+/**
+ * @brief  Mischt ein ARGB8888-Bild per Alpha-Blending in den Framebuffer.
+ *
+ * Die effektive Deckkraft jedes Pixels ist dessen Alphakanal multipliziert mit alpha.
+ * Mit DMA2D wird der Hintergrund bandweise in einen Zwischenpuffer in CPU-Byte-Reihenfolge
+ * kopiert, da der DMA2D-Eingang kein Byte-Tausch-Bit hat; danach wird gemischt und mit
+ * getauschten Bytes zurückgeschrieben.
+ *
+ * @param  x, y   Obere linke Ecke des Bildes.
+ * @param  width  Breite des Bildes in Pixeln.
+ * @param  height Höhe des Bildes in Pixeln.
+ * @param  image  Bilddaten (0xAARRGGBB), 32-Bit ausgerichtet.
+ * @param  alpha  Globale Deckkraft 0..255.
+ */
+void ILI9341_FB_BlendImage(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint32_t *image, uint8_t alpha)
+{
+	int16_t cx = x, cy = y, cw = width, ch = height;
+	if (!ILI9341_ClipRect(&cx, &cy, &cw, &ch) || alpha == 0) return;
+
+	const uint32_t *src = image + (uint32_t)(cy - y) * width + (cx - x);
+	uint16_t *dst = &ILI9341_FB_Back[(uint32_t)cy * ILI9341_WIDTH + cx];
+
+	ILI9341_FB_Sync();
+	ILI9341_FB_MarkDirty(cx, cy, cw, ch);
+
+	int16_t row = 0;
+
+#ifdef ILI9341_FB_USE_DMA2D
+	if (ILI9341_FB_DMA2D_Usable((uint32_t)cw * ch, src, 4)) {
+		uint32_t bandMax = (320 * ILI9341_FB_BLEND_LINES) / cw;
+
+		for (; row < ch; ) {
+			uint16_t band = (ch - row < (int32_t)bandMax) ? ch - row : bandMax;
+			uint16_t *d = dst + (uint32_t)row * ILI9341_WIDTH;
+
+			// 1. Hintergrund in CPU-Byte-Reihenfolge holen
+			DMA2D->FGMAR = (uint32_t)d;
+			DMA2D->FGOR = ILI9341_WIDTH - cw;
+			DMA2D->FGPFCCR = ILI9341_FB_RGB565;
+			ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_M2M_PFC, ILI9341_FB_BlendBuffer, 0, cw, band, 1);
+			if (ILI9341_FB_DMA2D_Wait() != HAL_OK) break;
+
+			// 2. Vordergrund (Alpha * globales Alpha) über den Hintergrund mischen
+			DMA2D->FGMAR = (uint32_t)(src + (uint32_t)row * width);
+			DMA2D->FGOR = width - cw;
+			DMA2D->FGPFCCR = ILI9341_FB_ARGB8888 | (2UL << DMA2D_FGPFCCR_AM_Pos) | ((uint32_t)alpha << DMA2D_FGPFCCR_ALPHA_Pos);
+			DMA2D->BGMAR = (uint32_t)ILI9341_FB_BlendBuffer;
+			DMA2D->BGOR = 0;
+			DMA2D->BGPFCCR = ILI9341_FB_RGB565;
+			ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_M2M_BLEND, d, ILI9341_WIDTH - cw, cw, band, 1);
+			if (ILI9341_FB_DMA2D_Wait() != HAL_OK) break;
+
+			row += band;
+		}
+	}
+#endif
+
+	// CPU-Pfad (ohne DMA2D, für kleine Bereiche und zum Fortsetzen nach einem Fehler)
+	for (; row < ch; row++) {
+		const uint32_t *s = src + (uint32_t)row * width;
+		uint16_t *d = dst + (uint32_t)row * ILI9341_WIDTH;
+
+		for (int16_t col = 0; col < cw; col++) {
+			uint32_t argb = s[col];
+			uint32_t a = ((argb >> 24) * alpha + 127) / 255;
+			if (a == 0) continue;
+
+			uint16_t bg = ILI9341_FB_Swap(d[col]);
+			uint32_t r = (((argb >> 16) & 0xFF) * a + (((bg >> 11) & 0x1F) << 3) * (255 - a)) / 255;
+			uint32_t g = (((argb >> 8) & 0xFF) * a + (((bg >> 5) & 0x3F) << 2) * (255 - a)) / 255;
+			uint32_t b = ((argb & 0xFF) * a + ((bg & 0x1F) << 3) * (255 - a)) / 255;
+
+			d[col] = ILI9341_FB_Swap(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+		}
+	}
+}
+
+/**
+ * @brief  Zeichnet ein Bild mit Farbtabelle (1, 2, 4 oder 8 Bit je Pixel) in den Framebuffer.
+ *
+ * Jede Zeile beginnt auf einem ganzen Byte, das erste Pixel eines Bytes liegt in den
+ * niederwertigen Bits (wie L4 bei DMA2D). Mit DMA2D werden 4- und 8-Bit-Bilder über die
+ * CLUT der Einheit gewandelt (L4/L8 nach RGB565); die Tabelle wird dazu nach ARGB8888
+ * umgerechnet und vor dem Transfer geladen. 1 und 2 Bit, kleine Bereiche und bei 4 Bit
+ * ein Ausschnitt, der mitten in einem Byte beginnt, expandiert die CPU.
+ *
+ * @param  x, y    Obere linke Ecke des Bildes.
+ * @param  width   Breite des Bildes in Pixeln.
+ * @param  height  Höhe des Bildes in Pixeln.
+ * @param  image   Indizes, (width * bpp + 7) / 8 Bytes je Zeile.
+ * @param  bpp     Bits je Pixel (1, 2, 4 oder 8).
+ * @param  palette Farben als RGB565 in Display-Reihenfolge (High-Byte zuerst, wie ILI9341_DrawImage).
+ * @param  colours Einträge der Farbtabelle; größere Indizes ergeben Farbe 0.
+ */
+void ILI9341_FB_DrawIndexed(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image,
+                            uint8_t bpp, const uint16_t *palette, uint16_t colours)
+{
+	int16_t cx = x, cy = y, cw = width, ch = height;
+	if (colours == 0 || colours > 256 || (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8) ||
+	    !ILI9341_ClipRect(&cx, &cy, &cw, &ch)) return;
+
+	uint32_t stride = ((uint32_t)width * bpp + 7) / 8;
+	uint32_t first = (uint32_t)(cx - x);
+	const uint8_t *src = image + (uint32_t)(cy - y) * stride;
+	uint16_t *dst = &ILI9341_FB_Back[(uint32_t)cy * ILI9341_WIDTH + cx];
+
+	ILI9341_FB_Sync();
+	ILI9341_FB_MarkDirty(cx, cy, cw, ch);
+
+#ifdef ILI9341_FB_USE_DMA2D
+	// L4 counts the line offset in pixels, so every row must start on a full byte
+	uint32_t pitch = stride * 8 / bpp;
+	if ((bpp == 8 || (bpp == 4 && (first & 1) == 0 && ((pitch - cw) & 1) == 0)) &&
+	    ILI9341_FB_DMA2D_Usable((uint32_t)cw * ch, src, 1)) {
+		static uint32_t clut[256] AXI_BUFFER;
+		for (uint16_t i = 0; i < colours; i++) {
+			uint16_t c = ILI9341_FB_Swap(palette[i]);
+			clut[i] = 0xFF000000UL | ((uint32_t)(c >> 11) * 255 / 31) << 16
+			        | ((uint32_t)((c >> 5) & 0x3F) * 255 / 63) << 8 | (uint32_t)(c & 0x1F) * 255 / 31;
+		}
+		Cache_CleanDMA(clut, colours * sizeof(uint32_t));
+
+		uint32_t mode = (bpp == 8) ? 5 : 8;	// CM: L8 bzw. L4
+		DMA2D->FGCMAR = (uint32_t)clut;
+		DMA2D->FGPFCCR = mode | ((uint32_t)(colours - 1) << DMA2D_FGPFCCR_CS_Pos) | DMA2D_FGPFCCR_START;
+
+		uint32_t start = HAL_GetTick();
+		while (!(DMA2D->ISR & (DMA2D_ISR_CTCIF | DMA2D_ISR_CAEIF)) && HAL_GetTick() - start <= ILI9341_FB_DMA2D_TIMEOUT);
+		uint8_t loaded = (DMA2D->ISR & DMA2D_ISR_CTCIF) != 0;
+		DMA2D->IFCR = DMA2D_IFCR_CCTCIF | DMA2D_IFCR_CAECIF;
+
+		if (loaded) {
+			DMA2D->FGMAR = (uint32_t)(src + first * bpp / 8);
+			DMA2D->FGOR = pitch - cw;
+			DMA2D->FGPFCCR = mode | ((uint32_t)(colours - 1) << DMA2D_FGPFCCR_CS_Pos);
+			ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_M2M_PFC, dst, ILI9341_WIDTH - cw, cw, ch, 1);
+			if (ILI9341_FB_DMA2D_Wait() == HAL_OK) return;
+		}
+	}
+#endif
+
+	uint8_t mask = (uint8_t)((1U << bpp) - 1);
+	for (int16_t row = 0; row < ch; row++) {
+		const uint8_t *s = src + (uint32_t)row * stride;
+		uint16_t *d = dst + (uint32_t)row * ILI9341_WIDTH;
+
+		for (int16_t col = 0; col < cw; col++) {
+			uint32_t bit = (first + col) * bpp;
+			uint8_t index = (s[bit >> 3] >> (bit & 7)) & mask;
+			d[col] = (index < colours) ? palette[index] : palette[0];
+		}
+	}
+}
+
+/* --------------------------------- Dirty-Rectangles und Übertragung --------------------------------- */
+
+/**
+ * @brief  Markiert einen Bereich als verändert.
+ *
+ * Berührt oder überlappt der neue Bereich ein vorhandenes Rechteck, werden beide
+ * zusammengefasst (auch kaskadierend). Ist die Liste voll, wird der Bereich mit dem
+ * Rechteck verschmolzen, dessen Fläche dabei am wenigsten wächst.
+ *
+ * @param  x, y  Obere linke Ecke.
+ * @param  w, h  Breite und Höhe in Pixeln.
+ */
+void ILI9341_FB_MarkDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (!ILI9341_FB_Clip(&x, &y, &w, &h)) return;
+
+	ILI9341_FB_Rect rect = { x, y, x + w - 1, y + h - 1 };
+
+	// Mit allen berührenden Rechtecken verschmelzen
+	uint8_t merged = 1;
+	while (merged) {
+		merged = 0;
+		for (uint8_t i = 0; i < ILI9341_FB_DirtyCount; i++) {
+			if (ILI9341_FB_Touches(&rect, &ILI9341_FB_Dirty[i])) {
+				ILI9341_FB_Union(&rect, &ILI9341_FB_Dirty[i]);
+				ILI9341_FB_Dirty[i] = ILI9341_FB_Dirty[--ILI9341_FB_DirtyCount];
+				merged = 1;
+				break;
+			}
+		}
+	}
+
+	if (ILI9341_FB_DirtyCount < ILI9341_FB_MAX_DIRTY) {
+		ILI9341_FB_Dirty[ILI9341_FB_DirtyCount++] = rect;
+		return;
+	}
+
+	// Liste voll: Rechteck mit dem geringsten Flächenzuwachs wählen
+	uint8_t best = 0;
+	uint32_t bestGrowth = UINT32_MAX;
+	for (uint8_t i = 0; i < ILI9341_FB_DirtyCount; i++) {
+		ILI9341_FB_Rect u = ILI9341_FB_Dirty[i];
+		ILI9341_FB_Union(&u, &rect);
+		uint32_t growth = ILI9341_FB_Area(&u) - ILI9341_FB_Area(&ILI9341_FB_Dirty[i]);
+		if (growth < bestGrowth) {
+			bestGrowth = growth;
+			best = i;
+		}
+	}
+	ILI9341_FB_Union(&ILI9341_FB_Dirty[best], &rect);
+}
+
+/**
+ * @brief  Markiert den gesamten Bildschirm als verändert.
+ */
+void ILI9341_FB_InvalidateAll()
+{
+	ILI9341_FB_DirtyCount = 1;
+	ILI9341_FB_Dirty[0].x1 = 0;
+	ILI9341_FB_Dirty[0].y1 = 0;
+	ILI9341_FB_Dirty[0].x2 = ILI9341_WIDTH - 1;
+	ILI9341_FB_Dirty[0].y2 = ILI9341_HEIGHT - 1;
+}
+
+/**
+ * @brief  Gibt die Anzahl der noch nicht übertragenen Dirty-Rectangles zurück.
+ */
+uint8_t ILI9341_FB_GetDirtyCount()
+{
+	return ILI9341_FB_DirtyCount;
+}
+
+/**
+ * @brief  Überträgt alle veränderten Bereiche des Framebuffers zum Display.
+ *
+ * Für jedes Dirty-Rectangle wird das Adressfenster gesetzt und der Inhalt zeilenweise
+ * in die Ping-Pong-Zeilenpuffer kopiert, die per DMA gesendet werden. Da kopiert wird,
+ * darf direkt nach der Rückkehr wieder in den Framebuffer gezeichnet werden.
+ *
+ * Im Doppelpuffer-Modus wartet der Flush nur auf die Übertragung des vorigen Bildes und
+ * kehrt zurück, sobald die des aktuellen läuft (siehe Dateikopf).
+ */
+void ILI9341_FB_Flush()
+{
+	PROF_BEGIN(PROF_ID_FB_FLUSH);
+	ILI9341_FB_Sync();
+#ifdef ILI9341_FB_USE_DOUBLE_BUFFER
+	if (ILI9341_FB_Double) {
+		ILI9341_FB_FlushDouble();
+		PROF_END(PROF_ID_FB_FLUSH);
+		return;
+	}
+#endif
+	if (ILI9341_FB_DirtyCount > 0) ILI9341_TE_Sync();
+
+	for (uint8_t i = 0; i < ILI9341_FB_DirtyCount; i++) {
+		ILI9341_FB_Rect *r = &ILI9341_FB_Dirty[i];
+		uint32_t rowBytes = (uint32_t)(r->x2 - r->x1 + 1) * 2;
+		uint32_t rowsPerBuffer = ILI9341_LINE_BUFFER_SIZE / rowBytes;
+
+		ILI9341_BeginWrite(r->x1, r->y1, r->x2, r->y2);
+		ILI9341_StreamBegin();
+
+		uint16_t row = r->y1;
+		while (row <= r->y2) {
+			uint8_t *buffer = ILI9341_StreamGetBuffer();
+			uint32_t used = 0;
+
+			for (uint32_t n = 0; n < rowsPerBuffer && row <= r->y2; n++, row++) {
+				memcpy(buffer + used, &ILI9341_FB_Back[(uint32_t)row * ILI9341_WIDTH + r->x1], rowBytes);
+				used += rowBytes;
+			}
+
+			ILI9341_StreamSubmit(used);
+		}
+
+		ILI9341_StreamEnd();
+	}
+
+	if (ILI9341_FB_Listener != NULL && ILI9341_FB_DirtyCount > 0)
+		ILI9341_FB_Listener(ILI9341_FB_Dirty, ILI9341_FB_DirtyCount);
+	ILI9341_FB_DirtyCount = 0;
+	PROF_END(PROF_ID_FB_FLUSH);
+}
+
+#ifdef ILI9341_FB_USE_DOUBLE_BUFFER
+/**
+ * @brief  Flush mit zwei Puffern: tauschen, Rechtecke im Hintergrund senden, in den neuen hinteren Puffer kopieren.
+ */
+static void ILI9341_FB_FlushDouble()
+{
+	if (ILI9341_FB_DirtyCount == 0) return;
+
+	// The previous frame still goes out of the buffer that becomes the back one
+	ILI9341_WaitWhileBusy();
+	ILI9341_TE_Sync();
+
+	uint16_t *front = ILI9341_FB_Back;
+	ILI9341_FB_Back = (front == ILI9341_FrameBuffer) ? ILI9341_FrameBuffer2 : ILI9341_FrameBuffer;
+
+	uint8_t batching = ILI9341_IsBatching();
+	if (!batching) ILI9341_BeginBatch();
+	for (uint8_t i = 0; i < ILI9341_FB_DirtyCount; i++) {
+		ILI9341_FB_Rect *r = &ILI9341_FB_Dirty[i];
+		ILI9341_BeginWrite(r->x1, r->y1, r->x2, r->y2);
+		ILI9341_SendRowsAsync((const uint8_t*)&front[(uint32_t)r->y1 * ILI9341_WIDTH + r->x1],
+				(r->x2 - r->x1 + 1) * 2, ILI9341_WIDTH * 2, r->y2 - r->y1 + 1);
+	}
+	if (!batching) ILI9341_EndBatch();
+
+	// Bring the new back buffer up to this frame while the SPI reads the front one
+	for (uint8_t i = 0; i < ILI9341_FB_DirtyCount; i++) {
+		ILI9341_FB_Rect *r = &ILI9341_FB_Dirty[i];
+		uint16_t w = r->x2 - r->x1 + 1;
+		uint16_t h = r->y2 - r->y1 + 1;
+		uint32_t offset = (uint32_t)r->y1 * ILI9341_WIDTH + r->x1;
+
+#ifdef ILI9341_FB_USE_DMA2D
+		if ((uint32_t)w * h >= ILI9341_FB_DMA2D_MIN_PIXELS && ILI9341_FB_DMA2D_Wait() == HAL_OK) {
+			DMA2D->FGMAR = (uint32_t)&front[offset];
+			DMA2D->FGOR = ILI9341_WIDTH - w;
+			DMA2D->FGPFCCR = ILI9341_FB_RGB565;
+			ILI9341_FB_DMA2D_Start(ILI9341_FB_DMA2D_M2M, &ILI9341_FB_Back[offset], ILI9341_WIDTH - w, w, h, 0);
+			continue;
+		}
+		ILI9341_FB_Sync();
+#endif
+		for (uint16_t row = 0; row < h; row++) {
+			memcpy(&ILI9341_FB_Back[offset + (uint32_t)row * ILI9341_WIDTH], &front[offset + (uint32_t)row * ILI9341_WIDTH], (uint32_t)w * 2);
+		}
+	}
+
+	if (ILI9341_FB_Listener != NULL)
+		ILI9341_FB_Listener(ILI9341_FB_Dirty, ILI9341_FB_DirtyCount);
+	ILI9341_FB_DirtyCount = 0;
+}
+#endif /* ILI9341_FB_USE_DOUBLE_BUFFER */
+
+/**
+ * @brief  Meldet die Bereiche jedes Flush an einen Empfänger, NULL meldet ab.
+ *
+ * Der Empfänger läuft im Task des Aufrufers von ILI9341_FB_Flush() und darf nur die Rechtecke
+ * übernehmen; die Pixel liest er später selbst aus dem Framebuffer.
+ */
+void ILI9341_FB_SetFlushListener(ILI9341_FB_FlushListener listener)
+{
+	ILI9341_FB_Listener = listener;
+}
+
+#endif /* ILI9341_USE_FRAMEBUFFER */
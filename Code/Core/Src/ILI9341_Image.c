@@ -0,0 +1,662 @@
+/**
+ * @file    ILI9341_Image.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Komprimierte RGB565-Bilder (RLE, LZ4 und Farbtabelle) mit Streaming-Dekoder für das ILI9341
+ *
+ * UI-Grafik besteht überwiegend aus Flächen einer Farbe und schrumpft mit Lauflängenkodierung
+ * auf ein Fünftel bis ein Zehntel, Fotos lassen sich mit LZ4 immer noch deutlich verkleinern.
+ * Tools/image_compress.py erzeugt die Dateien: ein ILI9341_ImageHeader, dahinter die Daten.
+ *
+ * RLE arbeitet auf Pixeln (2 Bytes, High-Byte zuerst). Ein Steuerbyte c leitet ein:
+ *   c < 0x80:  c + 1 Pixel folgen unverändert (Literal)
+ *   c >= 0x80: Lauf von (c & 0x7F) Pixeln einer Farbe; ist (c & 0x7F) == 0, folgt die
+ *              Länge als uint16_t Little Endian. Danach die Farbe (High-Byte zuerst).
+ *
+ * LZ4 ist das Standard-Blockformat auf dem Bytestrom der Pixel. Referenzen reichen
+ * höchstens ILI9341_IMAGE_LZ4_WINDOW Bytes zurück, das begrenzt der Packer.
+ *
+ * INDEXED beginnt mit colours + 1 Farben (RGB565, High-Byte zuerst), danach folgen die
+ * Indizes mit bpp Bits je Pixel. Jede Zeile beginnt auf einem ganzen Byte, das erste Pixel
+ * eines Bytes liegt in den niederwertigen Bits. Bis 16 Farben braucht ein Bild so ein
+ * Viertel von RGB565, von der SD-Karte also auch nur ein Viertel der Lesezeit. Eine Tabelle
+ * (ILI9341_ImageLUT) setzt die Indizes beim Dekodieren in Pixel um; im Framebuffer-Modus
+ * übernimmt das bei Bildern im Speicher die CLUT der DMA2D (ILI9341_FB_DrawIndexed()).
+ *
+ * Dekodiert wird direkt in die beiden ILI9341_FileBuffer, immer in ganzen Bildzeilen:
+ * Ist ein Puffer voll, wird er per DMA zum Display gesendet (bzw. in den Framebuffer
+ * kopiert) und der andere beschrieben. Der zuletzt gesendete Puffer dient LZ4 als Verlauf,
+ * DMA liest ihn nur. Lange RLE-Läufe werden wie ILI9341_DrawColourBurst() übertragen:
+ * Beide Puffer werden einmal mit der Farbe gefüllt und dann wiederholt gesendet, ohne
+ * die Pixel erneut zu schreiben.
+ *
+ * ILI9341_DecodeCompressedStream() gibt die Puffer statt an das Display an einen Empfänger
+ * (Vorschaubilder in Thumb.c), der Dekoder bleibt derselbe.
+ *
+ * FIL und Lesepuffer für Dateien kommen aus Arena_Frame und werden am Ende der Datei
+ * zurückgegeben; ohne Datei braucht der Dekoder keinen weiteren Speicher.
+ */
+
+#include "ILI9341_Image.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "SDCard.h"
+#include "FastSeek.h"
+#include "Arena.h"
+#include "Cache.h"
+#include "ff.h"
+#include <string.h>
+#include <stdio.h>
+
+/* Ping-Pong-Puffer für Bilder von der SD-Karte (ILI9341.c) */
+extern uint8_t ILI9341_FileBuffer[2][ILI9341_FILE_CHUNK_SIZE];
+
+#define ILI9341_IMAGE_NOT_PREPARED  0xFFFFFFFFUL
+
+/* Farben eines INDEXED-Bildes in Display-Reihenfolge; unbenutzte Einträge erhalten Farbe 0 */
+static uint16_t ILI9341_ImageLUT[256];
+
+/**
+ * @brief Quelle der komprimierten Daten (Speicher bzw. QSPI-Fenster oder Datei)
+ */
+typedef struct {
+	const uint8_t *ptr;       // Nächstes ungelesenes Byte
+	const uint8_t *end;       // Ende der gültigen Daten im Speicher bzw. Lesepuffer
+	FIL *file;                // NULL: alle Daten liegen im Speicher
+	uint8_t *buffer;          // Lesepuffer (ILI9341_IMAGE_INPUT_SIZE) für file
+	uint8_t error;
+} ILI9341_ImageSource;
+
+/**
+ * @brief Ziel der dekodierten Pixel: die beiden ILI9341_FileBuffer in ganzen Zeilen
+ */
+typedef struct {
+	uint16_t x, y, width, height;
+	uint32_t rowBytes;
+	uint32_t remaining;       // Noch fehlende Bytes des Bildes
+	uint16_t row;             // Bereits ausgegebene Zeilen
+	uint8_t *buffers[2];
+	uint8_t index;            // Puffer, der gerade beschrieben wird
+	uint32_t fill;            // Gültige Bytes im aktuellen Puffer
+	uint32_t capacity;        // Ganze Zeilen pro Puffer in Bytes
+	uint32_t prepared[2];     // Farbe, mit der ein Puffer vollständig gefüllt ist
+	uint8_t emitted;          // Mindestens ein Puffer wurde ausgegeben (LZ4-Verlauf gültig)
+	ILI9341_ImageRows rows;   // Statt des Displays: Empfänger der Zeilen
+	void *context;
+	uint8_t toFramebuffer;
+	uint8_t streaming;
+	uint8_t error;
+} ILI9341_ImageSink;
+
+static uint8_t ILI9341_ImageDecode(ILI9341_ImageSource *src, const ILI9341_ImageHeader *header, uint16_t x, uint16_t y,
+                                   ILI9341_ImageRows rows, void *context);
+static uint8_t ILI9341_ImageRefill(ILI9341_ImageSource *src);
+static uint8_t ILI9341_ImageByte(ILI9341_ImageSource *src);
+static void ILI9341_ImageRead(ILI9341_ImageSource *src, uint8_t *dst, uint32_t size);
+static uint8_t* ILI9341_ImageSpace(ILI9341_ImageSink *sink, uint32_t *space);
+static void ILI9341_ImageEmit(ILI9341_ImageSink *sink);
+static void ILI9341_ImageLiteral(ILI9341_ImageSource *src, ILI9341_ImageSink *sink, uint32_t size);
+static void ILI9341_ImageRun(ILI9341_ImageSink *sink, uint16_t colour, uint32_t pixels);
+static void ILI9341_ImageMatch(ILI9341_ImageSink *sink, uint32_t distance, uint32_t length);
+static void ILI9341_ImageDecodeRLE(ILI9341_ImageSource *src, ILI9341_ImageSink *sink);
+static void ILI9341_ImageDecodeLZ4(ILI9341_ImageSource *src, ILI9341_ImageSink *sink);
+static uint8_t ILI9341_ImageDecodeIndexed(ILI9341_ImageSource *src, ILI9341_ImageSink *sink, const ILI9341_ImageHeader *header);
+
+/**
+ * @brief  Zeichnet ein komprimiertes Bild aus dem Speicher, z.B. aus dem Memory-Mapped-Fenster des W25Qxx.
+ *
+ * @param  data Kopf und komprimierte Daten (z.B. von Asset_Find())
+ * @param  size Länge von data in Bytes
+ * @param  x, y Obere linke Ecke auf dem Display
+ * @retval 1 bei Erfolg, 0 bei ungültigen oder abgeschnittenen Daten
+ *
+ * @note   Kehrt nach dem Start des letzten DMA-Blocks zurück, data wird dann nicht mehr gelesen.
+ */
+uint8_t ILI9341_DrawCompressedImage(const uint8_t *data, uint32_t size, uint16_t x, uint16_t y) {
+	ILI9341_ImageHeader header;
+	if (size < sizeof(header)) {
+		return 0;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (header.size > size - sizeof(header)) {
+		return 0;
+	}
+
+	ILI9341_ImageSource src = { data + sizeof(header), data + sizeof(header) + header.size, NULL, NULL, 0 };
+	return ILI9341_ImageDecode(&src, &header, x, y, NULL, NULL);
+}
+
+/**
+ * @brief  Zeichnet ein komprimiertes Bild von der SD-Karte; Breite und Höhe stehen im Dateikopf.
+ *
+ * Die Datei wird in Blöcken von ILI9341_IMAGE_INPUT_SIZE Bytes gelesen, der erste Block
+ * enthält den Kopf. So bleiben alle weiteren Lesezugriffe sektorausgerichtet.
+ *
+ * @param  filename Pfad zur Datei
+ * @param  x, y     Obere linke Ecke auf dem Display
+ * @retval 1 bei Erfolg, sonst 0
+ */
+uint8_t ILI9341_DrawCompressedFile(const char *filename, uint16_t x, uint16_t y) {
+	if (SDCard_Acquire() == NULL) {
+		printf("Could not mount SDCard");
+		return 0;
+	}
+
+	Arena_Mark mark = Arena_GetMark(&Arena_Frame);
+	FIL *file = Arena_Alloc(&Arena_Frame, sizeof(FIL), 0);
+	if (file == NULL) {
+		printf("Not enough arena memory for image: %s\n", filename);
+		Arena_Release(&Arena_Frame, mark);
+		SDCard_Release();
+		return 0;
+	}
+
+	memset(file, 0, sizeof(FIL));
+	FRESULT res = FastSeek_Open(file, filename);
+	if (res != FR_OK) {
+		printf("Failed to open file: %d\n", res);
+		SDCard_CheckResult(res);
+		Arena_Release(&Arena_Frame, mark);
+		SDCard_Release();
+		return 0;
+	}
+
+	uint8_t ok = ILI9341_DrawCompressedStream(file, x, y);
+	if (!ok) {
+		printf("Failed to decode image: %s\n", filename);
+	}
+
+	FastSeek_Close(file);
+	Arena_Release(&Arena_Frame, mark);
+	SDCard_Release();
+	return ok;
+}
+
+/**
+ * @brief  Zeichnet ein komprimiertes Bild ab der aktuellen Position einer offenen Datei.
+ *
+ * Für Container mit mehreren Bildern (Einzelbilder einer Animation, Anim.c). Der Lesepuffer
+ * kommt aus Arena_Frame und wird vor dem Rücksprung zurückgegeben. Gelesen wird in Blöcken
+ * von ILI9341_IMAGE_INPUT_SIZE Bytes, danach steht die Dateiposition also bis zu einem Block
+ * hinter dem Bild; wer weiterliest, setzt sie mit f_lseek().
+ *
+ * @param  file Datei, deren Position auf einem ILI9341_ImageHeader steht
+ * @param  x, y Obere linke Ecke auf dem Display
+ * @retval 1 bei Erfolg, sonst 0
+ */
+uint8_t ILI9341_DrawCompressedStream(FIL *file, uint16_t x, uint16_t y) {
+	Arena_Mark mark = Arena_GetMark(&Arena_Frame);
+	uint8_t *input = Arena_Alloc(&Arena_Frame, ILI9341_IMAGE_INPUT_SIZE, CACHE_LINE_SIZE);
+	if (input == NULL) {
+		printf("Not enough arena memory for image input\n");
+		return 0;
+	}
+
+	uint8_t ok = 0;
+	ILI9341_ImageSource src = { input, input, file, input, 0 };
+	ILI9341_ImageHeader header;
+
+	ILI9341_ImageRead(&src, (uint8_t*)&header, sizeof(header));
+	if (!src.error) {
+		ok = ILI9341_ImageDecode(&src, &header, x, y, NULL, NULL);
+	}
+
+	Arena_Release(&Arena_Frame, mark);
+	return ok;
+}
+
+/**
+ * @brief  Dekodiert ein komprimiertes Bild ab der aktuellen Position einer offenen Datei in einen Empfänger.
+ *
+ * Wie ILI9341_DrawCompressedStream(), aber die Zeilen gehen an rows statt an das Display.
+ * Die Ping-Pong-Puffer werden dabei beschrieben; rows darf also nicht zeichnen, bevor der
+ * Aufruf zurückkehrt.
+ *
+ * @param  file   Datei, deren Position auf einem ILI9341_ImageHeader steht
+ * @param  header Erhält den Kopf (Breite, Höhe) bereits vor der ersten Zeile
+ * @param  rows   Empfänger, in Stücken aus ganzen Zeilen von oben nach unten
+ * @retval 1 bei Erfolg, sonst 0
+ */
+uint8_t ILI9341_DecodeCompressedStream(FIL *file, ILI9341_ImageHeader *header, ILI9341_ImageRows rows, void *context) {
+	Arena_Mark mark = Arena_GetMark(&Arena_Frame);
+	uint8_t *input = Arena_Alloc(&Arena_Frame, ILI9341_IMAGE_INPUT_SIZE, CACHE_LINE_SIZE);
+	if (input == NULL) {
+		printf("Not enough arena memory for image input\n");
+		return 0;
+	}
+
+	uint8_t ok = 0;
+	ILI9341_ImageSource src = { input, input, file, input, 0 };
+
+	// The last draw may still be sending from the ping-pong buffers
+	ILI9341_WaitWhileBusy();
+	ILI9341_ImageRead(&src, (uint8_t*)header, sizeof(*header));
+	if (!src.error) {
+		ok = ILI9341_ImageDecode(&src, header, 0, 0, rows, context);
+	}
+
+	Arena_Release(&Arena_Frame, mark);
+	return ok;
+}
+
+/**
+ * @brief  Prüft den Kopf und dekodiert das Bild in die Ping-Pong-Puffer.
+ */
+static uint8_t ILI9341_ImageDecode(ILI9341_ImageSource *src, const ILI9341_ImageHeader *header, uint16_t x, uint16_t y,
+                                   ILI9341_ImageRows rows, void *context) {
+	if (header->magic != ILI9341_IMAGE_MAGIC || header->width == 0 || header->height == 0) {
+		return 0;
+	}
+
+	ILI9341_ImageSink sink = {0};
+	sink.x = x;
+	sink.y = y;
+	sink.width = header->width;
+	sink.height = header->height;
+	sink.rowBytes = (uint32_t)header->width * 2;
+	sink.remaining = sink.rowBytes * header->height;
+	sink.buffers[0] = ILI9341_FileBuffer[0];
+	sink.buffers[1] = ILI9341_FileBuffer[1];
+	sink.capacity = (ILI9341_FILE_CHUNK_SIZE / sink.rowBytes) * sink.rowBytes;
+	sink.prepared[0] = ILI9341_IMAGE_NOT_PREPARED;
+	sink.prepared[1] = ILI9341_IMAGE_NOT_PREPARED;
+	sink.rows = rows;
+	sink.context = context;
+#ifdef ILI9341_USE_FRAMEBUFFER
+	sink.toFramebuffer = rows == NULL && ILI9341_FB_IsEnabled();
+#endif
+
+	if (sink.capacity == 0 ||
+	   (header->format == ILI9341_IMAGE_LZ4 && sink.capacity < ILI9341_IMAGE_LZ4_WINDOW)) {
+		printf("Image too wide for file buffer\n");
+		return 0;
+	}
+
+	if (header->format == ILI9341_IMAGE_RLE) {
+		ILI9341_ImageDecodeRLE(src, &sink);
+	} else if (header->format == ILI9341_IMAGE_LZ4) {
+		ILI9341_ImageDecodeLZ4(src, &sink);
+	} else if (header->format == ILI9341_IMAGE_INDEXED) {
+		if (!ILI9341_ImageDecodeIndexed(src, &sink, header)) {
+			return 0;
+		}
+	} else {
+		return 0;
+	}
+
+	// Letzten, evtl. unvollständigen Puffer ausgeben
+	if (sink.fill > 0) {
+		ILI9341_ImageEmit(&sink);
+	}
+	if (sink.streaming) {
+		ILI9341_StreamEnd();
+	}
+
+	return !src->error && !sink.error && sink.remaining == 0;
+}
+
+/* --------------------------------- Quelle --------------------------------- */
+
+/**
+ * @brief  Liest den nächsten Block der Datei in den Lesepuffer.
+ * @retval 1 wenn danach Daten vorliegen, sonst 0 (Fehler wird in src vermerkt)
+ */
+static uint8_t ILI9341_ImageRefill(ILI9341_ImageSource *src) {
+	UINT bytesRead = 0;
+
+	if (src->file == NULL || f_read(src->file, src->buffer, ILI9341_IMAGE_INPUT_SIZE, &bytesRead) != FR_OK || bytesRead == 0) {
+		src->error = 1;
+		return 0;
+	}
+
+	src->ptr = src->buffer;
+	src->end = src->buffer + bytesRead;
+	return 1;
+}
+
+/**
+ * @brief  Liefert das nächste Byte der Quelle, 0 am Ende der Daten.
+ */
+static uint8_t ILI9341_ImageByte(ILI9341_ImageSource *src) {
+	if (src->ptr == src->end && !ILI9341_ImageRefill(src)) {
+		return 0;
+	}
+	return *src->ptr++;
+}
+
+/**
+ * @brief  Kopiert size Bytes aus der Quelle nach dst.
+ */
+static void ILI9341_ImageRead(ILI9341_ImageSource *src, uint8_t *dst, uint32_t size) {
+	while (size > 0) {
+		if (src->ptr == src->end && !ILI9341_ImageRefill(src)) {
+			return;
+		}
+
+		uint32_t chunk = (uint32_t)(src->end - src->ptr);
+		if (chunk > size) {
+			chunk = size;
+		}
+
+		memcpy(dst, src->ptr, chunk);
+		src->ptr += chunk;
+		dst += chunk;
+		size -= chunk;
+	}
+}
+
+/* --------------------------------- Ziel --------------------------------- */
+
+/**
+ * @brief  Liefert die Schreibposition im aktuellen Puffer und den zusammenhängenden Platz dort.
+ *
+ * Ist der Puffer voll, wird er zuerst ausgegeben. Der Platz ist auf die noch fehlenden
+ * Bytes des Bildes begrenzt; 0 bedeutet, dass die Daten über das Bild hinausgehen.
+ */
+static uint8_t* ILI9341_ImageSpace(ILI9341_ImageSink *sink, uint32_t *space) {
+	if (sink->fill == sink->capacity) {
+		ILI9341_ImageEmit(sink);
+	}
+
+	*space = sink->capacity - sink->fill;
+	if (*space > sink->remaining) {
+		*space = sink->remaining;
+	}
+	if (*space == 0) {
+		sink->error = 1;
+	}
+
+	sink->prepared[sink->index] = ILI9341_IMAGE_NOT_PREPARED;
+	return sink->buffers[sink->index] + sink->fill;
+}
+
+/**
+ * @brief  Gibt den aktuellen Puffer aus und schaltet auf den anderen um.
+ *
+ * Zum Display per ILI9341_SendDataAsync(), das vorher auf die Übertragung des anderen
+ * Puffers wartet; danach ist dieser wieder beschreibbar. Das Adressfenster wird beim
+ * ersten Puffer einmal für das ganze Bild gesetzt.
+ */
+static void ILI9341_ImageEmit(ILI9341_ImageSink *sink) {
+	uint8_t *buffer = sink->buffers[sink->index];
+	uint16_t rows = (uint16_t)((sink->fill + sink->rowBytes - 1) / sink->rowBytes);
+
+	if (sink->rows != NULL) {
+		sink->rows(sink->context, sink->row, rows, buffer);
+	} else
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (sink->toFramebuffer) {
+		ILI9341_FB_DrawImage(sink->x, sink->y + sink->row, sink->width, rows, buffer);
+	} else
+#endif
+	{
+		if (!sink->streaming) {
+			ILI9341_BeginWrite(sink->x, sink->y, sink->x + sink->width - 1, sink->y + sink->height - 1);
+			ILI9341_StreamBegin();
+			sink->streaming = 1;
+		}
+		ILI9341_SendDataAsync(buffer, sink->fill);
+	}
+
+	sink->row += rows;
+	sink->index ^= 1;
+	sink->fill = 0;
+	sink->emitted = 1;
+}
+
+/**
+ * @brief  Kopiert size unveränderte Bytes aus der Quelle in die Puffer.
+ */
+static void ILI9341_ImageLiteral(ILI9341_ImageSource *src, ILI9341_ImageSink *sink, uint32_t size) {
+	while (size > 0 && !sink->error && !src->error) {
+		uint32_t space;
+		uint8_t *dst = ILI9341_ImageSpace(sink, &space);
+		if (space > size) {
+			space = size;
+		}
+
+		ILI9341_ImageRead(src, dst, space);
+		sink->fill += space;
+		sink->remaining -= space;
+		size -= space;
+	}
+}
+
+/**
+ * @brief  Schreibt einen Lauf von pixels Pixeln einer Farbe.
+ *
+ * Deckt der Lauf von einer Puffergrenze an mindestens einen ganzen Puffer ab, wird der
+ * Puffer nur gefüllt, wenn er nicht schon diese Farbe enthält, und dann unverändert
+ * gesendet (wie bei ILI9341_DrawColourBurst()).
+ */
+static void ILI9341_ImageRun(ILI9341_ImageSink *sink, uint16_t colour, uint32_t pixels) {
+	uint32_t size = pixels * 2;
+	// Pixel liegen mit High-Byte zuerst im Puffer
+	uint16_t value = (uint16_t)((colour >> 8) | (colour << 8));
+
+	while (size > 0 && !sink->error) {
+		if (sink->fill == sink->capacity) {
+			ILI9341_ImageEmit(sink);
+		}
+
+		if (sink->fill == 0 && !sink->toFramebuffer && size >= sink->capacity && sink->remaining >= sink->capacity) {
+			uint16_t *dst = (uint16_t*)sink->buffers[sink->index];
+			if (sink->prepared[sink->index] != colour) {
+				for (uint32_t i = 0; i < sink->capacity / 2; i++) {
+					dst[i] = value;
+				}
+				sink->prepared[sink->index] = colour;
+			}
+			sink->fill = sink->capacity;
+			sink->remaining -= sink->capacity;
+			size -= sink->capacity;
+			continue;
+		}
+
+		uint32_t space;
+		uint16_t *dst = (uint16_t*)ILI9341_ImageSpace(sink, &space);
+		if (space > size) {
+			space = size;
+		}
+
+		for (uint32_t i = 0; i < space / 2; i++) {
+			dst[i] = value;
+		}
+		sink->fill += space;
+		sink->remaining -= space;
+		size -= space;
+	}
+}
+
+/**
+ * @brief  Kopiert length Bytes, die distance Bytes vor der Schreibposition liegen (LZ4-Referenz).
+ *
+ * Der Verlauf besteht aus dem aktuellen und dem zuletzt ausgegebenen Puffer. Überlappt die
+ * Referenz die Schreibposition (distance < length), wird byteweise vorwärts kopiert.
+ */
+static void ILI9341_ImageMatch(ILI9341_ImageSink *sink, uint32_t distance, uint32_t length) {
+	while (length > 0 && !sink->error) {
+		uint32_t space;
+		uint8_t *dst = ILI9341_ImageSpace(sink, &space);
+		if (space > length) {
+			space = length;
+		}
+
+		const uint8_t *from;
+		if (distance == 0 || distance > sink->fill + (sink->emitted ? sink->capacity : 0)) {
+			sink->error = 1;
+			return;
+		}
+
+		if (distance <= sink->fill) {
+			from = dst - distance;
+			if (distance < space) {
+				for (uint32_t i = 0; i < space; i++) {
+					dst[i] = from[i];
+				}
+			} else {
+				memcpy(dst, from, space);
+			}
+		} else {
+			// Beginnt im vorherigen Puffer: nur bis zu dessen Ende kopieren
+			uint32_t back = distance - sink->fill;
+			from = sink->buffers[sink->index ^ 1] + sink->capacity - back;
+			if (space > back) {
+				space = back;
+			}
+			memcpy(dst, from, space);
+		}
+
+		sink->fill += space;
+		sink->remaining -= space;
+		length -= space;
+	}
+}
+
+/* --------------------------------- Dekoder --------------------------------- */
+
+/**
+ * @brief  Dekodiert RLE-Daten, bis das Bild vollständig ist.
+ */
+static void ILI9341_ImageDecodeRLE(ILI9341_ImageSource *src, ILI9341_ImageSink *sink) {
+	while (sink->remaining > 0 && !sink->error && !src->error) {
+		uint8_t control = ILI9341_ImageByte(src);
+
+		if (control & 0x80) {
+			uint32_t pixels = control & 0x7F;
+			if (pixels == 0) {
+				pixels = ILI9341_ImageByte(src);
+				pixels |= (uint32_t)ILI9341_ImageByte(src) << 8;
+			}
+			uint16_t colour = (uint16_t)ILI9341_ImageByte(src) << 8;
+			colour |= ILI9341_ImageByte(src);
+
+			if (!src->error) {
+				ILI9341_ImageRun(sink, colour, pixels);
+			}
+		} else {
+			ILI9341_ImageLiteral(src, sink, ((uint32_t)control + 1) * 2);
+		}
+	}
+}
+
+/**
+ * @brief  Dekodiert einen LZ4-Block, bis das Bild vollständig ist.
+ *
+ * Sequenz: Token (obere 4 Bit Literal-, untere 4 Bit Match-Länge), verlängerte Literal-Länge,
+ * Literale, Distanz (uint16_t Little Endian), verlängerte Match-Länge (+4). Die letzte
+ * Sequenz besteht nur aus Literalen.
+ */
+static void ILI9341_ImageDecodeLZ4(ILI9341_ImageSource *src, ILI9341_ImageSink *sink) {
+	while (sink->remaining > 0 && !sink->error && !src->error) {
+		uint8_t token = ILI9341_ImageByte(src);
+
+		uint32_t literals = token >> 4;
+		if (literals == 15) {
+			uint8_t extra;
+			do {
+				extra = ILI9341_ImageByte(src);
+				literals += extra;
+			} while (extra == 255 && !src->error);
+		}
+		ILI9341_ImageLiteral(src, sink, literals);
+
+		if (sink->remaining == 0 || sink->error || src->error) {
+			break;
+		}
+
+		uint32_t distance = ILI9341_ImageByte(src);
+		distance |= (uint32_t)ILI9341_ImageByte(src) << 8;
+
+		uint32_t length = token & 0x0F;
+		if (length == 15) {
+			uint8_t extra;
+			do {
+				extra = ILI9341_ImageByte(src);
+				length += extra;
+			} while (extra == 255 && !src->error);
+		}
+
+		if (!src->error) {
+			ILI9341_ImageMatch(sink, distance, length + 4);
+		}
+	}
+}
+
+/**
+ * @brief  Dekodiert ein Bild mit Farbtabelle, Zeile für Zeile über ILI9341_ImageLUT.
+ *
+ * Liegen die Daten im Speicher und ist der Framebuffer aktiv, zeichnet ILI9341_FB_DrawIndexed()
+ * das ganze Bild (mit DMA2D für 4 und 8 Bit); die Puffer bleiben dann unberührt.
+ *
+ * @retval 0 bei ungültigem Kopf, sonst 1 (Lesefehler stehen in src bzw. sink)
+ */
+static uint8_t ILI9341_ImageDecodeIndexed(ILI9341_ImageSource *src, ILI9341_ImageSink *sink, const ILI9341_ImageHeader *header) {
+	uint8_t bpp = header->bpp;
+	uint32_t colours = (uint32_t)header->colours + 1;
+	uint32_t stride = ((uint32_t)header->width * bpp + 7) / 8;
+	if ((bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8) || colours > (1UL << bpp) ||
+	    header->size < colours * 2 + stride * header->height) {
+		return 0;
+	}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (sink->toFramebuffer && src->file == NULL) {
+		ILI9341_FB_DrawIndexed(sink->x, sink->y, sink->width, sink->height, src->ptr + colours * 2,
+		                       bpp, (const uint16_t*)src->ptr, (uint16_t)colours);
+		sink->remaining = 0;
+		return 1;
+	}
+#endif
+
+	ILI9341_ImageRead(src, (uint8_t*)ILI9341_ImageLUT, colours * 2);
+	for (uint32_t i = colours; i < 256; i++) {
+		ILI9341_ImageLUT[i] = ILI9341_ImageLUT[0];
+	}
+
+	uint8_t mask = (uint8_t)((1U << bpp) - 1);
+	while (sink->remaining > 0 && !sink->error && !src->error) {
+		// Buffers hold whole rows, so a row never wraps into the other buffer
+		uint32_t space;
+		uint16_t *dst = (uint16_t*)ILI9341_ImageSpace(sink, &space);
+		if (space < sink->rowBytes) {
+			sink->error = 1;
+			break;
+		}
+
+		uint32_t bytes = stride;
+		uint32_t pixels = sink->width;
+		while (bytes > 0) {
+			if (src->ptr == src->end && !ILI9341_ImageRefill(src)) {
+				return 1;
+			}
+
+			uint32_t chunk = (uint32_t)(src->end - src->ptr);
+			if (chunk > bytes) {
+				chunk = bytes;
+			}
+			bytes -= chunk;
+
+			if (bpp == 8) {
+				for (uint32_t i = 0; i < chunk; i++) {
+					*dst++ = ILI9341_ImageLUT[src->ptr[i]];
+				}
+				pixels -= chunk;
+				src->ptr += chunk;
+				continue;
+			}
+
+			while (chunk-- > 0) {
+				uint8_t value = *src->ptr++;
+				for (uint8_t bit = 0; bit < 8 && pixels > 0; bit += bpp, pixels--) {
+					*dst++ = ILI9341_ImageLUT[value & mask];
+					value >>= bpp;
+				}
+			}
+		}
+
+		sink->fill += sink->rowBytes;
+		sink->remaining -= sink->rowBytes;
+	}
+	return 1;
+}
@@ -0,0 +1,95 @@
+/**
+* @file    ILI9341_InitFunctions.cpp
+ * @author  simim
+ * @date    1. April 2025
+ * @brief   Initialisierungsfolge für den ILI9341 TFT-Display-Controller
+ *
+ * Diese Datei enthält die Konfiguration des ILI9341 als konstante Befehlstabelle
+ * {Befehl, Anzahl Parameter, Pause, Parameter}. ILI9341_SendInitSequence() sendet eine
+ * Tabelle in einer einzigen CS-Phase, nur D/CX wechselt zwischen Befehl und Parametern.
+ * Pausen stehen nur dort, wo das Datenblatt sie verlangt:
+ *
+ * - ILI9341_InitSequence: Power Control und Management, Timing-Steuerung,
+ *   Spannungsreferenzen, Display-Format, Gamma-Korrektur. Keine Pausen, die Befehle
+ *   gelten auch im Sleep-Modus nach dem Reset.
+ * - ILI9341_WakeSequence: Sleep Out mit ILI9341_SLEEP_SETTLE_MS, danach Display On.
+ *   Frühestens ILI9341_SLEEP_OUT_WAIT_MS nach dem Reset (ILI9341_EndInit()).
+ *
+ * Die Einträge entstehen mit Hw::Command() (HwCommand.hpp) zur Übersetzungszeit: die Anzahl der
+ * Parameter zählt der Compiler, mehr als in ILI9341_InitCommand passen bricht den Build ab.
+ * Die Tabellen haben C-Bindung und liegen wie bisher als Konstanten im Flash.
+ *
+ * Referenz: ILI9341 Datasheet - https://cdn-shop.adafruit.com/datasheets/ILI9341.pdf
+ */
+
+#ifndef ILI9341_INITFUNCTIONS_H
+#define ILI9341_INITFUNCTIONS_H
+
+#include "HwCommand.hpp"
+
+extern "C" {
+#include "ILI9341_InitFunctions.h"
+}
+
+using Hw::Command;
+using Hw::CommandDelay;
+
+/**
+ * @brief  Konfiguration nach dem Reset, in der Reihenfolge des bisherigen Ablaufs
+ *
+ * Memory Access Control (0x36) fehlt: ILI9341_begin() setzt MADCTL mit der Ausrichtung.
+ */
+const ILI9341_InitCommand ILI9341_InitSequence[] = {
+	// Power Control A: REG_VD[2:0] = 100b -> Vcore = 1.6V, VBC[2:0] = 010b -> DDVDH = 5.6V
+	Command(0xCB, 0x39, 0x2C, 0x00, 0x34, 0x02),
+	// Power Control B: PCEQ aktiv, DRV_ena aktiv, DC_ena aktiv (Entladepfad für ESD-Schutz)
+	Command(0xCF, 0x00, 0xC1, 0x30),
+	// Driver Timing Control A: Gate-Treiber non-overlap +1 Einheit, EQ/CR -1, Vorladen -2 Einheiten
+	//https://cdn-shop.adafruit.com/datasheets/ILI9341.pdf#page=197
+	Command(0xE8, 0x85, 0x00, 0x78),
+	// Driver Timing Control B: alle Gate-Treiber-Übergänge 0 Zeiteinheiten (Standard 0x66, 0x00)
+	Command(0xEA, 0x00, 0x00),
+	// Power On Sequence Control: CP1 Soft Start 2 Frames, VCL/DDVDH im 2., VGH im 3. Frame, DDVDH-Verstärkung
+	//https://cdn-shop.adafruit.com/datasheets/ILI9341.pdf#page=200
+	Command(0xED, 0x64, 0x03, 0x12, 0x81),
+	// Pump Ratio Control: Ratio[1:0] = 10b -> DDVDH = 2xVCI
+	//https://cdn-shop.adafruit.com/datasheets/ILI9341.pdf#page=202
+	Command(0xF7, 0x20),
+	// Power Control 1: VRH[5:0] = 100011b -> GVDD = 4.60V (GVDD ≤ DDVDH - 0.2V)
+	//https://cdn-shop.adafruit.com/datasheets/ILI9341.pdf#page=178
+	Command(0xC0, 0x23),
+	// Power Control 2: Faktoren der Step-Up-Schaltung
+	Command(0xC1, 0x10),
+	// VCOM Control 1: VCOMH, VCOML
+	Command(0xC5, 0x3E, 0x28),
+	// VCOM Control 2: VCOM-Offset
+	Command(0xC7, 0x86),
+	// Pixel Format Set: 16 Bit pro Pixel (RGB565)
+	Command(0x3A, 0x55),
+	// Frame Rate Control: Division 1, 24 Takte je Zeile (79 Hz)
+	Command(0xB1, 0x00, 0x18),
+	// Display Function Control: Intervall-Scan, Gate-/Source-Richtung, 320 Zeilen
+	Command(0xB6, 0x08, 0x82, 0x27),
+	// Enable 3G: 3-Gamma-Steuerung aus
+	Command(0xF2, 0x00),
+	// Gamma Set: Kurve 1
+	Command(0x26, 0x01),
+	// Positive Gamma Correction
+	Command(0xE0, 0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00),
+	// Negative Gamma Correction
+	Command(0xE1, 0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F),
+};
+
+const uint8_t ILI9341_InitSequenceLength = Hw::Count(ILI9341_InitSequence);
+
+/**
+ * @brief  Sleep Out und Display On; vor Display On keine Befehle für ILI9341_SLEEP_SETTLE_MS
+ */
+const ILI9341_InitCommand ILI9341_WakeSequence[] = {
+	CommandDelay(ILI9341_SLEEP_SETTLE_MS, 0x11),
+	Command(0x29),
+};
+
+const uint8_t ILI9341_WakeSequenceLength = Hw::Count(ILI9341_WakeSequence);
+
+#endif //ILI9341_INITFUNCTIONS_H
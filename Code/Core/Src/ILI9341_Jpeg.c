@@ -0,0 +1,615 @@
+/**
+ * @file    ILI9341_Jpeg.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   JPEG-Bilder mit dem Hardware-Codec des STM32H7B0 auf dem ILI9341 anzeigen
+ *
+ * Ein Vollbild-Foto braucht roh 150 KB, als JPEG meist nur 10-30 KB. Dekodiert wird mit dem
+ * JPEG-Codec auf Registerebene (der HAL-JPEG-Treiber ist nicht Teil des Projekts):
+ *
+ *   SD/QSPI -> MDMA -> JPEG-Eingangs-FIFO -> Codec -> Ausgangs-FIFO -> MDMA -> MCU-Zeile
+ *           -> YCbCr nach RGB565 (CPU) -> ILI9341_FileBuffer -> SPI-DMA zum Display
+ *
+ * Der Codec liest Huffman- und Quantisierungstabellen selbst aus dem Kopf (Header Processing).
+ * Er liefert 8x8-Blöcke, zu MCUs gruppiert; eine MCU deckt je nach Unterabtastung 8x8
+ * (Graustufen, 4:4:4), 16x8 (4:2:2) oder 16x16 Pixel (4:2:0) ab. Der Ausgangs-MDMA
+ * schreibt immer genau eine MCU-Zeile in einen von zwei Puffern. Während er die nächste
+ * füllt, wandelt die CPU die fertige Zeile nach RGB565 und übergibt sie dem Display.
+ * Der Arbeitsspeicher bleibt so unabhängig von der Bildhöhe bei etwa 24 KB. Er kommt für
+ * jede Dekodierung aus Arena_Frame und wird danach zurückgegeben.
+ *
+ * Die Eingangsdaten kommen entweder aus dem Speicher (z.B. Memory-Mapped-Fenster des
+ * W25Qxx, der MDMA liest direkt daraus) oder blockweise von der SD-Karte, wobei ein Puffer
+ * gelesen wird, während der MDMA den anderen in den Codec schiebt.
+ *
+ * Benutzt zwei MDMA-Kanäle (Eingang, Ausgang) im Polling-Betrieb; DmaAlloc vergibt sie beim
+ * ersten Aufruf.
+ *
+ * Die Dekodierung selbst liegt im Overlay "jpeg" (Overlay.h): sie läuft aus dem ITCM und
+ * belegt keinen internen Flash. Ohne gültige Overlay-Ablage im W25Qxx schlagen beide
+ * Zeichenfunktionen fehl.
+ */
+
+#include "ILI9341_Jpeg.h"
+
+#ifdef USE_JPEG_ENCODING
+
+#include "ILI9341_FB.h"
+#include "SDCard.h"
+#include "FastSeek.h"
+#include "Arena.h"
+#include "Cache.h"
+#include "DmaAlloc.h"
+#include "Prof.h"
+#include "Overlay.h"
+#include "ff.h"
+#include <string.h>
+#include <stdio.h>
+
+/* Ping-Pong-Puffer für Bilder von der SD-Karte (ILI9341.c), hier für die RGB565-Bänder */
+extern uint8_t ILI9341_FileBuffer[2][ILI9341_FILE_CHUNK_SIZE];
+
+/* Schwelle der JPEG-FIFOs: 8 Wörter pro MDMA-Anforderung */
+#define ILI9341_JPEG_FIFO_TH_BYTES  32
+
+/**
+ * @brief Zustand einer Dekodierung
+ */
+typedef struct {
+	const uint8_t *data;      // Speicherquelle: nächstes noch nicht übertragenes Byte
+	uint32_t remaining;       // Speicherquelle: restliche Bytes
+	FIL *file;                // Dateiquelle, NULL bei Speicherquelle
+	uint8_t *input[2];        // Dateiquelle: Eingangspuffer (ILI9341_JPEG_INPUT_SIZE)
+	uint8_t *mcuBuffer[2];    // MCU-Zeilenpuffer (ILI9341_JPEG_MCU_ROW_SIZE)
+	uint32_t nextSize;        // Dateiquelle: Bytes im vorbereiteten Eingangspuffer (0 = Dateiende)
+	uint8_t inIndex;          // Eingangspuffer, den der MDMA gerade liest
+	uint8_t inActive;
+	uint8_t outIndex;         // MCU-Zeilenpuffer, den der MDMA gerade schreibt
+	uint8_t outActive;
+	uint16_t mcuRow;          // Fertige MCU-Zeilen
+	uint16_t mcuRows;
+	uint32_t mcuRowBytes;
+	uint16_t x, y;
+	uint8_t bandIndex;        // Nächster ILI9341_FileBuffer für ein RGB565-Band
+	uint8_t toFramebuffer;
+	uint8_t streaming;
+	uint8_t error;
+} ILI9341_JpegState;
+
+MDMA_HandleTypeDef ILI9341_JpegMdmaIn;
+MDMA_HandleTypeDef ILI9341_JpegMdmaOut;
+uint8_t ILI9341_JpegInitialised = 0;
+
+ILI9341_JpegInfo ILI9341_JpegLastInfo;
+
+/* Wird am Ende jeder Dekodierung gesetzt (Name wie in den ST-Beispielen) */
+__IO uint32_t Jpeg_HWDecodingEnd = 0;
+
+static uint8_t ILI9341_JpegInit(void);
+static uint8_t ILI9341_JpegDecode(ILI9341_JpegState *s);
+static uint8_t ILI9341_JpegAlloc(ILI9341_JpegState *s);
+static void ILI9341_JpegStart(void);
+static void ILI9341_JpegStop(void);
+static uint8_t ILI9341_JpegReadHeader(ILI9341_JpegState *s);
+static void ILI9341_JpegFeed(ILI9341_JpegState *s);
+static uint32_t ILI9341_JpegReadFile(ILI9341_JpegState *s, uint8_t index);
+static uint8_t ILI9341_JpegTransferDone(MDMA_HandleTypeDef *hmdma);
+static void ILI9341_JpegStartOutput(ILI9341_JpegState *s);
+static void ILI9341_JpegConvertRow(const uint8_t *mcu, uint8_t *rgb, uint16_t lines);
+static void ILI9341_JpegEmit(ILI9341_JpegState *s, uint8_t *band, uint16_t row, uint16_t lines);
+
+/**
+ * @brief  Zeichnet ein JPEG aus dem Speicher, z.B. aus dem Memory-Mapped-Fenster des W25Qxx.
+ *
+ * @param  data Anfang der JPEG-Datei (SOI-Marker)
+ * @param  size Länge in Bytes; der MDMA liest bis zu 3 Bytes darüber hinaus
+ * @param  x, y Obere linke Ecke auf dem Display
+ * @retval 1 bei Erfolg, 0 bei Fehlern (Info in ILI9341_JpegLastInfo)
+ */
+uint8_t ILI9341_DrawJpeg(const uint8_t *data, uint32_t size, uint16_t x, uint16_t y) {
+	ILI9341_JpegState s = {0};
+	s.data = data;
+	s.remaining = size;
+	s.x = x;
+	s.y = y;
+
+	// Lesen über den D-Cache hinweg: Daten im RAM müssen im Speicher stehen
+	SCB_CleanDCache_by_Addr((uint32_t*)((uint32_t)data & ~31UL), (int32_t)(size + 32));
+
+	if (!Overlay_Load(OVERLAY_JPEG)) {
+		return 0;
+	}
+	PROF_BEGIN(PROF_ID_JPEG);
+	uint8_t ok = ILI9341_JpegDecode(&s);
+	PROF_END(PROF_ID_JPEG);
+	Overlay_Release(OVERLAY_JPEG);
+	return ok;
+}
+
+/**
+ * @brief  Zeichnet eine JPEG-Datei von der SD-Karte.
+ *
+ * @param  filename Pfad zur Datei
+ * @param  x, y     Obere linke Ecke auf dem Display
+ * @retval 1 bei Erfolg, sonst 0
+ */
+uint8_t ILI9341_DrawJpegFile(const char *filename, uint16_t x, uint16_t y) {
+	if (SDCard_Acquire() == NULL) {
+		printf("Could not mount SDCard");
+		return 0;
+	}
+
+	Arena_Mark mark = Arena_GetMark(&Arena_Frame);
+	FIL *file = Arena_Alloc(&Arena_Frame, sizeof(FIL), 0);
+	if (file == NULL) {
+		printf("Not enough arena memory for JPEG: %s\n", filename);
+		SDCard_Release();
+		return 0;
+	}
+
+	memset(file, 0, sizeof(FIL));
+	FRESULT res = FastSeek_Open(file, filename);
+	if (res != FR_OK) {
+		printf("Failed to open file: %d\n", res);
+		SDCard_CheckResult(res);
+		Arena_Release(&Arena_Frame, mark);
+		SDCard_Release();
+		return 0;
+	}
+
+	ILI9341_JpegState s = {0};
+	s.file = file;
+	s.x = x;
+	s.y = y;
+
+	uint8_t ok = Overlay_Load(OVERLAY_JPEG);
+	if (ok) {
+		ok = ILI9341_JpegDecode(&s);
+		Overlay_Release(OVERLAY_JPEG);
+	}
+	if (!ok) {
+		printf("Failed to decode JPEG: %s\n", filename);
+	}
+
+	FastSeek_Close(file);
+	Arena_Release(&Arena_Frame, mark);
+	SDCard_Release();
+	return ok;
+}
+
+/**
+ * @brief  Schaltet den Codec-Takt ein und konfiguriert die beiden MDMA-Kanäle (einmalig).
+ */
+static uint8_t ILI9341_JpegInit(void) {
+	if (ILI9341_JpegInitialised) {
+		return 1;
+	}
+
+	__HAL_RCC_JPGDECEN_CLK_ENABLE();
+	__HAL_RCC_MDMA_CLK_ENABLE();
+
+	if (!DmaAlloc_ClaimMdma(&ILI9341_JpegMdmaIn, "JPEG in") || !DmaAlloc_ClaimMdma(&ILI9341_JpegMdmaOut, "JPEG out")) {
+		return 0;
+	}
+
+	// Eingang: Bytes aus dem Speicher, zu Wörtern gepackt in das Eingangsregister
+	ILI9341_JpegMdmaIn.Init.Request = MDMA_REQUEST_JPEG_INFIFO_TH;
+	ILI9341_JpegMdmaIn.Init.TransferTriggerMode = MDMA_BUFFER_TRANSFER;
+	ILI9341_JpegMdmaIn.Init.Priority = MDMA_PRIORITY_HIGH;
+	ILI9341_JpegMdmaIn.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+	ILI9341_JpegMdmaIn.Init.SourceInc = MDMA_SRC_INC_BYTE;
+	ILI9341_JpegMdmaIn.Init.DestinationInc = MDMA_DEST_INC_DISABLE;
+	ILI9341_JpegMdmaIn.Init.SourceDataSize = MDMA_SRC_DATASIZE_BYTE;
+	ILI9341_JpegMdmaIn.Init.DestDataSize = MDMA_DEST_DATASIZE_WORD;
+	ILI9341_JpegMdmaIn.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+	ILI9341_JpegMdmaIn.Init.BufferTransferLength = ILI9341_JPEG_FIFO_TH_BYTES;
+	ILI9341_JpegMdmaIn.Init.SourceBurst = MDMA_SOURCE_BURST_32BEATS;
+	ILI9341_JpegMdmaIn.Init.DestBurst = MDMA_DEST_BURST_8BEATS;
+	ILI9341_JpegMdmaIn.Init.SourceBlockAddressOffset = 0;
+	ILI9341_JpegMdmaIn.Init.DestBlockAddressOffset = 0;
+
+	// Ausgang: Wörter aus dem Ausgangsregister in den MCU-Zeilenpuffer
+	ILI9341_JpegMdmaOut.Init.Request = MDMA_REQUEST_JPEG_OUTFIFO_TH;
+	ILI9341_JpegMdmaOut.Init.TransferTriggerMode = MDMA_BUFFER_TRANSFER;
+	ILI9341_JpegMdmaOut.Init.Priority = MDMA_PRIORITY_VERY_HIGH;
+	ILI9341_JpegMdmaOut.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+	ILI9341_JpegMdmaOut.Init.SourceInc = MDMA_SRC_INC_DISABLE;
+	ILI9341_JpegMdmaOut.Init.DestinationInc = MDMA_DEST_INC_BYTE;
+	ILI9341_JpegMdmaOut.Init.SourceDataSize = MDMA_SRC_DATASIZE_WORD;
+	ILI9341_JpegMdmaOut.Init.DestDataSize = MDMA_DEST_DATASIZE_BYTE;
+	ILI9341_JpegMdmaOut.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+	ILI9341_JpegMdmaOut.Init.BufferTransferLength = ILI9341_JPEG_FIFO_TH_BYTES;
+	ILI9341_JpegMdmaOut.Init.SourceBurst = MDMA_SOURCE_BURST_8BEATS;
+	ILI9341_JpegMdmaOut.Init.DestBurst = MDMA_DEST_BURST_32BEATS;
+	ILI9341_JpegMdmaOut.Init.SourceBlockAddressOffset = 0;
+	ILI9341_JpegMdmaOut.Init.DestBlockAddressOffset = 0;
+
+	if (HAL_MDMA_Init(&ILI9341_JpegMdmaIn) != HAL_OK || HAL_MDMA_Init(&ILI9341_JpegMdmaOut) != HAL_OK) {
+		return 0;
+	}
+
+	ILI9341_JpegInitialised = 1;
+	return 1;
+}
+
+/**
+ * @brief  Führt eine Dekodierung vom Start des Codecs bis zur letzten MCU-Zeile aus.
+ */
+OVERLAY(jpeg) static uint8_t ILI9341_JpegDecode(ILI9341_JpegState *s) {
+	Jpeg_HWDecodingEnd = 0;
+	memset(&ILI9341_JpegLastInfo, 0, sizeof(ILI9341_JpegLastInfo));
+
+	if (!ILI9341_JpegInit()) {
+		return 0;
+	}
+
+	Arena_Mark mark = Arena_GetMark(&Arena_Frame);
+	if (!ILI9341_JpegAlloc(s)) {
+		printf("Not enough arena memory for JPEG decoding\n");
+		Arena_Release(&Arena_Frame, mark);
+		return 0;
+	}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	s->toFramebuffer = ILI9341_FB_IsEnabled();
+#endif
+
+	ILI9341_JpegStart();
+
+	if (s->file != NULL) {
+		// Ersten Block vorbereiten; ILI9341_JpegFeed() startet ihn und liest den nächsten
+		s->inIndex = 1;
+		s->nextSize = ILI9341_JpegReadFile(s, 0);
+	}
+
+	uint8_t header = 0;
+	uint32_t lastProgress = HAL_GetTick();
+
+	while (!s->error && (!header || s->mcuRow < s->mcuRows)) {
+		if (!header && (JPEG->SR & JPEG_SR_HPDF)) {
+			if (!ILI9341_JpegReadHeader(s)) {
+				s->error = 1;
+				break;
+			}
+			JPEG->CFR = JPEG_CFR_CHPDF;
+			ILI9341_JpegStartOutput(s);
+			header = 1;
+			lastProgress = HAL_GetTick();
+		}
+
+		if (s->inActive && ILI9341_JpegTransferDone(&ILI9341_JpegMdmaIn)) {
+			s->inActive = 0;
+			lastProgress = HAL_GetTick();
+		}
+		if (!s->inActive) {
+			ILI9341_JpegFeed(s);
+		}
+
+		if (s->outActive && ILI9341_JpegTransferDone(&ILI9341_JpegMdmaOut)) {
+			uint8_t filled = s->outIndex;
+			uint16_t row = s->mcuRow * ILI9341_JpegLastInfo.mcuHeight;
+			uint16_t lines = ILI9341_JpegLastInfo.mcuHeight;
+			if (row + lines > ILI9341_JpegLastInfo.height) {
+				lines = ILI9341_JpegLastInfo.height - row;
+			}
+
+			// Nächste MCU-Zeile sofort anfordern, damit der Codec weiterarbeitet
+			s->outActive = 0;
+			s->mcuRow++;
+			s->outIndex ^= 1;
+			if (s->mcuRow < s->mcuRows) {
+				ILI9341_JpegStartOutput(s);
+			}
+
+			SCB_InvalidateDCache_by_Addr((uint32_t*)s->mcuBuffer[filled], (int32_t)s->mcuRowBytes);
+			uint8_t *band = ILI9341_FileBuffer[s->bandIndex];
+			ILI9341_JpegConvertRow(s->mcuBuffer[filled], band, lines);
+			ILI9341_JpegEmit(s, band, row, lines);
+			lastProgress = HAL_GetTick();
+		}
+
+		if (HAL_GetTick() - lastProgress > ILI9341_JPEG_TIMEOUT) {
+			s->error = 1;
+		}
+	}
+
+	ILI9341_JpegStop();
+	if (s->streaming) {
+		ILI9341_StreamEnd();
+	}
+
+	Arena_Release(&Arena_Frame, mark);
+	Jpeg_HWDecodingEnd = 1;
+	return !s->error;
+}
+
+/**
+ * @brief  Holt die Puffer der Dekodierung aus Arena_Frame, Eingangspuffer nur für Dateien.
+ *
+ * Die MCU-Zeilenpuffer werden invalidiert: Hatte die CPU in diesem Teil der Arena zuvor andere
+ * Daten, dürfen deren Cache-Zeilen nicht später über die Ausgabe des MDMA geschrieben werden.
+ */
+OVERLAY(jpeg) static uint8_t ILI9341_JpegAlloc(ILI9341_JpegState *s) {
+	for (uint8_t i = 0; i < 2; i++) {
+		s->mcuBuffer[i] = Arena_Alloc(&Arena_Frame, ILI9341_JPEG_MCU_ROW_SIZE, CACHE_LINE_SIZE);
+		if (s->mcuBuffer[i] == NULL) {
+			return 0;
+		}
+		SCB_InvalidateDCache_by_Addr((uint32_t*)s->mcuBuffer[i], ILI9341_JPEG_MCU_ROW_SIZE);
+
+		if (s->file != NULL) {
+			s->input[i] = Arena_Alloc(&Arena_Frame, ILI9341_JPEG_INPUT_SIZE, CACHE_LINE_SIZE);
+			if (s->input[i] == NULL) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/* --------------------------------- Codec --------------------------------- */
+
+/**
+ * @brief  Setzt den Codec zurück und startet eine Dekodierung mit Kopfauswertung.
+ */
+OVERLAY(jpeg) static void ILI9341_JpegStart(void) {
+	JPEG->CR |= JPEG_CR_JCEN;
+	JPEG->CONFR0 &= ~JPEG_CONFR0_START;
+
+	// Keine Interrupts, die FIFO-Schwellen lösen nur MDMA-Anforderungen aus
+	JPEG->CR &= ~(JPEG_CR_IFTIE | JPEG_CR_IFNFIE | JPEG_CR_OFTIE | JPEG_CR_OFNEIE | JPEG_CR_EOCIE | JPEG_CR_HPDIE);
+	JPEG->CR |= JPEG_CR_IFF | JPEG_CR_OFF;
+	JPEG->CFR = JPEG_CFR_CEOCF | JPEG_CFR_CHPDF;
+
+	JPEG->CONFR1 |= JPEG_CONFR1_DE | JPEG_CONFR1_HDR;
+	JPEG->CONFR0 |= JPEG_CONFR0_START;
+}
+
+/**
+ * @brief  Bricht laufende MDMA-Transfers ab und hält den Codec an.
+ *
+ * Der Eingangs-MDMA kann noch laufen, weil der Codec nach dem EOI-Marker nichts mehr annimmt.
+ */
+OVERLAY(jpeg) static void ILI9341_JpegStop(void) {
+	if (ILI9341_JpegMdmaIn.State != HAL_MDMA_STATE_READY) {
+		HAL_MDMA_Abort(&ILI9341_JpegMdmaIn);
+	}
+	if (ILI9341_JpegMdmaOut.State != HAL_MDMA_STATE_READY) {
+		HAL_MDMA_Abort(&ILI9341_JpegMdmaOut);
+	}
+
+	JPEG->CONFR0 &= ~JPEG_CONFR0_START;
+	JPEG->CR |= JPEG_CR_IFF | JPEG_CR_OFF;
+	JPEG->CFR = JPEG_CFR_CEOCF | JPEG_CFR_CHPDF;
+}
+
+/**
+ * @brief  Liest Größe und Unterabtastung aus den vom Codec ausgewerteten Kopfdaten.
+ * @retval 0 bei nicht unterstütztem Format (CMYK) oder zu großem Bild
+ */
+OVERLAY(jpeg) static uint8_t ILI9341_JpegReadHeader(ILI9341_JpegState *s) {
+	ILI9341_JpegInfo *info = &ILI9341_JpegLastInfo;
+	uint32_t confr1 = JPEG->CONFR1;
+
+	info->width = (uint16_t)(JPEG->CONFR3 >> JPEG_CONFR3_XSIZE_Pos);
+	info->height = (uint16_t)(confr1 >> JPEG_CONFR1_YSIZE_Pos);
+	info->components = (uint8_t)((confr1 & JPEG_CONFR1_NF) + 1);
+
+	if (info->components == 1) {
+		info->mcuWidth = 8;
+		info->mcuHeight = 8;
+		info->mcuBytes = 64;
+	} else if (info->components == 3) {
+		uint32_t yBlocks = (JPEG->CONFR4 & JPEG_CONFR4_NB) >> JPEG_CONFR4_NB_Pos;
+		uint32_t cbBlocks = (JPEG->CONFR5 & JPEG_CONFR5_NB) >> JPEG_CONFR5_NB_Pos;
+		uint32_t crBlocks = (JPEG->CONFR6 & JPEG_CONFR6_NB) >> JPEG_CONFR6_NB_Pos;
+		if (cbBlocks != 0 || crBlocks != 0) {
+			return 0;
+		}
+
+		if (yBlocks == 3) {            // 4:2:0
+			info->mcuWidth = 16;
+			info->mcuHeight = 16;
+		} else if (yBlocks == 1) {     // 4:2:2
+			info->mcuWidth = 16;
+			info->mcuHeight = 8;
+		} else if (yBlocks == 0) {     // 4:4:4
+			info->mcuWidth = 8;
+			info->mcuHeight = 8;
+		} else {
+			return 0;
+		}
+		info->mcuBytes = (uint16_t)((yBlocks + 3) * 64);
+	} else {
+		return 0;
+	}
+
+	uint32_t mcusPerRow = (info->width + info->mcuWidth - 1) / info->mcuWidth;
+	s->mcuRowBytes = mcusPerRow * info->mcuBytes;
+	s->mcuRows = (uint16_t)((info->height + info->mcuHeight - 1) / info->mcuHeight);
+
+	if (info->width == 0 || info->height == 0 || s->mcuRowBytes > ILI9341_JPEG_MCU_ROW_SIZE ||
+	    (uint32_t)info->width * info->mcuHeight * 2 > ILI9341_FILE_CHUNK_SIZE) {
+		printf("JPEG too large: %ux%u\n", info->width, info->height);
+		return 0;
+	}
+	return 1;
+}
+
+/* --------------------------------- Eingang --------------------------------- */
+
+/**
+ * @brief  Startet den nächsten Eingangs-Transfer, sofern noch Daten vorliegen.
+ *
+ * Speicherquelle: bis zu ILI9341_JPEG_DMA_MAX_CHUNK Bytes direkt aus dem Speicher.
+ * Dateiquelle: Der vorbereitete Puffer wird übertragen und der andere währenddessen gelesen.
+ */
+OVERLAY(jpeg) static void ILI9341_JpegFeed(ILI9341_JpegState *s) {
+	const uint8_t *source;
+	uint32_t size;
+
+	if (s->file == NULL) {
+		if (s->remaining == 0) {
+			return;
+		}
+		source = s->data;
+		size = s->remaining;
+		if (size > ILI9341_JPEG_DMA_MAX_CHUNK) {
+			size = ILI9341_JPEG_DMA_MAX_CHUNK;
+		}
+		s->data += size;
+		s->remaining -= size;
+		// Das Eingangsregister nimmt nur ganze Wörter an
+		size = (size + 3) & ~3UL;
+	} else {
+		if (s->nextSize == 0) {
+			return;
+		}
+		s->inIndex ^= 1;
+		source = s->input[s->inIndex];
+		size = s->nextSize;
+	}
+
+	if (HAL_MDMA_Start(&ILI9341_JpegMdmaIn, (uint32_t)source, (uint32_t)&JPEG->DIR, size, 1) != HAL_OK) {
+		s->error = 1;
+		return;
+	}
+	s->inActive = 1;
+
+	if (s->file != NULL) {
+		s->nextSize = ILI9341_JpegReadFile(s, s->inIndex ^ 1);
+	}
+}
+
+/**
+ * @brief  Liest den nächsten Block der Datei in einen Eingangspuffer.
+ * @retval Zu übertragende Bytes (auf die FIFO-Schwelle aufgefüllt), 0 am Dateiende
+ */
+OVERLAY(jpeg) static uint32_t ILI9341_JpegReadFile(ILI9341_JpegState *s, uint8_t index) {
+	UINT bytesRead = 0;
+	uint8_t *buffer = s->input[index];
+
+	if (f_read(s->file, buffer, ILI9341_JPEG_INPUT_SIZE, &bytesRead) != FR_OK) {
+		s->error = 1;
+		return 0;
+	}
+
+	// Auffüllen hinter dem EOI-Marker wird vom Codec ignoriert
+	uint32_t size = (bytesRead + ILI9341_JPEG_FIFO_TH_BYTES - 1) & ~(ILI9341_JPEG_FIFO_TH_BYTES - 1);
+	memset(buffer + bytesRead, 0, size - bytesRead);
+
+	SCB_CleanDCache_by_Addr((uint32_t*)buffer, (int32_t)size);
+	return size;
+}
+
+/**
+ * @brief  Prüft, ob ein MDMA-Transfer fertig ist, und gibt den Kanal dann wieder frei.
+ *
+ * HAL_MDMA_PollForTransfer() würde bei Timeout 0 den Transfer abbrechen, es wird deshalb
+ * erst nach gesetztem CTC-Flag aufgerufen.
+ */
+OVERLAY(jpeg) static uint8_t ILI9341_JpegTransferDone(MDMA_HandleTypeDef *hmdma) {
+	if (!__HAL_MDMA_GET_FLAG(hmdma, MDMA_FLAG_CTC)) {
+		return 0;
+	}
+	HAL_MDMA_PollForTransfer(hmdma, HAL_MDMA_FULL_TRANSFER, 1);
+	return 1;
+}
+
+/* --------------------------------- Ausgang --------------------------------- */
+
+/**
+ * @brief  Lässt den Ausgangs-MDMA die nächste MCU-Zeile in mcuBuffer[outIndex] schreiben.
+ */
+OVERLAY(jpeg) static void ILI9341_JpegStartOutput(ILI9341_JpegState *s) {
+	if (HAL_MDMA_Start(&ILI9341_JpegMdmaOut, (uint32_t)&JPEG->DOR, (uint32_t)s->mcuBuffer[s->outIndex],
+	                   s->mcuRowBytes, 1) != HAL_OK) {
+		s->error = 1;
+		return;
+	}
+	s->outActive = 1;
+}
+
+/**
+ * @brief  Begrenzt einen Farbwert auf 0..255.
+ */
+static inline int32_t ILI9341_JpegClamp(int32_t value) {
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+/**
+ * @brief  Wandelt eine MCU-Zeile (8x8-Blöcke, YCbCr bzw. Graustufen) in RGB565-Zeilen.
+ *
+ * Aufbau einer MCU: erst die Y-Blöcke (links nach rechts, oben nach unten), dann je ein
+ * Cb- und ein Cr-Block, die bei 4:2:2 bzw. 4:2:0 die ganze MCU unterabgetastet abdecken.
+ *
+ * @param  mcu   Ausgabe des Codecs für eine MCU-Zeile
+ * @param  rgb   Ziel: lines Zeilen à width Pixel, High-Byte zuerst (wie ILI9341_DrawImage)
+ * @param  lines Gültige Zeilen (letzte MCU-Zeile kann angeschnitten sein)
+ */
+OVERLAY(jpeg) static void ILI9341_JpegConvertRow(const uint8_t *mcu, uint8_t *rgb, uint16_t lines) {
+	const ILI9341_JpegInfo *info = &ILI9341_JpegLastInfo;
+	uint16_t width = info->width;
+	uint8_t mcuWidth = info->mcuWidth;
+	uint8_t shiftX = (mcuWidth == 16) ? 1 : 0;
+	uint8_t shiftY = (info->mcuHeight == 16) ? 1 : 0;
+	uint32_t yBlocks = (uint32_t)(mcuWidth / 8) * (info->mcuHeight / 8);
+
+	for (uint16_t mx = 0; mx * mcuWidth < width; mx++) {
+		const uint8_t *block = mcu + (uint32_t)mx * info->mcuBytes;
+		const uint8_t *cb = block + yBlocks * 64;
+		const uint8_t *cr = cb + 64;
+
+		for (uint16_t py = 0; py < lines; py++) {
+			uint16_t x = mx * mcuWidth;
+			uint8_t *out = rgb + ((uint32_t)py * width + x) * 2;
+
+			for (uint8_t px = 0; px < mcuWidth && x < width; px++, x++) {
+				int32_t Y = block[((py >> 3) * (mcuWidth >> 3) + (px >> 3)) * 64 + (py & 7) * 8 + (px & 7)];
+				int32_t r = Y, g = Y, b = Y;
+
+				if (info->components == 3) {
+					uint32_t c = (py >> shiftY) * 8 + (px >> shiftX);
+					int32_t u = (int32_t)cb[c] - 128;
+					int32_t v = (int32_t)cr[c] - 128;
+					// ITU-R BT.601 (JFIF), 16.16 Festkomma
+					r = ILI9341_JpegClamp(Y + ((91881 * v) >> 16));
+					g = ILI9341_JpegClamp(Y - ((22554 * u + 46802 * v) >> 16));
+					b = ILI9341_JpegClamp(Y + ((116130 * u) >> 16));
+				}
+
+				uint16_t colour = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+				*out++ = colour >> 8;
+				*out++ = colour;
+			}
+		}
+	}
+}
+
+/**
+ * @brief  Gibt ein RGB565-Band zum Display (bzw. in den Framebuffer) aus.
+ *
+ * Das Adressfenster wird beim ersten Band einmal für das ganze Bild gesetzt. Die beiden
+ * ILI9341_FileBuffer wechseln sich ab; ILI9341_SendDataAsync() wartet vorher auf das Ende
+ * der Übertragung des anderen Bandes.
+ */
+OVERLAY(jpeg) static void ILI9341_JpegEmit(ILI9341_JpegState *s, uint8_t *band, uint16_t row, uint16_t lines) {
+	const ILI9341_JpegInfo *info = &ILI9341_JpegLastInfo;
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (s->toFramebuffer) {
+		ILI9341_FB_DrawImage(s->x, s->y + row, info->width, lines, band);
+		return;
+	}
+#endif
+
+	if (!s->streaming) {
+		ILI9341_BeginWrite(s->x, s->y, s->x + info->width - 1, s->y + info->height - 1);
+		ILI9341_StreamBegin();
+		s->streaming = 1;
+	}
+	ILI9341_SendDataAsync(band, (uint32_t)info->width * lines * 2);
+	s->bandIndex ^= 1;
+}
+
+#endif /* USE_JPEG_ENCODING */
@@ -0,0 +1,224 @@
+/**
+ * @file    ILI9341_Power.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Power-Manager des ILI9341: Teilbereich, 8-Farben-Modus und Schlaf nach Inaktivität
+ *
+ * Drei Stufen, jede ohne erneute Initialisierung umkehrbar:
+ * - ILI9341_POWER_STATUS: Partial Area (0x30) + Partial Mode (0x12) treiben nur die Zeilen des
+ *   Teilbereichs, Idle Mode (0x39) schaltet auf 8 Farben (MSB jedes Kanals). Für Bildschirme, die
+ *   nur eine Statuszeile zeigen. Zurück mit Normal Display Mode (0x13) und Idle Off (0x38).
+ * - Schlaf: Display Off (0x28) + Sleep In (0x10). Oszillator und Ladungspumpen sind aus, Register
+ *   und Displayspeicher bleiben erhalten; die UI darf weiter zeichnen, das Bild ist beim Aufwachen
+ *   aktuell.
+ * - Aufwachen: Sleep Out (0x11), nach ILI9341_SLEEP_SETTLE_MS Display On (0x29). Keine
+ *   Initialisierungsfolge, keine Gamma-Tabellen, kein Neuzeichnen.
+ *
+ * Das Datenblatt verlangt 5 ms ohne Befehle nach Sleep In/Out und 120 ms zwischen Sleep Out und
+ * dem nächsten Sleep In (und umgekehrt). Beides wartet hier niemand mit HAL_Delay() ab: die
+ * 5 ms sperren den Bus über ILI9341_HoldBus(), die 120 ms verschieben den Übergang auf einen
+ * späteren Durchlauf des Tasks.
+ *
+ * Eingaben kommen über TOPIC_INPUT (der Task ist Abonnent), andere Aktivität meldet
+ * ILI9341_Power_Activity(). Die Hintergrundbeleuchtung hängt auf dieser Platine fest an der
+ * Versorgung und bleibt an.
+ */
+
+#include "ILI9341_Power.h"
+#include "ILI9341.h"
+#include "Scheduler.h"
+#include "Topic.h"
+#include <stdio.h>
+
+/* Datenblatt 8.2.12/8.2.13: Abstand zwischen Sleep In und Sleep Out */
+#define ILI9341_POWER_SLEEP_TOGGLE_MS 120
+
+static uint8_t ILI9341_Power_TaskId = SCHEDULER_INVALID_TASK;
+static ILI9341_PowerState ILI9341_Power_State = ILI9341_POWER_AWAKE;
+static ILI9341_PowerState ILI9341_Power_Target = ILI9341_POWER_AWAKE;
+static ILI9341_PowerMode ILI9341_Power_Mode = ILI9341_POWER_NORMAL;
+static uint32_t ILI9341_Power_Timeout = ILI9341_POWER_TIMEOUT_MS;
+static uint32_t ILI9341_Power_LastActivity;
+static uint32_t ILI9341_Power_LastToggle;      // letztes Sleep In bzw. Sleep Out
+static uint32_t ILI9341_Power_WakeRequest;
+static uint32_t ILI9341_Power_InputSequence;
+static uint16_t ILI9341_Power_PartialFirst = ILI9341_POWER_PARTIAL_FIRST;
+static uint16_t ILI9341_Power_PartialLast = ILI9341_POWER_PARTIAL_LAST;
+static ILI9341_PowerStats ILI9341_Power_Stats;
+
+static void ILI9341_Power_Step(void);
+
+/**
+ * @brief  Meldet den Task an; das Panel ist nach ILI9341_EndInit() wach und im Normalmodus
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der ILI9341_Power_Task() aufruft
+ */
+void ILI9341_Power_Init(uint8_t taskId) {
+	uint32_t now = HAL_GetTick();
+
+	ILI9341_Power_TaskId = taskId;
+	ILI9341_Power_LastActivity = now;
+	ILI9341_Power_LastToggle = now;    // Sleep Out in ILI9341_EndInit()
+	ILI9341_Power_InputSequence = Topic_GetSequence(TOPIC_INPUT);
+	Topic_Subscribe(TOPIC_INPUT, taskId);
+}
+
+/**
+ * @brief  Setzt die Inaktivitätszeit zurück und weckt das Panel, falls es schläft
+ */
+void ILI9341_Power_Activity(void) {
+	ILI9341_Power_LastActivity = HAL_GetTick();
+	if (ILI9341_Power_Target != ILI9341_POWER_AWAKE) {
+		ILI9341_Power_Target = ILI9341_POWER_AWAKE;
+		ILI9341_Power_WakeRequest = ILI9341_Power_LastActivity;
+	}
+	Scheduler_Release(ILI9341_Power_TaskId);
+}
+
+/**
+ * @brief  Inaktivitätszeit bis zum Schlaf in ms, 0 = nie automatisch schlafen
+ */
+void ILI9341_Power_SetTimeout(uint32_t ms) {
+	ILI9341_Power_Timeout = ms;
+	ILI9341_Power_LastActivity = HAL_GetTick();
+}
+
+/**
+ * @brief  Schaltet zwischen ganzer Fläche und Statusbetrieb (Teilbereich, 8 Farben) um
+ *
+ * Geht auch im Schlaf, die Register gelten dann ab dem Aufwachen.
+ */
+void ILI9341_Power_SetMode(ILI9341_PowerMode mode) {
+	if (mode == ILI9341_POWER_STATUS) {
+		uint8_t area[4] = { ILI9341_Power_PartialFirst >> 8, ILI9341_Power_PartialFirst,
+				ILI9341_Power_PartialLast >> 8, ILI9341_Power_PartialLast };
+		ILI9341_SendCommandWithParam_8Bit(0x30, area, sizeof(area));
+		ILI9341_SendCommand(0x12);
+		ILI9341_SendCommand(0x39);
+	} else {
+		ILI9341_SendCommand(0x13);
+		ILI9341_SendCommand(0x38);
+	}
+	ILI9341_Power_Mode = mode;
+}
+
+/**
+ * @brief  Zeilen des Teilbereichs (Panelzeilen 0-319); wirkt sofort, wenn der Statusbetrieb läuft
+ */
+void ILI9341_Power_SetPartialArea(uint16_t first, uint16_t last) {
+	if (first > last || last > 319) return;
+
+	ILI9341_Power_PartialFirst = first;
+	ILI9341_Power_PartialLast = last;
+	if (ILI9341_Power_Mode == ILI9341_POWER_STATUS) {
+		ILI9341_Power_SetMode(ILI9341_POWER_STATUS);
+	}
+}
+
+/**
+ * @brief  Legt das Panel schlafen, sobald das Datenblatt es erlaubt (spätestens nach 120 ms)
+ */
+void ILI9341_Power_Sleep(void) {
+	ILI9341_Power_Target = ILI9341_POWER_ASLEEP;
+	Scheduler_Release(ILI9341_Power_TaskId);
+}
+
+/**
+ * @brief  Weckt das Panel (wie eine Eingabe)
+ */
+void ILI9341_Power_Wake(void) {
+	ILI9341_Power_Activity();
+}
+
+ILI9341_PowerState ILI9341_Power_GetState(void) {
+	return ILI9341_Power_State;
+}
+
+ILI9341_PowerMode ILI9341_Power_GetMode(void) {
+	return ILI9341_Power_Mode;
+}
+
+/**
+ * @brief  Gibt Zustand, Betriebsart und Zähler aus
+ */
+void ILI9341_Power_Dump(void) {
+	static const char *const states[] = { "wach", "schläft", "wacht auf" };
+	ILI9341_PowerStats s = ILI9341_Power_Stats;
+
+	printf("Display %s, %s, Teilbereich %u-%u\n", states[ILI9341_Power_State],
+			ILI9341_Power_Mode == ILI9341_POWER_STATUS ? "Statusbetrieb" : "Normalbetrieb",
+			ILI9341_Power_PartialFirst, ILI9341_Power_PartialLast);
+	if (ILI9341_Power_Timeout == 0) {
+		printf("Kein automatischer Schlaf\n");
+	} else {
+		printf("Schlaf nach %lu s ohne Eingabe, letzte vor %lu s\n", ILI9341_Power_Timeout / 1000,
+				(HAL_GetTick() - ILI9341_Power_LastActivity) / 1000);
+	}
+	printf("Schlafphasen %lu, geweckt %lu, geschlafen %lu s, Aufwachen max %lu ms\n", s.sleeps, s.wakes,
+			s.asleepMs / 1000, s.wakeMsMax);
+}
+
+/**
+ * @brief  Task: Eingaben auswerten, Inaktivität prüfen, Übergänge ausführen
+ */
+void ILI9341_Power_Task(void *context) {
+	uint32_t sequence = Topic_GetSequence(TOPIC_INPUT);
+
+	if (sequence != ILI9341_Power_InputSequence) {
+		ILI9341_Power_InputSequence = sequence;
+		ILI9341_Power_Activity();
+	}
+	if (ILI9341_Power_Timeout != 0 && ILI9341_Power_Target == ILI9341_POWER_AWAKE
+			&& HAL_GetTick() - ILI9341_Power_LastActivity >= ILI9341_Power_Timeout) {
+		ILI9341_Power_Target = ILI9341_POWER_ASLEEP;
+	}
+	ILI9341_Power_Step();
+}
+
+/**
+ * @brief  Ein Übergang Richtung ILI9341_Power_Target, wenn Bus und Datenblatt-Pausen es zulassen
+ */
+static void ILI9341_Power_Step(void) {
+	uint32_t now = HAL_GetTick();
+
+	// Bus busy covers running transfers and the 5 ms settle time of the previous step
+	if (ILI9341_IsBusy() || ILI9341_IsBatching()) return;
+
+	switch (ILI9341_Power_State) {
+		case ILI9341_POWER_AWAKE:
+			if (ILI9341_Power_Target != ILI9341_POWER_ASLEEP
+					|| now - ILI9341_Power_LastToggle < ILI9341_POWER_SLEEP_TOGGLE_MS) {
+				break;
+			}
+			ILI9341_DisplayOff();
+			ILI9341_SendCommand(0x10);
+			ILI9341_HoldBus(ILI9341_SLEEP_SETTLE_MS);
+			ILI9341_Power_LastToggle = now;
+			ILI9341_Power_State = ILI9341_POWER_ASLEEP;
+			ILI9341_Power_Stats.sleeps++;
+			break;
+
+		case ILI9341_POWER_ASLEEP:
+			if (ILI9341_Power_Target != ILI9341_POWER_AWAKE
+					|| now - ILI9341_Power_LastToggle < ILI9341_POWER_SLEEP_TOGGLE_MS) {
+				break;
+			}
+			ILI9341_Power_Stats.asleepMs += now - ILI9341_Power_LastToggle;
+			ILI9341_SendCommand(0x11);
+			ILI9341_HoldBus(ILI9341_SLEEP_SETTLE_MS);
+			ILI9341_Power_LastToggle = now;
+			ILI9341_Power_State = ILI9341_POWER_WAKING;
+			break;
+
+		case ILI9341_POWER_WAKING: {
+			ILI9341_DisplayOn();
+			ILI9341_Power_State = ILI9341_POWER_AWAKE;
+			ILI9341_Power_Stats.wakes++;
+
+			uint32_t wakeMs = now - ILI9341_Power_WakeRequest;
+			if (wakeMs > ILI9341_Power_Stats.wakeMsMax) {
+				ILI9341_Power_Stats.wakeMsMax = wakeMs;
+			}
+			break;
+		}
+	}
+}
@@ -0,0 +1,226 @@
+/**
+ * @file    ILI9341_Scale.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Skalierte und um 90°-Schritte gedrehte RGB565-Bilder für das ILI9341
+ *
+ * ILI9341_DrawImage() zeichnet nur 1:1, jede Vorschau und jede Zoomstufe müsste sonst als
+ * eigenes Asset im Flash liegen. ILI9341_DrawImageScaled() rechnet dagegen für jedes Zielpixel
+ * die Quellposition in 16.16-Festkomma aus: je Zielspalte kommt ein fester Schritt in x und y
+ * hinzu, je Zielzeile ein zweiter. Eine Drehung vertauscht bzw. spiegelt nur diese Schritte,
+ * die innere Schleife bleibt dieselbe. Die Pixelmitten von Quelle und Ziel liegen dabei
+ * übereinander, verkleinerte Bilder verschieben sich also nicht um ein halbes Quellpixel.
+ *
+ * Bilinear werden die vier Nachbarn mit 5-Bit-Gewichten gemischt. Dazu wird ein RGB565-Pixel
+ * in ein 32-Bit-Wort gespreizt (Grün oben, Rot und Blau unten, je mindestens 5 freie Bits
+ * dazwischen), so dass alle drei Kanäle mit einer Multiplikation je Nachbar gemischt werden.
+ *
+ * Ohne Framebuffer entstehen die Zeilen direkt in den Ping-Pong-Zeilenpuffern und laufen per
+ * DMA zum Display, während die CPU die nächsten rechnet. Mit Framebuffer wird direkt in dessen
+ * Zeilen geschrieben. Eine Skalierung kann die DMA2D nicht, sie bleibt bei der CPU; 1:1 ohne
+ * Drehung geht an ILI9341_DrawImage() und damit an die DMA-Kopie. Während einer
+ * Kachel-Aufnahme (ILI9341_Tile_Begin) zeichnet die Funktion nur 1:1.
+ */
+
+#include "ILI9341_Scale.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_Tile.h"
+
+/* Gespreiztes RGB565: -----GGGGGG-----RRRRR------BBBBB */
+#define ILI9341_SCALE_SPREAD_MASK  0x07E0F81FUL
+
+/**
+ * @brief Schrittweiten und Startpunkt in der Quelle (16.16-Festkomma)
+ */
+typedef struct {
+	const uint8_t *image;
+	uint16_t width, height;
+	int32_t colX, colY;         // Schritt je Zielspalte
+	int32_t rowX, rowY;         // Schritt je Zielzeile
+	int32_t startX, startY;     // Quellposition des ersten sichtbaren Zielpixels
+	uint8_t bilinear;
+} ILI9341_ScaleJob;
+
+static void ILI9341_Scale_Row(const ILI9341_ScaleJob *job, uint16_t *dst, int32_t fx, int32_t fy, uint16_t count);
+
+/**
+ * @brief  Liest ein Pixel (High-Byte zuerst) und spreizt es für das Mischen.
+ */
+static inline uint32_t ILI9341_Scale_Spread(const uint8_t *p) {
+	uint32_t c = ((uint32_t)p[0] << 8) | p[1];
+	return (c | (c << 16)) & ILI9341_SCALE_SPREAD_MASK;
+}
+
+/**
+ * @brief  Mischt zwei gespreizte Pixel, w = 0..32 ist der Anteil von b.
+ */
+static inline uint32_t ILI9341_Scale_Lerp(uint32_t a, uint32_t b, uint32_t w) {
+	return ((a * (32 - w) + b * w) >> 5) & ILI9341_SCALE_SPREAD_MASK;
+}
+
+/**
+ * @brief  Zeichnet ein RGB565-Bild skaliert und optional gedreht.
+ *
+ * @param  x, y      Obere linke Ecke des Ziels, darf außerhalb des Displays liegen
+ * @param  dstWidth  Breite des Ziels in Pixeln (nach der Drehung)
+ * @param  dstHeight Höhe des Ziels in Pixeln
+ * @param  image     Quelle, RGB565 mit High-Byte zuerst (wie ILI9341_DrawImage), z.B. im QSPI-Fenster
+ * @param  width     Breite der Quelle in Pixeln (vor der Drehung)
+ * @param  height    Höhe der Quelle in Pixeln
+ * @param  flags     ILI9341_SCALE_NEAREST oder _BILINEAR, verodert mit ILI9341_SCALE_ROTATE_*
+ * @retval 1 wenn gezeichnet wurde (auch ganz außerhalb), 0 bei leerer oder zu großer Quelle
+ *         (ab 32768 Pixeln) und bei Skalierung während einer Kachel-Aufnahme
+ *
+ * @note   Kehrt nach dem Start des letzten DMA-Blocks zurück, image wird dann nicht mehr gelesen.
+ */
+uint8_t ILI9341_DrawImageScaled(int16_t x, int16_t y, uint16_t dstWidth, uint16_t dstHeight,
+                                const uint8_t *image, uint16_t width, uint16_t height, uint8_t flags) {
+	// Source positions must fit 16.16 in an int32_t
+	if (image == NULL || width == 0 || height == 0 || width > INT16_MAX || height > INT16_MAX ||
+	    dstWidth == 0 || dstHeight == 0) {
+		return 0;
+	}
+
+	uint8_t rotation = flags & ILI9341_SCALE_ROTATE_MASK;
+	if (rotation == ILI9341_SCALE_ROTATE_0 && dstWidth == width && dstHeight == height) {
+		// 1:1 keeps the DMA copy, the framebuffer path and tile recording of DrawImage
+		if (x >= 0 && y >= 0) {
+			ILI9341_DrawImage((uint16_t)x, (uint16_t)y, width, height, image);
+			return 1;
+		}
+	}
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording()) {
+		return 0;
+	}
+#endif
+
+	// Visible part of the destination
+	int16_t left, top, right, bottom;
+	ILI9341_GetClip(&left, &top, &right, &bottom);
+	int32_t x1 = x, y1 = y, x2 = (int32_t)x + dstWidth, y2 = (int32_t)y + dstHeight;
+	if (x1 < left) x1 = left;
+	if (y1 < top) y1 = top;
+	if (x2 > right + 1) x2 = right + 1;
+	if (y2 > bottom + 1) y2 = bottom + 1;
+	if (x2 <= x1 || y2 <= y1) {
+		return 1;
+	}
+	uint16_t cw = (uint16_t)(x2 - x1), ch = (uint16_t)(y2 - y1);
+
+	// Steps in the rotated source: along a destination row (u) and down a column (v)
+	uint8_t swapped = rotation == ILI9341_SCALE_ROTATE_90 || rotation == ILI9341_SCALE_ROTATE_270;
+	int32_t stepU = (int32_t)(((uint32_t)(swapped ? height : width) << 16) / dstWidth);
+	int32_t stepV = (int32_t)(((uint32_t)(swapped ? width : height) << 16) / dstHeight);
+
+	ILI9341_ScaleJob job;
+	job.image = image;
+	job.width = width;
+	job.height = height;
+	job.bilinear = (flags & ILI9341_SCALE_BILINEAR) != 0;
+
+	// Pixel centres line up: nearest takes floor((u + 0.5) * step), bilinear samples at (u + 0.5) * step - 0.5
+	int32_t centre = job.bilinear ? -0x8000 : 0;
+	int32_t u = centre + stepU / 2 + (int32_t)((int64_t)(x1 - x) * stepU);
+	int32_t v = centre + stepV / 2 + (int32_t)((int64_t)(y1 - y) * stepV);
+
+	// Mirrored axes: nearest must floor to w - 1 - floor(u), bilinear mirrors the centre exactly
+	int32_t mirrorX = job.bilinear ? ((int32_t)(width - 1) << 16) : (((int32_t)width << 16) - 1);
+	int32_t mirrorY = job.bilinear ? ((int32_t)(height - 1) << 16) : (((int32_t)height << 16) - 1);
+
+	switch (rotation) {
+	case ILI9341_SCALE_ROTATE_90:
+		job.colX = 0;       job.colY = -stepU;  job.rowX = stepV;   job.rowY = 0;
+		job.startX = v;     job.startY = mirrorY - u;
+		break;
+	case ILI9341_SCALE_ROTATE_180:
+		job.colX = -stepU;  job.colY = 0;       job.rowX = 0;       job.rowY = -stepV;
+		job.startX = mirrorX - u;  job.startY = mirrorY - v;
+		break;
+	case ILI9341_SCALE_ROTATE_270:
+		job.colX = 0;       job.colY = stepU;   job.rowX = -stepV;  job.rowY = 0;
+		job.startX = mirrorX - v;  job.startY = u;
+		break;
+	default:
+		job.colX = stepU;   job.colY = 0;       job.rowX = 0;       job.rowY = stepV;
+		job.startX = u;     job.startY = v;
+		break;
+	}
+
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) {
+		uint16_t *fb = ILI9341_FB_GetBuffer() + (uint32_t)y1 * ILI9341_WIDTH + x1;
+		ILI9341_FB_Sync();
+		for (uint16_t row = 0; row < ch; row++) {
+			ILI9341_Scale_Row(&job, fb + (uint32_t)row * ILI9341_WIDTH,
+			                  job.startX + (int32_t)row * job.rowX, job.startY + (int32_t)row * job.rowY, cw);
+		}
+		ILI9341_FB_MarkDirty((int16_t)x1, (int16_t)y1, (int16_t)cw, (int16_t)ch);
+		return 1;
+	}
+#endif
+
+	uint32_t rowBytes = (uint32_t)cw * 2;
+	uint16_t rowsPerBuffer = (uint16_t)(ILI9341_LINE_BUFFER_SIZE / rowBytes);
+
+	ILI9341_BeginWrite((uint16_t)x1, (uint16_t)y1, (uint16_t)(x2 - 1), (uint16_t)(y2 - 1));
+	ILI9341_StreamBegin();
+	for (uint16_t row = 0; row < ch; row += rowsPerBuffer) {
+		uint16_t rows = (ch - row < rowsPerBuffer) ? ch - row : rowsPerBuffer;
+		uint16_t *buffer = (uint16_t*)ILI9341_StreamGetBuffer();
+
+		for (uint16_t i = 0; i < rows; i++) {
+			int32_t r = row + i;
+			ILI9341_Scale_Row(&job, buffer + (uint32_t)i * cw, job.startX + r * job.rowX, job.startY + r * job.rowY, cw);
+		}
+		ILI9341_StreamSubmit(rows * rowBytes);
+	}
+	ILI9341_StreamEnd();
+	return 1;
+}
+
+/**
+ * @brief  Rechnet count Zielpixel einer Zeile in Display-Reihenfolge, ab Quellposition (fx, fy).
+ */
+static void ILI9341_Scale_Row(const ILI9341_ScaleJob *job, uint16_t *dst, int32_t fx, int32_t fy, uint16_t count) {
+	const uint8_t *image = job->image;
+	uint32_t stride = (uint32_t)job->width * 2;
+
+	if (!job->bilinear) {
+		if (job->colY == 0) {
+			// Horizontal step (0° and 180°): the source row stays the same
+			const uint8_t *line = image + (uint32_t)(fy >> 16) * stride;
+			for (uint16_t i = 0; i < count; i++, fx += job->colX) {
+				const uint8_t *p = line + (uint32_t)(fx >> 16) * 2;
+				dst[i] = (uint16_t)(p[0] | (p[1] << 8));
+			}
+			return;
+		}
+		for (uint16_t i = 0; i < count; i++, fx += job->colX, fy += job->colY) {
+			const uint8_t *p = image + (uint32_t)(fy >> 16) * stride + (uint32_t)(fx >> 16) * 2;
+			dst[i] = (uint16_t)(p[0] | (p[1] << 8));
+		}
+		return;
+	}
+
+	int32_t maxX = (int32_t)(job->width - 1) << 16;
+	int32_t maxY = (int32_t)(job->height - 1) << 16;
+	for (uint16_t i = 0; i < count; i++, fx += job->colX, fy += job->colY) {
+		int32_t cx = fx < 0 ? 0 : (fx > maxX ? maxX : fx);
+		int32_t cy = fy < 0 ? 0 : (fy > maxY ? maxY : fy);
+		uint32_t sx = (uint32_t)cx >> 16, sy = (uint32_t)cy >> 16;
+		uint32_t wx = ((uint32_t)cx & 0xFFFF) >> 11, wy = ((uint32_t)cy & 0xFFFF) >> 11;
+
+		// Neighbours beyond the last column or row have zero weight, read the pixel itself
+		const uint8_t *p = image + sy * stride + sx * 2;
+		uint32_t dx = wx ? 2 : 0;
+		uint32_t dy = wy ? stride : 0;
+
+		uint32_t top = ILI9341_Scale_Lerp(ILI9341_Scale_Spread(p), ILI9341_Scale_Spread(p + dx), wx);
+		uint32_t bottom = ILI9341_Scale_Lerp(ILI9341_Scale_Spread(p + dy), ILI9341_Scale_Spread(p + dy + dx), wx);
+		uint32_t c = ILI9341_Scale_Lerp(top, bottom, wy);
+		c = (c | (c >> 16)) & 0xFFFF;
+		dst[i] = (uint16_t)((c >> 8) | (c << 8));
+	}
+}
@@ -0,0 +1,313 @@
+/**
+ * @file    ILI9341_Screenshot.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Bildschirmfoto: Displayspeicher per RX-DMA zurücklesen und als BMP auf die SD-Karte schreiben
+ *
+ * Das Bild entsteht in Bändern von ILI9341_SCREENSHOT_BAND_ROWS Zeilen, jedes ein eigener
+ * Memory Read (ILI9341_ReadPixelsAsync()). Der Task wandelt ein fertiges Band von RGB666 nach
+ * RGB565 und reiht es über SDQueue.c zum Schreiben ein, während das nächste Band gelesen wird
+ * (zwei Ausgabepuffer). Zwischen zwei Bändern ist der Bus frei, die UI zeichnet weiter; ein
+ * Band belegt SPI1 beim Lesetakt von 5,3 MHz etwa 12 ms. Ein ganzes Bild braucht so etwa eine
+ * halbe Sekunde. Was die UI in dieser Zeit ändert, kann in einem Teil der Bänder schon sichtbar
+ * sein, für Fehlerberichte reicht das.
+ *
+ * Das BMP ist 16 Bit mit BI_BITFIELDS (Masken 0xF800/0x07E0/0x001F), die Zeilen liegen wie im
+ * Format üblich von unten nach oben. Deshalb wird von unten nach oben gelesen und jedes Band
+ * beim Wandeln zeilenweise umgedreht, die Datei entsteht dann ohne Seek in einem Durchgang.
+ *
+ * Der RX-DMA-Stream für SPI1 kommt zur Laufzeit aus DmaAlloc_Claim(), CubeMX vergibt für SPI1
+ * nur den TX-Stream.
+ */
+
+#include "ILI9341_Screenshot.h"
+#include "ILI9341.h"
+#include "ILI9341_Colour.h"
+#include "SDQueue.h"
+#include "Scheduler.h"
+#include "DmaAlloc.h"
+#include "Irq.h"
+#include "Cache.h"
+#include <string.h>
+
+#define ILI9341_SCREENSHOT_MAX_WIDTH   320
+#define ILI9341_SCREENSHOT_BAND_PIXELS (ILI9341_SCREENSHOT_MAX_WIDTH * ILI9341_SCREENSHOT_BAND_ROWS)
+#define ILI9341_SCREENSHOT_HEADER_SIZE 66    // BITMAPFILEHEADER + BITMAPINFOHEADER + drei Farbmasken
+
+/* Context des Schreibauftrags für den Dateikopf (0 und 1 sind die Ausgabepuffer) */
+#define ILI9341_SCREENSHOT_HEADER_SLOT 2
+
+typedef enum {
+	ILI9341_SCREENSHOT_IDLE = 0,
+	ILI9341_SCREENSHOT_READ,      // nächstes Band lesen, sobald Bus und Ausgabepuffer frei sind
+	ILI9341_SCREENSHOT_CONVERT,   // Memory Read läuft
+	ILI9341_SCREENSHOT_WRITE,     // Band gewandelt, Schreibauftrag noch nicht eingereiht
+	ILI9341_SCREENSHOT_CLOSE,     // auf ausstehende Schreibaufträge warten, dann schließen
+	ILI9341_SCREENSHOT_CLOSING
+} ILI9341_ScreenshotState;
+
+static uint8_t ILI9341_Screenshot_Rx[1 + ILI9341_SCREENSHOT_BAND_PIXELS * 3] DMA_BUFFER;
+static uint16_t ILI9341_Screenshot_Rows[2][ILI9341_SCREENSHOT_BAND_PIXELS] AXI_BUFFER;
+static uint8_t ILI9341_Screenshot_Header[ILI9341_SCREENSHOT_HEADER_SIZE];
+
+static DMA_HandleTypeDef ILI9341_Screenshot_DmaRx;
+static uint8_t ILI9341_Screenshot_TaskId = SCHEDULER_INVALID_TASK;
+static ILI9341_ScreenshotState ILI9341_Screenshot_State = ILI9341_SCREENSHOT_IDLE;
+static volatile uint8_t ILI9341_Screenshot_ReadDone;
+static int8_t ILI9341_Screenshot_Handle = -1;
+static uint16_t ILI9341_Screenshot_Band;
+static uint16_t ILI9341_Screenshot_Bands;
+static uint8_t ILI9341_Screenshot_Out;
+static uint8_t ILI9341_Screenshot_Pending;    // ein Bit je Schreibauftrag (Ausgabepuffer 0/1, Dateikopf)
+static uint32_t ILI9341_Screenshot_StartTick;
+static ILI9341_ScreenshotStats ILI9341_Screenshot_Stats;
+
+static void ILI9341_Screenshot_BuildHeader(uint16_t width, uint16_t height);
+static void ILI9341_Screenshot_Convert(uint16_t *dst, const uint8_t *src, uint16_t width);
+static void ILI9341_Screenshot_ReadComplete(void);
+static void ILI9341_Screenshot_Written(FRESULT result, uint32_t bytes, void *context);
+static void ILI9341_Screenshot_Closed(FRESULT result, uint32_t bytes, void *context);
+static void ILI9341_Screenshot_Error(FRESULT result);
+static void ILI9341_Screenshot_Put16(uint8_t *p, uint16_t value);
+static void ILI9341_Screenshot_Put32(uint8_t *p, uint32_t value);
+
+/**
+ * @brief  Belegt den RX-DMA-Stream für SPI1 und meldet den Task an (deaktiviert bis zur ersten Aufnahme)
+ * @param  hspi: SPI-Handle des Displays (&hspi1), bekommt hdmarx
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der ILI9341_Screenshot_Task() aufruft
+ */
+void ILI9341_Screenshot_Init(SPI_HandleTypeDef *hspi, uint8_t taskId) {
+	DMA_HandleTypeDef *hdma = &ILI9341_Screenshot_DmaRx;
+
+	ILI9341_Screenshot_TaskId = taskId;
+	Scheduler_SetEnabled(taskId, 0);
+
+	hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+	hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma->Init.MemInc = DMA_MINC_ENABLE;
+	hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	hdma->Init.Mode = DMA_NORMAL;
+	hdma->Init.Priority = DMA_PRIORITY_LOW;
+	hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (!DmaAlloc_Claim(hdma, DMAALLOC_DMA, DMA_REQUEST_SPI1_RX, IRQ_PRIO_DISPLAY, "SPI1 RX")
+			|| HAL_DMA_Init(hdma) != HAL_OK) {
+		DmaAlloc_Release(hdma);
+		return;    // without hdmarx ILI9341_ReadPixelsAsync() refuses, 'shot' reports the error
+	}
+	__HAL_LINKDMA(hspi, hdmarx, ILI9341_Screenshot_DmaRx);
+}
+
+/**
+ * @brief  Beginnt eine Aufnahme des ganzen Bildschirms nach path
+ * @retval 1, wenn Öffnen und Dateikopf eingereiht sind; 0 wenn schon eine läuft oder die Warteschlange voll ist
+ */
+uint8_t ILI9341_Screenshot_Start(const char *path) {
+	uint16_t width = ILI9341_WIDTH;
+	uint16_t height = ILI9341_HEIGHT;
+
+	if (ILI9341_Screenshot_State != ILI9341_SCREENSHOT_IDLE || ILI9341_Screenshot_TaskId == SCHEDULER_INVALID_TASK
+			|| width > ILI9341_SCREENSHOT_MAX_WIDTH || height % ILI9341_SCREENSHOT_BAND_ROWS != 0) {
+		return 0;
+	}
+	// Room for open, header and the final close, so a started shot can always be closed again
+	if (SDQueue_Pending() + 3 > SDQUEUE_DEPTH) {
+		return 0;
+	}
+
+	ILI9341_Screenshot_Handle = SDQueue_Open(path, FA_WRITE | FA_CREATE_ALWAYS, NULL, NULL);
+	if (ILI9341_Screenshot_Handle < 0) {
+		return 0;
+	}
+	ILI9341_Screenshot_BuildHeader(width, height);
+	SDQueue_Write(ILI9341_Screenshot_Handle, ILI9341_Screenshot_Header, sizeof(ILI9341_Screenshot_Header),
+			ILI9341_Screenshot_Written, (void*)ILI9341_SCREENSHOT_HEADER_SLOT);
+
+	ILI9341_Screenshot_Stats = (ILI9341_ScreenshotStats){0};
+	ILI9341_Screenshot_Stats.bytes = sizeof(ILI9341_Screenshot_Header) + (uint32_t)width * height * 2U;
+	ILI9341_Screenshot_StartTick = HAL_GetTick();
+	ILI9341_Screenshot_Pending = 1U << ILI9341_SCREENSHOT_HEADER_SLOT;
+	ILI9341_Screenshot_Band = 0;
+	ILI9341_Screenshot_Bands = height / ILI9341_SCREENSHOT_BAND_ROWS;
+	ILI9341_Screenshot_Out = 0;
+	ILI9341_Screenshot_State = ILI9341_SCREENSHOT_READ;
+	Scheduler_SetEnabled(ILI9341_Screenshot_TaskId, 1);
+	return 1;
+}
+
+/**
+ * @brief  Läuft noch eine Aufnahme (bis die Datei geschlossen ist)?
+ */
+uint8_t ILI9341_Screenshot_IsBusy(void) {
+	return ILI9341_Screenshot_State != ILI9341_SCREENSHOT_IDLE;
+}
+
+/**
+ * @brief  Ergebnis der letzten abgeschlossenen Aufnahme
+ */
+const ILI9341_ScreenshotStats* ILI9341_Screenshot_GetStats(void) {
+	return &ILI9341_Screenshot_Stats;
+}
+
+/**
+ * @brief  Task: nächstes Band lesen, wandeln und zum Schreiben einreihen
+ */
+void ILI9341_Screenshot_Task(void *context) {
+	uint16_t width = ILI9341_WIDTH;
+	uint8_t out = ILI9341_Screenshot_Out;
+
+	switch (ILI9341_Screenshot_State) {
+		case ILI9341_SCREENSHOT_READ: {
+			if (ILI9341_Screenshot_Stats.result != FR_OK) {
+				ILI9341_Screenshot_State = ILI9341_SCREENSHOT_CLOSE;
+				break;
+			}
+			if ((ILI9341_Screenshot_Pending & (1U << out)) || ILI9341_IsBusy() || ILI9341_IsBatching()) {
+				break;    // retry on the next period
+			}
+
+			uint16_t y = ILI9341_HEIGHT - (ILI9341_Screenshot_Band + 1) * ILI9341_SCREENSHOT_BAND_ROWS;
+			uint32_t size = 1 + (uint32_t)width * ILI9341_SCREENSHOT_BAND_ROWS * 3U;
+
+			ILI9341_Screenshot_ReadDone = 0;
+			if (ILI9341_ReadPixelsAsync(0, y, width - 1, y + ILI9341_SCREENSHOT_BAND_ROWS - 1, ILI9341_Screenshot_Rx,
+					size, ILI9341_Screenshot_ReadComplete) != HAL_OK) {
+				ILI9341_Screenshot_Stats.readErrors++;
+				ILI9341_Screenshot_Error(FR_INT_ERR);
+				ILI9341_Screenshot_State = ILI9341_SCREENSHOT_CLOSE;
+				break;
+			}
+			ILI9341_Screenshot_State = ILI9341_SCREENSHOT_CONVERT;
+			break;
+		}
+
+		case ILI9341_SCREENSHOT_CONVERT:
+			if (!ILI9341_Screenshot_ReadDone) {
+				break;
+			}
+			if (ILI9341_Screenshot_Stats.result != FR_OK) {
+				ILI9341_Screenshot_State = ILI9341_SCREENSHOT_CLOSE;
+				break;
+			}
+			Cache_InvalidateDMA(ILI9341_Screenshot_Rx, sizeof(ILI9341_Screenshot_Rx));
+
+			// Screen rows top to bottom become file rows bottom to top
+			for (uint8_t row = 0; row < ILI9341_SCREENSHOT_BAND_ROWS; row++) {
+				ILI9341_Screenshot_Convert(&ILI9341_Screenshot_Rows[out][(ILI9341_SCREENSHOT_BAND_ROWS - 1 - row) * width],
+						&ILI9341_Screenshot_Rx[1 + (uint32_t)row * width * 3U], width);
+			}
+			ILI9341_Screenshot_State = ILI9341_SCREENSHOT_WRITE;
+			/* fallthrough */
+
+		case ILI9341_SCREENSHOT_WRITE:
+			if (!SDQueue_Write(ILI9341_Screenshot_Handle, ILI9341_Screenshot_Rows[out],
+					(uint32_t)width * ILI9341_SCREENSHOT_BAND_ROWS * 2U, ILI9341_Screenshot_Written,
+					(void*)(uintptr_t)out)) {
+				break;    // queue full, the converted band stays in its buffer
+			}
+			ILI9341_Screenshot_Pending |= 1U << out;
+			ILI9341_Screenshot_Out = out ^ 1;
+			ILI9341_Screenshot_Band++;
+			ILI9341_Screenshot_State = ILI9341_Screenshot_Band < ILI9341_Screenshot_Bands
+					? ILI9341_SCREENSHOT_READ : ILI9341_SCREENSHOT_CLOSE;
+			break;
+
+		case ILI9341_SCREENSHOT_CLOSE:
+			if (ILI9341_Screenshot_Pending == 0
+					&& SDQueue_Close(ILI9341_Screenshot_Handle, ILI9341_Screenshot_Closed, NULL)) {
+				ILI9341_Screenshot_State = ILI9341_SCREENSHOT_CLOSING;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief  Füllt den BMP-Kopf für ein Bild von width x height Pixeln in RGB565
+ */
+static void ILI9341_Screenshot_BuildHeader(uint16_t width, uint16_t height) {
+	uint8_t *h = ILI9341_Screenshot_Header;
+	uint32_t imageSize = (uint32_t)width * height * 2U;    // 640 or 480 bytes per row, already a multiple of 4
+
+	memset(h, 0, sizeof(ILI9341_Screenshot_Header));
+	h[0] = 'B';
+	h[1] = 'M';
+	ILI9341_Screenshot_Put32(&h[2], sizeof(ILI9341_Screenshot_Header) + imageSize);
+	ILI9341_Screenshot_Put32(&h[10], sizeof(ILI9341_Screenshot_Header));
+	ILI9341_Screenshot_Put32(&h[14], 40);                // BITMAPINFOHEADER
+	ILI9341_Screenshot_Put32(&h[18], width);
+	ILI9341_Screenshot_Put32(&h[22], height);            // positive: bottom-up
+	ILI9341_Screenshot_Put16(&h[26], 1);
+	ILI9341_Screenshot_Put16(&h[28], 16);
+	ILI9341_Screenshot_Put32(&h[30], 3);                 // BI_BITFIELDS
+	ILI9341_Screenshot_Put32(&h[34], imageSize);
+	ILI9341_Screenshot_Put32(&h[38], 2835);              // 72 dpi
+	ILI9341_Screenshot_Put32(&h[42], 2835);
+	ILI9341_Screenshot_Put32(&h[54], 0xF800);
+	ILI9341_Screenshot_Put32(&h[58], 0x07E0);
+	ILI9341_Screenshot_Put32(&h[62], 0x001F);
+}
+
+/**
+ * @brief  RGB666 vom Panel (je Byte ein Kanal, Wert in Bit 7..2) nach RGB565 in CPU-Byte-Reihenfolge
+ */
+RAMFUNC static void ILI9341_Screenshot_Convert(uint16_t *dst, const uint8_t *src, uint16_t width) {
+	for (uint16_t x = 0; x < width; x++, src += 3) {
+		dst[x] = ILI9341_Colour_RGB(src[0], src[1], src[2]);
+	}
+}
+
+/**
+ * @brief  Memory Read fertig (SPI-Interrupt)
+ */
+static void ILI9341_Screenshot_ReadComplete(void) {
+	ILI9341_Screenshot_ReadDone = 1;
+	Scheduler_Release(ILI9341_Screenshot_TaskId);
+}
+
+/**
+ * @brief  Schreibauftrag eines Ausgabepuffers oder des Dateikopfs abgeschlossen (context = Bit in Pending)
+ */
+static void ILI9341_Screenshot_Written(FRESULT result, uint32_t bytes, void *context) {
+	ILI9341_Screenshot_Pending &= ~(1U << (uintptr_t)context);
+	if (result != FR_OK) {
+		ILI9341_Screenshot_Error(result);
+	} else if (bytes == 0) {
+		ILI9341_Screenshot_Error(FR_DENIED);    // card full
+	}
+	Scheduler_Release(ILI9341_Screenshot_TaskId);
+}
+
+/**
+ * @brief  Datei geschlossen, Aufnahme beendet
+ */
+static void ILI9341_Screenshot_Closed(FRESULT result, uint32_t bytes, void *context) {
+	ILI9341_Screenshot_Error(result);
+	ILI9341_Screenshot_Stats.durationMs = HAL_GetTick() - ILI9341_Screenshot_StartTick;
+	ILI9341_Screenshot_Handle = -1;
+	ILI9341_Screenshot_State = ILI9341_SCREENSHOT_IDLE;
+	Scheduler_SetEnabled(ILI9341_Screenshot_TaskId, 0);
+}
+
+/**
+ * @brief  Merkt den ersten Fehler; der Task liest danach keine Bänder mehr und schließt die Datei
+ */
+static void ILI9341_Screenshot_Error(FRESULT result) {
+	if (ILI9341_Screenshot_Stats.result == FR_OK) {
+		ILI9341_Screenshot_Stats.result = result;
+	}
+}
+
+static void ILI9341_Screenshot_Put16(uint8_t *p, uint16_t value) {
+	p[0] = value;
+	p[1] = value >> 8;
+}
+
+static void ILI9341_Screenshot_Put32(uint8_t *p, uint32_t value) {
+	p[0] = value;
+	p[1] = value >> 8;
+	p[2] = value >> 16;
+	p[3] = value >> 24;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file    ILI9341_Sprite.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Sprites mit Farbschlüssel oder 1-Bit-Maske und Clipping für das ILI9341-Display
+ *
+ * Ein Sprite wird zeilenweise in deckende Abschnitte zerlegt. Jeder Abschnitt bekommt ein
+ * eigenes Adressfenster (ILI9341_BeginWrite sendet nur die geänderte Hälfte) und seine Pixel
+ * direkt aus dem Quellpuffer; durchsichtige Pixel gehen also nie über SPI1. Abschnitte mit
+ * gleichen Spalten in aufeinanderfolgenden Zeilen, deren Pixel in der Quelle hintereinander
+ * liegen (ganze Zeilen), werden zu einem Fenster zusammengefasst; ein deckendes Sprite ohne
+ * Clipping ist damit eine einzige Übertragung.
+ *
+ * Geschnitten wird am Display und an einem optionalen Clip-Rechteck, Koordinaten dürfen
+ * negativ sein oder über den Rand hinausgehen. Alle Abschnitte eines Aufrufs laufen in einer
+ * Befehlsliste (ILI9341_BeginBatch): kleine Abschnitte werden kopiert, große per DMA direkt
+ * aus der Quelle gesendet. Bei eingeschaltetem Bildpuffer gehen die Abschnitte dorthin,
+ * während einer Kachel-Aufnahme (ILI9341_Tile_Begin) wird das ganze Sprite als ein Befehl
+ * aufgenommen und die Funktionen geben 0 zurück.
+ *
+ * ILI9341_Sprite_Erase() füllt nur die deckenden Pixel mit einer Farbe,
+ * ILI9341_Sprite_Move() davon nur die, die an der neuen Position nicht wieder bedeckt werden.
+ * Ein Mauszeiger über einfarbigem Hintergrund kostet damit nur seine eigenen Pixel.
+ */
+
+#include "ILI9341_Sprite.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_Tile.h"
+
+/**
+ * @brief Gesammeltes Fenster aus einem oder mehreren Abschnitten gleicher Spalten
+ */
+typedef struct {
+	int16_t x;
+	int16_t y;
+	uint16_t width;
+	uint16_t rows;              // 0: leer
+	const uint8_t *pixels;      // Quelle des ersten Abschnitts (nicht beim Füllen)
+	uint8_t fill;               // 1: mit colour füllen statt Pixel senden
+	uint16_t colour;
+	uint32_t count;             // Summe aller Pixel
+} ILI9341_SpriteBlock;
+
+static uint8_t ILI9341_Sprite_Clipped;
+static int16_t ILI9341_Sprite_ClipX1, ILI9341_Sprite_ClipY1, ILI9341_Sprite_ClipX2, ILI9341_Sprite_ClipY2;
+
+static uint32_t ILI9341_Sprite_Walk(const ILI9341_Sprite *sprite, int16_t x, int16_t y,
+		const ILI9341_Sprite *cover, int16_t coverX, int16_t coverY, ILI9341_SpriteBlock *block);
+static void ILI9341_Sprite_Add(ILI9341_SpriteBlock *block, int16_t x, int16_t y, uint16_t count,
+		const uint8_t *pixels);
+static void ILI9341_Sprite_Flush(ILI9341_SpriteBlock *block);
+
+/**
+ * @brief  Setzt ein deckendes Sprite auf
+ * @param  pixels: width * height RGB565-Pixel, High-Byte zuerst
+ */
+void ILI9341_Sprite_Init(ILI9341_Sprite *sprite, uint16_t width, uint16_t height, const uint8_t *pixels) {
+	sprite->width = width;
+	sprite->height = height;
+	sprite->pixels = pixels;
+	sprite->mask = NULL;
+	sprite->key = 0;
+	sprite->mode = ILI9341_SPRITE_OPAQUE;
+}
+
+/**
+ * @brief  Macht alle Pixel mit der Farbe key durchsichtig
+ */
+void ILI9341_Sprite_SetKey(ILI9341_Sprite *sprite, uint16_t key) {
+	sprite->key = key;
+	sprite->mask = NULL;
+	sprite->mode = ILI9341_SPRITE_KEY;
+}
+
+/**
+ * @brief  Verwendet eine 1-Bit-Maske ((width + 7) / 8 Bytes je Zeile, MSB links, 1 = deckend)
+ */
+void ILI9341_Sprite_SetMask(ILI9341_Sprite *sprite, const uint8_t *mask) {
+	sprite->mask = mask;
+	sprite->mode = mask != NULL ? ILI9341_SPRITE_MASK : ILI9341_SPRITE_OPAQUE;
+}
+
+/**
+ * @brief  Begrenzt alle folgenden Sprite-Aufrufe zusätzlich auf ein Rechteck
+ */
+void ILI9341_Sprite_SetClip(int16_t x, int16_t y, uint16_t width, uint16_t height) {
+	ILI9341_Sprite_ClipX1 = x;
+	ILI9341_Sprite_ClipY1 = y;
+	ILI9341_Sprite_ClipX2 = x + (int16_t)width - 1;
+	ILI9341_Sprite_ClipY2 = y + (int16_t)height - 1;
+	ILI9341_Sprite_Clipped = 1;
+}
+
+/**
+ * @brief  Hebt das Clip-Rechteck auf, es wird nur noch am Display geschnitten
+ */
+void ILI9341_Sprite_ResetClip(void) {
+	ILI9341_Sprite_Clipped = 0;
+}
+
+/**
+ * @brief  Zeichnet die deckenden Pixel eines Sprites
+ * @param  x, y: Position der oberen linken Ecke, darf außerhalb des Displays liegen
+ * @retval Anzahl gesendeter Pixel
+ */
+uint32_t ILI9341_Sprite_Draw(const ILI9341_Sprite *sprite, int16_t x, int16_t y) {
+	ILI9341_SpriteBlock block = { .rows = 0, .fill = 0, .count = 0 };
+
+	return ILI9341_Sprite_Walk(sprite, x, y, NULL, 0, 0, &block);
+}
+
+/**
+ * @brief  Füllt die deckenden Pixel eines Sprites mit einer Farbe (Sprite vom Hintergrund löschen)
+ * @retval Anzahl gefüllter Pixel
+ */
+uint32_t ILI9341_Sprite_Erase(const ILI9341_Sprite *sprite, int16_t x, int16_t y, uint16_t colour) {
+	ILI9341_SpriteBlock block = { .rows = 0, .fill = 1, .colour = colour, .count = 0 };
+
+	return ILI9341_Sprite_Walk(sprite, x, y, NULL, 0, 0, &block);
+}
+
+/**
+ * @brief  Verschiebt ein Sprite über einfarbigem Hintergrund
+ *
+ * Gelöscht werden nur die Pixel der alten Position, die an der neuen nicht deckend sind;
+ * beides läuft in derselben Befehlsliste.
+ *
+ * @retval Anzahl gefüllter und gesendeter Pixel
+ */
+uint32_t ILI9341_Sprite_Move(const ILI9341_Sprite *sprite, int16_t fromX, int16_t fromY, int16_t toX, int16_t toY,
+		uint16_t background) {
+	ILI9341_SpriteBlock erase = { .rows = 0, .fill = 1, .colour = background, .count = 0 };
+	ILI9341_SpriteBlock draw = { .rows = 0, .fill = 0, .count = 0 };
+	uint8_t batching = ILI9341_IsBatching();
+
+	if (!batching) ILI9341_BeginBatch();
+	uint32_t count = ILI9341_Sprite_Walk(sprite, fromX, fromY, sprite, toX, toY, &erase);
+	count += ILI9341_Sprite_Walk(sprite, toX, toY, NULL, 0, 0, &draw);
+	if (!batching) ILI9341_EndBatch();
+	return count;
+}
+
+/**
+ * @brief  Zerlegt den sichtbaren Teil eines Sprites in deckende Abschnitte
+ * @param  cover: Sprite an (coverX, coverY), dessen deckende Pixel ausgelassen werden; NULL für keins
+ * @param  block: leerer Block, bestimmt Senden oder Füllen
+ * @retval Anzahl Pixel aller Abschnitte
+ */
+static uint32_t ILI9341_Sprite_Walk(const ILI9341_Sprite *sprite, int16_t x, int16_t y,
+		const ILI9341_Sprite *cover, int16_t coverX, int16_t coverY, ILI9341_SpriteBlock *block) {
+	int16_t x1 = x, y1 = y;
+	int16_t x2 = x + (int16_t)sprite->width - 1, y2 = y + (int16_t)sprite->height - 1;
+
+	if (sprite->width == 0 || sprite->height == 0) return 0;
+
+	// Intersect with the display clip (ILI9341_SetClip) and the sprite clip rectangle
+	int16_t left, top, right, bottom;
+	ILI9341_GetClip(&left, &top, &right, &bottom);
+	if (x1 < left) x1 = left;
+	if (y1 < top) y1 = top;
+	if (x2 > right) x2 = right;
+	if (y2 > bottom) y2 = bottom;
+	if (ILI9341_Sprite_Clipped) {
+		if (x1 < ILI9341_Sprite_ClipX1) x1 = ILI9341_Sprite_ClipX1;
+		if (y1 < ILI9341_Sprite_ClipY1) y1 = ILI9341_Sprite_ClipY1;
+		if (x2 > ILI9341_Sprite_ClipX2) x2 = ILI9341_Sprite_ClipX2;
+		if (y2 > ILI9341_Sprite_ClipY2) y2 = ILI9341_Sprite_ClipY2;
+	}
+	if (x1 > x2 || y1 > y2) return 0;
+
+#ifdef ILI9341_USE_TILES
+	if (ILI9341_Tile_IsRecording()) {
+		// Tiles are rebuilt from the background, the old position of a move needs no erase
+		if (cover != NULL) return 0;
+		if (ILI9341_Tile_Sprite(sprite, x, y, x1, y1, x2, y2, block->fill, block->colour)) return 0;
+	}
+#endif
+
+	uint8_t batching = ILI9341_IsBatching();
+	if (!batching) ILI9341_BeginBatch();
+
+	for (int16_t sy = y1; sy <= y2; sy++) {
+		int16_t row = sy - y;
+		const uint8_t *line = sprite->pixels + (uint32_t)row * sprite->width * 2;
+		int16_t coverRow = sy - coverY;
+		uint8_t coverLine = cover != NULL && coverRow >= 0 && coverRow < (int16_t)cover->height;
+		int16_t sx = x1;
+
+		while (sx <= x2) {
+			int16_t start = -1;
+
+			for (; sx <= x2; sx++) {
+				uint8_t visible = ILI9341_Sprite_IsOpaque(sprite, sx - x, row);
+				if (visible && coverLine) {
+					int16_t coverCol = sx - coverX;
+					if (coverCol >= 0 && coverCol < (int16_t)cover->width && ILI9341_Sprite_IsOpaque(cover, coverCol, coverRow))
+						visible = 0;
+				}
+				if (visible && start < 0) start = sx;
+				if (!visible && start >= 0) break;
+			}
+			if (start >= 0) ILI9341_Sprite_Add(block, start, sy, sx - start, line + (start - x) * 2);
+		}
+	}
+	ILI9341_Sprite_Flush(block);
+
+	if (!batching) ILI9341_EndBatch();
+	return block->count;
+}
+
+/**
+ * @brief  Hängt einen Abschnitt an das offene Fenster an oder sendet es und beginnt ein neues
+ */
+static void ILI9341_Sprite_Add(ILI9341_SpriteBlock *block, int16_t x, int16_t y, uint16_t count,
+		const uint8_t *pixels) {
+	block->count += count;
+
+	if (block->rows > 0 && x == block->x && count == block->width && y == block->y + block->rows
+			&& (block->fill || pixels == block->pixels + (uint32_t)block->rows * block->width * 2)) {
+		block->rows++;
+		return;
+	}
+
+	ILI9341_Sprite_Flush(block);
+	block->x = x;
+	block->y = y;
+	block->width = count;
+	block->rows = 1;
+	block->pixels = pixels;
+}
+
+/**
+ * @brief  Sendet bzw. füllt das offene Fenster
+ */
+static void ILI9341_Sprite_Flush(ILI9341_SpriteBlock *block) {
+	if (block->rows == 0) return;
+
+	if (block->fill) {
+		ILI9341_fillRect(block->x, block->y, block->width, block->rows, block->colour);
+	}
+#ifdef ILI9341_USE_FRAMEBUFFER
+	else if (ILI9341_FB_IsEnabled()) {
+		ILI9341_FB_DrawImage(block->x, block->y, block->width, block->rows, block->pixels);
+	}
+#endif
+	else {
+		ILI9341_BeginWrite(block->x, block->y, block->x + block->width - 1, block->y + block->rows - 1);
+		ILI9341_SendDataAsync(block->pixels, (uint32_t)block->width * block->rows * 2);
+	}
+	block->rows = 0;
+}
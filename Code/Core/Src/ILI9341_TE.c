@@ -0,0 +1,191 @@
+/**
+ * @file    ILI9341_TE.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Tearing-Effect-Signal des ILI9341: Übertragungen an der Austastlücke starten
+ *
+ * Mit TEON (0x35, Modus 0) gibt das Panel zu Beginn jeder vertikalen Austastlücke einen Puls
+ * auf der TE-Leitung aus (DISPLAY_TE, PD11, EXTI steigende Flanke). ILI9341_TE_Callback()
+ * zählt die Flanken und misst die Bildwiederholzeit mit dem DWT-Zähler (bei FrameRateControl()
+ * etwa 79 Hz, also 12,7 ms).
+ *
+ * Bildratenbindung: ILI9341_TE_SetPacing() gibt jede divider-te Flanke einen Scheduler-Task
+ * frei (Scheduler_Release), der Task fragt mit ILI9341_TE_TakeFrame() ab, ob ein Bild fällig
+ * ist. Die UI zeichnet damit direkt nach der Flanke, also bevor der Scan ihre Bereiche erreicht,
+ * und in einem festen Verhältnis zur Panelbildrate statt in einem davon unabhängigen 20-ms-Takt.
+ *
+ * ILI9341_TE_Sync() lässt eine Übertragung an der nächsten Flanke beginnen, wenn die letzte
+ * länger als ILI9341_TE_START_WINDOW_US zurückliegt. ILI9341_FB_Flush() und ILI9341_Tile_End()
+ * rufen es vor dem ersten Block auf. Es wird nichts zusätzlich übertragen, nur der Start
+ * verschoben.
+ *
+ * Grenzen: Ein Vollbild dauert bei 21 MBit/s auf SPI1 etwa 58 ms, also mehr als vier
+ * Panelbilder. Der Scan überholt es, der Riss liegt dann aber immer an derselben Stelle statt
+ * zufällig. Teilbereiche wie Widgets, Sprites und einzelne Kacheln sind geschrieben, bevor der
+ * Scan sie erreicht.
+ *
+ * Kommt ILI9341_TE_TIMEOUT_MS lang keine Flanke (Leitung nicht verbunden), brechen die
+ * Wartefunktionen ab und ILI9341_TE_TakeFrame() meldet jedes Mal ein fälliges Bild. Die UI
+ * läuft dann im Takt ihres Tasks weiter.
+ */
+
+#include "ILI9341_TE.h"
+#include "ILI9341.h"
+#include "Scheduler.h"
+
+#ifdef ILI9341_USE_TE
+
+static volatile uint8_t ILI9341_TE_Active;
+static volatile uint32_t ILI9341_TE_Edges;
+static volatile uint32_t ILI9341_TE_LastCycle;
+static volatile uint32_t ILI9341_TE_LastTick;          // HAL_GetTick() der letzten Flanke, läuft nicht nach 15 s über
+static volatile uint32_t ILI9341_TE_PeriodCycles;      // Gleitender Mittelwert über 8 Flanken
+static volatile uint8_t ILI9341_TE_FramePending;
+static uint8_t ILI9341_TE_Divider = 1;
+static uint8_t ILI9341_TE_Phase;
+static uint8_t ILI9341_TE_Task = SCHEDULER_INVALID_TASK;
+static ILI9341_TEStats ILI9341_TE_Statistics;
+
+static uint8_t ILI9341_TE_IsStalled(void);
+
+/**
+ * @brief  Schaltet das TE-Signal am Panel ein (TEON, nur V-Blank) oder aus (TEOFF)
+ */
+void ILI9341_TE_Enable(uint8_t enable) {
+	uint8_t mode = 0x00;
+
+	if (enable) {
+		ILI9341_SendCommandWithParam_8Bit(0x35, &mode, 1);
+	} else {
+		ILI9341_SendCommand(0x34);
+	}
+
+	__disable_irq();
+	ILI9341_TE_Edges = 0;
+	ILI9341_TE_PeriodCycles = 0;
+	ILI9341_TE_LastCycle = DWT->CYCCNT;
+	ILI9341_TE_LastTick = HAL_GetTick();
+	ILI9341_TE_FramePending = 0;
+	ILI9341_TE_Phase = 0;
+	ILI9341_TE_Statistics = (ILI9341_TEStats){0};
+	ILI9341_TE_Active = enable ? 1 : 0;
+	__enable_irq();
+}
+
+/**
+ * @brief  Prüft, ob das TE-Signal eingeschaltet ist und Flanken liefert
+ */
+uint8_t ILI9341_TE_IsActive(void) {
+	return ILI9341_TE_Active && !ILI9341_TE_IsStalled();
+}
+
+/**
+ * @brief  Flanke der TE-Leitung, wird aus HAL_GPIO_EXTI_Callback() aufgerufen
+ */
+RAMFUNC void ILI9341_TE_Callback(uint16_t GPIO_Pin) {
+	if (GPIO_Pin != DISPLAY_TE_Pin || !ILI9341_TE_Active) return;
+
+	uint32_t now = DWT->CYCCNT;
+	if (ILI9341_TE_Edges > 0) {
+		uint32_t period = now - ILI9341_TE_LastCycle;
+		ILI9341_TE_PeriodCycles = ILI9341_TE_PeriodCycles
+				? ILI9341_TE_PeriodCycles - ILI9341_TE_PeriodCycles / 8 + period / 8 : period;
+	}
+	ILI9341_TE_LastCycle = now;
+	ILI9341_TE_LastTick = HAL_GetTick();
+	ILI9341_TE_Edges++;
+
+	if (++ILI9341_TE_Phase >= ILI9341_TE_Divider) {
+		ILI9341_TE_Phase = 0;
+		ILI9341_TE_Statistics.frames++;
+		if (ILI9341_TE_FramePending) ILI9341_TE_Statistics.missed++;
+		ILI9341_TE_FramePending = 1;
+		if (ILI9341_TE_Task != SCHEDULER_INVALID_TASK) Scheduler_Release(ILI9341_TE_Task);
+	}
+}
+
+/**
+ * @brief  Bindet die UI an die Bildrate des Panels
+ * @param  divider: jede wievielte Flanke ein Bild fällig ist (1 = Panelrate, 2 = halbe Rate, ...)
+ * @param  taskId: Task, der an dieser Flanke freigegeben wird, SCHEDULER_INVALID_TASK für keinen
+ */
+void ILI9341_TE_SetPacing(uint8_t divider, uint8_t taskId) {
+	__disable_irq();
+	ILI9341_TE_Divider = divider ? divider : 1;
+	ILI9341_TE_Phase = 0;
+	ILI9341_TE_Task = taskId;
+	__enable_irq();
+}
+
+/**
+ * @brief  Holt ein fälliges Bild ab
+ * @retval 1, wenn seit dem letzten Aufruf ein Takt der Bildratenbindung kam oder kein TE-Signal anliegt
+ */
+uint8_t ILI9341_TE_TakeFrame(void) {
+	if (!ILI9341_TE_Active || ILI9341_TE_IsStalled()) return 1;
+	if (!ILI9341_TE_FramePending) return 0;
+
+	ILI9341_TE_FramePending = 0;
+	return 1;
+}
+
+/**
+ * @brief  Wartet auf die nächste Flanke
+ * @retval 1 bei Flanke, 0 wenn TE aus ist oder ILI9341_TE_TIMEOUT_MS ohne Flanke verging
+ */
+uint8_t ILI9341_TE_Wait(void) {
+	if (!ILI9341_TE_Active) return 0;
+
+	uint32_t edges = ILI9341_TE_Edges;
+	uint32_t start = DWT->CYCCNT;
+	uint32_t timeout = SystemCoreClock / 1000UL * ILI9341_TE_TIMEOUT_MS;
+
+	while (ILI9341_TE_Edges == edges) {
+		if (DWT->CYCCNT - start > timeout) {
+			ILI9341_TE_Statistics.timeouts++;
+			return 0;
+		}
+	}
+
+	uint32_t us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000UL);
+	ILI9341_TE_Statistics.waits++;
+	if (us > ILI9341_TE_Statistics.waitUsMax) ILI9341_TE_Statistics.waitUsMax = us;
+	return 1;
+}
+
+/**
+ * @brief  Lässt die folgende Übertragung an einer Flanke beginnen
+ *
+ * Liegt die letzte Flanke weniger als ILI9341_TE_START_WINDOW_US zurück (der Aufrufer wurde
+ * von ihr freigegeben), geht es sofort weiter, sonst wird auf die nächste gewartet.
+ */
+void ILI9341_TE_Sync(void) {
+	if (!ILI9341_TE_Active || ILI9341_TE_IsStalled()) return;
+
+	uint32_t window = SystemCoreClock / 1000000UL * ILI9341_TE_START_WINDOW_US;
+	if (DWT->CYCCNT - ILI9341_TE_LastCycle < window) return;
+
+	// Previous transfers must not run into the new frame
+	ILI9341_WaitWhileBusy();
+	ILI9341_TE_Wait();
+}
+
+/**
+ * @brief  Kopiert die Zähler, periodUs aus dem gemittelten Abstand der Flanken
+ */
+void ILI9341_TE_GetStats(ILI9341_TEStats *stats) {
+	__disable_irq();
+	*stats = ILI9341_TE_Statistics;
+	stats->edges = ILI9341_TE_Edges;
+	stats->periodUs = ILI9341_TE_PeriodCycles / (SystemCoreClock / 1000000UL);
+	__enable_irq();
+}
+
+/**
+ * @brief  Prüft, ob seit ILI9341_TE_TIMEOUT_MS keine Flanke kam
+ */
+static uint8_t ILI9341_TE_IsStalled(void) {
+	return HAL_GetTick() - ILI9341_TE_LastTick > ILI9341_TE_TIMEOUT_MS;
+}
+
+#endif /* ILI9341_USE_TE */
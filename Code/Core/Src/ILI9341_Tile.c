@@ -0,0 +1,484 @@
+/**
+ * @file    ILI9341_Tile.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Kachel-Renderer: Bilder mit Überdeckung und Transparenz ohne Framebuffer
+ *
+ * Zwischen ILI9341_Tile_Begin() und ILI9341_Tile_End() zeichnen die ILI9341-Funktionen nicht
+ * zum Display, sondern hängen einen Befehl an eine Liste an (Rechteck, Bild, Zeichen der
+ * Grundschrift, Sprite, halbtransparentes Rechteck). ILI9341_Tile_End() zerlegt das Display in
+ * Kacheln von ILI9341_TILE_SIZE Pixeln, füllt jede mit dem Hintergrund, wendet alle Befehle, die
+ * sie schneiden, in Aufnahmereihenfolge an und sendet sie per DMA. Während eine Kachel über
+ * SPI1 läuft, wird die nächste in den zweiten Puffer gerastert. Der Speicherbedarf hängt damit
+ * nur von der Kachelgröße und der Länge der Befehlsliste ab, nicht von der Displaygröße.
+ *
+ * Ein Bild beschreibt den vollständigen Inhalt des Displays. Für jede Kachel entsteht beim
+ * Aufnehmen eine Prüfsumme über Hintergrund und alle Befehle, die sie schneiden; stimmt sie mit
+ * der des gezeigten Bildes überein, wird die Kachel übersprungen. Ein statisches Bild mit einem
+ * bewegten Sprite überträgt so nur die Kacheln unter der alten und der neuen Position.
+ * Bild-, Sprite- und Zeichendaten werden nur über ihre Adresse erfasst: Ändert sich der Inhalt
+ * eines Puffers bei gleicher Adresse, muss der Bereich mit ILI9341_Tile_Invalidate() gemeldet
+ * werden. Alle Daten müssen bis zum Ende von ILI9341_Tile_End() gültig bleiben.
+ *
+ * Die erste Kachel startet an einer TE-Flanke (ILI9341_TE_Sync), falls das Signal anliegt.
+ *
+ * Läuft die Befehlsliste über, werden die bisherigen Befehle sofort in alle Kacheln gerendert
+ * und der Rest des Bildes direkt gezeichnet; das folgende Bild wird dann vollständig übertragen.
+ * Proportionale Schrift und Bilder von der SD-Karte streamen weiterhin direkt zum Display und
+ * gehören nach ILI9341_Tile_End(). Bei eingeschaltetem Framebuffer startet keine Aufnahme.
+ */
+
+#include "ILI9341_Tile.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_TE.h"
+#include "Cache.h"
+#include <string.h>
+
+#ifdef ILI9341_USE_TILES
+
+#define ILI9341_TILE_HASH_BASIS   2166136261UL
+#define ILI9341_TILE_HASH_PRIME   16777619UL
+
+/**
+ * @brief Art eines aufgenommenen Zeichenbefehls
+ */
+typedef enum {
+	ILI9341_TILE_FILL = 0,      // Rechteck in colour
+	ILI9341_TILE_IMAGE,         // RGB565, High-Byte zuerst (ILI9341_DrawImage)
+	ILI9341_TILE_IMAGE16,       // RGB565 in CPU-Byte-Reihenfolge (ILI9341_DrawImage16)
+	ILI9341_TILE_GLYPH,         // Spalten eines Zeichens der Grundschrift, size-fach skaliert
+	ILI9341_TILE_SPRITE,        // Deckende Pixel eines Sprites (Pixel oder colour)
+	ILI9341_TILE_BLEND          // Rechteck in colour mit Deckkraft alpha über dem Bisherigen
+} ILI9341_TileType;
+
+/**
+ * @brief Ein aufgenommener Zeichenbefehl
+ */
+typedef struct {
+	uint8_t type;               // ILI9341_TileType
+	uint8_t size;               // Zeichen: Skalierung, Sprite: 1 = mit colour füllen, Blend: Deckkraft
+	int16_t x1, y1, x2, y2;     // Sichtbarer Bereich (inklusive, mit ILI9341_GetClip() geschnitten)
+	int16_t ox, oy;             // Obere linke Ecke von Bild, Zeichen und Sprite
+	uint16_t stride;            // Bildbreite in Pixeln
+	uint16_t colour;
+	uint16_t background;
+	const void *data;           // Pixel, Zeichenspalten bzw. ILI9341_Sprite
+} ILI9341_TileCommand;
+
+static ILI9341_TileCommand ILI9341_Tile_Commands[ILI9341_TILE_MAX_COMMANDS];
+static uint16_t ILI9341_Tile_Count;
+static uint8_t ILI9341_Tile_Recording;
+static uint8_t ILI9341_Tile_Overflowed;     // Aufnahme abgebrochen, Rest des Bildes direkt gezeichnet
+static uint16_t ILI9341_Tile_Background;
+static uint8_t ILI9341_Tile_Columns;
+static uint8_t ILI9341_Tile_Rows;
+static uint32_t ILI9341_Tile_Hash[ILI9341_TILE_MAX];    // Prüfsumme des aufgenommenen Bildes
+static uint32_t ILI9341_Tile_Shown[ILI9341_TILE_MAX];   // Prüfsumme auf dem Display, 0 = unbekannt
+static ILI9341_TileStats ILI9341_Tile_Statistics;
+
+/* Ping-Pong-Kachelpuffer, Pixel bereits in Display-Byte-Reihenfolge */
+static uint16_t ILI9341_Tile_Buffer[2][ILI9341_TILE_SIZE * ILI9341_TILE_SIZE] DMA_BUFFER;
+
+static uint8_t ILI9341_Tile_Record(ILI9341_TileCommand *cmd);
+static uint32_t ILI9341_Tile_CommandHash(const ILI9341_TileCommand *cmd);
+static uint16_t ILI9341_Tile_Render(uint8_t force);
+static void ILI9341_Tile_Rasterise(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t *buffer);
+static inline uint16_t ILI9341_Tile_Swap(uint16_t colour);
+static inline uint16_t ILI9341_Tile_Mix(uint16_t back, uint16_t front, uint8_t alpha);
+
+/**
+ * @brief  Beginnt die Aufnahme eines Bildes
+ * @param  background: Farbe aller Pixel, die kein Befehl bedeckt
+ * @retval 1 bei Erfolg, 0 wenn schon aufgenommen wird oder der Framebuffer eingeschaltet ist
+ */
+uint8_t ILI9341_Tile_Begin(uint16_t background) {
+	if (ILI9341_Tile_Recording || ILI9341_Tile_Overflowed) return 0;
+#ifdef ILI9341_USE_FRAMEBUFFER
+	if (ILI9341_FB_IsEnabled()) return 0;
+#endif
+
+	uint8_t columns = (ILI9341_WIDTH + ILI9341_TILE_SIZE - 1) / ILI9341_TILE_SIZE;
+	uint8_t rows = (ILI9341_HEIGHT + ILI9341_TILE_SIZE - 1) / ILI9341_TILE_SIZE;
+	if (columns != ILI9341_Tile_Columns || rows != ILI9341_Tile_Rows) {
+		// Rotation changed: the tile grid no longer matches what is shown
+		ILI9341_Tile_Columns = columns;
+		ILI9341_Tile_Rows = rows;
+		ILI9341_Tile_InvalidateAll();
+	}
+
+	for (uint16_t t = 0; t < (uint16_t)columns * rows; t++) {
+		ILI9341_Tile_Hash[t] = ILI9341_TILE_HASH_BASIS ^ background;
+	}
+	ILI9341_Tile_Background = background;
+	ILI9341_Tile_Count = 0;
+	ILI9341_Tile_Recording = 1;
+	return 1;
+}
+
+/**
+ * @brief  Prüft, ob die Zeichenfunktionen gerade aufgenommen werden
+ */
+uint8_t ILI9341_Tile_IsRecording(void) {
+	return ILI9341_Tile_Recording;
+}
+
+/**
+ * @brief  Beendet die Aufnahme und überträgt alle geänderten Kacheln
+ *
+ * Die letzte Kachel läuft beim Rücksprung noch per DMA (siehe ILI9341_WaitWhileBusy()).
+ *
+ * @retval Anzahl übertragener Kacheln
+ */
+uint16_t ILI9341_Tile_End(void) {
+	uint16_t sent = 0;
+
+	if (ILI9341_Tile_Recording) {
+		ILI9341_Tile_Recording = 0;
+		sent = ILI9341_Tile_Render(0);
+	}
+	else if (!ILI9341_Tile_Overflowed) {
+		return 0;
+	}
+
+	if (ILI9341_Tile_Overflowed) {
+		// Part of the frame went straight to the display, the next one is sent completely
+		ILI9341_Tile_Overflowed = 0;
+		ILI9341_Tile_InvalidateAll();
+	}
+	ILI9341_Tile_Statistics.frames++;
+	return sent;
+}
+
+/**
+ * @brief  Meldet einen Bereich als unbekannt, er wird mit dem nächsten Bild übertragen
+ *
+ * Nötig, wenn sich der Inhalt eines aufgenommenen Puffers bei gleicher Adresse ändert oder am
+ * Renderer vorbei auf das Display gezeichnet wurde.
+ */
+void ILI9341_Tile_Invalidate(int16_t x, int16_t y, int16_t w, int16_t h) {
+	int16_t x2 = x + w - 1, y2 = y + h - 1;
+
+	if (w <= 0 || h <= 0 || ILI9341_Tile_Columns == 0) return;
+	if (x < 0) x = 0;
+	if (y < 0) y = 0;
+	if (x2 >= (int16_t)ILI9341_WIDTH) x2 = ILI9341_WIDTH - 1;
+	if (y2 >= (int16_t)ILI9341_HEIGHT) y2 = ILI9341_HEIGHT - 1;
+	if (x > x2 || y > y2) return;
+
+	for (int16_t ty = y / ILI9341_TILE_SIZE; ty <= y2 / ILI9341_TILE_SIZE; ty++) {
+		for (int16_t tx = x / ILI9341_TILE_SIZE; tx <= x2 / ILI9341_TILE_SIZE; tx++) {
+			ILI9341_Tile_Shown[ty * ILI9341_Tile_Columns + tx] = 0;
+		}
+	}
+}
+
+/**
+ * @brief  Meldet das ganze Display als unbekannt (nach direktem Zeichnen oder Init)
+ */
+void ILI9341_Tile_InvalidateAll(void) {
+	memset(ILI9341_Tile_Shown, 0, sizeof(ILI9341_Tile_Shown));
+}
+
+/**
+ * @brief  Kopiert die Zähler
+ * @param  reset: 1 = anschließend auf 0 setzen
+ */
+void ILI9341_Tile_GetStats(ILI9341_TileStats *stats, uint8_t reset) {
+	*stats = ILI9341_Tile_Statistics;
+	if (reset) memset(&ILI9341_Tile_Statistics, 0, sizeof(ILI9341_Tile_Statistics));
+}
+
+/* --------------------------------- Zeichenbefehle --------------------------------- */
+
+/**
+ * @brief  Nimmt ein gefülltes Rechteck auf
+ * @retval 1 aufgenommen (oder unsichtbar), 0 direkt zeichnen
+ */
+uint8_t ILI9341_Tile_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colour) {
+	ILI9341_TileCommand cmd = { .type = ILI9341_TILE_FILL, .x1 = x, .y1 = y, .x2 = x + w - 1, .y2 = y + h - 1,
+			.colour = colour };
+
+	if (w <= 0 || h <= 0) return 1;
+	return ILI9341_Tile_Record(&cmd);
+}
+
+/**
+ * @brief  Nimmt ein Bild auf (RGB565, High-Byte zuerst); image muss bis ILI9341_Tile_End() gültig bleiben
+ */
+uint8_t ILI9341_Tile_Image(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image) {
+	ILI9341_TileCommand cmd = { .type = ILI9341_TILE_IMAGE, .x1 = x, .y1 = y, .x2 = x + (int16_t)width - 1,
+			.y2 = y + (int16_t)height - 1, .ox = x, .oy = y, .stride = width, .data = image };
+
+	if (width == 0 || height == 0) return 1;
+	return ILI9341_Tile_Record(&cmd);
+}
+
+/**
+ * @brief  Nimmt einen Ausschnitt eines größeren Bildes auf (stride = Zeilenlänge des Bildes in Pixeln)
+ */
+uint8_t ILI9341_Tile_ImageRegion(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image,
+		uint16_t stride) {
+	ILI9341_TileCommand cmd = { .type = ILI9341_TILE_IMAGE, .x1 = x, .y1 = y, .x2 = x + (int16_t)width - 1,
+			.y2 = y + (int16_t)height - 1, .ox = x, .oy = y, .stride = stride, .data = image };
+
+	if (width == 0 || height == 0) return 1;
+	return ILI9341_Tile_Record(&cmd);
+}
+
+/**
+ * @brief  Nimmt ein Bild mit 16-Bit-Pixeln in CPU-Byte-Reihenfolge auf
+ */
+uint8_t ILI9341_Tile_Image16(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint16_t *pixels) {
+	ILI9341_TileCommand cmd = { .type = ILI9341_TILE_IMAGE16, .x1 = x, .y1 = y, .x2 = x + (int16_t)width - 1,
+			.y2 = y + (int16_t)height - 1, .ox = x, .oy = y, .stride = width, .data = pixels };
+
+	if (width == 0 || height == 0) return 1;
+	return ILI9341_Tile_Record(&cmd);
+}
+
+/**
+ * @brief  Nimmt ein Zeichen der Grundschrift auf
+ * @param  width, height: Größe der Zeichenzelle in Pixeln (bereits skaliert)
+ * @param  columns: Spalten des Zeichens, Bit 0 = oberste Zeile (Eintrag in stdfont)
+ */
+uint8_t ILI9341_Tile_Glyph(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t size,
+		const uint8_t *columns, uint16_t colour, uint16_t background) {
+	ILI9341_TileCommand cmd = { .type = ILI9341_TILE_GLYPH, .size = size, .x1 = x, .y1 = y,
+			.x2 = x + (int16_t)width - 1, .y2 = y + (int16_t)height - 1, .ox = x, .oy = y,
+			.colour = colour, .background = background, .data = columns };
+
+	if (size == 0) return 1;
+	return ILI9341_Tile_Record(&cmd);
+}
+
+/**
+ * @brief  Nimmt die deckenden Pixel eines Sprites auf
+ * @param  x, y: Position des Sprites
+ * @param  x1, y1, x2, y2: bereits geschnittener sichtbarer Bereich (ILI9341_Sprite_SetClip)
+ * @param  fill: 1 = deckende Pixel mit colour füllen (ILI9341_Sprite_Erase)
+ */
+uint8_t ILI9341_Tile_Sprite(const ILI9341_Sprite *sprite, int16_t x, int16_t y, int16_t x1, int16_t y1,
+		int16_t x2, int16_t y2, uint8_t fill, uint16_t colour) {
+	ILI9341_TileCommand cmd = { .type = ILI9341_TILE_SPRITE, .size = fill, .x1 = x1, .y1 = y1, .x2 = x2, .y2 = y2,
+			.ox = x, .oy = y, .colour = colour, .data = sprite };
+
+	return ILI9341_Tile_Record(&cmd);
+}
+
+/**
+ * @brief  Nimmt ein halbtransparentes Rechteck auf (nur im Kachelmodus, sonst deckend ab alpha 128)
+ * @param  alpha: Deckkraft 0..255
+ */
+uint8_t ILI9341_Tile_Blend(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colour, uint8_t alpha) {
+	ILI9341_TileCommand cmd = { .type = ILI9341_TILE_BLEND, .size = alpha, .x1 = x, .y1 = y, .x2 = x + w - 1,
+			.y2 = y + h - 1, .colour = colour };
+
+	if (w <= 0 || h <= 0 || alpha == 0) return 1;
+	if (!ILI9341_Tile_Recording) {
+		// Without a tile to blend into there is nothing to read back from the display
+		if (alpha >= 128) ILI9341_fillRect(x, y, w, h, colour);
+		return 1;
+	}
+	return ILI9341_Tile_Record(&cmd);
+}
+
+/* --------------------------------- Aufnahme und Rendern --------------------------------- */
+
+/**
+ * @brief  Schneidet einen Befehl am Display und Clip-Rechteck, hängt ihn an und trägt ihn in die Kachel-Prüfsummen ein
+ * @retval 1 aufgenommen, 0 Liste voll (bisherige Befehle sind gerendert, der Aufrufer zeichnet direkt)
+ */
+static uint8_t ILI9341_Tile_Record(ILI9341_TileCommand *cmd) {
+	int16_t left, top, right, bottom;
+	ILI9341_GetClip(&left, &top, &right, &bottom);
+	if (cmd->x1 < left) cmd->x1 = left;
+	if (cmd->y1 < top) cmd->y1 = top;
+	if (cmd->x2 > right) cmd->x2 = right;
+	if (cmd->y2 > bottom) cmd->y2 = bottom;
+	if (cmd->x1 > cmd->x2 || cmd->y1 > cmd->y2) return 1;
+
+	if (ILI9341_Tile_Count >= ILI9341_TILE_MAX_COMMANDS) {
+		ILI9341_Tile_Statistics.overflows++;
+		ILI9341_Tile_Recording = 0;
+		ILI9341_Tile_Overflowed = 1;
+		ILI9341_Tile_Render(1);
+		return 0;
+	}
+
+	ILI9341_Tile_Commands[ILI9341_Tile_Count++] = *cmd;
+	ILI9341_Tile_Statistics.commands++;
+
+	uint32_t hash = ILI9341_Tile_CommandHash(cmd);
+	for (int16_t ty = cmd->y1 / ILI9341_TILE_SIZE; ty <= cmd->y2 / ILI9341_TILE_SIZE; ty++) {
+		uint32_t *row = &ILI9341_Tile_Hash[ty * ILI9341_Tile_Columns];
+		for (int16_t tx = cmd->x1 / ILI9341_TILE_SIZE; tx <= cmd->x2 / ILI9341_TILE_SIZE; tx++) {
+			row[tx] = (row[tx] ^ hash) * ILI9341_TILE_HASH_PRIME;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief  Prüfsumme über alle Felder eines Befehls (bei Sprites auch über Pixel, Schlüssel und Maske)
+ */
+static uint32_t ILI9341_Tile_CommandHash(const ILI9341_TileCommand *cmd) {
+	uint32_t words[8] = {
+		cmd->type | ((uint32_t)cmd->size << 8) | ((uint32_t)cmd->colour << 16),
+		(uint16_t)cmd->x1 | ((uint32_t)(uint16_t)cmd->y1 << 16),
+		(uint16_t)cmd->x2 | ((uint32_t)(uint16_t)cmd->y2 << 16),
+		(uint16_t)cmd->ox | ((uint32_t)(uint16_t)cmd->oy << 16),
+		cmd->stride | ((uint32_t)cmd->background << 16),
+		(uint32_t)(uintptr_t)cmd->data,
+		0, 0
+	};
+	uint32_t hash = ILI9341_TILE_HASH_BASIS;
+
+	if (cmd->type == ILI9341_TILE_SPRITE) {
+		const ILI9341_Sprite *sprite = cmd->data;
+		words[6] = (uint32_t)(uintptr_t)sprite->pixels ^ (uint32_t)(uintptr_t)sprite->mask;
+		words[7] = sprite->key | ((uint32_t)sprite->mode << 16);
+	}
+	for (uint8_t i = 0; i < 8; i++) {
+		hash = (hash ^ words[i]) * ILI9341_TILE_HASH_PRIME;
+	}
+	return hash;
+}
+
+/**
+ * @brief  Rastert und überträgt die Kacheln
+ * @param  force: 1 = alle Kacheln senden und als unbekannt hinterlassen (Überlauf)
+ * @retval Anzahl übertragener Kacheln
+ */
+static uint16_t ILI9341_Tile_Render(uint8_t force) {
+	uint16_t sent = 0;
+	uint8_t index = 0;
+
+	// Both buffers may still be in flight from the previous frame
+	ILI9341_WaitWhileBusy();
+
+	for (uint8_t ty = 0; ty < ILI9341_Tile_Rows; ty++) {
+		for (uint8_t tx = 0; tx < ILI9341_Tile_Columns; tx++) {
+			uint16_t t = ty * ILI9341_Tile_Columns + tx;
+			uint32_t hash = ILI9341_Tile_Hash[t] | 1;
+
+			if (!force && hash == ILI9341_Tile_Shown[t]) {
+				ILI9341_Tile_Statistics.tilesSkipped++;
+				continue;
+			}
+
+			int16_t x1 = tx * ILI9341_TILE_SIZE, y1 = ty * ILI9341_TILE_SIZE;
+			int16_t x2 = x1 + ILI9341_TILE_SIZE - 1, y2 = y1 + ILI9341_TILE_SIZE - 1;
+			if (x2 >= (int16_t)ILI9341_WIDTH) x2 = ILI9341_WIDTH - 1;
+			if (y2 >= (int16_t)ILI9341_HEIGHT) y2 = ILI9341_HEIGHT - 1;
+
+			// The other buffer is still being sent; BeginWrite waits for it before the window is set
+			ILI9341_Tile_Rasterise(x1, y1, x2, y2, ILI9341_Tile_Buffer[index]);
+			if (sent == 0) ILI9341_TE_Sync();
+			ILI9341_BeginWrite(x1, y1, x2, y2);
+			ILI9341_SendDataAsync((const uint8_t*)ILI9341_Tile_Buffer[index], (uint32_t)(x2 - x1 + 1) * (y2 - y1 + 1) * 2);
+
+			ILI9341_Tile_Shown[t] = force ? 0 : hash;
+			index ^= 1;
+			sent++;
+		}
+	}
+	ILI9341_Tile_Statistics.tilesSent += sent;
+	return sent;
+}
+
+/**
+ * @brief  Füllt eine Kachel mit dem Hintergrund und wendet alle Befehle an, die sie schneiden
+ */
+RAMFUNC static void ILI9341_Tile_Rasterise(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t *buffer) {
+	uint16_t tw = x2 - x1 + 1;
+	uint32_t pixels = (uint32_t)tw * (y2 - y1 + 1);
+	uint16_t background = ILI9341_Tile_Swap(ILI9341_Tile_Background);
+
+	for (uint32_t i = 0; i < pixels; i++) {
+		buffer[i] = background;
+	}
+
+	for (uint16_t n = 0; n < ILI9341_Tile_Count; n++) {
+		const ILI9341_TileCommand *cmd = &ILI9341_Tile_Commands[n];
+		int16_t cx1 = cmd->x1 > x1 ? cmd->x1 : x1;
+		int16_t cy1 = cmd->y1 > y1 ? cmd->y1 : y1;
+		int16_t cx2 = cmd->x2 < x2 ? cmd->x2 : x2;
+		int16_t cy2 = cmd->y2 < y2 ? cmd->y2 : y2;
+		if (cx1 > cx2 || cy1 > cy2) continue;
+
+		uint16_t cw = cx2 - cx1 + 1;
+		uint16_t colour = ILI9341_Tile_Swap(cmd->colour);
+
+		for (int16_t y = cy1; y <= cy2; y++) {
+			uint16_t *dst = &buffer[(uint32_t)(y - y1) * tw + (cx1 - x1)];
+
+			switch (cmd->type) {
+				case ILI9341_TILE_FILL:
+					for (uint16_t i = 0; i < cw; i++) dst[i] = colour;
+					break;
+
+				case ILI9341_TILE_IMAGE: {
+					const uint8_t *src = (const uint8_t*)cmd->data + ((uint32_t)(y - cmd->oy) * cmd->stride + (cx1 - cmd->ox)) * 2;
+					memcpy(dst, src, (uint32_t)cw * 2);
+					break;
+				}
+
+				case ILI9341_TILE_IMAGE16: {
+					const uint16_t *src = (const uint16_t*)cmd->data + (uint32_t)(y - cmd->oy) * cmd->stride + (cx1 - cmd->ox);
+					for (uint16_t i = 0; i < cw; i++) dst[i] = ILI9341_Tile_Swap(src[i]);
+					break;
+				}
+
+				case ILI9341_TILE_GLYPH: {
+					const uint8_t *columns = cmd->data;
+					uint8_t bit = 1 << ((y - cmd->oy) / cmd->size);
+					uint16_t back = ILI9341_Tile_Swap(cmd->background);
+					for (uint16_t i = 0; i < cw; i++) {
+						dst[i] = (columns[(cx1 + i - cmd->ox) / cmd->size] & bit) ? colour : back;
+					}
+					break;
+				}
+
+				case ILI9341_TILE_SPRITE: {
+					const ILI9341_Sprite *sprite = cmd->data;
+					int16_t row = y - cmd->oy;
+					const uint8_t *line = sprite->pixels + ((uint32_t)row * sprite->width) * 2;
+					for (uint16_t i = 0; i < cw; i++) {
+						int16_t col = cx1 + i - cmd->ox;
+						if (!ILI9341_Sprite_IsOpaque(sprite, col, row)) continue;
+						if (cmd->size) dst[i] = colour;
+						else memcpy(&dst[i], line + col * 2, 2);
+					}
+					break;
+				}
+
+				case ILI9341_TILE_BLEND:
+					for (uint16_t i = 0; i < cw; i++) {
+						dst[i] = ILI9341_Tile_Swap(ILI9341_Tile_Mix(ILI9341_Tile_Swap(dst[i]), cmd->colour, cmd->size));
+					}
+					break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief  Tauscht die Bytes eines RGB565-Werts (CPU- <-> Display-Reihenfolge)
+ */
+static inline uint16_t ILI9341_Tile_Swap(uint16_t colour) {
+	return (uint16_t)((colour >> 8) | (colour << 8));
+}
+
+/**
+ * @brief  Mischt zwei RGB565-Farben kanalweise
+ * @param  alpha: Anteil von front, 0..255
+ */
+static inline uint16_t ILI9341_Tile_Mix(uint16_t back, uint16_t front, uint8_t alpha) {
+	uint32_t r = (((front >> 11) & 0x1F) * alpha + ((back >> 11) & 0x1F) * (255 - alpha)) / 255;
+	uint32_t g = (((front >> 5) & 0x3F) * alpha + ((back >> 5) & 0x3F) * (255 - alpha)) / 255;
+	uint32_t b = ((front & 0x1F) * alpha + (back & 0x1F) * (255 - alpha)) / 255;
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+#endif /* ILI9341_USE_TILES */
@@ -0,0 +1,815 @@
+/**
+ * @file    ILI9341_Widget.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Widgets mit gespeichertem Zustand für das ILI9341-Display (Label, Wert, Balken,
+ *          Zeigerinstrument, Button, Liste)
+ *
+ * Jedes Widget merkt sich, was zuletzt auf dem Display steht. Die Setter ändern nur den
+ * gewünschten Zustand; ILI9341_Widget_Render() zeichnet einmal pro Bild alle geänderten Widgets
+ * in einer Befehlsliste (ILI9341_BeginBatch), die im Hintergrund per DMA abläuft.
+ *
+ * Neu gezeichnet wird nur, was sich geändert hat:
+ * - Text (Label, Wert, Button, Zahl im Zeigerinstrument): nur die Zeichenzellen mit anderem
+ *   Zeichen und der frei gewordene Rest. Verschiebt sich der Text um keine ganze Zelle
+ *   (zentriert, ungerade Längenänderung), der ganze Text.
+ * - Balken: nur der Streifen zwischen alter und neuer Länge.
+ * - Zeigerinstrument: alter Zeiger in Hintergrundfarbe, neuer Zeiger, Nabe und Zahl.
+ * - Liste: beim Wechsel der Auswahl ohne Scrollen nur alte und neue Zeile, dazu die mit
+ *   ILI9341_Widget_InvalidateItem() gemeldeten. Die Texte liefert eine Datenquelle nur für die
+ *   sichtbaren Zeilen, so bleiben auch lange Listen (Verzeichnisse, Logs) ohne Speicher für alle
+ *   Einträge. Mit ILI9341_Widget_SetHardwareScroll() verschiebt Scrollen um weniger als eine
+ *   Seite den Inhalt per Scroll-Startzeile (wie ILI9341_Console), gezeichnet werden nur die
+ *   hereingescrollten Zeilen und die Auswahl.
+ * Hintergrund und Rahmen nur nach ILI9341_Widget_Invalidate() bzw. beim ersten Zeichnen.
+ *
+ * Widgets verwenden die Grundschrift (Fonts/5x5_font.h) und müssen vollständig auf dem Display
+ * liegen. Überlappende Widgets werden nicht unterstützt.
+ *
+ * Render misst die Zeichenzeit jedes Widgets mit dem DWT-Zykluszähler und meldet sie dem
+ * Bildtakt (Canvas_FrameCharge()). Überschreitet ein Bild das Budget, nennt Canvas.c das Widget,
+ * das darin am längsten gezeichnet hat; beim nächsten Render wird es ihm als Überschreitung
+ * angerechnet. Die Übertragung läuft als eine Befehlsliste für alle Widgets und zählt je
+ * Display (Canvas_FrameDump()), nicht je Widget.
+ */
+
+#include "ILI9341_Widget.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "Fonts/5x5_font.h"
+#include "Fmt.h"
+#include "FixMath.h"
+#include "Canvas.h"
+#include "Prof.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Halbe Breite des Zeigers am Drehpunkt und Radius der Nabe, in Pixeln */
+#define ILI9341_WIDGET_NEEDLE_BASE   3
+#define ILI9341_WIDGET_HUB_RADIUS    4
+
+/* Skala des Zeigerinstruments: Abschnitte über 270 Grad und Länge der Teilstriche in Pixeln */
+#define ILI9341_WIDGET_GAUGE_TICKS   10
+#define ILI9341_WIDGET_TICK_LENGTH   3
+
+static ILI9341_Widget *ILI9341_Widget_List[ILI9341_WIDGET_MAX];
+static uint8_t ILI9341_Widget_Count;
+static uint32_t ILI9341_Widget_SeenOverruns;    // Canvas_FrameStats.overruns already charged
+
+static const char *const ILI9341_Widget_TypeNames[] = {
+	"Label", "Wert", "Balken", "Zeiger", "Button", "Liste"
+};
+
+static void ILI9341_Widget_DrawText(ILI9341_WidgetText *drawn, const char *text, int16_t x, int16_t y,
+		uint16_t width, uint8_t size, uint8_t align, uint16_t colour, uint16_t background);
+static void ILI9341_Widget_DrawLabel(ILI9341_Widget *widget);
+static void ILI9341_Widget_DrawBar(ILI9341_Widget *widget);
+static void ILI9341_Widget_DrawGauge(ILI9341_Widget *widget);
+static void ILI9341_Widget_DrawButton(ILI9341_Widget *widget);
+static void ILI9341_Widget_DrawList(ILI9341_Widget *widget);
+static void ILI9341_Widget_DrawListRow(ILI9341_Widget *widget, uint8_t row);
+static void ILI9341_Widget_SetupScroll(ILI9341_Widget *widget, uint8_t rows);
+static void ILI9341_Widget_UpdateScroll(const ILI9341_Widget *widget, uint8_t rows);
+static uint8_t ILI9341_Widget_ListRows(const ILI9341_Widget *widget);
+static uint32_t ILI9341_Widget_RowMask(int32_t first, int32_t last, uint8_t rows);
+static uint8_t ILI9341_Widget_ItemSource(void *context, uint16_t index, char *text, uint8_t size);
+static void ILI9341_Widget_Needle(ILI9341_Widget *widget, int16_t angle, uint16_t colour);
+static void ILI9341_Widget_Ticks(int16_t cx, int16_t cy, int16_t r, uint16_t colour);
+static void ILI9341_Widget_Format(ILI9341_Widget *widget);
+static int32_t ILI9341_Widget_Scale(const ILI9341_Widget *widget, int32_t span);
+
+/**
+ * @brief  Setzt ein Widget mit Grundeinstellungen auf: schwarz auf weiß, Rahmen dunkelgrau,
+ *         Schriftgröße 1, linksbündig (Wert rechtsbündig, Button zentriert), Bereich 0 .. 100.
+ * @param  widget: Speicher des Widgets
+ * @param  type: Art des Widgets
+ * @param  x, y: obere linke Ecke
+ * @param  width, height: Größe in Pixeln (Zeigerinstrument: Kreis im kleineren Maß)
+ */
+void ILI9341_Widget_Init(ILI9341_Widget *widget, ILI9341_WidgetType type, int16_t x, int16_t y,
+		uint16_t width, uint16_t height) {
+	memset(widget, 0, sizeof(*widget));
+
+	widget->type = type;
+	widget->x = x;
+	widget->y = y;
+	widget->width = width;
+	widget->height = height;
+	widget->colour = BLACK;
+	widget->background = WHITE;
+	widget->accent = DARKGREY;
+	widget->size = 1;
+	widget->max = 100;
+	widget->unit = "";
+	widget->redraw = 1;
+
+	if (type == ILI9341_WIDGET_VALUE) widget->align = ILI9341_WIDGET_ALIGN_RIGHT;
+	if (type == ILI9341_WIDGET_BUTTON) widget->align = ILI9341_WIDGET_ALIGN_CENTER;
+	if (type == ILI9341_WIDGET_VALUE || type == ILI9341_WIDGET_GAUGE) ILI9341_Widget_Format(widget);
+}
+
+/**
+ * @brief  Setzt Farben und Schriftgröße, das Widget wird vollständig neu gezeichnet
+ * @param  colour: Text, Balken, Zeiger
+ * @param  background: Hintergrund bzw. Zifferblatt
+ * @param  accent: Rahmen, Skala, hervorgehobener Listeneintrag, gedrückter Button
+ * @param  size: Skalierung der Grundschrift
+ */
+void ILI9341_Widget_SetStyle(ILI9341_Widget *widget, uint16_t colour, uint16_t background, uint16_t accent,
+		uint8_t size) {
+	if (size == 0) size = 1;
+	if (widget->colour == colour && widget->background == background && widget->accent == accent
+			&& widget->size == size) return;
+
+	widget->colour = colour;
+	widget->background = background;
+	widget->accent = accent;
+	widget->size = size;
+	widget->redraw = 1;
+}
+
+/**
+ * @brief  Setzt die Ausrichtung des Textes
+ */
+void ILI9341_Widget_SetAlign(ILI9341_Widget *widget, ILI9341_WidgetAlign align) {
+	if (widget->align == align) return;
+
+	widget->align = align;
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Setzt den Text eines Labels oder Buttons, wird auf ILI9341_WIDGET_TEXT_MAX gekürzt
+ */
+void ILI9341_Widget_SetText(ILI9341_Widget *widget, const char *text) {
+	if (strncmp(widget->text, text, ILI9341_WIDGET_TEXT_MAX) == 0) return;
+
+	strncpy(widget->text, text, ILI9341_WIDGET_TEXT_MAX);
+	widget->text[ILI9341_WIDGET_TEXT_MAX] = '\0';
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Setzt den Wertebereich von Balken und Zeigerinstrument
+ */
+void ILI9341_Widget_SetRange(ILI9341_Widget *widget, int32_t min, int32_t max) {
+	if (max <= min) max = min + 1;
+	if (widget->min == min && widget->max == max) return;
+
+	widget->min = min;
+	widget->max = max;
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Setzt die Anzeige der Zahl von Wert und Zeigerinstrument
+ * @param  decimals: Nachkommastellen, value = 215 mit decimals = 1 ergibt "21.5"
+ * @param  unit: Einheit direkt hinter der Zahl (z.B. " C"), muss gültig bleiben; NULL für keine
+ */
+void ILI9341_Widget_SetFormat(ILI9341_Widget *widget, uint8_t decimals, const char *unit) {
+	widget->decimals = decimals > 6 ? 6 : decimals;
+	widget->unit = unit != NULL ? unit : "";
+	ILI9341_Widget_Format(widget);
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Setzt den Wert von Wert, Balken oder Zeigerinstrument
+ */
+void ILI9341_Widget_SetValue(ILI9341_Widget *widget, int32_t value) {
+	if (widget->value == value) return;
+
+	widget->value = value;
+	ILI9341_Widget_Format(widget);
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Setzt den Zustand eines Buttons
+ */
+void ILI9341_Widget_SetPressed(ILI9341_Widget *widget, uint8_t pressed) {
+	pressed = pressed ? 1 : 0;
+	if (widget->pressed == pressed) return;
+
+	widget->pressed = pressed;
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Setzt die Einträge einer Liste, die Auswahl springt auf den ersten Eintrag
+ * @param  items: Texte, müssen gültig bleiben
+ * @param  count: Anzahl Einträge
+ */
+void ILI9341_Widget_SetItems(ILI9341_Widget *widget, const char *const *items, uint16_t count) {
+	ILI9341_Widget_SetSource(widget, ILI9341_Widget_ItemSource, (void*)items, count);
+}
+
+/**
+ * @brief  Setzt die Datenquelle einer Liste, die Auswahl springt auf den ersten Eintrag
+ * @param  source: liefert den Text eines Eintrags, aufgerufen nur für sichtbare Zeilen
+ * @param  context: wird an source durchgereicht
+ * @param  count: Anzahl Einträge
+ */
+void ILI9341_Widget_SetSource(ILI9341_Widget *widget, ILI9341_WidgetSource source, void *context, uint16_t count) {
+	widget->source = source;
+	widget->sourceContext = context;
+	widget->itemCount = count;
+	widget->selected = 0;
+	widget->top = 0;
+	widget->dirtyRows = 0;
+	widget->redraw = 1;
+}
+
+/**
+ * @brief  Ändert die Anzahl Einträge, ohne Auswahl und Position zurückzusetzen (z.B. neue
+ *         Zeilen eines Logs); gezeichnet werden nur die sichtbaren Zeilen ab der Änderung
+ */
+void ILI9341_Widget_SetCount(ILI9341_Widget *widget, uint16_t count) {
+	if (widget->itemCount == count) return;
+
+	uint16_t first = count < widget->itemCount ? count : widget->itemCount;
+	uint8_t rows = ILI9341_Widget_ListRows(widget);
+
+	widget->itemCount = count;
+	if (count == 0) {
+		widget->selected = 0;
+		widget->top = 0;
+	} else if (widget->selected >= count) {
+		widget->selected = count - 1;
+	}
+	if (widget->top > widget->selected) widget->top = widget->selected;
+	widget->dirtyRows |= ILI9341_Widget_RowMask((int32_t)first - widget->shownTop, rows - 1, rows);
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Zeichnet einen Eintrag beim nächsten Render neu, weil sich sein Text geändert hat;
+ *         nicht sichtbare Einträge werden beim Hereinscrollen ohnehin neu gelesen
+ */
+void ILI9341_Widget_InvalidateItem(ILI9341_Widget *widget, uint16_t index) {
+	int32_t row = (int32_t)index - widget->shownTop;
+	uint32_t mask = ILI9341_Widget_RowMask(row, row, ILI9341_Widget_ListRows(widget));
+
+	if (mask == 0) return;
+	widget->dirtyRows |= mask;
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Verschiebt den Inhalt der Liste beim Scrollen per Hardware-Scrolling statt alle
+ *         Zeilen neu zu zeichnen
+ *
+ * Nur im Hochformat ohne Framebuffer und über die volle Breite: Der Scrollbereich des
+ * Controllers umfasst ganze Panelzeilen. Er belegt die Scroll-Register, ILI9341_Console und
+ * ILI9341_Chart dürfen nicht gleichzeitig scrollen.
+ *
+ * @retval 1 wenn eingeschaltet (oder ausgeschaltet wurde), 0 wenn die Lage es nicht erlaubt
+ */
+uint8_t ILI9341_Widget_SetHardwareScroll(ILI9341_Widget *widget, uint8_t enable) {
+	if (!enable) {
+		if (widget->hardwareScroll) {
+			widget->hardwareScroll = 0;
+			widget->redraw = 1;
+			ILI9341_ScrollDisable();
+		}
+		return 1;
+	}
+
+	// The scroll area runs along the panel lines, i.e. the screen rows in portrait
+	if ((ILI9341_GetMemoryAccess() & 0x20) || ILI9341_FB_IsEnabled()) return 0;
+	if (widget->type != ILI9341_WIDGET_LIST || widget->x != 0 || widget->width != ILI9341_WIDTH) return 0;
+	if (widget->y < 0 || widget->y + widget->height > 320 || ILI9341_Widget_ListRows(widget) == 0) return 0;
+
+	widget->hardwareScroll = 1;
+	widget->redraw = 1;
+	return 1;
+}
+
+/**
+ * @brief  Wählt einen Listeneintrag aus und scrollt so, dass er sichtbar ist
+ */
+void ILI9341_Widget_Select(ILI9341_Widget *widget, uint16_t index) {
+	uint8_t rows = ILI9341_Widget_ListRows(widget);
+
+	if (widget->itemCount == 0 || rows == 0) return;
+	if (index >= widget->itemCount) index = widget->itemCount - 1;
+	if (widget->selected == index) return;
+
+	widget->selected = index;
+	if (index < widget->top) widget->top = index;
+	if (index >= widget->top + rows) widget->top = index - rows + 1;
+	widget->changed = 1;
+}
+
+/**
+ * @brief  Meldet ein Widget beim Compositor an; es wird beim nächsten Render gezeichnet
+ * @retval 1 bei Erfolg, 0 wenn ILI9341_WIDGET_MAX erreicht ist
+ */
+uint8_t ILI9341_Widget_Add(ILI9341_Widget *widget) {
+	if (ILI9341_Widget_Count >= ILI9341_WIDGET_MAX) return 0;
+
+	widget->redraw = 1;
+	ILI9341_Widget_List[ILI9341_Widget_Count++] = widget;
+	return 1;
+}
+
+/**
+ * @brief  Zeichnet ein Widget beim nächsten Render vollständig neu (z.B. nachdem etwas anderes
+ *         seinen Bereich übermalt hat)
+ */
+void ILI9341_Widget_Invalidate(ILI9341_Widget *widget) {
+	widget->redraw = 1;
+}
+
+/**
+ * @brief  Zeichnet alle Widgets beim nächsten Render vollständig neu (nach ILI9341_FillScreen ...)
+ */
+void ILI9341_Widget_InvalidateAll(void) {
+	for (uint8_t i = 0; i < ILI9341_Widget_Count; i++) {
+		ILI9341_Widget_List[i]->redraw = 1;
+	}
+}
+
+/**
+ * @brief  Zeichnet alle geänderten Widgets in einer Befehlsliste
+ *
+ * Läuft bereits eine vom Aufrufer begonnene Aufzeichnung, werden die Widgets dort angehängt und
+ * die Liste bleibt offen.
+ *
+ * @retval Anzahl gezeichneter Widgets
+ */
+uint8_t ILI9341_Widget_Render(void) {
+	uint8_t batching = ILI9341_IsBatching();
+	uint8_t count = 0;
+
+	// Frames finish in the background; charge the overrun to the widget Canvas.c has named
+	const Canvas_FrameStats *frame = Canvas_GetFrameStats();
+	if (frame->overruns != ILI9341_Widget_SeenOverruns) {
+		ILI9341_Widget_SeenOverruns = frame->overruns;
+		for (uint8_t i = 0; i < ILI9341_Widget_Count; i++) {
+			if (ILI9341_Widget_List[i] == frame->overrunPart) ILI9341_Widget_List[i]->overruns++;
+		}
+	}
+
+	PROF_BEGIN(PROF_ID_WIDGETS);
+	for (uint8_t i = 0; i < ILI9341_Widget_Count; i++) {
+		ILI9341_Widget *widget = ILI9341_Widget_List[i];
+		if (!widget->redraw && !widget->changed) continue;
+
+		if (count++ == 0 && !batching) ILI9341_BeginBatch();
+
+		uint32_t start = DWT->CYCCNT;
+
+		if (widget->redraw) widget->drawn.valid = 0;
+		switch (widget->type) {
+			case ILI9341_WIDGET_LABEL:
+			case ILI9341_WIDGET_VALUE:
+				ILI9341_Widget_DrawLabel(widget);
+				break;
+			case ILI9341_WIDGET_BAR:
+				ILI9341_Widget_DrawBar(widget);
+				break;
+			case ILI9341_WIDGET_GAUGE:
+				ILI9341_Widget_DrawGauge(widget);
+				break;
+			case ILI9341_WIDGET_BUTTON:
+				ILI9341_Widget_DrawButton(widget);
+				break;
+			case ILI9341_WIDGET_LIST:
+				ILI9341_Widget_DrawList(widget);
+				break;
+		}
+		widget->redraw = 0;
+		widget->changed = 0;
+
+		uint32_t cycles = DWT->CYCCNT - start;
+		widget->renderCycles = cycles;
+		if (cycles > widget->maxRenderCycles) widget->maxRenderCycles = cycles;
+		Canvas_FrameCharge(widget, cycles);
+	}
+
+	if (count > 0 && !batching) ILI9341_EndBatch();
+	PROF_END(PROF_ID_WIDGETS);
+	return count;
+}
+
+/**
+ * @brief  Widget an Position index in der Reihenfolge von ILI9341_Widget_Add()
+ * @retval NULL, wenn es so viele Widgets nicht gibt
+ */
+const ILI9341_Widget* ILI9341_Widget_Get(uint8_t index) {
+	return index < ILI9341_Widget_Count ? ILI9341_Widget_List[index] : NULL;
+}
+
+/**
+ * @brief  Die Widgets mit den meisten Budgetüberschreitungen, bei Gleichstand mit der längsten
+ *         Zeichenzeit zuerst
+ * @param  indices: erhält bis zu max Positionen (ILI9341_Widget_Get())
+ * @retval Anzahl eingetragener Widgets, nur solche, die schon gezeichnet haben
+ */
+uint8_t ILI9341_Widget_GetWorst(uint8_t *indices, uint8_t max) {
+	uint32_t taken = 0;
+	uint8_t n = 0;
+
+	for (; n < max; n++) {
+		int16_t best = -1;
+		for (uint8_t i = 0; i < ILI9341_Widget_Count; i++) {
+			const ILI9341_Widget *w = ILI9341_Widget_List[i];
+			if ((taken & (1UL << i)) || w->maxRenderCycles == 0) continue;
+			if (best < 0) {
+				best = i;
+				continue;
+			}
+			const ILI9341_Widget *b = ILI9341_Widget_List[best];
+			if (w->overruns > b->overruns || (w->overruns == b->overruns && w->maxRenderCycles > b->maxRenderCycles)) {
+				best = i;
+			}
+		}
+		if (best < 0) break;
+		taken |= 1UL << best;
+		indices[n] = (uint8_t)best;
+	}
+	return n;
+}
+
+/**
+ * @brief  Setzt Zeichenzeiten und Überschreitungen aller Widgets zurück
+ */
+void ILI9341_Widget_ResetStats(void) {
+	for (uint8_t i = 0; i < ILI9341_Widget_Count; i++) {
+		ILI9341_Widget_List[i]->renderCycles = 0;
+		ILI9341_Widget_List[i]->maxRenderCycles = 0;
+		ILI9341_Widget_List[i]->overruns = 0;
+	}
+	ILI9341_Widget_SeenOverruns = Canvas_GetFrameStats()->overruns;
+}
+
+/**
+ * @brief  Gibt Zeichenzeit und Überschreitungen je Widget über printf aus, die langsamsten zuerst
+ */
+void ILI9341_Widget_Dump(void) {
+	uint8_t order[ILI9341_WIDGET_MAX];
+	uint8_t n = ILI9341_Widget_GetWorst(order, ILI9341_WIDGET_MAX);
+	uint32_t mhz = SystemCoreClock / 1000000UL;
+
+	printf("%-3s %-7s %9s %10s %10s %8s\n", "Nr", "Art", "Position", "zuletzt", "max [us]", "Überschr.");
+	for (uint8_t k = 0; k < n; k++) {
+		const ILI9341_Widget *w = ILI9341_Widget_List[order[k]];
+		printf("%-3u %-7s %4d,%-4d %10lu %10lu %8lu\n", order[k], ILI9341_Widget_TypeNames[w->type], w->x, w->y,
+				w->renderCycles / mhz, w->maxRenderCycles / mhz, w->overruns);
+	}
+}
+
+/**
+ * @brief  Zeichnet eine Textzeile und überträgt nur geänderte Zeichenzellen
+ *
+ * Ist drawn ungültig oder liegt der neue Text auf einem anderen Zellraster, werden alle
+ * Zeichen gezeichnet und links und rechts davon bis zur Breite mit dem Hintergrund gefüllt.
+ *
+ * @param  drawn: zuletzt gezeichneter Text, wird aktualisiert
+ * @param  x, y, width: Bereich der Zeile (Höhe CHAR_HEIGHT * size)
+ */
+static void ILI9341_Widget_DrawText(ILI9341_WidgetText *drawn, const char *text, int16_t x, int16_t y,
+		uint16_t width, uint8_t size, uint8_t align, uint16_t colour, uint16_t background) {
+	int16_t cell = CHAR_WIDTH * size;
+	int16_t height = CHAR_HEIGHT * size;
+	uint16_t length = strlen(text);
+
+	if (length > width / cell) length = width / cell;
+	if (length > ILI9341_WIDGET_TEXT_MAX) length = ILI9341_WIDGET_TEXT_MAX;
+
+	int16_t origin = x;
+	if (align == ILI9341_WIDGET_ALIGN_CENTER) origin = x + (width - length * cell) / 2;
+	if (align == ILI9341_WIDGET_ALIGN_RIGHT) origin = x + width - length * cell;
+	int16_t end = origin + length * cell;
+
+	if (!drawn->valid || (origin - drawn->shownX) % cell != 0) {
+		if (origin > x) ILI9341_fillRect(x, y, origin - x, height, background);
+		for (uint16_t i = 0; i < length; i++) {
+			ILI9341_DrawChar(text[i], origin + i * cell, y, colour, size, background);
+		}
+		if (end < x + width) ILI9341_fillRect(end, y, x + width - end, height, background);
+	} else {
+		int16_t shownEnd = drawn->shownX + drawn->shownLength * cell;
+		int16_t from = origin < drawn->shownX ? origin : drawn->shownX;
+		int16_t to = end > shownEnd ? end : shownEnd;
+
+		for (int16_t cx = from; cx < to; cx += cell) {
+			char now = (cx >= origin && cx < end) ? text[(cx - origin) / cell] : 0;
+			char old = (cx >= drawn->shownX && cx < shownEnd) ? drawn->shown[(cx - drawn->shownX) / cell] : 0;
+			if (now == old) continue;
+
+			if (now != 0)
+				ILI9341_DrawChar(now, cx, y, colour, size, background);
+			else
+				ILI9341_fillRect(cx, y, cell, height, background);
+		}
+	}
+
+	memcpy(drawn->shown, text, length);
+	drawn->shown[length] = '\0';
+	drawn->shownX = origin;
+	drawn->shownLength = length;
+	drawn->valid = 1;
+}
+
+/**
+ * @brief  Label und Wert: Text senkrecht zentriert, Streifen darüber und darunter nur beim
+ *         vollständigen Neuzeichnen
+ */
+static void ILI9341_Widget_DrawLabel(ILI9341_Widget *widget) {
+	int16_t height = CHAR_HEIGHT * widget->size;
+	int16_t top = (widget->height > height) ? (widget->height - height) / 2 : 0;
+
+	if (widget->redraw) {
+		if (top > 0) ILI9341_fillRect(widget->x, widget->y, widget->width, top, widget->background);
+		int16_t bottom = widget->height - top - height;
+		if (bottom > 0) {
+			ILI9341_fillRect(widget->x, widget->y + top + height, widget->width, bottom, widget->background);
+		}
+	}
+	ILI9341_Widget_DrawText(&widget->drawn, widget->text, widget->x, widget->y + top, widget->width,
+			widget->size, widget->align, widget->colour, widget->background);
+}
+
+/**
+ * @brief  Balken mit 1 Pixel Rahmen; ohne Neuzeichnen nur der Streifen zwischen alter und
+ *         neuer Länge
+ */
+static void ILI9341_Widget_DrawBar(ILI9341_Widget *widget) {
+	int16_t x = widget->x + 1, y = widget->y + 1;
+	int16_t width = widget->width - 2, height = widget->height - 2;
+	int16_t fill = ILI9341_Widget_Scale(widget, width);
+
+	if (width <= 0 || height <= 0) return;
+
+	if (widget->redraw) {
+		ILI9341_DrawRect(widget->x, widget->y, widget->width, widget->height, widget->accent);
+		if (fill > 0) ILI9341_fillRect(x, y, fill, height, widget->colour);
+		if (fill < width) ILI9341_fillRect(x + fill, y, width - fill, height, widget->background);
+	} else if (fill > widget->shownPosition) {
+		ILI9341_fillRect(x + widget->shownPosition, y, fill - widget->shownPosition, height, widget->colour);
+	} else if (fill < widget->shownPosition) {
+		ILI9341_fillRect(x + fill, y, widget->shownPosition - fill, height, widget->background);
+	}
+	widget->shownPosition = fill;
+}
+
+/**
+ * @brief  Rundes Instrument: Zifferblatt, Zeiger von 135 Grad (min) bis 405 Grad (max) im
+ *         Uhrzeigersinn, Zahl in der Lücke unten
+ */
+static void ILI9341_Widget_DrawGauge(ILI9341_Widget *widget) {
+	uint16_t diameter = widget->width < widget->height ? widget->width : widget->height;
+	int16_t r = diameter / 2 - 1;
+	int16_t cx = widget->x + widget->width / 2;
+	int16_t cy = widget->y + widget->height / 2;
+	int16_t angle = 135 + ILI9341_Widget_Scale(widget, 270);
+
+	if (r <= ILI9341_WIDGET_HUB_RADIUS * 2) return;
+
+	// Changed character cells can cover the needle, it is drawn again on top of them
+	uint8_t needle = widget->redraw || angle != widget->shownPosition || strcmp(widget->text, widget->drawn.shown) != 0;
+
+	if (widget->redraw) {
+		ILI9341_DrawFilledCircle(cx, cy, r, widget->background);
+		ILI9341_DrawCircleOutline(cx, cy, r, widget->accent);
+		ILI9341_Widget_Ticks(cx, cy, r, widget->accent);
+	} else if (angle != widget->shownPosition) {
+		// The old needle may cross the number, so the number is drawn again in full
+		ILI9341_Widget_Needle(widget, widget->shownPosition, widget->background);
+		widget->drawn.valid = 0;
+	}
+
+	int16_t textWidth = r;
+	ILI9341_Widget_DrawText(&widget->drawn, widget->text, cx - textWidth / 2, cy + r / 2 - CHAR_HEIGHT * widget->size / 2,
+			textWidth, widget->size, ILI9341_WIDGET_ALIGN_CENTER, widget->colour, widget->background);
+
+	if (needle) {
+		ILI9341_Widget_Needle(widget, angle, widget->colour);
+		ILI9341_DrawFilledCircle(cx, cy, ILI9341_WIDGET_HUB_RADIUS, widget->accent);
+	}
+	widget->shownPosition = angle;
+}
+
+/**
+ * @brief  Zeichnet den Zeiger als Dreieck vom Drehpunkt bis vor die Teilstriche
+ * @param  angle: Winkel in Grad, 0 = rechts, im Uhrzeigersinn
+ */
+static void ILI9341_Widget_Needle(ILI9341_Widget *widget, int16_t angle, uint16_t colour) {
+	uint16_t diameter = widget->width < widget->height ? widget->width : widget->height;
+	int32_t length = diameter / 2 - 3 - ILI9341_WIDGET_TICK_LENGTH;
+	int16_t cx = widget->x + widget->width / 2;
+	int16_t cy = widget->y + widget->height / 2;
+	int16_t X[3], Y[3];
+	int32_t s, c;
+
+	FixMath_SinCos(FixMath_Degrees(angle), &s, &c);
+	X[0] = cx + (int16_t)FixMath_Scale(c, length);
+	Y[0] = cy + (int16_t)FixMath_Scale(s, length);
+	X[1] = cx + (int16_t)FixMath_Scale(-s, ILI9341_WIDGET_NEEDLE_BASE);
+	Y[1] = cy + (int16_t)FixMath_Scale(c, ILI9341_WIDGET_NEEDLE_BASE);
+	X[2] = cx - (X[1] - cx);
+	Y[2] = cy - (Y[1] - cy);
+	ILI9341_FillPolygon(X, Y, 3, colour);
+}
+
+/**
+ * @brief  Teilstriche der Skala von 135 bis 405 Grad innen am Rand des Zifferblatts
+ */
+static void ILI9341_Widget_Ticks(int16_t cx, int16_t cy, int16_t r, uint16_t colour) {
+	int32_t angles[ILI9341_WIDGET_GAUGE_TICKS + 1];
+	int32_t s[ILI9341_WIDGET_GAUGE_TICKS + 1], c[ILI9341_WIDGET_GAUGE_TICKS + 1];
+
+	for (uint8_t i = 0; i <= ILI9341_WIDGET_GAUGE_TICKS; i++) {
+		angles[i] = FixMath_Degrees(135 + (270 * i) / ILI9341_WIDGET_GAUGE_TICKS);
+	}
+	FixMath_SinCosBatch(angles, s, c, ILI9341_WIDGET_GAUGE_TICKS + 1);
+
+	for (uint8_t i = 0; i <= ILI9341_WIDGET_GAUGE_TICKS; i++) {
+		int32_t outer = r - 1, inner = r - ILI9341_WIDGET_TICK_LENGTH;
+		ILI9341_DrawLine(cx + FixMath_Scale(c[i], inner), cy + FixMath_Scale(s[i], inner),
+				cx + FixMath_Scale(c[i], outer), cy + FixMath_Scale(s[i], outer), colour);
+	}
+}
+
+/**
+ * @brief  Button: abgerundetes Rechteck mit Rahmen, gedrückt mit accent gefüllt und Text in
+ *         der Hintergrundfarbe; ändert sich nur der Text, nur die Zeichenzellen
+ */
+static void ILI9341_Widget_DrawButton(ILI9341_Widget *widget) {
+	uint16_t radius = widget->height / 4;
+	uint16_t fill = widget->pressed ? widget->accent : widget->background;
+	uint16_t colour = widget->pressed ? widget->background : widget->colour;
+	int16_t height = CHAR_HEIGHT * widget->size;
+
+	if (radius > 8) radius = 8;
+	if (widget->width <= 2 * radius + 2 || widget->height < height + 2) return;
+
+	if (widget->redraw || widget->pressed != widget->shownPressed) {
+		ILI9341_DrawRoundedRectWithBorder(widget->x, widget->y, widget->width, widget->height, radius,
+				fill, widget->accent, 1);
+		widget->drawn.valid = 0;
+	}
+	ILI9341_Widget_DrawText(&widget->drawn, widget->text, widget->x + radius + 1,
+			widget->y + (widget->height - height) / 2, widget->width - 2 * radius - 2, widget->size,
+			widget->align, colour, fill);
+	widget->shownPressed = widget->pressed;
+}
+
+/**
+ * @brief  Liste: alle sichtbaren Zeilen nach Neuzeichnen oder weitem Scrollen, sonst nur die
+ *         geänderten Zeilen, die alte und die neue Auswahl und mit Hardware-Scrolling die
+ *         hereingescrollten Zeilen
+ */
+static void ILI9341_Widget_DrawList(ILI9341_Widget *widget) {
+	int16_t rowHeight = CHAR_HEIGHT * widget->size + ILI9341_WIDGET_LIST_PAD;
+	uint8_t rows = ILI9341_Widget_ListRows(widget);
+	int32_t delta = (int32_t)widget->top - widget->shownTop;
+	uint32_t dirty = widget->dirtyRows;
+
+	if (widget->redraw) {
+		ILI9341_Widget_SetupScroll(widget, rows);
+		dirty = ILI9341_Widget_RowMask(0, rows - 1, rows);
+		int16_t rest = widget->height - rows * rowHeight;
+		if (rest > 0) {
+			ILI9341_fillRect(widget->x, widget->y + rows * rowHeight, widget->width, rest, widget->background);
+		}
+	} else if (delta != 0 && widget->hardwareScroll && delta > -rows && delta < rows) {
+		// Rows still on screen move with the scroll start line, only the new ones are read
+		uint16_t area = rows * rowHeight;
+		widget->scrollOffset = (widget->scrollOffset + (delta + rows) * rowHeight) % area;
+		if (delta > 0) {
+			dirty = (dirty >> delta) | ILI9341_Widget_RowMask(rows - delta, rows - 1, rows);
+		} else {
+			dirty = (dirty << -delta) | ILI9341_Widget_RowMask(0, -delta - 1, rows);
+		}
+	} else if (delta != 0) {
+		dirty = ILI9341_Widget_RowMask(0, rows - 1, rows);
+	}
+
+	if (widget->selected != widget->shownSelected) {
+		dirty |= ILI9341_Widget_RowMask((int32_t)widget->shownSelected - widget->top,
+				(int32_t)widget->shownSelected - widget->top, rows);
+		dirty |= ILI9341_Widget_RowMask((int32_t)widget->selected - widget->top,
+				(int32_t)widget->selected - widget->top, rows);
+	}
+	for (uint8_t row = 0; row < rows; row++) {
+		if (dirty & (1UL << row)) ILI9341_Widget_DrawListRow(widget, row);
+	}
+	if (widget->hardwareScroll && (widget->redraw || delta != 0)) {
+		ILI9341_Widget_UpdateScroll(widget, rows);
+	}
+
+	widget->dirtyRows = 0;
+	widget->shownTop = widget->top;
+	widget->shownSelected = widget->selected;
+}
+
+/**
+ * @brief  Legt den Scrollbereich auf die Zeilen der Liste, die oberste Zeile liegt wieder bei y
+ */
+static void ILI9341_Widget_SetupScroll(ILI9341_Widget *widget, uint8_t rows) {
+	uint16_t area = rows * (CHAR_HEIGHT * widget->size + ILI9341_WIDGET_LIST_PAD);
+
+	widget->scrollOffset = 0;
+	if (!widget->hardwareScroll) return;
+
+	// With MY the panel lines count from the bottom edge
+	uint16_t first = (ILI9341_GetMemoryAccess() & 0x80) ? 320 - widget->y - area : widget->y;
+	if (ILI9341_ScrollDefine(first, area, 320 - first - area) != HAL_OK) {
+		widget->hardwareScroll = 0;
+	}
+}
+
+/**
+ * @brief  Zeigt die Zeile bei scrollOffset oben in der Liste: Startzeile des Scrollbereichs setzen
+ */
+static void ILI9341_Widget_UpdateScroll(const ILI9341_Widget *widget, uint8_t rows) {
+	uint16_t area = rows * (CHAR_HEIGHT * widget->size + ILI9341_WIDGET_LIST_PAD);
+
+	if (ILI9341_GetMemoryAccess() & 0x80) {
+		ILI9341_ScrollTo(320 - widget->y - area + (area - widget->scrollOffset) % area);
+	} else {
+		ILI9341_ScrollTo(widget->y + widget->scrollOffset);
+	}
+}
+
+/**
+ * @brief  Anzahl ganz sichtbarer Zeilen einer Liste
+ */
+static uint8_t ILI9341_Widget_ListRows(const ILI9341_Widget *widget) {
+	uint16_t rows = widget->height / (CHAR_HEIGHT * widget->size + ILI9341_WIDGET_LIST_PAD);
+	return rows > ILI9341_WIDGET_LIST_ROWS ? ILI9341_WIDGET_LIST_ROWS : rows;
+}
+
+/**
+ * @brief  Bitmaske der Zeilen first .. last, begrenzt auf 0 .. rows-1
+ */
+static uint32_t ILI9341_Widget_RowMask(int32_t first, int32_t last, uint8_t rows) {
+	if (first < 0) first = 0;
+	if (last >= rows) last = rows - 1;
+	if (first > last) return 0;
+
+	uint32_t upper = (last >= 31) ? 0xFFFFFFFFUL : (2UL << last) - 1;
+	return upper & ~((1UL << first) - 1);
+}
+
+/**
+ * @brief  Zeichnet eine sichtbare Zeile, leere Zeilen unter dem letzten Eintrag im Hintergrund
+ */
+static void ILI9341_Widget_DrawListRow(ILI9341_Widget *widget, uint8_t row) {
+	int16_t rowHeight = CHAR_HEIGHT * widget->size + ILI9341_WIDGET_LIST_PAD;
+	uint16_t area = ILI9341_Widget_ListRows(widget) * rowHeight;
+	int16_t y = widget->y + (widget->scrollOffset + row * rowHeight) % area;
+	uint32_t index = (uint32_t)widget->top + row;
+	uint8_t selected = index == widget->selected;
+	uint16_t fill = selected ? widget->accent : widget->background;
+	uint16_t colour = selected ? widget->background : widget->colour;
+	ILI9341_WidgetText drawn = { .valid = 0 };
+	char text[ILI9341_WIDGET_TEXT_MAX + 1];
+
+	if (index >= widget->itemCount) {
+		ILI9341_fillRect(widget->x, y, widget->width, rowHeight, widget->background);
+		return;
+	}
+
+	if (!widget->source(widget->sourceContext, index, text, sizeof(text))) text[0] = '\0';
+	ILI9341_fillRect(widget->x, y, widget->width, ILI9341_WIDGET_LIST_PAD / 2, fill);
+	ILI9341_Widget_DrawText(&drawn, text, widget->x + 2, y + ILI9341_WIDGET_LIST_PAD / 2,
+			widget->width - 2, widget->size, ILI9341_WIDGET_ALIGN_LEFT, colour, fill);
+	ILI9341_fillRect(widget->x, y + ILI9341_WIDGET_LIST_PAD / 2, 2, CHAR_HEIGHT * widget->size, fill);
+	ILI9341_fillRect(widget->x, y + rowHeight - ILI9341_WIDGET_LIST_PAD / 2, widget->width,
+			ILI9341_WIDGET_LIST_PAD - ILI9341_WIDGET_LIST_PAD / 2, fill);
+}
+
+/**
+ * @brief  Datenquelle von ILI9341_Widget_SetItems(): Texte aus einem Feld
+ */
+static uint8_t ILI9341_Widget_ItemSource(void *context, uint16_t index, char *text, uint8_t size) {
+	Fmt_Buffer b;
+	Fmt_Init(&b, text, size);
+	Fmt_Str(&b, ((const char *const *)context)[index]);
+	return 1;
+}
+
+/**
+ * @brief  Schreibt value als Festkomma mit Einheit in den Text von Wert und Zeigerinstrument
+ */
+static void ILI9341_Widget_Format(ILI9341_Widget *widget) {
+	if (widget->type != ILI9341_WIDGET_VALUE && widget->type != ILI9341_WIDGET_GAUGE) return;
+
+	Fmt_Buffer b;
+	Fmt_Init(&b, widget->text, sizeof(widget->text));
+	Fmt_Fixed(&b, widget->value, widget->decimals, 0);
+	Fmt_Str(&b, widget->unit);
+}
+
+/**
+ * @brief  Bildet value aus min .. max auf 0 .. span ab (begrenzt)
+ */
+static int32_t ILI9341_Widget_Scale(const ILI9341_Widget *widget, int32_t span) {
+	if (widget->value <= widget->min) return 0;
+	if (widget->value >= widget->max) return span;
+	return (int32_t)((int64_t)(widget->value - widget->min) * span / (widget->max - widget->min));
+}
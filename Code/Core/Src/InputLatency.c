@@ -0,0 +1,164 @@
+/**
+ * @file    InputLatency.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Eingabe bis Bild: Zeit vom Joystick-Druck bis die neue Statuszeile beim TFT ist
+ *
+ * UserInput_Interrupt() stempelt jede Flanke schon im EXTI-Interrupt (event.timeUs). Setzt
+ * Task_UserInput() daraufhin den Text der Statuszeile, übergibt es den Stempel mit
+ * InputLatency_Arm(). Die Messung läuft dann durch drei Stellen:
+ * - Arm: Task_UserInput() hat das Ereignis aus der Warteschlange geholt
+ * - Flush: Canvas_FrameFlush() startet das TFT mit dem nächsten Bild, das den Text enthält;
+ *   sendet das TFT zu diesem Takt noch, bleibt die Messung für den folgenden stehen
+ * - Photon: der Abschluss-Callback meldet den letzten DMA-Block des TFT (im Interrupt)
+ * Erst danach zeigt das Panel den Text mit seinem nächsten Bilddurchlauf, das kommt noch
+ * hinzu (bis zu einer Bildperiode, ca. 16 ms bei 61 Hz) und ist hier nicht enthalten.
+ *
+ * Es gibt je eine Messung in Arbeit und eine im Flug. Kommen vor dem Bild weitere Eingaben,
+ * gilt die älteste Flanke, die übrigen zählen als merged: sie erscheinen im selben Bild.
+ *
+ * Zeitstempel sind Timebase_Us32() (TIM5, 1 µs), der ganze Weg braucht Millisekunden; Differenzen
+ * vorzeichenlos.
+ */
+
+#include "InputLatency.h"
+
+#if INPUT_LATENCY_ENABLE
+
+#include "Timebase.h"
+#include <stdio.h>
+
+typedef struct {
+	uint8_t valid;
+	uint32_t edgeUs;
+	uint32_t handledUs;
+	uint32_t flushUs;
+} InputLatency_Sample;
+
+/* In Arbeit (Hauptschleife) und im Flug (vom Start des TFT bis zum Callback) */
+static InputLatency_Sample InputLatency_Pending;
+static volatile InputLatency_Sample InputLatency_InFlight;
+
+static InputLatency_Stats InputLatency_Statistics = { .minUs = UINT32_MAX };
+
+static const char *const InputLatency_StageName[INPUT_LATENCY_STAGES] = {
+	"Warteschlange", "Bildtakt", "Übertragung"
+};
+
+/**
+ * @brief  Merkt die Flanke einer Eingabe, die die Anzeige ändert; aus der Hauptschleife
+ * @param  edgeUs: Zeitstempel der Flanke (untere 32 Bit von event.timeUs)
+ */
+void InputLatency_Arm(uint32_t edgeUs) {
+	if (InputLatency_Pending.valid) {
+		InputLatency_Statistics.merged++;
+		return;
+	}
+	InputLatency_Pending.edgeUs = edgeUs;
+	InputLatency_Pending.handledUs = Timebase_Us32();
+	InputLatency_Pending.valid = 1;
+}
+
+/**
+ * @brief  Das TFT startet ein Bild; aus Canvas_FrameFlush() mit gesperrten Interrupts
+ */
+void InputLatency_Flush(void) {
+	if (!InputLatency_Pending.valid || InputLatency_InFlight.valid) return;
+
+	InputLatency_InFlight.edgeUs = InputLatency_Pending.edgeUs;
+	InputLatency_InFlight.handledUs = InputLatency_Pending.handledUs;
+	InputLatency_InFlight.flushUs = Timebase_Us32();
+	InputLatency_InFlight.valid = 1;
+	InputLatency_Pending.valid = 0;
+}
+
+/**
+ * @brief  Das TFT hat das Bild vollständig übertragen; aus dem Interrupt oder mit gesperrten Interrupts
+ */
+void InputLatency_Photon(void) {
+	if (!InputLatency_InFlight.valid) return;
+
+	uint32_t nowUs = Timebase_Us32();
+	uint32_t stageUs[INPUT_LATENCY_STAGES] = {
+		InputLatency_InFlight.handledUs - InputLatency_InFlight.edgeUs,
+		InputLatency_InFlight.flushUs - InputLatency_InFlight.handledUs,
+		nowUs - InputLatency_InFlight.flushUs
+	};
+	uint32_t totalUs = nowUs - InputLatency_InFlight.edgeUs;
+	InputLatency_InFlight.valid = 0;
+
+	InputLatency_Stats *s = &InputLatency_Statistics;
+	s->count++;
+	s->sumUs += totalUs;
+	if (totalUs < s->minUs) s->minUs = totalUs;
+	if (totalUs > s->maxUs) s->maxUs = totalUs;
+	for (uint8_t i = 0; i < INPUT_LATENCY_STAGES; i++) {
+		s->stageSumUs[i] += stageUs[i];
+		if (stageUs[i] > s->stageMaxUs[i]) s->stageMaxUs[i] = stageUs[i];
+	}
+	uint32_t bin = totalUs / INPUT_LATENCY_BIN_US;
+	s->bins[bin < INPUT_LATENCY_BINS ? bin : INPUT_LATENCY_BINS - 1]++;
+}
+
+void InputLatency_Reset(void) {
+	__disable_irq();
+	InputLatency_Statistics = (InputLatency_Stats){ .minUs = UINT32_MAX };
+	InputLatency_Pending.valid = 0;
+	InputLatency_InFlight.valid = 0;
+	__enable_irq();
+}
+
+const InputLatency_Stats* InputLatency_GetStats(void) {
+	return &InputLatency_Statistics;
+}
+
+/**
+ * @brief  Obere Grenze des Eimers, in dem das Perzentil liegt; im letzten Eimer das Maximum
+ */
+static uint32_t InputLatency_Percentile(const InputLatency_Stats *s, uint8_t percent) {
+	uint32_t rank = (s->count * percent + 99) / 100;
+	uint32_t seen = 0;
+
+	for (uint8_t i = 0; i < INPUT_LATENCY_BINS - 1; i++) {
+		seen += s->bins[i];
+		if (seen >= rank) {
+			uint32_t upperUs = (i + 1) * INPUT_LATENCY_BIN_US;
+			return upperUs < s->maxUs ? upperUs : s->maxUs;
+		}
+	}
+	return s->maxUs;
+}
+
+/**
+ * @brief  Verteilung der Gesamtzeit und der Abschnitte auf der Konsole
+ */
+void InputLatency_Dump(void) {
+	__disable_irq();
+	InputLatency_Stats s = InputLatency_Statistics;
+	__enable_irq();
+
+	if (s.count == 0) {
+		printf("Eingabe bis Bild: noch keine Messung (Joystick drücken), %lu zusammengefasst\n", s.merged);
+		return;
+	}
+
+	printf("Eingabe bis Bild: %lu Messungen, %lu Eingaben zusammengefasst\n", s.count, s.merged);
+	printf("  min %lu us, mittel %lu us, p50 <= %lu us, p90 <= %lu us, p99 <= %lu us, max %lu us\n",
+			s.minUs, (uint32_t)(s.sumUs / s.count), InputLatency_Percentile(&s, 50),
+			InputLatency_Percentile(&s, 90), InputLatency_Percentile(&s, 99), s.maxUs);
+	for (uint8_t i = 0; i < INPUT_LATENCY_STAGES; i++) {
+		printf("  %-14s mittel %6lu us, max %6lu us\n", InputLatency_StageName[i],
+				(uint32_t)(s.stageSumUs[i] / s.count), s.stageMaxUs[i]);
+	}
+	for (uint8_t i = 0; i < INPUT_LATENCY_BINS; i++) {
+		if (s.bins[i] == 0) continue;
+		if (i == INPUT_LATENCY_BINS - 1) {
+			printf("  >= %3lu ms %6lu\n", i * INPUT_LATENCY_BIN_US / 1000, s.bins[i]);
+		} else {
+			printf("  %3lu-%3lu ms %6lu\n", i * INPUT_LATENCY_BIN_US / 1000,
+					(i + 1) * INPUT_LATENCY_BIN_US / 1000, s.bins[i]);
+		}
+	}
+}
+
+#endif /* INPUT_LATENCY_ENABLE */
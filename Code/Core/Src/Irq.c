@@ -0,0 +1,234 @@
+/**
+ * @file    Irq.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Prioritätenplan des NVIC und Laufzeit-/Latenzmessung der Interrupt-Handler
+ *
+ * Irq_Init() setzt die Prioritäten aus Irq.h für alle Interrupts, die CubeMX einschaltet, und
+ * wird in main() direkt nach den MX_*_Init()-Aufrufen aufgerufen. Die Werte im .ioc bleiben 0/0,
+ * damit es nur eine Stelle gibt, an der der Plan steht.
+ *
+ * Mit IRQ_STAT_ENABLE misst jeder Handler in stm32h7xx_it.c mit IRQ_ENTER()/IRQ_EXIT() seine
+ * Laufzeit in CPU-Takten. Verschachtelte Interrupts werden herausgerechnet: Irq_Inner summiert
+ * die Laufzeit aller beendeten Handler, ein Handler zieht beim Verlassen den Zuwachs seit seinem
+ * Eintritt ab und setzt die Summe auf den Stand beim Eintritt plus seine eigene Gesamtdauer. So
+ * bekommt der unterbrochene Handler darüber genau einmal die Zeit des inneren gutgeschrieben.
+ *
+ * Die Latenz (Ereignis bis erste Anweisung des Handlers) kennt die Hardware nur beim TIM7-Tick:
+ * der Zähler läuft ab dem Update-Ereignis von 0 weiter, sein Stand beim Eintritt ist also die
+ * Verzögerung in Mikrosekunden (REALTIME_COUNTER_HZ). Die DMA-Streams misst DmaAlloc.c je
+ * Stream mit Irq_Leave().
+ */
+
+#include "Irq.h"
+#include "Realtime.h"
+#include <stdio.h>
+
+typedef struct {
+	IRQn_Type irq;
+	uint32_t priority;
+} Irq_Priority;
+
+/* Alle von CubeMX eingeschalteten Interrupts; DMA-Streams mit der Stufe ihrer Peripherie */
+static const Irq_Priority Irq_Plan[] = {
+	{ TIM1_BRK_IRQn,       IRQ_PRIO_WS2812 },
+	{ TIM1_UP_IRQn,        IRQ_PRIO_WS2812 },
+	{ TIM1_TRG_COM_IRQn,   IRQ_PRIO_WS2812 },
+	{ TIM1_CC_IRQn,        IRQ_PRIO_WS2812 },
+	{ DMA2_Stream7_IRQn,   IRQ_PRIO_WS2812 },
+	{ TIM7_IRQn,           IRQ_PRIO_REALTIME },
+	{ TIM5_IRQn,           IRQ_PRIO_REALTIME },
+	{ EXTI9_5_IRQn,        IRQ_PRIO_REALTIME },
+	{ EXTI15_10_IRQn,      IRQ_PRIO_REALTIME },
+	{ RTC_WKUP_IRQn,       IRQ_PRIO_REALTIME },
+	{ UART4_IRQn,          IRQ_PRIO_REALTIME },
+	{ ADC_IRQn,            IRQ_PRIO_ADC },
+	{ DMA1_Stream0_IRQn,   IRQ_PRIO_ADC },
+	{ FDCAN1_IT0_IRQn,     IRQ_PRIO_CAN },
+	{ LPUART1_IRQn,        IRQ_PRIO_SHELL },
+	{ BDMA2_Channel0_IRQn, IRQ_PRIO_SHELL },
+	{ BDMA2_Channel1_IRQn, IRQ_PRIO_SHELL },
+	{ OTG_HS_IRQn,         IRQ_PRIO_SHELL },
+	{ SPI1_IRQn,           IRQ_PRIO_DISPLAY },
+	{ DMA2_Stream6_IRQn,   IRQ_PRIO_DISPLAY },
+	{ SPI4_IRQn,           IRQ_PRIO_DISPLAY },
+	{ DMA1_Stream2_IRQn,   IRQ_PRIO_DISPLAY },
+	{ SDMMC1_IRQn,         IRQ_PRIO_STORAGE },
+	{ OCTOSPI1_IRQn,       IRQ_PRIO_STORAGE },
+	{ MDMA_IRQn,           IRQ_PRIO_STORAGE },
+	{ I2C1_EV_IRQn,        IRQ_PRIO_I2C },
+	{ I2C1_ER_IRQn,        IRQ_PRIO_I2C },
+	{ DMA2_Stream5_IRQn,   IRQ_PRIO_I2C },
+	{ I2C2_EV_IRQn,        IRQ_PRIO_I2C },
+	{ I2C2_ER_IRQn,        IRQ_PRIO_I2C },
+	{ UART7_IRQn,          IRQ_PRIO_LOG },
+	{ DMA1_Stream1_IRQn,   IRQ_PRIO_LOG },
+	{ TIM6_DAC_IRQn,       IRQ_PRIO_BACKGROUND },
+};
+
+#define IRQ_PLAN_COUNT            (sizeof(Irq_Plan) / sizeof(Irq_Plan[0]))
+
+/**
+ * @brief  Setzt die Prioritäten aller Interrupts nach dem Plan in Irq.h
+ *
+ * Der SysTick behält TICK_INT_PRIORITY (HAL_InitTick() setzt ihn bei jedem Taktwechsel neu).
+ */
+void Irq_Init(void) {
+	for (uint8_t i = 0; i < IRQ_PLAN_COUNT; i++) {
+		HAL_NVIC_SetPriority(Irq_Plan[i].irq, Irq_Plan[i].priority, 0);
+	}
+
+#if IRQ_STAT_ENABLE
+	Irq_Reset();
+#endif
+}
+
+#if IRQ_STAT_ENABLE
+
+typedef struct {
+	const char *name;
+	IRQn_Type irq;            // for the priority in Irq_Dump()
+} Irq_Name;
+
+static const Irq_Name Irq_Names[IRQ_ID_COUNT] = {
+	[IRQ_ID_TIM7]     = { "TIM7",     TIM7_IRQn },
+	[IRQ_ID_EXTI]     = { "EXTI",     EXTI15_10_IRQn },
+	[IRQ_ID_UART4]    = { "UART4",    UART4_IRQn },
+	[IRQ_ID_TIM1]     = { "TIM1",     TIM1_CC_IRQn },
+	[IRQ_ID_ADC]      = { "ADC",      ADC_IRQn },
+	[IRQ_ID_FDCAN1]   = { "FDCAN1",   FDCAN1_IT0_IRQn },
+	[IRQ_ID_LPUART1]  = { "LPUART1",  LPUART1_IRQn },
+	[IRQ_ID_OTG_HS]   = { "OTG_HS",   OTG_HS_IRQn },
+	[IRQ_ID_SPI1]     = { "SPI1",     SPI1_IRQn },
+	[IRQ_ID_SPI4]     = { "SPI4",     SPI4_IRQn },
+	[IRQ_ID_SDMMC1]   = { "SDMMC1",   SDMMC1_IRQn },
+	[IRQ_ID_OCTOSPI1] = { "OCTOSPI1", OCTOSPI1_IRQn },
+	[IRQ_ID_I2C1]     = { "I2C1",     I2C1_EV_IRQn },
+	[IRQ_ID_I2C2]     = { "I2C2",     I2C2_EV_IRQn },
+	[IRQ_ID_UART7]    = { "UART7",    UART7_IRQn },
+	[IRQ_ID_TIM6]     = { "TIM6",     TIM6_DAC_IRQn },
+};
+
+volatile uint32_t Irq_Inner = 0;
+volatile uint32_t Irq_StackLow = 0xFFFFFFFFUL;
+static Irq_Stat Irq_Stats[IRQ_ID_COUNT];
+
+static uint32_t Irq_CyclesToUs10(uint64_t cycles);
+
+/**
+ * @brief  Beendet die Messung eines Handlers
+ * @retval Takte seit Irq_Enter() ohne die Zeit verschachtelter Interrupts
+ */
+RAMFUNC uint32_t Irq_Leave(const Irq_Frame *frame) {
+	uint32_t primask = __get_PRIMASK();
+	uint32_t inclusive;
+	uint32_t nested;
+
+	// A higher level between reading and writing Irq_Inner would be lost to the outer handler
+	__disable_irq();
+	inclusive = DWT->CYCCNT - frame->start;
+	nested = Irq_Inner - frame->inner;
+	Irq_Inner = frame->inner + inclusive;
+	__set_PRIMASK(primask);
+
+	return inclusive > nested ? inclusive - nested : 0;
+}
+
+/**
+ * @brief  Trägt die Laufzeit eines Handlers ein, wird von IRQ_EXIT() aufgerufen
+ *
+ * Ohne Sperre: ein Eintrag gehört nur Handlern einer Stufe, die sich nicht unterbrechen.
+ */
+RAMFUNC void Irq_Record(Irq_Id id, uint32_t cycles) {
+	Irq_Stat *s = &Irq_Stats[id];
+
+	s->count++;
+	s->total += cycles;
+	if (cycles > s->max) s->max = cycles;
+}
+
+/**
+ * @brief  Trägt die Verzögerung vom Ereignis bis zum Eintritt in den Handler ein
+ */
+RAMFUNC void Irq_RecordLatency(Irq_Id id, uint32_t cycles) {
+	Irq_Stat *s = &Irq_Stats[id];
+
+	s->latencyTotal += cycles;
+	if (cycles > s->latencyMax) s->latencyMax = cycles;
+}
+
+/**
+ * @brief  Latenz des TIM7-Ticks aus dem Zählerstand, als erste Anweisung im TIM7-Handler
+ */
+RAMFUNC void Irq_RecordTickLatency(void) {
+	Irq_RecordLatency(IRQ_ID_TIM7, TIM7->CNT * (SystemCoreClock / REALTIME_COUNTER_HZ));
+}
+
+/**
+ * @brief  Kopiert die Statistik eines Handlers
+ */
+void Irq_GetStat(Irq_Id id, Irq_Stat *stat) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	*stat = Irq_Stats[id];
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Name eines Handlers für Ausgaben und den Trace
+ */
+const char* Irq_GetName(Irq_Id id) {
+	return id < IRQ_ID_COUNT ? Irq_Names[id].name : "?";
+}
+
+/**
+ * @brief  Setzt die Statistik aller Handler zurück
+ */
+void Irq_Reset(void) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	for (uint8_t i = 0; i < IRQ_ID_COUNT; i++) {
+		Irq_Stats[i].count = 0;
+		Irq_Stats[i].max = 0;
+		Irq_Stats[i].total = 0;
+		Irq_Stats[i].latencyMax = 0;
+		Irq_Stats[i].latencyTotal = 0;
+	}
+	Irq_StackLow = 0xFFFFFFFFUL;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt Priorität, Aufrufe, Laufzeit und Latenz aller Handler aus (Zeiten in µs)
+ */
+void Irq_Dump(void) {
+	printf("%-9s %4s %9s %9s %9s %9s\n", "IRQ", "Prio", "Aufrufe", "Mittel", "Max", "Lat. max");
+	for (uint8_t i = 0; i < IRQ_ID_COUNT; i++) {
+		Irq_Stat s;
+		Irq_GetStat((Irq_Id)i, &s);
+
+		uint32_t avg = s.count ? Irq_CyclesToUs10(s.total / s.count) : 0;
+		uint32_t max = Irq_CyclesToUs10(s.max);
+		uint32_t lat = Irq_CyclesToUs10(s.latencyMax);
+		printf("%-9s %4lu %9lu %7lu.%lu %7lu.%lu", Irq_Names[i].name, NVIC_GetPriority(Irq_Names[i].irq),
+				s.count, avg / 10, avg % 10, max / 10, max % 10);
+		if (s.latencyMax) {
+			printf(" %7lu.%lu\n", lat / 10, lat % 10);
+		} else {
+			printf(" %9s\n", "-");
+		}
+	}
+	printf("DMA-Streams einzeln: 'dma'\n");
+}
+
+/**
+ * @brief  Rechnet Takte in Zehntel-Mikrosekunden um
+ */
+static uint32_t Irq_CyclesToUs10(uint64_t cycles) {
+	uint32_t mhz = SystemCoreClock / 1000000UL;
+	return (uint32_t)(cycles * 10 / (mhz ? mhz : 1));
+}
+
+#endif /* IRQ_STAT_ENABLE */
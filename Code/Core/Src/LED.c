@@ -25,5 +25,5 @@ Pin LED_RED = {LED_RED_GPIO_Port, LED_RED_Pin};
  * @param state Status zum setzten (0 = Led aus, 1 = Led an)
  */
 void LED_Set(Pin pin, uint8_t state) {
-    HAL_GPIO_WritePin(pin.GPIOx,pin.GPIO_Pin,state);
+    Pin_Write(pin, state);
 }
@@ -8,6 +8,34 @@
  * Die Funktionen ermöglichen die Grundkonfiguration, Helligkeitssteuerung und das Zeichnen
  * auf der Matrix durch direktes Setzen der einzelnen Zeilen.
  *
+ * Mehrere Module können hintereinander geschaltet werden (LED_MATRIX_MODULES, DOUT an DIN des
+ * nächsten Moduls). Jedes Modul schiebt die 16 Bit, die es zuvor bekommen hat, beim nächsten
+ * Wort weiter; mit der steigenden Flanke von CS übernehmen alle Module gleichzeitig ihr
+ * aktuelles Wort. Eine Zeile der ganzen Kette sind deshalb N Worte unter einem CS.
+ * Das Wort für das letzte Modul kommt zuerst, das für Modul 0 zuletzt. Module, die nichts
+ * ändern sollen, bekommen das No-Op-Register 0x00.
+ *
+ * CS ist das Hardware-NSS von SPI4 (PE4). SPI4 sendet 16-Bit-Frames, ein Frame ist ein Wort
+ * (Adresse im oberen, Daten im unteren Byte). Mit einem Modul erzeugt SPI4 nach jedem Frame
+ * selbst einen NSS-Puls (NSSP, MasterInterDataIdleness = 2 Takte, MasterSSIdleness = 1 Takt),
+ * der Puls übernimmt das Wort. Alle geänderten Zeilen gehen dann als ein DMA-Strom hinaus, ohne
+ * CPU zwischen den Worten. Bei mehreren Modulen darf zwischen den N Worten einer Zeile kein Puls
+ * kommen (Frames über 16 Bit kann SPI4 nicht); LED_Matrix_setup() schaltet NSSP dann ab, NSS
+ * bleibt für eine Übertragung aktiv und geht an deren Ende hoch. Jede Zeile ist dann eine
+ * DMA-Übertragung und die nächste startet im Transfer-Complete-Callback.
+ *
+ * Gezeichnet wird in einen Bildpuffer (set_pixel, set_row, set_module, clear). LED_Matrix_flush()
+ * vergleicht ihn mit dem zuletzt gesendeten Bild und überträgt nur die geänderten Zeilen über
+ * SPI4_TX (DMA1 Stream 2), die CPU wartet nicht. Ein unverändertes Bild kostet keine Übertragung.
+ * Befehle (send_command, draw_row, Helligkeit) bleiben blockierend und warten vorher, bis ein
+ * laufendes Bild fertig ist.
+ *
+ * Laufschrift: LED_Matrix_scroll_text() schiebt einen Text mit dem 5x5-Font (Fonts/5x5_font.h)
+ * spaltenweise von rechts nach links über die ganze Kette. Jeder Aufruf des Scheduler-Tasks
+ * LED_Matrix_scroll_task() ist ein Schritt. Die Zeichen sind unterschiedlich breit, mit einer
+ * Spalte Abstand. Die Zeilen 0 und 7 sind im Font fast immer leer und kosten dann nichts.
+ * Spalte 0 ist Bit 7 von Modul 0, Modul 0 ist also ganz links.
+ *
  * @note Die SPI-Taktfrequenz für den MAX7219 darf 10 MHz nicht überschreiten.
  * @see https://www.analog.com/media/en/technical-documentation/data-sheets/max7219-max7221.pdf
  */
@@ -19,50 +47,82 @@
 
 #include "spi.h"
 #include "stm32h7xx_it.h"
+#include "Cache.h"
+#include "Scheduler.h"
+#include "BusStat.h"
+#include "BusFast.h"
+#include "Fonts/5x5_font.h"
+#include <string.h>
 
 #define SPI_LED_Matrix &hspi4
 
+// MAX7219 register addresses
+#define LED_MATRIX_REG_NOOP 0x00
+#define LED_MATRIX_REG_DIGIT0 0x01
+
+// Columns of the whole chain
+#define LED_MATRIX_COLUMNS (8 * LED_MATRIX_MODULES)
+
+// Words (address << 8 | data) of all changed rows back to back, read by DMA1 (not cached, no maintenance)
+static uint16_t LED_Matrix_tx_buffer[LED_MATRIX_ROWS * LED_MATRIX_MODULES] DMA_BUFFER;
+static volatile uint8_t LED_Matrix_busy = 0;
+static uint8_t LED_Matrix_next_row = 0;          // only used with more than one module
+static uint8_t LED_Matrix_row_count = 0;
+
+static LED_Matrix_Frame LED_Matrix_frame;        // drawing target
+static LED_Matrix_Frame LED_Matrix_shown;        // as last sent to the modules
+static uint8_t LED_Matrix_shown_valid = 0;       // 0 = module contents unknown, send everything
+static void (*LED_Matrix_complete_callback)(void) = NULL;
+
+// Marquee
+static char LED_Matrix_text[LED_MATRIX_SCROLL_TEXT_MAX + 1];
+static uint8_t LED_Matrix_scroll_task_id = SCHEDULER_INVALID_TASK;
+static uint8_t LED_Matrix_scrolling = 0;
+static uint16_t LED_Matrix_text_pos = 0;         // current character
+static uint8_t LED_Matrix_glyph_col = 0;         // column within it, glyph width = gap column
+static uint8_t LED_Matrix_blank_cols = 0;        // empty columns still to come after the text
+
+static void LED_Matrix_transmit(const uint16_t *words);
+static void LED_Matrix_start_row(void);
+static void LED_Matrix_queue_row(uint8_t row);
+static uint8_t LED_Matrix_next_column(void);
+static uint8_t LED_Matrix_glyph_width(const unsigned char *glyph);
 
-/**
- * @brief Setzt das Chip-Select-Signal der LED-Matrix auf HIGH.
- *
- * Diese Funktion aktiviert das Chip-Select-Signal (CS) der LED-Matrix,
- * indem der entsprechende GPIO-Pin auf HIGH gesetzt wird. Dies wird
- * verwendet, um die Kommunikation mit der LED-Matrix zu beenden.
- */
-void LEDM_CS_H(){
-    HAL_GPIO_WritePin(LEDM_CS_GPIO_Port, LEDM_CS_Pin, GPIO_PIN_SET);
-}
 
 /**
- * @brief Setzt das Chip-Select-Signal der LED-Matrix auf LOW.
+ * @brief Überträgt einen vollständigen Satz Worte für die Kette blockierend.
  *
- * Diese Funktion deaktiviert das Chip-Select-Signal (CS) der LED-Matrix,
- * indem der entsprechende GPIO-Pin auf LOW gesetzt wird. Dies wird
- * verwendet, um die Kommunikation mit der LED-Matrix zu starten.
+ * Wartet vorher auf ein laufendes Bild aus LED_Matrix_show(). Die steigende Flanke von NSS am
+ * Ende übernimmt die Worte in alle Module, das erzeugt SPI4 selbst.
+ *
+ * @param words Die Worte aller Module (Adresse << 8 | Daten), das letzte Modul zuerst.
  */
-void LEDM_CS_L(){
-    HAL_GPIO_WritePin(LEDM_CS_GPIO_Port, LEDM_CS_Pin, GPIO_PIN_RESET);
+static void LED_Matrix_transmit(const uint16_t *words){
+    LED_Matrix_wait();
+
+    // 16-bit frames: two bytes per module
+    BUSSTAT_CALL(BUSSTAT_ID_LED_MATRIX, BUSSTAT_COMMAND, LED_MATRIX_MODULES * 2,
+                 BusFast_SpiWrite(SPI_LED_Matrix, words, LED_MATRIX_MODULES, 100));
 }
 
 /**
      * @brief Sendet einen Befehl an die LED-Matrix.
      *
      * Diese Funktion überträgt einen Befehl an die LED-Matrix, indem sie
-     * die Adresse und die zugehörigen Daten über SPI sendet. Vor dem Senden
-     * wird das Chip-Select-Signal aktiviert (LOW) und nach dem Senden
-     * wieder deaktiviert (HIGH).
+     * die Adresse und die zugehörigen Daten als ein 16-Bit-Wort über SPI sendet.
+     * Chip-Select steuert SPI4 selbst (Hardware-NSS). Bei mehreren Modulen bekommen
+     * alle denselben Befehl.
      *
      * @param address Die Register-Adresse auf der LED-Matrix, an die die Daten gesendet werden.
      * @param data Die zu sendenden Daten, die in das angegebene Register geschrieben werden.
      */
 void LED_Matrix_send_command(uint8_t address,uint8_t data){
-    //uint16_t send_data = (data<<8)|(address);
-    uint8_t send_data[2] = {address,data};
+    uint16_t send_data[LED_MATRIX_MODULES];
 
-    LEDM_CS_L();
-    HAL_SPI_Transmit(SPI_LED_Matrix, send_data, 2, 100);
-    LEDM_CS_H();
+    for (int i = 0; i < LED_MATRIX_MODULES; i++){
+        send_data[i] = (address << 8) | data;
+    }
+    LED_Matrix_transmit(send_data);
 }
 
 
@@ -82,14 +142,21 @@ void LED_Matrix_setup(){
     // ACHTUNG!!!!!
     // SPI BAUD RATE DARF NICHT ÜBER 10 MBIT/S SEIN, SONST FUNKTIONIERT DIE LED_MATRIX NICHT!!!!
 
-    // Initialer Datenwert, der über SPI gesendet wird
-    uint8_t data = 0;
+#if LED_MATRIX_MODULES > 1
+    // Kein NSS-Puls zwischen den Worten einer Zeile, sonst übernimmt jedes Modul zu früh
+    LED_Matrix_wait();
+    hspi4.Init.NSSPMode = SPI_NSS_PULSE_DISABLE;
+    if (HAL_SPI_Init(SPI_LED_Matrix) != HAL_OK){
+        Error_Handler();
+    }
+#endif
+
+    // Initiale No-Op-Worte, die über SPI gesendet werden
+    uint16_t data[LED_MATRIX_MODULES] = {0};
 
-    // Sendet den Wert 0, da die erste SPI Kommunikation nicht immer funktioniert. Somit wird versichert, dass die nächsten
+    // Sendet No-Ops, da die erste SPI Kommunikation nicht immer funktioniert. Somit wird versichert, dass die nächsten
     // SPI-Kommunikationen auch wirklich funktionieren
-    LEDM_CS_L();
-    HAL_SPI_Transmit(SPI_LED_Matrix, &data, 1, 100);
-    LEDM_CS_H();
+    LED_Matrix_transmit(data);
 
     // Setzt die LED-Matrix in den Shutdown-Modus
     LED_Matrix_set_mode(0);
@@ -106,6 +173,9 @@ void LED_Matrix_setup(){
     // Setzt die Helligkeit der LED-Matrix
     LED_Matrix_set_intensity(2);
 
+    // Inhalt der Digit-Register nach dem Einschalten ist undefiniert, beim nächsten Abgleich alles senden
+    LED_Matrix_shown_valid = 0;
+
     // Setzt die LED-Matrix zurück
     LED_Matrix_reset();
 }
@@ -138,30 +208,39 @@ void LED_Matrix_set_mode(uint8_t mode){
  * Die Zeile wird durch den Parameter `row` angegeben, und die Daten,
  * die in dieser Zeile angezeigt werden sollen, werden durch `data` definiert.
  *
+ * Bei mehreren Modulen gilt das für Modul 0, die übrigen bekommen ein No-Op
+ * und behalten ihre Zeile. Ganze Bilder gehen mit LED_Matrix_show() schneller.
+ *
  * @param row Die Zeilennummer (0-7), die beschrieben werden soll.
  *            Werte außerhalb dieses Bereichs werden ignoriert.
  * @param data Die anzuzeigenden Daten für die angegebene Zeile.
  *             Jeder Bitwert im Byte repräsentiert eine LED in der Zeile.
  */
 void LED_Matrix_draw_row(uint8_t row, uint8_t data){
-    if (row >= 8 || row < 0) return;
+    if (row >= LED_MATRIX_ROWS) return;
 
-    uint8_t address = 0x01 + row;
+    uint16_t send_data[LED_MATRIX_MODULES] = {0};
 
-    LED_Matrix_send_command(address, data);
+    // Module 0 is the last word in the stream, all others get a no-op (address 0x00)
+    send_data[LED_MATRIX_MODULES - 1] = ((LED_MATRIX_REG_DIGIT0 + row) << 8) | data;
+    LED_Matrix_transmit(send_data);
+
+    // Keep the frame buffer in step, otherwise the next flush would not see the difference
+    LED_Matrix_frame[row][0] = data;
+    LED_Matrix_shown[row][0] = data;
 }
 
 /**
  * @brief Setzt die LED-Matrix zurück.
  *
- * Diese Funktion löscht alle Zeilen der LED-Matrix, indem sie die Daten
- * jeder Zeile auf 0 setzt. Anschließend wird die LED-Matrix in den
- * Normalbetrieb versetzt.
+ * Diese Funktion löscht den Bildpuffer und sendet nur die Zeilen, die
+ * noch nicht dunkel sind (nach LED_Matrix_setup() alle). Anschließend wird
+ * die LED-Matrix in den Normalbetrieb versetzt.
  */
 void LED_Matrix_reset(){
-    for (int i = 0; i < 8; i++){
-        LED_Matrix_draw_row(i, 0);
-    }
+    LED_Matrix_wait();
+    LED_Matrix_clear();
+    LED_Matrix_flush();
     LED_Matrix_set_mode(1);
 }
 
@@ -186,3 +265,328 @@ void LED_Matrix_set_intensity(uint8_t intensity) {
     LED_Matrix_send_command(0x0A, intensity);
 }
 
+/**
+ * @brief Setzt oder löscht eine LED im Bildpuffer.
+ *
+ * @param x Spalte über die ganze Kette (0 = links, Bit 7 von Modul 0).
+ * @param y Zeile (0-7).
+ * @param on 1 = an, 0 = aus.
+ */
+void LED_Matrix_set_pixel(uint8_t x, uint8_t y, uint8_t on){
+    if (x >= LED_MATRIX_COLUMNS || y >= LED_MATRIX_ROWS) return;
+
+    uint8_t bit = 0x80 >> (x & 7);
+    if (on){
+        LED_Matrix_frame[y][x >> 3] |= bit;
+    }
+    else {
+        LED_Matrix_frame[y][x >> 3] &= ~bit;
+    }
+}
+
+/**
+ * @brief Schreibt eine Zeile eines Moduls in den Bildpuffer.
+ *
+ * @param row Zeile (0-7).
+ * @param module Modul in der Kette (0 = am Controller).
+ * @param data Ein Bit je LED, wie bei LED_Matrix_draw_row().
+ */
+void LED_Matrix_set_row(uint8_t row, uint8_t module, uint8_t data){
+    if (row >= LED_MATRIX_ROWS || module >= LED_MATRIX_MODULES) return;
+
+    LED_Matrix_frame[row][module] = data;
+}
+
+/**
+ * @brief Liest eine Zeile eines Moduls aus dem Bildpuffer.
+ *
+ * @return Ein Bit je LED, 0 außerhalb der Kette.
+ */
+uint8_t LED_Matrix_get_row(uint8_t row, uint8_t module){
+    if (row >= LED_MATRIX_ROWS || module >= LED_MATRIX_MODULES) return 0;
+
+    return LED_Matrix_frame[row][module];
+}
+
+/**
+ * @brief Schreibt ein 8x8-Bild (eine Zeile je Byte) für ein Modul in den Bildpuffer.
+ *
+ * @param module Modul in der Kette (0 = am Controller).
+ * @param rows Die 8 Zeilen.
+ */
+void LED_Matrix_set_module(uint8_t module, const uint8_t rows[LED_MATRIX_ROWS]){
+    for (int row = 0; row < LED_MATRIX_ROWS; row++){
+        LED_Matrix_set_row(row, module, rows[row]);
+    }
+}
+
+/**
+ * @brief Löscht den Bildpuffer (gesendet wird erst mit LED_Matrix_flush()).
+ */
+void LED_Matrix_clear(void){
+    memset(LED_Matrix_frame, 0, sizeof(LED_Matrix_frame));
+}
+
+/**
+ * @brief Überträgt die seit dem letzten Abgleich geänderten Zeilen, ohne zu warten.
+ *
+ * Legt für jede geänderte Zeile die N Worte der Kette hintereinander in einem DMA-Puffer ab.
+ * Mit einem Modul geht der ganze Puffer in einer Übertragung hinaus, mit mehreren startet
+ * LED_Matrix_SPI_TxCpltCallback() Zeile für Zeile. Der Bildpuffer darf danach sofort weiter
+ * beschrieben werden.
+ *
+ * @return 1 wenn gestartet oder nichts zu tun, 0 solange noch das vorige Bild übertragen wird.
+ */
+uint8_t LED_Matrix_flush(void){
+    if (LED_Matrix_busy) return 0;
+
+    LED_Matrix_row_count = 0;
+    for (int row = 0; row < LED_MATRIX_ROWS; row++){
+        if (!LED_Matrix_shown_valid || memcmp(LED_Matrix_frame[row], LED_Matrix_shown[row], LED_MATRIX_MODULES) != 0){
+            LED_Matrix_queue_row(row);
+        }
+    }
+    LED_Matrix_shown_valid = 1;
+
+    if (LED_Matrix_row_count == 0) return 1;
+
+    LED_Matrix_busy = 1;
+    LED_Matrix_next_row = 0;
+    LED_Matrix_start_row();
+    return 1;
+}
+
+/**
+ * @brief Übernimmt ein ganzes Bild in den Bildpuffer und überträgt die geänderten Zeilen.
+ *
+ * @param frame Das Bild, frame[Zeile][Modul].
+ * @return 1 wenn gestartet oder nichts zu tun, 0 solange noch das vorige Bild übertragen wird.
+ */
+uint8_t LED_Matrix_show(const LED_Matrix_Frame frame){
+    if (LED_Matrix_busy) return 0;
+
+    memcpy(LED_Matrix_frame, frame, sizeof(LED_Matrix_frame));
+    return LED_Matrix_flush();
+}
+
+/**
+ * @brief Hängt die N Worte einer Zeile an den DMA-Puffer an und merkt sie als gesendet.
+ */
+static void LED_Matrix_queue_row(uint8_t row){
+    uint16_t *p = &LED_Matrix_tx_buffer[LED_MATRIX_MODULES * LED_Matrix_row_count++];
+
+    // The word for the last module is shifted out first
+    for (int module = LED_MATRIX_MODULES - 1; module >= 0; module--){
+        *p++ = ((LED_MATRIX_REG_DIGIT0 + row) << 8) | LED_Matrix_frame[row][module];
+    }
+    memcpy(LED_Matrix_shown[row], LED_Matrix_frame[row], LED_MATRIX_MODULES);
+}
+
+/**
+ * @brief Gibt an, ob gerade ein Bild per DMA übertragen wird.
+ *
+ * @return 1 während der Übertragung, sonst 0.
+ */
+uint8_t LED_Matrix_is_busy(void){
+    return LED_Matrix_busy;
+}
+
+/**
+ * @brief Wartet, bis ein laufendes Bild vollständig übertragen ist.
+ */
+void LED_Matrix_wait(void){
+    if (!LED_Matrix_busy) return;
+
+    BUSSTAT_WAIT_BEGIN(BUSSTAT_ID_LED_MATRIX);
+    while (LED_Matrix_busy){
+    }
+    BUSSTAT_WAIT_END(BUSSTAT_ID_LED_MATRIX);
+}
+
+/**
+ * @brief Startet die DMA-Übertragung der nächsten Zeile bzw. aller Zeilen.
+ *
+ * Mit einem Modul latcht der NSS-Puls nach jedem Wort, alle Zeilen gehen in einem Stück.
+ */
+static void LED_Matrix_start_row(void){
+#if LED_MATRIX_MODULES == 1
+    uint16_t *words = LED_Matrix_tx_buffer;
+    uint16_t count = LED_Matrix_row_count;
+    LED_Matrix_next_row = LED_Matrix_row_count - 1;
+#else
+    uint16_t *words = &LED_Matrix_tx_buffer[LED_MATRIX_MODULES * LED_Matrix_next_row];
+    uint16_t count = LED_MATRIX_MODULES;
+#endif
+
+    if (HAL_SPI_Transmit_DMA(SPI_LED_Matrix, (uint8_t *)words, count) != HAL_OK){
+        LED_Matrix_busy = 0;
+        LED_Matrix_shown_valid = 0;
+        return;
+    }
+    BUSSTAT_ASYNC(BUSSTAT_ID_LED_MATRIX, BUSSTAT_DATA, count * 2);
+}
+
+/**
+ * @brief Muss aus HAL_SPI_TxCpltCallback() aufgerufen werden.
+ *
+ * Am Ende der Übertragung geht NSS hoch und übernimmt die letzte Zeile in alle Module.
+ * Startet die nächste Zeile bzw. beendet das Bild.
+ *
+ * @param hspi SPI-Handler, der den Interrupt ausgelöst hat.
+ */
+void LED_Matrix_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi){
+    if (hspi != SPI_LED_Matrix || !LED_Matrix_busy) return;
+
+    if (++LED_Matrix_next_row < LED_Matrix_row_count){
+        LED_Matrix_start_row();
+    }
+    else {
+        LED_Matrix_busy = 0;
+        if (LED_Matrix_complete_callback != NULL) LED_Matrix_complete_callback();
+    }
+}
+
+/**
+ * @brief Muss aus HAL_SPI_ErrorCallback() aufgerufen werden.
+ *
+ * Bricht das laufende Bild ab, damit LED_Matrix_wait() nicht hängen bleibt. NSS gibt die HAL
+ * beim Abschluss der Übertragung selbst frei.
+ *
+ * @param hspi SPI-Handler, der den Fehler gemeldet hat.
+ */
+void LED_Matrix_SPI_ErrorCallback(SPI_HandleTypeDef *hspi){
+    if (hspi != SPI_LED_Matrix || !LED_Matrix_busy) return;
+
+    LED_Matrix_busy = 0;
+
+    // Rows not sent are unknown now
+    LED_Matrix_shown_valid = 0;
+    if (LED_Matrix_complete_callback != NULL) LED_Matrix_complete_callback();
+}
+
+/**
+ * @brief Registriert einen Callback, der am Ende jedes Bilds per DMA aufgerufen wird (auch nach Fehlern).
+ *
+ * @param callback Läuft im Interrupt-Kontext von SPI4, NULL entfernt ihn.
+ */
+void LED_Matrix_set_complete_callback(void (*callback)(void)){
+    LED_Matrix_complete_callback = callback;
+}
+
+/**
+ * @brief Meldet den Scheduler-Task der Laufschrift an.
+ *
+ * Der Task ist nur eingeschaltet, solange ein Text läuft.
+ *
+ * @param task_id Rückgabe von Scheduler_AddTask() für LED_Matrix_scroll_task, Periode = Schrittweite.
+ */
+void LED_Matrix_scroll_init(uint8_t task_id){
+    LED_Matrix_scroll_task_id = task_id;
+    Scheduler_SetEnabled(task_id, LED_Matrix_scrolling);
+}
+
+/**
+ * @brief Startet die Laufschrift, sie wiederholt sich bis LED_Matrix_scroll_stop().
+ *
+ * Der Text wird kopiert (höchstens LED_MATRIX_SCROLL_TEXT_MAX Zeichen) und läuft von rechts
+ * herein; zwischen zwei Durchläufen bleibt die Anzeige eine volle Breite lang leer.
+ *
+ * @param text Der Text, Zeichen außerhalb von ASCII 32-127 erscheinen als '?'.
+ */
+void LED_Matrix_scroll_text(const char *text){
+    strncpy(LED_Matrix_text, text, LED_MATRIX_SCROLL_TEXT_MAX);
+    LED_Matrix_text[LED_MATRIX_SCROLL_TEXT_MAX] = '\0';
+
+    LED_Matrix_text_pos = 0;
+    LED_Matrix_glyph_col = 0;
+    LED_Matrix_blank_cols = 0;
+    LED_Matrix_scrolling = LED_Matrix_text[0] != '\0';
+
+    LED_Matrix_clear();
+    Scheduler_SetEnabled(LED_Matrix_scroll_task_id, LED_Matrix_scrolling);
+}
+
+/**
+ * @brief Hält die Laufschrift an und löscht die Anzeige.
+ */
+void LED_Matrix_scroll_stop(void){
+    LED_Matrix_scrolling = 0;
+    Scheduler_SetEnabled(LED_Matrix_scroll_task_id, 0);
+    LED_Matrix_clear();
+    LED_Matrix_flush();
+}
+
+/**
+ * @brief Gibt an, ob gerade eine Laufschrift läuft.
+ *
+ * @return 1 während der Laufschrift, sonst 0.
+ */
+uint8_t LED_Matrix_is_scrolling(void){
+    return LED_Matrix_scrolling;
+}
+
+/**
+ * @brief Scheduler-Task: schiebt das Bild eine Spalte nach links und sendet die geänderten Zeilen.
+ *
+ * Ist die vorige Übertragung noch nicht fertig, fällt der Schritt aus, damit Bild und
+ * gesendeter Stand nicht auseinanderlaufen.
+ *
+ * @param context Nicht verwendet.
+ */
+void LED_Matrix_scroll_task(void *context){
+    if (!LED_Matrix_scrolling || LED_Matrix_busy) return;
+
+    uint8_t column = LED_Matrix_next_column();
+
+    for (int row = 0; row < LED_MATRIX_ROWS; row++){
+        uint8_t *line = LED_Matrix_frame[row];
+
+        // Whole chain as one shift register: bit 7 of the next module moves into bit 0
+        for (int module = 0; module < LED_MATRIX_MODULES - 1; module++){
+            line[module] = (uint8_t)((line[module] << 1) | (line[module + 1] >> 7));
+        }
+        line[LED_MATRIX_MODULES - 1] = (uint8_t)((line[LED_MATRIX_MODULES - 1] << 1) | ((column >> row) & 1));
+    }
+
+    LED_Matrix_flush();
+}
+
+/**
+ * @brief Liefert die nächste Spalte der Laufschrift (Bit n = Zeile n) und rückt weiter.
+ */
+static uint8_t LED_Matrix_next_column(void){
+    if (LED_Matrix_blank_cols > 0){
+        LED_Matrix_blank_cols--;
+        return 0;
+    }
+
+    unsigned char c = (unsigned char)LED_Matrix_text[LED_Matrix_text_pos];
+    if (c < 32 || c > 127){
+        c = '?';
+    }
+    const unsigned char *glyph = stdfont[c - 32];
+    uint8_t width = LED_Matrix_glyph_width(glyph);
+    uint8_t column = LED_Matrix_glyph_col < width ? glyph[LED_Matrix_glyph_col] : 0;
+
+    // One empty column after each glyph, a full display width after the text
+    if (++LED_Matrix_glyph_col > width){
+        LED_Matrix_glyph_col = 0;
+        if (LED_Matrix_text[++LED_Matrix_text_pos] == '\0'){
+            LED_Matrix_text_pos = 0;
+            LED_Matrix_blank_cols = LED_MATRIX_COLUMNS;
+        }
+    }
+    return column;
+}
+
+/**
+ * @brief Breite eines Zeichens ohne leere Spalten rechts, das Leerzeichen bekommt 3 Spalten.
+ */
+static uint8_t LED_Matrix_glyph_width(const unsigned char *glyph){
+    uint8_t width = CHAR_WIDTH;
+
+    while (width > 0 && glyph[width - 1] == 0){
+        width--;
+    }
+    return width > 0 ? width : 3;
+}
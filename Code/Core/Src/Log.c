@@ -0,0 +1,59 @@
+/**
+ * @file    Log.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Binäres Log: Formatiert wird erst am PC, die Firmware sendet nur Id, Zeitstempel und Argumente
+ *
+ * LOG("...", a, b) legt den Formatstring im Abschnitt .log_str ab, der nicht in den Flash geladen
+ * wird (Linkerskript), und schreibt zur Laufzeit nur einen Datensatz aus Id (Offset des Strings),
+ * DWT->CYCCNT und den Argumenten als 32-Bit-Worte in den Sendepuffer von Serial.c. Das kostet ein
+ * paar Dutzend Takte statt eines printf-Aufrufs und kann daher auch in Interrupts und im
+ * Betrieb eingeschaltet bleiben. Formatstrings belegen keinen Flash.
+ *
+ * Datensätze beginnen mit LOG_MARKER (0xFF), das in UTF-8-Text nie vorkommt. Sie teilen sich die
+ * UART mit printf; Serial_Write() überträgt jeden Datensatz am Stück oder verwirft ihn ganz.
+ *
+ * Tools/log_decode.py liest die Strings aus der ELF-Datei, gibt Text unverändert aus und setzt die
+ * Datensätze mit Zeitstempel wieder zusammen. Zur Umrechnung der Takte in Sekunden sendet
+ * Log_Clock() den Kerntakt, bei Log_Init() und nach jeder Umschaltung des Taktprofils.
+ */
+
+#include "Log.h"
+#include "Serial.h"
+
+/**
+ * @brief  Startet den Zykluszähler für die Zeitstempel und meldet den Kerntakt (nach Serial_Init())
+ */
+void Log_Init(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	Log_Clock();
+}
+
+/**
+ * @brief  Meldet dem Decoder den Takt von DWT->CYCCNT
+ */
+void Log_Clock(void) {
+	// log_decode.py takes the first argument of "@clock" as the new cycle rate
+	LOG("@clock %lu Hz\n", SystemCoreClock);
+}
+
+/**
+ * @brief  Schreibt einen Datensatz in den Sendepuffer, nur über LOG() aufrufen
+ * @param  id: Offset des Formatstrings in .log_str
+ * @param  args: Argumente als 32-Bit-Worte
+ * @param  count: Anzahl Argumente, höchstens LOG_MAX_ARGS
+ */
+void Log_Write(uint16_t id, const uint32_t *args, uint32_t count) {
+	uint32_t record[2 + LOG_MAX_ARGS];
+
+	if (count > LOG_MAX_ARGS)
+		count = LOG_MAX_ARGS;
+
+	record[0] = LOG_MARKER | (count << 8) | ((uint32_t)id << 16);
+	record[1] = DWT->CYCCNT;
+	for (uint32_t i = 0; i < count; i++)
+		record[2 + i] = args[i];
+
+	Serial_Write(&Serial_Log, record, 8 + 4 * count);
+}
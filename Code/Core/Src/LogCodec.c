@@ -0,0 +1,164 @@
+/**
+ * @file    LogCodec.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Verlustfreie Kompression von Messreihen für die Aufzeichnung auf SD (SensorLog.c)
+ *
+ * Die Potis ändern sich zwischen zwei Scans meist nur um wenige LSB, roh kostet trotzdem jeder
+ * Wert 2 Bytes. LogCodec_DeltaEncode() speichert je Kanal die Differenz zum vorigen Wert
+ * desselben Kanals, zig-zag-kodiert (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) als Varint mit 7 Bit
+ * je Byte: Differenzen bis ±63 brauchen 1 Byte, bis ±8191 2 Bytes, 12-Bit-Werte also nie
+ * mehr als roh. Der erste Wert jedes Kanals zählt als Differenz zu 0, jeder Block ist damit
+ * für sich dekodierbar, ein beschädigter Block kostet nur sich selbst.
+ *
+ * Ruhende Potis ergeben lange Folgen gleicher Bytes, die LogCodec_Lz4Compress() zusätzlich zu
+ * LZ4-Referenzen zusammenfasst (Blockformat wie ILI9341_IMAGE_LZ4, gierige Suche über eine
+ * Hashtabelle der letzten Position je 4-Byte-Folge). Das kostet deutlich mehr Zeit als die
+ * Differenzen, SensorLog.c ruft es nur auf, wenn der Task mit dem Schreiben nachkommt.
+ *
+ * Beide Funktionen arbeiten ohne Zustand zwischen den Aufrufen und ohne Ausrichtung der Daten.
+ */
+
+#include "LogCodec.h"
+#include <string.h>
+
+/* LZ4 block format: the last 5 bytes are literals, no match starts in the last 12 */
+#define LOGCODEC_LZ4_LAST_LITERALS   5
+#define LOGCODEC_LZ4_MATCH_LIMIT     12
+#define LOGCODEC_LZ4_MIN_MATCH       4
+
+static uint16_t LogCodec_Lz4Table[1U << LOGCODEC_LZ4_HASH_BITS];
+
+static uint32_t LogCodec_Read32(const uint8_t *p);
+static uint8_t* LogCodec_Lz4Sequence(uint8_t *op, const uint8_t *end, const uint8_t *literals,
+		uint32_t literalCount, uint32_t offset, uint32_t matchLength);
+
+/**
+ * @brief  Kodiert 16-Bit-Werte (Little Endian, Kanäle verschränkt) als Differenzen je Kanal
+ * @param  values: count Werte, Wert i gehört zu Kanal i % channels
+ * @param  out: mindestens LOGCODEC_DELTA_BOUND(count) Bytes
+ * @retval Länge der Ausgabe in Bytes
+ */
+uint32_t LogCodec_DeltaEncode(const uint8_t *values, uint32_t count, uint8_t channels, uint8_t *out) {
+	uint8_t *op = out;
+
+	for (uint32_t i = 0; i < count; i++) {
+		int32_t value = values[2 * i] | (values[2 * i + 1] << 8);
+		int32_t previous = 0;
+		if (i >= channels) {
+			previous = values[2 * (i - channels)] | (values[2 * (i - channels) + 1] << 8);
+		}
+
+		int32_t delta = value - previous;
+		uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+		while (zigzag >= 0x80) {
+			*op++ = (uint8_t)(zigzag | 0x80);
+			zigzag >>= 7;
+		}
+		*op++ = (uint8_t)zigzag;
+	}
+	return (uint32_t)(op - out);
+}
+
+/**
+ * @brief  Komprimiert einen Block im LZ4-Blockformat
+ * @param  length: höchstens LOGCODEC_LZ4_MAX_INPUT Bytes
+ * @param  capacity: Platz in out
+ * @retval Länge der Ausgabe, 0 wenn sie nicht in capacity passt
+ */
+uint32_t LogCodec_Lz4Compress(const uint8_t *in, uint32_t length, uint8_t *out, uint32_t capacity) {
+	if (length > LOGCODEC_LZ4_MAX_INPUT) {
+		return 0;
+	}
+	memset(LogCodec_Lz4Table, 0, sizeof(LogCodec_Lz4Table));
+
+	const uint8_t *end = out + capacity;
+	uint8_t *op = out;
+	uint32_t anchor = 0;
+	uint32_t position = 0;
+	uint32_t matchEnd = length > LOGCODEC_LZ4_LAST_LITERALS ? length - LOGCODEC_LZ4_LAST_LITERALS : 0;
+	uint32_t limit = length > LOGCODEC_LZ4_MATCH_LIMIT ? length - LOGCODEC_LZ4_MATCH_LIMIT : 0;
+
+	while (position < limit) {
+		uint32_t sequence = LogCodec_Read32(&in[position]);
+		uint32_t hash = (uint32_t)(sequence * 2654435761U) >> (32 - LOGCODEC_LZ4_HASH_BITS);
+		uint32_t candidate = LogCodec_Lz4Table[hash];
+		LogCodec_Lz4Table[hash] = (uint16_t)position;
+
+		if (candidate >= position || LogCodec_Read32(&in[candidate]) != sequence) {
+			position++;
+			continue;
+		}
+
+		uint32_t matchPosition = position + LOGCODEC_LZ4_MIN_MATCH;
+		uint32_t source = candidate + LOGCODEC_LZ4_MIN_MATCH;
+		while (matchPosition < matchEnd && in[matchPosition] == in[source]) {
+			matchPosition++;
+			source++;
+		}
+		// Take back literals that also match
+		while (position > anchor && candidate > 0 && in[position - 1] == in[candidate - 1]) {
+			position--;
+			candidate--;
+		}
+
+		op = LogCodec_Lz4Sequence(op, end, &in[anchor], position - anchor, position - candidate,
+				matchPosition - position);
+		if (op == NULL) {
+			return 0;
+		}
+		position = matchPosition;
+		anchor = position;
+	}
+
+	op = LogCodec_Lz4Sequence(op, end, &in[anchor], length - anchor, 0, 0);
+	return op != NULL ? (uint32_t)(op - out) : 0;
+}
+
+/**
+ * @brief  Little-Endian-Wort ab beliebiger Adresse
+ */
+static uint32_t LogCodec_Read32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief  Schreibt eine LZ4-Sequenz: Token, Literale, Abstand und Länge der Referenz
+ * @param  matchLength: 0 für die abschließenden Literale ohne Referenz
+ * @retval Position hinter der Sequenz, NULL wenn end erreicht würde
+ */
+static uint8_t* LogCodec_Lz4Sequence(uint8_t *op, const uint8_t *end, const uint8_t *literals,
+		uint32_t literalCount, uint32_t offset, uint32_t matchLength) {
+	uint32_t matchCode = matchLength ? matchLength - LOGCODEC_LZ4_MIN_MATCH : 0;
+
+	// Worst case: token, length bytes, literals, offset and match length bytes
+	uint32_t need = 1 + literalCount / 255 + 1 + literalCount + 2 + matchCode / 255 + 1;
+	if ((uint32_t)(end - op) < need) {
+		return NULL;
+	}
+
+	*op++ = (uint8_t)(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+	if (literalCount >= 15) {
+		uint32_t rest = literalCount - 15;
+		for (; rest >= 255; rest -= 255) {
+			*op++ = 255;
+		}
+		*op++ = (uint8_t)rest;
+	}
+	memcpy(op, literals, literalCount);
+	op += literalCount;
+
+	if (matchLength == 0) {
+		return op;
+	}
+	*op++ = (uint8_t)offset;
+	*op++ = (uint8_t)(offset >> 8);
+	if (matchCode >= 15) {
+		uint32_t rest = matchCode - 15;
+		for (; rest >= 255; rest -= 255) {
+			*op++ = 255;
+		}
+		*op++ = (uint8_t)rest;
+	}
+	return op;
+}
@@ -0,0 +1,472 @@
+/**
+ * @file    LowPower.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Stop-Modus im Leerlauf des Schedulers mit RTC-Wecker und schnellem Rückweg zu PLL1
+ *
+ * Realtime_Sleep() schläft bisher mit WFI im Run-Modus: PLL1, alle Bustakte und der Regler bei VOS
+ * des Profils laufen weiter. Ist bis zur nächsten Freigabe mindestens LOWPOWER_MIN_MS Zeit und
+ * seit LOWPOWER_QUIET_MS keine Eingabe gekommen, geht der Kern stattdessen hier in den Stop-Modus
+ * (CD-Domäne in DStop): Takte und PLL1 stehen, der Regler hält nur SVOS3, alle Register und SRAMs
+ * behalten ihren Inhalt. Nichts muss gesichert werden, die PWR_CR1-Bits legen nur fest, dass kein
+ * belegter Speicher abgeschaltet wird (LOWPOWER_RAM_SHUTOFF). Die SRD-Domäne bleibt im Run
+ * (PWR_CPUCR_RUN_SRD), LPUART1 und BDMA2 nehmen Zeichen der Kommandozeile also weiter in ihren
+ * Ring im SRD-SRAM an; ihr Interrupt läuft beim nächsten Aufwachen.
+ *
+ * Geweckt wird der Kern von:
+ *   - dem Wakeup-Timer der RTC (EXTI 19) kurz vor der nächsten Freigabe des Schedulers; die RTC läuft
+ *     vom LSI, dessen Takt im Betrieb gegen TIM5 gemessen wird (LOWPOWER_CAL_US)
+ *   - EXTI der Taster und des Joysticks und dem TE-Signal des Displays
+ *   - jedem anderen Interrupt, der im Stop noch ausgelöst werden kann
+ * Transfers können im Stop nicht weiterlaufen. Vorher muss deshalb alles ruhen, was auch der
+ * Governor vor einer Umschaltung abwartet, dazu die Sendepuffer beider UARTs, SD-Karte, CAN,
+ * USB mit PC am Bus, ESP-Link, Telemetrie und Bildspiegel. Was zuletzt im Weg war, zeigt 'stop'.
+ *
+ * Nach dem Aufwachen läuft der Kern vom HSI (STOPWUCK = 0). Clock_ResumeAfterStop() schaltet PLL1
+ * direkt über die Register wieder ein, begrenzt auf CLOCK_RESUME_TIMEOUT; gelingt das nicht, stellt
+ * Clock_SetProfile() das Profil im Timer-Task her, und der Stop-Modus bleibt bis 'stop on' aus.
+ * Die Zeit im Stop kommt aus der RTC: um sie rücken TIM7 (Realtime.c), uwTick, die Zeitbasis TIM5 und
+ * DWT->CYCCNT vor, damit Scheduler-Last, Governor und Zeitstempel weiterhin die Wandzeit sehen.
+ * Gemessen werden die Dauer des Rückwegs und die Zeit vom Aufwachen bis zum Start des ersten Tasks;
+ * beides soll unter einem Bild des Panels bleiben (LOWPOWER_FRAME_US).
+ *
+ * Mit angeschlossenem Debugger geht die Verbindung im Stop verloren, 'stop off' schaltet ihn ab.
+ */
+
+#include "LowPower.h"
+
+#if LOWPOWER_ENABLE
+
+#include "Clock.h"
+#include "Timer.h"
+#include "Timebase.h"
+#include "Serial.h"
+#include "Canvas.h"
+#include "ILI9341.h"
+#include "SSD1306.h"
+#include "LED_Matrix.h"
+#include "WS2812.h"
+#include "I2CBus.h"
+#include "EspLink.h"
+#include "Gamepad.h"
+#include "UsbCdc.h"
+#include "Telemetry.h"
+#include "Mirror.h"
+#include "SDQueue.h"
+#include "Can.h"
+#include "CanTp.h"
+#include "UserInput.h"
+#include <stdio.h>
+
+/* Asynchroner Vorteiler 1: die Unterzähler der RTC laufen mit dem vollen LSI-Takt (SSR) */
+#define LOWPOWER_RTC_PREDIV_S     (LOWPOWER_LSI_HZ - 1UL)
+#define LOWPOWER_RTC_TICKS_PER_S  (LOWPOWER_RTC_PREDIV_S + 1UL)
+#define LOWPOWER_RTC_DAY_TICKS    (86400UL * LOWPOWER_RTC_TICKS_PER_S)
+
+/* Wakeup-Timer mit RTCCLK / 2 (WUCKSEL = 011), 16-Bit-Zähler */
+#define LOWPOWER_WUT_DIVIDER      2UL
+#define LOWPOWER_WUT_MAX          0x10000UL
+
+#define LOWPOWER_START_TIMEOUT_MS 10
+#define LOWPOWER_WUT_LOOPS        100000UL
+
+/* Alle Abschalt-Bits der Speicher in DStop */
+#define LOWPOWER_RAM_SO_MASK      (PWR_CR1_SRDRAMSO | PWR_CR1_HSITFSO | PWR_CR1_GFXSO | PWR_CR1_ITCMSO \
+                                   | PWR_CR1_AHBRAM2SO | PWR_CR1_AHBRAM1SO | PWR_CR1_AXIRAM3SO \
+                                   | PWR_CR1_AXIRAM2SO | PWR_CR1_AXIRAM1SO)
+
+#if (LOWPOWER_RAM_SHUTOFF) & ~PWR_CR1_GFXSO
+#error "LOWPOWER_RAM_SHUTOFF: außer GFXMMU/JPEG sind alle Speicher belegt und müssen im Stop erhalten bleiben!"
+#endif
+#if LOWPOWER_RTC_PREDIV_S > 0x7FFFUL
+#error "LOWPOWER_LSI_HZ: der synchrone Vorteiler der RTC hat nur 15 Bit!"
+#endif
+
+volatile uint8_t LowPower_WakePending = 0;
+
+static LowPower_Stats LowPower_Statistics = { .lsiHz = LOWPOWER_LSI_HZ };
+static uint8_t LowPower_Ready = 0;
+static uint8_t LowPower_Enabled = 1;
+static Timer LowPower_RestoreTimer;
+
+// Activity seen by LowPower_Blocker()
+static uint32_t LowPower_LastInputs = 0;
+static uint32_t LowPower_LastFrames = 0;
+static uint32_t LowPower_QuietSince = 0;
+
+// Wake-up for LowPower_Interactive()
+static uint32_t LowPower_WakeCycle = 0;
+
+// LSI against TIM5 over the awake phases
+static uint32_t LowPower_CalRtc = 0;
+static uint32_t LowPower_CalUs = 0;
+static uint8_t LowPower_CalValid = 0;
+static uint64_t LowPower_CalSumRtc = 0;
+static uint64_t LowPower_CalSumUs = 0;
+
+static uint8_t LowPower_RtcInit(void);
+static uint32_t LowPower_RtcNow(void);
+static uint32_t LowPower_RtcSince(uint32_t then, uint32_t now);
+static uint8_t LowPower_ArmWakeup(uint32_t ticks);
+static void LowPower_DisarmWakeup(void);
+static const char* LowPower_Blocker(void);
+static uint8_t LowPower_SerialIdle(const Serial_Port *port);
+static void LowPower_Calibrate(uint32_t rtcNow, uint32_t usNow);
+static void LowPower_Restore(void *context);
+
+/**
+ * @brief  RTC vom LSI mit Wakeup-Timer und EXTI 19, Stop-Einstellungen von PWR und RCC
+ *
+ * Nach Irq_Init(), Timebase_Init() und Timer_Init() aufrufen. Startet der LSI nicht, bleibt es bei WFI.
+ */
+void LowPower_Init(void) {
+	Timer_Setup(&LowPower_RestoreTimer, "LowPower", LowPower_Restore, NULL);
+
+	if (!LowPower_RtcInit())
+		return;
+
+	// Stop: low-power regulator at SVOS3, flash stays powered, every memory in use keeps its content
+	HAL_PWREx_ControlStopModeVoltageScaling(LOWPOWER_SVOS);
+	CLEAR_BIT(PWR->CR1, PWR_CR1_FLPS);
+	MODIFY_REG(PWR->CR1, LOWPOWER_RAM_SO_MASK, LOWPOWER_RAM_SHUTOFF);
+
+	// SRD keeps running (LPUART1, BDMA2, SRD SRAM), HSI stays on as LPUART1 kernel clock and wake clock
+	SET_BIT(PWR->CPUCR, PWR_CPUCR_RUN_SRD);
+	SET_BIT(RCC->CR, RCC_CR_HSIKERON);
+	__HAL_RCC_WAKEUPSTOP_CLK_CONFIG(RCC_STOP_WAKEUPCLOCK_HSI);
+
+	// RTC wakeup on EXTI 19, rising edge, to the CPU; priority from Irq_Plan
+	SET_BIT(EXTI->RTSR1, EXTI_RTSR1_TR19);
+	SET_BIT(EXTI_D1->IMR1, EXTI_IMR1_IM19);
+	HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+	LowPower_QuietSince = HAL_GetTick();
+	LowPower_CalRtc = LowPower_RtcNow();
+	LowPower_CalUs = Timebase_Us32();
+	LowPower_CalValid = 1;
+	LowPower_Ready = 1;
+}
+
+/**
+ * @brief  Stop-Modus zur Laufzeit erlauben ('stop on|off'); ausgeschaltet bleibt es bei WFI
+ */
+void LowPower_SetEnabled(uint8_t enabled) {
+	LowPower_Enabled = enabled ? 1 : 0;
+}
+
+uint8_t LowPower_IsEnabled(void) {
+	return LowPower_Enabled && LowPower_Ready;
+}
+
+/**
+ * @brief  Schläft im Stop-Modus höchstens sleepUs µs, aus Realtime_Sleep() bei gesperrten Interrupts
+ *
+ * Kehrt mit PLL1 als SYSCLK zurück. Die Zeitbasis TIM5 und DWT->CYCCNT sind schon vorgerückt,
+ * TIM7 und uwTick stellt der Aufrufer um *sleptUs nach. Ein anstehender Interrupt weckt sofort.
+ * @param  sleepUs: µs bis kurz vor der nächsten Freigabe
+ * @param  sleptUs: Ziel für die Zeit im Stop (nur bei Rückgabe 1)
+ * @retval 1 nach einem Stop, 0 wenn der Stop-Modus nicht erlaubt war (der Aufrufer schläft mit WFI)
+ */
+uint8_t LowPower_Stop(uint32_t sleepUs, uint32_t *sleptUs) {
+	LowPower_Stats *s = &LowPower_Statistics;
+
+	if (!LowPower_Enabled || !LowPower_Ready)
+		return 0;
+
+	const char *blocker = LowPower_Blocker();
+	if (blocker != NULL) {
+		s->blocker = blocker;
+		s->blocked++;
+		return 0;
+	}
+
+	uint32_t ticks = (uint32_t)((uint64_t)sleepUs * s->lsiHz / (LOWPOWER_WUT_DIVIDER * 1000000ULL));
+	if (ticks < 2)
+		return 0;
+	if (ticks > LOWPOWER_WUT_MAX)
+		ticks = LOWPOWER_WUT_MAX;
+	if (!LowPower_ArmWakeup(ticks))
+		return 0;
+
+	uint32_t rtcStart = LowPower_RtcNow();
+	LowPower_Calibrate(rtcStart, Timebase_Us32());
+
+	HAL_PWR_EnterSTOPMode(LOWPOWER_REGULATOR, PWR_STOPENTRY_WFI);
+
+	// Running from HSI now; the RTC has counted the time in Stop
+	uint32_t wakeCycle = DWT->CYCCNT;
+	uint32_t rtcEnd = LowPower_RtcNow();
+	uint8_t byRtc = (RTC->SR & RTC_SR_WUTF) != 0;
+	LowPower_DisarmWakeup();
+
+	uint8_t fast = Clock_ResumeAfterStop();
+	uint32_t restoreUs = (DWT->CYCCNT - wakeCycle) / (HSI_VALUE / 1000000UL);
+	if (!fast) {
+		// Bus clocks are wrong until the profile is set up again; HAL_GetTick() stands still here
+		s->restoreFailed++;
+		LowPower_Enabled = 0;
+		Timer_Start(&LowPower_RestoreTimer, 1, 0);
+	}
+	UsbCdc_WakeFromStop();
+
+	uint32_t slept = (uint32_t)((uint64_t)LowPower_RtcSince(rtcStart, rtcEnd) * 1000000ULL / s->lsiHz);
+	DWT->CYCCNT += slept * (SystemCoreClock / 1000000UL);
+	Timebase_Advance(slept);
+
+	s->stops++;
+	s->stoppedUs += slept;
+	if (byRtc)
+		s->rtcWakes++;
+	else
+		s->otherWakes++;
+	s->restoreUs = restoreUs;
+	if (restoreUs > s->restoreUsMax) s->restoreUsMax = restoreUs;
+
+	LowPower_WakeCycle = DWT->CYCCNT - restoreUs * (SystemCoreClock / 1000000UL);
+	LowPower_WakePending = 1;
+
+	LowPower_CalRtc = LowPower_RtcNow();
+	LowPower_CalUs = Timebase_Us32();
+	LowPower_CalValid = fast;
+
+	*sleptUs = slept;
+	return 1;
+}
+
+/**
+ * @brief  Der erste Task nach dem Aufwachen startet (LOWPOWER_TASK_START() in Scheduler_Dispatch())
+ * @param  cycle: DWT->CYCCNT beim Start des Tasks
+ */
+void LowPower_Interactive(uint32_t cycle) {
+	LowPower_Stats *s = &LowPower_Statistics;
+	uint32_t us = (cycle - LowPower_WakeCycle) / (SystemCoreClock / 1000000UL);
+
+	LowPower_WakePending = 0;
+	s->interactiveUs = us;
+	if (us > s->interactiveUsMax) s->interactiveUsMax = us;
+	if (us > LOWPOWER_FRAME_US) s->overBudget++;
+}
+
+const LowPower_Stats* LowPower_GetStats(void) {
+	return &LowPower_Statistics;
+}
+
+/**
+ * @brief  Setzt die Zähler zurück, der gemessene LSI-Takt bleibt
+ */
+void LowPower_ResetStats(void) {
+	LowPower_Stats *s = &LowPower_Statistics;
+	uint32_t lsiHz = s->lsiHz;
+	uint32_t calibrations = s->calibrations;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	*s = (LowPower_Stats){ .lsiHz = lsiHz, .calibrations = calibrations };
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt Zustand, Zeit im Stop und die Dauer des Rückwegs aus ('stop' in der Shell)
+ */
+void LowPower_Dump(void) {
+	const LowPower_Stats *s = &LowPower_Statistics;
+
+	if (!LowPower_Ready) {
+		printf("Stop-Modus nicht verfügbar: LSI oder RTC nicht bereit\n");
+		return;
+	}
+	printf("Stop-Modus %s, ab %u ms Leerlauf und %u ms ohne Eingabe; LSI %lu Hz (%lu Messungen)\n",
+			LowPower_Enabled ? "an" : "aus", LOWPOWER_MIN_MS, LOWPOWER_QUIET_MS, s->lsiHz, s->calibrations);
+	printf("  %lu Stops, %lu ms im Stop; geweckt von RTC %lu, EXTI/anderen %lu; verhindert %lu (zuletzt %s)\n",
+			s->stops, (uint32_t)(s->stoppedUs / 1000U), s->rtcWakes, s->otherWakes, s->blocked,
+			s->blocker != NULL ? s->blocker : "-");
+	printf("  PLL1 zurück: zuletzt %lu us, max %lu us, gescheitert %lu\n", s->restoreUs, s->restoreUsMax, s->restoreFailed);
+	printf("  Aufwachen bis Task: zuletzt %lu us, max %lu us, über %u us (ein Bild) %lu\n",
+			s->interactiveUs, s->interactiveUsMax, LOWPOWER_FRAME_US, s->overBudget);
+}
+
+/**
+ * @brief  Wakeup-Timer der RTC: Flags löschen; die Zeit rechnet LowPower_Stop() ab
+ */
+void RTC_WKUP_IRQHandler(void) {
+	RTC->SCR = RTC_SCR_CWUTF;
+	EXTI_D1->PR1 = EXTI_PR1_PR19;
+}
+
+/**
+ * @brief  LSI einschalten, RTC auf den LSI legen, Vorteiler setzen, Schattenregister umgehen
+ * @retval 1 bei Erfolg
+ */
+static uint8_t LowPower_RtcInit(void) {
+	uint32_t start;
+
+	__HAL_RCC_LSI_ENABLE();
+	start = HAL_GetTick();
+	while (!__HAL_RCC_GET_FLAG(RCC_FLAG_LSIRDY)) {
+		if (HAL_GetTick() - start >= LOWPOWER_START_TIMEOUT_MS)
+			return 0;
+	}
+
+	HAL_PWR_EnableBkUpAccess();
+	if ((RCC->BDCR & RCC_BDCR_RTCSEL) != RCC_RTCCLKSOURCE_LSI) {
+		// The clock source can only be changed once after a backup domain reset
+		if (RCC->BDCR & RCC_BDCR_RTCSEL) {
+			__HAL_RCC_BACKUPRESET_FORCE();
+			__HAL_RCC_BACKUPRESET_RELEASE();
+		}
+		__HAL_RCC_RTC_CONFIG(RCC_RTCCLKSOURCE_LSI);
+	}
+	__HAL_RCC_RTC_ENABLE();
+	__HAL_RCC_RTC_CLK_ENABLE();
+
+	// Write protection stays off, LowPower_ArmWakeup() reprograms the timer before every Stop
+	RTC->WPR = 0xCA;
+	RTC->WPR = 0x53;
+	RTC->ICSR |= RTC_ICSR_INIT;
+	start = HAL_GetTick();
+	while (!(RTC->ICSR & RTC_ICSR_INITF)) {
+		if (HAL_GetTick() - start >= LOWPOWER_START_TIMEOUT_MS)
+			return 0;
+	}
+	RTC->PRER = LOWPOWER_RTC_PREDIV_S;                   // PREDIV_A = 0
+	RTC->PRER = LOWPOWER_RTC_PREDIV_S;                   // second write for PREDIV_S (RM0455)
+	RTC->CR = RTC_CR_BYPSHAD | (3U << RTC_CR_WUCKSEL_Pos);
+	RTC->ICSR &= ~RTC_ICSR_INIT;
+	return 1;
+}
+
+/**
+ * @brief  LSI-Takte seit Mitternacht der RTC aus Sekunden und Unterzähler
+ *
+ * Ohne Schattenregister (BYPSHAD): SSR vor und nach TR lesen, bis beide gleich sind.
+ */
+static uint32_t LowPower_RtcNow(void) {
+	uint32_t ssr, tr;
+
+	do {
+		ssr = RTC->SSR;
+		tr = RTC->TR;
+	} while (ssr != RTC->SSR);
+
+	uint32_t hours = ((tr & RTC_TR_HT) >> RTC_TR_HT_Pos) * 10U + ((tr & RTC_TR_HU) >> RTC_TR_HU_Pos);
+	uint32_t minutes = ((tr & RTC_TR_MNT) >> RTC_TR_MNT_Pos) * 10U + ((tr & RTC_TR_MNU) >> RTC_TR_MNU_Pos);
+	uint32_t seconds = ((tr & RTC_TR_ST) >> RTC_TR_ST_Pos) * 10U + ((tr & RTC_TR_SU) >> RTC_TR_SU_Pos);
+
+	return ((hours * 60U + minutes) * 60U + seconds) * LOWPOWER_RTC_TICKS_PER_S
+			+ (LOWPOWER_RTC_PREDIV_S - (ssr & RTC_SSR_SS));
+}
+
+/**
+ * @brief  LSI-Takte zwischen zwei Ständen von LowPower_RtcNow(), über Mitternacht hinweg
+ */
+static uint32_t LowPower_RtcSince(uint32_t then, uint32_t now) {
+	return now >= then ? now - then : now + (LOWPOWER_RTC_DAY_TICKS - then);
+}
+
+/**
+ * @brief  Wakeup-Timer auf ticks Takte (RTCCLK / 2) stellen und starten
+ * @retval 1 bei Erfolg, 0 wenn die RTC den Timer nicht freigibt
+ */
+static uint8_t LowPower_ArmWakeup(uint32_t ticks) {
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	for (uint32_t n = 0; !(RTC->ICSR & RTC_ICSR_WUTWF); n++) {
+		if (n >= LOWPOWER_WUT_LOOPS)
+			return 0;
+	}
+	RTC->WUTR = ticks - 1U;
+	RTC->SCR = RTC_SCR_CWUTF;
+	EXTI_D1->PR1 = EXTI_PR1_PR19;
+	RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+	return 1;
+}
+
+/**
+ * @brief  Wakeup-Timer anhalten und alle Spuren des Weckers löschen, auch den Interrupt im NVIC
+ */
+static void LowPower_DisarmWakeup(void) {
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	RTC->SCR = RTC_SCR_CWUTF;
+	EXTI_D1->PR1 = EXTI_PR1_PR19;
+	NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+}
+
+/**
+ * @brief  Was den Stop-Modus gerade verhindert
+ * @retval Kurzname für 'stop', NULL wenn der Kern in den Stop darf
+ */
+static const char* LowPower_Blocker(void) {
+	uint32_t inputs = UserInput_GetEventCount();
+	uint32_t frames = Can_GetStats()->received + Can_GetStats()->sent;
+	uint32_t now = HAL_GetTick();
+
+	// While someone is using the board, stay in Run for the shortest reaction time
+	if (inputs != LowPower_LastInputs || frames != LowPower_LastFrames || UserInput_GetPressed() != 0) {
+		LowPower_LastInputs = inputs;
+		LowPower_LastFrames = frames;
+		LowPower_QuietSince = now;
+	}
+	if (now - LowPower_QuietSince < LOWPOWER_QUIET_MS)
+		return "Eingabe";
+
+	if (ILI9341_IsBusy() || !Canvas_FrameIsDone())
+		return "Display";
+	if (ssd1306_IsBusy() || !I2CBus_IsIdle(&I2CBus_1) || !I2CBus_IsIdle(&I2CBus_2))
+		return "I2C";
+	if (LED_Matrix_is_busy() || WS2812_IsBusy())
+		return "LEDs";
+	if (!LowPower_SerialIdle(&Serial_Shell) || !LowPower_SerialIdle(&Serial_Log))
+		return "UART";
+	if (SDQueue_Pending())
+		return "SD";
+	if (CanTp_IsBusy() || Can_GetTxPending() != 0)
+		return "CAN";
+	if (UsbCdc_IsActive())
+		return "USB";
+	if (EspLink_IsUp())
+		return "ESP";
+	if (Gamepad_IsConnected())
+		return "Gamepad";
+	if (Telemetry_IsRunning() || Mirror_GetTransport() != MIRROR_OFF)
+		return "Stream";
+	return NULL;
+}
+
+/**
+ * @brief  Sendepuffer leer und keine DMA mehr unterwegs
+ */
+static uint8_t LowPower_SerialIdle(const Serial_Port *port) {
+	return port->head == port->tail && port->dmaLength == 0;
+}
+
+/**
+ * @brief  Summiert die Wachzeit seit dem letzten Aufwachen in RTC- und TIM5-Takten, neuer LSI-Takt nach LOWPOWER_CAL_US
+ */
+static void LowPower_Calibrate(uint32_t rtcNow, uint32_t usNow) {
+	LowPower_Stats *s = &LowPower_Statistics;
+
+	if (LowPower_CalValid) {
+		LowPower_CalSumRtc += LowPower_RtcSince(LowPower_CalRtc, rtcNow);
+		LowPower_CalSumUs += usNow - LowPower_CalUs;
+	}
+	if (LowPower_CalSumUs < LOWPOWER_CAL_US)
+		return;
+
+	uint32_t hz = (uint32_t)(LowPower_CalSumRtc * 1000000ULL / LowPower_CalSumUs);
+	if (hz > LOWPOWER_LSI_HZ * (100U - LOWPOWER_LSI_TOLERANCE) / 100U
+			&& hz < LOWPOWER_LSI_HZ * (100U + LOWPOWER_LSI_TOLERANCE) / 100U) {
+		s->lsiHz = hz;
+		s->calibrations++;
+	}
+	LowPower_CalSumRtc = 0;
+	LowPower_CalSumUs = 0;
+}
+
+/**
+ * @brief  Timer-Callback nach gescheitertem schnellen Rückweg: Profil über die HAL neu aufsetzen
+ */
+static void LowPower_Restore(void *context) {
+	if (!Clock_SetProfile(Clock_GetProfile()))
+		printf("Stop-Modus: Taktprofil nicht wiederhergestellt, Kern läuft vom HSI\n");
+}
+
+#endif /* LOWPOWER_ENABLE */
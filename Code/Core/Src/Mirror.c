@@ -0,0 +1,473 @@
+/**
+ * @file    Mirror.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Bildspiegel: geänderte Bereiche des Framebuffers als Differenz zum PC
+ *
+ * Ein Rohbild sind 150 KB, über LPUART1 (3 MBaud) gut eine halbe Sekunde, über den ESP-Link
+ * (921600 Baud) fast zwei. Die UI ändert aber je Bild meist nur Zahlen, Zeiger und Kurven. Der
+ * Spiegel hängt sich deshalb an ILI9341_FB_Flush() (ILI9341_FB_SetFlushListener()) und übernimmt
+ * dessen Dirty-Rectangles. Innerhalb der Bereiche schickt er nur, was sich gegenüber dem
+ * Schattenpuffer geändert hat; das ist der Stand, den der Empfänger bereits kennt. Die Datenmenge
+ * folgt damit den geänderten Pixeln, nicht der Displaygröße. Ein Schlüsselbild setzt den Schatten
+ * auf 0 und kodiert den ganzen Bildschirm; es kommt beim Start, nach einem verlorenen Paket, nach
+ * einem Wechsel der Ausrichtung und spätestens alle MIRROR_KEYFRAME_MS.
+ *
+ * Paket: Kopf (MIRROR_HEADER_SIZE, Little Endian) aus Bildnummer (2), Flags (1, MIRROR_FLAG_*),
+ * reserviert (1), x, y, Breite, Höhe des Bereichs (je 2), erstes Pixel im Bereich (4, zeilenweise
+ * gezählt), dann Token bis zum Paketende:
+ *   00nnnnnn             n+1 Pixel unverändert
+ *   01nnnnnn Farbe       n+1 Pixel dieser Farbe
+ *   1nnnnnnn n+1 Farben  Pixel einzeln
+ * Farben sind RGB565 wie im Framebuffer, High-Byte zuerst. Läufe reichen über Zeilenenden des
+ * Bereichs, aber nie über ein Paket hinaus: jedes Paket lässt sich für sich anwenden.
+ *
+ * Über LPUART1 geht jedes Paket als TELEMETRY_PKT_MIRROR (Telemetry_SendPacket()) mit höchstens
+ * MIRROR_UART_PAYLOAD Bytes. Über den ESP-Link geht es ohne Kopie aus einem von zwei Paketpuffern
+ * auf ESPLINK_CH_DISPLAY, Tag = Bildnummer. Ein Paket, das der Sendeweg nicht annimmt oder verwirft,
+ * hat den Schatten schon verändert; das nächste Bild ist dann ein Schlüsselbild.
+ *
+ * Kodiert wird im Timer-Callback, höchstens MIRROR_PACKETS_PER_TICK Pakete je Aufruf. Während ein
+ * Bild unterwegs ist, sammelt der Flush-Empfänger die nächsten Bereiche; gezeichnet wird derweil
+ * weiter, der Spiegel liest jedes Pixel erst beim Kodieren (Tools/mirror_view.py zeigt das Bild).
+ */
+
+#include "Mirror.h"
+
+#if MIRROR_ENABLE
+
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "EspLink.h"
+#include "Telemetry.h"
+#include "Serial.h"
+#include "Cache.h"
+#include "Timebase.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef ILI9341_USE_FRAMEBUFFER
+#error "Mirror.c braucht ILI9341_USE_FRAMEBUFFER (oder MIRROR_ENABLE 0)"
+#endif
+
+#if MIRROR_UART_PAYLOAD > TELEMETRY_MAX_PAYLOAD
+#error "MIRROR_UART_PAYLOAD darf TELEMETRY_MAX_PAYLOAD nicht überschreiten!"
+#endif
+
+/* Telemetriekopf, CRC, COBS und Begrenzer eines Pakets im Sendepuffer von LPUART1 */
+#define MIRROR_UART_OVERHEAD      24
+
+/* Längste Token */
+#define MIRROR_MAX_SKIP           64
+#define MIRROR_MAX_REPEAT         64
+#define MIRROR_MAX_LITERAL        128
+
+// State of the receiver: what it shows once all packets sent so far have arrived
+static uint16_t Mirror_Shadow[ILI9341_FB_PIXELS] AXI_BUFFER;
+
+// Packets, with the ESP link the DMA reads them in place
+static uint8_t Mirror_Packets[2][MIRROR_LINK_PAYLOAD] AXI_BUFFER;
+static volatile uint8_t Mirror_Busy[2];
+static uint8_t Mirror_Next = 0;
+static volatile uint8_t Mirror_Failed = 0;     // link discarded a packet (interrupt)
+
+static Timer Mirror_Timer;
+static Mirror_Transport Mirror_Mode = MIRROR_OFF;
+static Mirror_Stats Mirror_Statistics;
+static uint32_t Mirror_StatsStartMs = 0;
+
+// Areas flushed since the current frame started
+static ILI9341_FB_Rect Mirror_Pending[MIRROR_MAX_RECTS];
+static uint8_t Mirror_PendingCount = 0;
+
+// Frame being sent
+static ILI9341_FB_Rect Mirror_Rects[MIRROR_MAX_RECTS];
+static uint8_t Mirror_RectCount = 0;           // 0 = no frame in progress
+static uint8_t Mirror_RectIndex = 0;
+static uint32_t Mirror_Offset = 0;             // next pixel within the current area
+static uint16_t Mirror_Frame = 0;
+static uint8_t Mirror_Flags = 0;
+static uint32_t Mirror_EncodeUs = 0;
+
+static uint8_t Mirror_KeyRequested = 1;
+static uint32_t Mirror_LastKeyMs = 0;
+static uint16_t Mirror_Width = 0;              // ILI9341_WIDTH at the last keyframe
+
+static void Mirror_Tick(void *context);
+static void Mirror_Collect(const ILI9341_FB_Rect *rects, uint8_t count);
+static uint8_t Mirror_Begin(void);
+static uint8_t* Mirror_GetPacket(uint32_t *size);
+static uint8_t Mirror_Transmit(uint8_t *packet, uint32_t length);
+static void Mirror_LinkDone(const void *data, uint32_t length, uint8_t sent, void *context);
+static uint32_t Mirror_Encode(const uint16_t *fb, uint8_t *packet, uint32_t size);
+
+static inline uint32_t Mirror_Area(const ILI9341_FB_Rect *r) {
+	return (uint32_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+static inline void Mirror_Union(ILI9341_FB_Rect *dst, const ILI9341_FB_Rect *src) {
+	if (src->x1 < dst->x1) dst->x1 = src->x1;
+	if (src->y1 < dst->y1) dst->y1 = src->y1;
+	if (src->x2 > dst->x2) dst->x2 = src->x2;
+	if (src->y2 > dst->y2) dst->y2 = src->y2;
+}
+
+static inline uint8_t Mirror_Overlaps(const ILI9341_FB_Rect *a, const ILI9341_FB_Rect *b) {
+	return a->x1 <= b->x2 && b->x1 <= a->x2 && a->y1 <= b->y2 && b->y1 <= a->y2;
+}
+
+/* Next pixel of an area: along the row, at the end of the row to the start of the next */
+static inline uint32_t Mirror_After(uint32_t at, uint16_t col, uint16_t width, uint32_t stride) {
+	return col + 1U < width ? at + 1U : at + stride - width + 1U;
+}
+
+static inline void Mirror_Step(uint32_t *at, uint16_t *col, uint16_t width, uint32_t stride) {
+	*at = Mirror_After(*at, *col, width, stride);
+	*col = *col + 1U < width ? *col + 1U : 0;
+}
+
+/**
+ * @brief  Timer anlegen und am Flush des Framebuffers anmelden (nach Timer_Init()), startet mit Mirror_Start()
+ */
+void Mirror_Init(void) {
+	Timer_Setup(&Mirror_Timer, "Mirror", Mirror_Tick, NULL);
+	ILI9341_FB_SetFlushListener(Mirror_Collect);
+	Mirror_ResetStats();
+}
+
+/**
+ * @brief  Spiegel über den gewählten Weg starten, das erste Bild ist ein Schlüsselbild
+ * @retval 1 gestartet, 0 ohne Framebuffer-Modus oder (MIRROR_ESP) ohne verbundenen ESP
+ */
+uint8_t Mirror_Start(Mirror_Transport transport) {
+	if (transport == MIRROR_OFF) {
+		Mirror_Stop();
+		return 1;
+	}
+	if (!ILI9341_FB_IsEnabled() || (transport == MIRROR_ESP && !EspLink_IsUp()))
+		return 0;
+
+	Mirror_Mode = transport;
+	Mirror_RectCount = 0;
+	Mirror_PendingCount = 0;
+	Mirror_KeyRequested = 1;
+	Timer_Start(&Mirror_Timer, 1, MIRROR_TICK_MS);
+	return 1;
+}
+
+/**
+ * @brief  Spiegel anhalten; Pakete, die der ESP-Link noch sendet, laufen zu Ende
+ */
+void Mirror_Stop(void) {
+	Timer_Stop(&Mirror_Timer);
+	Mirror_Mode = MIRROR_OFF;
+	Mirror_RectCount = 0;
+	Mirror_PendingCount = 0;
+}
+
+Mirror_Transport Mirror_GetTransport(void) {
+	return Mirror_Mode;
+}
+
+/**
+ * @brief  Nächstes Bild als Schlüsselbild, z.B. für einen neu gestarteten Betrachter
+ */
+void Mirror_Keyframe(void) {
+	Mirror_KeyRequested = 1;
+}
+
+const Mirror_Stats* Mirror_GetStats(void) {
+	return &Mirror_Statistics;
+}
+
+void Mirror_ResetStats(void) {
+	Mirror_Statistics = (Mirror_Stats){ 0 };
+	Mirror_StatsStartMs = HAL_GetTick();
+}
+
+/**
+ * @brief  Weg, Bilder, Datenmenge und Kompression über printf
+ */
+void Mirror_Dump(void) {
+	static const char *const names[] = { "aus", "über LPUART1", "über den ESP-Link" };
+	const Mirror_Stats *s = &Mirror_Statistics;
+	uint32_t elapsedMs = HAL_GetTick() - Mirror_StatsStartMs;
+	uint64_t raw = s->pixels * 2U;
+
+	printf("Bildspiegel %s, Bild %u, %lu Bilder (%lu Schlüsselbilder), %lu Pakete\n", names[Mirror_Mode],
+			Mirror_Frame, s->frames, s->keyframes, s->packets);
+	printf("  %lu B (%lu B/s) für %lu KB Bereiche, %lu %%, Kodierung %lu us je Bild (max %lu)\n",
+			(uint32_t)s->bytes, elapsedMs ? (uint32_t)(s->bytes * 1000U / elapsedMs) : 0, (uint32_t)(raw / 1024U),
+			raw ? (uint32_t)(s->bytes * 100U / raw) : 0, s->lastEncodeUs, s->maxEncodeUs);
+	printf("  Sendeweg voll %lu, Fehler %lu, Bereiche zusammengefasst %lu\n", s->full, s->errors, s->merged);
+}
+
+/**
+ * @brief  Timer-Callback: nächstes Bild beginnen und Pakete kodieren, solange der Sendeweg frei ist
+ */
+static void Mirror_Tick(void *context) {
+	uint32_t start = Timebase_Us32();
+	const uint16_t *fb;
+
+	if (Mirror_Failed) {
+		Mirror_Failed = 0;
+		Mirror_Statistics.errors++;
+		Mirror_KeyRequested = 1;
+		Mirror_RectCount = 0;
+	}
+	if (Mirror_Mode == MIRROR_ESP && !EspLink_IsUp()) {
+		// Resume with a keyframe after the next HELLO
+		Mirror_KeyRequested = 1;
+		Mirror_RectCount = 0;
+		return;
+	}
+	if (!ILI9341_FB_IsEnabled())
+		return;
+	if (ILI9341_WIDTH != Mirror_Width) {
+		// Areas of the old orientation do not fit the new row length
+		Mirror_KeyRequested = 1;
+		Mirror_RectCount = 0;
+	}
+	if (Mirror_RectCount == 0 && !Mirror_Begin())
+		return;
+
+	fb = ILI9341_FB_GetBuffer();
+	for (uint8_t n = 0; n < MIRROR_PACKETS_PER_TICK && Mirror_RectCount > 0; n++) {
+		uint32_t size;
+		uint8_t *packet = Mirror_GetPacket(&size);
+
+		if (packet == NULL) {
+			Mirror_Statistics.full++;
+			break;
+		}
+		uint32_t length = Mirror_Encode(fb, packet, size);
+		if (!Mirror_Transmit(packet, length)) {
+			Mirror_Statistics.errors++;
+			Mirror_KeyRequested = 1;
+			Mirror_RectCount = 0;
+			break;
+		}
+		Mirror_Statistics.packets++;
+		Mirror_Statistics.bytes += length;
+
+		if (packet[2] & MIRROR_FLAG_END) {
+			Mirror_EncodeUs += Timebase_Us32() - start;
+			Mirror_Statistics.frames++;
+			Mirror_Statistics.lastEncodeUs = Mirror_EncodeUs;
+			if (Mirror_EncodeUs > Mirror_Statistics.maxEncodeUs)
+				Mirror_Statistics.maxEncodeUs = Mirror_EncodeUs;
+			Mirror_RectCount = 0;
+			return;
+		}
+	}
+	Mirror_EncodeUs += Timebase_Us32() - start;
+}
+
+/**
+ * @brief  Flush-Empfänger (Task der UI): Bereiche für das nächste Bild sammeln
+ */
+static void Mirror_Collect(const ILI9341_FB_Rect *rects, uint8_t count) {
+	if (Mirror_Mode == MIRROR_OFF)
+		return;
+
+	for (uint8_t i = 0; i < count; i++) {
+		const ILI9341_FB_Rect *r = &rects[i];
+		uint8_t merged = 0;
+
+		for (uint8_t k = 0; k < Mirror_PendingCount && !merged; k++) {
+			if (Mirror_Overlaps(&Mirror_Pending[k], r)) {
+				Mirror_Union(&Mirror_Pending[k], r);
+				merged = 1;
+			}
+		}
+		if (merged)
+			continue;
+		if (Mirror_PendingCount < MIRROR_MAX_RECTS) {
+			Mirror_Pending[Mirror_PendingCount++] = *r;
+			continue;
+		}
+
+		// Full: grow the area that gains the fewest pixels
+		uint8_t best = 0;
+		uint32_t bestGrowth = UINT32_MAX;
+		for (uint8_t k = 0; k < MIRROR_MAX_RECTS; k++) {
+			ILI9341_FB_Rect u = Mirror_Pending[k];
+			Mirror_Union(&u, r);
+			uint32_t growth = Mirror_Area(&u) - Mirror_Area(&Mirror_Pending[k]);
+			if (growth < bestGrowth) {
+				bestGrowth = growth;
+				best = k;
+			}
+		}
+		Mirror_Union(&Mirror_Pending[best], r);
+		Mirror_Statistics.merged++;
+	}
+}
+
+/**
+ * @brief  Bereiche des nächsten Bildes festlegen: Schlüsselbild, gesammelte Bereiche oder nichts
+ * @retval 1 ein Bild beginnt
+ */
+static uint8_t Mirror_Begin(void) {
+	uint32_t now = HAL_GetTick();
+
+	if (now - Mirror_LastKeyMs >= MIRROR_KEYFRAME_MS)
+		Mirror_KeyRequested = 1;
+
+	if (Mirror_KeyRequested) {
+		memset(Mirror_Shadow, 0, sizeof(Mirror_Shadow));
+		Mirror_Rects[0] = (ILI9341_FB_Rect){ 0, 0, ILI9341_WIDTH - 1, ILI9341_HEIGHT - 1 };
+		Mirror_RectCount = 1;
+		Mirror_PendingCount = 0;
+		Mirror_Flags = MIRROR_FLAG_KEY;
+		Mirror_KeyRequested = 0;
+		Mirror_LastKeyMs = now;
+		Mirror_Width = ILI9341_WIDTH;
+		Mirror_Statistics.keyframes++;
+	} else if (Mirror_PendingCount > 0) {
+		memcpy(Mirror_Rects, Mirror_Pending, Mirror_PendingCount * sizeof(ILI9341_FB_Rect));
+		Mirror_RectCount = Mirror_PendingCount;
+		Mirror_PendingCount = 0;
+		Mirror_Flags = 0;
+	} else {
+		return 0;
+	}
+
+	Mirror_Frame++;
+	Mirror_RectIndex = 0;
+	Mirror_Offset = 0;
+	Mirror_EncodeUs = 0;
+	return 1;
+}
+
+/**
+ * @brief  Freier Paketpuffer und dessen Nutzdatengröße für den aktuellen Weg
+ * @retval NULL, wenn der Sendeweg gerade kein Paket annimmt
+ */
+static uint8_t* Mirror_GetPacket(uint32_t *size) {
+	if (Mirror_Mode == MIRROR_UART) {
+		if (Serial_GetFree(&Serial_Shell) < MIRROR_UART_PAYLOAD + MIRROR_UART_OVERHEAD)
+			return NULL;
+		*size = MIRROR_UART_PAYLOAD;
+		return Mirror_Packets[0];
+	}
+
+	if (Mirror_Busy[Mirror_Next])
+		return NULL;
+	*size = MIRROR_LINK_PAYLOAD;
+	return Mirror_Packets[Mirror_Next];
+}
+
+static uint8_t Mirror_Transmit(uint8_t *packet, uint32_t length) {
+	if (Mirror_Mode == MIRROR_UART)
+		return Telemetry_SendPacket(TELEMETRY_PKT_MIRROR, packet, length);
+
+	uint8_t index = Mirror_Next;
+	Mirror_Busy[index] = 1;
+	if (!EspLink_Send(ESPLINK_CH_DISPLAY, packet, length, Mirror_Frame, Mirror_LinkDone, (void*)&Mirror_Busy[index])) {
+		Mirror_Busy[index] = 0;
+		return 0;
+	}
+	Mirror_Next ^= 1;
+	return 1;
+}
+
+/**
+ * @brief  EspLink hat den Paketpuffer gelesen (Interrupt); verworfen heißt, der Empfänger ist nicht mehr aktuell
+ */
+static void Mirror_LinkDone(const void *data, uint32_t length, uint8_t sent, void *context) {
+	*(volatile uint8_t*)context = 0;
+	if (!sent)
+		Mirror_Failed = 1;
+}
+
+/**
+ * @brief  Kodiert ab Mirror_Offset so viel des aktuellen Bereichs, wie in das Paket passt, und
+ *         gleicht den Schatten an; am Ende des Bereichs geht es mit dem nächsten weiter
+ * @param  size: Platz für Kopf und Token
+ * @retval Länge des Pakets
+ */
+static uint32_t Mirror_Encode(const uint16_t *fb, uint8_t *packet, uint32_t size) {
+	const ILI9341_FB_Rect *r = &Mirror_Rects[Mirror_RectIndex];
+	uint16_t width = r->x2 - r->x1 + 1;
+	uint16_t height = r->y2 - r->y1 + 1;
+	uint32_t total = (uint32_t)width * height;
+	uint32_t stride = ILI9341_WIDTH;
+	uint32_t first = Mirror_Offset;
+	uint32_t pos = first;
+	uint32_t at = (r->y1 + pos / width) * stride + r->x1 + pos % width;
+	uint16_t col = pos % width;
+	uint8_t *out = packet + MIRROR_HEADER_SIZE;
+	uint8_t *end = packet + size;
+
+	while (pos < total) {
+		uint16_t value = fb[at];
+		uint32_t a = at;
+		uint16_t c = col;
+		uint32_t n = 1;
+
+		if (value == Mirror_Shadow[at]) {
+			if (out + 1 > end)
+				break;
+			Mirror_Step(&a, &c, width, stride);
+			while (n < MIRROR_MAX_SKIP && pos + n < total && fb[a] == Mirror_Shadow[a]) {
+				Mirror_Step(&a, &c, width, stride);
+				n++;
+			}
+			*out++ = (uint8_t)(n - 1);
+		} else if (pos + 1 < total && fb[Mirror_After(at, col, width, stride)] == value) {
+			if (out + 3 > end)
+				break;
+			Mirror_Shadow[at] = value;
+			Mirror_Step(&a, &c, width, stride);
+			while (n < MIRROR_MAX_REPEAT && pos + n < total && fb[a] == value) {
+				Mirror_Shadow[a] = value;
+				Mirror_Step(&a, &c, width, stride);
+				n++;
+			}
+			*out++ = (uint8_t)(0x40 | (n - 1));
+			memcpy(out, &value, 2);
+			out += 2;
+		} else {
+			if (out + 3 > end)
+				break;
+			uint8_t *token = out++;
+			memcpy(out, &value, 2);
+			out += 2;
+			Mirror_Shadow[at] = value;
+			Mirror_Step(&a, &c, width, stride);
+			// Up to an unchanged pixel or the start of a run, both code shorter as their own token
+			while (n < MIRROR_MAX_LITERAL && pos + n < total && out + 2 <= end) {
+				uint16_t v = fb[a];
+				if (v == Mirror_Shadow[a] || (pos + n + 1 < total && fb[Mirror_After(a, c, width, stride)] == v))
+					break;
+				memcpy(out, &v, 2);
+				out += 2;
+				Mirror_Shadow[a] = v;
+				Mirror_Step(&a, &c, width, stride);
+				n++;
+			}
+			*token = (uint8_t)(0x80 | (n - 1));
+		}
+		pos += n;
+		at = a;
+		col = c;
+	}
+	Mirror_Statistics.pixels += pos - first;
+
+	uint8_t flags = Mirror_Flags;
+	Mirror_Offset = pos;
+	if (pos >= total) {
+		Mirror_Offset = 0;
+		if (++Mirror_RectIndex >= Mirror_RectCount)
+			flags |= MIRROR_FLAG_END;
+	}
+
+	uint16_t header[MIRROR_HEADER_SIZE / 2] = { Mirror_Frame, flags, r->x1, r->y1, width, height,
+			(uint16_t)first, (uint16_t)(first >> 16) };
+	memcpy(packet, header, MIRROR_HEADER_SIZE);
+	return (uint32_t)(out - packet);
+}
+
+#endif /* MIRROR_ENABLE */
@@ -0,0 +1,241 @@
+/**
+ * @file    Overlay.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Code-Overlays: selten gebrauchte, rechenintensive Module im ITCM, abgelegt im W25Qxx
+ *
+ * Funktionen mit OVERLAY(name) landen in der Ausgabesektion .ovl_name. Alle Overlays sind
+ * für denselben Bereich ITCM_OVL (16 KB am Ende des ITCM) gelinkt, ihre Ladeadressen liegen
+ * hintereinander in QSPI_OVL, also im Memory-Mapped-Fenster ab OVERLAY_STORE_ADDRESS. Der
+ * interne Flash enthält von ihnen nichts; nach dem Build wird CLionTest_ovl.bin wie das
+ * Asset-Bundle an OVERLAY_STORE_ADDRESS geschrieben.
+ *
+ * Overlay_Load() kopiert ein Overlay per MDMA aus dem Fenster in das ITCM (der MDMA erreicht
+ * das ITCM über den AHBS-Port) und hält es fest, bis Overlay_Release() es zurückgibt. Ist es
+ * schon geladen, kostet der Aufruf nichts; hält jemand ein anderes, liefert Overlay_Load() 0
+ * und der Aufrufer lässt die Arbeit aus. Aufrufe sind verschachtelbar, Interrupts dürfen keinen
+ * Overlay-Code aufrufen.
+ *
+ * Vor dem ersten Laden vergleicht Overlay_Init() die Build-ID der Firmware (.note.gnu.build-id im
+ * internen Flash) mit der Kopie vor den Overlays (.ovl_stamp, nach dem Linken eingesetzt).
+ * Gehört die Ablage zu einem anderen Build, etwa nach einem Update nur des internen Flashs,
+ * bleiben die Overlays gesperrt, statt fremden Code auszuführen.
+ */
+
+#include "Overlay.h"
+#include "Asset.h"
+#include "W25Qxx_QSPI.h"
+#include "DmaAlloc.h"
+#include <stdio.h>
+#include <string.h>
+
+#if OVERLAY_STORE_ADDRESS < ASSET_BUNDLE_ADDRESS + ASSET_BUNDLE_MAX_SIZE
+#error "OVERLAY_STORE_ADDRESS überschneidet sich mit dem Asset-Bundle!"
+#endif
+
+/* Wartezeit auf einen MDMA-Transfer; 16 KB aus dem Fenster brauchen etwa 100 us */
+#define OVERLAY_MDMA_TIMEOUT_MS   10
+
+/* .note.gnu.build-id: namesz, descsz, type, "GNU\0", 20 Bytes SHA-1 */
+#define OVERLAY_STAMP_SIZE        36
+#define OVERLAY_BUILD_ID_SIZE     20
+
+#define OVERLAY_NONE              0xFF
+
+/* Symbols of the linker script, the __load_* ones are provided by OVERLAY for each section */
+extern const uint8_t _sbuild_id[];
+extern const uint8_t _sovl_stamp[];
+extern uint8_t _sitcm_ovl[];
+extern const uint8_t __load_start_ovl_dsp[], __load_stop_ovl_dsp[];
+extern const uint8_t __load_start_ovl_jpeg[], __load_stop_ovl_jpeg[];
+
+/**
+ * @brief Ladebereich eines Overlays im Memory-Mapped-Fenster
+ */
+typedef struct {
+	const char *name;
+	const uint8_t *start;
+	const uint8_t *stop;
+} Overlay_Entry;
+
+static const Overlay_Entry Overlay_Table[OVERLAY_COUNT] = {
+	{ "dsp",  __load_start_ovl_dsp,  __load_stop_ovl_dsp },
+	{ "jpeg", __load_start_ovl_jpeg, __load_stop_ovl_jpeg },
+};
+
+Overlay_Stats Overlay_Statistics = {0};
+
+static MDMA_HandleTypeDef Overlay_Mdma;
+static uint8_t Overlay_Checked = 0;
+static uint8_t Overlay_Valid = 0;
+static const char *Overlay_Error = NULL;
+static uint8_t Overlay_Resident = OVERLAY_NONE;
+static uint8_t Overlay_Holds = 0;
+
+static uint8_t Overlay_Check(void);
+static uint8_t Overlay_Copy(const uint8_t *source, uint32_t size);
+
+/**
+ * @brief  Prüft die Ablage im W25Qxx und richtet den MDMA-Kanal ein (einmalig, auch aus Overlay_Load())
+ * @retval 1 wenn die Overlays geladen werden können
+ */
+uint8_t Overlay_Init(void) {
+	if (Overlay_Checked) {
+		return Overlay_Valid;
+	}
+	Overlay_Checked = 1;
+	Overlay_Valid = Overlay_Check();
+	if (!Overlay_Valid) {
+		printf("Overlays gesperrt: %s\n", Overlay_Error);
+	}
+	return Overlay_Valid;
+}
+
+/**
+ * @brief  Lädt ein Overlay in das ITCM, falls nötig, und hält es bis Overlay_Release() fest
+ * @retval 1 wenn die Funktionen des Overlays aufgerufen werden dürfen, 0 wenn die Ablage
+ *         ungültig ist oder ein anderes Overlay gehalten wird
+ */
+uint8_t Overlay_Load(Overlay_Id id) {
+	if (id >= OVERLAY_COUNT || !Overlay_Init()) {
+		Overlay_Statistics.failures++;
+		return 0;
+	}
+	if (Overlay_Resident == id) {
+		Overlay_Holds++;
+		Overlay_Statistics.hits++;
+		return 1;
+	}
+	if (Overlay_Holds > 0) {
+		Overlay_Statistics.refused++;
+		return 0;
+	}
+
+	const Overlay_Entry *entry = &Overlay_Table[id];
+	uint32_t size = (uint32_t)(entry->stop - entry->start);
+	uint32_t start = DWT->CYCCNT;
+
+	// The area is overwritten from here on, a failed copy leaves no overlay resident
+	Overlay_Resident = OVERLAY_NONE;
+	if (size > 0 && !Overlay_Copy(entry->start, size)) {
+		Overlay_Statistics.failures++;
+		return 0;
+	}
+	__DSB();
+	__ISB();
+
+	uint32_t us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000UL);
+	Overlay_Statistics.lastLoadUs = us;
+	if (us > Overlay_Statistics.maxLoadUs) Overlay_Statistics.maxLoadUs = us;
+	Overlay_Statistics.loads++;
+
+	Overlay_Resident = id;
+	Overlay_Holds = 1;
+	return 1;
+}
+
+/**
+ * @brief  Gibt ein mit Overlay_Load() gehaltenes Overlay frei; es bleibt geladen, bis ein anderes kommt
+ */
+void Overlay_Release(Overlay_Id id) {
+	if (id == Overlay_Resident && Overlay_Holds > 0) {
+		Overlay_Holds--;
+	}
+}
+
+/**
+ * @brief  Gibt Größe der Overlays, das geladene und die Zähler aus
+ */
+void Overlay_Dump(void) {
+	Overlay_Stats s = Overlay_Statistics;
+
+	printf("Overlays (ITCM ab 0x%08lX, Ablage 0x%06lX): %s\n", (uint32_t)_sitcm_ovl, OVERLAY_STORE_ADDRESS,
+			!Overlay_Checked ? "noch nicht geprüft" : Overlay_Valid ? "gültig" : Overlay_Error);
+	for (uint8_t id = 0; id < OVERLAY_COUNT; id++) {
+		const Overlay_Entry *entry = &Overlay_Table[id];
+		printf("  %-5s %6lu Bytes%s\n", entry->name, (uint32_t)(entry->stop - entry->start),
+				id == Overlay_Resident ? (Overlay_Holds > 0 ? " (geladen, gehalten)" : " (geladen)") : "");
+	}
+	printf("Geladen %lu (zuletzt %lu us, max %lu us), Treffer %lu, abgewiesen %lu, Fehler %lu\n",
+			s.loads, s.lastLoadUs, s.maxLoadUs, s.hits, s.refused, s.failures);
+}
+
+/**
+ * @brief  Vergleicht Lage und Build-ID der Ablage mit der Firmware und holt den MDMA-Kanal
+ * @retval 1 bei Erfolg, sonst 0 mit Grund in Overlay_Error
+ */
+static uint8_t Overlay_Check(void) {
+	if (_sovl_stamp != W25Qxx_MappedAddress(OVERLAY_STORE_ADDRESS)) {
+		Overlay_Error = "QSPI_OVL passt nicht zu OVERLAY_STORE_ADDRESS";
+		return 0;
+	}
+	if (((const uint32_t*)_sbuild_id)[1] != OVERLAY_BUILD_ID_SIZE) {
+		Overlay_Error = "Firmware ohne Build-ID gelinkt";
+		return 0;
+	}
+
+	uint8_t wasMapped = W25Qxx_IsMemoryMapped();
+	if (!wasMapped && !W25Qxx_EnableMemoryMapped()) {
+		Overlay_Error = "Memory-Mapped-Modus nicht verfügbar";
+		return 0;
+	}
+	SCB_InvalidateDCache_by_Addr((uint32_t*)_sovl_stamp, 64);
+	uint8_t match = memcmp(_sovl_stamp, _sbuild_id, OVERLAY_STAMP_SIZE) == 0;
+	if (!wasMapped) {
+		W25Qxx_DisableMemoryMapped();
+	}
+	if (!match) {
+		Overlay_Error = "Ablage gehört zu einem anderen Build";
+		return 0;
+	}
+
+	// Words from the window into the ITCM, the HAL selects the AHBS bus for TCM addresses
+	__HAL_RCC_MDMA_CLK_ENABLE();
+	if (!DmaAlloc_ClaimMdma(&Overlay_Mdma, "Overlay")) {
+		Overlay_Error = "kein MDMA-Kanal frei";
+		return 0;
+	}
+	Overlay_Mdma.Init.Request = MDMA_REQUEST_SW;
+	Overlay_Mdma.Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+	Overlay_Mdma.Init.Priority = MDMA_PRIORITY_HIGH;
+	Overlay_Mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+	Overlay_Mdma.Init.SourceInc = MDMA_SRC_INC_WORD;
+	Overlay_Mdma.Init.DestinationInc = MDMA_DEST_INC_WORD;
+	Overlay_Mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_WORD;
+	Overlay_Mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_WORD;
+	Overlay_Mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+	Overlay_Mdma.Init.BufferTransferLength = 128;
+	Overlay_Mdma.Init.SourceBurst = MDMA_SOURCE_BURST_32BEATS;
+	Overlay_Mdma.Init.DestBurst = MDMA_DEST_BURST_16BEATS;
+	Overlay_Mdma.Init.SourceBlockAddressOffset = 0;
+	Overlay_Mdma.Init.DestBlockAddressOffset = 0;
+
+	if (HAL_MDMA_Init(&Overlay_Mdma) != HAL_OK) {
+		Overlay_Error = "MDMA-Initialisierung fehlgeschlagen";
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Kopiert ein Overlay aus dem Memory-Mapped-Fenster nach ITCM_OVL und wartet darauf
+ * @param  source: Ladeadresse im Fenster, wortausgerichtet
+ * @param  size: Vielfaches von 4 (ALIGN(4) im Linkerskript), höchstens 16 KB
+ */
+static uint8_t Overlay_Copy(const uint8_t *source, uint32_t size) {
+	uint8_t wasMapped = W25Qxx_IsMemoryMapped();
+	if (!wasMapped && !W25Qxx_EnableMemoryMapped()) {
+		return 0;
+	}
+
+	uint8_t ok = HAL_MDMA_Start(&Overlay_Mdma, (uint32_t)source, (uint32_t)_sitcm_ovl, size, 1) == HAL_OK;
+	if (ok && HAL_MDMA_PollForTransfer(&Overlay_Mdma, HAL_MDMA_FULL_TRANSFER, OVERLAY_MDMA_TIMEOUT_MS) != HAL_OK) {
+		HAL_MDMA_Abort(&Overlay_Mdma);
+		ok = 0;
+	}
+
+	if (!wasMapped) {
+		W25Qxx_DisableMemoryMapped();
+	}
+	return ok;
+}
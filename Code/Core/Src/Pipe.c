@@ -0,0 +1,458 @@
+/**
+ * @file    Pipe.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Datenströme als Kette von Stufen (Quelle -> Verarbeitung -> Senken) ohne Kopien
+ *
+ * Ein ADC-Block soll durch einen Filter und danach an Logger, Telemetrie und Chart gehen. Jeder
+ * Empfänger mit eigener Kopie kostet Speicher und Zeit im Interrupt. Hier läuft stattdessen ein
+ * Deskriptor (Pipe_Buffer) durch die Stufen: Zeiger auf die Daten, Länge, Nummer, Zeitstempel
+ * und ein Referenzzähler. Jeder Platz in einer Warteschlange und jeder Halter (Pipe_Retain())
+ * ist eine Referenz. Pipe_Emit() reicht einen Puffer an alle Nachfolger einer Stufe weiter und
+ * erhöht dafür nur den Zähler; die Daten bleiben, wo sie sind. Fällt er auf 0, gehen die Daten
+ * an ihren Besitzer zurück: Blöcke aus Pipe_Alloc() an Pool_Free(), fremde Puffer über ihre
+ * Rückgabefunktion (z.B. ADC_ReleaseBlock()).
+ *
+ * Jede Stufe hat eine Eingangswarteschlange fester Tiefe. Ist sie voll, weist Pipe_Push() den
+ * Puffer ab und zählt ihn als verworfen (Rückstau); der Erzeuger erfährt es am Rückgabewert und
+ * kann mit Pipe_Room() vorher prüfen, ob seine Nachfolger noch Platz haben. Gewartet wird nie,
+ * ein Erzeuger im Interrupt bleibt so kurz wie vorher.
+ *
+ * Die Stufen laufen nacheinander im Pipe-Task (Reihenfolge der Anmeldung, vorne die Quellen),
+ * den jede Übergabe freigibt. Stufen mit PIPE_STAGE_INLINE laufen sofort im Kontext des
+ * Erzeugers, z.B. ein Verteiler im DMA-Interrupt. Je Stufe zählen angenommene, weitergegebene
+ * und verworfene Puffer, Bytes und Takte ('pipe' in der Shell).
+ *
+ * Deskriptoren kommen aus einer festen Tabelle mit Stapel freier Indizes wie in Pool.c,
+ * Anfordern und Freigeben sind O(1) und auch im Interrupt erlaubt.
+ */
+
+#include "Pipe.h"
+#include "Pool.h"
+#include "ADC.h"
+#include "Scheduler.h"
+#include "Timebase.h"
+#include <stdio.h>
+#include <string.h>
+
+static Pipe_Buffer Pipe_Buffers[PIPE_BUFFERS];
+
+// Stack of free descriptor indices, Pipe_FreeTop entries valid
+static uint8_t Pipe_FreeList[PIPE_BUFFERS];
+static uint8_t Pipe_FreeTop;
+static uint8_t Pipe_Ready;
+static uint8_t Pipe_InUse;
+static uint8_t Pipe_HighWater;
+static uint32_t Pipe_Failures;
+static uint32_t Pipe_Sequence;
+
+static Pipe_Stage *Pipe_Stages[PIPE_MAX_STAGES];
+static uint8_t Pipe_StageCount;
+static uint8_t Pipe_TaskId = SCHEDULER_INVALID_TASK;
+
+static Pipe_Buffer* Pipe_TakeDescriptor(void);
+static void Pipe_PutDescriptor(Pipe_Buffer *buffer);
+static void Pipe_Run(Pipe_Stage *stage, Pipe_Buffer *buffer);
+static uint8_t Pipe_AdcBlock(const ADC_Block *block, void *context);
+static void Pipe_AdcRelease(Pipe_Buffer *buffer);
+
+/**
+ * @brief  Übernimmt die Task-Nummer, der Task läuft erst mit angemeldeten Stufen
+ */
+void Pipe_Init(uint8_t taskId) {
+	Pipe_TaskId = taskId;
+	Scheduler_SetEnabled(taskId, Pipe_StageCount > 0);
+}
+
+/**
+ * @brief  Meldet eine Stufe an; Stufen in der Reihenfolge des Datenflusses anmelden
+ * @param  function: NULL = Verteiler, reicht jeden Puffer unverändert an die Nachfolger
+ * @param  flags: PIPE_STAGE_INLINE oder 0
+ * @retval 0 wenn schon PIPE_MAX_STAGES Stufen angemeldet sind
+ */
+uint8_t Pipe_AddStage(Pipe_Stage *stage, const char *name, Pipe_StageFunction function, void *context, uint8_t flags) {
+	if (Pipe_StageCount >= PIPE_MAX_STAGES) {
+		return 0;
+	}
+
+	memset(stage, 0, sizeof(*stage));
+	stage->name = name;
+	stage->function = function;
+	stage->context = context;
+	stage->flags = flags;
+	Pipe_Stages[Pipe_StageCount++] = stage;
+	Scheduler_SetEnabled(Pipe_TaskId, 1);
+	return 1;
+}
+
+/**
+ * @brief  Verbindet zwei Stufen; from gibt jeden Puffer aus Pipe_Emit() auch an to
+ * @retval 0 wenn from schon PIPE_MAX_OUTPUTS Nachfolger hat
+ */
+uint8_t Pipe_Connect(Pipe_Stage *from, Pipe_Stage *to) {
+	if (from->outputCount >= PIPE_MAX_OUTPUTS) {
+		return 0;
+	}
+	from->outputs[from->outputCount++] = to;
+	return 1;
+}
+
+/**
+ * @brief  Neuer Puffer mit size Bytes aus dem Blockpool (höchstens POOL_BLOCK_SIZE), eine Referenz
+ * @retval NULL, wenn kein Deskriptor oder Block frei ist
+ */
+Pipe_Buffer* Pipe_Alloc(uint32_t size) {
+	void *data = Pool_Alloc(size);
+	if (data == NULL) {
+		Pipe_Failures++;
+		return NULL;
+	}
+
+	Pipe_Buffer *buffer = Pipe_Wrap(data, size, NULL, NULL);
+	if (buffer == NULL) {
+		Pool_Free(data);
+	}
+	return buffer;
+}
+
+/**
+ * @brief  Deskriptor für fremden Speicher, eine Referenz; release bekommt ihn bei der letzten Freigabe
+ * @param  release: darf NULL sein, wenn data aus Pool_Alloc() stammt
+ * @retval NULL, wenn kein Deskriptor frei ist
+ */
+Pipe_Buffer* Pipe_Wrap(void *data, uint32_t length, Pipe_ReleaseFunction release, void *owner) {
+	Pipe_Buffer *buffer = Pipe_TakeDescriptor();
+	if (buffer == NULL) {
+		Pipe_Failures++;
+		return NULL;
+	}
+
+	buffer->data = data;
+	buffer->length = length;
+	buffer->sequence = Pipe_Sequence++;
+	buffer->timeUs = Timebase_Us();
+	buffer->meta = NULL;
+	buffer->release = release;
+	buffer->owner = owner;
+	buffer->refs = 1;
+	return buffer;
+}
+
+/**
+ * @brief  Zusätzliche Referenz, z.B. um einen Puffer über den Aufruf der Stufe hinaus zu halten
+ */
+void Pipe_Retain(Pipe_Buffer *buffer) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	buffer->refs++;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt eine Referenz ab; mit der letzten gehen die Daten an ihren Besitzer zurück
+ */
+void Pipe_Release(Pipe_Buffer *buffer) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint8_t last = buffer->refs > 0 && --buffer->refs == 0;
+	__set_PRIMASK(primask);
+
+	if (!last) {
+		return;
+	}
+	if (buffer->release != NULL) {
+		buffer->release(buffer);
+	} else {
+		Pool_Free(buffer->data);
+	}
+	Pipe_PutDescriptor(buffer);
+}
+
+/**
+ * @brief  Übergibt einen Puffer samt der Referenz des Aufrufers an eine Stufe
+ *
+ * Ist die Warteschlange voll, wird der Puffer verworfen (die Referenz freigegeben) und bei der
+ * Stufe gezählt. Eine Stufe mit PIPE_STAGE_INLINE läuft sofort.
+ *
+ * @retval 1 angenommen, 0 verworfen
+ */
+uint8_t Pipe_Push(Pipe_Stage *stage, Pipe_Buffer *buffer) {
+	if (stage->flags & PIPE_STAGE_INLINE) {
+		stage->stats.in++;
+		Pipe_Run(stage, buffer);
+		Pipe_Release(buffer);
+		return 1;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t head = stage->head;
+	uint32_t depth = head - stage->tail;
+	if (depth >= PIPE_QUEUE_DEPTH) {
+		stage->stats.drops++;
+		__set_PRIMASK(primask);
+		Pipe_Release(buffer);
+		return 0;
+	}
+
+	stage->queue[head & (PIPE_QUEUE_DEPTH - 1)] = buffer;
+	// The slot must be written before the consumer sees the new head
+	__DMB();
+	stage->head = head + 1;
+	stage->stats.in++;
+	if (depth + 1 > stage->stats.maxDepth) {
+		stage->stats.maxDepth = (uint8_t)(depth + 1);
+	}
+
+	__set_PRIMASK(primask);
+	Scheduler_Release(Pipe_TaskId);
+	return 1;
+}
+
+/**
+ * @brief  Reicht einen Puffer an alle Nachfolger einer Stufe weiter, je Nachfolger eine Referenz
+ *
+ * Die Referenz des Aufrufers bleibt bei ihm, er gibt sie wie gewohnt frei (in einer Stufenfunktion
+ * erledigt das der Task nach dem Aufruf).
+ *
+ * @retval Anzahl der Nachfolger, die den Puffer angenommen haben
+ */
+uint8_t Pipe_Emit(Pipe_Stage *stage, Pipe_Buffer *buffer) {
+	uint8_t accepted = 0;
+
+	for (uint8_t i = 0; i < stage->outputCount; i++) {
+		Pipe_Retain(buffer);
+		accepted += Pipe_Push(stage->outputs[i], buffer);
+	}
+	stage->stats.out += accepted;
+	if (accepted < stage->outputCount) {
+		stage->stats.blocked++;
+	}
+	return accepted;
+}
+
+/**
+ * @brief  Freie Plätze beim vollsten Nachfolger; 0 heißt, der nächste Pipe_Emit() verliert etwas
+ */
+uint8_t Pipe_Room(const Pipe_Stage *stage) {
+	uint32_t room = stage->outputCount ? PIPE_QUEUE_DEPTH : 0;
+
+	for (uint8_t i = 0; i < stage->outputCount; i++) {
+		const Pipe_Stage *output = stage->outputs[i];
+		if (output->flags & PIPE_STAGE_INLINE) {
+			continue;
+		}
+		uint32_t space = PIPE_QUEUE_DEPTH - (output->head - output->tail);
+		if (space < room) {
+			room = space;
+		}
+	}
+	return (uint8_t)room;
+}
+
+/**
+ * @brief  Macht source zur Quelle der ADC-Blöcke im Messbetrieb
+ *
+ * Jeder Block geht ohne Kopie als Puffer an die Nachfolger von source (data zeigt in den
+ * DMA-Puffer, meta auf den ADC_Block, nur lesen). Ein voller Nachfolger verliert nur selbst
+ * den Block, die übrigen bekommen ihn trotzdem. Der ADC hält die Hälfte, bis der letzte
+ * Nachfolger sie freigibt; bleibt sie länger als einen Block liegen, verwirft ADC.c den
+ * nächsten Block dieser Hälfte (ADC_AcqStats.drops).
+ *
+ * @param  source: angemeldete Stufe, ihre Funktion wird nicht aufgerufen
+ * @retval 0 wenn alle ADC_ACQ_MAX_LISTENERS Empfänger belegt sind
+ */
+uint8_t Pipe_AttachAdc(Pipe_Stage *source) {
+	return ADC_AddBlockListener(Pipe_AdcBlock, source);
+}
+
+/**
+ * @brief  Arbeitet die Warteschlangen aller Stufen ab, je Stufe höchstens PIPE_QUEUE_DEPTH Puffer
+ */
+void Pipe_Task(void *context) {
+	(void)context;
+	uint8_t pending = 0;
+
+	for (uint8_t s = 0; s < Pipe_StageCount; s++) {
+		Pipe_Stage *stage = Pipe_Stages[s];
+
+		for (uint8_t n = 0; n < PIPE_QUEUE_DEPTH && stage->tail != stage->head; n++) {
+			uint32_t tail = stage->tail;
+
+			// Read the slot only after the head that published it
+			__DMB();
+			Pipe_Buffer *buffer = stage->queue[tail & (PIPE_QUEUE_DEPTH - 1)];
+			stage->tail = tail + 1;
+
+			Pipe_Run(stage, buffer);
+			Pipe_Release(buffer);
+		}
+		if (stage->tail != stage->head) {
+			pending = 1;
+		}
+	}
+
+	if (pending) {
+		Scheduler_Release(Pipe_TaskId);
+	}
+}
+
+/**
+ * @brief  Anzahl der angemeldeten Stufen
+ */
+uint8_t Pipe_GetStageCount(void) {
+	return Pipe_StageCount;
+}
+
+/**
+ * @brief  Angemeldete Stufe in der Reihenfolge der Anmeldung, NULL außerhalb
+ */
+Pipe_Stage* Pipe_GetStage(uint8_t index) {
+	return index < Pipe_StageCount ? Pipe_Stages[index] : NULL;
+}
+
+/**
+ * @brief  Setzt die Zähler aller Stufen und den Höchststand der Deskriptoren zurück
+ */
+void Pipe_ResetStats(void) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for (uint8_t s = 0; s < Pipe_StageCount; s++) {
+		memset(&Pipe_Stages[s]->stats, 0, sizeof(Pipe_StageStats));
+	}
+	Pipe_HighWater = Pipe_InUse;
+	Pipe_Failures = 0;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt Deskriptoren und alle Stufen mit Durchsatz und Rückstau aus (Shell 'pipe')
+ */
+void Pipe_Dump(void) {
+	uint32_t cyclesPerUs = SystemCoreClock / 1000000UL;
+
+	printf("Pipe: %u Stufen, %u/%u Puffer belegt (Höchststand %u), %lu Fehlschläge\n",
+			Pipe_StageCount, Pipe_InUse, PIPE_BUFFERS, Pipe_HighWater, (unsigned long)Pipe_Failures);
+
+	for (uint8_t s = 0; s < Pipe_StageCount; s++) {
+		const Pipe_Stage *stage = Pipe_Stages[s];
+		const Pipe_StageStats *st = &stage->stats;
+		uint32_t meanUs = st->in ? (uint32_t)(st->cycles / st->in / cyclesPerUs) : 0;
+
+		printf("  %-10s %-6s ein %lu, weiter %lu, verworfen %lu, Rückstau %lu, %lu KB, Tiefe max %u/%u, %lu us je Puffer (max %lu us), ->",
+				stage->name, stage->function == NULL ? "Quelle" : (stage->flags & PIPE_STAGE_INLINE) ? "direkt" : "Task",
+				(unsigned long)st->in, (unsigned long)st->out, (unsigned long)st->drops, (unsigned long)st->blocked,
+				(unsigned long)(st->bytes / 1024U), st->maxDepth, PIPE_QUEUE_DEPTH,
+				(unsigned long)meanUs, (unsigned long)(st->maxCycles / cyclesPerUs));
+		for (uint8_t i = 0; i < stage->outputCount; i++) {
+			printf(" %s", stage->outputs[i]->name);
+		}
+		printf(stage->outputCount ? "\n" : " (Senke)\n");
+	}
+}
+
+/* --------------------------------- Intern --------------------------------- */
+
+/**
+ * @brief  Nimmt einen Deskriptor vom Stapel, legt beim ersten Zugriff alle darauf
+ */
+static Pipe_Buffer* Pipe_TakeDescriptor(void) {
+	Pipe_Buffer *buffer = NULL;
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!Pipe_Ready) {
+		for (uint8_t i = 0; i < PIPE_BUFFERS; i++) {
+			Pipe_FreeList[i] = PIPE_BUFFERS - 1 - i;
+		}
+		Pipe_FreeTop = PIPE_BUFFERS;
+		Pipe_Ready = 1;
+	}
+	if (Pipe_FreeTop > 0) {
+		buffer = &Pipe_Buffers[Pipe_FreeList[--Pipe_FreeTop]];
+		if (++Pipe_InUse > Pipe_HighWater) {
+			Pipe_HighWater = Pipe_InUse;
+		}
+	}
+
+	__set_PRIMASK(primask);
+	return buffer;
+}
+
+/**
+ * @brief  Legt einen Deskriptor ohne Referenzen zurück auf den Stapel
+ */
+static void Pipe_PutDescriptor(Pipe_Buffer *buffer) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Pipe_FreeList[Pipe_FreeTop++] = (uint8_t)(buffer - Pipe_Buffers);
+	Pipe_InUse--;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Ruft die Stufenfunktion auf (Verteiler: Pipe_Emit()) und zählt Bytes und Takte
+ */
+static void Pipe_Run(Pipe_Stage *stage, Pipe_Buffer *buffer) {
+	uint32_t start = DWT->CYCCNT;
+
+	if (stage->function != NULL) {
+		stage->function(stage, buffer);
+	} else {
+		Pipe_Emit(stage, buffer);
+	}
+
+	uint32_t cycles = DWT->CYCCNT - start;
+	stage->stats.cycles += cycles;
+	if (cycles > stage->stats.maxCycles) {
+		stage->stats.maxCycles = cycles;
+	}
+	stage->stats.bytes += buffer->length;
+}
+
+/**
+ * @brief  Empfänger der ADC-Blöcke (DMA-Interrupt): Block als Puffer an die Nachfolger der Quelle
+ *
+ * Die eigene Referenz hält den Puffer, bis alle Nachfolger ihn haben. Danach entscheidet der
+ * Zählerstand unter gesperrten Interrupts, ob noch jemand liest: dann bleibt der Block beim ADC
+ * gehalten (Rückgabe 1, die letzte Freigabe ruft ADC_ReleaseBlock()). Hat ihn niemand genommen
+ * oder haben direkte Stufen ihn schon fertig verarbeitet, geht nur der Deskriptor zurück, ohne
+ * ADC_ReleaseBlock() für einen Halt, den es noch nicht gibt.
+ *
+ * @retval 1 = Block wird noch gebraucht
+ */
+static uint8_t Pipe_AdcBlock(const ADC_Block *block, void *context) {
+	Pipe_Stage *source = context;
+	uint32_t length = (uint32_t)block->scans * block->slots * sizeof(uint16_t);
+
+	// Read-only for the consumers, the DMA owns the buffer
+	Pipe_Buffer *buffer = Pipe_Wrap((void*)block->data, length, Pipe_AdcRelease, NULL);
+	if (buffer == NULL) {
+		source->stats.drops++;
+		return 0;
+	}
+	buffer->meta = block;
+	buffer->sequence = block->sequence;
+
+	source->stats.in++;
+	Pipe_Run(source, buffer);
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint8_t held = buffer->refs > 1;
+	buffer->refs--;
+	__set_PRIMASK(primask);
+
+	if (!held) {
+		Pipe_PutDescriptor(buffer);
+	}
+	return held;
+}
+
+/**
+ * @brief  Letzte Referenz auf einen ADC-Block: Hälfte an die DMA zurück
+ */
+static void Pipe_AdcRelease(Pipe_Buffer *buffer) {
+	ADC_ReleaseBlock(buffer->meta);
+}
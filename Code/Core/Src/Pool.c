@@ -0,0 +1,96 @@
+/**
+ * @file    Pool.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Pool fester Blöcke für Zwischenpuffer der Treiber
+ *
+ * Statt Arrays variabler Länge auf dem Stack (Größe vom Aufrufer abhängig, Stackbedarf nicht
+ * abschätzbar, nicht DMA-tauglich) holen sich die Treiber kurzlebige Puffer hier. Alle Blöcke
+ * sind POOL_BLOCK_SIZE groß, liegen auf Cache-Zeilen ausgerichtet im nicht cachebaren RAM_CD
+ * (DMA_BUFFER) und dürfen also direkt an SPI-, I2C- oder UART-DMA übergeben werden.
+ *
+ * Freie Blöcke stehen als Indizes auf einem Stapel: Pool_Alloc() und Pool_Free() sind O(1)
+ * und sperren die Interrupts nur für zwei Zugriffe, beide dürfen also auch aus Interrupts
+ * gerufen werden. Ist kein Block frei oder die Anforderung zu groß, liefert Pool_Alloc() NULL;
+ * der Aufrufer meldet dann einen Fehler (HAL_ERROR) statt zu warten.
+ *
+ * Pool_GetStats() zeigt den Höchststand gleichzeitig belegter Blöcke ('pool' in der Shell),
+ * daran lässt sich POOL_BLOCK_COUNT bemessen.
+ */
+
+#include "Pool.h"
+#include "Cache.h"
+
+static uint8_t Pool_Memory[POOL_BLOCK_COUNT][POOL_BLOCK_SIZE] DMA_BUFFER;
+
+// Stack of free block indices, Pool_Top entries valid
+static uint8_t Pool_FreeList[POOL_BLOCK_COUNT];
+static uint8_t Pool_Top;
+static uint8_t Pool_Ready;
+static Pool_Stats Pool_Statistics;
+
+static void Pool_Init(void);
+
+/**
+ * @brief  Holt einen Block mit mindestens size Bytes
+ * @retval Zeiger auf den Block (32 Byte ausgerichtet, nicht cachebar) oder NULL
+ */
+void* Pool_Alloc(uint32_t size) {
+	void *block = NULL;
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!Pool_Ready) Pool_Init();
+	if (size > Pool_Statistics.largest) Pool_Statistics.largest = size;
+
+	if (size <= POOL_BLOCK_SIZE && Pool_Top > 0) {
+		block = Pool_Memory[Pool_FreeList[--Pool_Top]];
+		Pool_Statistics.allocs++;
+		Pool_Statistics.inUse++;
+		if (Pool_Statistics.inUse > Pool_Statistics.highWater) {
+			Pool_Statistics.highWater = Pool_Statistics.inUse;
+		}
+	} else {
+		Pool_Statistics.failures++;
+	}
+
+	__set_PRIMASK(primask);
+	return block;
+}
+
+/**
+ * @brief  Gibt einen Block aus Pool_Alloc() zurück, NULL wird ignoriert
+ */
+void Pool_Free(void *block) {
+	if (block == NULL) return;
+
+	uint32_t index = ((uint8_t*)block - &Pool_Memory[0][0]) / POOL_BLOCK_SIZE;
+	if (index >= POOL_BLOCK_COUNT) return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Pool_FreeList[Pool_Top++] = (uint8_t)index;
+	Pool_Statistics.inUse--;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Kopiert die Zähler
+ */
+void Pool_GetStats(Pool_Stats *stats) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	*stats = Pool_Statistics;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Legt beim ersten Zugriff alle Blöcke auf den Stapel (.dma_buffer wird nicht genullt)
+ */
+static void Pool_Init(void) {
+	for (uint8_t i = 0; i < POOL_BLOCK_COUNT; i++) {
+		Pool_FreeList[i] = POOL_BLOCK_COUNT - 1 - i;
+	}
+	Pool_Top = POOL_BLOCK_COUNT;
+	Pool_Ready = 1;
+}
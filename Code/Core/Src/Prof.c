@@ -0,0 +1,208 @@
+/**
+ * @file    Prof.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Laufzeitmessung einzelner Subsysteme mit dem DWT-Zykluszähler
+ *
+ * HAL_GetTick() löst nur Millisekunden auf. Der DWT-Zähler CYCCNT zählt dagegen jeden
+ * CPU-Takt und läuft bei 280 MHz nach gut 15 s über; gemessen wird die Differenz zweier
+ * Zählerstände, ein Überlauf dazwischen ist unschädlich, solange ein Abschnitt kürzer ist.
+ *
+ * Je Messpunkt werden Anzahl, Minimum, Maximum und Summe in Takten gesammelt. Die Kosten
+ * eines leeren PROF_BEGIN/PROF_END-Paars werden in Prof_Init() bestimmt und abgezogen.
+ * Ausgabe als Tabelle über printf (UART7) oder als Text auf dem ILI9341; die Umrechnung in
+ * Mikrosekunden nutzt SystemCoreClock, gilt also auch nach Clock_SetProfile(). Das Messfenster
+ * seit Prof_Reset() misst die µs-Zeitbasis (Timebase.h), die anders als CYCCNT nicht überläuft;
+ * daraus ergibt sich der Anteil jedes Messpunkts an der Laufzeit.
+ *
+ * Mit PROF_ENABLE 0 werden alle Makros leer und diese Datei übersetzt nichts.
+ */
+
+#include "Prof.h"
+#include "Fmt.h"
+
+#if PROF_ENABLE
+
+#include <stdio.h>
+#include "usart.h"
+#include "ILI9341.h"
+#include "Scheduler.h"
+#include "Timebase.h"
+
+Prof_Probe Prof_Probes[PROF_ID_COUNT];
+uint32_t Prof_Overhead = 0;
+uint8_t Prof_OverlayEnabled = 0;
+
+// Timebase_Us() at Prof_Reset(), start of the measurement window
+static uint64_t Prof_Since = 0;
+
+static const char *const Prof_Names[PROF_ID_COUNT] = {
+	[PROF_ID_MAIN_LOOP] = "MainLoop",
+	[PROF_ID_FB_FLUSH]  = "FB_Flush",
+	[PROF_ID_JPEG]      = "JPEG",
+	[PROF_ID_SDQUEUE]   = "SDQueue",
+	[PROF_ID_AHT20]     = "AHT20",
+	[PROF_ID_WS2812]    = "WS2812",
+	[PROF_ID_DSP]       = "DSP",
+	[PROF_ID_WIDGETS]   = "Widgets",
+};
+
+static uint32_t Prof_CyclesToUs10(uint64_t cycles);
+
+/**
+ * @brief  Schaltet den Zykluszähler ein und bestimmt die Eigenkosten eines Messpunkts
+ */
+void Prof_Init(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;    // unlock key, required on the M7 without a debugger attached
+	// Boot_Init() already counts from the start of main(), keep its time base
+	if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+
+	uint32_t start = DWT->CYCCNT;
+	Prof_Overhead = DWT->CYCCNT - start;
+
+	Prof_Reset();
+}
+
+/**
+ * @brief  Trägt eine Messung ein, wird von PROF_END() aufgerufen
+ * @param  id: Messpunkt
+ * @param  cycles: Gemessene Takte einschließlich der Eigenkosten
+ */
+RAMFUNC void Prof_Record(Prof_Id id, uint32_t cycles) {
+	Prof_Probe *p = &Prof_Probes[id];
+	uint32_t primask = __get_PRIMASK();
+
+	cycles = cycles > Prof_Overhead ? cycles - Prof_Overhead : 0;
+
+	// Probes may be recorded from interrupts as well as from the main loop
+	__disable_irq();
+	p->count++;
+	p->total += cycles;
+	if (cycles < p->min) p->min = cycles;
+	if (cycles > p->max) p->max = cycles;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Setzt die Statistik aller Messpunkte zurück
+ */
+void Prof_Reset(void) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	for (uint8_t i = 0; i < PROF_ID_COUNT; i++) {
+		Prof_Probes[i].count = 0;
+		Prof_Probes[i].min = UINT32_MAX;
+		Prof_Probes[i].max = 0;
+		Prof_Probes[i].total = 0;
+	}
+	Prof_Since = Timebase_Us();
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt alle Messpunkte als Tabelle über printf aus (Zeiten in µs)
+ *
+ * Anteil ist die Summe eines Messpunkts bezogen auf das Fenster seit Prof_Reset(), in 0,1 %.
+ * Nach einem Taktwechsel im Fenster stimmt er nur ungefähr (Summe in Takten, Umrechnung mit
+ * dem aktuellen Takt).
+ */
+void Prof_Dump(void) {
+	uint32_t load = Scheduler_GetLoad();
+	uint64_t windowUs = Timebase_Us() - Prof_Since;
+	uint64_t windowCycles = windowUs * (SystemCoreClock / 1000000UL);
+	uint32_t windowMs = (uint32_t)(windowUs / 1000U);
+
+	printf("\nProfil bei %lu MHz, CPU-Last %lu.%lu %%, Fenster %lu.%03lu s\n", SystemCoreClock / 1000000UL,
+			load / 10, load % 10, windowMs / 1000, windowMs % 1000);
+	printf("%-10s %8s %10s %10s %10s %8s\n", "Messpunkt", "Anzahl", "min [us]", "mittel", "max", "Anteil");
+
+	for (uint8_t i = 0; i < PROF_ID_COUNT; i++) {
+		Prof_Probe p = Prof_Probes[i];
+		if (p.count == 0) {
+			printf("%-10s %8s\n", Prof_Names[i], "-");
+			continue;
+		}
+
+		uint32_t min = Prof_CyclesToUs10(p.min);
+		uint32_t avg = Prof_CyclesToUs10(p.total / p.count);
+		uint32_t max = Prof_CyclesToUs10(p.max);
+		uint32_t share = windowCycles ? (uint32_t)(p.total * 1000U / windowCycles) : 0;
+		printf("%-10s %8lu %8lu.%lu %8lu.%lu %8lu.%lu %6lu.%lu%%\n", Prof_Names[i], p.count,
+				min / 10, min % 10, avg / 10, avg % 10, max / 10, max % 10, share / 10, share % 10);
+	}
+}
+
+/**
+ * @brief  Schreibt Mittelwert und Maximum aller Messpunkte auf das Display
+ * @param  x, y: Obere linke Ecke der Anzeige
+ */
+void Prof_DrawOverlay(uint16_t x, uint16_t y) {
+	char line[32];
+
+	for (uint8_t i = 0; i < PROF_ID_COUNT; i++) {
+		Prof_Probe p = Prof_Probes[i];
+		uint32_t avg = p.count ? Prof_CyclesToUs10(p.total / p.count) / 10 : 0;
+		uint32_t max = p.count ? Prof_CyclesToUs10(p.max) / 10 : 0;
+
+		Fmt_Format(line, sizeof(line), "%-9s %7lu %7lu us", Prof_Names[i], avg, max);
+		ILI9341_DrawText(line, x, y + i * 10 * PROF_OVERLAY_SIZE, BLACK, PROF_OVERLAY_SIZE, WHITE);
+	}
+
+	uint32_t load = Scheduler_GetLoad();
+	Fmt_Format(line, sizeof(line), "CPU %3lu.%lu %%", load / 10, load % 10);
+	ILI9341_DrawText(line, x, y + PROF_ID_COUNT * 10 * PROF_OVERLAY_SIZE, BLACK, PROF_OVERLAY_SIZE, WHITE);
+}
+
+/**
+ * @brief  Wertet ein empfangenes Zeichen auf UART7 aus, ohne zu blockieren
+ *
+ * Aus der Hauptschleife aufrufen. Kennt PROF_CMD_DUMP, PROF_CMD_RESET, PROF_CMD_OVERLAY
+ * und PROF_CMD_TASKS; Zurücksetzen betrifft auch die Statistik des Schedulers.
+ */
+void Prof_PollCommand(void) {
+	if (__HAL_UART_GET_FLAG(&huart7, UART_FLAG_ORE))
+		__HAL_UART_CLEAR_FLAG(&huart7, UART_CLEAR_OREF);
+
+	if (!__HAL_UART_GET_FLAG(&huart7, UART_FLAG_RXNE))
+		return;
+
+	switch ((char)(huart7.Instance->RDR & 0xFF)) {
+		case PROF_CMD_DUMP:
+			Prof_Dump();
+			break;
+		case PROF_CMD_RESET:
+			Prof_Reset();
+			Scheduler_ResetStats();
+			printf("Profil zurückgesetzt\n");
+			break;
+		case PROF_CMD_OVERLAY:
+			Prof_OverlayEnabled = !Prof_OverlayEnabled;
+			break;
+		case PROF_CMD_TASKS:
+			Scheduler_Dump();
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief  Gibt an, ob die Anzeige auf dem Display per PROF_CMD_OVERLAY eingeschaltet ist
+ */
+uint8_t Prof_IsOverlayEnabled(void) {
+	return Prof_OverlayEnabled;
+}
+
+/**
+ * @brief  Rechnet Takte in Zehntel-Mikrosekunden um
+ */
+static uint32_t Prof_CyclesToUs10(uint64_t cycles) {
+	return (uint32_t)(cycles * 10U / (SystemCoreClock / 1000000UL));
+}
+
+#endif /* PROF_ENABLE */
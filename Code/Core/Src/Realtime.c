@@ -8,8 +8,15 @@
 #include <stdio.h>
 
 #include "AHT20.h"
+#include "Scheduler.h"
+#include "Timer.h"
+#include "DmaAlloc.h"
+#include "adc.h"
 #include "ILI9341.h"
 #include "SSD1306.h"
+#include "UserInput.h"
+#include "Gamepad.h"
+#include "LowPower.h"
 #include "stm32h7xx_hal.h"
 #include "tim.h"
 #include "Fonts/ssd1306_fonts.h"
@@ -32,22 +39,138 @@
  *      Funktion HAL_TIM_PeriodElapsedCallback() aufruft, welche wiederum die Realtime_Loop()     *
  *      Funktion ausführt.                                                                        *
  *                                                                                                *
+ *      Realtime_Loop() gibt über Scheduler_Tick() die fälligen Tasks frei (siehe Scheduler.c).   *
+ *      Vorher entprellt UserInput_Tick() die Taster und den Joystick, Timer_Tick() dreht das     *
+ *      Timer-Rad der Software-Timer weiter (siehe Timer.c).                                      *
+ *                                                                                                *
+ *      Tickless-Betrieb: Realtime_Sleep() verlängert die Periode von TIM7 bis zur nächsten       *
+ *      Freigabe, hält den SysTick-Interrupt an und schläft mit WFI. Der nächste Interrupt von    *
+ *      TIM7 zählt dann mehrere Millisekunden auf einmal und stellt wieder 1 ms ein. Weckt ein    *
+ *      anderer Interrupt früher, endet der lange Zyklus an der nächsten Millisekundengrenze.     *
+ *      uwTick (HAL_GetTick) wird um die verschlafenen Millisekunden nachgeführt.                 *
+ *      Ist lange genug nichts zu tun, schläft der Kern im Stop-Modus statt mit WFI (LowPower.c). *
+ *                                                                                                *
  **************************************************************************************************/
 
 
+// Millisekunden, die der laufende Zyklus von TIM7 abdeckt (1 außer im Tickless-Betrieb)
+volatile uint32_t Realtime_TickMs = 1;
+
 void Realtime_Init(void) {
     // Timer 7 mit Interrupt starten
     HAL_TIM_Base_Start_IT(&htim7);
 }
 
 void Realtime_Loop(void) {
-    // Diese Funktion wird exakt alle 1 ms durch den Timer 7 Interrupt aufgerufen
+    // Diese Funktion wird alle 1 ms durch den Timer 7 Interrupt aufgerufen,
+    // nach einem Tickless-Schlaf einmal für alle verschlafenen Millisekunden
     static uint32_t ms_counter = 0;
-    ms_counter++;
+    static uint32_t next_poti = ADC_POTI_PUBLISH_MS;
+    uint32_t elapsed = Realtime_TickMs;
+
+    if (elapsed != 1) {
+        // Long cycle from Realtime_Sleep() is over, back to 1 ms
+        __HAL_TIM_SET_AUTORELOAD(&htim7, REALTIME_COUNTS_PER_MS - 1);
+        Realtime_TickMs = 1;
+    }
+    ms_counter += elapsed;
+
+#if defined(DEBOUNCE_WITH_TIMER) && !defined(USE_DMA_SAMPLING)
+    // Debounce every input on its own, before the tasks see the events
+    UserInput_Tick(elapsed);
+#endif
+    // A controller that stopped sending releases its buttons
+    Gamepad_Tick(elapsed);
 
-    // Beispiel für periodische Aktion jede Sekunde (1000 ms)
-    if (ms_counter % 1000 == 0) {
-        HAL_GPIO_TogglePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin);
+    // Moved potis go out as TOPIC_POTI and release their subscribers in the same tick
+    if ((int32_t)(ms_counter - next_poti) >= 0) {
+        ADC_PublishPoti();
+        next_poti = ms_counter + ADC_POTI_PUBLISH_MS;
     }
 
+    // Expired software timers release the timer task before the periodic releases
+    Timer_Tick(elapsed);
+    Scheduler_Tick(elapsed);
+    DmaAlloc_Tick(elapsed);
+}
+
+/**
+ * @brief  Schläft mit WFI bis zum nächsten Interrupt, höchstens maxMs Millisekunden
+ *
+ * Mit gesperrten Interrupts aufrufen (PRIMASK); WFI wacht trotzdem bei jedem anstehenden
+ * Interrupt auf, der nach der Rückkehr und dem Freigeben durch den Aufrufer ausgeführt wird.
+ * Bei maxMs <= 1 bleibt der 1-ms-Takt unverändert.
+ * @param  maxMs: Millisekunden bis zur nächsten Freigabe des Schedulers
+ */
+void Realtime_Sleep(uint32_t maxMs) {
+    if (maxMs > REALTIME_TICKLESS_MAX_MS) maxMs = REALTIME_TICKLESS_MAX_MS;
+#if defined(DEBOUNCE_WITH_TIMER) && !defined(USE_DMA_SAMPLING)
+    // A button is being debounced or held, keep sampling every millisecond
+    if (UserInput_IsBusy()) maxMs = 1;
+#endif
+    // Wake up for the next expiry in the timer wheel or a cascade from its upper levels
+    maxMs = Timer_TimeToNext(maxMs);
+
+    if (maxMs <= 1) {
+        __DSB();
+        __WFI();
+        return;
+    }
+
+    HAL_SuspendTick();
+    __HAL_TIM_SET_AUTORELOAD(&htim7, maxMs * REALTIME_COUNTS_PER_MS - 1);
+    Realtime_TickMs = maxMs;
+
+#if LOWPOWER_ENABLE
+    // Long enough for Stop: wake up LOWPOWER_WAKE_MARGIN_US before the release, then move TIM7
+    // on by the time in Stop; the end of the cycle is handled below like any early wake-up
+    uint32_t begin = __HAL_TIM_GET_COUNTER(&htim7);
+    uint32_t budget = maxMs * REALTIME_COUNTS_PER_MS;
+    uint32_t stoppedUs;
+    if (maxMs >= LOWPOWER_MIN_MS && begin + LOWPOWER_WAKE_MARGIN_US < budget
+            && LowPower_Stop(budget - begin - LOWPOWER_WAKE_MARGIN_US, &stoppedUs)) {
+        uint32_t moved = begin + stoppedUs * (REALTIME_COUNTS_PER_MS / 1000UL);
+        if (moved > budget - REALTIME_ARR_MARGIN) moved = budget - REALTIME_ARR_MARGIN;
+        __HAL_TIM_SET_COUNTER(&htim7, moved);
+    } else
+#endif
+    {
+        __DSB();
+        __WFI();
+    }
+
+    // Counter first, then the flag: a wrap in between is then seen as the full cycle
+    uint32_t count = __HAL_TIM_GET_COUNTER(&htim7);
+    uint32_t slept = maxMs;
+
+    if (!__HAL_TIM_GET_FLAG(&htim7, TIM_FLAG_UPDATE)) {
+        // Woken early: end the long cycle at the next millisecond boundary
+        uint32_t end = count / REALTIME_COUNTS_PER_MS + 1;
+        if (end * REALTIME_COUNTS_PER_MS - count < REALTIME_ARR_MARGIN) end++;
+        if (end < maxMs) {
+            __HAL_TIM_SET_AUTORELOAD(&htim7, end * REALTIME_COUNTS_PER_MS - 1);
+            Realtime_TickMs = end;
+        }
+        slept = count / REALTIME_COUNTS_PER_MS;
+    }
+
+    uwTick += slept;
+    HAL_ResumeTick();
+}
+
+/**
+ * @brief  Wartet wie die HAL-Version, schläft aber zwischen den SysTick-Interrupts mit WFI
+ */
+void HAL_Delay(uint32_t Delay) {
+    uint32_t tickstart = HAL_GetTick();
+    uint32_t wait = Delay;
+
+    // Add a freq to guarantee minimum wait
+    if (wait < HAL_MAX_DELAY) {
+        wait += (uint32_t)(uwTickFreq);
+    }
+
+    while ((HAL_GetTick() - tickstart) < wait) {
+        __WFI();
+    }
 }
@@ -0,0 +1,268 @@
+/**
+ * @file    SDCache.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   N-fach assoziativer Write-Back-Sektorcache mit Read-Ahead unter FatFs
+ *
+ * FatFs liest FAT-Einträge und Verzeichnissektoren (mit langen Dateinamen) immer wieder
+ * einzeln, und jedes Kommando an die Karte kostet rund 1 ms. Der Cache hält daher
+ * SDCACHE_SETS x SDCACHE_WAYS Sektoren; der Satz ergibt sich aus der Sektornummer,
+ * innerhalb des Satzes wird die am längsten unbenutzte Zeile ersetzt (LRU).
+ *
+ * Schreibzugriffe werden nur im Cache markiert (Dirty) und erst beim Verdrängen oder bei
+ * SDCache_Flush() (CTRL_SYNC aus f_sync/f_close) auf die Karte geschrieben. Folgesektoren
+ * liegen in Folgesätzen; eine Dirty-Zeile nimmt ihre Dirty-Nachbarn mit, bis zu
+ * SDCACHE_WRITE_RUN Sektoren in einem Multi-Block-Write, den sd_diskio.c per ACMD23 ankündigt.
+ *
+ * Schließt ein Lesezugriff direkt an den vorigen an, werden bei einem Fehltreffer
+ * SDCACHE_READAHEAD Folgesektoren im selben Multi-Block-Read mitgelesen.
+ * Große Zugriffe ab SDCACHE_BYPASS_SECTORS laufen am Cache vorbei, damit Bild- und
+ * Logdaten weiterhin per IDMA direkt im Aufruferpuffer landen.
+ */
+
+#include "SDCache.h"
+#include "Cache.h"
+#include "ff_gen_drv.h"
+#include "sd_diskio.h"
+#include <string.h>
+
+#ifdef SDCACHE_ENABLE
+
+#define SDCACHE_LINES            (SDCACHE_SETS * SDCACHE_WAYS)
+#define SDCACHE_STAGING_SECTORS  (SDCACHE_BYPASS_SECTORS + SDCACHE_READAHEAD)
+
+/**
+ * @brief Verwaltungsdaten einer Cache-Zeile
+ */
+typedef struct {
+	DWORD sector;     // Zwischengespeicherter Sektor
+	uint32_t stamp;   // Zeitpunkt des letzten Zugriffs (für LRU)
+	uint8_t valid;
+	uint8_t dirty;
+} SDCache_Line;
+
+SDCache_Stats SDCache_Statistics = {0};
+
+SDCache_Line SDCache_Lines[SDCACHE_LINES];
+uint8_t SDCache_Data[SDCACHE_LINES][SDCACHE_SECTOR_SIZE] AXI_BUFFER;
+
+// Zwischenpuffer für Fehltreffer samt Read-Ahead (ein Multi-Block-Read)
+uint8_t SDCache_Staging[SDCACHE_STAGING_SECTORS * SDCACHE_SECTOR_SIZE] AXI_BUFFER;
+
+// Zusammenhängende Dirty-Sektoren für einen Multi-Block-Write (Staging kann beim Verdrängen belegt sein)
+uint8_t SDCache_WriteBuffer[SDCACHE_WRITE_RUN * SDCACHE_SECTOR_SIZE] AXI_BUFFER;
+
+uint32_t SDCache_Clock = 0;
+DWORD SDCache_NextSector = 0xFFFFFFFF;	// Sektor, mit dem ein sequentieller Lesezugriff beginnen würde
+
+/**
+ * @brief  Sucht einen Sektor im Cache.
+ * @return Index der Zeile oder -1
+ */
+static int32_t SDCache_Find(DWORD sector)
+{
+	uint32_t base = (sector % SDCACHE_SETS) * SDCACHE_WAYS;
+	for (uint32_t way = 0; way < SDCACHE_WAYS; way++) {
+		SDCache_Line *line = &SDCache_Lines[base + way];
+		if (line->valid && line->sector == sector) return base + way;
+	}
+	return -1;
+}
+
+/**
+ * @brief  Sucht eine Dirty-Zeile für den Sektor.
+ * @return Index der Zeile oder -1
+ */
+static int32_t SDCache_FindDirty(DWORD sector)
+{
+	int32_t index = SDCache_Find(sector);
+	return (index >= 0 && SDCache_Lines[index].dirty) ? index : -1;
+}
+
+/**
+ * @brief  Schreibt eine Dirty-Zeile samt angrenzender Dirty-Sektoren in einem Kommando zurück.
+ */
+static DRESULT SDCache_WriteBack(uint32_t index)
+{
+	SDCache_Line *line = &SDCache_Lines[index];
+	if (!line->valid || !line->dirty) return RES_OK;
+
+	int32_t run[SDCACHE_WRITE_RUN];
+	UINT count = 0;
+	DWORD first = line->sector;
+
+	// Back to the start of the run, then forward; sector 0 has no predecessor
+	while (first > 0 && line->sector - (first - 1) < SDCACHE_WRITE_RUN && SDCache_FindDirty(first - 1) >= 0)
+		first--;
+	while (count < SDCACHE_WRITE_RUN && (run[count] = SDCache_FindDirty(first + count)) >= 0)
+		count++;
+
+	if (count == 1) {
+		DRESULT res = SD_WriteSectors(SDCache_Data[index], line->sector, 1);
+		if (res != RES_OK) return res;
+	} else {
+		for (UINT i = 0; i < count; i++)
+			memcpy(SDCache_WriteBuffer + i * SDCACHE_SECTOR_SIZE, SDCache_Data[run[i]], SDCACHE_SECTOR_SIZE);
+		DRESULT res = SD_WriteSectors(SDCache_WriteBuffer, first, count);
+		if (res != RES_OK) return res;
+	}
+
+	for (UINT i = 0; i < count; i++)
+		SDCache_Lines[run[i]].dirty = 0;
+	SDCache_Statistics.writebacks += count;
+	SDCache_Statistics.writeRuns++;
+	return RES_OK;
+}
+
+/**
+ * @brief  Belegt eine Zeile für den Sektor; verdrängt dazu die älteste Zeile des Satzes.
+ * @return Index der Zeile oder -1, wenn das Zurückschreiben fehlschlug
+ */
+static int32_t SDCache_Allocate(DWORD sector)
+{
+	uint32_t base = (sector % SDCACHE_SETS) * SDCACHE_WAYS;
+	uint32_t victim = base;
+
+	for (uint32_t way = 0; way < SDCACHE_WAYS; way++) {
+		SDCache_Line *line = &SDCache_Lines[base + way];
+		if (!line->valid) {
+			victim = base + way;
+			break;
+		}
+		if (line->stamp < SDCache_Lines[victim].stamp) victim = base + way;
+	}
+
+	if (SDCache_WriteBack(victim) != RES_OK) return -1;
+
+	SDCache_Lines[victim].sector = sector;
+	SDCache_Lines[victim].valid = 1;
+	SDCache_Lines[victim].dirty = 0;
+	return victim;
+}
+
+/**
+ * @brief  Liest Sektoren über den Cache.
+ *
+ * Fehlt mindestens ein Sektor, wird der ganze Bereich (bei sequentiellem Zugriff samt
+ * Read-Ahead) mit einem Kommando gelesen. Im Cache liegende Dirty-Sektoren sind neuer
+ * als die Karte und haben Vorrang.
+ */
+DRESULT SDCache_Read(BYTE *buff, DWORD sector, UINT count)
+{
+	uint8_t sequential = (sector == SDCache_NextSector);
+	SDCache_NextSector = sector + count;
+
+	if (count >= SDCACHE_BYPASS_SECTORS) {
+		DRESULT res = SD_ReadSectors(buff, sector, count);
+		if (res != RES_OK) return res;
+		// Noch nicht geschriebene Sektoren aus dem Cache darüberlegen
+		for (UINT i = 0; i < count; i++) {
+			int32_t index = SDCache_Find(sector + i);
+			if (index >= 0 && SDCache_Lines[index].dirty) {
+				memcpy(buff + i * SDCACHE_SECTOR_SIZE, SDCache_Data[index], SDCACHE_SECTOR_SIZE);
+			}
+		}
+		SDCache_Statistics.misses += count;
+		return RES_OK;
+	}
+
+	uint8_t miss = 0;
+	for (UINT i = 0; i < count && !miss; i++) {
+		if (SDCache_Find(sector + i) < 0) miss = 1;
+	}
+
+	UINT fetched = 0;
+	if (miss) {
+		fetched = count + (sequential ? SDCACHE_READAHEAD : 0);
+		DRESULT res = SD_ReadSectors(SDCache_Staging, sector, fetched);
+		if (res != RES_OK && fetched > count) {
+			// Read-Ahead über das Kartenende hinaus: nur den angeforderten Bereich lesen
+			fetched = count;
+			res = SD_ReadSectors(SDCache_Staging, sector, fetched);
+		}
+		if (res != RES_OK) return res;
+		SDCache_Statistics.misses += count;
+		SDCache_Statistics.prefetched += fetched - count;
+	}
+
+	for (UINT i = 0; i < fetched || i < count; i++) {
+		int32_t index = SDCache_Find(sector + i);
+		if (index < 0) {
+			index = SDCache_Allocate(sector + i);
+			if (index < 0) return RES_ERROR;
+			memcpy(SDCache_Data[index], SDCache_Staging + i * SDCACHE_SECTOR_SIZE, SDCACHE_SECTOR_SIZE);
+		} else if (i < count && !miss) {
+			SDCache_Statistics.hits++;
+		}
+		if (i < count) {
+			SDCache_Lines[index].stamp = ++SDCache_Clock;
+			memcpy(buff + i * SDCACHE_SECTOR_SIZE, SDCache_Data[index], SDCACHE_SECTOR_SIZE);
+		}
+	}
+	return RES_OK;
+}
+
+/**
+ * @brief  Schreibt Sektoren in den Cache (Write-Back).
+ *
+ * Große Schreibzugriffe gehen direkt auf die Karte; betroffene Cache-Zeilen werden
+ * dabei mit den neuen Daten aktualisiert, damit sie nicht veralten.
+ */
+DRESULT SDCache_Write(const BYTE *buff, DWORD sector, UINT count)
+{
+	if (count >= SDCACHE_BYPASS_SECTORS) {
+		DRESULT res = SD_WriteSectors(buff, sector, count);
+		if (res != RES_OK) return res;
+		for (UINT i = 0; i < count; i++) {
+			int32_t index = SDCache_Find(sector + i);
+			if (index >= 0) {
+				memcpy(SDCache_Data[index], buff + i * SDCACHE_SECTOR_SIZE, SDCACHE_SECTOR_SIZE);
+				SDCache_Lines[index].dirty = 0;
+			}
+		}
+		return RES_OK;
+	}
+
+	for (UINT i = 0; i < count; i++) {
+		int32_t index = SDCache_Find(sector + i);
+		if (index < 0) {
+			index = SDCache_Allocate(sector + i);
+			if (index < 0) return RES_ERROR;
+		}
+		memcpy(SDCache_Data[index], buff + i * SDCACHE_SECTOR_SIZE, SDCACHE_SECTOR_SIZE);
+		SDCache_Lines[index].dirty = 1;
+		SDCache_Lines[index].stamp = ++SDCache_Clock;
+	}
+	return RES_OK;
+}
+
+/**
+ * @brief  Schreibt alle Dirty-Sektoren auf die Karte (CTRL_SYNC).
+ */
+DRESULT SDCache_Flush()
+{
+	DRESULT res = RES_OK;
+	for (uint32_t index = 0; index < SDCACHE_LINES; index++) {
+		if (SDCache_WriteBack(index) != RES_OK) res = RES_ERROR;
+	}
+	return res;
+}
+
+/**
+ * @brief  Verwirft den Cache ohne Zurückschreiben (Karte neu initialisiert oder gewechselt).
+ */
+void SDCache_Invalidate()
+{
+	memset(SDCache_Lines, 0, sizeof(SDCache_Lines));
+	SDCache_Clock = 0;
+	SDCache_NextSector = 0xFFFFFFFF;
+}
+
+#else
+
+DRESULT SDCache_Read(BYTE *buff, DWORD sector, UINT count) { return SD_ReadSectors(buff, sector, count); }
+DRESULT SDCache_Write(const BYTE *buff, DWORD sector, UINT count) { return SD_WriteSectors(buff, sector, count); }
+DRESULT SDCache_Flush() { return RES_OK; }
+void SDCache_Invalidate() {}
+
+#endif /* SDCACHE_ENABLE */
@@ -8,222 +8,212 @@
 #include "SDCard.h"
 #include "main.h"
 #include "fatfs.h"
+#include "diskio.h"
+#include "SDCache.h"
+#include "Arena.h"
+#include "Cache.h"
 #include <stdio.h>
+#include "Log.h"
 #include "ILI9341.h"
 #include <string.h>
 extern SD_HandleTypeDef hsd1;
-char TxBuffer[250];
 
+// Persistentes Volume: einmal gemountet, über SDCard_Acquire()/SDCard_Release() geteilt
+FATFS SDCard_FatFs __attribute__((aligned(32)));
+uint8_t SDCard_Mounted = 0;
+uint8_t SDCard_RefCount = 0;
 
+/**
+ * @brief Gibt an, ob das Volume noch gültig ist.
+ *
+ * Fragt den Kartenstatus (CMD13) über disk_status() ab. Meldet die Karte nicht mehr
+ * den Transfer-Zustand, wurde sie entfernt oder neu gesteckt und das Volume muss
+ * neu gemountet werden.
+ *
+ * @return uint8_t 1, wenn das Volume benutzt werden kann
+ */
+static uint8_t SDCard_VolumeValid() {
+    if (!SDCard_Mounted) return 0;
+    if (BSP_SD_IsDetected() != SD_PRESENT || (disk_status(SDCard_FatFs.drv) & STA_NOINIT)) {
+        SDCard_Mounted = 0;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Mountet die SD-Karte einmalig in das statische FATFS-Objekt.
+ *
+ * Ist das Volume bereits gemountet und die Karte noch vorhanden, passiert nichts.
+ * Sollte einmal beim Start aufgerufen werden; SDCard_Acquire() mountet bei Bedarf nach.
+ *
+ * @return uint8_t 1 bei Erfolg, 0 bei Fehler
+ */
+uint8_t SDCard_Mount() {
+    if (SDCard_VolumeValid()) return 1;
+
+    FRESULT FR_Status = f_mount(&SDCard_FatFs, SDPath, 1);
+    if (FR_Status != FR_OK) {
+        LOG("Error! While Mounting SD Card, Error Code: (%i)\r\n", FR_Status);
+        return 0;
+    }
+
+    SDCard_Mounted = 1;
+    LOG("SD Card Mounted Successfully! \r\n\n");
+    return 1;
+}
+
+/**
+ * @brief Liefert das gemountete Volume und erhöht den Referenzzähler.
+ *
+ * Wurde die Karte entfernt oder ein Fehler gemeldet (SDCard_CheckResult), wird das Volume
+ * hier neu gemountet – aber nur, wenn gerade niemand eine Referenz hält, da offene
+ * Dateien durch einen Remount ungültig würden.
+ *
+ * @return FATFS* Zeiger auf das Volume oder NULL, wenn keine Karte verfügbar ist
+ */
+FATFS* SDCard_Acquire() {
+    if (!SDCard_VolumeValid()) {
+        if (SDCard_RefCount != 0 || !SDCard_Mount()) return NULL;
+    }
+    SDCard_RefCount++;
+    return &SDCard_FatFs;
+}
+
+/**
+ * @brief Gibt eine mit SDCard_Acquire() erhaltene Referenz zurück.
+ *
+ * Das Volume bleibt gemountet; der nächste Zugriff braucht keine Sektoren für
+ * Bootsektor und FAT neu zu lesen.
+ */
+void SDCard_Release() {
+    if (SDCard_RefCount > 0) SDCard_RefCount--;
+}
 
 /**
-* @brief Führt einen Test der SD-Karten-Funktionalität durch.
-*
-* Diese Funktion demonstriert grundlegende SD-Karten-Operationen:
-* - Mounten der SD-Karte
-* - Ermitteln der SD-Kartengröße und des freien Speicherplatzes
-* - Erstellen und Schreiben einer Textdatei
-* - Lesen der geschriebenen Datei
-* - Aktualisieren einer bestehenden Datei
-* - Löschen der Datei
-* - Unmounten der SD-Karte
-*/
-  void SDIO_SDCard_Test(void)
-  {
-    FATFS FatFs;          // FAT-Dateisystem-Objekt
-    FIL Fil;              // Dateiobjekt
-    FRESULT FR_Status;    // Ergebnisstatus der FatFs-Funktionen
-    FATFS *FS_Ptr;        // Zeiger auf das FAT-Dateisystem
-    UINT RWC, WWC;        // Lese-/Schreibzähler
-    DWORD FreeClusters;   // Anzahl der freien Cluster
-    uint32_t TotalSize, FreeSpace; // Gesamtspeicher und freier Speicherplatz
-    char RW_Buffer[200];  // Puffer für Lese-/Schreiboperationen
-
-    do
-    {
-      //------------------[ Mounten der SD-Karte ]--------------------
-      FR_Status = f_mount(&FatFs, (TCHAR const*)SDPath, 1);
-      if (FR_Status != FR_OK)
-      {
-        // Fehler beim Mounten der SD-Karte
-        sprintf(TxBuffer, "Error! While Mounting SD Card, Error Code: (%i)\r\n", FR_Status);
-        printf(TxBuffer);
-        break;
-      }
-      sprintf(TxBuffer, "SD Card Mounted Successfully! \r\n\n");
-      printf(TxBuffer);
-
-      //------------------[ Ermitteln der SD-Kartengröße und des freien Speicherplatzes ]--------------------
-      f_getfree("", &FreeClusters, &FS_Ptr);
-      TotalSize = (uint32_t)((FS_Ptr->n_fatent - 2) * FS_Ptr->csize * 0.5); // Gesamtspeicher in Bytes
-      FreeSpace = (uint32_t)(FreeClusters * FS_Ptr->csize * 0.5);          // Freier Speicherplatz in Bytes
-      sprintf(TxBuffer, "Total SD Card Size: %lu Bytes\r\n", TotalSize);
-      printf(TxBuffer);
-      sprintf(TxBuffer, "Free SD Card Space: %lu Bytes\r\n\n", FreeSpace);
-      printf(TxBuffer);
-
-      //------------------[ Erstellen und Schreiben einer Textdatei ]--------------------
-      // Öffnen oder Erstellen der Datei
-      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_WRITE | FA_READ | FA_CREATE_ALWAYS);
-      if(FR_Status != FR_OK)
-      {
-        // Fehler beim Erstellen/Öffnen der Datei
-        sprintf(TxBuffer, "Error! While Creating/Opening A New Text File, Error Code: (%i)\r\n", FR_Status);
-        printf(TxBuffer);
-        break;
-      }
-      sprintf(TxBuffer, "Text File Created & Opened! Writing Data To The Text File..\r\n\n");
-      printf(TxBuffer);
-
-      // Schreiben von Daten in die Datei mit f_puts()
-      f_puts("Hello! From STM32 To SD Card Over SDMMC, Using f_puts()\n", &Fil);
-
-      // Schreiben von Daten in die Datei mit f_write()
-      strcpy(RW_Buffer, "Hello! From STM32 To SD Card Over SDMMC, Using f_write()\r\n");
-      f_write(&Fil, RW_Buffer, strlen(RW_Buffer), &WWC);
-
-      // Schließen der Datei
-      f_close(&Fil);
-
-      //------------------[ Lesen der Textdatei ]--------------------
-      // Öffnen der Datei zum Lesen
-      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_READ);
-      if(FR_Status != FR_OK)
-      {
-        // Fehler beim Öffnen der Datei
-        sprintf(TxBuffer, "Error! While Opening (MyTextFile.txt) File For Read.. \r\n");
-        printf(TxBuffer);
-        break;
-      }
-
-      // Lesen der Datei mit f_gets()
-      f_gets(RW_Buffer, sizeof(RW_Buffer), &Fil);
-      sprintf(TxBuffer, "Data Read From (MyTextFile.txt) Using f_gets():%s", RW_Buffer);
-      printf(TxBuffer);
-
-      // Lesen der Datei mit f_read()
-      f_read(&Fil, RW_Buffer, f_size(&Fil), &RWC);
-      sprintf(TxBuffer, "Data Read From (MyTextFile.txt) Using f_read():%s", RW_Buffer);
-      printf(TxBuffer);
-
-      // Schließen der Datei
-      f_close(&Fil);
-      sprintf(TxBuffer, "File Closed! \r\n\n");
-      printf(TxBuffer);
-
-      //------------------[ Aktualisieren der Datei und erneutes Lesen ]--------------------
-      // Öffnen der Datei zum Aktualisieren
-      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_OPEN_EXISTING | FA_WRITE);
-      FR_Status = f_lseek(&Fil, f_size(&Fil)); // Verschieben des Dateizeigers ans Ende
-      if(FR_Status != FR_OK)
-      {
-        // Fehler beim Öffnen der Datei
-        sprintf(TxBuffer, "Error! While Opening (MyTextFile.txt) File For Update.. \r\n");
-        printf(TxBuffer);
-        break;
-      }
-
-      // Hinzufügen einer neuen Zeile
-      FR_Status = f_puts("This New Line Was Added During File Update!\r\n", &Fil);
-      f_close(&Fil);
-
-      // Puffer leeren
-      memset(RW_Buffer,'\0',sizeof(RW_Buffer));
-
-      // Lesen der Datei nach der Aktualisierung
-      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_READ);
-      f_read(&Fil, RW_Buffer, f_size(&Fil), &RWC);
-      sprintf(TxBuffer, "Data Read From (MyTextFile.txt) After Update:\r\n%s", RW_Buffer);
-      printf(TxBuffer);
-      f_close(&Fil);
-
-      //------------------[ Löschen der Datei ]--------------------
-      FR_Status = f_unlink("MyTextFile.txt");
-      if (FR_Status != FR_OK)
-      {
-          // Fehler beim Löschen der Datei
-          sprintf(TxBuffer, "Error! While Deleting The (MyTextFile.txt) File.. \r\n");
-          printf(TxBuffer);
-      }
-
-    } while(0);
-
-	//------------------[ Unmounten der SD-Karte ]--------------------
-	FR_Status = f_mount(NULL, "", 0);
-	if (FR_Status != FR_OK)
-	{
-	    // Fehler beim Unmounten der SD-Karte
-	    sprintf(TxBuffer, "\r\nError! While Un-mounting SD Card, Error Code: (%i)\r\n", FR_Status);
-	    printf(TxBuffer);
-	}
-	else
-	{
-	    sprintf(TxBuffer, "\r\nSD Card Un-mounted Successfully! \r\n");
-	    printf(TxBuffer);
-	}
-  }
+ * @brief Wertet das Ergebnis einer FatFs-Operation aus.
+ *
+ * Fehler, die auf eine entfernte oder gestörte Karte hindeuten, markieren das Volume
+ * als ungültig, sodass der nächste SDCard_Acquire()-Aufruf neu mountet.
+ *
+ * @param res Rückgabewert der FatFs-Funktion
+ * @return FRESULT Der unveränderte Rückgabewert
+ */
+FRESULT SDCard_CheckResult(FRESULT res) {
+    if (res == FR_DISK_ERR || res == FR_NOT_READY || res == FR_INT_ERR || res == FR_NO_FILESYSTEM) {
+        SDCard_Mounted = 0;
+    }
+    return res;
+}
 
 /**
  * @brief Mountet die SD-Karte.
  *
- * Diese Funktion versucht, die SD-Karte zu mounten, und gibt den Erfolg oder
- * Misserfolg zurück. Sie gibt entsprechende Statusmeldungen über die serielle
- * Schnittstelle aus.
+ * Kompatibilitätsfunktion; entspricht SDCard_Acquire() und muss mit unmountSD()
+ * freigegeben werden.
  *
  * @return uint8_t
- *         - 1: Erfolgreiches Mounten der SD-Karte
+ *         - 1: SD-Karte verfügbar
  *         - 0: Fehler beim Mounten der SD-Karte
  */
 uint8_t mountSD() {
-    FATFS FatFs;          // FAT-Dateisystem-Objekt
-    FIL Fil;              // Dateiobjekt (nicht verwendet in dieser Funktion)
-    FRESULT FR_Status;    // Ergebnisstatus der FatFs-Funktionen
-    FATFS *FS_Ptr;        // Zeiger auf das FAT-Dateisystem (nicht verwendet in dieser Funktion)
-
-    // Versuche, die SD-Karte zu mounten
-    FR_Status = f_mount(&FatFs, SDPath, 1);
-    if (FR_Status != FR_OK) {
-        // Fehler beim Mounten der SD-Karte
-        sprintf(TxBuffer, "Error! While Mounting SD Card, Error Code: (%i)\r\n", FR_Status);
-        printf(TxBuffer);
-        return 0; // Rückgabe 0 bei Fehler
-    }
-
-    // Erfolgreiches Mounten der SD-Karte
-    sprintf(TxBuffer, "SD Card Mounted Successfully! \r\n\n");
-    printf(TxBuffer);
-    return 1; // Rückgabe 1 bei Erfolg
+    return SDCard_Acquire() != NULL;
 }
 
 /**
   * @brief Unmountet die SD-Karte.
   *
-  * Diese Funktion versucht, die SD-Karte sicher zu unmounten und gibt den Erfolg
-  * oder Misserfolg zurück. Sie gibt entsprechende Statusmeldungen über die serielle
-  * Schnittstelle aus.
+  * Kompatibilitätsfunktion; gibt die Referenz aus mountSD() zurück. Das Volume bleibt
+  * gemountet, erst SDCard_Unmount() hängt es tatsächlich aus.
+  *
+  * @return uint8_t 1
+  */
+uint8_t unmountSD() {
+    SDCard_Release();
+    return 1;
+}
+
+/**
+  * @brief Hängt das Volume aus, z. B. vor dem Entnehmen der Karte.
   *
   * @return uint8_t
   *         - 1: Erfolgreiches Unmounten der SD-Karte
-  *         - 0: Fehler beim Unmounten der SD-Karte
+  *         - 0: Fehler beim Unmounten oder das Volume wird noch benutzt
   */
- uint8_t unmountSD() {
-     FATFS FatFs;          // FAT-Dateisystem-Objekt (nicht verwendet in dieser Funktion)
-     FIL Fil;              // Dateiobjekt (nicht verwendet in dieser Funktion)
-     FRESULT FR_Status;    // Ergebnisstatus der FatFs-Funktionen
-     FATFS *FS_Ptr;        // Zeiger auf das FAT-Dateisystem (nicht verwendet in dieser Funktion)
-
-     // Versuche, die SD-Karte zu unmounten
-     FR_Status = f_mount(NULL, "", 0);
-     if (FR_Status != FR_OK) {
-         // Fehler beim Unmounten der SD-Karte
-         sprintf(TxBuffer, "\r\nError! While Un-mounting SD Card, Error Code: (%i)\r\n", FR_Status);
-         printf(TxBuffer);
-         return 0; // Rückgabe 0 bei Fehler
-     } else {
-         // Erfolgreiches Unmounten der SD-Karte
-         sprintf(TxBuffer, "\r\nSD Card Un-mounted Successfully! \r\n");
-         printf(TxBuffer);
-     }
-     return 1; // Rückgabe 1 bei Erfolg
- }
+uint8_t SDCard_Unmount() {
+    if (SDCard_RefCount != 0) return 0;
+
+    // Noch nicht zurückgeschriebene Sektoren vor dem Aushängen sichern
+    SDCache_Flush();
 
+    FRESULT FR_Status = f_mount(NULL, SDPath, 0);
+    SDCard_Mounted = 0;
+    if (FR_Status != FR_OK) {
+        LOG("\r\nError! While Un-mounting SD Card, Error Code: (%i)\r\n", FR_Status);
+        return 0;
+    }
+    LOG("\r\nSD Card Un-mounted Successfully! \r\n");
+    return 1;
+}
+
+/**
+  * @brief Formatiert die Karte neu, ausgerichtet an ihrer Allocation Unit (AU).
+  *
+  * Am PC formatierte Karten legen FAT und Cluster oft quer zu den Löschblöcken der Karte,
+  * jeder Block des Loggers berührt dann zwei AUs. f_mkfs() richtet den Datenbereich an
+  * GET_BLOCK_SIZE aus; sd_diskio.c liefert dort die AU aus dem SD-Status (ACMD13). Die
+  * Clustergröße folgt der AU bis SDCARD_FAT_CLUSTER_MAX bzw. SDCARD_EXFAT_CLUSTER_MAX,
+  * darüber nicht, sonst verschwendet jede kleine Datei mehrere MB. Der Arbeitspuffer kommt
+  * aus Arena_Frame; der Aufruf blockiert, bis die Karte fertig ist (einige Sekunden).
+  *
+  * @param opt  FM_FAT, FM_FAT32, FM_EXFAT oder 0: FAT16/FAT32 bis 32 GB, darüber exFAT
+  * @param info Ergebnis, darf NULL sein
+  * @return FRESULT FR_LOCKED, solange jemand das Volume hält, sonst das Ergebnis von f_mkfs()
+  *         bzw. dem erneuten Mounten
+  */
+FRESULT SDCard_Format(BYTE opt, SDCard_FormatInfo *info) {
+    SDCard_FormatInfo result = { 0 };
+    HAL_SD_CardInfoTypeDef card;
+    DWORD auSectors = 1;
+    BYTE pdrv = (BYTE)(SDPath[0] - '0');
+    uint32_t start = HAL_GetTick();
+
+    if (SDCard_RefCount != 0) return FR_LOCKED;
+
+    // Nothing of the old volume survives, dirty sectors included
+    f_mount(NULL, SDPath, 0);
+    SDCard_Mounted = 0;
+    SDCache_Invalidate();
+
+    if (disk_initialize(pdrv) & STA_NOINIT) return FR_NOT_READY;
+    disk_ioctl(pdrv, GET_BLOCK_SIZE, &auSectors);
+    BSP_SD_GetCardInfo(&card);
+
+    if (opt == 0)
+        opt = card.LogBlockNbr > 64UL * 1024UL * 1024UL ? FM_EXFAT : FM_FAT | FM_FAT32;
+
+    uint32_t clusterMax = (opt & FM_EXFAT) ? SDCARD_EXFAT_CLUSTER_MAX : SDCARD_FAT_CLUSTER_MAX;
+    result.auBytes = auSectors * card.LogBlockSize;
+    result.clusterBytes = result.auBytes > card.LogBlockSize ? result.auBytes : 0;
+    if (result.clusterBytes > clusterMax) result.clusterBytes = clusterMax;
+
+    Arena_Mark mark = Arena_GetMark(&Arena_Frame);
+    void *work = Arena_Alloc(&Arena_Frame, SDCARD_FORMAT_WORK_SIZE, CACHE_LINE_SIZE);
+    if (work == NULL) return FR_NOT_ENOUGH_CORE;
+
+    LOG("Formatting SD card: AU %lu KB, cluster %lu KB\r\n", result.auBytes / 1024UL, result.clusterBytes / 1024UL);
+    FRESULT res = f_mkfs(SDPath, opt, result.clusterBytes, work, SDCARD_FORMAT_WORK_SIZE);
+    Arena_Release(&Arena_Frame, mark);
+    if (res != FR_OK) {
+        LOG("Error! While formatting SD Card, Error Code: (%i)\r\n", res);
+        return res;
+    }
+
+    if (!SDCard_Mount()) return FR_NO_FILESYSTEM;
+    result.fsType = SDCard_FatFs.fs_type;
+    result.clusterBytes = SDCard_FatFs.csize * card.LogBlockSize;
+    result.dataSector = SDCard_FatFs.database;
+    result.elapsedMs = HAL_GetTick() - start;
+    if (info != NULL) *info = result;
+    return FR_OK;
+}
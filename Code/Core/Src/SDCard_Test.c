@@ -0,0 +1,140 @@
+/**
+ * @file    SDCard_Test.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Vorführung der FatFs-Grundfunktionen auf der SD-Karte (Shell-Befehl 'sd')
+ *
+ * Stand früher in SDCard.c. Der Test legt Dateien an, liest und löscht sie über den normalen
+ * FatFs-Weg mit kleinen Zugriffen; mit dem Volume-Code in SDCard.c und dem Datenlogger
+ * (SDLogger.c, SensorLog.c) hat er nichts zu tun und bleibt deshalb in einer eigenen Datei.
+ */
+
+#include "SDCard.h"
+#include "fatfs.h"
+#include "Log.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+* @brief Führt einen Test der SD-Karten-Funktionalität durch.
+*
+* Diese Funktion demonstriert grundlegende SD-Karten-Operationen:
+* - Anfordern des persistenten Volumes (mountet bei Bedarf)
+* - Ermitteln der SD-Kartengröße und des freien Speicherplatzes
+* - Erstellen und Schreiben einer Textdatei
+* - Lesen der geschriebenen Datei
+* - Aktualisieren einer bestehenden Datei
+* - Löschen der Datei
+* - Freigeben des Volumes (es bleibt gemountet)
+*/
+  void SDIO_SDCard_Test(void)
+  {
+    FIL Fil;              // Dateiobjekt
+    FRESULT FR_Status;    // Ergebnisstatus der FatFs-Funktionen
+    FATFS *FS_Ptr;        // Zeiger auf das FAT-Dateisystem
+    UINT RWC, WWC;        // Lese-/Schreibzähler
+    DWORD FreeClusters;   // Anzahl der freien Cluster
+    uint32_t TotalSize, FreeSpace; // Gesamtspeicher und freier Speicherplatz
+    char RW_Buffer[200];  // Puffer für Lese-/Schreiboperationen
+    uint8_t acquired = 0; // Referenz auf das Volume gehalten
+
+    do
+    {
+      //------------------[ Mounten der SD-Karte ]--------------------
+      if (SDCard_Acquire() == NULL)
+      {
+        // Fehler beim Mounten der SD-Karte (Meldung kommt aus SDCard_Mount)
+        break;
+      }
+      acquired = 1;
+
+      //------------------[ Ermitteln der SD-Kartengröße und des freien Speicherplatzes ]--------------------
+      f_getfree("", &FreeClusters, &FS_Ptr);
+      TotalSize = (uint32_t)((FS_Ptr->n_fatent - 2) * FS_Ptr->csize * 0.5); // Gesamtspeicher in Bytes
+      FreeSpace = (uint32_t)(FreeClusters * FS_Ptr->csize * 0.5);          // Freier Speicherplatz in Bytes
+      LOG("Total SD Card Size: %lu Bytes\r\n", TotalSize);
+      LOG("Free SD Card Space: %lu Bytes\r\n\n", FreeSpace);
+
+      //------------------[ Erstellen und Schreiben einer Textdatei ]--------------------
+      // Öffnen oder Erstellen der Datei
+      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_WRITE | FA_READ | FA_CREATE_ALWAYS);
+      if(FR_Status != FR_OK)
+      {
+        // Fehler beim Erstellen/Öffnen der Datei
+        LOG("Error! While Creating/Opening A New Text File, Error Code: (%i)\r\n", FR_Status);
+        break;
+      }
+      LOG("Text File Created & Opened! Writing Data To The Text File..\r\n\n");
+
+      // Schreiben von Daten in die Datei mit f_puts()
+      f_puts("Hello! From STM32 To SD Card Over SDMMC, Using f_puts()\n", &Fil);
+
+      // Schreiben von Daten in die Datei mit f_write()
+      strcpy(RW_Buffer, "Hello! From STM32 To SD Card Over SDMMC, Using f_write()\r\n");
+      f_write(&Fil, RW_Buffer, strlen(RW_Buffer), &WWC);
+
+      // Schließen der Datei
+      f_close(&Fil);
+
+      //------------------[ Lesen der Textdatei ]--------------------
+      // Öffnen der Datei zum Lesen
+      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_READ);
+      if(FR_Status != FR_OK)
+      {
+        // Fehler beim Öffnen der Datei
+        LOG("Error! While Opening (MyTextFile.txt) File For Read.. \r\n");
+        break;
+      }
+
+      // Lesen der Datei mit f_gets()
+      f_gets(RW_Buffer, sizeof(RW_Buffer), &Fil);
+      printf("Data Read From (MyTextFile.txt) Using f_gets():%s", RW_Buffer);
+
+      // Lesen der Datei mit f_read()
+      f_read(&Fil, RW_Buffer, f_size(&Fil), &RWC);
+      printf("Data Read From (MyTextFile.txt) Using f_read():%s", RW_Buffer);
+
+      // Schließen der Datei
+      f_close(&Fil);
+      LOG("File Closed! \r\n\n");
+
+      //------------------[ Aktualisieren der Datei und erneutes Lesen ]--------------------
+      // Öffnen der Datei zum Aktualisieren
+      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_OPEN_EXISTING | FA_WRITE);
+      FR_Status = f_lseek(&Fil, f_size(&Fil)); // Verschieben des Dateizeigers ans Ende
+      if(FR_Status != FR_OK)
+      {
+        // Fehler beim Öffnen der Datei
+        LOG("Error! While Opening (MyTextFile.txt) File For Update.. \r\n");
+        break;
+      }
+
+      // Hinzufügen einer neuen Zeile
+      FR_Status = f_puts("This New Line Was Added During File Update!\r\n", &Fil);
+      f_close(&Fil);
+
+      // Puffer leeren
+      memset(RW_Buffer,'\0',sizeof(RW_Buffer));
+
+      // Lesen der Datei nach der Aktualisierung
+      FR_Status = f_open(&Fil, "MyTextFile.txt", FA_READ);
+      f_read(&Fil, RW_Buffer, f_size(&Fil), &RWC);
+      printf("Data Read From (MyTextFile.txt) After Update:\r\n%s", RW_Buffer);
+      f_close(&Fil);
+
+      //------------------[ Löschen der Datei ]--------------------
+      FR_Status = f_unlink("MyTextFile.txt");
+      if (FR_Status != FR_OK)
+      {
+          // Fehler beim Löschen der Datei
+          LOG("Error! While Deleting The (MyTextFile.txt) File.. \r\n");
+      }
+
+    } while(0);
+
+	//------------------[ Volume freigeben (bleibt gemountet) ]--------------------
+	if (acquired)
+	{
+	    SDCard_Release();
+	}
+  }
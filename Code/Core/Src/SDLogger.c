@@ -0,0 +1,248 @@
+/**
+ * @file    SDLogger.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Datenlogger mit vorab reservierter, zusammenhängender Datei auf der SD-Karte
+ *
+ * Beim Öffnen wird die Datei mit f_expand() in voller Größe als zusammenhängender
+ * Clusterbereich angelegt. Danach ist die Sektoradresse jedes Bytes bekannt, und die
+ * Daten aus dem Ringpuffer werden mit disk_write() direkt per LBA in Multi-Block-Writes
+ * geschrieben – ohne dass FatFs zwischendurch FAT oder Verzeichnis anfassen muss.
+ *
+ * Die Blöcke enden auf 32-KB-Grenzen der Karte, nicht der Datei: der erste Block reicht nur
+ * bis zur nächsten Grenze. Der Ringpuffer ist dafür um denselben Versatz (SDLogger_Lead)
+ * verschoben, so liegt jeder Block trotzdem am Stück im RAM.
+ *
+ * Nur an Checkpoints (alle SDLOGGER_CHECKPOINT_MS) wird die bisher geschriebene Größe
+ * in den Verzeichniseintrag übernommen, damit nach einem Stromausfall die Daten bis zum
+ * letzten Checkpoint lesbar sind. Beim Schließen wird die Datei auf die tatsächliche
+ * Länge gekürzt und der nicht benutzte Rest freigegeben.
+ *
+ * SDLogger_Write() darf aus einem Interrupt aufgerufen werden (ein Erzeuger);
+ * SDLogger_Process() läuft in der Hauptschleife.
+ */
+
+#include "SDLogger.h"
+#include "Cache.h"
+#include "SDCard.h"
+#include "diskio.h"
+#include <string.h>
+
+/* Entspricht FA_MODIFIED aus ff.c: Verzeichniseintrag beim nächsten f_sync() schreiben */
+#define SDLOGGER_FA_MODIFIED   0x40
+
+#define SDLOGGER_CHUNK_BYTES   (SDLOGGER_WRITE_SECTORS * SDLOGGER_SECTOR_SIZE)
+
+SDLogger_Stats SDLogger_Statistics = {0};
+
+FIL SDLogger_File;
+uint8_t SDLogger_Ring[SDLOGGER_RING_SIZE] AXI_BUFFER;
+
+volatile uint32_t SDLogger_Head = 0;	// Geschriebene Bytes (Erzeuger), läuft frei
+uint32_t SDLogger_Tail = 0;				// Auf die Karte übertragene Bytes
+uint32_t SDLogger_Capacity = 0;			// Reservierte Dateigröße in Bytes
+uint32_t SDLogger_Checkpointed = 0;		// Größe beim letzten Checkpoint
+uint32_t SDLogger_LastCheckpoint = 0;
+DWORD SDLogger_StartSector = 0;			// LBA des ersten Dateisektors
+uint32_t SDLogger_Lead = 0;				// Ringposition des ersten Dateibytes (Versatz zur 32-KB-Grenze)
+BYTE SDLogger_Drive = 0;
+uint8_t SDLogger_Opened = 0;
+
+/**
+ * @brief  Legt die Logdatei an und reserviert capacity Bytes am Stück.
+ *
+ * @param  path     Dateiname auf der SD-Karte (wird überschrieben)
+ * @param  capacity Maximale Loggröße in Bytes (wird auf ganze Schreibblöcke aufgerundet)
+ * @return FR_OK oder der FatFs-Fehler; FR_DENIED, wenn kein zusammenhängender Bereich frei ist
+ */
+FRESULT SDLogger_Open(const char *path, uint32_t capacity)
+{
+	if (SDLogger_Opened) return FR_LOCKED;
+
+	FATFS *fs = SDCard_Acquire();
+	if (fs == NULL) return FR_NOT_READY;
+
+	capacity = (capacity + SDLOGGER_CHUNK_BYTES - 1) / SDLOGGER_CHUNK_BYTES * SDLOGGER_CHUNK_BYTES;
+
+	FRESULT res = f_open(&SDLogger_File, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res == FR_OK) {
+		// opt = 1: Cluster sofort belegen, sonst nur prüfen
+		res = f_expand(&SDLogger_File, capacity, 1);
+		if (res != FR_OK) f_close(&SDLogger_File);
+	}
+	if (res != FR_OK) {
+		SDCard_CheckResult(res);
+		SDCard_Release();
+		return res;
+	}
+
+	SDLogger_StartSector = fs->database + (SDLogger_File.obj.sclust - 2) * fs->csize;
+	SDLogger_Lead = (SDLogger_StartSector % SDLOGGER_WRITE_SECTORS) * SDLOGGER_SECTOR_SIZE;
+	SDLogger_Drive = fs->drv;
+	SDLogger_Capacity = capacity;
+	SDLogger_Head = 0;
+	SDLogger_Tail = 0;
+	SDLogger_Checkpointed = 0;
+	SDLogger_LastCheckpoint = HAL_GetTick();
+	memset(&SDLogger_Statistics, 0, sizeof(SDLogger_Statistics));
+	SDLogger_Opened = 1;
+
+	// Größe 0 eintragen: bis zum ersten Checkpoint ist die Datei leer
+	return SDLogger_Checkpoint();
+}
+
+/**
+ * @brief  Kopiert Daten in den Ringpuffer.
+ * @return Anzahl übernommener Bytes; der Rest wird verworfen und gezählt
+ */
+uint32_t SDLogger_Write(const void *data, uint32_t length)
+{
+	if (!SDLogger_Opened) return 0;
+
+	uint32_t head = SDLogger_Head;
+	uint32_t space = SDLOGGER_RING_SIZE - (head - SDLogger_Tail);
+	if (SDLogger_Capacity - head < space) space = SDLogger_Capacity - head;
+
+	uint32_t accepted = (length < space) ? length : space;
+	SDLogger_Statistics.dropped += length - accepted;
+
+	uint32_t offset = (head + SDLogger_Lead) % SDLOGGER_RING_SIZE;
+	uint32_t first = SDLOGGER_RING_SIZE - offset;
+	if (first > accepted) first = accepted;
+	memcpy(&SDLogger_Ring[offset], data, first);
+	memcpy(SDLogger_Ring, (const uint8_t*)data + first, accepted - first);
+
+	SDLogger_Head = head + accepted;
+	if (SDLogger_Head - SDLogger_Tail > SDLogger_Statistics.maxFill)
+		SDLogger_Statistics.maxFill = SDLogger_Head - SDLogger_Tail;
+	return accepted;
+}
+
+/**
+ * @brief  Platz für SDLogger_Write(), ohne dass etwas verworfen wird
+ * @return Freie Bytes im Ringpuffer bzw. bis zum Ende der reservierten Datei
+ */
+uint32_t SDLogger_GetFree()
+{
+	if (!SDLogger_Opened) return 0;
+
+	uint32_t head = SDLogger_Head;
+	uint32_t space = SDLOGGER_RING_SIZE - (head - SDLogger_Tail);
+	if (SDLogger_Capacity - head < space) space = SDLogger_Capacity - head;
+	return space;
+}
+
+/**
+ * @brief  Schreibt sectors Sektoren ab SDLogger_Tail direkt auf die Karte.
+ */
+static FRESULT SDLogger_WriteSectors(uint32_t sectors)
+{
+	uint32_t offset = (SDLogger_Tail + SDLogger_Lead) % SDLOGGER_RING_SIZE;
+	DWORD lba = SDLogger_StartSector + SDLogger_Tail / SDLOGGER_SECTOR_SIZE;
+	uint32_t start = HAL_GetTick();
+
+	if (disk_write(SDLogger_Drive, &SDLogger_Ring[offset], lba, sectors) != RES_OK) {
+		return FR_DISK_ERR;
+	}
+
+	uint32_t ms = HAL_GetTick() - start;
+	if (ms > SDLogger_Statistics.maxWriteMs) SDLogger_Statistics.maxWriteMs = ms;
+	SDLogger_Statistics.writes++;
+	return FR_OK;
+}
+
+/**
+ * @brief  Überträgt alle vollen Schreibblöcke und setzt bei Bedarf einen Checkpoint.
+ *
+ * Regelmäßig aus der Hauptschleife aufrufen. Da Tail nach dem ersten Block immer auf einer
+ * Blockgrenze steht und der Ringpuffer ein Vielfaches der Blockgröße ist, liegt jeder Block
+ * am Stück im RAM.
+ */
+FRESULT SDLogger_Process()
+{
+	if (!SDLogger_Opened) return FR_INVALID_OBJECT;
+
+	for (;;) {
+		// Up to the next 32 KB boundary on the card, a full block after the first one
+		uint32_t chunk = SDLOGGER_CHUNK_BYTES - (SDLogger_Tail + SDLogger_Lead) % SDLOGGER_CHUNK_BYTES;
+		if (SDLogger_Head - SDLogger_Tail < chunk) break;
+
+		FRESULT res = SDLogger_WriteSectors(chunk / SDLOGGER_SECTOR_SIZE);
+		if (res != FR_OK) return SDCard_CheckResult(res);
+		SDLogger_Tail += chunk;
+		SDLogger_Statistics.written = SDLogger_Tail;
+	}
+
+	if (SDLogger_Tail != SDLogger_Checkpointed && HAL_GetTick() - SDLogger_LastCheckpoint >= SDLOGGER_CHECKPOINT_MS) {
+		return SDLogger_Checkpoint();
+	}
+	return FR_OK;
+}
+
+/**
+ * @brief  Trägt die bisher geschriebene Größe in den Verzeichniseintrag ein.
+ *
+ * Die Cluster bleiben in voller Größe belegt; nur die sichtbare Dateigröße wird
+ * kurzzeitig auf den geschriebenen Stand gesetzt und per f_sync() gespeichert.
+ */
+FRESULT SDLogger_Checkpoint()
+{
+	if (!SDLogger_Opened) return FR_INVALID_OBJECT;
+
+	FSIZE_t allocated = SDLogger_File.obj.objsize;
+	SDLogger_File.obj.objsize = SDLogger_Tail;
+	SDLogger_File.flag |= SDLOGGER_FA_MODIFIED;
+	FRESULT res = f_sync(&SDLogger_File);
+	SDLogger_File.obj.objsize = allocated;
+
+	SDLogger_LastCheckpoint = HAL_GetTick();
+	if (res == FR_OK) {
+		SDLogger_Checkpointed = SDLogger_Tail;
+		SDLogger_Statistics.checkpoints++;
+	}
+	return SDCard_CheckResult(res);
+}
+
+/**
+ * @brief  Schreibt den Rest des Ringpuffers, kürzt die Datei auf die tatsächliche Länge und schließt sie.
+ */
+FRESULT SDLogger_Close()
+{
+	if (!SDLogger_Opened) return FR_INVALID_OBJECT;
+
+	FRESULT res = SDLogger_Process();
+
+	// Letzter, unvollständiger Block: bis zur Sektorgrenze mit Nullen auffüllen
+	uint32_t head = SDLogger_Head;
+	uint32_t remaining = head - SDLogger_Tail;
+	if (res == FR_OK && remaining > 0) {
+		uint32_t sectors = (remaining + SDLOGGER_SECTOR_SIZE - 1) / SDLOGGER_SECTOR_SIZE;
+		uint32_t offset = (SDLogger_Tail + SDLogger_Lead) % SDLOGGER_RING_SIZE;
+		memset(&SDLogger_Ring[offset + remaining], 0, sectors * SDLOGGER_SECTOR_SIZE - remaining);
+		res = SDCard_CheckResult(SDLogger_WriteSectors(sectors));
+		if (res == FR_OK) {
+			SDLogger_Tail = head;
+			SDLogger_Statistics.written = head;
+		}
+	}
+
+	// Nicht benutzte Cluster hinter dem Logende freigeben
+	if (res == FR_OK) res = f_lseek(&SDLogger_File, SDLogger_Tail);
+	if (res == FR_OK) res = f_truncate(&SDLogger_File);
+
+	FRESULT closeRes = f_close(&SDLogger_File);
+	if (res == FR_OK) res = closeRes;
+
+	SDLogger_Opened = 0;
+	SDCard_CheckResult(res);
+	SDCard_Release();
+	return res;
+}
+
+/**
+ * @brief  Gibt an, ob gerade eine Logdatei geöffnet ist.
+ */
+uint8_t SDLogger_IsOpen()
+{
+	return SDLogger_Opened;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file    SDQueue.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Warteschlange für Dateizugriffe, abgearbeitet in einer Zeitscheibe der Hauptschleife
+ *
+ * UI- und Messcode reihen Open/Read/Write/Seek/Sync/Close-Aufträge nur ein und kehren
+ * sofort zurück. SDQueue_Service() führt sie in der Hauptschleife nacheinander aus,
+ * bis das übergebene Zeitbudget verbraucht ist; große Lese- und Schreibaufträge werden
+ * dabei in Teilstücke von SDQUEUE_SLICE_BYTES zerlegt. Nach jedem Auftrag läuft der
+ * Callback des Aufrufers, der auch gleich den nächsten Auftrag einreihen darf.
+ *
+ * Da alle FatFs-Aufrufe aus SDQueue_Service() kommen, bleibt _FS_REENTRANT = 0 ausreichend.
+ * Das Volume stammt aus SDCard_Acquire() und bleibt gemountet, solange Dateien offen sind.
+ */
+
+#include "SDQueue.h"
+#include "SDCard.h"
+#include "FastSeek.h"
+#include <string.h>
+
+typedef enum {
+	SDQUEUE_OPEN,
+	SDQUEUE_READ,
+	SDQUEUE_WRITE,
+	SDQUEUE_SEEK,
+	SDQUEUE_SYNC,
+	SDQUEUE_CLOSE
+} SDQueue_Type;
+
+/**
+ * @brief Ein eingereihter Auftrag
+ */
+typedef struct {
+	SDQueue_Type type;
+	int8_t handle;
+	BYTE mode;                 // Open: FA_-Flags
+	uint8_t *buffer;           // Read/Write: Daten
+	uint32_t size;             // Read/Write: Gesamtgröße
+	uint32_t done;             // Read/Write: bereits übertragen
+	FSIZE_t offset;            // Seek: Zielposition
+	char path[SDQUEUE_PATH_MAX];
+	SDQueue_Callback callback;
+	void *context;
+} SDQueue_Request;
+
+/**
+ * @brief Dateiplatz in der Handle-Tabelle
+ */
+typedef struct {
+	FIL file;
+	uint8_t used;     // Handle vergeben (ab SDQueue_Open)
+	uint8_t opened;   // f_open war erfolgreich
+} SDQueue_File;
+
+SDQueue_File SDQueue_Files[SDQUEUE_MAX_FILES];
+SDQueue_Request SDQueue_Requests[SDQUEUE_DEPTH];
+uint8_t SDQueue_Head = 0;	// Nächster freier Platz
+uint8_t SDQueue_Tail = 0;	// Ältester Auftrag
+uint8_t SDQueue_Count = 0;
+uint8_t SDQueue_Running = 0;	// Schutz gegen Rekursion aus einem Callback
+
+/**
+ * @brief  Reserviert den nächsten Platz in der Warteschlange.
+ * @return Zeiger auf den Auftrag oder NULL, wenn die Warteschlange voll ist
+ */
+static SDQueue_Request* SDQueue_Push(SDQueue_Type type, int8_t handle, SDQueue_Callback callback, void *context)
+{
+	if (SDQueue_Count >= SDQUEUE_DEPTH) return NULL;
+	if (type != SDQUEUE_OPEN && (handle < 0 || handle >= SDQUEUE_MAX_FILES || !SDQueue_Files[handle].used)) return NULL;
+
+	SDQueue_Request *request = &SDQueue_Requests[SDQueue_Head];
+	memset(request, 0, sizeof(SDQueue_Request));
+	request->type = type;
+	request->handle = handle;
+	request->callback = callback;
+	request->context = context;
+
+	SDQueue_Head = (SDQueue_Head + 1) % SDQUEUE_DEPTH;
+	SDQueue_Count++;
+	return request;
+}
+
+/**
+ * @brief  Reiht das Öffnen einer Datei ein.
+ * @return Handle für die folgenden Aufträge oder -1 (keine freie Datei, Warteschlange voll)
+ */
+int8_t SDQueue_Open(const char *path, BYTE mode, SDQueue_Callback callback, void *context)
+{
+	if (strlen(path) >= SDQUEUE_PATH_MAX) return -1;
+
+	int8_t handle = -1;
+	for (int8_t i = 0; i < SDQUEUE_MAX_FILES; i++) {
+		if (!SDQueue_Files[i].used) {
+			handle = i;
+			break;
+		}
+	}
+	if (handle < 0) return -1;
+
+	SDQueue_Request *request = SDQueue_Push(SDQUEUE_OPEN, handle, callback, context);
+	if (request == NULL) return -1;
+
+	strcpy(request->path, path);
+	request->mode = mode;
+	SDQueue_Files[handle].used = 1;
+	SDQueue_Files[handle].opened = 0;
+	return handle;
+}
+
+/**
+ * @brief  Reiht das Lesen von size Bytes in buffer ein. Der Puffer muss bis zum Callback gültig bleiben.
+ * @return 1, wenn eingereiht
+ */
+uint8_t SDQueue_Read(int8_t handle, void *buffer, uint32_t size, SDQueue_Callback callback, void *context)
+{
+	SDQueue_Request *request = SDQueue_Push(SDQUEUE_READ, handle, callback, context);
+	if (request == NULL) return 0;
+	request->buffer = buffer;
+	request->size = size;
+	return 1;
+}
+
+/**
+ * @brief  Reiht das Schreiben von size Bytes aus buffer ein. Der Puffer muss bis zum Callback gültig bleiben.
+ * @return 1, wenn eingereiht
+ */
+uint8_t SDQueue_Write(int8_t handle, const void *buffer, uint32_t size, SDQueue_Callback callback, void *context)
+{
+	SDQueue_Request *request = SDQueue_Push(SDQUEUE_WRITE, handle, callback, context);
+	if (request == NULL) return 0;
+	request->buffer = (uint8_t*)buffer;
+	request->size = size;
+	return 1;
+}
+
+/**
+ * @brief  Reiht das Setzen der Dateiposition ein.
+ * @return 1, wenn eingereiht
+ */
+uint8_t SDQueue_Seek(int8_t handle, FSIZE_t offset, SDQueue_Callback callback, void *context)
+{
+	SDQueue_Request *request = SDQueue_Push(SDQUEUE_SEEK, handle, callback, context);
+	if (request == NULL) return 0;
+	request->offset = offset;
+	return 1;
+}
+
+/**
+ * @brief  Reiht f_sync ein.
+ * @return 1, wenn eingereiht
+ */
+uint8_t SDQueue_Sync(int8_t handle, SDQueue_Callback callback, void *context)
+{
+	return SDQueue_Push(SDQUEUE_SYNC, handle, callback, context) != NULL;
+}
+
+/**
+ * @brief  Reiht das Schließen ein; das Handle wird nach der Ausführung wieder frei.
+ * @return 1, wenn eingereiht
+ */
+uint8_t SDQueue_Close(int8_t handle, SDQueue_Callback callback, void *context)
+{
+	return SDQueue_Push(SDQUEUE_CLOSE, handle, callback, context) != NULL;
+}
+
+/**
+ * @brief  Führt einen Schritt des ältesten Auftrags aus.
+ * @return 1, wenn der Auftrag abgeschlossen ist (result ist dann gültig)
+ */
+static uint8_t SDQueue_Step(SDQueue_Request *request, FRESULT *result)
+{
+	SDQueue_File *slot = &SDQueue_Files[request->handle];
+	UINT transferred = 0;
+
+	if (request->type != SDQUEUE_OPEN && !slot->opened) {
+		// Öffnen war fehlgeschlagen: Folgeaufträge nur noch quittieren
+		*result = FR_INVALID_OBJECT;
+		if (request->type == SDQUEUE_CLOSE) slot->used = 0;
+		return 1;
+	}
+
+	switch (request->type) {
+	case SDQUEUE_OPEN:
+		if (SDCard_Acquire() == NULL) {
+			*result = FR_NOT_READY;
+		} else {
+			*result = SDCard_CheckResult(f_open(&slot->file, request->path, request->mode));
+			if (*result == FR_OK) {
+				slot->opened = 1;
+				// Read-only files get a cluster table, so SDQueue_Seek() does not walk the FAT chain
+				if (request->mode == FA_READ) FastSeek_Attach(&slot->file);
+			} else {
+				SDCard_Release();
+			}
+		}
+		return 1;
+
+	case SDQUEUE_READ:
+	case SDQUEUE_WRITE: {
+		uint32_t chunk = request->size - request->done;
+		if (chunk > SDQUEUE_SLICE_BYTES) chunk = SDQUEUE_SLICE_BYTES;
+		if (request->type == SDQUEUE_READ) {
+			*result = f_read(&slot->file, request->buffer + request->done, chunk, &transferred);
+		} else {
+			*result = f_write(&slot->file, request->buffer + request->done, chunk, &transferred);
+		}
+		SDCard_CheckResult(*result);
+		request->done += transferred;
+		// Fertig bei Fehler, Dateiende (Read) bzw. voller Karte (Write) oder vollständiger Übertragung
+		return *result != FR_OK || transferred < chunk || request->done >= request->size;
+	}
+
+	case SDQUEUE_SEEK:
+		*result = SDCard_CheckResult(f_lseek(&slot->file, request->offset));
+		return 1;
+
+	case SDQUEUE_SYNC:
+		*result = SDCard_CheckResult(f_sync(&slot->file));
+		return 1;
+
+	case SDQUEUE_CLOSE:
+		*result = SDCard_CheckResult(FastSeek_Close(&slot->file));
+		slot->opened = 0;
+		slot->used = 0;
+		SDCard_Release();
+		return 1;
+	}
+
+	*result = FR_INT_ERR;
+	return 1;
+}
+
+/**
+ * @brief  Arbeitet Aufträge ab, bis die Warteschlange leer oder budgetMs verbraucht ist.
+ *
+ * In jedem Durchlauf der Hauptschleife aufrufen. Mindestens ein Schritt wird immer
+ * ausgeführt, damit auch bei kleinem Budget Fortschritt entsteht.
+ */
+void SDQueue_Service(uint32_t budgetMs)
+{
+	if (SDQueue_Running) return;
+	SDQueue_Running = 1;
+
+	uint32_t start = HAL_GetTick();
+	while (SDQueue_Count > 0) {
+		SDQueue_Request *request = &SDQueue_Requests[SDQueue_Tail];
+		FRESULT result = FR_OK;
+
+		if (SDQueue_Step(request, &result)) {
+			// Auftrag vor dem Callback entfernen, damit dieser neue einreihen kann
+			SDQueue_Callback callback = request->callback;
+			void *context = request->context;
+			uint32_t bytes = request->done;
+			SDQueue_Tail = (SDQueue_Tail + 1) % SDQUEUE_DEPTH;
+			SDQueue_Count--;
+			if (callback != NULL) callback(result, bytes, context);
+		}
+
+		if (HAL_GetTick() - start >= budgetMs) break;
+	}
+
+	SDQueue_Running = 0;
+}
+
+/**
+ * @brief  Anzahl noch nicht abgeschlossener Aufträge.
+ */
+uint8_t SDQueue_Pending()
+{
+	return SDQueue_Count;
+}
@@ -1,6 +1,10 @@
 
 
 #include "SSD1306.h"
+#include "Cache.h"
+#include "I2CBus.h"
+#include "BusStat.h"
+#include "BusFast.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -10,6 +14,79 @@
  * DATASHEET: https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf
  */
 
+#if I2CBUS_1_HZ > SSD1306_I2C_MAX_HZ
+#error "I2CBUS_1_HZ ist zu hoch für das SSD1306"
+#endif
+
+/*
+ * Update per DMA mit Doppelpuffer und Dirty-Tracking:
+ * Gezeichnet wird in SSD1306_Buffer (hinterer Puffer). SSD1306_Front enthält, was zuletzt
+ * zum Display gesendet wurde. Zeichenfunktionen merken sich je Seite (8 Pixelzeilen) die
+ * erste und letzte Spalte, deren Byte sich geändert hat. ssd1306_UpdateScreen() vergleicht
+ * in diesem Bereich beide Puffer wortweise und grenzt so die Spalten ein, die sich gegenüber
+ * dem Display wirklich unterscheiden - ein Fill() mit anschließendem Neuzeichnen desselben
+ * Texts erzeugt also keinen Verkehr. Nur diese Spanne wird in den vorderen Puffer kopiert,
+ * mit 0x21/0x22 (Horizontal Addressing Mode) adressiert und direkt aus dem vorderen Puffer
+ * per DMA gesendet; es darf also sofort weiter gezeichnet werden.
+ *
+ * Zu Beginn eines Durchlaufs werden die Dirty-Einträge aller Seiten atomar geholt und
+ * zurückgesetzt, verglichen und in den vorderen Puffer kopiert; ein gleichzeitiges Markieren
+ * im Hauptprogramm kann höchstens zu viel, nie zu wenig senden. Danach gehen die Fenster
+ * nacheinander hinaus, je Fenster Befehle und Daten als zwei direkt aufeinander folgende
+ * Transaktionen auf I2CBus_1; der Abschluss-Callback startet das nächste. Wird ein Update
+ * angefordert, während noch eines läuft, folgt danach ein weiterer Durchlauf.
+ *
+ * Nach ssd1306_InvalidateAll() (Init, Übertragungsfehler) ist der Inhalt des Displays
+ * unbekannt; der nächste Durchlauf sendet dann alle markierten Spalten ohne Vergleich.
+ *
+ * Die einzelnen Befehle von Init, Kontrast usw. gehen weiter blockierend hinaus, nachdem
+ * die Warteschlange leer ist, und zwar direkt über die Register (BusFast.c). Zwischen
+ * ssd1306_BeginCommands() und ssd1306_EndCommands() sammelt ssd1306_WriteCommand() sie nur
+ * und sendet sie dann hinter einem Kontrollbyte 0x00 in einer Transaktion; Init kostet so
+ * einmal START, Adresse und STOP statt 27-mal.
+ *
+ * Das Adressfenster (0x21/0x22) entfällt, wenn es dem zuletzt gesendeten gleicht: nach einem
+ * vollständig geschriebenen Fenster steht der Zeiger des Displays wieder an dessen Anfang.
+ * Benachbarte veränderte Seiten teilen sich ein Fenster und eine Datentransaktion, solange die
+ * dabei mitgesendeten unveränderten Spalten weniger kosten als eine eigene Seite
+ * (SSD1306_PAGE_OVERHEAD). Befehle und Daten in einer Transaktion über das Co-Bit (0x80 vor
+ * jedem Befehlsbyte) wären länger als die eingesparte zweite Adressierung und entfallen.
+ *
+ * Hardware-Scrollen (0x26/0x27, 0x29/0x2A) verschiebt den Inhalt des GDDRAM im Display selbst,
+ * nach dem Einrichten fällt kein I2C-Verkehr mehr an. Währenddessen darf das RAM nicht
+ * beschrieben werden: ssd1306_UpdateScreen() lässt die Änderungen markiert liegen, bis
+ * ssd1306_ScrollStop() das Scrollen beendet. Danach passt SSD1306_Front nicht mehr zum
+ * Display, das nächste Update sendet deshalb alles neu.
+ */
+
+// Dirty-Eintrag einer Seite: erste Spalte << 8 | letzte Spalte, CLEAN = unverändert
+#define SSD1306_CLEAN           0xFF00
+
+// Befehle für Scrollen, Ausblenden und Zoom
+#define SSD1306_CMD_SCROLL_RIGHT        0x26
+#define SSD1306_CMD_SCROLL_DIAG_RIGHT   0x29
+#define SSD1306_CMD_SCROLL_STOP         0x2E
+#define SSD1306_CMD_SCROLL_START        0x2F
+#define SSD1306_CMD_SCROLL_AREA         0xA3
+#define SSD1306_CMD_FADE                0x23
+#define SSD1306_CMD_ZOOM                0xD6
+
+#define SSD1306_BUS             I2CBus_1
+
+static void ssd1306_MarkDirty(uint8_t page, uint8_t first, uint8_t last);
+static void ssd1306_StartPass(void);
+static uint8_t ssd1306_SendNextPage(void);
+static uint8_t ssd1306_DiffSpan(uint8_t page, uint8_t *first, uint8_t *last);
+static void ssd1306_TxCommandsDone(uint8_t ok, void *context);
+static void ssd1306_TxDone(uint8_t ok, void *context);
+static void ssd1306_WriteCommands(const uint8_t *bytes, uint8_t count);
+static void ssd1306_WaitUpdate(void);
+
+// Gesammelte Befehle zwischen ssd1306_BeginCommands() und ssd1306_EndCommands()
+static uint8_t SSD1306_Batch[SSD1306_COMMAND_BATCH];
+static uint8_t SSD1306_BatchCount = 0;
+static uint8_t SSD1306_BatchDepth = 0;
+
 
 void ssd1306_Reset(void) {
 
@@ -24,7 +101,40 @@ void ssd1306_Reset(void) {
  * @param byte Das zu sendende Befehlsbyte.
  */
 void ssd1306_WriteCommand(uint8_t byte) {
-    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, &byte, 1, HAL_MAX_DELAY);
+    if (SSD1306_BatchDepth) {
+        if (SSD1306_BatchCount == sizeof(SSD1306_Batch)) {
+            ssd1306_WriteCommands(SSD1306_Batch, SSD1306_BatchCount);
+            SSD1306_BatchCount = 0;
+        }
+        SSD1306_Batch[SSD1306_BatchCount++] = byte;
+        return;
+    }
+
+    I2CBus_WaitIdle(&SSD1306_BUS, SSD1306_WAIT_TIMEOUT);
+    BUSSTAT_CALL(BUSSTAT_ID_SSD1306, BUSSTAT_COMMAND, 1,
+                 BusFast_I2CMemWrite(&SSD1306_BUS, SSD1306_I2C_ADDR, 0x00, &byte, 1, SSD1306_WAIT_TIMEOUT));
+}
+
+/**
+ * @brief Beginnt eine Befehlsfolge: ssd1306_WriteCommand() sammelt bis ssd1306_EndCommands().
+ *
+ * Paare lassen sich schachteln (z.B. ssd1306_SetContrast() innerhalb von ssd1306_Init()), gesendet
+ * wird beim äußersten ssd1306_EndCommands() bzw. wenn SSD1306_COMMAND_BATCH Bytes gesammelt sind.
+ */
+void ssd1306_BeginCommands(void) {
+    SSD1306_BatchDepth++;
+}
+
+/**
+ * @brief Beendet eine Befehlsfolge und sendet die gesammelten Befehle in einer Transaktion.
+ */
+void ssd1306_EndCommands(void) {
+    if (SSD1306_BatchDepth == 0 || --SSD1306_BatchDepth != 0)
+        return;
+    if (SSD1306_BatchCount) {
+        ssd1306_WriteCommands(SSD1306_Batch, SSD1306_BatchCount);
+        SSD1306_BatchCount = 0;
+    }
 }
 
 
@@ -39,12 +149,32 @@ void ssd1306_WriteCommand(uint8_t byte) {
  * @param buff_size Größe des zu sendenden Datenpuffers in Bytes.
  */
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
-    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size, HAL_MAX_DELAY);
+    I2CBus_WaitIdle(&SSD1306_BUS, SSD1306_WAIT_TIMEOUT);
+    BUSSTAT_CALL(BUSSTAT_ID_SSD1306, BUSSTAT_DATA, buff_size,
+                 HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size, SSD1306_WAIT_TIMEOUT));
 }
 
 
-// Screenbuffer
-static uint8_t SSD1306_Buffer[SSD1306_BUFFER_SIZE];
+// Screenbuffer, word-aligned for ssd1306_Fill()
+static uint8_t SSD1306_Buffer[SSD1306_BUFFER_SIZE] __attribute__((aligned(4)));
+
+// Veränderte Spalten je Seite
+static volatile uint16_t SSD1306_Dirty[SSD1306_PAGES];
+
+// Vorderer Puffer (Inhalt des Displays) und Befehle für das Adressfenster, beide für den DMA
+static uint8_t SSD1306_Front[SSD1306_BUFFER_SIZE] DMA_BUFFER;
+static uint8_t SSD1306_TxCommands[6] DMA_BUFFER;
+// Fenster über mehrere Seiten, schmaler als das Display: zeilenweise aus dem vorderen Puffer gepackt
+static uint8_t SSD1306_TxPacked[SSD1306_BUFFER_SIZE] DMA_BUFFER;
+static volatile uint8_t SSD1306_TxBusy = 0;
+static volatile uint8_t SSD1306_TxError = 0;
+static uint8_t SSD1306_TxPage;                      // nächste zu sendende Seite im Durchlauf
+static uint16_t SSD1306_TxSpan[SSD1306_PAGES];      // zu sendende Spalten je Seite, wie SSD1306_Dirty
+static uint8_t SSD1306_Window[4];                   // zuletzt gesendetes Fenster: Spalten, Seiten
+static volatile uint8_t SSD1306_WindowValid = 0;    // Zeiger des Displays steht am Anfang von SSD1306_Window
+static volatile uint8_t SSD1306_FrontInvalid = 1;   // Displayinhalt unbekannt
+static volatile uint8_t SSD1306_UpdatePending = 0;
+static SSD1306_UpdateCompleteCallback SSD1306_CompleteCallback = NULL;
 
 // Screen object
 static SSD1306_t SSD1306;
@@ -64,9 +194,14 @@ static SSD1306_t SSD1306;
 void ssd1306_Init(void) {
     ssd1306_Reset();
 
-    HAL_Delay(100);
+    // From the boot task this has long passed, only a call right after reset still waits
+    uint32_t elapsed = HAL_GetTick();
+    if (elapsed < SSD1306_POWER_UP_MS) {
+        HAL_Delay(SSD1306_POWER_UP_MS - elapsed);
+    }
 
-    // Init OLED
+    // Init OLED; alle Befehle bis zum Einschalten gehen in einer Transaktion hinaus
+    ssd1306_BeginCommands();
     ssd1306_SetDisplayOn(0); // Display ausschalten
 
     //https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf#page=34
@@ -294,11 +429,13 @@ void ssd1306_Init(void) {
     ssd1306_WriteCommand(0x14);
 
     ssd1306_SetDisplayOn(1); // Display einschalten
+    ssd1306_EndCommands();
 
     //https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf#page=64
 
-    // Bildschirm löschen
+    // Bildschirm löschen; der Inhalt des Display-RAMs ist unbekannt, also alles senden
     ssd1306_Fill(Black);
+    ssd1306_InvalidateAll();
 
     // Pufferinhalt auf das Display schreiben
     ssd1306_UpdateScreen();
@@ -312,23 +449,322 @@ void ssd1306_Init(void) {
 
 /* Fill the whole screen with the given color */
 void ssd1306_Fill(SSD1306_COLOR color) {
-    memset(SSD1306_Buffer, (color == Black) ? 0x00 : 0xFF, sizeof(SSD1306_Buffer));
+    uint32_t value = (color == Black) ? 0x00000000 : 0xFFFFFFFF;
+
+    // Compared and written a word (4 columns) at a time; only changed words are marked dirty
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        uint32_t *row = (uint32_t *)&SSD1306_Buffer[SSD1306_WIDTH * page];
+        int16_t first = -1, last = -1;
+
+        for (uint8_t w = 0; w < SSD1306_WIDTH / 4; w++) {
+            if (row[w] != value) {
+                if (first < 0) first = w;
+                last = w;
+                row[w] = value;
+            }
+        }
+
+        if (first >= 0)
+            ssd1306_MarkDirty(page, first * 4, last * 4 + 3);
+    }
 }
 
-/* Write the screenbuffer with changed to the screen */
+/* Write the changed part of the screenbuffer to the screen (DMA, returns immediately) */
 void ssd1306_UpdateScreen(void) {
-    // Write data to each page of RAM. Number of pages
-    // depends on the screen height:
-    //
-    //  * 32px   ==  4 pages
-    //  * 64px   ==  8 pages
-    //  * 128px  ==  16 pages
-    for(uint8_t i = 0; i < SSD1306_HEIGHT/8; i++) {
-        ssd1306_WriteCommand(0xB0 + i); // Set the current RAM page address.
-        ssd1306_WriteCommand(0x00);
-        ssd1306_WriteCommand(0x10);
-        ssd1306_WriteData(&SSD1306_Buffer[SSD1306_WIDTH*i],SSD1306_WIDTH);
+    // The RAM must not be written while it scrolls, the marks wait for ssd1306_ScrollStop()
+    if (SSD1306.Scrolling)
+        return;
+
+    __disable_irq();
+    if (SSD1306_TxBusy) {
+        // The completion callback starts the next update
+        SSD1306_UpdatePending = 1;
+        __enable_irq();
+        return;
+    }
+    SSD1306_TxBusy = 1;
+    __enable_irq();
+
+    ssd1306_StartPass();
+    if (!ssd1306_SendNextPage())
+        SSD1306_TxBusy = 0;
+}
+
+/**
+ * @brief Gibt an, ob gerade ein Update per DMA läuft.
+ */
+uint8_t ssd1306_IsBusy(void) {
+    return SSD1306_TxBusy;
+}
+
+/**
+ * @brief Registriert einen Callback, der am Ende jedes Updates per DMA aufgerufen wird (auch nach Fehlern).
+ * @note  Läuft im Interrupt-Kontext von I2CBus_1; ein Update ohne geänderte Spalten meldet sich nicht.
+ */
+void ssd1306_SetUpdateCompleteCallback(SSD1306_UpdateCompleteCallback callback) {
+    SSD1306_CompleteCallback = callback;
+}
+
+/**
+ * @brief Markiert den ganzen Puffer als verändert, das nächste Update sendet alles.
+ */
+void ssd1306_InvalidateAll(void) {
+    SSD1306_FrontInvalid = 1;
+    SSD1306_WindowValid = 0;
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
+        ssd1306_MarkDirty(page, 0, SSD1306_WIDTH - 1);
+}
+
+/**
+ * @brief Merkt einen veränderten Spaltenbereich einer Seite vor.
+ *
+ * Liest und schreibt den Eintrag ohne Sperre: Holt ssd1306_SendNextPage() ihn dazwischen ab,
+ * bleibt der alte Bereich zusätzlich markiert und wird ein zweites Mal gesendet.
+ */
+static void ssd1306_MarkDirty(uint8_t page, uint8_t first, uint8_t last) {
+    uint16_t dirty = SSD1306_Dirty[page];
+    uint8_t dirtyFirst = dirty >> 8;
+    uint8_t dirtyLast = dirty & 0xFF;
+
+    if (first < dirtyFirst) dirtyFirst = first;
+    if (last > dirtyLast) dirtyLast = last;
+
+    SSD1306_Dirty[page] = (uint16_t)(dirtyFirst << 8 | dirtyLast);
+}
+
+/**
+ * @brief Schreibt spaltenweise Bitmuster (Bit 0 = oberste Zeile) in den Puffer.
+ *
+ * Jede Spalte wird auf die Zeile y verschoben und mit einer Maske der Höhe height in
+ * die betroffenen Seiten geschrieben; liegt y nicht auf einer Seitengrenze, verteilt sie
+ * sich auf zwei (bzw. mehr) Bytes. Gesetzte Bits erhalten color, die übrigen die inverse
+ * Farbe (wie bei ssd1306_WriteChar()). Geänderte Spalten werden je Seite einmal markiert.
+ * y + height darf höchstens 64 sein; Spalten rechts außerhalb des Displays entfallen.
+ *
+ * @param columns (height+7)/8 Bytes je Spalte, niederwertiges Byte zuerst
+ */
+void ssd1306_DrawColumns(uint8_t x, uint8_t y, const uint8_t *columns, uint8_t width, uint8_t height, SSD1306_COLOR color) {
+    const uint8_t bytesPerColumn = (height + 7) / 8;
+    const uint8_t firstPage = y / 8;
+    const uint8_t shift = y % 8;
+    const uint64_t mask = (((uint64_t)1 << height) - 1) << shift;
+    uint8_t lastPage = (y + height - 1) / 8;
+    int16_t first[SSD1306_PAGES], last[SSD1306_PAGES];
+
+    if (lastPage >= SSD1306_PAGES) lastPage = SSD1306_PAGES - 1;
+    for (uint8_t page = firstPage; page <= lastPage; page++)
+        first[page] = last[page] = -1;
+
+    for (uint8_t j = 0; j < width && x + j < SSD1306_WIDTH; j++) {
+        uint64_t bits = 0;
+        for (uint8_t k = 0; k < bytesPerColumn; k++)
+            bits |= (uint64_t)columns[j * bytesPerColumn + k] << (8 * k);
+
+        uint64_t on = (color == White) ? (bits << shift) & mask : ~(bits << shift) & mask;
+
+        for (uint8_t page = firstPage; page <= lastPage; page++) {
+            uint8_t *byte = &SSD1306_Buffer[SSD1306_WIDTH * page + x + j];
+            uint8_t pageShift = 8 * (page - firstPage);
+            uint8_t pageMask = (uint8_t)(mask >> pageShift);
+            uint8_t value = (*byte & ~pageMask) | (uint8_t)(on >> pageShift);
+
+            if (value != *byte) {
+                *byte = value;
+                if (first[page] < 0) first[page] = x + j;
+                last[page] = x + j;
+            }
+        }
+    }
+
+    for (uint8_t page = firstPage; page <= lastPage; page++) {
+        if (first[page] >= 0)
+            ssd1306_MarkDirty(page, first[page], last[page]);
+    }
+}
+
+/**
+ * @brief Beginnt einen Durchlauf: holt, vergleicht und kopiert die veränderten Spalten aller Seiten.
+ *
+ * Ohne laufenden Transfer aufrufen (SSD1306_TxBusy gesetzt, aber nichts eingereiht), der vordere
+ * Puffer wird hier beschrieben. Was danach gezeichnet wird, bleibt für den nächsten Durchlauf markiert.
+ */
+static void ssd1306_StartPass(void) {
+    uint8_t full = SSD1306_FrontInvalid;
+
+    SSD1306_TxPage = 0;
+    SSD1306_FrontInvalid = 0;
+
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        uint16_t dirty;
+
+        // Fetch and reset atomically; cleared before the copy so later changes stay marked
+        do {
+            dirty = __LDREXH(&SSD1306_Dirty[page]);
+        } while (__STREXH(SSD1306_CLEAN, &SSD1306_Dirty[page]));
+
+        uint8_t first = dirty >> 8, last = dirty & 0xFF;
+        if (first > last || (!full && !ssd1306_DiffSpan(page, &first, &last))) {
+            SSD1306_TxSpan[page] = SSD1306_CLEAN;
+            continue;
+        }
+
+        memcpy(&SSD1306_Front[SSD1306_WIDTH * page + first], &SSD1306_Buffer[SSD1306_WIDTH * page + first],
+               last - first + 1);
+        SSD1306_TxSpan[page] = (uint16_t)(first << 8 | last);
+    }
+}
+
+/**
+ * @brief Reiht ab SSD1306_TxPage das nächste Fenster ein.
+ *
+ * Folgende Seiten kommen in dasselbe Fenster, solange die zusätzlich gesendeten Spalten
+ * (Vereinigung der Spannen) höchstens SSD1306_PAGE_OVERHEAD Bytes je gesparter Seite kosten.
+ * Die mitgesendeten unveränderten Spalten stammen aus dem vorderen Puffer und enthalten damit,
+ * was ohnehin auf dem Display steht. Gleicht das Fenster dem vorigen, entfallen die Befehle.
+ *
+ * @retval 1, wenn ein Transfer eingereiht wurde, 0 wenn der Durchlauf fertig ist oder die Warteschlange voll ist
+ */
+static uint8_t ssd1306_SendNextPage(void) {
+    while (SSD1306_TxPage < SSD1306_PAGES && SSD1306_TxSpan[SSD1306_TxPage] == SSD1306_CLEAN)
+        SSD1306_TxPage++;
+    if (SSD1306_TxPage >= SSD1306_PAGES)
+        return 0;
+
+    uint8_t firstPage = SSD1306_TxPage;
+    uint8_t lastPage = firstPage;
+    uint8_t first = SSD1306_TxSpan[firstPage] >> 8, last = SSD1306_TxSpan[firstPage] & 0xFF;
+    uint32_t cost = last - first + 1;
+
+    while (lastPage + 1 < SSD1306_PAGES && SSD1306_TxSpan[lastPage + 1] != SSD1306_CLEAN) {
+        uint8_t nextFirst = SSD1306_TxSpan[lastPage + 1] >> 8, nextLast = SSD1306_TxSpan[lastPage + 1] & 0xFF;
+        uint8_t mergedFirst = nextFirst < first ? nextFirst : first;
+        uint8_t mergedLast = nextLast > last ? nextLast : last;
+        uint32_t merged = (uint32_t)(mergedLast - mergedFirst + 1) * (lastPage - firstPage + 2);
+
+        if (merged > cost + (nextLast - nextFirst + 1) + SSD1306_PAGE_OVERHEAD)
+            break;
+        first = mergedFirst;
+        last = mergedLast;
+        cost = merged;
+        lastPage++;
+    }
+    SSD1306_TxPage = lastPage + 1;
+
+    uint16_t width = last - first + 1;
+    uint16_t length = width * (lastPage - firstPage + 1);
+    uint8_t *data = &SSD1306_Front[SSD1306_WIDTH * firstPage + first];
+    if (lastPage != firstPage && width != SSD1306_WIDTH) {
+        // Rows of the window are not contiguous in the front buffer
+        for (uint8_t page = firstPage; page <= lastPage; page++)
+            memcpy(&SSD1306_TxPacked[width * (page - firstPage)], &SSD1306_Front[SSD1306_WIDTH * page + first], width);
+        data = SSD1306_TxPacked;
+    }
+
+    uint8_t sameWindow = SSD1306_WindowValid &&
+                         SSD1306_Window[0] == first && SSD1306_Window[1] == last &&
+                         SSD1306_Window[2] == firstPage && SSD1306_Window[3] == lastPage;
+    SSD1306_TxError = 0;
+    if (!sameWindow) {
+        //https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf#page=35
+        SSD1306_TxCommands[0] = 0x21;       // Spaltenadresse: Anfang, Ende
+        SSD1306_TxCommands[1] = first;
+        SSD1306_TxCommands[2] = last;
+        SSD1306_TxCommands[3] = 0x22;       // Seitenadresse: Anfang, Ende
+        SSD1306_TxCommands[4] = firstPage;
+        SSD1306_TxCommands[5] = lastPage;
+        SSD1306_Window[0] = first;
+        SSD1306_Window[1] = last;
+        SSD1306_Window[2] = firstPage;
+        SSD1306_Window[3] = lastPage;
+        // Valid again only once the data has filled the window completely
+        SSD1306_WindowValid = 0;
+    }
+
+    // Commands and data are queued back to back, the data transfer ends the window
+    if ((!sameWindow &&
+         !I2CBus_MemWrite(&SSD1306_BUS, SSD1306_I2C_ADDR, 0x00, SSD1306_TxCommands, sizeof(SSD1306_TxCommands), ssd1306_TxCommandsDone, NULL)) ||
+        !I2CBus_MemWrite(&SSD1306_BUS, SSD1306_I2C_ADDR, 0x40, data, length, ssd1306_TxDone, NULL)) {
+        // The front buffer no longer matches the display: send everything again next time
+        ssd1306_InvalidateAll();
+        return 0;
     }
+    if (!sameWindow)
+        BUSSTAT_ASYNC(BUSSTAT_ID_SSD1306, BUSSTAT_COMMAND, sizeof(SSD1306_TxCommands));
+    BUSSTAT_ASYNC(BUSSTAT_ID_SSD1306, BUSSTAT_DATA, length);
+
+    return 1;
+}
+
+/**
+ * @brief Grenzt den markierten Bereich einer Seite auf die Spalten ein, die sich vom Display unterscheiden.
+ *
+ * Vergleicht hinteren und vorderen Puffer in 32-Bit-Wörtern und verfeinert nur die beiden
+ * Randwörter byteweise.
+ *
+ * @retval 1, wenn sich mindestens ein Byte unterscheidet
+ */
+static uint8_t ssd1306_DiffSpan(uint8_t page, uint8_t *first, uint8_t *last) {
+    const uint32_t *back = (const uint32_t *)&SSD1306_Buffer[SSD1306_WIDTH * page];
+    const uint32_t *front = (const uint32_t *)&SSD1306_Front[SSD1306_WIDTH * page];
+    int16_t wFirst = *first / 4, wLast = *last / 4;
+
+    while (wFirst <= wLast && back[wFirst] == front[wFirst]) wFirst++;
+    if (wFirst > wLast)
+        return 0;
+    while (back[wLast] == front[wLast]) wLast--;
+
+    const uint8_t *backBytes = (const uint8_t *)back;
+    const uint8_t *frontBytes = (const uint8_t *)front;
+    uint8_t x = wFirst * 4, y = wLast * 4 + 3;
+
+    while (backBytes[x] == frontBytes[x]) x++;
+    while (backBytes[y] == frontBytes[y]) y--;
+
+    *first = x;
+    *last = y;
+    return 1;
+}
+
+/**
+ * @brief Abschluss des Adressfensters (Interrupt): Fehler für ssd1306_TxDone() merken.
+ */
+static void ssd1306_TxCommandsDone(uint8_t ok, void *context) {
+    (void)context;
+
+    if (!ok)
+        SSD1306_TxError = 1;
+}
+
+/**
+ * @brief Abschluss einer Seite (Interrupt): nächste Seite bzw. nächstes Update starten.
+ */
+static void ssd1306_TxDone(uint8_t ok, void *context) {
+    (void)context;
+
+    // The data may have landed in a wrong window; the next update sends everything
+    if (!ok || SSD1306_TxError) {
+        ssd1306_InvalidateAll();
+        SSD1306_UpdatePending = 0;
+        SSD1306_TxBusy = 0;
+        if (SSD1306_CompleteCallback != NULL) SSD1306_CompleteCallback();
+        return;
+    }
+
+    // The window is full, the display's pointer is back at its start
+    SSD1306_WindowValid = 1;
+
+    if (ssd1306_SendNextPage())
+        return;
+
+    if (SSD1306_UpdatePending) {
+        SSD1306_UpdatePending = 0;
+        ssd1306_StartPass();
+        if (ssd1306_SendNextPage())
+            return;
+    }
+
+    SSD1306_TxBusy = 0;
+    if (SSD1306_CompleteCallback != NULL) SSD1306_CompleteCallback();
 }
 
 void ssd1306_SetDisplayOn(const uint8_t on) {
@@ -345,8 +781,144 @@ void ssd1306_SetDisplayOn(const uint8_t on) {
 
 void ssd1306_SetContrast(const uint8_t value) {
     const uint8_t kSetContrastControlRegister = 0x81;
+    ssd1306_BeginCommands();
     ssd1306_WriteCommand(kSetContrastControlRegister);
     ssd1306_WriteCommand(value);
+    ssd1306_EndCommands();
+}
+
+/**
+ * @brief Startet dauerhaftes waagerechtes Scrollen eines Seitenbereichs.
+ *
+ * Ein laufendes Update wird noch zu Ende gesendet, danach verschiebt das Display den Inhalt
+ * selbst. Bis ssd1306_ScrollStop() werden keine Änderungen übertragen.
+ *
+ * @param dir Richtung
+ * @param startPage, endPage Erste und letzte Seite (0 bis SSD1306_PAGES-1), je 8 Pixelzeilen
+ * @param interval Bilder je Schritt um eine Spalte
+ */
+void ssd1306_ScrollHorizontal(SSD1306_ScrollDir dir, uint8_t startPage, uint8_t endPage, SSD1306_ScrollInterval interval) {
+    //https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf#page=44
+    const uint8_t commands[] = {
+        SSD1306_CMD_SCROLL_STOP,
+        SSD1306_CMD_SCROLL_RIGHT + dir,
+        0x00,                                   // Dummy
+        startPage & 0x07,
+        interval,
+        endPage & 0x07,
+        0x00,                                   // Dummy
+        0xFF,                                   // Dummy
+        SSD1306_CMD_SCROLL_START
+    };
+
+    ssd1306_WaitUpdate();
+    ssd1306_WriteCommands(commands, sizeof(commands));
+    SSD1306.Scrolling = 1;
+}
+
+/**
+ * @brief Startet dauerhaftes senkrechtes und waagerechtes Scrollen.
+ *
+ * Senkrecht bewegt sich der Bereich aus ssd1306_SetVerticalScrollArea() (Voreinstellung: ganzes
+ * Display), waagerecht nur die Seiten startPage bis endPage.
+ *
+ * @param verticalOffset Zeilen je Schritt nach oben, 0 = nur waagerecht, 1 bis 63
+ */
+void ssd1306_ScrollDiagonal(SSD1306_ScrollDir dir, uint8_t startPage, uint8_t endPage, SSD1306_ScrollInterval interval,
+                            uint8_t verticalOffset) {
+    //https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf#page=46
+    const uint8_t commands[] = {
+        SSD1306_CMD_SCROLL_STOP,
+        SSD1306_CMD_SCROLL_DIAG_RIGHT + dir,
+        0x00,                                   // Dummy
+        startPage & 0x07,
+        interval,
+        endPage & 0x07,
+        verticalOffset & 0x3F,
+        SSD1306_CMD_SCROLL_START
+    };
+
+    ssd1306_WaitUpdate();
+    ssd1306_WriteCommands(commands, sizeof(commands));
+    SSD1306.Scrolling = 1;
+}
+
+/**
+ * @brief Legt fest, welche Zeilen beim diagonalen Scrollen senkrecht wandern.
+ *
+ * @param fixedRows Feste Zeilen oben, z.B. für eine stehende Kopfzeile
+ * @param scrollRows Anzahl der wandernden Zeilen darunter, fixedRows + scrollRows <= SSD1306_HEIGHT
+ */
+void ssd1306_SetVerticalScrollArea(uint8_t fixedRows, uint8_t scrollRows) {
+    const uint8_t commands[] = { SSD1306_CMD_SCROLL_AREA, fixedRows & 0x3F, scrollRows & 0x7F };
+
+    ssd1306_WriteCommands(commands, sizeof(commands));
+}
+
+/**
+ * @brief Beendet das Scrollen; das nächste Update schreibt den ganzen Puffer neu.
+ *
+ * Laut Datenblatt muss das RAM nach 0x2E neu beschrieben werden, der verschobene Inhalt
+ * passt nicht mehr zum Puffer.
+ */
+void ssd1306_ScrollStop(void) {
+    ssd1306_WriteCommand(SSD1306_CMD_SCROLL_STOP);
+    if (!SSD1306.Scrolling)
+        return;
+    SSD1306.Scrolling = 0;
+    ssd1306_InvalidateAll();
+}
+
+/**
+ * @brief Gibt an, ob das Display gerade selbst scrollt (Updates werden zurückgehalten).
+ */
+uint8_t ssd1306_IsScrolling(void) {
+    return SSD1306.Scrolling;
+}
+
+/**
+ * @brief Blendet das Display selbstständig aus oder lässt es blinken.
+ *
+ * Der Kontrast sinkt bzw. pulsiert ohne weiteren Verkehr; SSD1306_FADE_OFF stellt den mit
+ * ssd1306_SetContrast() gesetzten Wert wieder her.
+ *
+ * @param mode Aus, Ausblenden oder Blinken
+ * @param interval Schrittweite des Kontrasts: alle 8 * (interval + 1) Bilder, 0 bis 15
+ */
+void ssd1306_SetFade(SSD1306_FadeMode mode, uint8_t interval) {
+    const uint8_t commands[] = { SSD1306_CMD_FADE, (uint8_t)mode | (interval & 0x0F) };
+
+    ssd1306_WriteCommands(commands, sizeof(commands));
+}
+
+/**
+ * @brief Schaltet den Zoom ein: jede Zeile der oberen Hälfte wird doppelt angezeigt.
+ *
+ * Setzt die alternative COM-Pin-Konfiguration voraus (0xDA 0x12, wie in ssd1306_Init()).
+ */
+void ssd1306_SetZoom(const uint8_t on) {
+    const uint8_t commands[] = { SSD1306_CMD_ZOOM, on ? 0x01 : 0x00 };
+
+    ssd1306_WriteCommands(commands, sizeof(commands));
+}
+
+/**
+ * @brief Sendet mehrere Befehlsbytes hinter einem Kontrollbyte in einer Transaktion.
+ */
+static void ssd1306_WriteCommands(const uint8_t *bytes, uint8_t count) {
+    I2CBus_WaitIdle(&SSD1306_BUS, SSD1306_WAIT_TIMEOUT);
+    BUSSTAT_CALL(BUSSTAT_ID_SSD1306, BUSSTAT_COMMAND, count,
+                 BusFast_I2CMemWrite(&SSD1306_BUS, SSD1306_I2C_ADDR, 0x00, bytes, count, SSD1306_WAIT_TIMEOUT));
+}
+
+/**
+ * @brief Wartet, bis ein laufendes Update alle Seiten gesendet hat (höchstens SSD1306_WAIT_TIMEOUT ms).
+ */
+static void ssd1306_WaitUpdate(void) {
+    uint32_t start = HAL_GetTick();
+
+    while (SSD1306_TxBusy && HAL_GetTick() - start < SSD1306_WAIT_TIMEOUT) {
+    }
 }
 
 /**
@@ -387,10 +959,19 @@ void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
      * 2. 1 << (y % 8): Bestimmt das richtige Bit innerhalb des gefundenen Bytes
      *    - y % 8: Bestimmt die Position des Pixels innerhalb der 8-Pixel-Spalte (0-7)
      */
+    // Nur echte Änderungen werden für das nächste Update vorgemerkt.
+    uint8_t *byte = &SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH];
+    uint8_t value;
+
     if(color == White) {
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+        value = *byte | 1 << (y % 8);
     } else {
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+        value = *byte & ~(1 << (y % 8));
+    }
+
+    if (value != *byte) {
+        *byte = value;
+        ssd1306_MarkDirty(y / 8, x, x);
     }
 }
 
@@ -491,14 +1072,31 @@ void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD13
     uint8_t y_start = ((y1 <= y2) ? y1 : y2); // Kleinere Y-Koordinate als Startpunkt.
     uint8_t y_end   = ((y1 <= y2) ? y2 : y1); // Größere Y-Koordinate als Endpunkt.
 
-    // Iteriert über alle Pixel im definierten Rechteckbereich.
-    // Die äußere Schleife durchläuft die Y-Koordinaten (Zeilen),
-    // während die innere Schleife die X-Koordinaten (Spalten) durchläuft.
-    for (uint8_t y = y_start; (y <= y_end) && (y < SSD1306_HEIGHT); y++) {
-        for (uint8_t x = x_start; (x <= x_end) && (x < SSD1306_WIDTH); x++) {
-            // Zeichnet ein Pixel an der aktuellen Position (x, y) mit der angegebenen Farbe.
-            ssd1306_DrawPixel(x, y, color);
+    if (x_start >= SSD1306_WIDTH || y_start >= SSD1306_HEIGHT)
+        return;
+    if (x_end >= SSD1306_WIDTH) x_end = SSD1306_WIDTH - 1;
+    if (y_end >= SSD1306_HEIGHT) y_end = SSD1306_HEIGHT - 1;
+
+    // Seitenweise statt Pixel für Pixel: je Seite eine Bitmaske der betroffenen Zeilen,
+    // die mit ganzen Bytes gesetzt (White) bzw. gelöscht (Black) wird.
+    for (uint8_t page = y_start / 8; page <= y_end / 8; page++) {
+        uint8_t top = (page == y_start / 8) ? y_start % 8 : 0;
+        uint8_t bottom = (page == y_end / 8) ? y_end % 8 : 7;
+        uint8_t mask = (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+        uint8_t *row = &SSD1306_Buffer[SSD1306_WIDTH * page];
+        int16_t first = -1, last = -1;
+
+        for (uint8_t x = x_start; x <= x_end; x++) {
+            uint8_t value = (color == White) ? (row[x] | mask) : (row[x] & ~mask);
+            if (value != row[x]) {
+                row[x] = value;
+                if (first < 0) first = x;
+                last = x;
+            }
         }
+
+        if (first >= 0)
+            ssd1306_MarkDirty(page, first, last);
     }
 }
 
@@ -536,6 +1134,15 @@ char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
         return 0;
     }
 
+    if (Font.columns != NULL) {
+        // Schnellweg: vorberechnete Spaltenbytes direkt in die Seiten schreiben
+        const uint8_t bytesPerColumn = (Font.height + 7) / 8;
+        ssd1306_DrawColumns(SSD1306.CurrentX, SSD1306.CurrentY,
+                &Font.columns[(ch - 32) * Font.width * bytesPerColumn], char_width, Font.height, color);
+        SSD1306.CurrentX += char_width;
+        return ch;
+    }
+
     // Zeichnet das Zeichen Pixel für Pixel basierend auf der Schriftart.
     for(i = 0; i < Font.height; i++) {
         b = Font.data[(ch - 32) * Font.height + i]; // Ruft die Pixel-Daten für die aktuelle Zeile ab.
@@ -0,0 +1,363 @@
+/**
+ * @file    Scheduler.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Kooperativer Scheduler für periodische Tasks auf Basis des 1-ms-Takts von TIM7
+ *
+ * Jeder Task hat eine Periode, eine Deadline und eine Priorität. Realtime_Loop() ruft im
+ * TIM7-Interrupt jede Millisekunde Scheduler_Tick() auf; dort werden fällige Tasks nur als
+ * bereit markiert. Die Hauptschleife ruft Scheduler_Dispatch() auf, das jeweils den
+ * bereiten Task mit der höchsten Priorität (kleinste Zahl, bei Gleichstand der zuerst
+ * registrierte) vollständig ausführt. Tasks unterbrechen sich also nie gegenseitig und
+ * dürfen ohne Sperren auf gemeinsame Daten zugreifen, müssen aber zügig zurückkehren.
+ *
+ * Statistik je Task:
+ * - Latenz: Takte von der Freigabe bis zum Start; max - min ist der Jitter
+ * - Laufzeit: größte Dauer eines Durchlaufs
+ * - Overrun: Task war erst nach Ablauf der Deadline fertig
+ * - Skipped: Task wurde erneut freigegeben, bevor der vorige Durchlauf begonnen hatte
+ *
+ * Ist nichts bereit, ruft die Hauptschleife Scheduler_Idle() auf. Mit SCHEDULER_TICKLESS
+ * schläft der Kern dort über Realtime_Sleep() bis zur nächsten Freigabe, sonst bis zum
+ * nächsten Interrupt. Die Takte im Leerlauf ergeben die CPU-Last: (gesamt - Leerlauf) / gesamt
+ * über SCHEDULER_LOAD_WINDOW_MS, abrufbar mit Scheduler_GetLoad() und in Prof_Dump().
+ * Interrupts zählen als Last, da sie erst nach dem Aufwachen laufen.
+ *
+ * Die Takte kommen vom DWT-Zähler, den Scheduler_Init() einschaltet, falls Prof_Init()
+ * es noch nicht getan hat.
+ */
+
+#include "Scheduler.h"
+#include "Realtime.h"
+#include "Trace.h"
+#include "LowPower.h"
+#include <stdio.h>
+
+Scheduler_Task Scheduler_Tasks[SCHEDULER_MAX_TASKS];
+uint8_t Scheduler_TaskCount = 0;
+volatile uint32_t Scheduler_Ticks = 0;
+
+uint32_t Scheduler_IdleCycles = 0;
+static uint32_t Scheduler_IdleTotal = 0;
+uint32_t Scheduler_WindowStartCycle = 0;
+uint32_t Scheduler_WindowStartTick = 0;
+uint32_t Scheduler_Load = 0;
+
+static void Scheduler_ResetTask(Scheduler_Task *task);
+static uint32_t Scheduler_TimeToNextRelease(void);
+static void Scheduler_UpdateLoad(void);
+static uint32_t Scheduler_CyclesToUs(uint32_t cycles);
+
+/**
+ * @brief  Entfernt alle Tasks und schaltet den Zykluszähler für die Statistik ein
+ */
+void Scheduler_Init(void) {
+	if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->LAR = 0xC5ACCE55;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+
+	Scheduler_TaskCount = 0;
+	Scheduler_IdleCycles = 0;
+	Scheduler_WindowStartCycle = DWT->CYCCNT;
+	Scheduler_WindowStartTick = Scheduler_Ticks;
+}
+
+/**
+ * @brief  Registriert einen periodischen Task, die erste Freigabe erfolgt im nächsten Tick
+ * @param  name: Name für Scheduler_Dump()
+ * @param  function: Task-Funktion
+ * @param  context: wird an die Funktion übergeben
+ * @param  periodMs: Periode in ms (mindestens 1)
+ * @param  deadlineMs: Deadline ab Freigabe in ms, 0 = gleich der Periode
+ * @param  priority: 0 = höchste Priorität
+ * @retval Nummer des Tasks oder SCHEDULER_INVALID_TASK
+ */
+uint8_t Scheduler_AddTask(const char *name, Scheduler_TaskFunction function, void *context,
+		uint32_t periodMs, uint32_t deadlineMs, uint8_t priority) {
+	if (Scheduler_TaskCount >= SCHEDULER_MAX_TASKS || function == NULL || periodMs == 0)
+		return SCHEDULER_INVALID_TASK;
+
+	Scheduler_Task *task = &Scheduler_Tasks[Scheduler_TaskCount];
+	task->name = name;
+	task->function = function;
+	task->context = context;
+	task->periodMs = periodMs;
+	task->deadlineMs = deadlineMs ? deadlineMs : periodMs;
+	task->priority = priority;
+	task->ready = 0;
+	task->nextRelease = Scheduler_Ticks + 1;
+	task->enabled = 1;
+	Scheduler_ResetTask(task);
+
+	// Count is published last: the tick interrupt only looks at complete entries
+	__DMB();
+	Scheduler_TaskCount++;
+
+	return Scheduler_TaskCount - 1;
+}
+
+/**
+ * @brief  Schaltet einen Task ein oder aus; beim Einschalten wird er im nächsten Tick fällig
+ */
+void Scheduler_SetEnabled(uint8_t id, uint8_t enabled) {
+	if (id >= Scheduler_TaskCount)
+		return;
+
+	Scheduler_Task *task = &Scheduler_Tasks[id];
+	if (enabled && !task->enabled)
+		task->nextRelease = Scheduler_Ticks + 1;
+	task->ready = 0;
+	task->enabled = enabled ? 1 : 0;
+}
+
+/**
+ * @brief  Gibt fällige Tasks frei, wird aus dem TIM7-Interrupt aufgerufen
+ * @param  elapsedMs: Millisekunden seit dem letzten Aufruf (1, nach Realtime_Sleep() mehr)
+ */
+RAMFUNC void Scheduler_Tick(uint32_t elapsedMs) {
+	uint32_t now = Scheduler_Ticks += elapsedMs;
+
+	for (uint8_t i = 0; i < Scheduler_TaskCount; i++) {
+		Scheduler_Task *task = &Scheduler_Tasks[i];
+		if (!task->enabled || (int32_t)(now - task->nextRelease) < 0)
+			continue;
+
+		task->nextRelease += task->periodMs;
+		if (task->ready) {
+			task->skipped++;
+			continue;
+		}
+
+		task->releaseTick = now;
+		task->releaseCycle = DWT->CYCCNT;
+		task->ready = 1;
+	}
+}
+
+/**
+ * @brief  Gibt einen Task außerhalb seiner Periode frei, z.B. aus einem Interrupt (TE des Displays)
+ *
+ * Die periodische Freigabe läuft unverändert weiter. Aufrufbar aus jedem Kontext, auch aus
+ * Tasks (Topic_EndPublish()): die kurze Sperre schützt gegen Scheduler_Tick() im TIM7-Interrupt.
+ */
+RAMFUNC void Scheduler_Release(uint8_t id) {
+	if (id >= Scheduler_TaskCount)
+		return;
+
+	Scheduler_Task *task = &Scheduler_Tasks[id];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (task->enabled) {
+		if (task->ready) {
+			task->skipped++;
+		} else {
+			task->releaseTick = Scheduler_Ticks;
+			task->releaseCycle = DWT->CYCCNT;
+			task->ready = 1;
+		}
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Legt die nächste periodische Freigabe auf delayMs ab jetzt, danach geht es im Takt weiter
+ *
+ * Für Tasks, die selbst eine Wartezeit kennen (AWAIT_MS in Async.h): der Tickless-Schlaf reicht
+ * dann genau bis dahin. Die Freigabe kann früher oder später als die periodische liegen.
+ * Aufrufbar aus jedem Kontext wie Scheduler_Release().
+ */
+RAMFUNC void Scheduler_ReleaseAfter(uint8_t id, uint32_t delayMs) {
+	if (id >= Scheduler_TaskCount)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	Scheduler_Tasks[id].nextRelease = Scheduler_Ticks + (delayMs ? delayMs : 1);
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Führt den bereiten Task mit der höchsten Priorität aus
+ * @retval 1, wenn ein Task gelaufen ist, 0 wenn nichts bereit war
+ */
+uint8_t Scheduler_Dispatch(void) {
+	Scheduler_Task *next = NULL;
+
+	Scheduler_UpdateLoad();
+
+	for (uint8_t i = 0; i < Scheduler_TaskCount; i++) {
+		Scheduler_Task *task = &Scheduler_Tasks[i];
+		if (task->ready && (next == NULL || task->priority < next->priority))
+			next = task;
+	}
+
+	if (next == NULL)
+		return 0;
+
+	// Clear before running so a release during the run is not counted as skipped
+	__disable_irq();
+	uint32_t releaseTick = next->releaseTick;
+	uint32_t releaseCycle = next->releaseCycle;
+	next->ready = 0;
+	__enable_irq();
+
+	TRACE_TASK_START(next - Scheduler_Tasks);
+	uint32_t start = DWT->CYCCNT;
+	LOWPOWER_TASK_START(start);
+	next->function(next->context);
+	uint32_t end = DWT->CYCCNT;
+	TRACE_TASK_STOP(next - Scheduler_Tasks);
+
+	uint32_t latency = start - releaseCycle;
+	uint32_t runtime = end - start;
+	next->runs++;
+	if (latency < next->minLatency) next->minLatency = latency;
+	if (latency > next->maxLatency) next->maxLatency = latency;
+	if (runtime > next->maxRuntime) next->maxRuntime = runtime;
+	if (Scheduler_Ticks - releaseTick > next->deadlineMs) next->overruns++;
+
+	return 1;
+}
+
+/**
+ * @brief  Leerlauf der Hauptschleife: schläft, bis ein Task bereit sein kann
+ *
+ * Die Prüfung auf bereite Tasks und das Einschlafen geschehen bei gesperrten Interrupts,
+ * damit keine Freigabe dazwischen verloren geht.
+ */
+void Scheduler_Idle(void) {
+	uint32_t start = DWT->CYCCNT;
+
+	__disable_irq();
+	uint32_t sleepMs = Scheduler_TimeToNextRelease();
+	if (sleepMs > 0) {
+#if SCHEDULER_TICKLESS
+		Realtime_Sleep(sleepMs);
+#else
+		Realtime_Sleep(1);
+#endif
+	}
+	uint32_t idle = DWT->CYCCNT - start;
+	Scheduler_IdleCycles += idle;
+	Scheduler_IdleTotal += idle;
+	__enable_irq();
+}
+
+/**
+ * @brief  Millisekunden seit dem Start von TIM7
+ */
+uint32_t Scheduler_GetTicks(void) {
+	return Scheduler_Ticks;
+}
+
+/**
+ * @brief  CPU-Last im letzten Zeitfenster
+ * @retval Last in Promille (0-1000)
+ */
+uint32_t Scheduler_GetLoad(void) {
+	return Scheduler_Load;
+}
+
+/**
+ * @brief  Takte im Leerlauf seit dem Start, läuft über; für eigene Messfenster Differenzen bilden
+ */
+uint32_t Scheduler_GetIdleCycles(void) {
+	return Scheduler_IdleTotal;
+}
+
+/**
+ * @brief  Anzahl registrierter Tasks, ihre Ids sind 0 bis Anzahl - 1
+ */
+uint8_t Scheduler_GetTaskCount(void) {
+	return Scheduler_TaskCount;
+}
+
+/**
+ * @brief  Setzt die Statistik aller Tasks zurück
+ */
+void Scheduler_ResetStats(void) {
+	for (uint8_t i = 0; i < Scheduler_TaskCount; i++)
+		Scheduler_ResetTask(&Scheduler_Tasks[i]);
+}
+
+/**
+ * @brief  Gibt die Statistik aller Tasks als Tabelle über printf aus (Zeiten in µs)
+ */
+void Scheduler_Dump(void) {
+	printf("\nTasks nach %lu ms, CPU-Last %lu.%lu %%\n", Scheduler_Ticks,
+			Scheduler_Load / 10, Scheduler_Load % 10);
+	printf("%-10s %4s %6s %8s %8s %8s %10s %10s\n", "Task", "Prio", "Periode", "Laeufe",
+			"Overrun", "Skipped", "Jitter[us]", "Max [us]");
+
+	for (uint8_t i = 0; i < Scheduler_TaskCount; i++) {
+		Scheduler_Task *task = &Scheduler_Tasks[i];
+		uint32_t jitter = task->runs ? Scheduler_CyclesToUs(task->maxLatency - task->minLatency) : 0;
+
+		printf("%-10s %4u %6lu %8lu %8lu %8lu %10lu %10lu\n", task->name, task->priority,
+				task->periodMs, task->runs, task->overruns, task->skipped, jitter,
+				Scheduler_CyclesToUs(task->maxRuntime));
+	}
+}
+
+/**
+ * @brief  Millisekunden bis zur nächsten Freigabe, 0 wenn ein Task bereit ist
+ */
+static uint32_t Scheduler_TimeToNextRelease(void) {
+	uint32_t now = Scheduler_Ticks;
+	uint32_t next = REALTIME_TICKLESS_MAX_MS;
+
+	for (uint8_t i = 0; i < Scheduler_TaskCount; i++) {
+		Scheduler_Task *task = &Scheduler_Tasks[i];
+		if (!task->enabled)
+			continue;
+		if (task->ready)
+			return 0;
+
+		int32_t remaining = (int32_t)(task->nextRelease - now);
+		if (remaining < 1) remaining = 1;
+		if ((uint32_t)remaining < next) next = remaining;
+	}
+
+	return next;
+}
+
+/**
+ * @brief  Schließt nach SCHEDULER_LOAD_WINDOW_MS das Zeitfenster der CPU-Last ab
+ */
+static void Scheduler_UpdateLoad(void) {
+	if (Scheduler_Ticks - Scheduler_WindowStartTick < SCHEDULER_LOAD_WINDOW_MS)
+		return;
+
+	uint32_t now = DWT->CYCCNT;
+	uint32_t total = now - Scheduler_WindowStartCycle;
+	uint32_t idle = Scheduler_IdleCycles < total ? Scheduler_IdleCycles : total;
+
+	Scheduler_Load = total ? (uint32_t)((uint64_t)(total - idle) * 1000U / total) : 0;
+	Scheduler_IdleCycles = 0;
+	Scheduler_WindowStartCycle = now;
+	Scheduler_WindowStartTick = Scheduler_Ticks;
+}
+
+/**
+ * @brief  Setzt die Statistik eines Tasks zurück
+ */
+static void Scheduler_ResetTask(Scheduler_Task *task) {
+	task->runs = 0;
+	task->overruns = 0;
+	task->skipped = 0;
+	task->minLatency = UINT32_MAX;
+	task->maxLatency = 0;
+	task->maxRuntime = 0;
+}
+
+/**
+ * @brief  Rechnet Takte in Mikrosekunden um
+ */
+static uint32_t Scheduler_CyclesToUs(uint32_t cycles) {
+	return cycles / (SystemCoreClock / 1000000UL);
+}
@@ -0,0 +1,525 @@
+/**
+ * @file    SensorLog.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Aufzeichnung aller Messwerte auf die SD-Karte: Potis (kHz), AHT20, Tasten und CAN über Stunden
+ *
+ * Jede Quelle schreibt ihre Sätze in einen eigenen Ringpuffer, mit genau einem Erzeuger je
+ * Ring: die ADC-Blöcke kopiert der Empfänger im DMA-Interrupt von ADC.c, Potis außerhalb des
+ * Messbetriebs, AHT20 und Tasten holt der Logger-Task aus den Topics (Topic.h), CAN-Rahmen
+ * schreibt der Mitschnitt von Can.c im FDCAN-Interrupt (SENSORLOG_OPT_CAN). Der Task
+ * übernimmt danach ganze Sätze aus allen Ringen in den Ringpuffer von SDLogger.c, der sie in
+ * 32-KB-Blöcken per DMA in die vorab reservierte Datei schreibt und jede Sekunde die Länge im
+ * Verzeichniseintrag sichert (f_sync). Ist ein Ring voll, wird der neue Satz ganz verworfen
+ * und gezählt; halbe Sätze gibt es in der Datei nie.
+ *
+ * Datei: Folge von Sätzen, jeder mit SensorLog_Header (8 Bytes) vor den Nutzdaten:
+ * - SYNC:    oberes Wort von Timebase_Us() (4), HAL-Tick in ms (4), bisher verworfene Sätze
+ *            aller Quellen (4), übergelaufene RX-FIFO-Rahmen von FDCAN1 seit dem Start (4);
+ *            der erste Satz der Datei und danach alle SENSORLOG_SYNC_MS.
+ *            Zusammen mit dem unteren Wort im Kopf ist das die volle 64-Bit-Zeit, die übrigen
+ *            Zeitstempel (Überlauf nach ~71 min) lösen sich daran zu einer Zeitachse auf.
+ * - ADC:     Blocknummer (4), Scans/s (4), Scans (2), Slots (1), Kodierung (1), Poti je Slot
+ *            (Slots Bytes), dann die Scans x Slots 16-Bit-Werte. Der Zeitstempel gehört zum Ende
+ *            des Blocks. Kodierung SENSORLOG_ADC_RAW: die Werte wie im DMA-Puffer;
+ *            SENSORLOG_ADC_DELTA: Differenzen je Slot als Zig-Zag-Varint (LogCodec.c);
+ *            SENSORLOG_ADC_LZ4: Länge der Differenzen (2), dann diese als LZ4-Block.
+ * - POTI:    4 x 16 Bit nach Totband, Bitmaske der bewegten (1), reserviert (1)
+ * - CLIMATE: Temperatur in 0,01 °C (int16), Luftfeuchte in 0,01 % (uint16), beide nochmals gefiltert
+ * - INPUT:   Eingabe (1), Ereignis (1), gedrückte Eingaben Bit 0-7 (1), reserviert (1), fortlaufende
+ *            Nummer (4), alle gedrückten Eingaben (4, mit Gamepad); Lücken in der Nummer zählen als
+ *            verworfen. Der Zeitstempel ist die Flanke.
+ * - CAN:     Kennung (4), Can-Flags (1), Länge (1), FIFO (1), reserviert (1), Daten (Länge, bei
+ *            Remote-Rahmen 0 Bytes). Der Zeitstempel ist der Beginn des Rahmens laut Hardware;
+ *            Sätze aus FIFO 0 und 1 (CanTp) sind einzeln, aber nicht untereinander sortiert.
+ *
+ * Ein voll belegter Bus mit 1 Mbit/s (~8800 Rahmen/s mit 8 Bytes) ergibt ~210 KB/s: der Ring
+ * für CAN überbrückt mit 64 KB rund 300 ms, in denen der Task auf die Karte wartet.
+ *
+ * Die ADC-Blöcke sind der größte Teil der Datei. Der Task kodiert sie beim Übernehmen in den
+ * SD-Puffer als Differenzen (ohne SENSORLOG_OPT_RAW), der Interrupt kopiert weiterhin nur.
+ * Ruhige Potis brauchen so gut 1 statt 2 Bytes je Wert, entsprechend seltener schreibt
+ * SDLogger.c einen 32-KB-Block. Mit SENSORLOG_OPT_LZ4 folgt ein LZ4-Durchgang über die
+ * Differenzen, aber nur solange der ADC-Ring höchstens zu einem Viertel gefüllt ist, der Task
+ * also Luft hat; unter Last bleibt es bei den Differenzen. Ein Block, der kodiert nicht
+ * kleiner wird, geht roh hinaus.
+ */
+
+#include "SensorLog.h"
+#include "SDLogger.h"
+#include "Scheduler.h"
+#include "Topic.h"
+#include "Timebase.h"
+#include "Can.h"
+#include "LogCodec.h"
+#include "adc.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+	uint8_t *buffer;
+	uint32_t size;                       // Zweierpotenz
+	volatile uint32_t head;              // written bytes, producer only, free running
+	volatile uint32_t tail;              // bytes moved to SDLogger, task only
+} SensorLog_Ring;
+
+typedef struct {
+	const void *data;
+	uint32_t length;
+} SensorLog_Part;
+
+// 16 KB hold eight 2 KB ADC blocks, about 2 s at 4 x 1 kHz
+static uint8_t SensorLog_SyncBuffer[256];
+static uint8_t SensorLog_AdcBuffer[16 * 1024];
+static uint8_t SensorLog_PotiBuffer[1024];
+static uint8_t SensorLog_ClimateBuffer[256];
+static uint8_t SensorLog_InputBuffer[512];
+static uint8_t SensorLog_CanBuffer[64 * 1024];
+
+// One ADC record out of its ring, encoded; the meta part lies in front of the values
+#define SENSORLOG_ADC_META        12
+#define SENSORLOG_ADC_RECORD      (sizeof(SensorLog_Header) + SENSORLOG_ADC_META + ADC_ACQ_MAX_SLOTS + 2 * ADC_ACQ_HALF_SAMPLES)
+static uint8_t SensorLog_AdcRecord[SENSORLOG_ADC_RECORD];
+static uint8_t SensorLog_AdcDelta[LOGCODEC_DELTA_BOUND(ADC_ACQ_HALF_SAMPLES)];
+static uint8_t SensorLog_AdcLz4[2 * ADC_ACQ_HALF_SAMPLES];
+
+static SensorLog_Ring SensorLog_Rings[SENSORLOG_SRC_COUNT] = {
+	[SENSORLOG_SRC_SYNC]    = { SensorLog_SyncBuffer,    sizeof(SensorLog_SyncBuffer) },
+	[SENSORLOG_SRC_ADC]     = { SensorLog_AdcBuffer,     sizeof(SensorLog_AdcBuffer) },
+	[SENSORLOG_SRC_POTI]    = { SensorLog_PotiBuffer,    sizeof(SensorLog_PotiBuffer) },
+	[SENSORLOG_SRC_CLIMATE] = { SensorLog_ClimateBuffer, sizeof(SensorLog_ClimateBuffer) },
+	[SENSORLOG_SRC_INPUT]   = { SensorLog_InputBuffer,   sizeof(SensorLog_InputBuffer) },
+	[SENSORLOG_SRC_CAN]     = { SensorLog_CanBuffer,     sizeof(SensorLog_CanBuffer) },
+};
+
+static const char *const SensorLog_Names[SENSORLOG_SRC_COUNT] = {
+	[SENSORLOG_SRC_SYNC]    = "sync",
+	[SENSORLOG_SRC_ADC]     = "adc",
+	[SENSORLOG_SRC_POTI]    = "poti",
+	[SENSORLOG_SRC_CLIMATE] = "climate",
+	[SENSORLOG_SRC_INPUT]   = "input",
+	[SENSORLOG_SRC_CAN]     = "can",
+};
+
+static SensorLog_Stats SensorLog_Counters[SENSORLOG_SRC_COUNT];
+static volatile uint8_t SensorLog_Running = 0;
+static uint8_t SensorLog_TaskId = 0;
+static uint32_t SensorLog_LastSync = 0;
+static uint32_t SensorLog_Errors = 0;
+static uint8_t SensorLog_Capturing = 0;
+static uint32_t SensorLog_CanLost = 0;             // Can_Stats.rxLost at SensorLog_Start()
+static uint8_t SensorLog_Options = 0;
+static uint32_t SensorLog_AdcRawBytes = 0;         // ADC records before and after encoding
+static uint32_t SensorLog_AdcBytes = 0;
+static uint32_t SensorLog_AdcLz4Blocks = 0;
+
+// Last values taken from the topics
+static uint32_t SensorLog_PotiSequence = 0;
+static uint32_t SensorLog_ClimateSequence = 0;
+static uint32_t SensorLog_InputSequence = 0;
+static uint32_t SensorLog_InputEvents = 0;
+
+static uint8_t SensorLog_BlockCallback(const ADC_Block *block, void *context);
+static void SensorLog_CanCallback(uint32_t timeUs, uint32_t id, uint8_t flags, uint8_t fifo,
+		const uint8_t *data, uint8_t length, void *context);
+static uint8_t SensorLog_Put(SensorLog_Source source, uint32_t timeUs, const SensorLog_Part *parts, uint8_t count);
+static void SensorLog_Copy(SensorLog_Ring *ring, uint32_t position, const void *data, uint32_t length);
+static void SensorLog_Collect(void);
+static void SensorLog_PutSync(void);
+static uint32_t SensorLog_Drain(SensorLog_Source source);
+static void SensorLog_WriteAdc(uint32_t length, uint32_t backlog);
+
+/**
+ * @brief  Meldet den Logger bei ADC.c und TOPIC_INPUT an, der Task bleibt bis SensorLog_Start() aus
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der SensorLog_Task() aufruft
+ */
+void SensorLog_Init(uint8_t taskId) {
+	SensorLog_TaskId = taskId;
+	Scheduler_SetEnabled(taskId, 0);
+
+	for (uint8_t i = 0; i < SENSORLOG_SRC_COUNT; i++) {
+		SensorLog_Counters[i].size = SensorLog_Rings[i].size;
+	}
+
+	ADC_AddBlockListener(SensorLog_BlockCallback, NULL);
+	// Button events come faster than the task period, catch each one while it is the latest
+	Topic_Subscribe(TOPIC_INPUT, taskId);
+}
+
+/**
+ * @brief  Legt die Logdatei an (capacity Bytes am Stück reserviert) und startet die Aufzeichnung
+ * @param  options: SENSORLOG_OPT_*
+ * @retval FR_OK, der Fehler von SDLogger_Open() oder FR_INVALID_PARAMETER, wenn der CAN-Mitschnitt nicht startet
+ */
+FRESULT SensorLog_Start(const char *path, uint32_t capacity, uint8_t options) {
+	if (SensorLog_Running)
+		SensorLog_Stop();
+
+	FRESULT res = SDLogger_Open(path, capacity);
+	if (res != FR_OK)
+		return res;
+
+	for (uint8_t i = 0; i < SENSORLOG_SRC_COUNT; i++) {
+		SensorLog_Rings[i].head = 0;
+		SensorLog_Rings[i].tail = 0;
+		SensorLog_Counters[i].records = 0;
+		SensorLog_Counters[i].dropped = 0;
+		SensorLog_Counters[i].maxFill = 0;
+	}
+	SensorLog_Errors = 0;
+	SensorLog_Options = options;
+	SensorLog_AdcRawBytes = 0;
+	SensorLog_AdcBytes = 0;
+	SensorLog_AdcLz4Blocks = 0;
+
+	// Only values published from now on
+	SensorLog_PotiSequence = Topic_GetSequence(TOPIC_POTI);
+	SensorLog_ClimateSequence = Topic_GetSequence(TOPIC_CLIMATE);
+	SensorLog_InputSequence = Topic_GetSequence(TOPIC_INPUT);
+	SensorLog_InputEvents = 0;
+	SensorLog_CanLost = Can_GetStats()->rxLost;
+
+	SensorLog_PutSync();
+	SensorLog_Running = 1;
+
+	SensorLog_Capturing = 0;
+	if (options & SENSORLOG_OPT_CAN) {
+		if (!Can_SetCapture(SensorLog_CanCallback, NULL)) {
+			SensorLog_Stop();
+			return FR_INVALID_PARAMETER;
+		}
+		SensorLog_Capturing = 1;
+	}
+	Scheduler_SetEnabled(SensorLog_TaskId, 1);
+	return FR_OK;
+}
+
+/**
+ * @brief  Übernimmt den Rest aller Ringe, schreibt den letzten Block und schließt die Datei
+ */
+FRESULT SensorLog_Stop(void) {
+	if (!SDLogger_IsOpen())
+		return FR_INVALID_OBJECT;
+
+	// The ADC listener checks the flag, after this the task is the only one touching the rings
+	SensorLog_Running = 0;
+	Scheduler_SetEnabled(SensorLog_TaskId, 0);
+	// With frames in the TX FIFO the filter stays open; the callback already ignores them
+	if (SensorLog_Capturing && Can_SetCapture(NULL, NULL))
+		SensorLog_Capturing = 0;
+
+	// Until nothing moves any more: rings empty, or the reserved file is full
+	FRESULT res = FR_OK;
+	uint32_t moved;
+	do {
+		moved = 0;
+		for (uint8_t i = 0; i < SENSORLOG_SRC_COUNT; i++) {
+			moved += SensorLog_Drain((SensorLog_Source)i);
+		}
+		if (moved) res = SDLogger_Process();
+	} while (moved && res == FR_OK);
+
+	FRESULT closeRes = SDLogger_Close();
+	return res != FR_OK ? res : closeRes;
+}
+
+/**
+ * @brief  Gibt an, ob gerade aufgezeichnet wird
+ */
+uint8_t SensorLog_IsRunning(void) {
+	return SensorLog_Running;
+}
+
+/**
+ * @brief  Zähler einer Quelle seit dem letzten SensorLog_Start()
+ */
+const SensorLog_Stats* SensorLog_GetStats(SensorLog_Source source) {
+	return &SensorLog_Counters[source];
+}
+
+/**
+ * @brief  Gibt Sätze, Verluste und Füllstände je Quelle sowie den Stand der Datei aus
+ */
+void SensorLog_Dump(void) {
+	printf("%-8s %9s %8s %11s\n", "Quelle", "Sätze", "Verloren", "Max/Ring");
+	for (uint8_t i = 0; i < SENSORLOG_SRC_COUNT; i++) {
+		const SensorLog_Stats *s = &SensorLog_Counters[i];
+		printf("%-8s %9lu %8lu %5lu/%-5lu\n", SensorLog_Names[i], s->records, s->dropped, s->maxFill, s->size);
+	}
+	printf("Datei: %lu Bytes, %lu Blöcke (max. %lu ms), %lu Checkpoints, SD-Puffer max. %lu/%u, "
+			"%lu Bytes verworfen, %lu Fehler\n",
+			SDLogger_Statistics.written, SDLogger_Statistics.writes, SDLogger_Statistics.maxWriteMs,
+			SDLogger_Statistics.checkpoints, SDLogger_Statistics.maxFill, SDLOGGER_RING_SIZE,
+			SDLogger_Statistics.dropped, SensorLog_Errors);
+	if (SensorLog_AdcRawBytes)
+		printf("ADC: %lu KB roh, %lu KB geschrieben (%lu %%), %lu Blöcke mit LZ4\n", SensorLog_AdcRawBytes / 1024,
+				SensorLog_AdcBytes / 1024, (uint32_t)((uint64_t)SensorLog_AdcBytes * 100 / SensorLog_AdcRawBytes),
+				SensorLog_AdcLz4Blocks);
+	if (SensorLog_Capturing)
+		printf("CAN: %lu Rahmen im RX-FIFO übergelaufen\n", Can_GetStats()->rxLost - SensorLog_CanLost);
+}
+
+/**
+ * @brief  Task: Topics abholen, Ringe in den SD-Puffer übernehmen, volle Blöcke schreiben
+ *
+ * Blockiert nur für den Multi-Block-Write selbst (SDLogger_Process(), ein paar ms je 32 KB).
+ * Ein Fehler der Karte beendet die Aufzeichnung; die Datei hat dann die Länge des letzten
+ * Checkpoints.
+ */
+void SensorLog_Task(void *context) {
+	if (!SensorLog_Running)
+		return;
+
+	SensorLog_Collect();
+
+	uint32_t now = HAL_GetTick();
+	if (now - SensorLog_LastSync >= SENSORLOG_SYNC_MS)
+		SensorLog_PutSync();
+
+	for (uint8_t i = 0; i < SENSORLOG_SRC_COUNT; i++) {
+		SensorLog_Drain((SensorLog_Source)i);
+	}
+
+	if (SDLogger_Process() != FR_OK) {
+		SensorLog_Errors++;
+		SensorLog_Stop();
+	}
+}
+
+/**
+ * @brief  Empfänger der ADC-Blöcke: kopiert den ganzen Block als Satz, hält ihn nicht
+ */
+static uint8_t SensorLog_BlockCallback(const ADC_Block *block, void *context) {
+	if (!SensorLog_Running)
+		return 0;
+
+	// Same derivation as the telemetry INFO packet: channel rate / its slots per scan
+	uint8_t channel = block->slotChannel[0];
+	uint32_t weight = 0;
+	for (uint8_t slot = 0; slot < block->slots; slot++)
+		weight += block->slotChannel[slot] == channel;
+
+	struct __attribute__((packed)) {
+		uint32_t sequence;
+		uint32_t scanHz;
+		uint16_t scans;
+		uint8_t slots;
+		uint8_t reserved;
+	} meta = { block->sequence, ADC_GetChannelRate(channel) / (weight ? weight : 1), block->scans, block->slots,
+			SENSORLOG_ADC_RAW };
+
+	SensorLog_Part parts[3] = {
+		{ &meta, sizeof(meta) },
+		{ block->slotChannel, block->slots },
+		{ block->data, 2U * block->scans * block->slots },
+	};
+	SensorLog_Put(SENSORLOG_SRC_ADC, Timebase_Us32(), parts, 3);
+	return 0;
+}
+
+/**
+ * @brief  Mitschnitt von Can.c: ein Satz je Rahmen, aus dem FDCAN-Interrupt (einziger Erzeuger des Rings)
+ */
+RAMFUNC static void SensorLog_CanCallback(uint32_t timeUs, uint32_t id, uint8_t flags, uint8_t fifo,
+		const uint8_t *data, uint8_t length, void *context) {
+	if (!SensorLog_Running)
+		return;
+
+	uint8_t meta[8] = { (uint8_t)id, (uint8_t)(id >> 8), (uint8_t)(id >> 16), (uint8_t)(id >> 24),
+			flags, length, fifo, 0 };
+	if (flags & CAN_FLAG_REMOTE)
+		length = 0;
+
+	SensorLog_Part parts[2] = { { meta, sizeof(meta) }, { data, length } };
+	SensorLog_Put(SENSORLOG_SRC_CAN, timeUs, parts, 2);
+}
+
+/**
+ * @brief  Holt neue Werte aus den Topics in ihre Ringe (Erzeuger dieser Ringe ist der Task)
+ */
+static void SensorLog_Collect(void) {
+	Topic_Poti poti;
+	Topic_Climate climate;
+	Topic_Input input;
+
+	// In acquisition mode the ADC blocks carry the pots at full rate
+	if (Topic_Read(TOPIC_POTI, &poti, sizeof(poti), &SensorLog_PotiSequence) && !ADC_IsAcquiring()) {
+		uint8_t tail[2] = { poti.changed, 0 };
+		SensorLog_Part parts[2] = { { poti.value, sizeof(poti.value) }, { tail, sizeof(tail) } };
+		SensorLog_Put(SENSORLOG_SRC_POTI, Timebase_Us32(), parts, 2);
+	}
+
+	if (Topic_Read(TOPIC_CLIMATE, &climate, sizeof(climate), &SensorLog_ClimateSequence)) {
+		SensorLog_Part parts[1] = { { &climate, sizeof(climate) } };
+		SensorLog_Put(SENSORLOG_SRC_CLIMATE, Timebase_Us32(), parts, 1);
+	}
+
+	if (Topic_Read(TOPIC_INPUT, &input, sizeof(input), &SensorLog_InputSequence)) {
+		// Low byte of the mask stays in the head for older decoders, the full mask (gamepad) follows
+		uint8_t head[4] = { input.event.input, input.event.type, (uint8_t)input.event.mask, 0 };
+		SensorLog_Part parts[3] = { { head, sizeof(head) }, { &input.events, sizeof(input.events) },
+				{ &input.event.mask, sizeof(input.event.mask) } };
+
+		// Published twice between two runs: the older one is gone
+		if (SensorLog_InputEvents != 0 && input.events - SensorLog_InputEvents > 1)
+			SensorLog_Counters[SENSORLOG_SRC_INPUT].dropped += input.events - SensorLog_InputEvents - 1;
+		SensorLog_InputEvents = input.events;
+		SensorLog_Put(SENSORLOG_SRC_INPUT, (uint32_t)input.event.timeUs, parts, 3);
+	}
+}
+
+/**
+ * @brief  Zeitbasis: oberes Wort der µs-Zeit und HAL-Tick zum Zeitstempel im Kopf
+ */
+static void SensorLog_PutSync(void) {
+	uint32_t dropped = 0;
+	for (uint8_t i = 0; i < SENSORLOG_SRC_COUNT; i++)
+		dropped += SensorLog_Counters[i].dropped;
+
+	uint64_t now = Timebase_Us();
+	uint32_t sync[4] = { (uint32_t)(now >> 32), HAL_GetTick(), dropped, Can_GetStats()->rxLost - SensorLog_CanLost };
+	SensorLog_Part parts[1] = { { sync, sizeof(sync) } };
+
+	SensorLog_LastSync = sync[1];
+	SensorLog_Put(SENSORLOG_SRC_SYNC, (uint32_t)now, parts, 1);
+}
+
+/**
+ * @brief  Schreibt einen Satz aus Kopf und count Teilen in den Ring seiner Quelle, ganz oder gar nicht
+ * @retval 1, wenn der Satz übernommen wurde
+ */
+RAMFUNC static uint8_t SensorLog_Put(SensorLog_Source source, uint32_t timeUs, const SensorLog_Part *parts, uint8_t count) {
+	SensorLog_Ring *ring = &SensorLog_Rings[source];
+	SensorLog_Stats *stats = &SensorLog_Counters[source];
+	uint32_t length = 0;
+
+	for (uint8_t i = 0; i < count; i++)
+		length += parts[i].length;
+
+	uint32_t head = ring->head;
+	uint32_t fill = head - ring->tail;
+	if (fill + sizeof(SensorLog_Header) + length > ring->size) {
+		stats->dropped++;
+		return 0;
+	}
+
+	SensorLog_Header header = { SENSORLOG_MAGIC, (uint8_t)source, (uint16_t)length, timeUs };
+	uint32_t position = head;
+	SensorLog_Copy(ring, position, &header, sizeof(header));
+	position += sizeof(header);
+	for (uint8_t i = 0; i < count; i++) {
+		SensorLog_Copy(ring, position, parts[i].data, parts[i].length);
+		position += parts[i].length;
+	}
+
+	// The record must be complete before the task sees the new head
+	__DMB();
+	ring->head = position;
+
+	stats->records++;
+	if (position - ring->tail > stats->maxFill)
+		stats->maxFill = position - ring->tail;
+	return 1;
+}
+
+/**
+ * @brief  Kopiert in den Ring ab einer freilaufenden Position, über das Ende hinweg
+ */
+RAMFUNC static void SensorLog_Copy(SensorLog_Ring *ring, uint32_t position, const void *data, uint32_t length) {
+	uint32_t offset = position & (ring->size - 1);
+	uint32_t first = ring->size - offset;
+
+	if (first > length) first = length;
+	memcpy(&ring->buffer[offset], data, first);
+	memcpy(ring->buffer, (const uint8_t*)data + first, length - first);
+}
+
+/**
+ * @brief  Übernimmt ganze Sätze aus einem Ring, solange der SD-Puffer Platz hat
+ * @retval Übernommene Bytes
+ */
+static uint32_t SensorLog_Drain(SensorLog_Source source) {
+	SensorLog_Ring *ring = &SensorLog_Rings[source];
+	uint32_t head = ring->head;
+	uint32_t tail = ring->tail;
+
+	// Record contents written before 'head', see SensorLog_Put()
+	__DMB();
+	while (tail != head) {
+		SensorLog_Header header;
+		uint32_t offset = tail & (ring->size - 1);
+		uint32_t first = ring->size - offset;
+
+		if (first >= sizeof(header)) {
+			memcpy(&header, &ring->buffer[offset], sizeof(header));
+		} else {
+			memcpy(&header, &ring->buffer[offset], first);
+			memcpy((uint8_t*)&header + first, ring->buffer, sizeof(header) - first);
+		}
+
+		uint32_t length = sizeof(header) + header.length;
+		if (SDLogger_GetFree() < length)
+			break;
+
+		// Both pieces go in, SDLogger_GetFree() said so; encoded ADC records are never longer
+		if (first > length) first = length;
+		if (source == SENSORLOG_SRC_ADC && !(SensorLog_Options & SENSORLOG_OPT_RAW) && length <= SENSORLOG_ADC_RECORD) {
+			memcpy(SensorLog_AdcRecord, &ring->buffer[offset], first);
+			memcpy(&SensorLog_AdcRecord[first], ring->buffer, length - first);
+			SensorLog_WriteAdc(length, head - tail);
+		} else {
+			SDLogger_Write(&ring->buffer[offset], first);
+			SDLogger_Write(ring->buffer, length - first);
+		}
+		tail += length;
+	}
+
+	uint32_t moved = tail - ring->tail;
+	ring->tail = tail;
+	return moved;
+}
+
+/**
+ * @brief  Schreibt den ADC-Satz in SensorLog_AdcRecord kodiert in den SD-Puffer
+ * @param  length: Länge des Satzes mit Kopf
+ * @param  backlog: Bytes im ADC-Ring ab diesem Satz; LZ4 nur, solange der Task nachkommt
+ */
+static void SensorLog_WriteAdc(uint32_t length, uint32_t backlog) {
+	SensorLog_Header *header = (SensorLog_Header*)SensorLog_AdcRecord;
+	uint8_t *meta = &SensorLog_AdcRecord[sizeof(SensorLog_Header)];
+	uint32_t scans = meta[8] | (meta[9] << 8);
+	uint8_t slots = meta[10];
+	uint32_t prefix = sizeof(SensorLog_Header) + SENSORLOG_ADC_META + slots;
+	uint32_t count = scans * slots;
+
+	const uint8_t *payload = &SensorLog_AdcRecord[prefix];
+	uint32_t payloadLength = length - prefix;
+	if (prefix + 2 * count == length) {
+		uint32_t deltaLength = LogCodec_DeltaEncode(payload, count, slots, SensorLog_AdcDelta);
+		if (deltaLength < payloadLength) {
+			meta[11] = SENSORLOG_ADC_DELTA;
+			payload = SensorLog_AdcDelta;
+			payloadLength = deltaLength;
+		}
+	}
+
+	// Two bytes for the decoded length, and only if that still saves something
+	if (meta[11] == SENSORLOG_ADC_DELTA && (SensorLog_Options & SENSORLOG_OPT_LZ4) && payloadLength > 16 &&
+			backlog <= SensorLog_Rings[SENSORLOG_SRC_ADC].size / 4) {
+		uint32_t packed = LogCodec_Lz4Compress(SensorLog_AdcDelta, payloadLength, &SensorLog_AdcLz4[2], payloadLength - 3);
+		if (packed) {
+			SensorLog_AdcLz4[0] = (uint8_t)payloadLength;
+			SensorLog_AdcLz4[1] = (uint8_t)(payloadLength >> 8);
+			meta[11] = SENSORLOG_ADC_LZ4;
+			payload = SensorLog_AdcLz4;
+			payloadLength = packed + 2;
+			SensorLog_AdcLz4Blocks++;
+		}
+	}
+
+	header->length = (uint16_t)(prefix - sizeof(SensorLog_Header) + payloadLength);
+	SDLogger_Write(SensorLog_AdcRecord, prefix);
+	SDLogger_Write(payload, payloadLength);
+	SensorLog_AdcRawBytes += length;
+	SensorLog_AdcBytes += prefix + payloadLength;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file    Serial.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Nicht blockierende Ausgabe über UART: Ringpuffer, geleert per DMA
+ *
+ * printf() landet über _write() in Serial_Write(). Das kopiert die Daten nur in
+ * einen Ringpuffer und startet, falls die UART gerade nichts sendet, eine DMA-Übertragung
+ * des zusammenhängenden Stücks ab dem Lesezeiger. Der Abschluss-Interrupt startet direkt das
+ * nächste Stück, bis der Puffer leer ist. Die Hauptschleife wartet damit nie auf die UART.
+ *
+ * Passt eine Ausgabe nicht mehr ganz in den Puffer, wird sie komplett verworfen (keine halben
+ * Zeilen) und in dropped mitgezählt. Serial_Write() darf auch aus Interrupts aufgerufen werden.
+ *
+ * Es gibt zwei Ports: Serial_Log (UART7, DMA1) für printf und LOG(), Serial_Shell (LPUART1, BDMA2)
+ * für die Antworten der Kommandozeile (Shell.c) und den Messdatenstrom (Telemetry.c). printf
+ * schreibt nach Serial_Stdout.
+ *
+ * Die Baudrate steht in CubeMX (usart.c): UART7 läuft mit 921600 Baud, LPUART1 mit 3 MBaud vom
+ * HSI (unabhängig vom Taktprofil), beide 8N1. Vor einer Taktumschaltung muss die laufende
+ * Übertragung auf UART7 mit Serial_Suspend() beendet werden, da MX_UART7_Init() die UART neu
+ * aufsetzt; Serial_Resume() sendet danach den Rest.
+ *
+ * Serial_SetExternal() übergibt den Ring einem anderen Sender: EspLink.c verschickt den Inhalt von
+ * Serial_Log als Kanal seiner Rahmen direkt aus dem Ring und rückt tail selbst vor, solange der
+ * ESP-Einsatz verbunden ist. Serial_Write() nimmt dabei unverändert Daten an.
+ *
+ * Die HAL-Callbacks in main.c leiten an Serial_TxCpltCallback() bzw. Serial_ErrorCallback() weiter.
+ */
+
+#include "Serial.h"
+#include "Cache.h"
+#include <string.h>
+
+static uint8_t Serial_LogBuffer[SERIAL_LOG_BUFFER_SIZE] DMA_BUFFER;
+static uint8_t Serial_ShellBuffer[SERIAL_SHELL_BUFFER_SIZE] BDMA_BUFFER;
+
+Serial_Port Serial_Log = {
+	.buffer = Serial_LogBuffer,
+	.size = SERIAL_LOG_BUFFER_SIZE,
+};
+
+Serial_Port Serial_Shell = {
+	.buffer = Serial_ShellBuffer,
+	.size = SERIAL_SHELL_BUFFER_SIZE,
+};
+
+// Target of printf (_write below); Shell.c points it at Serial_Shell while a command runs
+Serial_Port *Serial_Stdout = &Serial_Log;
+
+static Serial_Port *Serial_Find(UART_HandleTypeDef *huart);
+static void Serial_StartNext(Serial_Port *port);
+static uint8_t Serial_WaitIdle(Serial_Port *port, uint32_t timeoutMs, uint8_t empty);
+
+/**
+ * @brief  Ordnet einer UART einen Sendepuffer zu
+ * @param  port: Serial_Log oder Serial_Shell
+ * @param  huart: bereits mit MX_UARTx_Init() initialisiertes Handle mit TX-DMA-Kanal
+ */
+void Serial_Init(Serial_Port *port, UART_HandleTypeDef *huart) {
+	port->huart = huart;
+	port->head = 0;
+	port->tail = 0;
+	port->dmaLength = 0;
+	port->suspended = 0;
+	port->external = 0;
+	port->sent = 0;
+	port->dropped = 0;
+}
+
+/**
+ * @brief  Reiht Daten zum Senden ein, kehrt sofort zurück
+ * @retval Anzahl übernommener Bytes: length oder 0, wenn der Puffer zu voll war
+ */
+uint32_t Serial_Write(Serial_Port *port, const void *data, uint32_t length) {
+	const uint8_t *src = data;
+	uint32_t mask = port->size - 1;
+	uint32_t primask;
+
+	if (port->huart == NULL || length == 0)
+		return 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (length > port->size - (port->head - port->tail)) {
+		port->dropped += length;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+
+	// Copy in up to two parts around the end of the ring
+	uint32_t offset = port->head & mask;
+	uint32_t first = port->size - offset;
+	if (first > length)
+		first = length;
+	memcpy(&port->buffer[offset], src, first);
+	memcpy(port->buffer, src + first, length - first);
+	port->head += length;
+
+	if (port->dmaLength == 0 && !port->suspended)
+		Serial_StartNext(port);
+
+	__set_PRIMASK(primask);
+	return length;
+}
+
+/**
+ * @brief  Ersetzt das schwache _write() aus syscalls.c: printf() schreibt nach Serial_Stdout
+ * @note   Was nicht in den Ringpuffer passt, wird verworfen und gezählt, nicht blockiert
+ */
+int _write(int file, char *ptr, int len) {
+	(void)file;
+
+	Serial_Write(Serial_Stdout, ptr, (uint32_t)len);
+	return len;
+}
+
+/**
+ * @brief  Freier Platz im Sendepuffer in Bytes
+ */
+uint32_t Serial_GetFree(Serial_Port *port) {
+	return port->size - (port->head - port->tail);
+}
+
+/**
+ * @brief  Seit Serial_Init() verworfene Bytes
+ */
+uint32_t Serial_GetDropped(Serial_Port *port) {
+	return port->dropped;
+}
+
+/**
+ * @brief  Wartet, bis alles gesendet ist (z.B. vor einem Reset), nicht aus Interrupts aufrufen
+ * @retval 1 wenn der Puffer leer ist, 0 bei Timeout
+ */
+uint8_t Serial_Flush(Serial_Port *port, uint32_t timeoutMs) {
+	return Serial_WaitIdle(port, timeoutMs, 1);
+}
+
+/**
+ * @brief  Lässt die laufende Übertragung auslaufen und startet keine neue mehr
+ *
+ * Serial_Write() nimmt weiter Daten an, bis der Puffer voll ist.
+ * @retval 1 wenn die UART frei ist, 0 bei Timeout
+ */
+uint8_t Serial_Suspend(Serial_Port *port) {
+	port->suspended = 1;
+	return Serial_WaitIdle(port, SERIAL_WAIT_TIMEOUT, 0);
+}
+
+/**
+ * @brief  Sendet nach Serial_Suspend() weiter
+ */
+void Serial_Resume(Serial_Port *port) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	port->suspended = 0;
+	if (port->dmaLength == 0)
+		Serial_StartNext(port);
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Übergibt den Ring an einen anderen Sender bzw. holt ihn zurück
+ *
+ * Wartet vorher auf das Ende der eigenen Übertragung. Beim Zurückholen muss der andere Sender
+ * fertig sein; was er nicht gesendet hat (head bis tail), geht danach über die DMA der UART.
+ * @retval 1 bei Erfolg, 0 wenn die laufende Übertragung nicht rechtzeitig fertig wurde
+ */
+uint8_t Serial_SetExternal(Serial_Port *port, uint8_t external) {
+	if (!Serial_Suspend(port)) {
+		Serial_Resume(port);
+		return 0;
+	}
+	port->external = external;
+	Serial_Resume(port);
+	return 1;
+}
+
+/**
+ * @brief  Aus HAL_UART_TxCpltCallback(): Stück ist gesendet, nächstes starten
+ */
+void Serial_TxCpltCallback(UART_HandleTypeDef *huart) {
+	Serial_Port *port = Serial_Find(huart);
+	if (port == NULL || port->dmaLength == 0)
+		return;
+
+	port->tail += port->dmaLength;
+	port->sent += port->dmaLength;
+	port->dmaLength = 0;
+
+	if (!port->suspended)
+		Serial_StartNext(port);
+}
+
+/**
+ * @brief  Aus HAL_UART_ErrorCallback(): das laufende Stück verwerfen und weitersenden
+ */
+void Serial_ErrorCallback(UART_HandleTypeDef *huart) {
+	Serial_Port *port = Serial_Find(huart);
+	if (port == NULL || port->dmaLength == 0 || huart->gState != HAL_UART_STATE_READY)
+		return;
+
+	port->tail += port->dmaLength;
+	port->dropped += port->dmaLength;
+	port->dmaLength = 0;
+
+	if (!port->suspended)
+		Serial_StartNext(port);
+}
+
+/**
+ * @brief  Sucht den Sendepuffer zu einem UART-Handle
+ */
+static Serial_Port *Serial_Find(UART_HandleTypeDef *huart) {
+	if (Serial_Log.huart == huart)
+		return &Serial_Log;
+	if (Serial_Shell.huart == huart)
+		return &Serial_Shell;
+	return NULL;
+}
+
+/**
+ * @brief  Startet die DMA-Übertragung des zusammenhängenden Stücks ab tail (Interrupts gesperrt)
+ */
+static void Serial_StartNext(Serial_Port *port) {
+	uint32_t pending = port->head - port->tail;
+	uint32_t offset = port->tail & (port->size - 1);
+	uint32_t length = port->size - offset;
+
+	if (pending == 0 || port->external)
+		return;
+	if (length > pending)
+		length = pending;
+	if (length > 0xFFFF)
+		length = 0xFFFF;
+
+	// Buffer is in non-cacheable RAM, no cache maintenance needed
+	port->dmaLength = length;
+	if (HAL_UART_Transmit_DMA(port->huart, &port->buffer[offset], (uint16_t)length) != HAL_OK)
+		port->dmaLength = 0;
+}
+
+/**
+ * @brief  Wartet auf das Ende der laufenden Übertragung bzw. bis der Puffer leer ist
+ */
+static uint8_t Serial_WaitIdle(Serial_Port *port, uint32_t timeoutMs, uint8_t empty) {
+	uint32_t start = HAL_GetTick();
+
+	while (port->dmaLength != 0 || (empty && port->head != port->tail && !port->suspended && !port->external)) {
+		if (HAL_GetTick() - start >= timeoutMs)
+			return 0;
+		// A start refused by the HAL (UART busy) is retried from here
+		if (port->dmaLength == 0 && !port->suspended)
+			Serial_Resume(port);
+	}
+	return (!empty || port->head == port->tail || port->external);
+}
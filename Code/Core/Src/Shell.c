@@ -0,0 +1,1333 @@
+/**
+ * @file    Shell.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Kommandozeile auf LPUART1: Empfang per DMA mit Idle-Erkennung, Auswertung im Scheduler-Task
+ *
+ * HAL_UARTEx_ReceiveToIdle_DMA() schreibt alle empfangenen Zeichen zirkulär in Shell_RxBuffer.
+ * Bei halbem und vollem Puffer sowie bei einer Sendepause meldet die HAL die neue DMA-Position;
+ * Shell_RxEventCallback() zählt dabei nur die Zeilenenden und schaltet den Shell-Task ein.
+ * Ohne Eingabe ist der Task ausgeschaltet und kostet in der Hauptschleife nichts.
+ *
+ * Der Task zerlegt jede fertige Zeile direkt im DMA-Puffer (Leerzeichen werden zu '\0',
+ * argv zeigt in den Puffer). Nur eine Zeile, die über das Pufferende läuft, wird einmal nach
+ * Shell_Line kopiert. Ausgaben der Befehle gehen per printf über Serial_Shell zurück an LPUART1.
+ * Shell_Submit() reicht eine Zeile von anderswo (EspLink.c) ein, ihre Ausgabe geht an den
+ * mitgegebenen Sendepuffer; bis der Task sie ausgeführt hat, nimmt Shell_Submit() keine weitere an.
+ *
+ * Befehle: help, prof [reset], tasks, async [reset], clock [low|balanced|max], bench, sd [stat | format [fat|exfat] ja], flash, stat,
+ * gov [on|off|reset], stop [on|off|reset], therm [reset], esp [off | reset], usb [reset], pad [reset], mirror [on uart|esp | off | key | reset], trace [on|off], stack, photon [reset], tele [on [adc] [aht] [timing] | off | dec n], can [send|fd id bytes], xfer [send n | node 0|1],
+ * matrix [text | off], update [sd datei | can | apply n | abort], anim [datei | asset:name] [x y] [once] | stop | stat.
+ * Das Terminal muss die Eingabe selbst anzeigen (lokales Echo), Zeilenende CR, LF oder CRLF.
+ */
+
+#include "Shell.h"
+#include "Serial.h"
+#include "Cache.h"
+#include "Scheduler.h"
+#include "Async.h"
+#include "Timer.h"
+#include "Prof.h"
+#include "BusStat.h"
+#include "Clock.h"
+#include "Governor.h"
+#include "Thermal.h"
+#include "LowPower.h"
+#include "WarmBoot.h"
+#include "EspLink.h"
+#include "UsbCdc.h"
+#include "Gamepad.h"
+#include "Mirror.h"
+#include "octospi.h"
+#include "ILI9341.h"
+#include "ILI9341_TE.h"
+#include "ILI9341_Widget.h"
+#include "ILI9341_Screenshot.h"
+#include "ILI9341_Power.h"
+#include "Anim.h"
+#include "Thumb.h"
+#include "AssetCache.h"
+#include "Pipe.h"
+#include "Pool.h"
+#include "Arena.h"
+#include "SDCard.h"
+#include "SDCache.h"
+#include "FastSeek.h"
+#include "ff_gen_drv.h"
+#include "sd_diskio.h"
+#include "W25Qxx_QSPI.h"
+#include "FlashPool.h"
+#include "UserInput.h"
+#include "Telemetry.h"
+#include "Can.h"
+#include "CanTp.h"
+#include "LED_Matrix.h"
+#include "Boot.h"
+#include "DmaAlloc.h"
+#include "Irq.h"
+#include "BusQos.h"
+#include "Trace.h"
+#include "Stack.h"
+#include "InputLatency.h"
+#include "Topic.h"
+#include "SensorLog.h"
+#include "Update.h"
+#include "Overlay.h"
+#include "Canvas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (SHELL_RX_BUFFER_SIZE & (SHELL_RX_BUFFER_SIZE - 1)) != 0
+#error "SHELL_RX_BUFFER_SIZE muss eine Zweierpotenz sein!"
+#endif
+
+#define SHELL_RX_MASK             (SHELL_RX_BUFFER_SIZE - 1)
+
+/* Bytes je Durchgang und Gesamtmenge des Flash-Lesetests */
+#define SHELL_FLASH_CHUNK         4096
+#define SHELL_FLASH_TEST_SIZE     (256UL * 1024UL)
+
+/* Vollbilder im Display-Benchmark */
+#define SHELL_BENCH_FRAMES        10
+
+/* FNV-1a über die mit 'xfer' gesendeten bzw. empfangenen Daten */
+#define SHELL_FNV_BASIS           2166136261UL
+#define SHELL_FNV_PRIME           16777619UL
+
+/* Abstand der AHT20- und Timing-Pakete bei 'tele on' in ms */
+#define SHELL_TELE_PERIOD_MS      1000
+
+static uint8_t Shell_RxBuffer[SHELL_RX_BUFFER_SIZE] BDMA_BUFFER;
+static char Shell_Line[SHELL_RX_BUFFER_SIZE];     // only for a line across the end of the ring
+static uint8_t Shell_FlashBuffer[SHELL_FLASH_CHUNK] AXI_BUFFER;
+
+static UART_HandleTypeDef *Shell_Uart = NULL;
+static uint8_t Shell_TaskId = SCHEDULER_INVALID_TASK;
+static uint8_t Shell_Running = 0;                 // DMA reception armed
+
+static uint16_t Shell_RxPos = 0;                  // DMA position at the last event
+static volatile uint32_t Shell_Received = 0;      // bytes received, free running
+static volatile uint32_t Shell_LineEnds = 0;      // CR/LF seen by the callback
+static uint32_t Shell_Parsed = 0;                 // bytes consumed by the task
+static uint32_t Shell_LineEndsDone = 0;
+
+// Line handed in by Shell_Submit(), executed by the task with its own output port
+static char Shell_Remote[SHELL_RX_BUFFER_SIZE];
+static Serial_Port *Shell_RemoteOut = NULL;
+static volatile uint8_t Shell_RemotePending = 0;
+
+static uint32_t Shell_XferHash = SHELL_FNV_BASIS; // over the data received last via CanTp
+
+static void Shell_Start(void);
+static uint8_t Shell_NextLine(char **line);
+static uint8_t Shell_Split(char *line, char *argv[]);
+static void Shell_Execute(uint8_t argc, char *argv[]);
+
+static void Shell_CmdHelp(uint8_t argc, char *argv[]);
+static void Shell_CmdProf(uint8_t argc, char *argv[]);
+static void Shell_CmdBus(uint8_t argc, char *argv[]);
+static void Shell_CmdTasks(uint8_t argc, char *argv[]);
+static void Shell_CmdTimer(uint8_t argc, char *argv[]);
+static void Shell_CmdClock(uint8_t argc, char *argv[]);
+static void Shell_CmdGov(uint8_t argc, char *argv[]);
+static void Shell_CmdStop(uint8_t argc, char *argv[]);
+static void Shell_CmdTherm(uint8_t argc, char *argv[]);
+static void Shell_CmdEsp(uint8_t argc, char *argv[]);
+static void Shell_CmdUsb(uint8_t argc, char *argv[]);
+static void Shell_CmdPad(uint8_t argc, char *argv[]);
+static void Shell_CmdMirror(uint8_t argc, char *argv[]);
+static void Shell_CmdBench(uint8_t argc, char *argv[]);
+static void Shell_CmdSd(uint8_t argc, char *argv[]);
+static void Shell_CmdFlash(uint8_t argc, char *argv[]);
+static void Shell_CmdStat(uint8_t argc, char *argv[]);
+static void Shell_CmdTele(uint8_t argc, char *argv[]);
+static void Shell_CmdCan(uint8_t argc, char *argv[]);
+static void Shell_CmdXfer(uint8_t argc, char *argv[]);
+static void Shell_CmdMatrix(uint8_t argc, char *argv[]);
+static void Shell_CmdTe(uint8_t argc, char *argv[]);
+static void Shell_CmdMem(uint8_t argc, char *argv[]);
+static void Shell_CmdBoot(uint8_t argc, char *argv[]);
+static void Shell_CmdDma(uint8_t argc, char *argv[]);
+static void Shell_CmdIrq(uint8_t argc, char *argv[]);
+static void Shell_CmdTrace(uint8_t argc, char *argv[]);
+static void Shell_CmdStack(uint8_t argc, char *argv[]);
+static void Shell_CmdPhoton(uint8_t argc, char *argv[]);
+static void Shell_CmdAsync(uint8_t argc, char *argv[]);
+static void Shell_CmdPhoton(uint8_t argc, char *argv[]) {
+#if INPUT_LATENCY_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		InputLatency_Reset();
+		printf("Messung Eingabe bis Bild zurückgesetzt\n");
+		return;
+	}
+	InputLatency_Dump();
+#else
+	printf("Messung Eingabe bis Bild ist abgeschaltet (INPUT_LATENCY_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdAsync(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Async_ResetStats();
+		printf("Coroutinen-Statistik zurückgesetzt\n");
+		return;
+	}
+	Async_Dump();
+}
+
+static void Shell_CmdTopics(uint8_t argc, char *argv[]);
+static void Shell_CmdLog(uint8_t argc, char *argv[]);
+static void Shell_CmdShot(uint8_t argc, char *argv[]);
+static void Shell_CmdDisp(uint8_t argc, char *argv[]);
+static void Shell_CmdUpdate(uint8_t argc, char *argv[]);
+static void Shell_CmdFrame(uint8_t argc, char *argv[]);
+static void Shell_CmdAnim(uint8_t argc, char *argv[]);
+static void Shell_CmdThumb(uint8_t argc, char *argv[]);
+static void Shell_CmdCache(uint8_t argc, char *argv[]);
+static void Shell_CmdPipe(uint8_t argc, char *argv[]);
+static void Shell_CmdQos(uint8_t argc, char *argv[]);
+static void Shell_XferSink(uint32_t offset, const uint8_t *data, uint32_t length, uint32_t total, void *context);
+static void Shell_UpdateSink(uint32_t offset, const uint8_t *data, uint32_t length, uint32_t total, void *context);
+static uint32_t Shell_Fnv(uint32_t hash, const uint8_t *data, uint32_t length);
+
+static const Shell_Command Shell_Commands[] = {
+	{ "help",  Shell_CmdHelp,  "Befehle auflisten" },
+	{ "prof",  Shell_CmdProf,  "Messpunkte ausgeben, 'prof reset' setzt sie zurück" },
+	{ "bus",   Shell_CmdBus,   "Busverkehr je Treiber, 'bus reset' setzt ihn zurück" },
+	{ "tasks", Shell_CmdTasks, "Statistik der Scheduler-Tasks" },
+	{ "timer", Shell_CmdTimer, "Software-Timer: aktive und abgelaufene Timer, Belegung des Timer-Rads" },
+	{ "async", Shell_CmdAsync, "Coroutinen: Wartepunkt, Unterbrechungen je Art und CPU-Zeit, 'async reset' setzt sie zurück" },
+	{ "clock", Shell_CmdClock, "Taktprofil anzeigen bzw. wechseln: low, balanced, max" },
+	{ "gov",   Shell_CmdGov,   "Taktprofil nach Last: Zeit je Profil, Wechsel und Dauer der Umschaltung, 'gov on|off|reset'" },
+	{ "stop",  Shell_CmdStop,  "Stop-Modus im Leerlauf: Zeit im Stop, Weckquellen, Dauer bis PLL1 und bis zum ersten Task, 'stop on|off|reset'" },
+	{ "therm", Shell_CmdTherm, "Chip- und Umgebungstemperatur, Obergrenze des Taktprofils und Drosselungen, 'therm reset'" },
+	{ "esp",   Shell_CmdEsp,   "Link zum ESP-Einsatz auf UART7: Durchsatz, Umlaufzeit, Kredit und Latenz je Kanal, 'esp off', 'esp reset'" },
+	{ "usb",   Shell_CmdUsb,   "Virtuelle COM-Ports über USB: Zustand, Durchsatz und Zeilen je Port, 'usb reset'" },
+	{ "pad",   Shell_CmdPad,   "PS4-Controller über den Airlink auf UART4: Berichte, Abstand, Alter, Fehler und Tasten, 'pad reset'" },
+	{ "mirror", Shell_CmdMirror, "Bildspiegel des Framebuffers an den PC: 'mirror on uart|esp', 'mirror off', 'mirror key' (Schlüsselbild), 'mirror reset'" },
+	{ "bench", Shell_CmdBench, "Vollbilder auf das Display, Bildrate und Durchsatz" },
+	{ "sd",    Shell_CmdSd,    "Test der SD-Karte (Datei schreiben, lesen, löschen), 'sd stat' Cache, 'sd format [fat|exfat] ja' formatiert passend zur AU" },
+	{ "flash", Shell_CmdFlash, "ID, SFDP-Geometrie und Lesegeschwindigkeit des W25Qxx, 'flash tune' misst das Timing neu, 'flash pool' zeigt das Hintergrund-Löschen, 'flash dtr on|off' schaltet DTR-Lesen" },
+	{ "stat",  Shell_CmdStat,  "Laufzeit und verworfene Ausgaben/Ereignisse" },
+	{ "tele",  Shell_CmdTele,  "Messdatenstrom: 'tele on [adc] [aht] [timing]', 'tele off', 'tele dec n'" },
+	{ "can",   Shell_CmdCan,   "Empfangene Rahmen und Zähler, 'can send|fd id b0 b1 ...' (hex) sendet" },
+	{ "xfer",  Shell_CmdXfer,  "Massendaten über CAN-FD: 'xfer send n' sendet n Bytes Flash, 'xfer node 0|1'" },
+	{ "matrix", Shell_CmdMatrix, "Laufschrift auf der LED-Matrix: 'matrix text ...', 'matrix off'" },
+	{ "te",    Shell_CmdTe,    "TE-Signal des Displays: Bildrate und Wartezeiten, 'te on|off'" },
+	{ "mem",   Shell_CmdMem,   "Blockpool der Treiber, Frame-Arena und Code-Overlays: belegt, Höchststand, Fehlschläge" },
+	{ "boot",  Shell_CmdBoot,  "Zeitstempel des Starts: erstes Bild, bedienbar, verschobene Initialisierungen; Reset-Ursache und Warmstart" },
+	{ "irq",   Shell_CmdIrq,   "Priorität, Laufzeit und Latenz der Interrupts, 'irq reset' setzt sie zurück" },
+	{ "trace", Shell_CmdTrace, "Ereignis-Trace über SWO (PB3): 'trace on', 'trace pc' (mit PC-Abtastung), 'trace off', ohne Argument Zustand" },
+	{ "stack", Shell_CmdStack, "Hochwassermarke des Stacks seit dem Start, auch tiefster Eintritt in einen Interrupt" },
+	{ "photon", Shell_CmdPhoton, "Joystick-Druck bis Statuszeile am TFT: Verteilung und Abschnitte, 'photon reset' setzt sie zurück" },
+	{ "dma",   Shell_CmdDma,   "Belegte DMA-Streams und MDMA-Kanäle mit Auslastung, 'dma reset' setzt sie zurück" },
+	{ "topics", Shell_CmdTopics, "Veröffentlichte Messwerte je Topic, Abonnenten und wiederholte Lesevorgänge" },
+	{ "log",   Shell_CmdLog,   "Messwerte auf die SD-Karte: 'log start [datei] [MB] [can] [raw|lz4]', 'log stop', ohne Argument Statistik" },
+	{ "shot",  Shell_CmdShot,  "Bildschirmfoto als BMP auf die SD-Karte: 'shot [datei]', 'shot last' Ergebnis der letzten" },
+	{ "disp",  Shell_CmdDisp,  "Display-Energie: 'disp sleep|wake', 'disp status|normal', 'disp timeout s' (0 = nie)" },
+	{ "update", Shell_CmdUpdate, "Firmware-Update: 'update sd datei', 'update can', 'update apply [slot]', 'update abort', ohne Argument Slots" },
+	{ "frame", Shell_CmdFrame, "Bildtakt über TFT, OLED und Matrix: Dauer je Display und gesamt, Zeichenzeit je Widget; 'frame reset' setzt sie zurück, 'frame budget <us>' setzt das Budget" },
+	{ "anim",  Shell_CmdAnim,  "Animation abspielen: 'anim datei|asset:name [x y] [once]', 'anim stop', 'anim stat' Bilder, verworfene und Durchsatz" },
+	{ "thumb", Shell_CmdThumb, "Vorschaubild zeichnen: 'thumb datei [b h [x y]]' (b h bei rohem RGB565, sonst 0 0), 'thumb stat' Treffer und Zeiten, 'thumb clear' leert den RAM-Cache" },
+	{ "cache", Shell_CmdCache, "Asset-Cache im RAM: Belegung und Treffer, 'cache load name|datei [bytes]' lädt im Leerlauf, 'cache clear', 'cache reset'" },
+	{ "pipe",  Shell_CmdPipe,  "Datenstrom-Stufen: angenommene, weitergegebene und verworfene Puffer, Takte je Stufe, 'pipe reset'" },
+	{ "qos",   Shell_CmdQos,   "Vorrang am AXI-Interconnect je Initiator: 'qos ini lesen schreiben' (0..15), 'qos default|flat'" },
+};
+
+#define SHELL_COMMAND_COUNT       (sizeof(Shell_Commands) / sizeof(Shell_Commands[0]))
+
+// Short names for "clock", in the order of Clock_Profile
+static const char *const Shell_ClockNames[CLOCK_PROFILE_COUNT] = { "low", "balanced", "max" };
+
+/**
+ * @brief  Startet den Empfang, der Task wird erst bei einer fertigen Zeile eingeschaltet
+ * @param  huart: bereits initialisiertes Handle mit zirkulärem RX-DMA-Kanal (LPUART1)
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der Shell_Task() aufruft
+ */
+void Shell_Init(UART_HandleTypeDef *huart, uint8_t taskId) {
+	static const char banner[] = "\r\nShell bereit, 'help' listet die Befehle\r\n> ";
+
+	Shell_Uart = huart;
+	Shell_TaskId = taskId;
+	Scheduler_SetEnabled(taskId, 0);
+	// Data received via CanTp is only checked, 'xfer' shows the hash
+	CanTp_SetSink(Shell_XferSink, NULL);
+
+	Shell_Start();
+	Serial_Write(&Serial_Shell, banner, sizeof(banner) - 1);
+}
+
+/**
+ * @brief  Scheduler-Task: führt alle fertigen Zeilen aus und schaltet sich danach wieder aus
+ */
+void Shell_Task(void *context) {
+	char *argv[SHELL_MAX_ARGS];
+	char *line;
+
+	while (Shell_NextLine(&line)) {
+		uint8_t argc = Shell_Split(line, argv);
+		if (argc == 0)
+			continue;
+
+		// Output of the command goes back to the shell port
+		fflush(stdout);
+		Serial_Stdout = &Serial_Shell;
+		Shell_Execute(argc, argv);
+		printf("> ");
+		fflush(stdout);
+		Serial_Stdout = &Serial_Log;
+	}
+
+	if (Shell_RemotePending) {
+		uint8_t argc = Shell_Split(Shell_Remote, argv);
+		if (argc > 0) {
+			fflush(stdout);
+			Serial_Stdout = Shell_RemoteOut;
+			Shell_Execute(argc, argv);
+			fflush(stdout);
+			Serial_Stdout = &Serial_Log;
+		}
+		Shell_RemotePending = 0;
+	}
+
+	// A line end arriving meanwhile keeps the task enabled
+	__disable_irq();
+	if (Shell_LineEndsDone == Shell_LineEnds && !Shell_RemotePending)
+		Scheduler_SetEnabled(Shell_TaskId, 0);
+	__enable_irq();
+}
+
+/**
+ * @brief  Hält den Empfang an, bevor die UART neu initialisiert wird (Taktumschaltung)
+ */
+void Shell_Suspend(void) {
+	if (!Shell_Running)
+		return;
+
+	HAL_UART_AbortReceive(Shell_Uart);
+	Shell_Running = 0;
+}
+
+/**
+ * @brief  Startet den Empfang nach Shell_Suspend() neu, bis dahin unvollständige Eingaben gehen verloren
+ */
+void Shell_Resume(void) {
+	if (Shell_Uart == NULL || Shell_Running)
+		return;
+
+	Shell_Start();
+}
+
+/**
+ * @brief  Reicht eine Befehlszeile ein, die der Shell-Task wie eine empfangene ausführt
+ * @param  line: muss nicht mit '\0' enden (wird kopiert), ein Zeilenende am Schluss fällt weg
+ * @param  out: Ziel der Ausgaben des Befehls
+ * @retval 1 übernommen, 0 wenn die vorige Zeile noch nicht ausgeführt ist oder line zu lang
+ */
+uint8_t Shell_Submit(const char *line, uint32_t length, Serial_Port *out) {
+	while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == '\n'))
+		length--;
+	if (Shell_RemotePending || length >= sizeof(Shell_Remote) || Shell_TaskId == SCHEDULER_INVALID_TASK)
+		return 0;
+
+	memcpy(Shell_Remote, line, length);
+	Shell_Remote[length] = '\0';
+	Shell_RemoteOut = out;
+	Shell_RemotePending = 1;
+	Scheduler_SetEnabled(Shell_TaskId, 1);
+	return 1;
+}
+
+/**
+ * @brief  1, solange die mit Shell_Submit() eingereichte Zeile noch nicht ausgeführt ist
+ */
+uint8_t Shell_IsSubmitPending(void) {
+	return Shell_RemotePending;
+}
+
+/**
+ * @brief  Aus HAL_UARTEx_RxEventCallback(): neue Zeichen im Ring, Zeilenenden zählen
+ * @param  size: DMA-Position im Puffer (bei vollem Puffer SHELL_RX_BUFFER_SIZE)
+ */
+void Shell_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size) {
+	if (huart != Shell_Uart)
+		return;
+
+	uint16_t pos = size & SHELL_RX_MASK;
+	uint32_t lineEnds = Shell_LineEnds;
+	uint32_t received = Shell_Received;
+
+	while (Shell_RxPos != pos) {
+		uint8_t c = Shell_RxBuffer[Shell_RxPos];
+		if (c == '\r' || c == '\n')
+			lineEnds++;
+		Shell_RxPos = (Shell_RxPos + 1) & SHELL_RX_MASK;
+		received++;
+	}
+
+	Shell_Received = received;
+	if (lineEnds != Shell_LineEnds) {
+		Shell_LineEnds = lineEnds;
+		Scheduler_SetEnabled(Shell_TaskId, 1);
+	}
+}
+
+/**
+ * @brief  Aus HAL_UART_ErrorCallback(): die HAL bricht den Empfang bei Überlauf ab, neu starten
+ */
+void Shell_ErrorCallback(UART_HandleTypeDef *huart) {
+	if (huart != Shell_Uart || !Shell_Running || huart->RxState != HAL_UART_STATE_READY)
+		return;
+
+	Shell_Start();
+}
+
+/**
+ * @brief  Setzt den Ring zurück und startet die zirkuläre DMA-Übertragung
+ */
+static void Shell_Start(void) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	// The DMA restarts at index 0: align the counters to a multiple of the ring and drop the rest
+	Shell_Received = (Shell_Received + SHELL_RX_MASK) & ~SHELL_RX_MASK;
+	Shell_Parsed = Shell_Received;
+	Shell_LineEndsDone = Shell_LineEnds;
+	Shell_RxPos = 0;
+	__set_PRIMASK(primask);
+
+	if (HAL_UARTEx_ReceiveToIdle_DMA(Shell_Uart, Shell_RxBuffer, SHELL_RX_BUFFER_SIZE) == HAL_OK)
+		Shell_Running = 1;
+}
+
+/**
+ * @brief  Liefert die nächste fertige Zeile, mit '\0' abgeschlossen
+ * @retval 1 wenn eine Zeile vorliegt, 0 wenn keine (mehr) fertig ist
+ */
+static uint8_t Shell_NextLine(char **line) {
+	uint32_t received = Shell_Received;
+	uint32_t start = Shell_Parsed;
+	uint32_t end = start;
+
+	if (received - start > SHELL_RX_BUFFER_SIZE) {
+		// The DMA has overwritten input that was not parsed yet
+		printf("Shell: Eingabe zu lang, verworfen\n");
+		Shell_Parsed = received;
+		Shell_LineEndsDone = Shell_LineEnds;
+		return 0;
+	}
+
+	while (end != received) {
+		uint8_t c = Shell_RxBuffer[end & SHELL_RX_MASK];
+		if (c == '\r' || c == '\n')
+			break;
+		end++;
+	}
+	if (end == received)
+		return 0;
+
+	uint32_t length = end - start;
+	uint32_t offset = start & SHELL_RX_MASK;
+	Shell_Parsed = end + 1;
+	Shell_LineEndsDone++;
+
+	if (offset + length < SHELL_RX_BUFFER_SIZE) {
+		// Zero copy: the line end itself becomes the terminator
+		*line = (char*)&Shell_RxBuffer[offset];
+		Shell_RxBuffer[offset + length] = '\0';
+	}
+	else {
+		uint32_t first = SHELL_RX_BUFFER_SIZE - offset;
+		memcpy(Shell_Line, &Shell_RxBuffer[offset], first);
+		memcpy(Shell_Line + first, Shell_RxBuffer, length - first);
+		Shell_Line[length] = '\0';
+		*line = Shell_Line;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Zerlegt eine Zeile an Leerzeichen und Tabs, an Ort und Stelle
+ * @retval Anzahl Wörter (höchstens SHELL_MAX_ARGS)
+ */
+static uint8_t Shell_Split(char *line, char *argv[]) {
+	uint8_t argc = 0;
+
+	while (*line != '\0' && argc < SHELL_MAX_ARGS) {
+		while (*line == ' ' || *line == '\t')
+			*line++ = '\0';
+		if (*line == '\0')
+			break;
+
+		argv[argc++] = line;
+		while (*line != '\0' && *line != ' ' && *line != '\t')
+			line++;
+	}
+	return argc;
+}
+
+/**
+ * @brief  Sucht den Befehl argv[0] und führt ihn aus
+ */
+static void Shell_Execute(uint8_t argc, char *argv[]) {
+	for (uint32_t i = 0; i < SHELL_COMMAND_COUNT; i++) {
+		if (strcmp(argv[0], Shell_Commands[i].name) == 0) {
+			Shell_Commands[i].handler(argc, argv);
+			return;
+		}
+	}
+	printf("Unbekannter Befehl '%s', siehe 'help'\n", argv[0]);
+}
+
+/* ------------------------------------ Befehle ------------------------------------ */
+
+static void Shell_CmdHelp(uint8_t argc, char *argv[]) {
+	for (uint32_t i = 0; i < SHELL_COMMAND_COUNT; i++)
+		printf("%-6s %s\n", Shell_Commands[i].name, Shell_Commands[i].help);
+}
+
+static void Shell_CmdProf(uint8_t argc, char *argv[]) {
+#if PROF_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Prof_Reset();
+		Scheduler_ResetStats();
+		printf("Profil zurückgesetzt\n");
+		return;
+	}
+	Prof_Dump();
+#else
+	printf("Profiling ist abgeschaltet (PROF_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdBus(uint8_t argc, char *argv[]) {
+#if BUSSTAT_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		BusStat_Reset();
+		printf("Buszähler zurückgesetzt\n");
+		return;
+	}
+	BusStat_Dump();
+#else
+	printf("Buszähler sind abgeschaltet (BUSSTAT_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdTasks(uint8_t argc, char *argv[]) {
+	Scheduler_Dump();
+}
+
+static void Shell_CmdTimer(uint8_t argc, char *argv[]) {
+	Timer_Dump();
+}
+
+static void Shell_CmdClock(uint8_t argc, char *argv[]) {
+	if (argc > 1) {
+		uint8_t profile = 0;
+		while (profile < CLOCK_PROFILE_COUNT && strcmp(argv[1], Shell_ClockNames[profile]) != 0)
+			profile++;
+		if (profile == CLOCK_PROFILE_COUNT) {
+			printf("Unbekanntes Profil '%s' (low, balanced, max)\n", argv[1]);
+			return;
+		}
+
+		// Above the thermal limit the governor would switch down again right away
+		if (profile > Governor_GetCeiling()) {
+			printf("Temperatur begrenzt das Taktprofil auf %s ('therm')\n", Clock_Profiles[Governor_GetCeiling()].name);
+			return;
+		}
+
+		// A profile set by hand stays, the governor would change it again
+		if (Governor_IsEnabled()) {
+			Governor_SetEnabled(0);
+			printf("Governor abgeschaltet ('gov on' schaltet ihn wieder ein)\n");
+		}
+
+		// No display DMA may run while SPI1 loses its clock
+		ILI9341_WaitWhileBusy();
+		if (!Clock_SetProfile((Clock_Profile)profile))
+			printf("Umschaltung fehlgeschlagen, Kern läuft vom HSI\n");
+	}
+
+	printf("Taktprofil: %s, SYSCLK %lu MHz\n", Clock_GetProfileInfo()->name, SystemCoreClock / 1000000UL);
+}
+
+static void Shell_CmdGov(uint8_t argc, char *argv[]) {
+#if GOVERNOR_ENABLE
+	if (argc > 1 && strcmp(argv[1], "on") == 0) {
+		Governor_SetEnabled(1);
+	} else if (argc > 1 && strcmp(argv[1], "off") == 0) {
+		Governor_SetEnabled(0);
+	} else if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Governor_ResetStats();
+		printf("Governor-Statistik zurückgesetzt\n");
+		return;
+	}
+	Governor_Dump();
+#else
+	printf("Governor ist abgeschaltet (GOVERNOR_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdStop(uint8_t argc, char *argv[]) {
+#if LOWPOWER_ENABLE
+	if (argc > 1 && strcmp(argv[1], "on") == 0) {
+		LowPower_SetEnabled(1);
+	} else if (argc > 1 && strcmp(argv[1], "off") == 0) {
+		LowPower_SetEnabled(0);
+	} else if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		LowPower_ResetStats();
+		printf("Stop-Statistik zurückgesetzt\n");
+		return;
+	}
+	LowPower_Dump();
+#else
+	printf("Stop-Modus ist abgeschaltet (LOWPOWER_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdTherm(uint8_t argc, char *argv[]) {
+#if THERMAL_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Thermal_ResetStats();
+		printf("Temperatur-Statistik zurückgesetzt\n");
+		return;
+	}
+	Thermal_Dump();
+#else
+	printf("Temperaturüberwachung ist abgeschaltet (THERMAL_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdEsp(uint8_t argc, char *argv[]) {
+#if ESPLINK_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		EspLink_ResetStats();
+		printf("ESP-Link-Statistik zurückgesetzt\n");
+		return;
+	}
+	if (argc > 1 && strcmp(argv[1], "off") == 0) {
+		EspLink_Disconnect();
+		printf("ESP-Link getrennt, UART7 ist wieder Logausgabe bis zum nächsten HELLO\n");
+		return;
+	}
+	EspLink_Dump();
+#else
+	printf("ESP-Link ist abgeschaltet (ESPLINK_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdUsb(uint8_t argc, char *argv[]) {
+#if USBCDC_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		UsbCdc_ResetStats();
+		printf("USB-Statistik zurückgesetzt\n");
+		return;
+	}
+	UsbCdc_Dump();
+#else
+	printf("USB ist abgeschaltet (USBCDC_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdPad(uint8_t argc, char *argv[]) {
+#if GAMEPAD_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Gamepad_ResetStats();
+		printf("Gamepad-Statistik zurückgesetzt\n");
+		return;
+	}
+	Gamepad_Dump();
+#else
+	printf("Gamepad ist abgeschaltet (GAMEPAD_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdMirror(uint8_t argc, char *argv[]) {
+#if MIRROR_ENABLE
+	if (argc > 2 && strcmp(argv[1], "on") == 0) {
+		Mirror_Transport transport = strcmp(argv[2], "esp") == 0 ? MIRROR_ESP : MIRROR_UART;
+
+		if (!Mirror_Start(transport)) {
+			printf("Bildspiegel nicht gestartet: %s\n",
+					transport == MIRROR_ESP && !EspLink_IsUp() ? "ESP-Link ist nicht verbunden" : "Framebuffer-Modus ist aus");
+			return;
+		}
+		printf("Bildspiegel %s, Tools/mirror_view.py zeigt das Bild\n",
+				transport == MIRROR_ESP ? "über den ESP-Link" : "über LPUART1");
+		return;
+	}
+	if (argc > 1 && strcmp(argv[1], "off") == 0) {
+		Mirror_Stop();
+		printf("Bildspiegel aus\n");
+		return;
+	}
+	if (argc > 1 && strcmp(argv[1], "key") == 0) {
+		Mirror_Keyframe();
+		printf("Nächstes Bild ist ein Schlüsselbild\n");
+		return;
+	}
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Mirror_ResetStats();
+		printf("Statistik des Bildspiegels zurückgesetzt\n");
+		return;
+	}
+	Mirror_Dump();
+#else
+	printf("Bildspiegel ist abgeschaltet (MIRROR_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdBench(uint8_t argc, char *argv[]) {
+	static const uint16_t colors[] = { RED, GREEN, BLUE, BLACK };
+	uint32_t bytes = (uint32_t)ILI9341_WIDTH * ILI9341_HEIGHT * 2U;
+
+	ILI9341_WaitWhileBusy();
+	uint32_t start = DWT->CYCCNT;
+	for (uint32_t i = 0; i < SHELL_BENCH_FRAMES; i++)
+		ILI9341_FillScreen(colors[i % 4]);
+	ILI9341_WaitWhileBusy();
+	uint32_t cycles = DWT->CYCCNT - start;
+
+	uint32_t us = cycles / (SystemCoreClock / 1000000UL);
+	if (us == 0) us = 1;
+	printf("%u Vollbilder in %lu us: %lu.%lu Bilder/s, %lu KB/s\n", SHELL_BENCH_FRAMES, us,
+			SHELL_BENCH_FRAMES * 10000000UL / us / 10, SHELL_BENCH_FRAMES * 10000000UL / us % 10,
+			(uint32_t)((uint64_t)bytes * SHELL_BENCH_FRAMES * 1000000ULL / 1024U / us));
+	ILI9341_FillScreen(WHITE);
+}
+
+static void Shell_CmdSd(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "format") == 0) {
+		// Destroys everything on the card, so it has to be asked for explicitly
+		if (strcmp(argv[argc - 1], "ja") != 0) {
+			printf("Löscht die ganze Karte: 'sd format [fat|exfat] ja'\n");
+			return;
+		}
+		BYTE opt = 0;
+		if (argc > 3 && strcmp(argv[2], "fat") == 0) opt = FM_FAT | FM_FAT32;
+		else if (argc > 3 && strcmp(argv[2], "exfat") == 0) opt = FM_EXFAT;
+
+		SDCard_FormatInfo info;
+		FRESULT res = SDCard_Format(opt, &info);
+		if (res == FR_LOCKED)
+			printf("Volume wird benutzt (Logger, Update, offene Datei)\n");
+		else if (res != FR_OK)
+			printf("Formatieren fehlgeschlagen (FatFs-Fehler %d)\n", res);
+		else
+			printf("%s, Cluster %lu KB, AU %lu KB, Daten ab Sektor %lu, %lu ms\n",
+					info.fsType == FS_EXFAT ? "exFAT" : info.fsType == FS_FAT32 ? "FAT32" : "FAT16",
+					info.clusterBytes / 1024UL, info.auBytes / 1024UL, info.dataSector, info.elapsedMs);
+		return;
+	}
+
+	if (argc > 1 && strcmp(argv[1], "stat") == 0) {
+		printf("Cache: %lu Treffer, %lu Fehltreffer, %lu vorausgelesen, %lu Sektoren in %lu Kommandos zurückgeschrieben, "
+				"%lu Multi-Block-Writes mit ACMD23\n", SDCache_Statistics.hits, SDCache_Statistics.misses,
+				SDCache_Statistics.prefetched, SDCache_Statistics.writebacks, SDCache_Statistics.writeRuns, SD_GetPreErases());
+		const FastSeek_Stats *seek = FastSeek_GetStats();
+		printf("Fast Seek: %lu Tabellen aus dem Cache, %lu aufgebaut, %lu zu zerstückelt, %lu ohne freien Platz, %lu kleine Dateien\n",
+				seek->hits, seek->builds, seek->fragmented, seek->busy, seek->small);
+		return;
+	}
+
+	SDIO_SDCard_Test();
+	printf("SD-Test beendet (Meldungen über LOG auf UART7)\n");
+}
+
+static void Shell_CmdFlash(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "tune") == 0) {
+		const OCTOSPI1_Setting *setting = &OCTOSPI1_Tuning.setting;
+		HAL_StatusTypeDef status = MX_OCTOSPI1_TuneBus(1);
+
+		printf("OCTOSPI %s: %lu kHz (Vorteiler %u), Sample Shift %s, ", status == HAL_OK ? "kalibriert" : "Standard",
+				OCTOSPI1_Tuning.clockHz / 1000UL, setting->prescaler, setting->sampleShift ? "1/2 Takt" : "aus");
+		if (setting->delayPhase == OCTOSPI1_TUNE_BYPASS)
+			printf("Delay Block aus");
+		else
+			printf("Delay Block Phase %u (Einheit %u)", setting->delayPhase, setting->delayUnit);
+		printf(", %u von %u Einstellungen bestanden\n", OCTOSPI1_Tuning.passed, OCTOSPI1_Tuning.tested);
+		return;
+	}
+	if (argc > 1 && strcmp(argv[1], "pool") == 0) {
+		FlashPool_Dump();
+		return;
+	}
+	if (argc > 2 && strcmp(argv[1], "dtr") == 0) {
+		if (strcmp(argv[2], "on") == 0) {
+			if (W25Qxx_EnableDtr(OCTOSPI1_TUNE_ADDRESS))
+				printf("DTR-Lesen (0x%02X) aktiv\n", W25Qxx_Device.dtrInstruction);
+			else
+				printf("DTR %s, Lesen bleibt SDR\n", W25Qxx_Device.dtrInstruction ? "weicht von SDR ab" : "nicht unterstützt");
+		} else {
+			W25Qxx_DisableDtr();
+			printf("DTR-Lesen aus\n");
+		}
+		return;
+	}
+
+	if (!W25Qxx_IsMemoryMapped()) {
+		uint8_t manufacturer = 0, device = 0;
+		W25Qxx_Read_Manu_ID(&manufacturer, &device);
+		printf("W25Qxx: Hersteller 0x%02X, Gerät 0x%02X\n", manufacturer, device);
+	}
+	else {
+		printf("W25Qxx im Memory-Mapped-Modus, ID nicht lesbar\n");
+	}
+	printf("%lu MB, %s-Byte-Adressen, Lesebefehl 0x%02X (1-%u-4, %u Wartetakte), Seite %lu Bytes%s\n",
+			W25Qxx_Device.size >> 20, W25Qxx_Device.addressSize == HAL_OSPI_ADDRESS_32_BITS ? "4" : "3",
+			W25Qxx_Device.readInstruction, W25Qxx_Device.readAddressLines, W25Qxx_Device.readDummyCycles,
+			W25Qxx_Device.pageSize, W25Qxx_Device.fromSfdp ? "" : " (ohne SFDP)");
+	if (W25Qxx_Device.readDtr)
+		printf("DTR aktiv: 0x%02X (1-4D-4D, %u Wartetakte)\n", W25Qxx_Device.dtrInstruction, W25QXX_DTR_DUMMY_CYCLES);
+	else
+		printf("DTR %s\n", W25Qxx_Device.dtrInstruction ? "möglich, aus" : "nicht unterstützt");
+
+	uint32_t start = DWT->CYCCNT;
+	for (uint32_t address = 0; address < SHELL_FLASH_TEST_SIZE; address += SHELL_FLASH_CHUNK)
+		W25Qxx_FastReadQuadOutput(address, Shell_FlashBuffer, SHELL_FLASH_CHUNK);
+	uint32_t us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000UL);
+	if (us == 0) us = 1;
+
+	printf("%lu KB gelesen in %lu us: %lu KB/s\n", SHELL_FLASH_TEST_SIZE / 1024UL, us,
+			(uint32_t)((uint64_t)SHELL_FLASH_TEST_SIZE * 1000000ULL / 1024U / us));
+#ifdef W25QXX_READ_CACHE
+	printf("Lesecache: %lu Treffer, %lu Fehltreffer, %lu vorbei, %lu verworfen\n",
+			W25Qxx_CacheStatistics.hits, W25Qxx_CacheStatistics.misses,
+			W25Qxx_CacheStatistics.bypassed, W25Qxx_CacheStatistics.invalidations);
+#endif
+	printf("Programmieren: %lu Aufträge, %lu Seiten per DMA, %lu leere übersprungen, %lu Fehler\n",
+			W25Qxx_ProgramStatistics.writes, W25Qxx_ProgramStatistics.pages,
+			W25Qxx_ProgramStatistics.skipped, W25Qxx_ProgramStatistics.errors);
+}
+
+static void Shell_CmdStat(uint8_t argc, char *argv[]) {
+	printf("Laufzeit %lu ms, CPU-Last %lu.%lu %%\n", Scheduler_GetTicks(),
+			Scheduler_GetLoad() / 10, Scheduler_GetLoad() % 10);
+	printf("Verworfen: UART7 %lu Bytes, LPUART1 %lu Bytes, Eingabeereignisse %lu\n",
+			Serial_GetDropped(&Serial_Log), Serial_GetDropped(&Serial_Shell), UserInput_GetDropped());
+}
+
+static void Shell_CmdTele(uint8_t argc, char *argv[]) {
+	static const char *const names[] = { "adc", "aht", "timing" };
+	static uint8_t decimation = 1;
+	Telemetry_Config config = *Telemetry_GetConfig();
+
+	if (argc > 1 && strcmp(argv[1], "off") == 0) {
+		Telemetry_Stop();
+	}
+	else if (argc > 2 && strcmp(argv[1], "dec") == 0) {
+		decimation = (uint8_t)strtoul(argv[2], NULL, 10);
+		if (decimation == 0)
+			decimation = 1;
+		config.adcDecimation = decimation;
+		if (Telemetry_IsRunning())
+			Telemetry_Start(&config);
+	}
+	else if (argc > 1 && strcmp(argv[1], "on") == 0) {
+		// Without a channel list: everything
+		config.channels = argc > 2 ? 0 : TELEMETRY_CH_ADC | TELEMETRY_CH_AHT20 | TELEMETRY_CH_TIMING;
+		for (uint8_t i = 2; i < argc; i++) {
+			uint8_t channel = 0;
+			while (channel < 3 && strcmp(argv[i], names[channel]) != 0)
+				channel++;
+			if (channel == 3) {
+				printf("Unbekannter Kanal '%s' (adc, aht, timing)\n", argv[i]);
+				return;
+			}
+			config.channels |= 1U << channel;
+		}
+		config.adcMask = (1U << ADC_POTI_COUNT) - 1;
+		config.adcDecimation = decimation;
+		config.aht20PeriodMs = SHELL_TELE_PERIOD_MS;
+		config.timingPeriodMs = SHELL_TELE_PERIOD_MS;
+
+		// ADC packets need the acquisition mode; start it with one slot per pot if nothing runs yet
+		if ((config.channels & TELEMETRY_CH_ADC) && !ADC_IsAcquiring()) {
+			static const ADC_AcqConfig acq = { .scanHz = ADC_SCAN_HZ, .weight = { 1, 1, 1, 1 }, .oversampling = 16 };
+			if (!ADC_StartAcquisition(&acq))
+				printf("Messbetrieb des ADC ließ sich nicht starten\n");
+		}
+		Telemetry_Start(&config);
+	}
+	else if (argc > 1) {
+		printf("Aufruf: tele [on [adc] [aht] [timing] | off | dec n]\n");
+		return;
+	}
+
+	const Telemetry_Stats *stats = Telemetry_GetStats();
+	printf("Telemetrie %s, Kanäle 0x%02X, Dezimierung %u\n", Telemetry_IsRunning() ? "an" : "aus",
+			Telemetry_GetConfig()->channels, decimation);
+	printf("%lu Pakete, %lu Bytes, %lu verworfen, %lu ADC-Blöcke übersprungen\n",
+			stats->packets, stats->bytes, stats->dropped, stats->adcSkipped);
+	if (stats->linkPackets || stats->linkSkipped)
+		printf("ESP-Link: %lu Pakete, %lu ausgelassen\n", stats->linkPackets, stats->linkSkipped);
+}
+
+static void Shell_CmdCan(uint8_t argc, char *argv[]) {
+	Can_Message message;
+
+	if (argc > 2 && (strcmp(argv[1], "send") == 0 || strcmp(argv[1], "fd") == 0)) {
+		memset(&message, 0, sizeof(message));
+		message.id = strtoul(argv[2], NULL, 16);
+		if (message.id > 0x7FF)
+			message.flags |= CAN_FLAG_EXTENDED;
+		if (argv[1][0] == 'f')
+			message.flags |= CAN_FLAG_FD | CAN_FLAG_BRS;
+		for (uint8_t i = 3; i < argc; i++)
+			message.data[message.length++] = (uint8_t)strtoul(argv[i], NULL, 16);
+
+		printf("%s\n", Can_Send(&message) ? "Gesendet" : "Sendewarteschlange voll");
+		return;
+	}
+
+	while (Can_Receive(&message)) {
+		printf("%s%0*lX [%u]", message.flags & CAN_FLAG_FD ? "FD " : "", message.flags & CAN_FLAG_EXTENDED ? 8 : 3,
+				message.id, message.length);
+		for (uint8_t i = 0; i < message.length; i++)
+			printf(" %02X", message.data[i]);
+		printf("\n");
+	}
+
+	const Can_Stats *stats = Can_GetStats();
+	uint8_t tec, rec;
+	Can_GetErrorCounters(&tec, &rec);
+	printf("%lu / %lu kbit/s, empfangen %lu, gesendet %lu, Überläufe %lu/%lu, verworfen %lu\n",
+			Can_GetNominalBitrate() / 1000, Can_GetDataBitrate() / 1000, stats->received, stats->sent,
+			stats->rxOverruns, stats->rxLost, stats->txDropped);
+	printf("Fehlerzähler TX %u, RX %u, Bus-Off %lu\n", tec, rec, stats->busOff);
+}
+
+static void Shell_CmdXfer(uint8_t argc, char *argv[]) {
+	if (argc > 2 && strcmp(argv[1], "node") == 0) {
+		CanTp_SetNode((uint8_t)atoi(argv[2]));
+	}
+	else if (argc > 2 && strcmp(argv[1], "send") == 0) {
+		uint32_t length = strtoul(argv[2], NULL, 0);
+		const uint8_t *image = (const uint8_t *)FLASH_BANK1_BASE;
+
+		// Internal flash as test data: memory mapped, so the frames are filled straight from it
+		if (length == 0 || length > FLASH_BANK_SIZE)
+			length = FLASH_BANK_SIZE;
+		if (CanTp_Send(image, length))
+			printf("Sende %lu Bytes ab 0x%08lX, FNV-1a %08lX\n", length, (uint32_t)FLASH_BANK1_BASE,
+					Shell_Fnv(SHELL_FNV_BASIS, image, length));
+		else
+			printf("Übertragung läuft noch\n");
+		return;
+	}
+
+	const CanTp_Stats *stats = CanTp_GetStats();
+	printf("Knoten %u, sendet auf 0x%03X, %s\n", CanTp_GetNode(), CANTP_ID_BASE + CanTp_GetNode(),
+			CanTp_IsBusy() ? "aktiv" : "bereit");
+	printf("Gesendet %lu, zuletzt %lu Bytes in %lu ms = %lu KB/s\n", stats->txTransfers, stats->lastTxBytes,
+			stats->lastTxMs, CanTp_GetThroughput(stats->lastTxBytes, stats->lastTxMs) / 1024);
+	printf("Empfangen %lu, zuletzt %lu Bytes in %lu ms = %lu KB/s, FNV-1a %08lX\n", stats->rxTransfers,
+			stats->lastRxBytes, stats->lastRxMs, CanTp_GetThroughput(stats->lastRxBytes, stats->lastRxMs) / 1024,
+			Shell_XferHash);
+	printf("Fehler %lu, Zeitüberschreitungen %lu, WAIT %lu\n", stats->errors, stats->timeouts, stats->waits);
+}
+
+static void Shell_CmdMatrix(uint8_t argc, char *argv[]) {
+	char text[LED_MATRIX_SCROLL_TEXT_MAX + 1];
+	size_t length = 0;
+
+	if (argc < 2) {
+		printf("Laufschrift %s\n", LED_Matrix_is_scrolling() ? "aktiv" : "aus");
+		return;
+	}
+	if (argc == 2 && strcmp(argv[1], "off") == 0) {
+		LED_Matrix_scroll_stop();
+		return;
+	}
+
+	// The shell split the line at the spaces, join the words again
+	text[0] = '\0';
+	for (uint8_t i = 1; i < argc && length < LED_MATRIX_SCROLL_TEXT_MAX; i++) {
+		length += snprintf(&text[length], sizeof(text) - length, i > 1 ? " %s" : "%s", argv[i]);
+	}
+	LED_Matrix_scroll_text(text);
+}
+
+static void Shell_CmdTe(uint8_t argc, char *argv[]) {
+	ILI9341_TEStats stats;
+
+	if (argc > 1) {
+		ILI9341_TE_Enable(strcmp(argv[1], "on") == 0);
+		printf("TE %s\n", strcmp(argv[1], "on") == 0 ? "ein" : "aus");
+		return;
+	}
+
+	ILI9341_TE_GetStats(&stats);
+	printf("TE %s, %lu Flanken, Periode %lu us", ILI9341_TE_IsActive() ? "aktiv" : "ohne Signal",
+			stats.edges, stats.periodUs);
+	if (stats.periodUs > 0)
+		printf(" (%lu.%lu Hz)", 10000000UL / stats.periodUs / 10, 10000000UL / stats.periodUs % 10);
+	printf("\nUI-Takte %lu, verpasst %lu, gewartet %lu (max %lu us), Zeitüberschreitungen %lu\n",
+			stats.frames, stats.missed, stats.waits, stats.waitUsMax, stats.timeouts);
+}
+
+static void Shell_CmdMem(uint8_t argc, char *argv[]) {
+	Pool_Stats pool;
+
+	Pool_GetStats(&pool);
+	printf("Pool %u x %u Bytes: belegt %u, Höchststand %u, Anforderungen %lu, Fehlschläge %lu, größte %lu Bytes\n",
+			POOL_BLOCK_COUNT, POOL_BLOCK_SIZE, pool.inUse, pool.highWater, pool.allocs, pool.failures,
+			pool.largest);
+	printf("Arena %lu Bytes: belegt %lu, Höchststand %lu, Fehlschläge %lu\n", Arena_Frame.size, Arena_Frame.used,
+			Arena_Frame.peak, Arena_Frame.failures);
+	Overlay_Dump();
+}
+
+static void Shell_CmdBoot(uint8_t argc, char *argv[]) {
+	Boot_Report();
+	WarmBoot_Dump();
+}
+
+static void Shell_CmdFrame(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Canvas_FrameReset();
+		ILI9341_Widget_ResetStats();
+		printf("Bildtakt-Zähler zurückgesetzt\n");
+		return;
+	}
+	if (argc > 2 && strcmp(argv[1], "budget") == 0) {
+		Canvas_FrameSetBudget(strtoul(argv[2], NULL, 10));
+	}
+	Canvas_FrameDump();
+	ILI9341_Widget_Dump();
+}
+
+static void Shell_CmdAnim(uint8_t argc, char *argv[]) {
+	if (argc < 2 || strcmp(argv[1], "stat") == 0) {
+		Anim_Dump();
+		return;
+	}
+	if (strcmp(argv[1], "stop") == 0) {
+		Anim_Stop();
+		printf("Animation angehalten\n");
+		return;
+	}
+
+	uint8_t loop = strcmp(argv[argc - 1], "once") != 0;
+	uint8_t args = loop ? argc : argc - 1;
+	uint16_t x = args > 3 ? (uint16_t)strtoul(argv[2], NULL, 0) : 0;
+	uint16_t y = args > 3 ? (uint16_t)strtoul(argv[3], NULL, 0) : 0;
+	uint8_t ok;
+
+	if (strncmp(argv[1], "asset:", 6) == 0)
+		ok = Anim_PlayAsset(argv[1] + 6, x, y, loop);
+	else
+		ok = Anim_PlayFile(argv[1], x, y, loop);
+
+	if (ok)
+		printf("Animation läuft%s, Zähler mit 'anim stat'\n", loop ? " in Schleife" : "");
+	else
+		printf("Animation ließ sich nicht starten\n");
+}
+
+static void Shell_CmdThumb(uint8_t argc, char *argv[]) {
+	if (argc < 2 || strcmp(argv[1], "stat") == 0) {
+		Thumb_Dump();
+		return;
+	}
+	if (strcmp(argv[1], "clear") == 0) {
+		Thumb_Clear();
+		printf("Vorschaubilder im RAM verworfen\n");
+		return;
+	}
+
+	uint16_t width = argc > 3 ? (uint16_t)strtoul(argv[2], NULL, 0) : 0;
+	uint16_t height = argc > 3 ? (uint16_t)strtoul(argv[3], NULL, 0) : 0;
+	uint16_t x = argc > 5 ? (uint16_t)strtoul(argv[4], NULL, 0) : 0;
+	uint16_t y = argc > 5 ? (uint16_t)strtoul(argv[5], NULL, 0) : 0;
+
+	if (Thumb_Draw(argv[1], width, height, x, y))
+		printf("Vorschaubild in %lu us\n", (unsigned long)Thumb_GetStats()->lastUs);
+	else
+		printf("Kein Vorschaubild für %s\n", argv[1]);
+}
+
+static void Shell_CmdCache(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+		AssetCache_Clear();
+		printf("Asset-Cache geleert\n");
+		return;
+	}
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		AssetCache_ResetStats();
+		printf("Zähler des Asset-Caches zurückgesetzt\n");
+		return;
+	}
+	if (argc > 2 && strcmp(argv[1], "load") == 0) {
+		// A one-item screen; the request is copied into the queue right away
+		AssetCache_Item item = { argv[2], argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 0 };
+		AssetCache_Screen screen = { "shell", &item, 1 };
+		AssetCache_Prefetch(&screen);
+		printf("%s eingereiht\n", argv[2]);
+		return;
+	}
+	AssetCache_Dump();
+}
+
+static void Shell_CmdPipe(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Pipe_ResetStats();
+		printf("Zähler der Pipeline-Stufen zurückgesetzt\n");
+		return;
+	}
+	Pipe_Dump();
+}
+
+static void Shell_CmdQos(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "default") == 0) {
+		BusQos_Apply(BusQos_Default);
+	} else if (argc > 1 && strcmp(argv[1], "flat") == 0) {
+		BusQos_Apply(BusQos_Flat);
+	} else if (argc > 3) {
+		int8_t initiator = BusQos_Find(argv[1]);
+		if (initiator < 0) {
+			printf("Unbekannter Initiator '%s'\n", argv[1]);
+			return;
+		}
+		BusQos_Set((BusQos_Initiator)initiator, (uint8_t)atoi(argv[2]), (uint8_t)atoi(argv[3]));
+	} else if (argc > 1) {
+		printf("Aufruf: qos [ini lesen schreiben | default | flat]\n");
+		return;
+	}
+	BusQos_Dump();
+}
+
+static void Shell_CmdDma(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		DmaAlloc_ResetStats();
+		printf("DMA-Zähler zurückgesetzt\n");
+		return;
+	}
+	DmaAlloc_Dump();
+}
+
+static void Shell_CmdIrq(uint8_t argc, char *argv[]) {
+#if IRQ_STAT_ENABLE
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Irq_Reset();
+		printf("Interrupt-Statistik zurückgesetzt\n");
+		return;
+	}
+	Irq_Dump();
+#else
+	printf("Interrupt-Messung ist abgeschaltet (IRQ_STAT_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdTrace(uint8_t argc, char *argv[]) {
+#if TRACE_ENABLE
+	if (argc > 1 && strcmp(argv[1], "on") == 0) {
+		Trace_Start();
+	} else if (argc > 1 && strcmp(argv[1], "pc") == 0) {
+		Trace_Start();
+		Trace_SetPcSampling(1);
+	} else if (argc > 1 && strcmp(argv[1], "off") == 0) {
+		Trace_Stop();
+	}
+	Trace_Dump();
+#else
+	printf("Trace ist abgeschaltet (TRACE_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdStack(uint8_t argc, char *argv[]) {
+#if STACK_PAINT_ENABLE
+	Stack_Dump();
+#else
+	printf("Stack-Bemalung ist abgeschaltet (STACK_PAINT_ENABLE 0)\n");
+#endif
+}
+
+static void Shell_CmdTopics(uint8_t argc, char *argv[]) {
+	Topic_Dump();
+}
+
+static void Shell_CmdLog(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "start") == 0) {
+		// Trailing words: 'can' adds the bus capture, 'raw' and 'lz4' select the ADC encoding
+		uint8_t options = 0;
+		while (argc > 2) {
+			if (strcmp(argv[argc - 1], "can") == 0) {
+				options |= SENSORLOG_OPT_CAN;
+			} else if (strcmp(argv[argc - 1], "raw") == 0) {
+				options |= SENSORLOG_OPT_RAW;
+			} else if (strcmp(argv[argc - 1], "lz4") == 0) {
+				options |= SENSORLOG_OPT_LZ4;
+			} else {
+				break;
+			}
+			argc--;
+		}
+		const char *path = argc > 2 ? argv[2] : SENSORLOG_DEFAULT_PATH;
+		uint32_t capacity = argc > 3 ? strtoul(argv[3], NULL, 10) * 1024UL * 1024UL : SENSORLOG_DEFAULT_SIZE;
+		FRESULT res = SensorLog_Start(path, capacity, options);
+		if (res == FR_INVALID_PARAMETER) {
+			printf("CAN-Mitschnitt ließ sich nicht starten (FDCAN1 aus oder Sendeauftrag offen)\n");
+			return;
+		}
+		if (res != FR_OK) {
+			printf("Logdatei '%s' ließ sich nicht anlegen (FatFs-Fehler %d)\n", path, res);
+			return;
+		}
+		printf("Aufzeichnung nach '%s', %lu KB reserviert%s, ADC %s\n", path, capacity / 1024,
+				options & SENSORLOG_OPT_CAN ? ", mit CAN" : "",
+				options & SENSORLOG_OPT_RAW ? "roh" : options & SENSORLOG_OPT_LZ4 ? "Differenzen + LZ4" : "Differenzen");
+	}
+	else if (argc > 1 && strcmp(argv[1], "stop") == 0) {
+		FRESULT res = SensorLog_Stop();
+		if (res != FR_OK)
+			printf("Fehler beim Schließen (FatFs-Fehler %d)\n", res);
+		SensorLog_Dump();
+	}
+	else if (argc > 1) {
+		printf("Aufruf: log [start [datei] [MB] [can] [raw|lz4] | stop]\n");
+	}
+	else {
+		printf("Aufzeichnung %s\n", SensorLog_IsRunning() ? "läuft" : "aus");
+		SensorLog_Dump();
+	}
+}
+
+static void Shell_CmdShot(uint8_t argc, char *argv[]) {
+	const ILI9341_ScreenshotStats *stats = ILI9341_Screenshot_GetStats();
+
+	if (ILI9341_Screenshot_IsBusy()) {
+		printf("Aufnahme läuft noch\n");
+		return;
+	}
+	if (argc > 1 && strcmp(argv[1], "last") == 0) {
+		printf("Letzte Aufnahme: %lu Bytes in %lu ms, FatFs-Ergebnis %d, Lesefehler %u\n", stats->bytes,
+				stats->durationMs, stats->result, stats->readErrors);
+		return;
+	}
+
+	const char *path = argc > 1 ? argv[1] : ILI9341_SCREENSHOT_DEFAULT_PATH;
+	if (!ILI9341_Screenshot_Start(path)) {
+		printf("Aufnahme ließ sich nicht starten (Dateiwarteschlange voll?)\n");
+		return;
+	}
+	printf("Aufnahme nach '%s' gestartet, Ergebnis mit 'shot last'\n", path);
+}
+
+static void Shell_CmdDisp(uint8_t argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "sleep") == 0) {
+		ILI9341_Power_Sleep();
+	}
+	else if (argc > 1 && strcmp(argv[1], "wake") == 0) {
+		ILI9341_Power_Wake();
+	}
+	else if (argc > 1 && strcmp(argv[1], "status") == 0) {
+		ILI9341_Power_SetMode(ILI9341_POWER_STATUS);
+	}
+	else if (argc > 1 && strcmp(argv[1], "normal") == 0) {
+		ILI9341_Power_SetMode(ILI9341_POWER_NORMAL);
+	}
+	else if (argc > 2 && strcmp(argv[1], "timeout") == 0) {
+		ILI9341_Power_SetTimeout(strtoul(argv[2], NULL, 10) * 1000UL);
+	}
+	else {
+		ILI9341_Power_Dump();
+	}
+}
+
+static void Shell_CmdUpdate(uint8_t argc, char *argv[]) {
+	const Update_Status *status = Update_GetStatus();
+
+	if (argc > 2 && strcmp(argv[1], "sd") == 0) {
+		if (Update_FromFile(argv[2]))
+			printf("Abbild v%lu in Slot %u geprüft (%lu ms, %lu Sektoren selbst gelöscht)\n",
+					status->header.version, status->slot, status->elapsedMs, status->stalls);
+		else
+			printf("Update fehlgeschlagen: %s\n", status->error != NULL ? status->error : "-");
+	}
+	else if (argc > 1 && strcmp(argv[1], "can") == 0) {
+		if (!Update_Begin()) {
+			printf("Es läuft schon ein Empfang\n");
+			return;
+		}
+		// The next CanTp transfer goes into the slot, afterwards 'xfer' takes over again
+		CanTp_SetSink(Shell_UpdateSink, NULL);
+		printf("Warte auf das Abbild über CanTp (Slot %u), Stand mit 'update'\n", status->slot);
+	}
+	else if (argc > 1 && strcmp(argv[1], "apply") == 0) {
+		if (status->state == UPDATE_RECEIVING) {
+			printf("Erst den laufenden Empfang beenden oder 'update abort'\n");
+			return;
+		}
+		if (argc <= 2 && status->state != UPDATE_VERIFIED) {
+			printf("Kein neues Abbild empfangen, Slot angeben: 'update apply n'\n");
+			return;
+		}
+		// Without an argument the slot just received
+		uint8_t slot = argc > 2 ? (uint8_t)strtoul(argv[2], NULL, 10) : status->slot;
+		printf("Programmiere Slot %u in den internen Flash, danach Reset\n", slot);
+		fflush(stdout);
+		Serial_Flush(&Serial_Shell, SERIAL_WAIT_TIMEOUT);
+		if (!Update_Apply(slot))
+			printf("Slot %u enthält kein gültiges Abbild\n", slot);
+	}
+	else if (argc > 1 && strcmp(argv[1], "abort") == 0) {
+		Update_Abort();
+		CanTp_SetSink(Shell_XferSink, NULL);
+	}
+	else {
+		static const char *const states[] = { "bereit", "Empfang", "geprüft", "fehlgeschlagen" };
+		Update_Header header;
+
+		printf("Update: %s, Slot %u, %lu Bytes", states[status->state], status->slot, status->received);
+		if (status->state == UPDATE_FAILED && status->error != NULL)
+			printf(" (%s)", status->error);
+		printf("\n");
+		for (uint8_t slot = 0; slot < UPDATE_SLOT_COUNT; slot++) {
+			if (Update_ReadSlot(slot, &header))
+				printf("Slot %u: v%lu, %lu Bytes, CRC %08lX%s\n", slot, header.version, header.size, header.crc,
+						slot == Update_GetActiveSlot() ? " (aktiv)" : "");
+			else
+				printf("Slot %u: leer\n", slot);
+		}
+	}
+}
+
+/**
+ * @brief  Abnehmer der CanTp-Empfangsfenster: nur die Prüfsumme bilden
+ */
+static void Shell_XferSink(uint32_t offset, const uint8_t *data, uint32_t length, uint32_t total, void *context) {
+	if (offset == 0)
+		Shell_XferHash = SHELL_FNV_BASIS;
+	Shell_XferHash = Shell_Fnv(Shell_XferHash, data, length);
+}
+
+/**
+ * @brief  Abnehmer der CanTp-Empfangsfenster nach 'update can': schreibt in den Update-Slot
+ */
+static void Shell_UpdateSink(uint32_t offset, const uint8_t *data, uint32_t length, uint32_t total, void *context) {
+	Update_Feed(data, length);
+	if (offset + length < total)
+		return;
+
+	const Update_Status *status = Update_GetStatus();
+	if (Update_Finish())
+		printf("Update: Abbild v%lu in Slot %u geprüft (%lu ms)\n", status->header.version, status->slot,
+				status->elapsedMs);
+	else
+		printf("Update fehlgeschlagen: %s\n", status->error != NULL ? status->error : "-");
+	CanTp_SetSink(Shell_XferSink, NULL);
+}
+
+/**
+ * @brief  FNV-1a, fortsetzbar über mehrere Stücke
+ */
+static uint32_t Shell_Fnv(uint32_t hash, const uint8_t *data, uint32_t length) {
+	while (length--) {
+		hash ^= *data++;
+		hash *= SHELL_FNV_PRIME;
+	}
+	return hash;
+}
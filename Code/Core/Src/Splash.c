@@ -0,0 +1,77 @@
+/**
+ * @file    Splash.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Startbildschirm aus dem Asset-Bundle im W25Qxx, die SD-Karte nur als Rückfall
+ *
+ * Die Logos liegen als RGB565-Assets im Bundle (Assets/assets.txt, Ziel "assets"), das mit dem
+ * Programm in den W25Qxx geschrieben wird. Splash_Show() schaltet den Memory-Mapped-Modus ein
+ * und schickt jedes Logo mit Asset_DrawImage() in einem DMA-Transfer aus dem Fenster zu SPI1:
+ * kein FatFs, kein Mounten, keine Kopie. Gebraucht werden nur OCTOSPI und Display; Quad-Modus und
+ * Timing des W25Qxx stellt main() vorher ein (W25Qxx_begin(), MX_OCTOSPI1_TuneBus()).
+ *
+ * Fehlt das Bundle, ein Logo darin oder ist seine CRC falsch, bleibt das Logo offen.
+ * Splash_ShowFallback() zeichnet die offenen Logos später von der SD-Karte
+ * (ILI9341_DrawBinaryFile(), gleicher Dateiname), sobald das Volume gemountet ist.
+ */
+
+#include "Splash.h"
+#include "Asset.h"
+#include "ILI9341.h"
+
+static const Splash_Image Splash_Images[] = {
+	{ "SiMi_Logo_TFT.bin", 30, 120, 100, 79 },
+	{ "TFO_TFT.bin", 180, 120, 100, 79 },
+};
+
+#define SPLASH_IMAGE_COUNT        (sizeof(Splash_Images) / sizeof(Splash_Images[0]))
+
+/* Bit i gesetzt: Bild i ist noch nicht gezeichnet */
+static uint8_t Splash_Pending = (1U << SPLASH_IMAGE_COUNT) - 1;
+
+/**
+ * @brief  Zeichnet die Logos aus dem Asset-Bundle, die Übertragungen laufen beim Rücksprung noch
+ * @retval 1 wenn alle Logos aus dem Flash kamen, 0 wenn welche für Splash_ShowFallback() offen sind
+ */
+uint8_t Splash_Show(void) {
+	if (!Asset_Init()) {
+		return 0;
+	}
+
+	for (uint8_t i = 0; i < SPLASH_IMAGE_COUNT; i++) {
+		const Splash_Image *image = &Splash_Images[i];
+
+		if ((Splash_Pending & (1U << i)) && Asset_DrawImage(image->name, image->x, image->y)) {
+			Splash_Pending &= ~(1U << i);
+		}
+	}
+	return Splash_Pending == 0;
+}
+
+/**
+ * @brief  Zeichnet die noch offenen Logos von der SD-Karte (Volume muss gemountet sein)
+ */
+void Splash_ShowFallback(void) {
+	for (uint8_t i = 0; i < SPLASH_IMAGE_COUNT; i++) {
+		const Splash_Image *image = &Splash_Images[i];
+
+		if (Splash_Pending & (1U << i)) {
+			ILI9341_DrawBinaryFile(image->name, image->x, image->y, image->width, image->height);
+			Splash_Pending &= ~(1U << i);
+		}
+	}
+}
+
+/**
+ * @brief  Nach einem Warmstart mit übernommenem Panel: die Logos stehen noch im Displayspeicher
+ */
+void Splash_Keep(void) {
+	Splash_Pending = 0;
+}
+
+/**
+ * @brief  Maske der noch nicht gezeichneten Logos (Bit i = Eintrag i)
+ */
+uint8_t Splash_GetPending(void) {
+	return Splash_Pending;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file    Stack.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Stack-Bemalung und Hochwassermarke des Hauptstacks (MSP)
+ *
+ * Der Linker reserviert für den Stack nur _Min_Stack_Size (1 KiB) am Ende des AXI-SRAM; ob das
+ * reicht, sagt er nicht. Stack_Paint() füllt deshalb zu Beginn von main() den freien Bereich
+ * unterhalb des Stackpointers mit STACK_PAINT_PATTERN. Was später überschrieben ist, war einmal
+ * belegt: Stack_GetUsed() sucht von unten das erste veränderte Wort, das ist die tiefste Stelle
+ * seit dem Start, gemessen ab _estack.
+ *
+ * Alle Interrupts laufen auf demselben MSP wie main() (kein RTOS, kein PSP), ihre Rahmen
+ * einschließlich des FPU-Kontexts landen unter dem, was sie gerade unterbrechen. Die Marke
+ * enthält sie also schon, auch verschachtelte. Wie tief der Stack beim Eintritt in einen
+ * Handler war, zeichnet Irq_Enter() zusätzlich auf (Irq_StackLow).
+ *
+ * Die Marke zeigt nur, was tatsächlich lief. Die obere Grenze aus dem Aufrufgraphen liefert
+ * Tools/stack_report.py aus den .su/.ci-Dateien des Compilers (Option STACK_USAGE); beide
+ * zusammen bestimmen die Größe, bevor der Stack in das kleine DTCM kommt.
+ *
+ * Wächst der Heap (malloc über _sbrk) in den bemalten Bereich, zählt nur der Teil darüber.
+ */
+
+#include "Stack.h"
+
+#if STACK_PAINT_ENABLE
+
+#include "Irq.h"
+#include <stddef.h>
+#include <stdio.h>
+
+extern uint8_t _estack;           // linker script: end of RAM, initial MSP
+extern uint8_t _end;              // linker script: end of .bss, start of the heap
+extern uint8_t _Min_Stack_Size;   // linker script: reserved stack size (address = value)
+
+extern void *_sbrk(ptrdiff_t incr);
+
+/* Unterstes bemaltes Wort, 0 solange nicht bemalt */
+static uint32_t *Stack_Bottom = NULL;
+
+static uint32_t *Stack_Floor(void);
+
+/**
+ * @brief  Bemalt den Stack unterhalb des aktuellen Stackpointers, als Erstes in main()
+ *
+ * Vom Heap-Ende (oder STACK_PAINT_SIZE unter dem Stackpointer) bis STACK_PAINT_MARGIN unter den
+ * eigenen Rahmen. Die Interrupts sind noch aus, niemand sonst benutzt den Bereich.
+ */
+void Stack_Paint(void) {
+	uint32_t sp = __get_MSP();
+	uint32_t heap = (uint32_t)_sbrk(0);
+	uint32_t bottom = sp - STACK_PAINT_SIZE;
+	uint32_t top = (sp - STACK_PAINT_MARGIN) & ~3UL;
+
+	if (heap == (uint32_t)-1) {
+		heap = (uint32_t)&_end;
+	}
+	if (bottom < heap) {
+		bottom = heap;
+	}
+	bottom = (bottom + 3UL) & ~3UL;
+
+	for (volatile uint32_t *p = (uint32_t *)bottom; p < (uint32_t *)top; p++) {
+		*p = STACK_PAINT_PATTERN;
+	}
+	Stack_Bottom = (uint32_t *)bottom;
+}
+
+/**
+ * @brief  Höchste Belegung des Stacks seit Stack_Paint() in Byte, ab _estack
+ * @retval 0 wenn nicht bemalt
+ */
+uint32_t Stack_GetUsed(void) {
+	uint32_t *p = Stack_Floor();
+	uint32_t *top = (uint32_t *)&_estack;
+
+	if (p == NULL) {
+		return 0;
+	}
+	while (p < top && *p == STACK_PAINT_PATTERN) {
+		p++;
+	}
+	return (uint32_t)&_estack - (uint32_t)p;
+}
+
+/**
+ * @brief  Größe des messbaren Bereichs in Byte: mehr Bedarf als das sieht die Marke nicht
+ */
+uint32_t Stack_GetPainted(void) {
+	uint32_t *floor = Stack_Floor();
+
+	return floor ? (uint32_t)&_estack - (uint32_t)floor : 0;
+}
+
+/**
+ * @brief  Hochwassermarke, Reserve und Vergleich mit _Min_Stack_Size über printf
+ *
+ * Läuft auf dem gemessenen Stack; die eigene Tiefe der Shell ist in der Marke mit drin.
+ */
+void Stack_Dump(void) {
+	uint32_t reserved = (uint32_t)&_Min_Stack_Size;
+	uint32_t painted = Stack_GetPainted();
+	uint32_t used = Stack_GetUsed();
+	uint32_t now = (uint32_t)&_estack - __get_MSP();
+
+	if (painted == 0) {
+		printf("Stack nicht bemalt\n");
+		return;
+	}
+
+	printf("Stack (MSP): Ende 0x%08lX, bemalt %lu Byte ab 0x%08lX\n",
+			(uint32_t)&_estack, painted, (uint32_t)&_estack - painted);
+	printf("  Hochwassermarke %lu Byte (%lu %% des bemalten Bereichs), jetzt %lu Byte\n",
+			used, used * 100UL / painted, now);
+#if IRQ_STAT_ENABLE
+	if (Irq_StackLow != 0xFFFFFFFFUL) {
+		printf("  tiefster Eintritt in einen Interrupt: %lu Byte\n", (uint32_t)&_estack - Irq_StackLow);
+	}
+#endif
+	printf("  reserviert (_Min_Stack_Size) %lu Byte: %s\n", reserved,
+			used > reserved ? "ZU KLEIN" : "reicht");
+	if (used >= painted) {
+		printf("  Marke am Rand des bemalten Bereichs, Bedarf unbekannt\n");
+	}
+}
+
+/* --------------------------------- Intern --------------------------------- */
+
+/**
+ * @brief  Unterstes noch gültiges Wort: das bemalte, außer der Heap ist darüber gewachsen
+ */
+static uint32_t *Stack_Floor(void) {
+	uint32_t heap = (uint32_t)_sbrk(0);
+	uint32_t *floor = Stack_Bottom;
+
+	if (floor == NULL) {
+		return NULL;
+	}
+	if (heap != (uint32_t)-1 && heap > (uint32_t)floor) {
+		floor = (uint32_t *)((heap + 3UL) & ~3UL);
+	}
+	return floor;
+}
+
+#endif /* STACK_PAINT_ENABLE */
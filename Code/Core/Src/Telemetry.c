@@ -0,0 +1,493 @@
+/**
+ * @file    Telemetry.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Binärer Messdatenstrom an den PC: Pakete mit CRC32, COBS-gerahmt, per DMA über LPUART1
+ *
+ * Der Telemetry-Task sammelt die eingeschalteten Kanäle zu Paketen und reiht sie mit
+ * Serial_Write() in den Sendepuffer von Serial_Shell ein; Ringpuffer und BDMA2 teilt sich der
+ * Datenstrom mit den Antworten der Kommandozeile. Serial_Write() übernimmt jeden Rahmen ganz
+ * oder gar nicht, Text und Rahmen vermischen sich daher nie innerhalb eines Rahmens. Passt ein
+ * Rahmen nicht mehr in den Puffer, wird er verworfen und gezählt (der Empfänger erkennt die
+ * Lücke an der Paketnummer).
+ *
+ * Paket (Little Endian):
+ *   Art (1 Byte), reserviert (1), Paketnummer (2), Timebase_Us32() (4), Nutzdaten, CRC32 (4)
+ * Die CRC32 (wie zlib.crc32) über Kopf und Nutzdaten rechnet die CRC-Einheit des H7 (Crc32.c). Das ganze
+ * Paket wird COBS-kodiert und zwischen zwei 0x00 gesendet; Text der Kommandozeile enthält nie
+ * 0x00, Tools/telemetry_decode.py trennt beides an den Nullbytes.
+ *
+ * Nutzdaten je Art:
+ * - INFO:   Kerntakt (4), Scans/s (4), Scans je Block (2), Slots je Scan (1), Potimaske (1),
+ *           Dezimierung (1), Kanäle (1), Poti je Slot (ADC_ACQ_MAX_SLOTS, unbenutzt 0xFF)
+ * - ADC:    Blocknummer (4), erster Scan im Block (2), Anzahl Scans (2), dann je Scan die
+ *           16-Bit-Werte aller Slots, deren Poti in der Maske steht
+ * - AHT20:  Temperatur (float), Luftfeuchte (float), nur neue Werte aus TOPIC_CLIMATE (ungefiltert)
+ * - TIMING: CPU-Last in 0,1 % (2), Anzahl Tasks (1), reserviert (1), je Task runs, overruns,
+ *           maxLatency, maxRuntime (je 4, Takte)
+ * - MIRROR: fertige Nutzdaten von Mirror.c (Telemetry_SendPacket()), Aufbau siehe dort
+ * - FRAME:  Bilder, Überschreitungen, Budget, letzte und längste Zeichenzeit, letzte und längste
+ *           Übertragung, Dauer der letzten Überschreitung (je 4, µs), Anzahl Widgets (1),
+ *           reserviert (1), je Widget (höchstens TELEMETRY_FRAME_WORST, langsamste zuerst)
+ *           Nummer (1), Art (1), Überschreitungen (4), längste Zeichenzeit (4, µs)
+ *
+ * Ist der ESP-Einsatz verbunden (EspLink.c), geht jedes Paket zusätzlich ungerahmt auf
+ * ESPLINK_CH_TELEMETRY, direkt aus dem Paketpuffer (außer MIRROR, das Mirror.c selbst schickt). Dafür gibt es zwei Paketpuffer: solange der
+ * Link einen sendet, baut der Task die nächsten Pakete im anderen; ist der Link mit dem vorigen
+ * noch nicht fertig, geht das Paket nur über LPUART1 (linkSkipped).
+ *
+ * ADC-Werte kommen als Empfänger der Messblöcke (ADC_AddBlockListener()) wie in Dsp.c: der
+ * Interrupt merkt den Block nur vor, der Task liest die Werte direkt aus dem DMA-Puffer und gibt
+ * ihn danach frei. Ohne laufenden Messbetrieb von ADC.c kommen keine ADC-Pakete.
+ */
+
+#include "Telemetry.h"
+#include "Serial.h"
+#include "Scheduler.h"
+#include "Topic.h"
+#include "Crc32.h"
+#include "Timebase.h"
+#include "EspLink.h"
+#include "Canvas.h"
+#include "ILI9341_Widget.h"
+#include <string.h>
+
+#define TELEMETRY_HEADER_SIZE     8
+#define TELEMETRY_CRC_SIZE        4
+#define TELEMETRY_PACKET_SIZE     (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + TELEMETRY_CRC_SIZE)
+
+/* COBS fügt je angefangene 254 Bytes ein Byte ein, dazu die beiden Begrenzer */
+#define TELEMETRY_FRAME_SIZE      (TELEMETRY_PACKET_SIZE + TELEMETRY_PACKET_SIZE / 254 + 1 + 2)
+
+/* Kopf der ADC-Nutzdaten: Blocknummer, erster Scan, Anzahl Scans */
+#define TELEMETRY_ADC_HEADER      8
+
+static uint8_t Telemetry_Packets[2][TELEMETRY_PACKET_SIZE] __attribute__((aligned(4)));
+static uint8_t *Telemetry_Packet = Telemetry_Packets[0];  // being built, the other one may be with EspLink
+static volatile uint8_t Telemetry_LinkBusy = 0;
+static uint8_t Telemetry_Frame[TELEMETRY_FRAME_SIZE];
+
+static uint8_t Telemetry_TaskId = SCHEDULER_INVALID_TASK;
+static volatile uint8_t Telemetry_Running = 0;
+static Telemetry_Config Telemetry_Active;
+static Telemetry_Stats Telemetry_Counters;
+static uint16_t Telemetry_Sequence = 0;
+
+static const ADC_Block *volatile Telemetry_Pending = NULL; // block held for the task
+static uint32_t Telemetry_LastInfo = 0;
+static uint32_t Telemetry_LastAht20 = 0;
+static uint32_t Telemetry_ClimateSequence = 0;          // last TOPIC_CLIMATE value sent
+static uint32_t Telemetry_LastTiming = 0;
+
+// ADC layout announced with the last INFO packet
+static uint16_t Telemetry_InfoScans = 0;
+static uint8_t Telemetry_InfoSlots = 0;
+static uint8_t Telemetry_InfoSlotChannel[ADC_ACQ_MAX_SLOTS];
+
+static uint8_t Telemetry_BlockCallback(const ADC_Block *block, void *context);
+static void Telemetry_SendInfo(const ADC_Block *block);
+static void Telemetry_SendAdc(const ADC_Block *block);
+static void Telemetry_SendAht20(void);
+static void Telemetry_SendTiming(void);
+static void Telemetry_SendFrame(void);
+static uint8_t* Telemetry_Begin(uint8_t type);
+static void Telemetry_Send(uint32_t payloadLength);
+static uint8_t Telemetry_Transmit(uint32_t payloadLength, uint8_t forward);
+static void Telemetry_SendLink(uint32_t length);
+static void Telemetry_LinkDone(const void *data, uint32_t length, uint8_t sent, void *context);
+static uint32_t Telemetry_Cobs(const uint8_t *src, uint32_t length, uint8_t *dst);
+static uint8_t* Telemetry_Put16(uint8_t *p, uint16_t value);
+static uint8_t* Telemetry_Put32(uint8_t *p, uint32_t value);
+
+/**
+ * @brief  Stellt die CRC-Einheit ein und meldet sich bei ADC.c an, der Datenstrom bleibt aus
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der Telemetry_Task() aufruft
+ * @retval 1 bei Erfolg, 0 wenn kein Empfängerplatz für ADC-Blöcke mehr frei ist
+ */
+uint8_t Telemetry_Init(uint8_t taskId) {
+	Telemetry_TaskId = taskId;
+	Scheduler_SetEnabled(taskId, 0);
+
+	Crc32_Init();
+
+	return ADC_AddBlockListener(Telemetry_BlockCallback, NULL);
+}
+
+/**
+ * @brief  Startet den Datenstrom bzw. übernimmt neue Einstellungen, zuerst kommt ein Info-Paket
+ */
+void Telemetry_Start(const Telemetry_Config *config) {
+	Telemetry_Stop();
+
+	Telemetry_Active = *config;
+	if (Telemetry_Active.adcDecimation == 0)
+		Telemetry_Active.adcDecimation = 1;
+	Telemetry_Active.adcMask &= (1U << ADC_POTI_COUNT) - 1;
+
+	uint32_t now = Scheduler_GetTicks();
+	Telemetry_LastInfo = now - TELEMETRY_INFO_PERIOD_MS;
+	Telemetry_LastAht20 = now - Telemetry_Active.aht20PeriodMs;
+	Telemetry_ClimateSequence = 0;
+	Telemetry_LastTiming = now - Telemetry_Active.timingPeriodMs;
+
+	Telemetry_Running = 1;
+	Scheduler_SetEnabled(Telemetry_TaskId, 1);
+}
+
+/**
+ * @brief  Hält den Datenstrom an und gibt einen noch vorgemerkten ADC-Block frei
+ */
+void Telemetry_Stop(void) {
+	const ADC_Block *block;
+
+	Telemetry_Running = 0;
+	Scheduler_SetEnabled(Telemetry_TaskId, 0);
+
+	__disable_irq();
+	block = Telemetry_Pending;
+	Telemetry_Pending = NULL;
+	__enable_irq();
+
+	if (block != NULL)
+		ADC_ReleaseBlock(block);
+}
+
+uint8_t Telemetry_IsRunning(void) {
+	return Telemetry_Running;
+}
+
+const Telemetry_Config* Telemetry_GetConfig(void) {
+	return &Telemetry_Active;
+}
+
+const Telemetry_Stats* Telemetry_GetStats(void) {
+	return &Telemetry_Counters;
+}
+
+/**
+ * @brief  Scheduler-Task: sendet fällige Pakete, nur eingeschaltet, solange der Datenstrom läuft
+ */
+void Telemetry_Task(void *context) {
+	const ADC_Block *block = Telemetry_Pending;
+	uint32_t now = Scheduler_GetTicks();
+
+	if (!Telemetry_Running)
+		return;
+
+	if (now - Telemetry_LastInfo >= TELEMETRY_INFO_PERIOD_MS) {
+		Telemetry_LastInfo = now;
+		Telemetry_SendInfo(block);
+	}
+
+	if (block != NULL) {
+		Telemetry_SendAdc(block);
+		ADC_ReleaseBlock(block);
+		Telemetry_Pending = NULL;
+	}
+
+	if ((Telemetry_Active.channels & TELEMETRY_CH_AHT20)
+			&& now - Telemetry_LastAht20 >= Telemetry_Active.aht20PeriodMs) {
+		Telemetry_LastAht20 = now;
+		Telemetry_SendAht20();
+	}
+
+	if ((Telemetry_Active.channels & TELEMETRY_CH_TIMING)
+			&& now - Telemetry_LastTiming >= Telemetry_Active.timingPeriodMs) {
+		Telemetry_LastTiming = now;
+		Telemetry_SendTiming();
+		Telemetry_SendFrame();
+	}
+}
+
+/**
+ * @brief  Merkt einen fertigen Block für den Task vor, im DMA-Interrupt
+ * @retval 1 = Block behalten, bis der Task ihn gesendet hat
+ */
+static uint8_t Telemetry_BlockCallback(const ADC_Block *block, void *context) {
+	if (!Telemetry_Running || !(Telemetry_Active.channels & TELEMETRY_CH_ADC) || Telemetry_Active.adcMask == 0)
+		return 0;
+
+	if (Telemetry_Pending != NULL) {
+		Telemetry_Counters.adcSkipped++;
+		return 0;
+	}
+
+	Telemetry_Pending = block;
+	return 1;
+}
+
+/**
+ * @brief  Kerntakt und Aufbau der ADC-Pakete, damit der Empfänger Werte und Zeitstempel zuordnen kann
+ * @param  block: aktueller Block für den Slot-Aufbau, NULL = zuletzt gemeldeter Aufbau
+ */
+static void Telemetry_SendInfo(const ADC_Block *block) {
+	uint8_t *p = Telemetry_Begin(TELEMETRY_PKT_INFO);
+	uint32_t scanHz = 0;
+
+	if (block != NULL) {
+		Telemetry_InfoScans = block->scans;
+		Telemetry_InfoSlots = block->slots;
+		memcpy(Telemetry_InfoSlotChannel, block->slotChannel, block->slots);
+	}
+
+	// The ADC only reports rates per channel: scan rate = channel rate / its slots per scan
+	if (Telemetry_InfoSlots > 0) {
+		uint8_t channel = Telemetry_InfoSlotChannel[0];
+		uint32_t weight = 0;
+		for (uint8_t slot = 0; slot < Telemetry_InfoSlots; slot++)
+			weight += Telemetry_InfoSlotChannel[slot] == channel;
+		scanHz = ADC_GetChannelRate(channel) / weight;
+	}
+
+	p = Telemetry_Put32(p, SystemCoreClock);
+	p = Telemetry_Put32(p, scanHz);
+	p = Telemetry_Put16(p, Telemetry_InfoScans);
+	*p++ = Telemetry_InfoSlots;
+	*p++ = Telemetry_Active.adcMask;
+	*p++ = Telemetry_Active.adcDecimation;
+	*p++ = Telemetry_Active.channels;
+	memset(p, 0xFF, ADC_ACQ_MAX_SLOTS);
+	memcpy(p, Telemetry_InfoSlotChannel, Telemetry_InfoSlots);
+
+	Telemetry_Send(14 + ADC_ACQ_MAX_SLOTS);
+}
+
+/**
+ * @brief  Verteilt die gewählten Werte eines Blocks auf Pakete, direkt aus dem DMA-Puffer
+ */
+static void Telemetry_SendAdc(const ADC_Block *block) {
+	uint8_t decimation = Telemetry_Active.adcDecimation;
+	uint8_t mask = Telemetry_Active.adcMask;
+	uint8_t values = 0;
+
+	// A changed sequence has to be announced before samples in the new layout
+	if (block->slots != Telemetry_InfoSlots
+			|| memcmp(block->slotChannel, Telemetry_InfoSlotChannel, block->slots) != 0)
+		Telemetry_SendInfo(block);
+
+	for (uint8_t slot = 0; slot < block->slots; slot++)
+		values += (mask >> block->slotChannel[slot]) & 1U;
+	if (values == 0)
+		return;
+
+	uint16_t scansPerPacket = (TELEMETRY_MAX_PAYLOAD - TELEMETRY_ADC_HEADER) / (2U * values);
+
+	for (uint16_t scan = 0; scan < block->scans; ) {
+		uint8_t *p = Telemetry_Begin(TELEMETRY_PKT_ADC);
+		uint8_t *countField;
+		uint16_t count = 0;
+
+		p = Telemetry_Put32(p, block->sequence);
+		p = Telemetry_Put16(p, scan);
+		countField = p;
+		p += 2;
+
+		for (; scan < block->scans && count < scansPerPacket; scan += decimation, count++) {
+			const uint16_t *samples = &block->data[scan * block->slots];
+			for (uint8_t slot = 0; slot < block->slots; slot++) {
+				if ((mask >> block->slotChannel[slot]) & 1U)
+					p = Telemetry_Put16(p, samples[slot]);
+			}
+		}
+
+		Telemetry_Put16(countField, count);
+		Telemetry_Send(TELEMETRY_ADC_HEADER + 2U * values * count);
+	}
+}
+
+/**
+ * @brief  Neuer Messwert des AHT20, nichts, wenn seit dem letzten Paket keiner kam
+ */
+static void Telemetry_SendAht20(void) {
+	Topic_Climate climate;
+	uint32_t bits;
+
+	if (!Topic_Read(TOPIC_CLIMATE, &climate, sizeof(climate), &Telemetry_ClimateSequence))
+		return;
+
+	// The packet keeps its float layout for the PC side
+	float temperature = climate.temperature / 100.0f;
+	float humidity = climate.humidity / 100.0f;
+	uint8_t *p = Telemetry_Begin(TELEMETRY_PKT_AHT20);
+	memcpy(&bits, &temperature, 4);
+	p = Telemetry_Put32(p, bits);
+	memcpy(&bits, &humidity, 4);
+	Telemetry_Put32(p, bits);
+	Telemetry_Send(8);
+}
+
+/**
+ * @brief  CPU-Last und Statistik aller Scheduler-Tasks (Reihenfolge wie bei 'tasks')
+ */
+static void Telemetry_SendTiming(void) {
+	uint8_t *p = Telemetry_Begin(TELEMETRY_PKT_TIMING);
+	uint8_t count = Scheduler_GetTaskCount();
+
+	p = Telemetry_Put16(p, Scheduler_GetLoad());
+	*p++ = count;
+	*p++ = 0;
+	for (uint8_t i = 0; i < count; i++) {
+		const Scheduler_Task *task = &Scheduler_Tasks[i];
+		p = Telemetry_Put32(p, task->runs);
+		p = Telemetry_Put32(p, task->overruns);
+		p = Telemetry_Put32(p, task->maxLatency);
+		p = Telemetry_Put32(p, task->maxRuntime);
+	}
+
+	Telemetry_Send(4 + 16U * count);
+}
+
+/**
+ * @brief  Bildbudget des Bildtakts (Canvas.c) und die Widgets, die es am häufigsten sprengen
+ */
+static void Telemetry_SendFrame(void) {
+	uint8_t *p = Telemetry_Begin(TELEMETRY_PKT_FRAME);
+	const Canvas_FrameStats *frame = Canvas_GetFrameStats();
+	uint8_t worst[TELEMETRY_FRAME_WORST];
+	uint8_t count = ILI9341_Widget_GetWorst(worst, TELEMETRY_FRAME_WORST);
+	uint32_t mhz = SystemCoreClock / 1000000UL;
+
+	p = Telemetry_Put32(p, frame->frames);
+	p = Telemetry_Put32(p, frame->overruns);
+	p = Telemetry_Put32(p, frame->budgetUs);
+	p = Telemetry_Put32(p, frame->lastRenderUs);
+	p = Telemetry_Put32(p, frame->maxRenderUs);
+	p = Telemetry_Put32(p, frame->lastUs);
+	p = Telemetry_Put32(p, frame->maxUs);
+	p = Telemetry_Put32(p, frame->lastOverrunUs);
+	*p++ = count;
+	*p++ = 0;
+	for (uint8_t i = 0; i < count; i++) {
+		const ILI9341_Widget *widget = ILI9341_Widget_Get(worst[i]);
+		*p++ = worst[i];
+		*p++ = (uint8_t)widget->type;
+		p = Telemetry_Put32(p, widget->overruns);
+		p = Telemetry_Put32(p, widget->maxRenderCycles / mhz);
+	}
+
+	Telemetry_Send(34 + 10U * count);
+}
+
+/**
+ * @brief  Schreibt den Paketkopf
+ * @retval Anfang der Nutzdaten
+ */
+static uint8_t* Telemetry_Begin(uint8_t type) {
+	uint8_t *p = Telemetry_Packet;
+
+	*p++ = type;
+	*p++ = 0;
+	p = Telemetry_Put16(p, Telemetry_Sequence++);
+	return Telemetry_Put32(p, Timebase_Us32());
+}
+
+/**
+ * @brief  Sendet ein Paket mit fertigen Nutzdaten eines anderen Moduls über LPUART1, nicht über
+ *         den ESP-Link (nur aus Tasks, wie alle Pakete)
+ * @param  type: TELEMETRY_PKT_*
+ * @param  length: höchstens TELEMETRY_MAX_PAYLOAD
+ * @retval 1 eingereiht, 0 zu lang oder kein Platz im Sendepuffer (dropped)
+ */
+uint8_t Telemetry_SendPacket(uint8_t type, const void *payload, uint32_t length) {
+	if (length > TELEMETRY_MAX_PAYLOAD)
+		return 0;
+
+	memcpy(Telemetry_Begin(type), payload, length);
+	return Telemetry_Transmit(length, 0);
+}
+
+static void Telemetry_Send(uint32_t payloadLength) {
+	Telemetry_Transmit(payloadLength, 1);
+}
+
+/**
+ * @brief  Hängt die CRC an, rahmt das Paket mit COBS und reiht es in den Sendepuffer ein
+ * @param  forward: 1 = zusätzlich an den ESP-Link
+ * @retval 1 eingereiht, 0 verworfen
+ */
+static uint8_t Telemetry_Transmit(uint32_t payloadLength, uint8_t forward) {
+	uint32_t length = TELEMETRY_HEADER_SIZE + payloadLength;
+
+	Telemetry_Put32(&Telemetry_Packet[length], Crc32_Compute(Telemetry_Packet, length));
+	length += TELEMETRY_CRC_SIZE;
+	if (forward)
+		Telemetry_SendLink(length);
+
+	Telemetry_Frame[0] = 0;
+	length = 1 + Telemetry_Cobs(Telemetry_Packet, length, &Telemetry_Frame[1]);
+	Telemetry_Frame[length++] = 0;
+
+	if (Serial_Write(&Serial_Shell, Telemetry_Frame, length) == 0) {
+		Telemetry_Counters.dropped++;
+		return 0;
+	}
+	Telemetry_Counters.packets++;
+	Telemetry_Counters.bytes += length;
+	return 1;
+}
+
+/**
+ * @brief  Übergibt das fertige Paket ohne Kopie dem ESP-Link und baut das nächste im anderen Puffer
+ */
+static void Telemetry_SendLink(uint32_t length) {
+	if (!EspLink_IsUp())
+		return;
+	if (Telemetry_LinkBusy) {
+		Telemetry_Counters.linkSkipped++;
+		return;
+	}
+
+	Telemetry_LinkBusy = 1;
+	if (!EspLink_Send(ESPLINK_CH_TELEMETRY, Telemetry_Packet, length, 0, Telemetry_LinkDone, NULL)) {
+		Telemetry_LinkBusy = 0;
+		Telemetry_Counters.linkSkipped++;
+		return;
+	}
+	Telemetry_Counters.linkPackets++;
+	Telemetry_Packet = (Telemetry_Packet == Telemetry_Packets[0]) ? Telemetry_Packets[1] : Telemetry_Packets[0];
+}
+
+/**
+ * @brief  EspLink hat den Paketpuffer gelesen (Interrupt), er darf wieder beschrieben werden
+ */
+static void Telemetry_LinkDone(const void *data, uint32_t length, uint8_t sent, void *context) {
+	Telemetry_LinkBusy = 0;
+}
+
+/**
+ * @brief  COBS-Kodierung: entfernt alle Nullbytes, damit 0x00 nur als Rahmengrenze vorkommt
+ * @param  dst: Platz für length + length / 254 + 1 Bytes
+ * @retval Länge der kodierten Daten
+ */
+static uint32_t Telemetry_Cobs(const uint8_t *src, uint32_t length, uint8_t *dst) {
+	uint8_t *code = dst;           // where the length of the current run goes
+	uint8_t *out = dst + 1;
+	uint8_t run = 1;
+
+	for (uint32_t i = 0; i < length; i++) {
+		if (src[i] != 0) {
+			*out++ = src[i];
+			if (++run < 0xFF)
+				continue;
+		}
+		*code = run;
+		code = out++;
+		run = 1;
+	}
+	*code = run;
+	return out - dst;
+}
+
+static uint8_t* Telemetry_Put16(uint8_t *p, uint16_t value) {
+	p[0] = value;
+	p[1] = value >> 8;
+	return p + 2;
+}
+
+static uint8_t* Telemetry_Put32(uint8_t *p, uint32_t value) {
+	p[0] = value;
+	p[1] = value >> 8;
+	p[2] = value >> 16;
+	p[3] = value >> 24;
+	return p + 4;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file    Thermal.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Begrenzt das Taktprofil nach Chip- und Umgebungstemperatur
+ *
+ * In einem warmen Gehäuse bringt das Profil mit 280 MHz (VOS0) den Chip an die Grenze seines
+ * Temperaturbereichs. Statt dort Instabilität zu riskieren, senkt dieses Modul die Obergrenze des
+ * Governors (Governor_SetCeiling()):
+ * - Chip ab THERMAL_DIE_BALANCED        -> höchstens CLOCK_PROFILE_BALANCED
+ * - Chip ab THERMAL_DIE_LOW_POWER       -> höchstens CLOCK_PROFILE_LOW_POWER
+ * - Umgebung ab THERMAL_AMBIENT_BALANCED -> höchstens CLOCK_PROFILE_BALANCED, auch bei kühlem Chip,
+ *   weil dann kaum Reserve für den nächsten Lastschub bleibt
+ * Gesenkt wird sofort, angehoben erst THERMAL_HYSTERESIS unter allen Schwellen. Jeder Wechsel geht
+ * als Meldung an den Logger (LOG).
+ *
+ * Messung: Der STM32H7B0 hat kein ADC3, Temperatursensor und VREFINT hängen an ADC2. ADC1 bleibt
+ * bei den Potis. ADC2 wandelt abwechselnd beide Kanäle, eine Wandlung je Timer-Callback: der
+ * Callback holt das Ergebnis der vorigen, trägt den anderen Kanal als Rank 1 ein und startet die
+ * nächste, gewartet wird nie. VREFINT liefert die tatsächliche VDDA, die
+ * Kalibrierwerte TS_CAL1/TS_CAL2 gelten für 3,3 V. Die Umgebung kommt aus TOPIC_CLIMATE (AHT20).
+ *
+ * Die internen Messpfade (TSEN, VREFEN im gemeinsamen CCR von ADC1/2) lassen sich nur setzen,
+ * solange keiner der beiden ADCs eingeschaltet ist: Thermal_Init() muss vor ADC_Start() laufen.
+ */
+
+#include "Thermal.h"
+
+#if THERMAL_ENABLE
+
+#include "Governor.h"
+#include "Timer.h"
+#include "Topic.h"
+#include "WarmBoot.h"
+#include "Log.h"
+#include <stdio.h>
+
+static ADC_HandleTypeDef Thermal_Adc;
+static Timer Thermal_Timer;
+static Thermal_Stats Thermal_Statistics;
+static uint8_t Thermal_Ready = 0;
+static uint32_t Thermal_ClimateSequence = 0;
+static uint32_t Thermal_LastTick = 0;
+static uint32_t Thermal_Channel = ADC_CHANNEL_VREFINT;     // Kanal der laufenden Wandlung
+
+static void Thermal_Tick(void *context);
+static Clock_Profile Thermal_Evaluate(Clock_Profile ceiling);
+static const char* Thermal_Format(char *buffer, uint32_t size, int16_t centi);
+
+/**
+ * @brief  ADC2 für Temperatursensor und VREFINT einrichten und den Timer starten (nach Timer_Init()
+ *         und MX_ADC1_Init(), vor ADC_Start())
+ */
+void Thermal_Init(void) {
+	ADC_ChannelConfTypeDef sConfig = { 0 };
+
+	Thermal_Statistics = (Thermal_Stats){ 0 };
+	Thermal_Statistics.ambient = THERMAL_NO_AMBIENT;
+	Thermal_Statistics.dieMax = INT16_MIN;
+	Thermal_Statistics.vddaMv = VREFINT_CAL_VREF;
+	Thermal_Statistics.ceiling = CLOCK_PROFILE_MAX;
+
+	// Kernel clock and prescaler are shared with ADC1 (ADC12 common, enabled by MX_ADC1_Init())
+	Thermal_Adc.Instance = ADC2;
+	Thermal_Adc.Init.ClockPrescaler = ADC_CLOCK_ASYNC_DIV6;
+	Thermal_Adc.Init.Resolution = ADC_RESOLUTION_16B;
+	Thermal_Adc.Init.ScanConvMode = ADC_SCAN_DISABLE;
+	Thermal_Adc.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
+	Thermal_Adc.Init.LowPowerAutoWait = DISABLE;
+	Thermal_Adc.Init.ContinuousConvMode = DISABLE;
+	Thermal_Adc.Init.NbrOfConversion = 1;
+	Thermal_Adc.Init.DiscontinuousConvMode = DISABLE;
+	Thermal_Adc.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+	Thermal_Adc.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
+	Thermal_Adc.Init.ConversionDataManagement = ADC_CONVERSIONDATA_DR;
+	Thermal_Adc.Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
+	Thermal_Adc.Init.LeftBitShift = ADC_LEFTBITSHIFT_NONE;
+	Thermal_Adc.Init.OversamplingMode = ENABLE;
+	Thermal_Adc.Init.Oversampling.Ratio = 16;
+	Thermal_Adc.Init.Oversampling.RightBitShift = ADC_RIGHTBITSHIFT_4;
+	Thermal_Adc.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+	Thermal_Adc.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
+	if (HAL_ADC_Init(&Thermal_Adc) != HAL_OK)
+		return;
+
+	// Both channels once for path, preselection and sampling time; the sensor needs at least 9 µs,
+	// 387.5 cycles cover it at any ADC clock used here. Rank 1 holds VREFINT afterwards
+	sConfig.Channel = ADC_CHANNEL_TEMPSENSOR;
+	sConfig.Rank = ADC_REGULAR_RANK_1;
+	sConfig.SamplingTime = ADC_SAMPLETIME_387CYCLES_5;
+	sConfig.SingleDiff = ADC_SINGLE_ENDED;
+	sConfig.OffsetNumber = ADC_OFFSET_NONE;
+	sConfig.Offset = 0;
+	sConfig.OffsetSignedSaturation = DISABLE;
+	if (HAL_ADC_ConfigChannel(&Thermal_Adc, &sConfig) != HAL_OK)
+		return;
+	sConfig.Channel = ADC_CHANNEL_VREFINT;
+	if (HAL_ADC_ConfigChannel(&Thermal_Adc, &sConfig) != HAL_OK)
+		return;
+
+	if (!WarmBoot_CalibrateAdc(&Thermal_Adc, WARMBOOT_ITEM_ADC2))
+		return;
+	// ADC2 stays enabled from here on, HAL_ADC_Start() only triggers the next conversion
+	Thermal_Channel = ADC_CHANNEL_VREFINT;
+	if (HAL_ADC_Start(&Thermal_Adc) != HAL_OK)
+		return;
+
+	Thermal_Ready = 1;
+	Thermal_LastTick = HAL_GetTick();
+	Timer_Setup(&Thermal_Timer, "Thermal", Thermal_Tick, NULL);
+	Timer_Start(&Thermal_Timer, THERMAL_TICK_MS, THERMAL_TICK_MS);
+}
+
+/**
+ * @brief  Höchstes Profil, das die Temperatur gerade zulässt
+ */
+Clock_Profile Thermal_GetCeiling(void) {
+	return Thermal_Statistics.ceiling;
+}
+
+const Thermal_Stats* Thermal_GetStats(void) {
+	return &Thermal_Statistics;
+}
+
+/**
+ * @brief  Zähler und Höchstwert zurücksetzen, die aktuelle Obergrenze bleibt
+ */
+void Thermal_ResetStats(void) {
+	Thermal_Stats *s = &Thermal_Statistics;
+
+	s->samples = 0;
+	s->errors = 0;
+	s->dieMax = s->die;
+	s->throttles = 0;
+	s->releases = 0;
+	s->throttledMs = 0;
+}
+
+/**
+ * @brief  Temperaturen, Obergrenze und Drosselungen über printf
+ */
+void Thermal_Dump(void) {
+	const Thermal_Stats *s = &Thermal_Statistics;
+	char die[12], dieMax[12], ambient[12];
+
+	if (!Thermal_Ready) {
+		printf("Temperatursensor nicht eingerichtet (ADC2)\n");
+		return;
+	}
+	printf("Chip %s °C (max %s °C), VDDA %u mV, %lu Messungen, %lu Fehler\n",
+			Thermal_Format(die, sizeof(die), s->die), Thermal_Format(dieMax, sizeof(dieMax), s->dieMax),
+			s->vddaMv, s->samples, s->errors);
+	if (s->ambient != THERMAL_NO_AMBIENT)
+		printf("Umgebung %s °C (AHT20)\n", Thermal_Format(ambient, sizeof(ambient), s->ambient));
+	else
+		printf("Umgebung: noch keine Messung des AHT20\n");
+	printf("Obergrenze %s, %lu x gedrosselt, %lu x freigegeben, %lu ms gedrosselt\n",
+			Clock_Profiles[s->ceiling].name, s->throttles, s->releases, (uint32_t)s->throttledMs);
+	printf("Schwellen: Chip %d / %d °C, Umgebung %d °C, Hysterese %d °C\n", THERMAL_DIE_BALANCED / 100,
+			THERMAL_DIE_LOW_POWER / 100, THERMAL_AMBIENT_BALANCED / 100, THERMAL_HYSTERESIS / 100);
+}
+
+/**
+ * @brief  Timer-Callback: Ergebnis der letzten Wandlung übernehmen, die nächste starten, Obergrenze prüfen
+ */
+static void Thermal_Tick(void *context) {
+	Thermal_Stats *s = &Thermal_Statistics;
+	uint32_t now = HAL_GetTick();
+
+	if (s->ceiling != CLOCK_PROFILE_MAX)
+		s->throttledMs += now - Thermal_LastTick;
+	Thermal_LastTick = now;
+
+	if (__HAL_ADC_GET_FLAG(&Thermal_Adc, ADC_FLAG_EOC)) {
+		uint32_t raw = HAL_ADC_GetValue(&Thermal_Adc);
+
+		if (Thermal_Channel == ADC_CHANNEL_VREFINT) {
+			if (raw != 0)
+				s->vddaMv = (uint16_t)__HAL_ADC_CALC_VREFANALOG_VOLTAGE(raw, ADC_RESOLUTION_16B);
+		} else {
+			// Like __LL_ADC_CALC_TEMPERATURE(), in 0.01 °C instead of whole degrees
+			int32_t scaled = (int32_t)(raw * s->vddaMv / TEMPSENSOR_CAL_VREFANALOG);
+			int32_t cal1 = (int32_t)*TEMPSENSOR_CAL1_ADDR;
+			int32_t cal2 = (int32_t)*TEMPSENSOR_CAL2_ADDR;
+			if (cal2 != cal1) {
+				s->die = (int16_t)((scaled - cal1) * (TEMPSENSOR_CAL2_TEMP - TEMPSENSOR_CAL1_TEMP) * 100
+						/ (cal2 - cal1) + TEMPSENSOR_CAL1_TEMP * 100);
+				if (s->die > s->dieMax) s->dieMax = s->die;
+				s->samples++;
+			}
+		}
+		// SQR1 may change while no conversion runs; paths and sampling time stay from Thermal_Init()
+		Thermal_Channel = Thermal_Channel == ADC_CHANNEL_VREFINT ? ADC_CHANNEL_TEMPSENSOR : ADC_CHANNEL_VREFINT;
+		LL_ADC_REG_SetSequencerRanks(Thermal_Adc.Instance, LL_ADC_REG_RANK_1, Thermal_Channel);
+	}
+	if (!LL_ADC_REG_IsConversionOngoing(Thermal_Adc.Instance) && HAL_ADC_Start(&Thermal_Adc) != HAL_OK)
+		s->errors++;
+
+	Topic_Climate climate;
+	if (Topic_Read(TOPIC_CLIMATE, &climate, sizeof(climate), &Thermal_ClimateSequence))
+		s->ambient = climate.temperatureFiltered;
+
+	if (s->samples == 0)
+		return;
+
+	Clock_Profile ceiling = Thermal_Evaluate(s->ceiling);
+	if (ceiling == s->ceiling)
+		return;
+
+	if (ceiling < s->ceiling) {
+		s->throttles++;
+		LOG("Thermal: gedrosselt auf %s, Chip %.1f °C, Umgebung %.1f °C\n", Clock_Profiles[ceiling].name,
+				s->die / 100.0f, s->ambient == THERMAL_NO_AMBIENT ? 0.0f : s->ambient / 100.0f);
+	} else {
+		s->releases++;
+		LOG("Thermal: Obergrenze wieder %s, Chip %.1f °C\n", Clock_Profiles[ceiling].name, s->die / 100.0f);
+	}
+	s->ceiling = ceiling;
+	Governor_SetCeiling(ceiling);
+}
+
+/**
+ * @brief  Obergrenze aus den aktuellen Werten; höher nur mit THERMAL_HYSTERESIS Abstand zur Schwelle
+ */
+static Clock_Profile Thermal_Evaluate(Clock_Profile ceiling) {
+	const Thermal_Stats *s = &Thermal_Statistics;
+	int16_t ambient = s->ambient;
+
+	// Limit reached right now
+	Clock_Profile hot = CLOCK_PROFILE_MAX;
+	if (s->die >= THERMAL_DIE_BALANCED || (ambient != THERMAL_NO_AMBIENT && ambient >= THERMAL_AMBIENT_BALANCED))
+		hot = CLOCK_PROFILE_BALANCED;
+	if (s->die >= THERMAL_DIE_LOW_POWER)
+		hot = CLOCK_PROFILE_LOW_POWER;
+	if (hot <= ceiling)
+		return hot;
+
+	// Raising the limit needs the same check with thresholds lowered by the hysteresis
+	Clock_Profile cool = CLOCK_PROFILE_MAX;
+	if (s->die >= THERMAL_DIE_BALANCED - THERMAL_HYSTERESIS
+			|| (ambient != THERMAL_NO_AMBIENT && ambient >= THERMAL_AMBIENT_BALANCED - THERMAL_HYSTERESIS))
+		cool = CLOCK_PROFILE_BALANCED;
+	if (s->die >= THERMAL_DIE_LOW_POWER - THERMAL_HYSTERESIS)
+		cool = CLOCK_PROFILE_LOW_POWER;
+	return cool > ceiling ? cool : ceiling;
+}
+
+/**
+ * @brief  0,01 °C als Text mit zwei Nachkommastellen, auch unter 0 °C
+ */
+static const char* Thermal_Format(char *buffer, uint32_t size, int16_t centi) {
+	int32_t value = centi;
+	const char *sign = value < 0 ? "-" : "";
+
+	if (value < 0) value = -value;
+	snprintf(buffer, size, "%s%ld.%02ld", sign, value / 100, value % 100);
+	return buffer;
+}
+
+#endif /* THERMAL_ENABLE */
@@ -0,0 +1,446 @@
+/**
+ * @file    Thumb.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Vorschaubilder für Bilder auf der SD-Karte mit Cache im RAM und in einer Datei
+ *
+ * Ein Bildbrowser zeigt eine Seite kleiner Vorschauen. Dafür jedes Bild ganz zu lesen und
+ * zu dekodieren kostet bei 320x240 150 KB Lesezugriff je Bild. Thumb_Get() macht das nur
+ * beim ersten Mal: Das Bild wird zeilenweise gelesen (RGB565 roh oder CIMG über den
+ * Streaming-Dekoder) und dabei per Mittelwert über die überdeckten Pixel auf höchstens
+ * THUMB_WIDTH x THUMB_HEIGHT verkleinert. Die skalierte Ausgabe (ILI9341_Scale.c) braucht
+ * das ganze Bild im Speicher und tastet beim starken Verkleinern nur einzelne Pixel ab,
+ * der Mittelwert kommt mit einer Summe je Spalte aus und glättet.
+ *
+ * Das Ergebnis landet in THUMB_FILE: Pro Hash des Pfads gibt es einen festen Platz aus
+ * ganzen Sektoren, beim Anlegen wird die Datei zusammenhängend reserviert (f_expand). Der
+ * Platz enthält Pfad-Hash, Änderungszeit und Länge des Originals; ändert sich das Bild,
+ * passt der Schlüssel nicht mehr und das Vorschaubild entsteht neu. Kollisionen verdrängen
+ * sich gegenseitig, die Datei bleibt so bei THUMB_FILE_SLOTS Plätzen begrenzt.
+ *
+ * Darüber liegen THUMB_RAM_ENTRIES Vorschaubilder im RAM, verdrängt wird das am längsten
+ * nicht benutzte. Ein Treffer dort kostet nur das f_stat() für den Schlüssel.
+ *
+ * FIL-Objekte und Lesepuffer kommen aus Arena_Frame und werden vor dem Rücksprung
+ * zurückgegeben.
+ */
+
+#include "Thumb.h"
+#include "ILI9341.h"
+#include "ILI9341_Image.h"
+#include "SDCard.h"
+#include "Arena.h"
+#include "Cache.h"
+#include "Timebase.h"
+#include "ff.h"
+#include <string.h>
+#include <stdio.h>
+
+#define THUMB_PIXEL_BYTES  ((uint32_t)THUMB_WIDTH * THUMB_HEIGHT * 2)
+
+/**
+ * @brief Kopf eines Platzes in THUMB_FILE und Schlüssel eines Eintrags im RAM (32 Bytes)
+ */
+typedef struct {
+	uint32_t magic;              // THUMB_MAGIC
+	uint32_t hash;               // Pfad und angegebene Größe roher Bilder
+	uint32_t time;               // Änderungszeit des Originals, fdate << 16 | ftime
+	uint32_t size;               // Länge des Originals in Bytes
+	uint16_t width;              // Größe des Vorschaubilds
+	uint16_t height;
+	uint32_t reserved[3];
+} Thumb_Header;
+
+/* Platz in THUMB_FILE: Kopf und Pixel, auf ganze Sektoren aufgerundet */
+#define THUMB_SLOT_SIZE    (((uint32_t)sizeof(Thumb_Header) + THUMB_PIXEL_BYTES + 511) / 512 * 512)
+
+/**
+ * @brief Verkleinern beim Lesen: Summen der Farbkanäle je Spalte des Vorschaubilds
+ */
+typedef struct {
+	uint8_t *out;
+	uint16_t srcWidth;
+	uint16_t srcHeight;
+	uint16_t width;
+	uint16_t height;
+	uint16_t row;                // Nächste Zeile des Vorschaubilds
+	uint32_t sum[3][THUMB_WIDTH];
+} Thumb_Scaler;
+
+typedef struct {
+	Thumb_Header key;
+	uint32_t used;               // Thumb_Clock beim letzten Zugriff
+} Thumb_Entry;
+
+static Thumb_Entry Thumb_Entries[THUMB_RAM_ENTRIES];
+static uint8_t Thumb_Pixels[THUMB_RAM_ENTRIES][THUMB_PIXEL_BYTES] AXI_BUFFER;
+static uint32_t Thumb_Clock;
+static Thumb_Scaler Thumb_Scale;
+static Thumb_Stats Thumb_Statistics;
+
+static uint32_t Thumb_Hash(const char *path, uint16_t width, uint16_t height);
+static uint8_t Thumb_ReadSlot(FIL *cache, const Thumb_Header *key, uint8_t *pixels, Thumb_Header *found);
+static uint8_t Thumb_WriteSlot(FIL *cache, const Thumb_Header *key, const uint8_t *pixels);
+static uint8_t Thumb_Generate(const char *path, uint16_t width, uint16_t height, uint8_t *pixels, Thumb_Header *key);
+static void Thumb_Setup(Thumb_Scaler *s, uint16_t srcWidth, uint16_t srcHeight, uint8_t *out);
+static void Thumb_Rows(void *context, uint16_t row, uint16_t count, const uint8_t *pixels);
+static uint8_t Thumb_ReadRaw(FIL *file, Thumb_Scaler *s);
+
+/**
+ * @brief  Zeichnet das Vorschaubild eines Bildes, mittig in einem Feld von THUMB_WIDTH x THUMB_HEIGHT
+ *
+ * Der Rest des Feldes wird nicht gezeichnet (Bilder mit anderem Seitenverhältnis).
+ *
+ * @param  path          Bilddatei auf der SD-Karte, CIMG oder rohes RGB565
+ * @param  width, height Größe roher RGB565-Dateien; bei CIMG 0 (steht im Kopf)
+ * @param  x, y          Obere linke Ecke des Feldes
+ * @retval 1 bei Erfolg, sonst 0
+ */
+uint8_t Thumb_Draw(const char *path, uint16_t width, uint16_t height, uint16_t x, uint16_t y) {
+	uint16_t thumbWidth, thumbHeight;
+	const uint8_t *pixels = Thumb_Get(path, width, height, &thumbWidth, &thumbHeight);
+	if (pixels == NULL) {
+		return 0;
+	}
+
+	ILI9341_DrawImage(x + (THUMB_WIDTH - thumbWidth) / 2, y + (THUMB_HEIGHT - thumbHeight) / 2,
+	                  thumbWidth, thumbHeight, pixels);
+	return 1;
+}
+
+/**
+ * @brief  Liefert das Vorschaubild eines Bildes aus dem RAM, der Cache-Datei oder neu erzeugt
+ *
+ * @param  path          Bilddatei auf der SD-Karte, CIMG oder rohes RGB565
+ * @param  width, height Größe roher RGB565-Dateien; bei CIMG 0 (steht im Kopf)
+ * @param  thumbWidth, thumbHeight Erhalten die Größe des Vorschaubilds
+ * @retval RGB565-Pixel (High-Byte zuerst) bis zum THUMB_RAM_ENTRIES-ten weiteren Aufruf gültig, NULL bei Fehlern
+ */
+const uint8_t* Thumb_Get(const char *path, uint16_t width, uint16_t height, uint16_t *thumbWidth, uint16_t *thumbHeight) {
+	if (SDCard_Acquire() == NULL) {
+		Thumb_Statistics.failures++;
+		return NULL;
+	}
+
+	uint64_t start = Timebase_Us();
+	FILINFO info;
+	FRESULT res = f_stat(path, &info);
+	if (res != FR_OK) {
+		SDCard_CheckResult(res);
+		SDCard_Release();
+		Thumb_Statistics.failures++;
+		return NULL;
+	}
+
+	Thumb_Header key = {
+		.magic = THUMB_MAGIC,
+		.hash = Thumb_Hash(path, width, height),
+		.time = ((uint32_t)info.fdate << 16) | info.ftime,
+		.size = (uint32_t)info.fsize,
+	};
+
+	// RAM first, otherwise the least recently used entry is replaced
+	uint8_t victim = 0;
+	for (uint8_t i = 0; i < THUMB_RAM_ENTRIES; i++) {
+		Thumb_Header *k = &Thumb_Entries[i].key;
+		if (k->magic == THUMB_MAGIC && k->hash == key.hash && k->time == key.time && k->size == key.size) {
+			Thumb_Entries[i].used = ++Thumb_Clock;
+			*thumbWidth = k->width;
+			*thumbHeight = k->height;
+			Thumb_Statistics.ramHits++;
+			Thumb_Statistics.lastUs = (uint32_t)(Timebase_Us() - start);
+			SDCard_Release();
+			return Thumb_Pixels[i];
+		}
+		if (Thumb_Entries[i].used < Thumb_Entries[victim].used) {
+			victim = i;
+		}
+	}
+
+	Thumb_Entry *entry = &Thumb_Entries[victim];
+	uint8_t *pixels = Thumb_Pixels[victim];
+	entry->key.magic = 0;
+
+	Arena_Mark mark = Arena_GetMark(&Arena_Frame);
+	FIL *cache = Arena_Alloc(&Arena_Frame, sizeof(FIL), 0);
+	uint8_t cached = 0, ok = 0;
+	if (cache != NULL) {
+		memset(cache, 0, sizeof(FIL));
+		res = f_open(cache, THUMB_FILE, FA_READ | FA_WRITE | FA_OPEN_ALWAYS);
+		if (res == FR_OK && f_size(cache) == 0) {
+			// Contiguous on the card; if that fails the file grows slot by slot
+			f_expand(cache, (FSIZE_t)THUMB_FILE_SLOTS * THUMB_SLOT_SIZE, 1);
+		}
+		cached = res == FR_OK;
+		SDCard_CheckResult(res);
+	}
+
+	if (cached && Thumb_ReadSlot(cache, &key, pixels, &entry->key)) {
+		Thumb_Statistics.fileHits++;
+		ok = 1;
+		Thumb_Statistics.lastUs = (uint32_t)(Timebase_Us() - start);
+		if (Thumb_Statistics.lastUs > Thumb_Statistics.maxFileUs) {
+			Thumb_Statistics.maxFileUs = Thumb_Statistics.lastUs;
+		}
+	} else if (cache != NULL && Thumb_Generate(path, width, height, pixels, &key)) {
+		entry->key = key;
+		Thumb_Statistics.generated++;
+		ok = 1;
+		if (!cached || !Thumb_WriteSlot(cache, &key, pixels)) {
+			Thumb_Statistics.failures++;
+		}
+		Thumb_Statistics.lastUs = (uint32_t)(Timebase_Us() - start);
+		if (Thumb_Statistics.lastUs > Thumb_Statistics.maxGenerateUs) {
+			Thumb_Statistics.maxGenerateUs = Thumb_Statistics.lastUs;
+		}
+	} else {
+		printf("No thumbnail for %s\n", path);
+		Thumb_Statistics.failures++;
+	}
+
+	if (cached) {
+		f_close(cache);
+	}
+	Arena_Release(&Arena_Frame, mark);
+	SDCard_Release();
+	if (!ok) {
+		return NULL;
+	}
+
+	entry->used = ++Thumb_Clock;
+	*thumbWidth = entry->key.width;
+	*thumbHeight = entry->key.height;
+	return pixels;
+}
+
+/**
+ * @brief  Verwirft die Vorschaubilder im RAM; die Cache-Datei bleibt (löschen mit f_unlink(THUMB_FILE))
+ */
+void Thumb_Clear(void) {
+	memset(Thumb_Entries, 0, sizeof(Thumb_Entries));
+	Thumb_Clock = 0;
+}
+
+/**
+ * @brief  Zähler des Caches
+ */
+const Thumb_Stats* Thumb_GetStats(void) {
+	return &Thumb_Statistics;
+}
+
+/**
+ * @brief  Gibt Treffer, erzeugte Vorschaubilder und Zeiten aus
+ */
+void Thumb_Dump(void) {
+	const Thumb_Stats *s = &Thumb_Statistics;
+	uint8_t used = 0;
+
+	for (uint8_t i = 0; i < THUMB_RAM_ENTRIES; i++) {
+		used += Thumb_Entries[i].key.magic == THUMB_MAGIC;
+	}
+	printf("Vorschaubilder %ux%u: %u/%u im RAM, %u Plätze in %s (%lu KB)\n", THUMB_WIDTH, THUMB_HEIGHT,
+			used, THUMB_RAM_ENTRIES, THUMB_FILE_SLOTS, THUMB_FILE,
+			(unsigned long)(THUMB_FILE_SLOTS * THUMB_SLOT_SIZE / 1024U));
+	printf("%lu Treffer RAM, %lu Treffer Datei, %lu erzeugt, %lu Fehler\n", (unsigned long)s->ramHits,
+			(unsigned long)s->fileHits, (unsigned long)s->generated, (unsigned long)s->failures);
+	printf("Zuletzt %lu us, Datei max %lu us, Erzeugen max %lu us\n", (unsigned long)s->lastUs,
+			(unsigned long)s->maxFileUs, (unsigned long)s->maxGenerateUs);
+}
+
+/**
+ * @brief  FNV-1a über den Pfad und die angegebene Größe (verschiedene Größen derselben rohen Datei)
+ */
+static uint32_t Thumb_Hash(const char *path, uint16_t width, uint16_t height) {
+	uint32_t hash = 2166136261UL;
+	uint8_t size[4] = { width, width >> 8, height, height >> 8 };
+
+	while (*path) {
+		hash ^= (uint8_t)*path++;
+		hash *= 16777619UL;
+	}
+	for (uint8_t i = 0; i < sizeof(size); i++) {
+		hash ^= size[i];
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+/**
+ * @brief  Liest den Platz zum Schlüssel, wenn er dasselbe Original beschreibt
+ * @param  found Erhält den Kopf mit der Größe des Vorschaubilds
+ */
+static uint8_t Thumb_ReadSlot(FIL *cache, const Thumb_Header *key, uint8_t *pixels, Thumb_Header *found) {
+	FSIZE_t offset = (FSIZE_t)(key->hash % THUMB_FILE_SLOTS) * THUMB_SLOT_SIZE;
+	Thumb_Header header;
+	UINT bytes;
+
+	if (offset + THUMB_SLOT_SIZE > f_size(cache) || f_lseek(cache, offset) != FR_OK ||
+	    f_read(cache, &header, sizeof(header), &bytes) != FR_OK || bytes != sizeof(header)) {
+		return 0;
+	}
+	if (header.magic != THUMB_MAGIC || header.hash != key->hash || header.time != key->time ||
+	    header.size != key->size || header.width == 0 || header.width > THUMB_WIDTH ||
+	    header.height == 0 || header.height > THUMB_HEIGHT) {
+		return 0;
+	}
+
+	uint32_t length = (uint32_t)header.width * header.height * 2;
+	if (f_read(cache, pixels, length, &bytes) != FR_OK || bytes != length) {
+		return 0;
+	}
+	*found = header;
+	return 1;
+}
+
+/**
+ * @brief  Schreibt ein Vorschaubild auf seinen Platz (verdrängt ein anderes mit gleichem Platz)
+ */
+static uint8_t Thumb_WriteSlot(FIL *cache, const Thumb_Header *key, const uint8_t *pixels) {
+	FSIZE_t offset = (FSIZE_t)(key->hash % THUMB_FILE_SLOTS) * THUMB_SLOT_SIZE;
+	uint32_t length = (uint32_t)key->width * key->height * 2;
+	UINT bytes;
+
+	// Past the end of a file that is not yet expanded, f_lseek() grows it
+	if (f_lseek(cache, offset) != FR_OK ||
+	    f_write(cache, key, sizeof(*key), &bytes) != FR_OK || bytes != sizeof(*key) ||
+	    f_write(cache, pixels, length, &bytes) != FR_OK || bytes != length) {
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Liest das Original und verkleinert es nach pixels, setzt die Größe in key
+ */
+static uint8_t Thumb_Generate(const char *path, uint16_t width, uint16_t height, uint8_t *pixels, Thumb_Header *key) {
+	FIL *file = Arena_Alloc(&Arena_Frame, sizeof(FIL), 0);
+	ILI9341_ImageHeader header;
+	UINT bytes;
+	uint8_t ok = 0;
+
+	if (file == NULL) {
+		printf("Not enough arena memory for thumbnail\n");
+		return 0;
+	}
+	memset(file, 0, sizeof(FIL));
+	FRESULT res = f_open(file, path, FA_READ);
+	if (res != FR_OK) {
+		SDCard_CheckResult(res);
+		return 0;
+	}
+
+	res = f_read(file, &header, sizeof(header), &bytes);
+	if (res == FR_OK && bytes == sizeof(header) && header.magic == ILI9341_IMAGE_MAGIC) {
+		Thumb_Setup(&Thumb_Scale, header.width, header.height, pixels);
+		ok = f_lseek(file, 0) == FR_OK && header.width > 0 && header.height > 0 &&
+		     ILI9341_DecodeCompressedStream(file, &header, Thumb_Rows, &Thumb_Scale);
+	} else if (res == FR_OK && width > 0 && height > 0 && f_size(file) >= (FSIZE_t)width * height * 2) {
+		Thumb_Setup(&Thumb_Scale, width, height, pixels);
+		ok = f_lseek(file, 0) == FR_OK && Thumb_ReadRaw(file, &Thumb_Scale);
+	}
+	f_close(file);
+
+	ok = ok && Thumb_Scale.row == Thumb_Scale.height;
+	key->width = Thumb_Scale.width;
+	key->height = Thumb_Scale.height;
+	return ok;
+}
+
+/**
+ * @brief  Bestimmt die Größe des Vorschaubilds (Seitenverhältnis bleibt, nie größer als das Original)
+ */
+static void Thumb_Setup(Thumb_Scaler *s, uint16_t srcWidth, uint16_t srcHeight, uint8_t *out) {
+	memset(s, 0, sizeof(*s));
+	s->out = out;
+	s->srcWidth = srcWidth;
+	s->srcHeight = srcHeight;
+	if (srcWidth == 0 || srcHeight == 0) {
+		return;
+	}
+
+	uint32_t width = THUMB_WIDTH, height = THUMB_HEIGHT;
+	if ((uint32_t)srcWidth * THUMB_HEIGHT >= (uint32_t)srcHeight * THUMB_WIDTH) {
+		height = (uint32_t)srcHeight * THUMB_WIDTH / srcWidth;
+	} else {
+		width = (uint32_t)srcWidth * THUMB_HEIGHT / srcHeight;
+	}
+	if (width > srcWidth) width = srcWidth;
+	if (height > srcHeight) height = srcHeight;
+	s->width = width ? width : 1;
+	s->height = height ? height : 1;
+}
+
+/**
+ * @brief  Nimmt Zeilen des Originals auf; ist eine Zeile des Vorschaubilds voll, wird sie geschrieben
+ *
+ * Spalte tx des Vorschaubilds überdeckt die Pixel tx * srcWidth / width bis vor
+ * (tx + 1) * srcWidth / width, für Zeilen ebenso.
+ */
+static void Thumb_Rows(void *context, uint16_t row, uint16_t count, const uint8_t *pixels) {
+	Thumb_Scaler *s = context;
+
+	for (uint16_t i = 0; i < count && s->row < s->height; i++, pixels += (uint32_t)s->srcWidth * 2) {
+		uint16_t x = 0;
+		for (uint16_t tx = 0; tx < s->width; tx++) {
+			uint16_t end = (uint32_t)(tx + 1) * s->srcWidth / s->width;
+			uint32_t r = 0, g = 0, b = 0;
+			for (; x < end; x++) {
+				uint16_t c = (uint16_t)((pixels[x * 2] << 8) | pixels[x * 2 + 1]);
+				r += c >> 11;
+				g += (c >> 5) & 0x3F;
+				b += c & 0x1F;
+			}
+			s->sum[0][tx] += r;
+			s->sum[1][tx] += g;
+			s->sum[2][tx] += b;
+		}
+
+		uint16_t first = (uint32_t)s->row * s->srcHeight / s->height;
+		uint16_t last = (uint32_t)(s->row + 1) * s->srcHeight / s->height;
+		if ((uint16_t)(row + i + 1) != last) {
+			continue;
+		}
+
+		// Row of the thumbnail complete: average of the covered pixels
+		uint8_t *out = s->out + (uint32_t)s->row * s->width * 2;
+		for (uint16_t tx = 0; tx < s->width; tx++) {
+			uint32_t n = ((uint32_t)(tx + 1) * s->srcWidth / s->width - (uint32_t)tx * s->srcWidth / s->width)
+			           * (last - first);
+			uint16_t c = (uint16_t)(((s->sum[0][tx] + n / 2) / n) << 11 |
+			                        ((s->sum[1][tx] + n / 2) / n) << 5 |
+			                        ((s->sum[2][tx] + n / 2) / n));
+			out[tx * 2] = c >> 8;
+			out[tx * 2 + 1] = c & 0xFF;
+			s->sum[0][tx] = s->sum[1][tx] = s->sum[2][tx] = 0;
+		}
+		s->row++;
+	}
+}
+
+/**
+ * @brief  Liest ein rohes RGB565-Bild in Blöcken aus ganzen Zeilen
+ */
+static uint8_t Thumb_ReadRaw(FIL *file, Thumb_Scaler *s) {
+	uint32_t rowBytes = (uint32_t)s->srcWidth * 2;
+	uint16_t rows = ILI9341_IMAGE_INPUT_SIZE / rowBytes;
+	if (rows == 0) {
+		printf("Image too wide for thumbnail\n");
+		return 0;
+	}
+
+	uint8_t *buffer = Arena_Alloc(&Arena_Frame, rows * rowBytes, CACHE_LINE_SIZE);
+	if (buffer == NULL) {
+		printf("Not enough arena memory for thumbnail\n");
+		return 0;
+	}
+
+	for (uint16_t row = 0; row < s->srcHeight; row += rows) {
+		uint16_t count = s->srcHeight - row < rows ? s->srcHeight - row : rows;
+		UINT bytes;
+		if (f_read(file, buffer, count * rowBytes, &bytes) != FR_OK || bytes != count * rowBytes) {
+			return 0;
+		}
+		Thumb_Rows(s, row, count, buffer);
+	}
+	return 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file    Timebase.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Monotone 64-Bit-Zeitbasis in Mikrosekunden aus dem freilaufenden TIM5
+ *
+ * HAL_GetTick() löst nur Millisekunden auf, DWT->CYCCNT läuft bei 280 MHz nach 15 s über und
+ * ändert seine Rate mit jedem Taktprofil. TIM5 zählt dagegen unabhängig vom Kerntakt mit 1 MHz
+ * über den vollen 32-Bit-Bereich; der Überlauf-Interrupt zählt das obere Wort weiter.
+ *
+ * Timebase_Us() liest ohne Sperre, auch aus Interrupts jeder Priorität:
+ * - Oberes Wort, Zähler, Überlauf-Flag lesen und wiederholen, falls sich das obere Wort
+ *   dazwischen geändert hat (der Überlauf-Interrupt lief).
+ * - Steht das Flag noch an, weil der Interrupt noch nicht laufen konnte (der Leser hat eine
+ *   höhere Priorität oder sperrt die Interrupts), gehört ein kleiner Zählerstand schon zum
+ *   nächsten Umlauf. Ein großer wurde vor dem Überlauf gelesen und bleibt beim alten Wort.
+ * Das gilt, solange der Überlauf-Interrupt innerhalb eines halben Umlaufs (35 min) drankommt.
+ *
+ * Nach einem Taktwechsel setzt Timebase_ClockChanged() den Vorteiler neu, ohne dass die Zeit
+ * springt; zwischen Umschalten der PLL und diesem Aufruf zählt TIM5 kurz mit der falschen Rate.
+ * Im Stop-Modus steht TIM5; Timebase_Advance() rückt die Zeit danach um die verschlafene Dauer vor.
+ */
+
+#include "Timebase.h"
+
+/* Umläufe des 32-Bit-Zählers, oberes Wort der Zeitbasis */
+static volatile uint32_t Timebase_High = 0;
+
+static uint8_t Timebase_Ready = 0;
+
+static uint32_t Timebase_Prescaler(void);
+
+/**
+ * @brief  Startet TIM5 als freilaufenden 1-MHz-Zähler mit Überlauf-Interrupt
+ *
+ * Direkt über die Register, CubeMX kennt TIM5 in diesem Projekt nicht. Vor allen Nutzern der
+ * Zeitbasis aufrufen (Eingaben, Sensor-Log, Telemetrie), nach Irq_Init().
+ */
+void Timebase_Init(void) {
+	__HAL_RCC_TIM5_CLK_ENABLE();
+
+	TIM5->CR1 = TIM_CR1_URS;          // UG below must not raise the overflow interrupt
+	TIM5->PSC = Timebase_Prescaler();
+	TIM5->ARR = 0xFFFFFFFFUL;
+	TIM5->CNT = 0;
+	TIM5->EGR = TIM_EGR_UG;           // load PSC now, not at the first overflow
+	TIM5->SR = 0;
+	TIM5->DIER = TIM_DIER_UIE;
+
+	Timebase_High = 0;
+	Timebase_Ready = 1;
+
+	// Priority from Irq_Plan (Irq_Init())
+	HAL_NVIC_EnableIRQ(TIM5_IRQn);
+
+	TIM5->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief  Mikrosekunden seit Timebase_Init(), monoton, ohne Sperre
+ */
+RAMFUNC uint64_t Timebase_Us(void) {
+	uint32_t high;
+	uint32_t count;
+	uint32_t pending;
+
+	do {
+		high = Timebase_High;
+		count = TIM5->CNT;
+		pending = TIM5->SR & TIM_SR_UIF;
+	} while (high != Timebase_High);
+
+	if (pending && count < 0x80000000UL) {
+		high++;
+	}
+	return ((uint64_t)high << 32) | count;
+}
+
+/**
+ * @brief  Passt den Vorteiler nach einem Taktwechsel an, aus Clock_ReinitPeripherals()
+ *
+ * Ein neuer Vorteiler gilt erst ab dem nächsten Update-Ereignis; das Ereignis per UG setzt
+ * aber auch den Zähler auf 0. Der Stand wird deshalb vorher gesichert und danach zurückgeschrieben,
+ * das obere Wort bleibt, wie es ist (URS: UG löst keinen Überlauf aus).
+ */
+void Timebase_ClockChanged(void) {
+	if (!Timebase_Ready) {
+		return;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint64_t now = Timebase_Us();
+	if (TIM5->SR & TIM_SR_UIF) {
+		// Overflow not yet counted: do it here, clearing the flag below would lose it
+		Timebase_High++;
+		TIM5->SR = ~TIM_SR_UIF;
+	}
+
+	TIM5->PSC = Timebase_Prescaler();
+	TIM5->EGR = TIM_EGR_UG;
+	TIM5->CNT = (uint32_t)now;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Rückt die Zeitbasis um us vor, nach dem Stop-Modus (LowPower.c), in dem TIM5 nicht zählt
+ *
+ * Überläuft der Zähler dabei, zählt das obere Wort hier weiter, wie in Timebase_ClockChanged().
+ */
+void Timebase_Advance(uint32_t us) {
+	if (!Timebase_Ready) {
+		return;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint64_t now = Timebase_Us() + us;
+	if (TIM5->SR & TIM_SR_UIF) {
+		TIM5->SR = ~TIM_SR_UIF;
+	}
+	Timebase_High = (uint32_t)(now >> 32);
+	TIM5->CNT = (uint32_t)now;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Überlauf von TIM5: oberes Wort weiterzählen
+ *
+ * Wort und Flag ändern sich gemeinsam unter gesperrten Interrupts, sonst sähe ein Leser
+ * höherer Priorität dazwischen entweder das neue Wort mit Flag (doppelt gezählt) oder das
+ * alte ohne Flag (Zeit springt zurück).
+ */
+void TIM5_IRQHandler(void) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (TIM5->SR & TIM_SR_UIF) {
+		Timebase_High++;
+		TIM5->SR = ~TIM_SR_UIF;
+		__DSB();
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/* --------------------------------- Intern --------------------------------- */
+
+/**
+ * @brief  PSC-Wert für TIMEBASE_HZ aus dem aktuellen APB1-Timertakt, wie in MX_TIM7_Init()
+ */
+static uint32_t Timebase_Prescaler(void) {
+	uint8_t CDPPRE1 = (RCC->CDCFGR2 & (0b111<<6))>>6;
+	uint32_t timer_clock_hz = HAL_RCC_GetPCLK1Freq() * (CDPPRE1 == 0 ? 1 : 2);
+
+	return timer_clock_hz / TIMEBASE_HZ - 1;
+}
@@ -0,0 +1,359 @@
+/**
+ * @file    Timer.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Software-Timer in einem hierarchischen Timer-Rad, getaktet vom 1-ms-Tick von TIM7
+ *
+ * Das Rad hat TIMER_WHEEL_LEVELS Stufen zu TIMER_WHEEL_SLOTS Fächern. Stufe 0 löst eine
+ * Millisekunde auf, jede höhere Stufe das 64-fache der darunter. Ein Timer kommt in die
+ * Stufe, deren Reichweite seine Restzeit abdeckt, und dort in das Fach seines Ablaufzeitpunkts.
+ * Läuft Stufe 0 einmal herum, werden die Timer des nächsten Fachs der Stufe 1 neu einsortiert
+ * (und so weiter nach oben); sie landen dabei in einer tieferen Stufe, zuletzt in Stufe 0.
+ *
+ * Die Fächer sind einfach verkettete Listen mit Rückzeiger (pprev) im Timer selbst:
+ * - Start und Stopp hängen einen Timer in konstanter Zeit ein bzw. aus,
+ * - je Millisekunde wird genau ein Fach der Stufe 0 geleert, die Weitergabe aus den höheren
+ *   Stufen verteilt sich auf seltene Zeitpunkte,
+ * - die Zahl der Timer ist nur durch den Speicher der Aufrufer begrenzt.
+ *
+ * Timer_Tick() läuft im TIM7-Interrupt (Realtime_Loop()) und hängt abgelaufene Timer nur in
+ * eine Liste, dann gibt es den Timer-Task frei (Scheduler_Release()). Die Callbacks laufen dort,
+ * also wie alle Tasks ohne Unterbrechung durch andere Tasks und ohne Sperren. Periodische
+ * Timer werden vor dem Callback ab ihrem geplanten Zeitpunkt neu eingehängt, die Periode
+ * driftet also nicht mit der Latenz des Tasks; lief der Task mehr als eine Periode zu spät,
+ * werden die verpassten Abläufe als 'late' gezählt und nicht nachgeholt.
+ *
+ * Im Tickless-Betrieb begrenzt Timer_TimeToNext() den Schlaf in Realtime_Sleep() auf den
+ * nächsten belegten Eintrag in Stufe 0 bzw. die nächste Weitergabe aus einer höheren Stufe.
+ */
+
+#include "Timer.h"
+#include "Scheduler.h"
+#include <stdio.h>
+
+static Timer *Timer_Wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static uint64_t Timer_Occupied[TIMER_WHEEL_LEVELS];   // bit n = slot n not empty
+static volatile uint32_t Timer_Clock = 0;             // last millisecond handled by the wheel
+
+static Timer *Timer_PendingHead = NULL;               // expired, callback not yet run (FIFO)
+static Timer **Timer_PendingTail = &Timer_PendingHead;
+static uint32_t Timer_PendingCount = 0;
+
+static uint8_t Timer_TaskId = SCHEDULER_INVALID_TASK;
+static Timer_Stats Timer_Statistics;
+
+static void Timer_Insert(Timer *timer);
+static void Timer_Detach(Timer *timer);
+static void Timer_Step(void);
+static void Timer_Cascade(uint8_t level, uint32_t slot);
+
+/**
+ * @brief  Merkt sich den Task, der die Callbacks ausführt
+ * @param  taskId: mit Scheduler_AddTask() registrierter Task, der Timer_Task() aufruft
+ */
+void Timer_Init(uint8_t taskId) {
+	Timer_TaskId = taskId;
+}
+
+/**
+ * @brief  Bereitet einen Timer vor, vor dem ersten Timer_Start() und nur im Zustand IDLE
+ * @param  name: für Fehlersuche im Debugger, darf NULL sein
+ */
+void Timer_Setup(Timer *timer, const char *name, Timer_Callback callback, void *context) {
+	timer->next = NULL;
+	timer->pprev = NULL;
+	timer->expires = 0;
+	timer->periodMs = 0;
+	timer->callback = callback;
+	timer->context = context;
+	timer->name = name;
+	timer->state = TIMER_STATE_IDLE;
+	timer->runs = 0;
+	timer->late = 0;
+}
+
+/**
+ * @brief  Startet einen Timer bzw. startet ihn neu, auch aus einem Callback oder Interrupt
+ * @param  delayMs: Zeit bis zum ersten Ablauf, 0 wird zu 1 (nächster Tick)
+ * @param  periodMs: Abstand der weiteren Abläufe, 0 = einmalig
+ */
+RAMFUNC void Timer_Start(Timer *timer, uint32_t delayMs, uint32_t periodMs) {
+	uint32_t primask = __get_PRIMASK();
+
+	if (delayMs == 0) delayMs = 1;
+
+	__disable_irq();
+	if (timer->state != TIMER_STATE_IDLE) {
+		Timer_Detach(timer);
+	} else if (++Timer_Statistics.active > Timer_Statistics.maxActive) {
+		Timer_Statistics.maxActive = Timer_Statistics.active;
+	}
+	timer->expires = Timer_Clock + delayMs;
+	timer->periodMs = periodMs;
+	timer->state = TIMER_STATE_ARMED;
+	Timer_Insert(timer);
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Hält einen Timer an; ein schon abgelaufener, noch nicht ausgeführter Callback entfällt
+ */
+RAMFUNC void Timer_Stop(Timer *timer) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (timer->state != TIMER_STATE_IDLE) {
+		Timer_Detach(timer);
+		timer->state = TIMER_STATE_IDLE;
+		Timer_Statistics.active--;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt an, ob der Timer läuft oder sein Callback noch aussteht
+ */
+uint8_t Timer_IsActive(const Timer *timer) {
+	return timer->state != TIMER_STATE_IDLE;
+}
+
+/**
+ * @brief  Millisekunden bis zum nächsten Ablauf, 0 wenn angehalten oder schon abgelaufen
+ */
+uint32_t Timer_Remaining(const Timer *timer) {
+	if (timer->state != TIMER_STATE_ARMED)
+		return 0;
+
+	int32_t remaining = (int32_t)(timer->expires - Timer_Clock);
+	return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+/**
+ * @brief  Millisekunden seit Realtime_Init(), der Zeitbezug aller Timer
+ */
+uint32_t Timer_Now(void) {
+	return Timer_Clock;
+}
+
+/**
+ * @brief  Dreht das Rad weiter, wird aus dem TIM7-Interrupt aufgerufen
+ * @param  elapsedMs: Millisekunden seit dem letzten Aufruf (1, nach Realtime_Sleep() mehr)
+ */
+RAMFUNC void Timer_Tick(uint32_t elapsedMs) {
+	if (Timer_Statistics.active == 0) {
+		// Nothing to move, only the time base follows
+		Timer_Clock += elapsedMs;
+		return;
+	}
+
+	uint32_t pending = Timer_PendingCount;
+	for (uint32_t i = 0; i < elapsedMs; i++)
+		Timer_Step();
+
+	if (Timer_PendingCount != pending)
+		Scheduler_Release(Timer_TaskId);
+}
+
+/**
+ * @brief  Scheduler-Task: führt die Callbacks aller abgelaufenen Timer in Ablaufreihenfolge aus
+ */
+void Timer_Task(void *context) {
+	for (;;) {
+		__disable_irq();
+		Timer *timer = Timer_PendingHead;
+		if (timer == NULL) {
+			__enable_irq();
+			break;
+		}
+
+		Timer_Detach(timer);
+		if (timer->periodMs != 0) {
+			// From the planned expiry, so the period does not drift with the task latency
+			timer->expires += timer->periodMs;
+			if ((int32_t)(timer->expires - Timer_Clock) <= 0) {
+				uint32_t missed = (Timer_Clock - timer->expires) / timer->periodMs + 1;
+				timer->expires += missed * timer->periodMs;
+				timer->late += missed;
+				Timer_Statistics.late += missed;
+			}
+			timer->state = TIMER_STATE_ARMED;
+			Timer_Insert(timer);
+		} else {
+			timer->state = TIMER_STATE_IDLE;
+			Timer_Statistics.active--;
+		}
+		Timer_Callback callback = timer->callback;
+		void *callbackContext = timer->context;
+		timer->runs++;
+		__enable_irq();
+
+		// The callback may stop or restart its own timer
+		callback(callbackContext);
+		Timer_Statistics.dispatched++;
+	}
+}
+
+/**
+ * @brief  Millisekunden, die das Rad ohne Tick auskommt, höchstens limitMs
+ *
+ * Mit gesperrten Interrupts aufrufen (Realtime_Sleep()). Abgelaufene Timer zählen nicht, deren
+ * Task ist dann schon bereit und der Scheduler schläft gar nicht erst.
+ * @retval 1 bis limitMs
+ */
+uint32_t Timer_TimeToNext(uint32_t limitMs) {
+	uint32_t next = limitMs;
+	uint32_t now = Timer_Clock;
+
+	if (Timer_Statistics.active == 0)
+		return limitMs;
+
+	uint64_t occupied = Timer_Occupied[0];
+	if (occupied != 0) {
+		// Rotate so that bit 0 is the slot of the next millisecond
+		uint32_t first = (now + 1) & TIMER_WHEEL_MASK;
+		uint64_t rotated = first ? (occupied >> first) | (occupied << (TIMER_WHEEL_SLOTS - first)) : occupied;
+		uint32_t distance = (uint32_t)__builtin_ctzll(rotated) + 1;
+		if (distance < next) next = distance;
+	}
+
+	for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		if (Timer_Occupied[level] != 0) {
+			uint32_t cascade = TIMER_WHEEL_SLOTS - (now & TIMER_WHEEL_MASK);
+			if (cascade < next) next = cascade;
+			break;
+		}
+	}
+
+	return next > 0 ? next : 1;
+}
+
+/**
+ * @brief  Zähler des Timer-Rads
+ */
+const Timer_Stats* Timer_GetStats(void) {
+	return &Timer_Statistics;
+}
+
+/**
+ * @brief  Gibt die Zähler und die Belegung der Stufen über printf aus
+ */
+void Timer_Dump(void) {
+	const Timer_Stats *s = &Timer_Statistics;
+
+	printf("Timer-Rad bei %lu ms: %lu aktiv (max. %lu), %lu abgelaufen, %lu ausgeführt\n",
+			Timer_Clock, s->active, s->maxActive, s->expired, s->dispatched);
+	printf("Weitergereicht %lu, verspätete Perioden %lu, längste Warteliste %lu\n",
+			s->cascaded, s->late, s->maxPending);
+	for (uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		printf("Stufe %u (%lu ms je Fach): %u von %lu Fächern belegt\n", level,
+				1UL << (level * TIMER_WHEEL_BITS), __builtin_popcountll(Timer_Occupied[level]),
+				TIMER_WHEEL_SLOTS);
+	}
+}
+
+/**
+ * @brief  Hängt einen Timer nach seiner Restzeit in ein Fach ein (Interrupts gesperrt)
+ */
+RAMFUNC static void Timer_Insert(Timer *timer) {
+	uint32_t when = timer->expires;
+	uint32_t delta = when - Timer_Clock;
+	uint8_t level = 0;
+
+	// Beyond the range: park at the far end of the top level, re-sorted from there by the cascade
+	if (delta >= TIMER_WHEEL_RANGE_MS) {
+		delta = TIMER_WHEEL_RANGE_MS - 1;
+		when = Timer_Clock + delta;
+	}
+	while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1))))
+		level++;
+
+	uint32_t slot = (when >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+	Timer **head = &Timer_Wheel[level][slot];
+
+	timer->next = *head;
+	if (timer->next != NULL)
+		timer->next->pprev = &timer->next;
+	timer->pprev = head;
+	*head = timer;
+	Timer_Occupied[level] |= 1ULL << slot;
+}
+
+/**
+ * @brief  Hängt einen Timer aus seinem Fach bzw. der Warteliste aus (Interrupts gesperrt)
+ */
+RAMFUNC static void Timer_Detach(Timer *timer) {
+	Timer **pprev = timer->pprev;
+
+	if (timer->state == TIMER_STATE_PENDING) {
+		if (Timer_PendingTail == &timer->next)
+			Timer_PendingTail = pprev;
+		Timer_PendingCount--;
+	}
+
+	*pprev = timer->next;
+	if (timer->next != NULL)
+		timer->next->pprev = pprev;
+	timer->next = NULL;
+	timer->pprev = NULL;
+
+	// Emptied a slot head: clear its bit
+	Timer **first = &Timer_Wheel[0][0];
+	if (pprev >= first && pprev < first + TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS && *pprev == NULL) {
+		uint32_t index = (uint32_t)(pprev - first);
+		Timer_Occupied[index / TIMER_WHEEL_SLOTS] &= ~(1ULL << (index % TIMER_WHEEL_SLOTS));
+	}
+}
+
+/**
+ * @brief  Eine Millisekunde: höhere Stufen weiterreichen, dann das Fach der Stufe 0 leeren
+ */
+RAMFUNC static void Timer_Step(void) {
+	uint32_t now = ++Timer_Clock;
+
+	for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		if (now & ((1UL << (TIMER_WHEEL_BITS * level)) - 1))
+			break;
+		Timer_Cascade(level, (now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+	}
+
+	uint32_t slot = now & TIMER_WHEEL_MASK;
+	Timer *timer = Timer_Wheel[0][slot];
+	if (timer == NULL)
+		return;
+
+	Timer_Wheel[0][slot] = NULL;
+	Timer_Occupied[0] &= ~(1ULL << slot);
+
+	while (timer != NULL) {
+		Timer *next = timer->next;
+
+		// Append to the pending list, the callback runs in Timer_Task()
+		timer->next = NULL;
+		timer->pprev = Timer_PendingTail;
+		*Timer_PendingTail = timer;
+		Timer_PendingTail = &timer->next;
+		timer->state = TIMER_STATE_PENDING;
+
+		Timer_Statistics.expired++;
+		if (++Timer_PendingCount > Timer_Statistics.maxPending)
+			Timer_Statistics.maxPending = Timer_PendingCount;
+		timer = next;
+	}
+}
+
+/**
+ * @brief  Sortiert alle Timer eines Fachs einer höheren Stufe nach ihrer Restzeit neu ein
+ */
+RAMFUNC static void Timer_Cascade(uint8_t level, uint32_t slot) {
+	Timer *timer = Timer_Wheel[level][slot];
+
+	Timer_Wheel[level][slot] = NULL;
+	Timer_Occupied[level] &= ~(1ULL << slot);
+
+	while (timer != NULL) {
+		Timer *next = timer->next;
+		Timer_Insert(timer);
+		Timer_Statistics.cascaded++;
+		timer = next;
+	}
+}
@@ -0,0 +1,245 @@
+/**
+ * @file    Topic.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Messwerte ohne Kopie verteilen: je Art ein Topic mit einem Erzeuger und beliebig vielen Lesern
+ *
+ * Jedes Topic hat zwei Plätze. Der Erzeuger schreibt immer in den Platz, der gerade nicht der
+ * aktuelle ist, und zwar direkt (Topic_BeginPublish() liefert den Zeiger), dann gibt
+ * Topic_EndPublish() ihn mit einer neuen Sequenznummer frei. Leser bekommen mit Topic_Peek()
+ * einen Zeiger auf den aktuellen Platz und lesen dort, ohne zu kopieren und ohne Sperre. Danach
+ * prüft Topic_Valid(), ob die Sequenznummer des Platzes noch dieselbe ist; ist sie es nicht, hat
+ * der Erzeuger in der Zwischenzeit zweimal veröffentlicht und den Platz überschrieben, und der
+ * Leser versucht es noch einmal (Topic_Read() macht das für kleine Werte mit Kopie).
+ *
+ * Je Topic darf nur ein Kontext veröffentlichen: TOPIC_POTI der TIM7-Tick, TOPIC_CLIMATE der
+ * AHT20-Task, TOPIC_INPUT der Erzeuger von UserInput, TOPIC_GAMEPAD UART4 und
+ * TIM7 (gleiche Stufe). Leser dürfen auf jeder Stufe laufen.
+ *
+ * Mit Topic_Subscribe() angemeldete Tasks gibt jede Veröffentlichung über Scheduler_Release()
+ * frei, statt dass sie in ihrer Periode nachsehen müssen.
+ */
+
+#include "Topic.h"
+#include "Scheduler.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Versuche von Topic_Read(), bevor es aufgibt (nur bei sehr langsamen Lesern) */
+#define TOPIC_READ_RETRIES        3
+
+typedef union {
+	Topic_Poti poti;
+	Topic_Climate climate;
+	Topic_Input input;
+	Topic_Gamepad gamepad;
+} Topic_Payload;
+
+typedef struct {
+	Topic_Payload slot[2];
+	volatile uint32_t slotSequence[2];   // 0, solange der Erzeuger den Platz beschreibt
+	volatile uint32_t published;         // Sequenznummer des aktuellen Platzes
+	uint8_t current;                     // Index des aktuellen Platzes, nur der Erzeuger liest ihn
+	uint8_t subscriberCount;
+	uint8_t subscriber[TOPIC_MAX_SUBSCRIBERS];
+	uint32_t retries;                    // Lesevorgänge, die der Erzeuger überholt hat
+} Topic_Data;
+
+static Topic_Data Topic_Table[TOPIC_COUNT];
+
+static const char *const Topic_Names[TOPIC_COUNT] = {
+	[TOPIC_POTI]    = "poti",
+	[TOPIC_CLIMATE] = "climate",
+	[TOPIC_INPUT]   = "input",
+	[TOPIC_GAMEPAD] = "gamepad",
+};
+
+static int8_t Topic_SlotOf(const Topic_Data *t, uint32_t sequence);
+
+/**
+ * @brief  Liefert den freien Platz eines Topics zum Beschreiben
+ *
+ * Der Platz enthält noch den vorletzten Wert; wer nur einen Teil ändert, muss den Rest selbst
+ * übernehmen. Bis Topic_EndPublish() sehen Leser weiter den alten Wert.
+ * @retval Zeiger auf den Platz (Topic_Poti/Topic_Climate/Topic_Input je nach Topic)
+ */
+RAMFUNC void* Topic_BeginPublish(Topic_Id topic) {
+	Topic_Data *t = &Topic_Table[topic];
+	uint8_t next = t->current ^ 1;
+
+	// A reader still holding this slot must see it invalid before the first byte changes
+	t->slotSequence[next] = TOPIC_NO_DATA;
+	__DMB();
+	return &t->slot[next];
+}
+
+/**
+ * @brief  Gibt den mit Topic_BeginPublish() beschriebenen Platz frei und weckt die Abonnenten
+ */
+RAMFUNC void Topic_EndPublish(Topic_Id topic) {
+	Topic_Data *t = &Topic_Table[topic];
+	uint8_t next = t->current ^ 1;
+	uint32_t sequence = t->published + 1;
+
+	if (sequence == TOPIC_NO_DATA)
+		sequence++;
+
+	// Slot contents, then its number, then the topic's number
+	__DMB();
+	t->slotSequence[next] = sequence;
+	__DMB();
+	t->current = next;
+	t->published = sequence;
+
+	for (uint8_t i = 0; i < t->subscriberCount; i++) {
+		Scheduler_Release(t->subscriber[i]);
+	}
+}
+
+/**
+ * @brief  Veröffentlicht einen fertigen Wert mit einer Kopie (für Erzeuger, die ihn ohnehin lokal haben)
+ */
+void Topic_Publish(Topic_Id topic, const void *data, uint32_t size) {
+	if (size > sizeof(Topic_Payload))
+		size = sizeof(Topic_Payload);
+
+	memcpy(Topic_BeginPublish(topic), data, size);
+	Topic_EndPublish(topic);
+}
+
+/**
+ * @brief  Meldet einen Task an, den jede Veröffentlichung des Topics freigibt
+ * @retval 1 bei Erfolg, 0 wenn schon TOPIC_MAX_SUBSCRIBERS angemeldet sind
+ */
+uint8_t Topic_Subscribe(Topic_Id topic, uint8_t taskId) {
+	Topic_Data *t = &Topic_Table[topic];
+	uint32_t primask = __get_PRIMASK();
+	uint8_t ok = 0;
+
+	__disable_irq();
+	if (t->subscriberCount < TOPIC_MAX_SUBSCRIBERS) {
+		t->subscriber[t->subscriberCount] = taskId;
+		t->subscriberCount++;
+		ok = 1;
+	}
+	__set_PRIMASK(primask);
+
+	return ok;
+}
+
+/**
+ * @brief  Zeigt auf den aktuellen Wert eines Topics, ohne ihn zu kopieren
+ *
+ * Nach dem Lesen mit Topic_Valid() prüfen, ob der Erzeuger den Platz inzwischen überschrieben hat.
+ * @retval Sequenznummer des Werts, TOPIC_NO_DATA wenn noch nichts veröffentlicht wurde
+ */
+uint32_t Topic_Peek(Topic_Id topic, Topic_View *view) {
+	Topic_Data *t = &Topic_Table[topic];
+	uint32_t sequence;
+	int8_t slot;
+
+	do {
+		sequence = t->published;
+		__DMB();
+		slot = Topic_SlotOf(t, sequence);
+		// -1: two publishes since reading 'published', take the newer one
+	} while (sequence != TOPIC_NO_DATA && slot < 0);
+
+	view->topic = topic;
+	view->sequence = sequence;
+	view->data = sequence != TOPIC_NO_DATA ? &t->slot[slot] : NULL;
+	return sequence;
+}
+
+/**
+ * @brief  Prüft nach dem Lesen, ob der Wert hinter view->data noch unverändert war
+ * @retval 1, wenn alles Gelesene zusammengehört, 0 wenn neu lesen
+ */
+uint8_t Topic_Valid(const Topic_View *view) {
+	Topic_Data *t = &Topic_Table[view->topic];
+
+	if (view->sequence == TOPIC_NO_DATA)
+		return 0;
+
+	// Reads of the payload must be done before the number is compared
+	__DMB();
+	uint8_t slot = view->data == &t->slot[1];
+	if (t->slotSequence[slot] == view->sequence)
+		return 1;
+
+	t->retries++;
+	return 0;
+}
+
+/**
+ * @brief  Wie Topic_Peek(), aber nur, wenn seit *lastSequence etwas Neues kam
+ * @param  lastSequence: zuletzt gesehene Nummer des Lesers (0 am Anfang), wird aktualisiert
+ * @retval 1, wenn view auf einen neuen Wert zeigt
+ */
+uint8_t Topic_Changed(Topic_Id topic, uint32_t *lastSequence, Topic_View *view) {
+	uint32_t sequence = Topic_Peek(topic, view);
+
+	if (sequence == TOPIC_NO_DATA || sequence == *lastSequence)
+		return 0;
+
+	*lastSequence = sequence;
+	return 1;
+}
+
+/**
+ * @brief  Kopiert einen neuen Wert, liest nach, falls der Erzeuger dazwischen kam
+ * @param  lastSequence: zuletzt gesehene Nummer des Lesers, NULL = immer den aktuellen Wert kopieren
+ * @retval 1, wenn data einen neuen, zusammenhängenden Wert enthält
+ */
+uint8_t Topic_Read(Topic_Id topic, void *data, uint32_t size, uint32_t *lastSequence) {
+	uint32_t seen = lastSequence != NULL ? *lastSequence : TOPIC_NO_DATA;
+	Topic_View view;
+
+	if (size > sizeof(Topic_Payload))
+		size = sizeof(Topic_Payload);
+
+	for (uint8_t i = 0; i < TOPIC_READ_RETRIES; i++) {
+		uint32_t sequence = Topic_Peek(topic, &view);
+		if (sequence == TOPIC_NO_DATA || (lastSequence != NULL && sequence == seen))
+			return 0;
+
+		memcpy(data, view.data, size);
+		if (Topic_Valid(&view)) {
+			if (lastSequence != NULL)
+				*lastSequence = sequence;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  Aktuelle Sequenznummer, entspricht der Anzahl der Veröffentlichungen
+ */
+uint32_t Topic_GetSequence(Topic_Id topic) {
+	return Topic_Table[topic].published;
+}
+
+/**
+ * @brief  Gibt Veröffentlichungen, Abonnenten und wiederholte Lesevorgänge aller Topics aus
+ */
+void Topic_Dump(void) {
+	printf("%-8s %10s %5s %8s\n", "Topic", "Werte", "Abo", "Wiederh.");
+	for (uint8_t i = 0; i < TOPIC_COUNT; i++) {
+		const Topic_Data *t = &Topic_Table[i];
+		printf("%-8s %10lu %5u %8lu\n", Topic_Names[i], t->published, t->subscriberCount, t->retries);
+	}
+}
+
+/**
+ * @brief  Sucht den Platz mit der Sequenznummer
+ * @retval 0 oder 1, -1 wenn keiner sie (noch) trägt
+ */
+static int8_t Topic_SlotOf(const Topic_Data *t, uint32_t sequence) {
+	if (t->slotSequence[0] == sequence)
+		return 0;
+	if (t->slotSequence[1] == sequence)
+		return 1;
+	return -1;
+}
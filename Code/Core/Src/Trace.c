@@ -0,0 +1,259 @@
+/**
+ * @file    Trace.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Ereignis-Trace über ITM und SWO: Interrupts, Scheduler-Tasks und eigene Marken
+ *
+ * printf über UART7 kostet je Zeile mehr Zeit, als die meisten gemessenen Abschnitte dauern.
+ * Das ITM schreibt dagegen ein Byte in seinen FIFO und ist fertig; den Rest erledigt die
+ * Hardware am SWO-Pin (PB3, NRZ mit TRACE_SWO_HZ), gelesen vom Debug-Probe (ST-Link SWV,
+ * J-Link, Orbuculum). Tools/trace_decode.py wandelt den Mitschnitt in eine Zeitleiste.
+ *
+ * Die Art des Ereignisses steckt im Stimulus-Port (Trace.h), der Inhalt ist meist ein Byte.
+ * Ein Ereignis kostet damit ein 2-Byte-Paket auf der Leitung und wenige Takte im Handler. Die
+ * Zeitstempel erzeugt das ITM selbst als lokale Zeitstempel im CPU-Takt, wie DWT->CYCCNT,
+ * aber als Differenzen: ein Überlauf nach 15 s wie bei CYCCNT spielt für den Decoder keine Rolle.
+ *
+ * Ist der FIFO voll, verwirft Trace_Put8() das Ereignis und zählt es (Trace_Dropped), statt zu
+ * warten; ein Trace verändert die gemessenen Zeiten also höchstens um die wenigen Takte je
+ * Ereignis. Namen und Takt sendet Trace_Start() dagegen wartend, außerhalb der Messung.
+ *
+ * Trace_SetPcSampling() lässt zusätzlich das DWT in festen Abständen den Programmzähler senden
+ * (Hardware-Pakete, Diskriminator 2). Tools/tcm_place.py zählt daraus die Treffer je Funktion,
+ * die Grundlage für die Platzierung heißer Funktionen im ITCM.
+ *
+ * SWO-Pfad des H7B0 (RM0455, Debug-Infrastruktur): ITM -> Trace-Funnel (SWTF) -> SWO-Einheit.
+ * Deren Takt ist pll1_r_ck; der Vorteiler wird nach jedem Taktwechsel neu gesetzt (Trace_Clock()).
+ */
+
+#include "Trace.h"
+
+#if TRACE_ENABLE
+
+#include "Irq.h"
+#include "Scheduler.h"
+#include <stdio.h>
+
+/* CoreSight-Register der SWO-Einheit und des Funnels, nicht im CMSIS-Header */
+#define TRACE_SWO_BASE            0x5C003000UL
+#define TRACE_SWTF_BASE           0x5C004000UL
+#define TRACE_SWO_CODR            (*(volatile uint32_t *)(TRACE_SWO_BASE + 0x010))
+#define TRACE_SWO_SPPR            (*(volatile uint32_t *)(TRACE_SWO_BASE + 0x0F0))
+#define TRACE_SWO_LAR             (*(volatile uint32_t *)(TRACE_SWO_BASE + 0xFB0))
+#define TRACE_SWTF_CTRL           (*(volatile uint32_t *)(TRACE_SWTF_BASE + 0x000))
+#define TRACE_SWTF_LAR            (*(volatile uint32_t *)(TRACE_SWTF_BASE + 0xFB0))
+
+#define TRACE_UNLOCK              0xC5ACCE55UL
+#define TRACE_SPPR_NRZ            2
+#define TRACE_SWTF_ENS0           (1UL << 0)        // funnel port 0 = ITM of the M7
+
+/* Höchste Wartezeit auf den FIFO bei wartendem Schreiben, danach wird abgeschaltet */
+#define TRACE_WAIT_MS             2
+
+/* Ports, die der Decoder kennt */
+#define TRACE_PORT_MASK           ((1UL << (TRACE_PORT_CLOCK + 1)) - 1)
+
+volatile uint8_t Trace_On = 0;
+volatile uint32_t Trace_Dropped = 0;
+
+static const char *Trace_MarkNames[TRACE_MARK_COUNT];
+static uint32_t Trace_Starts = 0;
+static uint8_t Trace_PcSampling = 0;
+
+static uint8_t Trace_Wait(uint8_t port);
+static void Trace_Name(uint8_t kind, uint8_t id, const char *name);
+static uint32_t Trace_ClockHz(void);
+static void Trace_SetPrescaler(void);
+
+/**
+ * @brief  Legt PB3 auf TRACESWO; das ITM bleibt aus bis Trace_Start()
+ */
+void Trace_Init(void) {
+	GPIO_InitTypeDef gpio = { 0 };
+
+	__HAL_RCC_GPIOB_CLK_ENABLE();
+	gpio.Pin = GPIO_PIN_3;
+	gpio.Mode = GPIO_MODE_AF_PP;
+	gpio.Pull = GPIO_NOPULL;
+	gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	gpio.Alternate = GPIO_AF0_TRACE;
+	HAL_GPIO_Init(GPIOB, &gpio);
+
+	Trace_On = 0;
+	Trace_Dropped = 0;
+}
+
+/**
+ * @brief  Schaltet Takt, SWO und ITM ein, sendet Takt und alle Namen, danach laufen die Ereignisse
+ */
+void Trace_Start(void) {
+	Trace_On = 0;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DBGMCU->CR |= DBGMCU_CR_DBG_TRACECKEN | DBGMCU_CR_DBG_CKCDEN | DBGMCU_CR_DBG_CKSRDEN;
+
+	TRACE_SWO_LAR = TRACE_UNLOCK;
+	TRACE_SWO_SPPR = TRACE_SPPR_NRZ;
+	Trace_SetPrescaler();
+
+	TRACE_SWTF_LAR = TRACE_UNLOCK;
+	TRACE_SWTF_CTRL |= TRACE_SWTF_ENS0;
+
+	// Local timestamps in CPU cycles (SWOENA = 0, no prescaler), no DWT packets
+	ITM->LAR = TRACE_UNLOCK;
+	ITM->TCR = 0;
+	ITM->TPR = 0;
+	ITM->TCR = (1UL << ITM_TCR_TraceBusID_Pos) | ITM_TCR_TSENA_Msk | ITM_TCR_ITMENA_Msk;
+	ITM->TER = TRACE_PORT_MASK;
+
+	Trace_Dropped = 0;
+	Trace_Starts++;
+	Trace_On = 1;
+
+	Trace_Clock();
+#if IRQ_STAT_ENABLE
+	for (uint8_t i = 0; i < IRQ_ID_COUNT; i++)
+		Trace_Name(TRACE_NAME_ISR, i, Irq_GetName((Irq_Id)i));
+#endif
+	for (uint8_t i = 0; i < Scheduler_GetTaskCount(); i++)
+		Trace_Name(TRACE_NAME_TASK, i, Scheduler_Tasks[i].name);
+	for (uint8_t i = 0; i < TRACE_MARK_COUNT; i++)
+		Trace_Name(TRACE_NAME_MARK, i, Trace_MarkNames[i]);
+}
+
+/**
+ * @brief  Hält den Trace an und schaltet den Trace-Takt wieder ab
+ */
+void Trace_Stop(void) {
+	Trace_On = 0;
+
+	// Let the FIFO drain before the clock goes
+	Trace_Wait(TRACE_PORT_TEXT);
+	Trace_SetPcSampling(0);
+	ITM->TER = 0;
+	ITM->TCR &= ~ITM_TCR_ITMENA_Msk;
+	DBGMCU->CR &= ~DBGMCU_CR_DBG_TRACECKEN;
+}
+
+/**
+ * @brief  Vorteiler nach einem Taktwechsel, meldet dem Decoder den neuen Takt der Zeitstempel
+ */
+void Trace_Clock(void) {
+	if (!Trace_On)
+		return;
+
+	Trace_SetPrescaler();
+	if (Trace_Wait(TRACE_PORT_CLOCK))
+		ITM->PORT[TRACE_PORT_CLOCK].u32 = SystemCoreClock;
+}
+
+/**
+ * @brief  Schaltet die PC-Abtastung des DWT ein oder aus, nur bei laufendem Trace
+ *
+ * Die Pakete laufen durch denselben FIFO wie die Ereignisse; bei voller Leitung verwirft das ITM
+ * sie und meldet einen Überlauf, die Ereignisse selbst bleiben davon unberührt.
+ */
+void Trace_SetPcSampling(uint8_t enable) {
+	if (enable && !Trace_On)
+		return;
+
+	if (enable) {
+		uint32_t ctrl = DWT->CTRL & ~(DWT_CTRL_POSTPRESET_Msk | DWT_CTRL_POSTINIT_Msk | DWT_CTRL_PCSAMPLENA_Msk);
+
+		DWT->CTRL = ctrl | DWT_CTRL_CYCTAP_Msk | (TRACE_PC_POSTPRESET << DWT_CTRL_POSTPRESET_Pos);
+		ITM->TCR |= ITM_TCR_DWTENA_Msk;
+		DWT->CTRL |= DWT_CTRL_PCSAMPLENA_Msk;
+	} else {
+		DWT->CTRL &= ~DWT_CTRL_PCSAMPLENA_Msk;
+		ITM->TCR &= ~ITM_TCR_DWTENA_Msk;
+	}
+	Trace_PcSampling = enable;
+}
+
+/**
+ * @brief  Name einer Marke für den Decoder, gilt ab dem nächsten Trace_Start() bzw. sofort
+ * @param  name: muss erhalten bleiben (Literal), NULL löscht den Namen
+ */
+void Trace_SetMarkName(uint8_t id, const char *name) {
+	if (id >= TRACE_MARK_COUNT)
+		return;
+
+	Trace_MarkNames[id] = name;
+	Trace_Name(TRACE_NAME_MARK, id, name);
+}
+
+/**
+ * @brief  Text in den Trace (Port 0), wartend; nicht aus Interrupts aufrufen
+ */
+void Trace_Print(const char *text) {
+	for (; Trace_On && *text; text++) {
+		if (!Trace_Wait(TRACE_PORT_TEXT))
+			return;
+		ITM->PORT[TRACE_PORT_TEXT].u8 = (uint8_t)*text;
+	}
+}
+
+/**
+ * @brief  Zustand über printf
+ */
+void Trace_Dump(void) {
+	printf("Trace: %s, %lu mal gestartet, SWO %lu Bit/s an PB3, Trace-Takt %lu Hz\n",
+			Trace_On ? "an" : "aus", Trace_Starts, TRACE_SWO_HZ, Trace_ClockHz());
+	printf("  verworfen (FIFO voll): %lu\n", Trace_Dropped);
+	printf("  PC-Abtastung: %s, alle %lu Takte\n", Trace_PcSampling ? "an" : "aus",
+			(TRACE_PC_POSTPRESET + 1UL) * 1024UL);
+}
+
+/* --------------------------------- Intern --------------------------------- */
+
+/**
+ * @brief  Wartet auf Platz im FIFO, höchstens TRACE_WAIT_MS; ohne Abnehmer am SWO-Pin läuft
+ *         der FIFO trotzdem leer, hängen kann es nur ohne Trace-Takt
+ * @retval 1 bei Platz, sonst 0 (Trace wird abgeschaltet)
+ */
+static uint8_t Trace_Wait(uint8_t port) {
+	uint32_t start = DWT->CYCCNT;
+	uint32_t limit = TRACE_WAIT_MS * (SystemCoreClock / 1000UL);
+
+	while (ITM->PORT[port].u32 == 0) {
+		if (DWT->CYCCNT - start > limit) {
+			Trace_On = 0;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief  Namenssatz: Art, Nummer, Zeichen, 0
+ */
+static void Trace_Name(uint8_t kind, uint8_t id, const char *name) {
+	if (!Trace_On || name == NULL)
+		return;
+
+	uint8_t head[2] = { kind, id };
+	for (uint8_t i = 0; i < 2; i++) {
+		if (!Trace_Wait(TRACE_PORT_NAME)) return;
+		ITM->PORT[TRACE_PORT_NAME].u8 = head[i];
+	}
+	do {
+		if (!Trace_Wait(TRACE_PORT_NAME)) return;
+		ITM->PORT[TRACE_PORT_NAME].u8 = (uint8_t)*name;
+	} while (*name++ != '\0');
+}
+
+/**
+ * @brief  Takt der SWO-Einheit (pll1_r_ck), ohne PLL der Kerntakt
+ */
+static uint32_t Trace_ClockHz(void) {
+	PLL1_ClocksTypeDef pll;
+
+	HAL_RCCEx_GetPLL1ClockFreq(&pll);
+	return pll.PLL1_R_Frequency ? pll.PLL1_R_Frequency : SystemCoreClock;
+}
+
+static void Trace_SetPrescaler(void) {
+	TRACE_SWO_CODR = Trace_ClockHz() / TRACE_SWO_HZ - 1;
+}
+
+#endif /* TRACE_ENABLE */
@@ -0,0 +1,382 @@
+/**
+ * @file    Update.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Firmware-Update über zwei Slots im W25Qxx und einen Programmierer im ITCM
+ *
+ * Ein Abbild kommt mit Kopf (Update_Header, Tools/update_pack.py) über CAN-FD (CanTp), die
+ * Shell-UART oder von der SD-Karte; Update_Feed() nimmt es in beliebig großen Stücken an.
+ * Jede volle Seite wird sofort in den Slot programmiert, der nicht die laufende Firmware
+ * enthält. Gelöscht hat den Slot da meist schon der Löschpool (FlashPool.c): Update_Begin()
+ * meldet ihn dort an, und solange die Verbindung langsamer als 45 KB/s ist, bleibt das Löschen
+ * vor den Daten. Holt der Empfang den Pool ein, löscht Update_Feed() den Sektor selbst
+ * (Update_Status.stalls).
+ *
+ * Update_Finish() rechnet die CRC-32 mit der CRC-Einheit über das Memory-Mapped-Fenster und
+ * prüft Stackzeiger und Reset-Vektor. Erst danach wird der Kopf in den ersten Sektor des Slots
+ * geschrieben; ein Slot mit gültigem Kopf ist also immer vollständig.
+ *
+ * Update_Apply() merkt sich den Slot im FlashKV, sperrt alle Interrupts und springt in
+ * Update_Program() im ITCM. Das löscht und programmiert den internen Flash direkt über die
+ * Register, liest dabei aus dem Fenster und löst danach einen Reset aus. Kein Code im
+ * internen Flash wird währenddessen ausgeführt. Der andere Slot behält die vorige Firmware,
+ * 'update apply n' programmiert sie zurück.
+ */
+
+#include "Update.h"
+#include "W25Qxx_QSPI.h"
+#include "FlashPool.h"
+#include "FlashKV.h"
+#include "Crc32.h"
+#include "Cache.h"
+#include "octospi.h"
+#include "ff.h"
+#include <string.h>
+
+/* Programmiereinheit im W25Qxx und Löschsektor, an dem der Pool gefragt wird */
+#define UPDATE_PAGE_SIZE          256UL
+#define UPDATE_SECTOR_SIZE        4096UL
+
+/* Stück je f_read() bei Update_FromFile() */
+#define UPDATE_FILE_CHUNK         4096UL
+
+/* Bereich für den Stackzeiger im Vektor 0 (DTCM bis Ende AXI-SRAM) */
+#define UPDATE_STACK_MIN          0x20000000UL
+#define UPDATE_STACK_MAX          0x24100000UL
+
+#if UPDATE_SLOT_BASE + UPDATE_SLOT_COUNT * UPDATE_SLOT_SIZE > OCTOSPI1_TUNE_ADDRESS
+#error "Update-Slots überlappen das Prüfmuster des Bus-Tunings"
+#endif
+
+static Update_Status Update_Current = { .state = UPDATE_IDLE, .slot = UPDATE_NO_SLOT };
+static uint8_t Update_Page[UPDATE_PAGE_SIZE] AXI_BUFFER;
+static uint8_t Update_FileBuffer[UPDATE_FILE_CHUNK] AXI_BUFFER;
+
+static uint8_t Update_Fail(const char *error);
+static void Update_ProgramPage(uint32_t offset, uint32_t length);
+static uint32_t Update_ImageCrc(uint8_t slot, uint32_t size);
+RAMFUNC static void Update_Program(const uint32_t *source, uint32_t size);
+
+/**
+ * @brief  Beginnt den Empfang in den Slot, der nicht die laufende Firmware enthält
+ *
+ * Löscht den Kopf-Sektor des Slots sofort, damit ein abgebrochener Empfang keinen alten
+ * gültigen Kopf hinterlässt, und übergibt den Rest dem Löschpool.
+ *
+ * @retval 1 bereit für Update_Feed(), 0 wenn schon ein Empfang läuft
+ */
+uint8_t Update_Begin(void) {
+	if (Update_Current.state == UPDATE_RECEIVING) {
+		return 0;
+	}
+
+	uint8_t active = Update_GetActiveSlot();
+	memset(&Update_Current, 0, sizeof(Update_Current));
+	Update_Current.state = UPDATE_RECEIVING;
+	Update_Current.slot = (active == 0) ? 1 : 0;
+	Update_Current.startMs = HAL_GetTick();
+
+	uint32_t address = UPDATE_SLOT_ADDRESS(Update_Current.slot);
+	W25Qxx_WriteEnable();
+	W25Qxx_EraseSector(address);
+	FlashPool_Discard(address + UPDATE_IMAGE_OFFSET, UPDATE_IMAGE_MAX);
+	return 1;
+}
+
+/**
+ * @brief  Nimmt das nächste Stück der Übertragung an (Kopf und Abbild, lückenlos in Reihenfolge)
+ * @retval 1 angenommen, 0 bei Fehler (Update_Status.error), weitere Stücke werden verworfen
+ */
+uint8_t Update_Feed(const uint8_t *data, uint32_t length) {
+	Update_Status *status = &Update_Current;
+	if (status->state != UPDATE_RECEIVING) {
+		return 0;
+	}
+
+	while (length > 0) {
+		uint32_t chunk;
+
+		if (status->received < sizeof(Update_Header)) {
+			chunk = sizeof(Update_Header) - status->received;
+			if (chunk > length) chunk = length;
+			memcpy((uint8_t*)&status->header + status->received, data, chunk);
+			status->received += chunk;
+			data += chunk;
+			length -= chunk;
+
+			if (status->received == sizeof(Update_Header)
+					&& (status->header.magic != UPDATE_MAGIC || status->header.size == 0
+						|| status->header.size > UPDATE_IMAGE_MAX)) {
+				return Update_Fail("Kopf ungültig");
+			}
+			continue;
+		}
+
+		uint32_t offset = status->received - sizeof(Update_Header);
+		if (offset >= status->header.size) {
+			return Update_Fail("mehr Daten als im Kopf angegeben");
+		}
+		chunk = UPDATE_PAGE_SIZE - (offset % UPDATE_PAGE_SIZE);
+		if (chunk > length) chunk = length;
+		if (chunk > status->header.size - offset) chunk = status->header.size - offset;
+
+		memcpy(&Update_Page[offset % UPDATE_PAGE_SIZE], data, chunk);
+		status->received += chunk;
+		data += chunk;
+		length -= chunk;
+		offset += chunk;
+
+		// Full page or end of the image: program it right away
+		if (offset % UPDATE_PAGE_SIZE == 0 || offset == status->header.size) {
+			uint32_t start = (offset - 1) & ~(UPDATE_PAGE_SIZE - 1);
+			Update_ProgramPage(start, offset - start);
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief  Beendet den Empfang: CRC-32 und Vektortabelle prüfen, dann den Kopf in den Slot schreiben
+ * @retval 1 wenn das Abbild gültig im Slot liegt
+ */
+uint8_t Update_Finish(void) {
+	Update_Status *status = &Update_Current;
+	if (status->state != UPDATE_RECEIVING) {
+		return 0;
+	}
+	if (status->received < sizeof(Update_Header) || status->received != sizeof(Update_Header) + status->header.size) {
+		return Update_Fail("Übertragung unvollständig");
+	}
+
+	uint32_t crc = Update_ImageCrc(status->slot, status->header.size);
+	if (crc != status->header.crc) {
+		return Update_Fail("CRC-32 stimmt nicht");
+	}
+
+	uint32_t vectors[2];
+	W25Qxx_FastReadQuadOutput(UPDATE_SLOT_ADDRESS(status->slot) + UPDATE_IMAGE_OFFSET, (uint8_t*)vectors, sizeof(vectors));
+	if (vectors[0] < UPDATE_STACK_MIN || vectors[0] > UPDATE_STACK_MAX
+			|| vectors[1] < FLASH_BANK1_BASE || vectors[1] >= FLASH_BANK1_BASE + status->header.size) {
+		return Update_Fail("keine Vektortabelle am Anfang");
+	}
+
+	// The header marks the slot valid, so it is written last
+	W25Qxx_WriteEnable();
+	W25Qxx_PageProgram(UPDATE_SLOT_ADDRESS(status->slot), (uint8_t*)&status->header, sizeof(Update_Header));
+
+	status->elapsedMs = HAL_GetTick() - status->startMs;
+	status->state = UPDATE_VERIFIED;
+	return 1;
+}
+
+/**
+ * @brief  Bricht einen laufenden Empfang ab; der Slot bleibt ohne gültigen Kopf
+ */
+void Update_Abort(void) {
+	if (Update_Current.state == UPDATE_RECEIVING) {
+		Update_Fail("abgebrochen");
+	}
+}
+
+/**
+ * @brief  Liest ein Abbild im Übertragungsformat von der SD-Karte (oder Laufwerk 1:) in den freien Slot
+ * @param  path: FatFs-Pfad, z. B. "0:/firmware.fwu"
+ * @retval 1 wenn das Abbild geprüft im Slot liegt
+ */
+uint8_t Update_FromFile(const char *path) {
+	FIL file;
+	UINT read = 0;
+
+	if (Update_Current.state == UPDATE_RECEIVING) {
+		return 0;
+	}
+	if (f_open(&file, path, FA_READ) != FR_OK) {
+		Update_Current.error = "Datei nicht gefunden";
+		Update_Current.state = UPDATE_FAILED;
+		return 0;
+	}
+	Update_Begin();
+
+	do {
+		if (f_read(&file, Update_FileBuffer, UPDATE_FILE_CHUNK, &read) != FR_OK) {
+			f_close(&file);
+			return Update_Fail("Lesefehler");
+		}
+		if (!Update_Feed(Update_FileBuffer, read)) {
+			f_close(&file);
+			return 0;
+		}
+	} while (read == UPDATE_FILE_CHUNK);
+
+	f_close(&file);
+	return Update_Finish();
+}
+
+/**
+ * @brief  Liest den Kopf eines Slots und prüft die CRC-32 des Abbilds
+ * @param  header: erhält den Kopf, darf NULL sein
+ * @retval 1 wenn der Slot ein vollständiges, unbeschädigtes Abbild enthält
+ */
+uint8_t Update_ReadSlot(uint8_t slot, Update_Header *header) {
+	Update_Header local;
+
+	if (slot >= UPDATE_SLOT_COUNT) {
+		return 0;
+	}
+	if (header == NULL) {
+		header = &local;
+	}
+	W25Qxx_FastReadQuadOutput(UPDATE_SLOT_ADDRESS(slot), (uint8_t*)header, sizeof(Update_Header));
+	if (header->magic != UPDATE_MAGIC || header->size == 0 || header->size > UPDATE_IMAGE_MAX) {
+		return 0;
+	}
+	return Update_ImageCrc(slot, header->size) == header->crc;
+}
+
+/**
+ * @brief  Slot, aus dem die laufende Firmware zuletzt programmiert wurde
+ * @retval Slotnummer oder UPDATE_NO_SLOT (noch nie per Update programmiert)
+ */
+uint8_t Update_GetActiveSlot(void) {
+	uint8_t slot = UPDATE_NO_SLOT;
+
+	if (FlashKV_Get(UPDATE_KEY_ACTIVE, &slot, sizeof(slot)) != sizeof(slot) || slot >= UPDATE_SLOT_COUNT) {
+		return UPDATE_NO_SLOT;
+	}
+	return slot;
+}
+
+/**
+ * @brief  Programmiert das Abbild eines Slots in den internen Flash und startet neu
+ *
+ * Vorher werden Kopf und CRC-32 noch einmal geprüft. Danach laufen keine Interrupts mehr, der
+ * Memory-Mapped-Modus bleibt für Update_Program() eingeschaltet.
+ *
+ * @retval 0 wenn der Slot kein gültiges Abbild enthält; bei Erfolg kehrt die Funktion nicht zurück
+ */
+uint8_t Update_Apply(uint8_t slot) {
+	Update_Header header;
+
+	if (Update_Current.state == UPDATE_RECEIVING || !Update_ReadSlot(slot, &header)) {
+		return 0;
+	}
+	if (!FlashKV_Set(UPDATE_KEY_ACTIVE, &slot, sizeof(slot))) {
+		return 0;
+	}
+
+	W25Qxx_WaitReadAsync();
+	if (!W25Qxx_IsMemoryMapped() && !W25Qxx_EnableMemoryMapped()) {
+		return 0;
+	}
+
+	const uint32_t *source = (const uint32_t*)W25Qxx_MappedAddress(UPDATE_SLOT_ADDRESS(slot) + UPDATE_IMAGE_OFFSET);
+	SCB_InvalidateDCache_by_Addr((uint32_t*)source, (int32_t)UPDATE_IMAGE_MAX);
+
+	__disable_irq();
+	Update_Program(source, header.size);
+	return 0;
+}
+
+/**
+ * @brief  Stand des laufenden bzw. letzten Empfangs
+ */
+const Update_Status* Update_GetStatus(void) {
+	return &Update_Current;
+}
+
+/**
+ * @brief  Beendet den Empfang mit Fehler
+ * @retval immer 0, für return Update_Fail(...)
+ */
+static uint8_t Update_Fail(const char *error) {
+	Update_Current.state = UPDATE_FAILED;
+	Update_Current.error = error;
+	Update_Current.elapsedMs = HAL_GetTick() - Update_Current.startMs;
+	return 0;
+}
+
+/**
+ * @brief  Programmiert length Bytes aus Update_Page an offset im Abbild
+ *
+ * Am Anfang eines Sektors wird der Löschpool gefragt: hat er ihn noch nicht gelöscht, wird er
+ * aus dem Pool genommen und hier gelöscht.
+ */
+static void Update_ProgramPage(uint32_t offset, uint32_t length) {
+	uint32_t address = UPDATE_SLOT_ADDRESS(Update_Current.slot) + UPDATE_IMAGE_OFFSET + offset;
+
+	if (offset % UPDATE_SECTOR_SIZE == 0 && FlashPool_IsPending(address) && !FlashPool_Claim(address)) {
+		W25Qxx_WriteEnable();
+		W25Qxx_EraseSector(address);
+		Update_Current.stalls++;
+	}
+
+	W25Qxx_WriteEnable();
+	W25Qxx_PageProgram(address, Update_Page, length);
+}
+
+/**
+ * @brief  CRC-32 des Abbilds eines Slots, per MDMA aus dem Memory-Mapped-Fenster
+ */
+static uint32_t Update_ImageCrc(uint8_t slot, uint32_t size) {
+	uint8_t wasMapped = W25Qxx_IsMemoryMapped();
+	if (!wasMapped && !W25Qxx_EnableMemoryMapped()) {
+		return ~0UL;
+	}
+
+	const uint8_t *image = W25Qxx_MappedAddress(UPDATE_SLOT_ADDRESS(slot) + UPDATE_IMAGE_OFFSET);
+	// Pages programmed outside memory-mapped mode may still sit in the D-cache
+	SCB_InvalidateDCache_by_Addr((uint32_t*)image, (int32_t)((size + 31) & ~31UL));
+	Crc32_Init();
+	uint32_t crc = Crc32_Compute(image, size);
+
+	if (!wasMapped) {
+		W25Qxx_DisableMemoryMapped();
+	}
+	return crc;
+}
+
+/**
+ * @brief  Löscht die belegten Sektoren des internen Flashs, programmiert das Abbild und startet neu
+ *
+ * Läuft vollständig im ITCM mit gesperrten Interrupts und greift nur auf Register zu, keine
+ * HAL- oder Bibliotheksfunktion. Programmiert wird in Flash-Wörtern zu 128 Bit; hinter dem
+ * Abbild liest das letzte Wort gelöschte Bytes (0xFF) aus dem Slot.
+ *
+ * @param  source: Abbild im Memory-Mapped-Fenster, 32-Bit-ausgerichtet
+ * @param  size: Länge in Bytes, höchstens UPDATE_IMAGE_MAX
+ */
+RAMFUNC static void Update_Program(const uint32_t *source, uint32_t size) {
+	volatile uint32_t *target = (volatile uint32_t*)FLASH_BANK1_BASE;
+	uint32_t sectors = (size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE;
+	uint32_t words = ((size + 15) / 16) * FLASH_NB_32BITWORD_IN_FLASHWORD;
+
+	if (FLASH->CR1 & FLASH_CR_LOCK) {
+		FLASH->KEYR1 = FLASH_KEY1;
+		FLASH->KEYR1 = FLASH_KEY2;
+	}
+	FLASH->CCR1 = FLASH_FLAG_ALL_ERRORS_BANK1 | FLASH_CCR_CLR_EOP;
+
+	for (uint32_t sector = 0; sector < sectors; sector++) {
+		FLASH->CR1 = (FLASH->CR1 & ~(FLASH_CR_SNB | FLASH_CR_PG)) | FLASH_CR_SER | (sector << FLASH_CR_SNB_Pos);
+		FLASH->CR1 |= FLASH_CR_START;
+		while (FLASH->SR1 & FLASH_SR_QW) {}
+	}
+	FLASH->CR1 &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+
+	FLASH->CR1 |= FLASH_CR_PG;
+	for (uint32_t i = 0; i < words; i += FLASH_NB_32BITWORD_IN_FLASHWORD) {
+		for (uint32_t w = 0; w < FLASH_NB_32BITWORD_IN_FLASHWORD; w++) {
+			target[i + w] = source[i + w];
+		}
+		__DSB();
+		while (FLASH->SR1 & FLASH_SR_QW) {}
+	}
+	FLASH->CR1 &= ~FLASH_CR_PG;
+	FLASH->CR1 |= FLASH_CR_LOCK;
+
+	// NVIC_SystemReset() itself may live in the internal flash
+	__DSB();
+	SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) | (SCB->AIRCR & SCB_AIRCR_PRIGROUP_Msk) | SCB_AIRCR_SYSRESETREQ_Msk;
+	__DSB();
+	while (1) {}
+}
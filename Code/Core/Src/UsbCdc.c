@@ -0,0 +1,1164 @@
+/**
+ * @file    UsbCdc.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   USB-Gerät mit zwei virtuellen COM-Ports (CDC-ACM) als schnellerer Sendeweg für Serial.c
+ *
+ * Der STM32H7B0 hat einen OTG-HS-Kern, aber keinen eingebauten High-Speed-PHY; ein ULPI-Baustein
+ * ist auf dem Board nicht bestückt. Der Kern läuft deshalb über den internen Full-Speed-PHY an
+ * PA11/PA12 mit 12 MBit/s, netto gut 1 MB/s in Bulk-Transfers. Das ist das Zehnfache von LPUART1
+ * (3 MBaud) und das Hundertfache von UART7. Die HAL-Schicht PCD und die USB-Middleware von ST
+ * sind nicht im Projekt; dieser Treiber spricht die Register des Kerns direkt an (RM0455, OTG).
+ *
+ * Das Gerät meldet sich als Verbund zweier CDC-ACM-Funktionen (IAD), unter Linux /dev/ttyACM0 und
+ * /dev/ttyACM1, unter Windows zwei COM-Ports ohne eigenen Treiber:
+ *   Port 0 (USBCDC_PORT_SHELL): Inhalt von Serial_Shell, also Antworten der Kommandozeile, Telemetrie
+ *                               und Bildspiegel wie auf LPUART1; Zeilen vom PC gehen an Shell_Submit()
+ *   Port 1 (USBCDC_PORT_LOG):   Inhalt von Serial_Log (printf und binäres LOG) wie auf UART7
+ * Die Werkzeuge auf dem PC bleiben unverändert, sie bekommen nur den USB-Port statt der UART.
+ *
+ * Öffnet ein Programm auf dem PC einen Port (DTR über SET_CONTROL_LINE_STATE), übernimmt der Treiber
+ * den Ring mit Serial_SetExternal(), wie EspLink.c es für Serial_Log tut. Die Erzeuger schreiben
+ * unverändert mit Serial_Write(), gesendet wird direkt aus dem Ring ohne Kopie: ein Bulk-Transfer
+ * umfasst das zusammenhängende Stück ab tail (bis USBCDC_TRANSFER_MAX), der Interrupt schreibt es
+ * paketweise in den Sende-FIFO des Endpunkts, und erst der Abschluss rückt tail vor. Der FIFO fasst
+ * USBCDC_TX_FIFO_PACKETS Pakete; der Kern meldet ihn ab halb leer, während der PC ein Paket
+ * abholt, liegen die nächsten also schon bereit. Ein Transfer aus lauter vollen Paketen endet mit
+ * einem Null-Paket, wenn danach nichts mehr ansteht, sonst hielte der PC die letzten Bytes zurück.
+ *
+ * Schließt der PC den Port, trennt er das Kabel oder legt er den Bus schlafen, bricht der Treiber
+ * den laufenden Transfer ab und gibt den Ring an die UART zurück; was noch nicht bestätigt war,
+ * geht dort hinaus (ein teilweise gesendetes Stück doppelt). Solange der ESP-Link Serial_Log hält,
+ * wartet Port 1, und umgekehrt verbindet sich der ESP nicht, solange Port 1 offen ist.
+ *
+ * Der 48-MHz-Takt kommt vom HSI48, die CRS gleicht ihn an den SOF des PCs an; er bleibt in allen
+ * Taktprofilen gleich. VBUS wird nicht erfasst, PA9 ist TX von LPUART1: die B-Session gilt immer
+ * als gültig, ohne Kabel bleibt das Gerät einfach unverbunden. Der Timer (USBCDC_TICK_MS) übernimmt
+ * neue Daten der Ringe und die empfangenen Zeilen, bis dahin hält der Endpunkt weitere Pakete
+ * vom PC mit NAK an. 'usb' in der Shell zeigt Zustand und Durchsatz je Port.
+ */
+
+#include "UsbCdc.h"
+
+#if USBCDC_ENABLE
+
+#include "Irq.h"
+#include "Shell.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <string.h>
+
+#define USBCDC_OTG                USB1_OTG_HS
+#define USBCDC_DEVICE             ((USB_OTG_DeviceTypeDef *)(USB1_OTG_HS_PERIPH_BASE + USB_OTG_DEVICE_BASE))
+#define USBCDC_IN(ep)             ((USB_OTG_INEndpointTypeDef *)(USB1_OTG_HS_PERIPH_BASE + USB_OTG_IN_ENDPOINT_BASE + (ep) * USB_OTG_EP_REG_SIZE))
+#define USBCDC_OUT(ep)            ((USB_OTG_OUTEndpointTypeDef *)(USB1_OTG_HS_PERIPH_BASE + USB_OTG_OUT_ENDPOINT_BASE + (ep) * USB_OTG_EP_REG_SIZE))
+#define USBCDC_FIFO(ep)           (*(volatile uint32_t *)(USB1_OTG_HS_PERIPH_BASE + USB_OTG_FIFO_BASE + (ep) * USB_OTG_FIFO_SIZE))
+#define USBCDC_PCGCCTL            (*(volatile uint32_t *)(USB1_OTG_HS_PERIPH_BASE + USB_OTG_PCGCCTL_BASE))
+
+/* Endpunkte: EP0 und je Port ein Interrupt-Endpunkt für Meldungen (nie benutzt) und ein Bulk-Paar */
+#define USBCDC_EP0_SIZE           64
+#define USBCDC_NOTIFY_SIZE        8
+#define USBCDC_NOTIFY_EP(port)    (1U + 2U * (port))
+#define USBCDC_DATA_EP(port)      (2U + 2U * (port))
+#define USBCDC_EP_COUNT           (1U + 2U * USBCDC_PORT_COUNT)
+
+/* FIFO-RAM in 32-Bit-Wörtern (4 KB): Empfang für alle OUT-Endpunkte, dann ein Sende-FIFO je IN-Endpunkt */
+#define USBCDC_FIFO_WORDS         1024U
+#define USBCDC_RX_WORDS           128U
+#define USBCDC_EP0_TX_WORDS       16U
+#define USBCDC_NOTIFY_TX_WORDS    16U
+#define USBCDC_DATA_TX_WORDS      (USBCDC_TX_FIFO_PACKETS * USBCDC_PACKET_SIZE / 4U)
+
+#if USBCDC_RX_WORDS + USBCDC_EP0_TX_WORDS + USBCDC_PORT_COUNT * (USBCDC_NOTIFY_TX_WORDS + USBCDC_DATA_TX_WORDS) > USBCDC_FIFO_WORDS
+#error "USBCDC_TX_FIFO_PACKETS: die FIFOs passen nicht in die 4 KB des OTG-Kerns!"
+#endif
+
+/* Wartezeiten beim Start: HSI48, VDD33USB, Reset des Kerns, Wechsel in den Gerätemodus (mind. 25 ms) */
+#define USBCDC_START_TIMEOUT_MS   50
+#define USBCDC_FLUSH_LOOPS        10000U
+
+/* Paketstatus im Empfangs-FIFO (GRXSTSP.PKTSTS) */
+#define USBCDC_RX_OUT_DATA        2U
+#define USBCDC_RX_SETUP_DATA      6U
+
+/* Anfragen an EP0 (USB 2.0 Kap. 9, CDC PSTN 1.2) */
+#define USBCDC_REQ_GET_STATUS     0x00
+#define USBCDC_REQ_CLEAR_FEATURE  0x01
+#define USBCDC_REQ_SET_FEATURE    0x03
+#define USBCDC_REQ_SET_ADDRESS    0x05
+#define USBCDC_REQ_GET_DESCRIPTOR 0x06
+#define USBCDC_REQ_GET_CONFIG     0x08
+#define USBCDC_REQ_SET_CONFIG     0x09
+#define USBCDC_REQ_GET_INTERFACE  0x0A
+#define USBCDC_REQ_SET_INTERFACE  0x0B
+#define USBCDC_REQ_SET_LINE_CODING 0x20
+#define USBCDC_REQ_GET_LINE_CODING 0x21
+#define USBCDC_REQ_SET_LINE_STATE 0x22
+#define USBCDC_REQ_SEND_BREAK     0x23
+
+#define USBCDC_DESC_DEVICE        1
+#define USBCDC_DESC_CONFIG        2
+#define USBCDC_DESC_STRING        3
+
+#define USBCDC_LINE_CODING_SIZE   7
+
+/* Eine CDC-ACM-Funktion: IAD, Steuer-Interface mit Funktionsbeschreibungen und Meldungs-Endpunkt, Daten-Interface */
+#define USBCDC_FUNCTION_SIZE      66
+#define USBCDC_FUNCTION(intf, notifyEp, dataEp, name) \
+	0x08, 0x0B, (intf), 0x02, 0x02, 0x02, 0x01, 0x00, \
+	0x09, 0x04, (intf), 0x00, 0x01, 0x02, 0x02, 0x01, (name), \
+	0x05, 0x24, 0x00, 0x10, 0x01, \
+	0x05, 0x24, 0x01, 0x00, (intf) + 1, \
+	0x04, 0x24, 0x02, 0x02, \
+	0x05, 0x24, 0x06, (intf), (intf) + 1, \
+	0x07, 0x05, 0x80 | (notifyEp), 0x03, USBCDC_NOTIFY_SIZE, 0x00, 0x10, \
+	0x09, 0x04, (intf) + 1, 0x00, 0x02, 0x0A, 0x00, 0x00, 0x00, \
+	0x07, 0x05, (dataEp), 0x02, USBCDC_PACKET_SIZE, 0x00, 0x00, \
+	0x07, 0x05, 0x80 | (dataEp), 0x02, USBCDC_PACKET_SIZE, 0x00, 0x00
+
+#define USBCDC_CONFIG_SIZE        (9 + USBCDC_PORT_COUNT * USBCDC_FUNCTION_SIZE)
+
+static const uint8_t UsbCdc_DeviceDesc[18] = {
+	18, USBCDC_DESC_DEVICE, 0x00, 0x02,
+	0xEF, 0x02, 0x01,                     // miscellaneous class with IAD
+	USBCDC_EP0_SIZE,
+	USBCDC_VID & 0xFF, USBCDC_VID >> 8, USBCDC_PID & 0xFF, USBCDC_PID >> 8,
+	0x00, 0x02,                           // bcdDevice 2.00
+	1, 2, 3,                              // manufacturer, product, serial number
+	1
+};
+
+static const uint8_t UsbCdc_ConfigDesc[USBCDC_CONFIG_SIZE] = {
+	9, USBCDC_DESC_CONFIG, USBCDC_CONFIG_SIZE & 0xFF, USBCDC_CONFIG_SIZE >> 8,
+	2 * USBCDC_PORT_COUNT, 1, 0, 0x80, 50, // bus powered, 100 mA
+	USBCDC_FUNCTION(0, USBCDC_NOTIFY_EP(0), USBCDC_DATA_EP(0), 4),
+	USBCDC_FUNCTION(2, USBCDC_NOTIFY_EP(1), USBCDC_DATA_EP(1), 5),
+};
+
+// String descriptors 1..5, 3 is the serial number from the unique device ID
+static const char *const UsbCdc_Strings[] = { NULL, "simim", "CLionTest", NULL, "CLionTest Shell", "CLionTest Log" };
+
+#define USBCDC_STRING_COUNT       (sizeof(UsbCdc_Strings) / sizeof(UsbCdc_Strings[0]))
+
+/**
+ * @brief Laufender Transfer eines IN-Endpunkts, der Interrupt schreibt ihn paketweise in den FIFO
+ */
+typedef struct {
+	const uint8_t *data;
+	uint32_t length;
+	uint32_t written;              // schon im FIFO
+	volatile uint8_t busy;
+} UsbCdc_InXfer;
+
+/**
+ * @brief Zustand eines COM-Ports
+ */
+typedef struct {
+	Serial_Port *serial;
+	UsbCdc_InXfer in;
+	volatile uint8_t dtr;          // vom PC gesetzt
+	uint8_t owned;                 // Ring mit Serial_SetExternal() übernommen
+	uint8_t zlpDue;                // letzter Transfer endete mit einem vollen Paket
+	uint8_t lineCoding[USBCDC_LINE_CODING_SIZE];
+
+	uint8_t rx[USBCDC_PACKET_SIZE];
+	volatile uint16_t rxCount;
+	volatile uint8_t rxFull;       // Paket wartet auf den Timer, der Endpunkt antwortet NAK
+	uint16_t rxPos;
+	char line[SHELL_RX_BUFFER_SIZE];
+	uint16_t lineLength;
+	uint8_t linePending;           // Zeile fertig, Shell_Submit() hat sie noch nicht angenommen
+} UsbCdc_Port;
+
+static UsbCdc_Port UsbCdc_Ports[USBCDC_PORT_COUNT] = {
+	[USBCDC_PORT_SHELL] = { .serial = &Serial_Shell },
+	[USBCDC_PORT_LOG]   = { .serial = &Serial_Log },
+};
+
+static UsbCdc_Stats UsbCdc_Statistics;
+static uint32_t UsbCdc_StatsStartMs = 0;
+static Timer UsbCdc_Timer;
+static uint32_t UsbCdc_PeriodMs = USBCDC_IDLE_MS;
+
+// Control endpoint
+static uint8_t UsbCdc_SetupPacket[8] __attribute__((aligned(4)));
+static uint8_t UsbCdc_Ep0Rx[USBCDC_EP0_SIZE];
+static uint16_t UsbCdc_Ep0RxCount = 0;
+static uint8_t UsbCdc_Ep0OutRequest = 0;      // class request waiting for its data stage
+static uint8_t UsbCdc_Ep0OutPort = 0;
+static UsbCdc_InXfer UsbCdc_Ep0In;
+static const uint8_t *UsbCdc_Ep0Data = NULL;  // rest of the data stage after the running packet
+static uint32_t UsbCdc_Ep0Remaining = 0;
+static uint8_t UsbCdc_Ep0Zlp = 0;
+static uint8_t UsbCdc_Ep0Reply[2 + 2 * 32];   // string descriptor or status
+static uint8_t UsbCdc_Configuration = 0;
+
+static uint8_t UsbCdc_CoreInit(void);
+static uint8_t UsbCdc_Wait(volatile uint32_t *reg, uint32_t mask, uint32_t value, uint32_t timeoutMs);
+static void UsbCdc_FlushTx(uint32_t fifo);
+static void UsbCdc_Tick(void *context);
+static void UsbCdc_Take(UsbCdc_Port *p);
+static void UsbCdc_Release(UsbCdc_Port *p);
+static void UsbCdc_Receive(UsbCdc_Port *p, uint8_t index);
+static void UsbCdc_StartIn(UsbCdc_Port *p, uint8_t index);
+static void UsbCdc_StartXfer(uint8_t ep, UsbCdc_InXfer *x, const uint8_t *data, uint32_t length);
+static void UsbCdc_FillFifo(uint8_t ep, UsbCdc_InXfer *x);
+static void UsbCdc_AbortIn(uint8_t ep);
+static void UsbCdc_ArmOut(uint8_t ep, uint32_t length);
+static void UsbCdc_ReadFifo(uint8_t *dst, uint32_t capacity, uint32_t length);
+static void UsbCdc_BusReset(void);
+static void UsbCdc_EnumDone(void);
+static void UsbCdc_RxLevel(void);
+static void UsbCdc_OutEndpoints(void);
+static void UsbCdc_InEndpoints(void);
+static void UsbCdc_Setup(void);
+static uint8_t UsbCdc_StandardRequest(uint8_t type, uint8_t request, uint16_t value, uint16_t index, uint16_t length);
+static uint8_t UsbCdc_ClassRequest(uint8_t request, uint16_t value, uint16_t index, uint16_t length);
+static uint32_t UsbCdc_StringDesc(uint8_t index);
+static void UsbCdc_Configure(uint8_t configuration);
+static void UsbCdc_Ep0Send(const uint8_t *data, uint32_t length, uint16_t requested);
+static void UsbCdc_Ep0Status(void);
+static void UsbCdc_Ep0Stall(void);
+static void UsbCdc_Ep0InDone(void);
+static void UsbCdc_Ep0OutDone(void);
+static void UsbCdc_Wake(void);
+
+/**
+ * @brief  Startet Takt, PHY und Kern und meldet das Gerät am Bus an
+ *
+ * Nach Irq_Init() und Shell_Init() aufrufen. Fehlt der HSI48 oder die Versorgung VDD33USB, bleibt
+ * USB aus ('usb' zeigt es), die UARTs arbeiten wie bisher.
+ */
+void UsbCdc_Init(void) {
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	RCC_CRSInitTypeDef crs = {
+		.Prescaler = RCC_CRS_SYNC_DIV1,
+		.Source = RCC_CRS_SYNC_SOURCE_USB1,
+		.Polarity = RCC_CRS_SYNC_POLARITY_RISING,
+		.ReloadValue = RCC_CRS_RELOADVALUE_DEFAULT,
+		.ErrorLimitValue = RCC_CRS_ERRORLIMIT_DEFAULT,
+		.HSI48CalibrationValue = RCC_CRS_HSI48CALIBRATION_DEFAULT,
+	};
+
+	// 48 MHz from the HSI48, trimmed to the host's SOF once enumerated
+	__HAL_RCC_HSI48_ENABLE();
+	if (!UsbCdc_Wait(&RCC->CR, RCC_CR_HSI48RDY, RCC_CR_HSI48RDY, USBCDC_START_TIMEOUT_MS))
+		return;
+	__HAL_RCC_CRS_CLK_ENABLE();
+	HAL_RCCEx_CRSConfig(&crs);
+	__HAL_RCC_USB_CONFIG(RCC_USBCLKSOURCE_HSI48);
+
+	HAL_PWREx_EnableUSBVoltageDetector();
+	if (!UsbCdc_Wait(&PWR->CR3, PWR_CR3_USB33RDY, PWR_CR3_USB33RDY, USBCDC_START_TIMEOUT_MS))
+		return;
+
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	GPIO_InitStruct.Pin = GPIO_PIN_11 | GPIO_PIN_12;
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	GPIO_InitStruct.Alternate = GPIO_AF10_OTG1_FS;
+	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+	__HAL_RCC_USB1_OTG_HS_CLK_ENABLE();
+	__HAL_RCC_USB1_OTG_HS_ULPI_CLK_SLEEP_DISABLE();
+	if (!UsbCdc_CoreInit())
+		return;
+
+	UsbCdc_Statistics.powered = 1;
+	UsbCdc_StatsStartMs = HAL_GetTick();
+	for (uint8_t i = 0; i < USBCDC_PORT_COUNT; i++) {
+		uint32_t baud = 115200;
+
+		memcpy(UsbCdc_Ports[i].lineCoding, &baud, sizeof(baud));
+		UsbCdc_Ports[i].lineCoding[6] = 8;     // 8N1
+	}
+
+	Timer_Setup(&UsbCdc_Timer, "UsbCdc", UsbCdc_Tick, NULL);
+	Timer_Start(&UsbCdc_Timer, UsbCdc_PeriodMs, UsbCdc_PeriodMs);
+
+	HAL_NVIC_EnableIRQ(OTG_HS_IRQn);
+	// Pull-up on D+, the host starts the enumeration
+	USBCDC_DEVICE->DCTL &= ~USB_OTG_DCTL_SDIS;
+}
+
+/**
+ * @brief  1, solange der PC den Port offen hält und der Ring über USB geht
+ */
+uint8_t UsbCdc_IsOpen(uint8_t port) {
+	return port < USBCDC_PORT_COUNT && UsbCdc_Ports[port].owned;
+}
+
+/**
+ * @brief  1, solange ein PC am Bus ist und ihn nicht schlafen gelegt hat; der Kern braucht dann seinen Takt
+ *
+ * Ohne Kabel meldet der Kern nach 3 ms Ruhe am Bus ebenfalls Suspend, LowPower.c darf dann in den Stop.
+ */
+uint8_t UsbCdc_IsActive(void) {
+	return UsbCdc_Statistics.powered && !UsbCdc_Statistics.suspended;
+}
+
+/**
+ * @brief  Nach dem Stop-Modus: der HSI48 ist dort aus, der Kern bekommt seinen 48-MHz-Takt zurück
+ *
+ * Ein PC, der sich während des Stops anmeldet, wiederholt den Reset, bis das Gerät antwortet.
+ */
+void UsbCdc_WakeFromStop(void) {
+	if (UsbCdc_Statistics.powered)
+		__HAL_RCC_HSI48_ENABLE();
+}
+
+const UsbCdc_Stats* UsbCdc_GetStats(void) {
+	for (uint8_t i = 0; i < USBCDC_PORT_COUNT; i++)
+		UsbCdc_Statistics.port[i].open = UsbCdc_Ports[i].owned;
+	return &UsbCdc_Statistics;
+}
+
+/**
+ * @brief  Setzt die Zähler zurück, Zustand und Baudrate bleiben
+ */
+void UsbCdc_ResetStats(void) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	UsbCdc_Statistics.resets = 0;
+	UsbCdc_Statistics.suspends = 0;
+	UsbCdc_Statistics.setups = 0;
+	UsbCdc_Statistics.stalls = 0;
+	for (uint8_t i = 0; i < USBCDC_PORT_COUNT; i++) {
+		UsbCdc_PortStats *s = &UsbCdc_Statistics.port[i];
+		uint32_t baud = s->baud;
+
+		memset(s, 0, sizeof(*s));
+		s->baud = baud;
+	}
+	UsbCdc_StatsStartMs = HAL_GetTick();
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Gibt Zustand und Zähler je Port aus ('usb' in der Shell)
+ */
+void UsbCdc_Dump(void) {
+	static const char *const names[USBCDC_PORT_COUNT] = { "shell", "log" };
+	const UsbCdc_Stats *s = UsbCdc_GetStats();
+	uint32_t elapsedMs = HAL_GetTick() - UsbCdc_StatsStartMs;
+
+	if (!s->powered) {
+		printf("USB aus: HSI48 oder VDD33USB nicht bereit\n");
+		return;
+	}
+	printf("USB Full Speed %s, %lu Resets, %lu Suspends, %lu Setups, %lu abgelehnt\n",
+			!s->configured ? "nicht verbunden" : s->suspended ? "im Suspend" : "konfiguriert",
+			s->resets, s->suspends, s->setups, s->stalls);
+	printf("  Port   offen Öffn.  gesendet B      B/s Transfers  ZLP abgebr. empfangen B Zeilen verworfen    Baud\n");
+	for (uint8_t i = 0; i < USBCDC_PORT_COUNT; i++) {
+		const UsbCdc_PortStats *p = &s->port[i];
+
+		printf("  %-6s %5s %5lu %11lu %8lu %9lu %4lu %7lu %11lu %6lu %9lu %7lu\n", names[i], p->open ? "ja" : "nein",
+				p->opens, (uint32_t)p->txBytes, elapsedMs ? (uint32_t)(p->txBytes * 1000U / elapsedMs) : 0,
+				p->transfers, p->zlps, p->aborted, (uint32_t)p->rxBytes, p->lines, p->rxDropped, p->baud);
+	}
+}
+
+/**
+ * @brief  Interrupt des OTG-Kerns: Empfangs-FIFO, Endpunkte und Buszustand
+ */
+void OTG_HS_IRQHandler(void) {
+	IRQ_ENTER(IRQ_ID_OTG_HS);
+	uint32_t status = USBCDC_OTG->GINTSTS & USBCDC_OTG->GINTMSK;
+
+	if (status & USB_OTG_GINTSTS_RXFLVL)
+		UsbCdc_RxLevel();
+	if (status & USB_OTG_GINTSTS_OEPINT)
+		UsbCdc_OutEndpoints();
+	if (status & USB_OTG_GINTSTS_IEPINT)
+		UsbCdc_InEndpoints();
+	if (status & USB_OTG_GINTSTS_USBRST) {
+		USBCDC_OTG->GINTSTS = USB_OTG_GINTSTS_USBRST;
+		UsbCdc_BusReset();
+	}
+	if (status & USB_OTG_GINTSTS_ENUMDNE) {
+		USBCDC_OTG->GINTSTS = USB_OTG_GINTSTS_ENUMDNE;
+		UsbCdc_EnumDone();
+	}
+	if (status & USB_OTG_GINTSTS_USBSUSP) {
+		USBCDC_OTG->GINTSTS = USB_OTG_GINTSTS_USBSUSP;
+		if (UsbCdc_Statistics.configured && !UsbCdc_Statistics.suspended)
+			UsbCdc_Statistics.suspends++;
+		UsbCdc_Statistics.suspended = 1;
+		UsbCdc_Wake();
+	}
+	if (status & USB_OTG_GINTSTS_WKUINT) {
+		USBCDC_OTG->GINTSTS = USB_OTG_GINTSTS_WKUINT;
+		UsbCdc_Statistics.suspended = 0;
+		UsbCdc_Wake();
+	}
+	IRQ_EXIT(IRQ_ID_OTG_HS);
+}
+
+/**
+ * @brief  Kern mit internem Full-Speed-PHY in den Gerätemodus bringen, FIFOs aufteilen, Interrupts einschalten
+ * @retval 1 bei Erfolg, 0 wenn der Kern nicht reagiert
+ */
+static uint8_t UsbCdc_CoreInit(void) {
+	USB_OTG_GlobalTypeDef *otg = USBCDC_OTG;
+	uint32_t start;
+
+	otg->GAHBCFG &= ~USB_OTG_GAHBCFG_GINT;
+	otg->GUSBCFG |= USB_OTG_GUSBCFG_PHYSEL;
+	if (!UsbCdc_Wait(&otg->GRSTCTL, USB_OTG_GRSTCTL_AHBIDL, USB_OTG_GRSTCTL_AHBIDL, USBCDC_START_TIMEOUT_MS))
+		return 0;
+	otg->GRSTCTL |= USB_OTG_GRSTCTL_CSRST;
+	if (!UsbCdc_Wait(&otg->GRSTCTL, USB_OTG_GRSTCTL_CSRST, 0, USBCDC_START_TIMEOUT_MS))
+		return 0;
+	otg->GCCFG |= USB_OTG_GCCFG_PWRDWN;            // set = transceiver active
+
+	otg->GUSBCFG = (otg->GUSBCFG & ~(USB_OTG_GUSBCFG_FHMOD | USB_OTG_GUSBCFG_FDMOD)) | USB_OTG_GUSBCFG_FDMOD;
+	start = HAL_GetTick();
+	while (otg->GINTSTS & USB_OTG_GINTSTS_CMOD) {
+		if (HAL_GetTick() - start >= USBCDC_START_TIMEOUT_MS)
+			return 0;
+	}
+
+	// No VBUS sensing, PA9 is LPUART1 TX: the B session is always valid
+	otg->GCCFG &= ~USB_OTG_GCCFG_VBDEN;
+	otg->GOTGCTL |= USB_OTG_GOTGCTL_BVALOEN | USB_OTG_GOTGCTL_BVALOVAL;
+	USBCDC_PCGCCTL = 0;
+
+	// Full speed on the internal PHY, stay disconnected until UsbCdc_Init() is done
+	USBCDC_DEVICE->DCFG = (USBCDC_DEVICE->DCFG & ~(USB_OTG_DCFG_DSPD | USB_OTG_DCFG_PFIVL)) | USB_OTG_DCFG_DSPD;
+	USBCDC_DEVICE->DCTL |= USB_OTG_DCTL_SDIS;
+	UsbCdc_FlushTx(0x10);
+	otg->GRSTCTL = USB_OTG_GRSTCTL_RXFFLSH;
+	for (uint32_t n = 0; (otg->GRSTCTL & USB_OTG_GRSTCTL_RXFFLSH) && n < USBCDC_FLUSH_LOOPS; n++)
+		;
+
+	USBCDC_DEVICE->DIEPMSK = 0;
+	USBCDC_DEVICE->DOEPMSK = 0;
+	USBCDC_DEVICE->DAINTMSK = 0;
+	for (uint8_t ep = 0; ep < USBCDC_EP_COUNT; ep++) {
+		USBCDC_IN(ep)->DIEPTSIZ = 0;
+		USBCDC_IN(ep)->DIEPINT = 0xFB7FU;
+		USBCDC_OUT(ep)->DOEPTSIZ = 0;
+		USBCDC_OUT(ep)->DOEPINT = 0xFB7FU;
+	}
+
+	// FIFO RAM: receive FIFO, EP0, then notification and data FIFO of each port
+	uint32_t offset = USBCDC_RX_WORDS + USBCDC_EP0_TX_WORDS;
+	otg->GRXFSIZ = USBCDC_RX_WORDS;
+	otg->DIEPTXF0_HNPTXFSIZ = (USBCDC_EP0_TX_WORDS << 16) | USBCDC_RX_WORDS;
+	for (uint8_t ep = 1; ep < USBCDC_EP_COUNT; ep++) {
+		uint32_t words = (ep & 1U) ? USBCDC_NOTIFY_TX_WORDS : USBCDC_DATA_TX_WORDS;
+
+		otg->DIEPTXF[ep - 1] = (words << 16) | offset;
+		offset += words;
+	}
+
+	otg->GINTSTS = 0xBFFFFFFFU;
+	otg->GINTMSK = USB_OTG_GINTMSK_USBRST | USB_OTG_GINTMSK_ENUMDNEM | USB_OTG_GINTMSK_RXFLVLM
+			| USB_OTG_GINTMSK_IEPINT | USB_OTG_GINTMSK_OEPINT | USB_OTG_GINTMSK_USBSUSPM | USB_OTG_GINTMSK_WUIM;
+	// TXFELVL stays 0: the TX FIFO empty interrupt comes at half empty
+	otg->GAHBCFG |= USB_OTG_GAHBCFG_GINT;
+	return 1;
+}
+
+/**
+ * @brief  Wartet, bis (*reg & mask) == value, nur beim Start
+ */
+static uint8_t UsbCdc_Wait(volatile uint32_t *reg, uint32_t mask, uint32_t value, uint32_t timeoutMs) {
+	uint32_t start = HAL_GetTick();
+
+	while ((*reg & mask) != value) {
+		if (HAL_GetTick() - start >= timeoutMs)
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Leert einen Sende-FIFO, 0x10 = alle
+ */
+static void UsbCdc_FlushTx(uint32_t fifo) {
+	USBCDC_OTG->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH | (fifo << USB_OTG_GRSTCTL_TXFNUM_Pos);
+	for (uint32_t n = 0; (USBCDC_OTG->GRSTCTL & USB_OTG_GRSTCTL_TXFFLSH) && n < USBCDC_FLUSH_LOOPS; n++)
+		;
+}
+
+/**
+ * @brief  Timer-Callback: Ringe übernehmen bzw. zurückgeben, neue Daten senden, Zeilen an die Kommandozeile
+ */
+static void UsbCdc_Tick(void *context) {
+	uint8_t open = 0;
+	uint32_t period;
+
+	for (uint8_t i = 0; i < USBCDC_PORT_COUNT; i++) {
+		UsbCdc_Port *p = &UsbCdc_Ports[i];
+		uint8_t wanted = UsbCdc_Statistics.configured && !UsbCdc_Statistics.suspended && p->dtr;
+
+		if (wanted && !p->owned)
+			UsbCdc_Take(p);
+		else if (!wanted && p->owned)
+			UsbCdc_Release(p);
+
+		if (p->owned) {
+			// Serial_Write() does not start anything while the ring is external
+			__disable_irq();
+			UsbCdc_StartIn(p, i);
+			__enable_irq();
+			open = 1;
+		}
+		if (p->rxFull)
+			UsbCdc_Receive(p, i);
+	}
+
+	period = open ? USBCDC_TICK_MS : USBCDC_IDLE_MS;
+	if (period != UsbCdc_PeriodMs) {
+		UsbCdc_PeriodMs = period;
+		Timer_Start(&UsbCdc_Timer, period, period);
+	}
+}
+
+/**
+ * @brief  Ring eines Ports von der UART übernehmen; hält ihn schon ein anderer Sender, im nächsten Takt erneut
+ */
+static void UsbCdc_Take(UsbCdc_Port *p) {
+	if (p->serial->external || !Serial_SetExternal(p->serial, 1))
+		return;
+
+	p->owned = 1;
+	p->zlpDue = 0;
+	UsbCdc_Statistics.port[p - UsbCdc_Ports].opens++;
+}
+
+/**
+ * @brief  Laufenden Transfer abbrechen und den Ring an die UART zurückgeben, sie sendet ab tail weiter
+ */
+static void UsbCdc_Release(UsbCdc_Port *p) {
+	uint8_t index = (uint8_t)(p - UsbCdc_Ports);
+
+	__disable_irq();
+	if (p->in.busy) {
+		UsbCdc_AbortIn(USBCDC_DATA_EP(index));
+		p->in.busy = 0;
+		UsbCdc_Statistics.port[index].aborted++;
+	}
+	__enable_irq();
+
+	if (Serial_SetExternal(p->serial, 0))
+		p->owned = 0;
+}
+
+/**
+ * @brief  Empfangenes Paket auswerten (Timer-Task), danach nimmt der Endpunkt das nächste an
+ *
+ * Auf dem Shell-Port werden Zeilen gesammelt und mit Shell_Submit() eingereicht, ihre Ausgabe geht
+ * nach Serial_Shell. Ist die Kommandozeile noch mit einer anderen Zeile beschäftigt, bleibt das
+ * Paket liegen und der PC wartet. Eingaben auf dem Log-Port werden verworfen.
+ */
+static void UsbCdc_Receive(UsbCdc_Port *p, uint8_t index) {
+	if (index == USBCDC_PORT_SHELL) {
+		for (;;) {
+			if (p->linePending) {
+				if (!Shell_Submit(p->line, p->lineLength, &Serial_Shell))
+					return;
+				UsbCdc_Statistics.port[index].lines++;
+				p->linePending = 0;
+				p->lineLength = 0;
+			}
+			if (p->rxPos >= p->rxCount)
+				break;
+
+			char c = (char)p->rx[p->rxPos++];
+			if (c == '\r' || c == '\n') {
+				if (p->lineLength > 0)
+					p->linePending = 1;
+			} else if (p->lineLength < sizeof(p->line) - 1) {
+				p->line[p->lineLength++] = c;
+			} else {
+				UsbCdc_Statistics.port[index].rxDropped++;
+			}
+		}
+	}
+
+	__disable_irq();
+	p->rxPos = 0;
+	p->rxFull = 0;
+	if (UsbCdc_Statistics.configured)
+		UsbCdc_ArmOut(USBCDC_DATA_EP(index), USBCDC_PACKET_SIZE);
+	__enable_irq();
+}
+
+/**
+ * @brief  Startet den nächsten Bulk-Transfer ab tail oder das fällige Null-Paket (Interrupts gesperrt)
+ */
+static void UsbCdc_StartIn(UsbCdc_Port *p, uint8_t index) {
+	Serial_Port *port = p->serial;
+
+	if (!UsbCdc_Statistics.configured || !p->owned || p->in.busy)
+		return;
+
+	uint32_t pending = port->head - port->tail;
+	uint32_t offset = port->tail & (port->size - 1);
+	uint32_t length = port->size - offset;
+
+	if (length > pending)
+		length = pending;
+	if (length > USBCDC_TRANSFER_MAX)
+		length = USBCDC_TRANSFER_MAX;
+	if (length == 0) {
+		if (!p->zlpDue)
+			return;
+		UsbCdc_Statistics.port[index].zlps++;
+	} else {
+		UsbCdc_Statistics.port[index].transfers++;
+	}
+	p->zlpDue = 0;
+	UsbCdc_StartXfer(USBCDC_DATA_EP(index), &p->in, &port->buffer[offset], length);
+}
+
+/**
+ * @brief  Programmiert einen IN-Transfer, die Daten schreibt der FIFO-leer-Interrupt (Interrupts gesperrt)
+ */
+static void UsbCdc_StartXfer(uint8_t ep, UsbCdc_InXfer *x, const uint8_t *data, uint32_t length) {
+	USB_OTG_INEndpointTypeDef *in = USBCDC_IN(ep);
+	uint32_t packets = length == 0 ? 1U : (length + USBCDC_PACKET_SIZE - 1U) / USBCDC_PACKET_SIZE;
+
+	x->data = data;
+	x->length = length;
+	x->written = 0;
+	x->busy = 1;
+	in->DIEPTSIZ = (packets << USB_OTG_DIEPTSIZ_PKTCNT_Pos) | length;
+	in->DIEPCTL |= USB_OTG_DIEPCTL_CNAK | USB_OTG_DIEPCTL_EPENA;
+	if (length > 0)
+		USBCDC_DEVICE->DIEPEMPMSK |= 1U << ep;
+}
+
+/**
+ * @brief  Schreibt so viele ganze Pakete in den FIFO, wie Platz ist
+ */
+static void UsbCdc_FillFifo(uint8_t ep, UsbCdc_InXfer *x) {
+	USB_OTG_INEndpointTypeDef *in = USBCDC_IN(ep);
+	volatile uint32_t *fifo = &USBCDC_FIFO(ep);
+
+	while (x->written < x->length) {
+		uint32_t length = x->length - x->written;
+		if (length > USBCDC_PACKET_SIZE)
+			length = USBCDC_PACKET_SIZE;
+		if ((in->DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV) < (length + 3U) / 4U)
+			return;
+
+		const uint8_t *src = x->data + x->written;
+		x->written += length;
+		for (; length >= 4; length -= 4, src += 4)
+			*fifo = __UNALIGNED_UINT32_READ(src);
+		if (length > 0) {
+			// Last word byte by byte, the ring may end right behind it
+			uint32_t word = 0;
+			for (uint32_t i = 0; i < length; i++)
+				word |= (uint32_t)src[i] << (8U * i);
+			*fifo = word;
+		}
+	}
+	USBCDC_DEVICE->DIEPEMPMSK &= ~(1U << ep);
+}
+
+/**
+ * @brief  Bricht den Transfer eines IN-Endpunkts ab und leert seinen FIFO (Interrupts gesperrt)
+ */
+static void UsbCdc_AbortIn(uint8_t ep) {
+	USB_OTG_INEndpointTypeDef *in = USBCDC_IN(ep);
+
+	USBCDC_DEVICE->DIEPEMPMSK &= ~(1U << ep);
+	if (in->DIEPCTL & USB_OTG_DIEPCTL_EPENA) {
+		in->DIEPCTL |= USB_OTG_DIEPCTL_SNAK;
+		in->DIEPCTL |= USB_OTG_DIEPCTL_EPDIS;
+		for (uint32_t n = 0; (in->DIEPCTL & USB_OTG_DIEPCTL_EPENA) && n < USBCDC_FLUSH_LOOPS; n++)
+			;
+	}
+	UsbCdc_FlushTx(ep);
+	in->DIEPINT = USB_OTG_DIEPINT_XFRC | USB_OTG_DIEPINT_EPDISD;
+}
+
+/**
+ * @brief  Gibt einen OUT-Endpunkt für das nächste Paket frei
+ */
+static void UsbCdc_ArmOut(uint8_t ep, uint32_t length) {
+	USB_OTG_OUTEndpointTypeDef *out = USBCDC_OUT(ep);
+
+	if (ep == 0)
+		out->DOEPTSIZ = (3U << USB_OTG_DOEPTSIZ_STUPCNT_Pos) | (1U << USB_OTG_DOEPTSIZ_PKTCNT_Pos) | length;
+	else
+		out->DOEPTSIZ = (1U << USB_OTG_DOEPTSIZ_PKTCNT_Pos) | length;
+	out->DOEPCTL |= USB_OTG_DOEPCTL_CNAK | USB_OTG_DOEPCTL_EPENA;
+}
+
+/**
+ * @brief  Liest ein Paket aus dem Empfangs-FIFO, was nicht in capacity passt, wird verworfen
+ */
+static void UsbCdc_ReadFifo(uint8_t *dst, uint32_t capacity, uint32_t length) {
+	volatile uint32_t *fifo = &USBCDC_FIFO(0);
+
+	for (uint32_t i = 0; i < length; i += 4) {
+		uint32_t word = *fifo;
+
+		for (uint32_t b = 0; b < 4 && i + b < length; b++) {
+			if (i + b < capacity)
+				dst[i + b] = (uint8_t)(word >> (8U * b));
+		}
+	}
+}
+
+/**
+ * @brief  Bus-Reset durch den PC: alle Endpunkte außer EP0 aus, Adresse 0, offene Ports gelten als geschlossen
+ */
+static void UsbCdc_BusReset(void) {
+	USBCDC_DEVICE->DCTL &= ~USB_OTG_DCTL_RWUSIG;
+	UsbCdc_Configure(0);
+	UsbCdc_FlushTx(0x10);
+	for (uint8_t ep = 0; ep < USBCDC_EP_COUNT; ep++) {
+		USBCDC_IN(ep)->DIEPINT = 0xFB7FU;
+		USBCDC_OUT(ep)->DOEPINT = 0xFB7FU;
+	}
+	UsbCdc_Ep0In.busy = 0;
+	UsbCdc_Ep0Remaining = 0;
+	UsbCdc_Ep0OutRequest = 0;
+
+	USBCDC_DEVICE->DAINTMSK = (1U << 0) | (1U << 16);
+	USBCDC_DEVICE->DOEPMSK = USB_OTG_DOEPMSK_STUPM | USB_OTG_DOEPMSK_XFRCM;
+	USBCDC_DEVICE->DIEPMSK = USB_OTG_DIEPMSK_XFRCM;
+	USBCDC_DEVICE->DCFG &= ~USB_OTG_DCFG_DAD;
+	UsbCdc_ArmOut(0, USBCDC_EP0_SIZE);
+
+	UsbCdc_Statistics.suspended = 0;
+	UsbCdc_Statistics.resets++;
+	UsbCdc_Wake();
+}
+
+/**
+ * @brief  Geschwindigkeit ausgehandelt: EP0 mit 64 Bytes, Umlaufzeit des Kerns für Full Speed
+ */
+static void UsbCdc_EnumDone(void) {
+	// TRDT 6 holds from 32 MHz HCLK, the lowest clock profile runs 64 MHz
+	USBCDC_OTG->GUSBCFG = (USBCDC_OTG->GUSBCFG & ~USB_OTG_GUSBCFG_TRDT) | (6U << USB_OTG_GUSBCFG_TRDT_Pos);
+	USBCDC_IN(0)->DIEPCTL &= ~USB_OTG_DIEPCTL_MPSIZ;
+	USBCDC_DEVICE->DCTL |= USB_OTG_DCTL_CGINAK;
+}
+
+/**
+ * @brief  Nächster Eintrag im Empfangs-FIFO: SETUP-Paket oder Daten eines OUT-Endpunkts
+ */
+static void UsbCdc_RxLevel(void) {
+	USBCDC_OTG->GINTMSK &= ~USB_OTG_GINTMSK_RXFLVLM;
+
+	uint32_t status = USBCDC_OTG->GRXSTSP;
+	uint8_t ep = (uint8_t)(status & USB_OTG_GRXSTSP_EPNUM);
+	uint32_t count = (status & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
+	uint32_t kind = (status & USB_OTG_GRXSTSP_PKTSTS) >> USB_OTG_GRXSTSP_PKTSTS_Pos;
+
+	if (kind == USBCDC_RX_SETUP_DATA) {
+		UsbCdc_ReadFifo(UsbCdc_SetupPacket, sizeof(UsbCdc_SetupPacket), count);
+	} else if (kind == USBCDC_RX_OUT_DATA && count > 0) {
+		if (ep == 0) {
+			UsbCdc_ReadFifo(UsbCdc_Ep0Rx, sizeof(UsbCdc_Ep0Rx), count);
+			UsbCdc_Ep0RxCount = (uint16_t)count;
+		} else {
+			UsbCdc_Port *p = &UsbCdc_Ports[(ep - 2U) / 2U];
+
+			UsbCdc_ReadFifo(p->rx, sizeof(p->rx), count);
+			p->rxCount = (uint16_t)(count > sizeof(p->rx) ? sizeof(p->rx) : count);
+			UsbCdc_Statistics.port[(ep - 2U) / 2U].rxBytes += count;
+		}
+	}
+
+	USBCDC_OTG->GINTMSK |= USB_OTG_GINTMSK_RXFLVLM;
+}
+
+/**
+ * @brief  OUT-Endpunkte: SETUP auf EP0, fertig empfangene Pakete
+ */
+static void UsbCdc_OutEndpoints(void) {
+	uint32_t daint = (USBCDC_DEVICE->DAINT & USBCDC_DEVICE->DAINTMSK) >> 16;
+
+	for (uint8_t ep = 0; ep < USBCDC_EP_COUNT; ep++) {
+		if (!(daint & (1U << ep)))
+			continue;
+
+		USB_OTG_OUTEndpointTypeDef *out = USBCDC_OUT(ep);
+		uint32_t flags = out->DOEPINT & USBCDC_DEVICE->DOEPMSK;
+		out->DOEPINT = flags;
+
+		if (ep == 0) {
+			if (flags & USB_OTG_DOEPINT_XFRC)
+				UsbCdc_Ep0OutDone();
+			if (flags & USB_OTG_DOEPINT_STUP)
+				UsbCdc_Setup();
+		} else if (flags & USB_OTG_DOEPINT_XFRC) {
+			// Endpoint NAKs from here until UsbCdc_Receive() arms it again
+			UsbCdc_Ports[(ep - 2U) / 2U].rxFull = 1;
+			UsbCdc_Wake();
+		}
+	}
+}
+
+/**
+ * @brief  IN-Endpunkte: Transfer fertig bzw. Platz im FIFO
+ */
+static void UsbCdc_InEndpoints(void) {
+	uint32_t daint = USBCDC_DEVICE->DAINT & USBCDC_DEVICE->DAINTMSK & 0xFFFFU;
+
+	for (uint8_t ep = 0; ep < USBCDC_EP_COUNT; ep++) {
+		if (!(daint & (1U << ep)))
+			continue;
+
+		USB_OTG_INEndpointTypeDef *in = USBCDC_IN(ep);
+		uint32_t mask = USBCDC_DEVICE->DIEPMSK | (((USBCDC_DEVICE->DIEPEMPMSK >> ep) & 1U) << USB_OTG_DIEPINT_TXFE_Pos);
+		uint32_t flags = in->DIEPINT & mask;
+		UsbCdc_InXfer *x = ep == 0 ? &UsbCdc_Ep0In : (ep & 1U) ? NULL : &UsbCdc_Ports[(ep - 2U) / 2U].in;
+
+		if (flags & USB_OTG_DIEPINT_XFRC) {
+			in->DIEPINT = USB_OTG_DIEPINT_XFRC;
+			USBCDC_DEVICE->DIEPEMPMSK &= ~(1U << ep);
+			if (ep == 0) {
+				UsbCdc_Ep0InDone();
+			} else if (x != NULL && x->busy) {
+				uint8_t index = (uint8_t)((ep - 2U) / 2U);
+				UsbCdc_Port *p = &UsbCdc_Ports[index];
+
+				x->busy = 0;
+				p->serial->tail += x->length;
+				p->serial->sent += x->length;
+				UsbCdc_Statistics.port[index].txBytes += x->length;
+				p->zlpDue = x->length > 0 && (x->length % USBCDC_PACKET_SIZE) == 0;
+				UsbCdc_StartIn(p, index);
+			}
+		}
+		// TXFE clears itself once the FIFO is written
+		if ((flags & USB_OTG_DIEPINT_TXFE) && x != NULL && x->busy)
+			UsbCdc_FillFifo(ep, x);
+	}
+}
+
+/**
+ * @brief  SETUP-Paket auf EP0 auswerten
+ */
+static void UsbCdc_Setup(void) {
+	const uint8_t *s = UsbCdc_SetupPacket;
+	uint8_t type = s[0];
+	uint8_t request = s[1];
+	uint16_t value = (uint16_t)(s[2] | (s[3] << 8));
+	uint16_t index = (uint16_t)(s[4] | (s[5] << 8));
+	uint16_t length = (uint16_t)(s[6] | (s[7] << 8));
+	uint8_t handled = 0;
+
+	UsbCdc_Statistics.setups++;
+	UsbCdc_Ep0OutRequest = 0;
+	UsbCdc_Ep0Remaining = 0;
+
+	if ((type & 0x60) == 0x00)
+		handled = UsbCdc_StandardRequest(type, request, value, index, length);
+	else if ((type & 0x60) == 0x20)
+		handled = UsbCdc_ClassRequest(request, value, index, length);
+
+	if (!handled) {
+		UsbCdc_Statistics.stalls++;
+		UsbCdc_Ep0Stall();
+	}
+	UsbCdc_ArmOut(0, USBCDC_EP0_SIZE);
+}
+
+/**
+ * @brief  Standardanfragen (USB 2.0 Kap. 9.4)
+ * @retval 1 beantwortet, 0 = STALL
+ */
+static uint8_t UsbCdc_StandardRequest(uint8_t type, uint8_t request, uint16_t value, uint16_t index, uint16_t length) {
+	uint8_t ep = (uint8_t)(index & 0x0F);
+
+	switch (request) {
+	case USBCDC_REQ_GET_STATUS:
+		UsbCdc_Ep0Reply[0] = 0;
+		UsbCdc_Ep0Reply[1] = 0;
+		UsbCdc_Ep0Send(UsbCdc_Ep0Reply, 2, length);
+		return 1;
+
+	case USBCDC_REQ_CLEAR_FEATURE:
+	case USBCDC_REQ_SET_FEATURE:
+		// Only ENDPOINT_HALT on the bulk endpoints, DEVICE_REMOTE_WAKEUP is acknowledged and ignored
+		if ((type & 0x1F) == 0x02 && value == 0 && ep != 0 && ep < USBCDC_EP_COUNT) {
+			if (index & 0x80) {
+				if (request == USBCDC_REQ_SET_FEATURE)
+					USBCDC_IN(ep)->DIEPCTL |= USB_OTG_DIEPCTL_STALL;
+				else
+					USBCDC_IN(ep)->DIEPCTL = (USBCDC_IN(ep)->DIEPCTL & ~USB_OTG_DIEPCTL_STALL) | USB_OTG_DIEPCTL_SD0PID_SEVNFRM;
+			} else {
+				if (request == USBCDC_REQ_SET_FEATURE)
+					USBCDC_OUT(ep)->DOEPCTL |= USB_OTG_DOEPCTL_STALL;
+				else
+					USBCDC_OUT(ep)->DOEPCTL = (USBCDC_OUT(ep)->DOEPCTL & ~USB_OTG_DOEPCTL_STALL) | USB_OTG_DOEPCTL_SD0PID_SEVNFRM;
+			}
+		}
+		UsbCdc_Ep0Status();
+		return 1;
+
+	case USBCDC_REQ_SET_ADDRESS:
+		// The core answers the status stage still under address 0
+		USBCDC_DEVICE->DCFG = (USBCDC_DEVICE->DCFG & ~USB_OTG_DCFG_DAD) | ((uint32_t)(value & 0x7F) << USB_OTG_DCFG_DAD_Pos);
+		UsbCdc_Ep0Status();
+		return 1;
+
+	case USBCDC_REQ_GET_DESCRIPTOR:
+		switch (value >> 8) {
+		case USBCDC_DESC_DEVICE:
+			UsbCdc_Ep0Send(UsbCdc_DeviceDesc, sizeof(UsbCdc_DeviceDesc), length);
+			return 1;
+		case USBCDC_DESC_CONFIG:
+			UsbCdc_Ep0Send(UsbCdc_ConfigDesc, sizeof(UsbCdc_ConfigDesc), length);
+			return 1;
+		case USBCDC_DESC_STRING: {
+			uint32_t size = UsbCdc_StringDesc((uint8_t)value);
+			if (size == 0)
+				return 0;
+			UsbCdc_Ep0Send(UsbCdc_Ep0Reply, size, length);
+			return 1;
+		}
+		default:
+			return 0;         // no device qualifier: full speed only
+		}
+
+	case USBCDC_REQ_GET_CONFIG:
+		UsbCdc_Ep0Reply[0] = UsbCdc_Configuration;
+		UsbCdc_Ep0Send(UsbCdc_Ep0Reply, 1, length);
+		return 1;
+
+	case USBCDC_REQ_SET_CONFIG:
+		if (value > 1)
+			return 0;
+		UsbCdc_Configure((uint8_t)value);
+		UsbCdc_Ep0Status();
+		return 1;
+
+	case USBCDC_REQ_GET_INTERFACE:
+		UsbCdc_Ep0Reply[0] = 0;
+		UsbCdc_Ep0Send(UsbCdc_Ep0Reply, 1, length);
+		return 1;
+
+	case USBCDC_REQ_SET_INTERFACE:
+		if (value != 0)
+			return 0;
+		UsbCdc_Ep0Status();
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief  CDC-Anfragen an ein Steuer-Interface (PSTN 1.2, Kap. 6.3)
+ * @retval 1 beantwortet, 0 = STALL
+ */
+static uint8_t UsbCdc_ClassRequest(uint8_t request, uint16_t value, uint16_t index, uint16_t length) {
+	uint8_t port = (uint8_t)((index & 0xFF) / 2U);
+
+	if (port >= USBCDC_PORT_COUNT)
+		return 0;
+
+	switch (request) {
+	case USBCDC_REQ_SET_LINE_CODING:
+		if (length < USBCDC_LINE_CODING_SIZE)
+			return 0;
+		// Data stage first, UsbCdc_Ep0OutDone() answers the status stage
+		UsbCdc_Ep0OutRequest = request;
+		UsbCdc_Ep0OutPort = port;
+		UsbCdc_Ep0RxCount = 0;
+		return 1;
+
+	case USBCDC_REQ_GET_LINE_CODING:
+		UsbCdc_Ep0Send(UsbCdc_Ports[port].lineCoding, USBCDC_LINE_CODING_SIZE, length);
+		return 1;
+
+	case USBCDC_REQ_SET_LINE_STATE:
+		UsbCdc_Ports[port].dtr = value & 0x01;
+		UsbCdc_Ep0Status();
+		UsbCdc_Wake();
+		return 1;
+
+	case USBCDC_REQ_SEND_BREAK:
+		UsbCdc_Ep0Status();
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief  Baut einen String-Deskriptor in UsbCdc_Ep0Reply
+ * @retval Länge in Bytes, 0 wenn es den Index nicht gibt
+ */
+static uint32_t UsbCdc_StringDesc(uint8_t index) {
+	static const char hex[] = "0123456789ABCDEF";
+	char serial[25];
+	const char *text;
+	uint32_t length;
+
+	if (index == 0) {
+		// Language ID table: English (US)
+		UsbCdc_Ep0Reply[0] = 4;
+		UsbCdc_Ep0Reply[1] = USBCDC_DESC_STRING;
+		UsbCdc_Ep0Reply[2] = 0x09;
+		UsbCdc_Ep0Reply[3] = 0x04;
+		return 4;
+	}
+	if (index >= USBCDC_STRING_COUNT)
+		return 0;
+
+	text = UsbCdc_Strings[index];
+	if (text == NULL) {
+		// 96 bit unique device ID, the host tells several boards apart by it
+		for (uint8_t w = 0; w < 3; w++) {
+			uint32_t id = *(const volatile uint32_t *)(UID_BASE + 4U * w);
+			for (uint8_t n = 0; n < 8; n++)
+				serial[w * 8 + n] = hex[(id >> (28 - 4 * n)) & 0x0F];
+		}
+		serial[24] = '\0';
+		text = serial;
+	}
+
+	length = strlen(text);
+	if (length > (sizeof(UsbCdc_Ep0Reply) - 2) / 2)
+		length = (sizeof(UsbCdc_Ep0Reply) - 2) / 2;
+	UsbCdc_Ep0Reply[0] = (uint8_t)(2 + 2 * length);
+	UsbCdc_Ep0Reply[1] = USBCDC_DESC_STRING;
+	for (uint32_t i = 0; i < length; i++) {
+		UsbCdc_Ep0Reply[2 + 2 * i] = (uint8_t)text[i];
+		UsbCdc_Ep0Reply[3 + 2 * i] = 0;
+	}
+	return 2 + 2 * length;
+}
+
+/**
+ * @brief  Konfiguration 1 schaltet die Endpunkte beider Ports ein, 0 schaltet sie ab
+ *
+ * Laufende Transfers gehen verloren, ihr Inhalt liegt noch im Ring. Der Timer gibt die Ringe danach an die UARTs zurück.
+ */
+static void UsbCdc_Configure(uint8_t configuration) {
+	for (uint8_t i = 0; i < USBCDC_PORT_COUNT; i++) {
+		UsbCdc_Port *p = &UsbCdc_Ports[i];
+		uint8_t notifyEp = (uint8_t)USBCDC_NOTIFY_EP(i);
+		uint8_t dataEp = (uint8_t)USBCDC_DATA_EP(i);
+
+		if (p->in.busy) {
+			UsbCdc_AbortIn(dataEp);
+			p->in.busy = 0;
+			UsbCdc_Statistics.port[i].aborted++;
+		}
+		p->zlpDue = 0;
+		p->rxFull = 0;
+		p->rxPos = 0;
+		p->rxCount = 0;
+		p->dtr = 0;
+
+		if (configuration) {
+			USBCDC_IN(notifyEp)->DIEPCTL = USBCDC_NOTIFY_SIZE | (3U << USB_OTG_DIEPCTL_EPTYP_Pos)
+					| ((uint32_t)notifyEp << USB_OTG_DIEPCTL_TXFNUM_Pos) | USB_OTG_DIEPCTL_SD0PID_SEVNFRM | USB_OTG_DIEPCTL_USBAEP;
+			USBCDC_IN(dataEp)->DIEPCTL = USBCDC_PACKET_SIZE | (2U << USB_OTG_DIEPCTL_EPTYP_Pos)
+					| ((uint32_t)dataEp << USB_OTG_DIEPCTL_TXFNUM_Pos) | USB_OTG_DIEPCTL_SD0PID_SEVNFRM | USB_OTG_DIEPCTL_USBAEP;
+			USBCDC_OUT(dataEp)->DOEPCTL = USBCDC_PACKET_SIZE | (2U << USB_OTG_DOEPCTL_EPTYP_Pos)
+					| USB_OTG_DOEPCTL_SD0PID_SEVNFRM | USB_OTG_DOEPCTL_USBAEP;
+			USBCDC_DEVICE->DAINTMSK |= (1U << dataEp) | (1U << (16 + dataEp));
+			UsbCdc_ArmOut(dataEp, USBCDC_PACKET_SIZE);
+		} else {
+			USBCDC_DEVICE->DAINTMSK &= ~((1U << notifyEp) | (1U << dataEp) | (1U << (16 + dataEp)));
+			USBCDC_IN(notifyEp)->DIEPCTL &= ~USB_OTG_DIEPCTL_USBAEP;
+			USBCDC_IN(dataEp)->DIEPCTL &= ~USB_OTG_DIEPCTL_USBAEP;
+			USBCDC_OUT(dataEp)->DOEPCTL &= ~USB_OTG_DOEPCTL_USBAEP;
+		}
+	}
+	UsbCdc_Configuration = configuration;
+	UsbCdc_Statistics.configured = configuration != 0;
+	UsbCdc_Wake();
+}
+
+/**
+ * @brief  Datenstufe einer Anfrage an EP0 senden, paketweise
+ * @param  requested: wLength des PCs; eine kürzere Antwort aus vollen Paketen endet mit einem Null-Paket
+ */
+static void UsbCdc_Ep0Send(const uint8_t *data, uint32_t length, uint16_t requested) {
+	uint32_t chunk;
+
+	if (length > requested)
+		length = requested;
+	UsbCdc_Ep0Zlp = length < requested && (length % USBCDC_EP0_SIZE) == 0;
+
+	chunk = length > USBCDC_EP0_SIZE ? USBCDC_EP0_SIZE : length;
+	UsbCdc_Ep0Data = data + chunk;
+	UsbCdc_Ep0Remaining = length - chunk;
+	if (chunk == 0)
+		UsbCdc_Ep0Zlp = 0;
+	UsbCdc_StartXfer(0, &UsbCdc_Ep0In, data, chunk);
+}
+
+/**
+ * @brief  Statusstufe einer Anfrage ohne Datenstufe: Null-Paket auf EP0
+ */
+static void UsbCdc_Ep0Status(void) {
+	UsbCdc_Ep0Remaining = 0;
+	UsbCdc_Ep0Zlp = 0;
+	UsbCdc_StartXfer(0, &UsbCdc_Ep0In, NULL, 0);
+}
+
+/**
+ * @brief  Anfrage ablehnen, die Hardware löscht STALL beim nächsten SETUP
+ */
+static void UsbCdc_Ep0Stall(void) {
+	USBCDC_IN(0)->DIEPCTL |= USB_OTG_DIEPCTL_STALL;
+	USBCDC_OUT(0)->DOEPCTL |= USB_OTG_DOEPCTL_STALL;
+}
+
+/**
+ * @brief  Paket auf EP0 gesendet: nächstes Paket der Datenstufe, abschließendes Null-Paket oder fertig
+ */
+static void UsbCdc_Ep0InDone(void) {
+	UsbCdc_Ep0In.busy = 0;
+
+	if (UsbCdc_Ep0Remaining > 0) {
+		uint32_t chunk = UsbCdc_Ep0Remaining > USBCDC_EP0_SIZE ? USBCDC_EP0_SIZE : UsbCdc_Ep0Remaining;
+		const uint8_t *data = UsbCdc_Ep0Data;
+
+		UsbCdc_Ep0Data += chunk;
+		UsbCdc_Ep0Remaining -= chunk;
+		UsbCdc_StartXfer(0, &UsbCdc_Ep0In, data, chunk);
+	} else if (UsbCdc_Ep0Zlp) {
+		UsbCdc_Ep0Zlp = 0;
+		UsbCdc_StartXfer(0, &UsbCdc_Ep0In, NULL, 0);
+	}
+}
+
+/**
+ * @brief  OUT auf EP0 fertig: Datenstufe von SET_LINE_CODING oder Statusstufe einer IN-Anfrage
+ */
+static void UsbCdc_Ep0OutDone(void) {
+	if (UsbCdc_Ep0OutRequest == USBCDC_REQ_SET_LINE_CODING && UsbCdc_Ep0RxCount >= USBCDC_LINE_CODING_SIZE) {
+		UsbCdc_Port *p = &UsbCdc_Ports[UsbCdc_Ep0OutPort];
+		uint32_t baud;
+
+		// Only recorded: the bytes go out as fast as USB carries them
+		memcpy(p->lineCoding, UsbCdc_Ep0Rx, USBCDC_LINE_CODING_SIZE);
+		memcpy(&baud, p->lineCoding, sizeof(baud));
+		UsbCdc_Statistics.port[UsbCdc_Ep0OutPort].baud = baud;
+		UsbCdc_Ep0OutRequest = 0;
+		UsbCdc_Ep0Status();
+	}
+	UsbCdc_ArmOut(0, USBCDC_EP0_SIZE);
+}
+
+/**
+ * @brief  Timer sofort laufen lassen (aus dem Interrupt)
+ */
+static void UsbCdc_Wake(void) {
+	if (Timer_Remaining(&UsbCdc_Timer) > 1)
+		Timer_Start(&UsbCdc_Timer, 1, UsbCdc_PeriodMs);
+}
+
+#endif /* USBCDC_ENABLE */
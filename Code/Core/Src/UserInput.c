@@ -21,10 +21,13 @@
  * Betriebsmodus:
  * - USE_POLLING: Aktiviert den Polling-Modus (regelmäßige Pin-Abfrage)
  * - USE_INTERRUPT: Aktiviert den Interrupt-Modus (event-gesteuerte Verarbeitung)
+ * - USE_DMA_SAMPLING: TIM2 lässt DMA die Ports mit USER_INPUT_SAMPLE_HZ abtasten
  *
  * Entprellmethode:
- * - DEBOUNCE_WITH_DELAY: Verwendet HAL_Delay für die Entprellung
- * - DEBOUNCE_WITH_TIMER: Verwendet Timer-Interrupts (TIM6) für die Entprellung
+ * - DEBOUNCE_WITH_DELAY: Bestätigt neue Drücke nach USER_INPUT_SETTLE_MS, ohne zu warten
+ * - DEBOUNCE_WITH_TIMER: Entprellt jede Eingabe einzeln im 1-ms-Takt von TIM7
+ *
+ * - USER_INPUT_DEBOUNCE_MS: Entprellzeit in Millisekunden (DEBOUNCE_WITH_TIMER)
  */
 
 /******************************************************************************
@@ -33,29 +36,29 @@
 /* 1. Initialisierung:
  *    - GPIO-Pins für die Buttons konfigurieren
  *    - Bei USE_INTERRUPT: Externe Interrupts für die Pins aktivieren
- *    - Bei DEBOUNCE_WITH_TIMER: TIM6-Timer konfigurieren
+ *    - Bei DEBOUNCE_WITH_TIMER: Realtime_Loop() ruft UserInput_Tick() jede Millisekunde auf
+ *    - Bei USE_DMA_SAMPLING: UserInput_StartSampling() nach Timebase_Init() aufrufen
  *
  * 2. Hauptschleife im Polling-Modus:
  *    while (1) {
- *        PollingUserInput();          // Erfasst Benutzereingaben
- *        HandlePendingUserInput();    // Überträgt Flankenereignisse
- *
- *        // Überprüfen der Flankenvariablen
- *        if (MDS_UP_Flanke) {
- *            // Aktion für MDS_UP ausführen
- *            ResetFlanken();          // Flanken zurücksetzen
+ *        PollingUserInput();          // Nur bei DEBOUNCE_WITH_DELAY
+ *
+ *        // Alle seit dem letzten Durchlauf erkannten Ereignisse abholen
+ *        UserInput_Event event;
+ *        while (UserInput_GetEvent(&event)) {
+ *            if (event.input == MDS_UP) {
+ *                // Aktion für MDS_UP ausführen
+ *            }
  *        }
  *    }
  *
  * 3. Hauptschleife im Interrupt-Modus:
  *    while (1) {
- *        HandleMDSLeft();             // MDS_LEFT per Polling abfragen
- *        HandlePendingUserInput();    // Überträgt Flankenereignisse
- *
- *        // Überprüfen der Flankenvariablen
- *        if (MDS_DOWN_Flanke) {
- *            // Aktion für MDS_DOWN ausführen
- *            ResetFlanken();          // Flanken zurücksetzen
+ *        UserInput_Event event;
+ *        while (UserInput_GetEvent(&event)) {
+ *            if (event.input == MDS_DOWN) {
+ *                // Aktion für MDS_DOWN ausführen
+ *            }
  *        }
  *    }
  */
@@ -66,376 +69,786 @@
 /* Öffentliche Funktionen:
  *
  * - PollingUserInput(): Erfasst Eingaben im Polling-Modus
- *   Aufruf: Regelmäßig in der Hauptschleife (nur bei USE_POLLING)
+ *   Aufruf: Regelmäßig in der Hauptschleife (nur bei USE_POLLING und DEBOUNCE_WITH_DELAY)
+ *
+ * - UserInput_Tick(): Entprellt alle aktiven Eingaben
+ *   Aufruf: Jede Millisekunde aus Realtime_Loop() (nur bei DEBOUNCE_WITH_TIMER)
+ *
+ * - UserInput_GetEvent(): Holt das älteste Ereignis aus der Warteschlange
+ *   Aufruf: In einer Schleife, bis 0 zurückkommt
+ *
+ * - UserInput_GetDropped(): Zahl der verworfenen Ereignisse (Warteschlange voll)
+ *
+ * - UserInput_GetEventCount(): Zahl aller eingereihten Ereignisse, zeigt Aktivität an (LowPower.c)
  *
- * - HandlePendingUserInput(): Überträgt anstehende Flanken in globale Variablen
- *   Aufruf: Regelmäßig in der Hauptschleife
+ * - UserInput_SetLongPress(), UserInput_SetRepeat(): Zeiten für langen Druck und
+ *   Wiederholung (nur bei DEBOUNCE_WITH_TIMER)
  *
- * - ResetFlanken(): Setzt alle Flankenvariablen zurück
- *   Aufruf: Nach der Verarbeitung erkannter Flanken
+ * - UserInput_GetPressed(): Entprellter Zustand aller Eingaben als Bitfeld
  *
- * - HandleMDSLeft(): Spezialbehandlung für MDS_LEFT-Eingabe
- *   Aufruf: Regelmäßig in der Hauptschleife (im Interrupt-Modus)
+ * - UserInput_Inject(): Zustand externer Eingaben ohne Entprellung (Gamepad.c), erzeugt die
+ *   gleichen Ereignisse in derselben Warteschlange (nur bei DEBOUNCE_WITH_TIMER)
  *
  * - UserInput_Interrupt(): ISR für GPIO-Interrupts
  *   Aufruf: Wird automatisch von HAL_GPIO_EXTI_Callback() aufgerufen
+ *
+ * - UserInput_StartSampling(): Startet die Abtastung per DMA (nur bei USE_DMA_SAMPLING)
  */
 
 /******************************************************************************
  * BESONDERHEITEN
  ******************************************************************************/
-/* - Die MDS_LEFT-Taste wird immer per Polling abgefragt, auch im Interrupt-Modus,
- *   da MDS_LEFT und MDS_RIGHT den gleichen GPIO-Pin (Pin 5) teilen.
- *
- * - Das Modul verwendet einen zweistufigen Prozess mit "Pending"-Flags, um
- *   Race-Conditions zwischen Interrupt-Kontext und Hauptprogramm zu vermeiden.
+/* - Alle Eingaben werden über ein Portabbild gelesen: jedes IDR (GPIOB, C, D, E) wird
+ *   einmal gelesen und in ein Bitfeld gepackt (Bit = enum UserInputs, 1 = gedrückt).
+ *   Flanken ergeben sich per XOR mit dem vorherigen bzw. entprellten Abbild. MDS_LEFT,
+ *   das keinen eigenen EXTI-Interrupt hat (gleiche Pin-Nummer wie MDS_RIGHT), braucht
+ *   dadurch keine Sonderbehandlung mehr.
+ *
+ * - Erkannte Flanken landen in einem Ringpuffer mit genau einem Schreiber (Entprell-Takt
+ *   bzw. Polling) und einem Leser (Anwendung). Kopf und Ende werden nur von
+ *   jeweils einer Seite geschrieben, daher braucht es keine Sperren; Speicherbarrieren
+ *   sorgen dafür, dass ein Eintrag vollständig ist, bevor der Leser ihn sieht.
+ *   Mehrere Drücke zwischen zwei Abfragen gehen so nicht verloren und werden nicht
+ *   zusammengefasst. Jedes Ereignis trägt den DWT-Zählerstand der Flanke, daraus
+ *   lässt sich die Latenz bis zur Verarbeitung berechnen.
+ *
+ * - Mit DEBOUNCE_WITH_TIMER hat jede Eingabe ihren eigenen Integrator. Der EXTI-Interrupt
+ *   liefert nur den Zeitstempel, entprellt wird im 1-ms-Takt. Gleichzeitig gedrückte Tasten
+ *   stören sich nicht, und es werden Drücke und Loslassen gemeldet. Mit DEBOUNCE_WITH_DELAY
+ *   gibt es nur Drücke (USER_INPUT_PRESSED).
+ *
+ * - Aus dem gleichen Takt kommen die höheren Ereignisse: USER_INPUT_LONG_PRESS nach
+ *   USER_INPUT_LONG_PRESS_MS, USER_INPUT_REPEAT beim Halten der Joystick-Richtungen und
+ *   USER_INPUT_CHORD, wenn mehrere Eingaben gleichzeitig gedrückt sind. Die Anwendung muss
+ *   dafür keine Schleifendurchläufe zählen.
  *
  * - Zustandsvariablen sind als `volatile` deklariert für die korrekte
  *   Verwendung in Interrupt-Kontexten.
  *
- * - Bei DEBOUNCE_WITH_TIMER wird TIM6 für die zeitgesteuerte Entprellung verwendet.
- *   Die Timer-ISR ruft HandleDebouncedUserInput() auf.
+ * - Solange eine Eingabe entprellt oder gehalten wird, meldet UserInput_IsBusy() das,
+ *   Realtime_Sleep() bleibt dann beim 1-ms-Takt.
+ *
+ * - Mit USE_DMA_SAMPLING gibt es weder EXTI-Interrupts je Flanke (ein Preller = ein Interrupt)
+ *   noch den 1-ms-Takt. Die Compare-Ereignisse CC1-CC4 von TIM2 lösen je einen DMA-Stream aus,
+ *   der das IDR von GPIOB, C, D bzw. E in einen Ringpuffer schreibt. Eine Timer-Anforderung
+ *   bedient nur einen Stream, deshalb vier Kanäle mit gleicher Periode. CC4 (GPIOE) liegt eine
+ *   halbe Periode hinter CC1-CC3: wenn der Stream von GPIOE einen halben Puffer meldet, sind die
+ *   übrigen drei damit sicher fertig. Der Interrupt setzt aus den vier Puffern je Abtastung das
+ *   Portabbild zusammen und lässt die Integratoren den ganzen Block durchlaufen, gezählt wird in
+ *   Abtastungen. Zeitstempel ergeben sich aus dem Index der Abtastung (1/USER_INPUT_SAMPLE_HZ
+ *   genau), nicht aus dem Eintritt in den Interrupt.
  */
 
 #include "UserInput.h"
+#include "Topic.h"
+#include "Timebase.h"
+#ifdef USE_DMA_SAMPLING
+#include "Cache.h"
+#include "DmaAlloc.h"
+#include "Irq.h"
+#endif
 
-#ifdef USE_POLLING
+/// Ringpuffer der Eingabeereignisse, Kopf schreibt nur der Erzeuger, Ende nur der Leser
+UserInput_Event UserInput_Queue[USER_INPUT_QUEUE_SIZE];
+volatile uint32_t UserInput_QueueHead = 0;
+volatile uint32_t UserInput_QueueTail = 0;
+volatile uint32_t UserInput_QueueDropped = 0;
+/// Erkannte Ereignisse einschließlich verworfener, Zähler in TOPIC_INPUT
+static uint32_t UserInput_EventCount = 0;
 
-/// Variable um den vorherigen Status der einzelnen Pins zu speichern
-uint8_t MDS_RIGHT_LetzterStatus = 0;
-uint8_t MDS_UP_LetzterStatus = 0;
-uint8_t MDS_DOWN_LetzterStatus = 0;
-uint8_t MDS_BUTTON_LetzterStatus = 0;
-uint8_t USER_BUTTON_LetzterStatus = 0;
+static const char* const UserInput_Names[] = {
+     "MDS_LEFT", "MDS_RIGHT", "MDS_UP", "MDS_DOWN", "MDS_BUTTON", "USER_BUTTON",
+     "PAD_LEFT", "PAD_RIGHT", "PAD_UP", "PAD_DOWN", "PAD_CROSS", "PAD_CIRCLE",
+     "PAD_SQUARE", "PAD_TRIANGLE", "PAD_L1", "PAD_R1", "PAD_OPTIONS", "PAD_PS"
+};
 
-uint8_t MDS_LEFT_Status = 0;
-uint8_t MDS_RIGHT_Status = 0;
-uint8_t MDS_UP_Status = 0;
-uint8_t MDS_DOWN_Status = 0;
-uint8_t MDS_BUTTON_Status = 0;
-uint8_t USER_BUTTON_Status = 0;
+static void UserInput_PushEvent(enum UserInputs userInput, enum UserInputEvents type, uint32_t mask, uint64_t timeUs);
 
+/// Bit einer Eingabe im Abbild, wenn ihr Pin im gelesenen IDR gesetzt ist
+#define USER_INPUT_BIT(idr, pin, input)  ((((idr) & (pin)) != 0U) ? (1UL << (input)) : 0UL)
 
-#ifdef DEBOUNCE_WITH_TIMER
+/// Eingaben, die im gedrückten Zustand LOW sind
+#define USER_INPUT_ACTIVE_LOW  (1UL << USER_BUTTON)
+
+/**
+ * @brief Packt die IDR-Werte der vier Ports in ein Abbild der Eingaben
+ *
+ * Da Pins und Bitpositionen Konstanten sind, bleiben davon nur Schiebe- und Maskenbefehle übrig.
+ *
+ * @return Abbild der gedrückten Eingaben (Bit = enum UserInputs, 1 = gedrückt)
+ */
+static inline uint32_t UserInput_Pack(uint32_t portB, uint32_t portC, uint32_t portD, uint32_t portE) {
+     uint32_t levels = USER_INPUT_BIT(portE, MDS_LEFT_Pin, MDS_LEFT)
+                     | USER_INPUT_BIT(portB, MDS_RIGHT_Pin, MDS_RIGHT)
+                     | USER_INPUT_BIT(portE, MDS_UP_Pin, MDS_UP)
+                     | USER_INPUT_BIT(portE, MDS_DOWN_Pin, MDS_DOWN)
+                     | USER_INPUT_BIT(portD, MDS_BUTTON_Pin, MDS_BUTTON)
+                     | USER_INPUT_BIT(portC, USER_BUTTON_Pin, USER_BUTTON);
+
+     return levels ^ USER_INPUT_ACTIVE_LOW;
+}
+
+/**
+ * @brief Liest alle Eingaben mit einem Zugriff je Port
+ *
+ * Die Eingaben liegen auf GPIOB, C, D und E. Jedes IDR wird genau einmal gelesen und
+ * in ein gepacktes Abbild übertragen.
+ *
+ * @return Abbild der gedrückten Eingaben
+ */
+static inline uint32_t UserInput_ReadInputs(void) {
+     return UserInput_Pack(GPIOB->IDR, GPIOC->IDR, GPIOD->IDR, GPIOE->IDR);
+}
 
+#ifdef DEBOUNCE_WITH_TIMER
 
+/// Obere Grenze der Integratoren: Millisekunden im 1-ms-Takt, Abtastungen bei USE_DMA_SAMPLING
+#ifdef USE_DMA_SAMPLING
+#define USER_INPUT_DEBOUNCE_COUNT  (USER_INPUT_DEBOUNCE_MS * USER_INPUT_SAMPLE_HZ / 1000)
+#else
+#define USER_INPUT_DEBOUNCE_COUNT  USER_INPUT_DEBOUNCE_MS
 #endif
+
+#if USER_INPUT_DEBOUNCE_COUNT > 255 || USER_INPUT_DEBOUNCE_COUNT < 1
+#error "Die Entprellzeit muss 1 bis 255 Takte bzw. Abtastungen lang sein!"
 #endif
 
-#ifdef USE_INTERRUPT
+/**
+ * @brief Entprellzustand einer Eingabe
+ *
+ * count ist ein Integrator: jeder Takt (bzw. jede Abtastung), in dem die Eingabe gedrückt
+ * gelesen wird, zählt ihn hoch, sonst herunter, begrenzt auf 0 und USER_INPUT_DEBOUNCE_COUNT.
+ * Der entprellte Zustand wechselt erst, wenn eine Grenze erreicht ist; Preller bewegen den
+ * Zähler nur ein Stück.
+ */
+typedef struct UserInput_Debounce{
+     uint8_t count;                 ///< Integrator, 0 bis USER_INPUT_DEBOUNCE_COUNT
+     uint8_t timed;                 ///< timeUs gehört zum laufenden Übergang
+     uint8_t longSent;              ///< USER_INPUT_LONG_PRESS für diesen Druck schon gemeldet
+     uint64_t timeUs;               ///< Timebase_Us() der ersten Flanke des Übergangs
+     uint32_t heldMs;               ///< Millisekunden seit dem entprellten Druck
+     uint32_t nextRepeatMs;         ///< heldMs, bei dem die nächste Wiederholung fällig ist
+}UserInput_Debounce;
 
-#endif
+UserInput_Debounce UserInput_State[USER_INPUT_NONE];
+
+/// Entprellter Zustand (Bit = enum UserInputs, 1 = gedrückt)
+volatile uint32_t UserInput_Stable = 0;
+
+/// Eingaben, deren Integrator gerade nicht an seiner Ruhegrenze steht
+volatile uint32_t UserInput_Moving = 0;
 
-uint8_t MDS_LEFT_LetzterStatus = 0;
+/// Eingaben mit EXTI-Zeitstempel seit dem letzten Takt
+volatile uint32_t UserInput_Armed = 0;
 
+/// Zeiten für langen Druck und Wiederholung, siehe UserInput_SetLongPress() und UserInput_SetRepeat()
+volatile uint16_t UserInput_LongPressMs = USER_INPUT_LONG_PRESS_MS;
+volatile uint32_t UserInput_RepeatMask = USER_INPUT_REPEAT_DEFAULT;
+volatile uint16_t UserInput_RepeatDelayMs = USER_INPUT_REPEAT_DELAY_MS;
+volatile uint16_t UserInput_RepeatIntervalMs = USER_INPUT_REPEAT_INTERVAL_MS;
 
-volatile uint8_t Pending_MDS_LEFT_Flanke = 0;
-volatile uint8_t Pending_MDS_RIGHT_Flanke = 0;
-volatile uint8_t Pending_MDS_UP_Flanke = 0;
-volatile uint8_t Pending_MDS_DOWN_Flanke = 0;
-volatile uint8_t Pending_MDS_BUTTON_Flanke = 0;
-volatile uint8_t Pending_USER_BUTTON_Flanke = 0;
+static uint32_t UserInput_Integrate(uint32_t pressed, uint32_t active, uint32_t step, uint64_t now);
+static void UserInput_TickHeld(uint32_t held, uint32_t mask, uint32_t elapsedMs, uint64_t now);
 
-/// Variable welche den aktuellen Status der Pins speichert
-volatile uint8_t MDS_LEFT_Flanke = 0;
-volatile uint8_t MDS_RIGHT_Flanke = 0;
-volatile uint8_t MDS_UP_Flanke = 0;
-volatile uint8_t MDS_DOWN_Flanke = 0;
-volatile uint8_t MDS_BUTTON_Flanke = 0;
-volatile uint8_t USER_BUTTON_Flanke = 0;
+#ifndef USE_DMA_SAMPLING
 
 /**
- * @brief Speichert Informationen zur zuletzt erkannten Benutzereingabe
+ * @brief Entprellt alle Eingaben, wird aus Realtime_Loop() aufgerufen
+ *
+ * Liest das Abbild aller Eingaben mit UserInput_ReadInputs() und vergleicht es per XOR mit
+ * dem entprellten Abbild. Nur Eingaben, die davon abweichen, deren Integrator noch läuft
+ * oder deren Interrupt seit dem letzten Takt ausgelöst hat, werden einzeln behandelt; in
+ * Ruhe kostet ein Takt damit nur vier Portzugriffe und einen Vergleich.
+ *
+ * Jede Eingabe hat ihren eigenen Integrator, mehrere Tasten werden also gleichzeitig
+ * entprellt und Kombinationen (z.B. Joystick und Taster) kommen beide an. Jede Eingabe
+ * meldet Drücken und Loslassen nach USER_INPUT_DEBOUNCE_MS stabilen Millisekunden.
+ * Ist beim Drücken schon eine andere Eingabe gedrückt, folgt USER_INPUT_CHORD mit allen
+ * gedrückten Eingaben in mask. Gehaltene Eingaben zählen danach in UserInput_TickHeld()
+ * ihre Haltezeit für langen Druck und Wiederholung.
+ *
+ * Der Zeitstempel eines Ereignisses ist der EXTI-Eintritt bzw. der erste Takt, in dem
+ * die Eingabe vom entprellten Zustand abwich.
  *
- * Diese Variable enthält die Pin-Informationen (GPIO-Port und Pin-Nummer)
- * der zuletzt erkannten Benutzereingabe. Sie wird verwendet, um die
- * Verarbeitung der Eingabe nach einem Entprellvorgang zu ermöglichen.
+ * @param elapsedMs Millisekunden seit dem letzten Aufruf (nach einem Tickless-Schlaf mehr als 1)
+ *
+ * @note Läuft im Interrupt von TIM7. EXTI und TIM7 haben die gleiche Priorität und
+ *       unterbrechen sich nicht gegenseitig, die Abbilder brauchen deshalb keine Sperre.
  */
-Pin LetzterUserInputPin;
+RAMFUNC void UserInput_Tick(uint32_t elapsedMs) {
+     uint64_t now = Timebase_Us();
+     uint32_t step = elapsedMs < USER_INPUT_DEBOUNCE_COUNT ? elapsedMs : USER_INPUT_DEBOUNCE_COUNT;
+     uint32_t pressed = UserInput_ReadInputs();
+     uint32_t active = ((pressed ^ UserInput_Stable) & USER_INPUT_PIN_MASK) | UserInput_Moving | UserInput_Armed;
+
+     UserInput_Armed = 0;
+
+     uint32_t newlyPressed = UserInput_Integrate(pressed, active, step, now);
+
+     // Inputs pressed in this tick start counting with the next one
+     uint32_t stable = UserInput_Stable;
+     UserInput_TickHeld(stable & ~newlyPressed, stable, elapsedMs, now);
+}
+#endif
 
 /**
- * @brief Enum-Wert für die zuletzt erkannte Benutzereingabe
+ * @brief Bewegt die Integratoren der aktiven Eingaben um einen Takt bzw. eine Abtastung
  *
- * Diese Variable speichert den Typ der zuletzt erkannten Benutzereingabe
- * (z. B. MDS_UP, MDS_BUTTON, usw.). Sie wird verwendet, um die Flanke
- * nach einem Entprellvorgang zu identifizieren und zu verarbeiten.
+ * @param pressed Abbild der gelesenen Eingaben
+ * @param active Eingaben, die abweichen, deren Integrator läuft oder die einen Zeitstempel haben
+ * @param step Schritte je Integrator (mehr als 1 nach einem Tickless-Schlaf)
+ * @param now Timebase_Us() der Abtastung, Zeitstempel eines neuen Übergangs
+ * @return Eingaben, die dabei entprellt gedrückt wurden
  */
-enum UserInputs LetzterUserInput = USER_INPUT_NONE;
+static RAMFUNC uint32_t UserInput_Integrate(uint32_t pressed, uint32_t active, uint32_t step, uint64_t now) {
+     uint32_t stable = UserInput_Stable;
+     uint32_t moving = UserInput_Moving;
+     uint32_t newlyPressed = 0;
+
+     while (active) {
+          uint32_t i = __CLZ(__RBIT(active));
+          uint32_t bit = 1UL << i;
+          active &= ~bit;
 
-extern TIM_HandleTypeDef htim6;
+          UserInput_Debounce *state = &UserInput_State[i];
+          uint32_t count = state->count;
+
+          if (pressed & bit) {
+               count = (count + step < USER_INPUT_DEBOUNCE_COUNT) ? count + step : USER_INPUT_DEBOUNCE_COUNT;
+          }
+          else {
+               count = (count > step) ? count - step : 0;
+          }
+          state->count = (uint8_t)count;
+
+          if (!state->timed) {
+               // First sample that differs from the debounced state starts a transition
+               state->timeUs = now;
+          }
+          state->timed = 1;
+
+          if (!(stable & bit) && count == USER_INPUT_DEBOUNCE_COUNT) {
+               stable |= bit;
+               newlyPressed |= bit;
+               state->heldMs = 0;
+               state->nextRepeatMs = UserInput_RepeatDelayMs;
+               state->longSent = 0;
+               UserInput_PushEvent((enum UserInputs)i, USER_INPUT_PRESSED, stable, state->timeUs);
+               if (stable & (stable - 1)) {
+                    // At least one other input is held as well
+                    UserInput_PushEvent((enum UserInputs)i, USER_INPUT_CHORD, stable, state->timeUs);
+               }
+               state->timed = 0;
+          }
+          else if ((stable & bit) && count == 0) {
+               stable &= ~bit;
+               UserInput_PushEvent((enum UserInputs)i, USER_INPUT_RELEASED, stable, state->timeUs);
+               state->timed = 0;
+          }
+          else if (count == ((stable & bit) ? USER_INPUT_DEBOUNCE_COUNT : 0)) {
+               // Back at rest without a change (glitch), the next edge gets a new timestamp
+               state->timed = 0;
+          }
+
+          if (count == ((stable & bit) ? USER_INPUT_DEBOUNCE_COUNT : 0)) {
+               moving &= ~bit;
+          }
+          else {
+               moving |= bit;
+          }
+     }
+
+     UserInput_Stable = stable;
+     UserInput_Moving = moving;
+     return newlyPressed;
+}
 
-volatile uint8_t debounce_in_progress = 0;
 /**
- * @brief Behandelt Flankenereignisse für Benutzereingaben mit Entprellung.
- *
- * Diese Funktion implementiert die Verarbeitung von erkannten Flanken bei
- * Benutzereingaben (Buttons) und kümmert sich um die Entprellung je nach
- * konfiguriertem Modus (Delay oder Timer).
+ * @brief Haltezeit der gedrückten Eingaben weiterzählen, langen Druck und Wiederholungen melden
  *
- * @param pin Struktur mit GPIO-Port und Pin-Nummer des betroffenen Pins.
- * @param userInput Enum-Wert, der identifiziert, welche Benutzereingabe erkannt wurde.
- * @param flankenVariable Zeiger auf die Flag-Variable, die bei bestätigter Flanke gesetzt wird.
+ * USER_INPUT_LONG_PRESS kommt einmal je Druck, sobald die Haltezeit UserInput_LongPressMs
+ * erreicht. USER_INPUT_REPEAT kommt für Eingaben in UserInput_RepeatMask zuerst nach
+ * UserInput_RepeatDelayMs und dann alle UserInput_RepeatIntervalMs. Nach einem langen
+ * Tickless-Zyklus gibt es höchstens eine Wiederholung je Takt, statt alle nachzuholen.
  *
- * Abhängig von der Konfiguration:
- * - Bei DEBOUNCE_WITH_DELAY: Wartet für einen bestimmten Zeitraum und prüft dann erneut.
- * - Bei DEBOUNCE_WITH_TIMER: Startet einen Timer-Interrupt und speichert die
- *   Pin-Informationen für die spätere Auswertung in HandleDebouncedUserInput().
+ * @param held Eingaben, deren Haltezeit weiterläuft
+ * @param mask Alle gedrückten Eingaben, wird in die Ereignisse übernommen
+ * @param elapsedMs Millisekunden seit dem letzten Takt
+ * @param now Timebase_Us() dieses Takts, Zeitstempel der Ereignisse
  */
-void HandleFlanke(Pin pin, enum UserInputs userInput,volatile uint8_t* flankenVariable) {
-#ifdef DEBOUNCE_WITH_DELAY
-     HAL_Delay(50);
-     if (HAL_GPIO_ReadPin(pin.GPIOx,pin.GPIO_Pin) == 1 || (HAL_GPIO_ReadPin(pin.GPIOx,pin.GPIO_Pin) == 0 && userInput == USER_BUTTON)) {
-          *flankenVariable = 1;
+static void UserInput_TickHeld(uint32_t held, uint32_t mask, uint32_t elapsedMs, uint64_t now) {
+     uint32_t longPressMs = UserInput_LongPressMs;
+     uint32_t repeatMask = UserInput_RepeatMask;
+
+     while (held) {
+          uint32_t i = __CLZ(__RBIT(held));
+          uint32_t bit = 1UL << i;
+          held &= ~bit;
+
+          UserInput_Debounce *state = &UserInput_State[i];
+          state->heldMs += elapsedMs;
+
+          if (!state->longSent && longPressMs && state->heldMs >= longPressMs) {
+               state->longSent = 1;
+               UserInput_PushEvent((enum UserInputs)i, USER_INPUT_LONG_PRESS, mask, now);
+          }
+
+          if ((repeatMask & bit) && state->heldMs >= state->nextRepeatMs) {
+               UserInput_PushEvent((enum UserInputs)i, USER_INPUT_REPEAT, mask, now);
+               state->nextRepeatMs += UserInput_RepeatIntervalMs;
+               if (state->nextRepeatMs <= state->heldMs) {
+                    state->nextRepeatMs = state->heldMs + UserInput_RepeatIntervalMs;
+               }
+          }
      }
+}
 
-#endif
-#ifdef DEBOUNCE_WITH_TIMER
-     debounce_in_progress = 1;
-     LetzterUserInputPin = (Pin){pin.GPIOx,pin.GPIO_Pin};
-     LetzterUserInput = userInput;
+/**
+ * @brief Zeit bis zum langen Druck einstellen
+ *
+ * @param ms Haltezeit in Millisekunden, 0 schaltet USER_INPUT_LONG_PRESS ab
+ */
+void UserInput_SetLongPress(uint16_t ms) {
+     UserInput_LongPressMs = ms;
+}
 
-     ///Starte den Debounce Timer
-     __HAL_TIM_SET_COUNTER(&htim6, 0);
-     HAL_TIM_Base_Start_IT(&htim6);
-#endif
+/**
+ * @brief Wiederholung beim Halten einstellen
+ *
+ * Wirkt ab dem nächsten Druck; eine gerade laufende Wiederholung behält ihre nächste Fälligkeit.
+ *
+ * @param inputMask Eingaben mit Wiederholung (Bit = enum UserInputs), 0 schaltet sie ab
+ * @param delayMs Haltezeit bis zur ersten Wiederholung
+ * @param intervalMs Abstand der Wiederholungen, 0 wird als 1 behandelt
+ */
+void UserInput_SetRepeat(uint32_t inputMask, uint16_t delayMs, uint16_t intervalMs) {
+     UserInput_RepeatDelayMs = delayMs;
+     UserInput_RepeatIntervalMs = intervalMs ? intervalMs : 1;
+     UserInput_RepeatMask = inputMask;
 }
 
-#ifdef USE_POLLING
 /**
- * @brief Erfasst und verarbeitet Benutzereingaben im Polling-Modus
+ * @brief Entprellter Zustand aller Eingaben, z.B. um eine Kombination beim Loslassen zu prüfen
  *
- * Diese Funktion überprüft zyklisch alle Eingabe-Pins auf Zustandsänderungen
- * und erkennt dadurch Tastendrücke. Bei erkannten Flanken wird die Entprellung
- * über die Funktion HandleFlanke eingeleitet.
+ * @return Bit = enum UserInputs, 1 = gedrückt
+ */
+uint32_t UserInput_GetPressed(void) {
+     return UserInput_Stable;
+}
+
+/**
+ * @brief Übernimmt den Zustand externer Eingaben, die schon sauber ankommen (Gamepad.c)
  *
- * Die Funktion:
- * 1. Prüft, ob bereits ein Entprellvorgang läuft und kehrt in diesem Fall sofort zurück
- * 2. Liest den aktuellen Status aller Eingabe-Pins
- * 3. Setzt alle Flankenvariablen zurück
- * 4. Vergleicht den aktuellen mit dem vorherigen Zustand, um Flanken zu erkennen
- * 5. Ruft bei erkannter Flanke die HandleFlanke()-Funktion auf
- * 6. Speichert den aktuellen Status für den nächsten Aufruf
+ * Ohne Integrator: eine Änderung ist sofort ein Ereignis mit dem Zeitstempel des Aufrufers.
+ * Gedrückt gehaltene Eingaben stehen danach in UserInput_Stable, langer Druck, Wiederholung
+ * und Kombinationen kommen wie bei den Pins aus UserInput_TickHeld(). Pin-Eingaben in mask
+ * bleiben unberührt, sie gehören den Integratoren.
  *
- * @note Diese Funktion sollte regelmäßig im Hauptprogramm aufgerufen werden,
- *       wenn USE_POLLING definiert ist.
+ * @param pressed Gedrückte Eingaben (Bit = enum UserInputs)
+ * @param mask Eingaben, deren Zustand pressed beschreibt
+ * @param timeUs Timebase_Us() der Änderung
  *
- * @see HandleFlanke()
- * @see HandleDebouncedUserInput()
+ * @note Nur mit IRQ_PRIO_REALTIME aufrufen: dort laufen auch UserInput_Tick() bzw. die
+ *       Abtastung und unterbrechen sich nicht, die Warteschlange behält einen Erzeuger.
  */
-void PollingUserInput(void) {
+void UserInput_Inject(uint32_t pressed, uint32_t mask, uint64_t timeUs) {
+     uint32_t stable = UserInput_Stable;
+     uint32_t changed;
+
+     mask &= ~USER_INPUT_PIN_MASK & ((1UL << USER_INPUT_NONE) - 1);
+     changed = (pressed ^ stable) & mask;
+
+     while (changed) {
+          uint32_t i = __CLZ(__RBIT(changed));
+          uint32_t bit = 1UL << i;
+          changed &= ~bit;
+
+          UserInput_Debounce *state = &UserInput_State[i];
+          if (pressed & bit) {
+               stable |= bit;
+               state->heldMs = 0;
+               state->nextRepeatMs = UserInput_RepeatDelayMs;
+               state->longSent = 0;
+               UserInput_PushEvent((enum UserInputs)i, USER_INPUT_PRESSED, stable, timeUs);
+               if (stable & (stable - 1)) {
+                    UserInput_PushEvent((enum UserInputs)i, USER_INPUT_CHORD, stable, timeUs);
+               }
+          }
+          else {
+               stable &= ~bit;
+               UserInput_PushEvent((enum UserInputs)i, USER_INPUT_RELEASED, stable, timeUs);
+          }
+     }
+     UserInput_Stable = stable;
+}
 
-#ifdef DEBOUNCE_WITH_TIMER
-if (debounce_in_progress) return;
-#endif
+/**
+ * @brief Ob gerade eine Eingabe entprellt oder gehalten wird
+ *
+ * Solange das so ist, braucht UserInput_Tick() den 1-ms-Takt; Realtime_Sleep() verzichtet
+ * dann auf den Tickless-Schlaf. Ein neuer Druck weckt über seinen EXTI-Interrupt, danach
+ * endet der lange Zyklus von TIM7 an der nächsten Millisekundengrenze.
+ */
+uint8_t UserInput_IsBusy(void) {
+     return (UserInput_Stable | UserInput_Moving) != 0;
+}
 
-     /// Lese den aktuellen Status der Pins aus
-     MDS_LEFT_Status = HAL_GPIO_ReadPin(MDS_LEFT_GPIO_Port,MDS_LEFT_Pin);
-     MDS_RIGHT_Status = HAL_GPIO_ReadPin(MDS_RIGHT_GPIO_Port,MDS_RIGHT_Pin);
-     MDS_UP_Status = HAL_GPIO_ReadPin(MDS_UP_GPIO_Port,MDS_UP_Pin);
-     MDS_DOWN_Status = HAL_GPIO_ReadPin(MDS_DOWN_GPIO_Port,MDS_DOWN_Pin);
-     MDS_BUTTON_Status = HAL_GPIO_ReadPin(MDS_BUTTON_GPIO_Port,MDS_BUTTON_Pin);
-     USER_BUTTON_Status = HAL_GPIO_ReadPin(USER_BUTTON_GPIO_Port,USER_BUTTON_Pin);
+#ifdef USE_DMA_SAMPLING
 
+/// Abstand zweier Abtastungen in µs (TIM2 zählt mit 1 MHz)
+#define USER_INPUT_SAMPLE_US  (1000000UL / USER_INPUT_SAMPLE_HZ)
 
-     /// Kontrolliere Flanke von den Pins
-     if (MDS_LEFT_Status == GPIO_PIN_SET && MDS_LEFT_LetzterStatus == 0) {
-          ///MDS_LEFT Flanke erkannt
-          HandleFlanke((Pin){MDS_LEFT_GPIO_Port,MDS_LEFT_Pin},MDS_LEFT,&MDS_LEFT_Flanke);
-     }
-     else if (MDS_RIGHT_Status == GPIO_PIN_SET && MDS_RIGHT_LetzterStatus == 0) {
-          ///MDS_RIGHT Flanke erkannt
-          HandleFlanke((Pin){MDS_RIGHT_GPIO_Port,MDS_RIGHT_Pin},MDS_RIGHT,&MDS_RIGHT_Flanke);
-     }
-     else if (MDS_UP_Status == GPIO_PIN_SET && MDS_UP_LetzterStatus == 0) {
-          ///MDS_UP Flanke erkannt
-          HandleFlanke((Pin){MDS_UP_GPIO_Port,MDS_UP_Pin},MDS_UP,&MDS_UP_Flanke);
+/// EXTI-Leitungen der Eingaben (Leitung = Pin-Nummer); TE des Displays (PD11) bleibt eingeschaltet
+#define USER_INPUT_EXTI_LINES (MDS_LEFT_Pin | MDS_RIGHT_Pin | MDS_UP_Pin | MDS_DOWN_Pin | MDS_BUTTON_Pin | USER_BUTTON_Pin)
+
+/// Ein Stream je Port, in der Reihenfolge der Parameter von UserInput_Pack()
+#define USER_INPUT_SAMPLE_PORTS 4
+
+/// Ringpuffer je Port, zwei Blöcke; nicht cachebar, die CPU liest direkt, was DMA geschrieben hat
+static uint32_t UserInput_Samples[USER_INPUT_SAMPLE_PORTS][2 * USER_INPUT_SAMPLE_BLOCK] DMA_BUFFER;
+
+static DMA_HandleTypeDef UserInput_Dma[USER_INPUT_SAMPLE_PORTS];
+
+static GPIO_TypeDef* const UserInput_SamplePorts[USER_INPUT_SAMPLE_PORTS] = { GPIOB, GPIOC, GPIOD, GPIOE };
+static const uint32_t UserInput_SampleRequests[USER_INPUT_SAMPLE_PORTS] = {
+     DMA_REQUEST_TIM2_CH1, DMA_REQUEST_TIM2_CH2, DMA_REQUEST_TIM2_CH3, DMA_REQUEST_TIM2_CH4
+};
+static const char* const UserInput_SampleOwners[USER_INPUT_SAMPLE_PORTS] = {
+     "TIM2 CH1 GPIOB", "TIM2 CH2 GPIOC", "TIM2 CH3 GPIOD", "TIM2 CH4 GPIOE"
+};
+
+/// Entprellte Blöcke seit dem Start
+static volatile uint32_t UserInput_SampleBlocks = 0;
+
+static void UserInput_SampleHalf(DMA_HandleTypeDef *hdma);
+static void UserInput_SampleFull(DMA_HandleTypeDef *hdma);
+static void UserInput_ProcessBlock(uint32_t first);
+static uint32_t UserInput_SamplePrescaler(void);
+
+/**
+ * @brief Startet die Abtastung der Eingaben per DMA
+ *
+ * TIM2 läuft mit 1 MHz und USER_INPUT_SAMPLE_HZ Perioden je Sekunde. CC1-CC3 fallen auf den
+ * Periodenanfang und lesen GPIOB, C und D, CC4 eine halbe Periode später GPIOE. Nur der Stream
+ * von CC4 hat Interrupts (halber und ganzer Puffer), die drei anderen laufen ohne CPU. Danach
+ * schaltet die Funktion die EXTI-Leitungen der Eingaben ab; die NVIC-Leitungen bleiben an, weil
+ * EXTI15_10 auch das TE-Signal des Displays bedient.
+ *
+ * Direkt über die Register wie TIM5 in Timebase.c, CubeMX kennt TIM2 in diesem Projekt nicht.
+ *
+ * @return 1 wenn die Abtastung läuft, 0 wenn nicht genug DMA-Streams frei waren
+ *         (die EXTI-Leitungen bleiben dann an, entprellt wird aber nicht)
+ */
+uint8_t UserInput_StartSampling(void) {
+     __HAL_RCC_TIM2_CLK_ENABLE();
+
+     TIM2->CR1 = TIM_CR1_URS;
+     TIM2->PSC = UserInput_SamplePrescaler();
+     TIM2->ARR = USER_INPUT_SAMPLE_US - 1;
+     TIM2->CCR1 = 0;
+     TIM2->CCR2 = 0;
+     TIM2->CCR3 = 0;
+     TIM2->CCR4 = USER_INPUT_SAMPLE_US / 2;
+     TIM2->CNT = 0;
+     TIM2->EGR = TIM_EGR_UG;           // load PSC now, not at the first overflow
+     TIM2->SR = 0;
+
+     for (uint8_t p = 0; p < USER_INPUT_SAMPLE_PORTS; p++) {
+          DMA_HandleTypeDef *hdma = &UserInput_Dma[p];
+
+          hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+          hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+          hdma->Init.MemInc = DMA_MINC_ENABLE;
+          hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+          hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+          hdma->Init.Mode = DMA_CIRCULAR;
+          hdma->Init.Priority = DMA_PRIORITY_LOW;
+          hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+          if (!DmaAlloc_Claim(hdma, DMAALLOC_DMA, UserInput_SampleRequests[p], IRQ_PRIO_REALTIME,
+                    UserInput_SampleOwners[p]) || HAL_DMA_Init(hdma) != HAL_OK) {
+               for (uint8_t q = 0; q <= p; q++) {
+                    DmaAlloc_Release(&UserInput_Dma[q]);
+               }
+               __HAL_RCC_TIM2_CLK_DISABLE();
+               return 0;
+          }
      }
-     else if (MDS_DOWN_Status == GPIO_PIN_SET && MDS_DOWN_LetzterStatus == 0) {
-          ///MDS_DOWN Flanke erkannt
-          HandleFlanke((Pin){MDS_DOWN_GPIO_Port,MDS_DOWN_Pin},MDS_DOWN,&MDS_DOWN_Flanke);
+
+     for (uint8_t p = 0; p < USER_INPUT_SAMPLE_PORTS; p++) {
+          uint32_t source = (uint32_t)&UserInput_SamplePorts[p]->IDR;
+          uint32_t destination = (uint32_t)UserInput_Samples[p];
+
+          if (p == USER_INPUT_SAMPLE_PORTS - 1) {
+               UserInput_Dma[p].XferHalfCpltCallback = UserInput_SampleHalf;
+               UserInput_Dma[p].XferCpltCallback = UserInput_SampleFull;
+               HAL_DMA_Start_IT(&UserInput_Dma[p], source, destination, 2 * USER_INPUT_SAMPLE_BLOCK);
+          }
+          else {
+               HAL_DMA_Start(&UserInput_Dma[p], source, destination, 2 * USER_INPUT_SAMPLE_BLOCK);
+          }
      }
-     else if (MDS_BUTTON_Status == GPIO_PIN_SET && MDS_BUTTON_LetzterStatus == 0) {
-          ///MDS_BUTTON Flanke erkannt
-          HandleFlanke((Pin){MDS_BUTTON_GPIO_Port,MDS_BUTTON_Pin},MDS_BUTTON,&MDS_BUTTON_Flanke);
+
+     // From here on the samples see every edge, an EXTI interrupt per bounce is not needed
+     EXTI_D1->IMR1 &= ~USER_INPUT_EXTI_LINES;
+     EXTI_D1->PR1 = USER_INPUT_EXTI_LINES;
+
+     TIM2->DIER = TIM_DIER_CC1DE | TIM_DIER_CC2DE | TIM_DIER_CC3DE | TIM_DIER_CC4DE;
+     TIM2->CR1 |= TIM_CR1_CEN;
+     return 1;
+}
+
+/**
+ * @brief Passt den Vorteiler von TIM2 nach einem Taktwechsel an, aus Clock_ReinitPeripherals()
+ *
+ * Der neue Wert gilt ab dem nächsten Update-Ereignis, eine Periode läuft also noch mit dem
+ * alten Takt. Für die Entprellung ist das ohne Belang, die Zähler bleiben stehen, wo sie sind.
+ */
+void UserInput_ClockChanged(void) {
+     if (TIM2->CR1 & TIM_CR1_CEN) {
+          TIM2->PSC = UserInput_SamplePrescaler();
      }
-     else if (USER_BUTTON_Status == GPIO_PIN_RESET && USER_BUTTON_LetzterStatus == 1) {
-          ///USER_BUTTON Flanke erkannt
-          HandleFlanke((Pin){USER_BUTTON_GPIO_Port,USER_BUTTON_Pin},USER_BUTTON,&USER_BUTTON_Flanke);
+}
+
+/**
+ * @brief Bisher entprellte Blöcke; steht der Zähler, liefert die Abtastung nichts mehr
+ */
+uint32_t UserInput_GetSampleBlocks(void) {
+     return UserInput_SampleBlocks;
+}
+
+/**
+ * @brief Erste Hälfte des Ringpuffers ist voll, der Stream schreibt jetzt die zweite
+ */
+static void UserInput_SampleHalf(DMA_HandleTypeDef *hdma) {
+     (void)hdma;
+     UserInput_ProcessBlock(0);
+}
+
+/**
+ * @brief Zweite Hälfte des Ringpuffers ist voll, der Stream beginnt wieder von vorn
+ */
+static void UserInput_SampleFull(DMA_HandleTypeDef *hdma) {
+     (void)hdma;
+     UserInput_ProcessBlock(USER_INPUT_SAMPLE_BLOCK);
+}
+
+/**
+ * @brief Entprellt einen Block von USER_INPUT_SAMPLE_BLOCK Abtastungen
+ *
+ * Jede Abtastung ist ein Schritt der Integratoren; solange alle Eingaben in Ruhe sind, kostet
+ * sie nur das Packen und einen Vergleich. Die letzte Abtastung von GPIOE ist gerade geschrieben
+ * worden, ihr Zeitstempel ist also der Eintritt in den Interrupt, der jeder früheren Abtastung
+ * entsprechend Vielfache von USER_INPUT_SAMPLE_US davor. Haltezeit, langer Druck und
+ * Wiederholung laufen einmal je Block um USER_INPUT_SAMPLE_BLOCK_MS weiter.
+ *
+ * @param first Index der ersten Abtastung im Ringpuffer (0 oder USER_INPUT_SAMPLE_BLOCK)
+ *
+ * @note Läuft im Interrupt des DMA-Streams von GPIOE mit IRQ_PRIO_REALTIME, als einziger
+ *       Erzeuger der Ereignis-Warteschlange.
+ */
+static RAMFUNC void UserInput_ProcessBlock(uint32_t first) {
+     uint64_t now = Timebase_Us();
+     uint64_t sampleUs = now - (uint64_t)(USER_INPUT_SAMPLE_BLOCK - 1) * USER_INPUT_SAMPLE_US;
+     uint32_t newlyPressed = 0;
+
+     for (uint32_t i = first; i < first + USER_INPUT_SAMPLE_BLOCK; i++, sampleUs += USER_INPUT_SAMPLE_US) {
+          uint32_t pressed = UserInput_Pack(UserInput_Samples[0][i], UserInput_Samples[1][i],
+                                            UserInput_Samples[2][i], UserInput_Samples[3][i]);
+          uint32_t active = ((pressed ^ UserInput_Stable) & USER_INPUT_PIN_MASK) | UserInput_Moving;
+
+          if (active) {
+               newlyPressed |= UserInput_Integrate(pressed, active, 1, sampleUs);
+          }
      }
+     UserInput_SampleBlocks++;
 
-     /// Speichere den aktuellen Status in die LetzterStatus Variablen
-     MDS_LEFT_LetzterStatus = MDS_LEFT_Status;
-     MDS_RIGHT_LetzterStatus = MDS_RIGHT_Status;
-     MDS_UP_LetzterStatus = MDS_UP_Status;
-     MDS_DOWN_LetzterStatus = MDS_DOWN_Status;
-     MDS_BUTTON_LetzterStatus = MDS_BUTTON_Status;
-     USER_BUTTON_LetzterStatus = USER_BUTTON_Status;
+     // Inputs pressed in this block start counting with the next one
+     uint32_t stable = UserInput_Stable;
+     UserInput_TickHeld(stable & ~newlyPressed, stable, USER_INPUT_SAMPLE_BLOCK_MS, now);
+}
+
+/**
+ * @brief  PSC-Wert für 1 MHz aus dem aktuellen APB1-Timertakt, wie Timebase_Prescaler()
+ */
+static uint32_t UserInput_SamplePrescaler(void) {
+     uint8_t CDPPRE1 = (RCC->CDCFGR2 & (0b111<<6))>>6;
+     uint32_t timer_clock_hz = HAL_RCC_GetPCLK1Freq() * (CDPPRE1 == 0 ? 1 : 2);
 
+     return timer_clock_hz / 1000000UL - 1;
 }
+
+#endif
+
 #endif
+
+#ifdef DEBOUNCE_WITH_DELAY
+
+/// Gedrückte Eingaben beim letzten Aufruf (Bit = enum UserInputs)
+uint32_t UserInput_LastPressed = 0;
+
+/// Neu gedrückte Eingaben, die noch bestätigt werden müssen, und Zeitpunkt ihrer Flanke
+static uint32_t UserInput_Pending = 0;
+static uint64_t UserInput_PendingUs = 0;
+
 /**
- * @brief Verarbeitet die entprellten Benutzereingaben nach Timer-Ablauf
- *
- * Diese Funktion wird vom Timer-Interrupt (TIM6) nach Ablauf der Entprellzeit aufgerufen.
- * Sie überprüft, ob die zuletzt erkannte Benutzereingabe immer noch aktiv ist, und setzt
- * gegebenenfalls die entsprechende Flanken-Variable.
+ * @brief Erfasst und verarbeitet Benutzereingaben im Polling-Modus mit Verzögerungs-Entprellung
  *
  * Die Funktion:
- * 1. Überprüft den Status des zuletzt erkannten Eingabe-Pins
- * 2. Wenn der Pin immer noch aktiv ist (HIGH), wird die entsprechende Flanken-Variable gesetzt
- * 3. Andernfalls werden die Informationen zur letzten Eingabe zurückgesetzt
+ * 1. Liest das Abbild aller Eingaben (ein Zugriff je Port)
+ * 2. Ist ein Satz neuer Drücke offen: kehrt zurück, bis USER_INPUT_SETTLE_MS um sind, und reiht
+ *    dann die Eingaben ein, die immer noch gedrückt sind (mit der Zeit der Flanke)
+ * 3. Ermittelt neu gedrückte Eingaben per XOR mit dem vorherigen Abbild und merkt sie vor
+ * 4. Speichert das Abbild für den nächsten Aufruf
  *
- * @note Diese Funktion ist nur verfügbar, wenn DEBOUNCE_WITH_TIMER definiert ist
- * @note Sie wird automatisch vom Timer-Interrupt in HAL_TIM_PeriodElapsedCallback() aufgerufen
+ * Gewartet wird nicht, der Task kehrt sofort zurück und die übrigen Tasks laufen weiter. Drücke
+ * während der offenen Zeit bleiben im Abbild neu und kommen mit dem nächsten Satz.
  *
- * @see HandleFlanke()
- * @see PollingUserInput()
- * @see HAL_TIM_PeriodElapsedCallback()
+ * @note Diese Funktion sollte regelmäßig im Hauptprogramm aufgerufen werden,
+ *       wenn USE_POLLING und DEBOUNCE_WITH_DELAY definiert sind. Mit
+ *       DEBOUNCE_WITH_TIMER tastet UserInput_Tick() die Pins selbst ab.
  */
-void HandleDebouncedUserInput(void) {
+void PollingUserInput(void) {
+     uint64_t timeUs = Timebase_Us();
+     uint32_t pressed = UserInput_ReadInputs();
 
-     if (HAL_GPIO_ReadPin(LetzterUserInputPin.GPIOx,LetzterUserInputPin.GPIO_Pin) == GPIO_PIN_SET) {
-          /// Wenn der Pin immer noch HIGH ist, dann wurde die Flanke erkannt
-          switch (LetzterUserInput) {
-          case MDS_LEFT:
-               Pending_MDS_LEFT_Flanke = 1;
-               break;
-          case MDS_RIGHT:
-               Pending_MDS_RIGHT_Flanke = 1;
-               break;
-          case MDS_UP:
-               Pending_MDS_UP_Flanke = 1;
-               break;
-          case MDS_DOWN:
-               Pending_MDS_DOWN_Flanke = 1;
-               break;
-          case MDS_BUTTON:
-               Pending_MDS_BUTTON_Flanke = 1;
-               break;
-          default:
-               break;
+     if (UserInput_Pending) {
+          if (timeUs - UserInput_PendingUs < USER_INPUT_SETTLE_MS * 1000ULL) {
+               // Keep the image of the edge, presses in between stay new for the next set
+               return;
+          }
+          // Only what is still pressed after the settle time counts
+          uint32_t confirmed = UserInput_Pending & pressed;
+          UserInput_Pending = 0;
+
+          while (confirmed) {
+               uint32_t i = __CLZ(__RBIT(confirmed));
+               confirmed &= confirmed - 1;
+               UserInput_PushEvent((enum UserInputs)i, USER_INPUT_PRESSED, pressed, UserInput_PendingUs);
           }
      }
-     // Der USER_BUTTON ist gedrückt, wenn der Pin LOW ist
-     else if (LetzterUserInput == USER_BUTTON && HAL_GPIO_ReadPin(LetzterUserInputPin.GPIOx,LetzterUserInputPin.GPIO_Pin) == GPIO_PIN_RESET) {
-          Pending_USER_BUTTON_Flanke = 1;
-     }
-     else {
-          /// Wenn der Pin nicht mehr HIGH ist, dann wurde die Flanke nicht erkannt
-          LetzterUserInput = USER_INPUT_NONE;
-          LetzterUserInputPin = (Pin){0,0};
+
+     uint32_t edges = pressed & (pressed ^ UserInput_LastPressed);
+     if (edges) {
+          UserInput_Pending = edges;
+          UserInput_PendingUs = timeUs;
      }
+
+     UserInput_LastPressed = pressed;
 }
+#endif
 
 /**
- * @brief Überträgt anstehende Flankenereignisse in die globalen Flankenvariablen
- *
- * Diese Funktion überprüft, ob für die verschiedenen Benutzereingaben
- * (z. B. MDS_LEFT, MDS_RIGHT, usw.) anstehende Flankenereignisse vorhanden sind.
- * Wenn ein solches Ereignis erkannt wird, wird die entsprechende globale
- * Flankenvariable gesetzt und das Pending-Flag zurückgesetzt.
- *
- * Die Funktion ist notwendig, um Race-Conditions zwischen Interrupt-Kontext und
- * Hauptprogramm zu vermeiden, da Flanken nicht direkt im Interrupt-Kontext gesetzt
- * werden sollten. Stattdessen werden sie als "pending" markiert und erst hier
- * im Hauptprogramm tatsächlich aktiviert.
+ * @brief Reiht ein Ereignis in die Warteschlange ein (nur vom Erzeuger aufrufen)
  *
+ * Der Erzeuger ist je nach Konfiguration der Entprell-Timer bzw. die Polling-Funktion,
+ * es schreibt also immer nur ein Kontext. Ist der Puffer voll, wird das neue Ereignis
+ * verworfen und gezählt, bereits eingereihte bleiben unverändert. TOPIC_INPUT bekommt
+ * jedes Ereignis, auch ein verworfenes, als letzten Stand.
  *
- * Die Funktion:
- * 1. Prüft die Pending-Flags für jede Benutzereingabe.
- * 2. Setzt die zugehörige globale Flankenvariable, wenn ein Pending-Flag aktiv ist.
- * 3. Löscht das Pending-Flag nach der Verarbeitung.
+ * @param userInput Erkannte Eingabe
+ * @param type Art des Ereignisses
+ * @param mask Gedrückte Eingaben zum Zeitpunkt des Ereignisses
+ * @param timeUs Timebase_Us() zum Zeitpunkt der Flanke
+ */
+static void UserInput_PushEvent(enum UserInputs userInput, enum UserInputEvents type, uint32_t mask, uint64_t timeUs) {
+     uint32_t head = UserInput_QueueHead;
+
+     Topic_Input *latest = Topic_BeginPublish(TOPIC_INPUT);
+     latest->event.input = (uint8_t)userInput;
+     latest->event.type = (uint8_t)type;
+     latest->event.mask = mask;
+     latest->event.timeUs = timeUs;
+     latest->events = ++UserInput_EventCount;
+     Topic_EndPublish(TOPIC_INPUT);
+
+     if (head - UserInput_QueueTail >= USER_INPUT_QUEUE_SIZE) {
+          UserInput_QueueDropped++;
+          return;
+     }
+
+     UserInput_Event *slot = &UserInput_Queue[head & (USER_INPUT_QUEUE_SIZE - 1)];
+     slot->input = (uint8_t)userInput;
+     slot->type = (uint8_t)type;
+     slot->mask = mask;
+     slot->timeUs = timeUs;
+
+     // The entry must be complete before the reader sees the new head
+     __DMB();
+     UserInput_QueueHead = head + 1;
+}
+
+/**
+ * @brief Holt das älteste Ereignis aus der Warteschlange (nur von der Anwendung aufrufen)
  *
- * @note Diese Funktion sollte regelmäßig aufgerufen werden, um anstehende
- *       Flankenereignisse zu verarbeiten.
+ * @param event Ziel für das Ereignis
+ * @return 1 wenn ein Ereignis geliefert wurde, 0 wenn die Warteschlange leer ist
  */
+uint8_t UserInput_GetEvent(UserInput_Event *event) {
+     uint32_t tail = UserInput_QueueTail;
 
-void HandlePendingUserInput(void) {
-     if (Pending_MDS_LEFT_Flanke) {
-          MDS_LEFT_Flanke = 1;
-          Pending_MDS_LEFT_Flanke = 0;
-     }
-     if (Pending_MDS_RIGHT_Flanke) {
-          MDS_RIGHT_Flanke = 1;
-          Pending_MDS_RIGHT_Flanke = 0;
-     }
-     if (Pending_MDS_UP_Flanke) {
-          MDS_UP_Flanke = 1;
-          Pending_MDS_UP_Flanke = 0;
-     }
-     if (Pending_MDS_DOWN_Flanke) {
-          MDS_DOWN_Flanke = 1;
-          Pending_MDS_DOWN_Flanke = 0;
-     }
-     if (Pending_MDS_BUTTON_Flanke) {
-          MDS_BUTTON_Flanke = 1;
-          Pending_MDS_BUTTON_Flanke = 0;
-     }
-     if (Pending_USER_BUTTON_Flanke) {
-          USER_BUTTON_Flanke = 1;
-          Pending_USER_BUTTON_Flanke = 0;
+     if (tail == UserInput_QueueHead) {
+          return 0;
      }
+
+     // Read the entry only after the head that published it
+     __DMB();
+     *event = UserInput_Queue[tail & (USER_INPUT_QUEUE_SIZE - 1)];
+
+     // Entry is copied before the slot is handed back to the writer
+     __DMB();
+     UserInput_QueueTail = tail + 1;
+     return 1;
+}
+
+/**
+ * @brief Anzahl der Ereignisse, die wegen voller Warteschlange verworfen wurden
+ */
+uint32_t UserInput_GetDropped(void) {
+     return UserInput_QueueDropped;
+}
+
+/**
+ * @brief Anzahl der eingereihten Ereignisse seit dem Start, läuft über
+ */
+uint32_t UserInput_GetEventCount(void) {
+     return UserInput_QueueHead;
 }
 
-void ResetFlanken() {
-     /// Resettiere die Flanken, damit sie nur einmal erkannt werden
-     MDS_LEFT_Flanke = 0;
-     MDS_RIGHT_Flanke = 0;
-     MDS_UP_Flanke = 0;
-     MDS_DOWN_Flanke = 0;
-     MDS_BUTTON_Flanke = 0;
-     USER_BUTTON_Flanke = 0;
+/**
+ * @brief Name einer Eingabe für Ausgaben
+ */
+const char* UserInput_GetName(enum UserInputs userInput) {
+     if (userInput >= USER_INPUT_NONE) {
+          return "NONE";
+     }
+     return UserInput_Names[userInput];
 }
 
 #ifdef USE_INTERRUPT
 
 /**
- * @brief Verarbeitet Benutzereingaben basierend auf dem übergebenen UserInput-Wert
+ * @brief Merkt sich den Zeitstempel einer Flanke für die Entprellung
  *
- * Diese Funktion wird verwendet, um Flankenereignisse für einen bestimmten
- * Benutzereingabe-Typ zu behandeln. Sie überprüft, ob ein Entprellvorgang
- * bereits läuft, und ruft andernfalls die Funktion HandleFlanke() auf, um
- * die Flanke zu verarbeiten.
- *
- * Die Funktion:
- * 1. Prüft, ob bereits ein Entprellvorgang aktiv ist und kehrt in diesem Fall zurück
- * 2. Verwendet eine switch-Anweisung, um den übergebenen UserInput-Wert auszuwerten
- * 3. Ruft für jeden erkannten Eingabetyp HandleFlanke() mit den entsprechenden Parametern auf
+ * Entprellt wird im Takt von UserInput_Tick(), der Interrupt liefert nur den genauen
+ * Zeitpunkt der Flanke und weckt den Kern aus dem Tickless-Schlaf. Läuft für die Eingabe
+ * schon ein Übergang (Preller), bleibt der erste Zeitstempel erhalten.
  *
  * @param userInput Enum-Wert, der den Typ der Benutzereingabe angibt (MDS_UP, MDS_BUTTON, usw.)
+ * @param timeUs Timebase_Us() beim Eintritt in den Interrupt
  *
- * @note Diese Funktion wird im Interrupt-Modus von UserInput_Interrupt() aufgerufen,
- *       wenn ein entsprechendes GPIO-Event erkannt wurde
- *
- * @see HandleFlanke()
+ * @see UserInput_Tick()
  * @see UserInput_Interrupt()
  */
-void HandleUserInputInterrupt(enum UserInputs userInput) {
-
-#ifdef DEBOUNCE_WITH_TIMER
-     if (debounce_in_progress) return;
-#endif
+void HandleUserInputInterrupt(enum UserInputs userInput, uint64_t timeUs) {
+     UserInput_Debounce *state = &UserInput_State[userInput];
 
-     switch (userInput) {
-          case MDS_UP:
-               HandleFlanke((Pin){MDS_UP_GPIO_Port,MDS_UP_Pin},MDS_UP,&Pending_MDS_UP_Flanke);
-          break;
-          case MDS_BUTTON:
-               HandleFlanke((Pin){MDS_BUTTON_GPIO_Port,MDS_BUTTON_Pin},MDS_BUTTON,&Pending_MDS_BUTTON_Flanke);
-          break;
-          case MDS_RIGHT:
-               HandleFlanke((Pin){MDS_RIGHT_GPIO_Port,MDS_RIGHT_Pin},MDS_RIGHT,&Pending_MDS_RIGHT_Flanke);
-          break;
-          case MDS_DOWN:
-               HandleFlanke((Pin){MDS_DOWN_GPIO_Port,MDS_DOWN_Pin},MDS_DOWN,&Pending_MDS_DOWN_Flanke);
-          break;
-          case USER_BUTTON:
-               HandleFlanke((Pin){USER_BUTTON_GPIO_Port,USER_BUTTON_Pin},USER_BUTTON,&Pending_USER_BUTTON_Flanke);
-          break;
-          default:
-               break;
+     if (state->timed) {
+          return;
      }
 
+     state->timeUs = timeUs;
+     state->timed = 1;
+     UserInput_Armed |= 1UL << userInput;
 }
 
 
@@ -443,80 +856,43 @@ void HandleUserInputInterrupt(enum UserInputs userInput) {
  * @brief Interrupt-Service-Routine für Benutzereingaben
  *
  * Diese Funktion wird aufgerufen, wenn ein GPIO-Interrupt ausgelöst wird.
- * Sie identifiziert den betroffenen Pin und leitet die Verarbeitung der
- * entsprechenden Benutzereingabe ein.
- *
- * Die Funktion:
- * 1. Überprüft, welcher GPIO-Pin den Interrupt ausgelöst hat
- * 2. Ruft die entsprechende Handler-Funktion für die erkannte Benutzereingabe auf
+ * Sie identifiziert den betroffenen Pin und merkt sich den Zeitpunkt der Flanke.
  *
  * @param GPIO_Pin Die Pin-Nummer des GPIO-Pins, der den Interrupt ausgelöst hat
  *
- * @note MDS_LEFT ist nicht als Interrupt-Auslöser implementiert, da MDS_LEFT und MDS_RIGHT den
- *       gleichen GPIO-Pin (GPIO-Pin 5) teilen. Daher wird MDS_LEFT separat per Polling in HandleMDSLeft() behandelt.
+ * @note MDS_LEFT hat keinen eigenen Interrupt, da MDS_LEFT und MDS_RIGHT den gleichen
+ *       GPIO-Pin (GPIO-Pin 5) teilen. UserInput_Tick() erkennt die Eingabe trotzdem über
+ *       das Portabbild, nur der Zeitstempel stammt dann aus dem Takt.
  * @note Diese Funktion wird im Kontext eines GPIO-Interrupts aufgerufen
- * @note Die Zuordnung der GPIO-Pins zu den Benutzereingaben erfolgt über die
- *       in der Funktion implementierte `switch`-Anweisung
  *
  * @see HandleUserInputInterrupt()
  */
 void UserInput_Interrupt(uint16_t GPIO_Pin) {
+     // Timestamp as early as possible, the debounce time must count as latency
+     uint64_t timeUs = Timebase_Us();
+
      switch (GPIO_Pin) {
           case GPIO_PIN_15:{ //MDS_UP
-               HandleUserInputInterrupt(MDS_UP);
+               HandleUserInputInterrupt(MDS_UP, timeUs);
                break;
           }
           case GPIO_PIN_14:{ //MDS_PRESS
-               HandleUserInputInterrupt(MDS_BUTTON);
+               HandleUserInputInterrupt(MDS_BUTTON, timeUs);
                break;
           }
           case GPIO_PIN_5:{ //MDS_RIGHT
-               HandleUserInputInterrupt(MDS_RIGHT);
+               HandleUserInputInterrupt(MDS_RIGHT, timeUs);
                break;
           }
           case GPIO_PIN_10:{ //MDS_DOWN
-               HandleUserInputInterrupt(MDS_DOWN);
+               HandleUserInputInterrupt(MDS_DOWN, timeUs);
                break;
           }
           case GPIO_PIN_13:{ //USER_BUTTON
-               HandleUserInputInterrupt(USER_BUTTON);
+               HandleUserInputInterrupt(USER_BUTTON, timeUs);
                break;
           }
      }
 }
 
-
-/**
- * @brief Behandelt Tastenereignisse für den linken Joystick-Knopf (MDS_LEFT) im Polling-Modus
- *
- * Diese Funktion wird verwendet, da MDS_LEFT und MDS_RIGHT auf der selben GPIO-Pin-Nummer
- * gemappt sind und daher nicht beide gleichzeitig einen Interrupt auslösen können.
- * MDS_LEFT muss daher per Polling abgefragt werden.
- *
- * Die Funktion:
- * 1. Liest den aktuellen Status des MDS_LEFT Pins
- * 2. Erkennt steigende Flanken (Übergang von LOW zu HIGH)
- * 3. Initiiert bei erkannter Flanke den Entprellvorgang mittels Timer
- * 4. Speichert Informationen zur späteren Verarbeitung in HandleDebouncedUserInput()
- * 5. Aktualisiert den gespeicherten vorherigen Zustand für den nächsten Aufruf
- *
- * @note Diese Funktion sollte regelmäßig aufgerufen werden, um den MDS_LEFT Pin zu überwachen
- * @note Wird im Kontext des USE_INTERRUPT Modus verwendet, ergänzt die Interrupt-Handler
- *
- * @see HandleFlanke()
- * @see HandleDebouncedUserInput()
- */
-void HandleMDSLeft() {
-     GPIO_PinState currentState = HAL_GPIO_ReadPin(MDS_LEFT_GPIO_Port, MDS_LEFT_Pin);
-     if (currentState == GPIO_PIN_SET && MDS_LEFT_LetzterStatus == GPIO_PIN_RESET){
-          if (!debounce_in_progress){
-               HandleFlanke((Pin){MDS_LEFT_GPIO_Port,MDS_LEFT_Pin},MDS_LEFT,&MDS_LEFT_Flanke);
-          }
-     }
-     /* Update previous state */
-     MDS_LEFT_LetzterStatus = currentState;
-}
-
 #endif
-
-
@@ -7,34 +7,154 @@
 
 /*
  * Datasheet: https://www.pjrc.com/teensy/W25Q128FV.pdf
+ * SFDP: JEDEC JESD216 (Serial Flash Discoverable Parameters)
  */
 
 #include "W25Qxx_QSPI.h"
+#include "Cache.h"
+#include <string.h>
 
 extern OSPI_HandleTypeDef hospi1;
 
 /*
 * - `W25Q128_PAGE_SIZE`: Die Größe einer Seite im Speicher, die 256 Bytes beträgt.
 * - `W25Q128_SECTOR_SIZE`: Die Größe eines Sektors im Speicher, die 4096 Bytes beträgt.
+* Die Seitengröße gilt nur, bis W25Qxx_begin() sie aus der SFDP-Tabelle übernommen hat;
+* die Löschgrößen sind fest, nur ihre Befehle kommen aus der Tabelle.
 */
 #define W25Q128_PAGE_SIZE     256
 #define W25Q128_SECTOR_SIZE   4096
+#define W25Q128_BLOCK32_SIZE  (32 * 1024)
+#define W25Q128_BLOCK64_SIZE  (64 * 1024)
 
+/*
+* SFDP (JESD216): Kopf mit Signatur "SFDP" ab Adresse 0, danach Parameterköpfe zu je 8 Bytes.
+* Der erste zeigt auf die Basic Flash Parameter Table (BFPT), von der die ersten 16 DWORDs
+* ausgewertet werden (JESD216B).
+*/
+#define W25QXX_SFDP_SIGNATURE  0x50444653UL
+#define W25QXX_SFDP_DWORDS     16
+
+// Ohne SFDP-Tabelle: W25Q128 mit 0xEB, 2 Modustakten und 4 Wartetakten
+W25Qxx_DeviceInfo W25Qxx_Device = {
+	.size = W25QXX_FLASH_SIZE,
+	.pageSize = W25Q128_PAGE_SIZE,
+	.addressSize = HAL_OSPI_ADDRESS_24_BITS,
+	.eraseInstruction = { 0x20, 0x52, 0xD8 },
+	.readInstruction = 0xEB,
+	.readAddressLines = 4,
+	.readModeClocks = 2,
+	.readDummyCycles = 4,
+	.dtrInstruction = (W25QXX_DTR_READ == 2) ? W25QXX_DTR_INSTRUCTION : 0,
+	.readDtr = 0,
+	.fromSfdp = 0,
+};
+
+// 1: OCTOSPI1 im Memory-Mapped-Modus, indirekte Befehle sind dann nicht möglich
+uint8_t W25Qxx_MemoryMappedActive = 0;
+
+// Wird von HAL_OSPI_StatusMatchCallback gesetzt, sobald das BUSY-Bit gelöscht ist
+volatile uint8_t W25Qxx_StatusMatched = 0;
+
+// 1: ein Löschvorgang ist mit W25Qxx_EraseSuspend() angehalten
+uint8_t W25Qxx_EraseSuspended = 0;
+
+// Zwischenpuffer für das Read-Modify-Write angeschnittener Sektoren in W25Qxx_WriteData
+uint8_t W25Qxx_SectorBuffer[W25Q128_SECTOR_SIZE] AXI_BUFFER;
+
+W25Qxx_CacheStats W25Qxx_CacheStatistics = {0};
+
+#ifdef W25QXX_READ_CACHE
+/*
+* Lesecache: kleine Zugriffe (Glyphen, Tabelleneinträge, Schlüssel/Wert-Köpfe) kosten ohne
+* Memory-Mapped-Modus je einen ganzen OCTOSPI-Befehl. Ein Fehltreffer lädt den ganzen Sektor
+* mit einem Quad-Lesebefehl, die folgenden Zugriffe sind nur noch ein memcpy. Jede Schreib-
+* und Löschfunktion verwirft die betroffenen Zeilen vor ihrem Ende (write-through, nichts
+* muss zurückgeschrieben werden).
+*/
+typedef struct {
+	uint32_t address;   // Sektoradresse der Zeile
+	uint32_t stamp;     // Zeitpunkt des letzten Zugriffs (für LRU)
+	uint8_t valid;
+} W25Qxx_CacheLine;
+
+W25Qxx_CacheLine W25Qxx_CacheLines[W25QXX_CACHE_LINES];
+uint8_t W25Qxx_CacheData[W25QXX_CACHE_LINES][W25QXX_CACHE_LINE_SIZE] AXI_BUFFER;
+uint32_t W25Qxx_CacheClock = 0;
+
+static uint8_t W25Qxx_CacheRead(uint32_t address, uint8_t *buffer, uint32_t size);
+#endif
+
+static uint8_t W25Qxx_Suspend(void);
+static void W25Qxx_Resume(uint8_t wasMapped, uint32_t address, uint32_t size);
+// Zustand des laufenden W25Qxx_ReadAsync-Transfers (Abschnitte von höchstens W25QXX_DMA_MAX_CHUNK Bytes)
+volatile uint8_t W25Qxx_AsyncBusy = 0;
+uint32_t W25Qxx_AsyncAddress;
+uint8_t *W25Qxx_AsyncBuffer;
+uint32_t W25Qxx_AsyncRemaining;
+uint8_t *W25Qxx_AsyncStart;
+uint32_t W25Qxx_AsyncSize;
+W25Qxx_ReadCallback W25Qxx_AsyncCallback;
+
+// Zustand des laufenden W25Qxx_ProgramAsync-Auftrags, die Seiten folgen einander aus den OCTOSPI-Interrupts
+volatile uint8_t W25Qxx_ProgramBusy = 0;
+volatile HAL_StatusTypeDef W25Qxx_ProgramResult = HAL_OK;
+volatile uint32_t W25Qxx_ProgramTick;    // HAL_GetTick() at the start of the page in flight
+uint32_t W25Qxx_ProgramAddress;
+const uint8_t *W25Qxx_ProgramData;
+uint32_t W25Qxx_ProgramRemaining;
+uint32_t W25Qxx_ProgramLength;           // bytes of the page in flight
+W25Qxx_ProgramCallback W25Qxx_ProgramDone;
+
+W25Qxx_ProgramStats W25Qxx_ProgramStatistics = {0};
+
+static void W25Qxx_EraseCommand(uint8_t instruction, uint32_t address);
+static uint8_t W25Qxx_FinishSuspendedErase(void);
+static void W25Qxx_EraseUnit(uint8_t type, uint32_t address, uint32_t size);
+static void W25Qxx_SetupRead(OSPI_RegularCmdTypeDef *cmd, uint32_t address, uint8_t continuous);
+static uint8_t W25Qxx_ReadSfdp(void);
+static void W25Qxx_ParseBfpt(const uint32_t *dword, uint32_t count);
+static void W25Qxx_EnterAddressMode(void);
+static void W25Qxx_ConfigureWindow(void);
+static void W25Qxx_SetDtrTiming(uint8_t dtr);
+static void W25Qxx_ProgramRange(uint32_t address, const uint8_t *data, uint32_t size);
+static HAL_StatusTypeDef W25Qxx_StartReadChunk(void);
+static void W25Qxx_FinishRead(HAL_StatusTypeDef status);
+static HAL_StatusTypeDef W25Qxx_StartPolling(void);
+static HAL_StatusTypeDef W25Qxx_StartProgramPage(void);
+static void W25Qxx_FinishProgram(HAL_StatusTypeDef status);
 
 
 /**
  * @brief Initialisiert den W25Qxx-Speicherchip.
  *
- * Diese Funktion aktiviert den Quad-Modus des W25Qxx-Speicherchips,
+ * Diese Funktion liest zuerst die SFDP-Tabelle (Read SFDP, 0x5A) des Chips. Aus der Basic
+ * Flash Parameter Table übernimmt sie Kapazität, Seitengröße, die Befehle für 4-KB-, 32-KB-
+ * und 64-KB-Löschungen sowie den schnellsten Quad-Lesebefehl mit seinen Modus- und
+ * Wartetakten (1-4-4 vor 1-1-4) nach W25Qxx_Device. Danach aktiviert sie den Quad-Modus,
  * um die Datenübertragung über vier Leitungen zu ermöglichen.
  *
+ * Chips über 16 MB (W25Q256, W25Q512) werden mit Enter 4-Byte Address Mode (0xB7) auf
+ * 4-Byte-Adressen umgeschaltet; alle Befehle mit Adresse senden dann 32 Bit. Zum Schluss
+ * werden die Gerätegröße des OCTOSPI1 (DCR1.DEVSIZE) und die MPU-Region des Adressfensters
+ * an die Kapazität angepasst.
+ *
  * @return Gibt immer 1 zurück, um den erfolgreichen Abschluss der Initialisierung anzuzeigen.
+ *         Ohne gültige SFDP-Tabelle bleiben die Werte des W25Q128.
  *
  * @note Diese Funktion muss vor anderen Speicheroperationen aufgerufen werden,
  *       um sicherzustellen, dass der Quad-Modus aktiviert ist.
  */
 uint8_t W25Qxx_begin(){
+	uint8_t wasMapped = W25Qxx_Suspend();
+
+	W25Qxx_ReadSfdp();
 	W25Qxx_EnableQuadMode();
+	W25Qxx_EnterAddressMode();
+	W25Qxx_ConfigureWindow();
+	W25Qxx_InvalidateReadCache(0, 0xFFFFFFFFUL);  // Address width may have changed
+
+	W25Qxx_Resume(wasMapped, 0, 0);
 	return 1;
 }
 
@@ -54,6 +174,9 @@ uint8_t W25Qxx_begin(){
  * @see W25Qxx_PageProgram(), W25Qxx_EraseSector(), W25Qxx_ChipErase()
  */
 void W25Qxx_WriteEnable(){
+	// Nur innerhalb einer Schreib-/Löschfunktion sinnvoll, die den Modus wiederherstellt
+	W25Qxx_Suspend();
+
 	OSPI_RegularCmdTypeDef cmd = {0};
 	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
 	cmd.Instruction = 0x06;                  // Write Enable command
@@ -82,77 +205,239 @@ void W25Qxx_WriteEnable(){
  * @see W25Qxx_WriteEnable(), W25Qxx_ChipErase(), W25Q128_SECTOR_SIZE
  */
 void W25Qxx_EraseSector(uint32_t address){
+	uint8_t wasMapped = W25Qxx_Suspend();
+
+	W25Qxx_EraseUnit(W25QXX_ERASE_4K, address, W25Q128_SECTOR_SIZE);  // Sector Erase command
+
+	W25Qxx_Resume(wasMapped, address, W25Q128_SECTOR_SIZE);
+}
+
+/**
+ * @brief Löscht einen 32-KB-Block des W25Qxx-Flash-Speicherchips.
+ *
+ * Wie W25Qxx_EraseSector(), aber mit dem Block-Erase-Befehl 0x52. Ein Block-Erase
+ * dauert typischerweise 120 ms und ist damit deutlich schneller als acht einzelne
+ * Sektor-Löschungen. Vor dem Aufruf muss W25Qxx_WriteEnable() aufgerufen werden.
+ * Kennt der Chip laut SFDP keinen 32-KB-Block, wird Sektor für Sektor gelöscht.
+ *
+ * @param address Die Adresse des Blocks, ausgerichtet auf 32 KB.
+ *
+ * @see W25Qxx_EraseSector(), W25Qxx_EraseBlock64K(), W25Qxx_WriteData()
+ */
+void W25Qxx_EraseBlock32K(uint32_t address){
+	uint8_t wasMapped = W25Qxx_Suspend();
+
+	W25Qxx_EraseUnit(W25QXX_ERASE_32K, address, W25Q128_BLOCK32_SIZE);  // 32KB Block Erase command
+
+	W25Qxx_Resume(wasMapped, address, W25Q128_BLOCK32_SIZE);
+}
+
+/**
+ * @brief Löscht einen 64-KB-Block des W25Qxx-Flash-Speicherchips.
+ *
+ * Wie W25Qxx_EraseSector(), aber mit dem Block-Erase-Befehl 0xD8 (typisch 150 ms
+ * statt 16 x 45 ms). Vor dem Aufruf muss W25Qxx_WriteEnable() aufgerufen werden.
+ * Kennt der Chip laut SFDP keinen 64-KB-Block, wird Sektor für Sektor gelöscht.
+ *
+ * @param address Die Adresse des Blocks, ausgerichtet auf 64 KB.
+ *
+ * @see W25Qxx_EraseSector(), W25Qxx_EraseBlock32K(), W25Qxx_WriteData()
+ */
+void W25Qxx_EraseBlock64K(uint32_t address){
+	uint8_t wasMapped = W25Qxx_Suspend();
+
+	W25Qxx_EraseUnit(W25QXX_ERASE_64K, address, W25Q128_BLOCK64_SIZE);  // 64KB Block Erase command
+
+	W25Qxx_Resume(wasMapped, address, W25Q128_BLOCK64_SIZE);
+}
+
+/**
+ * @brief Startet das Löschen eines 4-KB-Sektors, ohne auf dessen Ende zu warten.
+ *
+ * Sendet Write Enable und Sector Erase (0x20) und kehrt sofort zurück. Der Chip
+ * bleibt für typischerweise 45 ms beschäftigt; das Ende lässt sich mit W25Qxx_IsBusy()
+ * abfragen. Dazwischen kann der Löschvorgang mit W25Qxx_EraseSuspend() angehalten werden,
+ * um andere Sektoren zu lesen oder zu programmieren.
+ *
+ * @param address Die Adresse des Sektors, ausgerichtet auf 4 KB.
+ *
+ * @note Der Memory-Mapped-Modus wird verlassen und bleibt aus, bis der Aufrufer ihn nach
+ *       dem Ende des Löschvorgangs wieder einschaltet.
+ *
+ * @see W25Qxx_IsBusy(), W25Qxx_EraseSuspend(), W25Qxx_EraseResume()
+ */
+void W25Qxx_EraseSectorStart(uint32_t address){
+	W25Qxx_Suspend();
+	W25Qxx_FinishSuspendedErase();
+	W25Qxx_InvalidateReadCache(address, W25Q128_SECTOR_SIZE);
+	W25Qxx_WriteEnable();
+
 	OSPI_RegularCmdTypeDef cmd = {0};
 	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
-	cmd.Instruction = 0x20;                  // Sector Erase command
+	cmd.Instruction = W25Qxx_Device.eraseInstruction[W25QXX_ERASE_4K];  // Sector Erase command
 	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
-	cmd.Address = address;                   // 24-bit address
+	cmd.Address = address;                   // 24- or 32-bit address
 	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
-	cmd.AddressSize = HAL_OSPI_ADDRESS_24_BITS;
+	cmd.AddressSize = W25Qxx_Device.addressSize;
 	cmd.DataMode = HAL_OSPI_DATA_NONE;
 	HAL_OSPI_Command(&hospi1, &cmd, 100);
-	W25Qxx_WaitForWriteComplete();            // Wait for erase to complete
+}
+
+/**
+ * @brief Liest einmal das BUSY-Bit aus Status-Register 1.
+ * @return 1, solange ein Schreib- oder Löschvorgang läuft
+ */
+uint8_t W25Qxx_IsBusy(void){
+	// Memory-Mapped wird erst nach dem Ende aller Vorgänge wieder eingeschaltet
+	if (W25Qxx_MemoryMappedActive) return 0;
+	W25Qxx_WaitReadAsync();
+	if (W25Qxx_ProgramBusy) return 1;
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	uint8_t status = 0x01;
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0x05;                  // Read Status Register command
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.DataMode = HAL_OSPI_DATA_1_LINE;
+	cmd.NbData = 1;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return 1;
+	if (HAL_OSPI_Receive(&hospi1, &status, 100) != HAL_OK) return 1;
+	return status & 0x01;
+}
+
+/**
+ * @brief Hält einen laufenden Sektor- oder Block-Löschvorgang an (Erase Suspend, 0x75).
+ *
+ * Wartet, bis das BUSY-Bit gelöscht ist (tSUS, max. 20 µs). Danach dürfen alle anderen
+ * Sektoren gelesen und programmiert werden. Der Löschvorgang läuft erst nach
+ * W25Qxx_EraseResume() weiter.
+ *
+ * @note Zwischen Resume und dem nächsten Suspend muss dem Chip Zeit bleiben, sonst kommt
+ *       der Löschvorgang nicht voran. Ein weiterer Löschbefehl wird während der Unterbrechung
+ *       nicht angenommen; die Löschfunktionen setzen den angehaltenen Vorgang deshalb zuerst
+ *       fort und warten sein Ende ab (siehe W25Qxx_IsEraseSuspended()).
+ *
+ * @see W25Qxx_EraseResume(), W25Qxx_EraseSectorStart()
+ */
+void W25Qxx_EraseSuspend(void){
+	W25Qxx_Suspend();
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0x75;                  // Erase / Program Suspend command
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.AddressMode = HAL_OSPI_ADDRESS_NONE;
+	cmd.DataMode = HAL_OSPI_DATA_NONE;
+	HAL_OSPI_Command(&hospi1, &cmd, 100);
+	W25Qxx_WaitForWriteComplete();            // BUSY clears after tSUS
+	W25Qxx_EraseSuspended = 1;
+}
+
+/**
+ * @brief Setzt einen mit W25Qxx_EraseSuspend() angehaltenen Löschvorgang fort (0x7A).
+ */
+void W25Qxx_EraseResume(void){
+	W25Qxx_Suspend();
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0x7A;                  // Erase / Program Resume command
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.AddressMode = HAL_OSPI_ADDRESS_NONE;
+	cmd.DataMode = HAL_OSPI_DATA_NONE;
+	HAL_OSPI_Command(&hospi1, &cmd, 100);
+	W25Qxx_EraseSuspended = 0;
+}
+
+/**
+ * @brief Gibt an, ob ein Löschvorgang mit W25Qxx_EraseSuspend() angehalten ist.
+ * @note  Wird gelöscht durch W25Qxx_EraseResume() und durch jede Löschfunktion, die den
+ *        angehaltenen Vorgang vor ihrem eigenen Befehl zu Ende laufen lässt.
+ */
+uint8_t W25Qxx_IsEraseSuspended(void){
+	return W25Qxx_EraseSuspended;
 }
 
 /**
  * @brief Programmiert eine Seite im W25Qxx-Flash-Speicherchip.
  *
  * Diese Funktion schreibt Daten in eine Seite des Flash-Speichers an der
- * angegebenen Adresse. Vor dem Aufruf dieser Funktion muss W25Qxx_WriteEnable()
- * aufgerufen werden, um den Schreibzugriff zu aktivieren.
+ * angegebenen Adresse. Verwendet wird Quad Input Page Program (0x32): Befehl und
+ * Adresse laufen über eine Leitung, die Daten über vier Leitungen. Vor dem Aufruf
+ * dieser Funktion muss W25Qxx_WriteEnable() aufgerufen werden, um den Schreibzugriff
+ * zu aktivieren.
  *
- * @param address Die 24-Bit Adresse, an der die Daten geschrieben werden sollen.
+ * @param address Die Adresse, an der die Daten geschrieben werden sollen.
  * @param data Zeiger auf den Puffer mit den zu schreibenden Daten.
- * @param size Die Anzahl der zu schreibenden Bytes (maximal 256 Bytes, eine Seite).
+ * @param size Die Anzahl der zu schreibenden Bytes (maximal eine Seite).
  *
- * @note Eine Seite im W25Q128 ist auf 256 Bytes begrenzt. Wenn die Adresse plus die
- *       Datengröße über eine Seitengrenze hinausgeht, wird der Überlauf am Seitenanfang
- *       fortgesetzt (Page Wrap-Around). Um größere Datenmengen zu schreiben, verwenden
- *       Sie W25Qxx_WriteData().
+ * @note Eine Seite im W25Q128 ist auf 256 Bytes begrenzt (W25Qxx_Device.pageSize). Die Seite
+ *       läuft über W25Qxx_ProgramAsync() (Write Enable, Daten per MDMA, Ende per Auto-Polling),
+ *       die Funktion wartet nur auf ihr Ende. Geht der Bereich über eine Seitengrenze, wird er
+ *       dort geteilt statt am Seitenanfang fortgesetzt. Um größere Datenmengen zu schreiben,
+ *       verwenden Sie W25Qxx_WriteData(). Der Quad-Modus muss aktiv sein, siehe W25Qxx_begin().
  *
  * @see W25Qxx_WriteEnable(), W25Qxx_WriteData(), W25Q128_PAGE_SIZE
  */
 void W25Qxx_PageProgram(uint32_t address, uint8_t *data, uint32_t size){
-	OSPI_RegularCmdTypeDef cmd = {0};
-	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
-	cmd.Instruction = 0x02;                  // Page Program command
-	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
-	cmd.Address = address;                   // 24-bit address
-	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
-	cmd.AddressSize = HAL_OSPI_ADDRESS_24_BITS;
-	cmd.DataMode = HAL_OSPI_DATA_1_LINE;
-	cmd.NbData = size;                       // Data size (up to 256 bytes)
-	HAL_OSPI_Command(&hospi1, &cmd, 100);
-	HAL_OSPI_Transmit(&hospi1, data, 100);
-	W25Qxx_WaitForWriteComplete();            // Wait for write to complete
+	uint8_t wasMapped = W25Qxx_Suspend();
+
+	if (W25Qxx_ProgramAsync(address, data, size, NULL) == HAL_OK) {
+		W25Qxx_WaitProgramAsync();
+	}
+
+	W25Qxx_Resume(wasMapped, address, size);
 }
 
 /**
  * @brief Wartet, bis ein Schreib- oder Löschvorgang im W25Qxx-Flash-Speicherchip abgeschlossen ist.
  *
- * Diese Funktion prüft wiederholt das Status-Register des W25Qxx-Speicherchips,
- * bis der BUSY-Bit (Bit 0) auf 0 gesetzt ist, was anzeigt, dass eine
- * vorherige Schreib- oder Löschoperation abgeschlossen wurde.
+ * Statt das Status-Register in einer Schleife per Software abzufragen, übernimmt der
+ * OCTOSPI die Abfrage im Auto-Polling-Modus: Er liest Status-Register 1 (0x05) alle
+ * 16 Takte selbstständig, vergleicht das BUSY-Bit (Bit 0) mit 0 und löst bei einem
+ * Treffer den Status-Match-Interrupt aus. Der Bus bleibt dabei frei von CPU-Zugriffen.
  *
  * @note Diese Funktion wird intern von W25Qxx_PageProgram(), W25Qxx_EraseSector(),
  *       W25Qxx_ChipErase() und anderen Funktionen aufgerufen, die Schreib- oder
  *       Löschvorgänge durchführen, um sicherzustellen, dass die Operation
  *       vollständig abgeschlossen ist, bevor weitere Befehle gesendet werden.
+ *       Nach W25QXX_BUSY_TIMEOUT_MS wird das Polling abgebrochen.
  *
  * @see W25Qxx_PageProgram(), W25Qxx_EraseSector(), W25Qxx_ChipErase()
  */
 void W25Qxx_WaitForWriteComplete(void){
-	OSPI_RegularCmdTypeDef cmd = {0};
-	uint8_t status;
+	// Nur innerhalb einer Schreib-/Löschfunktion sinnvoll, die den Modus wiederherstellt
+	W25Qxx_Suspend();
+
+	if (W25Qxx_StartPolling() != HAL_OK) return;
 
-	do {
-		cmd.Instruction = 0x05;                // Read Status Register command
-		cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
-		cmd.DataMode = HAL_OSPI_DATA_1_LINE;
-		cmd.NbData = 1;
-		HAL_OSPI_Command(&hospi1, &cmd, 100);
-		HAL_OSPI_Receive(&hospi1, &status, 100);
-	} while (status & 0x01);                 // Wait until BUSY bit clears
+	uint32_t start = HAL_GetTick();
+	while (!W25Qxx_StatusMatched) {
+		if (HAL_GetTick() - start > W25QXX_BUSY_TIMEOUT_MS) {
+			HAL_OSPI_Abort(&hospi1);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Status-Match-Callback des OCTOSPI, meldet das Ende des Auto-Pollings.
+ * @note  Wird im Interrupt-Kontext (OCTOSPI1) ausgeführt
+ */
+void HAL_OSPI_StatusMatchCallback(OSPI_HandleTypeDef *hospi){
+	if (hospi != &hospi1) return;
+
+	W25Qxx_StatusMatched = 1;
+	if (!W25Qxx_ProgramBusy) return;
+
+	// BUSY cleared: the page is in the array, chain WREN and program of the next one right away
+	W25Qxx_ProgramStatistics.pages++;
+	W25Qxx_ProgramAddress += W25Qxx_ProgramLength;
+	W25Qxx_ProgramData += W25Qxx_ProgramLength;
+	W25Qxx_ProgramRemaining -= W25Qxx_ProgramLength;
+	if (W25Qxx_StartProgramPage() != HAL_OK) {
+		W25Qxx_FinishProgram(HAL_ERROR);
+	}
 }
 
 
@@ -163,7 +448,7 @@ void W25Qxx_WaitForWriteComplete(void){
  * Adresse in einen Puffer zu lesen. Dabei wird der normale Lesebefehl (0x03) verwendet,
  * der Daten über eine einzelne Datenleitung überträgt.
  *
- * @param address Die 24-Bit Adresse, ab der gelesen werden soll.
+ * @param address Die Adresse, ab der gelesen werden soll.
  * @param buffer Zeiger auf den Puffer, in den die gelesenen Daten gespeichert werden.
  * @param size Die Anzahl der zu lesenden Bytes.
  *
@@ -174,17 +459,27 @@ void W25Qxx_WaitForWriteComplete(void){
  * @see W25Qxx_FastReadData(), W25Qxx_FastReadQuadOutput()
  */
 void W25Qxx_ReadData(uint32_t address, uint8_t *buffer, uint32_t size){
+	W25Qxx_WaitReadAsync();
+
+	if (W25Qxx_MemoryMappedActive) {
+		memcpy(buffer, W25Qxx_MappedAddress(address), size);
+		return;
+	}
+#ifdef W25QXX_READ_CACHE
+	if (W25Qxx_CacheRead(address, buffer, size)) return;
+#endif
+
 	OSPI_RegularCmdTypeDef cmd = {0};
 	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
 	cmd.Instruction = 0x03;                  // Read Data command
 	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
-	cmd.Address = address;                   // 24-bit address
+	cmd.Address = address;                   // 24- or 32-bit address
 	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
-	cmd.AddressSize = HAL_OSPI_ADDRESS_24_BITS;
+	cmd.AddressSize = W25Qxx_Device.addressSize;
 	cmd.DataMode = HAL_OSPI_DATA_1_LINE;
 	cmd.NbData = size;                       // Data size
 	HAL_OSPI_Command(&hospi1, &cmd, 100);
-	HAL_OSPI_Receive(&hospi1, buffer, 100);
+	HAL_OSPI_Receive(&hospi1, buffer, W25QXX_READ_TIMEOUT(size));
 }
 
 
@@ -196,7 +491,7 @@ void W25Qxx_ReadData(uint32_t address, uint8_t *buffer, uint32_t size){
  * welcher höhere Taktraten als der Standard-Lesebefehl unterstützt, jedoch 8 Dummy-Zyklen
  * benötigt.
  *
- * @param address Die 24-Bit Adresse, ab der gelesen werden soll.
+ * @param address Die Adresse, ab der gelesen werden soll.
  * @param buffer Zeiger auf den Puffer, in den die gelesenen Daten gespeichert werden.
  * @param size Die Anzahl der zu lesenden Bytes.
  *
@@ -207,54 +502,71 @@ void W25Qxx_ReadData(uint32_t address, uint8_t *buffer, uint32_t size){
  * @see W25Qxx_ReadData(), W25Qxx_FastReadQuadOutput()
  */
 void W25Qxx_FastReadData(uint32_t address, uint8_t *buffer, uint32_t size){
+	W25Qxx_WaitReadAsync();
+
+	if (W25Qxx_MemoryMappedActive) {
+		memcpy(buffer, W25Qxx_MappedAddress(address), size);
+		return;
+	}
+#ifdef W25QXX_READ_CACHE
+	if (W25Qxx_CacheRead(address, buffer, size)) return;
+#endif
+
 	OSPI_RegularCmdTypeDef cmd = {0};
 	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
 	cmd.Instruction = 0x0B;                  // Fast Read command
 	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
-	cmd.Address = address;                   // 24-bit address
+	cmd.Address = address;                   // 24- or 32-bit address
 	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
-	cmd.AddressSize = HAL_OSPI_ADDRESS_24_BITS;
+	cmd.AddressSize = W25Qxx_Device.addressSize;
 	cmd.DataMode = HAL_OSPI_DATA_1_LINE;
 	cmd.DummyCycles = 8;                     // Dummy cycles (check datasheet)
 	cmd.NbData = size;                       // Data size
 	HAL_OSPI_Command(&hospi1, &cmd, 100);
-	HAL_OSPI_Receive(&hospi1, buffer, 100);
+	HAL_OSPI_Receive(&hospi1, buffer, W25QXX_READ_TIMEOUT(size));
 }
 
 
 /**
  * @brief Liest Daten mit maximaler Geschwindigkeit über Quad-Output vom W25Qxx-Flash-Speicherchip.
  *
- * Diese Funktion führt eine Hochgeschwindigkeits-Leseoperation durch, indem sie den
- * Fast Read Quad Output Befehl (0x6B) verwendet. Während Befehl und Adresse über eine
- * einzelne Leitung gesendet werden, erfolgt der Datenempfang über vier parallele Leitungen,
- * was eine deutlich höhere Übertragungsrate ermöglicht.
+ * Diese Funktion führt eine Hochgeschwindigkeits-Leseoperation mit dem schnellsten
+ * Quad-Lesebefehl aus W25Qxx_Device durch: Fast Read Quad I/O (0xEB, Adresse ebenfalls über
+ * vier Leitungen), wenn die SFDP-Tabelle ihn meldet, sonst Fast Read Quad Output (0x6B).
+ * Der Befehl läuft über eine einzelne Leitung, der Datenempfang über vier parallele
+ * Leitungen, was eine deutlich höhere Übertragungsrate ermöglicht.
  *
- * @param address Die 24-Bit Adresse, ab der gelesen werden soll.
+ * @param address Die Adresse, ab der gelesen werden soll.
  * @param buffer Zeiger auf den Puffer, in den die gelesenen Daten gespeichert werden.
  * @param size Die Anzahl der zu lesenden Bytes.
  *
- * @note Diese Funktion benötigt 8 Dummy-Zyklen zwischen Adresse und Datenübertragung und
- *       erfordert, dass der Quad-Modus zuvor durch W25Qxx_EnableQuadMode() aktiviert wurde.
+ * @note Die Wartetakte zwischen Adresse und Daten kommen aus der SFDP-Tabelle (4 bei 0xEB,
+ *       8 bei 0x6B). Die Modusbits werden mit 0x00 gesendet, der Chip bleibt also nicht im
+ *       Continuous-Read-Modus. Die Funktion erfordert, dass der Quad-Modus zuvor durch
+ *       W25Qxx_EnableQuadMode() aktiviert wurde.
  *       Sie bietet die höchste Lesegeschwindigkeit unter allen Lesefunktionen.
  *
  * @see W25Qxx_ReadData(), W25Qxx_FastReadData(), W25Qxx_EnableQuadMode()
  */
 void W25Qxx_FastReadQuadOutput(uint32_t address, uint8_t *buffer, uint32_t size){
+	W25Qxx_WaitReadAsync();
+
+	if (W25Qxx_MemoryMappedActive) {
+		memcpy(buffer, W25Qxx_MappedAddress(address), size);
+		return;
+	}
+#ifdef W25QXX_READ_CACHE
+	if (W25Qxx_CacheRead(address, buffer, size)) return;
+#endif
+
 	OSPI_RegularCmdTypeDef cmd = {0};
 
-	// Configure the Fast Read Quad Output command
+	// Configure the fastest quad read command (0xEB or 0x6B)
 	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
-	cmd.Instruction = 0x6B;                  // Fast Read Quad Output command
-	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;  // Send instruction on 1 line
-	cmd.Address = address;                   // 24-bit address
-	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE; // Send address on 1 line
-	cmd.AddressSize = HAL_OSPI_ADDRESS_24_BITS; // 24-bit address
-	cmd.DataMode = HAL_OSPI_DATA_4_LINES;     // Receive data on 4 lines
-	cmd.DummyCycles = 8;                      // Dummy cycles (check datasheet)
+	W25Qxx_SetupRead(&cmd, address, 0);
 	cmd.NbData = size;                        // Data size
 	HAL_OSPI_Command(&hospi1, &cmd, 100);
-	HAL_OSPI_Receive(&hospi1, buffer, 100);   // Receive data
+	HAL_OSPI_Receive(&hospi1, buffer, W25QXX_READ_TIMEOUT(size));   // Receive data
 }
 
 
@@ -279,6 +591,8 @@ void W25Qxx_FastReadQuadOutput(uint32_t address, uint8_t *buffer, uint32_t size)
  * @see W25Qxx_begin(), W25Qxx_FastReadQuadOutput()
  */
 void W25Qxx_EnableQuadMode(void) {
+  uint8_t wasMapped = W25Qxx_Suspend();
+
   uint8_t status;
   OSPI_RegularCmdTypeDef cmd = {0};
 
@@ -305,6 +619,8 @@ void W25Qxx_EnableQuadMode(void) {
 
     W25Qxx_WaitForWriteComplete();  // Wait until QE bit is updated
   }
+
+  W25Qxx_Resume(wasMapped, 0, 0);
 }
 /**
  * @brief Liest die Hersteller- und Geräte-ID des W25Qxx-Flash-Speicherchips aus.
@@ -325,6 +641,7 @@ void W25Qxx_EnableQuadMode(void) {
  * @see W25Qxx_begin()
  */
 void W25Qxx_Read_Manu_ID(uint8_t *manufacturerID, uint8_t *deviceID){
+	uint8_t wasMapped = W25Qxx_Suspend();
 
 	OSPI_RegularCmdTypeDef cmd = {0};
 	uint8_t data[2];  // Buffer to store both bytes
@@ -349,55 +666,90 @@ void W25Qxx_Read_Manu_ID(uint8_t *manufacturerID, uint8_t *deviceID){
 
 	*manufacturerID = data[0];  // First byte: Manufacturer ID
 	*deviceID = data[1];        // Second byte: Device ID
+
+	W25Qxx_Resume(wasMapped, 0, 0);
 }
 
 /**
  * @brief Schreibt Daten beliebiger Größe in den W25Qxx-Flash-Speicherchip.
  *
- * Diese Funktion ermöglicht das Schreiben von Datenblöcken, die größer als eine
- * einzelne Seite (256 Bytes) sind, indem sie die Daten automatisch in seitenweise
- * Schreibvorgänge aufteilt. Die Funktion beachtet die Seitengrenzen des Flash-Speichers
- * und führt mehrere Schreiboperationen durch, um alle Daten zu speichern.
+ * Die Funktion löscht den Zielbereich selbst und wählt dabei für jeden Abschnitt die
+ * größte Löscheinheit, auf die die aktuelle Adresse ausgerichtet ist und die vollständig
+ * im Bereich liegt: 64-KB-Block (0xD8), 32-KB-Block (0x52) oder 4-KB-Sektor (0x20).
+ * Blockgrößen, die der Chip laut SFDP-Tabelle nicht kennt, werden übersprungen.
+ * Ein 150-KB-Asset ab einer 64-KB-Grenze braucht so nur zwei 64-KB- und einen
+ * 32-KB-Löschvorgang statt 38 Sektor-Löschungen.
+ *
+ * Angeschnittene Sektoren am Anfang oder Ende werden per Read-Modify-Write behandelt:
+ * Der Sektor wird in W25Qxx_SectorBuffer gelesen, mit den neuen Daten zusammengeführt,
+ * gelöscht und komplett neu programmiert, sodass Daten außerhalb des Bereichs erhalten
+ * bleiben.
  *
- * @param address Die 24-Bit Startadresse, an die geschrieben werden soll.
+ * @param address Die Startadresse, an die geschrieben werden soll.
  * @param data Zeiger auf den Puffer mit den zu schreibenden Daten.
  * @param size Die Gesamtanzahl der zu schreibenden Bytes.
  *
  * @note Diese Funktion:
- *       1. Teilt die Daten in passende Seiten-Chunks auf
- *       2. Führt für jeden Chunk einen Write-Enable-Befehl aus
- *       3. Programmiert die einzelnen Seiten nacheinander
- *       4. Wartet nach jeder Seite auf den Abschluss des Schreibvorgangs
+ *       1. Löscht den Bereich mit der jeweils größten passenden Einheit
+ *       2. Teilt die Daten in passende Seiten-Chunks auf
+ *       3. Programmiert die Seiten per Quad Input Page Program mit W25Qxx_ProgramAsync(),
+ *          gelöschte Seiten (nur 0xFF) werden übersprungen
+ *       4. Wartet per Auto-Polling auf den Abschluss jedes Löschvorgangs; die Seiten
+ *          folgen einander aus dem Status-Match-Interrupt, gewartet wird nur auf das Ende
  *
- * @see W25Qxx_WriteEnable(), W25Qxx_PageProgram(), W25Qxx_WaitForWriteComplete(),
- *      W25Q128_PAGE_SIZE
+ * @see W25Qxx_EraseSector(), W25Qxx_EraseBlock32K(), W25Qxx_EraseBlock64K(),
+ *      W25Qxx_PageProgram(), W25Q128_PAGE_SIZE
  */
 void W25Qxx_WriteData(int32_t address, uint8_t *data, uint32_t size){
+	uint8_t wasMapped = W25Qxx_Suspend();
 
 	uint32_t currentAddress = address;
-	uint32_t remainingBytes = size;
-	uint32_t bytesToWrite;
+	uint32_t endAddress = address + size;
+
+	while (currentAddress < endAddress) {
+		uint32_t remainingBytes = endAddress - currentAddress;
+		uint32_t unit;
 
-	while (remainingBytes > 0) {
-		// Calculate the number of bytes we can write in the current page
-		uint32_t pageOffset = currentAddress % W25Q128_PAGE_SIZE;
-		uint32_t spaceInPage = W25Q128_PAGE_SIZE - pageOffset;
-		bytesToWrite = (remainingBytes > spaceInPage) ? spaceInPage : remainingBytes;
+		// Pick the largest erase unit that is aligned and fully covered
+		if (W25Qxx_Device.eraseInstruction[W25QXX_ERASE_64K] != 0
+				&& (currentAddress % W25Q128_BLOCK64_SIZE) == 0 && remainingBytes >= W25Q128_BLOCK64_SIZE) {
+			unit = W25Q128_BLOCK64_SIZE;
+			W25Qxx_WriteEnable();
+			W25Qxx_EraseBlock64K(currentAddress);
+		} else if (W25Qxx_Device.eraseInstruction[W25QXX_ERASE_32K] != 0
+				&& (currentAddress % W25Q128_BLOCK32_SIZE) == 0 && remainingBytes >= W25Q128_BLOCK32_SIZE) {
+			unit = W25Q128_BLOCK32_SIZE;
+			W25Qxx_WriteEnable();
+			W25Qxx_EraseBlock32K(currentAddress);
+		} else if ((currentAddress % W25Q128_SECTOR_SIZE) == 0 && remainingBytes >= W25Q128_SECTOR_SIZE) {
+			unit = W25Q128_SECTOR_SIZE;
+			W25Qxx_WriteEnable();
+			W25Qxx_EraseSector(currentAddress);
+		} else {
+			// Partial sector: read, merge, erase and reprogram the whole sector
+			uint32_t sectorAddress = currentAddress - (currentAddress % W25Q128_SECTOR_SIZE);
+			uint32_t offset = currentAddress - sectorAddress;
+			uint32_t bytesToWrite = W25Q128_SECTOR_SIZE - offset;
+			if (bytesToWrite > remainingBytes) bytesToWrite = remainingBytes;
 
-		// Enable write operations
-		W25Qxx_WriteEnable();
+			W25Qxx_FastReadQuadOutput(sectorAddress, W25Qxx_SectorBuffer, W25Q128_SECTOR_SIZE);
+			memcpy(&W25Qxx_SectorBuffer[offset], data, bytesToWrite);
 
-		// Write the page
-		W25Qxx_PageProgram(currentAddress, data, bytesToWrite);
+			W25Qxx_WriteEnable();
+			W25Qxx_EraseSector(sectorAddress);
+			W25Qxx_ProgramRange(sectorAddress, W25Qxx_SectorBuffer, W25Q128_SECTOR_SIZE);
 
-		// Wait until the write operation is complete
-		W25Qxx_WaitForWriteComplete();
+			currentAddress += bytesToWrite;
+			data += bytesToWrite;
+			continue;
+		}
 
-		// Move to the next chunk
-		currentAddress += bytesToWrite;
-		data += bytesToWrite;
-		remainingBytes -= bytesToWrite;
+		W25Qxx_ProgramRange(currentAddress, data, unit);
+		currentAddress += unit;
+		data += unit;
 	}
+
+	W25Qxx_Resume(wasMapped, address, size);
 }
 
 /**
@@ -411,7 +763,7 @@ void W25Qxx_WriteData(int32_t address, uint8_t *data, uint32_t size){
  *
  * @note Der Chip-Erase-Vorgang kann je nach Speicherkapazität mehrere Sekunden bis
  *       Minuten dauern. Bei W25Q128 (16 MB) kann dies typischerweise 15-30 Sekunden
- *       in Anspruch nehmen. Die Funktion blockiert, bis der Löschvorgang vollständig
+ *       in Anspruch nehmen, bei größeren Chips entsprechend länger. Die Funktion blockiert, bis der Löschvorgang vollständig
  *       abgeschlossen ist.
  *
  * @warning Diese Funktion löscht ALLE Daten im Speicherchip ohne Möglichkeit zur
@@ -420,9 +772,12 @@ void W25Qxx_WriteData(int32_t address, uint8_t *data, uint32_t size){
  * @see W25Qxx_WriteEnable(), W25Qxx_WaitForWriteComplete(), W25Qxx_EraseSector()
  */
 void W25Qxx_ChipErase(void) {
+  uint8_t wasMapped = W25Qxx_Suspend();
+
   OSPI_RegularCmdTypeDef cmd = {0};
 
-  // Step 1: Enable Write Operations
+  // Step 1: Enable Write Operations (a suspended erase must end first)
+  W25Qxx_FinishSuspendedErase();
   W25Qxx_WriteEnable();
 
   // Step 2: Send Chip Erase Command
@@ -435,7 +790,884 @@ void W25Qxx_ChipErase(void) {
 
   // Step 3: Wait for Erase to Complete
   W25Qxx_WaitForWriteComplete();
+
+  W25Qxx_Resume(wasMapped, 0, W25Qxx_Device.size);
+}
+
+
+
+/**
+ * @brief Liest Daten per OCTOSPI und MDMA im Hintergrund vom W25Qxx-Flash-Speicherchip.
+ *
+ * Verwendet denselben Quad-Lesebefehl (0xEB oder 0x6B) wie W25Qxx_FastReadQuadOutput(),
+ * die Daten holt aber der MDMA-Kanal an der FIFO-Schwelle des OCTOSPI ab. Die Funktion kehrt
+ * sofort zurück; die CPU kann währenddessen zeichnen oder Sensoren abfragen. Größere Bereiche
+ * werden in Abschnitte von W25QXX_DMA_MAX_CHUNK Bytes zerlegt, die nacheinander aus dem
+ * Transfer-Complete-Interrupt gestartet werden.
+ *
+ * Vor dem Start wird der Zielbereich im D-Cache bereinigt und verworfen, damit keine
+ * schmutzige Zeile später über die DMA-Daten geschrieben wird; nach dem letzten Abschnitt
+ * wird er erneut verworfen, bevor der Callback läuft.
+ *
+ * @param address Die Adresse, ab der gelesen werden soll.
+ * @param buffer Zielpuffer, möglichst 32-Byte-ausgerichtet und ein Vielfaches von 32 Bytes groß.
+ *               Teilt er sich eine Cache-Zeile mit anderen Variablen, dürfen diese während des
+ *               Transfers nicht geschrieben werden.
+ * @param size Die Anzahl der zu lesenden Bytes.
+ * @param callback Wird nach Abschluss mit HAL_OK oder HAL_ERROR aufgerufen (Interrupt-Kontext),
+ *                 darf NULL sein und darf direkt den nächsten W25Qxx_ReadAsync() starten.
+ *
+ * @return HAL_OK, wenn der Transfer gestartet wurde, HAL_BUSY, wenn noch einer läuft,
+ *         sonst HAL_ERROR.
+ *
+ * @note Im Memory-Mapped-Modus wird direkt aus dem Adressfenster kopiert und der Callback
+ *       sofort aufgerufen. Alle anderen W25Qxx-Funktionen warten, bis der Transfer beendet ist.
+ *
+ * @see W25Qxx_IsReadBusy(), W25Qxx_WaitReadAsync(), W25Qxx_FastReadQuadOutput()
+ */
+HAL_StatusTypeDef W25Qxx_ReadAsync(uint32_t address, uint8_t *buffer, uint32_t size, W25Qxx_ReadCallback callback){
+	if (W25Qxx_AsyncBusy || W25Qxx_ProgramBusy) return HAL_BUSY;
+	if (buffer == NULL) return HAL_ERROR;
+
+	if (W25Qxx_MemoryMappedActive || size == 0) {
+		if (size > 0) memcpy(buffer, W25Qxx_MappedAddress(address), size);
+		if (callback) callback(HAL_OK);
+		return HAL_OK;
+	}
+
+	uint32_t start = (uint32_t)buffer & ~31UL;
+	uint32_t end = (uint32_t)buffer + size;
+	SCB_CleanInvalidateDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+
+	W25Qxx_AsyncAddress = address;
+	W25Qxx_AsyncBuffer = buffer;
+	W25Qxx_AsyncRemaining = size;
+	W25Qxx_AsyncStart = buffer;
+	W25Qxx_AsyncSize = size;
+	W25Qxx_AsyncCallback = callback;
+	W25Qxx_AsyncBusy = 1;
+
+	if (W25Qxx_StartReadChunk() != HAL_OK) {
+		W25Qxx_AsyncBusy = 0;
+		return HAL_ERROR;
+	}
+	return HAL_OK;
+}
+
+/**
+ * @brief Gibt an, ob ein W25Qxx_ReadAsync-Transfer läuft.
+ */
+uint8_t W25Qxx_IsReadBusy(void){
+	return W25Qxx_AsyncBusy;
+}
+
+/**
+ * @brief Wartet, bis ein laufender W25Qxx_ReadAsync-Transfer beendet ist.
+ */
+void W25Qxx_WaitReadAsync(void){
+	while (W25Qxx_AsyncBusy) {}
+}
+
+/**
+ * @brief Transfer-Complete-Callback des OCTOSPI: startet den nächsten Abschnitt oder beendet den Transfer.
+ * @note  Wird im Interrupt-Kontext (OCTOSPI1) ausgeführt
+ */
+void HAL_OSPI_RxCpltCallback(OSPI_HandleTypeDef *hospi){
+	if (hospi != &hospi1 || !W25Qxx_AsyncBusy) return;
+
+	if (W25Qxx_AsyncRemaining == 0) {
+		W25Qxx_FinishRead(HAL_OK);
+	} else if (W25Qxx_StartReadChunk() != HAL_OK) {
+		W25Qxx_FinishRead(HAL_ERROR);
+	}
+}
+
+/**
+ * @brief Fehler-Callback des OCTOSPI: bricht einen laufenden W25Qxx_ReadAsync-Transfer ab.
+ * @note  Wird im Interrupt-Kontext (OCTOSPI1/MDMA) ausgeführt
+ */
+void HAL_OSPI_ErrorCallback(OSPI_HandleTypeDef *hospi){
+	if (hospi != &hospi1) return;
+
+	if (W25Qxx_AsyncBusy) {
+		W25Qxx_FinishRead(HAL_ERROR);
+	} else if (W25Qxx_ProgramBusy) {
+		W25Qxx_FinishProgram(HAL_ERROR);
+	}
+}
+
+/**
+ * @brief Programmiert einen gelöschten Bereich im Hintergrund, Seite für Seite per MDMA.
+ *
+ * Je Seite sendet der Treiber Write Enable (0x06) und Quad Input Page Program (0x32), die
+ * Daten holt der MDMA-Kanal des OCTOSPI aus dem Puffer. Nach dem Transfer-Complete-Interrupt
+ * fragt der OCTOSPI das BUSY-Bit selbst ab (Auto-Polling); der Status-Match-Interrupt startet
+ * sofort die nächste Seite. Der Chip programmiert so ohne Lücke eine Seite nach der anderen,
+ * die CPU ist dabei frei. Seiten, die nur 0xFF enthalten, werden übersprungen.
+ *
+ * Vor dem Start wird der Quellbereich im D-Cache bereinigt, damit der MDMA die aktuellen Daten
+ * liest. Der Lesecache verwirft die betroffenen Zeilen.
+ *
+ * @param address Zieladresse, der Bereich muss gelöscht sein (0xFF).
+ * @param data Quelldaten; müssen bis zum Callback gültig bleiben und dürfen nicht geändert werden.
+ * @param size Die Anzahl der zu schreibenden Bytes, beliebig über Seitengrenzen.
+ * @param callback Wird nach der letzten Seite mit HAL_OK, bei einem Fehler mit HAL_ERROR oder
+ *                 HAL_TIMEOUT aufgerufen (Interrupt-Kontext; ohne Seite mit Daten sofort),
+ *                 darf NULL sein.
+ *
+ * @return HAL_OK, wenn der Auftrag gestartet wurde, HAL_BUSY, wenn noch ein Lese- oder
+ *         Schreibauftrag läuft, sonst HAL_ERROR.
+ *
+ * @note Der Memory-Mapped-Modus wird verlassen und bleibt aus, bis der Aufrufer ihn nach dem
+ *       Ende wieder einschaltet (W25Qxx_EnableMemoryMapped()). Alle anderen W25Qxx-Funktionen
+ *       warten, bis der Auftrag beendet ist.
+ *
+ * @see W25Qxx_IsProgramBusy(), W25Qxx_WaitProgramAsync(), W25Qxx_PageProgram()
+ */
+HAL_StatusTypeDef W25Qxx_ProgramAsync(uint32_t address, const uint8_t *data, uint32_t size, W25Qxx_ProgramCallback callback){
+	if (W25Qxx_AsyncBusy || W25Qxx_ProgramBusy) return HAL_BUSY;
+	if (data == NULL && size > 0) return HAL_ERROR;
+
+	W25Qxx_DisableMemoryMapped();
+	W25Qxx_InvalidateReadCache(address, size);
+	if (size > 0) {
+		uint32_t start = (uint32_t)data & ~31UL;
+		uint32_t end = (uint32_t)data + size;
+		SCB_CleanDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+	}
+
+	W25Qxx_ProgramAddress = address;
+	W25Qxx_ProgramData = data;
+	W25Qxx_ProgramRemaining = size;
+	W25Qxx_ProgramLength = 0;
+	W25Qxx_ProgramDone = callback;
+	W25Qxx_ProgramResult = HAL_OK;
+	W25Qxx_ProgramTick = HAL_GetTick();
+	W25Qxx_ProgramStatistics.writes++;
+	W25Qxx_ProgramBusy = 1;
+
+	if (W25Qxx_StartProgramPage() != HAL_OK) {
+		HAL_OSPI_Abort(&hospi1);
+		W25Qxx_ProgramStatistics.errors++;
+		W25Qxx_ProgramBusy = 0;
+		return HAL_ERROR;
+	}
+	return HAL_OK;
+}
+
+/**
+ * @brief Gibt an, ob ein W25Qxx_ProgramAsync-Auftrag läuft.
+ */
+uint8_t W25Qxx_IsProgramBusy(void){
+	return W25Qxx_ProgramBusy;
+}
+
+/**
+ * @brief Wartet, bis ein laufender W25Qxx_ProgramAsync-Auftrag beendet ist.
+ *
+ * Kommt eine Seite nicht innerhalb von W25QXX_PAGE_TIMEOUT_MS zum Ende, wird der Auftrag mit
+ * HAL_TIMEOUT abgebrochen.
+ *
+ * @return Ergebnis des letzten Auftrags
+ */
+HAL_StatusTypeDef W25Qxx_WaitProgramAsync(void){
+	while (W25Qxx_ProgramBusy) {
+		if (HAL_GetTick() - W25Qxx_ProgramTick > W25QXX_PAGE_TIMEOUT_MS) {
+			// Keep the interrupt from chaining the next page while the job is torn down
+			HAL_NVIC_DisableIRQ(OCTOSPI1_IRQn);
+			if (W25Qxx_ProgramBusy) W25Qxx_FinishProgram(HAL_TIMEOUT);
+			HAL_NVIC_EnableIRQ(OCTOSPI1_IRQn);
+		}
+	}
+	return W25Qxx_ProgramResult;
+}
+
+/**
+ * @brief Transfer-Complete-Callback des OCTOSPI: die Seite liegt im Chip, das Auto-Polling wartet ihr Programmieren ab.
+ * @note  Wird im Interrupt-Kontext (OCTOSPI1) ausgeführt
+ */
+void HAL_OSPI_TxCpltCallback(OSPI_HandleTypeDef *hospi){
+	if (hospi != &hospi1 || !W25Qxx_ProgramBusy) return;
+
+	if (W25Qxx_StartPolling() != HAL_OK) {
+		W25Qxx_FinishProgram(HAL_ERROR);
+	}
+}
+
+
+
+/**
+ * @brief Schaltet den W25Qxx-Flash in den Memory-Mapped-Modus (XIP).
+ *
+ * Als Lesebefehl wird 0xEB (Fast Read Quad I/O, 1-4-4) konfiguriert: Adresse und
+ * Daten laufen über vier Leitungen, die Modusbits M7-0 = 0x20 versetzen den Chip in den
+ * Continuous-Read-Modus. Zusammen mit SIOO (Instruktion nur beim ersten Zugriff) entfällt
+ * bei jedem weiteren Burst das Befehlsbyte. Meldet die SFDP-Tabelle nur 0x6B (1-1-4), wird
+ * dieser ohne Continuous-Read-Modus verwendet. Der ganze Chip (W25Qxx_Device.size) erscheint ab
+ * W25QXX_MAPPED_BASE im Adressraum; Schriften, Bilder und Tabellen können von dort direkt
+ * gelesen oder per DMA zum Display übertragen werden.
+ *
+ * @return 1 bei Erfolg, 0 bei einem HAL-Fehler
+ *
+ * @note Der Quad-Modus (QE-Bit) muss aktiv sein, siehe W25Qxx_begin(). Für den
+ *       Adressbereich ist in MPU_Config() eine eigene MPU-Region eingerichtet, die
+ *       W25Qxx_begin() bei Chips über 16 MB vergrößert.
+ *
+ * @see W25Qxx_DisableMemoryMapped(), W25Qxx_MappedAddress()
+ */
+uint8_t W25Qxx_EnableMemoryMapped(void){
+	if (W25Qxx_MemoryMappedActive) return 1;
+	W25Qxx_WaitReadAsync();
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_READ_CFG;
+	cmd.FlashId = HAL_OSPI_FLASH_ID_1;
+	cmd.InstructionSize = HAL_OSPI_INSTRUCTION_8_BITS;
+	W25Qxx_SetupRead(&cmd, 0, 1);            // Fast Read Quad I/O, Continuous Read Mode
+	cmd.DQSMode = HAL_OSPI_DQS_DISABLE;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return 0;
+
+	// Schreiben ist im Memory-Mapped-Modus nicht vorgesehen, die HAL verlangt aber beide Konfigurationen
+	cmd.OperationType = HAL_OSPI_OPTYPE_WRITE_CFG;
+	cmd.Instruction = 0x32;                  // Quad Input Page Program command
+	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
+	cmd.AddressDtrMode = HAL_OSPI_ADDRESS_DTR_DISABLE;
+	cmd.AlternateBytesMode = HAL_OSPI_ALTERNATE_BYTES_NONE;
+	cmd.DataDtrMode = HAL_OSPI_DATA_DTR_DISABLE;
+	cmd.DummyCycles = 0;
+	cmd.SIOOMode = HAL_OSPI_SIOO_INST_EVERY_CMD;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return 0;
+
+	OSPI_MemoryMappedTypeDef mapped = {0};
+	mapped.TimeOutActivation = HAL_OSPI_TIMEOUT_COUNTER_ENABLE;
+	mapped.TimeOutPeriod = 0x20;             // nCS nach 32 Takten ohne Zugriff freigeben
+	if (HAL_OSPI_MemoryMapped(&hospi1, &mapped) != HAL_OK) return 0;
+
+	W25Qxx_MemoryMappedActive = 1;
+	return 1;
+}
+
+/**
+ * @brief Verlässt den Memory-Mapped-Modus.
+ *
+ * Bricht den Memory-Mapped-Zugriff des OCTOSPI ab und sendet anschließend 8 Takte mit
+ * 0xFF auf allen vier Leitungen (Continuous Read Mode Reset), damit der Chip wieder
+ * Befehlsbytes erwartet.
+ *
+ * @see W25Qxx_EnableMemoryMapped()
+ */
+void W25Qxx_DisableMemoryMapped(void){
+	if (!W25Qxx_MemoryMappedActive) return;
+
+	HAL_OSPI_Abort(&hospi1);
+	W25Qxx_MemoryMappedActive = 0;
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0xFFFFFFFF;            // Continuous Read Mode Reset
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_4_LINES;
+	cmd.InstructionSize = HAL_OSPI_INSTRUCTION_32_BITS;
+	cmd.AddressMode = HAL_OSPI_ADDRESS_NONE;
+	cmd.DataMode = HAL_OSPI_DATA_NONE;
+	HAL_OSPI_Command(&hospi1, &cmd, 100);
+}
+
+/**
+ * @brief Gibt an, ob der Memory-Mapped-Modus aktiv ist.
+ */
+uint8_t W25Qxx_IsMemoryMapped(void){
+	return W25Qxx_MemoryMappedActive;
+}
+
+/**
+ * @brief Schaltet die Quad-Lesebefehle auf Fast Read Quad I/O DTR (0xED) um.
+ *
+ * Adresse, Modusbits und Daten laufen dann auf beiden Taktflanken, bei gleichem OCTOSPI-Takt
+ * verdoppelt sich die Datenrate. Das gilt für W25Qxx_FastReadQuadOutput(), W25Qxx_ReadAsync(),
+ * den Lesecache und den Memory-Mapped-Modus; Status-, Schreib- und Löschbefehle bleiben SDR.
+ *
+ * Selbsttest: W25QXX_DTR_TEST_SIZE Bytes ab testAddress werden zuerst mit SDR gelesen, dann mit
+ * DTR indirekt, noch einmal mit SDR (0x03) und zuletzt über das Memory-Mapped-Fenster. Weicht
+ * eine Lesung ab, bleibt SDR mit dem alten Timing aktiv.
+ *
+ * @param testAddress Anfang eines Bereichs mit wechselnden Daten; gelöschter Flash (nur 0xFF)
+ *                    erkennt verschobene Abtastzeitpunkte nicht.
+ * @return 1, wenn DTR aktiv ist, 0 ohne Unterstützung (W25Qxx_Device.dtrInstruction) oder bei
+ *         fehlgeschlagenem Selbsttest.
+ *
+ * @note Im DTR-Modus ist Sample Shifting nicht erlaubt, dafür wird Delay Hold Quarter Cycle
+ *       eingeschaltet (TCR). MX_OCTOSPI1_ApplySetting() setzt SSHIFT neu; nach einer Änderung
+ *       des Timings muss DTR daher mit W25Qxx_DisableDtr() aus- und danach wieder eingeschaltet
+ *       werden.
+ */
+uint8_t W25Qxx_EnableDtr(uint32_t testAddress){
+	if (W25Qxx_Device.dtrInstruction == 0 || (uint64_t)testAddress + W25QXX_DTR_TEST_SIZE > W25Qxx_Device.size) return 0;
+
+	uint8_t wasMapped = W25Qxx_Suspend();
+	uint8_t *reference = W25Qxx_SectorBuffer;
+	uint8_t *sample = &W25Qxx_SectorBuffer[W25QXX_DTR_TEST_SIZE];
+
+	W25Qxx_DisableDtr();
+	W25Qxx_FastReadQuadOutput(testAddress, reference, W25QXX_DTR_TEST_SIZE);
+
+	W25Qxx_SetDtrTiming(1);
+	W25Qxx_Device.readDtr = 1;
+	memset(sample, 0, W25QXX_DTR_TEST_SIZE);
+	W25Qxx_FastReadQuadOutput(testAddress, sample, W25QXX_DTR_TEST_SIZE);
+	uint8_t ok = (memcmp(reference, sample, W25QXX_DTR_TEST_SIZE) == 0);
+
+	// SDR commands now run without sample shifting
+	if (ok) {
+		memset(sample, 0, W25QXX_DTR_TEST_SIZE);
+		W25Qxx_ReadData(testAddress, sample, W25QXX_DTR_TEST_SIZE);
+		ok = (memcmp(reference, sample, W25QXX_DTR_TEST_SIZE) == 0);
+	}
+	if (ok) {
+		ok = W25Qxx_EnableMemoryMapped();
+		if (ok) {
+			const uint8_t *window = W25Qxx_MappedAddress(testAddress);
+			SCB_InvalidateDCache_by_Addr((uint32_t*)((uint32_t)window & ~31UL), (int32_t)(W25QXX_DTR_TEST_SIZE + 32));
+			ok = (memcmp(reference, window, W25QXX_DTR_TEST_SIZE) == 0);
+			W25Qxx_DisableMemoryMapped();
+		}
+	}
+
+	if (!ok) W25Qxx_DisableDtr();
+	W25Qxx_Resume(wasMapped, 0, 0);
+	return ok;
+}
+
+/**
+ * @brief Schaltet die Lesebefehle zurück auf SDR und stellt Sample Shifting wieder her.
+ * @note  Ein aktiver Memory-Mapped-Modus wird dafür kurz verlassen.
+ */
+void W25Qxx_DisableDtr(void){
+	if (!W25Qxx_Device.readDtr) return;
+
+	uint8_t wasMapped = W25Qxx_Suspend();
+	W25Qxx_Device.readDtr = 0;
+	W25Qxx_SetDtrTiming(0);
+	W25Qxx_Resume(wasMapped, 0, 0);
+}
+
+/**
+ * @brief Verwirft die Zeilen des Lesecaches, die den Bereich berühren.
+ *
+ * Wird von W25Qxx_Resume() am Ende jeder Schreib- und Löschfunktion und von
+ * W25Qxx_EraseSectorStart() aufgerufen, auch ohne Memory-Mapped-Modus.
+ *
+ * @param address Anfang des geänderten Bereichs.
+ * @param size Länge in Bytes; 0 verwirft nichts, 0xFFFFFFFF alles.
+ */
+void W25Qxx_InvalidateReadCache(uint32_t address, uint32_t size){
+#ifdef W25QXX_READ_CACHE
+	if (size == 0) return;
+	uint64_t end = (uint64_t)address + size;
+
+	for (uint32_t i = 0; i < W25QXX_CACHE_LINES; i++) {
+		W25Qxx_CacheLine *line = &W25Qxx_CacheLines[i];
+		if (line->valid && line->address < end && address < line->address + W25QXX_CACHE_LINE_SIZE) {
+			line->valid = 0;
+			W25Qxx_CacheStatistics.invalidations++;
+		}
+	}
+#endif
+}
+
+/**
+ * @brief Verlässt den Memory-Mapped-Modus vor einem indirekten Befehl.
+ * @return 1, wenn der Modus aktiv war und danach wiederhergestellt werden muss
+ */
+static uint8_t W25Qxx_Suspend(void){
+	W25Qxx_WaitReadAsync();
+	W25Qxx_WaitProgramAsync();
+
+	uint8_t wasMapped = W25Qxx_MemoryMappedActive;
+	W25Qxx_DisableMemoryMapped();
+	return wasMapped;
+}
+
+/**
+ * @brief Stellt den Memory-Mapped-Modus wieder her und verwirft veraltete Cache-Zeilen.
+ */
+static void W25Qxx_Resume(uint8_t wasMapped, uint32_t address, uint32_t size){
+	W25Qxx_InvalidateReadCache(address, size);
+	if (!wasMapped) return;
+
+	W25Qxx_EnableMemoryMapped();
+	if (size > 0) {
+		uint32_t start = (W25QXX_MAPPED_BASE + address) & ~31UL;
+		uint32_t end = W25QXX_MAPPED_BASE + address + size;
+		SCB_InvalidateDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+	}
+}
+
+/**
+ * @brief Sendet einen Löschbefehl mit 24- oder 32-Bit-Adresse und wartet auf dessen Abschluss.
+ * @note  Write Enable muss vorher gesendet worden sein
+ */
+static void W25Qxx_EraseCommand(uint8_t instruction, uint32_t address){
+	// The finished erase clears WEL, so Write Enable has to be sent again
+	if (W25Qxx_FinishSuspendedErase()) W25Qxx_WriteEnable();
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = instruction;
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.Address = address;                   // 24- or 32-bit address
+	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
+	cmd.AddressSize = W25Qxx_Device.addressSize;
+	cmd.DataMode = HAL_OSPI_DATA_NONE;
+	HAL_OSPI_Command(&hospi1, &cmd, 100);
+	W25Qxx_WaitForWriteComplete();            // Wait for erase to complete
+}
+
+/**
+ * @brief Setzt einen angehaltenen Löschvorgang fort und wartet sein Ende ab.
+ * @return 1, wenn einer angehalten war
+ * @note  Während Erase Suspend nimmt der Chip keinen Löschbefehl an
+ */
+static uint8_t W25Qxx_FinishSuspendedErase(void){
+	if (!W25Qxx_EraseSuspended) return 0;
+
+	W25Qxx_EraseResume();
+	W25Qxx_WaitForWriteComplete();
+	return 1;
 }
 
+/**
+ * @brief Löscht eine Einheit mit dem Befehl aus W25Qxx_Device, ohne eigenen Befehl Sektor für Sektor.
+ * @note  Write Enable für den ersten Befehl muss vorher gesendet worden sein
+ */
+static void W25Qxx_EraseUnit(uint8_t type, uint32_t address, uint32_t size){
+	uint8_t instruction = W25Qxx_Device.eraseInstruction[type];
+	if (instruction != 0) {
+		W25Qxx_EraseCommand(instruction, address);
+		return;
+	}
 
+	for (uint32_t offset = 0; offset < size; offset += W25Q128_SECTOR_SIZE) {
+		if (offset > 0) W25Qxx_WriteEnable();
+		W25Qxx_EraseCommand(W25Qxx_Device.eraseInstruction[W25QXX_ERASE_4K], address + offset);
+	}
+}
 
+/**
+ * @brief Trägt den Quad-Lesebefehl aus W25Qxx_Device in cmd ein (Befehl, Adresse, Modusbits, Wartetakte).
+ * @param continuous 1: Modusbits 0x20 und SIOO für den Memory-Mapped-Modus (nur bei 0xEB),
+ *                   0: Modusbits 0x00, der Chip erwartet beim nächsten Zugriff wieder einen Befehl
+ */
+static void W25Qxx_SetupRead(OSPI_RegularCmdTypeDef *cmd, uint32_t address, uint8_t continuous){
+	if (W25Qxx_Device.readDtr) {
+		// 1-4D-4D: address, mode bits (one clock) and data on both clock edges
+		cmd->Instruction = W25Qxx_Device.dtrInstruction;
+		cmd->InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+		cmd->Address = address;
+		cmd->AddressMode = HAL_OSPI_ADDRESS_4_LINES;
+		cmd->AddressSize = W25Qxx_Device.addressSize;
+		cmd->AddressDtrMode = HAL_OSPI_ADDRESS_DTR_ENABLE;
+		cmd->AlternateBytes = continuous ? 0x20 : 0x00;
+		cmd->AlternateBytesMode = HAL_OSPI_ALTERNATE_BYTES_4_LINES;
+		cmd->AlternateBytesSize = HAL_OSPI_ALTERNATE_BYTES_8_BITS;
+		cmd->AlternateBytesDtrMode = HAL_OSPI_ALTERNATE_BYTES_DTR_ENABLE;
+		cmd->DataMode = HAL_OSPI_DATA_4_LINES;
+		cmd->DataDtrMode = HAL_OSPI_DATA_DTR_ENABLE;
+		cmd->DummyCycles = W25QXX_DTR_DUMMY_CYCLES;
+		cmd->SIOOMode = continuous ? HAL_OSPI_SIOO_INST_ONLY_FIRST_CMD : HAL_OSPI_SIOO_INST_EVERY_CMD;
+		return;
+	}
+
+	cmd->Instruction = W25Qxx_Device.readInstruction;
+	cmd->InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd->Address = address;                  // 24- or 32-bit address
+	cmd->AddressMode = (W25Qxx_Device.readAddressLines == 4) ? HAL_OSPI_ADDRESS_4_LINES : HAL_OSPI_ADDRESS_1_LINE;
+	cmd->AddressSize = W25Qxx_Device.addressSize;
+	cmd->DataMode = HAL_OSPI_DATA_4_LINES;   // Receive data on 4 lines
+	cmd->DummyCycles = W25Qxx_Device.readDummyCycles;
+	cmd->SIOOMode = HAL_OSPI_SIOO_INST_EVERY_CMD;
+
+	if (W25Qxx_Device.readModeClocks > 0) {
+		// Two mode clocks on four lines: M7-0, M5-4 = 10b selects Continuous Read Mode
+		cmd->AlternateBytes = continuous ? 0x20 : 0x00;
+		cmd->AlternateBytesMode = HAL_OSPI_ALTERNATE_BYTES_4_LINES;
+		cmd->AlternateBytesSize = HAL_OSPI_ALTERNATE_BYTES_8_BITS;
+		if (continuous) cmd->SIOOMode = HAL_OSPI_SIOO_INST_ONLY_FIRST_CMD;
+	} else {
+		cmd->AlternateBytesMode = HAL_OSPI_ALTERNATE_BYTES_NONE;
+	}
+}
+
+/**
+ * @brief Liest die SFDP-Tabelle und übernimmt die Basic Flash Parameter Table nach W25Qxx_Device.
+ * @return 1, wenn eine gültige Tabelle gefunden wurde
+ * @note  Read SFDP (0x5A) hat immer eine 24-Bit-Adresse und 8 Wartetakte, auch im 4-Byte-Modus
+ */
+static uint8_t W25Qxx_ReadSfdp(void){
+	uint32_t header[4];
+	uint32_t bfpt[W25QXX_SFDP_DWORDS] = {0};
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0x5A;                  // Read SFDP command
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.Address = 0x000000;                  // SFDP header and first parameter header
+	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
+	cmd.AddressSize = HAL_OSPI_ADDRESS_24_BITS;
+	cmd.DataMode = HAL_OSPI_DATA_1_LINE;
+	cmd.DummyCycles = 8;
+	cmd.NbData = sizeof(header);
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return 0;
+	if (HAL_OSPI_Receive(&hospi1, (uint8_t*)header, 100) != HAL_OK) return 0;
+	if (header[0] != W25QXX_SFDP_SIGNATURE) return 0;
+
+	// Parameter header 0: ID LSB 0x00 (BFPT), length in DWORDs, 24-bit table pointer
+	uint32_t length = header[2] >> 24;
+	uint32_t pointer = header[3] & 0x00FFFFFFUL;
+	if ((header[2] & 0xFF) != 0x00 || length < 9) return 0;
+	if (length > W25QXX_SFDP_DWORDS) length = W25QXX_SFDP_DWORDS;
+
+	cmd.Address = pointer;
+	cmd.NbData = length * 4;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return 0;
+	if (HAL_OSPI_Receive(&hospi1, (uint8_t*)bfpt, 100) != HAL_OK) return 0;
+
+	W25Qxx_ParseBfpt(bfpt, length);
+	return 1;
+}
+
+/**
+ * @brief Wertet die Basic Flash Parameter Table aus (DWORD 1-16 nach JESD216B).
+ *
+ * - DWORD 2: Kapazität in Bit (Bit 31 = 0: Wert + 1, sonst 2^Wert)
+ * - DWORD 1/3: 1-4-4- und 1-1-4-Lesebefehl mit Warte- und Modustakten
+ * - DWORD 8/9: bis zu vier Löschtypen als Zweierpotenz und Befehl
+ * - DWORD 11: Seitengröße als Zweierpotenz (ab JESD216A)
+ *
+ * Ungültige oder unpassende Felder lassen den Vorgabewert stehen. 4 KB muss als Löscheinheit
+ * vorhanden sein, sonst bleiben die Löschbefehle des W25Q128 (Sektorpuffer von W25Qxx_WriteData).
+ */
+static void W25Qxx_ParseBfpt(const uint32_t *dword, uint32_t count){
+	uint32_t density = dword[1];
+	uint64_t bits;
+	if (density & 0x80000000UL) {
+		uint32_t exponent = density & 0x7FFFFFFFUL;
+		bits = (exponent >= 3 && exponent < 40) ? (1ULL << exponent) : 0;
+	} else {
+		bits = (uint64_t)density + 1;
+	}
+	// The OCTOSPI1 window is 256 MB
+	if (bits >= 8ULL * 1024 * 1024 && bits <= 8ULL * 256 * 1024 * 1024) {
+		W25Qxx_Device.size = (uint32_t)(bits / 8);
+	}
+
+	// Fast read: 1-4-4 (0xEB) with two mode clocks first, then 1-1-4 (0x6B)
+	uint8_t waitQio = dword[2] & 0x1F, modeQio = (dword[2] >> 5) & 0x07, opQio = (dword[2] >> 8) & 0xFF;
+	uint8_t waitQo = (dword[2] >> 16) & 0x1F, modeQo = (dword[2] >> 21) & 0x07, opQo = dword[2] >> 24;
+	if ((dword[0] & (1UL << 21)) && opQio != 0 && modeQio == 2) {
+		W25Qxx_Device.readInstruction = opQio;
+		W25Qxx_Device.readAddressLines = 4;
+		W25Qxx_Device.readModeClocks = 2;
+		W25Qxx_Device.readDummyCycles = waitQio;
+	} else if ((dword[0] & (1UL << 22)) && opQo != 0) {
+		// Mode clocks on a single address line are sent as plain dummy clocks
+		W25Qxx_Device.readInstruction = opQo;
+		W25Qxx_Device.readAddressLines = 1;
+		W25Qxx_Device.readModeClocks = 0;
+		W25Qxx_Device.readDummyCycles = waitQo + modeQo;
+	}
+
+	// DWORD 1 bit 19: the part supports DTR clocking
+	if (W25QXX_DTR_READ == 1 && (dword[0] & (1UL << 19)) && W25Qxx_Device.readAddressLines == 4) {
+		W25Qxx_Device.dtrInstruction = W25QXX_DTR_INSTRUCTION;
+	}
+
+	// Erase types: size exponent and instruction, exponent 0 = unused
+	uint8_t erase[W25QXX_ERASE_COUNT] = {0};
+	for (uint8_t type = 0; type < 4; type++) {
+		uint16_t field = (uint16_t)(dword[7 + type / 2] >> ((type % 2) * 16));
+		uint8_t exponent = field & 0xFF, instruction = field >> 8;
+		if (exponent == 12) erase[W25QXX_ERASE_4K] = instruction;
+		else if (exponent == 15) erase[W25QXX_ERASE_32K] = instruction;
+		else if (exponent == 16) erase[W25QXX_ERASE_64K] = instruction;
+	}
+	if (erase[W25QXX_ERASE_4K] != 0) {
+		memcpy(W25Qxx_Device.eraseInstruction, erase, sizeof(erase));
+	}
+
+	if (count >= 11) {
+		uint8_t exponent = (dword[10] >> 4) & 0x0F;
+		if (exponent >= 4 && exponent <= 8) W25Qxx_Device.pageSize = 1UL << exponent;
+	}
+
+	W25Qxx_Device.fromSfdp = 1;
+}
+
+/**
+ * @brief Schaltet Chips über 16 MB auf 4-Byte-Adressen um (Enter 4-Byte Address Mode, 0xB7).
+ *
+ * Der Modus bleibt, bis der Chip die Versorgung verliert oder zurückgesetzt wird; ein
+ * erneuter Aufruf nach einem Neustart des Controllers ist unschädlich. Die normalen Befehle
+ * (0x03, 0x0B, 0x6B, 0xEB, 0x32, 0x20, 0x52, 0xD8) senden danach 32-Bit-Adressen.
+ */
+static void W25Qxx_EnterAddressMode(void){
+	if (W25Qxx_Device.size <= W25QXX_3BYTE_LIMIT) {
+		W25Qxx_Device.addressSize = HAL_OSPI_ADDRESS_24_BITS;
+		return;
+	}
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0xB7;                  // Enter 4-Byte Address Mode command
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.AddressMode = HAL_OSPI_ADDRESS_NONE;
+	cmd.DataMode = HAL_OSPI_DATA_NONE;
+	HAL_OSPI_Command(&hospi1, &cmd, 100);
+
+	W25Qxx_Device.addressSize = HAL_OSPI_ADDRESS_32_BITS;
+}
+
+/**
+ * @brief Passt Gerätegröße des OCTOSPI1 und MPU-Region 1 (Adressfenster) an W25Qxx_Device.size an.
+ * @note  MPU_Config() richtet die Region für 16 MB ein; nur größere Chips ändern sie
+ */
+static void W25Qxx_ConfigureWindow(void){
+	uint32_t exponent = 31 - __CLZ(W25Qxx_Device.size);
+
+	// DEVSIZE holds log2(size) - 1, the HAL init value is log2(size)
+	hospi1.Init.DeviceSize = exponent;
+	MODIFY_REG(hospi1.Instance->DCR1, OCTOSPI_DCR1_DEVSIZE, (exponent - 1) << OCTOSPI_DCR1_DEVSIZE_Pos);
+
+	if (W25Qxx_Device.size <= W25QXX_3BYTE_LIMIT) return;
+
+	MPU_Region_InitTypeDef region = {0};
+	region.Enable = MPU_REGION_ENABLE;
+	region.Number = MPU_REGION_NUMBER1;
+	region.BaseAddress = W25QXX_MAPPED_BASE;
+	region.Size = (uint8_t)(exponent - 1);   // MPU_REGION_SIZE_xx = log2(size) - 1
+	region.SubRegionDisable = 0x0;
+	region.TypeExtField = MPU_TEX_LEVEL0;
+	region.AccessPermission = MPU_REGION_FULL_ACCESS;
+	region.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
+	region.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+	region.IsCacheable = MPU_ACCESS_CACHEABLE;
+	region.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+
+	HAL_MPU_Disable();
+	HAL_MPU_ConfigRegion(&region);
+	HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+}
+
+/**
+ * @brief Timing für DTR: kein Sample Shifting, Delay Hold Quarter Cycle; für SDR wie in hospi1.Init.
+ * @note  Nur ohne laufende Übertragung und außerhalb des Memory-Mapped-Modus aufrufen
+ */
+static void W25Qxx_SetDtrTiming(uint8_t dtr){
+	while (READ_BIT(hospi1.Instance->SR, OCTOSPI_SR_BUSY)) {}
+
+	if (dtr) {
+		MODIFY_REG(hospi1.Instance->TCR, OCTOSPI_TCR_SSHIFT | OCTOSPI_TCR_DHQC, HAL_OSPI_DHQC_ENABLE);
+	} else {
+		MODIFY_REG(hospi1.Instance->TCR, OCTOSPI_TCR_SSHIFT | OCTOSPI_TCR_DHQC,
+				hospi1.Init.SampleShifting | hospi1.Init.DelayHoldQuarterCycle);
+	}
+}
+
+/**
+ * @brief Programmiert einen gelöschten Bereich seitenweise und überspringt Seiten, die nur 0xFF enthalten.
+ * @note  Die Seiten folgen einander aus dem Status-Match-Interrupt (W25Qxx_ProgramAsync()), hier
+ *        wird nur auf das Ende des ganzen Bereichs gewartet.
+ */
+static void W25Qxx_ProgramRange(uint32_t address, const uint8_t *data, uint32_t size){
+	if (W25Qxx_ProgramAsync(address, data, size, NULL) == HAL_OK) {
+		W25Qxx_WaitProgramAsync();
+	}
+}
+
+/**
+ * @brief Startet das Auto-Polling auf BUSY = 0 in Status-Register 1, das Ende meldet der Status-Match-Interrupt.
+ */
+static HAL_StatusTypeDef W25Qxx_StartPolling(void){
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0x05;                  // Read Status Register command
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.AddressMode = HAL_OSPI_ADDRESS_NONE;
+	cmd.DataMode = HAL_OSPI_DATA_1_LINE;
+	cmd.NbData = 1;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return HAL_ERROR;
+
+	OSPI_AutoPollingTypeDef polling = {0};
+	polling.Match = 0x00;                    // BUSY = 0
+	polling.Mask = 0x01;                     // Only compare the BUSY bit
+	polling.MatchMode = HAL_OSPI_MATCH_MODE_AND;
+	polling.Interval = 0x10;                 // Poll every 16 clock cycles
+	polling.AutomaticStop = HAL_OSPI_AUTOMATIC_STOP_ENABLE;
+
+	W25Qxx_StatusMatched = 0;
+	return HAL_OSPI_AutoPolling_IT(&hospi1, &polling);
+}
+
+/**
+ * @brief Sendet Write Enable und Page Program für die nächste Seite mit Daten und startet deren MDMA-Transfer.
+ *
+ * Ist keine Seite mehr übrig, endet der Auftrag hier mit HAL_OK.
+ */
+static HAL_StatusTypeDef W25Qxx_StartProgramPage(void){
+	for (;;) {
+		if (W25Qxx_ProgramRemaining == 0) {
+			W25Qxx_FinishProgram(HAL_OK);
+			return HAL_OK;
+		}
+
+		uint32_t spaceInPage = W25Qxx_Device.pageSize - (W25Qxx_ProgramAddress % W25Qxx_Device.pageSize);
+		uint32_t length = (W25Qxx_ProgramRemaining > spaceInPage) ? spaceInPage : W25Qxx_ProgramRemaining;
+
+		uint32_t i = 0;
+		while (i < length && W25Qxx_ProgramData[i] == 0xFF) i++;
+		if (i < length) {
+			W25Qxx_ProgramLength = length;
+			break;
+		}
+
+		// Erased flash already holds this page
+		W25Qxx_ProgramStatistics.skipped++;
+		W25Qxx_ProgramAddress += length;
+		W25Qxx_ProgramData += length;
+		W25Qxx_ProgramRemaining -= length;
+	}
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	cmd.Instruction = 0x06;                  // Write Enable command, WEL clears after every page
+	cmd.InstructionMode = HAL_OSPI_INSTRUCTION_1_LINE;
+	cmd.AddressMode = HAL_OSPI_ADDRESS_NONE;
+	cmd.DataMode = HAL_OSPI_DATA_NONE;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return HAL_ERROR;
+
+	cmd.Instruction = 0x32;                  // Quad Input Page Program command
+	cmd.Address = W25Qxx_ProgramAddress;     // 24- or 32-bit address
+	cmd.AddressMode = HAL_OSPI_ADDRESS_1_LINE;
+	cmd.AddressSize = W25Qxx_Device.addressSize;
+	cmd.DataMode = HAL_OSPI_DATA_4_LINES;    // Send data on 4 lines
+	cmd.NbData = W25Qxx_ProgramLength;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return HAL_ERROR;
+
+	W25Qxx_ProgramTick = HAL_GetTick();
+	return HAL_OSPI_Transmit_DMA(&hospi1, (uint8_t*)W25Qxx_ProgramData);
+}
+
+/**
+ * @brief Beendet den laufenden W25Qxx_ProgramAsync-Auftrag und ruft den Callback auf.
+ */
+static void W25Qxx_FinishProgram(HAL_StatusTypeDef status){
+	if (status != HAL_OK) {
+		HAL_OSPI_Abort(&hospi1);
+		W25Qxx_ProgramStatistics.errors++;
+	}
+
+	W25Qxx_ProgramCallback callback = W25Qxx_ProgramDone;
+	W25Qxx_ProgramResult = status;
+	W25Qxx_ProgramBusy = 0;
+	if (callback) callback(status);
+}
+
+/**
+ * @brief Startet den nächsten Abschnitt des laufenden W25Qxx_ReadAsync-Transfers.
+ */
+static HAL_StatusTypeDef W25Qxx_StartReadChunk(void){
+	uint32_t chunk = (W25Qxx_AsyncRemaining > W25QXX_DMA_MAX_CHUNK) ? W25QXX_DMA_MAX_CHUNK : W25Qxx_AsyncRemaining;
+
+	OSPI_RegularCmdTypeDef cmd = {0};
+	cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+	W25Qxx_SetupRead(&cmd, W25Qxx_AsyncAddress, 0);
+	cmd.NbData = chunk;
+	if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK) return HAL_ERROR;
+
+	uint8_t *target = W25Qxx_AsyncBuffer;
+	W25Qxx_AsyncAddress += chunk;
+	W25Qxx_AsyncBuffer += chunk;
+	W25Qxx_AsyncRemaining -= chunk;
+
+	return HAL_OSPI_Receive_DMA(&hospi1, target);
+}
+
+/**
+ * @brief Beendet den laufenden W25Qxx_ReadAsync-Transfer und ruft den Callback auf.
+ */
+static void W25Qxx_FinishRead(HAL_StatusTypeDef status){
+	uint32_t start = (uint32_t)W25Qxx_AsyncStart & ~31UL;
+	uint32_t end = (uint32_t)W25Qxx_AsyncStart + W25Qxx_AsyncSize;
+	SCB_InvalidateDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+
+	if (status != HAL_OK) {
+		HAL_OSPI_Abort(&hospi1);
+	}
+
+	W25Qxx_ReadCallback callback = W25Qxx_AsyncCallback;
+	W25Qxx_AsyncBusy = 0;
+	if (callback) callback(status);
+}
+
+#ifdef W25QXX_READ_CACHE
+/**
+ * @brief Bedient einen kleinen indirekten Lesezugriff aus dem Lesecache.
+ *
+ * Fehlende Zeilen werden sektorweise mit dem Quad-Lesebefehl nachgeladen, dabei wird die
+ * am längsten unbenutzte Zeile ersetzt. Ein Zugriff über eine Sektorgrenze nutzt beide Zeilen.
+ *
+ * @return 1, wenn der Zugriff bedient wurde, 0, wenn er am Cache vorbei gelesen werden muss
+ */
+static uint8_t W25Qxx_CacheRead(uint32_t address, uint8_t *buffer, uint32_t size){
+	if (size >= W25QXX_CACHE_BYPASS) {
+		W25Qxx_CacheStatistics.bypassed++;
+		return 0;
+	}
+
+	while (size > 0) {
+		uint32_t lineAddress = address & ~(W25QXX_CACHE_LINE_SIZE - 1);
+		uint32_t offset = address - lineAddress;
+		uint32_t chunk = W25QXX_CACHE_LINE_SIZE - offset;
+		if (chunk > size) chunk = size;
+
+		W25Qxx_CacheLine *line = NULL;
+		uint32_t victim = 0;
+		for (uint32_t i = 0; i < W25QXX_CACHE_LINES; i++) {
+			if (W25Qxx_CacheLines[i].valid && W25Qxx_CacheLines[i].address == lineAddress) {
+				line = &W25Qxx_CacheLines[i];
+				victim = i;
+				break;
+			}
+			if (!W25Qxx_CacheLines[i].valid
+					|| (W25Qxx_CacheLines[victim].valid && W25Qxx_CacheLines[i].stamp < W25Qxx_CacheLines[victim].stamp)) {
+				victim = i;
+			}
+		}
+
+		if (line != NULL) {
+			W25Qxx_CacheStatistics.hits++;
+		} else {
+			// Load the whole sector with one quad read command
+			OSPI_RegularCmdTypeDef cmd = {0};
+			cmd.OperationType = HAL_OSPI_OPTYPE_COMMON_CFG;
+			W25Qxx_SetupRead(&cmd, lineAddress, 0);
+			cmd.NbData = W25QXX_CACHE_LINE_SIZE;
+			line = &W25Qxx_CacheLines[victim];
+			line->valid = 0;
+			if (HAL_OSPI_Command(&hospi1, &cmd, 100) != HAL_OK
+					|| HAL_OSPI_Receive(&hospi1, W25Qxx_CacheData[victim], W25QXX_READ_TIMEOUT(W25QXX_CACHE_LINE_SIZE)) != HAL_OK) {
+				return 0;
+			}
+			line->address = lineAddress;
+			line->valid = 1;
+			W25Qxx_CacheStatistics.misses++;
+		}
+
+		line->stamp = ++W25Qxx_CacheClock;
+		memcpy(buffer, &W25Qxx_CacheData[victim][offset], chunk);
+		address += chunk;
+		buffer += chunk;
+		size -= chunk;
+	}
+	return 1;
+}
+#endif
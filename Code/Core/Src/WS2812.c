@@ -1,5 +1,7 @@
 #include "WS2812.h"
 #include <stdio.h>
+#include <string.h>
+#include "Cache.h"
 
 /**
  * @file    WS2812.c
@@ -11,10 +13,20 @@
  * (auch NeoPixel genannt) über PWM mit DMA-Unterstützung. Der Treiber nutzt
  * Timer1 zur präzisen Erzeugung der Timing-Signale und unterstützt:
  *
- * - Setzen von RGB-Farbwerten für LEDs
- * - Einstellung der Helligkeit mit Winkel-basierter Skalierung
+ * - Setzen von RGB-Farbwerten für einen Streifen mit MAX_LED LEDs
+ * - Einstellung der Helligkeit in Festkomma mit Gammakorrektur per Tabelle
  * - Effiziente Datenübertragung über DMA
- * - Blockierendes Senden mit Statusüberwachung
+ * - Nicht blockierendes Senden mit Statusabfrage, WS2812_Show() nur bei Änderungen
+ *   und höchstens mit WS2812_FRAME_RATE
+ *
+ * Die Pulsbreiten liegen nicht für den ganzen Streifen im Speicher, sondern in einem
+ * zirkulären DMA-Puffer für genau zwei LEDs (2 x 24 Werte). Während der DMA eine Hälfte
+ * ausgibt, kodiert der Half-Transfer- bzw. Transfer-Complete-Interrupt die nächste LED in
+ * die andere Hälfte. Der Speicherbedarf bleibt damit unabhängig von der Länge des Streifens
+ * (3 Byte Farbe je LED), und es lassen sich hunderte LEDs ansteuern. Nach der letzten LED
+ * folgen WS2812_RESET_SLOTS Hälften mit Nullen als Reset-Pause, dann wird der DMA gestoppt.
+ * Je Hälfte bleiben 30 us für den Interrupt; das Kodieren einer LED dauert nur einen
+ * Bruchteil davon.
  *
  * Die Implementierung basiert auf dem präzisen Timing-Protokoll der WS2812B-LEDs,
  * bei dem Bits durch unterschiedliche Pulsbreiten dargestellt werden (1/3 vs 2/3
@@ -36,7 +48,7 @@
  * 4. Periphere Datenbreite: Halbwort (16 Bit)
  * 5. Speicherdatenbreite: Halbwort (16 Bit)
  * 6. DMA-Priorität: Hoch oder Sehr hoch
- * 7. Circular Mode: Deaktiviert
+ * 7. Circular Mode: Aktiviert (Half-Transfer-Interrupt wird von der HAL eingeschaltet)
  *
  * In STM32CubeMX:
  * - Aktiviere DMA für TIM1
@@ -50,69 +62,122 @@
 
 extern TIM_HandleTypeDef htim1;	//Variable für den Timer handle
 
-uint8_t LED_Data[4];	//Buffer für Daten [0]:LEDIndex, [1] Grün, [2] Rot, [3] Blau
-uint8_t LED_Mod[4];  	//Buffer f+r die Daten mit Helligkeit
+uint8_t WS2812_Pixels[MAX_LED][3];	//Farbdaten je LED: [0] Grün, [1] Rot, [2] Blau
+
+uint16_t WS2812_DmaBuffer[2 * 24] DMA_BUFFER;	//Zirkulärer Puffer mit den Pulsbreiten für zwei LEDs
+
+uint16_t WS2812_Scale FASTDATA = 256;		//Helligkeit als Faktor in 1/256 (256 = voll)
 
-uint16_t pwmData[(24*1)+50];	//Buffer mit Daten welche an die LED gesendet werden
+uint16_t WS2812_PulseHigh FASTDATA = 0;		//Pulsbreite für logisch '1' (2/3 der Periode), von WS2812_Init()
+uint16_t WS2812_PulseLow FASTDATA = 0;		//Pulsbreite für logisch '0' (1/3 der Periode), von WS2812_Init()
+uint16_t WS2812_BitLut[256][8];				//Pulsbreiten der 8 Bits (MSB zuerst) für jeden Bytewert
+volatile uint8_t WS2812_Busy FASTDATA = 0;	//Flag für Kontrolle, ob gerade ein Frame gesendet wird
+uint32_t WS2812_SlotsDone FASTDATA = 0;		//bereits ausgegebene Hälften (LEDs und Reset) im laufenden Frame
 
-volatile uint8_t datasentflag = 0;	//Flag für Kontrolle, ob die Datenübertragung abgeschlossen ist
+volatile uint8_t WS2812_Changed = 1;		//Farben oder Helligkeit seit dem letzten Frame geändert
+uint32_t WS2812_FramePeriodMs = 1000 / WS2812_FRAME_RATE;	//Mindestabstand zweier Frames für WS2812_Show()
+uint32_t WS2812_LastFrameTick = 0;			//HAL_GetTick() beim Start des letzten Frames
 
-uint16_t ARR_TIM1 = 0;	//Variable welche den Wert des AutoReload Register beinhaltet und beim Senden gesetzt wird
+#if WS2812_USE_GAMMA
+/* Gammakorrektur 2,2: out = round(255 * (in / 255)^2.2), vorberechnet.
+ * Macht gleiche Schritte von Farbwert und Helligkeit auch gleich hell wahrnehmbar. */
+static const uint8_t WS2812_Gamma[256] = {
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+	  3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+	  6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+	 12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+	 20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+	 30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+	 42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+	 56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+	 73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+	 91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+	113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+	137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+	163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+	192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+	223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+#endif
+
+#define WS2812_TOTAL_SLOTS (MAX_LED + WS2812_RESET_SLOTS)
 
-#define PI 3.14159265
+static void WS2812_FillSlot(uint32_t slot, uint16_t *half);
+static void WS2812_SlotDone(uint16_t *half);
 
 /**
- * @brief Setzt die RGB-Werte für die LED.
+ * @brief Setzt die RGB-Werte für die erste LED.
  *
- * Diese Funktion speichert die übergebenen RGB-Werte in einem globalen Array,
- * das später für die Datenübertragung an die WS2812-LED verwendet wird.
+ * Kurzform von WS2812_SetPixel(0, ...) für die einzelne LED auf der Platine.
  *
  * @param Red Der Rotwert der LED (0-255).
  * @param Green Der Grünwert der LED (0-255).
  * @param Blue Der Blauwert der LED (0-255).
- *
- * @note Der LED-Index wird standardmäßig auf 0 gesetzt.
- * @note Die Funktion verwendet das globale Array `LED_Data`.
  */
 void WS2812_SetLED (int Red, int Green, int Blue)
 {
-	LED_Data[0] = 0;       // Setzt den LED-Index auf 0
-	LED_Data[1] = Green;   // Speichert den Grünwert
-	LED_Data[2] = Red;     // Speichert den Rotwert
-	LED_Data[3] = Blue;    // Speichert den Blauwert
+	WS2812_SetPixel(0, Red, Green, Blue);
+}
+
+/**
+ * @brief Setzt die RGB-Werte einer LED im Streifen.
+ *
+ * Die Werte werden erst mit dem nächsten WS2812_Send() übertragen. Eine Änderung während
+ * eines laufenden Frames wirkt sich auf die noch nicht gesendeten LEDs sofort aus.
+ *
+ * @param index Position im Streifen (0 bis MAX_LED-1), größere Werte werden ignoriert.
+ */
+void WS2812_SetPixel(uint16_t index, uint8_t Red, uint8_t Green, uint8_t Blue)
+{
+	if (index >= MAX_LED)
+		return;
+
+	uint8_t *pixel = WS2812_Pixels[index];
+	if (pixel[0] == Green && pixel[1] == Red && pixel[2] == Blue)
+		return;
+
+	pixel[0] = Green;
+	pixel[1] = Red;
+	pixel[2] = Blue;
+	WS2812_Changed = 1;
+}
+
+/**
+ * @brief Setzt alle LEDs des Streifens auf dieselbe Farbe.
+ */
+void WS2812_SetAll(uint8_t Red, uint8_t Green, uint8_t Blue)
+{
+	for (uint16_t i = 0; i < MAX_LED; i++)
+		WS2812_SetPixel(i, Red, Green, Blue);
 }
 
 
 /**
- * @brief Setzt die Helligkeit der RGB-LED.
+ * @brief Setzt die Helligkeit aller LEDs.
  *
- * Diese Funktion passt die Helligkeit der RGB-LED an, indem sie die RGB-Werte
- * entsprechend der angegebenen Helligkeit skaliert. Die Berechnung erfolgt
- * mithilfe eines Winkels, der in Abhängigkeit von der Helligkeit bestimmt wird.
+ * Die Farbwerte werden beim Kodieren mit einem Festkomma-Faktor (1/256) skaliert und
+ * danach über WS2812_Gamma korrigiert; die gespeicherten Farben bleiben unverändert.
+ * Da die Gammakorrektur nach der Skalierung kommt, ist die Stufung wahrnehmungslinear.
+ * Kein Gleitkomma, die Funktion darf also in jedem Durchlauf aufgerufen werden.
  *
  * @param brightness Die gewünschte Helligkeit (0-45).
  *
  * @note Diese Funktion ist nur aktiv, wenn `USE_BRIGHTNESS` definiert ist.
- * @note Die maximale Helligkeit ist auf 45 begrenzt.
- * @note Die Funktion verwendet die globalen Arrays `LED_Data` und `LED_Mod`.
+ * @note Die maximale Helligkeit ist auf WS2812_BRIGHTNESS_MAX (45) begrenzt.
  */
 void WS2812_SetBrightness (int brightness)  // 0-45
 {
 #if USE_BRIGHTNESS
 
-    // Begrenze die Helligkeit auf den maximalen Wert von 45
-    if (brightness > 45) brightness = 45;
-
-    // Kopiere den LED-Index in das modifizierte Datenarray
-    LED_Mod[0] = LED_Data[0];
-    for (int j = 1; j < 4; j++)
-    {
-        // Berechne den Winkel basierend auf der Helligkeit (in Grad)
-        float angle = 90 - brightness;
-        angle = angle * PI / 180;  // Konvertiere den Winkel in Radiant
+    // Begrenze die Helligkeit auf den Bereich 0 bis 45
+    if (brightness > WS2812_BRIGHTNESS_MAX) brightness = WS2812_BRIGHTNESS_MAX;
+    if (brightness < 0) brightness = 0;
 
-        // Skaliere die RGB-Werte basierend auf dem berechneten Winkel
-        LED_Mod[j] = (LED_Data[j]) / (tan(angle));
+    uint16_t scale = (uint16_t)((brightness * 256 + WS2812_BRIGHTNESS_MAX / 2) / WS2812_BRIGHTNESS_MAX);
+    if (scale != WS2812_Scale) {
+        WS2812_Scale = scale;
+        WS2812_Changed = 1;
     }
 
 #endif
@@ -120,93 +185,184 @@ void WS2812_SetBrightness (int brightness)  // 0-45
 }
 
 /**
- * @brief Sendet die aktuell gesetzten Farbdaten an die WS2812-RGB-LED
+ * @brief Berechnet die Pulsbreiten aus dem ARR von htim1 und füllt die Bit-Tabelle
  *
- * Diese Funktion konvertiert die RGB-Farbdaten in das für WS2812-LEDs erforderliche
- * PWM-Signal-Format und sendet sie über DMA und Timer an die LED.
+ * Wird am Ende von MX_TIM1_Init() aufgerufen, also beim Start und nach jedem Wechsel des
+ * Taktprofils. Die Tabelle enthält für jeden Bytewert die 8 Vergleichswerte, das Kodieren
+ * einer Farbe ist damit nur noch ein Kopieren von 16 Byte:
+ * - Logische '1': 2/3 der Periode
+ * - Logische '0': 1/3 der Periode
+ */
+void WS2812_Init(void)
+{
+	//Lese das AutoReload Register aus
+	uint32_t period = htim1.Init.Period + 1;
+
+	WS2812_PulseHigh = (uint16_t)(period * 2 / 3);
+	WS2812_PulseLow = (uint16_t)(period / 3);
+
+	for (uint32_t value = 0; value < 256; value++) {
+		for (int bit = 0; bit < 8; bit++)
+			WS2812_BitLut[value][bit] = (value & (0x80 >> bit)) ? WS2812_PulseHigh : WS2812_PulseLow;
+	}
+}
+
+/**
+ * @brief Startet die Übertragung aller LEDs des Streifens, ohne zu blockieren
  *
  * Die Funktion führt folgende Schritte aus:
- * 1. Liest den aktuellen Timer-Periode-Wert (ARR) aus
- * 2. Kombiniert die RGB-Farbkomponenten (mit oder ohne Helligkeitsanpassung) in einen 32-Bit-Farbwert
- * 3. Konvertiert jeden der 24 Farbbit-Werte in entsprechende PWM-Pulsbreiten:
- *    - Logische '1': 2/3 der Periode
- *    - Logische '0': 1/3 der Periode
- * 4. Fügt eine Reset-Sequenz (50 Nullwerte) am Ende hinzu
- * 5. Sendet die Daten per DMA an den Timer-Kanal
- * 6. Wartet auf das Abschluss-Flag bevor die Funktion zurückkehrt
- *
- * @note Die Funktion verwendet die globalen Variablen LED_Data oder LED_Mod (je nach USE_BRIGHTNESS)
- * @note Das Senden erfolgt blockierend, die Funktion kehrt erst zurück, wenn der DMA-Transfer
- *       abgeschlossen ist (signalisiert durch datasentflag)
- *
- * @see WS2812_SetLED() zum Setzen der Farbwerte
+ * 1. Kodiert die ersten beiden LEDs in die zwei Hälften des DMA-Puffers
+ * 2. Startet den zirkulären DMA-Transfer zum Timer-Kanal
+ *
+ * Alle weiteren LEDs und die Reset-Pause kodieren die DMA-Callbacks.
+ *
+ * @retval 1, wenn der Frame gestartet wurde, 0 wenn noch einer läuft oder WS2812_Init() fehlt
+ *
+ * @see WS2812_SetPixel() zum Setzen der Farbwerte
  * @see WS2812_SetBrightness() zum Einstellen der Helligkeit
- * @see HAL_TIM_PWM_PulseFinishedCallback() wird aufgerufen, wenn die Übertragung abgeschlossen ist
+ * @see WS2812_IsBusy() zum Abfragen, ob der Frame fertig ist
  */
-void WS2812_Send (void)
+RAMFUNC uint8_t WS2812_Send (void)
 {
-	//Lese das AutoReload Register aus
-	ARR_TIM1 = htim1.Init.Period;
+	if (WS2812_Busy)
+		return 0;
 
-	// Falls aus irgendein Grund das Register nicht gesetzt ist
-	if (ARR_TIM1 == 0) {
+	// Falls aus irgendein Grund die Pulsbreiten nicht berechnet sind
+	if (WS2812_PulseHigh == 0) {
 		printf("ARR has not been initialized");
-		return;
+		return 0;
 	}
 
-	uint32_t indx = 0;  // Index für das PWM-Datenarray
-	uint32_t color;     // Variable für den kombinierten Farbwert
+	WS2812_SlotsDone = 0;
+	WS2812_FillSlot(0, &WS2812_DmaBuffer[0]);
+	WS2812_FillSlot(1, &WS2812_DmaBuffer[24]);
 
-	// RGB-Daten mit oder ohne Helligkeitsanpassung kombinieren
-#if USE_BRIGHTNESS
-	color = ((LED_Mod[1] << 16) | (LED_Mod[2] << 8) | (LED_Mod[3]));
-#else
-	color = ((LED_Data[1] << 16) | (LED_Data[2] << 8) | (LED_Data[3]));
-#endif
+	WS2812_Busy = 1;
+	WS2812_LastFrameTick = HAL_GetTick();
+
+	// Starte den zirkulären DMA-Transfer für den Timer-Kanal
+	if (HAL_TIM_PWM_Start_DMA(&htim1, TIM_CHANNEL_1, (uint32_t*)WS2812_DmaBuffer, 2 * 24) != HAL_OK) {
+		WS2812_Busy = 0;
+		return 0;
+	}
 
-	// Konvertiere die 24 Farb-Bits in PWM-Daten
-	for (int i = 23; i >= 0; i--) {
-		if (color & (1 << i)) {
-			// Logische '1': 2/3 der Periode
-			pwmData[indx] = (uint16_t)((2.0 / 3.0) * (float)(ARR_TIM1 + 1));
-		} else {
-			// Logische '0': 1/3 der Periode
-			pwmData[indx] = (uint16_t)((1.0 / 3.0) * (float)(ARR_TIM1 + 1));
-		}
-		indx++;
+	return 1;
+}
+
+/**
+ * @brief Sendet die Farben, wenn sie sich geändert haben und der Frame-Abstand erreicht ist
+ *
+ * Kehrt immer sofort zurück. Ein Frame startet nur, wenn
+ * - sich seit dem letzten Frame eine Farbe oder die Helligkeit geändert hat,
+ * - der vorige Frame samt Reset-Pause fertig ist (die Pause erzeugt der Timer selbst,
+ *   als Nullen am Ende des DMA-Streams) und
+ * - seit dem Start des vorigen Frames mindestens die Frame-Periode vergangen ist.
+ * Sonst bleibt die Änderung vorgemerkt und geht mit einem späteren Aufruf hinaus. Für
+ * gleichmäßige Animationen regelmäßig (öfter als die Frame-Rate) aufrufen.
+ *
+ * @retval 1, wenn ein Frame gestartet wurde
+ */
+uint8_t WS2812_Show(void)
+{
+	uint32_t now = HAL_GetTick();
+
+	if (!WS2812_Changed || WS2812_Busy || now - WS2812_LastFrameTick < WS2812_FramePeriodMs)
+		return 0;
+
+	// Cleared first: a change during encoding is sent with the next frame
+	WS2812_Changed = 0;
+	if (!WS2812_Send()) {
+		WS2812_Changed = 1;
+		return 0;
 	}
 
-	// Füge eine Reset-Sequenz (50 Nullwerte) hinzu
-	for (int i = 0; i < 50; i++) {
-		pwmData[indx] = 0;
-		indx++;
+	return 1;
+}
+
+/**
+ * @brief Stellt die höchste Frame-Rate für WS2812_Show() ein
+ *
+ * @param fps Frames pro Sekunde, 0 = ohne Begrenzung
+ */
+void WS2812_SetFrameRate(uint32_t fps)
+{
+	WS2812_FramePeriodMs = fps ? 1000 / fps : 0;
+}
+
+/**
+ * @brief Gibt an, ob gerade ein Frame gesendet wird
+ */
+uint8_t WS2812_IsBusy(void)
+{
+	return WS2812_Busy;
+}
+
+/**
+ * @brief Kodiert eine LED bzw. eine Reset-Hälfte in eine Hälfte des DMA-Puffers
+ *
+ * @param slot Nummer im Frame: 0 bis MAX_LED-1 sind LEDs, danach folgen Nullen
+ * @param half Zeiger auf 24 Pulsbreiten
+ */
+RAMFUNC static void WS2812_FillSlot(uint32_t slot, uint16_t *half)
+{
+	if (slot >= MAX_LED) {
+		for (int i = 0; i < 24; i++)
+			half[i] = 0;
+		return;
 	}
 
-	uint32_t* address = (uint32_t*)pwmData;  // Adresse des PWM-Datenarrays
+	for (int c = 0; c < 3; c++) {
+#if USE_BRIGHTNESS
+		uint32_t value = (WS2812_Pixels[slot][c] * WS2812_Scale) >> 8;
+#else
+		uint32_t value = WS2812_Pixels[slot][c];
+#endif
+#if WS2812_USE_GAMMA
+		value = WS2812_Gamma[value];
+#endif
+		memcpy(half, WS2812_BitLut[value], sizeof(WS2812_BitLut[0]));
+		half += 8;
+	}
+}
 
-	HAL_Delay(1);  // Kurze Verzögerung
+/**
+ * @brief Eine Hälfte des DMA-Puffers ist ausgegeben: nächste LED hineinschreiben bzw. Frame beenden
+ *
+ * @param half Die gerade fertig übertragene Hälfte
+ */
+RAMFUNC static void WS2812_SlotDone(uint16_t *half)
+{
+	WS2812_SlotsDone++;
 
-	// Starte den DMA-Transfer für den Timer-Kanal
-	if (HAL_TIM_PWM_Start_DMA(&htim1, TIM_CHANNEL_1, address, 74) != HAL_OK) {
-		Error_Handler();  // Fehlerbehandlung bei fehlgeschlagenem DMA-Start
+	// The last reset half has been loaded: the line is low, stop the stream
+	if (WS2812_SlotsDone >= WS2812_TOTAL_SLOTS) {
+		HAL_TIM_PWM_Stop_DMA(&htim1, TIM_CHANNEL_1);
+		WS2812_Busy = 0;
+		return;
 	}
 
-	// Warte, bis die Datenübertragung abgeschlossen ist
-	while (!datasentflag) {};
-	datasentflag = 0;  // Rücksetzen des Flags
+	// This half is output again after the other one, i.e. it carries slot done + 1
+	WS2812_FillSlot(WS2812_SlotsDone + 1, half);
+}
+
+/**
+ * @brief Callback für den Half-Transfer-Interrupt: erste Hälfte neu füllen
+ */
+RAMFUNC void HAL_TIM_PWM_PulseFinishedHalfCpltCallback(TIM_HandleTypeDef *htim){
+    if (htim->Instance == TIM1)
+        WS2812_SlotDone(&WS2812_DmaBuffer[0]);
 }
 
 /**
- * @brief Callback-Funktion, die aufgerufen wird, wenn ein PWM-Puls abgeschlossen ist
+ * @brief Callback für den Transfer-Complete-Interrupt: zweite Hälfte neu füllen
  *
- * Diese Funktion wird vom HAL-Timer-System automatisch aufgerufen, nachdem
- * ein PWM-Übertragungszyklus via DMA abgeschlossen wurde. Sie stoppt den
- * DMA-Transfer für den Timer-Kanal und setzt das Flag, welches anzeigt,
- * dass die Datenübertragung abgeschlossen ist.
+ * Wird vom HAL-Timer-System automatisch aufgerufen, nachdem die zweite Hälfte des
+ * zirkulären Puffers übertragen wurde. Nach dem letzten Reset-Abschnitt wird der
+ * DMA-Transfer für den Timer-Kanal gestoppt.
  *
  * @param htim Zeiger auf die Timer-Handle-Struktur
  */
-void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim){
-    HAL_TIM_PWM_Stop_DMA(&htim1, TIM_CHANNEL_1);  // Stoppt die DMA-Übertragung für Timer1 Kanal1
-    datasentflag = 1;  // Setzt das Flag, das die Fertigstellung der Datenübertragung anzeigt
+RAMFUNC void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim){
+    if (htim->Instance == TIM1)
+        WS2812_SlotDone(&WS2812_DmaBuffer[24]);
 }
@@ -0,0 +1,292 @@
+/**
+ * @file    WarmBoot.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Warmstart: Ergebnisse langsamer Initialisierungen im SRD-SRAM über einen Reset retten
+ *
+ * Nach jedem Reset wiederholt main() bisher alles: Reset und Init-Sequenz des Displays, Kalibrierung
+ * beider ADCs, Prüfung des OCTOSPI-Timings, Identifikation und Bus-Tuning der SD-Karte samt
+ * Bandbreitenmessung, Logos. Das SRD-SRAM (BACKUP_DATA) verliert seinen Inhalt aber nur beim
+ * Abschalten. Jede dieser Initialisierungen legt ihr Ergebnis deshalb hier als Eintrag mit eigener
+ * CRC-32 ab (WarmBoot_Save()) und fragt es beim nächsten Start ab (WarmBoot_Load()).
+ *
+ * Übernommen wird nur nach einem Software-Reset (NVIC_SystemReset(), Update, WarmBoot_Fault()) oder
+ * einem Watchdog-Reset: dann laufen Display und SD-Karte mit ihrem Zustand weiter, und die SRAMs
+ * sind intakt. Nach dem Einschalten, einem Brown-out und dem Reset-Taster wird der Block nur
+ * beschrieben, nie gelesen; ungeschriebene Zeilen könnten einen ECC-Fehler melden. Jeder Nutzer
+ * prüft das übernommene Ergebnis kurz gegen die Hardware (ein Sektor, ein Lesevorgang) und fällt
+ * sonst auf den vollen Weg zurück.
+ *
+ * WarmBoot_Fault() macht aus einem HardFault oder Error_Handler() einen Software-Reset, statt für
+ * immer zu hängen; mit angeschlossenem Debugger bleibt der Kern zum Untersuchen stehen. Folgen
+ * WARMBOOT_FAULT_LIMIT Fehler-Resets aufeinander, ohne dass der Start fertig wurde
+ * (WarmBoot_Confirm() aus Boot.c), startet der nächste kalt, und eine weitere Folge bleibt stehen.
+ * Die Einträge könnten selbst die Ursache sein.
+ *
+ * 'boot' in der Shell zeigt Ursache, übernommene Einträge und den Fehler vor dem Reset.
+ */
+
+#include "WarmBoot.h"
+
+#if WARMBOOT_ENABLE
+
+#include "Cache.h"
+#include "Crc32.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Aufeinanderfolgende Fehler-Resets, ab denen ohne gerettete Einträge gestartet wird */
+#define WARMBOOT_FAULT_LIMIT      3
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t itemSize;
+	uint32_t check;                // ~magic, gegen zufällig passende Worte
+	uint32_t warmBoots;
+	uint32_t faultResets;          // Fehler-Resets seit dem letzten vollständigen Start
+	uint32_t fault;                // von WarmBoot_Fault() vor dem Reset
+	uint32_t faultCfsr;
+	uint32_t faultHfsr;
+	uint32_t faultAddress;
+} WarmBoot_Header;
+
+typedef struct {
+	uint16_t size;                 // 0 = leer
+	uint16_t reserved;
+	uint32_t crc;
+	uint8_t data[WARMBOOT_ITEM_SIZE];
+} WarmBoot_Slot;
+
+typedef struct {
+	WarmBoot_Header header;
+	WarmBoot_Slot slots[WARMBOOT_ITEM_COUNT];
+} WarmBoot_Block;
+
+/**
+ * @brief Kalibrierung eines ADC (WARMBOOT_ITEM_ADC1/2)
+ */
+typedef struct {
+	uint32_t offset;
+	uint32_t linear[ADC_LINEAR_CALIB_REG_COUNT];
+} WarmBoot_AdcCalibration;
+
+static WarmBoot_Block WarmBoot_Retained BACKUP_DATA;
+static WarmBoot_Stats WarmBoot_Statistics;
+static uint8_t WarmBoot_Ready = 0;
+
+static const char *const WarmBoot_ItemNames[WARMBOOT_ITEM_COUNT] = { "adc1", "adc2", "ospi", "sd", "ui" };
+static const char *const WarmBoot_CauseNames[] = { "Einschalten", "Reset-Pin", "Software", "Watchdog", "andere" };
+
+static WarmBoot_Cause WarmBoot_Decode(uint32_t rsr);
+
+/**
+ * @brief  Reset-Ursache lesen und den geretteten Block prüfen bzw. neu anlegen
+ *
+ * Nach Serial_Init() (Ausgabe) und DmaAlloc (CRC-Einheit), vor dem ersten Nutzer aufrufen.
+ */
+void WarmBoot_Init(void) {
+	WarmBoot_Header *header = &WarmBoot_Retained.header;
+	WarmBoot_Stats *s = &WarmBoot_Statistics;
+	uint32_t rsr = RCC->RSR;
+
+	SET_BIT(RCC->RSR, RCC_RSR_RMVF);
+	memset(s, 0, sizeof(*s));
+	s->rsr = rsr;
+	s->cause = WarmBoot_Decode(rsr);
+
+	uint8_t intact = (s->cause == WARMBOOT_CAUSE_SOFTWARE || s->cause == WARMBOOT_CAUSE_WATCHDOG)
+			&& header->magic == WARMBOOT_MAGIC && header->check == (uint32_t)~WARMBOOT_MAGIC
+			&& header->version == WARMBOOT_VERSION && header->itemSize == WARMBOOT_ITEM_SIZE;
+
+	if (!intact) {
+		// Written as whole words, so every line of the ECC-protected SRAM is valid from here on
+		memset(&WarmBoot_Retained, 0, sizeof(WarmBoot_Retained));
+		header->magic = WARMBOOT_MAGIC;
+		header->check = (uint32_t)~WARMBOOT_MAGIC;
+		header->version = WARMBOOT_VERSION;
+		header->itemSize = WARMBOOT_ITEM_SIZE;
+		WarmBoot_Ready = 1;
+		return;
+	}
+
+	s->fault = header->fault;
+	s->faultCfsr = header->faultCfsr;
+	s->faultHfsr = header->faultHfsr;
+	s->faultAddress = header->faultAddress;
+	header->fault = 0;
+
+	if (header->faultResets >= WARMBOOT_FAULT_LIMIT) {
+		// Repeated faults right after start: the retained results may be the cause
+		for (uint8_t i = 0; i < WARMBOOT_ITEM_COUNT; i++) {
+			WarmBoot_Retained.slots[i].size = 0;
+		}
+	} else {
+		s->warm = 1;
+		header->warmBoots++;
+	}
+	s->warmBoots = header->warmBoots;
+	WarmBoot_Ready = 1;
+}
+
+/**
+ * @brief  Gerettete Einträge dürfen benutzt werden (Software- oder Watchdog-Reset, Block gültig)
+ */
+uint8_t WarmBoot_IsWarm(void) {
+	return WarmBoot_Statistics.warm;
+}
+
+/**
+ * @brief  Kopiert einen geretteten Eintrag, nur nach einem Warmstart
+ * @param  size: erwartete Größe, ein Eintrag anderer Größe gilt als ungültig
+ * @retval 1 mit gültigem Eintrag in data, 0 wenn der Aufrufer den vollen Weg gehen muss
+ */
+uint8_t WarmBoot_Load(WarmBoot_Item item, void *data, uint16_t size) {
+	WarmBoot_Stats *s = &WarmBoot_Statistics;
+
+	if (!s->warm || item >= WARMBOOT_ITEM_COUNT)
+		return 0;
+
+	const WarmBoot_Slot *slot = &WarmBoot_Retained.slots[item];
+	if (slot->size != size || size > WARMBOOT_ITEM_SIZE || Crc32_Compute(slot->data, size) != slot->crc) {
+		s->missing |= 1UL << item;
+		return 0;
+	}
+	memcpy(data, slot->data, size);
+	s->restored |= 1UL << item;
+	return 1;
+}
+
+/**
+ * @brief  Legt das Ergebnis einer Initialisierung für den nächsten Warmstart ab
+ *
+ * Aus Task-Kontext oder main() (CRC-Einheit), nicht aus einem Interrupt.
+ * @retval 1 bei Erfolg, 0 wenn size größer als WARMBOOT_ITEM_SIZE ist
+ */
+uint8_t WarmBoot_Save(WarmBoot_Item item, const void *data, uint16_t size) {
+	if (!WarmBoot_Ready || item >= WARMBOOT_ITEM_COUNT || size == 0 || size > WARMBOOT_ITEM_SIZE)
+		return 0;
+
+	// Invalid while it is written, a reset in between leaves no half entry behind
+	WarmBoot_Slot *slot = &WarmBoot_Retained.slots[item];
+	slot->size = 0;
+	memcpy(slot->data, data, size);
+	slot->crc = Crc32_Compute(slot->data, size);
+	slot->size = size;
+	WarmBoot_Statistics.saves++;
+	return 1;
+}
+
+/**
+ * @brief  Verwirft einen Eintrag, z.B. wenn er die Prüfung gegen die Hardware nicht bestanden hat
+ */
+void WarmBoot_Invalidate(WarmBoot_Item item) {
+	if (!WarmBoot_Ready || item >= WARMBOOT_ITEM_COUNT)
+		return;
+	WarmBoot_Retained.slots[item].size = 0;
+	WarmBoot_Statistics.restored &= ~(1UL << item);
+	WarmBoot_Statistics.missing |= 1UL << item;
+}
+
+/**
+ * @brief  Kalibriert einen ADC oder stellt nach einem Warmstart die gerettete Kalibrierung ein
+ *
+ * Ersetzt HAL_ADCEx_Calibration_Start(ADC_CALIB_OFFSET_LINEARITY, ADC_SINGLE_ENDED); der ADC ist
+ * danach wie dort abgeschaltet. Die Linearitätskalibrierung ist der langsame Teil, die Faktoren
+ * gelten, solange VDDA und Temperatur sich nicht wesentlich ändern.
+ * @param  item: WARMBOOT_ITEM_ADC1 oder WARMBOOT_ITEM_ADC2
+ * @retval 1 bei Erfolg, 0 bei einem Fehler der HAL
+ */
+uint8_t WarmBoot_CalibrateAdc(ADC_HandleTypeDef *hadc, WarmBoot_Item item) {
+	WarmBoot_AdcCalibration calibration;
+
+	if (WarmBoot_Load(item, &calibration, sizeof(calibration))) {
+		// The linear factors are written with ADEN set, the offset factor as well
+		if (HAL_ADCEx_LinearCalibration_SetValue(hadc, calibration.linear) == HAL_OK && ADC_Enable(hadc) == HAL_OK) {
+			LL_ADC_SetCalibrationOffsetFactor(hadc->Instance, LL_ADC_SINGLE_ENDED, calibration.offset);
+			if (ADC_Disable(hadc) == HAL_OK)
+				return 1;
+		}
+		WarmBoot_Invalidate(item);
+	}
+
+	if (HAL_ADCEx_Calibration_Start(hadc, ADC_CALIB_OFFSET_LINEARITY, ADC_SINGLE_ENDED) != HAL_OK)
+		return 0;
+	calibration.offset = HAL_ADCEx_Calibration_GetValue(hadc, ADC_SINGLE_ENDED);
+	if (HAL_ADCEx_LinearCalibration_GetValue(hadc, calibration.linear) == HAL_OK)
+		WarmBoot_Save(item, &calibration, sizeof(calibration));
+	// Reading the linear factors enables the ADC, leave it as the calibration did
+	return ADC_Disable(hadc) == HAL_OK;
+}
+
+/**
+ * @brief  Fehler festhalten und mit einem Software-Reset neu starten (HardFault_Handler(), Error_Handler())
+ *
+ * Kehrt nur mit angeschlossenem Debugger, vor WarmBoot_Init() oder nach zu vielen Fehler-Resets
+ * in Folge zurück; der Aufrufer bleibt dann in seiner Schleife stehen.
+ */
+void WarmBoot_Fault(uint32_t reason) {
+	WarmBoot_Header *header = &WarmBoot_Retained.header;
+
+	if ((CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) || !WarmBoot_Ready
+			|| header->faultResets >= 2U * WARMBOOT_FAULT_LIMIT)
+		return;
+
+	uint32_t cfsr = SCB->CFSR;
+	header->fault = reason;
+	header->faultCfsr = cfsr;
+	header->faultHfsr = SCB->HFSR;
+	header->faultAddress = (cfsr & SCB_CFSR_BFARVALID_Msk) ? SCB->BFAR : (cfsr & SCB_CFSR_MMARVALID_Msk) ? SCB->MMFAR : 0;
+	header->faultResets++;
+	__DSB();
+	NVIC_SystemReset();
+}
+
+/**
+ * @brief  Der Start ist vollständig durchgelaufen: die Folge der Fehler-Resets endet hier
+ */
+void WarmBoot_Confirm(void) {
+	if (WarmBoot_Ready)
+		WarmBoot_Retained.header.faultResets = 0;
+}
+
+const WarmBoot_Stats* WarmBoot_GetStats(void) {
+	return &WarmBoot_Statistics;
+}
+
+/**
+ * @brief  Gibt Reset-Ursache, Einträge und den Fehler vor dem Reset aus ('boot' in der Shell)
+ */
+void WarmBoot_Dump(void) {
+	const WarmBoot_Stats *s = &WarmBoot_Statistics;
+
+	printf("Reset: %s (RSR 0x%08lX), %s, %lu Warmstarts in Folge\n", WarmBoot_CauseNames[s->cause], s->rsr,
+			s->warm ? "Warmstart" : "Kaltstart", s->warmBoots);
+	if (s->fault != 0) {
+		printf("  vor dem Reset: %s, CFSR 0x%08lX, HFSR 0x%08lX, Adresse 0x%08lX\n",
+				s->fault == WARMBOOT_FAULT_HARD ? "HardFault" : "Error_Handler", s->faultCfsr, s->faultHfsr, s->faultAddress);
+	}
+	printf("  Eintrag  übernommen  gespeichert\n");
+	for (uint8_t i = 0; i < WARMBOOT_ITEM_COUNT; i++) {
+		const WarmBoot_Slot *slot = &WarmBoot_Retained.slots[i];
+		printf("  %-8s %-11s %u Bytes\n", WarmBoot_ItemNames[i],
+				(s->restored & (1UL << i)) ? "ja" : (s->missing & (1UL << i)) ? "ungültig" : "-", slot->size);
+	}
+}
+
+/**
+ * @brief  Ursache aus RCC_RSR; ein Software-Reset setzt auch PINRSTF, Einschalten auch BORRSTF
+ */
+static WarmBoot_Cause WarmBoot_Decode(uint32_t rsr) {
+	if (rsr & (RCC_RSR_PORRSTF | RCC_RSR_BORRSTF))
+		return WARMBOOT_CAUSE_POWER;
+	if (rsr & (RCC_RSR_IWDG1RSTF | RCC_RSR_WWDG1RSTF))
+		return WARMBOOT_CAUSE_WATCHDOG;
+	if (rsr & RCC_RSR_SFTRSTF)
+		return WARMBOOT_CAUSE_SOFTWARE;
+	if (rsr & RCC_RSR_PINRSTF)
+		return WARMBOOT_CAUSE_PIN;
+	return WARMBOOT_CAUSE_OTHER;
+}
+
+#endif /* WARMBOOT_ENABLE */
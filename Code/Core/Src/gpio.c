@@ -53,8 +53,11 @@ void MX_GPIO_Init(void)
   __HAL_RCC_GPIOD_CLK_ENABLE();
 
   /*Configure GPIO pin Output Level */
-  HAL_GPIO_WritePin(GPIOD, DISPLAY_CS_Pin|DISPLAY_RESET_Pin|DISPLAY_DC_Pin|LED_GREEN_Pin
-                          |LED_YELLOW_Pin|LED_RED_Pin, GPIO_PIN_RESET);
+  HAL_GPIO_WritePin(GPIOD, DISPLAY_CS_Pin|DISPLAY_DC_Pin|LED_GREEN_Pin|LED_YELLOW_Pin
+                          |LED_RED_Pin, GPIO_PIN_RESET);
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(DISPLAY_RESET_GPIO_Port, DISPLAY_RESET_Pin, GPIO_PIN_SET);
 
   /*Configure GPIO pin Output Level */
   HAL_GPIO_WritePin(LEDM_CS_GPIO_Port, LEDM_CS_Pin, GPIO_PIN_SET);
@@ -86,11 +89,11 @@ void MX_GPIO_Init(void)
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
 
-  /*Configure GPIO pin : MDS_BUTTON_Pin */
-  GPIO_InitStruct.Pin = MDS_BUTTON_Pin;
+  /*Configure GPIO pins : DISPLAY_TE_Pin MDS_BUTTON_Pin */
+  GPIO_InitStruct.Pin = DISPLAY_TE_Pin|MDS_BUTTON_Pin;
   GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
   GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-  HAL_GPIO_Init(MDS_BUTTON_GPIO_Port, &GPIO_InitStruct);
+  HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
 
   /*Configure GPIO pin : MDS_RIGHT_Pin */
   GPIO_InitStruct.Pin = MDS_RIGHT_Pin;
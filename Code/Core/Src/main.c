@@ -34,22 +34,94 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include <stdio.h>
+#include <string.h>
 
 #include "WS2812.h"
 #include "AHT20.h"
+#include "Fmt.h"
 #include "ILI9341.h"
+#include "ILI9341_Widget.h"
+#include "ILI9341_Chart.h"
+#include "Arena.h"
+#include "ILI9341_TE.h"
+#include "ILI9341_Screenshot.h"
+#include "ILI9341_Power.h"
+#include "Anim.h"
 #include "LED.h"
 #include "LED_Matrix.h"
 #include "Realtime.h"
 #include "UserInput.h"
 #include "SSD1306.h"
+#include "Canvas.h"
+#include "SDCard.h"
+#include "SDQueue.h"
+#include "Clock.h"
+#include "Prof.h"
+#include "Scheduler.h"
+#include "Timer.h"
+#include "Timebase.h"
+#include "Trace.h"
+#include "Stack.h"
+#include "InputLatency.h"
+#include "Governor.h"
+#include "LowPower.h"
+#include "Thermal.h"
+#include "I2CBus.h"
+#include "Effects.h"
+#include "Dsp.h"
+#include "Serial.h"
+#include "Log.h"
+#include "Shell.h"
+#include "EspLink.h"
+#include "Gamepad.h"
+#include "UsbCdc.h"
+#include "Mirror.h"
+#include "Telemetry.h"
+#include "Can.h"
+#include "CanTp.h"
+#include "Boot.h"
+#include "WarmBoot.h"
+#include "Splash.h"
+#include "W25Qxx_QSPI.h"
+#include "FlashKV.h"
+#include "FlashPool.h"
+#include "AssetCache.h"
+#include "Pipe.h"
+#include "DmaAlloc.h"
+#include "Irq.h"
+#include "BusQos.h"
+#include "Topic.h"
+#include "SensorLog.h"
 #include "Fonts/ssd1306_fonts.h"
+#ifdef BENCH_DISPLAY
+#include "DisplayBench.h"
+#endif
+#ifdef BENCH_STORAGE
+#include "StorageBench.h"
+#endif
+#ifdef BENCH_MEM
+#include "MemBench.h"
+#endif
+#ifdef BENCH_JITTER
+#include "JitterBench.h"
+#endif
+#ifdef BENCH_BUS
+#include "BusBench.h"
+#endif
+#if defined(BENCH_DISPLAY) || defined(BENCH_STORAGE) || defined(BENCH_MEM) || defined(BENCH_JITTER) || defined(BENCH_BUS)
+#include "Bench.h"
+#endif
 
 
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
+// Bedienzustand, der einen Warmstart übersteht (WARMBOOT_ITEM_UI)
+typedef struct {
+  uint8_t mode;                                  // Effects_Mode
+  char text[ILI9341_WIDGET_TEXT_MAX + 1];        // Statuszeile
+} Ui_State;
 
 /* USER CODE END PTD */
 
@@ -66,14 +138,64 @@
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-static uint32_t lastUpdateTime = 0;
+// DMA-Handles aus dem MSP-Code von CubeMX, für die Belegungstabelle
+extern DMA_HandleTypeDef hdma_adc1;
+extern DMA_HandleTypeDef hdma_i2c1_tx;
+extern DMA_HandleTypeDef hdma_spi1_tx;
+extern DMA_HandleTypeDef hdma_spi4_tx;
+extern DMA_HandleTypeDef hdma_tim1_ch1;
+extern DMA_HandleTypeDef hdma_lpuart1_rx;
+extern DMA_HandleTypeDef hdma_lpuart1_tx;
+extern DMA_HandleTypeDef hdma_uart7_tx;
+extern MDMA_HandleTypeDef hmdma_octospi1_fifo_th;
+
+// Statusleiste oben: zuletzt erkannte Eingabe
+static ILI9341_Widget Ui_Status;
+static ILI9341_Chart Ui_PotiChart;
+static uint8_t Task_CanTpId = SCHEDULER_INVALID_TASK;
+
+// Software-Timer im Timer-Rad, die Callbacks laufen im Task "Timer"
+static Timer Heartbeat_Timer;
+static Timer Sensor_Timer;
+
+// Herz für LED-Matrix und SSD1306, eine Zeile je Byte (Bit 7 links)
+static const uint8_t Ui_Heart[8] = {
+  0b01100110,
+  0b11111111,
+  0b11111111,
+  0b11111111,
+  0b11111111,
+  0b01111110,
+  0b00111100,
+  0b00011000
+};
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MPU_Config(void);
 /* USER CODE BEGIN PFP */
-#define PUTCHAR_PROTOTYPE int __io_putchar(int ch)
+static void Task_UserInput(void *context);
+static void Task_LED(void *context);
+static void Task_SDQueue(void *context);
+static void Task_AHT20(void *context);
+static void Tick_Sensor(void *context);
+static void Tick_Heartbeat(void *context);
+static void Task_DSP(void *context);
+static void Task_Flash(void *context);
+static uint8_t Window_IsBusy(void);
+static void Task_UI(void *context);
+static void Ui_SaveState(void);
+static void ShowSensorValues(int16_t centiCelsius, uint16_t centiPercent);
+static uint8_t Stage_Adc(void);
+static uint8_t Stage_Dsp(void);
+static uint8_t Stage_Can(void);
+static uint8_t Stage_Oled(void);
+static void Ui_DrawHeart(Canvas *canvas, int16_t x, int16_t y, uint8_t scale, Canvas_Color colour);
+static uint8_t Stage_Matrix(void);
+static uint8_t Stage_Sd(void);
+static uint8_t Stage_RamDisk(void);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -89,16 +211,25 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
+  // Stack bemalen, bevor irgendetwas anderes ihn benutzt hat (Hochwassermarke, Shell 'stack')
+  Stack_Paint();
 
-
-  uint8_t rx_data;
-  HAL_I2C_Mem_Read(&hi2c1, 0xA1, 0x02, 1, &rx_data, 1, 100); // Lese von Register 0x02
+  // Zeitstempel des Starts ab hier (Boot_Report() nach der letzten verschobenen Initialisierung)
+  Boot_Init();
 
   /* USER CODE END 1 */
 
   /* MPU Configuration--------------------------------------------------------*/
   MPU_Config();
 
+  /* Enable the CPU Cache */
+
+  /* Enable I-Cache---------------------------------------------------------*/
+  SCB_EnableICache();
+
+  /* Enable D-Cache---------------------------------------------------------*/
+  SCB_EnableDCache();
+
   /* MCU Configuration--------------------------------------------------------*/
 
   /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
@@ -112,6 +243,12 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  // Switch to the selected clock profile before any peripheral derives its dividers
+  if (!Clock_SetProfile(CLOCK_PROFILE))
+  {
+    Error_Handler();
+  }
+  Boot_MarkPhase("clock");
 
   /* USER CODE END SysInit */
 
@@ -132,71 +269,209 @@ int main(void)
   MX_TIM6_Init();
   MX_FATFS_Init();
   MX_TIM7_Init();
+  MX_TIM3_Init();
+  MX_UART4_Init();
   /* USER CODE BEGIN 2 */
+  Boot_MarkPhase("peripherals");
+
+  // Prioritätenplan aus Irq.h statt 0/0 aus dem MSP-Code, bevor der erste Transfer startet
+  Irq_Init();
+  // Vorrang am AXI-Interconnect: Display- und ADC-DMA vor CPU, MDMA und DMA2D, die SD-Karte zuletzt ('qos')
+  BusQos_Init();
+
+  // µs-Zeitbasis (TIM5) vor allem, was Zeitstempel nimmt: Eingaben, Sensor-Log, Telemetrie
+  Timebase_Init();
+
+  // Fest vergebene Streams eintragen, ihre Interrupts laufen ab hier über DmaAlloc.c
+  DmaAlloc_Register(&hdma_adc1, "ADC1");
+  DmaAlloc_Register(&hdma_uart7_tx, "UART7 TX");
+  DmaAlloc_Register(&hdma_spi4_tx, "SPI4 TX");
+  DmaAlloc_Register(&hdma_i2c1_tx, "I2C1 TX");
+  DmaAlloc_Register(&hdma_spi1_tx, "SPI1 TX");
+  DmaAlloc_Register(&hdma_tim1_ch1, "TIM1 CH1");
+  DmaAlloc_Register(&hdma_lpuart1_rx, "LPUART1 RX");
+  DmaAlloc_Register(&hdma_lpuart1_tx, "LPUART1 TX");
+  DmaAlloc_RegisterMdma(&hmdma_octospi1_fifo_th, "OCTOSPI1");
+#ifdef USE_DMA_SAMPLING
+  // Taster und Joystick per DMA mit USER_INPUT_SAMPLE_HZ abtasten statt einem EXTI-Interrupt je Preller
+  UserInput_StartSampling();
+#endif
 
-
-  LED_Matrix_setup();
-  LED_Matrix_reset();
-  uint8_t heart[8]={
-    0b01100110,
-    0b11111111,
-    0b11111111,
-    0b11111111,
-    0b11111111,
-    0b01111110,
-    0b00111100,
-    0b00011000
-  };
-
-  for (int i = 0; i < 8; i++){
-    LED_Matrix_draw_row(i,heart[i]);
-  }
-
-  LED_Matrix_set_intensity(2);
-
-
-
-  ssd1306_Init();
-
-  ssd1306_Fill(White);
-
-  ssd1306_SetCursor(25,0);
-  ssd1306_WriteString("Demo Programm", Font_6x8, BLACK);
-  ssd1306_UpdateScreen();
-
-
-
-  ILI9341_begin(&hspi1, DISPLAY_CS_GPIO_Port, DISPLAY_CS_Pin, DISPLAY_DC_GPIO_Port, DISPLAY_DC_Pin, DISPLAY_RESET_GPIO_Port, DISPLAY_RESET_Pin);
-
-  ILI9341_DisplayOn();
+  // printf ab hier über den Sendepuffer per DMA (921600 Baud an UART7)
+  Serial_Init(&Serial_Log, &huart7);
+  Serial_Init(&Serial_Shell, &hlpuart1);
+  Log_Init();
+  Prof_Init();
+  Trace_Init();
+  Boot_MarkPhase("serial");
+
+  // Reset-Ursache auswerten: nach Software- oder Watchdog-Reset gelten die im SRD-SRAM geretteten Ergebnisse
+  WarmBoot_Init();
+
+  // Display zuerst: bis zum ersten Bild läuft nichts anderes, alles Langsame folgt im Boot-Task.
+  // Warm übernimmt ILI9341_Attach() das wache Panel samt Bild, sonst Reset und Konfiguration,
+  // das Panel schläft dann bis ILI9341_EndInit()
+  uint8_t displayKept = WarmBoot_IsWarm()
+      && ILI9341_Attach(&hspi1, DISPLAY_CS_GPIO_Port, DISPLAY_CS_Pin, DISPLAY_DC_GPIO_Port, DISPLAY_DC_Pin, DISPLAY_RESET_GPIO_Port, DISPLAY_RESET_Pin);
+  if (!displayKept)
+    ILI9341_begin(&hspi1, DISPLAY_CS_GPIO_Port, DISPLAY_CS_Pin, DISPLAY_DC_GPIO_Port, DISPLAY_DC_Pin, DISPLAY_RESET_GPIO_Port, DISPLAY_RESET_Pin);
+  Boot_MarkPhase("display");
+
+  // TE-Puls zu Beginn jeder Austastlücke auf DISPLAY_TE, ohne Verbindung läuft alles frei weiter
+  ILI9341_TE_Enable(1);
 
   ILI9341_SetOrientation(TEST);
+  // Größe der gemeinsamen Zeichenfläche des TFT, OLED und Matrix haben feste Maße
+  Canvas_Init();
 
-  ILI9341_FillScreen(WHITE);
-
-  ILI9341_DrawText("DEMO PROGRAMM", 50, 50, BLACK, 3,WHITE);
+  if (!displayKept) {
+    ILI9341_FillScreen(WHITE);
 
+    ILI9341_DrawText("DEMO PROGRAMM", 50, 50, BLACK, 3,WHITE);
+  }
 
-  ILI9341_DrawBinaryFile("SiMi_Logo_TFT.bin", 30, 120, 100, 79);
-  ILI9341_DrawBinaryFile("TFO_TFT.bin", 180, 120, 100, 79);
-
-  // Herz auf SSD1306 zeichnen
-    ssd1306_SetCursor(80, 40);
-    for (int y = 0; y < 8; y++) {
-      for (int x = 0; x < 8; x++) {
-        if (heart[y] & (1 << (7 - x))) {
-          ssd1306_DrawPixel(80 + x*2, 40 + y*2, BLACK);
-          ssd1306_DrawPixel(80 + x*2 + 1, 40 + y*2, BLACK);
-          ssd1306_DrawPixel(80 + x*2, 40 + y*2 + 1, BLACK);
-          ssd1306_DrawPixel(80 + x*2 + 1, 40 + y*2 + 1, BLACK);
-        }
-      }
-    }
-    ssd1306_UpdateScreen();
+  // W25Qxx: Quad-Modus, Schlüssel/Wert-Speicher und das gespeicherte Timing des OCTOSPI vor dem ersten Asset.
+  // Fehlt es, misst MX_OCTOSPI1_TuneBus() neu; das Panel wartet ohnehin noch auf die 120 ms nach dem Reset
+  W25Qxx_begin();
+  FlashKV_Init();
+  MX_OCTOSPI1_TuneBus(0);
+  // DTR-Lesebefehle (0xED) nur, wenn der Chip sie meldet und der Selbsttest gegen SDR besteht
+  W25Qxx_EnableDtr(OCTOSPI1_TUNE_ADDRESS);
+  Boot_MarkPhase("flash");
+
+  // Logos per DMA direkt aus dem Memory-Mapped-Fenster des W25Qxx, fehlende holt Stage_Sd() von der SD-Karte.
+  // Beim übernommenen Panel stehen sie noch im Displayspeicher
+  if (displayKept)
+    Splash_Keep();
+  else
+    Splash_Show();
+  // Sleep Out und Display On erst jetzt: das Logo liegt schon im Displayspeicher, die 120 ms nach dem Reset sind meist vorbei
+  ILI9341_EndInit();
+  Boot_FirstPixel();
+
+  // Warteschlangen und Geschwindigkeit der I2C-Busse (SSD1306 an I2C1, AHT20 an I2C2)
+  I2CBus_Init(&I2CBus_1, &hi2c1, I2CBUS_1_HZ);
+  I2CBus_Init(&I2CBus_2, &hi2c2, I2CBUS_2_HZ);
+
+  // Statusleiste als Widget, Task_UI zeichnet sie nur bei geändertem Text
+  ILI9341_Widget_Init(&Ui_Status, ILI9341_WIDGET_LABEL, 0, 0, 320, 40);
+  ILI9341_Widget_SetStyle(&Ui_Status, BLACK, WHITE, DARKGREY, 3);
+  ILI9341_Widget_SetAlign(&Ui_Status, ILI9341_WIDGET_ALIGN_CENTER);
+  ILI9341_Widget_Add(&Ui_Status);
+
+  // Lichteffekt und Statuszeile wie vor dem Warmstart
+  Ui_State uiState;
+  if (WarmBoot_Load(WARMBOOT_ITEM_UI, &uiState, sizeof(uiState)) && uiState.mode < EFFECTS_COUNT) {
+    uiState.text[ILI9341_WIDGET_TEXT_MAX] = '\0';
+    Effects_SetMode((Effects_Mode)uiState.mode);
+    ILI9341_Widget_SetText(&Ui_Status, uiState.text);
+  }
 
+  // Verlauf von VR1 am unteren Rand: eine Spalte je 10 Werte (Task_LED bzw. ADC-Blöcke im Messbetrieb)
+  ILI9341_Chart_Init(&Ui_PotiChart, 0, 200, 320, 40, ILI9341_CHART_SWEEP);
+  ILI9341_Chart_SetStyle(&Ui_PotiChart, BLUE, WHITE, LIGHTGREY);
+  ILI9341_Chart_SetDecimation(&Ui_PotiChart, 10);
+  ILI9341_Chart_SetChannel(&Ui_PotiChart, 0);
+  ADC_AddBlockListener(ILI9341_Chart_AdcListener, &Ui_PotiChart);
+
+  // Periodische Aufgaben: Periode und Deadline in ms, Priorität 0 = höchste
+  Scheduler_Init();
+  // Läuft sofort bei jedem Eingabeereignis (TOPIC_INPUT), statt alle 10 ms die Warteschlange abzufragen
+  Topic_Subscribe(TOPIC_INPUT, Scheduler_AddTask("Input", Task_UserInput, NULL, USER_INPUT_TASK_MS, 10, 0));
+  // Läuft zusätzlich sofort, wenn ein Poti bewegt wurde (TOPIC_POTI)
+  Topic_Subscribe(TOPIC_POTI, Scheduler_AddTask("LED", Task_LED, NULL, EFFECTS_TICK_MS, 10, 1));
+  // Messung als Coroutine, I2C-Callbacks und Wartezeiten geben den Task frei (Shell 'async')
+  AHT20_Init(Scheduler_AddTask("AHT20", Task_AHT20, NULL, AHT20_TASK_MS, 10, 2));
+  Scheduler_AddTask("SDQueue", Task_SDQueue, NULL, 5, 10, 3);
+  // Callbacks der Software-Timer, freigegeben von Timer_Tick() beim Ablauf
+  Timer_Init(Scheduler_AddTask("Timer", Timer_Task, NULL, TIMER_TASK_MS, 10, 4));
+  Timer_Setup(&Sensor_Timer, "Sensor", Tick_Sensor, NULL);
+  Timer_Start(&Sensor_Timer, 1, 1000);
+  Timer_Setup(&Heartbeat_Timer, "Heartbeat", Tick_Heartbeat, NULL);
+  Timer_Start(&Heartbeat_Timer, 1000, 1000);
+  // Taktprofil nach Last; verpasste Deadlines von UI und DSP schalten sofort auf 280 MHz
+  Governor_Init();
+  // Chiptemperatur über ADC2 (vor ADC_Start() in Stage_Adc), bei Übertemperatur sinkt die Obergrenze des Governors
+  Thermal_Init();
+  // Leerlauf ab LOWPOWER_MIN_MS im Stop-Modus, RTC vom LSI weckt vor der nächsten Freigabe
+  LowPower_Init();
+  Governor_WatchTask(Scheduler_AddTask("DSP", Task_DSP, NULL, 10, 10, 5));
+  // UI an jeder zweiten TE-Flanke (ca. 40 Hz), der 20-ms-Takt bleibt als Rückfall ohne TE
+  ILI9341_TE_SetPacing(2, Governor_WatchTask(Scheduler_AddTask("UI", Task_UI, NULL, 20, 20, 10)));
+  // Messdatenstrom über LPUART1, eingeschaltet mit dem Shell-Befehl 'tele'
+  Telemetry_Init(Scheduler_AddTask("Telemetry", Telemetry_Task, NULL, 2, 10, 6));
+  // Kommandozeile auf LPUART1: Task läuft nur, wenn eine Zeile angekommen ist
+  Shell_Init(&hlpuart1, Scheduler_AddTask("Shell", Shell_Task, NULL, 1, 100, 7));
+  // Verbindung zum ESP-Einsatz auf UART7, übernimmt die UART erst nach dessen HELLO ('esp' in der Shell)
+  EspLink_Init();
+  // PS4-Controller über den Airlink auf UART4, Tasten und Stick als GAMEPAD_*-Eingaben ('pad' in der Shell)
+  Gamepad_Init();
+  // Zwei virtuelle COM-Ports über USB (Shell und Log), übernehmen die Ringe, sobald der PC sie öffnet ('usb' in der Shell)
+  UsbCdc_Init();
+  // Bildspiegel des Framebuffers über LPUART1 oder den ESP-Link, gestartet mit 'mirror on uart|esp'
+  Mirror_Init();
+  // Laufschrift auf der LED-Matrix, Task läuft nur mit Text ('matrix' in der Shell)
+  LED_Matrix_scroll_init(Scheduler_AddTask("Matrix", LED_Matrix_scroll_task, NULL, LED_MATRIX_SCROLL_MS, 10, 9));
+  // Massendaten über CAN-FD (RX-FIFO 1), Task läuft nur während einer Übertragung (CanTp_Init() in Stage_Can())
+  Task_CanTpId = Scheduler_AddTask("CanTp", CanTp_Task, NULL, 1, 10, 8);
+  Scheduler_SetEnabled(Task_CanTpId, 0);
+  // Messwerte auf die SD-Karte, Task läuft nur während einer Aufzeichnung ('log start' in der Shell)
+  SensorLog_Init(Scheduler_AddTask("Logger", SensorLog_Task, NULL, SENSORLOG_TASK_MS, 50, 12));
+  // Bildschirmfoto, Task läuft nur während einer Aufnahme ('shot' in der Shell)
+  ILI9341_Screenshot_Init(&hspi1, Scheduler_AddTask("Shot", ILI9341_Screenshot_Task, NULL, ILI9341_SCREENSHOT_TASK_MS, 20, 13));
+  // Display schlafen legen nach Inaktivität, Eingaben wecken es über TOPIC_INPUT ('disp' in der Shell)
+  ILI9341_Power_Init(Scheduler_AddTask("Power", ILI9341_Power_Task, NULL, ILI9341_POWER_TASK_MS, 10, 14));
+  // Animationen von SD-Karte oder Flash, Task läuft nur während einer Wiedergabe und legt seine Freigaben selbst ('anim' in der Shell)
+  Anim_Init(Scheduler_AddTask("Anim", Anim_Task, NULL, ANIM_TASK_MS, 50, 10));
+  // Freigegebene W25Qxx-Sektoren im Hintergrund löschen und KV-Garbage-Collection, läuft nur bei Bedarf ('flash pool')
+  FlashPool_Init(Scheduler_AddTask("Flash", Task_Flash, NULL, FLASHPOOL_TASK_MS, 10, 15), Window_IsBusy);
+  // Assets angemeldeter Bildschirme im Leerlauf in den RAM laden, läuft nur bei Bedarf ('cache')
+  AssetCache_Init(Scheduler_AddTask("Prefetch", AssetCache_Task, NULL, ASSET_CACHE_TASK_MS, 50, 16), ILI9341_IsBusy);
+  // Stufen der Datenstrom-Pipelines, läuft erst mit angemeldeten Stufen und wird von jeder Übergabe freigegeben ('pipe')
+  Pipe_Init(Scheduler_AddTask("Pipe", Pipe_Task, NULL, PIPE_TASK_MS, 20, 6));
+  AHT20_SetCallback(ShowSensorValues);
+
+  // Langsame Initialisierungen nach dem Start des Schedulers, je Durchlauf des Boot-Tasks eine
+  Boot_Defer("adc", Stage_Adc);
+  Boot_Defer("dsp", Stage_Dsp);
+  Boot_Defer("can", Stage_Can);
+  Boot_Defer("oled", Stage_Oled);
+  Boot_Defer("matrix", Stage_Matrix);
+  Boot_Defer("sd", Stage_Sd);
+  Boot_Defer("ramdisk", Stage_RamDisk);
+  Boot_Start(Scheduler_AddTask("Boot", Boot_Task, NULL, 1, 1000, 11));
+
+#if defined(BENCH_DISPLAY) || defined(BENCH_STORAGE) || defined(BENCH_MEM) || defined(BENCH_JITTER) || defined(BENCH_BUS)
+  // Messreihen brauchen SD-Karte und ruhige Peripherie: alles sofort initialisieren
+  Boot_RunDeferred();
+#endif
+#ifdef BENCH_DISPLAY
+  // Nur im Ziel display_bench: Messreihe der Zeichenfunktionen als CSV über UART7
+  DisplayBench_Run();
+#endif
+#ifdef BENCH_STORAGE
+  // Nur im Ziel storage_bench: Durchsatz von SD-Karte und W25Qxx als CSV über UART7
+  StorageBench_Run();
+#endif
+#ifdef BENCH_MEM
+  // Nur im Ziel mem_bench: Bandbreite und Latenz der Speicherbereiche als CSV über UART7
+  MemBench_Run();
+#endif
+#ifdef BENCH_JITTER
+  // Nur im Ziel jitter_bench: Verspätung des TIM7-Ticks unter Display-, SD- und UART-Last
+  JitterBench_Run();
+#endif
+#ifdef BENCH_BUS
+  // Nur im Ziel bus_bench: alle Master gleichzeitig auf dem AXI-SRAM, ohne und mit QoS
+  BusBench_Run();
+#endif
+#if defined(BENCH_DISPLAY) || defined(BENCH_STORAGE) || defined(BENCH_MEM) || defined(BENCH_JITTER) || defined(BENCH_BUS)
+  // Ende aller Messreihen, Tools/bench_run.py liest bis hierher
+  Bench_Finish();
+#endif
 
   Realtime_Init();
-
+  Boot_Interactive();
 
   /* USER CODE END 2 */
 
@@ -204,81 +479,19 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-#ifdef USE_POLLING
-    PollingUserInput();
-#endif
-#ifdef USE_INTERRUPT
-    HandleMDSLeft();
-#endif
-
-
-    HandlePendingUserInput();
-
+    PROF_BEGIN(PROF_ID_MAIN_LOOP);
+    // Bereiten Task mit der höchsten Priorität ausführen (Tasks siehe USER CODE 4),
+    // sonst bis zur nächsten Freigabe schlafen
+    if (!Scheduler_Dispatch())
+      Scheduler_Idle();
 
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
 
-  if (MDS_LEFT_Flanke == 1) {
-    printf("MDS_LEFT Flanke erkannt\n");
-    ILI9341_fillRect(0,0,320,40,WHITE);
-    ILI9341_DrawText("LEFT",130,0,BLACK,3,WHITE);
-  }
-  else if (MDS_RIGHT_Flanke == 1) {
-    printf("MDS_RIGHT_Flanke erkannt\n");
-    ILI9341_fillRect(0,0,320,40,WHITE);
-    ILI9341_DrawText("RIGHT",130,0,BLACK,3,WHITE);
-  }
-  else if (MDS_UP_Flanke == 1) {
-    printf("MDS_UP_Flanke erkannt\n");
-    ILI9341_fillRect(0,0,320,40,WHITE);
-    ILI9341_DrawText("UP",130,0,BLACK,3,WHITE);
-  }
-  else if (MDS_DOWN_Flanke == 1) {
-    printf("MDS_DOWN_Flanke erkannt\n");
-    ILI9341_fillRect(0,0,320,40,WHITE);
-    ILI9341_DrawText("DOWN",130,0,BLACK,3,WHITE);
-  }
-    else if (MDS_BUTTON_Flanke == 1){
-      printf("MDS_BUTTON_Flanke erkannt\n");
-      ILI9341_fillRect(0,0,320,40,WHITE);
-      ILI9341_DrawText("BUTTON",130,0,BLACK,3,WHITE);
-    }
-    else if (USER_BUTTON_Flanke == 1) {
-      printf("USER_BUTTON_Flanke erkannt\n");
-      ILI9341_fillRect(0,0,320,40,WHITE);
-    }
-
-
-    UpdatePotiValues();
-
-  WS2812_SetLED(Poti1Value*(1.0/256.0),Poti2Value*(1.0/256.0),Poti3Value*(1.0/256.0));
-  WS2812_SetBrightness(Poti4Value*(45.0/65536.0));
-  WS2812_Send();
-  HAL_Delay(1);
-
-
-    if (HAL_GetTick() - lastUpdateTime >= 1000) {  // Alle 1000 ms aktualisieren
-      float temp = 0, hum = 0;
-      AHT20_Read(&temp, &hum);
-        char tempStr[16], humStr[16];
-        sprintf(tempStr, "Temp: %.1f C", temp);
-        sprintf(humStr, "Hum: %.1f %%", hum);
-
-        // Bereich löschen und neu beschreiben
-        ssd1306_Fill(White);
-        ssd1306_SetCursor(25, 0);
-        ssd1306_WriteString("Demo Programm", Font_6x8, BLACK);
-        ssd1306_SetCursor(10, 20);
-        ssd1306_WriteString(tempStr, Font_6x8, BLACK);
-        ssd1306_SetCursor(10, 30);
-        ssd1306_WriteString(humStr, Font_6x8, BLACK);
-        ssd1306_UpdateScreen();
-
-      lastUpdateTime = HAL_GetTick();
-    }
-
-    ResetFlanken();
+    // Befehle für das Profiling auf UART7 (p = Tabelle, r = zurücksetzen, o = Anzeige, s = Tasks)
+    Prof_PollCommand();
+    PROF_END(PROF_ID_MAIN_LOOP);
   }
   /* USER CODE END 3 */
 }
@@ -346,50 +559,419 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
-//TODO DO CODE EINI TIAN
-PUTCHAR_PROTOTYPE
+/**
+  * @brief  Task: Taster und Joystick auswerten und die erkannte Richtung anzeigen, freigegeben von jedem Ereignis (TOPIC_INPUT)
+  */
+static void Task_UserInput(void *context)
 {
-  /* Place your implementation of fputc here */
-  /* e.g. write a character to the USART1 and Loop until the end of transmission */
-  HAL_UART_Transmit(&huart7, (uint8_t *)&ch, 1, 0xFFFF);
-  return ch;
-}
+#if defined(USE_POLLING) && defined(DEBOUNCE_WITH_DELAY)
+  PollingUserInput();
+#endif
 
+  // Alle seit dem letzten Aufruf erkannten Flanken abholen, keine geht verloren
+  UserInput_Event event;
+  uint8_t changed = 0;
+  while (UserInput_GetEvent(&event)) {
+    if (event.type == USER_INPUT_RELEASED)
+      continue;
+    changed = 1;
+
+    if (event.type == USER_INPUT_CHORD) {
+      LOG("Kombination 0x%lX erkannt\n", (unsigned long)event.mask);
+      ILI9341_Widget_SetText(&Ui_Status, "CHORD");
+      continue;
+    }
 
-void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
-    //Alle Funktionen, welche den Interrupt abbekommen wollen werden hier drinnen platziert.
-    //Wenn man nicht weiß, was man tut, hier nichts verändern
+    if (event.type == USER_INPUT_LONG_PRESS) {
+      // Langer Druck auf den USER-Taster springt zurück zum ersten Effekt
+      LOG("%s lang gedrückt\n", UserInput_GetName(event.input));
+      if (event.input == USER_BUTTON || event.input == GAMEPAD_OPTIONS)
+        Effects_SetMode(EFFECTS_STATIC);
+      continue;
+    }
 
-#ifdef USE_INTERRUPT
-    UserInput_Interrupt(GPIO_Pin);
-#endif
+    // Druck oder Wiederholung beim Halten (Joystick-Richtungen), Latenz nur für den Druck selbst
+    if (event.type == USER_INPUT_PRESSED) {
+      uint32_t latencyUs = (uint32_t)(Timebase_Us() - event.timeUs);
+      LOG("%s erkannt, Latenz %lu us\n", UserInput_GetName(event.input), latencyUs);
+    }
 
+    // Das Gamepad (Gamepad.c) bedient die Demo wie Joystick und USER-Taster
+    switch (event.input) {
+      case MDS_LEFT:
+      case GAMEPAD_LEFT:
+        ILI9341_Widget_SetText(&Ui_Status, "LEFT");
+        break;
+      case MDS_RIGHT:
+      case GAMEPAD_RIGHT:
+        ILI9341_Widget_SetText(&Ui_Status, "RIGHT");
+        break;
+      case MDS_UP:
+      case GAMEPAD_UP:
+        ILI9341_Widget_SetText(&Ui_Status, "UP");
+        break;
+      case MDS_DOWN:
+      case GAMEPAD_DOWN:
+        ILI9341_Widget_SetText(&Ui_Status, "DOWN");
+        break;
+      case MDS_BUTTON:
+      case GAMEPAD_CROSS:
+        ILI9341_Widget_SetText(&Ui_Status, "BUTTON");
+        break;
+      case USER_BUTTON:
+      case GAMEPAD_OPTIONS:
+        Effects_NextMode();
+        break;
+      default:
+        ILI9341_Widget_SetText(&Ui_Status, UserInput_GetName(event.input));
+        break;
+    }
+
+    // Eingabe bis Bild: ab hier bis das TFT die neue Statuszeile übertragen hat (Shell 'photon')
+    if (event.type == USER_INPUT_PRESSED && event.input != USER_BUTTON && event.input != GAMEPAD_OPTIONS)
+      InputLatency_Arm((uint32_t)event.timeUs);
+  }
+
+  if (changed)
+    Ui_SaveState();
 }
 
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+/**
+  * @brief  Lichteffekt und Statuszeile für den nächsten Warmstart retten
+  */
+static void Ui_SaveState(void)
+{
+  Ui_State state;
 
-#ifdef DEBOUNCE_WITH_TIMER
-  if (htim->Instance == TIM6) {
-    HandleDebouncedUserInput();
+  memset(&state, 0, sizeof(state));
+  state.mode = (uint8_t)Effects_GetMode();
+  strncpy(state.text, Ui_Status.text, ILI9341_WIDGET_TEXT_MAX);
+  WarmBoot_Save(WARMBOOT_ITEM_UI, &state, sizeof(state));
+}
 
-    // Stoppe den Timer
-    HAL_TIM_Base_Stop(&htim6);
+/**
+  * @brief  Task: Geänderte Widgets zeichnen und alle Displays übertragen (ein Bild je TE-Takt bzw. alle 20 ms, unveränderte kosten nichts)
+  */
+static void Task_UI(void *context)
+{
+  if (!ILI9341_TE_TakeFrame())
+    return;
+  Canvas_FrameBegin();
+  ILI9341_Widget_Render();
+  ILI9341_Chart_Render(&Ui_PotiChart);
+  // OLED, Matrix and TFT transfer side by side on their own buses, the task does not wait for them
+  Canvas_FrameFlush();
+  // Zwischenpuffer des Bildes freigeben, Dekoder haben ihren Teil bereits zurückgegeben
+  Arena_Reset(&Arena_Frame);
+}
 
-    // Setze debounce flag zurück
-    debounce_in_progress = 0;
+/**
+  * @brief  Task: Lichteffekt aus den Potentiometern berechnen, USER-Taster wechselt den Effekt
+  */
+static void Task_LED(void *context)
+{
+  static uint32_t potiSequence = 0;
+  Topic_Poti poti;
 
-    //Setzte timer update flag zurück
-    __HAL_TIM_CLEAR_FLAG(&htim6, TIM_FLAG_UPDATE);
+  // Neue Potiwerte nur, wenn der TIM7-Tick einen außerhalb des Totbands veröffentlicht hat
+  if (Topic_Read(TOPIC_POTI, &poti, sizeof(poti), &potiSequence))
+  {
+    Effects_SetInputs(poti.value[0], poti.value[1], poti.value[2], poti.value[3]);
   }
+  // Im Messbetrieb speisen die ADC-Blöcke die Kurve direkt
+  if (!ADC_IsAcquiring())
+    ILI9341_Chart_AddSample(&Ui_PotiChart, Poti1Value);
+  Effects_Tick();
+  // Sendet nur bei Änderungen und höchstens mit WS2812_FRAME_RATE, blockiert nicht
+  PROF_BEGIN(PROF_ID_WS2812);
+  WS2812_Show();
+  PROF_END(PROF_ID_WS2812);
+}
+
+/**
+  * @brief  Task: Eingereihte Dateizugriffe in einer Zeitscheibe von 2 ms abarbeiten
+  */
+static void Task_SDQueue(void *context)
+{
+  PROF_BEGIN(PROF_ID_SDQUEUE);
+  SDQueue_Service(2);
+  PROF_END(PROF_ID_SDQUEUE);
+}
+
+/**
+  * @brief  Task: Laufende AHT20-Messung vorantreiben (Wartezeiten, I2C-Transfers, CRC)
+  */
+static void Task_AHT20(void *context)
+{
+  PROF_BEGIN(PROF_ID_AHT20);
+  AHT20_Service();
+  PROF_END(PROF_ID_AHT20);
+}
+
+/**
+  * @brief  Timer: Jede Sekunde eine Messung starten, der Wert kommt über ShowSensorValues()
+  */
+static void Tick_Sensor(void *context)
+{
+  AHT20_StartMeasurement();
+
+  if (Prof_IsOverlayEnabled())
+    Prof_DrawOverlay(PROF_OVERLAY_X, PROF_OVERLAY_Y);
+}
+
+/**
+  * @brief  Timer: Grüne LED als Lebenszeichen, Takt 1 s
+  */
+static void Tick_Heartbeat(void *context)
+{
+  HAL_GPIO_TogglePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin);
+}
+
+/**
+  * @brief  Task: Messblöcke des ADC glätten und Spektrum berechnen (nur im Messbetrieb aktiv)
+  */
+static void Task_DSP(void *context)
+{
+  Dsp_Process();
+}
+
+/**
+  * @brief  Task: Einen Löschabschnitt des W25Qxx und einen Schritt der KV-Garbage-Collection ausführen
+  */
+static void Task_Flash(void *context)
+{
+  FlashPool_Task(context);
+  FlashKV_Process();
+}
+
+/**
+  * @brief  Liest gerade ein DMA-Transfer aus dem Memory-Mapped-Fenster (Bild zum Display, Asset-Cache)?
+  */
+static uint8_t Window_IsBusy(void)
+{
+  return ILI9341_IsBusy() || AssetCache_IsBusy();
+}
+
+/**
+  * @brief  Neuer gefilterter Messwert vom AHT20 (Hundertstel): Temperatur und Luftfeuchte auf dem SSD1306 anzeigen
+  */
+static void ShowSensorValues(int16_t centiCelsius, uint16_t centiPercent)
+{
+  char tempStr[16], humStr[16];
+  Fmt_Buffer b;
+  // Hundredths rounded to one decimal, integers only
+  int32_t temp10 = (centiCelsius + (centiCelsius < 0 ? -5 : 5)) / 10;
+  uint32_t hum10 = (centiPercent + 5U) / 10U;
+  Fmt_Init(&b, tempStr, sizeof(tempStr));
+  Fmt_Str(&b, "Temp: ");
+  Fmt_Fixed(&b, temp10, 1, 0);
+  Fmt_Str(&b, " C");
+  Fmt_Init(&b, humStr, sizeof(humStr));
+  Fmt_Str(&b, "Hum: ");
+  Fmt_Fixed(&b, hum10, 1, 0);
+  Fmt_Str(&b, " %");
+
+  // Bereich löschen und neu beschreiben, gesendet werden nur die geänderten Spalten
+  Canvas_Fill(&Canvas_Oled, CANVAS_WHITE);
+  Canvas_DrawText(&Canvas_Oled, 25, 0, "Demo Programm", &Font_6x8, CANVAS_BLACK, CANVAS_WHITE);
+  Canvas_DrawText(&Canvas_Oled, 10, 20, tempStr, &Font_6x8, CANVAS_BLACK, CANVAS_WHITE);
+  Canvas_DrawText(&Canvas_Oled, 10, 30, humStr, &Font_6x8, CANVAS_BLACK, CANVAS_WHITE);
+}
+
+
+RAMFUNC void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
+    //Alle Funktionen, welche den Interrupt abbekommen wollen werden hier drinnen platziert.
+    //Wenn man nicht weiß, was man tut, hier nichts verändern
+
+#ifdef USE_INTERRUPT
+    UserInput_Interrupt(GPIO_Pin);
 #endif
+    ILI9341_TE_Callback(GPIO_Pin);
+
+}
 
+RAMFUNC void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
 
   if (htim->Instance == TIM7) {
     // Timer 7 Callback
+#ifdef BENCH_JITTER
+    JitterBench_Tick();
+#endif
     Realtime_Loop();
   }
 }
 
+RAMFUNC void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+  // DMA-Übertragung zum Display abgeschlossen -> CS freigeben bzw. nächsten Block starten
+  ILI9341_SPI_TxCpltCallback(hspi);
+  // LED-Matrix: Zeile übernehmen, nächste Zeile des Bildes starten
+  LED_Matrix_SPI_TxCpltCallback(hspi);
+}
+
+RAMFUNC void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi) {
+  // Rücklesen des Displayspeichers abgeschlossen (Bildschirmfoto)
+  ILI9341_SPI_RxCpltCallback(hspi);
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+  ILI9341_SPI_ErrorCallback(hspi);
+  LED_Matrix_SPI_ErrorCallback(hspi);
+}
+
+// I2C: Transaktion fertig -> Callback des Treibers, nächste Transaktion des Busses starten
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+  I2CBus_CompleteCallback(hi2c);
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+  I2CBus_CompleteCallback(hi2c);
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+  I2CBus_CompleteCallback(hi2c);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+  I2CBus_CompleteCallback(hi2c);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+  I2CBus_ErrorCallback(hi2c);
+}
+
+void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c) {
+  I2CBus_ErrorCallback(hi2c);
+}
+
+// UART: Stück des Sendepuffers per DMA gesendet -> nächstes Stück starten
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+  Serial_TxCpltCallback(huart);
+  EspLink_TxCpltCallback(huart);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+  Serial_ErrorCallback(huart);
+  Shell_ErrorCallback(huart);
+  EspLink_ErrorCallback(huart);
+  Gamepad_ErrorCallback(huart);
+}
+
+// UART: neue Zeichen im Empfangsring der Kommandozeile bzw. des ESP-Links (halb/voll/Sendepause),
+// Rahmen des Gamepads (Sendepause)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+  Shell_RxEventCallback(huart, Size);
+  EspLink_RxEventCallback(huart, Size);
+  Gamepad_RxEventCallback(huart, Size);
+}
+
+// ADC: Hälfte des Messpuffers fertig -> Block an die Empfänger
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc) {
+  ADC_ConvHalfCpltCallback(hadc);
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc) {
+  ADC_ConvCpltCallback(hadc);
+}
+
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc) {
+  ADC_ErrorCallback(hadc);
+}
+
+// FDCAN: RX-FIFOs leeren, TX-FIFO nachfüllen, Bus-Off behandeln
+void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs) {
+  Can_RxFifo0Callback(hfdcan, RxFifo0ITs);
+}
+
+void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo1ITs) {
+  Can_RxFifo1Callback(hfdcan, RxFifo1ITs);
+}
+
+void HAL_FDCAN_TxBufferCompleteCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t BufferIndexes) {
+  Can_TxBufferCompleteCallback(hfdcan, BufferIndexes);
+}
+
+void HAL_FDCAN_ErrorStatusCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t ErrorStatusITs) {
+  Can_ErrorStatusCallback(hfdcan, ErrorStatusITs);
+}
+
+/**
+  * @brief  Boot: ADC1 kalibrieren, danach Potis per Timer und DMA im Hintergrund abtasten
+  */
+static uint8_t Stage_Adc(void)
+{
+  return ADC_Start();
+}
+
+/**
+  * @brief  Boot: Auswertung von VR1, sobald ADC_StartAcquisition() den Messbetrieb einschaltet
+  */
+static uint8_t Stage_Dsp(void)
+{
+  return Dsp_Init(0);
+}
+
+/**
+  * @brief  Boot: CAN-FD an FDCAN1, nur IDs mit Filter erreichen die CPU; Massendaten über RX-FIFO 1
+  */
+static uint8_t Stage_Can(void)
+{
+  return Can_Init(&hfdcan1) && Can_AddFilter(CAN_RX_ID_BASE, CAN_RX_ID_MASK, 0, 0)
+      && CanTp_Init(Task_CanTpId, CANTP_NODE);
+}
+
+/**
+  * @brief  Das Herz auf einer beliebigen Zeichenfläche, der Hintergrund bleibt stehen
+  */
+static void Ui_DrawHeart(Canvas *canvas, int16_t x, int16_t y, uint8_t scale, Canvas_Color colour)
+{
+  Canvas_DrawBitmapScaled(canvas, x, y, Ui_Heart, 8, 8, scale, colour, CANVAS_TRANSPARENT);
+}
+
+/**
+  * @brief  Boot: SSD1306 mit Titel und Herz
+  */
+static uint8_t Stage_Oled(void)
+{
+  ssd1306_Init();
+  Canvas_Fill(&Canvas_Oled, CANVAS_WHITE);
+  Canvas_DrawText(&Canvas_Oled, 25, 0, "Demo Programm", &Font_6x8, CANVAS_BLACK, CANVAS_WHITE);
+  Ui_DrawHeart(&Canvas_Oled, 80, 40, 2, CANVAS_BLACK);
+  Canvas_Flush(&Canvas_Oled);
+  return 1;
+}
+
+/**
+  * @brief  Boot: LED-Matrix mit Herz; gesendet werden nur die Zeilen, die nicht schon dunkel sind
+  */
+static uint8_t Stage_Matrix(void)
+{
+  LED_Matrix_setup();
+  Ui_DrawHeart(&Canvas_Matrix, 0, 0, 1, CANVAS_WHITE);
+  Canvas_Flush(&Canvas_Matrix);
+  LED_Matrix_set_intensity(2);
+  return 1;
+}
+
+/**
+  * @brief  Boot: Volume einmal mounten (alle Dateizugriffe teilen es danach), dann Logos, die nicht im Flash waren
+  */
+static uint8_t Stage_Sd(void)
+{
+  if (!SDCard_Mount())
+    return 0;
+
+  Splash_ShowFallback();
+  return 1;
+}
+
+/**
+  * @brief  Boot: leeres Laufwerk "2:" im Rest von RAM_CD für Zwischendateien
+  */
+static uint8_t Stage_RamDisk(void)
+{
+  return FATFS_MountRam() == FR_OK;
+}
+
 /* USER CODE END 4 */
 
  /* MPU Configuration */
@@ -415,6 +997,39 @@ void MPU_Config(void)
   MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
   MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
 
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+  /** Initializes and configures the Region and the memory to be protected
+  */
+  MPU_InitStruct.Number = MPU_REGION_NUMBER1;
+  MPU_InitStruct.BaseAddress = 0x90000000;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_16MB;
+  MPU_InitStruct.SubRegionDisable = 0x0;
+  MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
+  MPU_InitStruct.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+  MPU_InitStruct.IsCacheable = MPU_ACCESS_CACHEABLE;
+
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+  /** Initializes and configures the Region and the memory to be protected
+  */
+  MPU_InitStruct.Number = MPU_REGION_NUMBER2;
+  MPU_InitStruct.BaseAddress = 0x30000000;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_128KB;
+  MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL1;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+  MPU_InitStruct.IsShareable = MPU_ACCESS_SHAREABLE;
+  MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+  /** Initializes and configures the Region and the memory to be protected
+  */
+  MPU_InitStruct.Number = MPU_REGION_NUMBER3;
+  MPU_InitStruct.BaseAddress = 0x38000000;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_32KB;
+
   HAL_MPU_ConfigRegion(&MPU_InitStruct);
   /* Enables the MPU */
   HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
@@ -430,6 +1045,8 @@ void Error_Handler(void)
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
   __disable_irq();
+  // Warmstart statt Stillstand, mit Debugger oder nach wiederholten Fehlern bleibt es bei der Schleife
+  WarmBoot_Fault(WARMBOOT_FAULT_ERROR);
   while (1)
   {
   }
@@ -21,6 +21,35 @@
 #include "octospi.h"
 
 /* USER CODE BEGIN 0 */
+#include "Clock.h"
+#include "FlashKV.h"
+#include "WarmBoot.h"
+#include "W25Qxx_QSPI.h"
+#include "Log.h"
+#include <string.h>
+
+/* MDMA-Kanal für W25Qxx_ReadAsync, ausgelöst über die FIFO-Schwelle des OCTOSPI1 */
+MDMA_HandleTypeDef hmdma_octospi1_fifo_th;
+
+/**
+  * @brief Eintrag "ospi.tuneN" im Schlüssel/Wert-Speicher, N = Taktprofil
+  */
+typedef struct {
+  uint32_t hclkHz;         /* HCLK, für den die Einstellung gilt (0 = kein Eintrag) */
+  OCTOSPI1_Setting setting;
+} OCTOSPI1_TuneStore;
+
+OCTOSPI1_TuneResult OCTOSPI1_Tuning = {{1, 1, OCTOSPI1_TUNE_BYPASS, 0}, 0, 0, 0, 0};
+
+/* Gespeicherte Einstellungen je Profil, beim ersten Tuning aus dem Schlüssel/Wert-Speicher geladen */
+static OCTOSPI1_TuneStore OCTOSPI1_Stored[CLOCK_PROFILE_COUNT];
+static uint8_t OCTOSPI1_StoredLoaded = 0;
+
+/* Aktives Timing, zu Beginn das aus MX_OCTOSPI1_Init() */
+static OCTOSPI1_Setting OCTOSPI1_Active = {1, 1, OCTOSPI1_TUNE_BYPASS, 0};
+
+static uint8_t OCTOSPI1_TunePattern[OCTOSPI1_TUNE_SIZE] __attribute__((aligned(32)));
+static uint8_t OCTOSPI1_TuneBuffer[OCTOSPI1_TUNE_SIZE] __attribute__((aligned(32)));
 
 /* USER CODE END 0 */
 
@@ -67,6 +96,7 @@ void MX_OCTOSPI1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN OCTOSPI1_Init 2 */
+  Clock_ConfigOctospi();
 
   /* USER CODE END OCTOSPI1_Init 2 */
 
@@ -142,8 +172,44 @@ void HAL_OSPI_MspInit(OSPI_HandleTypeDef* ospiHandle)
     GPIO_InitStruct.Alternate = GPIO_AF11_OCTOSPIM_P1;
     HAL_GPIO_Init(GPIOE, &GPIO_InitStruct);
 
+    /* OCTOSPI1 interrupt Init */
+    HAL_NVIC_SetPriority(OCTOSPI1_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(OCTOSPI1_IRQn);
   /* USER CODE BEGIN OCTOSPI1_MspInit 1 */
 
+    /* OCTOSPI1 MDMA Init */
+    __HAL_RCC_MDMA_CLK_ENABLE();
+
+    hmdma_octospi1_fifo_th.Instance = MDMA_Channel0;
+    hmdma_octospi1_fifo_th.Init.Request = MDMA_REQUEST_OCTOSPI1_FIFO_TH;
+    hmdma_octospi1_fifo_th.Init.TransferTriggerMode = MDMA_BUFFER_TRANSFER;
+    hmdma_octospi1_fifo_th.Init.Priority = MDMA_PRIORITY_HIGH;
+    hmdma_octospi1_fifo_th.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+    hmdma_octospi1_fifo_th.Init.SourceInc = MDMA_SRC_INC_DISABLE;
+    hmdma_octospi1_fifo_th.Init.DestinationInc = MDMA_DEST_INC_BYTE;
+    hmdma_octospi1_fifo_th.Init.SourceDataSize = MDMA_SRC_DATASIZE_BYTE;
+    hmdma_octospi1_fifo_th.Init.DestDataSize = MDMA_DEST_DATASIZE_BYTE;
+    hmdma_octospi1_fifo_th.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+    hmdma_octospi1_fifo_th.Init.BufferTransferLength = 1;
+    hmdma_octospi1_fifo_th.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+    hmdma_octospi1_fifo_th.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+    hmdma_octospi1_fifo_th.Init.SourceBlockAddressOffset = 0;
+    hmdma_octospi1_fifo_th.Init.DestBlockAddressOffset = 0;
+    if (HAL_MDMA_Init(&hmdma_octospi1_fifo_th) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    if (HAL_MDMA_ConfigPostRequestMask(&hmdma_octospi1_fifo_th, 0, 0) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(ospiHandle, hmdma, hmdma_octospi1_fifo_th);
+
+    /* MDMA interrupt Init */
+    HAL_NVIC_SetPriority(MDMA_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(MDMA_IRQn);
   /* USER CODE END OCTOSPI1_MspInit 1 */
   }
 }
@@ -174,12 +240,423 @@ void HAL_OSPI_MspDeInit(OSPI_HandleTypeDef* ospiHandle)
 
     HAL_GPIO_DeInit(GPIOE, GPIO_PIN_11);
 
+    /* OCTOSPI1 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(OCTOSPI1_IRQn);
   /* USER CODE BEGIN OCTOSPI1_MspDeInit 1 */
 
+    /* OCTOSPI1 MDMA DeInit */
+    HAL_MDMA_DeInit(ospiHandle->hmdma);
+    HAL_NVIC_DisableIRQ(MDMA_IRQn);
   /* USER CODE END OCTOSPI1_MspDeInit 1 */
   }
 }
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief  Prüfmuster: alle Leitungen gemeinsam, Nachbarleitungen gegenläufig, wandernde
+  *         Einsen/Nullen und eine Pseudozufallsfolge (je 64 Bytes).
+  */
+static void OCTOSPI1_FillPattern(void)
+{
+  uint16_t lfsr = 0xACE1U;
+
+  for (uint32_t i = 0; i < OCTOSPI1_TUNE_SIZE; i++)
+  {
+    uint8_t value;
+    switch (i / 64U)
+    {
+      case 0:  value = (i & 1U) ? 0xFF : 0x00; break;
+      case 1:  value = (i & 1U) ? 0xAA : 0x55; break;
+      case 2:  value = (uint8_t)((1U << (i & 7U)) ^ ((i & 8U) ? 0xFFU : 0x00U)); break;
+      default:
+        lfsr = (uint16_t)((lfsr >> 1) ^ (-(lfsr & 1U) & 0xB400U));
+        value = (uint8_t)lfsr;
+        break;
+    }
+    OCTOSPI1_TunePattern[i] = value;
+  }
+}
+
+/**
+  * @brief  Schreibt das Prüfmuster, falls es fehlt; gelesen wird einzeilig mit Fast Read
+  *         im Timing der CubeMX-Konfiguration.
+  */
+static uint8_t OCTOSPI1_PreparePattern(void)
+{
+  OCTOSPI1_FillPattern();
+  W25Qxx_FastReadData(OCTOSPI1_TUNE_ADDRESS, OCTOSPI1_TuneBuffer, OCTOSPI1_TUNE_SIZE);
+  if (memcmp(OCTOSPI1_TuneBuffer, OCTOSPI1_TunePattern, OCTOSPI1_TUNE_SIZE) == 0)
+  {
+    return 1;
+  }
+
+  W25Qxx_WriteData((int32_t)OCTOSPI1_TUNE_ADDRESS, OCTOSPI1_TunePattern, OCTOSPI1_TUNE_SIZE);
+  memset(OCTOSPI1_TuneBuffer, 0, sizeof(OCTOSPI1_TuneBuffer));
+  W25Qxx_FastReadData(OCTOSPI1_TUNE_ADDRESS, OCTOSPI1_TuneBuffer, OCTOSPI1_TUNE_SIZE);
+  return memcmp(OCTOSPI1_TuneBuffer, OCTOSPI1_TunePattern, OCTOSPI1_TUNE_SIZE) == 0;
+}
+
+/**
+  * @brief  Read-Verify: OCTOSPI1_TUNE_REPEAT Quad-Lesevorgänge (W25Qxx_FastReadQuadOutput) müssen das Muster liefern.
+  */
+static uint8_t OCTOSPI1_Verify(void)
+{
+  for (uint32_t n = 0; n < OCTOSPI1_TUNE_REPEAT; n++)
+  {
+    memset(OCTOSPI1_TuneBuffer, 0, sizeof(OCTOSPI1_TuneBuffer));
+    W25Qxx_FastReadQuadOutput(OCTOSPI1_TUNE_ADDRESS, OCTOSPI1_TuneBuffer, OCTOSPI1_TUNE_SIZE);
+    if (hospi1.State != HAL_OSPI_STATE_READY)
+    {
+      HAL_OSPI_Abort(&hospi1);
+      return 0;
+    }
+    if (memcmp(OCTOSPI1_TuneBuffer, OCTOSPI1_TunePattern, OCTOSPI1_TUNE_SIZE) != 0)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Liest das Muster einmal über den Memory-Mapped-Modus (Quad I/O, 0xEB) und verlässt ihn wieder.
+  */
+static uint8_t OCTOSPI1_VerifyMapped(void)
+{
+  uint8_t ok;
+
+  if (!W25Qxx_EnableMemoryMapped())
+  {
+    return 0;
+  }
+  SCB_InvalidateDCache_by_Addr((uint32_t*)(W25QXX_MAPPED_BASE + OCTOSPI1_TUNE_ADDRESS), OCTOSPI1_TUNE_SIZE);
+  ok = memcmp(W25Qxx_MappedAddress(OCTOSPI1_TUNE_ADDRESS), OCTOSPI1_TunePattern, OCTOSPI1_TUNE_SIZE) == 0;
+  W25Qxx_DisableMemoryMapped();
+  return ok;
+}
+
+/**
+  * @brief  Stellt eine Einstellung ein und prüft sie.
+  */
+static uint8_t OCTOSPI1_Try(const OCTOSPI1_Setting *setting)
+{
+  MX_OCTOSPI1_ApplySetting(setting);
+  OCTOSPI1_Tuning.tested++;
+  if (!OCTOSPI1_Verify())
+  {
+    return 0;
+  }
+  OCTOSPI1_Tuning.passed++;
+  return 1;
+}
+
+/**
+  * @brief  Kalibriert den Delay Block auf einen Takt des aktuellen Vorteilers.
+  * @retval Verzögerung je Stufe (1..127), 0 wenn der Takt zu langsam für die 12 Stufen ist
+  */
+static uint8_t OCTOSPI1_CalibrateDelayBlock(void)
+{
+  HAL_StatusTypeDef status;
+
+  /* The delay block measures the OCTOSPI clock, which only runs during transfers otherwise */
+  SET_BIT(hospi1.Instance->DCR1, OCTOSPI_DCR1_FRCK);
+  status = DelayBlock_Enable(DLYB_OCTOSPI1);
+  CLEAR_BIT(hospi1.Instance->DCR1, OCTOSPI_DCR1_FRCK);
+  if (status != HAL_OK)
+  {
+    return 0;
+  }
+  return (uint8_t)((DLYB_OCTOSPI1->CFGR & DLYB_CFGR_UNIT) >> DLYB_CFGR_UNIT_Pos);
+}
+
+/**
+  * @brief  Sucht die schnellste stabile Einstellung, vom höchsten erlaubten Takt abwärts.
+  *
+  * Je Vorteiler zuerst ohne Delay Block (halber Takt Verschiebung wie CubeMX, dann ohne),
+  * danach alle Phasen des Delay Blocks. Dort gilt die Mitte des längsten Fensters bestandener
+  * Phasen, wenn es mindestens OCTOSPI1_TUNE_MIN_WINDOW breit ist.
+  */
+static uint8_t OCTOSPI1_Sweep(uint32_t hclkHz, uint8_t slowest, OCTOSPI1_Setting *best)
+{
+  uint8_t fastest = (uint8_t)((hclkHz + CLOCK_OSPI_MAX_HZ - 1U) / CLOCK_OSPI_MAX_HZ);
+
+  for (uint8_t prescaler = fastest; prescaler <= slowest; prescaler++)
+  {
+    OCTOSPI1_Setting setting = {prescaler, 1, OCTOSPI1_TUNE_BYPASS, 0};
+    if (OCTOSPI1_Try(&setting))
+    {
+      *best = setting;
+      return 1;
+    }
+    setting.sampleShift = 0;
+    if (OCTOSPI1_Try(&setting))
+    {
+      *best = setting;
+      return 1;
+    }
+
+    setting.delayUnit = OCTOSPI1_CalibrateDelayBlock();
+    if (setting.delayUnit == 0)
+    {
+      continue;
+    }
+
+    uint8_t runStart = 0, runLength = 0, windowStart = 0, windowLength = 0;
+    for (uint8_t phase = 0; phase < OCTOSPI1_TUNE_PHASES; phase++)
+    {
+      setting.delayPhase = phase;
+      if (!OCTOSPI1_Try(&setting))
+      {
+        runLength = 0;
+        continue;
+      }
+      if (runLength++ == 0)
+      {
+        runStart = phase;
+      }
+      if (runLength > windowLength)
+      {
+        windowStart = runStart;
+        windowLength = runLength;
+      }
+    }
+    if (windowLength >= OCTOSPI1_TUNE_MIN_WINDOW)
+    {
+      setting.delayPhase = windowStart + windowLength / 2U;
+      *best = setting;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+  * @brief  Gibt an, ob ein gespeicherter Eintrag zu einem HCLK passt und gültige Werte enthält.
+  */
+static uint8_t OCTOSPI1_IsValid(const OCTOSPI1_TuneStore *store, uint32_t hclkHz)
+{
+  const OCTOSPI1_Setting *setting = &store->setting;
+
+  return store->hclkHz == hclkHz && setting->prescaler != 0 && hclkHz / setting->prescaler <= CLOCK_OSPI_MAX_HZ
+      && (setting->delayPhase == OCTOSPI1_TUNE_BYPASS
+          || (setting->delayPhase < OCTOSPI1_TUNE_PHASES && setting->delayUnit != 0 && setting->delayUnit < DLYB_MAX_UNIT));
+}
+
+/**
+  * @brief  Warmstart: geretteten Eintrag nur im Memory-Mapped-Modus prüfen, Muster und Read-Verify entfallen.
+  */
+static uint8_t OCTOSPI1_TryWarm(OCTOSPI1_TuneStore *warm, uint32_t hclkHz)
+{
+  if (!WarmBoot_Load(WARMBOOT_ITEM_OSPI, warm, sizeof(*warm)))
+  {
+    return 0;
+  }
+  if (OCTOSPI1_IsValid(warm, hclkHz))
+  {
+    // The pattern was verified in flash before the reset, only the expected copy in RAM is missing
+    OCTOSPI1_FillPattern();
+    MX_OCTOSPI1_ApplySetting(&warm->setting);
+    if (OCTOSPI1_VerifyMapped())
+    {
+      return 1;
+    }
+  }
+  WarmBoot_Invalidate(WARMBOOT_ITEM_OSPI);
+  return 0;
+}
+
+/**
+  * @brief  Lädt die Einträge aller Profile einmalig aus dem Schlüssel/Wert-Speicher.
+  */
+static void OCTOSPI1_LoadStored(void)
+{
+  char key[] = "ospi.tune0";
+
+  if (OCTOSPI1_StoredLoaded)
+  {
+    return;
+  }
+  for (uint8_t profile = 0; profile < CLOCK_PROFILE_COUNT; profile++)
+  {
+    key[sizeof(key) - 2] = (char)('0' + profile);
+    if (FlashKV_Get(key, &OCTOSPI1_Stored[profile], sizeof(OCTOSPI1_TuneStore)) != (int32_t)sizeof(OCTOSPI1_TuneStore))
+    {
+      OCTOSPI1_Stored[profile].hclkHz = 0;
+    }
+  }
+  OCTOSPI1_StoredLoaded = 1;
+}
+
+/**
+  * @brief  Bus-Tuning des OCTOSPI1 für das aktive Taktprofil, nach W25Qxx_begin() und FlashKV_Init().
+  *
+  * 0. Ohne force nach einem Warmstart: die vor dem Reset benutzte Einstellung, wenn sie zum HCLK
+  *    passt und der Lesevorgang im Memory-Mapped-Modus besteht (WARMBOOT_ITEM_OSPI)
+  * 1. Prüfmuster an OCTOSPI1_TUNE_ADDRESS im sicheren Startzustand lesen, bei Bedarf schreiben
+  * 2. Ohne force: die gespeicherte Einstellung des Profils übernehmen, wenn sie das Read-Verify
+  *    (W25Qxx_FastReadQuadOutput) und einen Lesevorgang im Memory-Mapped-Modus (0xEB) besteht
+  * 3. Sonst Vorteiler ab HCLK / CLOCK_OSPI_MAX_HZ, Sample Shifting und Delay Block durchprobieren
+  *    (OCTOSPI1_Sweep) und das Ergebnis als "ospi.tuneN" speichern
+  *
+  * Der Kerneltakt bleibt HCLK; den höchsten Takt bringt damit das Profil Balanced (128 MHz
+  * statt 64 MHz mit dem festen Vorteiler). Nach einem Profilwechsel übernimmt
+  * Clock_ConfigOctospi() die gespeicherte Einstellung des neuen Profils, fehlt sie, gilt der
+  * Vorteiler aus Clock.h.
+  *
+  * @param  force: 1 = gespeicherte Einstellung ignorieren und neu messen
+  * @retval HAL_OK mit getesteter Einstellung, sonst HAL_ERROR (Timing aus Clock.h)
+  */
+HAL_StatusTypeDef MX_OCTOSPI1_TuneBus(uint8_t force)
+{
+  Clock_Profile profile = Clock_GetProfile();
+  uint32_t hclkHz = Clock_GetProfileInfo()->sysclkHz;
+  OCTOSPI1_TuneStore *store = &OCTOSPI1_Stored[profile];
+  OCTOSPI1_Setting fallback = {(uint8_t)Clock_GetProfileInfo()->ospiPrescaler, 1, OCTOSPI1_TUNE_BYPASS, 0};
+  OCTOSPI1_Setting best = fallback;
+  OCTOSPI1_TuneStore warm;
+  HAL_StatusTypeDef status = HAL_OK;
+  uint8_t mapped;
+  uint8_t dtr = W25Qxx_Device.readDtr;
+
+  // Tuning measures SDR reads; DTR is switched on again below if its self-test passes
+  W25Qxx_DisableDtr();
+  W25Qxx_WaitReadAsync();
+  mapped = W25Qxx_IsMemoryMapped();
+  W25Qxx_DisableMemoryMapped();
+
+  OCTOSPI1_LoadStored();
+  OCTOSPI1_Tuning.fromStore = 0;
+  OCTOSPI1_Tuning.tested = 0;
+  OCTOSPI1_Tuning.passed = 0;
+  MX_OCTOSPI1_ApplySetting(&fallback);
+
+  if (!force && OCTOSPI1_TryWarm(&warm, hclkHz))
+  {
+    best = warm.setting;
+    OCTOSPI1_Tuning.fromStore = 2;
+  }
+  else if (!OCTOSPI1_PreparePattern())
+  {
+    LOG("OSPI tuning: pattern at 0x%06lX not readable\r\n", OCTOSPI1_TUNE_ADDRESS);
+    status = HAL_ERROR;
+  }
+  else if (!force && OCTOSPI1_IsValid(store, hclkHz) && OCTOSPI1_Try(&store->setting) && OCTOSPI1_VerifyMapped())
+  {
+    best = store->setting;
+    OCTOSPI1_Tuning.fromStore = 1;
+  }
+  else if (OCTOSPI1_Sweep(hclkHz, fallback.prescaler, &best))
+  {
+    MX_OCTOSPI1_ApplySetting(&best);
+    if (OCTOSPI1_VerifyMapped())
+    {
+      char key[] = "ospi.tune0";
+      key[sizeof(key) - 2] = (char)('0' + profile);
+      store->hclkHz = hclkHz;
+      store->setting = best;
+      FlashKV_Set(key, store, sizeof(*store));
+    }
+    else
+    {
+      status = HAL_ERROR;
+    }
+  }
+  else
+  {
+    status = HAL_ERROR;
+  }
+
+  if (status != HAL_OK)
+  {
+    best = fallback;
+    store->hclkHz = 0;
+  }
+  else
+  {
+    warm.hclkHz = hclkHz;
+    warm.setting = best;
+    WarmBoot_Save(WARMBOOT_ITEM_OSPI, &warm, sizeof(warm));
+  }
+  MX_OCTOSPI1_ApplySetting(&best);
+  OCTOSPI1_Tuning.setting = best;
+  OCTOSPI1_Tuning.clockHz = hclkHz / best.prescaler;
+
+  LOG("OSPI bus: %lu kHz, sample shift %u, delay phase %u unit %u, %u/%u passed%s\r\n",
+      OCTOSPI1_Tuning.clockHz / 1000U, best.sampleShift, best.delayPhase, best.delayUnit,
+      OCTOSPI1_Tuning.passed, OCTOSPI1_Tuning.tested,
+      OCTOSPI1_Tuning.fromStore == 2 ? " (warm)" : OCTOSPI1_Tuning.fromStore ? " (stored)" : "");
+
+  if (dtr && !W25Qxx_EnableDtr(OCTOSPI1_TUNE_ADDRESS))
+  {
+    LOG("OSPI bus: DTR self-test failed, reads stay SDR\r\n");
+  }
+
+  if (mapped)
+  {
+    W25Qxx_EnableMemoryMapped();
+  }
+  return status;
+}
+
+/**
+  * @brief  Timing für ein Taktprofil: die gespeicherte Einstellung, wenn sie zu dessen HCLK
+  *         passt, sonst der Vorteiler aus Clock.h mit halbem Takt Verschiebung.
+  */
+void MX_OCTOSPI1_GetSetting(uint8_t profile, OCTOSPI1_Setting *setting)
+{
+  const Clock_ProfileInfo *info = &Clock_Profiles[profile];
+  const OCTOSPI1_TuneStore *store = &OCTOSPI1_Stored[profile];
+
+  if (OCTOSPI1_IsValid(store, info->sysclkHz))
+  {
+    *setting = store->setting;
+    return;
+  }
+  setting->prescaler = (uint8_t)info->ospiPrescaler;
+  setting->sampleShift = 1;
+  setting->delayPhase = OCTOSPI1_TUNE_BYPASS;
+  setting->delayUnit = 0;
+}
+
+/**
+  * @brief  Gibt an, ob das Timing bereits eingestellt ist.
+  */
+uint8_t MX_OCTOSPI1_IsApplied(const OCTOSPI1_Setting *setting)
+{
+  return memcmp(setting, &OCTOSPI1_Active, sizeof(OCTOSPI1_Setting)) == 0;
+}
+
+/**
+  * @brief  Stellt Vorteiler, Sample Shifting und Delay Block ein.
+  * @note   Keine Übertragung und kein Memory-Mapped-Modus aktiv; die Register sind nur bei
+  *         gelöschtem BUSY schreibbar.
+  */
+void MX_OCTOSPI1_ApplySetting(const OCTOSPI1_Setting *setting)
+{
+  while (READ_BIT(hospi1.Instance->SR, OCTOSPI_SR_BUSY))
+  {
+  }
+  MODIFY_REG(hospi1.Instance->DCR2, OCTOSPI_DCR2_PRESCALER,
+             ((uint32_t)setting->prescaler - 1U) << OCTOSPI_DCR2_PRESCALER_Pos);
+  hospi1.Init.ClockPrescaler = setting->prescaler;
+
+  hospi1.Init.SampleShifting = setting->sampleShift ? HAL_OSPI_SAMPLE_SHIFTING_HALFCYCLE : HAL_OSPI_SAMPLE_SHIFTING_NONE;
+  MODIFY_REG(hospi1.Instance->TCR, OCTOSPI_TCR_SSHIFT, hospi1.Init.SampleShifting);
+
+  if (setting->delayPhase == OCTOSPI1_TUNE_BYPASS)
+  {
+    SET_BIT(hospi1.Instance->DCR1, OCTOSPI_DCR1_DLYBYP);
+    DelayBlock_Disable(DLYB_OCTOSPI1);
+    hospi1.Init.DelayBlockBypass = HAL_OSPI_DELAY_BLOCK_BYPASSED;
+  }
+  else
+  {
+    DelayBlock_Configure(DLYB_OCTOSPI1, setting->delayPhase, setting->delayUnit);
+    CLEAR_BIT(hospi1.Instance->DCR1, OCTOSPI_DCR1_DLYBYP);
+    hospi1.Init.DelayBlockBypass = HAL_OSPI_DELAY_BLOCK_USED;
+  }
+  OCTOSPI1_Active = *setting;
+}
+
 /* USER CODE END 1 */
@@ -21,6 +21,27 @@
 #include "sdmmc.h"
 
 /* USER CODE BEGIN 0 */
+#include <stdio.h>
+#include <string.h>
+#include "Log.h"
+#include "WarmBoot.h"
+#include "bsp_driver_sd.h"
+
+SDMMC1_TuneResult SDMMC1_Tuning = {1, 0, 0, 0, 0};
+
+/* Referenzdaten aus dem langsamen Startzustand und Vergleichspuffer */
+static uint8_t SDMMC1_TuneReference[SDMMC1_TUNE_VERIFY_BLOCKS * 512] __attribute__((aligned(32)));
+static uint8_t SDMMC1_TuneBuffer[SDMMC1_TUNE_VERIFY_BLOCKS * 512] __attribute__((aligned(32)));
+
+/* Busmodus und Kartendaten für MX_SDMMC1_Resume() (WARMBOOT_ITEM_SD) */
+typedef struct {
+  SDMMC1_TuneResult tuning;
+  HAL_SD_CardInfoTypeDef card;
+  uint32_t cid[4];
+  uint32_t csd[4];
+} SDMMC1_WarmState;
+
+static uint8_t SDMMC1_ResumeTried;
 
 /* USER CODE END 0 */
 
@@ -98,6 +119,19 @@ void HAL_SD_MspInit(SD_HandleTypeDef* sdHandle)
     HAL_NVIC_SetPriority(SDMMC1_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(SDMMC1_IRQn);
   /* USER CODE BEGIN SDMMC1_MspInit 1 */
+#ifdef SDMMC1_TUNE_4BIT
+    /**SDMMC1 GPIO Configuration (4-bit)
+    PC9     ------> SDMMC1_D1
+    PC10     ------> SDMMC1_D2
+    PC11     ------> SDMMC1_D3
+    */
+    GPIO_InitStruct.Pin = GPIO_PIN_9|GPIO_PIN_10|GPIO_PIN_11;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.Alternate = GPIO_AF12_SDMMC1;
+    HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
+#endif
 
   /* USER CODE END SDMMC1_MspInit 1 */
   }
@@ -126,6 +160,9 @@ void HAL_SD_MspDeInit(SD_HandleTypeDef* sdHandle)
     /* SDMMC1 interrupt Deinit */
     HAL_NVIC_DisableIRQ(SDMMC1_IRQn);
   /* USER CODE BEGIN SDMMC1_MspDeInit 1 */
+#ifdef SDMMC1_TUNE_4BIT
+    HAL_GPIO_DeInit(GPIOC, GPIO_PIN_9|GPIO_PIN_10|GPIO_PIN_11);
+#endif
 
   /* USER CODE END SDMMC1_MspDeInit 1 */
   }
@@ -133,4 +170,233 @@ void HAL_SD_MspDeInit(SD_HandleTypeDef* sdHandle)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief  Liest die Prüfsektoren und wartet, bis die Karte wieder im Transfer-Zustand ist.
+  */
+static HAL_StatusTypeDef SDMMC1_ReadBlocks(uint8_t *buffer, uint32_t block, uint32_t count)
+{
+  if (HAL_SD_ReadBlocks(&hsd1, buffer, block, count, 1000) != HAL_OK)
+  {
+    /* bei CRC-Fehlern steckt die Karte evtl. noch im Sendezustand: CMD12 holt sie zurück */
+    (void)SDMMC_CmdStopTransfer(hsd1.Instance);
+    return HAL_ERROR;
+  }
+  uint32_t start = HAL_GetTick();
+  while (HAL_SD_GetCardState(&hsd1) != HAL_SD_CARD_TRANSFER)
+  {
+    if (HAL_GetTick() - start > 1000) return HAL_TIMEOUT;
+  }
+  return HAL_OK;
+}
+
+/**
+  * @brief  Read-Verify: Die Prüfsektoren müssen mit der aktuellen Buskonfiguration
+  *         fehlerfrei und identisch zur Referenz gelesen werden.
+  */
+static uint8_t SDMMC1_Verify(void)
+{
+  memset(SDMMC1_TuneBuffer, 0, sizeof(SDMMC1_TuneBuffer));
+  if (SDMMC1_ReadBlocks(SDMMC1_TuneBuffer, 0, SDMMC1_TUNE_VERIFY_BLOCKS) != HAL_OK)
+  {
+    return 0;
+  }
+  return memcmp(SDMMC1_TuneBuffer, SDMMC1_TuneReference, sizeof(SDMMC1_TuneBuffer)) == 0;
+}
+
+/**
+  * @brief  Setzt den SDMMC-Taktteiler (SDMMC_CK = ker_ck / (2 * div), div = 0: ker_ck).
+  */
+static uint32_t SDMMC1_SetClockDiv(uint32_t div)
+{
+  uint32_t kernel = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_SDMMC);
+  MODIFY_REG(hsd1.Instance->CLKCR, SDMMC_CLKCR_CLKDIV, div);
+  hsd1.Init.ClockDiv = div;
+  return (div == 0U) ? kernel : kernel / (2U * div);
+}
+
+/**
+  * @brief  Bus-Tuning nach HAL_SD_Init.
+  *
+  * 1. Referenzsektoren im sicheren Startzustand (1 Bit, Init.ClockDiv) lesen
+  * 2. Auf 4-Bit-Bus umschalten, bei fehlgeschlagenem Read-Verify zurück auf 1 Bit
+  * 3. High-Speed-Modus (SDR25, CMD6) anfordern, wenn die Karte ihn unterstützt
+  * 4. Den kleinsten Taktteiler wählen, der im erlaubten Takt liegt und das Read-Verify besteht
+  * 5. Lesebandbreite messen und ausgeben
+  *
+  * SDR50 und schneller brauchen 1,8-V-Signalpegel und damit einen externen
+  * Transceiver (USE_SD_TRANSCEIVER); ohne ihn ist SDR25 mit 50 MHz das Maximum.
+  *
+  * @retval HAL_OK, sobald die Karte in einer funktionierenden Konfiguration ist
+  */
+HAL_StatusTypeDef MX_SDMMC1_TuneBus(void)
+{
+  uint32_t startDiv = hsd1.Init.ClockDiv;
+
+  if (SDMMC1_ReadBlocks(SDMMC1_TuneReference, 0, SDMMC1_TUNE_VERIFY_BLOCKS) != HAL_OK)
+  {
+    LOG("SD tuning: reference read failed\r\n");
+    return HAL_ERROR;
+  }
+
+  SDMMC1_Tuning.busWidth = 1;
+#ifdef SDMMC1_TUNE_4BIT
+  if (HAL_SD_ConfigWideBusOperation(&hsd1, SDMMC_BUS_WIDE_4B) == HAL_OK && SDMMC1_Verify())
+  {
+    SDMMC1_Tuning.busWidth = 4;
+  }
+  else
+  {
+    /* D1..D3 nicht verbunden oder gestört: ACMD6 läuft über CMD und funktioniert weiterhin */
+    HAL_SD_ConfigWideBusOperation(&hsd1, SDMMC_BUS_WIDE_1B);
+  }
+#endif
+
+  uint32_t maxHz = 25000000U;
+  SDMMC1_Tuning.highSpeed = 0;
+#ifdef SDMMC1_TUNE_HIGH_SPEED
+  if (HAL_SD_ConfigSpeedBusOperation(&hsd1, SDMMC_SPEED_MODE_HIGH) == HAL_OK && SDMMC1_Verify())
+  {
+    SDMMC1_Tuning.highSpeed = 1;
+    maxHz = 50000000U;
+  }
+#endif
+
+  /* Vom schnellsten Teiler aus abwärts, bis das Read-Verify besteht */
+  static const uint32_t dividers[] = {0, 1, 2, 3, 4, 6, 8};
+  uint32_t chosenDiv = startDiv;
+  for (uint32_t i = 0; i < sizeof(dividers) / sizeof(dividers[0]); i++)
+  {
+    if (dividers[i] >= startDiv) break;
+    uint32_t hz = SDMMC1_SetClockDiv(dividers[i]);
+    if (hz > maxHz) continue;
+    if (SDMMC1_Verify())
+    {
+      chosenDiv = dividers[i];
+      break;
+    }
+  }
+  SDMMC1_Tuning.clockDiv = chosenDiv;
+  SDMMC1_Tuning.clockHz = SDMMC1_SetClockDiv(chosenDiv);
+
+  /* Bandbreite: SDMMC1_TUNE_BENCH_BLOCKS Sektoren in Multi-Block-Reads */
+  uint32_t start = HAL_GetTick();
+  for (uint32_t block = 0; block < SDMMC1_TUNE_BENCH_BLOCKS; block += SDMMC1_TUNE_VERIFY_BLOCKS)
+  {
+    if (SDMMC1_ReadBlocks(SDMMC1_TuneBuffer, block, SDMMC1_TUNE_VERIFY_BLOCKS) != HAL_OK) break;
+  }
+  uint32_t elapsed = HAL_GetTick() - start;
+  if (elapsed == 0) elapsed = 1;
+  SDMMC1_Tuning.bandwidthKBs = (SDMMC1_TUNE_BENCH_BLOCKS / 2U) * 1000U / elapsed;
+
+  LOG("SD bus: %u-bit, %s, %lu kHz, %lu KB/s\r\n", SDMMC1_Tuning.busWidth,
+      SDMMC1_Tuning.highSpeed ? "high speed" : "default speed",
+      SDMMC1_Tuning.clockHz / 1000U, SDMMC1_Tuning.bandwidthKBs);
+
+  SDMMC1_WarmState warm;
+  warm.tuning = SDMMC1_Tuning;
+  warm.card = hsd1.SdCard;
+  memcpy(warm.cid, hsd1.CID, sizeof(warm.cid));
+  memcpy(warm.csd, hsd1.CSD, sizeof(warm.csd));
+  WarmBoot_Save(WARMBOOT_ITEM_SD, &warm, sizeof(warm));
+  return HAL_OK;
+}
+
+/**
+  * @brief  Warmstart: die noch ausgewählte Karte ohne Identifikation und Tuning übernehmen.
+  *
+  * Ein Software-Reset setzt nur den SDMMC1 zurück, die Karte bleibt versorgt, im Transfer-Zustand
+  * und im ausgehandelten Busmodus. Mit dem geretteten Busmodus und den Kartendaten (RCA, CSD, CID)
+  * genügen CMD13 und ein Testsektor; die 74 Takte, ACMD41 und das Tuning aus MX_SDMMC1_TuneBus()
+  * entfallen. Nur einmal je Start, jeder weitere BSP_SD_Init() (Kartenwechsel) initialisiert voll.
+  *
+  * @retval HAL_OK, wenn die Karte übernommen wurde, sonst HAL_ERROR (dann HAL_SD_Init() aufrufen)
+  */
+HAL_StatusTypeDef MX_SDMMC1_Resume(void)
+{
+  SDMMC1_WarmState warm;
+  SD_InitTypeDef cold = hsd1.Init;
+
+  if (SDMMC1_ResumeTried)
+  {
+    return HAL_ERROR;
+  }
+  SDMMC1_ResumeTried = 1;
+  if (!WarmBoot_Load(WARMBOOT_ITEM_SD, &warm, sizeof(warm)))
+  {
+    return HAL_ERROR;
+  }
+
+  if (hsd1.State == HAL_SD_STATE_RESET)
+  {
+    hsd1.Lock = HAL_UNLOCKED;
+    HAL_SD_MspInit(&hsd1);
+  }
+  hsd1.Init.BusWide = (warm.tuning.busWidth == 4U) ? SDMMC_BUS_WIDE_4B : SDMMC_BUS_WIDE_1B;
+  hsd1.Init.ClockDiv = warm.tuning.clockDiv;
+  (void)SDMMC_Init(hsd1.Instance, hsd1.Init);
+  (void)SDMMC_PowerState_ON(hsd1.Instance);
+
+  hsd1.SdCard = warm.card;
+  memcpy(hsd1.CID, warm.cid, sizeof(hsd1.CID));
+  memcpy(hsd1.CSD, warm.csd, sizeof(hsd1.CSD));
+  hsd1.ErrorCode = HAL_SD_ERROR_NONE;
+  hsd1.Context = SD_CONTEXT_NONE;
+  hsd1.State = HAL_SD_STATE_READY;
+
+  /* Reset mitten in einem Transfer: CMD12 bringt die Karte in den Transfer-Zustand zurück */
+  HAL_SD_CardStateTypeDef state = HAL_SD_GetCardState(&hsd1);
+  if (state == HAL_SD_CARD_SENDING || state == HAL_SD_CARD_RECEIVING)
+  {
+    (void)SDMMC_CmdStopTransfer(hsd1.Instance);
+    state = HAL_SD_GetCardState(&hsd1);
+  }
+  if (state != HAL_SD_CARD_TRANSFER || SDMMC1_ReadBlocks(SDMMC1_TuneBuffer, 0, 1) != HAL_OK)
+  {
+    LOG("SD resume: card state %u, full init\r\n", (unsigned)state);
+    WarmBoot_Invalidate(WARMBOOT_ITEM_SD);
+    __HAL_SD_CLEAR_FLAG(&hsd1, SDMMC_STATIC_FLAGS);
+    hsd1.Init = cold;
+    hsd1.ErrorCode = HAL_SD_ERROR_NONE;
+    return HAL_ERROR;
+  }
+
+  SDMMC1_Tuning = warm.tuning;
+  LOG("SD bus: %u-bit, %s, %lu kHz (warm)\r\n", SDMMC1_Tuning.busWidth,
+      SDMMC1_Tuning.highSpeed ? "high speed" : "default speed", SDMMC1_Tuning.clockHz / 1000U);
+  return HAL_OK;
+}
+
+/**
+  * @brief  Initializes the SD card device (overrides the weak version in bsp_driver_sd.c)
+  *
+  * Warm start: the card is still selected in the tuned bus mode (MX_SDMMC1_Resume()).
+  * Otherwise HAL_SD_Init() and the bus tuning: 4-bit wide bus, high speed and fastest
+  * verified clock divider (MX_SDMMC1_TuneBus()).
+  * @retval SD status
+  */
+uint8_t BSP_SD_Init(void)
+{
+  uint8_t sd_state = MSD_OK;
+  /* Check if the SD card is plugged in the slot */
+  if (BSP_SD_IsDetected() != SD_PRESENT)
+  {
+    return MSD_ERROR_SD_NOT_PRESENT;
+  }
+  if (MX_SDMMC1_Resume() == HAL_OK)
+  {
+    return MSD_OK;
+  }
+  /* HAL SD initialization */
+  sd_state = HAL_SD_Init(&hsd1);
+  if (sd_state == MSD_OK)
+  {
+    if (MX_SDMMC1_TuneBus() != HAL_OK)
+    {
+      sd_state = MSD_ERROR;
+    }
+  }
+
+  return sd_state;
+}
+
 /* USER CODE END 1 */
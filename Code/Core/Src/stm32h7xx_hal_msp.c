@@ -72,6 +72,11 @@ void HAL_MspInit(void)
   /* System interrupt init*/
 
   /* USER CODE BEGIN MspInit 1 */
+  // AHB SRAM1/2 (RAM_CD) holds the non-cacheable .dma_buffer section
+  __HAL_RCC_AHBSRAM1_CLK_ENABLE();
+  __HAL_RCC_AHBSRAM2_CLK_ENABLE();
+  // SRD SRAM (RAM_SRD) holds the .bdma_buffer section for BDMA2
+  __HAL_RCC_SRDSRAM_CLK_ENABLE();
 
   /* USER CODE END MspInit 1 */
 }
@@ -22,6 +22,8 @@
 #include "stm32h7xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "Irq.h"
+#include "WarmBoot.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -56,11 +58,19 @@
 
 /* External variables --------------------------------------------------------*/
 extern ADC_HandleTypeDef hadc1;
+extern FDCAN_HandleTypeDef hfdcan1;
+extern I2C_HandleTypeDef hi2c1;
+extern I2C_HandleTypeDef hi2c2;
+extern OSPI_HandleTypeDef hospi1;
 extern SD_HandleTypeDef hsd1;
-extern DMA_HandleTypeDef hdma_tim1_ch1;
+extern SPI_HandleTypeDef hspi1;
+extern SPI_HandleTypeDef hspi4;
 extern TIM_HandleTypeDef htim1;
 extern TIM_HandleTypeDef htim6;
 extern TIM_HandleTypeDef htim7;
+extern UART_HandleTypeDef hlpuart1;
+extern UART_HandleTypeDef huart4;
+extern UART_HandleTypeDef huart7;
 /* USER CODE BEGIN EV */
 
 /* USER CODE END EV */
@@ -89,7 +99,8 @@ void NMI_Handler(void)
 void HardFault_Handler(void)
 {
   /* USER CODE BEGIN HardFault_IRQn 0 */
-
+  // Software reset instead of hanging; stays here with a debugger attached
+  WarmBoot_Fault(WARMBOOT_FAULT_HARD);
   /* USER CODE END HardFault_IRQn 0 */
   while (1)
   {
@@ -209,25 +220,39 @@ void SysTick_Handler(void)
 void ADC_IRQHandler(void)
 {
   /* USER CODE BEGIN ADC_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_ADC);
   /* USER CODE END ADC_IRQn 0 */
   HAL_ADC_IRQHandler(&hadc1);
   /* USER CODE BEGIN ADC_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_ADC);
   /* USER CODE END ADC_IRQn 1 */
 }
 
+/**
+  * @brief This function handles FDCAN1 interrupt 0.
+  */
+void FDCAN1_IT0_IRQHandler(void)
+{
+  /* USER CODE BEGIN FDCAN1_IT0_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_FDCAN1);
+  /* USER CODE END FDCAN1_IT0_IRQn 0 */
+  HAL_FDCAN_IRQHandler(&hfdcan1);
+  /* USER CODE BEGIN FDCAN1_IT0_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_FDCAN1);
+  /* USER CODE END FDCAN1_IT0_IRQn 1 */
+}
+
 /**
   * @brief This function handles EXTI line[9:5] interrupts.
   */
 void EXTI9_5_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI9_5_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_EXTI);
   /* USER CODE END EXTI9_5_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(MDS_RIGHT_Pin);
   /* USER CODE BEGIN EXTI9_5_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_EXTI);
   /* USER CODE END EXTI9_5_IRQn 1 */
 }
 
@@ -237,11 +262,11 @@ void EXTI9_5_IRQHandler(void)
 void TIM1_BRK_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_BRK_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_TIM1);
   /* USER CODE END TIM1_BRK_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_BRK_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_TIM1);
   /* USER CODE END TIM1_BRK_IRQn 1 */
 }
 
@@ -251,11 +276,11 @@ void TIM1_BRK_IRQHandler(void)
 void TIM1_UP_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_UP_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_TIM1);
   /* USER CODE END TIM1_UP_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_UP_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_TIM1);
   /* USER CODE END TIM1_UP_IRQn 1 */
 }
 
@@ -265,11 +290,11 @@ void TIM1_UP_IRQHandler(void)
 void TIM1_TRG_COM_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_TRG_COM_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_TIM1);
   /* USER CODE END TIM1_TRG_COM_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_TRG_COM_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_TIM1);
   /* USER CODE END TIM1_TRG_COM_IRQn 1 */
 }
 
@@ -279,28 +304,99 @@ void TIM1_TRG_COM_IRQHandler(void)
 void TIM1_CC_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_CC_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_TIM1);
   /* USER CODE END TIM1_CC_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_CC_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_TIM1);
   /* USER CODE END TIM1_CC_IRQn 1 */
 }
 
+/**
+  * @brief This function handles I2C1 event interrupt.
+  */
+void I2C1_EV_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C1_EV_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_I2C1);
+  /* USER CODE END I2C1_EV_IRQn 0 */
+  HAL_I2C_EV_IRQHandler(&hi2c1);
+  /* USER CODE BEGIN I2C1_EV_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_I2C1);
+  /* USER CODE END I2C1_EV_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C1 error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C1_ER_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_I2C1);
+  /* USER CODE END I2C1_ER_IRQn 0 */
+  HAL_I2C_ER_IRQHandler(&hi2c1);
+  /* USER CODE BEGIN I2C1_ER_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_I2C1);
+  /* USER CODE END I2C1_ER_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C2 event interrupt.
+  */
+void I2C2_EV_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C2_EV_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_I2C2);
+  /* USER CODE END I2C2_EV_IRQn 0 */
+  HAL_I2C_EV_IRQHandler(&hi2c2);
+  /* USER CODE BEGIN I2C2_EV_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_I2C2);
+  /* USER CODE END I2C2_EV_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C2 error interrupt.
+  */
+void I2C2_ER_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C2_ER_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_I2C2);
+  /* USER CODE END I2C2_ER_IRQn 0 */
+  HAL_I2C_ER_IRQHandler(&hi2c2);
+  /* USER CODE BEGIN I2C2_ER_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_I2C2);
+  /* USER CODE END I2C2_ER_IRQn 1 */
+}
+
+/**
+  * @brief This function handles SPI1 global interrupt.
+  */
+void SPI1_IRQHandler(void)
+{
+  /* USER CODE BEGIN SPI1_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_SPI1);
+  /* USER CODE END SPI1_IRQn 0 */
+  HAL_SPI_IRQHandler(&hspi1);
+  /* USER CODE BEGIN SPI1_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_SPI1);
+  /* USER CODE END SPI1_IRQn 1 */
+}
+
 /**
   * @brief This function handles EXTI line[15:10] interrupts.
   */
 void EXTI15_10_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI15_10_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_EXTI);
   /* USER CODE END EXTI15_10_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(MDS_DOWN_Pin);
+  HAL_GPIO_EXTI_IRQHandler(DISPLAY_TE_Pin);
   HAL_GPIO_EXTI_IRQHandler(USER_BUTTON_Pin);
   HAL_GPIO_EXTI_IRQHandler(MDS_BUTTON_Pin);
   HAL_GPIO_EXTI_IRQHandler(MDS_UP_Pin);
   /* USER CODE BEGIN EXTI15_10_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_EXTI);
   /* USER CODE END EXTI15_10_IRQn 1 */
 }
 
@@ -310,25 +406,39 @@ void EXTI15_10_IRQHandler(void)
 void SDMMC1_IRQHandler(void)
 {
   /* USER CODE BEGIN SDMMC1_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_SDMMC1);
   /* USER CODE END SDMMC1_IRQn 0 */
   HAL_SD_IRQHandler(&hsd1);
   /* USER CODE BEGIN SDMMC1_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_SDMMC1);
   /* USER CODE END SDMMC1_IRQn 1 */
 }
 
+/**
+  * @brief This function handles UART4 global interrupt.
+  */
+void UART4_IRQHandler(void)
+{
+  /* USER CODE BEGIN UART4_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_UART4);
+  /* USER CODE END UART4_IRQn 0 */
+  HAL_UART_IRQHandler(&huart4);
+  /* USER CODE BEGIN UART4_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_UART4);
+  /* USER CODE END UART4_IRQn 1 */
+}
+
 /**
   * @brief This function handles TIM6 global interrupt, DAC1_CH1 and DAC1_CH2 underrun error interrupts.
   */
 void TIM6_DAC_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM6_DAC_IRQn 0 */
-
+  IRQ_ENTER(IRQ_ID_TIM6);
   /* USER CODE END TIM6_DAC_IRQn 0 */
   HAL_TIM_IRQHandler(&htim6);
   /* USER CODE BEGIN TIM6_DAC_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_TIM6);
   /* USER CODE END TIM6_DAC_IRQn 1 */
 }
 
@@ -338,28 +448,73 @@ void TIM6_DAC_IRQHandler(void)
 void TIM7_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM7_IRQn 0 */
-
+  Irq_RecordTickLatency();
+  IRQ_ENTER(IRQ_ID_TIM7);
   /* USER CODE END TIM7_IRQn 0 */
   HAL_TIM_IRQHandler(&htim7);
   /* USER CODE BEGIN TIM7_IRQn 1 */
-
+  IRQ_EXIT(IRQ_ID_TIM7);
   /* USER CODE END TIM7_IRQn 1 */
 }
 
 /**
-  * @brief This function handles DMA2 stream7 global interrupt.
+  * @brief This function handles UART7 global interrupt.
   */
-void DMA2_Stream7_IRQHandler(void)
+void UART7_IRQHandler(void)
 {
-  /* USER CODE BEGIN DMA2_Stream7_IRQn 0 */
+  /* USER CODE BEGIN UART7_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_UART7);
+  /* USER CODE END UART7_IRQn 0 */
+  HAL_UART_IRQHandler(&huart7);
+  /* USER CODE BEGIN UART7_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_UART7);
+  /* USER CODE END UART7_IRQn 1 */
+}
 
-  /* USER CODE END DMA2_Stream7_IRQn 0 */
-  HAL_DMA_IRQHandler(&hdma_tim1_ch1);
-  /* USER CODE BEGIN DMA2_Stream7_IRQn 1 */
+/**
+  * @brief This function handles SPI4 global interrupt.
+  */
+void SPI4_IRQHandler(void)
+{
+  /* USER CODE BEGIN SPI4_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_SPI4);
+  /* USER CODE END SPI4_IRQn 0 */
+  HAL_SPI_IRQHandler(&hspi4);
+  /* USER CODE BEGIN SPI4_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_SPI4);
+  /* USER CODE END SPI4_IRQn 1 */
+}
 
-  /* USER CODE END DMA2_Stream7_IRQn 1 */
+/**
+  * @brief This function handles OCTOSPI1 global interrupt.
+  */
+void OCTOSPI1_IRQHandler(void)
+{
+  /* USER CODE BEGIN OCTOSPI1_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_OCTOSPI1);
+  /* USER CODE END OCTOSPI1_IRQn 0 */
+  HAL_OSPI_IRQHandler(&hospi1);
+  /* USER CODE BEGIN OCTOSPI1_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_OCTOSPI1);
+  /* USER CODE END OCTOSPI1_IRQn 1 */
+}
+
+/**
+  * @brief This function handles LPUART1 global interrupt.
+  */
+void LPUART1_IRQHandler(void)
+{
+  /* USER CODE BEGIN LPUART1_IRQn 0 */
+  IRQ_ENTER(IRQ_ID_LPUART1);
+  /* USER CODE END LPUART1_IRQn 0 */
+  HAL_UART_IRQHandler(&hlpuart1);
+  /* USER CODE BEGIN LPUART1_IRQn 1 */
+  IRQ_EXIT(IRQ_ID_LPUART1);
+  /* USER CODE END LPUART1_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
 
+/* DMA1/DMA2/BDMA2 streams and MDMA: generation disabled in the .ioc, see DmaAlloc.c */
+
 /* USER CODE END 1 */
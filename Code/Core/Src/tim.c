@@ -21,10 +21,13 @@
 #include "tim.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "Realtime.h"
+#include "WS2812.h"
+#include "adc.h"
 /* USER CODE END 0 */
 
 TIM_HandleTypeDef htim1;
+TIM_HandleTypeDef htim3;
 TIM_HandleTypeDef htim6;
 TIM_HandleTypeDef htim7;
 DMA_HandleTypeDef hdma_tim1_ch1;
@@ -103,10 +106,58 @@ void MX_TIM1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN TIM1_Init 2 */
-
+  // Pulsbreiten und Bit-Tabelle der WS2812 passend zum neuen ARR
+  WS2812_Init();
   /* USER CODE END TIM1_Init 2 */
   HAL_TIM_MspPostInit(&htim1);
 
+}
+/* TIM3 init function */
+void MX_TIM3_Init(void)
+{
+
+  /* USER CODE BEGIN TIM3_Init 0 */
+
+  /* USER CODE END TIM3_Init 0 */
+
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /* USER CODE BEGIN TIM3_Init 1 */
+  // TIM3 hängt an APB1; bei einem APB1-Teiler > 1 laufen die Timer mit doppeltem PCLK1
+  uint32_t timer_clock_hz = HAL_RCC_GetPCLK1Freq() * ((RCC->CDCFGR2 & RCC_CDCFGR2_CDPPRE1) == 0 ? 1 : 2);
+
+  // Zähler auf ADC_TRIGGER_COUNTER_HZ, jedes Update (TRGO) startet einen Scan von ADC1
+  uint32_t prescaler = timer_clock_hz / ADC_TRIGGER_COUNTER_HZ;
+  uint32_t arr = ADC_TRIGGER_COUNTER_HZ / ADC_SCAN_HZ - 1;
+
+  uint16_t TIM3_ARR = arr, TIM3_PRESCALER = prescaler - 1;
+  /* USER CODE END TIM3_Init 1 */
+  htim3.Instance = TIM3;
+  htim3.Init.Prescaler = TIM3_PRESCALER;
+  htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim3.Init.Period = TIM3_ARR;
+  htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim3, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN TIM3_Init 2 */
+
+  /* USER CODE END TIM3_Init 2 */
+
 }
 /* TIM6 init function */
 void MX_TIM6_Init(void)
@@ -171,20 +222,13 @@ uint8_t CDPPRE1 = (RCC->CDCFGR2 & (0b111<<6))>>6;
 // unverändert (Faktor 1) oder verdoppelt (Faktor 2) verwendet
 uint32_t timer_clock_hz = HAL_RCC_GetPCLK1Freq() * (CDPPRE1 == 0 ? 1 : 2);
 
-// Definiere die Zielfrequenz des Timers auf 1 kHz, was einer Periode von 1 ms entspricht
-uint32_t desired_freq = 1000; // 1kHz = 1ms Periode
-
-// Berechne die Gesamtzahl der Timer-Takte, die für eine 1ms-Periode benötigt werden
-uint32_t total_cycles = timer_clock_hz / desired_freq;
+// Der Vorteiler bringt den Zähler auf REALTIME_COUNTER_HZ (1 MHz). Eine 1ms-Periode
+// sind damit REALTIME_COUNTS_PER_MS Zählschritte, und im Tickless-Betrieb
+// (Realtime_Sleep) reicht das 16-Bit-ARR für bis zu REALTIME_TICKLESS_MAX_MS am Stück
+uint32_t prescaler = timer_clock_hz / REALTIME_COUNTER_HZ;
 
-// Teile diese Gesamtzahl durch den maximalen Wert des Auto-Reload-Registers (0xFFFF),
-// um den benötigten Vorteiler (Prescaler) zu berechnen.
-uint32_t prescaler = (total_cycles / 0xFFFF)+1;  // Durch max ARR-Wert teilen
-
-// Berechne den Wert für das Auto-Reload-Register (ARR) basierend auf
-// der Gesamtzahl der Takte dividiert durch den Vorteiler, minus 1
-// (Timer zählt von 0 bis ARR)
-uint32_t arr = (total_cycles / prescaler) - 1;
+// ARR für eine 1ms-Periode (Timer zählt von 0 bis ARR)
+uint32_t arr = REALTIME_COUNTS_PER_MS - 1;
 
 // Speichere die berechneten Werte für die Timer-Konfiguration in lokalen Variablen
 uint16_t TIM7_ARR = arr, TIM7_PRESCALER = prescaler-1;
@@ -232,8 +276,8 @@ void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef* tim_pwmHandle)
     hdma_tim1_ch1.Init.MemInc = DMA_MINC_ENABLE;
     hdma_tim1_ch1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
     hdma_tim1_ch1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
-    hdma_tim1_ch1.Init.Mode = DMA_NORMAL;
-    hdma_tim1_ch1.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_tim1_ch1.Init.Mode = DMA_CIRCULAR;
+    hdma_tim1_ch1.Init.Priority = DMA_PRIORITY_HIGH;
     hdma_tim1_ch1.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     if (HAL_DMA_Init(&hdma_tim1_ch1) != HAL_OK)
     {
@@ -260,7 +304,18 @@ void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef* tim_pwmHandle)
 void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* tim_baseHandle)
 {
 
-  if(tim_baseHandle->Instance==TIM6)
+  if(tim_baseHandle->Instance==TIM3)
+  {
+  /* USER CODE BEGIN TIM3_MspInit 0 */
+
+  /* USER CODE END TIM3_MspInit 0 */
+    /* TIM3 clock enable */
+    __HAL_RCC_TIM3_CLK_ENABLE();
+  /* USER CODE BEGIN TIM3_MspInit 1 */
+
+  /* USER CODE END TIM3_MspInit 1 */
+  }
+  else if(tim_baseHandle->Instance==TIM6)
   {
   /* USER CODE BEGIN TIM6_MspInit 0 */
 
@@ -347,7 +402,18 @@ void HAL_TIM_PWM_MspDeInit(TIM_HandleTypeDef* tim_pwmHandle)
 void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef* tim_baseHandle)
 {
 
-  if(tim_baseHandle->Instance==TIM6)
+  if(tim_baseHandle->Instance==TIM3)
+  {
+  /* USER CODE BEGIN TIM3_MspDeInit 0 */
+
+  /* USER CODE END TIM3_MspDeInit 0 */
+    /* Peripheral clock disable */
+    __HAL_RCC_TIM3_CLK_DISABLE();
+  /* USER CODE BEGIN TIM3_MspDeInit 1 */
+
+  /* USER CODE END TIM3_MspDeInit 1 */
+  }
+  else if(tim_baseHandle->Instance==TIM6)
   {
   /* USER CODE BEGIN TIM6_MspDeInit 0 */
 
@@ -43,6 +43,20 @@ defined in linker script */
 .word  _sbss
 /* end address for the .bss section. defined in linker script */
 .word  _ebss
+/* start address for the initialization values of the .itcm_text section.
+defined in linker script */
+.word  _siitcm
+/* start address for the .itcm_text section. defined in linker script */
+.word  _sitcm
+/* end address for the .itcm_text section. defined in linker script */
+.word  _eitcm
+/* start address for the initialization values of the .dtcm_data section.
+defined in linker script */
+.word  _sidtcm
+/* start address for the .dtcm_data section. defined in linker script */
+.word  _sdtcm
+/* end address for the .dtcm_data section. defined in linker script */
+.word  _edtcm
 /* stack used for SystemInit_ExtMemCtl; always internal RAM used */
 
 /**
@@ -81,6 +95,40 @@ LoopCopyDataInit:
   adds r4, r0, r3
   cmp r4, r1
   bcc CopyDataInit
+/* Copy the ITCM code (RAMFUNC, interrupt handlers) from flash to ITCM */
+  ldr r0, =_sitcm
+  ldr r1, =_eitcm
+  ldr r2, =_siitcm
+  movs r3, #0
+  b LoopCopyItcmInit
+
+CopyItcmInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyItcmInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyItcmInit
+
+/* Copy the DTCM data (FASTDATA) initializers from flash to DTCM */
+  ldr r0, =_sdtcm
+  ldr r1, =_edtcm
+  ldr r2, =_sidtcm
+  movs r3, #0
+  b LoopCopyDtcmInit
+
+CopyDtcmInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyDtcmInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyDtcmInit
+
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
   ldr r4, =_ebss
@@ -24,7 +24,14 @@ FATFS SDFatFS;    /* File system object for SD logical drive */
 FIL SDFile;       /* File object for SD */
 
 /* USER CODE BEGIN Variables */
+uint8_t retW25Qxx;    /* Return value for W25Qxx */
+char W25QxxPath[4];   /* W25Qxx logical drive path ("1:/") */
+FATFS W25QxxFatFS __attribute__((aligned(32)));    /* File system object for W25Qxx logical drive */
+BYTE W25QxxWork[_MAX_SS];   /* Work area for f_mkfs, also used by FATFS_MountRam() */
 
+uint8_t retRamDisk;    /* Return value for the RAM disk */
+char RamDiskPath[4];   /* RAM disk logical drive path ("2:/") */
+FATFS RamDiskFatFS __attribute__((aligned(32)));    /* File system object for the RAM disk */
 /* USER CODE END Variables */
 
 void MX_FATFS_Init(void)
@@ -34,6 +41,11 @@ void MX_FATFS_Init(void)
 
   /* USER CODE BEGIN Init */
   /* additional user code for init */
+  /*## FatFS: Link the W25Qxx QSPI flash driver as the second volume ######*/
+  retW25Qxx = FATFS_LinkDriver(&W25Qxx_Driver, W25QxxPath);
+
+  /*## FatFS: Link the RAM disk in the spare RAM_CD as the third volume ######*/
+  retRamDisk = FATFS_LinkDriver(&RamDisk_Driver, RamDiskPath);
   /* USER CODE END Init */
 }
 
@@ -51,4 +63,48 @@ DWORD get_fattime(void)
 
 /* USER CODE BEGIN Application */
 
+/**
+  * @brief  Mounts the W25Qxx flash volume
+  * @param  format: 1 = create a FAT volume (4 KB clusters, one per erase sector) if none exists
+  * @retval FRESULT of the mount or of f_mkfs
+  */
+FRESULT FATFS_MountFlash(uint8_t format)
+{
+  FRESULT res = f_mount(&W25QxxFatFS, W25QxxPath, 1);
+
+  if (res == FR_NO_FILESYSTEM && format)
+  {
+    res = f_mkfs(W25QxxPath, FM_FAT | FM_SFD, W25QXX_DISK_ERASE_SIZE, W25QxxWork, sizeof(W25QxxWork));
+    if (res == FR_OK)
+    {
+      res = f_mount(&W25QxxFatFS, W25QxxPath, 1);
+    }
+  }
+
+  return res;
+}
+
+/**
+  * @brief  Creates an empty FAT volume on the RAM disk and mounts it (contents do not survive a reset)
+  * @retval FRESULT of f_mkfs or the mount, FR_NOT_READY if the spare RAM_CD is too small
+  */
+FRESULT FATFS_MountRam(void)
+{
+  FRESULT res;
+
+  if (RamDisk_GetSectorCount() < RAMDISK_MIN_SECTORS)
+  {
+    return FR_NOT_READY;
+  }
+
+  /* One sector per cluster: temp files are small, and there is no erase block to match */
+  res = f_mkfs(RamDiskPath, FM_FAT | FM_SFD, RAMDISK_SECTOR_SIZE, W25QxxWork, sizeof(W25QxxWork));
+  if (res == FR_OK)
+  {
+    res = f_mount(&RamDiskFatFS, RamDiskPath, 1);
+  }
+
+  return res;
+}
+
 /* USER CODE END Application */
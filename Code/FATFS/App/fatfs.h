@@ -28,7 +28,8 @@
 #include "sd_diskio.h" /* defines SD_Driver as external */
 
 /* USER CODE BEGIN Includes */
-
+#include "w25qxx_diskio.h" /* defines W25Qxx_Driver as external */
+#include "ramdisk_diskio.h" /* defines RamDisk_Driver as external */
 /* USER CODE END Includes */
 
 extern uint8_t retSD; /* Return value for SD */
@@ -39,7 +40,17 @@ extern FIL SDFile; /* File object for SD */
 void MX_FATFS_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+extern uint8_t retW25Qxx; /* Return value for W25Qxx */
+extern char W25QxxPath[4]; /* W25Qxx logical drive path */
+extern FATFS W25QxxFatFS; /* File system object for W25Qxx logical drive */
+
+FRESULT FATFS_MountFlash(uint8_t format);
+
+extern uint8_t retRamDisk; /* Return value for the RAM disk */
+extern char RamDiskPath[4]; /* RAM disk logical drive path */
+extern FATFS RamDiskFatFS; /* File system object for the RAM disk */
 
+FRESULT FATFS_MountRam(void);
 /* USER CODE END Prototypes */
 #ifdef __cplusplus
 }
@@ -0,0 +1,19 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef __FFCONF_EXT_H
+#define __FFCONF_EXT_H
+
+/* Projekterweiterungen von FatFs, die CubeMX nicht kennt. ffconf.h wird generiert, deshalb
+   stehen sie hier und ff.c bindet die Datei nach ff.h ein. */
+
+#define _USE_DIRCACHE        1
+#define _DIRCACHE_ENTRIES    16
+#define _DIRCACHE_PATH_MAX   48
+/* Project extension, not in the FatFs release: f_open() for reading remembers where
+/  the directory entry of each path lies and checks that entry again instead of
+/  searching the directories. _DIRCACHE_ENTRIES paths up to _DIRCACHE_PATH_MAX - 1
+/  characters (without drive) are kept, FAT12/16/32 only. (0:Disable or 1:Enable) */
+
+#endif /* __FFCONF_EXT_H */
@@ -0,0 +1,208 @@
+/**
+ * @file    ramdisk_diskio.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   FatFs-Laufwerk im RAM (Laufwerk "2:") für Zwischendateien von Dekodern und Screenshots
+ *
+ * Auf der SD-Karte kostet jeder Sektor rund 1 ms und Verschleiß, für Dateien, die nur
+ * während eines Vorgangs leben, ist das verschenkt. Das Laufwerk belegt, was in RAM_CD
+ * hinter den DMA-Puffern frei bleibt: das Linkerskript legt .ramdisk bis zum Ende des
+ * Speichers an, die Größe ergibt sich also erst beim Linken. RAM_CD ist nicht gecacht
+ * (MPU-Region 2), Lesen und Schreiben sind ein memcpy, GET_BLOCK_SIZE ist 1 Sektor.
+ *
+ * Ohne Kopie geht es über RamDisk_Map() bzw. RamDisk_MapFile(): eine mit f_expand()
+ * zusammenhängend angelegte Datei liegt am Stück im Speicher, ein Dekoder liest sie dann
+ * direkt statt über f_read(). Der Inhalt überlebt keinen Neustart, FATFS_MountRam()
+ * formatiert das Laufwerk bei jedem Start.
+ */
+
+#include "ramdisk_diskio.h"
+#include <string.h>
+
+/* From the linker script: start and end of the spare RAM_CD */
+extern uint8_t _sramdisk[];
+extern uint8_t _eramdisk[];
+
+/* Linked drivers (ff_gen_drv.c), to recognise volumes on this drive */
+extern Disk_drvTypeDef disk;
+
+/* Disk status */
+static volatile DSTATUS Stat = STA_NOINIT;
+
+DSTATUS RamDisk_initialize (BYTE);
+DSTATUS RamDisk_status (BYTE);
+DRESULT RamDisk_read (BYTE, BYTE*, DWORD, UINT);
+#if _USE_WRITE == 1
+DRESULT RamDisk_write (BYTE, const BYTE*, DWORD, UINT);
+#endif /* _USE_WRITE == 1 */
+#if _USE_IOCTL == 1
+DRESULT RamDisk_ioctl (BYTE, BYTE, void*);
+#endif  /* _USE_IOCTL == 1 */
+
+const Diskio_drvTypeDef  RamDisk_Driver =
+{
+  RamDisk_initialize,
+  RamDisk_status,
+  RamDisk_read,
+#if  _USE_WRITE == 1
+  RamDisk_write,
+#endif /* _USE_WRITE == 1 */
+
+#if  _USE_IOCTL == 1
+  RamDisk_ioctl,
+#endif /* _USE_IOCTL == 1 */
+};
+
+/**
+  * @brief  Number of sectors that fit into the spare RAM_CD
+  */
+DWORD RamDisk_GetSectorCount(void)
+{
+  return (DWORD)(_eramdisk - _sramdisk) / RAMDISK_SECTOR_SIZE;
+}
+
+/**
+  * @brief  Initializes a Drive
+  * @param  lun : not used
+  * @retval DSTATUS: Operation status
+  */
+DSTATUS RamDisk_initialize(BYTE lun)
+{
+  if (RamDisk_GetSectorCount() >= RAMDISK_MIN_SECTORS)
+  {
+    Stat &= ~STA_NOINIT;
+  }
+  return Stat;
+}
+
+/**
+  * @brief  Gets Disk Status
+  * @param  lun : not used
+  * @retval DSTATUS: Operation status
+  */
+DSTATUS RamDisk_status(BYTE lun)
+{
+  return Stat;
+}
+
+/**
+  * @brief  Reads Sector(s)
+  * @param  lun : not used
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT RamDisk_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+  const void *data = RamDisk_Map(sector, count);
+
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+  if (data == NULL) return RES_PARERR;
+
+  memcpy(buff, data, count * RAMDISK_SECTOR_SIZE);
+  return RES_OK;
+}
+
+#if _USE_WRITE == 1
+/**
+  * @brief  Writes Sector(s)
+  * @param  lun : not used
+  * @param  *buff: Data to be written
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to write (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT RamDisk_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+  void *data = (void*)RamDisk_Map(sector, count);
+
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+  if (data == NULL) return RES_PARERR;
+
+  memcpy(data, buff, count * RAMDISK_SECTOR_SIZE);
+  return RES_OK;
+}
+#endif /* _USE_WRITE == 1 */
+
+#if _USE_IOCTL == 1
+/**
+  * @brief  I/O control operation
+  * @param  lun : not used
+  * @param  cmd: Control code
+  * @param  *buff: Buffer to send/receive control data
+  * @retval DRESULT: Operation result
+  */
+DRESULT RamDisk_ioctl(BYTE lun, BYTE cmd, void *buff)
+{
+  DRESULT res = RES_ERROR;
+
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+
+  switch (cmd)
+  {
+  /* Nothing is held back */
+  case CTRL_SYNC :
+    res = RES_OK;
+    break;
+
+  /* Get number of sectors on the disk (DWORD) */
+  case GET_SECTOR_COUNT :
+    *(DWORD*)buff = RamDisk_GetSectorCount();
+    res = RES_OK;
+    break;
+
+  /* Get R/W sector size (WORD) */
+  case GET_SECTOR_SIZE :
+    *(WORD*)buff = RAMDISK_SECTOR_SIZE;
+    res = RES_OK;
+    break;
+
+  /* Get erase block size in unit of sector (DWORD) */
+  case GET_BLOCK_SIZE :
+    *(DWORD*)buff = 1;
+    res = RES_OK;
+    break;
+
+#if _USE_TRIM == 1
+  /* Freed sectors need no treatment */
+  case CTRL_TRIM :
+    res = RES_OK;
+    break;
+#endif /* _USE_TRIM == 1 */
+
+  default:
+    res = RES_PARERR;
+  }
+
+  return res;
+}
+#endif /* _USE_IOCTL == 1 */
+
+/**
+ * @brief  Adresse von Sektoren im RAM, zum Lesen ohne Kopie
+ * @return Zeiger auf den ersten Sektor oder NULL, wenn der Bereich über das Laufwerk hinausgeht
+ */
+const void* RamDisk_Map(DWORD sector, UINT count)
+{
+  if ((uint64_t)sector + count > RamDisk_GetSectorCount()) return NULL;
+  return &_sramdisk[sector * RAMDISK_SECTOR_SIZE];
+}
+
+/**
+ * @brief  Inhalt einer Datei auf "2:" am Stück, wenn sie mit f_expand() angelegt wurde
+ *
+ * Geprüft wird nur, ob die Datei auf diesem Laufwerk liegt und in den Speicher passt; dass
+ * ihre Cluster aufeinander folgen, muss der Aufrufer durch f_expand(..., 1) sicherstellen.
+ * @return Zeiger auf das erste Byte oder NULL
+ */
+const void* RamDisk_MapFile(const FIL *file)
+{
+  const FATFS *fs = file->obj.fs;
+
+  if (fs == NULL || disk.drv[fs->drv] != &RamDisk_Driver || file->obj.sclust < 2) return NULL;
+
+  DWORD sector = fs->database + (file->obj.sclust - 2) * fs->csize;
+  DWORD count = (DWORD)((file->obj.objsize + RAMDISK_SECTOR_SIZE - 1) / RAMDISK_SECTOR_SIZE);
+  return RamDisk_Map(sector, count);
+}
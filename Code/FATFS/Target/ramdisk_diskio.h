@@ -0,0 +1,22 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef __RAMDISK_DISKIO_H
+#define __RAMDISK_DISKIO_H
+
+#include "ff_gen_drv.h"
+
+/* Laufwerk "2:" im freien Rest von RAM_CD hinter den DMA-Puffern (Linkerskript: .ramdisk) */
+#define RAMDISK_SECTOR_SIZE      512
+
+/* Kleinstes Laufwerk, das f_mkfs noch anlegt (128 Sektoren); darunter bleibt "2:" aus */
+#define RAMDISK_MIN_SECTORS      128
+
+extern const Diskio_drvTypeDef RamDisk_Driver;
+
+DWORD RamDisk_GetSectorCount(void);
+const void* RamDisk_Map(DWORD sector, UINT count);
+const void* RamDisk_MapFile(const FIL *file);
+
+#endif /* __RAMDISK_DISKIO_H */
@@ -22,6 +22,25 @@
 
 /* USER CODE BEGIN firstSection */
 /* can be used to modify / undefine following code or add new definitions */
+
+/* Sektoren per IDMA übertragen und auf das Abschluss-Flag aus dem SDMMC-Interrupt warten.
+ * Auskommentieren für die Polling-Variante (HAL_SD_ReadBlocks/WriteBlocks). */
+#define SD_USE_DMA
+
+/* D-Cache um IDMA-Transfers pflegen (Clean vor Write, Invalidate um Read).
+ * Dann müssen Puffer auf 32 Bytes (Cache-Zeile) ausgerichtet sein, sonst nur auf 4 Bytes. */
+#define ENABLE_SD_DMA_CACHE_MAINTENANCE  1
+
+/* Nicht ausgerichtete Puffer (z. B. FATFS.win) über einen ausgerichteten Bounce-Puffer übertragen */
+#define ENABLE_SCRATCH_BUFFER
+
+/* Größe des Bounce-Puffers in Sektoren und Zeitlimit eines IDMA-Transfers in ms */
+#define SD_SCRATCH_SECTORS  8
+#define SD_DMA_TIMEOUT      (30 * 1000)
+
+/* SD_initialize, SD_read, SD_write und SD_ioctl stehen jeweils im USER CODE-Abschnitt davor
+ * (Sektor-Cache, IDMA, ACMD23, AU-Größe). Die generierten Fassungen werden dort per #define
+ * umbenannt und bleiben als reiner Kartenzugriff ohne DMA übrig (SD_*Card). */
 /* USER CODE END firstSection*/
 
 /* Includes ------------------------------------------------------------------*/
@@ -83,6 +102,22 @@ const Diskio_drvTypeDef  SD_Driver =
 
 /* USER CODE BEGIN beforeFunctionSection */
 /* can be used to modify / undefine following code or add new code */
+#include "SDCache.h"
+
+DSTATUS SD_InitializeCard(BYTE lun);
+
+/**
+  * @brief  Initializes a Drive and drops the sector cache
+  * @param  lun : not used
+  * @retval DSTATUS: Operation status
+  */
+DSTATUS SD_initialize(BYTE lun)
+{
+  /* a (re)initialised card may be a different one */
+  SDCache_Invalidate();
+  return SD_InitializeCard(lun);
+}
+#define SD_initialize SD_InitializeCard
 /* USER CODE END beforeFunctionSection */
 
 /* Private functions ---------------------------------------------------------*/
@@ -134,6 +169,210 @@ DSTATUS SD_status(BYTE lun)
 
 /* USER CODE BEGIN beforeReadSection */
 /* can be used to modify previous code / undefine following code / add new code */
+#undef SD_initialize
+
+extern SD_HandleTypeDef hsd1;
+
+#if _USE_WRITE == 1
+/* ACMD23, not in stm32h7xx_ll_sdmmc.h */
+#define SD_CMD_SET_WR_BLK_ERASE_COUNT  23U
+
+/* Multi-block writes announced with ACMD23, see SD_PreErase() */
+static uint32_t SD_PreErases = 0;
+
+/**
+  * @brief  Tells the card how many blocks the next multi-block write brings (SET_WR_BLK_ERASE_COUNT)
+  *
+  * Without it many cards assume a partial write and run read-modify-erase on the whole erase
+  * block; knowing the count they erase just the blocks to be written ahead of the data.
+  * The setting only applies to the next CMD25. A failure is harmless, the write runs as before.
+  * @param  count: Number of blocks of the following write
+  */
+static void SD_PreErase(UINT count)
+{
+  SDMMC_CmdInitTypeDef command = {
+    count, SD_CMD_SET_WR_BLK_ERASE_COUNT, SDMMC_RESPONSE_SHORT, SDMMC_WAIT_NO, SDMMC_CPSM_ENABLE
+  };
+
+  if (count < 2 || hsd1.SdCard.CardType == CARD_SECURED)
+  {
+    return;
+  }
+  if (SDMMC_CmdAppCommand(hsd1.Instance, hsd1.SdCard.RelCardAdd << 16U) != HAL_SD_ERROR_NONE)
+  {
+    return;
+  }
+  (void)SDMMC_SendCommand(hsd1.Instance, &command);
+  if (SDMMC_GetCmdResp1(hsd1.Instance, SD_CMD_SET_WR_BLK_ERASE_COUNT, SDMMC_CMDTIMEOUT) == HAL_SD_ERROR_NONE)
+  {
+    SD_PreErases++;
+  }
+}
+
+/**
+  * @brief  Number of multi-block writes announced with ACMD23 since reset
+  */
+uint32_t SD_GetPreErases(void)
+{
+  return SD_PreErases;
+}
+#endif /* _USE_WRITE == 1 */
+
+#if defined(SD_USE_DMA)
+#include <string.h>
+
+#if (ENABLE_SD_DMA_CACHE_MAINTENANCE == 1)
+#define SD_DMA_ALIGN_MASK  0x1FU
+#else
+#define SD_DMA_ALIGN_MASK  0x03U
+#endif
+
+/* Abschluss-Flags, gesetzt im SDMMC-Interrupt */
+static volatile uint8_t SD_ReadDone = 0;
+static volatile uint8_t SD_WriteDone = 0;
+static volatile uint8_t SD_TransferError = 0;
+
+#if defined(ENABLE_SCRATCH_BUFFER)
+static uint8_t SD_ScratchBuffer[SD_SCRATCH_SECTORS * SD_DEFAULT_BLOCK_SIZE] __attribute__((aligned(32)));
+#endif
+
+/**
+  * @brief  Waits for the completion flag of an IDMA transfer and for the card to return to transfer state
+  * @param  done: Completion flag set from the SDMMC interrupt
+  * @retval DRESULT: Operation result
+  */
+static DRESULT SD_WaitTransfer(volatile uint8_t *done)
+{
+  uint32_t start = HAL_GetTick();
+
+  while (!*done && !SD_TransferError)
+  {
+    if (HAL_GetTick() - start >= SD_DMA_TIMEOUT)
+    {
+      HAL_SD_Abort(&hsd1);
+      return RES_ERROR;
+    }
+  }
+  if (SD_TransferError)
+  {
+    return RES_ERROR;
+  }
+
+  /* after a write the card stays in programming state for a while */
+  start = HAL_GetTick();
+  while (BSP_SD_GetCardState() != SD_TRANSFER_OK)
+  {
+    if (HAL_GetTick() - start >= SD_DMA_TIMEOUT)
+    {
+      return RES_ERROR;
+    }
+  }
+  return RES_OK;
+}
+
+/**
+  * @brief  Reads sectors by IDMA into an aligned buffer
+  * @retval DRESULT: Operation result
+  */
+static DRESULT SD_ReadBlocksDMA(BYTE *buff, DWORD sector, UINT count)
+{
+  DRESULT res;
+
+#if (ENABLE_SD_DMA_CACHE_MAINTENANCE == 1)
+  /* no dirty line may be evicted over the DMA data */
+  SCB_InvalidateDCache_by_Addr((uint32_t*)buff, count * SD_DEFAULT_BLOCK_SIZE);
+#endif
+
+  SD_ReadDone = 0;
+  SD_TransferError = 0;
+  if (BSP_SD_ReadBlocks_DMA((uint32_t*)buff, (uint32_t)sector, count) != MSD_OK)
+  {
+    return RES_ERROR;
+  }
+  res = SD_WaitTransfer(&SD_ReadDone);
+
+#if (ENABLE_SD_DMA_CACHE_MAINTENANCE == 1)
+  /* drop lines fetched speculatively during the transfer */
+  SCB_InvalidateDCache_by_Addr((uint32_t*)buff, count * SD_DEFAULT_BLOCK_SIZE);
+#endif
+  return res;
+}
+
+#if _USE_WRITE == 1
+/**
+  * @brief  Writes sectors by IDMA from an aligned buffer
+  * @retval DRESULT: Operation result
+  */
+static DRESULT SD_WriteBlocksDMA(const BYTE *buff, DWORD sector, UINT count)
+{
+#if (ENABLE_SD_DMA_CACHE_MAINTENANCE == 1)
+  SCB_CleanDCache_by_Addr((uint32_t*)buff, count * SD_DEFAULT_BLOCK_SIZE);
+#endif
+
+  SD_PreErase(count);
+  SD_WriteDone = 0;
+  SD_TransferError = 0;
+  if (BSP_SD_WriteBlocks_DMA((uint32_t*)buff, (uint32_t)sector, count) != MSD_OK)
+  {
+    return RES_ERROR;
+  }
+  return SD_WaitTransfer(&SD_WriteDone);
+}
+#endif /* _USE_WRITE == 1 */
+#endif /* SD_USE_DMA */
+
+DRESULT SD_ReadCard(BYTE lun, BYTE *buff, DWORD sector, UINT count);
+
+/**
+  * @brief  Reads Sector(s)
+  * @param  lun : not used
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+  /* FAT, directory and small file reads go through the sector cache */
+  return SDCache_Read(buff, sector, count);
+}
+
+/**
+  * @brief  Reads Sector(s) from the card, bypassing the sector cache
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_ReadSectors(BYTE *buff, DWORD sector, UINT count)
+{
+#if defined(SD_USE_DMA)
+  if (((uintptr_t)buff & SD_DMA_ALIGN_MASK) == 0)
+  {
+    return SD_ReadBlocksDMA(buff, sector, count);
+  }
+#if defined(ENABLE_SCRATCH_BUFFER)
+  /* unaligned buffer: read through the scratch buffer */
+  while (count > 0)
+  {
+    UINT n = (count < SD_SCRATCH_SECTORS) ? count : SD_SCRATCH_SECTORS;
+    DRESULT res = SD_ReadBlocksDMA(SD_ScratchBuffer, sector, n);
+    if (res != RES_OK)
+    {
+      return res;
+    }
+    memcpy(buff, SD_ScratchBuffer, n * SD_DEFAULT_BLOCK_SIZE);
+    buff += n * SD_DEFAULT_BLOCK_SIZE;
+    sector += n;
+    count -= n;
+  }
+  return RES_OK;
+#endif /* ENABLE_SCRATCH_BUFFER */
+#endif /* SD_USE_DMA */
+
+  return SD_ReadCard(0, buff, sector, count);
+}
+#define SD_read SD_ReadCard
 /* USER CODE END beforeReadSection */
 /**
   * @brief  Reads Sector(s)
@@ -164,6 +403,64 @@ DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
 
 /* USER CODE BEGIN beforeWriteSection */
 /* can be used to modify previous code / undefine following code / add new code */
+#undef SD_read
+
+#if _USE_WRITE == 1
+DRESULT SD_WriteCard(BYTE lun, const BYTE *buff, DWORD sector, UINT count);
+
+/**
+  * @brief  Writes Sector(s)
+  * @param  lun : not used
+  * @param  *buff: Data to be written
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to write (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+  /* written back on eviction or CTRL_SYNC */
+  return SDCache_Write(buff, sector, count);
+}
+
+/**
+  * @brief  Writes Sector(s) to the card, bypassing the sector cache
+  * @param  *buff: Data to be written
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to write
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_WriteSectors(const BYTE *buff, DWORD sector, UINT count)
+{
+#if defined(SD_USE_DMA)
+  if (((uintptr_t)buff & SD_DMA_ALIGN_MASK) == 0)
+  {
+    return SD_WriteBlocksDMA(buff, sector, count);
+  }
+#if defined(ENABLE_SCRATCH_BUFFER)
+  /* unaligned buffer: write through the scratch buffer */
+  while (count > 0)
+  {
+    UINT n = (count < SD_SCRATCH_SECTORS) ? count : SD_SCRATCH_SECTORS;
+    DRESULT res;
+    memcpy(SD_ScratchBuffer, buff, n * SD_DEFAULT_BLOCK_SIZE);
+    res = SD_WriteBlocksDMA(SD_ScratchBuffer, sector, n);
+    if (res != RES_OK)
+    {
+      return res;
+    }
+    buff += n * SD_DEFAULT_BLOCK_SIZE;
+    sector += n;
+    count -= n;
+  }
+  return RES_OK;
+#endif /* ENABLE_SCRATCH_BUFFER */
+#endif /* SD_USE_DMA */
+
+  SD_PreErase(count);
+  return SD_WriteCard(0, buff, sector, count);
+}
+#define SD_write SD_WriteCard
+#endif /* _USE_WRITE == 1 */
 /* USER CODE END beforeWriteSection */
 /**
   * @brief  Writes Sector(s)
@@ -196,6 +493,73 @@ DRESULT SD_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
 
 /* USER CODE BEGIN beforeIoctlSection */
 /* can be used to modify previous code / undefine following code / add new code */
+#undef SD_write
+
+#if _USE_IOCTL == 1
+/* AU_SIZE / UHS_AU_SIZE of the SD status register (4 bit) in 512-byte sectors, 0 = not defined */
+static const uint32_t SD_AuSectors[16] = {
+  0, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 24576, 32768, 49152, 65536, 131072
+};
+
+/**
+  * @brief  Allocation unit of the card from the SD status (ACMD13), the erase block f_mkfs aligns to
+  * @retval Power of two in sectors, at most 32768 (16 MB, the limit of f_mkfs); 1 if unknown
+  */
+static DWORD SD_GetAuSectors(void)
+{
+  HAL_SD_CardStatusTypeDef status;
+  DWORD sectors;
+
+  if (HAL_SD_GetCardStatus(&hsd1, &status) != HAL_OK)
+  {
+    return 1;
+  }
+  sectors = SD_AuSectors[status.AllocationUnitSize & 0x0FU];
+  if (sectors == 0)
+  {
+    sectors = SD_AuSectors[status.UhsAllocationUnitSize & 0x0FU];
+  }
+  if (sectors == 0)
+  {
+    return 1;
+  }
+
+  /* 12 and 24 MB: the largest power of two that divides them still lines up with each AU */
+  sectors &= ~(sectors - 1U);
+  return sectors > 32768U ? 32768U : sectors;
+}
+
+DRESULT SD_IoctlCard(BYTE lun, BYTE cmd, void *buff);
+
+/**
+  * @brief  I/O control operation: CTRL_SYNC writes the sector cache back, GET_BLOCK_SIZE
+  *         reports the allocation unit, everything else goes to the generated SD_IoctlCard
+  * @param  lun : not used
+  * @param  cmd: Control code
+  * @param  *buff: Buffer to send/receive control data
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
+{
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+
+  switch (cmd)
+  {
+  /* Make sure that no pending write process */
+  case CTRL_SYNC :
+    return SDCache_Flush();
+
+  /* Get erase block size in unit of sector (DWORD) */
+  case GET_BLOCK_SIZE :
+    *(DWORD*)buff = SD_GetAuSectors();
+    return RES_OK;
+
+  default:
+    return SD_IoctlCard(lun, cmd, buff);
+  }
+}
+#define SD_ioctl SD_IoctlCard
+#endif /* _USE_IOCTL == 1 */
 /* USER CODE END beforeIoctlSection */
 /**
   * @brief  I/O control operation
@@ -250,8 +614,38 @@ DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
 
 /* USER CODE BEGIN afterIoctlSection */
 /* can be used to modify previous code / undefine following code / add new code */
+#undef SD_ioctl
 /* USER CODE END afterIoctlSection */
 
 /* USER CODE BEGIN lastSection */
 /* can be used to modify / undefine previous code or add new code */
+#if defined(SD_USE_DMA)
+/**
+  * @brief Rx Transfer completed callback (overrides the weak BSP version)
+  * @retval None
+  */
+void BSP_SD_ReadCpltCallback(void)
+{
+  SD_ReadDone = 1;
+}
+
+/**
+  * @brief Tx Transfer completed callback (overrides the weak BSP version)
+  * @retval None
+  */
+void BSP_SD_WriteCpltCallback(void)
+{
+  SD_WriteDone = 1;
+}
+
+/**
+  * @brief SD error callback: releases a waiting SD_read/SD_write
+  * @param hsd: SD handle
+  * @retval None
+  */
+void HAL_SD_ErrorCallback(SD_HandleTypeDef *hsd)
+{
+  SD_TransferError = 1;
+}
+#endif /* SD_USE_DMA */
 /* USER CODE END lastSection */
@@ -36,6 +36,10 @@ extern const Diskio_drvTypeDef  SD_Driver;
 
 /* USER CODE BEGIN lastSection */
 /* can be used to modify / undefine previous code or add new definitions */
+/* raw sector access below the sector cache (SDCache.c) */
+DRESULT SD_ReadSectors(BYTE *buff, DWORD sector, UINT count);
+DRESULT SD_WriteSectors(const BYTE *buff, DWORD sector, UINT count);
+uint32_t SD_GetPreErases(void);
 /* USER CODE END lastSection */
 
 #endif /* __SD_DISKIO_H */
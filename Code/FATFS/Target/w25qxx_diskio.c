@@ -0,0 +1,326 @@
+/**
+ * @file    w25qxx_diskio.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   FatFs-Laufwerk auf dem W25Qxx-QSPI-Flash (Laufwerk "1:")
+ *
+ * FatFs arbeitet mit 512-Byte-Sektoren, der Flash kann aber nur 4-KB-Sektoren löschen und
+ * nur Bits von 1 auf 0 programmieren. Dazwischen liegt ein Write-Back-Cache für genau einen
+ * 4-KB-Löschblock: Schreibzugriffe landen im RAM, erst beim Wechsel auf einen anderen Block
+ * oder bei CTRL_SYNC (f_sync/f_close) wird der Block zurückgeschrieben. Eine FAT-Aktualisierung
+ * mit mehreren Sektoren im selben Block kostet so nur einen Löschvorgang.
+ *
+ * Beim Zurückschreiben wird geprüft, ob überhaupt gelöscht werden muss: Setzen die neuen
+ * Daten nur Bits von 1 auf 0 (z.B. beim Anhängen an eine Datei in frisch gelöschten Bereich),
+ * werden nur die geänderten Seiten programmiert.
+ *
+ * Blöcke, die FatFs freigibt (CTRL_TRIM beim Löschen und Kürzen von Dateien, bei f_mkfs das
+ * ganze Laufwerk), bekommt der Löschpool (FlashPool.c) und löscht sie im Hintergrund. Wird
+ * ein solcher Block später neu belegt, findet das Zurückschreiben ihn gelöscht vor und muss
+ * nur noch programmieren. Vor dem Laden in den Cache wird der Block aus dem Pool geholt,
+ * damit der Pool keine neuen Daten löscht.
+ *
+ * Gelesen wird über das Memory-Mapped-Fenster (W25Qxx_FastReadQuadOutput kopiert dann direkt
+ * daraus), also ohne Befehlsaufbau pro Zugriff. Schreib- und Löschfunktionen des W25Qxx
+ * verlassen den Modus selbst vorübergehend.
+ */
+
+#include "w25qxx_diskio.h"
+#include "W25Qxx_QSPI.h"
+#include "FlashPool.h"
+#include <string.h>
+
+#define W25QXX_DISK_SECTORS_PER_BLOCK  (W25QXX_DISK_ERASE_SIZE / W25QXX_DISK_SECTOR_SIZE)
+#define W25QXX_DISK_PAGE_SIZE          256
+#define W25QXX_DISK_NO_BLOCK           0xFFFFFFFFUL
+
+/* Disk status */
+static volatile DSTATUS Stat = STA_NOINIT;
+
+/* Write-Back-Cache für einen Löschblock */
+uint8_t W25QxxDisk_Block[W25QXX_DISK_ERASE_SIZE] __attribute__((aligned(32)));
+uint8_t W25QxxDisk_Page[W25QXX_DISK_PAGE_SIZE] __attribute__((aligned(32)));
+uint32_t W25QxxDisk_BlockAddress = W25QXX_DISK_NO_BLOCK;
+uint8_t W25QxxDisk_Dirty = 0;
+
+DSTATUS W25QxxDisk_initialize (BYTE);
+DSTATUS W25QxxDisk_status (BYTE);
+DRESULT W25QxxDisk_read (BYTE, BYTE*, DWORD, UINT);
+#if _USE_WRITE == 1
+DRESULT W25QxxDisk_write (BYTE, const BYTE*, DWORD, UINT);
+#endif /* _USE_WRITE == 1 */
+#if _USE_IOCTL == 1
+DRESULT W25QxxDisk_ioctl (BYTE, BYTE, void*);
+#endif  /* _USE_IOCTL == 1 */
+
+const Diskio_drvTypeDef  W25Qxx_Driver =
+{
+  W25QxxDisk_initialize,
+  W25QxxDisk_status,
+  W25QxxDisk_read,
+#if  _USE_WRITE == 1
+  W25QxxDisk_write,
+#endif /* _USE_WRITE == 1 */
+
+#if  _USE_IOCTL == 1
+  W25QxxDisk_ioctl,
+#endif /* _USE_IOCTL == 1 */
+};
+
+/**
+  * @brief  Initializes a Drive
+  * @param  lun : not used
+  * @retval DSTATUS: Operation status
+  */
+DSTATUS W25QxxDisk_initialize(BYTE lun)
+{
+  W25QxxDisk_BlockAddress = W25QXX_DISK_NO_BLOCK;
+  W25QxxDisk_Dirty = 0;
+
+  W25Qxx_begin();
+#ifdef W25QXX_DISK_MEMORY_MAPPED
+  W25Qxx_EnableMemoryMapped();
+#endif
+
+  Stat &= ~STA_NOINIT;
+  return Stat;
+}
+
+/**
+  * @brief  Gets Disk Status
+  * @param  lun : not used
+  * @retval DSTATUS: Operation status
+  */
+DSTATUS W25QxxDisk_status(BYTE lun)
+{
+  return Stat;
+}
+
+/**
+  * @brief  Reads Sector(s)
+  * @param  lun : not used
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT W25QxxDisk_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+  if ((uint64_t)(sector + count) * W25QXX_DISK_SECTOR_SIZE > W25QXX_DISK_SIZE) return RES_PARERR;
+
+  uint32_t address = W25QXX_DISK_BASE + sector * W25QXX_DISK_SECTOR_SIZE;
+  uint32_t size = count * W25QXX_DISK_SECTOR_SIZE;
+  W25Qxx_FastReadQuadOutput(address, buff, size);
+
+  /* Sectors of the cached block are newer in RAM than in the flash */
+  if (W25QxxDisk_Dirty && W25QxxDisk_BlockAddress < address + size &&
+      W25QxxDisk_BlockAddress + W25QXX_DISK_ERASE_SIZE > address)
+  {
+    uint32_t start = (W25QxxDisk_BlockAddress > address) ? W25QxxDisk_BlockAddress : address;
+    uint32_t end = W25QxxDisk_BlockAddress + W25QXX_DISK_ERASE_SIZE;
+    if (end > address + size) end = address + size;
+    memcpy(&buff[start - address], &W25QxxDisk_Block[start - W25QxxDisk_BlockAddress], end - start);
+  }
+
+  return RES_OK;
+}
+
+#if _USE_WRITE == 1
+/**
+  * @brief  Writes Sector(s)
+  * @param  lun : not used
+  * @param  *buff: Data to be written
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to write (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT W25QxxDisk_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+  if ((uint64_t)(sector + count) * W25QXX_DISK_SECTOR_SIZE > W25QXX_DISK_SIZE) return RES_PARERR;
+
+  while (count > 0)
+  {
+    uint32_t address = W25QXX_DISK_BASE + sector * W25QXX_DISK_SECTOR_SIZE;
+    uint32_t block = address & ~(W25QXX_DISK_ERASE_SIZE - 1);
+    uint32_t offset = address - block;
+    uint32_t sectors = (W25QXX_DISK_ERASE_SIZE - offset) / W25QXX_DISK_SECTOR_SIZE;
+    if (sectors > count) sectors = count;
+
+    if (block != W25QxxDisk_BlockAddress)
+    {
+      if (W25QxxDisk_Flush() != RES_OK) return RES_ERROR;
+
+      /* The block is in use again, the pool must not erase it any more */
+      FlashPool_Claim(block);
+
+      /* A fully overwritten block does not need its old contents */
+      if (sectors < W25QXX_DISK_SECTORS_PER_BLOCK)
+      {
+        W25Qxx_FastReadQuadOutput(block, W25QxxDisk_Block, W25QXX_DISK_ERASE_SIZE);
+      }
+      W25QxxDisk_BlockAddress = block;
+    }
+
+    memcpy(&W25QxxDisk_Block[offset], buff, sectors * W25QXX_DISK_SECTOR_SIZE);
+    W25QxxDisk_Dirty = 1;
+
+    buff += sectors * W25QXX_DISK_SECTOR_SIZE;
+    sector += sectors;
+    count -= sectors;
+  }
+
+  return RES_OK;
+}
+#endif /* _USE_WRITE == 1 */
+
+#if _USE_IOCTL == 1
+/**
+  * @brief  I/O control operation
+  * @param  lun : not used
+  * @param  cmd: Control code
+  * @param  *buff: Buffer to send/receive control data
+  * @retval DRESULT: Operation result
+  */
+DRESULT W25QxxDisk_ioctl(BYTE lun, BYTE cmd, void *buff)
+{
+  DRESULT res = RES_ERROR;
+
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+
+  switch (cmd)
+  {
+  /* Write back the cached erase block */
+  case CTRL_SYNC :
+    res = W25QxxDisk_Flush();
+    break;
+
+  /* Get number of sectors on the disk (DWORD) */
+  case GET_SECTOR_COUNT :
+    *(DWORD*)buff = W25QXX_DISK_SIZE / W25QXX_DISK_SECTOR_SIZE;
+    res = RES_OK;
+    break;
+
+  /* Get R/W sector size (WORD) */
+  case GET_SECTOR_SIZE :
+    *(WORD*)buff = W25QXX_DISK_SECTOR_SIZE;
+    res = RES_OK;
+    break;
+
+  /* Get erase block size in unit of sector (DWORD) */
+  case GET_BLOCK_SIZE :
+    *(DWORD*)buff = W25QXX_DISK_SECTORS_PER_BLOCK;
+    res = RES_OK;
+    break;
+
+#if _USE_TRIM == 1
+  /* Freed sectors (first and last LBA): erase whole blocks in the background */
+  case CTRL_TRIM :
+    res = W25QxxDisk_Trim(((DWORD*)buff)[0], ((DWORD*)buff)[1]);
+    break;
+#endif /* _USE_TRIM == 1 */
+
+  default:
+    res = RES_PARERR;
+  }
+
+  return res;
+}
+#endif /* _USE_IOCTL == 1 */
+
+/**
+ * @brief  Schreibt den gecachten Löschblock in den Flash zurück.
+ *
+ * Muss nur gelöscht werden, wenn ein Bit von 0 auf 1 wechseln soll; sonst werden nur die
+ * geänderten Seiten programmiert. Nach dem Löschen werden Seiten, die nur 0xFF enthalten,
+ * übersprungen.
+ *
+ * @return RES_OK, auch wenn nichts zu schreiben war
+ */
+DRESULT W25QxxDisk_Flush(void)
+{
+  if (!W25QxxDisk_Dirty || W25QxxDisk_BlockAddress == W25QXX_DISK_NO_BLOCK) return RES_OK;
+
+  /* Erased already if the pool got to it, otherwise the comparison below decides */
+  FlashPool_Claim(W25QxxDisk_BlockAddress);
+
+  uint8_t needErase = 0;
+  uint32_t changed = 0;		// Bitmask of pages that differ from the flash
+
+  for (uint32_t page = 0; page < W25QXX_DISK_ERASE_SIZE / W25QXX_DISK_PAGE_SIZE; page++)
+  {
+    const uint8_t *data = &W25QxxDisk_Block[page * W25QXX_DISK_PAGE_SIZE];
+    W25Qxx_FastReadQuadOutput(W25QxxDisk_BlockAddress + page * W25QXX_DISK_PAGE_SIZE, W25QxxDisk_Page, W25QXX_DISK_PAGE_SIZE);
+
+    for (uint32_t i = 0; i < W25QXX_DISK_PAGE_SIZE; i++)
+    {
+      if (W25QxxDisk_Page[i] == data[i]) continue;
+      changed |= 1UL << page;
+      if ((W25QxxDisk_Page[i] & data[i]) != data[i])
+      {
+        needErase = 1;
+        break;
+      }
+    }
+    if (needErase) break;
+  }
+
+  if (needErase)
+  {
+    W25Qxx_WriteEnable();
+    W25Qxx_EraseSector(W25QxxDisk_BlockAddress);
+    changed = 0;
+
+    for (uint32_t page = 0; page < W25QXX_DISK_ERASE_SIZE / W25QXX_DISK_PAGE_SIZE; page++)
+    {
+      const uint8_t *data = &W25QxxDisk_Block[page * W25QXX_DISK_PAGE_SIZE];
+      for (uint32_t i = 0; i < W25QXX_DISK_PAGE_SIZE; i++)
+      {
+        if (data[i] != 0xFF)
+        {
+          changed |= 1UL << page;
+          break;
+        }
+      }
+    }
+  }
+
+  for (uint32_t page = 0; page < W25QXX_DISK_ERASE_SIZE / W25QXX_DISK_PAGE_SIZE; page++)
+  {
+    if (!(changed & (1UL << page))) continue;
+    W25Qxx_WriteEnable();
+    W25Qxx_PageProgram(W25QxxDisk_BlockAddress + page * W25QXX_DISK_PAGE_SIZE,
+                       &W25QxxDisk_Block[page * W25QXX_DISK_PAGE_SIZE], W25QXX_DISK_PAGE_SIZE);
+  }
+
+  W25QxxDisk_Dirty = 0;
+  return RES_OK;
+}
+
+/**
+ * @brief  Übergibt die ganz freigegebenen Löschblöcke zwischen zwei LBAs dem Löschpool.
+ *
+ * Liegt der gecachte Block vollständig im Bereich, wird er verworfen statt zurückgeschrieben.
+ *
+ * @param  first: erster freigegebener FatFs-Sektor
+ * @param  last: letzter freigegebener FatFs-Sektor (einschließlich)
+ * @return RES_OK, RES_PARERR bei einem Bereich außerhalb des Laufwerks
+ */
+DRESULT W25QxxDisk_Trim(DWORD first, DWORD last)
+{
+  if (first > last || (uint64_t)(last + 1) * W25QXX_DISK_SECTOR_SIZE > W25QXX_DISK_SIZE) return RES_PARERR;
+
+  uint32_t address = W25QXX_DISK_BASE + first * W25QXX_DISK_SECTOR_SIZE;
+  uint32_t size = (last - first + 1) * W25QXX_DISK_SECTOR_SIZE;
+
+  if (W25QxxDisk_BlockAddress != W25QXX_DISK_NO_BLOCK && W25QxxDisk_BlockAddress >= address &&
+      W25QxxDisk_BlockAddress + W25QXX_DISK_ERASE_SIZE <= address + size)
+  {
+    W25QxxDisk_BlockAddress = W25QXX_DISK_NO_BLOCK;
+    W25QxxDisk_Dirty = 0;
+  }
+
+  FlashPool_Discard(address, size);
+  return RES_OK;
+}
@@ -0,0 +1,31 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef __W25QXX_DISKIO_H
+#define __W25QXX_DISKIO_H
+
+#include "ff_gen_drv.h"
+#include "FlashKV.h"
+#include "Asset.h"
+#include "Update.h"
+#include "Overlay.h"
+
+/* Von FatFs genutzter Bereich des W25Qxx: zwischen den Code-Overlays hinter dem Asset-Bundle und
+ * den Update-Slots; dahinter liegen Prüfmuster des Bus-Tunings und Schlüssel/Wert-Speicher */
+#define W25QXX_DISK_BASE         (OVERLAY_STORE_ADDRESS + OVERLAY_STORE_SIZE)
+#define W25QXX_DISK_SIZE         (UPDATE_SLOT_BASE - W25QXX_DISK_BASE)
+
+/* FatFs-Sektor und Löscheinheit des Flashs (ein Cache-Block umfasst 8 FatFs-Sektoren) */
+#define W25QXX_DISK_SECTOR_SIZE  512
+#define W25QXX_DISK_ERASE_SIZE   4096
+
+/* Lesezugriffe über den Memory-Mapped-Modus (XIP). Auskommentieren für indirekte Quad-Reads. */
+#define W25QXX_DISK_MEMORY_MAPPED
+
+extern const Diskio_drvTypeDef W25Qxx_Driver;
+
+DRESULT W25QxxDisk_Flush(void);
+DRESULT W25QxxDisk_Trim(DWORD first, DWORD last);
+
+#endif /* __W25QXX_DISKIO_H */
@@ -0,0 +1,95 @@
+/**
+ * @file    HostBench.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   host_bench: Busverkehr und Host-Laufzeit je Zeichenfunktion als CSV
+ *
+ * Jeder Fall aus HostCases.c läuft einmal mit gelöschten Zählern; für jede Schnittstelle, auf
+ * der er etwas übertragen hat, entsteht eine Zeile:
+ *   case,param,bus,transfers,bytes,clocks,wire_us,hash,host_ns
+ * wire_us ist die aus dem Bustakt geschätzte Leitungszeit (siehe HalShim.c), hash die Prüfsumme
+ * der gesendeten Bytes, host_ns die mittlere Laufzeit des Falls auf dem Host über mindestens
+ * HOST_BENCH_MIN_NS. Alle Spalten außer host_ns sind auf jedem Rechner gleich; mit --wire fehlt
+ * host_ns, die Ausgabe zweier Stände lässt sich dann direkt mit diff vergleichen.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "HostCases.h"
+#include "HalShim.h"
+
+#define HOST_BENCH_MIN_NS    50000000ULL   // 50 ms je Fall
+#define HOST_BENCH_MAX_REPS  100000UL
+
+static uint64_t HostBench_Now(void);
+static uint64_t HostBench_Time(const HostCase *c);
+
+int main(int argc, char **argv) {
+	uint8_t wireOnly = argc > 1 && strcmp(argv[1], "--wire") == 0;
+
+	if (!HostCases_Init()) {
+		fprintf(stderr, "host_bench: init failed\n");
+		return 1;
+	}
+
+	printf("# host, SPI1 %lu kbit/s, I2C1 TIMINGR 0x%08lX\n",
+			(unsigned long)(HALSHIM_SPI123_HZ / 2 / 1000), (unsigned long)hi2c1.Instance->TIMINGR);
+	printf(wireOnly ? "case,param,bus,transfers,bytes,clocks,wire_us,hash\n"
+			: "case,param,bus,transfers,bytes,clocks,wire_us,hash,host_ns\n");
+
+	for (uint32_t i = 0; i < HostCaseCount; i++) {
+		const HostCase *c = &HostCases[i];
+		HalShim_Bus buses[HALSHIM_BUS_COUNT];
+
+		if (c->prepare != NULL) c->prepare(c->param);
+		HalShim_Reset();
+		c->run(c->param, 0);
+		memcpy(buses, HalShim_Buses, sizeof(buses));
+
+		uint64_t hostNs = wireOnly ? 0 : HostBench_Time(c);
+		if (c->finish != NULL) c->finish(c->param);
+
+		for (uint32_t b = 0; b < HALSHIM_BUS_COUNT; b++) {
+			const HalShim_Bus *bus = &buses[b];
+			if (bus->transfers == 0) continue;
+
+			uint64_t us10 = bus->nanoseconds / 100;
+			printf("%s,%lu,%s,%lu,%llu,%llu,%llu.%llu,%08lx", c->name, (unsigned long)c->param, bus->name,
+					(unsigned long)bus->transfers, (unsigned long long)bus->bytes,
+					(unsigned long long)bus->clocks, (unsigned long long)(us10 / 10),
+					(unsigned long long)(us10 % 10), (unsigned long)bus->hash);
+			if (wireOnly)
+				printf("\n");
+			else
+				printf(",%llu\n", (unsigned long long)hostNs);
+		}
+	}
+
+	printf("# host done\n");
+	return 0;
+}
+
+/**
+ * @brief  Mittlere Laufzeit eines Falls; prepare() zählt nicht mit
+ */
+static uint64_t HostBench_Time(const HostCase *c) {
+	uint64_t total = 0;
+	uint32_t reps = 0;
+
+	while (total < HOST_BENCH_MIN_NS && reps < HOST_BENCH_MAX_REPS) {
+		if (c->prepare != NULL) c->prepare(c->param);
+
+		uint64_t start = HostBench_Now();
+		c->run(c->param, reps + 1);
+		total += HostBench_Now() - start;
+		reps++;
+	}
+	return total / reps;
+}
+
+static uint64_t HostBench_Now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,532 @@
+/**
+ * @file    HostCases.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   Messfälle des Host-Builds, gemeinsam für host_bench und host_gbench
+ *
+ * Die Fälle entsprechen DisplayBench.c auf dem Board (gleiche Größen, Radien und Texte),
+ * ergänzt um Linien und Messkurven, Sprites, den Kachel-Renderer, den Framebuffer, das OLED, die WS2812-Kette und Dateizugriffe über FatFs.
+ * Einmal durchlaufen ergeben sie den Busverkehr je Primitive, wiederholt die Laufzeit des
+ * Rasterns und Kodierens auf dem Host.
+ */
+
+#include "HostCases.h"
+
+#include <string.h>
+#include "HalShim.h"
+#include "HostSd.h"
+#include "ILI9341.h"
+#include "ILI9341_FB.h"
+#include "ILI9341_Sprite.h"
+#include "ILI9341_Tile.h"
+#include "ILI9341_Image.h"
+#include "ILI9341_Scale.h"
+#include "SSD1306.h"
+#include "Fonts/ssd1306_fonts.h"
+#include "WS2812.h"
+#include "I2CBus.h"
+#include "SDCard.h"
+#include "Fonts/5x5_font.h"
+
+#define HOST_CASES_IO_FILE    "io.dat"
+#define HOST_CASES_IO_BYTES   (64UL * 1024UL)
+#define HOST_CASES_SPRITE     32      // Kantenlänge des Ring-Sprites
+#define HOST_CASES_INDEXED_FILE "logo16.cimg"
+#define HOST_CASES_INDEXED_MAX (sizeof(ILI9341_ImageHeader) + 256 * 2 + HOST_CASES_FILE_WIDTH * HOST_CASES_FILE_HEIGHT)
+
+static const char HostCases_Text[] = "Benchmark 0123456789 ABC";
+static const char HostCases_Paragraph[] = "Messwerte werden jede Sekunde neu gezeichnet,\nohne die Box vorher zu loeschen.";
+static uint8_t HostCases_Image[HOST_CASES_FILE_WIDTH * HOST_CASES_FILE_HEIGHT * 2];
+static uint8_t HostCases_Io[HOST_CASES_IO_BYTES];
+static uint32_t HostCases_Seed;
+static uint8_t HostCases_SpritePixels[HOST_CASES_SPRITE * HOST_CASES_SPRITE * 2];
+static ILI9341_Sprite HostCases_Sprite;
+static int16_t HostCases_Plot[320];
+static uint8_t HostCases_Indexed[4][HOST_CASES_INDEXED_MAX];   // 1, 2, 4 und 8 Bit je Pixel
+
+static void HostCases_FillScreen(uint32_t param, uint32_t iteration);
+static void HostCases_FillRect(uint32_t param, uint32_t iteration);
+static void HostCases_DrawPixel(uint32_t param, uint32_t iteration);
+static void HostCases_DrawText(uint32_t param, uint32_t iteration);
+static void HostCases_TextBox(uint32_t param, uint32_t iteration);
+static void HostCases_FillCircle(uint32_t param, uint32_t iteration);
+static void HostCases_Circle(uint32_t param, uint32_t iteration);
+static void HostCases_DrawLine(uint32_t param, uint32_t iteration);
+static void HostCases_DrawPlot(uint32_t param, uint32_t iteration);
+static void HostCases_ClipScene(uint32_t param, uint32_t iteration);
+static void HostCases_BinaryFile(uint32_t param, uint32_t iteration);
+static void HostCases_IndexedImage(uint32_t param, uint32_t iteration);
+static void HostCases_IndexedFile(uint32_t param, uint32_t iteration);
+static uint32_t HostCases_BuildIndexed(uint8_t *out, uint8_t bpp);
+static void HostCases_ScaleNearest(uint32_t param, uint32_t iteration);
+static void HostCases_ScaleBilinear(uint32_t param, uint32_t iteration);
+static void HostCases_ScaleRotate(uint32_t param, uint32_t iteration);
+static void HostCases_SpriteDraw(uint32_t param, uint32_t iteration);
+static void HostCases_SpriteMove(uint32_t param, uint32_t iteration);
+static void HostCases_TileFrame(uint32_t param, uint32_t iteration);
+static void HostCases_FbFlush(uint32_t param, uint32_t iteration);
+static void HostCases_OledFill(uint32_t param, uint32_t iteration);
+static void HostCases_OledText(uint32_t param, uint32_t iteration);
+static void HostCases_Ws2812(uint32_t param, uint32_t iteration);
+static void HostCases_FileWrite(uint32_t param, uint32_t iteration);
+static void HostCases_FileRead(uint32_t param, uint32_t iteration);
+static void HostCases_PlotPrepare(uint32_t param);
+static void HostCases_TilePrepare(uint32_t param);
+static void HostCases_FbPrepare(uint32_t param);
+static void HostCases_FbFinish(uint32_t param);
+static void HostCases_FbDoublePrepare(uint32_t param);
+static void HostCases_FbDoubleFinish(uint32_t param);
+static void HostCases_ClipPrepare(uint32_t param);
+static void HostCases_ClipFinish(uint32_t param);
+static void HostCases_ClearGlyphs(uint32_t param);
+static void HostCases_ResetSeed(uint32_t param);
+static uint32_t HostCases_Random(void);
+
+const HostCase HostCases[] = {
+	{ "fill_screen", 0,   HostCases_FillScreen, NULL, NULL },
+	{ "fill_rect",   8,   HostCases_FillRect,   NULL, NULL },
+	{ "fill_rect",   16,  HostCases_FillRect,   NULL, NULL },
+	{ "fill_rect",   32,  HostCases_FillRect,   NULL, NULL },
+	{ "fill_rect",   64,  HostCases_FillRect,   NULL, NULL },
+	{ "fill_rect",   128, HostCases_FillRect,   NULL, NULL },
+	{ "fill_rect",   240, HostCases_FillRect,   NULL, NULL },
+	{ "draw_pixel",  1000, HostCases_DrawPixel, HostCases_ResetSeed, NULL },
+	{ "draw_text",   1,   HostCases_DrawText,   NULL, NULL },
+	{ "draw_text",   2,   HostCases_DrawText,   NULL, NULL },
+	{ "draw_text",   3,   HostCases_DrawText,   NULL, NULL },
+	{ "draw_text",   4,   HostCases_DrawText,   NULL, NULL },
+	{ "draw_text_cold", 2, HostCases_DrawText,  HostCases_ClearGlyphs, NULL },
+	{ "text_box",    1,   HostCases_TextBox,    NULL, NULL },
+	{ "text_box",    2,   HostCases_TextBox,    NULL, NULL },
+	{ "fill_circle", 10,  HostCases_FillCircle, NULL, NULL },
+	{ "fill_circle", 50,  HostCases_FillCircle, NULL, NULL },
+	{ "fill_circle", 100, HostCases_FillCircle, NULL, NULL },
+	{ "circle",      10,  HostCases_Circle,     NULL, NULL },
+	{ "circle",      50,  HostCases_Circle,     NULL, NULL },
+	{ "circle",      100, HostCases_Circle,     NULL, NULL },
+	{ "draw_line",   16,  HostCases_DrawLine,   NULL, NULL },
+	{ "draw_plot",   320, HostCases_DrawPlot,   HostCases_PlotPrepare, NULL },
+	{ "clip_scene",  64,  HostCases_ClipScene,  HostCases_ClipPrepare, HostCases_ClipFinish },
+	{ "clip_scene",  320, HostCases_ClipScene,  HostCases_ClipPrepare, HostCases_ClipFinish },
+	{ "binary_file", HOST_CASES_FILE_WIDTH, HostCases_BinaryFile, NULL, NULL },
+	{ "indexed_image", 1, HostCases_IndexedImage, NULL, NULL },
+	{ "indexed_image", 2, HostCases_IndexedImage, NULL, NULL },
+	{ "indexed_image", 4, HostCases_IndexedImage, NULL, NULL },
+	{ "indexed_image", 8, HostCases_IndexedImage, NULL, NULL },
+	{ "indexed_file",  4, HostCases_IndexedFile,  NULL, NULL },
+	{ "scale_nearest",  50,  HostCases_ScaleNearest,  NULL, NULL },
+	{ "scale_nearest",  200, HostCases_ScaleNearest,  NULL, NULL },
+	{ "scale_bilinear", 50,  HostCases_ScaleBilinear, NULL, NULL },
+	{ "scale_bilinear", 200, HostCases_ScaleBilinear, NULL, NULL },
+	{ "scale_rotate",   90,  HostCases_ScaleRotate,   NULL, NULL },
+	{ "scale_rotate",   270, HostCases_ScaleRotate,   NULL, NULL },
+	{ "sprite_draw", HOST_CASES_SPRITE, HostCases_SpriteDraw, NULL, NULL },
+	{ "sprite_move", 4,   HostCases_SpriteMove, NULL, NULL },
+	{ "tile_frame",  4,   HostCases_TileFrame,  HostCases_TilePrepare, NULL },
+	{ "fb_flush",    64,  HostCases_FbFlush,    HostCases_FbPrepare, HostCases_FbFinish },
+	{ "fb_flush",    240, HostCases_FbFlush,    HostCases_FbPrepare, HostCases_FbFinish },
+	{ "fb_flush_double", 64,  HostCases_FbFlush, HostCases_FbDoublePrepare, HostCases_FbDoubleFinish },
+	{ "fb_flush_double", 240, HostCases_FbFlush, HostCases_FbDoublePrepare, HostCases_FbDoubleFinish },
+	{ "oled_fill",   0,   HostCases_OledFill,   NULL, NULL },
+	{ "oled_text",   0,   HostCases_OledText,   NULL, NULL },
+	{ "ws2812_show", MAX_LED, HostCases_Ws2812, NULL, NULL },
+	{ "file_write",  HOST_CASES_IO_BYTES, HostCases_FileWrite, NULL, NULL },
+	{ "file_read",   HOST_CASES_IO_BYTES, HostCases_FileRead,  NULL, NULL },
+};
+
+const uint32_t HostCaseCount = sizeof(HostCases) / sizeof(HostCases[0]);
+
+/**
+ * @brief  Initialisiert Shim, RAM-Karte und Treiber in der Reihenfolge von main()
+ * @retval 1 bei Erfolg
+ */
+uint8_t HostCases_Init(void) {
+	HalShim_Init();
+	if (!HostSd_Init()) return 0;
+
+	// Test image: a gradient, so runs of equal pixels stay short
+	for (uint32_t i = 0; i < sizeof(HostCases_Image); i++)
+		HostCases_Image[i] = (uint8_t)(i * 7U + (i >> 8));
+	if (HostSd_WriteFile(HOST_CASES_FILE, HostCases_Image, sizeof(HostCases_Image)) != FR_OK) return 0;
+	for (uint32_t i = 0; i < sizeof(HostCases_Io); i++)
+		HostCases_Io[i] = (uint8_t)(i ^ (i >> 9));
+	if (HostSd_WriteFile(HOST_CASES_IO_FILE, HostCases_Io, sizeof(HostCases_Io)) != FR_OK) return 0;
+
+	// The logo with 2, 4, 16 and 256 colours, the 16-colour one also on the card
+	uint32_t indexedSize[4];
+	for (uint8_t i = 0; i < 4; i++)
+		indexedSize[i] = HostCases_BuildIndexed(HostCases_Indexed[i], (uint8_t)(1U << i));
+	if (HostSd_WriteFile(HOST_CASES_INDEXED_FILE, HostCases_Indexed[2], indexedSize[2]) != FR_OK) return 0;
+
+	// Sprite: a ring on the colour key, about 45 % of the pixels are opaque
+	for (int32_t y = 0; y < HOST_CASES_SPRITE; y++) {
+		for (int32_t x = 0; x < HOST_CASES_SPRITE; x++) {
+			int32_t dx = 2 * x - (HOST_CASES_SPRITE - 1), dy = 2 * y - (HOST_CASES_SPRITE - 1);
+			int32_t d2 = dx * dx + dy * dy;
+			uint16_t colour = (d2 >= 20 * 20 && d2 <= 31 * 31) ? (uint16_t)(RED + x) : MAGENTA;
+			HostCases_SpritePixels[(y * HOST_CASES_SPRITE + x) * 2] = colour >> 8;
+			HostCases_SpritePixels[(y * HOST_CASES_SPRITE + x) * 2 + 1] = colour & 0xFF;
+		}
+	}
+	ILI9341_Sprite_Init(&HostCases_Sprite, HOST_CASES_SPRITE, HOST_CASES_SPRITE, HostCases_SpritePixels);
+	ILI9341_Sprite_SetKey(&HostCases_Sprite, MAGENTA);
+
+	I2CBus_Init(&I2CBus_1, &hi2c1, I2CBUS_1_HZ);
+	I2CBus_Init(&I2CBus_2, &hi2c2, I2CBUS_2_HZ);
+	ssd1306_Init();
+	WS2812_Init();
+	ILI9341_begin(&hspi1, DISPLAY_CS_GPIO_Port, DISPLAY_CS_Pin, DISPLAY_DC_GPIO_Port, DISPLAY_DC_Pin,
+			DISPLAY_RESET_GPIO_Port, DISPLAY_RESET_Pin);
+	ILI9341_EndInit();
+	if (!SDCard_Mount()) return 0;
+
+	HalShim_Reset();
+	return 1;
+}
+
+static void HostCases_FillScreen(uint32_t param, uint32_t iteration) {
+	static const uint16_t colors[] = { RED, GREEN, BLUE, BLACK };
+	(void)param;
+	ILI9341_FillScreen(colors[iteration % 4]);
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_FillRect(uint32_t param, uint32_t iteration) {
+	int16_t x = (int16_t)((ILI9341_WIDTH - param) / 2);
+	int16_t y = (int16_t)((ILI9341_HEIGHT - param) / 2);
+
+	ILI9341_fillRect(x, y, (int16_t)param, (int16_t)param, (iteration & 1) ? BLUE : YELLOW);
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_DrawPixel(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	for (uint32_t p = 0; p < param; p++) {
+		uint32_t r = HostCases_Random();
+		ILI9341_DrawPixel((r >> 8) % ILI9341_WIDTH, (r >> 20) % ILI9341_HEIGHT, (uint16_t)r);
+	}
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_DrawText(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	uint16_t y = (uint16_t)((param - 1) * param * CHAR_HEIGHT * 2);
+
+	ILI9341_DrawText(HostCases_Text, 0, y, BLACK, (uint16_t)param, WHITE);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Umbrochener, zentrierter Absatz: ein Adressfenster je Zeile, Umbrüche aus dem Cache
+ */
+static void HostCases_TextBox(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	ILI9341_DrawTextBox(HostCases_Paragraph, 10, 40, 200, ILI9341_ALIGN_CENTER, BLACK, (uint16_t)param, WHITE);
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_FillCircle(uint32_t param, uint32_t iteration) {
+	ILI9341_DrawFilledCircle(ILI9341_WIDTH / 2, ILI9341_HEIGHT / 2, (uint16_t)param, (iteration & 1) ? RED : GREEN);
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_Circle(uint32_t param, uint32_t iteration) {
+	ILI9341_DrawCircleOutline(ILI9341_WIDTH / 2, ILI9341_HEIGHT / 2, (uint8_t)param, (iteration & 1) ? WHITE : BLUE);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  param Linien als Fächer von der Bildmitte zu Punkten am Rand (flache und steile)
+ */
+static void HostCases_DrawLine(uint32_t param, uint32_t iteration) {
+	int16_t cx = ILI9341_WIDTH / 2, cy = ILI9341_HEIGHT / 2;
+
+	for (uint32_t i = 0; i < param; i++) {
+		int16_t x = (int16_t)((ILI9341_WIDTH - 1) * i / (param - 1));
+		ILI9341_DrawLine(cx, cy, x, (i & 1) ? 0 : ILI9341_HEIGHT - 1, (iteration & 1) ? WHITE : YELLOW);
+	}
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Szene aus Rechteck, Kreis, Linien, abgerundetem Rechteck und Text, teils außerhalb des Displays
+ *
+ * Das Clip-Rechteck aus HostCases_ClipPrepare() ist param Pixel breit, der Rest der Formen kostet keinen Busverkehr.
+ */
+static void HostCases_ClipScene(uint32_t param, uint32_t iteration) {
+	(void)param;
+	uint16_t colour = (iteration & 1) ? MAGENTA : ORANGE;
+
+	ILI9341_fillRect(-40, 20, 400, 60, colour);
+	ILI9341_DrawFilledCircle(ILI9341_WIDTH / 2, ILI9341_HEIGHT / 2, 80, colour);
+	ILI9341_DrawLine(-100, -50, ILI9341_WIDTH + 100, ILI9341_HEIGHT + 50, WHITE);
+	ILI9341_DrawLine(ILI9341_WIDTH + 100, -50, -100, ILI9341_HEIGHT + 50, WHITE);
+	ILI9341_FillRoundRect(-20, ILI9341_HEIGHT - 60, ILI9341_WIDTH + 40, 80, 16, colour);
+	ILI9341_DrawText(HostCases_Text, 0, 100, BLACK, 2, WHITE);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Messkurve mit param Werten (Zufallsbewegung aus HostCases_PlotPrepare)
+ */
+static void HostCases_DrawPlot(uint32_t param, uint32_t iteration) {
+	ILI9341_DrawPlot(0, HostCases_Plot, (uint16_t)param, (iteration & 1) ? GREEN : CYAN);
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_BinaryFile(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	ILI9341_DrawBinaryFile(HOST_CASES_FILE, 30, 30, (uint16_t)param, HOST_CASES_FILE_HEIGHT);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Testbild mit Farbtabelle aus dem Speicher, param Bits je Pixel
+ */
+static void HostCases_IndexedImage(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	uint8_t i = (param == 1) ? 0 : (param == 2) ? 1 : (param == 4) ? 2 : 3;
+	ILI9341_DrawCompressedImage(HostCases_Indexed[i], sizeof(HostCases_Indexed[i]), 30, 30);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Testbild mit 16 Farben von der Karte: ein Viertel der Bytes von binary_file
+ */
+static void HostCases_IndexedFile(uint32_t param, uint32_t iteration) {
+	(void)param;
+	(void)iteration;
+	ILI9341_DrawCompressedFile(HOST_CASES_INDEXED_FILE, 30, 30);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Testbild auf param Prozent skaliert, nächster Nachbar
+ */
+static void HostCases_ScaleNearest(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	ILI9341_DrawImageScaled(10, 10, (uint16_t)(HOST_CASES_FILE_WIDTH * param / 100), (uint16_t)(HOST_CASES_FILE_HEIGHT * param / 100),
+	                        HostCases_Image, HOST_CASES_FILE_WIDTH, HOST_CASES_FILE_HEIGHT, ILI9341_SCALE_NEAREST);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Testbild auf param Prozent skaliert, bilinear
+ */
+static void HostCases_ScaleBilinear(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	ILI9341_DrawImageScaled(10, 10, (uint16_t)(HOST_CASES_FILE_WIDTH * param / 100), (uint16_t)(HOST_CASES_FILE_HEIGHT * param / 100),
+	                        HostCases_Image, HOST_CASES_FILE_WIDTH, HOST_CASES_FILE_HEIGHT, ILI9341_SCALE_BILINEAR);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Testbild um param Grad gedreht, 1:1
+ */
+static void HostCases_ScaleRotate(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	ILI9341_DrawImageScaled(10, 10, HOST_CASES_FILE_HEIGHT, HOST_CASES_FILE_WIDTH, HostCases_Image,
+	                        HOST_CASES_FILE_WIDTH, HOST_CASES_FILE_HEIGHT, param == 90 ? ILI9341_SCALE_ROTATE_90 : ILI9341_SCALE_ROTATE_270);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Baut ein Bild mit Farbtabelle in der Größe des Testbilds: konzentrische Ringe
+ * @retval Länge mit Kopf in Bytes
+ */
+static uint32_t HostCases_BuildIndexed(uint8_t *out, uint8_t bpp) {
+	ILI9341_ImageHeader header = { ILI9341_IMAGE_MAGIC, HOST_CASES_FILE_WIDTH, HOST_CASES_FILE_HEIGHT,
+	                               ILI9341_IMAGE_INDEXED, bpp, (uint8_t)((1U << bpp) - 1), 0, 0 };
+	uint32_t colours = 1UL << bpp;
+	uint32_t stride = ((uint32_t)HOST_CASES_FILE_WIDTH * bpp + 7) / 8;
+	uint8_t *p = out + sizeof(header);
+
+	for (uint32_t i = 0; i < colours; i++) {
+		uint16_t colour = (uint16_t)(i * 0x0841U + (i << 11));
+		*p++ = colour >> 8;
+		*p++ = colour & 0xFF;
+	}
+	memset(p, 0, stride * HOST_CASES_FILE_HEIGHT);
+	for (int32_t y = 0; y < HOST_CASES_FILE_HEIGHT; y++) {
+		for (int32_t x = 0; x < HOST_CASES_FILE_WIDTH; x++) {
+			int32_t dx = x - HOST_CASES_FILE_WIDTH / 2, dy = y - HOST_CASES_FILE_HEIGHT / 2;
+			uint32_t index = (uint32_t)((dx * dx + dy * dy) / 40) % colours;
+			uint32_t bit = (uint32_t)x * bpp;
+			p[y * stride + bit / 8] |= (uint8_t)(index << (bit % 8));
+		}
+	}
+
+	header.size = colours * 2 + stride * HOST_CASES_FILE_HEIGHT;
+	memcpy(out, &header, sizeof(header));
+	return sizeof(header) + header.size;
+}
+
+/**
+ * @brief  Ring-Sprite mit Farbschlüssel, halb über den rechten Rand geschnitten
+ */
+static void HostCases_SpriteDraw(uint32_t param, uint32_t iteration) {
+	(void)iteration;
+	ILI9341_Sprite_Draw(&HostCases_Sprite, (int16_t)(ILI9341_WIDTH - param / 2), 40);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Ring-Sprite um param Pixel nach rechts schieben: nur frei gewordene Pixel löschen
+ */
+static void HostCases_SpriteMove(uint32_t param, uint32_t iteration) {
+	int16_t x = (int16_t)((iteration % 64) * param);
+
+	ILI9341_Sprite_Move(&HostCases_Sprite, x, 100, x + (int16_t)param, 100, WHITE);
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Bild mit Tafel, Text, halbtransparentem Balken und Ring-Sprite, das um param Pixel
+ *         weiterrückt: nur die Kacheln unter alter und neuer Position werden gesendet
+ */
+static void HostCases_TileFrame(uint32_t param, uint32_t iteration) {
+	int16_t x = (int16_t)(((iteration + 1) % 64) * param);
+
+	ILI9341_Tile_Begin(WHITE);
+	ILI9341_fillRect(8, 8, 304, 64, NAVY);
+	ILI9341_DrawText(HostCases_Text, 16, 24, WHITE, 2, NAVY);
+	ILI9341_Sprite_Draw(&HostCases_Sprite, x, 56);
+	ILI9341_Tile_Blend(0, 48, ILI9341_WIDTH, 24, RED, 96);
+	ILI9341_Tile_End();
+	ILI9341_WaitWhileBusy();
+}
+
+/**
+ * @brief  Quadrat der Kantenlänge param in den Framebuffer zeichnen und nur die Änderung senden
+ */
+static void HostCases_FbFlush(uint32_t param, uint32_t iteration) {
+	int16_t x = (int16_t)((ILI9341_WIDTH - param) / 2);
+	int16_t y = (int16_t)((ILI9341_HEIGHT - param) / 2);
+
+	ILI9341_FB_FillRect(x, y, (int16_t)param, (int16_t)param, (iteration & 1) ? BLUE : YELLOW);
+	ILI9341_FB_Flush();
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_OledFill(uint32_t param, uint32_t iteration) {
+	(void)param;
+	ssd1306_Fill((iteration & 1) ? Black : White);
+	ssd1306_UpdateScreen();
+	I2CBus_WaitIdle(&I2CBus_1, SSD1306_WAIT_TIMEOUT);
+}
+
+static void HostCases_OledText(uint32_t param, uint32_t iteration) {
+	char line[] = "Temp 21.5 C  #0";
+	(void)param;
+
+	line[sizeof(line) - 2] = (char)('0' + iteration % 10);
+	ssd1306_SetCursor(0, 24);
+	ssd1306_WriteString(line, Font_6x8, White);
+	ssd1306_UpdateScreen();
+	I2CBus_WaitIdle(&I2CBus_1, SSD1306_WAIT_TIMEOUT);
+}
+
+static void HostCases_Ws2812(uint32_t param, uint32_t iteration) {
+	(void)param;
+	WS2812_SetAll((uint8_t)(iteration * 5U), 40, (uint8_t)(255U - iteration));
+	WS2812_Send();
+}
+
+static void HostCases_FileWrite(uint32_t param, uint32_t iteration) {
+	FIL file;
+	UINT done;
+	(void)iteration;
+
+	if (f_open(&file, HOST_CASES_IO_FILE, FA_OPEN_EXISTING | FA_WRITE) != FR_OK) return;
+	f_write(&file, HostCases_Io, param, &done);
+	f_close(&file);
+}
+
+static void HostCases_FileRead(uint32_t param, uint32_t iteration) {
+	FIL file;
+	UINT done;
+	(void)iteration;
+
+	if (f_open(&file, HOST_CASES_IO_FILE, FA_READ) != FR_OK) return;
+	f_read(&file, HostCases_Io, param, &done);
+	f_close(&file);
+}
+
+/**
+ * @brief  Erstes Bild vollständig senden, gemessen wird danach nur die Bewegung
+ */
+static void HostCases_PlotPrepare(uint32_t param) {
+	int16_t y = ILI9341_HEIGHT / 2;
+
+	HostCases_Seed = 1;
+	for (uint32_t i = 0; i < param && i < sizeof(HostCases_Plot) / sizeof(HostCases_Plot[0]); i++) {
+		// Mostly small steps, every few samples a flat stretch like a quiet ADC channel
+		int16_t step = (int16_t)(HostCases_Random() >> 29) - 4;
+		if ((i & 7) < 3) step = 0;
+		y += step;
+		if (y < 20) y = 20;
+		if (y > ILI9341_HEIGHT - 20) y = ILI9341_HEIGHT - 20;
+		HostCases_Plot[i] = y;
+	}
+}
+
+static void HostCases_TilePrepare(uint32_t param) {
+	ILI9341_Tile_InvalidateAll();
+	HostCases_TileFrame(param, 63);
+}
+
+/**
+ * @brief  Framebuffer einschalten und abgleichen, danach ist nichts mehr als verändert markiert
+ */
+static void HostCases_FbPrepare(uint32_t param) {
+	(void)param;
+	if (!ILI9341_FB_IsEnabled())
+		ILI9341_FB_Enable(1);
+	ILI9341_FB_Flush();
+	ILI9341_WaitWhileBusy();
+}
+
+static void HostCases_FbFinish(uint32_t param) {
+	(void)param;
+	ILI9341_FB_Enable(0);
+}
+
+/**
+ * @brief  Wie HostCases_FbPrepare(), dazu der zweite Framebuffer: gleiche Bytes, aber Wiedergabe aus dem Puffer
+ */
+static void HostCases_FbDoublePrepare(uint32_t param) {
+	HostCases_FbPrepare(param);
+	ILI9341_FB_SetDoubleBuffer(1);
+}
+
+static void HostCases_FbDoubleFinish(uint32_t param) {
+	ILI9341_FB_SetDoubleBuffer(0);
+	HostCases_FbFinish(param);
+}
+
+static void HostCases_ClipPrepare(uint32_t param) {
+	ILI9341_SetClip(0, 0, (uint16_t)param, ILI9341_HEIGHT);
+}
+
+static void HostCases_ClipFinish(uint32_t param) {
+	(void)param;
+	ILI9341_ResetClip();
+}
+
+static void HostCases_ClearGlyphs(uint32_t param) {
+	(void)param;
+	ILI9341_GlyphCacheClear();
+}
+
+static void HostCases_ResetSeed(uint32_t param) {
+	(void)param;
+	HostCases_Seed = 1;
+}
+
+/**
+ * @brief  Pseudozufallszahl wie DisplayBench_Random()
+ */
+static uint32_t HostCases_Random(void) {
+	HostCases_Seed = HostCases_Seed * 1664525UL + 1013904223UL;
+	return HostCases_Seed;
+}
@@ -0,0 +1,44 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef HOST_HOSTCASES_H_
+#define HOST_HOSTCASES_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Testbild auf der RAM-SD-Karte für ILI9341_DrawBinaryFile (wie DISPLAY_BENCH_FILE) */
+#define HOST_CASES_FILE         "SiMi_Logo_TFT.bin"
+#define HOST_CASES_FILE_WIDTH   100
+#define HOST_CASES_FILE_HEIGHT  79
+
+/**
+ * @brief Ein Messfall: eine Zeichenfunktion mit festem Parameter
+ *
+ * run() zeichnet genau einmal; iteration wechselt Farben, damit diff-basierte Treiber
+ * (SSD1306, Framebuffer) bei jedem Durchlauf wirklich senden. prepare() läuft vor jedem
+ * Durchlauf außerhalb der Messung, finish() einmal nach allen Durchläufen eines Falls und stellt
+ * den Ausgangszustand für die übrigen Fälle wieder her. Beide NULL, wenn nicht nötig.
+ */
+typedef struct {
+	const char *name;
+	uint32_t param;
+	void (*run)(uint32_t param, uint32_t iteration);
+	void (*prepare)(uint32_t param);
+	void (*finish)(uint32_t param);
+} HostCase;
+
+extern const HostCase HostCases[];
+extern const uint32_t HostCaseCount;
+
+uint8_t HostCases_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_HOSTCASES_H_ */
@@ -0,0 +1,75 @@
+/**
+ * @file    HostGBench.cpp
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   host_gbench: die Fälle aus HostCases.c als Google-Benchmark-Läufe
+ *
+ * Gemessen wird die Host-Laufzeit je Aufruf (Rastern, Kodieren, FatFs). Der Busverkehr wird
+ * vorher einmal je Fall in der Reihenfolge von host_bench aufgezeichnet und steht als Zähler
+ * daneben: wire_bytes über alle Schnittstellen und wire_us als geschätzte Leitungszeit.
+ * Filter und Ausgabeformat über die üblichen Optionen, z. B.
+ *   host_gbench --benchmark_filter=fill_rect --benchmark_format=json
+ */
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include "HostCases.h"
+#include "HalShim.h"
+
+/* Busverkehr des ersten Durchlaufs je Fall, ermittelt in main() in derselben Reihenfolge wie host_bench */
+struct HostGBench_Wire {
+	uint64_t bytes;
+	uint64_t ns;
+	uint32_t iteration;
+};
+
+static std::vector<HostGBench_Wire> HostGBench_Wires;
+
+static void HostGBench_Run(benchmark::State &state, uint32_t index) {
+	const HostCase *c = &HostCases[index];
+	HostGBench_Wire &wire = HostGBench_Wires[index];
+
+	for (auto _ : state) {
+		if (c->prepare != nullptr) {
+			state.PauseTiming();
+			c->prepare(c->param);
+			state.ResumeTiming();
+		}
+		// The library calls this function several times, the colours keep alternating across calls
+		c->run(c->param, wire.iteration++);
+	}
+	if (c->finish != nullptr) c->finish(c->param);
+
+	state.counters["wire_bytes"] = static_cast<double>(wire.bytes);
+	state.counters["wire_us"] = static_cast<double>(wire.ns) / 1000.0;
+}
+
+int main(int argc, char **argv) {
+	if (!HostCases_Init()) return 1;
+
+	for (uint32_t i = 0; i < HostCaseCount; i++) {
+		const HostCase *c = &HostCases[i];
+		HostGBench_Wire wire = { 0, 0, 1 };
+
+		if (c->prepare != nullptr) c->prepare(c->param);
+		HalShim_Reset();
+		c->run(c->param, 0);
+		if (c->finish != nullptr) c->finish(c->param);
+		for (uint32_t b = 0; b < HALSHIM_BUS_COUNT; b++) {
+			wire.bytes += HalShim_Buses[b].bytes;
+			wire.ns += HalShim_Buses[b].nanoseconds;
+		}
+		HostGBench_Wires.push_back(wire);
+
+		std::string name = std::string(c->name) + "/" + std::to_string(c->param);
+		benchmark::RegisterBenchmark(name.c_str(), HostGBench_Run, i);
+	}
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
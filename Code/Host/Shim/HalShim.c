@@ -0,0 +1,407 @@
+/**
+ * @file    HalShim.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   HAL-Funktionen für den Host-Build: zeichnen SPI-, I2C-, TIM- und SD-Verkehr auf
+ *
+ * Die Treiber laufen unverändert gegen diese Funktionen. Jede Übertragung wird gezählt (Aufrufe,
+ * Nutzbytes, Bustakte, Prüfsumme) und ihre Dauer aus dem Takt geschätzt, der im Handle bzw. im
+ * Register steht: SPI aus dem Vorteiler in CFG1 und der Framegröße, I2C aus TIMINGR, WS2812 aus
+ * der Periode von TIM1. Die Schätzung ist reine Leitungszeit ohne Pausen zwischen DMA-Blöcken.
+ *
+ * DMA- und Interrupt-Übertragungen sind sofort fertig: der Complete-Callback wird noch im
+ * Startaufruf ausgeführt. Die Treiber setzen ihre Busy-Flags vor dem Start, Warteschleifen wie
+ * ILI9341_WaitWhileBusy() kehren deshalb sofort zurück. HAL_GetTick() läuft auf einer virtuellen
+ * Uhr, die um die geschätzte Buszeit und um HAL_Delay() weiterzählt.
+ */
+
+#include "HalShim.h"
+
+#include "ILI9341.h"
+#include "I2CBus.h"
+
+#define HALSHIM_FNV_OFFSET   2166136261UL
+#define HALSHIM_FNV_PRIME    16777619UL
+
+// Upper bound for circular TIM DMA halves per start, guards against a driver that never stops
+#define HALSHIM_TIM_MAX_HALVES  (1UL << 20)
+
+SCB_Type HalShim_SCB;
+DWT_Type HalShim_DWT;
+GPIO_TypeDef HalShim_GPIO[11];
+SPI_TypeDef HalShim_SPI[6];
+I2C_TypeDef HalShim_I2C[4];
+TIM_TypeDef HalShim_TIM[8];
+uint32_t SystemCoreClock = 64000000UL;
+
+HalShim_Bus HalShim_Buses[HALSHIM_BUS_COUNT];
+
+static DMA_Stream_TypeDef HalShim_Streams[4];
+static DMA_HandleTypeDef hdma_spi1_tx = { &HalShim_Streams[0], { 0 } };
+static DMA_HandleTypeDef hdma_spi4_tx = { &HalShim_Streams[1], { 0 } };
+static DMA_HandleTypeDef hdma_i2c1_tx = { &HalShim_Streams[2], { 0 } };
+static DMA_HandleTypeDef hdma_tim1_ch1 = { &HalShim_Streams[3], { 0 } };
+
+SPI_HandleTypeDef hspi1;
+SPI_HandleTypeDef hspi4;
+I2C_HandleTypeDef hi2c1;
+I2C_HandleTypeDef hi2c2;
+TIM_HandleTypeDef htim1;
+SD_HandleTypeDef hsd1;
+
+static uint8_t HalShim_TimRunning;
+static uint64_t HalShim_DelayNs;
+
+static const char *const HalShim_BusNames[HALSHIM_BUS_COUNT] = {
+	"spi1", "spi4", "i2c1", "i2c2", "tim1", "sdmmc"
+};
+
+static HalShim_BusId HalShim_SpiBus(SPI_HandleTypeDef *hspi);
+static HalShim_BusId HalShim_I2cBus(I2C_HandleTypeDef *hi2c);
+static uint32_t HalShim_I2cClock(I2C_HandleTypeDef *hi2c);
+static void HalShim_I2cRecord(I2C_HandleTypeDef *hi2c, const uint8_t *data, uint16_t size,
+		uint16_t memAddSize, uint8_t restart);
+static void HalShim_TimHalf(TIM_HandleTypeDef *htim, const uint16_t *compare, uint16_t count);
+
+/**
+ * @brief  Stellt die Handles wie die MX_*_Init()-Funktionen ein und löscht die Zähler
+ */
+void HalShim_Init(void) {
+	hspi1.Instance = SPI1;
+	hspi1.Init.DataSize = SPI_DATASIZE_8BIT;
+	hspi1.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_2;
+	hspi1.Init.FifoThreshold = SPI_FIFO_THRESHOLD_01DATA;
+	hspi1.hdmatx = &hdma_spi1_tx;
+	HAL_SPI_Init(&hspi1);
+
+	hspi4.Instance = SPI4;
+	hspi4.Init.DataSize = SPI_DATASIZE_16BIT;
+	hspi4.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_16;
+	hspi4.Init.NSSPMode = SPI_NSS_PULSE_ENABLE;
+	hspi4.hdmatx = &hdma_spi4_tx;
+	HAL_SPI_Init(&hspi4);
+
+	hi2c1.Instance = I2C1;
+	hi2c1.Init.Timing = 0x00707CBB;
+	hi2c1.Instance->TIMINGR = hi2c1.Init.Timing;
+	hi2c1.hdmatx = &hdma_i2c1_tx;
+
+	hi2c2.Instance = I2C2;
+	hi2c2.Init.Timing = 0x00707CBB;
+	hi2c2.Instance->TIMINGR = hi2c2.Init.Timing;
+
+	// ARR for 800 kHz, as computed in MX_TIM1_Init()
+	htim1.Instance = TIM1;
+	htim1.Init.Period = HALSHIM_TIM1_HZ / 800000UL - 1;
+	htim1.Instance->ARR = htim1.Init.Period;
+	(void)hdma_tim1_ch1;
+
+	SCB->CCR |= SCB_CCR_DC_Msk;
+
+	for (uint32_t i = 0; i < HALSHIM_BUS_COUNT; i++)
+		HalShim_Buses[i].name = HalShim_BusNames[i];
+	HalShim_Reset();
+}
+
+/**
+ * @brief  Löscht die Zähler aller Schnittstellen, die virtuelle Uhr läuft weiter
+ */
+void HalShim_Reset(void) {
+	for (uint32_t i = 0; i < HALSHIM_BUS_COUNT; i++) {
+		HalShim_Bus *bus = &HalShim_Buses[i];
+		HalShim_DelayNs += bus->nanoseconds;
+		bus->transfers = 0;
+		bus->bytes = 0;
+		bus->clocks = 0;
+		bus->nanoseconds = 0;
+		bus->hash = HALSHIM_FNV_OFFSET;
+	}
+}
+
+/**
+ * @brief  Trägt eine Übertragung ein
+ * @param  bus: Schnittstelle
+ * @param  data: Nutzdaten wie im Speicher, NULL wenn nicht zu prüfen (Empfang)
+ * @param  bytes: Anzahl Nutzbytes
+ * @param  frameBytes: 2 bei 16-Bit-Frames (Bytepaare werden für die Prüfsumme getauscht), sonst 1
+ * @param  clocks: Bustakte der Übertragung
+ * @param  clockHz: Bustakt
+ */
+void HalShim_Record(HalShim_BusId bus, const uint8_t *data, uint32_t bytes, uint32_t frameBytes,
+		uint64_t clocks, uint32_t clockHz) {
+	HalShim_Bus *b = &HalShim_Buses[bus];
+
+	b->transfers++;
+	b->bytes += bytes;
+	b->clocks += clocks;
+	b->nanoseconds += clocks * 1000000000ULL / clockHz;
+
+	if (data == NULL) return;
+
+	uint32_t hash = b->hash;
+	for (uint32_t i = 0; i < bytes; i++) {
+		// 16-bit frames leave the shift register MSB first
+		uint32_t index = frameBytes == 2 ? (i ^ 1U) : i;
+		hash = (hash ^ data[index]) * HALSHIM_FNV_PRIME;
+	}
+	b->hash = hash;
+}
+
+/**
+ * @brief  Virtuelle Zeit seit dem Start: alle geschätzten Buszeiten plus HAL_Delay()
+ */
+uint64_t HalShim_Nanoseconds(void) {
+	uint64_t ns = HalShim_DelayNs;
+	for (uint32_t i = 0; i < HALSHIM_BUS_COUNT; i++)
+		ns += HalShim_Buses[i].nanoseconds;
+	return ns;
+}
+
+/* --------------------------------- HAL allgemein --------------------------------- */
+
+uint32_t HAL_GetTick(void) {
+	return (uint32_t)(HalShim_Nanoseconds() / 1000000ULL);
+}
+
+void HAL_Delay(uint32_t delay) {
+	HalShim_DelayNs += (uint64_t)delay * 1000000ULL;
+}
+
+void SCB_CleanDCache(void) { }
+void SCB_CleanInvalidateDCache(void) { }
+void SCB_CleanDCache_by_Addr(volatile void *addr, int32_t size) { (void)addr; (void)size; }
+void SCB_InvalidateDCache_by_Addr(volatile void *addr, int32_t size) { (void)addr; (void)size; }
+void SCB_CleanInvalidateDCache_by_Addr(volatile void *addr, int32_t size) { (void)addr; (void)size; }
+
+void Error_Handler(void) {
+}
+
+/* --------------------------------- GPIO --------------------------------- */
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+	if (PinState == GPIO_PIN_SET)
+		GPIOx->ODR |= GPIO_Pin;
+	else
+		GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+	return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+	GPIOx->ODR ^= GPIO_Pin;
+}
+
+/* --------------------------------- SPI --------------------------------- */
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi) {
+	hspi->Instance->CFG1 = hspi->Init.BaudRatePrescaler | hspi->Init.FifoThreshold | hspi->Init.DataSize;
+	return HAL_OK;
+}
+
+/**
+ * @brief  Zeichnet Size Frames auf; Framegröße und Bittakt kommen aus CFG1
+ */
+static void HalShim_SpiRecord(SPI_HandleTypeDef *hspi, const uint8_t *data, uint16_t size) {
+	uint32_t cfg1 = hspi->Instance->CFG1;
+	uint32_t frameBits = ((cfg1 & SPI_CFG1_DSIZE) >> SPI_CFG1_DSIZE_Pos) + 1;
+	uint32_t frameBytes = frameBits > 8 ? 2 : 1;
+	uint32_t kernel = hspi->Instance == SPI1 ? HALSHIM_SPI123_HZ : HALSHIM_SPI45_HZ;
+	uint32_t divider = 2UL << ((cfg1 & SPI_CFG1_MBR) >> SPI_CFG1_MBR_Pos);
+
+	HalShim_Record(HalShim_SpiBus(hspi), data, (uint32_t)size * frameBytes, frameBytes,
+			(uint64_t)size * frameBits, kernel / divider);
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void)Timeout;
+	if (pData == NULL || Size == 0) return HAL_ERROR;
+
+	HalShim_SpiRecord(hspi, pData, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void)Timeout;
+	if (pData == NULL || Size == 0) return HAL_ERROR;
+
+	uint32_t frameBytes = ((hspi->Instance->CFG1 & SPI_CFG1_DSIZE) >> SPI_CFG1_DSIZE_Pos) >= 8 ? 2 : 1;
+	memset(pData, 0, (size_t)Size * frameBytes);
+	HalShim_SpiRecord(hspi, NULL, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size) {
+	if (pData == NULL || Size == 0) return HAL_ERROR;
+
+	HalShim_SpiRecord(hspi, pData, Size);
+	HAL_SPI_TxCpltCallback(hspi);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size) {
+	if (pData == NULL || Size == 0) return HAL_ERROR;
+
+	memset(pData, 0, Size);
+	HalShim_SpiRecord(hspi, NULL, Size);
+	HAL_SPI_RxCpltCallback(hspi);
+	return HAL_OK;
+}
+
+/**
+ * @brief  Verteilt den Callback wie main.c (ohne LED-Matrix, die im Host-Build fehlt)
+ */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+	ILI9341_SPI_TxCpltCallback(hspi);
+}
+
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi) {
+	ILI9341_SPI_RxCpltCallback(hspi);
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+	ILI9341_SPI_ErrorCallback(hspi);
+}
+
+static HalShim_BusId HalShim_SpiBus(SPI_HandleTypeDef *hspi) {
+	return hspi->Instance == SPI4 ? HALSHIM_BUS_SPI4 : HALSHIM_BUS_SPI1;
+}
+
+/* --------------------------------- I2C --------------------------------- */
+
+void HAL_I2CEx_EnableFastModePlus(uint32_t ConfigFastModePlus) {
+	(void)ConfigFastModePlus;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+		uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void)DevAddress; (void)MemAddress; (void)Timeout;
+	HalShim_I2cRecord(hi2c, pData, Size, MemAddSize, 0);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+		uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+	(void)DevAddress; (void)MemAddress;
+	HalShim_I2cRecord(hi2c, pData, Size, MemAddSize, 0);
+	HAL_I2C_MemTxCpltCallback(hi2c);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+		uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+	return HAL_I2C_Mem_Write_IT(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+		uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+	(void)DevAddress; (void)MemAddress;
+	memset(pData, 0, Size);
+	HalShim_I2cRecord(hi2c, NULL, Size, MemAddSize, 1);
+	HAL_I2C_MemRxCpltCallback(hi2c);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size) {
+	(void)DevAddress;
+	HalShim_I2cRecord(hi2c, pData, Size, 0, 0);
+	HAL_I2C_MasterTxCpltCallback(hi2c);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size) {
+	return HAL_I2C_Master_Transmit_IT(hi2c, DevAddress, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size) {
+	(void)DevAddress;
+	memset(pData, 0, Size);
+	HalShim_I2cRecord(hi2c, NULL, Size, 0, 0);
+	HAL_I2C_MasterRxCpltCallback(hi2c);
+	return HAL_OK;
+}
+
+// Same dispatch as main.c
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) { I2CBus_CompleteCallback(hi2c); }
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) { I2CBus_CompleteCallback(hi2c); }
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) { I2CBus_CompleteCallback(hi2c); }
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) { I2CBus_CompleteCallback(hi2c); }
+
+static HalShim_BusId HalShim_I2cBus(I2C_HandleTypeDef *hi2c) {
+	return hi2c->Instance == I2C2 ? HALSHIM_BUS_I2C2 : HALSHIM_BUS_I2C1;
+}
+
+/**
+ * @brief  SCL-Takt aus TIMINGR: (PRESC + 1) * (SCLL + 1 + SCLH + 1) Kernel-Takte je Bit
+ */
+static uint32_t HalShim_I2cClock(I2C_HandleTypeDef *hi2c) {
+	uint32_t timing = hi2c->Instance->TIMINGR;
+	uint32_t presc = (timing >> 28) & 0xFU;
+	uint32_t sclh = (timing >> 8) & 0xFFU;
+	uint32_t scll = timing & 0xFFU;
+
+	return HALSHIM_PCLK1_HZ / ((presc + 1) * (scll + sclh + 2));
+}
+
+/**
+ * @brief  Eine I2C-Transaktion: Start, Adresse, Registeradresse, Daten und Stopp, je Byte 9 Takte
+ * @param  restart: 1 bei Mem_Read (wiederholter Start mit zweiter Adresse)
+ */
+static void HalShim_I2cRecord(I2C_HandleTypeDef *hi2c, const uint8_t *data, uint16_t size,
+		uint16_t memAddSize, uint8_t restart) {
+	uint32_t frames = 1 + memAddSize + size + (restart ? 1 : 0);
+	uint64_t clocks = (uint64_t)frames * 9 + 2 + (restart ? 1 : 0);
+
+	HalShim_Record(HalShim_I2cBus(hi2c), data, size, 1, clocks, HalShim_I2cClock(hi2c));
+}
+
+/* --------------------------------- TIM --------------------------------- */
+
+/**
+ * @brief  Spielt den zirkulären DMA-Strom ab, bis der Treiber HAL_TIM_PWM_Stop_DMA() aufruft
+ *
+ * Aufgezeichnet werden die Datenbits, die der Streifen sieht: ein Vergleichswert über der halben
+ * Periode ist eine '1'. Je 8 Vergleichswerte ergeben ein Nutzbyte.
+ */
+HAL_StatusTypeDef HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel, const uint32_t *pData, uint16_t Length) {
+	(void)Channel;
+	if (pData == NULL || Length < 2) return HAL_ERROR;
+
+	// The timer DMA moves half-words (WS2812_DmaBuffer)
+	const uint16_t *compare = (const uint16_t*)pData;
+	uint16_t half = Length / 2;
+
+	HalShim_TimRunning = 1;
+	for (uint32_t i = 0; i < HALSHIM_TIM_MAX_HALVES && HalShim_TimRunning; i++) {
+		uint8_t second = i & 1U;
+		HalShim_TimHalf(htim, compare + (second ? half : 0), half);
+		if (second)
+			HAL_TIM_PWM_PulseFinishedCallback(htim);
+		else
+			HAL_TIM_PWM_PulseFinishedHalfCpltCallback(htim);
+	}
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel) {
+	(void)htim; (void)Channel;
+	HalShim_TimRunning = 0;
+	return HAL_OK;
+}
+
+static void HalShim_TimHalf(TIM_HandleTypeDef *htim, const uint16_t *compare, uint16_t count) {
+	uint32_t period = htim->Init.Period + 1;
+	uint8_t bytes[64];
+	uint32_t n = count / 8;
+	if (n > sizeof(bytes)) n = sizeof(bytes);
+
+	for (uint32_t b = 0; b < n; b++) {
+		uint8_t value = 0;
+		for (uint32_t bit = 0; bit < 8; bit++)
+			value = (uint8_t)((value << 1) | (compare[b * 8 + bit] > period / 2 ? 1 : 0));
+		bytes[b] = value;
+	}
+
+	HalShim_Record(HALSHIM_BUS_TIM1, bytes, n, 1, count, HALSHIM_TIM1_HZ / period);
+}
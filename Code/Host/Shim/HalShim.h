@@ -0,0 +1,69 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef HOST_SHIM_HALSHIM_H_
+#define HOST_SHIM_HALSHIM_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Takte wie im Profil CLOCK_PROFILE_LOW_POWER (Clock.h) */
+#define HALSHIM_SPI123_HZ    42666667UL   // PLL1Q, Kernel-Takt von SPI1
+#define HALSHIM_SPI45_HZ     32000000UL   // PCLK2, Kernel-Takt von SPI4
+#define HALSHIM_PCLK1_HZ     32000000UL   // I2C-Kernel-Takt, daraus der Bittakt über TIMINGR
+#define HALSHIM_TIM1_HZ      64000000UL   // Zählertakt von TIM1 (WS2812)
+#define HALSHIM_SDMMC_HZ     21333333UL   // SDMMC1-Takt nach ClockDiv, 4 Datenleitungen
+
+/* Aufgezeichnete Schnittstellen */
+typedef enum {
+	HALSHIM_BUS_SPI1,     // Display (ILI9341)
+	HALSHIM_BUS_SPI4,     // LED-Matrix
+	HALSHIM_BUS_I2C1,     // OLED (SSD1306)
+	HALSHIM_BUS_I2C2,     // Sensoren
+	HALSHIM_BUS_TIM1,     // WS2812: ein Takt = ein Vergleichswert = ein Datenbit
+	HALSHIM_BUS_SDMMC,    // SD-Karte über SD_ReadSectors()/SD_WriteSectors()
+	HALSHIM_BUS_COUNT
+} HalShim_BusId;
+
+/**
+ * @brief Zähler einer Schnittstelle seit dem letzten HalShim_Reset()
+ *
+ * clocks sind Bustakte inklusive Protokoll (I2C: Adresse, ACK, Start/Stopp; SDMMC: CRC und
+ * Kommandos), nanoseconds die daraus mit dem jeweils eingestellten Takt geschätzte Busdauer.
+ * hash ist FNV-1a über die Nutzdaten in Leitungsreihenfolge (16-Bit-Frames MSB zuerst), damit
+ * ändert er sich nur, wenn sich die gesendeten Bytes ändern, nicht ihre Aufteilung.
+ */
+typedef struct {
+	const char *name;
+	uint32_t transfers;
+	uint64_t bytes;
+	uint64_t clocks;
+	uint64_t nanoseconds;
+	uint32_t hash;
+} HalShim_Bus;
+
+extern HalShim_Bus HalShim_Buses[HALSHIM_BUS_COUNT];
+
+/* Handles wie in spi.c, i2c.c, tim.c und sdmmc.c */
+extern SPI_HandleTypeDef hspi1;
+extern SPI_HandleTypeDef hspi4;
+extern I2C_HandleTypeDef hi2c1;
+extern I2C_HandleTypeDef hi2c2;
+extern TIM_HandleTypeDef htim1;
+extern SD_HandleTypeDef hsd1;
+
+void HalShim_Init(void);
+void HalShim_Reset(void);
+void HalShim_Record(HalShim_BusId bus, const uint8_t *data, uint32_t bytes, uint32_t frameBytes,
+		uint64_t clocks, uint32_t clockHz);
+uint64_t HalShim_Nanoseconds(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_SHIM_HALSHIM_H_ */
@@ -0,0 +1,171 @@
+/**
+ * @file    HostSd.c
+ * @author  simim
+ * @date    14. Oktober 2026
+ * @brief   SD-Karte im RAM für den Host-Build: BSP_SD_* hinter sd_diskio.c und SDCache.c
+ *
+ * Ersetzt bsp_driver_sd.c und die FatFs-Globals aus fatfs.c. sd_diskio.c, SDCache.c und SDCard.c
+ * laufen unverändert darüber. Jeder Blockzugriff wird auf HALSHIM_BUS_SDMMC gezählt: je Block
+ * 1024 Takte Daten (4 Leitungen), 16 Takte CRC und Start/Ende, je Aufruf zwei Kommandos mit
+ * Antwort (je 48 + 48 Takte auf CMD). Die Karte ist immer sofort bereit.
+ */
+
+#include "HostSd.h"
+
+#include <stdlib.h>
+#include "fatfs.h"
+#include "HalShim.h"
+
+#define HOSTSD_BLOCK_CLOCKS    (1024UL + 18UL)
+#define HOSTSD_COMMAND_CLOCKS  (2UL * 96UL)
+
+uint8_t retSD;
+char SDPath[4];
+FATFS SDFatFS;
+FIL SDFile;
+
+static uint8_t *HostSd_Image;
+
+static uint8_t HostSd_Access(uint32_t *data, uint32_t block, uint32_t count, uint8_t write);
+
+/**
+ * @brief  Legt die Karte an, meldet sie bei FatFs an und formatiert sie (FatFs wählt bei 16 MB FAT16)
+ * @retval 1 bei Erfolg
+ */
+uint8_t HostSd_Init(void) {
+	static BYTE work[_MAX_SS];
+
+	if (HostSd_Image == NULL) {
+		HostSd_Image = calloc(HOSTSD_SECTORS, HOSTSD_SECTOR_SIZE);
+		if (HostSd_Image == NULL) return 0;
+		retSD = FATFS_LinkDriver(&SD_Driver, SDPath);
+	}
+
+	if (f_mkfs(SDPath, FM_ANY, 0, work, sizeof(work)) != FR_OK) return 0;
+	return 1;
+}
+
+/**
+ * @brief  Schreibt eine Datei auf die Karte (Testbilder für ILI9341_DrawBinaryFile ...)
+ */
+FRESULT HostSd_WriteFile(const char *path, const void *data, uint32_t size) {
+	FATFS fs;
+	FIL file;
+	UINT written;
+
+	FRESULT res = f_mount(&fs, SDPath, 1);
+	if (res != FR_OK) return res;
+
+	res = f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res == FR_OK) {
+		res = f_write(&file, data, size, &written);
+		FRESULT closed = f_close(&file);
+		if (res == FR_OK) res = closed;
+		if (res == FR_OK && written != size) res = FR_DISK_ERR;
+	}
+
+	f_mount(NULL, SDPath, 0);
+	return res;
+}
+
+DWORD get_fattime(void) {
+	return 0;
+}
+
+/* --------------------------------- BSP_SD --------------------------------- */
+
+uint8_t BSP_SD_Init(void) {
+	return HostSd_Image != NULL ? MSD_OK : MSD_ERROR;
+}
+
+uint8_t BSP_SD_IsDetected(void) {
+	return HostSd_Image != NULL ? SD_PRESENT : SD_NOT_PRESENT;
+}
+
+uint8_t BSP_SD_GetCardState(void) {
+	return SD_TRANSFER_OK;
+}
+
+void BSP_SD_GetCardInfo(BSP_SD_CardInfo *CardInfo) {
+	memset(CardInfo, 0, sizeof(*CardInfo));
+	CardInfo->BlockNbr = HOSTSD_SECTORS;
+	CardInfo->BlockSize = HOSTSD_SECTOR_SIZE;
+	CardInfo->LogBlockNbr = HOSTSD_SECTORS;
+	CardInfo->LogBlockSize = HOSTSD_SECTOR_SIZE;
+}
+
+uint8_t BSP_SD_ReadBlocks(uint32_t *pData, uint32_t ReadAddr, uint32_t NumOfBlocks, uint32_t Timeout) {
+	(void)Timeout;
+	return HostSd_Access(pData, ReadAddr, NumOfBlocks, 0);
+}
+
+uint8_t BSP_SD_WriteBlocks(uint32_t *pData, uint32_t WriteAddr, uint32_t NumOfBlocks, uint32_t Timeout) {
+	(void)Timeout;
+	return HostSd_Access(pData, WriteAddr, NumOfBlocks, 1);
+}
+
+uint8_t BSP_SD_ReadBlocks_DMA(uint32_t *pData, uint32_t ReadAddr, uint32_t NumOfBlocks) {
+	uint8_t status = HostSd_Access(pData, ReadAddr, NumOfBlocks, 0);
+	if (status == MSD_OK) BSP_SD_ReadCpltCallback();
+	return status;
+}
+
+uint8_t BSP_SD_WriteBlocks_DMA(uint32_t *pData, uint32_t WriteAddr, uint32_t NumOfBlocks) {
+	uint8_t status = HostSd_Access(pData, WriteAddr, NumOfBlocks, 1);
+	if (status == MSD_OK) BSP_SD_WriteCpltCallback();
+	return status;
+}
+
+HAL_StatusTypeDef HAL_SD_Abort(SD_HandleTypeDef *hsd) {
+	(void)hsd;
+	return HAL_OK;
+}
+
+/**
+ * @brief  AU des Abbilds: 4 MB (Code 9), wie bei üblichen SDHC-Karten
+ */
+HAL_StatusTypeDef HAL_SD_GetCardStatus(SD_HandleTypeDef *hsd, HAL_SD_CardStatusTypeDef *pStatus) {
+	(void)hsd;
+	pStatus->AllocationUnitSize = 9;
+	pStatus->UhsAllocationUnitSize = 0;
+	return HAL_OK;
+}
+
+/* Das Abbild braucht kein Vorablöschen, ACMD23 wird angenommen und hat keine Wirkung */
+uint32_t SDMMC_CmdAppCommand(void *SDMMCx, uint32_t Argument) {
+	(void)SDMMCx;
+	(void)Argument;
+	return HAL_SD_ERROR_NONE;
+}
+
+uint32_t SDMMC_SendCommand(void *SDMMCx, const SDMMC_CmdInitTypeDef *Command) {
+	(void)SDMMCx;
+	(void)Command;
+	return HAL_SD_ERROR_NONE;
+}
+
+uint32_t SDMMC_GetCmdResp1(void *SDMMCx, uint8_t SD_CMD, uint32_t Timeout) {
+	(void)SDMMCx;
+	(void)SD_CMD;
+	(void)Timeout;
+	return HAL_SD_ERROR_NONE;
+}
+
+/**
+ * @brief  Kopiert Blöcke zwischen Puffer und Abbild und zählt den Verkehr
+ */
+static uint8_t HostSd_Access(uint32_t *data, uint32_t block, uint32_t count, uint8_t write) {
+	if (HostSd_Image == NULL || block + count > HOSTSD_SECTORS) return MSD_ERROR;
+
+	uint8_t *card = HostSd_Image + (size_t)block * HOSTSD_SECTOR_SIZE;
+	uint32_t bytes = count * HOSTSD_SECTOR_SIZE;
+
+	if (write)
+		memcpy(card, data, bytes);
+	else
+		memcpy(data, card, bytes);
+
+	HalShim_Record(HALSHIM_BUS_SDMMC, write ? (const uint8_t*)data : NULL, bytes, 1,
+			(uint64_t)count * HOSTSD_BLOCK_CLOCKS + HOSTSD_COMMAND_CLOCKS, HALSHIM_SDMMC_HZ);
+	return MSD_OK;
+}
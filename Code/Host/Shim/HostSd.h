@@ -0,0 +1,18 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+#ifndef HOST_SHIM_HOSTSD_H_
+#define HOST_SHIM_HOSTSD_H_
+
+#include "main.h"
+#include "ff.h"
+
+/* Größe der SD-Karte im RAM */
+#define HOSTSD_SECTORS       (16UL * 2048UL)   // 16 MB
+#define HOSTSD_SECTOR_SIZE   512UL
+
+uint8_t HostSd_Init(void);
+FRESULT HostSd_WriteFile(const char *path, const void *data, uint32_t size);
+
+#endif /* HOST_SHIM_HOSTSD_H_ */
@@ -0,0 +1,401 @@
+//
+// Created by simim on 14.10.2026.
+//
+
+/*
+ * Ersatz für den STM32H7-HAL-Header im Host-Build (Host/CMakeLists.txt).
+ *
+ * main.h bindet "stm32h7xx_hal.h" ein; da Drivers/ im Host-Build nicht im Include-Pfad liegt,
+ * landet jede Treiberdatei hier. Definiert ist nur, was ILI9341, SSD1306, WS2812, I2CBus, Cache
+ * und die FatFs-Anbindung tatsächlich benutzen: Handle-Strukturen mit den gelesenen Feldern,
+ * Register als einfache Variablen, die CMSIS-Intrinsics als C-Funktionen. Die HAL-Funktionen
+ * selbst liegen in HalShim.c und zeichnen den Busverkehr auf.
+ */
+
+#ifndef HOST_SHIM_STM32H7XX_HAL_H_
+#define HOST_SHIM_STM32H7XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Compiler / CMSIS --------------------------------- */
+
+#define __IO            volatile
+#define __I             volatile const
+#define __STATIC_INLINE static inline
+#define __weak          __attribute__((weak))
+#define __ALIGNED(x)    __attribute__((aligned(x)))
+#define UNUSED(x)       ((void)(x))
+
+#define SET_BIT(REG, BIT)                    ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT)                  ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT)                   ((REG) & (BIT))
+#define WRITE_REG(REG, VAL)                  ((REG) = (VAL))
+#define READ_REG(REG)                        ((REG))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK)  WRITE_REG((REG), (((READ_REG(REG)) & (~(CLEARMASK))) | (SETMASK)))
+
+// Single core without interrupts: exclusive access always succeeds
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) { }
+static inline void __enable_irq(void) { }
+static inline void __DSB(void) { }
+static inline void __DMB(void) { }
+static inline void __ISB(void) { }
+static inline void __NOP(void) { }
+static inline uint16_t __LDREXH(volatile uint16_t *addr) { return *addr; }
+static inline uint32_t __STREXH(uint16_t value, volatile uint16_t *addr) { *addr = value; return 0; }
+static inline uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+static inline uint32_t __REV16(uint32_t value) { return ((value & 0x00FF00FFUL) << 8) | ((value >> 8) & 0x00FF00FFUL); }
+#define __PKHBT(ARG1, ARG2, ARG3)  ((((uint32_t)(ARG1)) & 0x0000FFFFUL) | ((((uint32_t)(ARG2)) << (ARG3)) & 0xFFFF0000UL))
+
+typedef struct {
+	uint32_t CCR;
+} SCB_Type;
+
+typedef struct {
+	uint32_t CTRL;
+	uint32_t CYCCNT;
+} DWT_Type;
+
+#define SCB_CCR_DC_Msk   (1UL << 16)
+
+extern SCB_Type HalShim_SCB;
+extern DWT_Type HalShim_DWT;
+#define SCB   (&HalShim_SCB)
+#define DWT   (&HalShim_DWT)
+
+extern uint32_t SystemCoreClock;
+
+void SCB_CleanDCache(void);
+void SCB_CleanInvalidateDCache(void);
+void SCB_CleanDCache_by_Addr(volatile void *addr, int32_t size);
+void SCB_InvalidateDCache_by_Addr(volatile void *addr, int32_t size);
+void SCB_CleanInvalidateDCache_by_Addr(volatile void *addr, int32_t size);
+
+/* --------------------------------- HAL allgemein --------------------------------- */
+
+typedef enum {
+	HAL_OK      = 0x00U,
+	HAL_ERROR   = 0x01U,
+	HAL_BUSY    = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+	RESET = 0U,
+	SET = !RESET
+} FlagStatus, ITStatus;
+
+typedef enum {
+	DISABLE = 0U,
+	ENABLE = !DISABLE
+} FunctionalState;
+
+#define HAL_MAX_DELAY   0xFFFFFFFFU
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t delay);
+
+/* --------------------------------- GPIO --------------------------------- */
+
+typedef struct {
+	uint32_t ODR;
+	uint32_t IDR;
+	uint32_t BSRR;      // Pin.h schreibt hier, ODR folgt nicht (nur für BusStat gelesen, auf dem Host aus)
+} GPIO_TypeDef;
+
+typedef enum {
+	GPIO_PIN_RESET = 0U,
+	GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_PIN_0    ((uint16_t)0x0001)
+#define GPIO_PIN_1    ((uint16_t)0x0002)
+#define GPIO_PIN_2    ((uint16_t)0x0004)
+#define GPIO_PIN_3    ((uint16_t)0x0008)
+#define GPIO_PIN_4    ((uint16_t)0x0010)
+#define GPIO_PIN_5    ((uint16_t)0x0020)
+#define GPIO_PIN_6    ((uint16_t)0x0040)
+#define GPIO_PIN_7    ((uint16_t)0x0080)
+#define GPIO_PIN_8    ((uint16_t)0x0100)
+#define GPIO_PIN_9    ((uint16_t)0x0200)
+#define GPIO_PIN_10   ((uint16_t)0x0400)
+#define GPIO_PIN_11   ((uint16_t)0x0800)
+#define GPIO_PIN_12   ((uint16_t)0x1000)
+#define GPIO_PIN_13   ((uint16_t)0x2000)
+#define GPIO_PIN_14   ((uint16_t)0x4000)
+#define GPIO_PIN_15   ((uint16_t)0x8000)
+
+extern GPIO_TypeDef HalShim_GPIO[11];
+#define GPIOA   (&HalShim_GPIO[0])
+#define GPIOB   (&HalShim_GPIO[1])
+#define GPIOC   (&HalShim_GPIO[2])
+#define GPIOD   (&HalShim_GPIO[3])
+#define GPIOE   (&HalShim_GPIO[4])
+#define GPIOF   (&HalShim_GPIO[5])
+#define GPIOG   (&HalShim_GPIO[6])
+#define GPIOH   (&HalShim_GPIO[7])
+#define GPIOI   (&HalShim_GPIO[8])
+#define GPIOJ   (&HalShim_GPIO[9])
+#define GPIOK   (&HalShim_GPIO[10])
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+/* --------------------------------- DMA --------------------------------- */
+
+typedef struct {
+	uint32_t CR;
+	uint32_t NDTR;
+	uint32_t PAR;
+	uint32_t M0AR;
+} DMA_Stream_TypeDef;
+
+typedef struct {
+	uint32_t Request;
+	uint32_t Direction;
+	uint32_t PeriphInc;
+	uint32_t MemInc;
+	uint32_t PeriphDataAlignment;
+	uint32_t MemDataAlignment;
+	uint32_t Mode;
+	uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct {
+	void *Instance;
+	DMA_InitTypeDef Init;
+} DMA_HandleTypeDef;
+
+#define DMA_SxCR_PSIZE            (3UL << 11)
+#define DMA_SxCR_MSIZE            (3UL << 13)
+#define DMA_PDATAALIGN_BYTE       0x00000000U
+#define DMA_PDATAALIGN_HALFWORD   (1UL << 11)
+#define DMA_PDATAALIGN_WORD       (2UL << 11)
+#define DMA_MDATAALIGN_BYTE       0x00000000U
+#define DMA_MDATAALIGN_HALFWORD   (1UL << 13)
+#define DMA_MDATAALIGN_WORD       (2UL << 13)
+
+/* --------------------------------- SPI --------------------------------- */
+
+typedef struct {
+	uint32_t CR1;
+	uint32_t CR2;
+	uint32_t CFG1;
+	uint32_t CFG2;
+} SPI_TypeDef;
+
+typedef struct {
+	uint32_t Mode;
+	uint32_t Direction;
+	uint32_t DataSize;
+	uint32_t CLKPolarity;
+	uint32_t CLKPhase;
+	uint32_t NSS;
+	uint32_t BaudRatePrescaler;
+	uint32_t FirstBit;
+	uint32_t FifoThreshold;
+	uint32_t NSSPMode;
+} SPI_InitTypeDef;
+
+typedef struct __SPI_HandleTypeDef {
+	SPI_TypeDef *Instance;
+	SPI_InitTypeDef Init;
+	DMA_HandleTypeDef *hdmatx;
+	DMA_HandleTypeDef *hdmarx;
+	uint32_t State;
+	uint32_t ErrorCode;
+} SPI_HandleTypeDef;
+
+#define SPI_CFG1_DSIZE_Pos          0U
+#define SPI_CFG1_DSIZE              (0x1FUL << SPI_CFG1_DSIZE_Pos)
+#define SPI_CFG1_FTHLV_Pos          5U
+#define SPI_CFG1_FTHLV              (0xFUL << SPI_CFG1_FTHLV_Pos)
+#define SPI_CFG1_MBR_Pos            28U
+#define SPI_CFG1_MBR                (0x7UL << SPI_CFG1_MBR_Pos)
+#define SPI_CR1_SPE                 (1UL << 0)
+
+#define SPI_DATASIZE_8BIT           0x00000007UL
+#define SPI_DATASIZE_16BIT          0x0000000FUL
+#define SPI_FIFO_THRESHOLD_01DATA   (0x0UL << SPI_CFG1_FTHLV_Pos)
+#define SPI_FIFO_THRESHOLD_02DATA   (0x1UL << SPI_CFG1_FTHLV_Pos)
+#define SPI_BAUDRATEPRESCALER_2     (0x0UL << SPI_CFG1_MBR_Pos)
+#define SPI_BAUDRATEPRESCALER_4     (0x1UL << SPI_CFG1_MBR_Pos)
+#define SPI_BAUDRATEPRESCALER_8     (0x2UL << SPI_CFG1_MBR_Pos)
+#define SPI_BAUDRATEPRESCALER_16    (0x3UL << SPI_CFG1_MBR_Pos)
+#define SPI_NSS_PULSE_DISABLE       0x00000000UL
+#define SPI_NSS_PULSE_ENABLE        (1UL << 30)
+
+#define __HAL_SPI_ENABLE(__HANDLE__)   SET_BIT((__HANDLE__)->Instance->CR1, SPI_CR1_SPE)
+#define __HAL_SPI_DISABLE(__HANDLE__)  CLEAR_BIT((__HANDLE__)->Instance->CR1, SPI_CR1_SPE)
+
+extern SPI_TypeDef HalShim_SPI[6];
+#define SPI1   (&HalShim_SPI[0])
+#define SPI2   (&HalShim_SPI[1])
+#define SPI3   (&HalShim_SPI[2])
+#define SPI4   (&HalShim_SPI[3])
+#define SPI5   (&HalShim_SPI[4])
+#define SPI6   (&HalShim_SPI[5])
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi);
+
+/* --------------------------------- I2C --------------------------------- */
+
+typedef struct {
+	uint32_t CR1;
+	uint32_t TIMINGR;
+} I2C_TypeDef;
+
+typedef struct {
+	uint32_t Timing;
+	uint32_t OwnAddress1;
+	uint32_t AddressingMode;
+} I2C_InitTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+	I2C_TypeDef *Instance;
+	I2C_InitTypeDef Init;
+	DMA_HandleTypeDef *hdmatx;
+	DMA_HandleTypeDef *hdmarx;
+	uint32_t State;
+	uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_CR1_PE                  (1UL << 0)
+#define I2C_MEMADD_SIZE_8BIT        0x00000001U
+#define I2C_MEMADD_SIZE_16BIT       0x00000002U
+#define I2C_FASTMODEPLUS_I2C1       (1UL << 0)
+#define I2C_FASTMODEPLUS_I2C2       (1UL << 1)
+#define I2C_FASTMODEPLUS_I2C3       (1UL << 2)
+#define I2C_FASTMODEPLUS_I2C4       (1UL << 3)
+
+#define __HAL_I2C_ENABLE(__HANDLE__)   SET_BIT((__HANDLE__)->Instance->CR1, I2C_CR1_PE)
+#define __HAL_I2C_DISABLE(__HANDLE__)  CLEAR_BIT((__HANDLE__)->Instance->CR1, I2C_CR1_PE)
+
+extern I2C_TypeDef HalShim_I2C[4];
+#define I2C1   (&HalShim_I2C[0])
+#define I2C2   (&HalShim_I2C[1])
+#define I2C3   (&HalShim_I2C[2])
+#define I2C4   (&HalShim_I2C[3])
+
+void HAL_I2CEx_EnableFastModePlus(uint32_t ConfigFastModePlus);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+
+/* --------------------------------- TIM --------------------------------- */
+
+typedef struct {
+	uint32_t CR1;
+	uint32_t ARR;
+	uint32_t CCR1;
+} TIM_TypeDef;
+
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t CounterMode;
+	uint32_t Period;
+	uint32_t ClockDivision;
+	uint32_t RepetitionCounter;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+	TIM_TypeDef *Instance;
+	TIM_Base_InitTypeDef Init;
+	uint32_t Channel;
+} TIM_HandleTypeDef;
+
+#define TIM_CHANNEL_1   0x00000000U
+#define TIM_CHANNEL_2   0x00000004U
+#define TIM_CHANNEL_3   0x00000008U
+#define TIM_CHANNEL_4   0x0000000CU
+
+extern TIM_TypeDef HalShim_TIM[8];
+#define TIM1   (&HalShim_TIM[0])
+#define TIM2   (&HalShim_TIM[1])
+#define TIM3   (&HalShim_TIM[2])
+#define TIM4   (&HalShim_TIM[3])
+#define TIM5   (&HalShim_TIM[4])
+#define TIM6   (&HalShim_TIM[5])
+#define TIM7   (&HalShim_TIM[6])
+#define TIM8   (&HalShim_TIM[7])
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel, const uint32_t *pData, uint16_t Length);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel);
+void HAL_TIM_PWM_PulseFinishedHalfCpltCallback(TIM_HandleTypeDef *htim);
+void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim);
+
+/* --------------------------------- SDMMC --------------------------------- */
+
+typedef struct {
+	uint32_t CardType;
+	uint32_t CardVersion;
+	uint32_t Class;
+	uint32_t RelCardAdd;
+	uint32_t BlockNbr;
+	uint32_t BlockSize;
+	uint32_t LogBlockNbr;
+	uint32_t LogBlockSize;
+	uint32_t CardSpeed;
+} HAL_SD_CardInfoTypeDef;
+
+typedef struct {
+	void *Instance;
+	HAL_SD_CardInfoTypeDef SdCard;
+} SD_HandleTypeDef;
+
+/* SD-Status (ACMD13), nur die Felder, die sd_diskio.c ausliest */
+typedef struct {
+	uint8_t AllocationUnitSize;
+	uint8_t UhsAllocationUnitSize;
+} HAL_SD_CardStatusTypeDef;
+
+/* Einzelkommandos (SD_PreErase() in sd_diskio.c) */
+typedef struct {
+	uint32_t Argument;
+	uint32_t CmdIndex;
+	uint32_t Response;
+	uint32_t WaitForInterrupt;
+	uint32_t CPSM;
+} SDMMC_CmdInitTypeDef;
+
+#define CARD_SECURED          3U
+#define HAL_SD_ERROR_NONE     0U
+#define SDMMC_RESPONSE_SHORT  1U
+#define SDMMC_WAIT_NO         0U
+#define SDMMC_CPSM_ENABLE     1U
+#define SDMMC_CMDTIMEOUT      5000U
+
+HAL_StatusTypeDef HAL_SD_Abort(SD_HandleTypeDef *hsd);
+HAL_StatusTypeDef HAL_SD_GetCardStatus(SD_HandleTypeDef *hsd, HAL_SD_CardStatusTypeDef *pStatus);
+uint32_t SDMMC_CmdAppCommand(void *SDMMCx, uint32_t Argument);
+uint32_t SDMMC_SendCommand(void *SDMMCx, const SDMMC_CmdInitTypeDef *Command);
+uint32_t SDMMC_GetCmdResp1(void *SDMMCx, uint8_t SD_CMD, uint32_t Timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_SHIM_STM32H7XX_HAL_H_ */
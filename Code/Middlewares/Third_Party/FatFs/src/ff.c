@@ -20,6 +20,17 @@
 
 #include "ff.h"			/* Declarations of FatFs API */
 #include "diskio.h"		/* Declarations of device I/O functions */
+#include "ffconf_ext.h"		/* Project extensions not managed by CubeMX */
+
+#ifndef _USE_DIRCACHE
+#define _USE_DIRCACHE		0
+#endif
+#ifndef _DIRCACHE_ENTRIES
+#define _DIRCACHE_ENTRIES	16
+#endif
+#ifndef _DIRCACHE_PATH_MAX
+#define _DIRCACHE_PATH_MAX	48
+#endif
 
 
 /*--------------------------------------------------------------------------
@@ -541,6 +552,22 @@ static BYTE CurrVol;			/* Current drive */
 static FILESEM Files[_FS_LOCK];	/* Open object lock semaphores */
 #endif
 
+#if _USE_DIRCACHE && !_FS_READONLY
+typedef struct {
+	FATFS*	fs;			/* Volume of the entry (0:unused) */
+	WORD	id;			/* Mount ID of the volume */
+	WORD	ofs;		/* Offset of the SFN entry in its sector */
+	DWORD	sect;		/* Sector containing the SFN entry */
+	DWORD	dclust;		/* Start cluster of the containing directory (0:root) */
+	DWORD	dptr;		/* Offset of the SFN entry in the directory */
+	DWORD	sclust;		/* Start cluster of the file when cached */
+	BYTE	sfn[11];	/* SFN of the entry */
+	TCHAR	path[_DIRCACHE_PATH_MAX];	/* Path without drive */
+} DCENT;
+static DCENT DirCache[_DIRCACHE_ENTRIES];	/* Directory lookup cache */
+static UINT DirCacheNext;		/* Next entry to be replaced (round robin) */
+#endif
+
 #if _USE_LFN == 0		/* Non-LFN configuration */
 #define	DEF_NAMBUF
 #define INIT_NAMBUF(fs)
@@ -2283,6 +2310,110 @@ FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 
 
 
+#if _USE_DIRCACHE && !_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Directory lookup cache (project extension)                            */
+/*-----------------------------------------------------------------------*/
+
+static
+int dc_cmp (			/* 1:path equals the cached one */
+	const TCHAR* a,
+	const TCHAR* b
+)
+{
+	UINT i;
+
+	for (i = 0; i < _DIRCACHE_PATH_MAX; i++) {
+		if (a[i] != b[i]) return 0;
+		if (!a[i]) return 1;
+	}
+	return 0;
+}
+
+
+static
+void dc_invalidate (	/* Forget cached entries of a directory whose entries change */
+	FATFS* fs,
+	DWORD dclust
+)
+{
+	UINT i;
+
+	for (i = 0; i < _DIRCACHE_ENTRIES; i++) {
+		if (DirCache[i].fs == fs && DirCache[i].dclust == dclust) DirCache[i].fs = 0;
+	}
+}
+
+
+static
+int dc_lookup (			/* 1:dp points to the checked SFN entry of the path, 0:not cached */
+	DIR* dp,			/* Directory object with obj.fs set */
+	const TCHAR* path	/* Path without drive */
+)
+{
+	FATFS *fs = dp->obj.fs;
+	DCENT *e = 0;
+	BYTE *dir;
+	UINT i;
+
+
+	if (fs->fs_type == FS_EXFAT) return 0;
+	for (i = 0; i < _DIRCACHE_ENTRIES && !e; i++) {
+		if (DirCache[i].fs == fs && DirCache[i].id == fs->id && dc_cmp(DirCache[i].path, path)) e = &DirCache[i];
+	}
+	if (!e) return 0;
+
+	/* The entry must still be the same object: removed, reused or truncated entries miss */
+	if (move_window(fs, e->sect) != FR_OK) return 0;
+	dir = fs->win + e->ofs;
+	if (dir[DIR_Name] == DDEM || dir[DIR_Name] == 0 || mem_cmp(dir, e->sfn, 11) || ld_clust(fs, dir) != e->sclust) {
+		e->fs = 0;
+		return 0;
+	}
+
+	dp->obj.sclust = e->dclust;		/* As left by follow_path() */
+	dp->obj.attr = dir[DIR_Attr] & AM_MASK;
+	dp->dptr = e->dptr;
+	dp->sect = e->sect;
+	dp->dir = dir;
+	dp->fn[NSFLAG] = 0;
+	return 1;
+}
+
+
+static
+void dc_store (			/* Remember the entry that follow_path() found for the path */
+	const DIR* dp,
+	const TCHAR* path
+)
+{
+	FATFS *fs = dp->obj.fs;
+	DCENT *e;
+	UINT i;
+
+
+	if (fs->fs_type == FS_EXFAT) return;
+	for (i = 0; path[i]; i++) {
+		if (i + 1 >= _DIRCACHE_PATH_MAX) return;	/* Too long to be cached */
+	}
+
+	e = &DirCache[DirCacheNext];
+	DirCacheNext = (DirCacheNext + 1) % _DIRCACHE_ENTRIES;
+	e->fs = fs;
+	e->id = fs->id;
+	e->sect = fs->winsect;
+	e->ofs = (WORD)(dp->dir - fs->win);
+	e->dclust = dp->obj.sclust;
+	e->dptr = dp->dptr;
+	e->sclust = ld_clust(fs, dp->dir);
+	mem_cpy(e->sfn, dp->dir, 11);
+	mem_cpy(e->path, path, (i + 1) * sizeof (TCHAR));
+}
+#endif
+
+
+
+
 #if !_FS_READONLY
 /*-----------------------------------------------------------------------*/
 /* Register an object to the directory                                   */
@@ -2301,6 +2432,11 @@ FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too many S
 
 
 	if (dp->fn[NSFLAG] & (NS_DOT | NS_NONAME)) return FR_INVALID_NAME;	/* Check name validity */
+#endif
+#if _USE_DIRCACHE
+	dc_invalidate(fs, dp->obj.sclust);	/* A new entry may take the slot of a cached one */
+#endif
+#if _USE_LFN != 0
 	for (nlen = 0; fs->lfnbuf[nlen]; nlen++) ;	/* Get lfn length */
 
 #if _FS_EXFAT
@@ -2401,6 +2537,12 @@ FRESULT dir_remove (	/* FR_OK:Succeeded, FR_DISK_ERR:A disk error */
 	FATFS *fs = dp->obj.fs;
 #if _USE_LFN != 0	/* LFN configuration */
 	DWORD last = dp->dptr;
+#endif
+
+#if _USE_DIRCACHE
+	dc_invalidate(fs, dp->obj.sclust);
+#endif
+#if _USE_LFN != 0
 
 	res = (dp->blk_ofs == 0xFFFFFFFF) ? FR_OK : dir_sdi(dp, dp->blk_ofs);	/* Goto top of the entry block if LFN is exist */
 	if (res == FR_OK) {
@@ -3317,6 +3459,9 @@ FRESULT f_open (
 #if !_FS_READONLY
 	DWORD dw, cl, bcs, clst, sc;
 	FSIZE_t ofs;
+#endif
+#if _USE_DIRCACHE && !_FS_READONLY
+	int cached;
 #endif
 	DEF_NAMBUF
 
@@ -3329,7 +3474,12 @@ FRESULT f_open (
 	if (res == FR_OK) {
 		dj.obj.fs = fs;
 		INIT_NAMBUF(fs);
+#if _USE_DIRCACHE && !_FS_READONLY
+		cached = mode == FA_READ && dc_lookup(&dj, path);	/* Known path: no directory search */
+		res = cached ? FR_OK : follow_path(&dj, path);
+#else
 		res = follow_path(&dj, path);	/* Follow the file path */
+#endif
 #if !_FS_READONLY	/* R/W configuration */
 		if (res == FR_OK) {
 			if (dj.fn[NSFLAG] & NS_NONAME) {	/* Origin directory itself? */
@@ -3424,6 +3574,9 @@ FRESULT f_open (
 				mode |= FA_MODIFIED;
 			fp->dir_sect = fs->winsect;			/* Pointer to the directory entry */
 			fp->dir_ptr = dj.dir;
+#if _USE_DIRCACHE
+			if (mode == FA_READ && !cached) dc_store(&dj, path);
+#endif
 #if _FS_LOCK != 0
 			fp->obj.lockid = inc_lock(&dj, (mode & ~FA_READ) ? 1 : 0);
 			if (!fp->obj.lockid) res = FR_INT_ERR;
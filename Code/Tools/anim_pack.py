@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""
+anim_pack.py - Packt Einzelbilder zu einer Animation für Anim_PlayFile/-Asset (Core/Src/Anim.c).
+
+Aufbau (Little Endian, passend zu Core/Inc/Anim.h):
+
+    Anim_Header  magic "ANI1", version, flags, width, height, frameCount, frameUs,
+                 tableOffset, size, reserviert                                   (32 Bytes)
+    Daten        je Bild der geänderte Bereich, rohes RGB565 (High-Byte zuerst) oder
+                 komprimiertes Bild mit ILI9341_ImageHeader (siehe image_compress.py)
+    Anim_Frame   offset, size, x, y, width, height, format, flags, reserviert
+                 (20 Bytes je Bild, ab tableOffset)
+
+Jedes Bild speichert nur das Rechteck, in dem es sich vom Vorgänger unterscheidet, und davon
+das kleinere aus RGB565 und RLE/LZ4; unveränderte Bilder haben keine Daten. Bild 0 und jedes
+--key-te Bild sind Schlüsselbilder über die ganze Fläche: Nur bis zu ihnen darf die Firmware
+Bilder überspringen, wenn sie mit der Bildrate nicht nachkommt.
+
+Aufruf:
+    python3 anim_pack.py ausgabe.anim bild000.png bild001.png ...
+    python3 anim_pack.py ausgabe.anim ordner/                        (alle Bilder, nach Namen sortiert)
+    Optionen: --fps N (Standard 30), --key N (Standard 30, 0 = nur Bild 0), --once (ohne Schleife),
+              --size B H (Bilder umrechnen)
+Mit asset_pack.py landet die Datei als Typ anim im Bundle ('anim asset:name' in der Shell).
+"""
+
+import os
+import struct
+import sys
+
+from image_compress import compress, load_rgb565
+
+ANIM_MAGIC = 0x31494E41
+ANIM_VERSION = 1
+ANIM_FLAG_LOOP = 0x0001
+ANIM_FRAME_KEY = 0x01
+
+FORMAT_SAME, FORMAT_RGB565, FORMAT_CIMG = 0, 1, 2
+
+HEADER_FORMAT = "<IHHHHIIIII"
+FRAME_FORMAT = "<IIHHHHBBH"
+IMAGE_EXTENSIONS = (".png", ".bmp", ".gif", ".jpg", ".jpeg", ".bin")
+
+
+def dirty_rect(previous, current, width, height):
+    """Kleinstes Rechteck (x, y, w, h), in dem sich zwei RGB565-Bilder unterscheiden, sonst None."""
+    stride = width * 2
+    rows = [y for y in range(height) if previous[y * stride:(y + 1) * stride] != current[y * stride:(y + 1) * stride]]
+    if not rows:
+        return None
+    top, bottom = rows[0], rows[-1]
+    left, right = width, -1
+    for y in range(top, bottom + 1):
+        row = y * stride
+        for x in range(width):
+            p = row + x * 2
+            if previous[p:p + 2] != current[p:p + 2]:
+                left = min(left, x)
+                right = max(right, x)
+                break
+        for x in range(width - 1, right, -1):
+            p = row + x * 2
+            if previous[p:p + 2] != current[p:p + 2]:
+                right = x
+                break
+    return left, top, right - left + 1, bottom - top + 1
+
+
+def crop(data, width, x, y, w, h):
+    stride = width * 2
+    return b"".join(data[(y + r) * stride + x * 2:(y + r) * stride + (x + w) * 2] for r in range(h))
+
+
+def encode_frame(data, x, y, w, h, width):
+    """Liefert (format, Daten) für einen Bereich, das kleinere aus RGB565 und komprimiert."""
+    raw = crop(data, width, x, y, w, h)
+    blob = compress(raw, w, h)[1]
+    if len(blob) < len(raw):
+        return FORMAT_CIMG, blob
+    return FORMAT_RGB565, raw
+
+
+def pack(frames, width, height, fps, key, loop):
+    header_size = struct.calcsize(HEADER_FORMAT)
+    data = bytearray()
+    table = bytearray()
+    previous = None
+
+    for n, current in enumerate(frames):
+        keyframe = previous is None or (key > 0 and n % key == 0)
+        rect = (0, 0, width, height) if keyframe else dirty_rect(previous, current, width, height)
+        if rect is None:
+            table += struct.pack(FRAME_FORMAT, 0, 0, 0, 0, 0, 0, FORMAT_SAME, 0, 0)
+        else:
+            fmt, blob = encode_frame(current, *rect, width)
+            table += struct.pack(FRAME_FORMAT, header_size + len(data), len(blob), *rect, fmt,
+                                 ANIM_FRAME_KEY if keyframe else 0, 0)
+            data += blob
+        previous = current
+
+    table_offset = header_size + len(data)
+    size = table_offset + len(table)
+    header = struct.pack(HEADER_FORMAT, ANIM_MAGIC, ANIM_VERSION, ANIM_FLAG_LOOP if loop else 0,
+                         width, height, len(frames), round(1000000 / fps), table_offset, size, 0)
+    return header + bytes(data) + bytes(table)
+
+
+def list_frames(paths):
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files += sorted(os.path.join(path, name) for name in os.listdir(path)
+                            if name.lower().endswith(IMAGE_EXTENSIONS))
+        else:
+            files.append(path)
+    return files
+
+
+def main(argv):
+    fps, key, loop, size = 30.0, 30, True, (None, None)
+    args = []
+    i = 1
+    try:
+        while i < len(argv):
+            if argv[i] == "--fps":
+                fps = float(argv[i + 1])
+                i += 1
+            elif argv[i] == "--key":
+                key = int(argv[i + 1])
+                i += 1
+            elif argv[i] == "--size":
+                size = (int(argv[i + 1]), int(argv[i + 2]))
+                i += 2
+            elif argv[i] == "--once":
+                loop = False
+            else:
+                args.append(argv[i])
+            i += 1
+    except (IndexError, ValueError):
+        args = []
+
+    if len(args) < 2 or fps <= 0 or fps > 1000:
+        sys.stderr.write("Aufruf: %s [--fps N] [--key N] [--once] [--size B H] <ausgabe.anim> <bilder|ordner>...\n"
+                         % argv[0])
+        return 2
+
+    try:
+        files = list_frames(args[1:])
+        if not files:
+            raise ValueError("keine Bilder gefunden")
+        frames = []
+        width, height = size
+        for path in files:
+            data, w, h = load_rgb565(path, width, height)
+            if width is not None and (w, h) != (width, height):
+                raise ValueError("%s: %dx%d, erwartet %dx%d" % (path, w, h, width, height))
+            width, height = w, h
+            frames.append(data)
+        blob = pack(frames, width, height, fps, key, loop)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("anim_pack: %s\n" % error)
+        return 1
+
+    with open(args[0], "wb") as f:
+        f.write(blob)
+    print("%s: %d Bilder %dx%d, %.1f Bilder/s, %d -> %d Bytes" % (args[0], len(frames), width, height, fps,
+          len(frames) * width * height * 2, len(blob)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+asset_pack.py - Packt Bilder, Zeichensätze und Tabellen zu einem Asset-Bundle für den W25Qxx.
+
+Aufbau (Little Endian, passend zu Core/Inc/Asset.h):
+
+    Asset_Header  magic "ASB1", version, count, size, CRC-32 des Index   (16 Bytes)
+    Asset_Entry   hash, offset, size, width, height, type, 3x reserviert, CRC-32 der Daten
+                  (24 Bytes je Asset, aufsteigend nach FNV-1a-Hash des Namens sortiert)
+    Daten         jedes Asset auf ASSET_ALIGNMENT (32 Bytes) ausgerichtet, Füllbytes 0xFF
+
+Die Asset-Liste ist eine Textdatei, eine Zeile pro Asset, '#' leitet Kommentare ein:
+
+    # name                typ     datei                 [breite höhe | größe]
+    SiMi_Logo_TFT.bin     rgb565  SiMi_Logo_TFT.bin     100 79
+    sans18                font    DejaVuSans.ttf        18
+    fixed                 font    6x13.bdf
+    TFO_TFT.bin           rgb565  TFO.png
+    cursor                sprite  cursor.png
+    background            cimg    background.png
+    icons                 indexed icons.png
+    photo                 jpeg    photo.jpg
+    spinner               anim    spinner.anim
+    gamma                 table   gamma.bin
+    icons16               atlas   icons16.atlas
+
+Typen: raw, rgb565, font, table, rle, lz4, indexed (Farbtabelle, höchstens 256 Farben) und cimg
+(komprimiertes Bild, cimg wählt das kleinere Verfahren, siehe image_compress.py), jpeg (Hardware-Codec, Größe aus dem Kopf),
+sprite (RGB565 plus 1-Bit-Maske aus dem Alphakanal, deckend ab Alpha 128, siehe ILI9341_Sprite.h)
+und anim (Animation von anim_pack.py, unverändert übernommen, Größe aus dem Kopf).
+Ein atlas-Eintrag zeigt auf eine Atlas-Liste, atlas_pack.py packt deren Symbole zu Streifen.
+Ein font-Eintrag mit einer .bdf- oder .ttf-Datei wird mit font_atlas.py in einen ILI9341_t3-Font
+umgewandelt (ASCII 32-126, 1 Bit pro Pixel), TTF braucht dazu die Größe in Pixeln; andere Dateien
+werden unverändert übernommen. Rohe .bin-Bilder (RGB565, High-Byte zuerst) brauchen
+Breite und Höhe; andere Bildformate werden mit Pillow umgerechnet. Dateipfade sind relativ zur Liste.
+
+Aufruf:
+    python3 asset_pack.py assets.txt assets.bin
+
+Das Bundle wird an ASSET_BUNDLE_ADDRESS (Standard 0x000000) in den Flash geschrieben,
+z.B. mit dem STM32CubeProgrammer und dem External Loader des W25Q128.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+from atlas_pack import build_file as build_atlas
+from font_atlas import build_file as build_font
+from image_compress import compress, load_rgb565
+
+ASSET_MAGIC = 0x31425341
+ASSET_VERSION = 2
+ASSET_ALIGNMENT = 32
+ASSET_BUNDLE_MAX_SIZE = 4 * 1024 * 1024
+
+HEADER_FORMAT = "<IHHII"
+ENTRY_FORMAT = "<IIIHHB3xI"
+
+TYPES = {"raw": 0, "rgb565": 1, "font": 2, "table": 3, "rle": 4, "lz4": 4, "indexed": 4, "cimg": 4, "jpeg": 5, "sprite": 6, "anim": 7, "atlas": 8}
+
+
+def fnv1a(name):
+    h = 2166136261
+    for b in name.encode("utf-8"):
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def jpeg_size(data, path):
+    """Liest Breite und Höhe aus dem SOF-Marker einer JPEG-Datei."""
+    i = 2
+    while i + 9 <= len(data) and data[i] == 0xFF:
+        marker = data[i + 1]
+        length = struct.unpack(">H", data[i + 2:i + 4])[0]
+        if marker in (0xC0, 0xC1, 0xC2):
+            height, width = struct.unpack(">HH", data[i + 5:i + 9])
+            return width, height
+        i += 2 + length
+    raise ValueError("%s: kein SOF-Marker gefunden" % path)
+
+
+def anim_size(data, path):
+    """Liest Breite und Höhe aus dem Anim_Header einer Animation."""
+    if len(data) < 32 or struct.unpack_from("<I", data)[0] != 0x31494E41:
+        raise ValueError("%s: keine Animation (anim_pack.py)" % path)
+    return struct.unpack_from("<HH", data, 8)
+
+
+def load_sprite(path, width=None, height=None):
+    """Lädt ein Bild mit Alphakanal als RGB565 (High-Byte zuerst) gefolgt von der Maske,
+    (breite + 7) // 8 Bytes je Zeile, höchstes Bit links. Durchsichtige Pixel werden 0."""
+    from PIL import Image
+    image = Image.open(path).convert("RGBA")
+    if width is not None and image.size != (width, height):
+        image = image.resize((width, height))
+    width, height = image.size
+    stride = (width + 7) // 8
+    pixels = bytearray()
+    mask = bytearray(stride * height)
+    for i, (r, g, b, a) in enumerate(image.getdata()):
+        opaque = a >= 128
+        pixels += struct.pack(">H", ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3) if opaque else 0)
+        if opaque:
+            y, x = divmod(i, width)
+            mask[y * stride + x // 8] |= 0x80 >> (x % 8)
+    return bytes(pixels + mask), width, height
+
+
+def read_list(path):
+    base = os.path.dirname(os.path.abspath(path))
+    assets = []
+    with open(path, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if fields[1:2] == ["font"] and len(fields) in (3, 4):
+                name, kind, filename = fields[:3]
+                filename = os.path.join(base, filename)
+                if filename.lower().endswith((".bdf", ".ttf", ".otf")):
+                    data = build_font(filename, int(fields[3]) if len(fields) == 4 else None)
+                else:
+                    with open(filename, "rb") as f2:
+                        data = f2.read()
+                assets.append((name, TYPES[kind], data, 0, 0))
+                continue
+            if len(fields) not in (3, 5) or fields[1] not in TYPES:
+                raise ValueError("%s:%d: erwartet 'name typ datei [breite höhe]'" % (path, number))
+            name, kind, filename = fields[:3]
+            width = int(fields[3]) if len(fields) == 5 else None
+            height = int(fields[4]) if len(fields) == 5 else None
+            filename = os.path.join(base, filename)
+
+            if kind == "rgb565":
+                data, width, height = load_rgb565(filename, width, height)
+            elif kind == "atlas":
+                data, width, height = build_atlas(filename)
+            elif kind == "sprite":
+                data, width, height = load_sprite(filename, width, height)
+            elif TYPES[kind] == 4:
+                data, width, height = load_rgb565(filename, width, height)
+                data = compress(data, width, height, None if kind == "cimg" else kind)[1]
+            else:
+                with open(filename, "rb") as f2:
+                    data = f2.read()
+                if kind == "jpeg":
+                    width, height = jpeg_size(data, filename)
+                elif kind == "anim":
+                    width, height = anim_size(data, filename)
+            assets.append((name, TYPES[kind], data, width or 0, height or 0))
+    return assets
+
+
+def pack(assets):
+    entries = {}
+    for name, kind, data, width, height in assets:
+        h = fnv1a(name)
+        if h in entries:
+            raise ValueError("Hash-Kollision: '%s' und '%s'" % (name, entries[h][0]))
+        entries[h] = (name, kind, data, width, height)
+
+    index_size = struct.calcsize(HEADER_FORMAT) + len(entries) * struct.calcsize(ENTRY_FORMAT)
+    offset = (index_size + ASSET_ALIGNMENT - 1) & ~(ASSET_ALIGNMENT - 1)
+
+    index = bytearray()
+    payload = bytearray()
+    for h in sorted(entries):
+        name, kind, data, width, height = entries[h]
+        index += struct.pack(ENTRY_FORMAT, h, offset + len(payload), len(data), width, height, kind,
+                             zlib.crc32(data) & 0xFFFFFFFF)
+        payload += data
+        payload += b"\xff" * (-len(payload) % ASSET_ALIGNMENT)
+
+    size = offset + len(payload)
+    if size > ASSET_BUNDLE_MAX_SIZE:
+        raise ValueError("Bundle mit %d Bytes größer als %d" % (size, ASSET_BUNDLE_MAX_SIZE))
+
+    header = struct.pack(HEADER_FORMAT, ASSET_MAGIC, ASSET_VERSION, len(entries), size,
+                         zlib.crc32(bytes(index)) & 0xFFFFFFFF)
+    blob = header + index
+    blob += b"\xff" * (offset - len(blob))
+    return blob + payload
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("Aufruf: %s <assetliste.txt> <bundle.bin>\n" % argv[0])
+        return 2
+    try:
+        assets = read_list(argv[1])
+        blob = pack(assets)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("asset_pack: %s\n" % error)
+        return 1
+
+    with open(argv[2], "wb") as f:
+        f.write(blob)
+    print("%s: %d Assets, %d Bytes" % (argv[2], len(assets), len(blob)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+atlas_pack.py - Packt kleine Symbole zu einem Atlas-Asset (ASSET_TYPE_ATLAS) für das Bundle.
+
+Aufbau (Little Endian, passend zu Asset_AtlasHeader in Core/Inc/Asset.h):
+
+    Asset_AtlasHeader  magic "ATL1", Anzahl Symbole, Anzahl Streifen, Offset der Streifen,
+                       Offset der Rechtecke                                        (16 Bytes)
+    Asset_AtlasStrip   Offset der Pixel, Breite (Zeilenlänge), Höhe                (8 Bytes je Streifen)
+    Asset_AtlasRect    FNV-1a-Hash des Namens, x im Streifen, Breite, Höhe, Streifen, 1x reserviert
+                       (12 Bytes je Symbol, aufsteigend nach Hash sortiert)
+    Pixel              je Streifen RGB565 (High-Byte zuerst) zeilenweise, auf 32 Bytes ausgerichtet
+
+Jede Gruppe der Liste wird ein Streifen, ihre Symbole stehen darin in Listenreihenfolge
+lückenlos nebeneinander. Werden sie in dieser Reihenfolge nebeneinander gezeichnet
+(Asset_DrawAtlasRow()), ist die ganze Gruppe ein Adressfenster und ein DMA-Block. Die Höhe eines
+Streifens ist die des höchsten Symbols, darunter wird mit 0 (schwarz) aufgefüllt; Symbole
+einer Gruppe sollten deshalb gleich hoch sein.
+
+Die Atlas-Liste ist eine Textdatei, eine Zeile pro Symbol, '#' leitet Kommentare ein:
+
+    # gruppe      name        datei          [breite höhe]
+    toolbar       play        play.png
+    toolbar       pause       pause.png
+    toolbar       stop        stop.bin       16 16
+    status        sd          sd.png
+
+Rohe .bin-Bilder (RGB565, High-Byte zuerst) brauchen Breite und Höhe, andere Bildformate
+werden mit Pillow umgerechnet. Dateipfade sind relativ zur Liste.
+
+Aufruf:
+    python3 atlas_pack.py icons.atlas icons.bin
+
+asset_pack.py ruft build_file() direkt auf, wenn ein 'atlas'-Eintrag auf eine Atlas-Liste zeigt.
+"""
+
+import os
+import struct
+import sys
+
+from image_compress import load_rgb565
+
+ATLAS_MAGIC = 0x314C5441
+ATLAS_ALIGNMENT = 32
+
+HEADER_FORMAT = "<IHHII"
+STRIP_FORMAT = "<IHH"
+RECT_FORMAT = "<IHHHBx"
+
+
+def fnv1a(name):
+    h = 0x811C9DC5
+    for byte in name.encode("utf-8"):
+        h = ((h ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def read_list(path):
+    """Liefert die Gruppen in Listenreihenfolge: [(gruppe, [(name, pixel, breite, höhe), ...]), ...]."""
+    base = os.path.dirname(os.path.abspath(path))
+    groups = {}
+    with open(path, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if len(fields) not in (3, 5):
+                raise ValueError("%s:%d: erwartet 'gruppe name datei [breite höhe]'" % (path, number))
+            group, name, filename = fields[:3]
+            width = int(fields[3]) if len(fields) == 5 else None
+            height = int(fields[4]) if len(fields) == 5 else None
+            data, width, height = load_rgb565(os.path.join(base, filename), width, height)
+            groups.setdefault(group, []).append((name, data, width, height))
+    return list(groups.items())
+
+
+def build(groups):
+    if not groups:
+        raise ValueError("Atlas ohne Symbole")
+    if len(groups) > 255:
+        raise ValueError("%d Gruppen, höchstens 255" % len(groups))
+
+    rects = {}
+    strips = []
+    for number, (group, icons) in enumerate(groups):
+        width = sum(icon[2] for icon in icons)
+        height = max(icon[3] for icon in icons)
+        if width > 0xFFFF:
+            raise ValueError("Gruppe '%s' mit %d Pixeln zu breit" % (group, width))
+        rows = [bytearray() for _ in range(height)]
+        for name, data, w, h in icons:
+            key = fnv1a(name)
+            if key in rects:
+                raise ValueError("Hash-Kollision oder doppelt: '%s' und '%s'" % (name, rects[key][0]))
+            rects[key] = (name, len(rows[0]) // 2, w, h, number)
+            for y in range(height):
+                rows[y] += data[y * w * 2:(y + 1) * w * 2] if y < h else b"\x00" * (w * 2)
+        strips.append((width, height, b"".join(rows)))
+
+    strip_offset = struct.calcsize(HEADER_FORMAT)
+    rect_offset = strip_offset + len(strips) * struct.calcsize(STRIP_FORMAT)
+    pixel_offset = rect_offset + len(rects) * struct.calcsize(RECT_FORMAT)
+
+    table = bytearray()
+    pixels = bytearray(b"\x00" * (-pixel_offset % ATLAS_ALIGNMENT))
+    for width, height, data in strips:
+        table += struct.pack(STRIP_FORMAT, pixel_offset + len(pixels), width, height)
+        pixels += data
+        pixels += b"\x00" * (-(pixel_offset + len(pixels)) % ATLAS_ALIGNMENT)
+    for key in sorted(rects):
+        name, x, w, h, number = rects[key]
+        table += struct.pack(RECT_FORMAT, key, x, w, h, number)
+
+    header = struct.pack(HEADER_FORMAT, ATLAS_MAGIC, len(rects), len(strips), strip_offset, rect_offset)
+    # Breite und Höhe im Index: breitester Streifen, alle Streifen untereinander
+    return (bytes(header + table + pixels), max(s[0] for s in strips), sum(s[1] for s in strips))
+
+
+def build_file(path):
+    return build(read_list(path))
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("Aufruf: %s <atlasliste.atlas> <atlas.bin>\n" % argv[0])
+        return 2
+    try:
+        groups = read_list(argv[1])
+        blob = build(groups)[0]
+    except (OSError, ValueError) as error:
+        sys.stderr.write("atlas_pack: %s\n" % error)
+        return 1
+
+    with open(argv[2], "wb") as f:
+        f.write(blob)
+    print("%s: %d Symbole in %d Streifen, %d Bytes" % (argv[2], sum(len(g[1]) for g in groups), len(groups),
+                                                       len(blob)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
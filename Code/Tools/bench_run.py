@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+bench_run.py - Flasht die Benchmark-Firmware, sammelt ihre CSV-Ausgabe und vergleicht Läufe.
+
+Die Ziele display_bench, storage_bench, mem_bench, jitter_bench und bus_bench (CMakeLists.txt,
+Bench/) geben nach dem Start eine CSV-Zeile je Test über UART7 aus (Bench.c):
+
+    suite,test,param,reps,us_avg,us_min,us_max,units_per_s,mb_per_s
+
+Kommentare beginnen mit '#'. Bench_Begin() nennt Takt und Build-ID, Bench_Finish() schließt mit
+"# bench done". Binäre LOG()-Datensätze (0xFF ..., siehe log_decode.py) zwischen den Zeilen
+werden übersprungen.
+
+Verglichen wird je Test (suite/test/param) und Kennzahl mit einer Schwelle in Prozent des
+Basislaufs. Zeiten sollen kleiner, Raten größer werden. Änderungen unter --floor-us Mikrosekunden
+zählen nicht, das dämpft Rauschen bei sehr kurzen Tests. Schlechter als die Schwelle, fehlende
+Tests und FAIL-Meldungen (jitter_bench) ergeben Rückgabewert 1. Die CSV von Host/host_bench
+(case,param,bus,...) lässt sich ebenso vergleichen. Dort ist der Busverkehr deterministisch,
+eine geänderte hash-Spalte heißt: andere Bytes auf dem Bus.
+
+Aufruf:
+    python3 bench_run.py run display_bench [-o lauf.csv]        flashen, Ausgabe mitschneiden
+    python3 bench_run.py compare basis.csv lauf.csv               Tabelle der Abweichungen
+    python3 bench_run.py check display_bench [--update]           run + compare mit Bench/Baseline/<ziel>.csv,
+                                                                  --update speichert den Lauf als neue Basis
+    Optionen: --port /dev/ttyACM0, --baud 921600, --build cmake-build-debug (Verzeichnis der .elf),
+              --flash "Befehl mit {elf}" (Standard: OpenOCD mit ST-Link), --timeout 900 (s),
+              --threshold 5 (Prozent, alle Kennzahlen), --threshold us_max=25 (eine Kennzahl),
+              --floor-us 0.5, --baseline-dir Bench/Baseline
+"""
+
+import csv
+import os
+import shlex
+import subprocess
+import sys
+import time
+
+from log_decode import LOG_MARKER
+
+DONE_MARKER = "# bench done"
+DEFAULT_FLASH = ("openocd -f interface/stlink.cfg -f target/stm32h7x.cfg "
+                 "-c \"program {elf} verify reset exit\"")
+
+# Kennzahl -> +1 größer ist besser, -1 kleiner ist besser, 0 muss gleich bleiben
+METRICS = {
+    "us_avg": -1, "us_min": -1, "us_max": -1, "units_per_s": +1, "mb_per_s": +1,
+    "transfers": -1, "bytes": -1, "clocks": -1, "wire_us": -1, "host_ns": -1, "hash": 0,
+}
+TIME_METRICS = ("us_avg", "us_min", "us_max", "wire_us")
+# Spalten, die einen Test benennen (Firmware bzw. host_bench)
+KEYS = (("suite", "test", "param"), ("case", "param", "bus"))
+DEFAULT_THRESHOLDS = {"us_max": 25.0, "host_ns": 50.0}
+
+
+def parse(lines):
+    """Liest CSV-Zeilen mit Kopf: (Kennzahlen je Test, Spaltenreihenfolge, Kommentare)."""
+    rows, order, notes = {}, [], []
+    header = None
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        if line.startswith("#"):
+            notes.append(line)
+            continue
+        fields = next(csv.reader([line]))
+        if any(all(k in fields for k in key) for key in KEYS):
+            header = fields
+            continue
+        if header is None or len(fields) != len(header):
+            continue
+        record = dict(zip(header, fields))
+        key_columns = next(key for key in KEYS if all(k in header for k in key))
+        name = "/".join(record[k] for k in key_columns)
+        metrics = {m: record[m] for m in METRICS if m in record and record[m] != ""}
+        if name not in rows:
+            order.append(name)
+        rows[name] = metrics
+    return rows, order, notes
+
+
+def read_file(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        return parse(f)
+
+
+def capture(port, baud, timeout, start):
+    """Schneidet die UART mit, bis "# bench done" kommt oder timeout Sekunden vergangen sind.
+
+    start() wird nach dem Öffnen aufgerufen (flashen und Reset), damit keine Zeile verloren geht.
+    """
+    import serial
+
+    lines = []
+    with serial.Serial(port, baud, timeout=1) as uart:
+        uart.reset_input_buffer()
+        start()
+        deadline = time.monotonic() + timeout
+        text = bytearray()
+        while time.monotonic() < deadline:
+            byte = uart.read(1)
+            if not byte:
+                continue
+            if byte[0] == LOG_MARKER:
+                # Binary LOG() record: count, id, cycles, then 4 bytes per argument
+                header = uart.read(7)
+                if len(header) == 7:
+                    uart.read(4 * header[0])
+                continue
+            if byte != b"\n":
+                text += byte
+                continue
+            line = text.decode("utf-8", "replace").rstrip("\r")
+            text.clear()
+            lines.append(line)
+            print(line, flush=True)
+            if line.startswith(DONE_MARKER):
+                return lines, True
+    return lines, False
+
+
+def run(target, options):
+    elf = os.path.join(options["build"], target + ".elf")
+    if not os.path.exists(elf):
+        raise SystemExit("%s fehlt, erst 'cmake --build %s --target %s'" % (elf, options["build"], target))
+
+    command = options["flash"].format(elf=elf)
+
+    def flash():
+        result = subprocess.run(shlex.split(command), stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        if result.returncode != 0:
+            sys.stderr.write(result.stdout.decode("utf-8", "replace"))
+            raise SystemExit("Flashen fehlgeschlagen: %s" % command)
+
+    lines, done = capture(options["port"], options["baud"], options["timeout"], flash)
+    if not done:
+        sys.stderr.write("bench_run: kein '%s' nach %d s\n" % (DONE_MARKER, options["timeout"]))
+    if options["output"]:
+        with open(options["output"], "w", encoding="utf-8") as f:
+            f.write("\n".join(lines) + "\n")
+    return lines, done
+
+
+def number(value):
+    try:
+        return float(value)
+    except ValueError:
+        return None
+
+
+def compare(baseline, current, options, out=sys.stdout):
+    """Gibt die Tabelle der Abweichungen aus, Rückgabe: Anzahl Verschlechterungen."""
+    base_rows, base_order, _ = baseline
+    rows, order, notes = current
+    thresholds = options["thresholds"]
+    worse = 0
+
+    table = []
+    for name in base_order + [n for n in order if n not in base_rows]:
+        if name not in rows:
+            table.append((name, "", "", "", "", "FEHLT"))
+            worse += 1
+            continue
+        if name not in base_rows:
+            table.append((name, "", "", "", "", "neu"))
+            continue
+        for metric, direction in METRICS.items():
+            old, new = base_rows[name].get(metric), rows[name].get(metric)
+            if old is None or new is None:
+                continue
+            if direction == 0:
+                if old != new:
+                    table.append((name, metric, old, new, "", "geändert"))
+                continue
+
+            a, b = number(old), number(new)
+            if a is None or b is None:
+                continue
+            delta = (b - a) / a * 100.0 if a else (0.0 if a == b else float("inf"))
+            limit = thresholds.get(metric, thresholds["*"])
+            status = "ok"
+            if metric in TIME_METRICS and abs(b - a) < options["floor"]:
+                status = "ok"
+            elif delta * direction < -limit:
+                status = "SCHLECHTER"
+                worse += 1
+            elif delta * direction > limit:
+                status = "besser"
+            table.append((name, metric, old, new, "%+.1f %%" % delta, status))
+
+    failed = [n for n in notes if " FAIL" in n]
+    worse += len(failed)
+
+    width = max([len(t[0]) for t in table] + [4])
+    out.write("%-*s  %-11s  %12s  %12s  %9s  %s\n" % (width, "test", "kennzahl", "basis", "lauf", "delta", "status"))
+    for name, metric, old, new, delta, status in table:
+        if status == "ok" and not options["verbose"]:
+            continue
+        out.write("%-*s  %-11s  %12s  %12s  %9s  %s\n" % (width, name, metric, old, new, delta, status))
+    for note in failed:
+        out.write("%s\n" % note)
+    checked = sum(1 for t in table if t[1])
+    out.write("%d Kennzahlen in %d Tests, %d schlechter als die Schwelle\n" % (checked, len(order), worse))
+    return worse
+
+
+def main(argv):
+    options = {
+        "port": "/dev/ttyACM0", "baud": 921600, "build": "cmake-build-debug", "flash": DEFAULT_FLASH,
+        "timeout": 900, "output": None, "floor": 0.5, "verbose": False, "update": False,
+        "baseline_dir": os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Bench", "Baseline"),
+        "thresholds": dict(DEFAULT_THRESHOLDS, **{"*": 5.0}),
+    }
+    args = []
+    i = 1
+    try:
+        while i < len(argv):
+            arg = argv[i]
+            if arg in ("--port", "--build", "--flash", "--baseline-dir"):
+                options[arg[2:].replace("-", "_")] = argv[i + 1]
+                i += 1
+            elif arg in ("--baud", "--timeout"):
+                options[arg[2:]] = int(argv[i + 1])
+                i += 1
+            elif arg == "--floor-us":
+                options["floor"] = float(argv[i + 1])
+                i += 1
+            elif arg == "-o":
+                options["output"] = argv[i + 1]
+                i += 1
+            elif arg == "--threshold":
+                metric, _, value = argv[i + 1].rpartition("=")
+                if metric and metric not in METRICS:
+                    raise ValueError(metric)
+                options["thresholds"][metric or "*"] = float(value)
+                i += 1
+            elif arg == "--update":
+                options["update"] = True
+            elif arg in ("-v", "--verbose"):
+                options["verbose"] = True
+            else:
+                args.append(arg)
+            i += 1
+    except (IndexError, ValueError):
+        args = []
+
+    if len(args) == 3 and args[0] == "compare":
+        return 1 if compare(read_file(args[1]), read_file(args[2]), options) else 0
+
+    if len(args) == 2 and args[0] in ("run", "check"):
+        target = args[1]
+        baseline = os.path.join(options["baseline_dir"], target + ".csv")
+        if args[0] == "check" and options["output"] is None:
+            options["output"] = target + "_" + time.strftime("%Y%m%d_%H%M%S") + ".csv"
+        lines, done = run(target, options)
+        if args[0] == "run":
+            return 0 if done else 1
+
+        if options["update"] or not os.path.exists(baseline):
+            os.makedirs(options["baseline_dir"], exist_ok=True)
+            with open(baseline, "w", encoding="utf-8") as f:
+                f.write("\n".join(lines) + "\n")
+            print("Basis gespeichert: %s" % baseline)
+            return 0 if done else 1
+        worse = compare(read_file(baseline), parse(lines), options)
+        return 1 if worse or not done else 0
+
+    print(__doc__)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
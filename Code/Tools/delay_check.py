@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+delay_check.py - Findet Aufrufe von HAL_Delay() außerhalb der Initialisierung.
+
+HAL_Delay() hält die Hauptschleife an: der Scheduler, die Eingaben und alle Displays stehen, bis
+die Zeit um ist. Im Betrieb wartet ein Task statt dessen mit Scheduler_ReleaseAfter(), einem
+Software-Timer (Timer.h), AWAIT_MS in einer Coroutine (Async.h) oder lässt die Hardware takten.
+Erlaubt ist HAL_Delay() nur in Funktionen, die vor dem Scheduler bzw. einmal beim Start laufen.
+
+Das Werkzeug liest alle .c/.cpp-Dateien unter den angegebenen Verzeichnissen, blendet Kommentare,
+Zeichenketten und Präprozessorzeilen aus und ordnet jeden Aufruf über die Klammerung der
+umgebenden Funktion zu. Als Initialisierung gelten Namen, auf die ein Muster aus INIT_PATTERNS
+oder --allow passt:
+
+    main, MX_*, SystemClock_Config    erzeugter Startcode
+    *_Init, *_init, *_begin, *_EndInit, *_Reset, *InitSequence
+
+Die Definition von HAL_Delay() selbst (Realtime.c) ist kein Aufruf. Gibt es Aufrufe außerhalb,
+endet das Werkzeug mit Rückgabewert 1, das CMake-Ziel delay_check und damit der Build schlagen
+dann fehl.
+
+Aufruf:
+    python3 delay_check.py Core/Src FATFS [--allow REGEX]...
+"""
+
+import bisect
+import os
+import re
+import sys
+
+INIT_PATTERNS = (r"^main$", r"^MX_", r"^SystemClock_Config$", r"_[Ii]nit$", r"_begin$",
+                 r"_EndInit$", r"_Reset$", r"InitSequence$")
+
+_TOKEN = re.compile(r"[A-Za-z_]\w*|[{}();=]")
+# Comments, string and character literals; replaced by blanks with the newlines kept
+_NOISE = re.compile(r"//[^\n]*|/\*.*?\*/|\"(?:[^\"\\\n]|\\.)*\"|'(?:[^'\\\n]|\\.)*'", re.S)
+_DIRECTIVE = re.compile(r"^[ \t]*#(?:[^\n]*\\\n)*[^\n]*", re.M)
+_EXTENSIONS = (".c", ".cpp")
+
+
+def blank(match):
+    return re.sub(r"[^\n]", " ", match.group(0))
+
+
+def find_sources(dirs):
+    paths = []
+    for base in dirs:
+        for root, _, files in os.walk(base):
+            paths.extend(os.path.join(root, name) for name in files if name.endswith(_EXTENSIONS))
+    return sorted(paths)
+
+
+def scan(path):
+    """Liefert (zeile, funktion) je Aufruf von HAL_Delay() in path."""
+    with open(path, encoding="utf-8", errors="replace") as source:
+        text = source.read()
+    text = _NOISE.sub(blank, text)
+    text = _DIRECTIVE.sub(blank, text)
+    lines = [0] + [m.end() for m in re.finditer(r"\n", text)]
+
+    calls = []
+    depth = 0
+    candidate = None        # last "name(" at file scope, the function if a '{' follows
+    function = None
+    previous = None
+    for match in _TOKEN.finditer(text):
+        token = match.group(0)
+        if token == "{":
+            if depth == 0:
+                function = candidate
+            depth += 1
+        elif token == "}":
+            # Unbalanced braces from #if branches must not push the scope below file level
+            depth = max(depth - 1, 0)
+            if depth == 0:
+                function = candidate = None
+        elif depth == 0:
+            if token in (";", "="):
+                candidate = None
+            elif token == "(" and previous not in (None, "(", ")", ";", "=", "{", "}"):
+                candidate = candidate or previous
+        elif token == "(" and previous == "HAL_Delay":
+            calls.append((bisect.bisect_right(lines, match.start()), function or "?"))
+        previous = token
+    return calls
+
+
+def main(argv):
+    args = argv[1:]
+    patterns = list(INIT_PATTERNS)
+    dirs = []
+    while args:
+        arg = args.pop(0)
+        if arg == "--allow" and args:
+            patterns.append(args.pop(0))
+        else:
+            dirs.append(arg)
+    if not dirs:
+        sys.stderr.write("Aufruf: %s <verzeichnis>... [--allow REGEX]...\n" % argv[0])
+        return 2
+    try:
+        allowed = [re.compile(pattern) for pattern in patterns]
+        paths = find_sources(dirs)
+        found = [(path, line, function) for path in paths for line, function in scan(path)]
+    except (OSError, re.error) as error:
+        sys.stderr.write("delay_check: %s\n" % error)
+        return 2
+
+    runtime = [entry for entry in found if not any(p.search(entry[2]) for p in allowed)]
+    for path, line, function in runtime:
+        print("%s:%d: HAL_Delay() im Betrieb (in %s), Scheduler_ReleaseAfter()/Timer/AWAIT_MS verwenden"
+              % (path, line, function))
+    print("delay_check: %d Dateien, %d Aufrufe in Initialisierungen, %d im Betrieb"
+          % (len(paths), len(found) - len(runtime), len(runtime)))
+    return 1 if runtime else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+"""
+font_atlas.py - Wandelt BDF- und TTF-Zeichensätze in ILI9341_t3-Fonts für das Asset-Bundle.
+
+Aufbau (Little Endian, passend zu Asset_FontHeader in Core/Inc/Asset.h):
+
+    Asset_FontHeader  magic "FNT3", Offset des Index, Offset der Glyphen, danach die Felder
+                      von ILI9341_t3_font_t ab version (14 Bytes, 2 Füllbytes)   (28 Bytes)
+    Index             je Zeichen der beiden Bereiche bits_index Bits: Byte-Offset der Glyphe
+    Glyphen           je Glyphe ab einer Byte-Grenze: 3 Bit Kodierung (0), Breite, Höhe,
+                      X-Versatz, Y-Versatz (vorzeichenbehaftet), Vorschub, dann die Pixel
+
+Der Index hat für jedes Zeichen zwischen index1_first..index1_last und index2_first..index2_last
+einen Eintrag fester Breite, ILI9341_FontGetGlyph() findet eine Glyphe also ohne Suche. Fehlende
+Zeichen bekommen eine leere Glyphe mit dem Vorschub des Leerzeichens.
+
+1-Bit-Pixel sind zeilenweise komprimiert wie bei PJRC: 0 + Zeile, oder 1 + 3 Bit n + Zeile für
+n+2 gleiche Zeilen. Mit --bpp 2 oder 4 (nur TTF) entsteht ein anti-aliased Font (version 23),
+die Zeilen stehen dann unkomprimiert ab einer Byte-Grenze.
+
+cap_height ist die Oberkante der höchsten Glyphe über der Grundlinie, line_space reicht bis zur
+Unterkante der tiefsten. Damit liegt jede Glyphe ganz in ihrer Zeichenzelle.
+
+Aufruf:
+    python3 font_atlas.py schrift.bdf schrift.fnt
+    python3 font_atlas.py schrift.ttf schrift.fnt --size 18 [--bpp 4]
+    Optionen: --range 32-126 (Standard), --range2 160-255 (zweiter Bereich, Standard leer)
+
+TTF braucht Pillow. asset_pack.py ruft build() direkt auf, wenn ein 'font'-Eintrag auf eine
+.bdf- oder .ttf-Datei zeigt.
+"""
+
+import struct
+import sys
+
+FONT_MAGIC = 0x33544E46
+HEADER_FORMAT = "<III14B2x"
+
+
+def _bits_unsigned(value):
+    return max(1, value.bit_length())
+
+
+def _bits_signed(low, high):
+    bits = 1
+    while not (-(1 << (bits - 1)) <= low and high < (1 << (bits - 1))):
+        bits += 1
+    return bits
+
+
+class _BitWriter:
+    def __init__(self):
+        self.bits = []
+
+    def put(self, value, count):
+        for i in range(count - 1, -1, -1):
+            self.bits.append((value >> i) & 1)
+
+    def align(self):
+        self.bits += [0] * (-len(self.bits) % 8)
+
+    def data(self):
+        self.align()
+        out = bytearray()
+        for i in range(0, len(self.bits), 8):
+            byte = 0
+            for bit in self.bits[i:i + 8]:
+                byte = (byte << 1) | bit
+            out.append(byte)
+        return bytes(out)
+
+
+def load_bdf(path):
+    """Liefert {Zeichen: (breite, höhe, xoff, yoff, vorschub, zeilen)}, Zeilen als Listen von 0/1."""
+    glyphs = {}
+    with open(path, encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+    code = advance = width = height = xoff = yoff = 0
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "ENCODING":
+            code = int(fields[1])
+        elif fields[0] == "DWIDTH":
+            advance = int(fields[1])
+        elif fields[0] == "BBX":
+            width, height, xoff, yoff = (int(v) for v in fields[1:5])
+        elif fields[0] == "BITMAP":
+            rows = []
+            for _ in range(height):
+                hexrow = next(lines).strip()
+                value, total = int(hexrow or "0", 16), len(hexrow) * 4
+                rows.append([(value >> (total - 1 - x)) & 1 if x < total else 0 for x in range(width)])
+            if 0 <= code <= 255:
+                glyphs[code] = (width, height, xoff, yoff, advance, rows)
+    return glyphs
+
+
+def load_ttf(path, size, bpp, codes):
+    from PIL import Image, ImageDraw, ImageFont
+    font = ImageFont.truetype(path, size)
+    levels = (1 << bpp) - 1
+    glyphs = {}
+    for code in codes:
+        text = chr(code)
+        left, top, right, bottom = font.getbbox(text, anchor="ls")
+        advance = int(round(font.getlength(text)))
+        width, height = max(0, right - left), max(0, bottom - top)
+        rows = []
+        if width and height:
+            image = Image.new("L", (width, height), 0)
+            ImageDraw.Draw(image).text((-left, -top), text, font=font, fill=255, anchor="ls")
+            pixels = list(image.getdata())
+            for y in range(height):
+                row = pixels[y * width:(y + 1) * width]
+                rows.append([(p * levels + 127) // 255 for p in row])
+        glyphs[code] = (width, height, left, -bottom, advance, rows)
+    return glyphs
+
+
+def _encode_rows(writer, rows, bpp):
+    if bpp > 1:
+        writer.align()
+        for row in rows:
+            for alpha in row:
+                writer.put(alpha, bpp)
+        return
+    y = 0
+    while y < len(rows):
+        repeat = 1
+        while y + repeat < len(rows) and rows[y + repeat] == rows[y] and repeat < 9:
+            repeat += 1
+        if repeat >= 2:
+            writer.put(1, 1)
+            writer.put(repeat - 2, 3)
+        else:
+            writer.put(0, 1)
+        for bit in rows[y]:
+            writer.put(bit, 1)
+        y += repeat
+
+
+def build(glyphs, range1=(32, 126), range2=None, bpp=1):
+    """Packt Glyphen zu einem Font-Asset (Asset_FontHeader, Index, Glyphen)."""
+    codes = list(range(range1[0], range1[1] + 1))
+    if range2:
+        codes += range(range2[0], range2[1] + 1)
+
+    space = glyphs.get(32, (0, 0, 0, 0, 0, []))[4]
+    used = [glyphs.get(c, (0, 0, 0, 0, space, [])) for c in codes]
+
+    bits_width = _bits_unsigned(max(g[0] for g in used))
+    bits_height = _bits_unsigned(max(g[1] for g in used))
+    bits_xoffset = _bits_signed(min(g[2] for g in used), max(g[2] for g in used))
+    bits_yoffset = _bits_signed(min(g[3] for g in used), max(g[3] for g in used))
+    bits_delta = _bits_unsigned(max(g[4] for g in used))
+
+    data = bytearray()
+    offsets = []
+    for width, height, xoff, yoff, advance, rows in used:
+        writer = _BitWriter()
+        writer.put(0, 3)
+        writer.put(width, bits_width)
+        writer.put(height, bits_height)
+        writer.put(xoff & ((1 << bits_xoffset) - 1), bits_xoffset)
+        writer.put(yoff & ((1 << bits_yoffset) - 1), bits_yoffset)
+        writer.put(advance, bits_delta)
+        _encode_rows(writer, rows if width and height else [], bpp)
+        offsets.append(len(data))
+        data += writer.data()
+
+    bits_index = _bits_unsigned(max(offsets))
+    writer = _BitWriter()
+    for offset in offsets:
+        writer.put(offset, bits_index)
+    index = writer.data()
+
+    inked = [g for g in used if g[0] and g[1]]
+    cap_height = max((g[1] + g[3] for g in inked), default=0)
+    line_space = cap_height - min((g[3] for g in inked), default=0)
+    if line_space > 255 or not 0 <= cap_height <= 255:
+        raise ValueError("Zeilenhöhe %d passt nicht in ein Byte" % line_space)
+
+    version = 23 if bpp > 1 else 1
+    reserved = bpp - 1 if bpp > 1 else 0
+    first2, last2 = range2 if range2 else (1, 0)
+    header_size = struct.calcsize(HEADER_FORMAT)
+    index_offset = header_size
+    data_offset = (index_offset + len(index) + 3) & ~3
+    header = struct.pack(HEADER_FORMAT, FONT_MAGIC, index_offset, data_offset, version, reserved,
+                         range1[0], range1[1], first2, last2, bits_index, bits_width, bits_height,
+                         bits_xoffset, bits_yoffset, bits_delta, line_space, cap_height)
+    blob = header + index
+    blob += b"\x00" * (data_offset - len(blob))
+    # fetchbits_unsigned() liest bis zu 5 Bytes ab der Bitposition
+    return bytes(blob + data + b"\x00" * 4)
+
+
+def build_file(path, size=None, bpp=1, range1=(32, 126), range2=None):
+    if path.lower().endswith(".bdf"):
+        if bpp != 1:
+            raise ValueError("%s: BDF-Fonts haben 1 Bit pro Pixel" % path)
+        glyphs = load_bdf(path)
+    else:
+        if not size:
+            raise ValueError("%s: TTF braucht eine Größe in Pixeln" % path)
+        codes = list(range(range1[0], range1[1] + 1)) + (list(range(range2[0], range2[1] + 1)) if range2 else [])
+        glyphs = load_ttf(path, size, bpp, codes)
+    return build(glyphs, range1, range2, bpp)
+
+
+def _parse_range(text):
+    first, last = (int(v, 0) for v in text.split("-"))
+    if not 0 <= first <= last <= 255:
+        raise ValueError("Bereich %s außerhalb 0-255" % text)
+    return first, last
+
+
+def main(argv):
+    args = argv[1:]
+    options = {"--size": None, "--bpp": "1", "--range": "32-126", "--range2": None}
+    files = []
+    while args:
+        arg = args.pop(0)
+        if arg in options and args:
+            options[arg] = args.pop(0)
+        else:
+            files.append(arg)
+    if len(files) != 2 or options["--bpp"] not in ("1", "2", "4"):
+        sys.stderr.write("Aufruf: %s <schrift.bdf|.ttf> <ausgabe.fnt> [--size px] [--bpp 1|2|4] "
+                         "[--range a-b] [--range2 a-b]\n" % argv[0])
+        return 2
+    try:
+        blob = build_file(files[0], int(options["--size"]) if options["--size"] else None, int(options["--bpp"]),
+                          _parse_range(options["--range"]),
+                          _parse_range(options["--range2"]) if options["--range2"] else None)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("font_atlas: %s\n" % error)
+        return 1
+
+    with open(files[1], "wb") as f:
+        f.write(blob)
+    print("%s: %d Bytes" % (files[1], len(blob)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+image_compress.py - Erzeugt komprimierte RGB565-Bilder für ILI9341_DrawCompressedFile/-Image.
+
+Aufbau (passend zu Core/Inc/ILI9341_Image.h):
+
+    ILI9341_ImageHeader  magic "CIMG", width, height, format, bpp, colours, reserviert, size (16 Bytes)
+    Daten                RLE (format 1), LZ4-Block (format 2) oder Farbtabelle (format 3), size Bytes
+
+RLE arbeitet auf Pixeln (2 Bytes, High-Byte zuerst):
+    c < 0x80   c + 1 Pixel folgen unverändert
+    c >= 0x80  Lauf von (c & 0x7F) Pixeln, bei 0 folgt die Länge als uint16 Little Endian;
+               danach die Farbe
+
+LZ4 ist das Standard-Blockformat, Referenzen reichen höchstens LZ4_WINDOW Bytes zurück
+(ILI9341_IMAGE_LZ4_WINDOW in der Firmware).
+
+Farbtabelle (nur bei höchstens 256 Farben): colours + 1 Farben (RGB565, High-Byte zuerst),
+danach bpp = 1, 2, 4 oder 8 Bits je Pixel, das erste Pixel eines Bytes in den niederwertigen
+Bits; jede Zeile beginnt auf einem ganzen Byte.
+
+Aufruf:
+    python3 image_compress.py eingabe.bin ausgabe.cimg 100 79      # rohes RGB565
+    python3 image_compress.py eingabe.png ausgabe.cimg              # mit Pillow
+    Optionen: --rle, --lz4, --indexed (Standard: das kleinere Ergebnis)
+"""
+
+import struct
+import sys
+
+IMAGE_MAGIC = 0x474D4943
+IMAGE_RLE = 1
+IMAGE_LZ4 = 2
+IMAGE_INDEXED = 3
+LZ4_WINDOW = 12 * 1024
+
+HEADER_FORMAT = "<IHHBBBxI"
+
+
+def encode_rle(data):
+    pixels = [data[i:i + 2] for i in range(0, len(data), 2)]
+    out = bytearray()
+    literal = []
+
+    def flush_literal():
+        while literal:
+            block = literal[:128]
+            del literal[:128]
+            out.append(len(block) - 1)
+            for p in block:
+                out.extend(p)
+
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < 0xFFFF and pixels[i + run] == pixels[i]:
+            run += 1
+        # Ein Lauf kostet 3 bzw. 5 Bytes, zwei gleiche Pixel als Literal 4 Bytes
+        if run >= 3 or (run == 2 and not literal):
+            flush_literal()
+            if run < 0x80:
+                out.append(0x80 | run)
+            else:
+                out.append(0x80)
+                out += struct.pack("<H", run)
+            out += pixels[i]
+            i += run
+        else:
+            literal.append(pixels[i])
+            i += 1
+    flush_literal()
+    return bytes(out)
+
+
+def _lz4_length(out, value):
+    while value >= 255:
+        out.append(255)
+        value -= 255
+    out.append(value)
+
+
+def encode_lz4(data, window=LZ4_WINDOW):
+    """Greedy-LZ4 mit Hash-Tabelle; hält die Regeln des Blockformats ein (letzte 5 Bytes Literale)."""
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+    limit = n - 12
+
+    while i < limit:
+        key = data[i:i + 4]
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is None or i - candidate > window:
+            i += 1
+            continue
+
+        length = 4
+        while i + length < n - 5 and data[candidate + length] == data[i + length]:
+            length += 1
+
+        literals = i - anchor
+        token_lit = min(literals, 15)
+        token_match = min(length - 4, 15)
+        out.append((token_lit << 4) | token_match)
+        if literals >= 15:
+            _lz4_length(out, literals - 15)
+        out += data[anchor:i]
+        out += struct.pack("<H", i - candidate)
+        if length - 4 >= 15:
+            _lz4_length(out, length - 4 - 15)
+
+        for j in range(i + 1, min(i + length, limit)):
+            table[data[j:j + 4]] = j
+        i += length
+        anchor = i
+
+    literals = n - anchor
+    out.append(min(literals, 15) << 4)
+    if literals >= 15:
+        _lz4_length(out, literals - 15)
+    out += data[anchor:]
+    return bytes(out)
+
+
+def encode_indexed(data, width):
+    """Liefert (bpp, Farbanzahl, Daten) oder None bei mehr als 256 Farben."""
+    pixels = [data[i:i + 2] for i in range(0, len(data), 2)]
+    counts = {}
+    for p in pixels:
+        counts[p] = counts.get(p, 0) + 1
+    if len(counts) > 256:
+        return None
+
+    palette = sorted(counts, key=lambda p: -counts[p])
+    index = {p: i for i, p in enumerate(palette)}
+    bpp = next(b for b in (1, 2, 4, 8) if len(palette) <= 1 << b)
+    out = bytearray(b"".join(palette))
+    for row in range(0, len(pixels), width):
+        value = bit = 0
+        for p in pixels[row:row + width]:
+            value |= index[p] << bit
+            bit += bpp
+            if bit == 8:
+                out.append(value)
+                value = bit = 0
+        if bit:
+            out.append(value)
+    return bpp, len(palette), bytes(out)
+
+
+def compress(data, width, height, method=None):
+    """Liefert (format, Datei-Inhalt mit Kopf) für RGB565-Daten (High-Byte zuerst)."""
+    if len(data) != width * height * 2:
+        raise ValueError("%d Bytes, erwartet %d" % (len(data), width * height * 2))
+
+    candidates = []
+    if method in (None, "rle"):
+        candidates.append((IMAGE_RLE, encode_rle(data)))
+    if method in (None, "lz4"):
+        candidates.append((IMAGE_LZ4, encode_lz4(data)))
+    bpp = colours = 0
+    if method in (None, "indexed"):
+        indexed = encode_indexed(data, width)
+        if indexed is not None:
+            bpp, colours, payload = indexed
+            candidates.append((IMAGE_INDEXED, payload))
+        elif method == "indexed":
+            raise ValueError("mehr als 256 Farben, Farbtabelle nicht möglich")
+    fmt, payload = min(candidates, key=lambda c: len(c[1]))
+    if fmt != IMAGE_INDEXED:
+        bpp = colours = 0
+
+    header = struct.pack(HEADER_FORMAT, IMAGE_MAGIC, width, height, fmt, bpp, max(colours - 1, 0), len(payload))
+    return fmt, header + payload
+
+
+def load_rgb565(path, width=None, height=None):
+    """Lädt ein Bild als RGB565 (High-Byte zuerst); rohe .bin-Dateien brauchen Breite und Höhe."""
+    if path.lower().endswith(".bin"):
+        if width is None:
+            raise ValueError("%s: rohes RGB565-Bild braucht Breite und Höhe" % path)
+        with open(path, "rb") as f:
+            data = f.read()
+        if len(data) < width * height * 2:
+            raise ValueError("%s: %d Bytes, erwartet %d" % (path, len(data), width * height * 2))
+        return data[:width * height * 2], width, height
+
+    from PIL import Image
+    image = Image.open(path).convert("RGB")
+    if width is not None and image.size != (width, height):
+        image = image.resize((width, height))
+    out = bytearray()
+    for r, g, b in image.getdata():
+        out += struct.pack(">H", ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
+    return bytes(out), image.size[0], image.size[1]
+
+
+def main(argv):
+    method = None
+    args = []
+    for arg in argv[1:]:
+        if arg in ("--rle", "--lz4", "--indexed"):
+            method = arg[2:]
+        else:
+            args.append(arg)
+
+    if len(args) not in (2, 4):
+        sys.stderr.write("Aufruf: %s [--rle|--lz4|--indexed] <eingabe> <ausgabe.cimg> [breite höhe]\n" % argv[0])
+        return 2
+
+    try:
+        width = int(args[2]) if len(args) == 4 else None
+        height = int(args[3]) if len(args) == 4 else None
+        data, width, height = load_rgb565(args[0], width, height)
+        fmt, blob = compress(data, width, height, method)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("image_compress: %s\n" % error)
+        return 1
+
+    with open(args[1], "wb") as f:
+        f.write(blob)
+    print("%s: %dx%d, %s, %d -> %d Bytes" % (args[1], width, height,
+          {IMAGE_RLE: "RLE", IMAGE_LZ4: "LZ4", IMAGE_INDEXED: "Farbtabelle"}[fmt], len(data), len(blob)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+log_decode.py - Setzt die binären LOG()-Datensätze der Firmware (Core/Inc/Log.h) wieder zu Text zusammen.
+
+Die UART liefert Text von printf und binäre Datensätze gemischt. Ein Datensatz beginnt mit 0xFF
+(kommt in UTF-8 nie vor), Little Endian:
+
+    0xFF, Anzahl Argumente (1 Byte), Id (2 Bytes), DWT->CYCCNT (4 Bytes), Argumente je 4 Bytes
+
+Die Id ist der Offset des Formatstrings im Abschnitt .log_str der ELF-Datei. %f/%e/%g-Argumente
+sind float, %s-Argumente Adressen konstanter Strings im Flash, die ebenfalls aus der ELF-Datei
+gelesen werden. Zeitstempel werden mit dem Takt aus der letzten "@clock"-Meldung in Sekunden
+umgerechnet; Überläufe des 32-Bit-Zählers werden aufaddiert, solange zwischen zwei Datensätzen
+weniger als ein Überlauf liegt (15 s bei 280 MHz).
+
+Aufruf:
+    python3 log_decode.py firmware.elf /dev/ttyACM0 [baudrate]   (mit pyserial, Standard 921600)
+    python3 log_decode.py firmware.elf mitschnitt.bin             (Datei oder mit stty eingestellte UART)
+    python3 log_decode.py firmware.elf --strings                  (Stringtabelle ausgeben)
+"""
+
+import re
+import struct
+import sys
+
+LOG_MARKER = 0xFF
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+FORMAT_SPEC = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcfFeEgGsp%])")
+
+
+def read_sections(path):
+    """Liest die Abschnitte einer ELF32-Datei (Little Endian): Name -> (Adresse, Flags, Inhalt)."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise SystemExit("%s: keine ELF32-Datei (Little Endian)" % path)
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+    headers = [struct.unpack_from("<IIIIII", elf, shoff + i * shentsize) for i in range(shnum)]
+    names = headers[shstrndx]
+
+    sections = {}
+    for name, kind, flags, addr, offset, size in headers:
+        end = elf.index(b"\0", names[4] + name)
+        data = b"" if kind == SHT_NOBITS else elf[offset:offset + size]
+        sections[elf[names[4] + name:end].decode()] = (addr, flags, data)
+    return sections
+
+
+def c_string(data, offset):
+    end = data.find(b"\0", offset)
+    return data[offset:end if end >= 0 else len(data)].decode("utf-8", "replace")
+
+
+class Decoder:
+    def __init__(self, elf_path):
+        sections = read_sections(elf_path)
+        if ".log_str" not in sections:
+            raise SystemExit("%s: kein Abschnitt .log_str (Linkerskript?)" % elf_path)
+        self.strings = sections[".log_str"][2]
+        # Loaded sections for %s arguments (.rodata in flash)
+        self.memory = [(addr, data) for addr, flags, data in sections.values() if flags & SHF_ALLOC and data]
+        self.clock_hz = None
+        self.last_cycles = None
+        self.seconds = 0.0
+
+    def flash_string(self, address):
+        for base, data in self.memory:
+            if base <= address < base + len(data):
+                return c_string(data, address - base)
+        return "<0x%08X>" % address
+
+    def format(self, fmt, args):
+        args = list(args)
+
+        def convert(match):
+            flags, width, precision, _, conv = match.groups()
+            if conv == "%":
+                return "%"
+            value = args.pop(0) if args else 0
+            spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+            if conv in "di":
+                value -= (value & 0x80000000) << 1
+            elif conv in "fFeEgG":
+                value, = struct.unpack("<f", struct.pack("<I", value))
+            elif conv == "s":
+                value = self.flash_string(value)
+            elif conv == "p":
+                conv, spec = "X", spec + "08"
+            elif conv == "c":
+                value = chr(value & 0xFF)
+            return (spec + conv) % value
+
+        return FORMAT_SPEC.sub(convert, fmt)
+
+    def timestamp(self, cycles):
+        if self.last_cycles is not None and self.clock_hz:
+            self.seconds += ((cycles - self.last_cycles) & 0xFFFFFFFF) / self.clock_hz
+        self.last_cycles = cycles
+        if not self.clock_hz:
+            return "[%10u]" % cycles
+        return "[%12.6f]" % self.seconds
+
+    def record(self, log_id, cycles, args):
+        fmt = c_string(self.strings, log_id) if log_id < len(self.strings) else "<id %u> " % log_id
+        if fmt.startswith("@clock") and args:
+            self.clock_hz = args[0]
+        return self.timestamp(cycles) + " " + self.format(fmt, args)
+
+    def run(self, stream, out):
+        text = bytearray()
+        while True:
+            byte = stream.read(1)
+            if not byte:
+                break
+            if byte[0] != LOG_MARKER:
+                text += byte
+                if byte == b"\n":
+                    out.write(text.decode("utf-8", "replace"))
+                    out.flush()
+                    text.clear()
+                continue
+
+            header = stream.read(7)
+            if len(header) < 7:
+                break
+            count, log_id, cycles = struct.unpack("<BHI", header)
+            payload = stream.read(4 * count)
+            if len(payload) < 4 * count:
+                break
+            if text:
+                out.write(text.decode("utf-8", "replace"))
+                text.clear()
+            out.write(self.record(log_id, cycles, struct.unpack("<%dI" % count, payload)))
+            out.flush()
+
+
+def open_stream(path, baudrate):
+    try:
+        import serial
+        if path.startswith("/dev/") or path.upper().startswith("COM"):
+            return serial.Serial(path, baudrate)
+    except ImportError:
+        pass
+    return open(path, "rb", buffering=0)
+
+
+def main(argv):
+    if len(argv) < 3:
+        print(__doc__)
+        return 1
+
+    decoder = Decoder(argv[1])
+    if argv[2] == "--strings":
+        for match in re.finditer(rb"[^\0]+", decoder.strings):
+            print("%5u  %r" % (match.start(), match.group().decode("utf-8", "replace")))
+        return 0
+
+    baudrate = int(argv[3]) if len(argv) > 3 else 921600
+    try:
+        decoder.run(open_stream(argv[2], baudrate), sys.stdout)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+mirror_view.py - Zeigt den Bildspiegel der Firmware (Core/Src/Mirror.c, Shell 'mirror on uart|esp').
+
+Jedes Paket enthält geänderte Pixel eines Bereichs des Framebuffers als Token gegenüber dem
+zuletzt gesendeten Stand; ein Schlüsselbild (Flag KEY) beginnt bei einem schwarzen Bild. Fehlt ein
+Paket (Lücke in der Paketnummer) oder kommt es beschädigt an, wartet der Betrachter auf das nächste
+Schlüsselbild ('mirror key' in der Shell, sonst spätestens nach MIRROR_KEYFRAME_MS).
+
+Kopf (16 Bytes, Little Endian): Bild (2), Flags (1: 1 = KEY, 2 = END), reserviert (1),
+x, y, Breite, Höhe (je 2), erstes Pixel im Bereich (4). Token:
+    00nnnnnn             n+1 Pixel unverändert
+    01nnnnnn Farbe       n+1 Pixel dieser Farbe
+    1nnnnnnn n+1 Farben  Pixel einzeln
+Farben sind RGB565, High-Byte zuerst.
+
+Wege:
+    uart: Telemetriepakete der Art MIRROR auf LPUART1 (wie telemetry_decode.py, COBS und CRC32)
+    link: Rahmen des ESP-Links (Core/Src/EspLink.c) auf Kanal 3, z.B. vom ESP weitergereicht
+          oder an UART7 mitgeschnitten
+
+Aufruf:
+    python3 mirror_view.py /dev/ttyACM0 [baudrate]          (Standard 3000000)
+    python3 mirror_view.py --link /dev/ttyUSB0 [baudrate]   (Standard 921600)
+    python3 mirror_view.py --png bild.png mitschnitt.bin     (jedes fertige Bild als PNG, ohne Fenster)
+Mit tkinter und Pillow öffnet sich ein Fenster, ohne sie schreibt --png die Bilder.
+"""
+
+import struct
+import sys
+import zlib
+
+from telemetry_decode import Decoder, open_stream
+
+PKT_MIRROR = 4
+FLAG_KEY, FLAG_END = 0x01, 0x02
+HEADER = struct.Struct("<HBBHHHHI")
+
+LINK_SYNC = 0xA5
+LINK_HEADER = 8
+LINK_CH_DISPLAY = 3
+
+
+class Screen:
+    """Bild des Empfängers, RGB565 je Pixel."""
+
+    def __init__(self, png=None):
+        self.width = 0
+        self.height = 0
+        self.pixels = []
+        self.synced = False
+        self.frames = 0
+        self.bytes = 0
+        self.png = png
+        self.window = None
+
+    def lost(self):
+        self.synced = False
+
+    def apply(self, payload):
+        if len(payload) < HEADER.size:
+            return
+        frame, flags, _, x, y, w, h, offset = HEADER.unpack_from(payload)
+        if flags & FLAG_KEY and offset == 0 and x == 0 and y == 0:
+            # The keyframe covers the whole screen
+            self.width, self.height = w, h
+            self.pixels = [0] * (w * h)
+            self.synced = True
+        if not self.synced or x + w > self.width or y + h > self.height:
+            return
+
+        self.bytes += len(payload)
+        i = offset
+        p = HEADER.size
+        while p < len(payload):
+            token = payload[p]
+            p += 1
+            if token < 0x40:
+                i += token + 1
+            elif token < 0x80:
+                colour = payload[p] << 8 | payload[p + 1]
+                p += 2
+                for _ in range(token - 0x3F):
+                    self.put(x, y, w, i, colour)
+                    i += 1
+            else:
+                for _ in range(token - 0x7F):
+                    self.put(x, y, w, i, payload[p] << 8 | payload[p + 1])
+                    p += 2
+                    i += 1
+        if flags & FLAG_END:
+            self.frames += 1
+            self.show(frame)
+
+    def put(self, x, y, w, i, colour):
+        self.pixels[(y + i // w) * self.width + x + i % w] = colour
+
+    def rgb(self):
+        out = bytearray()
+        for c in self.pixels:
+            out += bytes(((c >> 8 & 0xF8) | c >> 13, (c >> 3 & 0xFC) | (c >> 9 & 0x03), (c << 3 & 0xF8) | (c >> 2 & 0x07)))
+        return bytes(out)
+
+    def show(self, frame):
+        sys.stderr.write("# Bild %u, %u Bilder, %u B\n" % (frame, self.frames, self.bytes))
+        if self.png:
+            write_png(self.png, self.width, self.height, self.rgb())
+            return
+        try:
+            import tkinter
+            from PIL import Image, ImageTk
+        except ImportError:
+            return
+        if self.window is None:
+            self.window = tkinter.Tk()
+            self.window.title("Bildspiegel")
+            self.label = tkinter.Label(self.window)
+            self.label.pack()
+        image = Image.frombytes("RGB", (self.width, self.height), self.rgb())
+        self.photo = ImageTk.PhotoImage(image.resize((self.width * 2, self.height * 2)))
+        self.label.configure(image=self.photo)
+        self.window.update()
+
+
+def write_png(path, width, height, rgb):
+    rows = b"".join(b"\0" + rgb[y * width * 3:(y + 1) * width * 3] for y in range(height))
+
+    def chunk(kind, data):
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data))
+
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0))
+                + chunk(b"IDAT", zlib.compress(rows)) + chunk(b"IEND", b""))
+
+
+class UartDecoder(Decoder):
+    """Telemetriestrom von LPUART1, nur die Pakete des Bildspiegels."""
+
+    def __init__(self, screen):
+        super().__init__(open("/dev/null", "w"))
+        self.screen = screen
+
+    def segment(self, data):
+        lost, errors = self.lost, self.crc_errors
+        super().segment(data)
+        if self.lost != lost or self.crc_errors != errors:
+            self.screen.lost()
+
+    def packet(self, kind, seconds, payload):
+        if kind == PKT_MIRROR:
+            self.screen.apply(payload)
+
+    def report(self):
+        pass
+
+
+def link_crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc << 1 ^ 0x07) & 0xFF if crc & 0x80 else crc << 1
+    return crc
+
+
+def run_link(stream, screen):
+    """Rahmen des ESP-Links: Kopf mit CRC-8, Nutzdaten, CRC32; Bytes außerhalb eines Rahmens werden übersprungen."""
+    data = bytearray()
+    sequence = None
+    while True:
+        chunk = stream.read(max(1, stream.in_waiting)) if hasattr(stream, "in_waiting") else stream.read(4096)
+        if not chunk:
+            break
+        data += chunk
+        while len(data) >= LINK_HEADER:
+            if data[0] != LINK_SYNC or link_crc8(data[:7]) != data[7]:
+                del data[0]
+                continue
+            channel, seq, _, length = struct.unpack_from("<BBHH", data, 1)
+            size = LINK_HEADER + length + (4 if length else 0)
+            if len(data) < size:
+                break
+            payload = bytes(data[LINK_HEADER:LINK_HEADER + length])
+            valid = not length or zlib.crc32(payload) == struct.unpack_from("<I", data, LINK_HEADER + length)[0]
+            del data[:size]
+            if channel != LINK_CH_DISPLAY:
+                continue
+            if not valid or (sequence is not None and seq != (sequence + 1) & 0xFF):
+                screen.lost()
+            sequence = seq
+            if valid:
+                screen.apply(payload)
+
+
+def main(argv):
+    args = argv[1:]
+    link = "--link" in args
+    png = None
+    if link:
+        args.remove("--link")
+    if "--png" in args:
+        i = args.index("--png")
+        png = args[i + 1]
+        del args[i:i + 2]
+    if not args:
+        print(__doc__)
+        return 1
+
+    baudrate = int(args[1]) if len(args) > 1 else (921600 if link else 3000000)
+    stream = open_stream(args[0], baudrate)
+    screen = Screen(png)
+    try:
+        if link:
+            run_link(stream, screen)
+        else:
+            UartDecoder(screen).run(stream)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""
+sensorlog_decode.py - Wandelt eine Aufzeichnung des Datenloggers (Core/Src/SensorLog.c) in CSV.
+
+Die Datei ist eine Folge von Sätzen, jeder mit 8 Bytes Kopf (Little Endian):
+    0xA5 (1), Quelle (1), Länge der Nutzdaten (2), untere 32 Bit von Timebase_Us() (4)
+Der erste Satz ist ein SYNC mit dem oberen Wort der µs-Zeit, danach folgt einmal je Sekunde
+ein weiterer. Jeder Zeitstempel wird zu der 64-Bit-Zeit ergänzt, die dem letzten SYNC am
+nächsten liegt; so bleiben auch ADC-Blöcke, die nach neueren Sätzen kommen, richtig
+eingeordnet. Ausgegeben werden Sekunden seit dem Start der Aufzeichnung.
+
+Ausgabe, ein Datensatz je Zeile:
+    adc,<zeit>,<poti>,<wert>          (Zeit aus Blockende, Scan und Scanrate)
+    poti,<zeit>,<vr1>,<vr2>,<vr3>,<vr4>
+    climate,<zeit>,<temperatur>,<feuchte>,<temperatur gefiltert>,<feuchte gefiltert>
+    input,<zeit>,<eingabe>,<ereignis>,<maske>,<nummer>
+    can,<zeit>,<kennung hex>,<flags>,<fifo>,<daten hex>
+Lücken in den ADC-Blocknummern, beschädigte Stellen und die Zähler der SYNC-Sätze gehen nach stderr.
+
+ADC-Blöcke sind roh, als Differenzen je Slot (Zig-Zag-Varint) oder zusätzlich mit LZ4 gepackt
+(Byte 11 des Satzes, SENSORLOG_ADC_* in SensorLog.h); die Ausgabe ist in allen Fällen gleich.
+
+Mit --candump gehen nur die CAN-Rahmen im Format von candump -l hinaus (für canplayer, Wireshark):
+    (<sekunden>) can0 <kennung>#<daten>      bzw. <kennung>##<fd-flags><daten>, <kennung>#R
+
+Aufruf:
+    python3 sensorlog_decode.py sensor.bin > sensor.csv
+    python3 sensorlog_decode.py --candump sensor.bin > bus.log
+"""
+
+import struct
+import sys
+
+MAGIC = 0xA5
+SRC_SYNC, SRC_ADC, SRC_POTI, SRC_CLIMATE, SRC_INPUT, SRC_CAN = range(6)
+HEADER = struct.Struct("<BBHI")
+ADC_RAW, ADC_DELTA, ADC_LZ4 = range(3)
+
+# Core/Inc/Can.h
+CAN_FLAG_EXTENDED, CAN_FLAG_REMOTE, CAN_FLAG_FD, CAN_FLAG_BRS = 0x01, 0x02, 0x04, 0x08
+
+
+class Clock:
+    """Löst die unteren 32 Bit der µs-Zeit über den letzten SYNC zu Sekunden seit Beginn auf."""
+
+    def __init__(self):
+        self.base = None
+        self.start = None
+
+    def sync(self, high, low):
+        self.base = (high << 32) | low
+        if self.start is None:
+            self.start = self.base
+
+    def seconds(self, low):
+        if self.base is None:
+            return 0.0
+        full = (self.base & ~0xFFFFFFFF) | low
+        if full - self.base > 0x80000000:
+            full -= 1 << 32
+        elif self.base - full > 0x80000000:
+            full += 1 << 32
+        return (full - self.start) / 1e6
+
+
+def lz4_decode(data, size):
+    """Entpackt einen LZ4-Block (LogCodec_Lz4Compress()) zu size Bytes."""
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        token = data[pos]
+        pos += 1
+        literals = token >> 4
+        if literals == 15:
+            while True:
+                literals += data[pos]
+                pos += 1
+                if data[pos - 1] != 255:
+                    break
+        out += data[pos:pos + literals]
+        pos += literals
+        if pos >= len(data):
+            break
+        offset = data[pos] | (data[pos + 1] << 8)
+        pos += 2
+        length = token & 15
+        if length == 15:
+            while True:
+                length += data[pos]
+                pos += 1
+                if data[pos - 1] != 255:
+                    break
+        # Overlapping copies repeat the last offset bytes
+        for _ in range(length + 4):
+            out.append(out[-offset])
+    if len(out) != size:
+        raise ValueError(f"LZ4: {len(out)} statt {size} Bytes")
+    return bytes(out)
+
+
+def delta_decode(data, count, channels):
+    """Kehrt LogCodec_DeltaEncode() um: Zig-Zag-Varints, Differenz zum vorigen Wert im Kanal."""
+    values = []
+    pos = 0
+    for i in range(count):
+        zigzag = shift = 0
+        while True:
+            byte = data[pos]
+            pos += 1
+            zigzag |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                break
+        delta = (zigzag >> 1) ^ -(zigzag & 1)
+        values.append((values[i - channels] if i >= channels else 0) + delta)
+    return values
+
+
+def adc_values(body, scans, slots, encoding):
+    """Die Scans x Slots Werte eines ADC-Satzes ab Byte 12 + Slots."""
+    payload = body[12 + slots:]
+    if encoding == ADC_RAW:
+        return struct.unpack_from(f"<{scans * slots}H", payload)
+    if encoding == ADC_LZ4:
+        size = struct.unpack_from("<H", payload)[0]
+        payload = lz4_decode(payload[2:], size)
+    elif encoding != ADC_DELTA:
+        raise ValueError(f"unbekannte Kodierung {encoding}")
+    return delta_decode(payload, scans * slots, slots)
+
+
+def candump(seconds, ident, flags, payload):
+    """Eine Zeile wie candump -l; die Zeit sind Sekunden seit Beginn der Aufzeichnung."""
+    name = f"{ident:08X}" if flags & CAN_FLAG_EXTENDED else f"{ident:03X}"
+    if flags & CAN_FLAG_REMOTE:
+        frame = f"{name}#R"
+    elif flags & CAN_FLAG_FD:
+        frame = f"{name}##{1 if flags & CAN_FLAG_BRS else 0:X}{payload.hex().upper()}"
+    else:
+        frame = f"{name}#{payload.hex().upper()}"
+    return f"({seconds:.6f}) can0 {frame}\n"
+
+
+def decode(data, out, err, only_can=False):
+    clock = Clock()
+    pos = 0
+    last_block = None
+    skipped = 0
+
+    # Records of different sources are interleaved, ADC blocks may come after newer events
+    while pos + HEADER.size <= len(data):
+        magic, source, length, stamp = HEADER.unpack_from(data, pos)
+        if magic != MAGIC or pos + HEADER.size + length > len(data):
+            pos += 1
+            skipped += 1
+            continue
+        if skipped:
+            print(f"{skipped} Bytes übersprungen vor Offset {pos}", file=err)
+            skipped = 0
+
+        body = data[pos + HEADER.size:pos + HEADER.size + length]
+        pos += HEADER.size + length
+
+        if source == SRC_SYNC:
+            high, tick, dropped = struct.unpack_from("<III", body)
+            # Older files have no CAN word
+            can_lost = struct.unpack_from("<I", body, 12)[0] if len(body) >= 16 else 0
+            clock.sync(high, stamp)
+            if dropped or can_lost:
+                print(f"SYNC bei {tick} ms: {dropped} Sätze verworfen, {can_lost} CAN-Rahmen übergelaufen", file=err)
+        elif source == SRC_CAN:
+            ident, flags, size, fifo = struct.unpack_from("<IBBB", body)
+            payload = body[8:8 + size]
+            if only_can:
+                out.write(candump(clock.seconds(stamp), ident, flags, payload))
+            else:
+                out.write(f"can,{clock.seconds(stamp):.6f},{ident:X},{flags},{fifo},{payload.hex()}\n")
+        elif only_can:
+            continue
+        elif source == SRC_ADC:
+            sequence, scan_hz, scans, slots, encoding = struct.unpack_from("<IIHBB", body)
+            channels = body[12:12 + slots]
+            try:
+                values = adc_values(body, scans, slots, encoding)
+            except (ValueError, IndexError, struct.error) as e:
+                print(f"ADC: Block {sequence} nicht lesbar ({e})", file=err)
+                continue
+            if last_block is not None and sequence != last_block + 1:
+                print(f"ADC: {sequence - last_block - 1} Blöcke fehlen vor {sequence}", file=err)
+            last_block = sequence
+            end = clock.seconds(stamp)
+            for s in range(scans):
+                t = end - (scans - s) / scan_hz if scan_hz else end
+                for k in range(slots):
+                    out.write(f"adc,{t:.6f},{channels[k]},{values[s * slots + k]}\n")
+        elif source == SRC_POTI:
+            values = struct.unpack_from("<4H", body)
+            out.write(f"poti,{clock.seconds(stamp):.6f}," + ",".join(map(str, values)) + "\n")
+        elif source == SRC_CLIMATE:
+            values = struct.unpack_from("<hHhH", body)
+            out.write(f"climate,{clock.seconds(stamp):.6f}," + ",".join(f"{v / 100:.2f}" for v in values) + "\n")
+        elif source == SRC_INPUT:
+            inp, kind, mask, _, number = struct.unpack_from("<BBBBI", body)
+            if len(body) >= 12:
+                # Full mask including the gamepad inputs, older recordings only have the low byte
+                (mask,) = struct.unpack_from("<I", body, 8)
+            out.write(f"input,{clock.seconds(stamp):.6f},{inp},{kind},{mask},{number}\n")
+
+
+def main():
+    args = sys.argv[1:]
+    only_can = "--candump" in args
+    if only_can:
+        args.remove("--candump")
+    if len(args) != 1:
+        print(__doc__, file=sys.stderr)
+        return 1
+    with open(args[0], "rb") as f:
+        decode(f.read(), sys.stdout, sys.stderr, only_can)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""
+size_report.py - Speicherbelegung der Firmware aus der Map-Datei des GNU-Linkers.
+
+Liest "Memory Configuration" und "Linker script and memory map" aus CLionTest.map und ordnet
+jede Eingabesektion (-ffunction-sections/-fdata-sections, eine Sektion je Funktion oder
+Variable) über ihre Adresse einem Speicherbereich zu. Sektionen in Ausgabesektionen mit
+"load address" (.data, .itcm_text, .dtcm_data) zählen zusätzlich im Bereich der Ladeadresse,
+ihr Abbild liegt im FLASH.
+
+Ausgabe:
+    Bereiche     belegt / Größe je MEMORY-Eintrag des Linkerskripts
+    Module       Belegung je Objektdatei (Quelldatei bzw. Bibliothek) und Bereich
+    Symbole      die größten Funktionen und Variablen mit Bereich und Modul
+    QSPI         konstante Daten (.rodata) ab --qspi-min Bytes im FLASH: Kandidaten für das
+                 Asset-Bundle im W25Qxx (Zeichensätze, Bilder, Tabellen, siehe asset_pack.py)
+
+Budgets werden als BEREICH=GRENZE angegeben, die Grenze in Bytes, mit K/M oder in Prozent
+der Bereichsgröße. Ist ein Budget überschritten, endet das Werkzeug mit Rückgabewert 1, das
+CMake-Ziel size_report schlägt dann fehl.
+
+Aufruf:
+    python3 size_report.py CLionTest.map [--budget FLASH=90%] [--budget RAM=512K]
+    Optionen: --top 20 (Anzahl Symbole), --qspi-min 1024 (Bytes), --modules 0 (alle Module)
+"""
+
+import os
+import re
+import sys
+
+_SECTION = re.compile(r"^ (\.\S+|COMMON)\s*(?:(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*))?$")
+_CONTINUED = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*)$")
+_SYMBOL = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+([A-Za-z_.$][\w.$]*)\s*$")
+_OUTPUT = re.compile(r"^(\.\S+)\s*(?:(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)(?:\s+load address\s+(0x[0-9a-fA-F]+))?)?\s*$")
+_LOAD = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+load address\s+(0x[0-9a-fA-F]+)")
+
+_RODATA = (".rodata", ".constdata")
+
+
+class Section:
+    def __init__(self, name, output, address, size, module, load):
+        self.name = name
+        self.output = output
+        self.address = address
+        self.size = size
+        self.module = module
+        self.load = load          # Ladeadresse im FLASH oder None
+        self.symbols = []         # (Adresse, Name)
+
+
+def _module_name(path):
+    """Kurzname einer Objektdatei: Core/Src/main.c.obj -> main.c, libc.a(memcpy.o) -> libc.a(memcpy.o)."""
+    path = path.replace("\\", "/")
+    if "(" in path:
+        return os.path.basename(path)
+    name = os.path.basename(path)
+    for suffix in (".obj", ".o"):
+        if name.endswith(suffix):
+            return name[:-len(suffix)]
+    return name
+
+
+def parse(lines):
+    """Liefert (Bereiche, Sektionen); Bereiche als Liste (Name, Anfang, Größe)."""
+    regions = []
+    sections = []
+    state = None
+    output = None
+    output_load = None
+    pending = None
+    current = None
+
+    for line in lines:
+        line = line.rstrip("\n")
+        if line.startswith("Memory Configuration"):
+            state = "memory"
+            continue
+        if line.startswith("Linker script and memory map"):
+            state = "map"
+            continue
+        if line.startswith("Discarded input sections") or line.startswith("Cross Reference Table"):
+            state = None
+            continue
+
+        if state == "memory":
+            fields = line.split()
+            if len(fields) >= 3 and fields[1].startswith("0x") and fields[0] != "*default*":
+                regions.append((fields[0], int(fields[1], 16), int(fields[2], 16)))
+            continue
+        if state != "map" or not line.strip():
+            continue
+
+        # Ausgabesektion, Name allein in einer Zeile wenn er lang ist
+        if not line[0].isspace():
+            match = _OUTPUT.match(line)
+            output, output_load, pending, current = None, None, None, None
+            if match:
+                output = match.group(1)
+                if match.group(4):
+                    output_load = int(match.group(2), 16), int(match.group(4), 16)
+                elif not match.group(2):
+                    pending = "output"
+            continue
+        if pending == "output":
+            pending = None
+            match = _LOAD.match(line)
+            if match:
+                output_load = int(match.group(1), 16), int(match.group(3), 16)
+            continue
+        if output is None:
+            continue
+
+        match = _SECTION.match(line)
+        if match:
+            current = None
+            name = match.group(1)
+            if match.group(2):
+                current = _add_section(sections, name, output, output_load, match.group(2),
+                                       match.group(3), match.group(4))
+                pending = None
+            else:
+                pending = name
+            continue
+        if pending:
+            match = _CONTINUED.match(line)
+            if match:
+                current = _add_section(sections, pending, output, output_load, *match.groups())
+            pending = None
+            continue
+
+        match = _SYMBOL.match(line)
+        if match and current is not None:
+            address = int(match.group(1), 16)
+            if current.address <= address < current.address + max(current.size, 1):
+                current.symbols.append((address, match.group(2)))
+    return regions, sections
+
+
+def _add_section(sections, name, output, output_load, address, size, module):
+    address, size = int(address, 16), int(size, 16)
+    if size == 0 or module.startswith("load address"):
+        return None
+    load = None
+    if output_load is not None:
+        load = output_load[1] + (address - output_load[0])
+    section = Section(name, output, address, size, _module_name(module), load)
+    sections.append(section)
+    return section
+
+
+def region_of(regions, address):
+    for name, origin, length in regions:
+        if origin <= address < origin + length:
+            return name
+    return "?"
+
+
+def symbols_of(section):
+    """Teilt eine Sektion auf ihre Symbole auf; ohne Symbol zählt sie unter ihrem Sektionsnamen."""
+    symbols = sorted(set(section.symbols))
+    if not symbols:
+        name = section.name
+        for prefix in (".text.", ".rodata.", ".data.", ".bss.", ".itcm_text.", ".dtcm_data."):
+            if name.startswith(prefix):
+                name = name[len(prefix):]
+                break
+        return [(name, section.size)]
+    result = []
+    end = section.address + section.size
+    for index, (address, name) in enumerate(symbols):
+        following = symbols[index + 1][0] if index + 1 < len(symbols) else end
+        result.append((name, following - address))
+    return result
+
+
+def parse_budget(text, regions):
+    """'FLASH=90%', 'RAM=512K' oder 'FLASH=120000' -> (Bereich, Grenze in Bytes)."""
+    if "=" not in text:
+        raise ValueError("Budget %s: erwartet BEREICH=GRENZE" % text)
+    name, limit = text.split("=", 1)
+    sizes = dict((r[0], r[2]) for r in regions)
+    if name not in sizes:
+        raise ValueError("Budget %s: Bereich %s fehlt in der Map" % (text, name))
+    limit = limit.strip().upper()
+    if limit.endswith("%"):
+        return name, sizes[name] * float(limit[:-1]) / 100.0
+    factor = 1
+    if limit.endswith("K"):
+        factor, limit = 1024, limit[:-1]
+    elif limit.endswith("M"):
+        factor, limit = 1024 * 1024, limit[:-1]
+    return name, int(limit, 0) * factor
+
+
+def report(regions, sections, budgets, top=20, qspi_min=1024, modules=0, out=sys.stdout):
+    """Gibt den Bericht aus und liefert die Liste der überschrittenen Budgets."""
+    used = dict((r[0], 0) for r in regions)
+    per_module = {}
+    symbols = []
+    candidates = []
+
+    for section in sections:
+        targets = [region_of(regions, section.address)]
+        if section.load is not None:
+            targets.append(region_of(regions, section.load))
+        for region in targets:
+            used[region] = used.get(region, 0) + section.size
+            module = per_module.setdefault(section.module, {})
+            module[region] = module.get(region, 0) + section.size
+        for name, size in symbols_of(section):
+            symbols.append((size, name, targets[0], section.module))
+            if section.name.startswith(_RODATA) and targets[0] == "FLASH" and size >= qspi_min:
+                candidates.append((size, name, section.module))
+
+    names = [r[0] for r in regions]
+    out.write("Bereich          belegt      Größe    Anteil\n")
+    for name, origin, length in regions:
+        share = 100.0 * used[name] / length if length else 0.0
+        out.write("%-12s %10d %10d   %5.1f %%\n" % (name, used[name], length, share))
+
+    shown = [n for n in names if any(n in m for m in per_module.values())]
+    out.write("\nModul                          " + "".join("%10s" % n for n in shown) + "\n")
+    ranking = sorted(per_module.items(), key=lambda item: -sum(item[1].values()))
+    if modules:
+        ranking = ranking[:modules]
+    for module, values in ranking:
+        out.write("%-30s " % module[:30] + "".join("%10d" % values.get(n, 0) for n in shown) + "\n")
+
+    out.write("\nGrößte Symbole\n")
+    for size, name, region, module in sorted(symbols, reverse=True)[:top]:
+        out.write("%8d  %-10s %-36s %s\n" % (size, region, name[:36], module))
+
+    if candidates:
+        out.write("\nKonstante Daten ab %d Bytes im FLASH, Kandidaten für das QSPI-Asset-Bundle\n" % qspi_min)
+        for size, name, module in sorted(candidates, reverse=True):
+            out.write("%8d  %-36s %s\n" % (size, name[:36], module))
+        out.write("%8d  gesamt\n" % sum(c[0] for c in candidates))
+
+    exceeded = []
+    for name, limit in budgets:
+        if used.get(name, 0) > limit:
+            exceeded.append(name)
+            out.write("\nBudget überschritten: %s belegt %d Bytes, erlaubt %d\n" % (name, used[name], int(limit)))
+    return exceeded
+
+
+def main(argv):
+    args = argv[1:]
+    options = {"--top": "20", "--qspi-min": "1024", "--modules": "0"}
+    budgets = []
+    files = []
+    while args:
+        arg = args.pop(0)
+        if arg == "--budget" and args:
+            budgets.append(args.pop(0))
+        elif arg in options and args:
+            options[arg] = args.pop(0)
+        else:
+            files.append(arg)
+    if len(files) != 1:
+        sys.stderr.write("Aufruf: %s <firmware.map> [--budget BEREICH=GRENZE[%%|K|M]]... [--top n] "
+                         "[--qspi-min bytes] [--modules n]\n" % argv[0])
+        return 2
+    try:
+        with open(files[0], encoding="utf-8", errors="replace") as f:
+            regions, sections = parse(f)
+        if not regions:
+            raise ValueError("%s: keine Memory Configuration gefunden" % files[0])
+        limits = [parse_budget(text, regions) for text in budgets]
+    except (OSError, ValueError) as error:
+        sys.stderr.write("size_report: %s\n" % error)
+        return 2
+
+    exceeded = report(regions, sections, limits, int(options["--top"]), int(options["--qspi-min"]),
+                      int(options["--modules"]))
+    return 1 if exceeded else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
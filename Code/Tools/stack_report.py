@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""
+stack_report.py - Größter Stackbedarf der Firmware aus dem Aufrufgraphen des Compilers.
+
+Mit der CMake-Option STACK_USAGE übersetzt GCC jede Quelldatei zusätzlich mit -fstack-usage und
+-fcallgraph-info=su und schreibt neben die Objektdatei eine .ci-Datei (VCG-Format): je Funktion
+den eigenen Rahmen in Byte und alle Aufrufe. Das Werkzeug liest alle .ci-Dateien unter dem
+angegebenen Verzeichnis, verbindet die Graphen über die Funktionsnamen und sucht von jeder Wurzel
+den teuersten Pfad:
+
+    main                    Hauptschleife mit allem, was sie aufruft
+    *_IRQHandler, SysTick   Interrupts; sie laufen auf demselben Stack (MSP) wie main()
+
+Interrupts gleicher Priorität unterbrechen sich nicht. Die Priorität jedes Handlers kommt aus
+Irq_Plan in Core/Src/Irq.c und den IRQ_PRIO_* in Core/Inc/Irq.h. Der schlimmste Fall ist main()
+plus je Prioritätsstufe der teuerste Handler mit seinem Ausnahmerahmen (108 Byte mit FPU-Kontext).
+Handler ohne Eintrag im Plan zählen als eigene Stufe, Fehler-Handler (HardFault, ...) gar nicht.
+
+Was der Graph nicht kennt, steht in der Ausgabe als Warnung und macht das Ergebnis zur unteren
+Schranke:
+    extern      Funktion ohne .ci (newlib: printf, memcpy, ...); --extern NAME=BYTES setzt einen Wert
+    dynamisch   Rahmen mit VLA oder alloca ohne feste Grenze
+    rekursiv    Zyklus im Graphen, nur ein Durchlauf gezählt
+Indirekte Aufrufe (Funktionszeiger: Scheduler-Tasks, Callbacks) werden als der teuerste Kandidat
+gezählt; Kandidaten sind alle Funktionen, die nirgends direkt aufgerufen werden.
+
+Ohne --stack gilt _Min_Stack_Size aus dem Linkerskript (--ld) als Budget. Ist es überschritten,
+endet das Werkzeug mit Rückgabewert 1, das CMake-Ziel stack_report schlägt dann fehl.
+
+Aufruf:
+    python3 stack_report.py build/CMakeFiles/CLionTest.elf.dir --irq Core/Src/Irq.c --prio Core/Inc/Irq.h
+            [--ld STM32H7B0VBTX_FLASH.ld] [--stack 8K] [--extern printf=1200] [--top 10]
+"""
+
+import os
+import re
+import sys
+
+_NODE = re.compile(r'^node: \{ title: "([^"]*)" label: "((?:[^"\\]|\\.)*)"(.*)\}\s*$')
+_EDGE = re.compile(r'^edge: \{ sourcename: "([^"]*)" targetname: "([^"]*)"')
+_BYTES = re.compile(r"^(\d+) bytes \(([\w,]+)\)$")
+_PLAN = re.compile(r"\{\s*(\w+)_IRQn\s*,\s*(\w+)\s*\}")
+_PRIO = re.compile(r"^#define\s+(IRQ_PRIO_\w+)\s+(\S+)")
+_LD_STACK = re.compile(r"_Min_Stack_Size\s*=\s*(0x[0-9a-fA-F]+|\d+)")
+
+INDIRECT = "__indirect_call"
+EXCEPTION_FRAME = 108       # 26 words with FPU context plus alignment
+SYSTICK_PRIO = 0            # TICK_INT_PRIORITY in stm32h7xx_hal_conf.h
+FAULTS = ("NMI_Handler", "HardFault_Handler", "MemManage_Handler", "BusFault_Handler",
+          "UsageFault_Handler", "DebugMon_Handler")
+
+
+class Function:
+    def __init__(self, title, name, location, size, qualifier):
+        self.title = title
+        self.name = name
+        self.location = location
+        self.size = size
+        self.qualifier = qualifier
+        self.calls = []
+
+
+class Graph:
+    def __init__(self):
+        self.functions = {}
+        self.externals = {}
+        self.edges = []
+        self.source_files = 0
+
+    def read(self, path):
+        self.source_files += 1
+        with open(path, encoding="utf-8", errors="replace") as f:
+            for line in f:
+                match = _NODE.match(line)
+                if match:
+                    self.node(match.group(1), match.group(2).split("\\n"))
+                    continue
+                match = _EDGE.match(line)
+                if match:
+                    self.edges.append((match.group(1), match.group(2)))
+
+    def node(self, title, label):
+        size = None
+        for part in label[2:]:
+            match = _BYTES.match(part)
+            if match:
+                size = (int(match.group(1)), match.group(2))
+        if size is None:
+            # Declaration only: defined in another file or in a library
+            self.externals.setdefault(title, label[0])
+        elif title not in self.functions:
+            self.functions[title] = Function(title, label[0], label[1] if len(label) > 1 else "?",
+                                             size[0], size[1])
+
+    def link(self):
+        """Verbindet die Graphen aller Dateien, liefert die Kandidaten für indirekte Aufrufe."""
+        called = set()
+        for source, target in self.edges:
+            if source in self.functions:
+                self.functions[source].calls.append(target)
+                called.add(target)
+        return sorted(title for title in self.functions if title not in called)
+
+
+class Analysis:
+    def __init__(self, graph, externals):
+        self.graph = graph
+        self.externals = externals
+        self.candidates = [t for t in graph.link() if not is_root(graph.functions[t].name)]
+        self.memo = {}
+        self.active = set()
+
+    def worst(self, title):
+        """(Byte, Pfad, Warnungen) des teuersten Pfads ab title."""
+        if title in self.memo:
+            return self.memo[title]
+        if title in self.active:
+            return 0, [title], {"rekursiv: " + self.name(title)}
+        self.active.add(title)
+
+        if title == INDIRECT:
+            result = self.choose([self.worst(t) for t in self.candidates], title, 0, set())
+        elif title in self.graph.functions:
+            function = self.graph.functions[title]
+            warnings = set()
+            if "dynamic" in function.qualifier and "bounded" not in function.qualifier:
+                warnings.add("dynamisch: " + function.name)
+            result = self.choose([self.worst(t) for t in function.calls], title, function.size, warnings)
+        elif title in self.externals:
+            result = self.externals[title], [title], set()
+        else:
+            result = 0, [title], {"extern: " + self.name(title)}
+
+        self.active.discard(title)
+        self.memo[title] = result
+        return result
+
+    @staticmethod
+    def choose(callees, title, size, warnings):
+        deepest = (0, [], set())
+        for callee in callees:
+            warnings = warnings | callee[2]
+            if callee[0] > deepest[0]:
+                deepest = callee
+        return size + deepest[0], [title] + deepest[1], warnings
+
+    def name(self, title):
+        if title in self.graph.functions:
+            return self.graph.functions[title].name
+        return self.graph.externals.get(title, title)
+
+
+def is_root(name):
+    return name == "main" or name.endswith("_IRQHandler") or name.endswith("_Handler")
+
+
+def read_plan(irq_path, prio_path):
+    """Handlername -> Priorität aus Irq_Plan und IRQ_PRIO_*."""
+    levels = {}
+    if prio_path:
+        with open(prio_path, encoding="utf-8", errors="replace") as f:
+            for line in f:
+                match = _PRIO.match(line)
+                if match:
+                    try:
+                        levels[match.group(1)] = int(match.group(2), 0)
+                    except ValueError:
+                        levels[match.group(1)] = SYSTICK_PRIO if "TICK" in match.group(2) else None
+    plan = {"SysTick_Handler": SYSTICK_PRIO}
+    if irq_path:
+        with open(irq_path, encoding="utf-8", errors="replace") as f:
+            text = f.read()
+        start = text.find("Irq_Plan[]")
+        end = text.find("};", start)
+        for irq, prio in _PLAN.findall(text[start:end] if start >= 0 else ""):
+            plan[irq + "_IRQHandler"] = levels.get(prio)
+    return plan
+
+
+def parse_size(text):
+    text = text.strip().upper()
+    factor = 1
+    if text.endswith("K"):
+        factor, text = 1024, text[:-1]
+    elif text.endswith("M"):
+        factor, text = 1024 * 1024, text[:-1]
+    return int(text, 0) * factor
+
+
+def read_ld_stack(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        match = _LD_STACK.search(f.read())
+    if not match:
+        raise ValueError("%s: kein _Min_Stack_Size" % path)
+    return int(match.group(1), 0)
+
+
+def find_ci(root):
+    paths = []
+    for directory, _, names in os.walk(root):
+        paths.extend(os.path.join(directory, name) for name in names if name.endswith(".ci"))
+    return sorted(paths)
+
+
+def show_path(analysis, path):
+    return " > ".join(analysis.name(title) for title in path)
+
+
+def report(analysis, plan, budget, top):
+    functions = analysis.graph.functions
+    roots = sorted((f for f in functions.values() if is_root(f.name)), key=lambda f: f.name)
+    warnings = set()
+
+    print("Aufrufgraph: %d Dateien, %d Funktionen, %d Kandidaten für indirekte Aufrufe"
+          % (analysis.graph.source_files, len(functions), len(analysis.candidates)))
+    print()
+    print("Größte Rahmen")
+    for function in sorted(functions.values(), key=lambda f: -f.size)[:top]:
+        print("  %6d  %-32s %s %s" % (function.size, function.name, function.location,
+                                      "" if function.qualifier == "static" else "(" + function.qualifier + ")"))
+
+    main_bytes = 0
+    levels = {}
+    print()
+    print("Wurzeln (Byte ohne Ausnahmerahmen, Pfad)")
+    for function in roots:
+        size, path, found = analysis.worst(function.title)
+        if function.name in FAULTS:
+            label = "Fehler"
+        elif function.name == "main":
+            label = "main"
+            main_bytes = size
+            warnings |= found
+        else:
+            prio = plan.get(function.name)
+            label = "Prio %s" % ("?" if prio is None else prio)
+            key = ("?", function.name) if prio is None else prio
+            if key not in levels or size > levels[key][0]:
+                levels[key] = (size, function.name)
+            warnings |= found
+        print("  %6d  %-8s %s" % (size, label, show_path(analysis, path)))
+
+    total = main_bytes + sum(size + EXCEPTION_FRAME for size, _ in levels.values())
+    print()
+    print("Schlimmster Fall: main %d Byte + %d Prioritätsstufen mit je %d Byte Ausnahmerahmen"
+          % (main_bytes, len(levels), EXCEPTION_FRAME))
+    for key in sorted(levels, key=lambda k: (isinstance(k, tuple), k)):
+        size, name = levels[key]
+        print("  %-6s %6d  %s" % ("?" if isinstance(key, tuple) else key, size + EXCEPTION_FRAME, name))
+    print("  Summe  %6d Byte" % total)
+
+    if warnings:
+        print()
+        print("Nicht erfasst, Summe ist eine untere Schranke:")
+        for warning in sorted(warnings):
+            print("  " + warning)
+
+    if budget is not None:
+        print()
+        state = "ÜBERSCHRITTEN" if total > budget else "ok"
+        print("Budget %d Byte: %s (%d%%)" % (budget, state, total * 100 // budget if budget else 0))
+        return total > budget
+    return False
+
+
+def main(argv):
+    args = argv[1:]
+    options = {"--irq": None, "--prio": None, "--ld": None, "--stack": None, "--top": "10"}
+    externals = {}
+    dirs = []
+    while args:
+        arg = args.pop(0)
+        if arg == "--extern" and args:
+            name, _, value = args.pop(0).partition("=")
+            externals[name] = value
+        elif arg in options and args:
+            options[arg] = args.pop(0)
+        else:
+            dirs.append(arg)
+    if len(dirs) != 1:
+        sys.stderr.write("Aufruf: %s <objektverzeichnis> [--irq Irq.c] [--prio Irq.h] [--ld skript.ld] "
+                         "[--stack BYTES[K|M]] [--extern NAME=BYTES]... [--top n]\n" % argv[0])
+        return 2
+    try:
+        paths = find_ci(dirs[0])
+        if not paths:
+            raise ValueError("%s: keine .ci-Dateien (mit -DSTACK_USAGE=ON übersetzen)" % dirs[0])
+        graph = Graph()
+        for path in paths:
+            graph.read(path)
+        externals = {name: parse_size(value) for name, value in externals.items()}
+        plan = read_plan(options["--irq"], options["--prio"])
+        budget = None
+        if options["--stack"]:
+            budget = parse_size(options["--stack"])
+        elif options["--ld"]:
+            budget = read_ld_stack(options["--ld"])
+    except (OSError, ValueError) as error:
+        sys.stderr.write("stack_report: %s\n" % error)
+        return 2
+
+    exceeded = report(Analysis(graph, externals), plan, budget, int(options["--top"]))
+    return 1 if exceeded else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,318 @@
+#!/usr/bin/env python3
+"""
+tcm_place.py - Legt heiße Funktionen ins ITCM und heiße Variablen ins DTCM, nach einem Profil.
+
+Welche Funktion RAMFUNC verdient, war bisher Schätzung. Das Werkzeug nimmt statt dessen gemessene
+Treffer je Funktion und schreibt zwei Linker-Fragmente, die STM32H7B0VBTX_FLASH.ld einbindet:
+
+    tcm_itcm.ld   *(.text.<funktion>) in .itcm_text (ITCMRAM)
+    tcm_dtcm.ld   *(.data.<variable>) / *(.bss.<variable>) in .dtcm_data (DTCMRAM1)
+
+Ohne Profil gelten die leeren Fragmente neben dem Linkerskript. Mit der CMake-Variable
+TCM_PROFILE läuft "place" vor jedem Linken der Firmware (PRE_LINK) und schreibt die Fragmente ins
+Build-Verzeichnis, die Platzierung folgt also jeder Codeänderung. Jede Funktion und Variable hat
+dank -ffunction-sections/-fdata-sections ihre eigene Sektion.
+
+profile: SWO-Mitschnitt mit PC-Abtastung ('trace pc' in der Shell, Core/Src/Trace.c) und die
+    dabei laufende .elf ergeben die Treffer je Funktion als CSV (function,samples). Abtastwerte
+    im Schlaf (WFI) zählen als "sleep" und zu keiner Funktion.
+place: liest das Profil (Spalten function und samples oder cycles, etwa auch aus Prof-Messungen),
+    die Sektionsgrößen und Relokationen aller Objektdateien (objdump -h -r) und die Größe von
+    ITCMRAM und DTCMRAM1 aus dem Linkerskript. Was schon fest im ITCM bzw. DTCM liegt (RAMFUNC,
+    *_IRQHandler, FASTDATA), geht vom Budget ab, ebenso --itcm-reserve bzw. --dtcm-reserve für
+    Veneers und Ausrichtung. Dann füllt es nach Treffern je Byte, bis das Budget erschöpft ist;
+    Funktionen unter --min-share Prozent aller Treffer bleiben im Flash.
+    Variablen werden nach den Treffern der Funktionen gewichtet, die sie über Relokationen
+    ansprechen. DMA1/DMA2 erreichen das DTCM nicht: Variablen über --max-data Bytes und Namen
+    auf --exclude-data (Standard: dma, buf) bleiben, wo sie sind.
+
+Der Startcode bis zur Kopie ins ITCM (Reset_Handler, SystemInit, __libc_init_array) wird nie
+verschoben. Die Ausgabe listet alle Entscheidungen; Rückgabewert 2 bei fehlenden Dateien.
+
+Aufruf:
+    python3 tcm_place.py profile mitschnitt.swo --elf CLionTest.elf [-o profil.csv]
+    python3 tcm_place.py place profil.csv --objects build/CMakeFiles/CLionTest.elf.dir
+            --ld STM32H7B0VBTX_FLASH.ld --out build/tcm/CLionTest.elf
+    Optionen: --objdump arm-none-eabi-objdump, --itcm-reserve 2K, --dtcm-reserve 1K,
+              --min-share 0.1, --max-data 4K, --exclude-data REGEX, --exclude REGEX
+"""
+
+import bisect
+import csv
+import os
+import re
+import subprocess
+import sys
+
+from trace_decode import packets
+
+ITCM_REGION = "ITCMRAM"
+DTCM_REGION = "DTCMRAM1"
+ITCM_FILE = "tcm_itcm.ld"
+DTCM_FILE = "tcm_dtcm.ld"
+
+# Runs before the startup code has copied .itcm_text
+STARTUP = r"^(Reset_Handler|SystemInit|__libc_init_array|_start)$"
+EXCLUDE_DATA = r"(?i)dma|buf"
+PC_SAMPLE = 2               # DWT discriminator of a PC sample packet
+
+_MEMORY = re.compile(r"^\s*(\w+)\s*\([^)]*\)\s*:\s*ORIGIN\s*=\s*\S+\s*,\s*LENGTH\s*=\s*(\w+)", re.M)
+_SECTION = re.compile(r"^\s*\d+\s+(\S+)\s+([0-9a-fA-F]+)\s+[0-9a-fA-F]+\s+[0-9a-fA-F]+")
+_RELOCS = re.compile(r"^RELOCATION RECORDS FOR \[(\S+)\]:")
+_RELOC = re.compile(r"^[0-9a-fA-F]+\s+R_\w+\s+(\S+)")
+_SYMBOL = re.compile(r"^([0-9a-fA-F]+)\s(.{7})\s(\S+)\s+([0-9a-fA-F]+)\s+(\S+)$")
+_FIXED_ITCM = re.compile(r"^\.itcm_text|^\.text\..*_IRQHandler$")
+_FIXED_DTCM = re.compile(r"^\.dtcm_data")
+_DATA = re.compile(r"^\.(data|bss)\.(.+)$")
+
+
+def parse_size(text):
+    text = text.strip().upper()
+    scale = {"K": 1024, "M": 1024 * 1024}.get(text[-1:], 1)
+    number = text[:-1] if text[-1:] in ("K", "M") else text
+    return int(number, 0) * scale
+
+
+def read_memory(path):
+    """LENGTH je MEMORY-Eintrag des Linkerskripts."""
+    with open(path, encoding="utf-8") as script:
+        return {name: parse_size(length) for name, length in _MEMORY.findall(script.read())}
+
+
+def run_objdump(objdump, flags, path):
+    result = subprocess.run([objdump] + flags + [path], stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        raise OSError("%s %s: %s" % (objdump, path, result.stderr.strip()))
+    return result.stdout
+
+
+# ------------------------------------------------------------------ profile
+
+def read_functions(objdump, elf):
+    """(Startadressen, [(start, ende, name)]) aller Funktionen der .elf, Thumb-Bit entfernt."""
+    functions = []
+    for line in run_objdump(objdump, ["-t"], elf).splitlines():
+        match = _SYMBOL.match(line)
+        if not match or "F" not in match.group(2):
+            continue
+        start = int(match.group(1), 16) & ~1
+        size = int(match.group(4), 16)
+        if size:
+            functions.append((start, start + size, match.group(5)))
+    functions.sort()
+    return [f[0] for f in functions], functions
+
+
+def profile(swo, elf, objdump, out):
+    starts, functions = read_functions(objdump, elf)
+    counts = {}
+    total = 0
+    with open(swo, "rb") as capture:
+        data = capture.read()
+    for packet in packets(data):
+        if packet[0] != "hw" or packet[1] != PC_SAMPLE:
+            continue
+        total += 1
+        if packet[3] != 4:
+            name = "sleep"
+        else:
+            pc = packet[2] & ~1
+            index = bisect.bisect_right(starts, pc) - 1
+            name = functions[index][2] if index >= 0 and pc < functions[index][1] else "?"
+        counts[name] = counts.get(name, 0) + 1
+    if total == 0:
+        raise ValueError("%s: keine PC-Abtastwerte ('trace pc' in der Shell)" % swo)
+
+    writer = csv.writer(out, lineterminator="\n")
+    writer.writerow(["function", "samples", "share"])
+    for name, count in sorted(counts.items(), key=lambda item: -item[1]):
+        writer.writerow([name, count, "%.2f" % (count * 100.0 / total)])
+    sys.stderr.write("tcm_place: %d Abtastwerte, %d Funktionen\n" % (total, len(counts)))
+
+
+# ------------------------------------------------------------------ place
+
+def read_profile(path):
+    """Treffer je Funktion aus einer CSV mit den Spalten function und samples bzw. cycles."""
+    weights = {}
+    with open(path, encoding="utf-8", newline="") as source:
+        rows = csv.DictReader(line for line in source if not line.startswith("#"))
+        column = next((c for c in ("samples", "cycles", "weight") if c in (rows.fieldnames or ())), None)
+        if "function" not in (rows.fieldnames or ()) or column is None:
+            raise ValueError("%s: Spalten function und samples|cycles fehlen" % path)
+        for row in rows:
+            name = row["function"].strip()
+            if name and name not in ("sleep", "?"):
+                weights[name] = weights.get(name, 0) + float(row[column] or 0)
+    return weights
+
+
+class Objects:
+    """Sektionsgrößen und Relokationen aller Objektdateien unter einem Verzeichnis."""
+
+    def __init__(self, objdump, base):
+        self.sizes = {}           # section name -> bytes, summed over all objects
+        self.refs = {}            # code section -> referenced symbols and sections
+        self.files = 0
+        for root, _, names in os.walk(base):
+            for name in sorted(names):
+                if name.endswith((".obj", ".o")):
+                    self.read(run_objdump(objdump, ["-h", "-r"], os.path.join(root, name)))
+                    self.files += 1
+        if not self.files:
+            raise ValueError("%s: keine Objektdateien" % base)
+
+    def read(self, text):
+        current = None
+        for line in text.splitlines():
+            match = _RELOCS.match(line)
+            if match:
+                current = self.refs.setdefault(match.group(1), set())
+                continue
+            match = _RELOC.match(line) if current is not None else None
+            if match:
+                current.add(match.group(1).split("+")[0].split("-")[0])
+                continue
+            match = _SECTION.match(line)
+            if match:
+                current = None
+                self.sizes[match.group(1)] = self.sizes.get(match.group(1), 0) + int(match.group(2), 16)
+
+    def fixed(self, pattern):
+        return sum(size for name, size in self.sizes.items() if pattern.search(name))
+
+    def data_section(self, reference):
+        """Sektion einer Variable: direkt (.bss.x bei static) oder über den Symbolnamen."""
+        if _DATA.match(reference):
+            return reference if reference in self.sizes else None
+        for prefix in (".data.", ".bss."):
+            if prefix + reference in self.sizes:
+                return prefix + reference
+        return None
+
+
+def fill(candidates, budget):
+    """Gierig nach Treffern je Byte: [(gewicht, größe, sektion, name)] -> (gewählt, verbraucht)."""
+    chosen = []
+    used = 0
+    for weight, size, section, name in sorted(candidates, key=lambda c: -c[0] / max(c[1], 1)):
+        if used + size <= budget:
+            chosen.append((weight, size, section, name))
+            used += size
+    return chosen, used
+
+
+def write_fragment(path, title, source, chosen, total):
+    lines = ["/* %s - erzeugt von Tools/tcm_place.py aus %s, nicht von Hand ändern */" % (title, source)]
+    for weight, size, section, name in sorted(chosen, key=lambda c: c[2]):
+        lines.append("*(%s)    /* %d B, %.1f %% */" % (section, size, weight * 100.0 / total))
+    with open(path, "w", encoding="utf-8") as fragment:
+        fragment.write("\n".join(lines) + "\n")
+
+
+def place(options):
+    weights = read_profile(options["profile"])
+    total = sum(weights.values())
+    if total <= 0:
+        raise ValueError("%s: keine Treffer" % options["profile"])
+    memory = read_memory(options["--ld"])
+    for region in (ITCM_REGION, DTCM_REGION):
+        if region not in memory:
+            raise ValueError("%s: kein MEMORY-Eintrag %s" % (options["--ld"], region))
+    objects = Objects(options["--objdump"], options["--objects"])
+    exclude = re.compile(options["--exclude"]) if options["--exclude"] else None
+    startup = re.compile(STARTUP)
+    exclude_data = re.compile(options["--exclude-data"])
+    min_share = float(options["--min-share"]) / 100.0
+    max_data = parse_size(options["--max-data"])
+
+    itcm_budget = (memory[ITCM_REGION] - objects.fixed(_FIXED_ITCM) - parse_size(options["--itcm-reserve"]))
+    dtcm_budget = (memory[DTCM_REGION] - objects.fixed(_FIXED_DTCM) - parse_size(options["--dtcm-reserve"]))
+
+    code = []
+    skipped = []
+    data = {}
+    for name, weight in weights.items():
+        section = ".text." + name
+        if section in objects.sizes:
+            for reference in objects.refs.get(section, ()):
+                target = objects.data_section(reference)
+                if target:
+                    data[target] = data.get(target, 0) + weight
+        if startup.search(name) or (exclude and exclude.search(name)):
+            skipped.append((name, "ausgenommen"))
+        elif section not in objects.sizes:
+            skipped.append((name, "keine Sektion .text.%s (RAMFUNC, Overlay, Bibliothek?)" % name))
+        elif weight < total * min_share:
+            skipped.append((name, "unter --min-share"))
+        else:
+            code.append((weight, objects.sizes[section], section, name))
+
+    data_candidates = []
+    for section, weight in data.items():
+        name = _DATA.match(section).group(2)
+        size = objects.sizes[section]
+        if size > max_data or exclude_data.search(name):
+            skipped.append((name, "Variable bleibt (%d B oder --exclude-data)" % size))
+        elif weight >= total * min_share:
+            data_candidates.append((weight, size, section, name))
+
+    code_chosen, code_used = fill(code, max(itcm_budget, 0))
+    data_chosen, data_used = fill(data_candidates, max(dtcm_budget, 0))
+
+    os.makedirs(options["--out"], exist_ok=True)
+    source = os.path.basename(options["profile"])
+    write_fragment(os.path.join(options["--out"], ITCM_FILE), "ITCM", source, code_chosen, total)
+    write_fragment(os.path.join(options["--out"], DTCM_FILE), "DTCM", source, data_chosen, total)
+
+    share = sum(c[0] for c in code_chosen) * 100.0 / total
+    print("tcm_place: ITCM %d von %d B frei belegt, %d Funktionen, %.1f %% der Treffer"
+          % (code_used, max(itcm_budget, 0), len(code_chosen), share))
+    print("tcm_place: DTCM %d von %d B frei belegt, %d Variablen" % (data_used, max(dtcm_budget, 0), len(data_chosen)))
+    for weight, size, section, name in sorted(code_chosen + data_chosen, key=lambda c: -c[0]):
+        print("  %-40s %6d B %6.1f %%" % (section, size, weight * 100.0 / total))
+    left = [c for c in code if c not in code_chosen]
+    for weight, size, section, name in sorted(left, key=lambda c: -c[0])[:10]:
+        print("  passt nicht: %-28s %6d B %6.1f %%" % (name, size, weight * 100.0 / total))
+    for name, reason in skipped[:20]:
+        print("  übergangen: %-29s %s" % (name, reason))
+    return 0
+
+
+def main(argv):
+    args = argv[1:]
+    options = {"--elf": None, "-o": None, "--objects": None, "--ld": None, "--out": None,
+               "--objdump": "arm-none-eabi-objdump", "--itcm-reserve": "2K", "--dtcm-reserve": "1K",
+               "--min-share": "0.1", "--max-data": "4K", "--exclude-data": EXCLUDE_DATA, "--exclude": None}
+    positional = []
+    while args:
+        arg = args.pop(0)
+        if arg in options and args:
+            options[arg] = args.pop(0)
+        else:
+            positional.append(arg)
+    command = positional[0] if positional else None
+    try:
+        if command == "profile" and len(positional) == 2 and options["--elf"]:
+            out = open(options["-o"], "w", encoding="utf-8") if options["-o"] else sys.stdout
+            try:
+                profile(positional[1], options["--elf"], options["--objdump"], out)
+            finally:
+                if out is not sys.stdout:
+                    out.close()
+            return 0
+        if command == "place" and len(positional) == 2 and options["--objects"] and options["--ld"] and options["--out"]:
+            options["profile"] = positional[1]
+            return place(options)
+    except (OSError, ValueError, re.error) as error:
+        sys.stderr.write("tcm_place: %s\n" % error)
+        return 2
+    sys.stderr.write("Aufruf: %s profile <mitschnitt.swo> --elf <firmware.elf> [-o profil.csv]\n"
+                     "       %s place <profil.csv> --objects <verzeichnis> --ld <skript.ld> --out <verzeichnis>\n"
+                     % (argv[0], argv[0]))
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+telemetry_decode.py - Empfängt den Messdatenstrom der Firmware (Core/Src/Telemetry.c) von LPUART1.
+
+Auf der Leitung liegen COBS-kodierte Pakete zwischen zwei Nullbytes und dazwischen Text der
+Kommandozeile (der nie 0x00 enthält). Jedes Stück zwischen zwei Nullbytes ist entweder ein Paket
+mit gültiger CRC32 oder Text; Text geht unverändert nach stderr.
+
+Paket (Little Endian): Art (1), reserviert (1), Paketnummer (2), µs-Zeit (4), Nutzdaten, CRC32 (4)
+Die CRC32 ist dieselbe wie zlib.crc32 über Kopf und Nutzdaten.
+
+Ausgabe als CSV, ein Datensatz je Zeile mit Zeit in Sekunden (aus den unteren 32 Bit von
+Timebase_Us(), unabhängig vom Kerntakt):
+    adc,<zeit>,<poti>,<wert>          (Zeit aus Blocknummer, Scan und Scanrate, ohne Jitter)
+    aht20,<zeit>,<temperatur>,<feuchte>
+    timing,<zeit>,<last %>,<task>,<runs>,<overruns>,<maxLatency>,<maxRuntime>
+    frame,<zeit>,<bilder>,<überschreitungen>,<budget>,<zeichnen>,<max>,<übertragen>,<max>,<letzte überschreitung>
+    widget,<zeit>,<nummer>,<art>,<überschreitungen>,<max zeichnen>     (Zeiten in µs, langsamste zuerst)
+Verlorene Pakete (Lücke in der Paketnummer), CRC-Fehler und der Durchsatz gehen nach stderr.
+Pakete des Bildspiegels (PKT_MIRROR, 'mirror on uart') überspringt das Skript, sie zeigt mirror_view.py.
+
+Aufruf:
+    python3 telemetry_decode.py /dev/ttyACM0 [baudrate]   (mit pyserial, Standard 3000000)
+    python3 telemetry_decode.py mitschnitt.bin            (Datei oder mit stty eingestellte UART)
+Am Terminal der Kommandozeile 'tele on' eingeben bzw. vorher mit echo senden.
+"""
+
+import struct
+import sys
+import time
+import zlib
+
+PKT_INFO, PKT_ADC, PKT_AHT20, PKT_TIMING, PKT_MIRROR, PKT_FRAME = range(6)
+WIDGET_TYPES = ("label", "wert", "balken", "zeiger", "button", "liste")
+
+
+def cobs_decode(data):
+    """Kehrt die COBS-Kodierung um, None bei ungültigen Daten."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, out):
+        self.out = out
+        self.clock_hz = None
+        self.scan_hz = 0
+        self.block_scans = 0
+        self.slots = []
+        self.mask = 0
+        self.decimation = 1
+        self.last_us = None
+        self.seconds = 0.0
+        self.sequence = None
+        self.lost = 0
+        self.crc_errors = 0
+        self.bytes = 0
+        self.report_time = time.monotonic()
+
+    def timestamp(self, us):
+        if self.last_us is not None:
+            self.seconds += ((us - self.last_us) & 0xFFFFFFFF) / 1e6
+        self.last_us = us
+        return self.seconds
+
+    def segment(self, data):
+        """Ein Stück zwischen zwei Nullbytes."""
+        if not data:
+            return
+        packet = cobs_decode(data)
+        if packet is None or len(packet) < 12 or zlib.crc32(packet[:-4]) != struct.unpack_from("<I", packet, len(packet) - 4)[0]:
+            # Shell text contains no control characters besides line ends, a damaged frame does
+            if any(b < 0x20 and b not in b"\r\n\t" for b in data):
+                self.crc_errors += 1
+            else:
+                sys.stderr.write(data.decode("utf-8", "replace"))
+            return
+
+        self.bytes += len(data) + 1
+        kind, _, sequence, us = struct.unpack_from("<BBHI", packet)
+        if self.sequence is not None:
+            self.lost += (sequence - self.sequence - 1) & 0xFFFF
+        self.sequence = sequence
+        self.packet(kind, self.timestamp(us), packet[8:-4])
+        self.report()
+
+    def packet(self, kind, seconds, payload):
+        if kind == PKT_INFO:
+            self.clock_hz, self.scan_hz, self.block_scans, slots, self.mask, self.decimation, _ = \
+                struct.unpack_from("<IIHBBBB", payload)
+            self.slots = list(payload[14:14 + slots])
+        elif kind == PKT_ADC and self.slots:
+            block, first, count = struct.unpack_from("<IHH", payload)
+            chosen = [channel for channel in self.slots if self.mask >> channel & 1]
+            values = struct.unpack_from("<%dH" % (count * len(chosen)), payload, 8)
+            for n in range(count):
+                scan = block * self.block_scans + first + n * self.decimation
+                t = scan / self.scan_hz if self.scan_hz else seconds
+                for k, channel in enumerate(chosen):
+                    self.out.write("adc,%.6f,%d,%d\n" % (t, channel, values[n * len(chosen) + k]))
+        elif kind == PKT_AHT20:
+            temperature, humidity = struct.unpack_from("<ff", payload)
+            self.out.write("aht20,%.6f,%.2f,%.2f\n" % (seconds, temperature, humidity))
+        elif kind == PKT_TIMING:
+            load, count = struct.unpack_from("<HB", payload)
+            for task in range(count):
+                runs, overruns, latency, runtime = struct.unpack_from("<IIII", payload, 4 + 16 * task)
+                self.out.write("timing,%.6f,%.1f,%d,%u,%u,%u,%u\n"
+                               % (seconds, load / 10.0, task, runs, overruns, latency, runtime))
+        elif kind == PKT_FRAME:
+            fields = struct.unpack_from("<8IB", payload)
+            self.out.write("frame,%.6f,%u,%u,%u,%u,%u,%u,%u,%u\n" % ((seconds,) + fields[:8]))
+            for n in range(fields[8]):
+                index, wtype, overruns, render = struct.unpack_from("<BBII", payload, 34 + 10 * n)
+                name = WIDGET_TYPES[wtype] if wtype < len(WIDGET_TYPES) else str(wtype)
+                self.out.write("widget,%.6f,%d,%s,%u,%u\n" % (seconds, index, name, overruns, render))
+
+    def report(self):
+        now = time.monotonic()
+        if now - self.report_time < 1.0:
+            return
+        sys.stderr.write("# %.1f KB/s, %u Pakete verloren, %u CRC-Fehler\n"
+                         % (self.bytes / 1024.0 / (now - self.report_time), self.lost, self.crc_errors))
+        self.bytes = 0
+        self.report_time = now
+
+    def run(self, stream):
+        data = bytearray()
+        while True:
+            chunk = stream.read(max(1, stream.in_waiting)) if hasattr(stream, "in_waiting") else stream.read(4096)
+            if not chunk:
+                break
+            parts = chunk.split(b"\0")
+            data += parts[0]
+            for part in parts[1:]:
+                self.segment(bytes(data))
+                data = bytearray(part)
+            self.out.flush()
+
+
+def open_stream(path, baudrate):
+    try:
+        import serial
+        if path.startswith("/dev/") or path.upper().startswith("COM"):
+            return serial.Serial(path, baudrate)
+    except ImportError:
+        pass
+    return open(path, "rb", buffering=0)
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+
+    baudrate = int(argv[2]) if len(argv) > 2 else 3000000
+    try:
+        Decoder(sys.stdout).run(open_stream(argv[1], baudrate))
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
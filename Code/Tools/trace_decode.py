@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""
+trace_decode.py - Wandelt einen SWO-Mitschnitt des Ereignis-Trace (Core/Src/Trace.c) in eine Zeitleiste.
+
+Eingabe ist der rohe Bytestrom am SWO-Pin (ITM-Protokoll), z.B. aus STM32CubeProgrammer/ST-Link
+SWV, OpenOCD ("tpiu config internal datei.swo uart off <takt> 2000000") oder Orbuculum. Die Art
+des Ereignisses steht im Stimulus-Port (Core/Inc/Trace.h):
+
+    Port 0  Text                    Port 4  Marke << 24 | Wert (32 Bit)
+    Port 1  Interrupt, Bit 7 = Ende Port 5  Namen: Art, Nummer, Zeichen, 0
+    Port 2  Task, Bit 7 = Ende      Port 6  Kerntakt in Hz (32 Bit)
+    Port 3  Marke, Bit 7 = Ende
+
+Die Zeit kommt aus den lokalen Zeitstempeln des ITM (Differenzen in CPU-Takten), umgerechnet mit
+dem zuletzt gemeldeten Kerntakt. Ausgabe ist das Trace-Event-Format (JSON), das Perfetto
+(ui.perfetto.dev) und chrome://tracing als Zeitleiste zeigen: je eine Spur für Interrupts (mit
+Verschachtelung), Tasks und Marken, Werte als Zähler. Überläufe des ITM und die Zahl der Ereignisse
+gehen nach stderr.
+
+Aufruf:
+    python3 trace_decode.py mitschnitt.swo > trace.json
+    python3 trace_decode.py mitschnitt.swo --hz 280000000 > trace.json   (Takt vor der ersten Meldung)
+"""
+
+import json
+import sys
+
+PORT_TEXT, PORT_ISR, PORT_TASK, PORT_MARK, PORT_VALUE, PORT_NAME, PORT_CLOCK = range(7)
+END = 0x80
+NAME_KINDS = ("isr", "task", "mark")
+TRACKS = {PORT_ISR: (1, "Interrupts"), PORT_TASK: (2, "Tasks"), PORT_MARK: (3, "Marken")}
+
+
+def packets(data):
+    """Zerlegt den ITM-Strom: ('sw', port, wert, größe), ('hw', diskriminator, wert, größe),
+    ('ts', takte) oder ('overflow',)."""
+    pos = 0
+    while pos < len(data):
+        header = data[pos]
+        pos += 1
+        if header == 0x00:
+            # Synchronisation: Nullen, abgeschlossen mit 0x80
+            while pos < len(data) and data[pos] == 0x00:
+                pos += 1
+            if pos < len(data) and data[pos] == 0x80:
+                pos += 1
+        elif header == 0x70:
+            yield ("overflow",)
+        elif header & 0x0F == 0x00:
+            # Local timestamp: format 2 in one byte or format 1 with continuation bytes
+            if header & 0x80 == 0:
+                yield ("ts", (header >> 4) & 0x07)
+                continue
+            value = 0
+            shift = 0
+            while pos < len(data):
+                byte = data[pos]
+                pos += 1
+                value |= (byte & 0x7F) << shift
+                shift += 7
+                if byte & 0x80 == 0:
+                    break
+            yield ("ts", value)
+        elif header & 0x03 == 0x00:
+            # Extension and global timestamps: skip the continuation bytes
+            if header & 0x80:
+                while pos < len(data) and data[pos] & 0x80:
+                    pos += 1
+                pos += 1
+        else:
+            size = {1: 1, 2: 2, 3: 4}[header & 0x03]
+            if pos + size > len(data):
+                return
+            value = int.from_bytes(data[pos:pos + size], "little")
+            pos += size
+            if header & 0x04 == 0:
+                yield ("sw", header >> 3, value, size)
+            else:
+                # Hardware source (DWT): discriminator 2 = PC sample, one byte = sleeping
+                yield ("hw", header >> 3, value, size)
+
+
+class Decoder:
+    def __init__(self, hz):
+        self.hz = hz
+        self.us = 0.0
+        self.pending = []
+        self.events = []
+        self.names = {}
+        self.name_bytes = []
+        self.text = []
+        self.overflows = 0
+
+    def feed(self, data):
+        for packet in packets(data):
+            if packet[0] == "ts":
+                # The timestamp belongs to the packets since the previous one
+                self.us += packet[1] * 1e6 / self.hz
+                for event in self.pending:
+                    event[0] = self.us
+                self.pending = []
+            elif packet[0] == "overflow":
+                self.overflows += 1
+                self.add(PORT_TEXT, None, "ITM-Überlauf")
+            elif packet[0] == "sw":
+                self.software(packet[1], packet[2])
+
+    def add(self, port, value, text=None):
+        event = [self.us, port, value, text]
+        self.events.append(event)
+        self.pending.append(event)
+
+    def software(self, port, value):
+        if port == PORT_CLOCK:
+            self.hz = value or self.hz
+        elif port == PORT_NAME:
+            self.name_bytes.append(value)
+            if value == 0 and len(self.name_bytes) >= 3:
+                kind, number = self.name_bytes[0], self.name_bytes[1]
+                name = bytes(self.name_bytes[2:-1]).decode("utf-8", "replace")
+                if kind < len(NAME_KINDS):
+                    self.names[(NAME_KINDS[kind], number)] = name
+                self.name_bytes = []
+        elif port == PORT_TEXT:
+            if value == ord("\n"):
+                self.add(PORT_TEXT, None, bytes(self.text).decode("utf-8", "replace"))
+                self.text = []
+            else:
+                self.text.append(value)
+        else:
+            self.add(port, value)
+
+    def name(self, kind, number):
+        return self.names.get((kind, number), "%s %d" % (kind, number))
+
+    def timeline(self):
+        """Trace-Event-Format, Namen erst am Ende aufgelöst (sie kommen nach den ersten Ereignissen)."""
+        out = [{"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": title}}
+               for tid, title in TRACKS.values()]
+        for us, port, value, text in self.events:
+            if port == PORT_TEXT:
+                out.append({"name": text, "ph": "i", "s": "g", "ts": us, "pid": 1, "tid": 0})
+            elif port == PORT_VALUE:
+                mark = value >> 24
+                out.append({"name": self.name("mark", mark), "ph": "C", "ts": us, "pid": 1,
+                            "args": {"wert": value & 0xFFFFFF}})
+            elif port in TRACKS:
+                tid = TRACKS[port][0]
+                kind = NAME_KINDS[port - PORT_ISR]
+                out.append({"name": self.name(kind, value & ~END), "ph": "E" if value & END else "B",
+                            "ts": us, "pid": 1, "tid": tid})
+        return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main():
+    args = sys.argv[1:]
+    hz = 280000000
+    if "--hz" in args:
+        i = args.index("--hz")
+        hz = int(args[i + 1])
+        del args[i:i + 2]
+    if len(args) != 1:
+        print(__doc__, file=sys.stderr)
+        return 1
+
+    decoder = Decoder(hz)
+    with open(args[0], "rb") as f:
+        decoder.feed(f.read())
+    json.dump(decoder.timeline(), sys.stdout)
+    sys.stdout.write("\n")
+
+    print("%d Ereignisse, %d ITM-Überläufe, %.3f s" % (len(decoder.events), decoder.overflows, decoder.us / 1e6),
+          file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""
+update_pack.py - Firmware-Abbild im Übertragungsformat für den Update-Slot (Core/Src/Update.c).
+
+Stellt dem Rohabbild (objcopy -Obinary, ab 0x08000000) einen Kopf von 32 Bytes voran:
+
+    magic (4)     0x50555746 "FWUP"
+    size (4)      Länge des Abbilds in Bytes
+    crc (4)       CRC-32 des Abbilds (wie zlib.crc32, entspricht Crc32_Compute())
+    version (4)   frei wählbar, z. B. Build-Nummer
+    reserviert (16)
+
+Alle Werte little-endian. Die Firmware prüft Länge, CRC-32, Stackzeiger und Reset-Vektor,
+bevor sie den Kopf in den Slot schreibt.
+
+Aufruf:
+    python3 update_pack.py CLionTest.bin CLionTest.fwu [--version n]
+    Danach 'update sd 0:/CLionTest.fwu' oder per CanTp nach 'update can'.
+"""
+
+import struct
+import sys
+import zlib
+
+MAGIC = 0x50555746
+IMAGE_MAX = 128 * 1024
+HEADER = struct.Struct("<IIII16x")
+
+
+def pack(image, version):
+    if not image:
+        raise ValueError("Abbild ist leer")
+    if len(image) > IMAGE_MAX:
+        raise ValueError("Abbild hat %d Bytes, der interne Flash nur %d" % (len(image), IMAGE_MAX))
+    stack, reset = struct.unpack_from("<II", image, 0) if len(image) >= 8 else (0, 0)
+    if not 0x20000000 <= stack <= 0x24100000 or not 0x08000000 <= reset < 0x08000000 + len(image):
+        raise ValueError("keine Vektortabelle am Anfang (SP 0x%08X, Reset 0x%08X)" % (stack, reset))
+    return HEADER.pack(MAGIC, len(image), zlib.crc32(image) & 0xFFFFFFFF, version) + image
+
+
+def main(argv):
+    args = argv[1:]
+    version = 0
+    files = []
+    while args:
+        arg = args.pop(0)
+        if arg == "--version" and args:
+            version = int(args.pop(0), 0)
+        else:
+            files.append(arg)
+    if len(files) != 2:
+        sys.stderr.write("Aufruf: %s <firmware.bin> <ausgabe.fwu> [--version n]\n" % argv[0])
+        return 2
+    try:
+        with open(files[0], "rb") as f:
+            data = pack(f.read(), version)
+        with open(files[1], "wb") as f:
+            f.write(data)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("update_pack: %s\n" % error)
+        return 1
+    print("%s: %d Bytes Abbild, Version %d" % (files[1], len(data) - HEADER.size, version))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))